@@ -64,10 +64,326 @@
 /**************************************************************************/
 
 #include "adc.h"
+#include "core/bench/isrstats.h"
+#include "core/cpu/cpu.h"
+#include "core/clkgate/clkgate.h"
 
 static bool _adcInitialised = false;
 static uint8_t _adcLastChannel = 0;
 
+/* Data register for channel 'ch' */
+#define ADC_DR(ch)        (*(pREG32(ADC_AD0DR0 + ((ch) << 2))))
+
+#ifdef CFG_ADC_BURST
+#define ADC_RINGMASK      (CFG_ADC_RINGSIZE - 1)
+
+static volatile uint16_t _adcRing[8][CFG_ADC_RINGSIZE];
+static volatile uint16_t _adcLatest[8];
+static volatile uint16_t _adcHead[8];     // Samples written (free running)
+static uint16_t _adcTail[8];              // Samples read (free running)
+static uint8_t _adcBurstMask = 0;
+
+#endif
+
+#ifdef CFG_ADC_TRIGGER
+static uint16_t * volatile _adcTrigBuffer = 0;
+static uint32_t _adcTrigLen = 0;
+static volatile uint32_t _adcTrigIndex = 0;
+static uint8_t _adcTrigChannel = 0;
+static adcBlockCallback_t _adcTrigCallback = 0;
+#endif
+
+#if defined CFG_ADC_BURST || defined CFG_ADC_TRIGGER
+/**************************************************************************/
+/*! 
+    @brief  ADC interrupt handler.
+
+    In burst mode it fires once per scan, when the highest channel in the
+    scan is done, and pushes the result of every channel in the scan into
+    its ring buffer (overwriting the oldest sample when a ring is full).
+
+    In triggered mode it fires once per timer triggered conversion and
+    stores the result in the double buffer, calling the block callback
+    each time one half of the buffer has been filled.
+*/
+/**************************************************************************/
+void ADC_IRQHandler (void)
+{
+  uint32_t regVal;
+#ifdef CFG_ADC_TRIGGER
+  uint32_t idx, half;
+#endif
+#ifdef CFG_ADC_BURST
+  uint8_t ch;
+  uint16_t head;
+#endif
+
+  ISRSTAT_BEGIN();
+
+#ifdef CFG_ADC_TRIGGER
+  if (_adcTrigBuffer)
+  {
+    /* Reading the data register clears its DONE bit */
+    regVal = ADC_DR(_adcTrigChannel);
+    if (regVal & ADC_DR_DONE)
+    {
+      idx = _adcTrigIndex;
+      half = _adcTrigLen >> 1;
+      _adcTrigBuffer[idx++] = (regVal >> 6) & 0x3FF;
+      if (idx == half)
+      {
+        _adcTrigCallback(_adcTrigBuffer, half);
+      }
+      else if (idx == _adcTrigLen)
+      {
+        _adcTrigCallback(_adcTrigBuffer + half, half);
+        idx = 0;
+      }
+      _adcTrigIndex = idx;
+    }
+  }
+#endif
+
+#ifdef CFG_ADC_BURST
+  for (ch = 0; ch < 8; ch++)
+  {
+    if (!(_adcBurstMask & (1 << ch)))
+    {
+      continue;
+    }
+
+    regVal = ADC_DR(ch);
+    if (regVal & ADC_DR_DONE)
+    {
+      head = _adcHead[ch];
+      _adcLatest[ch] = (regVal >> 6) & 0x3FF;
+      _adcRing[ch][head & ADC_RINGMASK] = _adcLatest[ch];
+      _adcHead[ch] = head + 1;
+    }
+  }
+#endif
+
+  ISRSTAT_END(isrStat_ADC);
+}
+#endif
+
+#ifdef CFG_ADC_BURST
+/**************************************************************************/
+/*! 
+    @brief      Starts continuous conversions on every channel in
+                channelMask (bit 0 = AD0 ... bit 7 = AD7).
+
+    The ADC scans the channels in hardware (BURST mode) at the ADC clock
+    set in adcInit (11 clocks per conversion, so a scan of n channels
+    takes 11 * n us at 1MHz) and the interrupt handler collects the
+    results.  Use adcGetLatest or adcReadBlock to get at the samples.
+    Only AD0..3 are configured as analog inputs by adcInit.
+
+    @param[in]  channelMask
+                The channels to scan (0 stops burst mode)
+*/
+/**************************************************************************/
+void adcBurstStart (uint8_t channelMask)
+{
+  uint8_t ch, last = 0;
+
+  if (!_adcInitialised) adcInit();
+
+  adcBurstStop();
+  if (!channelMask)
+  {
+    return;
+  }
+
+  for (ch = 0; ch < 8; ch++)
+  {
+    _adcHead[ch] = _adcTail[ch] = 0;
+    _adcLatest[ch] = 0;
+    if (channelMask & (1 << ch))
+    {
+      last = ch;
+    }
+  }
+  _adcBurstMask = channelMask;
+  clkgateAcquire(clkgatePeriph_ADC);
+
+  /* Interrupt once per scan, on the last channel converted
+     (ADGINTEN must be 0 in burst mode) */
+  *(pREG32(ADC_AD0INTEN)) = (1 << last);
+  NVIC_EnableIRQ(ADC_IRQn);
+
+  /* START must be 0 when BURST is set */
+  ADC_AD0CR = (ADC_AD0CR & ~(ADC_AD0CR_SEL_MASK | ADC_AD0CR_START_MASK)) |
+              channelMask | ADC_AD0CR_BURST_HWSCANMODE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Stops burst mode conversions and returns to software
+                controlled single conversions
+*/
+/**************************************************************************/
+void adcBurstStop (void)
+{
+  if (!_adcBurstMask)
+  {
+    return;
+  }
+
+  ADC_AD0CR = (ADC_AD0CR & ~(ADC_AD0CR_SEL_MASK | ADC_AD0CR_BURST_MASK)) | ADC_AD0CR_SEL_AD0;
+  NVIC_DisableIRQ(ADC_IRQn);
+  *(pREG32(ADC_AD0INTEN)) = 0;
+  _adcBurstMask = 0;
+  clkgateRelease(clkgatePeriph_ADC);
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Returns the most recent burst mode result on a channel
+                without waiting (0 if the channel isn't being scanned)
+*/
+/**************************************************************************/
+uint16_t adcGetLatest (uint8_t channelNum)
+{
+  return _adcLatest[channelNum & 7];
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Copies up to 'len' of the oldest unread burst mode samples
+                on a channel into 'buffer' without waiting.
+
+    If the ring buffer has overflowed since the last read, only the
+    newest CFG_ADC_RINGSIZE samples are still available.
+
+    @return     The number of samples copied
+*/
+/**************************************************************************/
+uint32_t adcReadBlock (uint8_t channelNum, uint16_t *buffer, uint32_t len)
+{
+  uint32_t count = 0;
+  uint16_t head;
+
+  channelNum &= 7;
+
+  /* Keep the interrupt handler out while the ring is read */
+  NVIC_DisableIRQ(ADC_IRQn);
+  head = _adcHead[channelNum];
+  if ((uint16_t)(head - _adcTail[channelNum]) > CFG_ADC_RINGSIZE)
+  {
+    _adcTail[channelNum] = head - CFG_ADC_RINGSIZE;
+  }
+  while ((count < len) && (_adcTail[channelNum] != head))
+  {
+    buffer[count++] = _adcRing[channelNum][_adcTail[channelNum] & ADC_RINGMASK];
+    _adcTail[channelNum]++;
+  }
+  if (_adcBurstMask)
+  {
+    NVIC_EnableIRQ(ADC_IRQn);
+  }
+
+  return count;
+}
+#endif
+
+#ifdef CFG_ADC_TRIGGER
+/**************************************************************************/
+/*! 
+    @brief      Starts sampling one channel at a fixed rate into a double
+                buffer.
+
+    32-bit timer 0 toggles MAT1 twice per sample period and each rising
+    edge starts a conversion in hardware, so the sample rate doesn't
+    depend on interrupt latency or on what the main loop is doing.  The
+    ADC interrupt stores the results in 'buffer', and 'callback' is called
+    (from the interrupt) with the first half of the buffer once it is
+    full, then with the second half, and so on.  Each half must be dealt
+    with before the other one fills up.
+
+    @param[in]  channelNum
+                The A/D channel [0..7] to sample
+    @param[in]  rateHz
+                The sample rate (1..ADC_TRIGGER_MAXHZ)
+    @param[in]  buffer
+                The sample buffer, 'len' entries long
+    @param[in]  len
+                The buffer length (even, at least 2)
+    @param[in]  callback
+                Called with each half of the buffer as it fills
+
+    @return     false if an argument is out of range
+*/
+/**************************************************************************/
+bool adcTriggerStart (uint8_t channelNum, uint32_t rateHz, uint16_t *buffer, uint32_t len, adcBlockCallback_t callback)
+{
+  if ((channelNum >= 8) || (rateHz == 0) || (rateHz > ADC_TRIGGER_MAXHZ) ||
+      (len < 2) || (len & 1) || (buffer == 0) || (callback == 0))
+  {
+    return false;
+  }
+
+  if (!_adcInitialised) adcInit();
+
+  adcTriggerStop();
+#ifdef CFG_ADC_BURST
+  adcBurstStop();
+#endif
+
+  _adcTrigChannel = channelNum;
+  _adcTrigLen = len;
+  _adcTrigIndex = 0;
+  _adcTrigCallback = callback;
+  _adcTrigBuffer = buffer;
+
+  /* Configure 32-bit timer 0 to toggle MAT1 every half sample period
+     (the match output doesn't need to be routed to a pin) */
+  clkgateAcquire(clkgatePeriph_ADC);
+  clkgateAcquire(clkgatePeriph_CT32B0);
+  TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERRESET_ENABLED;
+  TMR_TMR32B0CTCR = TMR_TMR32B0CTCR_CTMODE_TIMER;
+  TMR_TMR32B0PR = 0;
+  TMR_TMR32B0MR1 = TIMER32_CCLK_1S / (rateHz * 2) - 1;
+  TMR_TMR32B0MCR = TMR_TMR32B0MCR_MR1_RESET_ENABLED;
+  TMR_TMR32B0EMR = TMR_TMR32B0EMR_EMC1_TOGGLE;
+
+  /* Interrupt on every conversion of the channel */
+  *(pREG32(ADC_AD0INTEN)) = (1 << channelNum);
+  NVIC_EnableIRQ(ADC_IRQn);
+
+  /* Start a conversion on each rising edge of MAT1 */
+  ADC_AD0CR = (ADC_AD0CR & ~(ADC_AD0CR_SEL_MASK | ADC_AD0CR_START_MASK | ADC_AD0CR_EDGE_MASK)) |
+              (1 << channelNum) | ADC_AD0CR_START_CT32B0_MAT1 | ADC_AD0CR_EDGE_RISING;
+
+  TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERENABLE_ENABLED;
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Stops timer triggered sampling and returns to software
+                controlled single conversions
+*/
+/**************************************************************************/
+void adcTriggerStop (void)
+{
+  if (!_adcTrigBuffer)
+  {
+    return;
+  }
+
+  TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERENABLE_DISABLED;
+  TMR_TMR32B0EMR = TMR_TMR32B0EMR_EMC1_DONOTHING;
+  ADC_AD0CR = (ADC_AD0CR & ~(ADC_AD0CR_SEL_MASK | ADC_AD0CR_START_MASK)) | ADC_AD0CR_SEL_AD0;
+  NVIC_DisableIRQ(ADC_IRQn);
+  *(pREG32(ADC_AD0INTEN)) = 0;
+  _adcTrigBuffer = 0;
+  clkgateRelease(clkgatePeriph_CT32B0);
+  clkgateRelease(clkgatePeriph_ADC);
+}
+#endif
+
 /**************************************************************************/
 /*! 
     @brief Returns the conversion results on the specified ADC channel.
@@ -81,7 +397,10 @@ static uint8_t _adcLastChannel = 0;
                 configured by default in adcInit.)
 
     @return     0 if an overrun error occured, otherwise a 10-bit value
-                containing the A/D conversion results.
+                containing the A/D conversion results.  While burst mode
+                is running (adcBurstStart), the latest burst result is
+                returned instead, and while triggered sampling is
+                running (adcTriggerStart) 0 is returned.
     @warning    Only AD channels 0..3 are configured for A/D in adcInit.
                 If you wish to use A/D pins 4..7 they will also need to
                 be added to the adcInit function.
@@ -93,6 +412,21 @@ uint32_t adcRead (uint8_t channelNum)
 
   uint32_t regVal, adcData;
 
+#ifdef CFG_ADC_BURST
+  /* Software conversions can't be started while in burst mode */
+  if (_adcBurstMask)
+  {
+    return adcGetLatest(channelNum);
+  }
+#endif
+#ifdef CFG_ADC_TRIGGER
+  /* The channel is owned by the trigger while it is running */
+  if (_adcTrigBuffer)
+  {
+    return 0;
+  }
+#endif
+
   /* make sure that channel number is 0..7 */
   if ( channelNum >= 8 )
   {
@@ -100,6 +434,8 @@ uint32_t adcRead (uint8_t channelNum)
     channelNum = 0;
   }
 
+  clkgateAcquire(clkgatePeriph_ADC);
+
   /* Deselect all channels */
   ADC_AD0CR &= ~ADC_AD0CR_SEL_MASK;
 
@@ -150,6 +486,7 @@ uint32_t adcRead (uint8_t channelNum)
 
   /* stop ADC */
   ADC_AD0CR &= ~ADC_AD0CR_START_MASK;
+  clkgateRelease(clkgatePeriph_ADC);
 
   /* return 0 if an overrun occurred */
   if ( regVal & ADC_DR_OVERRUN )
@@ -162,6 +499,105 @@ uint32_t adcRead (uint8_t channelNum)
   return (adcData);
 }
 
+/**************************************************************************/
+/*! 
+    @brief Takes several back to back conversions on one channel and
+           returns a filtered result scaled to 12 bits.
+
+    The conversions are run in hardware (BURST mode on the single
+    channel, 11us each), sorted, and the lowest and highest quarter are
+    thrown away before the rest are averaged.  This rejects the odd
+    noisy reading (e.g. from a resistive touch panel that hasn't settled)
+    and the averaging adds up to 2 bits of effective resolution.
+
+    @param[in]  channelNum
+                The A/D channel [0..7] to read
+    @param[in]  samples
+                The number of conversions (1..ADC_OVERSAMPLE_MAX),
+                typically CFG_ADC_OVERSAMPLE
+
+    @return     The filtered result, 0..4092 (10-bit value * 4).  While
+                burst mode or triggered sampling is running this is
+                just adcRead() * 4.
+*/
+/**************************************************************************/
+uint32_t adcReadOversampled (uint8_t channelNum, uint8_t samples)
+{
+  uint16_t buffer[ADC_OVERSAMPLE_MAX];
+  uint16_t v;
+  uint32_t regVal, sum;
+  uint8_t i, j, trim;
+
+  if (!_adcInitialised) adcInit();
+
+  channelNum &= 7;
+  if (samples > ADC_OVERSAMPLE_MAX) samples = ADC_OVERSAMPLE_MAX;
+
+#ifdef CFG_ADC_BURST
+  if (_adcBurstMask) samples = 1;
+#endif
+#ifdef CFG_ADC_TRIGGER
+  if (_adcTrigBuffer) samples = 1;
+#endif
+  if (samples < 2)
+  {
+    return adcRead(channelNum) << 2;
+  }
+
+  /* Convert continuously on this channel only */
+  clkgateAcquire(clkgatePeriph_ADC);
+  ADC_AD0CR = (ADC_AD0CR & ~(ADC_AD0CR_SEL_MASK | ADC_AD0CR_START_MASK)) |
+              (1 << channelNum) | ADC_AD0CR_BURST_HWSCANMODE;
+
+  /* Insertion sort the results as they come in */
+  for (i = 0; i < samples; )
+  {
+    /* Reading the data register clears its DONE bit */
+    regVal = ADC_DR(channelNum);
+    if (!(regVal & ADC_DR_DONE))
+    {
+      continue;
+    }
+    v = (regVal >> 6) & 0x3FF;
+    for (j = i; (j > 0) && (buffer[j - 1] > v); j--)
+    {
+      buffer[j] = buffer[j - 1];
+    }
+    buffer[j] = v;
+    i++;
+  }
+
+  ADC_AD0CR = (ADC_AD0CR & ~(ADC_AD0CR_SEL_MASK | ADC_AD0CR_BURST_MASK)) | ADC_AD0CR_SEL_AD0;
+  clkgateRelease(clkgatePeriph_ADC);
+
+  /* Trimmed mean of the middle half */
+  trim = samples / 4;
+  sum = 0;
+  for (i = trim; i < samples - trim; i++)
+  {
+    sum += buffer[i];
+  }
+
+  return (sum << 2) / (samples - 2 * trim);
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Clock change hook (see cpuSetClock), keeps the A/D clock
+                at 1MHz
+*/
+/**************************************************************************/
+static void adcClockChanged(uint32_t clock, bool changed)
+{
+  if (changed)
+  {
+    clkgateAcquire(clkgatePeriph_ADC);
+    ADC_AD0CR = (ADC_AD0CR & ~ADC_AD0CR_CLKDIV_MASK) |
+                (((clock / SCB_SYSAHBCLKDIV) / 1000000 - 1) << 8);
+    clkgateRelease(clkgatePeriph_ADC);
+  }
+}
+
 /**************************************************************************/
 /*! 
     @brief      Initialises the A/D converter and configures channels 0..3
@@ -172,11 +608,12 @@ uint32_t adcRead (uint8_t channelNum)
 /**************************************************************************/
 void adcInit (void)
 {
-  /* Disable Power down bit to the ADC block. */
-  SCB_PDRUNCFG &= ~(SCB_PDRUNCFG_ADC);
+  /* Power up the ADC block and enable its AHB clock (with CFG_CLKGATE
+     it is only kept running while a conversion needs it) */
+  clkgateAcquire(clkgatePeriph_ADC);
 
-  /* Enable AHB clock to the ADC. */
-  SCB_SYSAHBCLKCTRL |= (SCB_SYSAHBCLKCTRL_ADC);
+  /* The interrupt is only enabled while a burst or block read runs */
+  NVIC_SetPriority(ADC_IRQn, CFG_IRQPRIO_PERIPH);
 
   /* Digital pins need to have the 'analog' bit set in addition
      to changing their pin function */
@@ -212,7 +649,7 @@ void adcInit (void)
   /* Note that in SW mode only one channel can be selected at a time (AD0 in this case)
      To select multiple channels, ADC_AD0CR_BURST_HWSCANMODE must be used */
   ADC_AD0CR = (ADC_AD0CR_SEL_AD0 |                     /* SEL=1,select channel 0 on ADC0 */
-              (((CFG_CPU_CCLK / SCB_SYSAHBCLKDIV) / 1000000 - 1 ) << 8) |   /* CLKDIV = Fpclk / 1000000 - 1 */ 
+              (((cpuGetClock() / SCB_SYSAHBCLKDIV) / 1000000 - 1 ) << 8) |   /* CLKDIV = Fpclk / 1000000 - 1 */ 
               ADC_AD0CR_BURST_SWMODE |                 /* BURST = 0, no BURST, software controlled */
               ADC_AD0CR_CLKS_10BITS |                  /* CLKS = 0, 11 clocks/10 bits */
               ADC_AD0CR_START_NOSTART |                /* START = 0 A/D conversion stops */
@@ -220,6 +657,8 @@ void adcInit (void)
 
   /* Set initialisation flag */
   _adcInitialised = true;
+  clkgateRelease(clkgatePeriph_ADC);
+  cpuRegisterClockHook(adcClockChanged);
 
   /* Set last channel flag to 0 (initialised above) */
   _adcLastChannel = 0;
@@ -19,9 +19,9 @@
     2. Redistributions in binary form must reproduce the above copyright
     notice, this list of conditions and the following disclaimer in the
     documentation and/or other materials provided with the distribution.
-    3. Neither the name of the copyright holders nor the
-    names of its contributors may be used to endorse or promote products
-    derived from this software without specific prior written permission.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
 
     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
     EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
@@ -41,7 +41,32 @@
 
 #include "projectconfig.h"
 
+/* Largest number of conversions adcReadOversampled will take */
+#define ADC_OVERSAMPLE_MAX  (16)
+
+#ifdef CFG_ADC_TRIGGER
+#include "core/timer32/timer32.h"
+
+/* 11 ADC clocks per conversion at the 1MHz set in adcInit */
+#define ADC_TRIGGER_MAXHZ   (1000000 / 11)
+
+typedef void (*adcBlockCallback_t)(uint16_t *samples, uint32_t count);
+#endif
+
 uint32_t   adcRead (uint8_t channelNum);
+uint32_t   adcReadOversampled (uint8_t channelNum, uint8_t samples);
 void  adcInit (void);
 
+#ifdef CFG_ADC_BURST
+void      adcBurstStart (uint8_t channelMask);
+void      adcBurstStop (void);
+uint16_t  adcGetLatest (uint8_t channelNum);
+uint32_t  adcReadBlock (uint8_t channelNum, uint16_t *buffer, uint32_t len);
+#endif
+
+#ifdef CFG_ADC_TRIGGER
+bool      adcTriggerStart (uint8_t channelNum, uint32_t rateHz, uint16_t *buffer, uint32_t len, adcBlockCallback_t callback);
+void      adcTriggerStop (void);
+#endif
+
 #endif
@@ -0,0 +1,401 @@
+/**************************************************************************/
+/*! 
+    @file     scope.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Triggered oscilloscope style capture of one ADC channel
+
+    @section DESCRIPTION
+
+    Samples one channel continuously at a fixed rate with adcTriggerStart
+    (conversions started in hardware by 32-bit timer 0) into a ring of
+    CFG_SCOPE_SAMPLES samples.  The trigger is checked on every sample
+    in the ADC block callback, so it fires on the exact sample that
+    crossed the level, and once 'preTrigger' samples have been
+    collected before it and the rest of the capture after it, sampling
+    stops and the ring is left alone until the next scopeStart.
+
+    Edge triggers only fire again once the signal has moved back
+    SCOPE_HYSTERESIS counts past the level.  SCOPE_TRIGGER_NONE (or
+    scopeForce, for an 'auto' mode that gives up waiting after a while)
+    takes the capture without waiting for the signal.
+
+    scopeRender draws a capture, or part of it, on a strip chart
+    (drivers/lcd/tft/chart.c).  When there are more samples than
+    columns, each column shows the min/max of the samples it covers,
+    so glitches that fall between columns still show up.
+
+    @section Example
+
+    @code 
+
+    #include "core/adc/scope.h"
+
+    static int16_t columns[200];
+    chart_t chart = { ... };    // 200 columns, minValue 0, maxValue 1023
+
+    // AD5 at 10kHz, rising through 512 with 50 samples before it
+    scopeStart(5, 10000, SCOPE_TRIGGER_RISING, 512, CFG_SCOPE_SAMPLES, 50);
+    while (scopeGetState() != SCOPE_STATE_DONE);
+    scopeRender(&chart, 0, scopeGetLength());
+
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "scope.h"
+
+#ifdef CFG_SCOPE
+
+#include "core/adc/adc.h"
+
+#define SCOPE_RINGMASK          (CFG_SCOPE_SAMPLES - 1)
+
+static uint16_t _scopeRing[CFG_SCOPE_SAMPLES];
+static uint16_t _scopeBlock[SCOPE_BLOCKSIZE * 2];
+static uint16_t _scopeHead;             /* Next slot to write (free running) */
+static uint16_t _scopeStart;            /* First sample of the finished capture */
+static volatile scopeState_t _scopeState = SCOPE_STATE_IDLE;
+static scopeTrigger_t _scopeTrigger;
+static uint16_t _scopeLevel;
+static bool _scopePrimed;               /* Signal was on the far side of the level */
+static volatile bool _scopeForce;
+static uint16_t _scopeSamples, _scopePre;
+static uint16_t _scopeCount;            /* Samples left in the current state */
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Returns true if 'value' meets the trigger condition, keeping
+            track of the hysteresis for the edge triggers
+*/
+/**************************************************************************/
+static bool scopeTriggerCheck(uint16_t value)
+{
+  switch (_scopeTrigger)
+  {
+    case SCOPE_TRIGGER_RISING:
+      if (value + SCOPE_HYSTERESIS <= _scopeLevel)
+      {
+        _scopePrimed = true;
+      }
+      else if (_scopePrimed && (value >= _scopeLevel))
+      {
+        _scopePrimed = false;
+        return true;
+      }
+      return false;
+    case SCOPE_TRIGGER_FALLING:
+      if (value >= _scopeLevel + SCOPE_HYSTERESIS)
+      {
+        _scopePrimed = true;
+      }
+      else if (_scopePrimed && (value <= _scopeLevel))
+      {
+        _scopePrimed = false;
+        return true;
+      }
+      return false;
+    case SCOPE_TRIGGER_ABOVE:
+      return value >= _scopeLevel;
+    case SCOPE_TRIGGER_BELOW:
+      return value <= _scopeLevel;
+    default:
+      return true;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  ADC block callback (called from the ADC interrupt with each
+            half of the double buffer)
+*/
+/**************************************************************************/
+static void scopeBlock(uint16_t *samples, uint32_t count)
+{
+  uint16_t value;
+  bool hit;
+
+  while (count--)
+  {
+    value = *samples++;
+    _scopeRing[_scopeHead++ & SCOPE_RINGMASK] = value;
+    hit = scopeTriggerCheck(value);
+
+    switch (_scopeState)
+    {
+      case SCOPE_STATE_PRETRIGGER:
+        if (--_scopeCount == 0)
+        {
+          _scopeState = SCOPE_STATE_ARMED;
+        }
+        break;
+      case SCOPE_STATE_ARMED:
+        if (!hit && !_scopeForce)
+        {
+          break;
+        }
+        // This sample is the trigger, the rest of the capture follows it
+        _scopeCount = _scopeSamples - _scopePre - 1;
+        _scopeState = SCOPE_STATE_TRIGGERED;
+        if (_scopeCount)
+        {
+          break;
+        }
+        // Fall through
+      case SCOPE_STATE_TRIGGERED:
+        if (_scopeCount && --_scopeCount)
+        {
+          break;
+        }
+        _scopeStart = _scopeHead - _scopeSamples;
+        _scopeState = SCOPE_STATE_DONE;
+        adcTriggerStop();
+        return;
+      default:
+        return;
+    }
+  }
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Starts a new capture, dropping the previous one
+
+    @param[in]  channelNum
+                The A/D channel [0..7] to sample
+    @param[in]  rateHz
+                The sample rate (1..ADC_TRIGGER_MAXHZ)
+    @param[in]  trigger
+                The trigger condition
+    @param[in]  level
+                The trigger level in ADC counts (0..1023)
+    @param[in]  samples
+                The capture length (2..CFG_SCOPE_SAMPLES)
+    @param[in]  preTrigger
+                How many of those samples are taken before the trigger
+
+    @return     false if an argument is out of range
+*/
+/**************************************************************************/
+bool scopeStart(uint8_t channelNum, uint32_t rateHz, scopeTrigger_t trigger, uint16_t level, uint16_t samples, uint16_t preTrigger)
+{
+  if ((samples < 2) || (samples > CFG_SCOPE_SAMPLES) || (preTrigger >= samples) || (level > 1023))
+  {
+    return false;
+  }
+
+  scopeStop();
+
+  _scopeTrigger = trigger;
+  _scopeLevel = level;
+  _scopePrimed = false;
+  _scopeForce = false;
+  _scopeSamples = samples;
+  _scopePre = preTrigger;
+  _scopeCount = preTrigger;
+  _scopeState = preTrigger ? SCOPE_STATE_PRETRIGGER : SCOPE_STATE_ARMED;
+
+  if (!adcTriggerStart(channelNum, rateHz, _scopeBlock, SCOPE_BLOCKSIZE * 2, scopeBlock))
+  {
+    _scopeState = SCOPE_STATE_IDLE;
+    return false;
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Stops sampling.  A capture in progress is dropped, but a
+            finished one can still be read.
+*/
+/**************************************************************************/
+void scopeStop(void)
+{
+  adcTriggerStop();
+  if (_scopeState != SCOPE_STATE_DONE)
+  {
+    _scopeState = SCOPE_STATE_IDLE;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Triggers on the next sample without waiting for the trigger
+            condition (once the pre-trigger samples are in)
+*/
+/**************************************************************************/
+void scopeForce(void)
+{
+  _scopeForce = true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the state of the capture
+*/
+/**************************************************************************/
+scopeState_t scopeGetState(void)
+{
+  return _scopeState;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the number of samples in the finished capture (0 if
+            there is no finished capture)
+*/
+/**************************************************************************/
+uint16_t scopeGetLength(void)
+{
+  return _scopeState == SCOPE_STATE_DONE ? _scopeSamples : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the index of the trigger sample in the capture
+*/
+/**************************************************************************/
+uint16_t scopeGetTrigger(void)
+{
+  return _scopePre;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns one sample of the finished capture
+
+    @param[in]  index
+                The sample, 0 being the oldest (0..scopeGetLength()-1)
+*/
+/**************************************************************************/
+uint16_t scopeGetSample(uint16_t index)
+{
+  return _scopeRing[(_scopeStart + index) & SCOPE_RINGMASK];
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the lowest and highest sample in part of the
+            finished capture
+
+    @param[in]  first
+                The first sample to look at
+    @param[in]  count
+                The number of samples to look at (at least 1)
+    @param[out] minValue
+                The lowest sample
+    @param[out] maxValue
+                The highest sample
+*/
+/**************************************************************************/
+void scopeGetRange(uint16_t first, uint16_t count, uint16_t *minValue, uint16_t *maxValue)
+{
+  uint16_t pos = _scopeStart + first;
+  uint16_t lo = 0xFFFF, hi = 0, value;
+
+  while (count--)
+  {
+    value = _scopeRing[pos++ & SCOPE_RINGMASK];
+    if (value < lo) lo = value;
+    if (value > hi) hi = value;
+  }
+
+  *minValue = lo;
+  *maxValue = hi;
+}
+
+#ifdef CFG_TFTLCD
+/**************************************************************************/
+/*!
+    @brief  Draws samples 'first' to 'first + count - 1' of the finished
+            capture across the whole width of a strip chart
+
+    Each column shows the min/max of the samples that fall in it, plus
+    the last sample of the column before so the trace is continuous.
+    With fewer samples than columns, samples are stretched over several
+    columns.
+
+    @param[in]  chart
+                Chart initialised with chartInit
+    @param[in]  first
+                The first sample to draw
+    @param[in]  count
+                The number of samples to draw
+
+    @return     false if there is no finished capture or the range
+                doesn't fit in it
+*/
+/**************************************************************************/
+bool scopeRender(chart_t *chart, uint16_t first, uint16_t count)
+{
+  uint32_t column, start, end;
+  uint16_t lo, hi;
+
+  if ((_scopeState != SCOPE_STATE_DONE) || (count == 0) ||
+      ((uint32_t)first + count > _scopeSamples))
+  {
+    return false;
+  }
+
+  for (column = 0; column < chart->width; column++)
+  {
+    start = first + column * count / chart->width;
+    end = first + (column + 1) * count / chart->width;
+    if (end <= start)
+    {
+      end = start + 1;
+    }
+    if (column && (start > first))
+    {
+      start--;
+    }
+    scopeGetRange(start, end - start, &lo, &hi);
+    chartDrawColumn(chart, column, lo, hi);
+  }
+
+  return true;
+}
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+/**************************************************************************/
+/*! 
+    @file     scope.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef __SCOPE_H__ 
+#define __SCOPE_H__
+
+#include "projectconfig.h"
+
+#ifdef CFG_SCOPE
+
+#ifdef CFG_TFTLCD
+  #include "drivers/lcd/tft/chart.h"
+#endif
+
+/* Samples per half of the ADC double buffer (one callback each) */
+#define SCOPE_BLOCKSIZE         (8)
+
+/* ADC counts the signal has to move back past the level before an
+   edge trigger can fire again, so noise on a slow edge doesn't
+   trigger more than once */
+#define SCOPE_HYSTERESIS        (8)
+
+typedef enum
+{
+  SCOPE_TRIGGER_NONE = 0,               /* Trigger as soon as the pre-trigger samples are in */
+  SCOPE_TRIGGER_RISING,                 /* Signal rises through the level */
+  SCOPE_TRIGGER_FALLING,                /* Signal falls through the level */
+  SCOPE_TRIGGER_ABOVE,                  /* Any sample at or above the level */
+  SCOPE_TRIGGER_BELOW                   /* Any sample at or below the level */
+} scopeTrigger_t;
+
+typedef enum
+{
+  SCOPE_STATE_IDLE = 0,
+  SCOPE_STATE_PRETRIGGER,               /* Collecting the samples before the trigger */
+  SCOPE_STATE_ARMED,                    /* Waiting for the trigger */
+  SCOPE_STATE_TRIGGERED,                /* Collecting the samples after the trigger */
+  SCOPE_STATE_DONE                      /* Capture complete, sampling stopped */
+} scopeState_t;
+
+bool         scopeStart ( uint8_t channelNum, uint32_t rateHz, scopeTrigger_t trigger, uint16_t level, uint16_t samples, uint16_t preTrigger );
+void         scopeStop ( void );
+void         scopeForce ( void );
+scopeState_t scopeGetState ( void );
+uint16_t     scopeGetLength ( void );
+uint16_t     scopeGetTrigger ( void );
+uint16_t     scopeGetSample ( uint16_t index );
+void         scopeGetRange ( uint16_t first, uint16_t count, uint16_t *minValue, uint16_t *maxValue );
+#ifdef CFG_TFTLCD
+bool         scopeRender ( chart_t *chart, uint16_t first, uint16_t count );
+#endif
+
+#endif
+
+#endif
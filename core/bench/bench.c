@@ -0,0 +1,109 @@
+/**************************************************************************/
+/*! 
+    @file     bench.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Cycle counting for benchmarks, using the Cortex-M3 DWT cycle counter
+    (CYCCNT).  If the cycle counter isn't available (it is optional in
+    the Cortex-M3, and is disabled while some debuggers are attached)
+    the systick timer is used instead, combining the tick count with the
+    current systick value.  This is less precise and assumes that the
+    systick interrupt isn't held off for more than one period.
+
+    The 32-bit counter wraps around every ~59 seconds at 72MHz, so it
+    should only be used to time short sections of code.
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "bench.h"
+#include "core/cpu/cpu.h"
+
+#include "core/systick/systick.h"
+#include "core/delay/delay.h"
+
+static bool _benchCycleCounter = false;
+
+/**************************************************************************/
+/*! 
+    @brief  Enables the DWT cycle counter, and checks that it is running
+*/
+/**************************************************************************/
+void benchInit(void)
+{
+  delayInit();
+  _benchCycleCounter = delayHasCycleCounter();
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns true if the DWT cycle counter is used
+*/
+/**************************************************************************/
+bool benchHasCycleCounter(void)
+{
+  return _benchCycleCounter;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns a free-running count of CPU cycles
+*/
+/**************************************************************************/
+uint32_t benchGetCycles(void)
+{
+  uint32_t ticks, current;
+
+  if (_benchCycleCounter)
+  {
+    return DWT_CYCCNT;
+  }
+
+  // Read the tick count and the down counter consistently
+  do
+  {
+    ticks = systickGetTicks();
+    current = SYSTICK_STCURR;
+  } while (ticks != systickGetTicks());
+
+  return ticks * (SYSTICK_STRELOAD + 1) + (SYSTICK_STRELOAD - current);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Converts a number of CPU cycles to microseconds
+*/
+/**************************************************************************/
+uint32_t benchCyclesToUs(uint32_t cycles)
+{
+  return cycles / (cpuGetClock() / 1000000);
+}
@@ -0,0 +1,62 @@
+/**************************************************************************/
+/*! 
+    @file     bench.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include "projectconfig.h"
+
+/**************************************************************************/
+/*! 
+    Measures the number of CPU cycles taken by a block of code.  't' must
+    be a uint32_t, and holds the elapsed cycles after BENCH_END:
+
+    @code
+    uint32_t cycles;
+    BENCH_BEGIN(cycles);
+    drawFill(COLOR_BLACK);
+    BENCH_END(cycles);
+    @endcode
+*/
+/**************************************************************************/
+#define BENCH_BEGIN(t)  do { (t) = benchGetCycles(); } while (0)
+#define BENCH_END(t)    do { (t) = benchGetCycles() - (t); } while (0)
+
+void     benchInit ( void );
+bool     benchHasCycleCounter ( void );
+uint32_t benchGetCycles ( void );
+uint32_t benchCyclesToUs ( uint32_t cycles );
+
+#endif
@@ -0,0 +1,166 @@
+/**************************************************************************/
+/*! 
+    @file     isrstats.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Keeps the number of calls and the min/max/average duration (in CPU
+    cycles, see bench.c) of the main interrupt handlers, as well as the
+    longest time interrupts were masked by CHB_ENTER_CRIT.  Enabled
+    with CFG_ISRSTATS, and displayed with the 'I' command.
+
+    The durations only cover the handler body, not the exception entry
+    and exit (12 cycles each on the Cortex-M3) or the time an interrupt
+    was pending before it could run.
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "isrstats.h"
+
+#ifdef CFG_ISRSTATS
+
+static isrStatEntry_t _isrStats[isrStat_Last];
+static uint32_t _isrStatCritStart;
+static volatile uint32_t _isrStatCritMax;
+
+static const char * const _isrStatNames[isrStat_Last] =
+{
+  "UART",
+  "USB",
+  "Chibi",
+  "SysTick",
+  "I2C",
+  "ADC"
+};
+
+/**************************************************************************/
+/*! 
+    @brief  Adds one call to the statistics (from the handler itself)
+*/
+/**************************************************************************/
+void isrStatRecord(isrStat_t id, uint32_t cycles)
+{
+  isrStatEntry_t *e = &_isrStats[id];
+
+  e->count++;
+  e->total += cycles;
+  if (cycles < e->min)
+  {
+    e->min = cycles;
+  }
+  if (cycles > e->max)
+  {
+    e->max = cycles;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Called after interrupts have been masked
+*/
+/**************************************************************************/
+void isrStatCritEnter(void)
+{
+  _isrStatCritStart = benchGetCycles();
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Called just before interrupts are enabled again
+*/
+/**************************************************************************/
+void isrStatCritLeave(void)
+{
+  uint32_t cycles = benchGetCycles() - _isrStatCritStart;
+
+  if (cycles > _isrStatCritMax)
+  {
+    _isrStatCritMax = cycles;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Clears all statistics (also starts the cycle counter)
+*/
+/**************************************************************************/
+void isrStatReset(void)
+{
+  uint32_t i;
+
+  benchInit();
+
+  __disable_irq();
+  memset(_isrStats, 0, sizeof(_isrStats));
+  for (i = 0; i < isrStat_Last; i++)
+  {
+    _isrStats[i].min = 0xFFFFFFFF;
+  }
+  _isrStatCritMax = 0;
+  __enable_irq();
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns a consistent copy of the statistics for a handler
+*/
+/**************************************************************************/
+void isrStatGet(isrStat_t id, isrStatEntry_t *entry)
+{
+  __disable_irq();
+  *entry = _isrStats[id];
+  __enable_irq();
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the longest CHB_ENTER_CRIT section in cycles
+*/
+/**************************************************************************/
+uint32_t isrStatGetMaxCrit(void)
+{
+  return _isrStatCritMax;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the display name of a handler
+*/
+/**************************************************************************/
+const char *isrStatGetName(isrStat_t id)
+{
+  return _isrStatNames[id];
+}
+
+#endif
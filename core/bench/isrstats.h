@@ -0,0 +1,89 @@
+/**************************************************************************/
+/*! 
+    @file     isrstats.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef _ISRSTATS_H_
+#define _ISRSTATS_H_
+
+#include "projectconfig.h"
+
+typedef enum
+{
+  isrStat_UART = 0,
+  isrStat_USB,
+  isrStat_Chibi,
+  isrStat_SysTick,
+  isrStat_I2C,
+  isrStat_ADC,
+  isrStat_Last
+} isrStat_t;
+
+typedef struct
+{
+  uint32_t count;
+  uint32_t min;                 // Cycles
+  uint32_t max;                 // Cycles
+  uint64_t total;               // Cycles
+} isrStatEntry_t;
+
+/**************************************************************************/
+/*! 
+    ISRSTAT_BEGIN must be placed after the local variable declarations
+    of an interrupt handler, and ISRSTAT_END before every return.  Both
+    compile to nothing unless CFG_ISRSTATS is defined.
+*/
+/**************************************************************************/
+#ifdef CFG_ISRSTATS
+  #include "core/bench/bench.h"
+
+  #define ISRSTAT_BEGIN()       uint32_t _isrStatStart = benchGetCycles()
+  #define ISRSTAT_END(id)       isrStatRecord((id), benchGetCycles() - _isrStatStart)
+  #define ISRSTAT_CRITENTER()   isrStatCritEnter()
+  #define ISRSTAT_CRITLEAVE()   isrStatCritLeave()
+
+  void     isrStatRecord ( isrStat_t id, uint32_t cycles );
+  void     isrStatCritEnter ( void );
+  void     isrStatCritLeave ( void );
+  void     isrStatReset ( void );
+  void     isrStatGet ( isrStat_t id, isrStatEntry_t *entry );
+  uint32_t isrStatGetMaxCrit ( void );
+  const char *isrStatGetName ( isrStat_t id );
+#else
+  #define ISRSTAT_BEGIN()
+  #define ISRSTAT_END(id)
+  #define ISRSTAT_CRITENTER()
+  #define ISRSTAT_CRITLEAVE()
+#endif
+
+#endif
@@ -0,0 +1,218 @@
+/**************************************************************************/
+/*! 
+    @file     trace.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Deferred-format trace log.  TRACE (see trace.h) doesn't format
+    anything: it stores the format string pointer, a cycle count
+    timestamp and its arguments in a RAM ring of CFG_TRACE_ENTRIES
+    entries, which takes a few dozen cycles and is safe from any
+    interrupt.  The text is produced later, either on the device from
+    the main loop (tracePrint, or 'y' in the CLI), or on the host
+    (traceDump, or 'y 1'), where 'tools/tracedump' looks the format
+    strings up in the firmware's .elf file.
+
+    Producers claim a slot by incrementing the head index with
+    LDREX/STREX, so interrupts at any priority can log without
+    disabling interrupts, and the format pointer is written last to
+    mark the entry as complete.  The reader (only one, in the main
+    loop) stops at the first entry that is still being written.  When
+    the ring is full new entries are dropped and counted, rather than
+    overwriting entries that the reader may be copying.
+
+    Timestamps are in CPU cycles (see core/bench/bench.c), which wrap
+    around every ~59 seconds at 72MHz.
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "trace.h"
+#include "core/bench/bench.h"
+
+#ifdef CFG_TRACE
+
+static volatile traceEntry_t _traceRing[CFG_TRACE_ENTRIES];
+static volatile uint32_t _traceHead = 0;      // Next slot to claim
+static volatile uint32_t _traceTail = 0;      // Next slot to read
+static volatile uint32_t _traceDropped = 0;
+
+/**************************************************************************/
+/*! 
+    @brief  Starts the timestamp counter and empties the log
+*/
+/**************************************************************************/
+void traceInit(void)
+{
+  uint32_t i;
+
+  benchInit();
+  for (i = 0; i < CFG_TRACE_ENTRIES; i++)
+  {
+    _traceRing[i].format = NULL;
+  }
+  _traceHead = 0;
+  _traceTail = 0;
+  _traceDropped = 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Adds an entry to the log (use the TRACE macro instead)
+*/
+/**************************************************************************/
+void traceLog(const char *format, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+  volatile traceEntry_t *e;
+  uint32_t head, dropped;
+
+  // Claim a slot
+  do
+  {
+    head = __LDREXW(&_traceHead);
+    if (head - _traceTail >= CFG_TRACE_ENTRIES)
+    {
+      __CLREX();
+      do
+      {
+        dropped = __LDREXW(&_traceDropped);
+      } while (__STREXW(dropped + 1, &_traceDropped));
+      return;
+    }
+  } while (__STREXW(head + 1, &_traceHead));
+
+  e = &_traceRing[head & (CFG_TRACE_ENTRIES - 1)];
+  e->time = benchGetCycles();
+  e->args[0] = a0;
+  e->args[1] = a1;
+  e->args[2] = a2;
+  e->args[3] = a3;
+  e->format = format;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Takes the oldest entry out of the log
+
+    @returns  false if the log is empty (or the oldest entry is still
+              being written by an interrupted producer)
+*/
+/**************************************************************************/
+bool traceRead(traceEntry_t *entry)
+{
+  volatile traceEntry_t *e;
+  uint32_t i;
+
+  if (_traceTail == _traceHead)
+  {
+    return false;
+  }
+
+  e = &_traceRing[_traceTail & (CFG_TRACE_ENTRIES - 1)];
+  if (e->format == NULL)
+  {
+    return false;
+  }
+
+  entry->format = e->format;
+  entry->time = e->time;
+  for (i = 0; i < TRACE_MAXARGS; i++)
+  {
+    entry->args[i] = e->args[i];
+  }
+
+  // Free the slot only once it has been copied
+  e->format = NULL;
+  _traceTail++;
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the number of entries dropped because the log was
+            full
+*/
+/**************************************************************************/
+uint32_t traceGetDropped(void)
+{
+  return _traceDropped;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Formats and prints every entry in the log, oldest first,
+            with the time in microseconds
+*/
+/**************************************************************************/
+void tracePrint(void)
+{
+  traceEntry_t e;
+
+  while (traceRead(&e))
+  {
+    printf("%10u ", (unsigned int)benchCyclesToUs(e.time));
+    printf(e.format, e.args[0], e.args[1], e.args[2], e.args[3]);
+    printf("%s", CFG_PRINTF_NEWLINE);
+  }
+  if (_traceDropped)
+  {
+    printf("(%u entries dropped)%s", (unsigned int)_traceDropped, CFG_PRINTF_NEWLINE);
+    _traceDropped = 0;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Prints every entry in the log unformatted, one per line
+            ('T <format> <time> <arg0> .. <arg3>' in hex), for
+            'tools/tracedump' to format on the host
+*/
+/**************************************************************************/
+void traceDump(void)
+{
+  traceEntry_t e;
+
+  while (traceRead(&e))
+  {
+    printf("T %08X %08X %08X %08X %08X %08X%s", (unsigned int)e.format, (unsigned int)e.time,
+           (unsigned int)e.args[0], (unsigned int)e.args[1], (unsigned int)e.args[2], (unsigned int)e.args[3],
+           CFG_PRINTF_NEWLINE);
+  }
+  printf("D %08X%s", (unsigned int)_traceDropped, CFG_PRINTF_NEWLINE);
+  _traceDropped = 0;
+}
+
+#endif
@@ -0,0 +1,82 @@
+/**************************************************************************/
+/*! 
+    @file     trace.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include "projectconfig.h"
+
+#define TRACE_MAXARGS   (4)
+
+typedef struct
+{
+  const char *format;           // NULL while the entry is being written
+  uint32_t    time;             // benchGetCycles() when it was logged
+  uint32_t    args[TRACE_MAXARGS];
+} traceEntry_t;
+
+/**************************************************************************/
+/*! 
+    TRACE logs a printf style format string (which must be a literal)
+    with up to TRACE_MAXARGS integer or pointer arguments.  %s arguments
+    are only stored as pointers, so they must point to constant strings.
+    Compiles to nothing unless CFG_TRACE is defined.
+
+    @code
+    TRACE("chb: tx %u bytes to %04X", len, addr);
+    @endcode
+*/
+/**************************************************************************/
+#ifdef CFG_TRACE
+  #define TRACE_0(f)              traceLog((f), 0, 0, 0, 0)
+  #define TRACE_1(f, a)           traceLog((f), (uint32_t)(a), 0, 0, 0)
+  #define TRACE_2(f, a, b)        traceLog((f), (uint32_t)(a), (uint32_t)(b), 0, 0)
+  #define TRACE_3(f, a, b, c)     traceLog((f), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), 0)
+  #define TRACE_4(f, a, b, c, d)  traceLog((f), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d))
+  #define TRACE_SELECT(_1, _2, _3, _4, _5, name, ...) name
+  #define TRACE(...)              TRACE_SELECT(__VA_ARGS__, TRACE_4, TRACE_3, TRACE_2, TRACE_1, TRACE_0, )(__VA_ARGS__)
+
+  void     traceInit ( void );
+  void     traceLog ( const char *format, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3 );
+  bool     traceRead ( traceEntry_t *entry );
+  uint32_t traceGetDropped ( void );
+  void     tracePrint ( void );
+  void     traceDump ( void );
+#else
+  #define TRACE(...)              do { } while (0)
+#endif
+
+#endif
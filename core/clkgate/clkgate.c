@@ -0,0 +1,222 @@
+/**************************************************************************/
+/*! 
+    @file     clkgate.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Reference counted clock and power gating for the on-chip
+    peripherals.  Drivers call clkgateAcquire before touching a
+    peripheral and clkgateRelease when they are done with it.  The first
+    acquire turns on the AHB clock (plus the peripheral clock divider or
+    the analog power where there is one), and with CFG_CLKGATE the last
+    release turns them off again.  The registers keep their contents
+    while the clock is off, so nothing needs to be set up again.
+
+    Without CFG_CLKGATE releasing a peripheral leaves it running, which
+    is how the drivers behaved before, but the user counts and the
+    current estimate are still kept.
+
+    The ADC and I2C drivers hold their peripheral only for each
+    conversion or transfer.  The UART and SSP drivers acquire theirs in
+    uartInit and sspInit and keep it: the UART has to be clocked to
+    receive, and the SSP clock can't be stopped safely while a device on
+    the bus may be selected.
+
+    @section Example
+
+    @code 
+    #include "core/clkgate/clkgate.h"
+
+    clkgateAcquire(clkgatePeriph_ADC);
+    // ... use the ADC ...
+    clkgateRelease(clkgatePeriph_ADC);
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "clkgate.h"
+
+#include "core/cpu/cpu.h"
+
+typedef struct
+{
+  uint32_t ahbMask;                   // SCB_SYSAHBCLKCTRL bit
+  uint32_t pdMask;                    // SCB_PDRUNCFG power-down bit (or 0)
+  REG32   *clkDiv;                    // Peripheral clock divider (or NULL)
+  uint16_t uAPerMHz;                  // Rough current while clocked
+  uint16_t uAFixed;                   // Rough analog current while powered
+} clkgateEntry_t;
+
+// The current figures are only rough estimates for 3.3V (the datasheet
+// doesn't give them per peripheral).  Measure your own board and
+// adjust them if clkgateGetCurrent needs to be accurate.
+static const clkgateEntry_t _clkgateTable[clkgatePeriph_Count] =
+{
+  { SCB_SYSAHBCLKCTRL_ADC,    SCB_PDRUNCFG_ADC, NULL,           10, 400 },
+  { SCB_SYSAHBCLKCTRL_I2C,    0,                NULL,           10,   0 },
+  { SCB_SYSAHBCLKCTRL_SSP0,   0,                &SCB_SSP0CLKDIV, 15,   0 },
+  { SCB_SYSAHBCLKCTRL_UART,   0,                &SCB_UARTCLKDIV, 15,   0 },
+  { SCB_SYSAHBCLKCTRL_CT32B0, 0,                NULL,            8,   0 }
+};
+
+static uint8_t _clkgateUsers[clkgatePeriph_Count];
+
+// Clock dividers saved when a peripheral is gated
+static uint8_t _clkgateDivider[clkgatePeriph_Count];
+
+/**************************************************************************/
+/*! 
+    @brief  Disables interrupts and returns the previous PRIMASK, since
+            the drivers also acquire and release from interrupt handlers
+            and with interrupts disabled
+*/
+/**************************************************************************/
+static inline uint32_t clkgateLock(void)
+{
+  uint32_t primask;
+
+  __asm volatile ("mrs %0, primask" : "=r" (primask));
+  __disable_irq();
+  return primask;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Restores the interrupt state saved by clkgateLock
+*/
+/**************************************************************************/
+static inline void clkgateUnlock(uint32_t primask)
+{
+  if (!primask)
+  {
+    __enable_irq();
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Adds a user of a peripheral, turning its power and clocks on
+            if it was off
+
+    @param[in]  periph
+                The peripheral that is about to be used
+*/
+/**************************************************************************/
+void clkgateAcquire(clkgatePeriph_t periph)
+{
+  const clkgateEntry_t *entry = &_clkgateTable[periph];
+  uint32_t primask;
+
+  primask = clkgateLock();
+  if (_clkgateUsers[periph]++ == 0)
+  {
+    SCB_PDRUNCFG &= ~entry->pdMask;
+    SCB_SYSAHBCLKCTRL |= entry->ahbMask;
+    if (entry->clkDiv && _clkgateDivider[periph])
+    {
+      *entry->clkDiv = _clkgateDivider[periph];
+    }
+  }
+  clkgateUnlock(primask);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Removes a user of a peripheral.  With CFG_CLKGATE, the
+            clocks and power are turned off once there are no users
+            left.
+
+    @param[in]  periph
+                The peripheral that is no longer used
+*/
+/**************************************************************************/
+void clkgateRelease(clkgatePeriph_t periph)
+{
+  const clkgateEntry_t *entry = &_clkgateTable[periph];
+  uint32_t primask;
+
+  primask = clkgateLock();
+  if (_clkgateUsers[periph] && (--_clkgateUsers[periph] == 0))
+  {
+    #ifdef CFG_CLKGATE
+      if (entry->clkDiv)
+      {
+        // Remember the divider set by the driver (0 stops the clock)
+        _clkgateDivider[periph] = *entry->clkDiv;
+        *entry->clkDiv = 0;
+      }
+      SCB_SYSAHBCLKCTRL &= ~entry->ahbMask;
+      SCB_PDRUNCFG |= entry->pdMask;
+    #else
+      (void)entry;
+    #endif
+  }
+  clkgateUnlock(primask);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the number of drivers currently using a peripheral
+*/
+/**************************************************************************/
+uint8_t clkgateGetUsers(clkgatePeriph_t periph)
+{
+  return _clkgateUsers[periph];
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns a rough estimate in microamps of the current drawn
+            by the managed peripherals that are running at the moment
+            (not including the core, the flash or the GPIO)
+*/
+/**************************************************************************/
+uint32_t clkgateGetCurrent(void)
+{
+  uint32_t mhz = cpuGetClock() / 1000000;
+  uint32_t total = 0;
+  uint8_t i;
+
+  for (i = 0; i < clkgatePeriph_Count; i++)
+  {
+    if (SCB_SYSAHBCLKCTRL & _clkgateTable[i].ahbMask)
+    {
+      total += _clkgateTable[i].uAPerMHz * mhz;
+    }
+    if (_clkgateTable[i].pdMask && !(SCB_PDRUNCFG & _clkgateTable[i].pdMask))
+    {
+      total += _clkgateTable[i].uAFixed;
+    }
+  }
+
+  return total;
+}
@@ -53,6 +53,7 @@
 
 #include "cmd.h"
 #include "project/cmd_tbl.h"
+#include "project/commands.h"
 
 #ifdef CFG_PRINTF_UART
 #include "core/uart/uart.h"
@@ -67,9 +68,70 @@
   #include "core/gpio/gpio.h"
 #endif
 
+#ifdef CFG_POOL
+  #include "core/pool/pool.h"
+#endif
+
+#if CFG_INTERFACE_SCRIPTS == 1
+  #include "drivers/fatfs/diskio.h"
+  #include "drivers/fatfs/ff.h"
+  #include "drivers/fatfs/ffsync.h"
+
+  // Set while a script runs: no prompt, and errors are reported by
+  // cmdRunScript with the line number instead of by cmdParse
+  static bool cmd_scriptRunning = false;
+  // Script lines are parsed in place, and can't share 'msg' since the
+  // 'X' command's own arguments still point into it
+  static char cmd_scriptBuf[CFG_INTERFACE_MAXMSGSIZE + 1];
+
+  static const char * const cmd_errorText[] =
+  {
+    "",
+    "Command not recognized",
+    "Too few arguments",
+    "Too many arguments"
+  };
+#endif
+
+#define CMD_MAXARGS (30)
+
 static uint8_t msg[CFG_INTERFACE_MAXMSGSIZE];
 static uint8_t *msg_ptr;
 
+// cmd_tbl indices sorted by command name (see cmdSortTable)
+static uint8_t cmd_index[CMD_COUNT];
+
+#if CFG_INTERFACE_BINARYMODE == 1
+  #define CMD_FRAME_SYNC    (0xA5)
+  #define CMD_FRAME_MAXNUM  (12)      // Numeric args per frame
+
+  static cmdMode_t cmd_mode = cmdMode_Text;
+
+  typedef enum
+  {
+    cmdFrameState_Sync = 0,
+    cmdFrameState_Length,
+    cmdFrameState_Data,
+    cmdFrameState_Crc
+  } cmdFrameState_t;
+
+  static cmdFrameState_t cmd_frameState = cmdFrameState_Sync;
+  static uint8_t cmd_frameLength;
+  static uint8_t cmd_frameCrc;
+
+  static void cmdParseFrame(uint8_t *frame, uint8_t length);
+#endif
+
+#if CFG_INTERFACE_CMDLISTSIZE > 0
+  // Recorded commands, stored pre-parsed as:
+  // table index, arg count, arg strings ('\0' terminated)
+  static uint8_t cmd_list[CFG_INTERFACE_CMDLISTSIZE];
+  static uint16_t cmd_listLength = 0;
+  static bool cmd_listRecording = false;
+
+  static bool cmdListAppend(const cmd_t *entry, size_t argc, char **argv);
+#endif
+
 /**************************************************************************/
 /*! 
     @brief  Polls the relevant incoming message queue to see if anything
@@ -117,6 +179,14 @@ void cmdPoll()
 /**************************************************************************/
 void cmdRx(uint8_t c)
 {
+  #if CFG_INTERFACE_BINARYMODE == 1
+  if (cmd_mode == cmdMode_Binary)
+  {
+    cmdRxFrame(c);
+    return;
+  }
+  #endif
+
   // read out the data in the buffer and echo it back to the host. 
   switch (c)
   {
@@ -159,12 +229,277 @@ void cmdRx(uint8_t c)
 /**************************************************************************/
 static void cmdMenu()
 {
+  #if CFG_INTERFACE_BINARYMODE == 1
+  if (cmd_mode == cmdMode_Binary) return;
+  #endif
+  #if CFG_INTERFACE_SCRIPTS == 1
+  if (cmd_scriptRunning) return;
+  #endif
+
   #if CFG_INTERFACE_SILENTMODE == 0
   printf(CFG_PRINTF_NEWLINE);
   printf(CFG_INTERFACE_PROMPT);
   #endif
 }
 
+/**************************************************************************/
+/*! 
+    @brief  Builds the sorted index used by cmdFind.  The table itself
+            is assembled from #ifdef'ed blocks in cmd_tbl.h, so it is
+            sorted once here rather than by hand.
+*/
+/**************************************************************************/
+static void cmdSortTable()
+{
+  size_t i, j;
+  uint8_t tmp;
+
+  // Insertion sort, the table is small and only sorted once
+  for (i = 0; i < CMD_COUNT; i++)
+  {
+    tmp = i;
+    for (j = i; j > 0 && strcmp(cmd_tbl[cmd_index[j - 1]].command, cmd_tbl[tmp].command) > 0; j--)
+    {
+      cmd_index[j] = cmd_index[j - 1];
+    }
+    cmd_index[j] = tmp;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Looks up a command with a binary search on the sorted index
+
+    @param[in]  name
+                The command name
+
+    @return     The matching table entry, or NULL if there is none
+*/
+/**************************************************************************/
+static const cmd_t *cmdFind(const char *name)
+{
+  size_t lo = 0, hi = CMD_COUNT, mid;
+  int diff;
+
+  while (lo < hi)
+  {
+    mid = (lo + hi) / 2;
+    diff = strcmp(name, cmd_tbl[cmd_index[mid]].command);
+    if (diff == 0)
+    {
+      return &cmd_tbl[cmd_index[mid]];
+    }
+    if (diff < 0)
+    {
+      hi = mid;
+    }
+    else
+    {
+      lo = mid + 1;
+    }
+  }
+
+  return NULL;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Splits the command line into space separated arguments in
+            place (the spaces are replaced with '\0').  Consecutive
+            spaces are skipped, and anything after CMD_MAXARGS arguments
+            is ignored.
+
+    @param[in]  cmd
+                The command string to split
+    @param[out] argv
+                Receives pointers to the start of each argument
+
+    @return     The number of arguments found
+*/
+/**************************************************************************/
+static size_t cmdTokenize(char *cmd, char **argv)
+{
+  size_t argc = 0;
+
+  while (*cmd)
+  {
+    if (*cmd == ' ')
+    {
+      *cmd++ = '\0';
+      continue;
+    }
+    if (argc == CMD_MAXARGS)
+    {
+      break;
+    }
+    argv[argc++] = cmd;
+    while (*cmd && *cmd != ' ')
+    {
+      cmd++;
+    }
+  }
+
+  return argc;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Checks the argument count and runs a command
+
+    @param[in]  entry
+                The command table entry
+    @param[in]  argc
+                The number of arguments, including the command name
+    @param[in]  argv
+                The arguments, starting with the command name
+
+    @return     cmdError_None if the command was run (or its help shown)
+*/
+/**************************************************************************/
+static cmdError_t cmdExecute(const cmd_t *entry, size_t argc, char **argv)
+{
+  if ((argc == 2) && !strcmp (argv [1], "?"))
+  {
+    // Display parameter help menu on 'command ?'
+    printf ("%s%s%s", entry->description, CFG_PRINTF_NEWLINE, CFG_PRINTF_NEWLINE);
+    printf ("%s%s", entry->parameters, CFG_PRINTF_NEWLINE);
+  }
+  else if ((argc - 1) < entry->minArgs)
+  {
+    #if CFG_INTERFACE_BINARYMODE == 1
+    if (cmd_mode == cmdMode_Binary) return cmdError_TooFewArgs;
+    #endif
+    #if CFG_INTERFACE_SCRIPTS == 1
+    if (cmd_scriptRunning) return cmdError_TooFewArgs;
+    #endif
+    // Too few arguments supplied
+    printf ("Too few arguments (%d expected)%s", entry->minArgs, CFG_PRINTF_NEWLINE);
+    printf ("%sType '%s ?' for more information%s%s", CFG_PRINTF_NEWLINE, entry->command, CFG_PRINTF_NEWLINE, CFG_PRINTF_NEWLINE);
+    return cmdError_TooFewArgs;
+  }
+  else if ((argc - 1) > entry->maxArgs)
+  {
+    #if CFG_INTERFACE_BINARYMODE == 1
+    if (cmd_mode == cmdMode_Binary) return cmdError_TooManyArgs;
+    #endif
+    #if CFG_INTERFACE_SCRIPTS == 1
+    if (cmd_scriptRunning) return cmdError_TooManyArgs;
+    #endif
+    // Too many arguments supplied
+    printf ("Too many arguments (%d maximum)%s", entry->maxArgs, CFG_PRINTF_NEWLINE);
+    printf ("%sType '%s ?' for more information%s%s", CFG_PRINTF_NEWLINE, entry->command, CFG_PRINTF_NEWLINE, CFG_PRINTF_NEWLINE);
+    return cmdError_TooManyArgs;
+  }
+  else
+  {
+    #if CFG_INTERFACE_CMDLISTSIZE > 0
+    if (cmd_listRecording && entry->func != cmd_cmdlist)
+    {
+      // Store the command in the list instead of running it
+      if (!cmdListAppend(entry, argc, argv))
+      {
+        printf("Command list full%s", CFG_PRINTF_NEWLINE);
+      }
+      return cmdError_None;
+    }
+    #endif
+    #if CFG_INTERFACE_ENABLEIRQ != 0
+    // Set the IRQ pin high at start of a command
+    gpioSetValue(CFG_INTERFACE_IRQPORT, CFG_INTERFACE_IRQPIN, 1);
+    #endif
+    // Dispatch command to the appropriate function
+    entry->func(argc - 1, &argv [1]);
+    #if CFG_INTERFACE_ENABLEIRQ  != 0
+    // Set the IRQ pin low to signal the end of a command
+    gpioSetValue(CFG_INTERFACE_IRQPORT, CFG_INTERFACE_IRQPIN, 0);
+    #endif
+  }
+
+  return cmdError_None;
+}
+
+#if CFG_INTERFACE_CMDLISTSIZE > 0
+/**************************************************************************/
+/*! 
+    @brief  Adds a command (already checked by cmdExecute) to the end of
+            the command list
+
+    @param[in]  entry
+                The command table entry
+    @param[in]  argc
+                The number of arguments, including the command name
+    @param[in]  argv
+                The arguments, starting with the command name
+
+    @return     false if the command doesn't fit in the list
+*/
+/**************************************************************************/
+static bool cmdListAppend(const cmd_t *entry, size_t argc, char **argv)
+{
+  size_t i, len, total = 2;
+
+  for (i = 1; i < argc; i++)
+  {
+    total += strlen(argv[i]) + 1;
+  }
+  if (cmd_listLength + total > CFG_INTERFACE_CMDLISTSIZE)
+  {
+    return false;
+  }
+
+  cmd_list[cmd_listLength++] = entry - cmd_tbl;
+  cmd_list[cmd_listLength++] = argc - 1;
+  for (i = 1; i < argc; i++)
+  {
+    len = strlen(argv[i]) + 1;
+    memcpy(&cmd_list[cmd_listLength], argv[i], len);
+    cmd_listLength += len;
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Runs every command in the list.  The commands were looked up
+            and checked when they were recorded, so they are called
+            directly, without any prompt in between.
+*/
+/**************************************************************************/
+static void cmdListRun()
+{
+  uint16_t pos = 0;
+  uint8_t index, argc, i;
+#ifdef CFG_POOL
+  char **argv = poolAlloc(CMD_MAXARGS * sizeof(char *));
+
+  if (argv == NULL)
+  {
+    printf("Out of memory%s", CFG_PRINTF_NEWLINE);
+    return;
+  }
+#else
+  char *argv[CMD_MAXARGS];
+#endif
+
+  while (pos < cmd_listLength)
+  {
+    index = cmd_list[pos++];
+    argc = cmd_list[pos++];
+    for (i = 0; i < argc; i++)
+    {
+      argv[i] = (char *)&cmd_list[pos];
+      pos += strlen(argv[i]) + 1;
+    }
+    cmd_tbl[index].func(argc, argv);
+  }
+
+#ifdef CFG_POOL
+  poolFree(argv);
+#endif
+}
+#endif
+
 /**************************************************************************/
 /*! 
     @brief  Parse the command line. This function tokenizes the command
@@ -174,68 +509,357 @@ static void cmdMenu()
 
     @param[in]  cmd
                 The entire command string to be parsed
+
+    @return     cmdError_None if the command was run (or the line was
+                empty)
 */
 /**************************************************************************/
-void cmdParse(char *cmd)
+cmdError_t cmdParse(char *cmd)
 {
-  size_t argc, i = 0;
-  char *argv[30];
+  size_t argc;
+  const cmd_t *entry;
+  cmdError_t error = cmdError_None;
+#ifdef CFG_POOL
+  // The argument list comes from the pool so that the stack is left
+  // for the command handlers
+  char **argv = poolAlloc(CMD_MAXARGS * sizeof(char *));
+
+  if (argv == NULL)
+  {
+    printf("Out of memory%s", CFG_PRINTF_NEWLINE);
+    cmdMenu();
+    return cmdError_None;
+  }
+#else
+  char *argv[CMD_MAXARGS];
+#endif
 
-  argv[i] = strtok(cmd, " ");
-  do
+  argc = cmdTokenize(cmd, argv);
+  if (argc == 0)
   {
-      argv[++i] = strtok(NULL, " ");
-  } while ((i < 30) && (argv[i] != NULL));
-  
-  argc = i;
-  for (i=0; i < CMD_COUNT; i++)
+    // Empty line
+  }
+  else if ((entry = cmdFind(argv[0])) != NULL)
+  {
+    error = cmdExecute(entry, argc, argv);
+  }
+  else
   {
-      if (!strcmp(argv[0], cmd_tbl[i].command))
+    error = cmdError_Unknown;
+    #if CFG_INTERFACE_SCRIPTS == 1
+    if (!cmd_scriptRunning)
+    #endif
+    {
+      printf("Command not recognized: '%s'%s%s", cmd, CFG_PRINTF_NEWLINE, CFG_PRINTF_NEWLINE);
+      #if CFG_INTERFACE_SILENTMODE == 0
+      printf("Type '?' for a list of all available commands%s", CFG_PRINTF_NEWLINE);
+      #endif
+    }
+  }
+
+#ifdef CFG_POOL
+  poolFree(argv);
+#endif
+
+  // Refresh the command prompt
+  cmdMenu();
+
+  return error;
+}
+
+#if CFG_INTERFACE_SCRIPTS == 1
+/**************************************************************************/
+/*! 
+    @brief  Reads up to CFG_INTERFACE_MAXMSGSIZE bytes of a script,
+            starting at 'offset'.  The file is opened for every read,
+            since the commands in the script (bitmaps, for example) open
+            files of their own and FatFs only has the one sector window.
+
+    @return     false if the card or the file can't be opened
+*/
+/**************************************************************************/
+static bool cmdScriptRead(const char *path, DWORD offset, UINT *len)
+{
+  FIL file;
+  bool ok;
+
+  if (ffSyncMount() != FR_OK)
+  {
+    return false;
+  }
+
+  ok = (f_open(&file, path, FA_READ | FA_OPEN_EXISTING) == FR_OK);
+  if (ok)
+  {
+    ok = (f_lseek(&file, offset) == FR_OK) &&
+         (f_read(&file, cmd_scriptBuf, CFG_INTERFACE_MAXMSGSIZE, len) == FR_OK);
+    f_close(&file);
+  }
+  ffSyncUnmount();
+
+  return ok;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Runs every line of a text file on the SD card through
+            cmdParse, exactly as if it had been typed but without echo or
+            prompt.  Lines are separated by CR and/or LF, and lines
+            starting with ';' are comments.  Lines that can't be run are
+            reported with their line number once the line is done, and
+            the remaining lines still run.
+
+    @param[in]  path
+                The script's file name
+
+    @return     The number of lines that couldn't be run, or -1 if the
+                file couldn't be opened
+*/
+/**************************************************************************/
+int16_t cmdRunScript(const char *path)
+{
+  DWORD offset = 0;
+  UINT len, start, i;
+  uint16_t line = 0;
+  int16_t errors = 0;
+  bool done = false, skipping = false;
+  cmdError_t error;
+  char c;
+
+  cmd_scriptRunning = true;
+  while (!done)
+  {
+    if (!cmdScriptRead(path, offset, &len))
+    {
+      if (offset == 0)
       {
-        if ((argc == 2) && !strcmp (argv [1], "?"))
-        {
-          // Display parameter help menu on 'command ?'
-          printf ("%s%s%s", cmd_tbl[i].description, CFG_PRINTF_NEWLINE, CFG_PRINTF_NEWLINE);
-          printf ("%s%s", cmd_tbl[i].parameters, CFG_PRINTF_NEWLINE);
-        }
-        else if ((argc - 1) < cmd_tbl[i].minArgs)
-        {
-          // Too few arguments supplied
-          printf ("Too few arguments (%d expected)%s", cmd_tbl[i].minArgs, CFG_PRINTF_NEWLINE);
-          printf ("%sType '%s ?' for more information%s%s", CFG_PRINTF_NEWLINE, cmd_tbl[i].command, CFG_PRINTF_NEWLINE, CFG_PRINTF_NEWLINE);
-        }
-        else if ((argc - 1) > cmd_tbl[i].maxArgs)
-        {
-          // Too many arguments supplied
-          printf ("Too many arguments (%d maximum)%s", cmd_tbl[i].maxArgs, CFG_PRINTF_NEWLINE);
-          printf ("%sType '%s ?' for more information%s%s", CFG_PRINTF_NEWLINE, cmd_tbl[i].command, CFG_PRINTF_NEWLINE, CFG_PRINTF_NEWLINE);
-        }
-        else
+        errors = -1;
+      }
+      break;
+    }
+
+    if (len < CFG_INTERFACE_MAXMSGSIZE)
+    {
+      // End of the file, which also ends the last line
+      cmd_scriptBuf[len++] = '\n';
+      done = true;
+    }
+
+    start = 0;
+    for (i = 0; i < len; i++)
+    {
+      c = cmd_scriptBuf[i];
+      if ((c != '\r') && (c != '\n'))
+      {
+        continue;
+      }
+
+      cmd_scriptBuf[i] = '\0';
+      if (skipping)
+      {
+        skipping = false;
+      }
+      else if (cmd_scriptBuf[start] != ';')
+      {
+        error = cmdParse(&cmd_scriptBuf[start]);
+        if (error != cmdError_None)
         {
-          #if CFG_INTERFACE_ENABLEIRQ != 0
-          // Set the IRQ pin high at start of a command
-          gpioSetValue(CFG_INTERFACE_IRQPORT, CFG_INTERFACE_IRQPIN, 1);
-          #endif
-          // Dispatch command to the appropriate function
-          cmd_tbl[i].func(argc - 1, &argv [1]);
-          #if CFG_INTERFACE_ENABLEIRQ  != 0
-          // Set the IRQ pin low to signal the end of a command
-          gpioSetValue(CFG_INTERFACE_IRQPORT, CFG_INTERFACE_IRQPIN, 0);
-          #endif
+          printf("%s:%u: %s%s", path, line + 1, cmd_errorText[error], CFG_PRINTF_NEWLINE);
+          errors++;
         }
+      }
+      if (c == '\n')
+      {
+        line++;
+      }
+      start = i + 1;
+    }
 
-        // Refresh the command prompt
-        cmdMenu();
-        return;
+    if (start == 0)
+    {
+      // No line end in a full buffer, drop the rest of the line
+      if (!skipping)
+      {
+        printf("%s:%u: Line too long%s", path, line + 1, CFG_PRINTF_NEWLINE);
+        errors++;
+        skipping = true;
       }
+      start = len;
+    }
+    offset += start;
   }
-  printf("Command not recognized: '%s'%s%s", cmd, CFG_PRINTF_NEWLINE, CFG_PRINTF_NEWLINE);
-  #if CFG_INTERFACE_SILENTMODE == 0
-  printf("Type '?' for a list of all available commands%s", CFG_PRINTF_NEWLINE);
-  #endif
+  cmd_scriptRunning = false;
 
-  cmdMenu();
+  return errors;
 }
+#endif
+
+#if CFG_INTERFACE_BINARYMODE == 1
+/**************************************************************************/
+/*! 
+    @brief  CRC-8 (polynomial 0x07) used to check binary frames
+*/
+/**************************************************************************/
+static uint8_t cmdFrameCrc(uint8_t crc, uint8_t data)
+{
+  uint8_t bit;
+
+  crc ^= data;
+  for (bit = 0; bit < 8; bit++)
+  {
+    crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+  }
+
+  return crc;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Handles a single incoming byte in binary mode.  Frames have
+            the following layout:
+
+            0xA5 len opcode nargs arg[0..nargs-1] text crc
+
+            'len' is the number of bytes from 'opcode' to the end of
+            'text', 'opcode' is the command name (all commands are a
+            single character) and each 'arg' is a little-endian 32-bit
+            value.  The optional 'text' is split on spaces into more
+            arguments (for commands like 't' that end with a string).
+            'crc' is a CRC-8 of everything from 'len' to the end of
+            'text'.  Bad frames are silently dropped, nothing is echoed
+            and no prompt is displayed.
+
+    @param[in]  c
+                The byte to parse.
+*/
+/**************************************************************************/
+void cmdRxFrame(uint8_t c)
+{
+  switch (cmd_frameState)
+  {
+    case cmdFrameState_Sync:
+      if (c == CMD_FRAME_SYNC)
+      {
+        cmd_frameState = cmdFrameState_Length;
+      }
+      break;
+
+    case cmdFrameState_Length:
+      // Leave room for the '\0' after the text
+      if (c < 2 || c >= CFG_INTERFACE_MAXMSGSIZE)
+      {
+        cmd_frameState = cmdFrameState_Sync;
+        break;
+      }
+      cmd_frameLength = c;
+      cmd_frameCrc = cmdFrameCrc(0, c);
+      msg_ptr = msg;
+      cmd_frameState = cmdFrameState_Data;
+      break;
+
+    case cmdFrameState_Data:
+      *msg_ptr++ = c;
+      cmd_frameCrc = cmdFrameCrc(cmd_frameCrc, c);
+      if (msg_ptr - msg == cmd_frameLength)
+      {
+        cmd_frameState = cmdFrameState_Crc;
+      }
+      break;
+
+    case cmdFrameState_Crc:
+      cmd_frameState = cmdFrameState_Sync;
+      if (c == cmd_frameCrc)
+      {
+        cmdParseFrame(msg, cmd_frameLength);
+      }
+      msg_ptr = msg;
+      break;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Converts a binary frame back to the argv form that the
+            command handlers expect and runs the command.  Numeric
+            arguments are passed as '0x' hex strings, which avoids any
+            division here and round trips through getNumber.
+
+    @param[in]  frame
+                The frame, starting with the opcode
+    @param[in]  length
+                The frame length (see cmdRxFrame)
+*/
+/**************************************************************************/
+static void cmdParseFrame(uint8_t *frame, uint8_t length)
+{
+  char name[2];
+  char numbers[CMD_FRAME_MAXNUM][11];
+  char *argv[CMD_MAXARGS];
+  const cmd_t *entry;
+  uint8_t nargs, i, digit;
+  uint32_t value;
+  size_t argc;
+  uint8_t *text;
+
+  name[0] = frame[0];
+  name[1] = '\0';
+  nargs = frame[1];
+  if (nargs > CMD_FRAME_MAXNUM || 2 + nargs * 4 > length)
+  {
+    return;
+  }
+
+  entry = cmdFind(name);
+  if (entry == NULL)
+  {
+    return;
+  }
+
+  argv[0] = name;
+  argc = 1;
+  for (i = 0; i < nargs; i++)
+  {
+    value = frame[2 + i * 4] | (frame[3 + i * 4] << 8) | (frame[4 + i * 4] << 16) | ((uint32_t)frame[5 + i * 4] << 24);
+    numbers[i][0] = '0';
+    numbers[i][1] = 'x';
+    for (digit = 0; digit < 8; digit++)
+    {
+      numbers[i][2 + digit] = "0123456789ABCDEF"[(value >> (28 - digit * 4)) & 0x0F];
+    }
+    numbers[i][10] = '\0';
+    argv[argc++] = numbers[i];
+  }
+
+  // Anything after the numeric arguments is text
+  text = &frame[2 + nargs * 4];
+  frame[length] = '\0';
+  argc += cmdTokenize((char *)text, &argv[argc]);
+
+  cmdExecute(entry, argc, argv);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Switches between the text command line and binary frames
+*/
+/**************************************************************************/
+void cmdSetMode(cmdMode_t mode)
+{
+  cmd_mode = mode;
+  cmd_frameState = cmdFrameState_Sync;
+  msg_ptr = msg;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the current command mode
+*/
+/**************************************************************************/
+cmdMode_t cmdGetMode()
+{
+  return cmd_mode;
+}
+#endif
 
 /**************************************************************************/
 /*! 
@@ -262,6 +886,14 @@ void cmdInit()
   // init the msg ptr
   msg_ptr = msg;
 
+  // Sort the command table for cmdFind
+  cmdSortTable();
+
+  #if CFG_INTERFACE_SCRIPTS == 1
+  // Run the autorun script, with nothing said if there isn't one
+  cmdRunScript(CFG_INTERFACE_AUTORUN);
+  #endif
+
   // Show the menu
   cmdMenu();
 
@@ -294,3 +926,92 @@ void cmd_help(uint8_t argc, char **argv)
 
   printf("%sCommand parameters can be seen by entering: <command-name> ?%s", CFG_PRINTF_NEWLINE, CFG_PRINTF_NEWLINE);
 }
+
+#if CFG_INTERFACE_BINARYMODE == 1
+/**************************************************************************/
+/*! 
+    'mode' command handler ('# 1' switches to binary frames, and a '#'
+    frame with a 0 argument switches back to text)
+*/
+/**************************************************************************/
+void cmd_cmdmode(uint8_t argc, char **argv)
+{
+  int32_t mode;
+
+  if (argc == 0)
+  {
+    printf("%d%s", cmdGetMode(), CFG_PRINTF_NEWLINE);
+    return;
+  }
+
+  getNumber(argv[0], &mode);
+  cmdSetMode(mode ? cmdMode_Binary : cmdMode_Text);
+}
+#endif
+
+#if CFG_INTERFACE_CMDLISTSIZE > 0
+/**************************************************************************/
+/*! 
+    'command list' command handler
+
+    'D 1' clears the list and starts recording: the following commands
+    are checked and stored, but not run.  'D 0' stops recording, and 'D'
+    runs the whole list in one go (useful to draw a complete screen with
+    a single command).
+*/
+/**************************************************************************/
+void cmd_cmdlist(uint8_t argc, char **argv)
+{
+  int32_t record;
+
+  if (argc == 0)
+  {
+    cmd_listRecording = false;
+    cmdListRun();
+    return;
+  }
+
+  getNumber(argv[0], &record);
+  if (record)
+  {
+    cmd_listLength = 0;
+    cmd_listRecording = true;
+  }
+  else
+  {
+    cmd_listRecording = false;
+    #if CFG_INTERFACE_SILENTMODE == 0
+    printf("%d bytes used%s", cmd_listLength, CFG_PRINTF_NEWLINE);
+    #endif
+  }
+}
+#endif
+
+#if CFG_INTERFACE_SCRIPTS == 1
+/**************************************************************************/
+/*! 
+    'execute script' command handler ('X <file>' runs a script from the
+    SD card, see cmdRunScript)
+*/
+/**************************************************************************/
+void cmd_script(uint8_t argc, char **argv)
+{
+  int16_t errors;
+
+  if (cmd_scriptRunning)
+  {
+    printf("Scripts can't be nested%s", CFG_PRINTF_NEWLINE);
+    return;
+  }
+
+  errors = cmdRunScript(argv[0]);
+  if (errors < 0)
+  {
+    printf("Failed to open '%s'%s", argv[0], CFG_PRINTF_NEWLINE);
+  }
+  else if (errors > 0)
+  {
+    printf("%d error(s)%s", errors, CFG_PRINTF_NEWLINE);
+  }
+}
+#endif
@@ -52,9 +52,33 @@ typedef struct
   const char *parameters;
 } cmd_t;
 
+typedef enum
+{
+  cmdError_None = 0,
+  cmdError_Unknown,     // No command with that name
+  cmdError_TooFewArgs,
+  cmdError_TooManyArgs
+} cmdError_t;
+
+typedef enum
+{
+  cmdMode_Text = 0,     // Text command line with echo and prompt
+  cmdMode_Binary        // Framed binary commands (see cmdRxFrame)
+} cmdMode_t;
+
 void cmdPoll();
 void cmdRx(uint8_t c);
-void cmdParse(char *cmd);
+cmdError_t cmdParse(char *cmd);
 void cmdInit();
 
+#if CFG_INTERFACE_SCRIPTS == 1
+int16_t cmdRunScript(const char *path);
+#endif
+
+#if CFG_INTERFACE_BINARYMODE == 1
+void cmdRxFrame(uint8_t c);
+void cmdSetMode(cmdMode_t mode);
+cmdMode_t cmdGetMode();
+#endif
+
 #endif
\ No newline at end of file
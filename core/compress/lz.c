@@ -0,0 +1,375 @@
+/**************************************************************************/
+/*! 
+    @file     lz.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Small LZSS compressor and decompressor for logs and radio payloads.
+
+    The format has a fixed 256 byte window and matches of 2 to 17 bytes
+    (see lz.h), which keeps the decoder down to a 256 byte history, and
+    lets lzDecompress use the output buffer itself as the history.
+
+    lzCompress works on a block that is entirely in memory (RAM or
+    flash) and uses the block itself as the window, so apart from a
+    256 byte hash table on the stack it needs no RAM.  For each
+    position it only tries the last position with the same two byte
+    hash, plus the previous one and two bytes (runs and repeating 16-bit
+    samples), which makes it fast enough to run on every sector of a
+    log at the cost of some compression.
+
+    lzDecode undoes it in pieces, for data that arrives in fragments
+    (see chb_xport_send_lz).
+
+    @code
+    uint8_t packed[256];
+    uint32_t len;
+
+    len = lzCompress(data, dataLen, packed, sizeof(packed));
+    if (len == 0)
+    {
+      // doesn't compress into 256 bytes, send it as it is
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "lz.h"
+
+#define LZ_HASHBITS       (7)
+#define LZ_HASHSIZE       (1 << LZ_HASHBITS)
+#define LZ_TOKENBITS      (1 + LZ_WINDOWBITS + LZ_LENGTHBITS)
+#define LZ_HASH(p)        ((((p)[0] << 3) ^ ((p)[1] * 0x9D)) & (LZ_HASHSIZE - 1))
+
+typedef struct
+{
+  uint8_t  *out;
+  uint32_t size;
+  uint32_t pos;
+  uint32_t bits;
+  uint8_t  bitCount;
+} lzWriter_t;
+
+/**************************************************************************/
+/*! 
+    @brief      Appends 'count' bits to the output (false if it is full)
+*/
+/**************************************************************************/
+static bool lzPutBits (lzWriter_t *w, uint32_t value, uint8_t count)
+{
+  w->bits = (w->bits << count) | value;
+  w->bitCount += count;
+
+  while (w->bitCount >= 8)
+  {
+    if (w->pos >= w->size)
+    {
+      return false;
+    }
+    w->bitCount -= 8;
+    w->out[w->pos++] = w->bits >> w->bitCount;
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Returns the length of the match at 'in + pos' against the
+                data 'dist' bytes back (up to 'max')
+*/
+/**************************************************************************/
+static uint32_t lzMatch (const uint8_t *in, uint32_t pos, uint32_t dist, uint32_t max)
+{
+  const uint8_t *a = in + pos;
+  const uint8_t *b = a - dist;
+  uint32_t len = 0;
+
+  while ((len < max) && (a[len] == b[len]))
+  {
+    len++;
+  }
+
+  return len;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Compresses a block of data
+
+    @param[in]  in
+                The data to compress
+    @param[in]  len
+                Its length in bytes
+    @param[out] out
+                The buffer for the compressed data
+    @param[in]  outSize
+                The size of 'out'
+
+    @return     The compressed length, or 0 if it doesn't fit into
+                'outSize' bytes
+*/
+/**************************************************************************/
+uint32_t lzCompress (const uint8_t *in, uint32_t len, uint8_t *out, uint32_t outSize)
+{
+  uint16_t hash[LZ_HASHSIZE];
+  lzWriter_t w;
+  uint32_t pos = 0;
+  uint32_t max, best, bestDist, dist, n, hpos;
+
+  memset(hash, 0, sizeof(hash));
+  w.out = out;
+  w.size = outSize;
+  w.pos = 0;
+  w.bits = 0;
+  w.bitCount = 0;
+
+  while (pos < len)
+  {
+    max = len - pos;
+    if (max > LZ_MAXMATCH)
+    {
+      max = LZ_MAXMATCH;
+    }
+    best = 0;
+    bestDist = 0;
+
+    if (max >= LZ_MINMATCH)
+    {
+      /* Last position with the same hash (positions are kept mod 64K,
+         so the distance decides whether it is still in the window) */
+      dist = (uint16_t)(pos - hash[LZ_HASH(in + pos)]);
+      if ((dist > 2) && (dist <= LZ_WINDOWSIZE) && (dist <= pos))
+      {
+        best = lzMatch(in, pos, dist, max);
+        bestDist = dist;
+      }
+      for (dist = 1; (dist <= 2) && (dist <= pos) && (best < max); dist++)
+      {
+        n = lzMatch(in, pos, dist, max);
+        if (n > best)
+        {
+          best = n;
+          bestDist = dist;
+        }
+      }
+    }
+
+    if (best >= LZ_MINMATCH)
+    {
+      if (!lzPutBits(&w, (((bestDist - 1) << LZ_LENGTHBITS) | (best - LZ_MINMATCH)), LZ_TOKENBITS))
+      {
+        return 0;
+      }
+    }
+    else
+    {
+      best = 1;
+      if (!lzPutBits(&w, 0x100 | in[pos], 9))
+      {
+        return 0;
+      }
+    }
+
+    /* Every position covered by the token goes into the hash table */
+    for (hpos = pos; (hpos < pos + best) && (hpos + 1 < len); hpos++)
+    {
+      hash[LZ_HASH(in + hpos)] = hpos;
+    }
+    pos += best;
+  }
+
+  /* Pad the last byte */
+  if (w.bitCount && !lzPutBits(&w, 0, 8 - w.bitCount))
+  {
+    return 0;
+  }
+
+  return w.pos;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Decompresses a block that is entirely in memory
+
+    @param[in]  in
+                The compressed data
+    @param[in]  len
+                Its length in bytes
+    @param[out] out
+                The buffer for the decompressed data
+    @param[in]  outSize
+                The size of 'out'
+
+    @return     The decompressed length, or 0 if the data is corrupt or
+                doesn't fit into 'outSize' bytes
+*/
+/**************************************************************************/
+uint32_t lzDecompress (const uint8_t *in, uint32_t len, uint8_t *out, uint32_t outSize)
+{
+  uint32_t bits = 0, i = 0, pos = 0, offset, count, value;
+  uint8_t bitCount = 0;
+
+  while (1)
+  {
+    while ((bitCount < LZ_TOKENBITS) && (i < len))
+    {
+      bits = (bits << 8) | in[i++];
+      bitCount += 8;
+    }
+    if (bitCount < 9)
+    {
+      /* Only padding left */
+      break;
+    }
+
+    if ((bits >> (bitCount - 1)) & 1)
+    {
+      bitCount -= 9;
+      if (pos >= outSize)
+      {
+        return 0;
+      }
+      out[pos++] = bits >> bitCount;
+      continue;
+    }
+
+    if (bitCount < LZ_TOKENBITS)
+    {
+      break;
+    }
+
+    bitCount -= LZ_TOKENBITS;
+    value = bits >> bitCount;
+    offset = ((value >> LZ_LENGTHBITS) & (LZ_WINDOWSIZE - 1)) + 1;
+    count = (value & ((1 << LZ_LENGTHBITS) - 1)) + LZ_MINMATCH;
+    if ((offset > pos) || (pos + count > outSize))
+    {
+      return 0;
+    }
+    while (count--)
+    {
+      out[pos] = out[pos - offset];
+      pos++;
+    }
+  }
+
+  return pos;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Prepares a streaming decoder for a new stream
+*/
+/**************************************************************************/
+void lzDecoderInit (lzDecoder_t *dec)
+{
+  memset(dec, 0, sizeof(lzDecoder_t));
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Decompresses as much of 'in' as fits into 'out'
+
+    Input that was consumed but not decoded yet is kept in the decoder,
+    so the next call carries on where this one stopped.  Call it again
+    with the rest of the input whenever 'out' was filled.
+
+    @param[in]  dec
+                The decoder state (see lzDecoderInit)
+    @param[in]  in
+                The next piece of compressed data
+    @param[in]  len
+                Its length in bytes
+    @param[out] used
+                Set to the number of input bytes consumed
+    @param[out] out
+                The buffer for the decompressed data
+    @param[in]  outSize
+                The size of 'out'
+
+    @return     The number of bytes written to 'out'
+*/
+/**************************************************************************/
+uint32_t lzDecode (lzDecoder_t *dec, const uint8_t *in, uint32_t len, uint32_t *used, uint8_t *out, uint32_t outSize)
+{
+  uint32_t i = 0, n = 0, value;
+  uint8_t b;
+
+  while (n < outSize)
+  {
+    if (dec->length)
+    {
+      b = dec->window[(dec->pos - dec->offset) & (LZ_WINDOWSIZE - 1)];
+      dec->length--;
+    }
+    else
+    {
+      while ((dec->bitCount < LZ_TOKENBITS) && (i < len))
+      {
+        dec->bits = (dec->bits << 8) | in[i++];
+        dec->bitCount += 8;
+      }
+      if (dec->bitCount < 9)
+      {
+        break;
+      }
+
+      if ((dec->bits >> (dec->bitCount - 1)) & 1)
+      {
+        dec->bitCount -= 9;
+        b = dec->bits >> dec->bitCount;
+      }
+      else
+      {
+        if (dec->bitCount < LZ_TOKENBITS)
+        {
+          break;
+        }
+        dec->bitCount -= LZ_TOKENBITS;
+        value = dec->bits >> dec->bitCount;
+        dec->offset = ((value >> LZ_LENGTHBITS) & (LZ_WINDOWSIZE - 1)) + 1;
+        dec->length = (value & ((1 << LZ_LENGTHBITS) - 1)) + LZ_MINMATCH;
+        continue;
+      }
+    }
+
+    dec->window[dec->pos & (LZ_WINDOWSIZE - 1)] = b;
+    dec->pos++;
+    out[n++] = b;
+  }
+
+  *used = i;
+  return n;
+}
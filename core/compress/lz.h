@@ -0,0 +1,72 @@
+/**************************************************************************/
+/*! 
+    @file     lz.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef _LZ_H_
+#define _LZ_H_
+
+#include "projectconfig.h"
+
+/* Fixed stream format: every token is a '1' bit and a literal byte, or
+   a '0' bit, (offset - 1) in LZ_WINDOWBITS and (length - LZ_MINMATCH)
+   in LZ_LENGTHBITS, packed MSB first.  The last byte is padded with 0. */
+#define LZ_WINDOWBITS     (8)
+#define LZ_LENGTHBITS     (4)
+#define LZ_WINDOWSIZE     (1 << LZ_WINDOWBITS)
+#define LZ_MINMATCH       (2)
+#define LZ_MAXMATCH       (LZ_MINMATCH + (1 << LZ_LENGTHBITS) - 1)
+
+/**************************************************************************/
+/*! 
+    Streaming decoder state.  The decoder keeps the last LZ_WINDOWSIZE
+    bytes it produced, so the compressed data can be fed in pieces of
+    any size and the output taken in pieces of any size.
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint8_t  window[LZ_WINDOWSIZE];
+  uint16_t pos;                       // Bytes produced (mod window size)
+  uint16_t offset;                    // Current match
+  uint16_t length;                    // Bytes of it still to be copied
+  uint32_t bits;                      // Unused input bits
+  uint8_t  bitCount;
+} lzDecoder_t;
+
+uint32_t lzCompress ( const uint8_t *in, uint32_t len, uint8_t *out, uint32_t outSize );
+uint32_t lzDecompress ( const uint8_t *in, uint32_t len, uint8_t *out, uint32_t outSize );
+void     lzDecoderInit ( lzDecoder_t *dec );
+uint32_t lzDecode ( lzDecoder_t *dec, const uint8_t *in, uint32_t len, uint32_t *used, uint8_t *out, uint32_t outSize );
+
+#endif
@@ -0,0 +1,170 @@
+/**************************************************************************/
+/*! 
+    @file     varint.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Variable length integers (7 bits per byte, least significant group
+    first, the top bit set on every byte but the last) and delta coding
+    of 16-bit sample blocks.
+
+    Sensor readings usually change very little from one sample to the
+    next, so varintDeltaEncode16 stores the first sample of a block as
+    it is and every other one as the zigzag coded difference to the
+    previous sample.  Differences of -64..63 take a single byte instead
+    of two.  Each block can be decoded on its own.
+
+    @code
+    uint16_t samples[12];
+    uint8_t packed[12 * VARINT_MAXBYTES16];
+    uint32_t len;
+
+    len = varintDeltaEncode16(samples, 12, packed);
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "varint.h"
+
+/**************************************************************************/
+/*! 
+    @brief      Writes 'value' to 'buffer' (up to VARINT_MAXBYTES)
+
+    @return     The number of bytes written
+*/
+/**************************************************************************/
+uint8_t varintPut (uint8_t *buffer, uint32_t value)
+{
+  uint8_t n = 0;
+
+  while (value >= 0x80)
+  {
+    buffer[n++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  buffer[n++] = value;
+
+  return n;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Reads a value written by varintPut
+
+    @return     The number of bytes read, or 0 if 'len' bytes don't hold
+                a complete value
+*/
+/**************************************************************************/
+uint8_t varintGet (const uint8_t *buffer, uint32_t len, uint32_t *value)
+{
+  uint32_t v = 0;
+  uint8_t n = 0;
+
+  while ((n < len) && (n < VARINT_MAXBYTES))
+  {
+    v |= (uint32_t)(buffer[n] & 0x7F) << (7 * n);
+    if (!(buffer[n++] & 0x80))
+    {
+      *value = v;
+      return n;
+    }
+  }
+
+  return 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Delta codes a block of 16-bit samples
+
+    @param[in]  samples
+                The samples to encode
+    @param[in]  count
+                The number of samples
+    @param[out] buffer
+                At least count * VARINT_MAXBYTES16 bytes
+
+    @return     The number of bytes written
+*/
+/**************************************************************************/
+uint32_t varintDeltaEncode16 (const uint16_t *samples, uint32_t count, uint8_t *buffer)
+{
+  uint32_t i, len;
+
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  len = varintPut(buffer, samples[0]);
+  for (i = 1; i < count; i++)
+  {
+    len += varintPut(buffer + len, varintZigzag((int32_t)samples[i] - samples[i - 1]));
+  }
+
+  return len;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Decodes a block written by varintDeltaEncode16
+
+    @param[in]  buffer
+                The encoded block
+    @param[in]  len
+                The bytes available in 'buffer'
+    @param[out] samples
+                Room for 'count' samples
+    @param[in]  count
+                The number of samples in the block
+
+    @return     The number of bytes read, or 0 if the block is truncated
+*/
+/**************************************************************************/
+uint32_t varintDeltaDecode16 (const uint8_t *buffer, uint32_t len, uint16_t *samples, uint32_t count)
+{
+  uint32_t i, pos = 0, value;
+  uint8_t n;
+
+  for (i = 0; i < count; i++)
+  {
+    n = varintGet(buffer + pos, len - pos, &value);
+    if (n == 0)
+    {
+      return 0;
+    }
+    pos += n;
+    samples[i] = i ? samples[i - 1] + varintUnzigzag(value) : value;
+  }
+
+  return pos;
+}
@@ -0,0 +1,65 @@
+/**************************************************************************/
+/*! 
+    @file     varint.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef _VARINT_H_
+#define _VARINT_H_
+
+#include "projectconfig.h"
+
+#define VARINT_MAXBYTES     (5)     /* Longest encoding of a 32-bit value */
+#define VARINT_MAXBYTES16   (3)     /* Longest encoding of a 16-bit delta */
+
+/**************************************************************************/
+/*! 
+    @brief  Maps signed values to unsigned ones so that small negative
+            numbers stay small (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...)
+*/
+/**************************************************************************/
+static inline uint32_t varintZigzag(int32_t value)
+{
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t varintUnzigzag(uint32_t value)
+{
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+uint8_t  varintPut ( uint8_t *buffer, uint32_t value );
+uint8_t  varintGet ( const uint8_t *buffer, uint32_t len, uint32_t *value );
+uint32_t varintDeltaEncode16 ( const uint16_t *samples, uint32_t count, uint8_t *buffer );
+uint32_t varintDeltaDecode16 ( const uint8_t *buffer, uint32_t len, uint16_t *samples, uint32_t count );
+
+#endif
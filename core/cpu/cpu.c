@@ -59,23 +59,39 @@
 /**************************************************************************/
 
 #include "cpu.h"
+#include "irq.h"
 #include "core/gpio/gpio.h"
 
+// The crystal frequency multiplied by the PLL
+#define CPU_XTAL_HZ   (12000000)
+
+static uint32_t _cpuClock = CFG_CPU_CCLK;
+static cpuMultiplier_t _cpuMultiplier = CPU_MULTIPLIER_6;
+static cpuClockHook_t _cpuClockHooks[CPU_MAXCLOCKHOOKS];
+
 /**************************************************************************/
 /*! 
-    @brief Configures the main clock/PLL
-    
-    The speed at which the MCU operates is set here using the SCB_PLLCTRL
-    register, and the SCB_PLLCLKSEL register can be used to select which
-    oscillator to use to generate the system clocks (the internal 12MHz
-    oscillator or an external crystal).
+    @brief Selects the main clock source and waits for the switch
+*/
+/**************************************************************************/
+static void cpuSelectMainClock (uint32_t source)
+{
+  SCB_MAINCLKSEL = source;
+  SCB_MAINCLKUEN = SCB_MAINCLKUEN_UPDATE;     // Update clock source
+  SCB_MAINCLKUEN = SCB_MAINCLKUEN_DISABLE;    // Toggle update register once
+  SCB_MAINCLKUEN = SCB_MAINCLKUEN_UPDATE;
 
-    @param[in]  multiplier
-                The PLL multiplier
+  // Wait until the clock is updated
+  while (!(SCB_MAINCLKUEN & SCB_MAINCLKUEN_UPDATE));
+}
 
+/**************************************************************************/
+/*! 
+    @brief Starts the crystal oscillator and the system PLL, and runs
+           the main clock from the PLL output
 */
 /**************************************************************************/
-void cpuPllSetup (cpuMultiplier_t multiplier)
+static void cpuPllStart (cpuMultiplier_t multiplier)
 {
   uint32_t i;
 
@@ -130,13 +146,26 @@ void cpuPllSetup (cpuMultiplier_t multiplier)
   while (!(SCB_PLLSTAT & SCB_PLLSTAT_LOCK));
 
   // Setup main clock (use PLL output)
-  SCB_MAINCLKSEL = SCB_MAINCLKSEL_SOURCE_SYSPLLCLKOUT;
-  SCB_MAINCLKUEN = SCB_MAINCLKUEN_UPDATE;     // Update clock source
-  SCB_MAINCLKUEN = SCB_MAINCLKUEN_DISABLE;    // Toggle update register once
-  SCB_MAINCLKUEN = SCB_MAINCLKUEN_UPDATE;
+  cpuSelectMainClock(SCB_MAINCLKSEL_SOURCE_SYSPLLCLKOUT);
+}
 
-  // Wait until the clock is updated
-  while (!(SCB_MAINCLKUEN & SCB_MAINCLKUEN_UPDATE));
+/**************************************************************************/
+/*! 
+    @brief Configures the main clock/PLL
+    
+    The speed at which the MCU operates is set here using the SCB_PLLCTRL
+    register, and the SCB_PLLCLKSEL register can be used to select which
+    oscillator to use to generate the system clocks (the internal 12MHz
+    oscillator or an external crystal).
+
+    @param[in]  multiplier
+                The PLL multiplier
+
+*/
+/**************************************************************************/
+void cpuPllSetup (cpuMultiplier_t multiplier)
+{
+  cpuPllStart(multiplier);
 
   // Disable USB clock by default (enabled in USB code)
   SCB_PDRUNCFG |= (SCB_PDSLEEPCFG_USBPAD_PD); // Power-down USB PHY
@@ -156,6 +185,10 @@ void cpuPllSetup (cpuMultiplier_t multiplier)
 /**************************************************************************/
 void cpuInit (void)
 {
+  // Preemption levels vs. sub-priorities, before any driver sets its
+  // interrupt's priority (see CFG_IRQPRIO_... in projectconfig.h)
+  NVIC_SetPriorityGrouping(IRQ_PRIGROUP);
+
   gpioInit();
 
   // Set all GPIO pins to input by default
@@ -167,3 +200,180 @@ void cpuInit (void)
   // Setup PLL (etc.)
   cpuPllSetup(CPU_MULTIPLIER_6);
 }
+
+/**************************************************************************/
+/*! 
+    @brief Changes the main clock at run time
+
+    The main clock is switched to the IRC while the PLL is reconfigured,
+    then every hook registered with cpuRegisterClockHook is called so
+    that the drivers can recompute their dividers (the UART baud rate,
+    the systick reload value, the ADC clock, etc.).  Peripherals set up
+    after the change pick up the new clock from cpuGetClock.
+
+    Clocks above CFG_CPU_CCLK are refused, since the busy-wait delays
+    that are derived from CFG_CPU_CCLK at compile time would become too
+    short.  Slower clocks only make them longer.  The crystal oscillator
+    is left running (the USB PLL uses it as well).
+
+    @param[in]  multiplier
+                The PLL multiplier, or CPU_MULTIPLIER_IRC to run from
+                the 12MHz internal oscillator with the PLL powered down
+
+    @return     false if the clock would be faster than CFG_CPU_CCLK
+
+    @section Example
+
+    @code 
+    // Drop to 12MHz while idle ...
+    cpuSetClock(CPU_MULTIPLIER_IRC);
+    // ... and back to full speed for a display update
+    cpuSetClock(CPU_MULTIPLIER_6);
+    @endcode
+*/
+/**************************************************************************/
+bool cpuSetClock (cpuMultiplier_t multiplier)
+{
+  uint32_t clock;
+  uint8_t i;
+
+  if (multiplier == CPU_MULTIPLIER_IRC)
+  {
+    clock = CPU_XTAL_HZ;
+  }
+  else
+  {
+    clock = CPU_XTAL_HZ * (multiplier - CPU_MULTIPLIER_1 + 1);
+  }
+
+  if (clock > CFG_CPU_CCLK)
+  {
+    return false;
+  }
+
+  __disable_irq();
+
+  for (i = 0; i < CPU_MAXCLOCKHOOKS && _cpuClockHooks[i]; i++)
+  {
+    _cpuClockHooks[i](clock, false);
+  }
+
+  // Run from the IRC and power the PLL down while it's changed
+  cpuSelectMainClock(SCB_MAINCLKSEL_SOURCE_INTERNALOSC);
+  SCB_PDRUNCFG |= SCB_PDRUNCFG_SYSPLL_MASK;
+  if (multiplier != CPU_MULTIPLIER_IRC)
+  {
+    cpuPllStart(multiplier);
+  }
+
+  _cpuClock = clock;
+  _cpuMultiplier = multiplier;
+
+  for (i = 0; i < CPU_MAXCLOCKHOOKS && _cpuClockHooks[i]; i++)
+  {
+    _cpuClockHooks[i](clock, true);
+  }
+
+  __enable_irq();
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief First half of the deep-sleep wake-up, switches the main clock
+           to the IRC straight away
+
+    The blocks that were running before deep-sleep (see SCB_PDAWAKECFG
+    in pmuDeepSleep) are powered up again by the hardware on wake-up,
+    and the PLL settings are kept, so the crystal oscillator and the PLL
+    are already starting up.  Running from the IRC rather than the slow
+    WDT oscillator in the meantime lets the rest of the wake-up work get
+    done while the PLL locks.  cpuWakeFinish then switches back to the
+    PLL.
+*/
+/**************************************************************************/
+void cpuWakeStart (void)
+{
+  cpuSelectMainClock(SCB_MAINCLKSEL_SOURCE_INTERNALOSC);
+}
+
+/**************************************************************************/
+/*! 
+    @brief Second half of the deep-sleep wake-up, waits for the PLL to
+           lock and runs the main clock from it again
+*/
+/**************************************************************************/
+void cpuWakeFinish (void)
+{
+  if (_cpuMultiplier == CPU_MULTIPLIER_IRC)
+  {
+    return;
+  }
+
+  if (SCB_PDRUNCFG & SCB_PDRUNCFG_SYSPLL_MASK)
+  {
+    // The PLL wasn't powered up on wake, so start from scratch
+    cpuPllSetup(_cpuMultiplier);
+    return;
+  }
+
+  while (!(SCB_PLLSTAT & SCB_PLLSTAT_LOCK));
+  cpuSelectMainClock(SCB_MAINCLKSEL_SOURCE_SYSPLLCLKOUT);
+}
+
+/**************************************************************************/
+/*! 
+    @brief Restores the clock selected with cpuSetClock after waking up
+           from deep-sleep (the hooks aren't called, since nothing else
+           has changed)
+*/
+/**************************************************************************/
+void cpuRestoreClock (void)
+{
+  cpuWakeStart();
+  cpuWakeFinish();
+}
+
+/**************************************************************************/
+/*! 
+    @brief Returns the current main clock in Hz (CFG_CPU_CCLK until
+           cpuSetClock is called)
+*/
+/**************************************************************************/
+uint32_t cpuGetClock (void)
+{
+  return _cpuClock;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Registers a function to be called when cpuSetClock changes
+           the main clock.  Registering the same hook twice has no
+           effect, so drivers can do this from their init functions.
+
+    @param[in]  hook
+                The function to call (see cpuClockHook_t)
+
+    @return     false if CPU_MAXCLOCKHOOKS hooks are already registered
+*/
+/**************************************************************************/
+bool cpuRegisterClockHook (cpuClockHook_t hook)
+{
+  uint8_t i;
+
+  for (i = 0; i < CPU_MAXCLOCKHOOKS; i++)
+  {
+    if (_cpuClockHooks[i] == hook)
+    {
+      return true;
+    }
+    if (_cpuClockHooks[i] == NULL)
+    {
+      _cpuClockHooks[i] = hook;
+      return true;
+    }
+  }
+
+  return false;
+}
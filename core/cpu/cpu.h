@@ -66,11 +66,30 @@ typedef enum
   CPU_MULTIPLIER_3,
   CPU_MULTIPLIER_4,
   CPU_MULTIPLIER_5,
-  CPU_MULTIPLIER_6
+  CPU_MULTIPLIER_6,
+  CPU_MULTIPLIER_IRC          // 12MHz internal RC oscillator, PLL off
 }
 cpuMultiplier_t;
 
-void cpuPllSetup (cpuMultiplier_t multiplier);
-void cpuInit (void);
+#define CPU_MAXCLOCKHOOKS   (8)
+
+/**************************************************************************/
+/*! 
+    @brief Called by cpuSetClock with interrupts disabled, once with
+           'changed' set to false before the main clock is switched and
+           once with it set to true afterwards.  'clock' is always the
+           new main clock in Hz.
+*/
+/**************************************************************************/
+typedef void (*cpuClockHook_t)(uint32_t clock, bool changed);
+
+void     cpuPllSetup (cpuMultiplier_t multiplier);
+void     cpuInit (void);
+bool     cpuSetClock (cpuMultiplier_t multiplier);
+void     cpuRestoreClock (void);
+void     cpuWakeStart (void);
+void     cpuWakeFinish (void);
+uint32_t cpuGetClock (void);
+bool     cpuRegisterClockHook (cpuClockHook_t hook);
 
 #endif
\ No newline at end of file
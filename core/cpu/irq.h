@@ -0,0 +1,98 @@
+/**************************************************************************/
+/*! 
+    @file     irq.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Interrupt priority helpers.  The priorities themselves are set in
+    projectconfig.h (CFG_IRQPRIO_...) and applied by each driver's init
+    with NVIC_SetPriority, and cpuInit sets the split between preemption
+    levels and sub-priorities (CFG_IRQ_SUBPRIOBITS).
+
+    irqMask/irqUnmask are critical sections that only hold off the
+    interrupts at or below a given level (with BASEPRI) rather than all
+    of them, so that the handlers above it keep their latency.
+
+    @section Example
+
+    @code 
+    #include "core/cpu/irq.h"
+
+    // Keep the UART and everything below it out, but not the radio
+    uint32_t mask = irqMask(CFG_IRQPRIO_UART);
+    ...
+    irqUnmask(mask);
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef _IRQ_H_
+#define _IRQ_H_
+
+#include "projectconfig.h"
+
+// BASEPRI/IP register value of a 0..7 priority
+#define IRQ_BASEPRI(priority)   ((priority) << (8 - __NVIC_PRIO_BITS))
+
+// PRIGROUP value that makes the low CFG_IRQ_SUBPRIOBITS of the three
+// implemented bits a sub-priority
+#define IRQ_PRIGROUP            (7 - __NVIC_PRIO_BITS + CFG_IRQ_SUBPRIOBITS)
+
+/**************************************************************************/
+/*! 
+    @brief  Masks every interrupt in the same preemption level as
+            'priority' or a lower one, and returns the previous mask for
+            irqUnmask.  Sections can nest, and interrupts in a higher
+            level still run.  The highest level (0) can't be masked this
+            way; use __disable_irq for that.
+*/
+/**************************************************************************/
+static inline uint32_t irqMask(uint32_t priority)
+{
+  uint32_t old = __get_BASEPRI();
+
+  __set_BASEPRI_MAX(IRQ_BASEPRI(priority));
+  return old;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Ends a section started with irqMask
+*/
+/**************************************************************************/
+static inline void irqUnmask(uint32_t old)
+{
+  __set_BASEPRI(old);
+}
+
+#endif
@@ -0,0 +1,172 @@
+/**************************************************************************/
+/*! 
+    @file     delay.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Blocking delays that don't depend on the compiler or its
+    optimisation level.  Short waits (delayCycles, delayUs) poll the DWT
+    cycle counter, or the systick down counter on parts without one, so
+    they are accurate to a few cycles and work with interrupts disabled.
+    Anything of a millisecond or more (delayMs) waits for systick ticks
+    with the core asleep in WFI in between.
+
+    delayMs still holds up the caller, so scheduler tasks (see
+    core/sched) should use schedStartTimer rather than wait.
+
+    @section Example
+
+    @code 
+    #include "core/delay/delay.h"
+    ...
+    delayInit();      // Called by systemInit
+
+    delayUs(10);      // 10us busy wait
+    delayMs(100);     // 100ms, sleeping between systick ticks
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "delay.h"
+#include "core/cpu/cpu.h"
+
+#include "core/systick/systick.h"
+
+#define DELAY_DEMCR_TRCENA      ((unsigned int) 0x01000000)
+#define DELAY_DWTCTRL_CYCCNTENA ((unsigned int) 0x00000001)
+
+static bool _delayCycleCounter = false;
+
+/**************************************************************************/
+/*! 
+    @brief  Enables the DWT cycle counter, and checks that it is running
+*/
+/**************************************************************************/
+void delayInit(void)
+{
+  volatile uint32_t start;
+
+  SCB_DEMCR |= DELAY_DEMCR_TRCENA;
+  DWT_CYCCNT = 0;
+  DWT_CTRL |= DELAY_DWTCTRL_CYCCNTENA;
+
+  start = DWT_CYCCNT;
+  __asm("nop");
+  __asm("nop");
+  _delayCycleCounter = (DWT_CYCCNT != start);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns true if the DWT cycle counter is used for the short
+            delays
+*/
+/**************************************************************************/
+bool delayHasCycleCounter(void)
+{
+  return _delayCycleCounter;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Waits for at least the specified number of CPU cycles
+
+    @note   Without the DWT cycle counter the systick down counter is
+            polled instead, so the systick timer must be running.
+*/
+/**************************************************************************/
+void delayCycles(uint32_t cycles)
+{
+  uint32_t start, prev, cur, elapsed;
+
+  if (_delayCycleCounter)
+  {
+    start = DWT_CYCCNT;
+    while ((DWT_CYCCNT - start) < cycles);
+    return;
+  }
+
+  // Add up how far the down counter has moved, across reloads
+  elapsed = 0;
+  prev = SYSTICK_STCURR;
+  while (elapsed < cycles)
+  {
+    cur = SYSTICK_STCURR;
+    elapsed += (cur <= prev) ? prev - cur : prev + SYSTICK_STRELOAD + 1 - cur;
+    prev = cur;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Waits for at least the specified number of microseconds
+            (busy wait, use delayMs for longer delays)
+*/
+/**************************************************************************/
+void delayUs(uint32_t us)
+{
+  uint32_t cyclesPerUs = (cpuGetClock()/SCB_SYSAHBCLKDIV) / 1000000;
+  uint32_t maxUs = 0x7FFFFFFF / cyclesPerUs;
+
+  while (us > maxUs)
+  {
+    delayCycles(maxUs * cyclesPerUs);
+    us -= maxUs;
+  }
+  delayCycles(us * cyclesPerUs);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Waits for at least the specified number of milliseconds,
+            sleeping in WFI between systick ticks
+
+    @warning  Interrupts must be enabled, since the systick interrupt
+              both wakes the core and counts the time
+*/
+/**************************************************************************/
+void delayMs(uint32_t ms)
+{
+  // One more tick since the current one has already started
+  uint32_t ticks = (ms + CFG_SYSTICK_DELAY_IN_MS - 1) / CFG_SYSTICK_DELAY_IN_MS + 1;
+  uint32_t start = systickGetTicks();
+
+  if (!ms)
+  {
+    return;
+  }
+
+  while ((systickGetTicks() - start) < ticks)
+  {
+    __asm volatile ("wfi");
+  }
+}
@@ -0,0 +1,450 @@
+/**************************************************************************/
+/*! 
+    @file     dsp.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Small fixed point (Q15) DSP kernels to reduce blocks of ADC samples
+    on the device: boxcar decimation, FIR filtering, RMS/peak and a
+    radix-2 real FFT.  Every kernel works in place on the caller's
+    buffer, so a block captured with adcReadBlock or adcTriggerStart
+    can be converted with dspFromAdc and reduced without a second copy.
+
+    The Cortex-M3 has no SIMD instructions, so the kernels stick to
+    16x16->32 bit multiplies (MUL/MLA) and 32-bit accumulators, and the
+    FFT scales by 1/2 on every stage so that it can never overflow.
+    The sine table for the FFT twiddle factors is const data in flash.
+
+    @code
+    uint16_t samples[128];
+    int16_t *q15;
+
+    adcReadBlock(0, samples, 128);
+    q15 = dspFromAdc(samples, 128);
+    dspFftReal(q15, 128);
+    dspFftMagnitude(q15, 128);    // q15[0..63] now holds the spectrum
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "dsp.h"
+
+#define DSP_QUARTER       (DSP_FFT_MAXSIZE / 4)
+
+/* sin(2 * pi * i / DSP_FFT_MAXSIZE) in Q15 for the first quarter wave */
+static const int16_t _dspSinTable[DSP_QUARTER + 1] =
+{
+      0,   804,  1608,  2411,  3212,  4011,  4808,  5602,
+   6393,  7180,  7962,  8740,  9512, 10279, 11039, 11793,
+  12540, 13279, 14010, 14733, 15447, 16151, 16846, 17531,
+  18205, 18868, 19520, 20160, 20788, 21403, 22006, 22595,
+  23170, 23732, 24279, 24812, 25330, 25833, 26320, 26791,
+  27246, 27684, 28106, 28511, 28899, 29269, 29622, 29957,
+  30274, 30572, 30853, 31114, 31357, 31581, 31786, 31972,
+  32138, 32286, 32413, 32522, 32610, 32679, 32729, 32758,
+  32767
+};
+
+/**************************************************************************/
+/*! 
+    @brief  Returns sin(2 * pi * i / DSP_FFT_MAXSIZE) in Q15
+*/
+/**************************************************************************/
+static int16_t dspSin (uint32_t i)
+{
+  uint32_t r;
+
+  i &= DSP_FFT_MAXSIZE - 1;
+  r = i % DSP_QUARTER;
+  switch (i / DSP_QUARTER)
+  {
+    case 0:
+      return _dspSinTable[r];
+    case 1:
+      return _dspSinTable[DSP_QUARTER - r];
+    case 2:
+      return -_dspSinTable[r];
+    default:
+      return -_dspSinTable[DSP_QUARTER - r];
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns cos(2 * pi * i / DSP_FFT_MAXSIZE) in Q15
+*/
+/**************************************************************************/
+static int16_t dspCos (uint32_t i)
+{
+  return dspSin(i + DSP_QUARTER);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Clamps a 32-bit value to the Q15 range
+*/
+/**************************************************************************/
+static int16_t dspSaturate (int32_t value)
+{
+  if (value > 32767) return 32767;
+  if (value < -32768) return -32768;
+  return (int16_t)value;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Converts a block of 10-bit ADC results to signed Q15 in
+                place (mid scale becomes 0, full scale becomes ~1.0)
+
+    @return     The same buffer, as Q15 samples
+*/
+/**************************************************************************/
+int16_t *dspFromAdc (uint16_t *buffer, uint32_t len)
+{
+  int16_t *out = (int16_t *)buffer;
+  uint32_t i;
+
+  for (i = 0; i < len; i++)
+  {
+    out[i] = (int16_t)(((int32_t)(buffer[i] & 0x3FF) - 512) << 6);
+  }
+
+  return out;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Averages every 'factor' samples into one, in place.
+
+    This is a first order CIC (boxcar) decimator: the output is the
+    mean of each group of 'factor' input samples, which filters out
+    noise above the new sample rate before it is reduced.  Any samples
+    left over at the end of the block are dropped.
+
+    @return     The number of samples left in the buffer (len / factor)
+*/
+/**************************************************************************/
+uint32_t dspDecimate (int16_t *buffer, uint32_t len, uint16_t factor)
+{
+  uint32_t i, j, out = 0;
+  int32_t sum;
+
+  if (factor < 2)
+  {
+    return len;
+  }
+
+  for (i = 0; i + factor <= len; i += factor)
+  {
+    sum = 0;
+    for (j = 0; j < factor; j++)
+    {
+      sum += buffer[i + j];
+    }
+    buffer[out++] = (int16_t)(sum / factor);
+  }
+
+  return out;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Prepares an FIR filter and clears its history
+
+    @param[in]  fir
+                The filter state
+    @param[in]  coeffs
+                'taps' Q15 coefficients (coeffs[0] applies to the
+                newest sample)
+    @param[in]  delay
+                'taps' samples of RAM for the filter history
+    @param[in]  taps
+                The filter length
+*/
+/**************************************************************************/
+void dspFirInit (dspFir_t *fir, const int16_t *coeffs, int16_t *delay, uint16_t taps)
+{
+  uint16_t i;
+
+  fir->coeffs = coeffs;
+  fir->delay = delay;
+  fir->taps = taps;
+  fir->index = 0;
+  for (i = 0; i < taps; i++)
+  {
+    delay[i] = 0;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Runs a block of samples through an FIR filter in place.
+                The history is kept in the filter state, so consecutive
+                blocks are filtered as one continuous stream.
+*/
+/**************************************************************************/
+void dspFir (dspFir_t *fir, int16_t *buffer, uint32_t len)
+{
+  const int16_t *c;
+  int16_t *d = fir->delay;
+  uint32_t i, t, idx;
+  int32_t acc;
+
+  for (i = 0; i < len; i++)
+  {
+    /* Newest sample goes to d[index], older ones are at lower indices */
+    idx = fir->index;
+    d[idx] = buffer[i];
+
+    c = fir->coeffs;
+    acc = 0;
+    for (t = idx + 1; t-- > 0; )
+    {
+      acc += (int32_t)*c++ * d[t];
+    }
+    for (t = fir->taps; t-- > idx + 1; )
+    {
+      acc += (int32_t)*c++ * d[t];
+    }
+
+    buffer[i] = dspSaturate(acc >> 15);
+    fir->index = (idx + 1 == fir->taps) ? 0 : idx + 1;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Integer square root (rounded down)
+*/
+/**************************************************************************/
+uint16_t dspSqrt (uint32_t value)
+{
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+
+  while (bit > value)
+  {
+    bit >>= 2;
+  }
+
+  while (bit)
+  {
+    if (value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return (uint16_t)root;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Returns the RMS value of a block of Q15 samples
+*/
+/**************************************************************************/
+uint16_t dspRms (const int16_t *buffer, uint32_t len)
+{
+  uint64_t sum = 0;
+  uint32_t i;
+
+  if (!len)
+  {
+    return 0;
+  }
+
+  for (i = 0; i < len; i++)
+  {
+    sum += (uint32_t)((int32_t)buffer[i] * buffer[i]);
+  }
+
+  return dspSqrt((uint32_t)(sum / len));
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Returns the largest absolute value in a block of Q15
+                samples
+*/
+/**************************************************************************/
+uint16_t dspPeak (const int16_t *buffer, uint32_t len)
+{
+  uint16_t peak = 0;
+  int32_t v;
+  uint32_t i;
+
+  for (i = 0; i < len; i++)
+  {
+    v = buffer[i] < 0 ? -(int32_t)buffer[i] : buffer[i];
+    if (v > peak)
+    {
+      peak = (uint16_t)v;
+    }
+  }
+
+  return peak;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Real FFT of 'len' Q15 samples, in place.
+
+    The samples are treated as len/2 complex values, run through a
+    radix-2 complex FFT and then split into the spectrum of the real
+    signal.  On return buffer[2k] and buffer[2k+1] hold the real and
+    imaginary parts of bin k (k = 1..len/2-1), buffer[0] holds the DC
+    bin and buffer[1] the (real) len/2 bin.  The results are scaled by
+    1/len, so a full scale sine gives a bin magnitude of ~0.5.
+
+    @param[in]  buffer
+                The samples, replaced by the spectrum
+    @param[in]  len
+                The number of samples, a power of 2 (4..DSP_FFT_MAXSIZE)
+
+    @return     false if len isn't supported
+*/
+/**************************************************************************/
+bool dspFftReal (int16_t *buffer, uint32_t len)
+{
+  uint32_t n = len >> 1;          // Complex points
+  uint32_t i, j, k, m, size, half, step;
+  int32_t wr, wi, tr, ti, ar, ai, br, bi, er, ei, or, oi;
+  int16_t t;
+
+  if ((len < 4) || (len > DSP_FFT_MAXSIZE) || (len & (len - 1)))
+  {
+    return false;
+  }
+
+  /* Bit reverse the complex points */
+  for (i = 1, j = 0; i < n; i++)
+  {
+    for (m = n >> 1; j & m; m >>= 1)
+    {
+      j ^= m;
+    }
+    j |= m;
+    if (i < j)
+    {
+      t = buffer[2*i];   buffer[2*i]   = buffer[2*j];   buffer[2*j]   = t;
+      t = buffer[2*i+1]; buffer[2*i+1] = buffer[2*j+1]; buffer[2*j+1] = t;
+    }
+  }
+
+  /* Butterflies, halving every stage so the output is scaled by 1/n */
+  for (size = 2; size <= n; size <<= 1)
+  {
+    half = size >> 1;
+    step = DSP_FFT_MAXSIZE / size;
+    for (j = 0; j < half; j++)
+    {
+      wr = dspCos(j * step);
+      wi = -dspSin(j * step);
+      for (i = j; i < n; i += size)
+      {
+        k = i + half;
+        tr = (wr * buffer[2*k] - wi * buffer[2*k+1]) >> 15;
+        ti = (wr * buffer[2*k+1] + wi * buffer[2*k]) >> 15;
+        ar = buffer[2*i];
+        ai = buffer[2*i+1];
+        buffer[2*k]   = (int16_t)((ar - tr) >> 1);
+        buffer[2*k+1] = (int16_t)((ai - ti) >> 1);
+        buffer[2*i]   = (int16_t)((ar + tr) >> 1);
+        buffer[2*i+1] = (int16_t)((ai + ti) >> 1);
+      }
+    }
+  }
+
+  /* Split into the real spectrum, X[k] = (E[k] + W^k * O[k]) / 2 with
+     E = (Z[k] + conj(Z[n-k])) / 2 and O = -j * (Z[k] - conj(Z[n-k])) / 2 */
+  ar = buffer[0];
+  ai = buffer[1];
+  buffer[0] = (int16_t)((ar + ai) >> 1);
+  buffer[1] = (int16_t)((ar - ai) >> 1);
+
+  step = DSP_FFT_MAXSIZE / len;
+  for (k = 1; k <= n / 2; k++)
+  {
+    m = n - k;
+    ar = buffer[2*k];
+    ai = buffer[2*k+1];
+    br = buffer[2*m];
+    bi = buffer[2*m+1];
+
+    /* Even and odd parts (both already halved) */
+    er = (ar + br) >> 1;
+    ei = (ai - bi) >> 1;
+    or = (ai + bi) >> 1;
+    oi = (br - ar) >> 1;
+
+    wr = dspCos(k * step);
+    wi = -dspSin(k * step);
+    tr = (wr * or - wi * oi) >> 15;
+    ti = (wr * oi + wi * or) >> 15;
+
+    /* X[k] and X[n-k] = conj(E - W^k * O) */
+    buffer[2*k]   = (int16_t)((er + tr) >> 1);
+    buffer[2*k+1] = (int16_t)((ei + ti) >> 1);
+    buffer[2*m]   = (int16_t)((er - tr) >> 1);
+    buffer[2*m+1] = (int16_t)((ti - ei) >> 1);
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Converts the output of dspFftReal to len/2 bin magnitudes
+                in place (buffer[k] = |X[k]|, with buffer[0] the DC bin).
+                The len/2 bin is dropped.
+*/
+/**************************************************************************/
+void dspFftMagnitude (int16_t *buffer, uint32_t len)
+{
+  uint32_t k;
+  int32_t re, im;
+
+  buffer[0] = buffer[0] < 0 ? -buffer[0] : buffer[0];
+  for (k = 1; k < len / 2; k++)
+  {
+    re = buffer[2*k];
+    im = buffer[2*k+1];
+    buffer[k] = (int16_t)dspSqrt((uint32_t)(re * re + im * im));
+  }
+}
@@ -0,0 +1,70 @@
+/**************************************************************************/
+/*! 
+    @file     dsp.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef _DSP_H_
+#define _DSP_H_
+
+#include "projectconfig.h"
+
+/* Largest real FFT size (the twiddle table in dsp.c is built for it) */
+#define DSP_FFT_MAXSIZE   (256)
+
+/**************************************************************************/
+/*! 
+    FIR filter state.  'delay' must point to 'taps' samples of RAM that
+    hold the filter history between blocks, and 'coeffs' to 'taps' Q15
+    coefficients (can be const data in flash).
+*/
+/**************************************************************************/
+typedef struct
+{
+  const int16_t *coeffs;
+  int16_t       *delay;
+  uint16_t      taps;
+  uint16_t      index;
+} dspFir_t;
+
+int16_t *dspFromAdc ( uint16_t *buffer, uint32_t len );
+uint32_t dspDecimate ( int16_t *buffer, uint32_t len, uint16_t factor );
+void     dspFirInit ( dspFir_t *fir, const int16_t *coeffs, int16_t *delay, uint16_t taps );
+void     dspFir ( dspFir_t *fir, int16_t *buffer, uint32_t len );
+uint16_t dspRms ( const int16_t *buffer, uint32_t len );
+uint16_t dspPeak ( const int16_t *buffer, uint32_t len );
+uint16_t dspSqrt ( uint32_t value );
+bool     dspFftReal ( int16_t *buffer, uint32_t len );
+void     dspFftMagnitude ( int16_t *buffer, uint32_t len );
+
+#endif
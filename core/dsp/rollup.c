@@ -0,0 +1,313 @@
+/**************************************************************************/
+/*! 
+    @file     rollup.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Reduces a stream of samples to min/max/mean/count summaries over
+    fixed windows, so that a node can send one summary a second (or a
+    minute, or an hour) instead of every sample.
+
+    Each metric has up to ROLLUP_MAXLEVELS windows, each one a multiple
+    of the one below it.  Samples only go into the shortest window, and
+    when a window closes its totals are merged into the next one up, so
+    every window costs the same few words of RAM however many samples
+    it covers.  The sums are 64-bit integers, so the means of long
+    windows are exact.  Windows are aligned to multiples of their
+    length since boot, and a window that got no samples isn't
+    reported.
+
+    Windows are closed by rollupAdd, and by rollupPoll for metrics that
+    stop getting samples: call it regularly (at least once per shortest
+    window), e.g. from a scheduler timer.  rollupEncode packs a summary
+    into at most ROLLUP_ENCODEDMAX bytes of varints (see
+    core/compress/varint.c), typically 6-10, small enough to batch
+    many of them into one radio frame with chb_aggr_write.
+
+    @section Example
+
+    @code 
+    #include "core/dsp/rollup.h"
+
+    static const uint32_t periods[3] = { 1000, 60000, 3600000 };
+    static rollupMetric_t temperature;
+
+    static void sendSummary(const rollupSummary_t *summary, void *arg)
+    {
+      uint8_t buffer[ROLLUP_ENCODEDMAX];
+
+      // Only send the minute and hour windows over the radio
+      if (summary->level > 0)
+      {
+        chb_aggr_write(0x0000, buffer, rollupEncode(summary, buffer));
+      }
+    }
+
+    rollupInit(&temperature, 1, periods, 3, sendSummary, NULL);
+    ...
+    rollupAdd(&temperature, lm75bReading);
+
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "rollup.h"
+
+#include "core/systick/systick.h"
+#include "core/compress/varint.h"
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the current systick time in ms
+*/
+/**************************************************************************/
+static uint32_t rollupNow(void)
+{
+  return systickGetTicks() * CFG_SYSTICK_DELAY_IN_MS;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Empties a window
+*/
+/**************************************************************************/
+static void rollupClear(rollupWindow_t *window)
+{
+  window->sum = 0;
+  window->count = 0;
+  window->min = INT32_MAX;
+  window->max = INT32_MIN;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reports a closed window and merges it into the next level
+*/
+/**************************************************************************/
+static void rollupClose(rollupMetric_t *metric, uint8_t level)
+{
+  rollupWindow_t *window = &metric->window[level];
+  rollupWindow_t *up;
+  rollupSummary_t summary;
+  int64_t half;
+
+  if (!window->count)
+  {
+    return;
+  }
+
+  if (metric->callback)
+  {
+    // Round the mean to the nearest integer for both signs
+    half = window->count / 2;
+    summary.id = metric->id;
+    summary.level = level;
+    summary.start = metric->start[level];
+    summary.count = window->count;
+    summary.min = window->min;
+    summary.max = window->max;
+    summary.mean = (int32_t)((window->sum + (window->sum < 0 ? -half : half)) / (int64_t)window->count);
+    metric->callback(&summary, metric->arg);
+  }
+
+  if (level + 1 < metric->levels)
+  {
+    up = &metric->window[level + 1];
+    up->sum += window->sum;
+    up->count += window->count;
+    if (window->min < up->min) up->min = window->min;
+    if (window->max > up->max) up->max = window->max;
+  }
+
+  rollupClear(window);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Closes the windows that have ended by 'now', shortest first
+            so that each one is merged into the window it belongs to
+            before that one closes
+*/
+/**************************************************************************/
+static void rollupUpdate(rollupMetric_t *metric, uint32_t now)
+{
+  uint8_t level;
+
+  for (level = 0; level < metric->levels; level++)
+  {
+    if (now - metric->start[level] < metric->period[level])
+    {
+      // The longer windows can't have ended either
+      break;
+    }
+    rollupClose(metric, level);
+    metric->start[level] = now - now % metric->period[level];
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Sets up a metric
+
+    @param[in]  metric
+                Metric to initialise
+    @param[in]  id
+                ID reported in the summaries
+    @param[in]  periodsMs
+                Window lengths in ms, shortest first.  Each one must be
+                a multiple of the one before.
+    @param[in]  levels
+                Number of windows (1..ROLLUP_MAXLEVELS)
+    @param[in]  callback
+                Called with each closed window (can be NULL)
+    @param[in]  arg
+                Passed to the callback
+
+    @return false if the window lengths aren't valid
+*/
+/**************************************************************************/
+bool rollupInit(rollupMetric_t *metric, uint16_t id, const uint32_t *periodsMs, uint8_t levels, rollupCallback_t callback, void *arg)
+{
+  uint32_t now = rollupNow();
+  uint8_t level;
+
+  if (!levels || levels > ROLLUP_MAXLEVELS)
+  {
+    return false;
+  }
+  for (level = 0; level < levels; level++)
+  {
+    if (!periodsMs[level] || (level && (periodsMs[level] % periodsMs[level - 1])))
+    {
+      return false;
+    }
+  }
+
+  metric->id = id;
+  metric->levels = levels;
+  metric->callback = callback;
+  metric->arg = arg;
+  for (level = 0; level < levels; level++)
+  {
+    metric->period[level] = periodsMs[level];
+    metric->start[level] = now - now % periodsMs[level];
+    rollupClear(&metric->window[level]);
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Adds a sample to the shortest window, after closing any
+            windows that have ended.  Must not be called from interrupts
+            (the callback would run there).
+*/
+/**************************************************************************/
+void rollupAdd(rollupMetric_t *metric, int32_t value)
+{
+  rollupWindow_t *window = &metric->window[0];
+
+  rollupUpdate(metric, rollupNow());
+
+  window->sum += value;
+  window->count++;
+  if (value < window->min) window->min = value;
+  if (value > window->max) window->max = value;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Closes any windows that have ended without a new sample
+*/
+/**************************************************************************/
+void rollupPoll(rollupMetric_t *metric)
+{
+  rollupUpdate(metric, rollupNow());
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Packs a summary into varints: id, level, count, min (zigzag),
+            max - min and mean - min
+
+    @return the number of bytes written (at most ROLLUP_ENCODEDMAX)
+*/
+/**************************************************************************/
+uint8_t rollupEncode(const rollupSummary_t *summary, uint8_t *buffer)
+{
+  uint8_t len = 0;
+
+  len += varintPut(&buffer[len], summary->id);
+  len += varintPut(&buffer[len], summary->level);
+  len += varintPut(&buffer[len], summary->count);
+  len += varintPut(&buffer[len], varintZigzag(summary->min));
+  len += varintPut(&buffer[len], (uint32_t)summary->max - (uint32_t)summary->min);
+  len += varintPut(&buffer[len], (uint32_t)summary->mean - (uint32_t)summary->min);
+
+  return len;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Unpacks a summary written by rollupEncode.  'start' isn't
+            sent and is set to 0.
+
+    @return the number of bytes used, or 0 if the data is truncated
+*/
+/**************************************************************************/
+uint8_t rollupDecode(const uint8_t *buffer, uint8_t len, rollupSummary_t *summary)
+{
+  uint32_t values[6];
+  uint8_t used = 0;
+  uint8_t i, n;
+
+  for (i = 0; i < 6; i++)
+  {
+    n = varintGet(&buffer[used], len - used, &values[i]);
+    if (!n)
+    {
+      return 0;
+    }
+    used += n;
+  }
+
+  summary->id = (uint16_t)values[0];
+  summary->level = (uint8_t)values[1];
+  summary->start = 0;
+  summary->count = values[2];
+  summary->min = varintUnzigzag(values[3]);
+  summary->max = (int32_t)((uint32_t)summary->min + values[4]);
+  summary->mean = (int32_t)((uint32_t)summary->min + values[5]);
+
+  return used;
+}
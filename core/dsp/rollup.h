@@ -0,0 +1,103 @@
+/**************************************************************************/
+/*! 
+    @file     rollup.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef _ROLLUP_H_
+#define _ROLLUP_H_
+
+#include "projectconfig.h"
+
+/* Most windows per metric (e.g. 1s, 1min, 1h) */
+#define ROLLUP_MAXLEVELS    (3)
+
+/* Longest output of rollupEncode (six varints) */
+#define ROLLUP_ENCODEDMAX   (30)
+
+/**************************************************************************/
+/*! 
+    A closed window, as passed to the callback.  'mean' is rounded to
+    the nearest integer, 'start' is the systick time in ms at which the
+    window opened.
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint16_t id;                        // Metric ID given to rollupInit
+  uint8_t  level;                     // Window index (0 = shortest)
+  uint32_t start;
+  uint32_t count;                     // Samples in the window (never 0)
+  int32_t  min;
+  int32_t  max;
+  int32_t  mean;
+} rollupSummary_t;
+
+typedef void (*rollupCallback_t)(const rollupSummary_t *summary, void *arg);
+
+/**************************************************************************/
+/*! 
+    Running totals of one window
+*/
+/**************************************************************************/
+typedef struct
+{
+  int64_t  sum;
+  uint32_t count;
+  int32_t  min;
+  int32_t  max;
+} rollupWindow_t;
+
+/**************************************************************************/
+/*! 
+    One metric and its windows.  Metrics are statically allocated by
+    the caller, all of the fields are private to rollup.c.
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint16_t         id;
+  uint8_t          levels;
+  uint32_t         period[ROLLUP_MAXLEVELS];  // Window lengths in ms
+  uint32_t         start[ROLLUP_MAXLEVELS];   // Opening times in ms
+  rollupWindow_t   window[ROLLUP_MAXLEVELS];
+  rollupCallback_t callback;
+  void             *arg;
+} rollupMetric_t;
+
+bool    rollupInit ( rollupMetric_t *metric, uint16_t id, const uint32_t *periodsMs, uint8_t levels, rollupCallback_t callback, void *arg );
+void    rollupAdd ( rollupMetric_t *metric, int32_t value );
+void    rollupPoll ( rollupMetric_t *metric );
+uint8_t rollupEncode ( const rollupSummary_t *summary, uint8_t *buffer );
+uint8_t rollupDecode ( const uint8_t *buffer, uint8_t len, rollupSummary_t *summary );
+
+#endif
@@ -9,6 +9,13 @@
 	
     Controls the general purpose digital IO.
 
+    Pin interrupts are dispatched through a small table: drivers and
+    applications register a callback with gpioAttachInterrupt, and the
+    port's interrupt handler reads the masked interrupt status once,
+    clears it, and calls the callback of each pending pin, highest pin
+    first (one count-leading-zeros per pin, so the time to reach a
+    callback doesn't depend on how many pins are attached).
+
     @section LICENSE
 
     Software License Agreement (BSD License)
@@ -42,91 +49,84 @@
 
 #include "gpio.h"
 
-#ifdef CFG_CHIBI
-#include "drivers/chibi/chb_drvr.h"
-volatile uint32_t chibi_counter  = 0;
-#endif
+/* Masked interrupt status and interrupt clear registers of a port */
+#define GPIO_MIS(portNum)   (*(pREG32 ((uint32_t)&GPIO_GPIO0MIS + ((portNum) << 16))))
+#define GPIO_IC(portNum)    (*(pREG32 ((uint32_t)&GPIO_GPIO0IC + ((portNum) << 16))))
 
 static bool _gpioInitialised = false;
 
+/* Callback of each attached pin: _gpioIntSlot holds the index into      *
+ * _gpioIntCallbacks plus one, or 0 if nothing is attached to the pin.   */
+static gpioIntCallback_t _gpioIntCallbacks[GPIO_MAXCALLBACKS];
+static uint8_t _gpioIntSlot[4][12];
+
 /**************************************************************************/
 /*! 
-    @brief IRQ Handler for GPIO port 0 (currently checks pin 0.1)
+    @brief  Clears and dispatches the pending interrupts of a port.
+            Pins without a callback are only cleared.
 */
 /**************************************************************************/
-void PIOINT0_IRQHandler(void)
+static inline void gpioDispatch(uint32_t portNum)
 {
-  uint32_t regVal;
+  uint32_t status, bitPos;
+  uint8_t slot;
+
+  // Clear first, so that an edge that comes in while a callback runs
+  // raises the interrupt again
+  status = GPIO_MIS(portNum);
+  GPIO_IC(portNum) = status;
 
-  regVal = gpioIntStatus(0, 1);
-  if (regVal)
+  while (status)
   {
-    gpioIntClear(0, 1);
-  }		
-  return;
+    bitPos = 31 - __builtin_clz(status);
+    status &= ~(1 << bitPos);
+    slot = _gpioIntSlot[portNum][bitPos];
+    if (slot)
+    {
+      _gpioIntCallbacks[slot - 1]();
+    }
+  }
 }
 
 /**************************************************************************/
 /*! 
-    @brief IRQ Handler for GPIO port 1 (currently checks pin 1.1)
+    @brief IRQ Handler for GPIO port 0
 */
 /**************************************************************************/
-void PIOINT1_IRQHandler(void)
+void PIOINT0_IRQHandler(void)
 {
-  uint32_t regVal;
-
-#ifdef CFG_CHIBI
-  // Check for interrupt on 1.8
-  regVal = gpioIntStatus(1, 8);
-  if (regVal)
-  {
-    chibi_counter++;
-    chb_ISR_Handler();
-    gpioIntClear(1, 8);
-  }		
-#else
-  regVal = gpioIntStatus(1, 1);
-  if ( regVal )
-  {
-    gpioIntClear(1, 1);
-  }
-#endif
+  gpioDispatch(0);
+}
 
-  return;
+/**************************************************************************/
+/*! 
+    @brief IRQ Handler for GPIO port 1 (the Chibi radio is on 1.8 and
+           the touch screen pen down on 1.0)
+*/
+/**************************************************************************/
+void PIOINT1_IRQHandler(void)
+{
+  gpioDispatch(1);
 }
 
 /**************************************************************************/
 /*! 
-    @brief IRQ Handler for GPIO port 2 (currently checks pin 2.1)
+    @brief IRQ Handler for GPIO port 2
 */
 /**************************************************************************/
 void PIOINT2_IRQHandler(void)
 {
-  uint32_t regVal;
-
-  regVal = gpioIntStatus(2, 1);
-  if ( regVal )
-  {
-    gpioIntClear(2, 1);
-  }		
-  return;
+  gpioDispatch(2);
 }
 
 /**************************************************************************/
 /*! 
-    @brief IRQ Handler for GPIO port 3 (currently checks pin 3.1)
+    @brief IRQ Handler for GPIO port 3 (SD card detect on 3.0)
 */
 /**************************************************************************/
 void PIOINT3_IRQHandler(void)
 {
-  uint32_t regVal;
-
-  regVal = gpioIntStatus(3, 1);
-  if ( regVal )
-  {
-    gpioIntClear(3, 1);
-  }		
-  return;
+  gpioDispatch(3);
 }
 
 /**************************************************************************/
@@ -141,6 +141,11 @@ void gpioInit (void)
   SCB_SYSAHBCLKCTRL |= (SCB_SYSAHBCLKCTRL_GPIO);
 
   /* Set up NVIC when I/O pins are configured as external interrupts. */
+  /* Port 1 has the radio's IRQ pin, so it gets its own priority.     */
+  NVIC_SetPriority(EINT0_IRQn, CFG_IRQPRIO_GPIO);
+  NVIC_SetPriority(EINT1_IRQn, CFG_IRQPRIO_RADIO);
+  NVIC_SetPriority(EINT2_IRQn, CFG_IRQPRIO_GPIO);
+  NVIC_SetPriority(EINT3_IRQn, CFG_IRQPRIO_GPIO);
   NVIC_EnableIRQ(EINT0_IRQn);
   NVIC_EnableIRQ(EINT1_IRQn);
   NVIC_EnableIRQ(EINT2_IRQn);
@@ -248,26 +253,37 @@ void gpioSetValue (uint32_t portNum, uint32_t bitPos, uint32_t bitVal)
 {
   if (!_gpioInitialised) gpioInit();
 
-  // Get the appropriate register (handled this way to optimise code size)
-  REG32 *gpiodata = &GPIO_GPIO0DATA;
-  switch (portNum)
-  {
-    case 0:
-      gpiodata = &GPIO_GPIO0DATA;
-      break;
-    case 1:
-      gpiodata = &GPIO_GPIO1DATA;
-      break;
-    case 2:
-      gpiodata = &GPIO_GPIO2DATA;
-      break;
-    case 3:
-      gpiodata = &GPIO_GPIO3DATA;
-      break;
-  }
+  // Only the selected pin is written (see gpioWritePortMasked)
+  GPIO_MASKEDDATA(portNum & 3, 1 << bitPos) = (bitVal == 1) ? (1 << bitPos) : 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Sets several pins on the same port with a single write, using
+           the address masked GPIODATA access.  Pins outside 'mask' are
+           left unchanged.  For constant pins, GPIO_WRITEMASKED in gpio.h
+           does the same thing inline.
+
+    @param[in]  portNum
+                The port number (0..3)
+    @param[in]  mask
+                The pins to update (bits 0..11)
+    @param[in]  value
+                The new values for the pins in 'mask' (1 = high)
+
+    @section Example
+
+    @code
+    // Set 3.0 and 3.2 high and 3.1 and 3.3 low in one write
+    gpioWritePortMasked(3, 0x0F, 0x05);
+    @endcode
+*/
+/**************************************************************************/
+void gpioWritePortMasked (uint32_t portNum, uint32_t mask, uint32_t value)
+{
+  if (!_gpioInitialised) gpioInit();
 
-  // Toggle value
-  bitVal == 1 ? (*gpiodata |= (1 << bitPos)) : (*gpiodata &= ~(1 << bitPos));
+  GPIO_MASKEDDATA(portNum & 3, mask) = value;
 }
 
 /**************************************************************************/
@@ -339,18 +355,18 @@ void gpioSetInterrupt (uint32_t portNum, uint32_t bitPos, gpioInterruptSense_t s
       break;
   }
 
-  if (gpioInterruptSense_Edge)
+  if (sense == gpioInterruptSense_Edge)
   {
     *gpiois &= ~(0x1<<bitPos);
     /* single or double only applies when sense is 0(edge trigger). */
-    gpioInterruptEdge_Single ? (*gpioibe &= ~(0x1<<bitPos)) : (*gpioibe |= (0x1<<bitPos));
+    edge == gpioInterruptEdge_Single ? (*gpioibe &= ~(0x1<<bitPos)) : (*gpioibe |= (0x1<<bitPos));
   }
   else
   {
     *gpiois |= (0x1<<bitPos);
   }
 
-  gpioInterruptEvent_ActiveHigh ? (*gpioiev &= ~(0x1<<bitPos)) : (*gpioiev |= (0x1<<bitPos));
+  event == gpioInterruptEvent_ActiveHigh ? (*gpioiev |= (0x1<<bitPos)) : (*gpioiev &= ~(0x1<<bitPos));
 
   return;
 }
@@ -507,6 +523,106 @@ void gpioIntClear (uint32_t portNum, uint32_t bitPos)
   return;
 }
 
+/**************************************************************************/
+/*! 
+    @brief Configures a pin interrupt and attaches a callback to it
+
+    The callback runs in interrupt context, from the port's interrupt
+    handler.  Attaching a new callback to a pin replaces the old one.
+
+    @param[in]  portNum
+                The port number (0..3)
+    @param[in]  bitPos
+                The bit position (0..11)
+    @param[in]  sense
+                Whether the interrupt should be configured as edge or
+                level sensitive
+    @param[in]  edge
+                Whether one edge or both trigger an interrupt
+    @param[in]  event
+                Whether the rising or the falling edge (high or low)
+                should be used to trigger the interrupt
+    @param[in]  callback
+                The function to call when the pin interrupts
+
+    @return     false if the pin is invalid or all GPIO_MAXCALLBACKS
+                slots are in use
+
+    @section Example
+
+    @code
+    void buttonPressed(void)
+    {
+      ...
+    }
+
+    // Call buttonPressed on a falling edge on pin 2.1
+    gpioSetDir(2, 1, gpioDirection_Input);
+    gpioAttachInterrupt (2, 1,
+                         gpioInterruptSense_Edge,
+                         gpioInterruptEdge_Single,
+                         gpioInterruptEvent_ActiveLow,
+                         buttonPressed);
+    @endcode
+*/
+/**************************************************************************/
+bool gpioAttachInterrupt (uint32_t portNum, uint32_t bitPos, gpioInterruptSense_t sense, gpioInterruptEdge_t edge, gpioInterruptEvent_t event, gpioIntCallback_t callback)
+{
+  uint8_t i, slot;
+
+  if ((portNum > 3) || (bitPos > 11) || (callback == NULL)) return false;
+  if (!_gpioInitialised) gpioInit();
+
+  slot = _gpioIntSlot[portNum][bitPos];
+  if (!slot)
+  {
+    for (i = 0; i < GPIO_MAXCALLBACKS; i++)
+    {
+      if (_gpioIntCallbacks[i] == NULL) break;
+    }
+    if (i == GPIO_MAXCALLBACKS) return false;
+    slot = i + 1;
+  }
+
+  // Keep the pin masked while the table is updated
+  gpioIntDisable(portNum, bitPos);
+  _gpioIntCallbacks[slot - 1] = callback;
+  _gpioIntSlot[portNum][bitPos] = slot;
+
+  // Drop any edge latched before the pin was configured
+  gpioSetInterrupt(portNum, bitPos, sense, edge, event);
+  gpioIntClear(portNum, bitPos);
+  gpioIntEnable(portNum, bitPos);
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Disables a pin interrupt and frees its callback slot
+
+    @param[in]  portNum
+                The port number (0..3)
+    @param[in]  bitPos
+                The bit position (0..11)
+*/
+/**************************************************************************/
+void gpioDetachInterrupt (uint32_t portNum, uint32_t bitPos)
+{
+  uint8_t slot;
+
+  if ((portNum > 3) || (bitPos > 11)) return;
+  if (!_gpioInitialised) gpioInit();
+
+  gpioIntDisable(portNum, bitPos);
+  slot = _gpioIntSlot[portNum][bitPos];
+  if (slot)
+  {
+    _gpioIntSlot[portNum][bitPos] = 0;
+    _gpioIntCallbacks[slot - 1] = NULL;
+  }
+}
+
 /**************************************************************************/
 /*! 
     @brief Configures the internal pullup/down resistor for GPIO pins
@@ -98,15 +98,48 @@ typedef enum gpioPullupMode_e
 }
 gpioPullupMode_t;
 
+/**************************************************************************/
+/*! 
+    Called from the port's interrupt handler when an attached pin
+    interrupts (see gpioAttachInterrupt).  The interrupt has already
+    been cleared.
+*/
+/**************************************************************************/
+typedef void (*gpioIntCallback_t)(void);
+
+#define GPIO_MAXCALLBACKS   (8)     // pins that can have a callback at the same time
+
+/**************************************************************************/
+/*! 
+    Address masked access to a port's GPIODATA register.  Bits 13:2 of
+    the address select which pins a read or write affects, so a single
+    store updates only the pins in 'mask' (no read-modify-write, and
+    safe against interrupts changing other pins on the same port).
+    With a constant port and mask this resolves to one store at a
+    constant address.
+
+    @code
+    // Set 2.5 high and 2.6 low with a single write
+    GPIO_WRITEMASKED(2, (1 << 5) | (1 << 6), (1 << 5));
+    @endcode
+*/
+/**************************************************************************/
+#define GPIO_MASKEDDATA(portNum, mask)          (*(pREG32 (GPIO_GPIO0_BASE + ((portNum) << 16) + (((mask) & 0xFFF) << 2))))
+#define GPIO_WRITEMASKED(portNum, mask, value)  do { GPIO_MASKEDDATA(portNum, mask) = (value); } while (0)
+#define GPIO_READMASKED(portNum, mask)          (GPIO_MASKEDDATA(portNum, mask))
+
 void gpioInit (void);
 void gpioSetDir (uint32_t portNum, uint32_t bitPos, gpioDirection_t dir);
 uint32_t gpioGetValue (uint32_t portNum, uint32_t bitPos);
 void gpioSetValue (uint32_t portNum, uint32_t bitPos, uint32_t bitVal);
+void gpioWritePortMasked (uint32_t portNum, uint32_t mask, uint32_t value);
 void gpioSetInterrupt (uint32_t portNum, uint32_t bitPos, gpioInterruptSense_t sense, gpioInterruptEdge_t edge, gpioInterruptEvent_t event);
 void gpioIntEnable (uint32_t portNum, uint32_t bitPos);
 void gpioIntDisable (uint32_t portNum, uint32_t bitPos);
 uint32_t  gpioIntStatus (uint32_t portNum, uint32_t bitPos);
 void gpioIntClear (uint32_t portNum, uint32_t bitPos);
+bool gpioAttachInterrupt (uint32_t portNum, uint32_t bitPos, gpioInterruptSense_t sense, gpioInterruptEdge_t edge, gpioInterruptEvent_t event, gpioIntCallback_t callback);
+void gpioDetachInterrupt (uint32_t portNum, uint32_t bitPos);
 void gpioSetPullup (volatile uint32_t *ioconRegister, gpioPullupMode_t mode);
 
 #endif
\ No newline at end of file
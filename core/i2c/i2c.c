@@ -11,9 +11,17 @@
  *                           Major cleaning and a rewrite of some functions
  *                           - adding ACK/NACK handling to the state machine
  *                           - adding a return result to the I2CEngine()
+ *   2010.11.02  ver 1.11    Added a queue of non-blocking transfers that
+ *                           are run back-to-back by the interrupt handler
+ *   2010.11.20  ver 1.12    Per-transfer SCL rate (up to Fm+), SCLH/SCLL
+ *                           are only reprogrammed when the rate changes
  *
 *****************************************************************************/
 #include "i2c.h"
+#include "core/bench/isrstats.h"
+#include "core/clkgate/clkgate.h"
+#include "core/cpu/cpu.h"
+#include "core/sched/event.h"
 
 volatile uint32_t I2CMasterState = I2CSTATE_IDLE;
 volatile uint32_t I2CSlaveState = I2CSTATE_IDLE;
@@ -26,6 +34,229 @@ volatile uint32_t I2CWriteLength;
 volatile uint32_t RdIndex = 0;
 volatile uint32_t WrIndex = 0;
 
+/* Lengths used by the interrupt handler for the transfer in progress */
+/* (copied from I2CWriteLength/I2CReadLength or from an i2cTransfer_t) */
+static volatile uint32_t i2cTxLength;
+static volatile uint32_t i2cRxLength;
+
+/* Non-blocking transfer queue, i2cCurrent is NULL when no queued */
+/* transfer is on the bus                                          */
+static i2cTransfer_t * volatile i2cQueue[I2C_QUEUESIZE];
+static volatile uint32_t i2cQueueHead = 0;
+static volatile uint32_t i2cQueueTail = 0;
+static i2cTransfer_t * volatile i2cCurrent = NULL;
+static volatile uint32_t i2cBlocking = FALSE;
+
+/* Set by i2cFinish every time a transfer reaches a terminal state, */
+/* so i2cEngineSpeed can sleep instead of polling I2CMasterState    */
+#define I2C_EVENT_DONE    (1 << 0)
+static volatile uint32_t i2cEvents = 0;
+
+/* SCL rate currently in SCLH/SCLL and the core clock it was worked */
+/* out for (see i2cSetSpeed)                                        */
+#define I2C_SPEED_NONE    0xFFFFFFFF
+static uint32_t i2cSpeed = I2C_SPEED_NONE;
+static uint32_t i2cSpeedClock;
+
+/*****************************************************************************
+** Function name:		i2cTxByte
+**
+** Descriptions:		Returns byte 'index' of the transfer in progress.
+**						Queued transfers are presented to the state machine
+**						in the same layout as I2CMasterBuffer:
+**						SLA+W, the write bytes and SLA+R (or only SLA+R
+**						when there is nothing to write).
+**
+** parameters:			Index of the byte to send
+** Returned value:		Byte to write to I2DAT
+** 
+*****************************************************************************/
+static uint8_t i2cTxByte( uint32_t index )
+{
+  i2cTransfer_t *t = i2cCurrent;
+
+  if ( t == NULL )
+  {
+	return I2CMasterBuffer[index];
+  }
+  if ( t->writeLength == 0 )
+  {
+	return t->address | RD_BIT;
+  }
+  if ( index == 0 )
+  {
+	return t->address;
+  }
+  if ( index <= t->writeLength )
+  {
+	return t->writeBuffer[index - 1];
+  }
+  return t->address | RD_BIT;
+}
+
+/*****************************************************************************
+** Function name:		i2cRxByte
+**
+** Descriptions:		Stores a received byte for the transfer in progress
+**
+** parameters:			Index and value of the received byte
+** Returned value:		None
+** 
+*****************************************************************************/
+static void i2cRxByte( uint32_t index, uint8_t value )
+{
+  if ( i2cCurrent == NULL )
+  {
+	I2CSlaveBuffer[index] = value;
+  }
+  else
+  {
+	i2cCurrent->readBuffer[index] = value;
+  }
+}
+
+/*****************************************************************************
+** Function name:		i2cWaitStop
+**
+** Descriptions:		Waits for a STOP condition set by the interrupt
+**						handler to go out, so that the I2C clock can be
+**						gated without cutting it short.
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+static void i2cWaitStop( void )
+{
+  uint32_t timeout = 0;
+
+  while ((I2C_I2CCONSET & I2CONSET_STO) && (timeout < MAX_TIMEOUT))
+  {
+	timeout++;
+  }
+}
+
+/*****************************************************************************
+** Function name:		i2cSetSpeed
+**
+** Descriptions:		Programs SCLH/SCLL for the given SCL rate, unless
+**						they already hold it.  Fast mode and Fm+ need a
+**						longer low than high period (1.3us/0.6us and
+**						0.5us/0.26us minimum), so the low period gets two
+**						thirds of the cycle.  Rates above fast mode
+**						switch the pads to Fm+ drive.  Any STOP still
+**						going out is allowed to finish first.
+**
+** parameters:			SCL rate in Hz, or I2C_SPEED_DEFAULT
+** Returned value:		None
+** 
+*****************************************************************************/
+static void i2cSetSpeed( uint32_t speed )
+{
+  uint32_t clock = cpuGetClock();
+  uint32_t total, high, low, mode;
+
+  if ( (speed == i2cSpeed) && (clock == i2cSpeedClock) )
+  {
+	return;
+  }
+
+  if ( speed == I2C_SPEED_DEFAULT )
+  {
+	high = I2SCLH_SCLH;
+	low = I2SCLL_SCLL;
+  }
+  else
+  {
+	total = (clock + speed - 1) / speed;
+	high = (speed > I2C_SPEED_STANDARD) ? total / 3 : total / 2;
+	if ( high < 4 )
+	{
+	  high = 4;
+	}
+	low = (total > high + 4) ? total - high : 4;
+  }
+  mode = (speed > I2C_SPEED_FAST) ? IOCON_PIO0_4_I2CMODE_FASTPLUSI2C : IOCON_PIO0_4_I2CMODE_STANDARDI2C;
+
+  i2cWaitStop();
+  IOCON_PIO0_4 = (IOCON_PIO0_4 & ~IOCON_PIO0_4_I2CMODE_MASK) | mode;
+  IOCON_PIO0_5 = (IOCON_PIO0_5 & ~IOCON_PIO0_5_I2CMODE_MASK) | mode;
+  I2C_I2CSCLH = high;
+  I2C_I2CSCLL = low;
+  i2cSpeed = speed;
+  i2cSpeedClock = clock;
+}
+
+/*****************************************************************************
+** Function name:		i2cQueueStart
+**
+** Descriptions:		Puts the transfer at the tail of the queue on the
+**						bus. Must be called with the I2C interrupt
+**						disabled or from the interrupt handler.
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+static void i2cQueueStart( void )
+{
+  i2cTransfer_t *t = i2cQueue[i2cQueueTail];
+
+  i2cSetSpeed(t->speed);
+  i2cCurrent = t;
+  i2cTxLength = t->writeLength ? t->writeLength + 1 : 1;
+  i2cRxLength = t->readLength;
+  RdIndex = 0;
+  WrIndex = 0;
+  I2C_I2CCONSET = I2CONSET_STA;	/* Set Start flag */
+}
+
+/*****************************************************************************
+** Function name:		i2cFinish
+**
+** Descriptions:		Records the terminal state of the transfer in
+**						progress.  For queued transfers the callback is
+**						run and the next queued transfer (if any) is
+**						started straight away.
+**
+** parameters:			Any of the terminal I2CSTATE_... values
+** Returned value:		None
+** 
+*****************************************************************************/
+static void i2cFinish( uint32_t state )
+{
+  i2cTransfer_t *t = i2cCurrent;
+
+  I2CMasterState = state;
+  eventSet(&i2cEvents, I2C_EVENT_DONE);
+  if ( t == NULL )
+  {
+	return;
+  }
+
+  /* Start the next transfer before running the callback so the bus */
+  /* stays busy (a STOP followed by a new START)                    */
+  i2cQueueTail = (i2cQueueTail + 1) % I2C_QUEUESIZE;
+  i2cCurrent = NULL;
+  if ( i2cQueueTail != i2cQueueHead )
+  {
+	i2cQueueStart();
+  }
+
+  /* Each queued transfer holds the I2C clock until it completes */
+  if ( i2cQueueTail == i2cQueueHead )
+  {
+	i2cWaitStop();
+  }
+  clkgateRelease(clkgatePeriph_I2C);
+
+  t->state = state;
+  if ( t->callback != NULL )
+  {
+	t->callback( t );
+  }
+}
+
 
 /*****************************************************************************
 ** Function name:		I2C_IRQHandler
@@ -39,6 +270,7 @@ volatile uint32_t WrIndex = 0;
 void I2C_IRQHandler(void) 
 {
 	uint8_t StatValue;
+	ISRSTAT_BEGIN();
 
 	/* this handler deals with master read and master write only */
 	StatValue = I2C_I2CSTAT;
@@ -52,7 +284,7 @@ void I2C_IRQHandler(void)
 		 * (we always start with a write after START+SLA)
 		 */
 		WrIndex = 0;
-		I2C_I2CDAT = I2CMasterBuffer[WrIndex++];
+		I2C_I2CDAT = i2cTxByte(WrIndex++);
 		I2C_I2CCONCLR = (I2CONCLR_SIC | I2CONCLR_STAC);
 		I2CMasterState = I2CSTATE_PENDING;
 		break;
@@ -65,7 +297,7 @@ void I2C_IRQHandler(void)
 		 */
 		RdIndex = 0;
 		/* Send SLA with R bit set, */
-		I2C_I2CDAT = I2CMasterBuffer[WrIndex++];
+		I2C_I2CDAT = i2cTxByte(WrIndex++);
 		I2C_I2CCONCLR = (I2CONCLR_SIC | I2CONCLR_STAC);
 	break;
 	
@@ -74,7 +306,7 @@ void I2C_IRQHandler(void)
 		 * SLA+W has been transmitted; ACK has been received.
 		 * We now start writing bytes.
 		 */
-		I2C_I2CDAT = I2CMasterBuffer[WrIndex++];
+		I2C_I2CDAT = i2cTxByte(WrIndex++);
 		I2C_I2CCONCLR = I2CONCLR_SIC;
 		break;
 
@@ -86,7 +318,7 @@ void I2C_IRQHandler(void)
 		 */
 		I2C_I2CCONSET = I2CONSET_STO;
 		I2C_I2CCONCLR = I2CONCLR_SIC;
-		I2CMasterState = I2CSTATE_SLA_NACK;
+		i2cFinish(I2CSTATE_SLA_NACK);
 		break;
 
 	case 0x28:
@@ -95,14 +327,14 @@ void I2C_IRQHandler(void)
 		 * Continue sending more bytes as long as there are bytes to send
 		 * and after this check if a read transaction should follow.
 		 */
-		if ( WrIndex < I2CWriteLength )
+		if ( WrIndex < i2cTxLength )
 		{
 			/* Keep writing as long as bytes avail */
-			I2C_I2CDAT = I2CMasterBuffer[WrIndex++];
+			I2C_I2CDAT = i2cTxByte(WrIndex++);
 		}
 		else
 		{
-			if ( I2CReadLength != 0 )
+			if ( i2cRxLength != 0 )
 			{
 				/* Send a Repeated START to initialize a read transaction */
 				/* (handled in state 0x10)                                */
@@ -110,8 +342,8 @@ void I2C_IRQHandler(void)
 			}
 			else
 			{
-				I2CMasterState = I2CSTATE_ACK;
 				I2C_I2CCONSET = I2CONSET_STO;      /* Set Stop flag */
+				i2cFinish(I2CSTATE_ACK);
 			}
 		}
 		I2C_I2CCONCLR = I2CONCLR_SIC;
@@ -125,7 +357,7 @@ void I2C_IRQHandler(void)
 		 */
 		I2C_I2CCONSET = I2CONSET_STO;
 		I2C_I2CCONCLR = I2CONCLR_SIC;
-		I2CMasterState = I2CSTATE_NACK;
+		i2cFinish(I2CSTATE_NACK);
 		break;
 
 	case 0x38:
@@ -136,8 +368,8 @@ void I2C_IRQHandler(void)
 		 * Inform the I2CEngine of this and cancel the transaction
 		 * (this is automatically done by the I2C hardware)
 		 */
-		I2CMasterState = I2CSTATE_ARB_LOSS;
 		I2C_I2CCONCLR = I2CONCLR_SIC;
+		i2cFinish(I2CSTATE_ARB_LOSS);
 		break;
 
 	case 0x40:
@@ -147,7 +379,7 @@ void I2C_IRQHandler(void)
 		 * Since a NOT ACK is sent after reading the last byte,
 		 * we need to prepare a NOT ACK in case we only read 1 byte.
 		 */
-		if ( I2CReadLength == 1 )
+		if ( i2cRxLength == 1 )
 		{
 			/* last (and only) byte: send a NACK after data is received */
 			I2C_I2CCONCLR = I2CONCLR_AAC;
@@ -168,7 +400,7 @@ void I2C_IRQHandler(void)
 		 */
 		I2C_I2CCONSET = I2CONSET_STO;
 		I2C_I2CCONCLR = I2CONCLR_SIC;
-		I2CMasterState = I2CSTATE_SLA_NACK;
+		i2cFinish(I2CSTATE_SLA_NACK);
 		break;
 
 	case 0x50:
@@ -177,8 +409,8 @@ void I2C_IRQHandler(void)
 		 * Read the byte and check for more bytes to read.
 		 * Send a NOT ACK after the last byte is received
 		 */
-		I2CSlaveBuffer[RdIndex++] = I2C_I2CDAT;
-		if ( RdIndex < (I2CReadLength-1) )
+		i2cRxByte(RdIndex++, I2C_I2CDAT);
+		if ( RdIndex < (i2cRxLength-1) )
 		{
 			/* lmore bytes to follow: send an ACK after data is received */
 			I2C_I2CCONSET = I2CONSET_AA;
@@ -198,10 +430,10 @@ void I2C_IRQHandler(void)
 		 * Generate a STOP condition and flag the I2CEngine that the
 		 * transaction is finished.
 		 */
-		I2CSlaveBuffer[RdIndex++] = I2C_I2CDAT;
-		I2CMasterState = I2CSTATE_ACK;
+		i2cRxByte(RdIndex++, I2C_I2CDAT);
 		I2C_I2CCONSET = I2CONSET_STO;	/* Set Stop flag */
 		I2C_I2CCONCLR = I2CONCLR_SIC;	/* Clear SI flag */
+		i2cFinish(I2CSTATE_ACK);
 		break;
 
 	
@@ -209,6 +441,7 @@ void I2C_IRQHandler(void)
 		I2C_I2CCONCLR = I2CONCLR_SIC;
 	break;
   }
+  ISRSTAT_END(isrStat_I2C);
   return;
 }
 
@@ -277,7 +510,7 @@ uint32_t i2cInit( uint32_t I2cMode )
 	SCB_PRESETCTRL |= (0x1<<1);
 
   // Enable I2C clock
-  SCB_SYSAHBCLKCTRL |= (SCB_SYSAHBCLKCTRL_I2C);
+  clkgateAcquire(clkgatePeriph_I2C);
 
   // Configure pin 0.4 for SCL
   IOCON_PIO0_4 &= ~(IOCON_PIO0_4_FUNC_MASK | IOCON_PIO0_4_I2CMODE_MASK);
@@ -293,16 +526,10 @@ uint32_t i2cInit( uint32_t I2cMode )
                   I2C_I2CCONCLR_STAC | 
                   I2C_I2CCONCLR_I2ENC;
 
-  // See p.128 for appropriate values for SCLL and SCLH
-#if I2C_FAST_MODE_PLUS
-  IOCON_PIO0_4 |= (IOCON_PIO0_4_I2CMODE_FASTPLUSI2C);
-  IOCON_PIO0_5 |= (IOCON_PIO0_5_I2CMODE_FASTPLUSI2C);
-  I2C_I2CSCLL   = I2C_SCLL_HS_SCLL;
-  I2C_I2CSCLH   = I2C_SCLH_HS_SCLH;
-#else
-  I2C_I2CSCLL   = I2SCLL_SCLL;
-  I2C_I2CSCLH   = I2SCLH_SCLH;
-#endif
+  // See p.128 for appropriate values for SCLL and SCLH, the reset
+  // above cleared them
+  i2cSpeed = I2C_SPEED_NONE;
+  i2cSetSpeed(I2C_SPEED_DEFAULT);
 
   if ( I2cMode == I2CSLAVE )
   {
@@ -310,9 +537,17 @@ uint32_t i2cInit( uint32_t I2cMode )
   }    
 
   /* Enable the I2C Interrupt */
+  NVIC_SetPriority(I2C_IRQn, CFG_IRQPRIO_PERIPH);
   NVIC_EnableIRQ(I2C_IRQn);
   I2C_I2CCONSET = I2C_I2CCONSET_I2EN;
 
+  /* A master only needs the clock during transfers, a slave must */
+  /* always be able to respond                                    */
+  if ( I2cMode != I2CSLAVE )
+  {
+    clkgateRelease(clkgatePeriph_I2C);
+  }
+
   return( TRUE );
 }
 
@@ -325,6 +560,9 @@ uint32_t i2cInit( uint32_t I2cMode )
 **					Before this routine is called, the read
 **					length, write length and I2C master buffer
 **					need to be filled.
+**					Any queued transfers are allowed to complete
+**					first, and transfers queued while this runs
+**					are started once it is finished.
 **
 ** parameters:		None
 ** Returned value:	Any of the I2CSTATE_... values. See i2c.h
@@ -332,19 +570,135 @@ uint32_t i2cInit( uint32_t I2cMode )
 *****************************************************************************/
 uint32_t i2cEngine( void ) 
 {
+  return ( i2cEngineSpeed(I2C_SPEED_DEFAULT) );
+}
+
+/*****************************************************************************
+** Function name:	i2cEngineSpeed
+**
+** Descriptions:	Same as i2cEngine, with the SCL rate the device
+**					supports.  SCLH/SCLL are left alone if the
+**					previous transfer used the same rate.
+**
+** parameters:		SCL rate in Hz (I2C_SPEED_...)
+** Returned value:	Any of the I2CSTATE_... values. See i2c.h
+** 
+*****************************************************************************/
+uint32_t i2cEngineSpeed( uint32_t speed ) 
+{
+  uint32_t state;
+
+  /* wait until the queue is idle and take the bus, sleeping until */
+  /* each queued transfer finishes                                  */
+  while (1)
+  {
+	eventClear(&i2cEvents, I2C_EVENT_DONE);
+	NVIC_DisableIRQ(I2C_IRQn);
+	if ( i2cCurrent == NULL )
+	{
+	  i2cBlocking = TRUE;
+	  NVIC_EnableIRQ(I2C_IRQn);
+	  break;
+	}
+	NVIC_EnableIRQ(I2C_IRQn);
+	eventWait(&i2cEvents, I2C_EVENT_DONE, 0);
+  }
+
+  clkgateAcquire(clkgatePeriph_I2C);
+  i2cSetSpeed(speed);
   I2CMasterState = I2CSTATE_IDLE;
   RdIndex = 0;
   WrIndex = 0;
+  i2cTxLength = I2CWriteLength;
+  i2cRxLength = I2CReadLength;
   if ( I2CStart() != TRUE )
   {
 	I2CStop();
+	state = FALSE;
+  }
+  else
+  {
+	/* sleep until the state is a terminal state */
+	eventWait(&i2cEvents, I2C_EVENT_DONE, 0);
+	state = I2CMasterState;
+	i2cWaitStop();
+  }
+
+  /* release the bus and start anything queued in the meantime */
+  NVIC_DisableIRQ(I2C_IRQn);
+  i2cBlocking = FALSE;
+  if ( i2cQueueTail != i2cQueueHead )
+  {
+	i2cQueueStart();
+  }
+  NVIC_EnableIRQ(I2C_IRQn);
+  clkgateRelease(clkgatePeriph_I2C);
+
+  return ( state );
+}
+
+/*****************************************************************************
+** Function name:	i2cQueueTransfer
+**
+** Descriptions:	Adds a transfer to the non-blocking queue and
+**					returns immediately.  Transfers are run in order,
+**					back-to-back, by the interrupt handler.  When a
+**					transfer completes its state field is set to one
+**					of the terminal I2CSTATE_... values and the
+**					callback (if any) is called from the interrupt
+**					handler.  The transfer and its buffers must stay
+**					valid until then.
+**
+** parameters:		Transfer to queue
+** Returned value:	true or false, return false if the queue is full
+**					or the transfer is empty
+** 
+*****************************************************************************/
+uint32_t i2cQueueTransfer( i2cTransfer_t *transfer )
+{
+  uint32_t next;
+
+  if ( (transfer->writeLength == 0) && (transfer->readLength == 0) )
+  {
+	return ( FALSE );
+  }
+
+  NVIC_DisableIRQ(I2C_IRQn);
+  next = (i2cQueueHead + 1) % I2C_QUEUESIZE;
+  if ( next == i2cQueueTail )
+  {
+	NVIC_EnableIRQ(I2C_IRQn);
 	return ( FALSE );
   }
 
-  /* wait until the state is a terminal state */
-  while (I2CMasterState < 0x100);
+  transfer->state = I2CSTATE_PENDING;
+  i2cQueue[i2cQueueHead] = transfer;
+  i2cQueueHead = next;
+  clkgateAcquire(clkgatePeriph_I2C);
+
+  /* start straight away if the bus is free */
+  if ( (i2cCurrent == NULL) && !i2cBlocking )
+  {
+	i2cQueueStart();
+  }
+  NVIC_EnableIRQ(I2C_IRQn);
+
+  return ( TRUE );
+}
 
-  return ( I2CMasterState );
+/*****************************************************************************
+** Function name:	i2cQueueIdle
+**
+** Descriptions:	Checks whether all queued transfers have completed
+**
+** parameters:		None
+** Returned value:	true if the queue is empty and no queued transfer
+**					is on the bus
+** 
+*****************************************************************************/
+uint32_t i2cQueueIdle( void )
+{
+  return ( (i2cCurrent == NULL) && (i2cQueueTail == i2cQueueHead) );
 }
 
 /******************************************************************************
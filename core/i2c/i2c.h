@@ -40,6 +40,7 @@
 #define FAST_MODE_PLUS    0
 
 #define I2C_BUFSIZE       6
+#define I2C_QUEUESIZE     4           /* Max queued transfers + 1 */
 #define MAX_TIMEOUT       0x00FFFFFF
 
 #define I2CMASTER         0x01
@@ -68,14 +69,47 @@
 #define I2SCLH_HS_SCLH    0x00000020  /* Fast Plus I2C SCL Duty Cycle High Reg */
 #define I2SCLL_HS_SCLL    0x00000020  /* Fast Plus I2C SCL Duty Cycle Low Reg */
 
+#define I2C_SPEED_DEFAULT   0         /* I2SCLH_SCLH/I2SCLL_SCLL as set by i2cInit */
+#define I2C_SPEED_STANDARD  100000    /* Standard mode (Hz) */
+#define I2C_SPEED_FAST      400000    /* Fast mode (Hz) */
+#define I2C_SPEED_FASTPLUS  1000000   /* Fast mode plus (Hz), high drive pads */
+
 
 extern volatile uint8_t I2CMasterBuffer[I2C_BUFSIZE];
 extern volatile uint8_t I2CSlaveBuffer[I2C_BUFSIZE];
 extern volatile uint32_t I2CReadLength, I2CWriteLength;
 
+/*
+ * Non-blocking transfer, queued with i2cQueueTransfer():
+ *
+ * address     - 8-bit device address (R/W bit cleared)
+ * writeBuffer - bytes sent after SLA+W (typically the register address)
+ * readBuffer  - bytes received after a repeated START with SLA+R
+ * callback    - called from the I2C interrupt when the transfer is
+ *               finished (may be NULL)
+ * speed       - SCL rate in Hz supported by the device (I2C_SPEED_...),
+ *               the bus is only reprogrammed when it changes
+ * state       - I2CSTATE_PENDING while queued/running, and then one of
+ *               the terminal I2CSTATE_... values
+ */
+typedef struct i2cTransfer_s
+{
+  uint8_t         address;
+  const uint8_t  *writeBuffer;
+  uint8_t         writeLength;
+  uint8_t        *readBuffer;
+  uint8_t         readLength;
+  void          (*callback)(struct i2cTransfer_s *transfer);
+  uint32_t        speed;
+  volatile uint32_t state;
+} i2cTransfer_t;
+
 extern void I2C_IRQHandler( void );
 extern uint32_t i2cInit( uint32_t I2cMode );
 extern uint32_t i2cEngine( void );
+extern uint32_t i2cEngineSpeed( uint32_t speed );
+extern uint32_t i2cQueueTransfer( i2cTransfer_t *transfer );
+extern uint32_t i2cQueueIdle( void );
 
 #endif /* end __I2C_H */
 /****************************************************************************
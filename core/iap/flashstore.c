@@ -0,0 +1,253 @@
+/**************************************************************************/
+/*! 
+    @file     flashstore.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Read-mostly data storage in the free flash sectors at the top of
+    the part (CFG_FLASHSTORE_FIRSTSECTOR and up).  Calibration tables,
+    lookup tables or fonts downloaded at runtime are written once with
+    IAP and then read through a plain pointer, so using them costs no
+    more than reading a const array and doesn't touch the I2C bus the
+    way the EEPROM does.
+
+    Flash can only be erased in 4KB sectors and programmed 256 bytes
+    at a time, and programming can only clear bits.  flashstoreWrite
+    accepts any offset and length: each 256 byte page is sent with
+    0xFF in the bytes that aren't being written, which leaves them
+    untouched, so a page can be filled in several writes as long as
+    the bytes being written are still erased (or already hold the same
+    value).  To change data that is already there, erase its sector
+    with flashstoreErase and write it again.
+
+    Interrupts are masked while IAP runs (see iapCommand), about 100ms
+    for an erase and 1ms for each page.
+
+    @code
+    #include "core/iap/flashstore.h"
+
+    typedef struct
+    {
+      int16_t offset[8];
+      int16_t gain[8];
+    } calibration_t;
+
+    const calibration_t *cal = FLASHSTORE_PTR(0);
+
+    // Store a new table
+    flashstoreErase(0, sizeof(calibration_t));
+    flashstoreWrite(0, &newCalibration, sizeof(calibration_t));
+
+    // and use it in place
+    value = (raw - cal->offset[channel]) * cal->gain[channel];
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include <string.h>
+
+#include "flashstore.h"
+
+#ifdef CFG_FLASHSTORE
+
+// Set by the linker, the image in flash ends with the .data initialisers
+extern unsigned char _etext;
+extern unsigned char _data;
+extern unsigned char _edata;
+
+static uint32_t flashstorePage[IAP_PAGESIZE / 4];   // Word aligned for IAP
+
+/**************************************************************************/
+/*! 
+    @brief  Checks that the running firmware ends below the storage
+            area, so that it can't be erased by mistake
+*/
+/**************************************************************************/
+static bool flashstoreImageFits(void)
+{
+  uint32_t end = (uint32_t)&_etext + (uint32_t)(&_edata - &_data);
+
+  return end <= FLASHSTORE_ADDR;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Checks that 'len' bytes at 'offset' are inside the storage
+            area (without overflowing)
+*/
+/**************************************************************************/
+static bool flashstoreInRange(uint32_t offset, uint32_t len)
+{
+  return (offset <= FLASHSTORE_SIZE) && (len <= FLASHSTORE_SIZE - offset);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Erases every sector that overlaps 'len' bytes at 'offset'
+            (whole 4KB sectors, so anything else in them is lost too)
+
+    @param[in]  offset
+                Offset from the start of the storage area
+    @param[in]  len
+                Number of bytes that need to be erased
+*/
+/**************************************************************************/
+flashstoreError_t flashstoreErase(uint32_t offset, uint32_t len)
+{
+  uint32_t first, last;
+
+  if (!flashstoreInRange(offset, len))
+  {
+    return FLASHSTORE_ERROR_RANGE;
+  }
+  if (!flashstoreImageFits())
+  {
+    return FLASHSTORE_ERROR_OVERLAP;
+  }
+  if (len == 0)
+  {
+    return FLASHSTORE_ERROR_OK;
+  }
+
+  first = CFG_FLASHSTORE_FIRSTSECTOR + offset / IAP_SECTORSIZE;
+  last = CFG_FLASHSTORE_FIRSTSECTOR + (offset + len - 1) / IAP_SECTORSIZE;
+
+  // Nothing to do if the sectors are already blank
+  if (iapBlankCheckSectors(first, last) == IAP_STATUS_CMDSUCCESS)
+  {
+    return FLASHSTORE_ERROR_OK;
+  }
+
+  if (iapPrepareSectors(first, last) != IAP_STATUS_CMDSUCCESS ||
+      iapEraseSectors(first, last) != IAP_STATUS_CMDSUCCESS)
+  {
+    return FLASHSTORE_ERROR_FLASH;
+  }
+
+  return FLASHSTORE_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Programs 'len' bytes from 'data' at 'offset', one 256 byte
+            page at a time
+
+    Every byte written must still be erased or already hold the same
+    value, which is checked for the whole range before anything is
+    programmed.  Pages that already hold the data are skipped, and
+    every page is compared against the data once it has been written.
+
+    @param[in]  offset
+                Offset from the start of the storage area
+    @param[in]  data
+                Data to store (any alignment)
+    @param[in]  len
+                Number of bytes to store
+*/
+/**************************************************************************/
+flashstoreError_t flashstoreWrite(uint32_t offset, const void *data, uint32_t len)
+{
+  const uint8_t *src = data;
+  const uint8_t *flash = FLASHSTORE_PTR(offset);
+  uint8_t *page = (uint8_t *)flashstorePage;
+  uint32_t start, count, addr, sector, i;
+
+  if (!flashstoreInRange(offset, len))
+  {
+    return FLASHSTORE_ERROR_RANGE;
+  }
+  if (!flashstoreImageFits())
+  {
+    return FLASHSTORE_ERROR_OVERLAP;
+  }
+
+  // Programming can only clear bits
+  for (i = 0; i < len; i++)
+  {
+    if ((flash[i] & src[i]) != src[i])
+    {
+      return FLASHSTORE_ERROR_NOTBLANK;
+    }
+  }
+
+  while (len)
+  {
+    start = offset & (IAP_PAGESIZE - 1);
+    count = IAP_PAGESIZE - start;
+    if (count > len)
+    {
+      count = len;
+    }
+    addr = FLASHSTORE_ADDR + offset - start;
+    flash = (const uint8_t *)(addr + start);
+
+    if (memcmp(flash, src, count) != 0)
+    {
+      // Erased bits in the rest of the page leave the flash as it is
+      memset(page, 0xFF, IAP_PAGESIZE);
+      memcpy(&page[start], src, count);
+
+      sector = addr / IAP_SECTORSIZE;
+      if (iapPrepareSectors(sector, sector) != IAP_STATUS_CMDSUCCESS ||
+          iapCopyRamToFlash(addr, flashstorePage, IAP_PAGESIZE) != IAP_STATUS_CMDSUCCESS ||
+          memcmp(flash, src, count) != 0)
+      {
+        return FLASHSTORE_ERROR_FLASH;
+      }
+    }
+
+    offset += count;
+    src += count;
+    len -= count;
+  }
+
+  return FLASHSTORE_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns a pointer to 'offset' in the storage area, or NULL
+            if it is outside of it
+*/
+/**************************************************************************/
+const void *flashstoreGetPointer(uint32_t offset)
+{
+  if (offset >= FLASHSTORE_SIZE)
+  {
+    return NULL;
+  }
+
+  return FLASHSTORE_PTR(offset);
+}
+
+#endif
@@ -0,0 +1,66 @@
+/**************************************************************************/
+/*! 
+    @file     flashstore.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef _FLASHSTORE_H_
+#define _FLASHSTORE_H_
+
+#include "projectconfig.h"
+#include "core/iap/iap.h"
+
+#ifdef CFG_FLASHSTORE
+
+#define FLASHSTORE_ADDR         (CFG_FLASHSTORE_FIRSTSECTOR * IAP_SECTORSIZE)
+#define FLASHSTORE_SIZE         (CFG_FLASHSTORE_SECTORS * IAP_SECTORSIZE)
+
+// Reads are plain memory accesses, so data can be used in place
+#define FLASHSTORE_PTR(offset)  ((const void *)(FLASHSTORE_ADDR + (offset)))
+
+typedef enum
+{
+  FLASHSTORE_ERROR_OK = 0,
+  FLASHSTORE_ERROR_RANGE,           // Outside the storage area
+  FLASHSTORE_ERROR_NOTBLANK,        // Bits would have to go from 0 to 1, erase first
+  FLASHSTORE_ERROR_FLASH,           // IAP erase/write/compare failed
+  FLASHSTORE_ERROR_OVERLAP          // The firmware image extends into the storage area
+}
+flashstoreError_t;
+
+flashstoreError_t flashstoreErase(uint32_t offset, uint32_t len);
+flashstoreError_t flashstoreWrite(uint32_t offset, const void *data, uint32_t len);
+const void *      flashstoreGetPointer(uint32_t offset);
+
+#endif
+
+#endif
@@ -0,0 +1,348 @@
+/**************************************************************************/
+/*! 
+    @file     fwupdate.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    In-field firmware updates through IAP.  The new image is streamed
+    in chunks of any size (USB CDC packets, Chibi frames, ...) into a
+    staging area starting at CFG_FWUPDATE_STAGINGSECTOR, 256 bytes at a
+    time, and hashed with SHA-256 as it arrives, so the image is never
+    held in RAM.  Every page is compared against flash after writing.
+
+    Once the last byte is in, fwupdateFinish checks the LPC vector
+    checksum (written by lpcrc) and verifies a PKCS#1 v1.5 RSA
+    signature of the SHA-256 digest against the caller's public key.
+    Only then can fwupdateApply copy the staging area over the running
+    application, from a small routine in RAM, and reset.
+
+    If power fails during fwupdateApply the part has to be recovered
+    with the ROM ISP bootloader, so keep that routine's run time (about
+    100ms per sector) in mind on battery powered boards.
+
+    @code
+    #include "core/iap/fwupdate.h"
+
+    // Announce the image, then pass on every chunk as it arrives
+    fwupdateBegin(imageSize);
+    ...
+    fwupdateWrite(chunk, chunkLen);
+    ...
+    // After the last chunk
+    if (fwupdateFinish(&key, signature) == FWUPDATE_ERROR_OK)
+    {
+      fwupdateApply();      // Doesn't return
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include <string.h>
+
+#include "fwupdate.h"
+#include "core/cpu/cpu.h"
+#include "drivers/crypto/sha256.h"
+
+#define FWUPDATE_SECTORS(size)  (((size) + IAP_SECTORSIZE - 1) / IAP_SECTORSIZE)
+#define FWUPDATE_IAPADDRESS     (0x1FFF1FF1)
+
+typedef enum
+{
+  FWUPDATE_STATE_IDLE = 0,
+  FWUPDATE_STATE_RECEIVING,
+  FWUPDATE_STATE_VERIFIED
+}
+fwupdateState_t;
+
+static struct
+{
+  uint32_t        page[IAP_PAGESIZE / 4];   // Word aligned for IAP
+  uint32_t        size;
+  uint32_t        received;
+  uint32_t        flashed;
+  sha256Context_t sha;
+  fwupdateState_t state;
+} fwupdate;
+
+/* Runs from RAM (.data) since it overwrites the code in flash.  The *
+ * long_call is needed because RAM is out of range of a BL from flash. */
+static void fwupdateCopy(uint32_t sectors) __attribute__ ((section(".data.fwupdateCopy"), long_call, noinline, noreturn));
+
+/**************************************************************/
+/*! 
+    @brief  Writes the page buffer to the next staging page and
+            checks it
+*/
+/**************************************************************/
+static fwupdateError_t fwupdateFlush(void)
+{
+  uint32_t dst = FWUPDATE_STAGINGADDR + fwupdate.flashed;
+  uint32_t sector = dst / IAP_SECTORSIZE;
+
+  if (iapPrepareSectors(sector, sector) != IAP_STATUS_CMDSUCCESS ||
+      iapCopyRamToFlash(dst, fwupdate.page, IAP_PAGESIZE) != IAP_STATUS_CMDSUCCESS ||
+      iapCompare(dst, fwupdate.page, IAP_PAGESIZE) != IAP_STATUS_CMDSUCCESS)
+  {
+    fwupdate.state = FWUPDATE_STATE_IDLE;
+    return FWUPDATE_ERROR_FLASH;
+  }
+
+  fwupdate.flashed += IAP_PAGESIZE;
+  return FWUPDATE_ERROR_OK;
+}
+
+/**************************************************************/
+/*! 
+    @brief  Starts a new update and erases as much of the staging
+            area as the image needs
+
+    @param[in]  size
+                Image size in bytes (up to FWUPDATE_MAXSIZE)
+*/
+/**************************************************************/
+fwupdateError_t fwupdateBegin(uint32_t size)
+{
+  uint32_t last;
+
+  fwupdate.state = FWUPDATE_STATE_IDLE;
+  if (size == 0 || size > FWUPDATE_MAXSIZE)
+  {
+    return FWUPDATE_ERROR_SIZE;
+  }
+
+  last = CFG_FWUPDATE_STAGINGSECTOR + FWUPDATE_SECTORS(size) - 1;
+  if (iapPrepareSectors(CFG_FWUPDATE_STAGINGSECTOR, last) != IAP_STATUS_CMDSUCCESS ||
+      iapEraseSectors(CFG_FWUPDATE_STAGINGSECTOR, last) != IAP_STATUS_CMDSUCCESS)
+  {
+    return FWUPDATE_ERROR_FLASH;
+  }
+
+  fwupdate.size = size;
+  fwupdate.received = 0;
+  fwupdate.flashed = 0;
+  sha256Init(&fwupdate.sha);
+  fwupdate.state = FWUPDATE_STATE_RECEIVING;
+
+  return FWUPDATE_ERROR_OK;
+}
+
+/**************************************************************/
+/*! 
+    @brief  Adds the next chunk of the image.  Chunks can be any
+            length, a flash page is written whenever 256 bytes
+            have been collected.
+*/
+/**************************************************************/
+fwupdateError_t fwupdateWrite(const uint8_t *data, uint32_t len)
+{
+  uint32_t fill, n;
+  fwupdateError_t error;
+
+  if (fwupdate.state != FWUPDATE_STATE_RECEIVING)
+  {
+    return FWUPDATE_ERROR_SEQUENCE;
+  }
+  if (len > fwupdate.size - fwupdate.received)
+  {
+    fwupdate.state = FWUPDATE_STATE_IDLE;
+    return FWUPDATE_ERROR_SIZE;
+  }
+
+  sha256Update(&fwupdate.sha, data, len);
+
+  while (len)
+  {
+    fill = fwupdate.received - fwupdate.flashed;
+    n = IAP_PAGESIZE - fill;
+    if (n > len)
+    {
+      n = len;
+    }
+    memcpy((uint8_t *)fwupdate.page + fill, data, n);
+    fwupdate.received += n;
+    data += n;
+    len -= n;
+
+    if (fill + n == IAP_PAGESIZE)
+    {
+      error = fwupdateFlush();
+      if (error)
+      {
+        return error;
+      }
+    }
+  }
+
+  return FWUPDATE_ERROR_OK;
+}
+
+/**************************************************************/
+/*! 
+    @brief  Writes the last partial page and verifies the image
+
+    @param[in]  key
+                Public key the image was signed with
+    @param[in]  signature
+                Signature of the image's SHA-256 digest, as many
+                bytes as the key's modulus
+*/
+/**************************************************************/
+fwupdateError_t fwupdateFinish(const rsaBigPubKey_t *key, const uint8_t *signature)
+{
+  const uint32_t *vectors = (const uint32_t *)FWUPDATE_STAGINGADDR;
+  uint8_t digest[SHA256_DIGESTSIZE];
+  uint32_t fill, sum;
+  fwupdateError_t error;
+  uint8_t i;
+
+  if (fwupdate.state != FWUPDATE_STATE_RECEIVING)
+  {
+    return FWUPDATE_ERROR_SEQUENCE;
+  }
+  if (fwupdate.received != fwupdate.size)
+  {
+    fwupdate.state = FWUPDATE_STATE_IDLE;
+    return FWUPDATE_ERROR_SIZE;
+  }
+
+  // Pad the last page with erased flash
+  fill = fwupdate.received - fwupdate.flashed;
+  if (fill)
+  {
+    memset((uint8_t *)fwupdate.page + fill, 0xFF, IAP_PAGESIZE - fill);
+    error = fwupdateFlush();
+    if (error)
+    {
+      return error;
+    }
+  }
+
+  fwupdate.state = FWUPDATE_STATE_IDLE;
+
+  // The boot ROM only starts images whose first 8 vectors add up to 0
+  for (i = 0, sum = 0; i < 8; i++)
+  {
+    sum += vectors[i];
+  }
+  if (fwupdate.size < 32 || sum)
+  {
+    return FWUPDATE_ERROR_VECTORCHECKSUM;
+  }
+
+  sha256Final(&fwupdate.sha, digest);
+  if (!rsaVerifySha256(key, signature, digest))
+  {
+    return FWUPDATE_ERROR_SIGNATURE;
+  }
+
+  fwupdate.state = FWUPDATE_STATE_VERIFIED;
+  return FWUPDATE_ERROR_OK;
+}
+
+/**************************************************************/
+/*! 
+    @brief  Drops a partly received or verified image.  The
+            staging area is erased again by the next fwupdateBegin.
+*/
+/**************************************************************/
+void fwupdateAbort(void)
+{
+  fwupdate.state = FWUPDATE_STATE_IDLE;
+}
+
+/**************************************************************/
+/*! 
+    @brief  Copies the staging area to sector 0 onwards and
+            resets.  Everything it calls is either in RAM or in
+            the boot ROM: nothing in flash below the staging area
+            may be touched once the first sector is erased.
+*/
+/**************************************************************/
+static void fwupdateCopy(uint32_t sectors)
+{
+  void (*iap)(uint32_t[], uint32_t[]) = (void (*)(uint32_t[], uint32_t[]))FWUPDATE_IAPADDRESS;
+  uint32_t command[5], result[4];
+  volatile const uint32_t *src;
+  uint32_t sector, offset, i;
+
+  for (sector = 0; sector < sectors; sector++)
+  {
+    command[0] = IAP_CMD_PREPARESECTORFORWRITE;
+    command[1] = sector;
+    command[2] = sector;
+    iap(command, result);
+    command[0] = IAP_CMD_ERASESECTORS;
+    command[3] = cpuGetClock() / 1000;
+    iap(command, result);
+
+    for (offset = 0; offset < IAP_SECTORSIZE; offset += IAP_PAGESIZE)
+    {
+      // Volatile so the compiler can't turn this into a memcpy call
+      src = (volatile const uint32_t *)(FWUPDATE_STAGINGADDR + sector * IAP_SECTORSIZE + offset);
+      for (i = 0; i < IAP_PAGESIZE / 4; i++)
+      {
+        fwupdate.page[i] = src[i];
+      }
+      command[0] = IAP_CMD_PREPARESECTORFORWRITE;
+      command[1] = sector;
+      command[2] = sector;
+      iap(command, result);
+      command[0] = IAP_CMD_COPYRAMTOFLASH;
+      command[1] = sector * IAP_SECTORSIZE + offset;
+      command[2] = (uint32_t)fwupdate.page;
+      command[3] = IAP_PAGESIZE;
+      command[4] = cpuGetClock() / 1000;
+      iap(command, result);
+    }
+  }
+
+  SCB_AIRCR = SCB_AIRCR_VECTKEY_VALUE | SCB_AIRCR_SYSRESETREQ;
+  while (1);
+}
+
+/**************************************************************/
+/*! 
+    @brief  Installs a verified image and resets into it.  Does
+            nothing if fwupdateFinish hasn't succeeded.
+*/
+/**************************************************************/
+void fwupdateApply(void)
+{
+  if (fwupdate.state != FWUPDATE_STATE_VERIFIED)
+  {
+    return;
+  }
+
+  __disable_irq();
+  fwupdateCopy(FWUPDATE_SECTORS(fwupdate.size));
+}
@@ -0,0 +1,77 @@
+/**************************************************************************/
+/*! 
+    @file     fwupdate.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef _FWUPDATE_H_
+#define _FWUPDATE_H_
+
+#include "projectconfig.h"
+#include "core/iap/iap.h"
+#include "drivers/rsa/rsa.h"
+
+#define FWUPDATE_STAGINGADDR    (CFG_FWUPDATE_STAGINGSECTOR * IAP_SECTORSIZE)
+
+/* The staging area stops below the flash storage sectors, if any */
+#ifdef CFG_FLASHSTORE
+  #define FWUPDATE_ENDSECTOR    (CFG_FLASHSTORE_FIRSTSECTOR)
+#else
+  #define FWUPDATE_ENDSECTOR    (IAP_SECTORCOUNT)
+#endif
+
+/* The image has to fit both in the staging area and below it */
+#if CFG_FWUPDATE_STAGINGSECTOR * 2 <= FWUPDATE_ENDSECTOR
+  #define FWUPDATE_MAXSIZE      (CFG_FWUPDATE_STAGINGSECTOR * IAP_SECTORSIZE)
+#else
+  #define FWUPDATE_MAXSIZE      ((FWUPDATE_ENDSECTOR - CFG_FWUPDATE_STAGINGSECTOR) * IAP_SECTORSIZE)
+#endif
+
+typedef enum
+{
+  FWUPDATE_ERROR_OK = 0,
+  FWUPDATE_ERROR_SEQUENCE,          // Call out of order
+  FWUPDATE_ERROR_SIZE,              // Image too large, or not the announced size
+  FWUPDATE_ERROR_FLASH,             // IAP erase/write/compare failed
+  FWUPDATE_ERROR_VECTORCHECKSUM,    // Image would not boot (run lpcrc on it)
+  FWUPDATE_ERROR_SIGNATURE          // Hash doesn't match the signature
+}
+fwupdateError_t;
+
+fwupdateError_t fwupdateBegin(uint32_t size);
+fwupdateError_t fwupdateWrite(const uint8_t *data, uint32_t len);
+fwupdateError_t fwupdateFinish(const rsaBigPubKey_t *key, const uint8_t *signature);
+void            fwupdateAbort(void);
+void            fwupdateApply(void);
+
+#endif
@@ -5,6 +5,7 @@
 */
 /**************************************************************************/
 #include "iap.h"
+#include "core/cpu/cpu.h"
  
 IAP_return_t iap_return;
  
@@ -55,3 +56,86 @@ IAP_return_t iapReadSerialNumber(void)
   return iap_return;
 }
 
+/**************************************************************************/
+/*! 
+    Runs one IAP command with interrupts masked.  Flash can't be read
+    while it is being programmed or erased, so an interrupt vectoring
+    into flash half way through would fault.
+*/
+/**************************************************************************/
+static uint32_t iapCommand(uint32_t cmd, uint32_t p1, uint32_t p2, uint32_t p3, uint32_t p4)
+{
+  uint32_t primask;
+
+  param_table[0] = cmd;
+  param_table[1] = p1;
+  param_table[2] = p2;
+  param_table[3] = p3;
+  param_table[4] = p4;
+
+  __asm volatile ("mrs %0, primask" : "=r" (primask));
+  __disable_irq();
+  iap_entry(param_table,(uint32_t*)(&iap_return));
+  if (!primask)
+  {
+    __enable_irq();
+  }
+
+  return iap_return.ReturnCode;
+}
+
+/**************************************************************************/
+/*! 
+    Unlocks sectors 'start' to 'end' (inclusive) for the next erase or
+    write command.  The lock is set again after every erase/write, so
+    this has to be called before each one.
+*/
+/**************************************************************************/
+uint32_t iapPrepareSectors(uint32_t start, uint32_t end)
+{
+  return iapCommand(IAP_CMD_PREPARESECTORFORWRITE, start, end, 0, 0);
+}
+
+/**************************************************************************/
+/*! 
+    Erases sectors 'start' to 'end' (inclusive).  The sectors must have
+    been prepared first.
+*/
+/**************************************************************************/
+uint32_t iapEraseSectors(uint32_t start, uint32_t end)
+{
+  return iapCommand(IAP_CMD_ERASESECTORS, start, end, cpuGetClock() / 1000, 0);
+}
+
+/**************************************************************************/
+/*! 
+    Returns IAP_STATUS_CMDSUCCESS if sectors 'start' to 'end' are erased
+*/
+/**************************************************************************/
+uint32_t iapBlankCheckSectors(uint32_t start, uint32_t end)
+{
+  return iapCommand(IAP_CMD_BLANKCHECKSECTOR, start, end, 0, 0);
+}
+
+/**************************************************************************/
+/*! 
+    Programs 'len' bytes (256, 512, 1024 or 4096) from word aligned RAM
+    at 'src' to flash at 'dst', which must be on a 256 byte boundary in
+    a prepared sector.
+*/
+/**************************************************************************/
+uint32_t iapCopyRamToFlash(uint32_t dst, const void *src, uint32_t len)
+{
+  return iapCommand(IAP_CMD_COPYRAMTOFLASH, dst, (uint32_t)src, len, cpuGetClock() / 1000);
+}
+
+/**************************************************************************/
+/*! 
+    Compares 'len' bytes (a multiple of 4) at word aligned addresses
+    'dst' and 'src'.  Returns IAP_STATUS_COMPAREERROR on a mismatch.
+*/
+/**************************************************************************/
+uint32_t iapCompare(uint32_t dst, const void *src, uint32_t len)
+{
+  return iapCommand(IAP_CMD_COMPARE, dst, (uint32_t)src, len, 0);
+}
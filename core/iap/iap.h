@@ -41,7 +41,7 @@
 
 #define IAP_CMD_PREPARESECTORFORWRITE (50)
 #define IAP_CMD_COPYRAMTOFLASH        (51)
-#define CAP_CMD_ERASESECTORS          (52)
+#define IAP_CMD_ERASESECTORS          (52)
 #define IAP_CMD_BLANKCHECKSECTOR      (53)
 #define IAP_CMD_READPARTID            (54)
 #define IAP_CMD_READBOOTCODEVERSION   (55)
@@ -49,6 +49,20 @@
 #define IAP_CMD_REINVOKEISP           (57)
 #define IAP_CMD_READUID               (58)
 
+#define IAP_STATUS_CMDSUCCESS         (0)
+#define IAP_STATUS_SRCADDRERROR       (2)
+#define IAP_STATUS_DSTADDRERROR       (3)
+#define IAP_STATUS_COUNTERROR         (6)
+#define IAP_STATUS_INVALIDSECTOR      (7)
+#define IAP_STATUS_SECTORNOTBLANK     (8)
+#define IAP_STATUS_NOTPREPARED        (9)
+#define IAP_STATUS_COMPAREERROR       (10)
+#define IAP_STATUS_BUSY               (11)
+
+#define IAP_SECTORSIZE                (4096)    // All LPC1343 sectors are 4KB
+#define IAP_SECTORCOUNT               (8)       // 32KB flash
+#define IAP_PAGESIZE                  (256)     // Smallest CopyRAMToFlash block
+
 typedef struct
 {
   unsigned int ReturnCode;
@@ -56,5 +70,10 @@ typedef struct
 } IAP_return_t;
 
 IAP_return_t iapReadSerialNumber(void);
+uint32_t iapPrepareSectors(uint32_t start, uint32_t end);
+uint32_t iapEraseSectors(uint32_t start, uint32_t end);
+uint32_t iapBlankCheckSectors(uint32_t start, uint32_t end);
+uint32_t iapCopyRamToFlash(uint32_t dst, const void *src, uint32_t len);
+uint32_t iapCompare(uint32_t dst, const void *src, uint32_t len);
 
 #endif
\ No newline at end of file
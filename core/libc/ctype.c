@@ -27,9 +27,37 @@
  * SUCH DAMAGE.
  */
 
+/*
+ * Table driven classification for the C locale.  Every function is one
+ * load and a mask instead of a chain of compares, and anything outside
+ * 0..255 (EOF) is in no class.
+ */
+#define CT_U	0x01	/* Upper case letter */
+#define CT_L	0x02	/* Lower case letter */
+#define CT_D	0x04	/* Decimal digit */
+#define CT_S	0x08	/* White space */
+#define CT_P	0x10	/* Punctuation */
+#define CT_C	0x20	/* Control character */
+#define CT_X	0x40	/* Hex digit */
+#define CT_B	0x80	/* Blank (space or tab) */
+
+#define CTYPE(c, mask)	(((unsigned int)(c) < 256) ? (ctypeTable[(c)] & (mask)) : 0)
+
+static const unsigned char ctypeTable[256] = {
+	CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C|CT_S|CT_B, CT_C|CT_S, CT_C|CT_S, CT_C|CT_S, CT_C|CT_S, CT_C, CT_C,
+	CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C, CT_C,
+	CT_S|CT_B, CT_P, CT_P, CT_P, CT_P, CT_P, CT_P, CT_P, CT_P, CT_P, CT_P, CT_P, CT_P, CT_P, CT_P, CT_P,
+	CT_D|CT_X, CT_D|CT_X, CT_D|CT_X, CT_D|CT_X, CT_D|CT_X, CT_D|CT_X, CT_D|CT_X, CT_D|CT_X, CT_D|CT_X, CT_D|CT_X, CT_P, CT_P, CT_P, CT_P, CT_P, CT_P,
+	CT_P, CT_U|CT_X, CT_U|CT_X, CT_U|CT_X, CT_U|CT_X, CT_U|CT_X, CT_U|CT_X, CT_U, CT_U, CT_U, CT_U, CT_U, CT_U, CT_U, CT_U, CT_U,
+	CT_U, CT_U, CT_U, CT_U, CT_U, CT_U, CT_U, CT_U, CT_U, CT_U, CT_U, CT_P, CT_P, CT_P, CT_P, CT_P,
+	CT_P, CT_L|CT_X, CT_L|CT_X, CT_L|CT_X, CT_L|CT_X, CT_L|CT_X, CT_L|CT_X, CT_L, CT_L, CT_L, CT_L, CT_L, CT_L, CT_L, CT_L, CT_L,
+	CT_L, CT_L, CT_L, CT_L, CT_L, CT_L, CT_L, CT_L, CT_L, CT_L, CT_L, CT_P, CT_P, CT_P, CT_P, CT_C,
+	/* 0x80..0xFF are in no class */
+};
+
 int isalpha(int c)
 {
-	return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'));
+	return CTYPE(c, CT_U | CT_L);
 }
 
 int isascii(int c)
@@ -39,66 +67,65 @@ int isascii(int c)
 
 int isblank(int c)
 {
-	return (c == ' ' || c == '\t');
+	return CTYPE(c, CT_B);
 }
 
 int iscntrl(int c)
 {
-	return (c <= 31 || c == 127);
+	return CTYPE(c, CT_C);
 }
 
 int isdigit(int c)
 {
-	return (c >= '0' && c <= '9');
+	return CTYPE(c, CT_D);
 }
 
 int isalnum(int c)
 {
-	return isalpha(c) || isdigit(c);
+	return CTYPE(c, CT_U | CT_L | CT_D);
 }
 
 int isgraph(int c)
 {
-	return (c >= 33 && c <= 126);
+	return CTYPE(c, CT_P | CT_U | CT_L | CT_D);
 }
 
 int islower(int c)
 {
-	return (c >= 'a' && c <= 'z');
+	return CTYPE(c, CT_L);
 }
 
 int isprint(int c)
 {
-	return (c >= 32 && c <= 126);
+	return (c == ' ') || CTYPE(c, CT_P | CT_U | CT_L | CT_D);
 }
 
-
 int isspace(int c)
 {
-	return (c == ' ' || (c >= '\t' || c <= '\r'));
+	return CTYPE(c, CT_S);
 }
 
 int isupper(int c)
 {
-	return (c >= 'A' && c <= 'Z');
+	return CTYPE(c, CT_U);
 }
 
 int tolower(int c)
 {
-	return (c >= 'A' && c <= 'Z') ? (c + 32) : c;
+	return CTYPE(c, CT_U) ? (c + 32) : c;
 }
 
 int toupper(int c)
 {
-	return (c >= 'a' && c <= 'z') ? (c - 32) : c;
+	return CTYPE(c, CT_L) ? (c - 32) : c;
 }
 
 int isxdigit(int c)
 {
-	return isdigit(c) || (tolower(c) >= 'a' && tolower(c) <= 'z');
+	return CTYPE(c, CT_X);
 }
 
 int ispunct(int c)
 {
-	return isprint(c) && !isspace(c) && !isalnum(c);
+	return CTYPE(c, CT_P);
 }
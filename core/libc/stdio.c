@@ -39,13 +39,41 @@
 #include <stdarg.h>
 #include <stdint.h>
 
+#include "projectconfig.h"
+#include "itoa.h"
+
 //------------------------------------------------------------------------------
 //         Local Definitions
 //------------------------------------------------------------------------------
 
-// Maximum string size allowed (in bytes).
+// Maximum string size allowed (in bytes) for vsprintf/sprintf.
 #define MAX_STRING_SIZE         255
 
+// Size of the chunks printf hands to puts (in bytes).
+#define PRINTF_CHUNK_SIZE       32
+
+// Output state shared by printf and the string functions. When 'stream' is
+// set, a full buffer is passed to puts and reused, otherwise output stops at
+// the end of the buffer (leaving room for the final '\0').
+typedef struct {
+
+    char *pStr;
+    char *pStart;
+    char *pEnd;
+    signed int count;
+    unsigned char stream;
+} Output;
+
+// "00" to "99", so decimal numbers are converted two digits per step.
+static const char DecimalPairs[200] =
+    "00010203040506070809" "10111213141516171819" "20212223242526272829"
+    "30313233343536373839" "40414243444546474849" "50515253545556575859"
+    "60616263646566676869" "70717273747576777879" "80818283848586878889"
+    "90919293949596979899";
+
+static const char HexDigitsLower[16] = "0123456789abcdef";
+static const char HexDigitsUpper[16] = "0123456789ABCDEF";
+
 //------------------------------------------------------------------------------
 //         Global Variables
 //------------------------------------------------------------------------------
@@ -59,219 +87,257 @@
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
-// Writes a character inside the given string. Returns 1.
-// \param pStr  Storage string.
-// \param c  Character to write.
+// Sends the buffered characters to puts and empties the buffer.
+// \param pOut  Output state.
 //------------------------------------------------------------------------------
-signed int append_char(char *pStr, char c)
+static void FlushOutput(Output *pOut)
 {
-    *pStr = c;
-    return 1;
+    if (pOut->pStr != pOut->pStart) {
+
+        *pOut->pStr = 0;
+        puts(pOut->pStart);
+        pOut->pStr = pOut->pStart;
+    }
 }
 
 //------------------------------------------------------------------------------
-// Writes a string inside the given string.
-// Returns the size of the written
-// string.
-// \param pStr  Storage string.
-// \param pSource  Source string.
+// Writes a character to the output.
+// \param pOut  Output state.
+// \param c  Character to write.
 //------------------------------------------------------------------------------
-signed int PutString(char *pStr, char fill, signed int width, const char *pSource)
+static void PutChar(Output *pOut, char c)
 {
-    signed int num = 0;
+    if (pOut->pStr == pOut->pEnd) {
 
-    while (*pSource != 0) {
+        if (!pOut->stream) {
 
-        *pStr++ = *pSource++;
-        num++;
+            return;
+        }
+        FlushOutput(pOut);
     }
 
-	width -= num;
-	while (width > 0) {
-
-        *pStr++ = fill;
-		num++;
-		width--;
-	}
-
-    return num;
+    *pOut->pStr++ = c;
+    pOut->count++;
 }
 
 //------------------------------------------------------------------------------
-// Writes an unsigned int inside the given string, using the provided fill &
-// width parameters.
-// Returns the size in characters of the written integer.
-// \param pStr  Storage string.
+// Writes 'width' fill characters to the output.
+// \param pOut  Output state.
 // \param fill  Fill character.
-// \param width  Minimum integer width.
-// \param value  Integer value.
+// \param width  Number of characters to write.
 //------------------------------------------------------------------------------
-signed int PutUnsignedInt(
-    char *pStr,
-    char fill,
-    signed int width,
-    unsigned int value)
+static void PutFill(Output *pOut, char fill, signed int width)
 {
-    signed int num = 0;
+    while (width-- > 0) {
 
-    // Take current digit into account when calculating width
-    width--;
-
-    // Recursively write upper digits
-    if ((value / 10) > 0) {
-
-        num = PutUnsignedInt(pStr, fill, width, value / 10);
-        pStr += num;
+        PutChar(pOut, fill);
     }
-    // Write filler characters
-    else {
+}
 
-        while (width > 0) {
+//------------------------------------------------------------------------------
+// Writes a string, padded on the right to 'width' characters.
+// \param pOut  Output state.
+// \param fill  Fill character.
+// \param width  Minimum string width.
+// \param pSource  Source string.
+//------------------------------------------------------------------------------
+static void PutString(Output *pOut, char fill, signed int width, const char *pSource)
+{
+    while (*pSource != 0) {
 
-            append_char(pStr, fill);
-            pStr++;
-            num++;
-            width--;
-        }
+        PutChar(pOut, *pSource++);
+        width--;
     }
 
-    // Write lower digit
-    num += append_char(pStr, (value % 10) + '0');
-
-    return num;
+    PutFill(pOut, fill, width);
 }
 
 //------------------------------------------------------------------------------
-// Writes a signed int inside the given string, using the provided fill & width
-// parameters.
-// Returns the size of the written integer.
-// \param pStr  Storage string.
-// \param fill  Fill character.
-// \param width  Minimum integer width.
-// \param value  Signed integer value.
+// Writes the digits of an unsigned value backwards, ending just before pEnd.
+// Decimal takes two digits per step from DecimalPairs: the divisions are by a
+// constant 100, which the compiler turns into a UMULL by the reciprocal, so
+// a 10 digit number costs five multiplies and no UDIV. Powers of two are
+// shifts and masks, and any other base (2..36) falls back to dividing.
+// Returns a pointer to the first digit.
+// \param pEnd  End of the digit buffer (at least 32 bytes for base 2).
+// \param value  Value to convert.
+// \param base  2..36.
+// \param maj  Indicates if letters must be printed in lower- or upper-case.
 //------------------------------------------------------------------------------
-signed int PutSignedInt(
-    char *pStr,
-    char fill,
-    signed int width,
-    signed int value)
+static char * FormatUnsigned(char *pEnd, unsigned int value, unsigned int base, unsigned char maj)
 {
-    signed int num = 0;
-    unsigned int absolute;
+    const char *pHex = maj ? HexDigitsUpper : HexDigitsLower;
+    char *p = pEnd;
+    unsigned int q, digit;
 
-    // Compute absolute value
-    if (value < 0) {
+    if (base == 10) {
 
-        absolute = -value;
-    }
-    else {
-
-        absolute = value;
-    }
-
-    // Take current digit into account when calculating width
-    width--;
+        while (value >= 100) {
 
-    // Recursively write upper digits
-    if ((absolute / 10) > 0) {
+            q = value / 100;
+            digit = (value - q * 100) * 2;
+            *--p = DecimalPairs[digit + 1];
+            *--p = DecimalPairs[digit];
+            value = q;
+        }
+        if (value >= 10) {
 
-        if (value < 0) {
-        
-            num = PutSignedInt(pStr, fill, width, -(absolute / 10));
+            *--p = DecimalPairs[value * 2 + 1];
+            *--p = DecimalPairs[value * 2];
         }
         else {
 
-            num = PutSignedInt(pStr, fill, width, absolute / 10);
+            *--p = '0' + value;
         }
-        pStr += num;
+    }
+    else if (base == 16) {
+
+        do {
+
+            *--p = pHex[value & 0xF];
+            value >>= 4;
+        } while (value);
     }
     else {
 
-        // Reserve space for sign
-        if (value < 0) {
+        do {
 
-            width--;
-        }
+            digit = value % base;
+            value /= base;
+            *--p = digit < 10 ? digit + '0' : digit - 10 + (maj ? 'A' : 'a');
+        } while (value);
+    }
 
-        // Write filler characters
-        while (width > 0) {
+    return p;
+}
 
-            append_char(pStr, fill);
-            pStr++;
-            num++;
-            width--;
-        }
+//------------------------------------------------------------------------------
+// Writes an unsigned value in base 10 or 16, padded on the left to 'width'
+// characters. The digits are built backwards in a small local buffer, so
+// there is no recursion.
+// \param pOut  Output state.
+// \param fill  Fill character.
+// \param width  Minimum width, including the sign.
+// \param value  Absolute value.
+// \param negative  Writes a '-' sign if set.
+// \param base  10 or 16.
+// \param maj  Indicates if hex letters must be printed in lower- or upper-case.
+//------------------------------------------------------------------------------
+static void PutNumber(
+    Output *pOut,
+    char fill,
+    signed int width,
+    unsigned int value,
+    unsigned char negative,
+    unsigned char base,
+    unsigned char maj)
+{
+    char digits[10];
+    char *pDigit = FormatUnsigned(digits + sizeof(digits), value, base, maj);
+    signed int num = digits + sizeof(digits) - pDigit;
 
-        // Write sign
-        if (value < 0) {
+    width -= num + (negative ? 1 : 0);
 
-            num += append_char(pStr, '-');
-            pStr++;
-        }
+    // '0' fill goes between the sign and the digits
+    if (negative && fill == '0') {
+
+        PutChar(pOut, '-');
+        negative = 0;
+    }
+    PutFill(pOut, fill, width);
+    if (negative) {
+
+        PutChar(pOut, '-');
     }
 
-    // Write lower digit
-    num += append_char(pStr, (absolute % 10) + '0');
+    while (num--) {
 
-    return num;
+        PutChar(pOut, *pDigit++);
+    }
 }
 
 //------------------------------------------------------------------------------
-// Writes an hexadecimal value into a string, using the given fill, width &
-// capital parameters.
-// Returns the number of char written.
-// \param pStr  Storage string.
-// \param fill  Fill character.
-// \param width  Minimum integer width.
-// \param maj  Indicates if the letters must be printed in lower- or upper-case.
-// \param value  Hexadecimal value.
+// Formats a string into the given output in a single pass.
+// Returns the number of characters written, or EOF on an unknown conversion.
+// \param pOut  Output state.
+// \param pFormat  Format string.
+// \param ap  Argument list.
 //------------------------------------------------------------------------------
-signed int PutHexa(
-    char *pStr,
-    char fill,
-    signed int width,
-    unsigned char maj,
-    unsigned int value)
+static signed int FormatOutput(Output *pOut, const char *pFormat, va_list ap)
 {
-    signed int num = 0;
+    char          fill;
+    signed int    width;
+    signed int    value;
 
-    // Decrement width
-    width--;
+    while (*pFormat != 0) {
+
+        // Normal character
+        if (*pFormat != '%') {
 
-    // Recursively output upper digits
-    if ((value >> 4) > 0) {
+            PutChar(pOut, *pFormat++);
+            continue;
+        }
 
-        num += PutHexa(pStr, fill, width, maj, value >> 4);
-        pStr += num;
-    }
-    // Write filler chars
-    else {
+        // Escaped '%'
+        pFormat++;
+        if (*pFormat == '%') {
+
+            PutChar(pOut, '%');
+            pFormat++;
+            continue;
+        }
+
+        fill = ' ';
+        width = 0;
 
-        while (width > 0) {
+#ifndef CFG_PRINTF_NOPADDING
+        // Parse filler
+        if (*pFormat == '0') {
 
-            append_char(pStr, fill);
-            pStr++;
-            num++;
-            width--;
+            fill = '0';
+            pFormat++;
         }
-    }
 
-    // Write current digit
-    if ((value & 0xF) < 10) {
+        // Ignore justifier
+        if (*pFormat == '-') {
 
-        append_char(pStr, (value & 0xF) + '0');
-    }
-    else if (maj) {
+            pFormat++;
+        }
 
-        append_char(pStr, (value & 0xF) - 10 + 'A');
-    }
-    else {
+        // Parse width
+        while ((*pFormat >= '0') && (*pFormat <= '9')) {
+
+            width = (width*10) + *pFormat-'0';
+            pFormat++;
+        }
+#else
+        // Skip any flags and width
+        while (*pFormat == '-' || ((*pFormat >= '0') && (*pFormat <= '9'))) {
 
-        append_char(pStr, (value & 0xF) - 10 + 'a');
+            pFormat++;
+        }
+#endif
+
+        // Parse type
+        switch (*pFormat) {
+        case 'd':
+        case 'i':
+            value = va_arg(ap, signed int);
+            PutNumber(pOut, fill, width, value < 0 ? -(unsigned int)value : (unsigned int)value, value < 0, 10, 0);
+            break;
+        case 'u': PutNumber(pOut, fill, width, va_arg(ap, unsigned int), 0, 10, 0); break;
+        case 'x': PutNumber(pOut, fill, width, va_arg(ap, unsigned int), 0, 16, 0); break;
+        case 'X': PutNumber(pOut, fill, width, va_arg(ap, unsigned int), 0, 16, 1); break;
+        case 's': PutString(pOut, fill, width, va_arg(ap, char *)); break;
+        case 'c': PutChar(pOut, va_arg(ap, unsigned int)); break;
+        default:
+            return EOF;
+        }
+
+        pFormat++;
     }
-    num++;
 
-    return num;
+    return pOut->count;
 }
 
 //------------------------------------------------------------------------------
@@ -289,94 +355,23 @@ signed int PutHexa(
 //------------------------------------------------------------------------------
 signed int vsnprintf(char *pStr, size_t length, const char *pFormat, va_list ap)
 {
-    char          fill;
-    unsigned char width;
-    signed int    num = 0;
-    signed int    size = 0;
+    Output out;
+    signed int size;
 
-    // Clear the string
-    if (pStr) {
+    if (!pStr || !length) {
 
-        *pStr = 0;
+        return 0;
     }
 
-    // Phase string
-    while (*pFormat != 0 && size < length) {
-
-        // Normal character
-        if (*pFormat != '%') {
-
-            *pStr++ = *pFormat++;
-            size++;
-        }
-        // Escaped '%'
-        else if (*(pFormat+1) == '%') {
-
-            *pStr++ = '%';
-            pFormat += 2;
-            size++;
-        }
-        // Token delimiter
-        else {
-
-            fill = ' ';
-            width = 0;
-            pFormat++;
+    // Keep the last byte for the final '\0' (which is not counted)
+    out.pStr = pStr;
+    out.pStart = pStr;
+    out.pEnd = pStr + length - 1;
+    out.count = 0;
+    out.stream = 0;
 
-            // Parse filler
-            if (*pFormat == '0') {
-
-                fill = '0';
-                pFormat++;
-            }
-
-            // Ignore justifier
-            if (*pFormat == '-') {
-                pFormat++;
-            }
-
-            // Parse width
-            while ((*pFormat >= '0') && (*pFormat <= '9')) {
-        
-                width = (width*10) + *pFormat-'0';
-                pFormat++;
-            }
-
-            // Check if there is enough space
-            if (size + width > length) {
-
-                width = length - size;
-            }
-        
-            // Parse type
-            switch (*pFormat) {
-            case 'd': 
-            case 'i': num = PutSignedInt(pStr, fill, width, va_arg(ap, signed int)); break;
-            case 'u': num = PutUnsignedInt(pStr, fill, width, va_arg(ap, unsigned int)); break;
-            case 'x': num = PutHexa(pStr, fill, width, 0, va_arg(ap, unsigned int)); break;
-            case 'X': num = PutHexa(pStr, fill, width, 1, va_arg(ap, unsigned int)); break;
-            case 's': num = PutString(pStr, fill, width, va_arg(ap, char *)); break;
-            case 'c': num = append_char(pStr, va_arg(ap, unsigned int)); break;
-            default:
-                return EOF;
-            }
-
-            pFormat++;
-            pStr += num;
-            size += num;
-        }
-    }
-
-    // NULL-terminated (final \0 is not counted)
-    if (size < length) {
-
-        *pStr = 0;
-    }
-    else {
-
-        *(--pStr) = 0;
-        size--;
-    }
+    size = FormatOutput(&out, pFormat, ap);
+    *out.pStr = 0;
 
     return size;
 }
@@ -417,24 +412,27 @@ signed int vsprintf(char *pString, const char *pFormat, va_list ap)
 
 //------------------------------------------------------------------------------
 /// Outputs a formatted string on the DBGU stream. Format arguments are given
-/// in a va_list instance.
+/// in a va_list instance. The output is formatted in a single pass and handed
+/// to puts in PRINTF_CHUNK_SIZE chunks, so there is no length limit.
 /// \param pFormat  Format string
 /// \param ap  Argument list.
 //------------------------------------------------------------------------------
 signed int vprintf(const char *pFormat, va_list ap)
 {
-  char pStr[MAX_STRING_SIZE];
-  char pError[] = "stdio.c: increase MAX_STRING_SIZE\r\n";
-  
-  // Write formatted string in buffer
-  if (vsprintf(pStr, pFormat, ap) >= MAX_STRING_SIZE) {
-    
-    puts(pError);
-    while (1); // Increase MAX_STRING_SIZE
-  }
-  
-  // Display string
-  return puts(pStr);
+    char pChunk[PRINTF_CHUNK_SIZE + 1];
+    Output out;
+    signed int size;
+
+    out.pStr = pChunk;
+    out.pStart = pChunk;
+    out.pEnd = pChunk + PRINTF_CHUNK_SIZE;
+    out.count = 0;
+    out.stream = 1;
+
+    size = FormatOutput(&out, pFormat, ap);
+    FlushOutput(&out);
+
+    return size;
 }
 
 //------------------------------------------------------------------------------
@@ -472,4 +470,52 @@ signed int sprintf(char *pStr, const char *pFormat, ...)
     va_end(ap);
 
     return result;
-}
\ No newline at end of file
+}
+
+//------------------------------------------------------------------------------
+/// Converts an unsigned value to a string, without going through the printf
+/// parser (for on-screen readouts and the like). Returns pStr, which must
+/// hold 33 bytes for base 2, or 11 for base 10. An invalid base gives an
+/// empty string.
+/// \param value  Value to convert.
+/// \param pStr  Destination string.
+/// \param base  2..36 (letters are lower-case).
+//------------------------------------------------------------------------------
+char * utoa(unsigned int value, char *pStr, int base)
+{
+    char digits[32];
+    char *pDigit;
+    char *p = pStr;
+
+    if (base >= 2 && base <= 36) {
+
+        pDigit = FormatUnsigned(digits + sizeof(digits), value, base, 0);
+        while (pDigit != digits + sizeof(digits)) {
+
+            *p++ = *pDigit++;
+        }
+    }
+    *p = 0;
+
+    return pStr;
+}
+
+//------------------------------------------------------------------------------
+/// Same as utoa for signed values. Only base 10 values get a '-' sign, other
+/// bases show the two's complement bits (like the usual itoa). Returns pStr,
+/// which must hold 12 bytes for base 10.
+/// \param value  Value to convert.
+/// \param pStr  Destination string.
+/// \param base  2..36.
+//------------------------------------------------------------------------------
+char * itoa(int value, char *pStr, int base)
+{
+    if (base == 10 && value < 0) {
+
+        *pStr = '-';
+        utoa(-(unsigned int)value, pStr + 1, base);
+        return pStr;
+    }
+
+    return utoa((unsigned int)value, pStr, base);
+}
@@ -36,6 +36,150 @@
 //------------------------------------------------------------------------------
 
 #include <string.h>
+#include <stdint.h>
+
+#include "sysdefs.h"
+
+//------------------------------------------------------------------------------
+//         Local Functions
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Returns non-zero if any of the four bytes in a word is zero. Subtracting 1
+// from every byte only sets the top bit of a byte that was 0 (or above 0x80,
+// which the ~w masks out); a borrow can set false bits, but only above a byte
+// that really is zero, so the result is always right about "any".
+// The string functions below use it to check four characters at a time. They
+// only ever read aligned words, so reading past the terminator stays within
+// the word that holds it and can't fault.
+//------------------------------------------------------------------------------
+static inline uint32_t WordHasZero(uint32_t w)
+{
+    return (w - 0x01010101) & ~w & 0x80808080;
+}
+
+//------------------------------------------------------------------------------
+// Copies words forward once the destination is word aligned. 16 bytes are
+// copied per iteration (loaded before they are stored, so the sequence can
+// be emitted as LDM/STM pairs), and a misaligned source is read one aligned
+// word at a time and shift-merged, so there are no byte accesses in the main
+// loop. This is also safe for overlapping buffers when destination < source.
+// Returns the number of bytes left to copy (less than 4).
+// \param ppDestination  Word aligned destination pointer (updated).
+// \param ppSource  Source pointer (updated).
+// \param num  Number of bytes to copy.
+//------------------------------------------------------------------------------
+RAMFUNC static size_t CopyWordsForward(unsigned char **ppDestination, const unsigned char **ppSource, size_t num)
+{
+    uint32_t *pDst = (uint32_t *) *ppDestination;
+    unsigned int offset = (uintptr_t) *ppSource & 0x3;
+    const uint32_t *pSrc = (const uint32_t *) (*ppSource - offset);
+    uint32_t w0, w1, w2, w3;
+
+    if (offset == 0) {
+
+        while (num >= 16) {
+
+            w0 = pSrc[0];
+            w1 = pSrc[1];
+            w2 = pSrc[2];
+            w3 = pSrc[3];
+            pDst[0] = w0;
+            pDst[1] = w1;
+            pDst[2] = w2;
+            pDst[3] = w3;
+            pSrc += 4;
+            pDst += 4;
+            num -= 16;
+        }
+        while (num >= 4) {
+
+            *pDst++ = *pSrc++;
+            num -= 4;
+        }
+    }
+    else {
+
+        // Little endian: the low bytes of each destination word come from
+        // the top of the previous source word
+        unsigned int shr = offset * 8;
+        unsigned int shl = 32 - shr;
+
+        w0 = *pSrc++;
+        while (num >= 4) {
+
+            w1 = *pSrc++;
+            *pDst++ = (w0 >> shr) | (w1 << shl);
+            w0 = w1;
+            num -= 4;
+        }
+        pSrc--;
+    }
+
+    *ppDestination = (unsigned char *) pDst;
+    *ppSource = (const unsigned char *) pSrc + offset;
+
+    return num;
+}
+
+//------------------------------------------------------------------------------
+// Same as CopyWordsForward, but copies downwards from the end of the buffers
+// (for memmove when destination > source). The pointers point just past the
+// bytes to copy, and the destination one must be word aligned.
+// Returns the number of bytes left to copy (less than 4).
+// \param ppDestination  Word aligned end of destination (updated).
+// \param ppSource  End of source (updated).
+// \param num  Number of bytes to copy.
+//------------------------------------------------------------------------------
+static size_t CopyWordsBackward(unsigned char **ppDestination, const unsigned char **ppSource, size_t num)
+{
+    uint32_t *pDst = (uint32_t *) *ppDestination;
+    unsigned int offset = (uintptr_t) *ppSource & 0x3;
+    const uint32_t *pSrc = (const uint32_t *) (*ppSource - offset);
+    uint32_t w0, w1, w2, w3;
+
+    if (offset == 0) {
+
+        while (num >= 16) {
+
+            pSrc -= 4;
+            pDst -= 4;
+            w0 = pSrc[0];
+            w1 = pSrc[1];
+            w2 = pSrc[2];
+            w3 = pSrc[3];
+            pDst[0] = w0;
+            pDst[1] = w1;
+            pDst[2] = w2;
+            pDst[3] = w3;
+            num -= 16;
+        }
+        while (num >= 4) {
+
+            *--pDst = *--pSrc;
+            num -= 4;
+        }
+    }
+    else {
+
+        unsigned int shr = offset * 8;
+        unsigned int shl = 32 - shr;
+
+        w1 = *pSrc;
+        while (num >= 4) {
+
+            w0 = *--pSrc;
+            *--pDst = (w0 >> shr) | (w1 << shl);
+            w1 = w0;
+            num -= 4;
+        }
+    }
+
+    *ppDestination = (unsigned char *) pDst;
+    *ppSource = (const unsigned char *) pSrc + offset;
+
+    return num;
+}
 
 //------------------------------------------------------------------------------
 //         Global Functions
@@ -48,29 +192,24 @@
 /// \param pSource  Source buffer.
 /// \param num  Number of bytes to copy.
 //------------------------------------------------------------------------------
-void * memcpy(void *pDestination, const void *pSource, size_t num)
+RAMFUNC void * memcpy(void *pDestination, const void *pSource, size_t num)
 {
-    unsigned char *pByteDestination;
-    unsigned char *pByteSource;
-    unsigned int *pAlignedSource = (unsigned int *) pSource;
-    unsigned int *pAlignedDestination = (unsigned int *) pDestination;
+    unsigned char *pByteDestination = (unsigned char *) pDestination;
+    const unsigned char *pByteSource = (const unsigned char *) pSource;
 
-    // If num is more than 4 bytes, and both dest. and source are aligned,
-    // then copy dwords
-    if ((((unsigned int) pAlignedDestination & 0x3) == 0)
-        && (((unsigned int) pAlignedSource & 0x3) == 0)
-        && (num >= 4)) {
+    // Short copies aren't worth aligning
+    if (num >= 8) {
 
-        while (num >= 4) {
+        // Align the destination, then copy words
+        while ((uintptr_t) pByteDestination & 0x3) {
 
-            *pAlignedDestination++ = *pAlignedSource++;
-            num -= 4;
+            *pByteDestination++ = *pByteSource++;
+            num--;
         }
+        num = CopyWordsForward(&pByteDestination, &pByteSource, num);
     }
 
     // Copy remaining bytes
-    pByteDestination = (unsigned char *) pAlignedDestination;
-    pByteSource = (unsigned char *) pAlignedSource;
     while (num--) {
 
         *pByteDestination++ = *pByteSource++;
@@ -88,42 +227,84 @@ void * memcpy(void *pDestination, const void *pSource, size_t num)
 //------------------------------------------------------------------------------
 void * memset(void *pBuffer, int value, size_t num)
 {
-    unsigned char *pByteDestination;
-    unsigned int  *pAlignedDestination = (unsigned int *) pBuffer;
-    unsigned int  alignedValue = (value << 24) | (value << 16) | (value << 8) | value;
+    unsigned char *pByteDestination = (unsigned char *) pBuffer;
+    uint32_t      *pAlignedDestination;
+    uint32_t      alignedValue = (value & 0xFF) * 0x01010101;
+
+    if (num >= 8) {
+
+        // Set bytes up to the first word boundary
+        while ((uintptr_t) pByteDestination & 0x3) {
 
-    // Set words if possible
-    if ((((unsigned int) pAlignedDestination & 0x3) == 0) && (num >= 4)) {
+            *pByteDestination++ = value;
+            num--;
+        }
+
+        // Set words, 16 bytes at a time
+        pAlignedDestination = (uint32_t *) pByteDestination;
+        while (num >= 16) {
+
+            pAlignedDestination[0] = alignedValue;
+            pAlignedDestination[1] = alignedValue;
+            pAlignedDestination[2] = alignedValue;
+            pAlignedDestination[3] = alignedValue;
+            pAlignedDestination += 4;
+            num -= 16;
+        }
         while (num >= 4) {
+
             *pAlignedDestination++ = alignedValue;
             num -= 4;
         }
+        pByteDestination = (unsigned char *) pAlignedDestination;
     }
+
     // Set remaining bytes
-    pByteDestination = (unsigned char *) pAlignedDestination;
     while (num--) {
+
         *pByteDestination++ = value;
     }
+
     return pBuffer;
 }
 
+//------------------------------------------------------------------------------
+/// Copies data from a source buffer into a destination buffer. The buffers
+/// may overlap. Returns the destination buffer.
+/// \param s1  Destination buffer.
+/// \param s2  Source buffer.
+/// \param n  Number of bytes to copy.
+//------------------------------------------------------------------------------
 void* memmove(void *s1, const void *s2, size_t n)
 {
-  char *s=(char*)s2, *d=(char*)s1;
-  
-  if(d > s){
-    s+=n-1;
-    d+=n-1;
-    while(n){
-      *d--=*s--;
-      n--;
+    unsigned char *d = (unsigned char *) s1;
+    const unsigned char *s = (const unsigned char *) s2;
+
+    if (d <= s || d >= s + n) {
+
+        // A forward copy never overwrites source bytes it still has to read
+        return memcpy(s1, s2, n);
     }
-  }else if(d < s)
-    while(n){
-      *d++=*s++;
-      n--;
+
+    // Overlapping with destination above the source: copy from the end
+    d += n;
+    s += n;
+    if (n >= 8) {
+
+        while ((uintptr_t) d & 0x3) {
+
+            *--d = *--s;
+            n--;
+        }
+        n = CopyWordsBackward(&d, &s, n);
     }
-  return s1;
+
+    while (n--) {
+
+        *--d = *--s;
+    }
+
+    return s1;
 }
 
 int memcmp(const void *av, const void *bv, size_t len)
@@ -152,16 +333,44 @@ int memcmp(const void *av, const void *bv, size_t len)
 //-----------------------------------------------------------------------------
 char * strchr(const char *pString, int character)
 {
-    char * p = (char *)pString;
-    char   c = character & 0xFF;
+    const char *p = pString;
+    char c = character & 0xFF;
+    const uint32_t *pWord;
+    uint32_t pattern = (uint32_t)(unsigned char) c * 0x01010101;
+    uint32_t w;
 
-    while(*p != c) {
+    // Bytes up to the first word boundary
+    while ((uintptr_t) p & 0x3) {
+
+        if (*p == c) {
+            return (char *) p;
+        }
         if (*p == 0) {
             return 0;
         }
         p++;
     }
-    return p;
+
+    // Skip words with neither the terminator nor the character in them
+    pWord = (const uint32_t *) p;
+    for (;;) {
+
+        w = *pWord;
+        if (WordHasZero(w) || WordHasZero(w ^ pattern)) {
+            break;
+        }
+        pWord++;
+    }
+
+    // The match is in this word
+    p = (const char *) pWord;
+    while (*p != c) {
+        if (*p == 0) {
+            return 0;
+        }
+        p++;
+    }
+    return (char *) p;
 }
 
 //-----------------------------------------------------------------------------
@@ -170,12 +379,31 @@ char * strchr(const char *pString, int character)
 //-----------------------------------------------------------------------------
 size_t strlen(const char *pString)
 {
-    unsigned int length = 0;
+    const char *p = pString;
+    const uint32_t *pWord;
+
+    // Bytes up to the first word boundary
+    while ((uintptr_t) p & 0x3) {
+
+        if (*p == 0) {
+            return p - pString;
+        }
+        p++;
+    }
+
+    // Words until one has a zero byte in it
+    pWord = (const uint32_t *) p;
+    while (!WordHasZero(*pWord)) {
 
-    while(*pString++ != 0) {
-        length++;
+        pWord++;
     }
-    return length;
+
+    // Find it
+    p = (const char *) pWord;
+    while (*p != 0) {
+        p++;
+    }
+    return p - pString;
 }
 
 
@@ -188,12 +416,14 @@ size_t strlen(const char *pString)
 char * strrchr(const char *pString, int character)
 {
     char *p = 0;
+    char  c = character & 0xFF;
 
-    while(*pString != 0) {
-        if (*pString++ == character) {
+    // The terminator counts as part of the string (so c = 0 finds it)
+    do {
+        if (*pString == c) {
             p = (char*)pString;
         }
-    }
+    } while(*pString++ != 0);
     return p;
 }
 
@@ -268,6 +498,28 @@ char * strncpy(char *pDestination, const char *pSource, size_t count)
 
 int strcmp(const char *s1, const char *s2)
 {
+  /*
+   * If both strings have the same alignment, compare a word at a time
+   * (command names and arguments are mostly a few words long) until the
+   * words differ or the first one holds the terminator, then finish off
+   * byte by byte.
+   */
+  if ((((uintptr_t)s1 ^ (uintptr_t)s2) & 0x3) == 0) {
+    while ((uintptr_t)s1 & 0x3) {
+      if (*s1 != *s2)
+        return (*(unsigned char *)s1 - *(unsigned char *)s2);
+      if (*s1 == 0)
+        return (0);
+      s1++;
+      s2++;
+    }
+    while (*(const uint32_t *)s1 == *(const uint32_t *)s2 &&
+           !WordHasZero(*(const uint32_t *)s1)) {
+      s1 += 4;
+      s2 += 4;
+    }
+  }
+
   while (*s1 == *s2++)
     if (*s1++ == 0)
       return (0);
@@ -0,0 +1,465 @@
+/**************************************************************************/
+/*! 
+    @file     logic.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Logic analyser capture of a GPIO port, streamed over USB
+
+    @section DESCRIPTION
+
+    Samples a whole GPIO port at a fixed rate from the 16-bit timer 0
+    match interrupt, with a single masked load of GPIOnDATA per sample,
+    into a ring of CFG_LOGIC_SAMPLES 16-bit samples.  The trigger is a
+    value on a set of pins ((sample & trigMask) == trigValue), and
+    fires on the first sample where the condition becomes true once
+    'preTrigger' samples have been collected, so the capture holds the
+    lead-up to the trigger as well as what follows.  A trigMask of 0
+    triggers straight away.
+
+    Once the capture is complete, logicPoll sends it RLE compressed
+    over the vendor bulk endpoint (CFG_USBCDC_VENDORBULK), one buffer
+    being filled while the other is on the bus.  Signals that are idle
+    most of the time compress to a few bytes per edge.  A capture
+    request from the host (see logic.h, and 'tools/logicdump' which
+    writes the capture as a VCD file) arms a new capture, so the host
+    can drive the whole thing without the CLI.
+
+    logicPoll runs from a scheduler task with CFG_SCHEDULER, and has to
+    be called from the main loop otherwise.
+
+    @section Example
+
+    @code 
+
+    #include "core/logic/logic.h"
+
+    // Port 2 pins 0-7 at 100kHz, trigger on a falling edge of 2.3 with
+    // 64 samples before it
+    logicStart(2, 0x00FF, 100000, 1 << 3, 0, CFG_LOGIC_SAMPLES, 64);
+
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "logic.h"
+
+#ifdef CFG_LOGIC
+
+#include "core/cpu/cpu.h"
+#include "core/gpio/gpio.h"
+#include "core/timer16/timer16.h"
+#include "core/usbcdc/usbvendor.h"
+#include "core/compress/varint.h"
+
+#ifdef CFG_SCHEDULER
+  #include "core/sched/sched.h"
+#endif
+
+#define LOGIC_RINGMASK          (CFG_LOGIC_SAMPLES - 1)
+#define LOGIC_RECORDSIZE        (2 + VARINT_MAXBYTES16)
+
+static uint16_t _logicRing[CFG_LOGIC_SAMPLES];
+static uint16_t _logicHead;             /* Next slot to write */
+static uint16_t _logicStored;           /* Samples in the ring, up to CFG_LOGIC_SAMPLES */
+
+static volatile logicState_t _logicState = LOGIC_STATE_IDLE;
+static REG32 *_logicData;               /* Masked GPIO data register */
+static uint8_t _logicPort;
+static uint16_t _logicMask;
+static uint32_t _logicRate;
+static uint16_t _logicTrigMask, _logicTrigValue;
+static bool _logicTrigWasTrue;
+static uint16_t _logicSamples, _logicPre;
+static uint16_t _logicRemaining;        /* Samples still to take after the trigger */
+static bool _logicTriggered;
+
+/* Capture being sent: the next sample, and how many are left */
+static uint16_t _logicSendPos, _logicSendLeft;
+static bool _logicHeaderSent;
+
+static uint8_t _logicBuffer[2][LOGIC_BUFFERSIZE];
+static uint16_t _logicQueued[2];        /* Bytes waiting in each buffer */
+static uint8_t _logicFill = 0;          /* Next buffer to encode into */
+static uint8_t _logicSend = 0;          /* Next buffer to send */
+static bool _logicInFlight = false;     /* _logicSend is on the bus */
+
+/* Capture requests from the host */
+static uint8_t _logicRequest[LOGIC_REQUESTSIZE];
+static volatile bool _logicRequested = false;
+
+#ifdef CFG_SCHEDULER
+static schedTask_t _logicTask;
+
+static void logicTask(schedTask_t *task)
+{
+  logicPoll();
+}
+#endif
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+static inline void logicPut16(uint8_t *buffer, uint16_t value)
+{
+  buffer[0] = value & 0xFF;
+  buffer[1] = value >> 8;
+}
+
+static inline uint16_t logicGet16(const uint8_t *buffer)
+{
+  return buffer[0] | (buffer[1] << 8);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Called from the USB interrupt when the host asks for a
+            capture
+*/
+/**************************************************************************/
+static void logicRequestReceived(uint8_t *buffer, uint32_t length)
+{
+  if ((length == LOGIC_REQUESTSIZE) && (buffer[0] == 'L'))
+  {
+    _logicRequested = true;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Encodes as much of the capture as fits in a buffer
+
+    @return The number of bytes used, 0 when everything has been sent
+*/
+/**************************************************************************/
+static uint16_t logicEncode(uint8_t *buffer)
+{
+  uint16_t len = 0, value;
+  uint32_t run;
+
+  if (!_logicHeaderSent)
+  {
+    buffer[0] = 'L';
+    buffer[1] = 'A';
+    buffer[2] = _logicPort;
+    buffer[3] = _logicTriggered ? LOGIC_FLAG_TRIGGERED : 0;
+    logicPut16(&buffer[4], _logicMask);
+    logicPut16(&buffer[6], _logicRate & 0xFFFF);
+    logicPut16(&buffer[8], _logicRate >> 16);
+    logicPut16(&buffer[10], _logicSendLeft);
+    logicPut16(&buffer[12], _logicPre);
+    _logicHeaderSent = true;
+    len = LOGIC_HEADERSIZE;
+  }
+
+  while (_logicSendLeft && (len + LOGIC_RECORDSIZE <= LOGIC_BUFFERSIZE))
+  {
+    value = _logicRing[_logicSendPos];
+    run = 0;
+    do
+    {
+      _logicSendPos = (_logicSendPos + 1) & LOGIC_RINGMASK;
+      _logicSendLeft--;
+      run++;
+    } while (_logicSendLeft && (_logicRing[_logicSendPos] == value));
+
+    logicPut16(&buffer[len], value);
+    len += 2;
+    len += varintPut(&buffer[len], run - 1);
+  }
+
+  return len;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts sending the next buffer if the endpoint is free
+*/
+/**************************************************************************/
+static void logicKick(void)
+{
+  // The buffer on the bus is free again once the transfer has ended
+  // (or was dropped by a USB reset)
+  if (_logicInFlight && !usbVendorSendBusy())
+  {
+    _logicInFlight = false;
+    _logicQueued[_logicSend] = 0;
+    _logicSend ^= 1;
+  }
+
+  if (!_logicInFlight && _logicQueued[_logicSend])
+  {
+    if (usbVendorSend(_logicBuffer[_logicSend], _logicQueued[_logicSend], NULL))
+    {
+      _logicInFlight = true;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Ends sampling (called from the timer interrupt or with it
+            disabled)
+*/
+/**************************************************************************/
+static void logicFinish(void)
+{
+  timer16Disable(0);
+  _logicState = LOGIC_STATE_DONE;
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Starts listening for capture requests from the host
+*/
+/**************************************************************************/
+void logicInit(void)
+{
+  NVIC_SetPriority(TIMER_16_0_IRQn, CFG_IRQPRIO_TIMER);
+
+  #ifdef CFG_SCHEDULER
+    schedTaskInit(&_logicTask, logicTask, NULL);
+    schedStartTimer(&_logicTask, 0, LOGIC_POLLMS);
+  #endif
+}
+
+/**************************************************************************/
+/*!
+    @brief  Arms a capture.  Any capture in progress or waiting to be
+            sent is dropped.
+
+    @param[in]  port
+                The GPIO port to sample (0..3)
+    @param[in]  mask
+                The pins of the port to sample (0 for all 12)
+    @param[in]  rateHz
+                Samples per second (up to LOGIC_MAXRATE)
+    @param[in]  trigMask
+                The pins that make up the trigger condition (0 triggers
+                straight away)
+    @param[in]  trigValue
+                The value of those pins that triggers the capture
+    @param[in]  samples
+                The capture length (up to CFG_LOGIC_SAMPLES, 0 for all)
+    @param[in]  preTrigger
+                How many of those samples are taken before the trigger
+
+    @return     false if an argument is out of range
+*/
+/**************************************************************************/
+bool logicStart(uint8_t port, uint16_t mask, uint32_t rateHz, uint16_t trigMask, uint16_t trigValue, uint16_t samples, uint16_t preTrigger)
+{
+  uint32_t ticks, prescale;
+
+  mask = mask ? (mask & 0xFFF) : 0xFFF;
+  samples = samples ? samples : CFG_LOGIC_SAMPLES;
+  if ((port > 3) || !rateHz || (rateHz > LOGIC_MAXRATE) || (samples > CFG_LOGIC_SAMPLES) || (preTrigger >= samples))
+  {
+    return false;
+  }
+
+  logicStop();
+  _logicState = LOGIC_STATE_IDLE;
+
+  _logicData = &GPIO_MASKEDDATA(port, mask);
+  _logicPort = port;
+  _logicMask = mask;
+  _logicRate = rateHz;
+  _logicTrigMask = trigMask & mask;
+  _logicTrigValue = trigValue & _logicTrigMask;
+  // Only a change into the trigger condition counts (unless there's
+  // no condition at all)
+  _logicTrigWasTrue = _logicTrigMask != 0;
+  _logicSamples = samples;
+  _logicPre = preTrigger;
+  _logicTriggered = false;
+  _logicHead = 0;
+  _logicStored = 0;
+
+  // The 16-bit match register holds up to 65536 ticks, so prescale
+  // slow rates
+  ticks = (cpuGetClock()/SCB_SYSAHBCLKDIV) / rateHz;
+  prescale = (ticks >> 16) + 1;
+  timer16Init(0, ticks / prescale - 1);
+  TMR_TMR16B0PR = prescale - 1;
+  TMR_TMR16B0TCR = TMR_TMR16B0TCR_COUNTERRESET_ENABLED;
+
+  _logicState = LOGIC_STATE_ARMED;
+  timer16Enable(0);
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Stops sampling.  A capture that has been armed but not
+            completed is sent as it is, with the samples taken so far.
+*/
+/**************************************************************************/
+void logicStop(void)
+{
+  NVIC_DisableIRQ(TIMER_16_0_IRQn);
+  if ((_logicState == LOGIC_STATE_ARMED) || (_logicState == LOGIC_STATE_TRIGGERED))
+  {
+    if (_logicSamples > _logicStored)
+    {
+      _logicSamples = _logicStored;
+    }
+    if (!_logicTriggered)
+    {
+      _logicPre = 0;
+    }
+    logicFinish();
+  }
+  NVIC_EnableIRQ(TIMER_16_0_IRQn);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the state of the capture engine
+*/
+/**************************************************************************/
+logicState_t logicGetState(void)
+{
+  return _logicState;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Takes one sample and checks the trigger.  Called from
+            TIMER16_0_IRQHandler once per sample period.
+*/
+/**************************************************************************/
+void logicTimerIRQ(void)
+{
+  uint16_t sample;
+  bool match;
+
+  if (_logicState == LOGIC_STATE_ARMED)
+  {
+    sample = *_logicData;
+    _logicRing[_logicHead] = sample;
+    _logicHead = (_logicHead + 1) & LOGIC_RINGMASK;
+    if (_logicStored < CFG_LOGIC_SAMPLES)
+    {
+      _logicStored++;
+    }
+
+    match = (sample & _logicTrigMask) == _logicTrigValue;
+    if (match && !_logicTrigWasTrue && (_logicStored > _logicPre))
+    {
+      _logicTriggered = true;
+      _logicRemaining = _logicSamples - _logicPre - 1;
+      if (_logicRemaining)
+      {
+        _logicState = LOGIC_STATE_TRIGGERED;
+      }
+      else
+      {
+        logicFinish();
+      }
+    }
+    _logicTrigWasTrue = match;
+  }
+  else if (_logicState == LOGIC_STATE_TRIGGERED)
+  {
+    _logicRing[_logicHead] = *_logicData;
+    _logicHead = (_logicHead + 1) & LOGIC_RINGMASK;
+    _logicStored++;
+    if (--_logicRemaining == 0)
+    {
+      logicFinish();
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts requested captures and sends completed ones, as far
+            as the two transmit buffers allow
+*/
+/**************************************************************************/
+void logicPoll(void)
+{
+  uint16_t len;
+  uint8_t *r = _logicRequest;
+
+  // Listen for capture requests from the host
+  if (_logicRequested)
+  {
+    _logicRequested = false;
+    logicStart(r[1], logicGet16(&r[2]), logicGet16(&r[4]) | ((uint32_t)logicGet16(&r[6]) << 16),
+               logicGet16(&r[8]), logicGet16(&r[10]), logicGet16(&r[12]), logicGet16(&r[14]));
+  }
+  if (!usbVendorReceiveBusy())
+  {
+    usbVendorReceive(_logicRequest, sizeof(_logicRequest), logicRequestReceived);
+  }
+
+  if (_logicState == LOGIC_STATE_DONE)
+  {
+    // The capture is the last _logicSamples samples in the ring
+    _logicSendPos = (_logicHead - _logicSamples) & LOGIC_RINGMASK;
+    _logicSendLeft = _logicSamples;
+    _logicHeaderSent = false;
+    _logicState = LOGIC_STATE_SENDING;
+  }
+
+  logicKick();
+
+  // Encode into the free buffer while the other one is being sent
+  if ((_logicState == LOGIC_STATE_SENDING) && !_logicQueued[_logicFill])
+  {
+    len = logicEncode(_logicBuffer[_logicFill]);
+    if (len)
+    {
+      _logicQueued[_logicFill] = len;
+      _logicFill ^= 1;
+      logicKick();
+    }
+    if (!_logicSendLeft)
+    {
+      _logicState = LOGIC_STATE_IDLE;
+    }
+  }
+}
+
+#endif
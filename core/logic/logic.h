@@ -0,0 +1,93 @@
+/**************************************************************************/
+/*! 
+    @file     logic.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef __LOGIC_H__ 
+#define __LOGIC_H__
+
+#include "projectconfig.h"
+
+#ifdef CFG_LOGIC
+
+/* Size of each of the two transmit buffers (one is filled while the
+   other is being sent) */
+#define LOGIC_BUFFERSIZE        (128)
+
+/* Poll period when running from the scheduler */
+#define LOGIC_POLLMS            (10)
+
+/* Highest sample rate accepted (one timer interrupt per sample) */
+#define LOGIC_MAXRATE           (250000)
+
+/* Capture request from the host (OUT endpoint), all values are
+   little-endian:
+
+   'L' <port:8> <mask:16> <rate:32> <trigMask:16> <trigValue:16>
+   <samples:16> <preTrigger:16>
+
+   Capture stream to the host (IN endpoint):
+
+   'L' 'A' <port:8> <flags:8> <mask:16> <rate:32> <samples:16>
+   <trigger:16>
+           followed by RLE records until 'samples' samples have been
+           sent: the port value masked with 'mask' (16 bits) and a
+           varint (see core/compress/varint.c) with the number of
+           samples it was held for minus one.  'trigger' is the index
+           of the sample that matched the trigger, and bit 0 of
+           'flags' is set if the capture was triggered (rather than
+           stopped with logicStop). */
+#define LOGIC_REQUESTSIZE       (16)
+#define LOGIC_HEADERSIZE        (14)
+#define LOGIC_FLAG_TRIGGERED    (0x01)
+
+typedef enum
+{
+  LOGIC_STATE_IDLE = 0,
+  LOGIC_STATE_ARMED,                    /* Sampling, waiting for the trigger */
+  LOGIC_STATE_TRIGGERED,                /* Sampling the rest of the capture */
+  LOGIC_STATE_DONE,                     /* Waiting to be sent */
+  LOGIC_STATE_SENDING
+} logicState_t;
+
+void         logicInit ( void );
+bool         logicStart ( uint8_t port, uint16_t mask, uint32_t rateHz, uint16_t trigMask, uint16_t trigValue, uint16_t samples, uint16_t preTrigger );
+void         logicStop ( void );
+logicState_t logicGetState ( void );
+void         logicPoll ( void );
+void         logicTimerIRQ ( void );
+
+#endif
+
+#endif
@@ -52,7 +52,16 @@
 #ifdef CFG_CHIBI
   #include "drivers/chibi/chb_drvr.h"
 #endif
-#define PMU_WDTCLOCKSPEED_HZ 7812
+// 0.5MHz / 4.  A faster WDT clock costs very little in deep-sleep, but
+// the wakeup handler runs from it until the IRC is selected, so a slow
+// one makes every wake-up take milliseconds
+#define PMU_WDTCLOCKSPEED_HZ 125000
+
+// Set while the main clock runs from the WDT oscillator
+static bool _pmuWDTClock = false;
+
+// Time taken by the last wake-up (see pmuGetWakeLatency)
+static uint32_t _pmuWakeLatency = 0;
 
 void pmuSetupHW(void);
 void pmuRestoreHW(void);
@@ -66,9 +75,13 @@ void pmuRestoreHW(void);
 void WAKEUP_IRQHandler(void)
 {
   uint32_t regVal;
+  uint32_t start, irc;
 
-  // Reconfigure system clock/PLL
-  cpuPllSetup(CPU_MULTIPLIER_6);
+  // Get off the WDT oscillator first, and leave the PLL (powered up
+  // again by the hardware) locking while everything else is restored
+  start = DWT_CYCCNT;
+  cpuWakeStart();
+  irc = DWT_CYCCNT;
 
   // Clear match bit on timer
   TMR_TMR32B0EMR = 0;
@@ -97,6 +110,22 @@ void WAKEUP_IRQHandler(void)
   // Perform peripheral specific and custom wakeup tasks
   pmuRestoreHW();
 
+  // Back to full speed
+  cpuWakeFinish();
+
+  // The cycles before the IRC was selected ran at the WDT (or the old
+  // main) clock, the rest at 12MHz
+  _pmuWakeLatency = (DWT_CYCCNT - irc) / 12;
+  if (_pmuWDTClock)
+  {
+    _pmuWakeLatency += (irc - start) * (1000000 / PMU_WDTCLOCKSPEED_HZ);
+    _pmuWDTClock = false;
+  }
+  else
+  {
+    _pmuWakeLatency += (irc - start) / (cpuGetClock() / 1000000);
+  }
+
   /* See tracker for bug report. */
   __asm volatile ("NOP");
 
@@ -105,7 +134,7 @@ void WAKEUP_IRQHandler(void)
 
 /**************************************************************************/
 /*! 
-    Setup the clock for the watchdog timer.  The default is 7.8125kHz.
+    Setup the clock for the watchdog timer.  The default is 125kHz.
 */
 /**************************************************************************/
 static void pmuWDTClockInit (void)
@@ -114,9 +143,9 @@ static void pmuWDTClockInit (void)
   SCB_PDRUNCFG &= ~(SCB_PDRUNCFG_WDTOSC);
 
   /* Configure watchdog clock */
-  /* Freq. = 0.5MHz, div = 64: WDT_OSC = 7.8125kHz  */
+  /* Freq. = 0.5MHz, div = 4: WDT_OSC = 125kHz  */
   SCB_WDTOSCCTRL = SCB_WDTOSCCTRL_FREQSEL_0_5MHZ | 
-                   SCB_WDTOSCCTRL_DIVSEL_DIV64;
+                   SCB_WDTOSCCTRL_DIVSEL_DIV4;
 
   // Switch main clock to WDT output
   SCB_MAINCLKSEL = SCB_MAINCLKSEL_SOURCE_WDTOSC;
@@ -126,6 +155,7 @@ static void pmuWDTClockInit (void)
 
   // Wait until the clock is updated
   while (!(SCB_MAINCLKUEN & SCB_MAINCLKUEN_UPDATE));
+  _pmuWDTClock = true;
 }
 
 /**************************************************************************/
@@ -140,9 +170,27 @@ void pmuInit( void )
                     SCB_PDRUNCFG_SYSOSC_MASK | 
                     SCB_PDRUNCFG_ADC_MASK);
 
+  /* Start the cycle counter (used to time the wake-ups) if it isn't
+     already running */
+  SCB_DEMCR |= 0x01000000;
+  DWT_CTRL |= 1;
+
   return;
 }
 
+/**************************************************************************/
+/*! 
+    @brief  Returns the time in microseconds spent in the wakeup handler
+            after the last deep-sleep, until the PLL was running again
+            and the peripherals were restored.  The hardware wake-up
+            time before the handler runs isn't included.
+*/
+/**************************************************************************/
+uint32_t pmuGetWakeLatency( void )
+{
+  return _pmuWakeLatency;
+}
+
 /**************************************************************************/
 /*! 
     @brief Puts select peripherals in sleep mode.
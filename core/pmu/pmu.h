@@ -46,5 +46,6 @@ void pmuInit( void );
 void pmuSleep( void );
 void pmuDeepSleep(uint32_t sleepCtrl, uint32_t wakeupSeconds);
 void pmuPowerDown( void );
+uint32_t pmuGetWakeLatency( void );
 
 #endif
@@ -0,0 +1,254 @@
+/**************************************************************************/
+/*! 
+    @file     pool.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Fixed-block memory pool for temporary buffers that would otherwise
+    be declared on the stack.  There are three block sizes (set with
+    CFG_POOL_SMALLSIZE, CFG_POOL_MEDIUMSIZE and CFG_POOL_LARGESIZE in
+    projectconfig.h), each with its own statically allocated storage.
+
+    poolAlloc returns a block from the smallest class that fits, or
+    from a larger class if that one is exhausted, and poolFree finds the
+    class from the address alone.  Both take a fixed amount of time
+    (there is no searching or coalescing), so they can be used from
+    interrupt handlers as well.  Blocks that have never been used are
+    handed out in order, and freed blocks are kept in a list threaded
+    through the blocks themselves, so there is nothing to initialise.
+
+    @section Example
+
+    @code 
+    #include "core/pool/pool.h"
+
+    uint8_t *buffer = poolAlloc(128);
+    if (buffer)
+    {
+      // Use the buffer ...
+      poolFree(buffer);
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "pool.h"
+
+#ifdef CFG_POOL
+
+typedef struct poolBlock_s
+{
+  struct poolBlock_s *next;
+} poolBlock_t;
+
+typedef struct
+{
+  uint8_t *start;                     // First block
+  uint8_t *end;                       // Just past the last block
+  uint16_t blockSize;
+  uint8_t  blockCount;
+  uint8_t  fresh;                     // Blocks handed out at least once
+  uint8_t  used;
+  uint16_t misses;
+  poolBlock_t *freeList;
+} poolClass_t;
+
+// uint32_t keeps every block word aligned
+static uint32_t _poolSmall[(CFG_POOL_SMALLSIZE / 4) * CFG_POOL_SMALLCOUNT];
+static uint32_t _poolMedium[(CFG_POOL_MEDIUMSIZE / 4) * CFG_POOL_MEDIUMCOUNT];
+static uint32_t _poolLarge[(CFG_POOL_LARGESIZE / 4) * CFG_POOL_LARGECOUNT];
+
+static poolClass_t _poolClasses[POOL_CLASSES] =
+{
+  { (uint8_t *)_poolSmall,  (uint8_t *)_poolSmall + sizeof(_poolSmall),
+    CFG_POOL_SMALLSIZE,  CFG_POOL_SMALLCOUNT,  0, 0, 0, NULL },
+  { (uint8_t *)_poolMedium, (uint8_t *)_poolMedium + sizeof(_poolMedium),
+    CFG_POOL_MEDIUMSIZE, CFG_POOL_MEDIUMCOUNT, 0, 0, 0, NULL },
+  { (uint8_t *)_poolLarge,  (uint8_t *)_poolLarge + sizeof(_poolLarge),
+    CFG_POOL_LARGESIZE,  CFG_POOL_LARGECOUNT,  0, 0, 0, NULL }
+};
+
+/**************************************************************************/
+/*! 
+    @brief  Disables interrupts and returns the previous PRIMASK, so
+            that the pool can also be used with interrupts disabled
+*/
+/**************************************************************************/
+static inline uint32_t poolLock(void)
+{
+  uint32_t primask;
+
+  __asm volatile ("mrs %0, primask" : "=r" (primask));
+  __disable_irq();
+  return primask;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Restores the interrupt state saved by poolLock
+*/
+/**************************************************************************/
+static inline void poolUnlock(uint32_t primask)
+{
+  if (!primask)
+  {
+    __enable_irq();
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Allocates a block of at least 'size' bytes
+
+    @param[in]  size
+                The number of bytes needed
+
+    @return     A word aligned block, or NULL if every block that is big
+                enough is in use
+*/
+/**************************************************************************/
+void *poolAlloc(size_t size)
+{
+  poolClass_t *pool;
+  poolBlock_t *block = NULL;
+  bool missed = false;
+  uint32_t primask;
+  uint8_t i;
+
+  primask = poolLock();
+  for (i = 0; i < POOL_CLASSES; i++)
+  {
+    pool = &_poolClasses[i];
+    if (size > pool->blockSize)
+    {
+      continue;
+    }
+
+    if (pool->freeList)
+    {
+      block = pool->freeList;
+      pool->freeList = block->next;
+    }
+    else if (pool->fresh < pool->blockCount)
+    {
+      block = (poolBlock_t *)(pool->start + pool->fresh * pool->blockSize);
+      pool->fresh++;
+    }
+    else
+    {
+      // Count the miss against the class that should have been used
+      // and try the next size up
+      if (!missed)
+      {
+        pool->misses++;
+        missed = true;
+      }
+      continue;
+    }
+
+    pool->used++;
+    break;
+  }
+  poolUnlock(primask);
+
+  return block;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns a block to the pool
+
+    @param[in]  block
+                A block returned by poolAlloc (NULL is ignored)
+*/
+/**************************************************************************/
+void poolFree(void *block)
+{
+  poolClass_t *pool;
+  uint32_t primask;
+  uint8_t i;
+
+  if (block == NULL)
+  {
+    return;
+  }
+
+  for (i = 0; i < POOL_CLASSES; i++)
+  {
+    pool = &_poolClasses[i];
+    if (((uint8_t *)block >= pool->start) && ((uint8_t *)block < pool->end))
+    {
+      primask = poolLock();
+      ((poolBlock_t *)block)->next = pool->freeList;
+      pool->freeList = (poolBlock_t *)block;
+      pool->used--;
+      poolUnlock(primask);
+      return;
+    }
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Gets the usage statistics for one block size
+
+    @param[in]  poolClass
+                0 for the small blocks, 1 for the medium blocks and 2 for
+                the large blocks
+    @param[out] stats
+                Filled in with the current statistics
+
+    @return     false if poolClass is out of range
+*/
+/**************************************************************************/
+bool poolGetStats(uint8_t poolClass, poolStats_t *stats)
+{
+  poolClass_t *pool;
+
+  if (poolClass >= POOL_CLASSES)
+  {
+    return false;
+  }
+
+  pool = &_poolClasses[poolClass];
+  stats->blockSize = pool->blockSize;
+  stats->blockCount = pool->blockCount;
+  stats->used = pool->used;
+  // Fresh blocks are only handed out when the free list is empty, so
+  // the number handed out so far is the most that were in use at once
+  stats->peak = pool->fresh;
+  stats->misses = pool->misses;
+
+  return true;
+}
+
+#endif
@@ -0,0 +1,63 @@
+/**************************************************************************/
+/*! 
+    @file     pool.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include "projectconfig.h"
+
+#define POOL_CLASSES  (3)
+
+/**************************************************************************/
+/*! 
+    Usage statistics for one block size (see poolGetStats)
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint16_t blockSize;                 // Size of each block in bytes
+  uint8_t  blockCount;                // Total number of blocks
+  uint8_t  used;                      // Blocks currently allocated
+  uint8_t  peak;                      // Most blocks ever allocated at once
+  uint16_t misses;                    // Requests this size couldn't meet
+                                      // (served by a larger size or not
+                                      // at all)
+} poolStats_t;
+
+void *poolAlloc ( size_t size );
+void  poolFree ( void *block );
+bool  poolGetStats ( uint8_t poolClass, poolStats_t *stats );
+
+#endif
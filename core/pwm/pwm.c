@@ -28,6 +28,30 @@
 
     @endcode
 
+    Playback mode updates the duty cycle (or frequency) from the timer's
+    own MR3 interrupt, once per PWM period, so sounds play in the
+    background without any delays in the main loop.  8-bit PCM samples
+    are played with a PWM period of one sample (pwmPlaybackStart), either
+    straight from a buffer in flash or streamed through a double buffer
+    that is refilled by a callback.  Note sequences (pwmPlayNotes) set
+    the frequency of a 50% square wave for each note:
+
+    @code 
+    static const pwmNote_t alert[] = { { 4000, 100 }, { 0, 50 }, { 2000, 200 } };
+
+    pwmPlayNotes(alert, sizeof(alert) / sizeof(pwmNote_t));
+
+    // 8-bit PCM at 16kHz, refilled 64 samples at a time from the ISR
+    static uint8_t pcm[128];
+    uint32_t fill(uint8_t *samples, uint32_t count)
+    {
+      // Copy up to 'count' samples, returning fewer at the end
+      ...
+    }
+
+    pwmPlaybackStart(16000, pcm, sizeof(pcm), fill);
+    @endcode
+
     @section LICENSE
 
     Software License Agreement (BSD License)
@@ -68,6 +92,27 @@ uint32_t pwmDutyCycle = CFG_PWM_DEFAULT_DUTYCYCLE;
 // pwmStartFixed() is used.
 volatile uint32_t pwmMaxPulses = 0;
 
+typedef enum
+{
+  PWM_PLAY_NONE = 0,
+  PWM_PLAY_PCM,
+  PWM_PLAY_NOTES
+} pwmPlayMode_t;
+
+// Playback state, updated by pwmPlaybackIRQ on every MR3 match
+static volatile pwmPlayMode_t pwmPlayMode = PWM_PLAY_NONE;
+static uint32_t pwmPlayPeriod;                // Ticks per sample (PCM)
+static uint8_t *pwmPlayBuffer;
+static uint32_t pwmPlayHalf;                  // Samples in each half of the buffer
+static uint32_t pwmPlayCount[2];              // Valid samples in each half
+static uint32_t pwmPlayPos;
+static uint8_t pwmPlayCur;                    // Half being played
+static bool pwmPlayEnding;                    // The callback has run out of data
+static pwmRefillCallback_t pwmPlayCallback;
+static const pwmNote_t *pwmNotes;
+static uint32_t pwmNotesLeft;
+static uint32_t pwmNotePeriods;               // Periods left in the current note
+
 /**************************************************************************/
 /*! 
     Initialises 16-bit Timer 1, and configures the MAT0 output (pin 1.9) 
@@ -104,6 +149,7 @@ void pwmInit(void)
   TMR_TMR16B1PWMC = TMR_TMR16B1PWMC_PWM0_ENABLED | TMR_TMR16B1PWMC_PWM3_ENABLED;
 
   /* Make sure that the timer interrupt is enabled */
+  NVIC_SetPriority(TIMER_16_1_IRQn, CFG_IRQPRIO_TIMER);
   NVIC_EnableIRQ(TIMER_16_1_IRQn);
 }
 
@@ -235,7 +281,7 @@ int pwmSetFrequencyInMicroseconds(uint16_t us)
     return -1;
   }
 
-  uint32_t ticks = (((CFG_CPU_CCLK/SCB_SYSAHBCLKDIV) / 1000000) * us);
+  uint32_t ticks = (((cpuGetClock()/SCB_SYSAHBCLKDIV) / 1000000) * us);
   if (ticks > 0xFFFF)
   {
     /* Delay exceeds the upper limit for the 16-bit timer */
@@ -251,4 +297,232 @@ int pwmSetFrequencyInMicroseconds(uint16_t us)
   return 0;  
 }
 
+/**************************************************************************/
+/*! 
+    Private - Sets the timer up for one note
+*/
+/**************************************************************************/
+static void pwmStartNote(const pwmNote_t *note)
+{
+  uint32_t clk = cpuGetClock()/SCB_SYSAHBCLKDIV;
+  uint32_t freq = note->frequency ? note->frequency : PWM_PLAYBACK_RESTHZ;
+  uint32_t period = clk / freq;
+
+  if (period > 0xFFFF)
+  {
+    period = 0xFFFF;
+  }
+
+  TMR_TMR16B1MR3 = period;
+  // A match value above MR3 holds the output low for a rest
+  TMR_TMR16B1MR0 = note->frequency ? period / 2 : 0xFFFF;
+  pwmNotePeriods = ((uint32_t)note->duration * freq) / 1000;
+  if (!pwmNotePeriods)
+  {
+    pwmNotePeriods = 1;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    Private - Enables the MR3 interrupt and starts the timer from 0
+*/
+/**************************************************************************/
+static void pwmPlaybackRun(pwmPlayMode_t mode)
+{
+  pwmMaxPulses = 0;
+  pwmPlayMode = mode;
+  TMR_TMR16B1TCR = TMR_TMR16B1TCR_COUNTERRESET_ENABLED;
+  TMR_TMR16B1IR = TMR_TMR16B1IR_MR3;
+  TMR_TMR16B1MCR |= (TMR_TMR16B1MCR_MR3_INT_ENABLED);
+  TMR_TMR16B1TCR = TMR_TMR16B1TCR_COUNTERENABLE_ENABLED;
+}
+
+/**************************************************************************/
+/*! 
+    Starts playing 8-bit unsigned PCM samples in the background, with
+    one PWM period per sample (the duty cycle follows the sample value).
+
+    @param[in]  sampleRate
+                Samples per second (PWM_PLAYBACK_MINHZ or higher, since
+                each period has to fit in the 16-bit timer)
+    @param[in]  buffer
+                The samples.  Without a callback the buffer (which can be
+                in flash) is played once.  With a callback it is used as
+                a double buffer: each half is passed to the callback to
+                be refilled as soon as it has been played, and both
+                halves are filled by the callback before playback starts.
+    @param[in]  len
+                The size of the buffer in samples
+    @param[in]  callback
+                Refill callback or 0.  It is called from the timer ISR
+                and returns the number of samples it copied; returning
+                fewer than asked ends playback after those samples.
+
+    @returns    -1 if the rate or buffer are invalid.
+
+    @warning    Sharing 16-bit timer 1 with pwmStart, pwmStartFixed and
+                the frequency and duty cycle settings, which are restored
+                when playback stops.
+*/
+/**************************************************************************/
+int pwmPlaybackStart(uint32_t sampleRate, uint8_t *buffer, uint32_t len, pwmRefillCallback_t callback)
+{
+  uint32_t period;
+
+  if (!sampleRate || !buffer || (len < (callback ? 2 : 1)))
+  {
+    return -1;
+  }
+
+  period = (cpuGetClock()/SCB_SYSAHBCLKDIV) / sampleRate;
+  if ((period > 0xFFFF) || (period < 256))
+  {
+    /* One sample must fit in the 16-bit timer, with 8-bit resolution */
+    return -1;
+  }
+
+  pwmPlaybackStop();
+
+  pwmPlayPeriod = period;
+  pwmPlayBuffer = buffer;
+  pwmPlayCallback = callback;
+  pwmPlayPos = 0;
+  pwmPlayCur = 0;
+  if (callback)
+  {
+    pwmPlayHalf = len / 2;
+    pwmPlayCount[0] = callback(buffer, pwmPlayHalf);
+    pwmPlayCount[1] = pwmPlayCount[0] < pwmPlayHalf ? 0 : callback(buffer + pwmPlayHalf, pwmPlayHalf);
+    pwmPlayEnding = pwmPlayCount[1] < pwmPlayHalf;
+  }
+  else
+  {
+    pwmPlayHalf = len;
+    pwmPlayCount[0] = len;
+    pwmPlayCount[1] = 0;
+    pwmPlayEnding = true;
+  }
+
+  /* Silent (low) until the first sample is loaded by the ISR */
+  TMR_TMR16B1MR3 = period;
+  TMR_TMR16B1MR0 = period;
+  pwmPlaybackRun(PWM_PLAY_PCM);
+
+  return 0;
+}
+
+/**************************************************************************/
+/*! 
+    Plays a sequence of notes (50% square waves) in the background.
+
+    @param[in]  notes
+                The notes, which can be in flash.  A frequency of 0 is
+                a rest.  Frequencies are limited to PWM_PLAYBACK_MINHZ
+                and up (~1.1kHz at 72MHz), which suits piezo buzzers.
+    @param[in]  count
+                The number of notes
+
+    @returns    -1 if there are no notes.
+*/
+/**************************************************************************/
+int pwmPlayNotes(const pwmNote_t *notes, uint32_t count)
+{
+  if (!notes || !count)
+  {
+    return -1;
+  }
+
+  pwmPlaybackStop();
+
+  pwmNotes = notes + 1;
+  pwmNotesLeft = count - 1;
+  pwmStartNote(notes);
+  pwmPlaybackRun(PWM_PLAY_NOTES);
 
+  return 0;
+}
+
+/**************************************************************************/
+/*! 
+    Stops PCM or note playback, and restores the previous frequency and
+    duty cycle (the output is left off).
+*/
+/**************************************************************************/
+void pwmPlaybackStop(void)
+{
+  if (pwmPlayMode == PWM_PLAY_NONE)
+  {
+    return;
+  }
+
+  TMR_TMR16B1TCR &= ~(TMR_TMR16B1TCR_COUNTERENABLE_MASK);
+  TMR_TMR16B1MCR &= ~(TMR_TMR16B1MCR_MR3_INT_MASK);
+  pwmPlayMode = PWM_PLAY_NONE;
+
+  TMR_TMR16B1MR3 = pwmPulseWidth;
+  TMR_TMR16B1MR0 = (pwmPulseWidth * (100 - pwmDutyCycle)) / 100;
+}
+
+/**************************************************************************/
+/*! 
+    Returns true while PCM samples or notes are being played
+*/
+/**************************************************************************/
+bool pwmPlaybackIsActive(void)
+{
+  return pwmPlayMode != PWM_PLAY_NONE;
+}
+
+/**************************************************************************/
+/*! 
+    Loads the next sample or note.  Called from TIMER16_1_IRQHandler on
+    every MR3 match (the start of each PWM period) during playback.
+*/
+/**************************************************************************/
+void pwmPlaybackIRQ(void)
+{
+  uint8_t *half;
+
+  if (pwmPlayMode == PWM_PLAY_NOTES)
+  {
+    if (--pwmNotePeriods)
+    {
+      return;
+    }
+    if (!pwmNotesLeft)
+    {
+      pwmPlaybackStop();
+      return;
+    }
+    pwmNotesLeft--;
+    pwmStartNote(pwmNotes++);
+    return;
+  }
+
+  if (pwmPlayPos >= pwmPlayCount[pwmPlayCur])
+  {
+    /* The last sample has been played */
+    pwmPlaybackStop();
+    return;
+  }
+
+  half = pwmPlayBuffer + pwmPlayCur * pwmPlayHalf;
+  TMR_TMR16B1MR0 = pwmPlayPeriod - ((pwmPlayPeriod * half[pwmPlayPos]) >> 8);
+
+  if (++pwmPlayPos == pwmPlayCount[pwmPlayCur])
+  {
+    /* Refill this half while the other one plays */
+    if (pwmPlayEnding)
+    {
+      pwmPlayCount[pwmPlayCur] = 0;
+    }
+    else
+    {
+      pwmPlayCount[pwmPlayCur] = pwmPlayCallback(half, pwmPlayHalf);
+      pwmPlayEnding = pwmPlayCount[pwmPlayCur] < pwmPlayHalf;
+    }
+    pwmPlayCur ^= 1;
+    pwmPlayPos = 0;
+  }
+}
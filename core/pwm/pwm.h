@@ -38,6 +38,27 @@
 #define _PWM_H_
 
 #include "projectconfig.h"
+#include "core/cpu/cpu.h"
+
+/* Lowest PCM sample rate or note frequency that fits in the 16-bit timer */
+#define PWM_PLAYBACK_MINHZ      ((cpuGetClock()/SCB_SYSAHBCLKDIV) / 0xFFFF + 1)
+/* Timebase used to count the length of rests */
+#define PWM_PLAYBACK_RESTHZ     (4000)
+
+/**************************************************************************/
+/*! 
+    Refills 'count' PCM samples during playback (called from the timer
+    ISR).  Returns the number of samples copied, and fewer than 'count'
+    ends playback.
+*/
+/**************************************************************************/
+typedef uint32_t (*pwmRefillCallback_t)(uint8_t *samples, uint32_t count);
+
+typedef struct
+{
+  uint16_t frequency;     // Hz, or 0 for a rest
+  uint16_t duration;      // ms
+} pwmNote_t;
 
 void pwmInit( void );
 void pwmStart( void );
@@ -46,5 +67,10 @@ void pwmStartFixed( uint32_t pulses );
 int  pwmSetDutyCycle( uint32_t percentage );
 int  pwmSetFrequencyInTicks( uint16_t ticks );
 int  pwmSetFrequencyInMicroseconds(uint16_t us );
+int  pwmPlaybackStart( uint32_t sampleRate, uint8_t *buffer, uint32_t len, pwmRefillCallback_t callback );
+int  pwmPlayNotes( const pwmNote_t *notes, uint32_t count );
+void pwmPlaybackStop( void );
+bool pwmPlaybackIsActive( void );
+void pwmPlaybackIRQ( void );
 
 #endif
\ No newline at end of file
@@ -0,0 +1,220 @@
+/**************************************************************************/
+/*! 
+    @file     event.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Event flags: a 32-bit word that interrupt handlers set bits in and
+    the main code takes them back out of.  The updates use LDREX/STREX
+    rather than disabling interrupts, so setting a flag from an ISR never
+    holds off other interrupts and a read-modify-write in the main code
+    simply retries if an interrupt got in between.
+
+    eventWait replaces 'while (!flag);' style polling: the core sleeps in
+    WFI until an interrupt sets one of the flags (or the timeout runs
+    out) instead of spinning on the bus.
+
+    The drivers also signal the shared eventSources word (UART and USB
+    CDC input, received radio frames, touch events and software timers),
+    so eventWaitAny lets one loop sleep until any of them has something
+    for it, rather than checking each one in turn.  The signals only
+    say that a source needs attention, so the loop should drain
+    everything the source has before waiting again.
+
+    @section Example
+
+    @code 
+    #include "core/sched/event.h"
+
+    #define MY_EVENT_DONE   (1 << 0)
+
+    static volatile uint32_t myEvents;
+
+    void TIMER16_0_IRQHandler(void)
+    {
+      ...
+      eventSet(&myEvents, MY_EVENT_DONE);
+    }
+
+    // Waits for up to 100ms
+    if (!eventWait(&myEvents, MY_EVENT_DONE, 100))
+    {
+      printf("Timed out%s", CFG_PRINTF_NEWLINE);
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "event.h"
+
+#include "core/systick/systick.h"
+
+volatile uint32_t eventSources = 0;
+
+/**************************************************************************/
+/*! 
+    @brief  Sets flags (safe to call from interrupt handlers)
+
+    @param[in]  flags
+                The event word
+    @param[in]  bits
+                The flags to set
+
+    @return The flags before they were set
+*/
+/**************************************************************************/
+uint32_t eventSet(volatile uint32_t *flags, uint32_t bits)
+{
+  uint32_t old;
+
+  do
+  {
+    old = __LDREXW(flags);
+  } while (__STREXW(old | bits, flags));
+
+  return old;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Clears flags (safe to call from interrupt handlers)
+
+    @return The flags before they were cleared
+*/
+/**************************************************************************/
+uint32_t eventClear(volatile uint32_t *flags, uint32_t bits)
+{
+  uint32_t old;
+
+  do
+  {
+    old = __LDREXW(flags);
+  } while (__STREXW(old & ~bits, flags));
+
+  return old;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the flags in 'mask' that are set and clears them, so
+            a flag set by an interrupt at the same time is never lost
+
+    @param[in]  flags
+                The event word
+    @param[in]  mask
+                The flags to take (0xFFFFFFFF for all of them)
+*/
+/**************************************************************************/
+uint32_t eventTake(volatile uint32_t *flags, uint32_t mask)
+{
+  uint32_t old;
+
+  do
+  {
+    old = __LDREXW(flags);
+    if (!(old & mask))
+    {
+      __CLREX();
+      return 0;
+    }
+  } while (__STREXW(old & ~mask, flags));
+
+  return old & mask;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Sleeps in WFI until one of the flags in 'mask' is set, then
+            takes them (see eventTake).  Must not be called with
+            interrupts disabled, since it needs them to be woken up.
+
+    @param[in]  flags
+                The event word
+    @param[in]  mask
+                The flags to wait for
+    @param[in]  timeoutMs
+                How long to wait for, rounded up to a systick tick
+                (0 waits forever)
+
+    @return The flags that were taken, or 0 if it timed out
+*/
+/**************************************************************************/
+uint32_t eventWait(volatile uint32_t *flags, uint32_t mask, uint32_t timeoutMs)
+{
+  uint32_t start = systickGetTicks();
+  uint32_t ticks = (timeoutMs + CFG_SYSTICK_DELAY_IN_MS - 1) / CFG_SYSTICK_DELAY_IN_MS;
+  uint32_t events;
+
+  while (1)
+  {
+    events = eventTake(flags, mask);
+    if (events)
+    {
+      return events;
+    }
+    if (timeoutMs && (systickGetTicks() - start >= ticks))
+    {
+      return 0;
+    }
+
+    // Check again with interrupts masked so that a flag set by an
+    // interrupt can't slip in before WFI.  WFI still wakes up on a
+    // pending interrupt with PRIMASK set (the systick interrupt at the
+    // latest, which takes care of the timeout).
+    __disable_irq();
+    if (!(*flags & mask))
+    {
+      __asm volatile ("wfi");
+    }
+    __enable_irq();
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Sleeps until any of the sources in 'mask' has signalled
+            (see eventSignal), or the timeout runs out
+
+    @param[in]  mask
+                The EVENT_SOURCE_... bits to wait for
+    @param[in]  timeoutMs
+                How long to wait for (0 waits forever)
+
+    @return The set of sources that signalled (they are cleared), or 0
+            if it timed out
+*/
+/**************************************************************************/
+uint32_t eventWaitAny(uint32_t mask, uint32_t timeoutMs)
+{
+  return eventWait(&eventSources, mask, timeoutMs);
+}
@@ -0,0 +1,62 @@
+/**************************************************************************/
+/*! 
+    @file     event.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef _EVENT_H_
+#define _EVENT_H_
+
+#include "projectconfig.h"
+
+/* Sources that signal the shared eventSources word, which the main loop *
+ * can sleep on with eventWaitAny instead of polling every driver       */
+#define EVENT_SOURCE_UARTRX     (1 << 0)    // UART data (or an RS485 frame) received
+#define EVENT_SOURCE_CDCOUT     (1 << 1)    // USB CDC data received from the host
+#define EVENT_SOURCE_RADIORX    (1 << 2)    // Chibi frame received
+#define EVENT_SOURCE_TOUCH      (1 << 3)    // Touch screen event queued
+#define EVENT_SOURCE_TIMER      (1 << 4)    // Software timer expired (swtimer.c)
+#define EVENT_SOURCE_USER       (1 << 16)   // First bit free for the application
+
+extern volatile uint32_t eventSources;
+
+// Signals sources from a driver (safe to call from interrupt handlers)
+#define eventSignal(bits)       eventSet(&eventSources, (bits))
+
+uint32_t eventSet ( volatile uint32_t *flags, uint32_t bits );
+uint32_t eventClear ( volatile uint32_t *flags, uint32_t bits );
+uint32_t eventTake ( volatile uint32_t *flags, uint32_t mask );
+uint32_t eventWait ( volatile uint32_t *flags, uint32_t mask, uint32_t timeoutMs );
+uint32_t eventWaitAny ( uint32_t mask, uint32_t timeoutMs );
+
+#endif
@@ -0,0 +1,244 @@
+/**************************************************************************/
+/*! 
+    @file     msgq.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Message queue for passing data from one interrupt handler (the
+    producer) to the main code (the consumer) without disabling
+    interrupts.  The producer only ever writes the head index and the
+    consumer only the tail, so neither side needs a lock: a message
+    is copied into its slot before the head moves past it, and a slot
+    is only reused once the tail has moved past it.
+
+    A queue can wake up a scheduler task when a message is posted
+    (msgqSetTask), which then empties it with msgqGet, or the main code
+    can sleep until a message arrives with msgqWait.  A message posted
+    while the queue is full is dropped and counted (msgqGetDropped).
+
+    @section Example
+
+    @code 
+    #include "core/sched/msgq.h"
+
+    static uint16_t samples[16];
+    static msgq_t sampleQueue;
+    static schedTask_t sampleTask;
+
+    void sampleRun(schedTask_t *task)
+    {
+      uint16_t sample;
+
+      while (msgqGet(&sampleQueue, &sample))
+      {
+        printf("%u%s", sample, CFG_PRINTF_NEWLINE);
+      }
+    }
+
+    void ADC_IRQHandler(void)
+    {
+      uint16_t sample = ...;
+
+      msgqPost(&sampleQueue, &sample);
+    }
+
+    ...
+    schedTaskInit(&sampleTask, sampleRun, NULL);
+    msgqInit(&sampleQueue, samples, sizeof(uint16_t), 16);
+    msgqSetTask(&sampleQueue, &sampleTask, 0);
+    schedRun();
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include <string.h>
+
+#include "msgq.h"
+#include "event.h"
+
+/**************************************************************************/
+/*! 
+    @brief  Initialises a queue
+
+    @param[in]  queue
+                The queue to initialise
+    @param[in]  buffer
+                Storage for the messages ('size' * 'count' bytes)
+    @param[in]  size
+                The size of each message in bytes
+    @param[in]  count
+                The number of messages the queue holds, which must be a
+                power of two
+*/
+/**************************************************************************/
+void msgqInit(msgq_t *queue, void *buffer, uint16_t size, uint16_t count)
+{
+  memset(queue, 0, sizeof(msgq_t));
+  queue->buffer = (uint8_t *)buffer;
+  queue->size = size;
+  queue->mask = count - 1;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Sets a task to post (with 'event' in its event flags) every
+            time a message is added, or NULL for none.  Must be called
+            before the producer starts posting.
+*/
+/**************************************************************************/
+void msgqSetTask(msgq_t *queue, schedTask_t *task, uint32_t event)
+{
+  queue->task = task;
+  queue->event = event;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Adds a message to the queue (producer side, normally an
+            interrupt handler)
+
+    @param[in]  queue
+                The queue to add it to
+    @param[in]  msg
+                The message ('size' bytes, copied into the queue)
+
+    @return false if the queue was full and the message was dropped
+*/
+/**************************************************************************/
+bool msgqPost(msgq_t *queue, const void *msg)
+{
+  uint16_t head = queue->head;
+
+  if ((uint16_t)(head - queue->tail) > queue->mask)
+  {
+    queue->dropped++;
+    return false;
+  }
+
+  memcpy(queue->buffer + (head & queue->mask) * queue->size, msg, queue->size);
+
+  // The message has to be in place before the consumer can see it
+  __DMB();
+  queue->head = head + 1;
+
+  eventSet(&queue->posted, 1);
+  if (queue->task)
+  {
+    schedPostEvent(queue->task, queue->event);
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Removes the oldest message from the queue (consumer side)
+
+    @param[in]  queue
+                The queue to read from
+    @param[out] msg
+                Where to copy the message ('size' bytes)
+
+    @return false if the queue was empty
+*/
+/**************************************************************************/
+bool msgqGet(msgq_t *queue, void *msg)
+{
+  uint16_t tail = queue->tail;
+
+  if (tail == queue->head)
+  {
+    return false;
+  }
+
+  // Read the head before the slot it covers
+  __DMB();
+  memcpy(msg, queue->buffer + (tail & queue->mask) * queue->size, queue->size);
+
+  // ... and finish reading the slot before the producer can reuse it
+  __DMB();
+  queue->tail = tail + 1;
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Removes the oldest message from the queue, sleeping in WFI
+            until one is posted if the queue is empty (see eventWait)
+
+    @param[in]  queue
+                The queue to read from
+    @param[out] msg
+                Where to copy the message ('size' bytes)
+    @param[in]  timeoutMs
+                How long to wait for (0 waits forever)
+
+    @return false if it timed out
+*/
+/**************************************************************************/
+bool msgqWait(msgq_t *queue, void *msg, uint32_t timeoutMs)
+{
+  // A post after the check sets 'posted', so eventWait returns straight
+  // away instead of missing it
+  while (!msgqGet(queue, msg))
+  {
+    if (!eventWait(&queue->posted, 1, timeoutMs))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the number of messages waiting in the queue
+*/
+/**************************************************************************/
+uint16_t msgqCount(msgq_t *queue)
+{
+  return (uint16_t)(queue->head - queue->tail);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the number of messages dropped because the queue was
+            full
+*/
+/**************************************************************************/
+uint32_t msgqGetDropped(msgq_t *queue)
+{
+  return queue->dropped;
+}
@@ -0,0 +1,72 @@
+/**************************************************************************/
+/*! 
+    @file     msgq.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef _MSGQ_H_
+#define _MSGQ_H_
+
+#include "projectconfig.h"
+
+#include "sched.h"
+
+/**************************************************************************/
+/*! 
+    Single-producer/single-consumer queue of fixed size messages.  The
+    storage is supplied by the caller and all of the fields are private
+    to msgq.c.
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint8_t *buffer;
+  uint16_t size;                      // Bytes per message
+  uint16_t mask;                      // Number of slots - 1
+  volatile uint16_t head;             // Only written by the producer
+  volatile uint16_t tail;             // Only written by the consumer
+  volatile uint32_t posted;           // Set by msgqPost for msgqWait
+  volatile uint32_t dropped;          // Messages posted while full
+  schedTask_t *task;                  // Posted when a message arrives
+  uint32_t event;                     // Event flags set on 'task'
+} msgq_t;
+
+void     msgqInit ( msgq_t *queue, void *buffer, uint16_t size, uint16_t count );
+void     msgqSetTask ( msgq_t *queue, schedTask_t *task, uint32_t event );
+bool     msgqPost ( msgq_t *queue, const void *msg );
+bool     msgqGet ( msgq_t *queue, void *msg );
+bool     msgqWait ( msgq_t *queue, void *msg, uint32_t timeoutMs );
+uint16_t msgqCount ( msgq_t *queue );
+uint32_t msgqGetDropped ( msgq_t *queue );
+
+#endif
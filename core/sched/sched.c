@@ -0,0 +1,484 @@
+/**************************************************************************/
+/*! 
+    @file     sched.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Small cooperative scheduler.  Tasks are functions that run to
+    completion, either because they were posted (schedPost, which can be
+    called from an interrupt handler), because an interrupt set one of
+    their event flags (schedPostEvent), or because their timer expired.
+    Interrupt handlers can also pass data to a task through a message
+    queue (see msgq.c), which posts the task for them.
+    Timers are kept in a list sorted by deadline and are checked against
+    the systick counter each time round the loop.  When there is nothing
+    to run, the core waits in WFI until the next interrupt (the systick
+    interrupt at the latest).
+
+    With CFG_SCHEDULER_TICKLESS the systick interrupt is stopped while
+    idle.  The time until the next timer deadline is programmed into a
+    match on 32-bit timer 1, the core enters sleep mode (pmuSleep) and
+    the tick counter is advanced by the time actually spent asleep when
+    any interrupt wakes it up.  With CFG_SCHEDULER_DEEPSLEEP, whole
+    seconds of idle time are spent in deep-sleep (pmuDeepSleep, woken by
+    the WDT oscillator driven CT32B0 match) instead.
+
+    Tasks must not block for long: anything that waits (systickDelay,
+    busy loops, etc.) holds up every other task.  Long jobs that can't
+    be split up can call schedYield now and then to let the other ready
+    tasks run.
+
+    @section Example
+
+    @code 
+    #include "core/sched/sched.h"
+
+    static schedTask_t blinkTask;
+
+    void blink(schedTask_t *task)
+    {
+      gpioSetValue(CFG_LED_PORT, CFG_LED_PIN, !gpioGetValue(CFG_LED_PORT, CFG_LED_PIN));
+    }
+
+    int main(void)
+    {
+      systemInit();
+      schedTaskInit(&blinkTask, blink, NULL);
+      schedStartTimer(&blinkTask, 500, 500);
+      schedRun();
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "sched.h"
+#include "event.h"
+
+#include "core/systick/systick.h"
+
+#ifdef CFG_SCHEDULER_TICKLESS
+  #include "core/pmu/pmu.h"
+  #include "core/timer32/timer32.h"
+
+  // CT32B1 counts per systick tick
+  #define SCHED_TIMERTICK   ((cpuGetClock() / 1000) * CFG_SYSTICK_DELAY_IN_MS)
+  #define SCHED_MAXTICKS    (CFG_SCHEDULER_TICKLESS_MAXMS / CFG_SYSTICK_DELAY_IN_MS)
+#endif
+
+static schedTask_t *_schedRunHead = NULL;
+static schedTask_t *_schedRunTail = NULL;
+static schedTask_t *_schedTimers = NULL;      // Sorted by deadline
+static schedTask_t *_schedCurrent = NULL;     // Task run by schedRunOnce
+static schedTask_t *_schedYielding = NULL;    // Task waiting in schedYield
+
+/**************************************************************************/
+/*! 
+    @brief  Returns true if tick 'a' comes before tick 'b' (this works
+            across the 32-bit wrap around as long as they are less than
+            2^31 ticks apart)
+*/
+/**************************************************************************/
+static inline bool schedBefore(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) < 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Adds a task to the end of the run queue (interrupts must be
+            disabled)
+*/
+/**************************************************************************/
+static void schedEnqueue(schedTask_t *task)
+{
+  if (task->queued)
+  {
+    return;
+  }
+
+  task->queued = true;
+  task->runNext = NULL;
+  if (_schedRunTail)
+  {
+    _schedRunTail->runNext = task;
+  }
+  else
+  {
+    _schedRunHead = task;
+  }
+  _schedRunTail = task;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Inserts a task in the timer list according to its deadline
+*/
+/**************************************************************************/
+static void schedTimerInsert(schedTask_t *task)
+{
+  schedTask_t **p = &_schedTimers;
+
+  while (*p && !schedBefore(task->deadline, (*p)->deadline))
+  {
+    p = &(*p)->timerNext;
+  }
+  task->timerNext = *p;
+  *p = task;
+  task->timerActive = true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Removes a task from the timer list (if it's in it)
+*/
+/**************************************************************************/
+static void schedTimerRemove(schedTask_t *task)
+{
+  schedTask_t **p = &_schedTimers;
+
+  while (*p)
+  {
+    if (*p == task)
+    {
+      *p = task->timerNext;
+      break;
+    }
+    p = &(*p)->timerNext;
+  }
+  task->timerActive = false;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Initialises a task
+
+    @param[in]  task
+                The task to initialise
+    @param[in]  func
+                The function to run for this task
+    @param[in]  arg
+                User data (available in task->arg)
+*/
+/**************************************************************************/
+void schedTaskInit(schedTask_t *task, schedTaskFunc_t func, void *arg)
+{
+  memset(task, 0, sizeof(schedTask_t));
+  task->func = func;
+  task->arg = arg;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Queues a task to run (safe to call from interrupt handlers).
+            Posting a task that is already queued has no effect.
+*/
+/**************************************************************************/
+void schedPost(schedTask_t *task)
+{
+  __disable_irq();
+  schedEnqueue(task);
+  __enable_irq();
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Sets event flags on a task and queues it (safe to call from
+            interrupt handlers)
+
+    @param[in]  task
+                The task to wake up
+    @param[in]  events
+                The flags to set (read back with schedTakeEvents)
+*/
+/**************************************************************************/
+void schedPostEvent(schedTask_t *task, uint32_t events)
+{
+  eventSet(&task->events, events);
+  schedPost(task);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns and clears the event flags of a task
+*/
+/**************************************************************************/
+uint32_t schedTakeEvents(schedTask_t *task)
+{
+  return eventTake(&task->events, 0xFFFFFFFF);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Starts (or restarts) a task's timer.  Must not be called from
+            an interrupt handler.
+
+    @param[in]  task
+                The task to run when the timer expires
+    @param[in]  delayMs
+                Delay before the first run, in milliseconds
+    @param[in]  periodMs
+                Delay between the following runs (0 = run once)
+*/
+/**************************************************************************/
+void schedStartTimer(schedTask_t *task, uint32_t delayMs, uint32_t periodMs)
+{
+  if (task->timerActive)
+  {
+    schedTimerRemove(task);
+  }
+
+  task->deadline = systickGetTicks() + delayMs / CFG_SYSTICK_DELAY_IN_MS;
+  task->period = periodMs / CFG_SYSTICK_DELAY_IN_MS;
+  if (periodMs && !task->period)
+  {
+    task->period = 1;
+  }
+  schedTimerInsert(task);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Stops a task's timer (a run that is already queued will
+            still happen)
+*/
+/**************************************************************************/
+void schedStopTimer(schedTask_t *task)
+{
+  if (task->timerActive)
+  {
+    schedTimerRemove(task);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Queues every task with an expired timer, then runs the task
+            at the head of the run queue
+
+    @return false if there was nothing to do
+*/
+/**************************************************************************/
+bool schedRunOnce(void)
+{
+  schedTask_t *task;
+  uint32_t now = systickGetTicks();
+
+  // Move expired timers to the run queue
+  while (_schedTimers && !schedBefore(now, _schedTimers->deadline))
+  {
+    task = _schedTimers;
+    _schedTimers = task->timerNext;
+    task->timerActive = false;
+    if (task->period)
+    {
+      // Keep the phase, unless we've fallen more than a period behind
+      task->deadline += task->period;
+      if (schedBefore(task->deadline, now))
+      {
+        task->deadline = now + task->period;
+      }
+      schedTimerInsert(task);
+    }
+    schedPost(task);
+  }
+
+  __disable_irq();
+  task = _schedRunHead;
+  if (task)
+  {
+    _schedRunHead = task->runNext;
+    if (!_schedRunHead)
+    {
+      _schedRunTail = NULL;
+    }
+    task->queued = false;
+  }
+  __enable_irq();
+
+  if (!task)
+  {
+    return false;
+  }
+
+  if (task == _schedYielding)
+  {
+    // Posted again while it's waiting in schedYield, it runs once that
+    // call is over
+    schedPost(task);
+    return false;
+  }
+
+  _schedCurrent = task;
+  task->func(task);
+  _schedCurrent = NULL;
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Runs one other ready task from inside the current one, for
+            jobs that take too long to run to completion in one go (see
+            ff_yield in drivers/fatfs/ffsync.c).  The calling task can't
+            be run again until it returns, and tasks started here can't
+            yield themselves.  Nothing happens when this isn't called
+            from a task.
+
+    @return false if no other task was run
+*/
+/**************************************************************************/
+bool schedYield(void)
+{
+  schedTask_t *current = _schedCurrent;
+  bool ran;
+
+  if (!current || _schedYielding)
+  {
+    return false;
+  }
+
+  _schedYielding = current;
+  ran = schedRunOnce();
+  _schedYielding = NULL;
+  _schedCurrent = current;
+
+  return ran;
+}
+
+#ifdef CFG_SCHEDULER_TICKLESS
+/**************************************************************************/
+/*! 
+    @brief  Sleeps with the systick interrupt stopped until the next timer
+            deadline or any other interrupt (interrupts must be disabled
+            and the run queue empty)
+*/
+/**************************************************************************/
+static void schedIdleTickless(void)
+{
+  uint32_t idleTicks, elapsed;
+
+  if (_schedTimers)
+  {
+    idleTicks = _schedTimers->deadline - systickGetTicks();
+    if ((int32_t)idleTicks < 2)
+    {
+      // Due now or on the next tick, not worth stopping systick for
+      __asm volatile ("wfi");
+      return;
+    }
+    if (idleTicks > SCHED_MAXTICKS)
+    {
+      idleTicks = SCHED_MAXTICKS;
+    }
+  }
+  else
+  {
+    idleTicks = SCHED_MAXTICKS;
+  }
+
+  systickSuspend();
+  elapsed = 0;
+
+  #ifdef CFG_SCHEDULER_DEEPSLEEP
+  if (idleTicks >= 1000 / CFG_SYSTICK_DELAY_IN_MS)
+  {
+    uint32_t seconds = idleTicks / (1000 / CFG_SYSTICK_DELAY_IN_MS);
+
+    // Only P0.1 (the CT32B0 match output) is enabled as a wakeup
+    // source, so this always sleeps for the full delay.  WAKEUP_IRQHandler
+    // restores the PLL as soon as interrupts are enabled again.
+    pmuDeepSleep(SCB_PDSLEEPCFG_IRCOUT_PD | SCB_PDSLEEPCFG_IRC_PD |
+                 SCB_PDSLEEPCFG_FLASH_PD | SCB_PDSLEEPCFG_BOD_PD |
+                 SCB_PDSLEEPCFG_ADC_PD | SCB_PDSLEEPCFG_SYSOSC_PD |
+                 SCB_PDSLEEPCFG_SYSPLL_PD | SCB_PDSLEEPCFG_USBPLL_PD,
+                 seconds);
+    __enable_irq();
+    __disable_irq();
+    systickResume(seconds * (1000 / CFG_SYSTICK_DELAY_IN_MS));
+    return;
+  }
+  #endif
+
+  // Stop CT32B1 at the deadline and interrupt to wake us up
+  SCB_SYSAHBCLKCTRL |= (SCB_SYSAHBCLKCTRL_CT32B1);
+  TMR_TMR32B1TCR = TMR_TMR32B1TCR_COUNTERRESET_ENABLED;
+  TMR_TMR32B1PR = 0;
+  TMR_TMR32B1MR0 = idleTicks * SCHED_TIMERTICK;
+  TMR_TMR32B1MCR = TMR_TMR32B1MCR_MR0_INT_ENABLED | TMR_TMR32B1MCR_MR0_STOP_ENABLED;
+  TMR_TMR32B1IR = TMR_TMR32B1IR_MR0;
+  NVIC_SetPriority(TIMER_32_1_IRQn, CFG_IRQPRIO_TIMER);
+  NVIC_EnableIRQ(TIMER_32_1_IRQn);
+  TMR_TMR32B1TCR = TMR_TMR32B1TCR_COUNTERENABLE_ENABLED;
+
+  pmuSleep();
+
+  // Woken by the match or by something else: count the whole ticks we
+  // slept for (a partial tick is lost, so early wakeups drift slightly)
+  TMR_TMR32B1TCR = TMR_TMR32B1TCR_COUNTERENABLE_DISABLED;
+  elapsed = TMR_TMR32B1TC / SCHED_TIMERTICK;
+  if (elapsed > idleTicks)
+  {
+    elapsed = idleTicks;
+  }
+  systickResume(elapsed);
+}
+#endif
+
+/**************************************************************************/
+/*! 
+    @brief  Runs tasks forever, sleeping in WFI when there is nothing to
+            do
+*/
+/**************************************************************************/
+void schedRun(void)
+{
+  while (1)
+  {
+    if (!schedRunOnce())
+    {
+      // Interrupts are disabled while checking the run queue so that a
+      // post from an interrupt can't slip in before WFI.  WFI still
+      // wakes up on a pending interrupt with PRIMASK set.
+      __disable_irq();
+      if (!_schedRunHead)
+      {
+        #ifdef CFG_SCHEDULER_TICKLESS
+          schedIdleTickless();
+        #else
+          __asm volatile ("wfi");
+        #endif
+      }
+      __enable_irq();
+    }
+  }
+}
@@ -0,0 +1,75 @@
+/**************************************************************************/
+/*! 
+    @file     sched.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef _SCHED_H_
+#define _SCHED_H_
+
+#include "projectconfig.h"
+
+struct schedTask_s;
+
+typedef void (*schedTaskFunc_t)(struct schedTask_s *task);
+
+/**************************************************************************/
+/*! 
+    A task is a function that runs to completion every time it is posted
+    or its timer expires.  Tasks are statically allocated by the caller,
+    and all of the fields are private to sched.c.
+*/
+/**************************************************************************/
+typedef struct schedTask_s
+{
+  schedTaskFunc_t func;
+  void *arg;                          // User data
+  volatile uint32_t events;           // Event flags set by schedPostEvent
+  uint32_t deadline;                  // Systick tick when the timer expires
+  uint32_t period;                    // Timer reload in ticks (0 = one-shot)
+  struct schedTask_s *runNext;        // Run queue link
+  struct schedTask_s *timerNext;      // Timer list link
+  volatile bool queued;
+  bool timerActive;
+} schedTask_t;
+
+void     schedTaskInit ( schedTask_t *task, schedTaskFunc_t func, void *arg );
+void     schedPost ( schedTask_t *task );
+void     schedPostEvent ( schedTask_t *task, uint32_t events );
+uint32_t schedTakeEvents ( schedTask_t *task );
+void     schedStartTimer ( schedTask_t *task, uint32_t delayMs, uint32_t periodMs );
+void     schedStopTimer ( schedTask_t *task );
+bool     schedRunOnce ( void );
+bool     schedYield ( void );
+void     schedRun ( void );
+
+#endif
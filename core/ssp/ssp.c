@@ -68,12 +68,83 @@
 /**************************************************************************/
 #include "ssp.h"
 #include "core/gpio/gpio.h"
+#include "core/clkgate/clkgate.h"
+#include "core/cpu/cpu.h"
 
 /* Statistics for all interrupts */
 volatile uint32_t interruptRxStat = 0;
 volatile uint32_t interruptOverRunStat = 0;
 volatile uint32_t interruptRxTimeoutStat = 0;
 
+/* State of the current asynchronous transfer (see sspTransferAsync) */
+static volatile struct
+{
+  bool                  busy;
+  const uint8_t        *txbuf;        // NULL = clock out 0xFF
+  uint8_t              *rxbuf;        // NULL = discard incoming data
+  uint32_t              txRemaining;  // Frames still to be written to the Tx FIFO
+  uint32_t              rxRemaining;  // Frames still to be read from the Rx FIFO
+  sspTransferCallback_t callback;
+} sspXfer;
+
+/* Shared bus state (see sspDeviceAcquire) */
+static sspDevice_t *sspDevices;             // Registered devices
+static sspDevice_t *sspOwner;               // Device whose settings are in CR0/CPSR
+static volatile bool sspLocked;             // sspOwner is in the middle of a transaction
+static volatile bool sspPending;            // A request was deferred while locked
+
+/**************************************************************************/
+/*! 
+    @brief Moves data between the FIFOs and the async transfer buffers
+
+    Any pending data is first read out of the Rx FIFO, and the Tx FIFO
+    is then topped up.  No more than SSP_FIFOSIZE frames are ever in
+    flight (written but not yet read back) so that the Rx FIFO can
+    not overrun, even if the ISR is held off for a while.
+*/
+/**************************************************************************/
+RAMFUNC static void sspXferService (void)
+{
+  uint8_t data;
+
+  /* Drain the Rx FIFO */
+  while ((SSP_SSP0SR & SSP_SSP0SR_RNE_NOTEMPTY) && sspXfer.rxRemaining)
+  {
+    data = SSP_SSP0DR;
+    if (sspXfer.rxbuf)
+    {
+      *sspXfer.rxbuf++ = data;
+    }
+    sspXfer.rxRemaining--;
+  }
+
+  /* Top up the Tx FIFO */
+  while (sspXfer.txRemaining &&
+        (sspXfer.rxRemaining - sspXfer.txRemaining < SSP_FIFOSIZE) &&
+        (SSP_SSP0SR & SSP_SSP0SR_TNF_NOTFULL))
+  {
+    SSP_SSP0DR = sspXfer.txbuf ? *sspXfer.txbuf++ : 0xFF;
+    sspXfer.txRemaining--;
+  }
+
+  /* Nothing left to send ... stop the (level-sensitive) Tx interrupt */
+  if (!sspXfer.txRemaining)
+  {
+    SSP_SSP0IMSC &= ~SSP_SSP0IMSC_TXIM_MASK;
+  }
+
+  /* Transfer complete */
+  if (!sspXfer.rxRemaining)
+  {
+    SSP_SSP0IMSC &= ~(SSP_SSP0IMSC_RXIM_MASK | SSP_SSP0IMSC_TXIM_MASK);
+    sspXfer.busy = false;
+    if (sspXfer.callback)
+    {
+      sspXfer.callback(0);
+    }
+  }
+}
+
 /**************************************************************************/
 /*! 
     @brief SSP0 interrupt handler for SPI communication
@@ -82,9 +153,14 @@ volatile uint32_t interruptRxTimeoutStat = 0;
     start receive until it's empty; if TXFIFO is at least
     half empty, start transmit until it's full.
     This will maximize the use of both FIFOs and performance.
+
+    The Rx half-full, Rx timeout and Tx half-empty interrupts are used
+    to service transfers started with sspTransferAsync().  The timeout
+    interrupt picks up the last few frames of a block that aren't
+    enough to cross the half-full threshold.
 */
 /**************************************************************************/
-void SSP_IRQHandler (void)
+RAMFUNC void SSP_IRQHandler (void)
 {
   uint32_t regValue;
 
@@ -107,9 +183,14 @@ void SSP_IRQHandler (void)
   /* Check if Rx buffer is at least half-full */
   if ( regValue & SSP_SSP0MIS_RXMIS_HALFFULL )
   {
-    // ToDo: Receive until it's empty
     interruptRxStat++;
   }
+
+  /* Receive until the Rx FIFO is empty, transmit until the Tx FIFO is full */
+  if (sspXfer.busy)
+  {
+    sspXferService();
+  }
   return;
 }
 
@@ -148,8 +229,12 @@ void sspInit (uint8_t portNum, sspClockPolarity_t polarity, sspClockPhase_t phas
     SCB_PRESETCTRL &= ~SCB_PRESETCTRL_SSP0_MASK;
     SCB_PRESETCTRL |= SCB_PRESETCTRL_SSP0_RESETDISABLED;
   
-    /* Enable AHB clock to the SSP domain. */
-    SCB_SYSAHBCLKCTRL |= (SCB_SYSAHBCLKCTRL_SSP0);
+    /* Enable AHB clock to the SSP domain.  The clock stays on since  */
+    /* chip select is driven by the callers between transfers        */
+    if (!clkgateGetUsers(clkgatePeriph_SSP0))
+    {
+      clkgateAcquire(clkgatePeriph_SSP0);
+    }
   
     /* Divide by 1 (SSPCLKDIV also enables to SSP CLK) */
     SCB_SSP0CLKDIV = SCB_SSP0CLKDIV_DIV1;
@@ -203,6 +288,10 @@ void sspInit (uint8_t portNum, sspClockPolarity_t polarity, sspClockPhase_t phas
   
     /* Clock prescale register must be even and at least 2 in master mode */
     SSP_SSP0CPSR = SSP_SSP0CPSR_CPSDVSR_DIV2;
+
+    /* Whichever device uses the bus next has to load its own settings */
+    sspOwner = NULL;
+    sspLocked = false;
   
     /* Clear the Rx FIFO */
     uint8_t i, Dummy=Dummy;
@@ -212,6 +301,7 @@ void sspInit (uint8_t portNum, sspClockPolarity_t polarity, sspClockPhase_t phas
     }
   
     /* Enable the SSP Interrupt */
+    NVIC_SetPriority(SSP_IRQn, CFG_IRQPRIO_PERIPH);
     NVIC_EnableIRQ(SSP_IRQn);
   
     /* Set SSPINMS registers to enable interrupts
@@ -230,6 +320,11 @@ void sspInit (uint8_t portNum, sspClockPolarity_t polarity, sspClockPhase_t phas
 /*! 
     @brief Sends a block of data to the SSP0 port
 
+    The Tx FIFO is kept topped up while the frames echoed back on MISO
+    are discarded as they arrive, so there are no gaps between bytes
+    on the bus.  The function only returns once every frame has been
+    clocked out and the Rx FIFO is empty again.
+
     @param[in]  portNum
                 The SPI port to use (0..1)
     @param[in]  buf
@@ -238,25 +333,141 @@ void sspInit (uint8_t portNum, sspClockPolarity_t polarity, sspClockPhase_t phas
                 Block length of the data buffer
 */
 /**************************************************************************/
-void sspSend (uint8_t portNum, uint8_t *buf, uint32_t length)
+RAMFUNC void sspSend (uint8_t portNum, uint8_t *buf, uint32_t length)
 {
-  uint32_t i;
+  uint32_t inFlight = 0;
   uint8_t Dummy = Dummy;
 
   if (portNum == 0)
   {
-    for (i = 0; i < length; i++)
+    while (length)
     {
-      /* Move on only if NOT busy and TX FIFO not full. */
-      while ((SSP_SSP0SR & (SSP_SSP0SR_TNF_NOTFULL | SSP_SSP0SR_BSY_BUSY)) != SSP_SSP0SR_TNF_NOTFULL);
-      SSP_SSP0DR = *buf;
-      buf++;
-  
-      while ( (SSP_SSP0SR & (SSP_SSP0SR_BSY_BUSY|SSP_SSP0SR_RNE_NOTEMPTY)) != SSP_SSP0SR_RNE_NOTEMPTY );
+      /* Keep the Tx FIFO full, but never have more frames in flight
+         than the Rx FIFO can hold or it will overrun */
+      if ((inFlight < SSP_FIFOSIZE) && (SSP_SSP0SR & SSP_SSP0SR_TNF_NOTFULL))
+      {
+        SSP_SSP0DR = *buf++;
+        length--;
+        inFlight++;
+      }
+
       /* Whenever a byte is written, MISO FIFO counter increments, Clear FIFO 
       on MISO. Otherwise, when SSP0Receive() is called, previous data byte
       is left in the FIFO. */
-      Dummy = SSP_SSP0DR;
+      if (SSP_SSP0SR & SSP_SSP0SR_RNE_NOTEMPTY)
+      {
+        Dummy = SSP_SSP0DR;
+        inFlight--;
+      }
+    }
+
+    /* Drain whatever is still on its way back */
+    while (inFlight)
+    {
+      if (SSP_SSP0SR & SSP_SSP0SR_RNE_NOTEMPTY)
+      {
+        Dummy = SSP_SSP0DR;
+        inFlight--;
+      }
+    }
+  }
+
+  return; 
+}
+
+/**************************************************************************/
+/*! 
+    @brief Sets the number of bits per frame on the SSP0 port
+
+    sspInit() always configures the port for 8-bit frames.  Switching
+    to 16-bit frames allows sspSend16() to push one RGB565 pixel (or
+    any other 16-bit word) per frame, MSB first.
+
+    @param[in]  portNum
+                The SPI port to use (0..1)
+    @param[in]  frameSize
+                sspFrameSize_8Bit or sspFrameSize_16Bit
+
+    @note   sspSend() and sspReceive() must only be used with 8-bit
+            frames, so switch back to sspFrameSize_8Bit when done.
+*/
+/**************************************************************************/
+void sspSetFrameSize (uint8_t portNum, sspFrameSize_t frameSize)
+{
+  if (portNum == 0)
+  {
+    /* Wait for any pending frames to be clocked out */
+    while (SSP_SSP0SR & SSP_SSP0SR_BSY_BUSY);
+
+    SSP_SSP0CR0 = (SSP_SSP0CR0 & ~SSP_SSP0CR0_DSS_MASK) |
+                  (frameSize == sspFrameSize_16Bit ? SSP_SSP0CR0_DSS_16BIT : SSP_SSP0CR0_DSS_8BIT);
+  }
+
+  return;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Sends a block of 16-bit frames to the SSP0 port
+
+    This works the same way as sspSend(), but writes one 16-bit word
+    per frame.  The port must first be set to 16-bit frames with
+    sspSetFrameSize().
+
+    @param[in]  portNum
+                The SPI port to use (0..1)
+    @param[in]  buf
+                Pointer to the data buffer
+    @param[in]  length
+                Number of 16-bit words in the data buffer
+
+    @section Example
+
+    @code
+    #include "core/ssp/ssp.h"
+
+    uint16_t pixels[32];
+
+    // ... fill pixels with RGB565 data ...
+
+    sspSetFrameSize(0, sspFrameSize_16Bit);
+    ssp0Select();
+    sspSend16(0, pixels, 32);
+    ssp0Deselect();
+    sspSetFrameSize(0, sspFrameSize_8Bit);
+    @endcode
+*/
+/**************************************************************************/
+void sspSend16 (uint8_t portNum, const uint16_t *buf, uint32_t length)
+{
+  uint32_t inFlight = 0;
+  uint16_t Dummy = Dummy;
+
+  if (portNum == 0)
+  {
+    while (length)
+    {
+      if ((inFlight < SSP_FIFOSIZE) && (SSP_SSP0SR & SSP_SSP0SR_TNF_NOTFULL))
+      {
+        SSP_SSP0DR = *buf++;
+        length--;
+        inFlight++;
+      }
+
+      if (SSP_SSP0SR & SSP_SSP0SR_RNE_NOTEMPTY)
+      {
+        Dummy = SSP_SSP0DR;
+        inFlight--;
+      }
+    }
+
+    while (inFlight)
+    {
+      if (SSP_SSP0SR & SSP_SSP0SR_RNE_NOTEMPTY)
+      {
+        Dummy = SSP_SSP0DR;
+        inFlight--;
+      }
     }
   }
 
@@ -267,6 +478,10 @@ void sspSend (uint8_t portNum, uint8_t *buf, uint32_t length)
 /*! 
     @brief Receives a block of data from the SSP0 port
 
+    0xFF is clocked out for every frame read.  As with sspSend(), up to
+    SSP_FIFOSIZE frames are kept in flight so the bus doesn't idle
+    between bytes while waiting for each one to come back.
+
     @param[in]  portNum
                 The SPI port to use (0..1)
     @param[in]  buf
@@ -277,23 +492,426 @@ void sspSend (uint8_t portNum, uint8_t *buf, uint32_t length)
 /**************************************************************************/
 void sspReceive(uint8_t portNum, uint8_t *buf, uint32_t length)
 {
-  uint32_t i;
+  uint32_t toSend = length;
 
   if (portNum == 0)
   {
-    for ( i = 0; i < length; i++ )
+    while (length)
     {
+      /* Queue dummy frames, but never more than the Rx FIFO can hold */
+      if (toSend && (length - toSend < SSP_FIFOSIZE) && (SSP_SSP0SR & SSP_SSP0SR_TNF_NOTFULL))
+      {
+        SSP_SSP0DR = 0xFF;
+        toSend--;
+      }
+
       /* As long as the receive FIFO is not empty, data can be received. */
-      SSP_SSP0DR = 0xFF;
-  
-      /* Wait until the Busy bit is cleared */
-      while ( (SSP_SSP0SR & (SSP_SSP0SR_BSY_BUSY|SSP_SSP0SR_RNE_NOTEMPTY)) != SSP_SSP0SR_RNE_NOTEMPTY );
-      
-      *buf = SSP_SSP0DR;
-      buf++;
+      if (SSP_SSP0SR & SSP_SSP0SR_RNE_NOTEMPTY)
+      {
+        *buf++ = SSP_SSP0DR;
+        length--;
+      }
     }
   }
 
   return; 
 }
 
+/**************************************************************************/
+/*! 
+    @brief Starts a non-blocking full-duplex block transfer on the
+           SSP0 port
+
+    The FIFOs are primed straight away and the remainder of the block
+    is moved by SSP_IRQHandler, leaving the CPU free until 'callback'
+    is fired.  Chip select is not touched, so the caller must assert
+    it before and release it after (i.e. in the callback).
+
+    @param[in]  portNum
+                The SPI port to use (0..1)
+    @param[in]  txbuf
+                Pointer to the data to send, or NULL to clock out
+                0xFF (for example when only reading from a card)
+    @param[in]  rxbuf
+                Pointer to the buffer that will receive the incoming
+                data, or NULL if the incoming data should be discarded
+    @param[in]  length
+                Number of bytes to transfer
+    @param[in]  callback
+                Function to call when the transfer is complete, or
+                NULL.  Note that this runs in interrupt context.
+
+    @return     false if a transfer is already in progress or the
+                parameters are invalid, otherwise true
+
+    @note   sspSend() and sspReceive() must not be used until the
+            transfer has completed (see sspTransferBusy()).  Both
+            buffers must also remain valid until then.
+
+    @section Example
+
+    @code
+    #include "core/ssp/ssp.h"
+
+    static uint8_t request[16];
+    static uint8_t response[16];
+
+    void transferDone(uint8_t portNum)
+    {
+      ssp0Deselect();
+    }
+
+    sspInit(0, sspClockPolarity_Low, sspClockPhase_RisingEdge);
+
+    ssp0Select();
+    sspTransferAsync(0, request, response, sizeof(response), transferDone);
+
+    // ... do something useful while the data is clocked out ...
+
+    while (sspTransferBusy(0));
+    @endcode
+*/
+/**************************************************************************/
+bool sspTransferAsync (uint8_t portNum, const uint8_t *txbuf, uint8_t *rxbuf, uint32_t length, sspTransferCallback_t callback)
+{
+  uint8_t Dummy = Dummy;
+
+  if ((portNum != 0) || (length == 0) || sspXfer.busy)
+  {
+    return false;
+  }
+
+  /* Make sure nothing stale is left in the Rx FIFO */
+  while (SSP_SSP0SR & SSP_SSP0SR_RNE_NOTEMPTY)
+  {
+    Dummy = SSP_SSP0DR;
+  }
+
+  sspXfer.txbuf = txbuf;
+  sspXfer.rxbuf = rxbuf;
+  sspXfer.txRemaining = length;
+  sspXfer.rxRemaining = length;
+  sspXfer.callback = callback;
+  sspXfer.busy = true;
+
+  /* Prime the FIFO with the SSP interrupt masked, then let the ISR
+     take over (half-full Rx, half-empty Tx) */
+  NVIC_DisableIRQ(SSP_IRQn);
+  sspXferService();
+  if (sspXfer.busy)
+  {
+    SSP_SSP0IMSC |= SSP_SSP0IMSC_RXIM_ENBL;
+    if (sspXfer.txRemaining)
+    {
+      SSP_SSP0IMSC |= SSP_SSP0IMSC_TXIM_ENBL;
+    }
+  }
+  NVIC_EnableIRQ(SSP_IRQn);
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Indicates whether an asynchronous transfer started with
+           sspTransferAsync() is still in progress
+
+    @param[in]  portNum
+                The SPI port to use (0..1)
+*/
+/**************************************************************************/
+bool sspTransferBusy (uint8_t portNum)
+{
+  if (portNum == 0)
+  {
+    return sspXfer.busy;
+  }
+
+  return false;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Works out the prescaler and serial clock rate for a device
+
+    SSP0CLKDIV is left at DIV1 by sspInit(), so the rate is
+    PCLK / (CPSDVSR * [SCR+1]).  The smallest (even) prescaler that can
+    still reach the requested rate is used so the SCR steps are as fine
+    as possible.
+*/
+/**************************************************************************/
+static void sspDeviceCompute (sspDevice_t *dev)
+{
+  uint32_t pclk = cpuGetClock();
+  uint32_t div, cpsr, scr;
+
+  div = dev->hz ? (pclk + dev->hz - 1) / dev->hz : 0xFFFFFFFF;
+  for (cpsr = 2; cpsr < 254 && div > cpsr * 256; cpsr += 2);
+  scr = (div + cpsr - 1) / cpsr;
+  scr = (scr > 256) ? 255 : (scr ? scr - 1 : 0);
+
+  dev->cpsr = cpsr;
+  dev->cr0 = (dev->cr0 & ~SSP_SSP0CR0_SCR_MASK) | (scr << 8);
+  dev->clock = pclk / (cpsr * (scr + 1));
+}
+
+/**************************************************************************/
+/*! 
+    @brief Loads a device's settings into the SSP registers
+*/
+/**************************************************************************/
+static void sspDeviceApply (sspDevice_t *dev)
+{
+  /* Let the previous owner's last frame finish */
+  while (SSP_SSP0SR & SSP_SSP0SR_BSY_BUSY);
+
+  SSP_SSP0CR0 = dev->cr0;
+  SSP_SSP0CPSR = dev->cpsr;
+  sspOwner = dev;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Clock change hook (see cpuSetClock), recomputes the settings
+           of every registered device
+*/
+/**************************************************************************/
+static void sspClockChanged (uint32_t clock, bool changed)
+{
+  sspDevice_t *dev;
+
+  if (!changed)
+  {
+    return;
+  }
+
+  for (dev = sspDevices; dev; dev = dev->next)
+  {
+    sspDeviceCompute(dev);
+  }
+
+  /* A transaction in progress carries on at the new rate, otherwise
+     the next sspDeviceAcquire() loads the new settings */
+  if (sspOwner && sspLocked)
+  {
+    sspDeviceApply(sspOwner);
+  }
+  else
+  {
+    sspOwner = NULL;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief Registers a device that shares SSP0 with others
+
+    The clock rate and SPI mode are turned into register values once,
+    here, rather than on every transaction.  Registering the same device
+    again updates its settings.  sspInit() still has to be called first
+    to set up the pins.
+
+    @param[in]  dev
+                Device state, must stay valid (static) from now on
+    @param[in]  hz
+                Maximum clock rate the device supports
+    @param[in]  polarity
+                Clock level between frames
+    @param[in]  phase
+                Clock edge the data is sampled on
+
+    @section Example
+
+    @code
+    static sspDevice_t flash;
+
+    sspInit(0, sspClockPolarity_Low, sspClockPhase_RisingEdge);
+    sspDeviceRegister(&flash, 8000000, sspClockPolarity_Low, sspClockPhase_RisingEdge);
+
+    if (sspDeviceAcquire(&flash))
+    {
+      ssp0Select();
+      sspSend(0, cmd, sizeof(cmd));
+      ssp0Deselect();
+      sspDeviceRelease(&flash);
+    }
+    @endcode
+*/
+/**************************************************************************/
+void sspDeviceRegister (sspDevice_t *dev, uint32_t hz, sspClockPolarity_t polarity, sspClockPhase_t phase)
+{
+  sspDevice_t *d;
+
+  dev->cr0 = SSP_SSP0CR0_DSS_8BIT | SSP_SSP0CR0_FRF_SPI;
+  if (polarity == sspClockPolarity_High)
+    dev->cr0 |= SSP_SSP0CR0_CPOL_HIGH;
+  if (phase == sspClockPhase_FallingEdge)
+    dev->cr0 |= SSP_SSP0CR0_CPHA_SECOND;
+  dev->hz = hz;
+  dev->deferred = NULL;
+  sspDeviceCompute(dev);
+
+  for (d = sspDevices; d && d != dev; d = d->next);
+  if (!d)
+  {
+    dev->next = sspDevices;
+    sspDevices = dev;
+  }
+
+  /* Settings may have changed, load them again on the next acquire */
+  if (sspOwner == dev && !sspLocked)
+  {
+    sspOwner = NULL;
+  }
+
+  cpuRegisterClockHook(sspClockChanged);
+}
+
+/**************************************************************************/
+/*! 
+    @brief Changes the clock rate of a registered device
+
+    If the device currently owns the bus the new rate takes effect
+    straight away (e.g. when an SD card moves from the 400kHz
+    identification clock to its full rate).
+
+    @param[in]  dev
+                A device set up with sspDeviceRegister()
+    @param[in]  hz
+                Maximum clock rate
+
+    @return The rate that will actually be used, in Hz
+*/
+/**************************************************************************/
+uint32_t sspDeviceSetClock (sspDevice_t *dev, uint32_t hz)
+{
+  dev->hz = hz;
+  sspDeviceCompute(dev);
+  if (sspOwner == dev)
+  {
+    sspDeviceApply(dev);
+  }
+
+  return dev->clock;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Takes the bus for a transaction
+
+    The SSP registers are only rewritten if another device used the bus
+    last.  Acquiring the bus again while already holding it is fine, a
+    single sspDeviceRelease() gives it up.
+
+    @param[in]  dev
+                A device set up with sspDeviceRegister()
+
+    @return false if another device is in the middle of a transaction.
+            Interrupt handlers use sspDeviceDefer() to run once the bus
+            is free.  In thread mode this only happens while a raw SD
+            read stream is part way through a sector.
+*/
+/**************************************************************************/
+bool sspDeviceAcquire (sspDevice_t *dev)
+{
+  if (sspLocked && sspOwner != dev)
+  {
+    return false;
+  }
+
+  /* Lock before loading the settings: an interrupt that gets in ahead
+     of this has already released the bus again, one after it defers */
+  sspLocked = true;
+  if (sspOwner != dev)
+  {
+    sspDeviceApply(dev);
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Ends a transaction and runs any requests that were deferred
+           in the meantime
+
+    The device's settings stay loaded, so taking the bus again costs
+    nothing unless another device gets in first.  Does nothing if the
+    device doesn't hold the bus.
+
+    @param[in]  dev
+                The device that called sspDeviceAcquire()
+*/
+/**************************************************************************/
+void sspDeviceRelease (sspDevice_t *dev)
+{
+  sspDevice_t *d;
+  sspDeviceCallback_t callback;
+
+  if (!sspLocked || sspOwner != dev)
+  {
+    return;
+  }
+
+  /* Nothing can be deferred once the lock is gone, so the list can be
+     walked without masking interrupts */
+  sspLocked = false;
+  while (sspPending)
+  {
+    sspPending = false;
+    for (d = sspDevices; d; d = d->next)
+    {
+      callback = d->deferred;
+      if (callback)
+      {
+        d->deferred = NULL;
+        callback();
+      }
+    }
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief Queues a request from an interrupt handler if the bus is busy
+
+    A device that is interrupted mid-transfer can't be cut short, so an
+    interrupt that needs the bus queues its work instead, and it runs
+    from sspDeviceRelease() (or at the next block boundary for drivers
+    that call sspBusPending()).  Each device holds one request, a later
+    one replaces it.
+
+    @param[in]  dev
+                The device that wants the bus
+    @param[in]  callback
+                Run once the bus is free
+
+    @return true if the request was queued, false if the bus can be used
+            right away
+*/
+/**************************************************************************/
+bool sspDeviceDefer (sspDevice_t *dev, sspDeviceCallback_t callback)
+{
+  if (!sspLocked || sspOwner == dev)
+  {
+    return false;
+  }
+
+  dev->deferred = callback;
+  sspPending = true;
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Indicates whether a request is waiting for the bus
+
+    Drivers with long multi-block transfers check this between blocks
+    and briefly release the bus if it is set.
+*/
+/**************************************************************************/
+bool sspBusPending (void)
+{
+  return sspPending;
+}
@@ -77,9 +77,68 @@ typedef enum sspClockPhase_e
 } 
 sspClockPhase_t;
 
+/**************************************************************************/
+/*! 
+    Indicates the number of bits in each SPI frame.  16-bit frames are
+    useful when pushing RGB565 pixel data, since one frame then carries
+    one pixel.
+*/
+/**************************************************************************/
+typedef enum sspFrameSize_e
+{
+  sspFrameSize_8Bit = 0,
+  sspFrameSize_16Bit
+} 
+sspFrameSize_t;
+
+/**************************************************************************/
+/*! 
+    Callback function fired from SSP_IRQHandler when an asynchronous
+    transfer started with sspTransferAsync() has completed.
+*/
+/**************************************************************************/
+typedef void (*sspTransferCallback_t)(uint8_t portNum);
+
+/**************************************************************************/
+/*! 
+    Request queued with sspDeviceDefer(), run once the device that held
+    the bus calls sspDeviceRelease().
+*/
+/**************************************************************************/
+typedef void (*sspDeviceCallback_t)(void);
+
+/**************************************************************************/
+/*! 
+    One device sharing SSP0.  The bus settings are worked out once by
+    sspDeviceRegister() and sspDeviceSetClock(), and only written to the
+    SSP registers when a different device takes the bus.  Chip select
+    stays with the driver.
+*/
+/**************************************************************************/
+typedef struct sspDevice_s
+{
+  uint32_t              hz;           // Requested clock rate
+  uint32_t              clock;        // Rate actually used (<= hz)
+  uint16_t              cr0;          // Cached SSP0CR0 (8-bit SPI, CPOL/CPHA, SCR)
+  uint8_t               cpsr;         // Cached SSP0CPSR prescaler
+  volatile sspDeviceCallback_t deferred;  // Request waiting for the bus
+  struct sspDevice_s   *next;         // Next registered device
+}
+sspDevice_t;
+
 extern void SSP_IRQHandler (void);
 void sspInit (uint8_t portNum, sspClockPolarity_t polarity, sspClockPhase_t phase);
 void sspSend (uint8_t portNum, uint8_t *buf, uint32_t length);
 void sspReceive (uint8_t portNum, uint8_t *buf, uint32_t length);
+void sspSetFrameSize (uint8_t portNum, sspFrameSize_t frameSize);
+void sspSend16 (uint8_t portNum, const uint16_t *buf, uint32_t length);
+bool sspTransferAsync (uint8_t portNum, const uint8_t *txbuf, uint8_t *rxbuf, uint32_t length, sspTransferCallback_t callback);
+bool sspTransferBusy (uint8_t portNum);
+void sspDeviceRegister (sspDevice_t *dev, uint32_t hz, sspClockPolarity_t polarity, sspClockPhase_t phase);
+uint32_t sspDeviceSetClock (sspDevice_t *dev, uint32_t hz);
+bool sspDeviceAcquire (sspDevice_t *dev);
+void sspDeviceRelease (sspDevice_t *dev);
+bool sspDeviceDefer (sspDevice_t *dev, sspDeviceCallback_t callback);
+bool sspBusPending (void);
 
 #endif
@@ -0,0 +1,115 @@
+/**************************************************************************/
+/*! 
+    @file     stack.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Reports how the SRAM is used.  The stack grows down from the top of
+    the SRAM towards the end of the bss, and the startup code fills the
+    space in between with STACK_PAINTBYTE before main is called.  The
+    lowest address that no longer holds that value is the deepest the
+    stack has ever been, which is found by scanning up from the end of
+    the bss.  The result can be slightly low if the stack happened to
+    hold STACK_PAINTBYTE at its deepest point, so allow a margin.
+
+    @section Example
+
+    @code 
+    #include "core/stack/stack.h"
+
+    printf("Stack peak: %u of %u bytes\r\n",
+           (unsigned int)stackGetPeak(), (unsigned int)stackGetSize());
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "stack.h"
+
+// These are defined and created by the linker
+extern unsigned char _data;
+extern unsigned char _ebss;
+extern unsigned char stack_entry;
+
+#define STACK_SRAMSTART (0x10000000)
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the number of bytes at the bottom of the SRAM that
+            are kept out of the linker's memory map (SRAM_USB in the
+            Makefile)
+*/
+/**************************************************************************/
+uint32_t stackGetReservedSize(void)
+{
+  return (uint32_t)&_data - STACK_SRAMSTART;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the size in bytes of the .data and .bss sections
+            (all the statically allocated variables and buffers, plus
+            any RAMFUNC code)
+*/
+/**************************************************************************/
+uint32_t stackGetStaticSize(void)
+{
+  return &_ebss - &_data;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the space in bytes left for the stack between the
+            end of the bss and the initial stack pointer
+*/
+/**************************************************************************/
+uint32_t stackGetSize(void)
+{
+  return &stack_entry - &_ebss;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the largest number of bytes the stack has used since
+            reset
+*/
+/**************************************************************************/
+uint32_t stackGetPeak(void)
+{
+  unsigned char *p = &_ebss;
+
+  while ((p < &stack_entry) && (*p == STACK_PAINTBYTE))
+  {
+    p++;
+  }
+
+  return &stack_entry - p;
+}
@@ -62,14 +62,20 @@
 /**************************************************************************/
 
 #include "systick.h"
+#include "core/bench/isrstats.h"
+#include "core/cpu/cpu.h"
 
-#ifdef CFG_SDCARD
-#include "drivers/fatfs/diskio.h"
-volatile uint32_t fatTicks = 0;
+#ifdef CFG_TFTLCD_TS_IRQ
+#include "drivers/lcd/tft/touchscreen.h"
+#endif
+
+#ifdef CFG_WDT_SUPERVISOR
+#include "core/wdt/supervisor.h"
 #endif
 
 volatile uint32_t systickTicks = 0;             // 1ms tick counter
 volatile uint32_t systickRollovers = 0;
+static uint32_t systickDelayMs = CFG_SYSTICK_DELAY_IN_MS;
 
 /**************************************************************************/
 /*! 
@@ -78,19 +84,20 @@ volatile uint32_t systickRollovers = 0;
 /**************************************************************************/
 void SysTick_Handler (void)
 {
-  systickTicks++;
+  ISRSTAT_BEGIN();
 
-  // Increment rollover counter
-  if (systickTicks == 0xFFFFFFFF) systickRollovers++;
+  // Increment rollover counter when the tick counter wraps to 0
+  if (++systickTicks == 0) systickRollovers++;
 
-  #ifdef CFG_SDCARD
-  fatTicks++;
-  if (fatTicks == 10)
-  {
-    fatTicks = 0;
-    disk_timerproc();
-  }
+  #ifdef CFG_TFTLCD_TS_IRQ
+  tsTimerProc();
+  #endif
+
+  #ifdef CFG_WDT_SUPERVISOR
+  supervisorTick();
   #endif
+
+  ISRSTAT_END(isrStat_SysTick);
 }
 
 /**************************************************************************/
@@ -121,6 +128,7 @@ static uint32_t systickConfig(uint32_t ticks)
   SYSTICK_STCURR = 0;
 
   // Enable systick IRQ and timer
+  NVIC_SetPriority(SysTick_IRQn, CFG_IRQPRIO_SYSTICK);
   SYSTICK_STCTRL = SYSTICK_STCTRL_CLKSOURCE |
                    SYSTICK_STCTRL_TICKINT |
                    SYSTICK_STCTRL_ENABLE;
@@ -128,6 +136,22 @@ static uint32_t systickConfig(uint32_t ticks)
   return (0);
 }
 
+/**************************************************************************/
+/*! 
+    @brief      Clock change hook (see cpuSetClock).  Only the reload
+                value changes, so the tick counters carry on (the tick
+                in progress is restarted).
+*/
+/**************************************************************************/
+static void systickClockChanged(uint32_t clock, bool changed)
+{
+  if (changed)
+  {
+    SYSTICK_STRELOAD = (((clock / 1000) * systickDelayMs) & SYSTICK_STRELOAD_MASK) - 1;
+    SYSTICK_STCURR = 0;
+  }
+}
+
 /**************************************************************************/
 /*! 
     @brief      Initialises the systick timer
@@ -148,7 +172,9 @@ static uint32_t systickConfig(uint32_t ticks)
 /**************************************************************************/
 void systickInit (uint32_t delayMs)
 {
-  systickConfig ((CFG_CPU_CCLK / 1000) * delayMs);
+  systickDelayMs = delayMs;
+  systickConfig ((cpuGetClock() / 1000) * delayMs);
+  cpuRegisterClockHook(systickClockChanged);
 }
 
 /**************************************************************************/
@@ -199,6 +225,59 @@ uint32_t systickGetTicks(void)
   return systickTicks;
 }
 
+/**************************************************************************/
+/*! 
+    @brief      Returns the time since the systick timer was started in
+                microseconds as a 64-bit count that never wraps around,
+                combining the tick and rollover counters with the systick
+                counter itself for the sub-tick part.  This is the time
+                base for timestamps and timeouts that need better than
+                tick resolution.
+
+    @note       Safe to call from interrupt handlers and with interrupts
+                disabled: if the counter has reloaded but the systick
+                interrupt hasn't run yet, the missing tick is added here.
+*/
+/**************************************************************************/
+uint64_t systickGetMicros64(void)
+{
+  uint32_t ticks, rollovers, cur;
+  uint64_t total;
+
+  // Make sure the tick count, rollovers and the counter belong together
+  do
+  {
+    rollovers = systickRollovers;
+    ticks = systickTicks;
+    cur = SYSTICK_STCURR;
+  } while ((ticks != systickTicks) || (rollovers != systickRollovers));
+
+  total = ((uint64_t)rollovers << 32) | ticks;
+
+  // The counter reloaded but the interrupt is held off (we're in a
+  // higher priority handler or interrupts are disabled).  A counter
+  // close to the reload value means it was read after the reload.
+  if ((SCB_ICSR & SCB_ICSR_PENDSTSET) && (cur > SYSTICK_STRELOAD / 2))
+  {
+    total++;
+  }
+
+  return total * CFG_SYSTICK_DELAY_IN_MS * 1000 + 
+         (SYSTICK_STRELOAD - cur) / (cpuGetClock() / 1000000);
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Returns the time since the systick timer was started in
+                microseconds (wraps around every 71 minutes).  See
+                systickGetMicros64.
+*/
+/**************************************************************************/
+uint32_t systickGetMicros(void)
+{
+  return (uint32_t)systickGetMicros64();
+}
+
 /**************************************************************************/
 /*! 
     @brief      Returns the current value of the systick timer rollover 
@@ -219,11 +298,40 @@ uint32_t systickGetRollovers(void)
 /**************************************************************************/
 uint32_t systickGetSecondsActive(void)
 {
-  uint32_t currentTick = systickTicks;
-  uint32_t rollovers = systickRollovers;
-  uint32_t secsActive = currentTick / (1000 / CFG_SYSTICK_DELAY_IN_MS);
-  secsActive += rollovers * (0xFFFFFFFF / (1000 / CFG_SYSTICK_DELAY_IN_MS));
+  return (uint32_t)(systickGetMicros64() / 1000000);
+}
 
-  return secsActive;
+/**************************************************************************/
+/*! 
+    @brief      Stops the systick interrupt (used by the scheduler before
+                a long sleep so that the core isn't woken every tick)
+*/
+/**************************************************************************/
+void systickSuspend(void)
+{
+  SYSTICK_STCTRL &= ~(SYSTICK_STCTRL_TICKINT | SYSTICK_STCTRL_ENABLE);
 }
 
+/**************************************************************************/
+/*! 
+    @brief      Restarts the systick timer after systickSuspend, adding
+                the ticks that were skipped while it was stopped
+
+    @param[in]  elapsedTicks
+                The number of ticks that went by while the systick timer
+                was stopped
+*/
+/**************************************************************************/
+void systickResume(uint32_t elapsedTicks)
+{
+  uint32_t ticks = systickTicks;
+
+  // Increment rollover counter
+  if (ticks + elapsedTicks < ticks) systickRollovers++;
+  systickTicks = ticks + elapsedTicks;
+
+  SYSTICK_STCURR = 0;
+  SYSTICK_STCTRL = SYSTICK_STCTRL_CLKSOURCE |
+                   SYSTICK_STCTRL_TICKINT |
+                   SYSTICK_STCTRL_ENABLE;
+}
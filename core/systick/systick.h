@@ -44,7 +44,11 @@
 void systickInit (uint32_t delayMs);
 void systickDelay (uint32_t delayTicks);
 uint32_t systickGetTicks(void);
+uint32_t systickGetMicros(void);
+uint64_t systickGetMicros64(void);
 uint32_t systickGetRollovers(void);
 uint32_t systickGetSecondsActive(void);
+void systickSuspend(void);
+void systickResume(uint32_t elapsedTicks);
 
 #endif
\ No newline at end of file
@@ -76,9 +76,18 @@
 volatile uint32_t timer16_0_counter = 0;
 volatile uint32_t timer16_1_counter = 0;
 
+#ifdef CFG_MCP4725_STREAM
+  #include "drivers/dac/mcp4725/mcp4725.h"
+#endif
+
+#ifdef CFG_LOGIC
+  #include "core/logic/logic.h"
+#endif
+
 #ifdef CFG_PWM
   volatile uint32_t pwmCounter = 0;
   extern volatile uint32_t pwmMaxPulses;    // See drivers/pwm/pwm.c
+  #include "core/pwm/pwm.h"
 #endif
 
 /**************************************************************************/
@@ -228,7 +237,7 @@ void timer16DelayUS(uint8_t timerNum, uint16_t delayInUS)
     /* Set the prescaler to zero */
     TMR_TMR16B0PR  = 0x00;
 
-    TMR_TMR16B0MR0 = delayInUS * ((CFG_CPU_CCLK/SCB_SYSAHBCLKDIV)/1000000);
+    TMR_TMR16B0MR0 = delayInUS * ((cpuGetClock()/SCB_SYSAHBCLKDIV)/1000000);
 
     /* Reset all interrupts */
     TMR_TMR16B0IR  = TMR_TMR16B0IR_MASK_ALL;
@@ -251,7 +260,7 @@ void timer16DelayUS(uint8_t timerNum, uint16_t delayInUS)
     /* Set the prescaler to zero */
     TMR_TMR16B1PR  = 0x00;
 
-    TMR_TMR16B1MR0 = delayInUS * ((CFG_CPU_CCLK/SCB_SYSAHBCLKDIV)/1000000);
+    TMR_TMR16B1MR0 = delayInUS * ((cpuGetClock()/SCB_SYSAHBCLKDIV)/1000000);
 
     /* Reset all interrupts */
     TMR_TMR16B1IR  = TMR_TMR16B1IR_MASK_ALL;
@@ -281,6 +290,17 @@ void TIMER16_0_IRQHandler(void)
 
   /* Increment timer counter by 1 (it will automatically roll back to 0) */
   timer16_0_counter++;
+
+#ifdef CFG_MCP4725_STREAM
+  /* Waveform sample pacing */
+  mcp4725StreamTimerIRQ();
+#endif
+
+#ifdef CFG_LOGIC
+  /* Logic analyser sampling */
+  logicTimerIRQ();
+#endif
+
   return;
 }
 
@@ -305,7 +325,12 @@ void TIMER16_1_IRQHandler(void)
     /* Clear the interrupt flag */
     TMR_TMR16B1IR = TMR_TMR16B1IR_MR3;
 
-    if (pwmMaxPulses > 0)
+    if (pwmPlaybackIsActive())
+    {
+      /* Load the next sample or note */
+      pwmPlaybackIRQ();
+    }
+    else if (pwmMaxPulses > 0)
     {
       pwmCounter++;
       if (pwmCounter == pwmMaxPulses)
@@ -466,6 +491,7 @@ void timer16Init(uint8_t timerNum, uint16_t timerInterval)
     TMR_TMR16B0MCR = (TMR_TMR16B0MCR_MR0_INT_ENABLED | TMR_TMR16B0MCR_MR0_RESET_ENABLED);
 
     /* Enable the TIMER0 interrupt */
+    NVIC_SetPriority(TIMER_16_0_IRQn, CFG_IRQPRIO_TIMER);
     NVIC_EnableIRQ(TIMER_16_0_IRQn);
   }
 
@@ -499,6 +525,7 @@ void timer16Init(uint8_t timerNum, uint16_t timerInterval)
     TMR_TMR16B1MCR = (TMR_TMR16B1MCR_MR0_INT_ENABLED | TMR_TMR16B1MCR_MR0_RESET_ENABLED);
 
     /* Enable the TIMER1 Interrupt */
+    NVIC_SetPriority(TIMER_16_1_IRQn, CFG_IRQPRIO_TIMER);
     NVIC_EnableIRQ(TIMER_16_1_IRQn);
   }
   return;
@@ -0,0 +1,375 @@
+/**************************************************************************/
+/*! 
+    @file     capture.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Frequency, period and pulse width measurement using the capture
+    input of 32-bit timer 0 (CT32B0_CAP0 on pin 1.5).  The timer runs
+    from the system clock without a prescaler, so every edge is
+    timestamped by the hardware to one clock (13.9nS at 72MHz) no
+    matter how late the interrupt is serviced.
+
+    In captureMode_Period the capture edge alternates between rising
+    and falling, and the interrupt stores the period (rising to rising)
+    and high time (rising to falling) of each cycle in a ring of
+    CFG_CAPTURE_SAMPLES entries.  Running sums are kept so the average
+    period, frequency and duty cycle can be read at any time without
+    walking the ring.
+
+    In captureMode_Reciprocal only rising edges are captured, and the
+    interrupt counts them until the gate time has elapsed.  The
+    frequency is then the number of whole cycles divided by the time
+    between the first and last captured edge, so the resolution is one
+    clock over the whole gate rather than over a single period.
+
+    Edges are serviced one interrupt each, so the input should stay
+    below a couple of hundred kHz, and in captureMode_Period each pulse
+    must be longer than the interrupt latency.  If no edge arrives for
+    CFG_CAPTURE_TIMEOUTMS the measurement is discarded (captureValid
+    returns false) and starts over with the next edge.
+
+    @note   Timer 0 is configured here, so timer32Delay(0, ...) can't be
+            used, and captureStart needs to be called again after
+            pmuDeepSleep (which reconfigures the timer on wakeup).
+
+    @section Example
+
+    @code
+    #include "core/timer32/capture.h"
+
+    captureStart(captureMode_Period, 0);
+    systickDelay(100);
+    if (captureValid())
+    {
+      printf("%u mHz, %u.%u%% duty%s",
+             (unsigned int)captureGetFrequency(),
+             captureGetDuty() / 10, captureGetDuty() % 10,
+             CFG_PRINTF_NEWLINE);
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "capture.h"
+#include "timer32.h"
+#include "core/systick/systick.h"
+
+#ifdef CFG_CAPTURE
+
+#define CAPTURE_TIMEOUTTICKS    (CFG_CAPTURE_TIMEOUTMS / CFG_SYSTICK_DELAY_IN_MS)
+
+typedef struct
+{
+  uint32_t period;
+  uint32_t high;
+} captureSample_t;
+
+static captureSample_t _captureRing[CFG_CAPTURE_SAMPLES];
+static uint8_t _captureHead;
+
+static captureMode_t _captureMode;
+static uint32_t _captureClock;          // Timer ticks per second
+static uint32_t _captureGateTicks;
+
+/* Measurement in progress */
+static bool _captureRising;             // Next edge to be captured is rising
+static bool _captureHaveRise;
+static bool _captureHaveFall;
+static uint32_t _captureRise;
+static uint32_t _captureFall;
+static uint32_t _captureEdges;
+static uint32_t _captureLastTick;       // systick of the last edge
+
+/* Result: _captureCount cycles took _captureSumPeriod ticks in total */
+static volatile uint32_t _captureCount;
+static volatile uint32_t _captureSumPeriod;
+static volatile uint32_t _captureSumHigh;
+
+/**************************************************************************/
+/*! 
+    @brief  Drops the measurement and result (called from the interrupt
+            or with the interrupt disabled)
+*/
+/**************************************************************************/
+static void captureRestart(void)
+{
+  _captureHead = 0;
+  _captureHaveRise = false;
+  _captureHaveFall = false;
+  _captureEdges = 0;
+  _captureCount = 0;
+  _captureSumPeriod = 0;
+  _captureSumHigh = 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Adds one cycle to the ring, replacing the oldest one once
+            the ring is full
+*/
+/**************************************************************************/
+static inline void captureRecord(uint32_t period, uint32_t high)
+{
+  captureSample_t *s = &_captureRing[_captureHead];
+
+  if (_captureCount == CFG_CAPTURE_SAMPLES)
+  {
+    _captureSumPeriod -= s->period;
+    _captureSumHigh -= s->high;
+  }
+  else
+  {
+    _captureCount++;
+  }
+
+  s->period = period;
+  s->high = high;
+  _captureSumPeriod += period;
+  _captureSumHigh += high;
+
+  if (++_captureHead == CFG_CAPTURE_SAMPLES)
+  {
+    _captureHead = 0;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Interrupt handler for 32-bit timer 0, which replaces the
+            handler in timer32.c when CFG_CAPTURE is defined
+*/
+/**************************************************************************/
+void TIMER32_0_IRQHandler(void)
+{
+  uint32_t cap, now;
+
+  cap = TMR_TMR32B0CR0;
+  TMR_TMR32B0IR = TMR_TMR32B0IR_CR0;
+
+  // Anything before a long gap says nothing about the current signal
+  now = systickGetTicks();
+  if (now - _captureLastTick > CAPTURE_TIMEOUTTICKS)
+  {
+    captureRestart();
+  }
+  _captureLastTick = now;
+
+  if (_captureMode == captureMode_Reciprocal)
+  {
+    if (_captureEdges == 0)
+    {
+      _captureRise = cap;
+    }
+    else if (cap - _captureRise >= _captureGateTicks)
+    {
+      _captureCount = _captureEdges;
+      _captureSumPeriod = cap - _captureRise;
+      _captureRise = cap;
+      _captureEdges = 0;
+    }
+    _captureEdges++;
+    return;
+  }
+
+  if (_captureRising)
+  {
+    TMR_TMR32B0CCR = TMR_TMR32B0CCR_CAP0FE_ENABLED | TMR_TMR32B0CCR_CAP0I_ENABLED;
+    if (_captureHaveRise && _captureHaveFall)
+    {
+      captureRecord(cap - _captureRise, _captureFall - _captureRise);
+    }
+    _captureRise = cap;
+    _captureHaveRise = true;
+    _captureHaveFall = false;
+  }
+  else
+  {
+    TMR_TMR32B0CCR = TMR_TMR32B0CCR_CAP0RE_ENABLED | TMR_TMR32B0CCR_CAP0I_ENABLED;
+    _captureFall = cap;
+    _captureHaveFall = _captureHaveRise;
+  }
+  _captureRising = !_captureRising;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Starts measuring the signal on pin 1.5
+
+    @param[in]  mode
+                captureMode_Period or captureMode_Reciprocal
+    @param[in]  gateMs
+                The gate time in milliseconds for captureMode_Reciprocal
+                (1..CAPTURE_MAXGATEMS), ignored for captureMode_Period
+*/
+/**************************************************************************/
+void captureStart(captureMode_t mode, uint32_t gateMs)
+{
+  NVIC_DisableIRQ(TIMER_32_0_IRQn);
+
+  if (gateMs < 1) gateMs = 1;
+  if (gateMs > CAPTURE_MAXGATEMS) gateMs = CAPTURE_MAXGATEMS;
+
+  _captureMode = mode;
+  _captureClock = TIMER32_CCLK_1S;
+  _captureGateTicks = (_captureClock / 1000) * gateMs;
+  _captureRising = true;
+  _captureLastTick = systickGetTicks();
+  captureRestart();
+
+  /* Enable the clock for CT32B0 */
+  SCB_SYSAHBCLKCTRL |= (SCB_SYSAHBCLKCTRL_CT32B0);
+
+  /* Configure PIO1.5 as Timer0_32 CAP0 */
+  IOCON_PIO1_5 &= ~IOCON_PIO1_5_FUNC_MASK;
+  IOCON_PIO1_5 |= IOCON_PIO1_5_FUNC_CT32B0_CAP0;
+
+  /* Free running from the system clock, capture (and interrupt) on the
+     rising edge first */
+  TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERRESET_ENABLED;
+  TMR_TMR32B0CTCR = TMR_TMR32B0CTCR_CTMODE_TIMER;
+  TMR_TMR32B0PR = 0;
+  TMR_TMR32B0MCR = 0;
+  TMR_TMR32B0CCR = TMR_TMR32B0CCR_CAP0RE_ENABLED | TMR_TMR32B0CCR_CAP0I_ENABLED;
+  TMR_TMR32B0IR = TMR_TMR32B0IR_MASK_ALL;
+  TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERENABLE_ENABLED;
+
+  NVIC_SetPriority(TIMER_32_0_IRQn, CFG_IRQPRIO_TIMER);
+  NVIC_EnableIRQ(TIMER_32_0_IRQn);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Stops measuring (the last result can still be read until
+            it times out)
+*/
+/**************************************************************************/
+void captureStop(void)
+{
+  NVIC_DisableIRQ(TIMER_32_0_IRQn);
+  TMR_TMR32B0CCR = 0;
+  TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERENABLE_DISABLED;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns true if a measurement is available and an edge has
+            been seen within the last CFG_CAPTURE_TIMEOUTMS
+*/
+/**************************************************************************/
+bool captureValid(void)
+{
+  return _captureCount && (systickGetTicks() - _captureLastTick <= CAPTURE_TIMEOUTTICKS);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reads the result consistently
+
+    @return false if there is no valid measurement
+*/
+/**************************************************************************/
+static bool captureRead(uint32_t *count, uint32_t *sumPeriod, uint32_t *sumHigh)
+{
+  bool valid;
+
+  NVIC_DisableIRQ(TIMER_32_0_IRQn);
+  valid = captureValid();
+  *count = _captureCount;
+  *sumPeriod = _captureSumPeriod;
+  *sumHigh = _captureSumHigh;
+  if (TMR_TMR32B0CCR)
+  {
+    NVIC_EnableIRQ(TIMER_32_0_IRQn);
+  }
+
+  return valid && *sumPeriod;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the average period in timer ticks (system clock
+            cycles), or 0 if there is no valid measurement
+*/
+/**************************************************************************/
+uint32_t captureGetPeriodTicks(void)
+{
+  uint32_t count, sumPeriod, sumHigh;
+
+  if (!captureRead(&count, &sumPeriod, &sumHigh)) return 0;
+  return (sumPeriod + count / 2) / count;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the average period in nanoseconds, or 0 if there is
+            no valid measurement
+*/
+/**************************************************************************/
+uint32_t captureGetPeriodNs(void)
+{
+  uint32_t count, sumPeriod, sumHigh;
+
+  if (!captureRead(&count, &sumPeriod, &sumHigh)) return 0;
+  return (uint32_t)(((uint64_t)sumPeriod * 1000000000ULL) / ((uint64_t)_captureClock * count));
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the frequency in millihertz, or 0 if there is no
+            valid measurement
+*/
+/**************************************************************************/
+uint32_t captureGetFrequency(void)
+{
+  uint32_t count, sumPeriod, sumHigh;
+
+  if (!captureRead(&count, &sumPeriod, &sumHigh)) return 0;
+  return (uint32_t)(((uint64_t)_captureClock * 1000 * count + sumPeriod / 2) / sumPeriod);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the duty cycle (high time) in tenths of a percent
+            (0..1000).  Only captureMode_Period measures the duty cycle,
+            captureMode_Reciprocal always returns 0.
+*/
+/**************************************************************************/
+uint16_t captureGetDuty(void)
+{
+  uint32_t count, sumPeriod, sumHigh;
+
+  if (!captureRead(&count, &sumPeriod, &sumHigh)) return 0;
+  return (uint16_t)(((uint64_t)sumHigh * 1000 + sumPeriod / 2) / sumPeriod);
+}
+
+#endif
@@ -0,0 +1,202 @@
+/**************************************************************************/
+/*! 
+    @file     profiler.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Sampling profiler using 32-bit timer 1.  At CFG_PROFILER_RATE Hz the
+    timer interrupt reads the PC that was pushed on the stack when the
+    interrupt was taken, and increments the histogram bucket for that
+    address.  Each bucket covers (1 << CFG_PROFILER_BUCKETSHIFT) bytes of
+    flash, and the counts can be matched to functions on the host with
+    the .map file or 'arm-none-eabi-addr2line -f -e firmware.elf <addr>'.
+
+    Timer 1 is used by the ROM-based USB HID driver, so this can't be
+    used with CFG_USBHID.  While sampling, the timer interrupt is raised
+    to priority 0 so that it can preempt the other interrupt handlers
+    (see CFG_IRQPRIO_... in projectconfig.h), and time spent in them is
+    attributed to the handlers.  Anything else at level 0, or code that
+    runs with interrupts disabled, is still attributed to the code that
+    runs after it.
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "profiler.h"
+#include "timer32.h"
+
+#ifdef CFG_PROFILER
+
+static uint16_t _profilerBuckets[PROFILER_BUCKETS];
+static volatile uint32_t _profilerSamples = 0;
+static volatile uint32_t _profilerOutside = 0;
+static bool _profilerRunning = false;
+
+/**************************************************************************/
+/*! 
+    @brief  Records one sample (called from TIMER32_1_IRQHandler)
+
+    @param[in]  frame
+                The exception stack frame (r0-r3, r12, lr, pc, xpsr)
+*/
+/**************************************************************************/
+void profilerSample(uint32_t *frame)
+{
+  uint32_t pc = frame[6];
+
+  /* Clear the interrupt flag */
+  TMR_TMR32B1IR = TMR_TMR32B1IR_MR0;
+
+  _profilerSamples++;
+  if (pc < PROFILER_FLASHSIZE)
+  {
+    // Saturate rather than wrap around
+    if (_profilerBuckets[pc >> CFG_PROFILER_BUCKETSHIFT] != 0xFFFF)
+    {
+      _profilerBuckets[pc >> CFG_PROFILER_BUCKETSHIFT]++;
+    }
+  }
+  else
+  {
+    // RAM or ROM (USB/IAP drivers)
+    _profilerOutside++;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Interrupt handler for 32-bit timer 1, which passes the stack
+            frame to profilerSample.  This replaces the handler in
+            timer32.c when CFG_PROFILER is defined.
+*/
+/**************************************************************************/
+void TIMER32_1_IRQHandler(void) __attribute__ ((naked));
+void TIMER32_1_IRQHandler(void)
+{
+  __asm volatile (
+    "tst    lr, #4          \n"
+    "ite    eq              \n"
+    "mrseq  r0, msp         \n"
+    "mrsne  r0, psp         \n"
+    "b      profilerSample  \n"
+  );
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Starts (or resumes) sampling
+*/
+/**************************************************************************/
+void profilerStart(void)
+{
+  if (!_profilerRunning)
+  {
+    timer32Init(1, TIMER32_CCLK_1S / CFG_PROFILER_RATE);
+    NVIC_SetPriority(TIMER_32_1_IRQn, 0);
+    timer32Enable(1);
+    _profilerRunning = true;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Stops sampling (the histogram is kept)
+*/
+/**************************************************************************/
+void profilerStop(void)
+{
+  timer32Disable(1);
+  NVIC_DisableIRQ(TIMER_32_1_IRQn);
+  NVIC_SetPriority(TIMER_32_1_IRQn, CFG_IRQPRIO_TIMER);
+  _profilerRunning = false;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Clears the histogram
+*/
+/**************************************************************************/
+void profilerClear(void)
+{
+  NVIC_DisableIRQ(TIMER_32_1_IRQn);
+  memset(_profilerBuckets, 0, sizeof(_profilerBuckets));
+  _profilerSamples = 0;
+  _profilerOutside = 0;
+  if (_profilerRunning)
+  {
+    NVIC_EnableIRQ(TIMER_32_1_IRQn);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns true if the profiler is sampling
+*/
+/**************************************************************************/
+bool profilerRunning(void)
+{
+  return _profilerRunning;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the number of samples for a bucket, which covers
+            the addresses starting at 'bucket * PROFILER_BUCKETSIZE'
+*/
+/**************************************************************************/
+uint16_t profilerGetBucket(uint32_t bucket)
+{
+  return bucket < PROFILER_BUCKETS ? _profilerBuckets[bucket] : 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the total number of samples taken
+*/
+/**************************************************************************/
+uint32_t profilerGetSamples(void)
+{
+  return _profilerSamples;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the number of samples outside of flash
+*/
+/**************************************************************************/
+uint32_t profilerGetOutside(void)
+{
+  return _profilerOutside;
+}
+
+#endif
@@ -0,0 +1,350 @@
+/**************************************************************************/
+/*! 
+    @file     swtimer.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Software timers multiplexed onto 32-bit timer 1.  The timer counts
+    microseconds and is never reset, and a single match register (MR0)
+    is set to the deadline of the first timer in a list sorted by
+    deadline.  When the match interrupt fires, every timer that has
+    expired is run (periodic timers are put back in the list first),
+    and the match is moved on to the next deadline, so there is one
+    interrupt per expiry rather than one per tick.  Timers that expire
+    after all of the others (a periodic timer that has just been
+    reloaded with the longest period, for example) are appended in
+    constant time.
+
+    Callbacks run in the timer interrupt and must be short.  They can
+    start and stop timers, including their own.  Longer work should be
+    posted to a scheduler task (see core/sched) instead.
+
+    Timer 1 is also used by the ROM-based USB HID driver, the profiler
+    and the tickless scheduler, so this can't be used with CFG_USBHID,
+    CFG_PROFILER or CFG_SCHEDULER_TICKLESS.
+
+    @section Example
+
+    @code 
+    #include "core/timer32/swtimer.h"
+
+    static swtimer_t blinkTimer;
+
+    void blink(swtimer_t *timer)
+    {
+      gpioSetValue(CFG_LED_PORT, CFG_LED_PIN, !gpioGetValue(CFG_LED_PORT, CFG_LED_PIN));
+    }
+
+    ...
+    swtimerInit();      // Called by systemInit when CFG_SWTIMER is defined
+    swtimerSetup(&blinkTimer, blink, NULL);
+    swtimerStart(&blinkTimer, 500000, 500000);   // Every 500ms
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "swtimer.h"
+#include "timer32.h"
+#include "core/sched/event.h"
+
+#ifdef CFG_SWTIMER
+
+static swtimer_t *_swtimerHead = NULL;        // Sorted by deadline
+static swtimer_t *_swtimerTail = NULL;
+
+/**************************************************************************/
+/*! 
+    @brief  Returns true if time 'a' comes before time 'b' (this works
+            across the 32-bit wraparound as long as they are less than
+            ~35 minutes apart)
+*/
+/**************************************************************************/
+static inline bool swtimerBefore(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) < 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Adds a timer to the list (timer interrupt disabled)
+*/
+/**************************************************************************/
+static void swtimerInsert(swtimer_t *timer)
+{
+  swtimer_t **link;
+
+  timer->next = NULL;
+  timer->active = true;
+
+  if (!_swtimerHead)
+  {
+    _swtimerHead = _swtimerTail = timer;
+    return;
+  }
+
+  // Expires after everything else, so no need to walk the list
+  if (!swtimerBefore(timer->deadline, _swtimerTail->deadline))
+  {
+    _swtimerTail->next = timer;
+    _swtimerTail = timer;
+    return;
+  }
+
+  link = &_swtimerHead;
+  while (*link && !swtimerBefore(timer->deadline, (*link)->deadline))
+  {
+    link = &(*link)->next;
+  }
+  timer->next = *link;
+  *link = timer;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Removes a timer from the list (timer interrupt disabled)
+*/
+/**************************************************************************/
+static void swtimerRemove(swtimer_t *timer)
+{
+  swtimer_t **link = &_swtimerHead;
+  swtimer_t *prev = NULL;
+
+  while (*link)
+  {
+    if (*link == timer)
+    {
+      *link = timer->next;
+      if (_swtimerTail == timer)
+      {
+        _swtimerTail = prev;
+      }
+      break;
+    }
+    prev = *link;
+    link = &(*link)->next;
+  }
+  timer->active = false;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Moves the match to the first deadline.  Returns false if that
+            deadline has already passed, in which case the caller has to
+            run the expired timers itself.
+*/
+/**************************************************************************/
+static bool swtimerArm(void)
+{
+  if (!_swtimerHead)
+  {
+    TMR_TMR32B1MCR = 0;
+    return true;
+  }
+
+  TMR_TMR32B1MR0 = _swtimerHead->deadline;
+  TMR_TMR32B1MCR = TMR_TMR32B1MCR_MR0_INT_ENABLED;
+
+  // The counter may have passed the deadline while it was being set
+  return swtimerBefore(TMR_TMR32B1TC, _swtimerHead->deadline);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Runs the expired timers and sets the match for the next one
+*/
+/**************************************************************************/
+void TIMER32_1_IRQHandler(void)
+{
+  swtimer_t *timer;
+
+  TMR_TMR32B1IR = TMR_TMR32B1IR_MR0;
+
+  do
+  {
+    while (_swtimerHead && !swtimerBefore(TMR_TMR32B1TC, _swtimerHead->deadline))
+    {
+      timer = _swtimerHead;
+      _swtimerHead = timer->next;
+      if (!_swtimerHead)
+      {
+        _swtimerTail = NULL;
+      }
+      timer->active = false;
+
+      if (timer->period)
+      {
+        // Reload from the deadline rather than now, so it doesn't drift
+        timer->deadline += timer->period;
+        swtimerInsert(timer);
+      }
+      timer->callback(timer);
+      eventSignal(EVENT_SOURCE_TIMER);
+    }
+  } while (!swtimerArm());
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Clock change hook (see cpuSetClock), keeps the timer
+            counting microseconds
+*/
+/**************************************************************************/
+static void swtimerClockChanged(uint32_t clock, bool changed)
+{
+  if (changed)
+  {
+    TMR_TMR32B1PR = (clock / SCB_SYSAHBCLKDIV) / 1000000 - 1;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Starts 32-bit timer 1 counting microseconds
+*/
+/**************************************************************************/
+void swtimerInit(void)
+{
+  SCB_SYSAHBCLKCTRL |= (SCB_SYSAHBCLKCTRL_CT32B1);
+  TMR_TMR32B1TCR = TMR_TMR32B1TCR_COUNTERRESET_ENABLED;
+  TMR_TMR32B1PR = TIMER32_CCLK_1US - 1;
+  TMR_TMR32B1MCR = 0;
+  TMR_TMR32B1IR = TMR_TMR32B1IR_MR0;
+  _swtimerHead = _swtimerTail = NULL;
+  NVIC_SetPriority(TIMER_32_1_IRQn, CFG_IRQPRIO_TIMER);
+  NVIC_EnableIRQ(TIMER_32_1_IRQn);
+  TMR_TMR32B1TCR = TMR_TMR32B1TCR_COUNTERENABLE_ENABLED;
+  cpuRegisterClockHook(swtimerClockChanged);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Initialises a timer
+
+    @param[in]  timer
+                The timer to initialise (statically allocated)
+    @param[in]  callback
+                The function run from the timer interrupt on expiry
+    @param[in]  arg
+                User data, available as timer->arg in the callback
+*/
+/**************************************************************************/
+void swtimerSetup(swtimer_t *timer, swtimerCallback_t callback, void *arg)
+{
+  timer->callback = callback;
+  timer->arg = arg;
+  timer->next = NULL;
+  timer->period = 0;
+  timer->active = false;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Starts (or restarts) a timer
+
+    @param[in]  timer
+                The timer to start
+    @param[in]  delayUs
+                Microseconds until the first expiry (1..0x7FFFFFFF)
+    @param[in]  periodUs
+                Microseconds between expiries after that, or 0 for a
+                one-shot timer
+*/
+/**************************************************************************/
+void swtimerStart(swtimer_t *timer, uint32_t delayUs, uint32_t periodUs)
+{
+  NVIC_DisableIRQ(TIMER_32_1_IRQn);
+  if (timer->active)
+  {
+    swtimerRemove(timer);
+  }
+  timer->period = periodUs;
+  timer->deadline = TMR_TMR32B1TC + (delayUs ? delayUs : 1);
+  swtimerInsert(timer);
+  if (!swtimerArm())
+  {
+    // Already due, let the interrupt handler run it
+    NVIC_SetPendingIRQ(TIMER_32_1_IRQn);
+  }
+  NVIC_EnableIRQ(TIMER_32_1_IRQn);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Stops a timer (nothing happens if it isn't running)
+*/
+/**************************************************************************/
+void swtimerStop(swtimer_t *timer)
+{
+  NVIC_DisableIRQ(TIMER_32_1_IRQn);
+  if (timer->active)
+  {
+    swtimerRemove(timer);
+    swtimerArm();
+  }
+  timer->period = 0;
+  NVIC_EnableIRQ(TIMER_32_1_IRQn);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns true while a timer is waiting to expire
+*/
+/**************************************************************************/
+bool swtimerIsActive(swtimer_t *timer)
+{
+  return timer->active;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the microsecond count (wraps around every ~71 minutes)
+*/
+/**************************************************************************/
+uint32_t swtimerNow(void)
+{
+  return TMR_TMR32B1TC;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Waits for the specified number of microseconds by polling
+            the timer count (no interrupt and no other timer needed)
+*/
+/**************************************************************************/
+void swtimerDelayUs(uint32_t us)
+{
+  uint32_t start = TMR_TMR32B1TC;
+
+  while ((TMR_TMR32B1TC - start) < us);
+}
+
+#endif
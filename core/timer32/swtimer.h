@@ -0,0 +1,68 @@
+/**************************************************************************/
+/*! 
+    @file     swtimer.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __SWTIMER_H__ 
+#define __SWTIMER_H__
+
+#include "projectconfig.h"
+
+struct swtimer_s;
+typedef void (*swtimerCallback_t)(struct swtimer_s *timer);
+
+/**************************************************************************/
+/*! 
+    A one-shot or periodic timer.  Timers are statically allocated by the
+    caller, and all of the fields are private to swtimer.c.
+*/
+/**************************************************************************/
+typedef struct swtimer_s
+{
+  swtimerCallback_t callback;         // Called from the timer interrupt
+  void *arg;                          // User data
+  uint32_t deadline;                  // Timer count (us) when it expires
+  uint32_t period;                    // Reload in us (0 = one-shot)
+  struct swtimer_s *next;             // Sorted by deadline
+  bool active;
+} swtimer_t;
+
+void     swtimerInit ( void );
+void     swtimerSetup ( swtimer_t *timer, swtimerCallback_t callback, void *arg );
+void     swtimerStart ( swtimer_t *timer, uint32_t delayUs, uint32_t periodUs );
+void     swtimerStop ( swtimer_t *timer );
+bool     swtimerIsActive ( swtimer_t *timer );
+uint32_t swtimerNow ( void );
+void     swtimerDelayUs ( uint32_t us );
+
+#endif
@@ -67,6 +67,10 @@
 
 #include "timer32.h"
 
+#ifdef CFG_STEPPER
+#include "drivers/motor/stepper/stepper.h"
+#endif
+
 volatile uint32_t timer32_0_counter = 0;
 volatile uint32_t timer32_1_counter = 0;
 
@@ -125,9 +129,11 @@ void timer32Delay(uint8_t timerNum, uint32_t delay)
 
 /**************************************************************************/
 /*! 
-    @brief Interrupt handler for 32-bit timer 0
+    @brief Interrupt handler for 32-bit timer 0 (see capture.c when
+    CFG_CAPTURE is defined)
 */
 /**************************************************************************/
+#ifndef CFG_CAPTURE
 void TIMER32_0_IRQHandler(void)
 {  
   /* Clear the interrupt flag */
@@ -137,14 +143,22 @@ void TIMER32_0_IRQHandler(void)
      incrementing a counter variable) you can do so here */
   timer32_0_counter++;
 
+#ifdef CFG_STEPPER
+  /* Step timing */
+  stepperTimerIRQ();
+#endif
+
   return;
 }
+#endif
 
 /**************************************************************************/
 /*! 
-	@brief Interrupt handler for 32-bit timer 1
+	@brief Interrupt handler for 32-bit timer 1 (see profiler.c when
+	CFG_PROFILER is defined, and swtimer.c when CFG_SWTIMER is defined)
 */
 /**************************************************************************/
+#if !defined CFG_PROFILER && !defined CFG_SWTIMER
 void TIMER32_1_IRQHandler(void)
 {  
   /* Clear the interrupt flag */
@@ -156,6 +170,7 @@ void TIMER32_1_IRQHandler(void)
 
   return;
 }
+#endif
 
 /**************************************************************************/
 /*! 
@@ -294,6 +309,7 @@ void timer32Init(uint8_t timerNum, uint32_t timerInterval)
     TMR_TMR32B0MCR = (TMR_TMR32B0MCR_MR0_INT_ENABLED | TMR_TMR32B0MCR_MR0_RESET_ENABLED);
 
     /* Enable the TIMER0 interrupt */
+    NVIC_SetPriority(TIMER_32_0_IRQn, CFG_IRQPRIO_TIMER);
     NVIC_EnableIRQ(TIMER_32_0_IRQn);
   }
 
@@ -336,6 +352,7 @@ void timer32Init(uint8_t timerNum, uint32_t timerInterval)
     TMR_TMR32B1MCR = (TMR_TMR32B1MCR_MR0_INT_ENABLED | TMR_TMR32B1MCR_MR0_RESET_ENABLED);
 
     /* Enable the TIMER1 Interrupt */
+    NVIC_SetPriority(TIMER_32_1_IRQn, CFG_IRQPRIO_TIMER);
     NVIC_EnableIRQ(TIMER_32_1_IRQn);
   }
   return;
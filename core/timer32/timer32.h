@@ -40,14 +40,15 @@
 #define __TIMER32_H__
 
 #include "projectconfig.h"
+#include "core/cpu/cpu.h"
 
-#define TIMER32_CCLK_1US        ((CFG_CPU_CCLK/SCB_SYSAHBCLKDIV) / 1000000)
-#define TIMER32_CCLK_10US       ((CFG_CPU_CCLK/SCB_SYSAHBCLKDIV) / 100000)
-#define TIMER32_CCLK_100US      ((CFG_CPU_CCLK/SCB_SYSAHBCLKDIV) / 10000)
-#define TIMER32_CCLK_1MS        ((CFG_CPU_CCLK/SCB_SYSAHBCLKDIV) / 1000)
-#define TIMER32_CCLK_10MS       ((CFG_CPU_CCLK/SCB_SYSAHBCLKDIV) / 100)
-#define TIMER32_CCLK_100MS      ((CFG_CPU_CCLK/SCB_SYSAHBCLKDIV) / 10)
-#define TIMER32_CCLK_1S         (CFG_CPU_CCLK/SCB_SYSAHBCLKDIV)
+#define TIMER32_CCLK_1US        ((cpuGetClock()/SCB_SYSAHBCLKDIV) / 1000000)
+#define TIMER32_CCLK_10US       ((cpuGetClock()/SCB_SYSAHBCLKDIV) / 100000)
+#define TIMER32_CCLK_100US      ((cpuGetClock()/SCB_SYSAHBCLKDIV) / 10000)
+#define TIMER32_CCLK_1MS        ((cpuGetClock()/SCB_SYSAHBCLKDIV) / 1000)
+#define TIMER32_CCLK_10MS       ((cpuGetClock()/SCB_SYSAHBCLKDIV) / 100)
+#define TIMER32_CCLK_100MS      ((cpuGetClock()/SCB_SYSAHBCLKDIV) / 10)
+#define TIMER32_CCLK_1S         (cpuGetClock()/SCB_SYSAHBCLKDIV)
 #define TIMER32_DEFAULTINTERVAL	(TIMER32_CCLK_100US)
 
 #define TIMER32_DELAY_100US     (1)            // 100uS delay = 1 tick
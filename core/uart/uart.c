@@ -94,6 +94,10 @@
 #include <string.h>
 
 #include "uart.h"
+#include "core/bench/isrstats.h"
+#include "core/cpu/cpu.h"
+#include "core/clkgate/clkgate.h"
+#include "core/sched/event.h"
 
 #ifdef CFG_INTERFACE_UART
   #include "core/cmd/cmd.h"
@@ -108,17 +112,238 @@
 /**************************************************************************/
 static uart_pcb_t pcb;
 
+// Baud rate measured by the auto-baud hardware, 0 after a time-out
+static volatile uint32_t uartAutoBaudRate;
+
+// Standard rates that auto-baud measurements are rounded to
+static const uint32_t uartStandardRates[] =
+{
+  1200, 2400, 4800, 9600, 14400, 19200, 38400, 57600, 115200,
+  230400, 460800, 921600, 1000000, 1500000, 2000000, 3000000
+};
+
+/**************************************************************************/
+/*!
+    Returns the clock feeding the baud rate generator (UART_PCLK)
+*/
+/**************************************************************************/
+static uint32_t uartGetPClk(uint32_t clock)
+{
+  return (clock * SCB_SYSAHBCLKDIV) / SCB_UARTCLKDIV;
+}
+
+/**************************************************************************/
+/*!
+    Searches every fractional divider setting for the one that gets
+    closest to 'baudrate', where
+
+      baud rate = UART_PCLK / (16 * DL * (1 + DIVADDVAL / MULVAL))
+
+    with 1 <= MULVAL <= 15 and 0 <= DIVADDVAL < MULVAL.  DL has to be at
+    least 3 when DIVADDVAL isn't 0.  Returns the rate that will actually
+    be used (0 if it can't be reached at all), and the DL and FDR values
+    needed for it.
+*/
+/**************************************************************************/
+static uint32_t uartFindDivisor(uint32_t pclk, uint32_t baudrate, uint32_t *dl, uint32_t *fdr)
+{
+  uint32_t mulVal, divAddVal, div, den, rate, err;
+  uint32_t best = 0, bestErr = 0xFFFFFFFF;
+
+  for (mulVal = 1; (mulVal <= 15) && bestErr; mulVal++)
+  {
+    for (divAddVal = 0; (divAddVal < mulVal) && bestErr; divAddVal++)
+    {
+      den = 16 * baudrate * (mulVal + divAddVal);
+      div = (pclk * mulVal + den / 2) / den;
+      if ((div == 0) || (div > 0xFFFF) || (divAddVal && (div < 3)))
+      {
+        continue;
+      }
+
+      rate = (pclk * mulVal) / (16 * div * (mulVal + divAddVal));
+      err = rate > baudrate ? rate - baudrate : baudrate - rate;
+      if (err < bestErr)
+      {
+        bestErr = err;
+        best = rate;
+        *dl = div;
+        *fdr = (mulVal << 4) | divAddVal;
+      }
+    }
+  }
+
+  return best;
+}
+
+/**************************************************************************/
+/*!
+    Programs the divisors for 'baudrate' at the given core clock
+*/
+/**************************************************************************/
+static void uartSetDivisors(uint32_t clock, uint32_t baudrate)
+{
+  uint32_t dl = 0, fdr = 0x10;
+
+  pcb.actual = uartFindDivisor(uartGetPClk(clock), baudrate, &dl, &fdr);
+  if (!pcb.actual)
+  {
+    // Out of range, use the nearest limit the divisor allows
+    dl = baudrate > UART_BAUDRATE_MIN ? 1 : 0xFFFF;
+    fdr = 0x10;
+    pcb.actual = uartGetPClk(clock) / (16 * dl);
+  }
+
+  UART_U0LCR |= UART_U0LCR_Divisor_Latch_Access_Enabled;
+  UART_U0DLM = dl / 256;
+  UART_U0DLL = dl % 256;
+  UART_U0LCR &= ~UART_U0LCR_Divisor_Latch_Access_MASK;
+  UART_U0FDR = fdr;
+}
+
+/**************************************************************************/
+/*!
+    Handles the end of an auto-baud measurement (or its time-out).  The
+    hardware has already loaded DLM/DLL with the measured divisor, which
+    is rounded to the nearest standard rate within 3% and set again
+    through the fractional divider.
+*/
+/**************************************************************************/
+static void uartAutoBaudDone(uint32_t iir)
+{
+  uint32_t dl, rate, err;
+  uint8_t i;
+
+  UART_U0ACR |= UART_U0ACR_ABEOIntClr | UART_U0ACR_ABTOIntClr;
+  UART_U0IER &= ~(UART_U0IER_ABEOIntEn_MASK | UART_U0IER_ABTOIntEn_MASK);
+
+  rate = 0;
+  if (iir & UART_U0IIR_ABEOInt)
+  {
+    UART_U0LCR |= UART_U0LCR_Divisor_Latch_Access_Enabled;
+    dl = (UART_U0DLM << 8) | UART_U0DLL;
+    UART_U0LCR &= ~UART_U0LCR_Divisor_Latch_Access_MASK;
+    rate = dl ? uartGetPClk(cpuGetClock()) / (16 * dl) : 0;
+
+    for (i = 0; i < sizeof(uartStandardRates) / sizeof(uartStandardRates[0]); i++)
+    {
+      err = rate > uartStandardRates[i] ? rate - uartStandardRates[i] : uartStandardRates[i] - rate;
+      if (err * 100 <= uartStandardRates[i] * 3)
+      {
+        rate = uartStandardRates[i];
+        break;
+      }
+    }
+  }
+
+  if (rate)
+  {
+    pcb.baudrate = rate;
+  }
+  uartSetDivisors(cpuGetClock(), pcb.baudrate);
+  uartAutoBaudRate = rate;
+  eventSet(&pcb.events, UART_EVENT_AUTOBAUD);
+}
+
+/**************************************************************************/
+/*!
+    Moves bytes from the TX buffer into the 16-byte TX FIFO if it's
+    empty, and disables the THRE interrupt once everything is sent.
+    Called from the IRQ, or with the UART IRQ disabled.
+*/
+/**************************************************************************/
+static void uartTxFill(void)
+{
+  uint16_t tail = pcb.txfifo.tail;
+  uint8_t count;
+
+  if (!(UART_U0LSR & UART_U0LSR_THRE))
+  {
+    return;
+  }
+
+  for (count = 0; (count < 16) && (tail != pcb.txfifo.head); count++)
+  {
+    UART_U0THR = pcb.txfifo.buf[tail & (CFG_UART_TXBUFSIZE - 1)];
+    tail++;
+  }
+  pcb.txfifo.tail = tail;
+
+  if (tail == pcb.txfifo.head)
+  {
+    UART_U0IER &= ~UART_U0IER_THRE_Interrupt_MASK;
+    eventSet(&pcb.events, UART_EVENT_TXIDLE);
+  }
+}
+
+/**************************************************************************/
+/*!
+    Moves every byte waiting in the 16-byte RX FIFO into the RX buffer,
+    so each interrupt handles a whole batch of bytes instead of one
+*/
+/**************************************************************************/
+static void uartRxDrain(void)
+{
+  #ifdef CFG_UART_RS485
+  if (pcb.rs485)
+  {
+    // Only complete frames for this node wake the main loop
+    while (UART_U0LSR & UART_U0LSR_RDR_DATA)
+    {
+      if (uartRS485RxByte(UART_U0RBR))
+      {
+        eventSet(&pcb.events, UART_EVENT_RXFRAME);
+        eventSignal(EVENT_SOURCE_UARTRX);
+      }
+    }
+    return;
+  }
+  #endif
+
+  while (UART_U0LSR & UART_U0LSR_RDR_DATA)
+  {
+    uartRxBufferWrite(UART_U0RBR);
+  }
+  eventSet(&pcb.events, UART_EVENT_RXDATA);
+  eventSignal(EVENT_SOURCE_UARTRX);
+}
+
+/**************************************************************************/
+/*!
+    Waits until the TX buffer is empty
+*/
+/**************************************************************************/
+static void uartTxDrain(void)
+{
+  while (pcb.txfifo.tail != pcb.txfifo.head)
+  {
+    NVIC_DisableIRQ(UART_IRQn);
+    uartTxFill();
+    NVIC_EnableIRQ(UART_IRQn);
+  }
+}
+
 /**************************************************************************/
 /*!
     IRQ to handle incoming data, etc.
 */
 /**************************************************************************/
-void UART_IRQHandler(void)
+HOTFUNC void UART_IRQHandler(void)
 {
+  uint32_t iir;
   uint8_t IIRValue, LSRValue;
   uint8_t Dummy = Dummy;
+  ISRSTAT_BEGIN();
+
+  iir = UART_U0IIR;
+  if (iir & (UART_U0IIR_ABEOInt | UART_U0IIR_ABTOInt))
+  {
+    uartAutoBaudDone(iir);
+    ISRSTAT_END(isrStat_UART);
+    return;
+  }
 
-  IIRValue = UART_U0IIR;
+  IIRValue = iir;
   IIRValue &= ~(UART_U0IIR_IntStatus_MASK); /* skip pending bit in IIR */
   IIRValue &= UART_U0IIR_IntId_MASK;        /* check bit 1~3, interrupt identification */
 
@@ -133,6 +358,7 @@ void UART_IRQHandler(void)
       /* Read LSR will clear the interrupt */
       pcb.status = LSRValue;
       Dummy = UART_U0RBR;	/* Dummy read on RX to clear interrupt, then bail out */
+      ISRSTAT_END(isrStat_UART);
       return;
     }
     // No error and receive data is ready
@@ -140,38 +366,25 @@ void UART_IRQHandler(void)
     {
       /* If no error on RLS, normal ready, save into the data buffer. */
       /* Note: read RBR will clear the interrupt */
-      uartRxBufferWrite(UART_U0RBR);
+      uartRxDrain();
     }
   }
 
-  // 2.) Check receive data available
-  else if (IIRValue == UART_U0IIR_IntId_RDA)
+  // 2.) Check receive data available (RX FIFO trigger level reached)
+  // 3.) or character timeout indicator (bytes left below the trigger level)
+  else if ((IIRValue == UART_U0IIR_IntId_RDA) || (IIRValue == UART_U0IIR_IntId_CTI))
   {
-    // Add incoming text to UART buffer
-    uartRxBufferWrite(UART_U0RBR);
-  }
-
-  // 3.) Check character timeout indicator
-  else if (IIRValue == UART_U0IIR_IntId_CTI)
-  {
-    /* Bit 9 as the CTI error */
-    pcb.status |= 0x100;
+    // Move everything in the RX FIFO into the UART buffer
+    uartRxDrain();
   }
 
   // 4.) Check THRE (transmit holding register empty)
   else if (IIRValue == UART_U0IIR_IntId_THRE)
   {
-    /* Check status in the LSR to see if valid data in U0THR or not */
-    LSRValue = UART_U0LSR;
-    if (LSRValue & UART_U0LSR_THRE)
-    {
-      pcb.pending_tx_data = 0;
-    }
-    else
-    {
-      pcb.pending_tx_data= 1;
-    }
+    /* Refill the TX FIFO from the TX buffer */
+    uartTxFill();
   }
+  ISRSTAT_END(isrStat_UART);
   return;
 }
 
@@ -199,24 +412,52 @@ uart_pcb_t *uartGetPCB()
     return &pcb;
 }
 
+/**************************************************************************/
+/*! 
+    @brief Clock change hook (see cpuSetClock).  The transmitter is
+           drained before the clock changes, since a character sent
+           across the change would be garbled, and the baud rate divisors
+           are recomputed afterwards.
+*/
+/**************************************************************************/
+static void uartClockChanged(uint32_t clock, bool changed)
+{
+  if (!changed)
+  {
+    while (!(UART_U0LSR & UART_U0LSR_TEMT));
+    return;
+  }
+
+  uartSetDivisors(clock, pcb.baudrate);
+}
+
 /**************************************************************************/
 /*! 
     @brief Initialises UART at the specified baud rate.
 
+    The integer divisor and the fractional divider are both searched
+    for the setting closest to 'baudrate' (see uartFindDivisor), and
+    the rate actually set is kept in the pcb's 'actual' field.
+
     @param[in]  baudRate
                 The baud rate to use when configuring the UART.
 */
 /**************************************************************************/
 void uartInit(uint32_t baudrate)
 {
-  uint32_t fDiv;
   uint32_t regVal;
 
+  // Send anything still queued at the old baud rate
+  if (pcb.initialised)
+  {
+    uartTxDrain();
+  }
+
   NVIC_DisableIRQ(UART_IRQn);
 
   // Clear protocol control blocks
   memset(&pcb, 0, sizeof(uart_pcb_t));
-  pcb.pending_tx_data = 0;
+  pcb.events = UART_EVENT_TXIDLE;
   uartRxBufferInit();
 
   /* Set 1.6 UART RXD */
@@ -227,8 +468,11 @@ void uartInit(uint32_t baudrate)
   IOCON_PIO1_7 &= ~IOCON_PIO1_7_FUNC_MASK;	
   IOCON_PIO1_7 |= IOCON_PIO1_7_FUNC_UART_TXD;
 
-  /* Enable UART clock */
-  SCB_SYSAHBCLKCTRL |= (SCB_SYSAHBCLKCTRL_UART);
+  /* Enable UART clock (held, since RX can arrive at any time) */
+  if (!clkgateGetUsers(clkgatePeriph_UART))
+  {
+    clkgateAcquire(clkgatePeriph_UART);
+  }
   SCB_UARTCLKDIV = SCB_UARTCLKDIV_DIV1;     /* divided by 1 */
 
   /* 8 bits, no Parity, 1 Stop bit */
@@ -237,27 +481,22 @@ void uartInit(uint32_t baudrate)
                 UART_U0LCR_Parity_Disabled |
                 UART_U0LCR_Parity_Select_OddParity |
                 UART_U0LCR_Break_Control_Disabled |
-                UART_U0LCR_Divisor_Latch_Access_Enabled);
+                UART_U0LCR_Divisor_Latch_Access_Disabled);
 
   /* Baud rate */
-  regVal = SCB_UARTCLKDIV;
-  fDiv = (((CFG_CPU_CCLK * SCB_SYSAHBCLKDIV)/regVal)/16)/baudrate;
+  uartSetDivisors(cpuGetClock(), baudrate);
 
-  UART_U0DLM = fDiv / 256;
-  UART_U0DLL = fDiv % 256;
-  
-  /* Set DLAB back to 0 */
-  UART_U0LCR = (UART_U0LCR_Word_Length_Select_8Chars |
-                UART_U0LCR_Stop_Bit_Select_1Bits |
-                UART_U0LCR_Parity_Disabled |
-                UART_U0LCR_Parity_Select_OddParity |
-                UART_U0LCR_Break_Control_Disabled |
-                UART_U0LCR_Divisor_Latch_Access_Disabled);
+  #ifdef CFG_UART_RS485
+  /* Plain UART until uartRS485Init says otherwise */
+  UART_U0RS485CTRL = 0;
+  #endif
   
-  /* Enable and reset TX and RX FIFO. */
+  /* Enable and reset TX and RX FIFO.  The RX interrupt fires once 8 */
+  /* bytes are waiting (or on a character timeout for fewer bytes).  */
   UART_U0FCR = (UART_U0FCR_FIFO_Enabled | 
                 UART_U0FCR_Rx_FIFO_Reset | 
-                UART_U0FCR_Tx_FIFO_Reset); 
+                UART_U0FCR_Tx_FIFO_Reset |
+                UART_U0FCR_Rx_Trigger_Level_Select_8Char); 
 
   /* Read to clear the line status. */
   regVal = UART_U0LSR;
@@ -273,18 +512,93 @@ void uartInit(uint32_t baudrate)
   /* Set the initialised flag in the protocol control block */
   pcb.initialised = 1;
   pcb.baudrate = baudrate;
+  cpuRegisterClockHook(uartClockChanged);
 
   /* Enable the UART Interrupt */
+  NVIC_SetPriority(UART_IRQn, CFG_IRQPRIO_UART);
   NVIC_EnableIRQ(UART_IRQn);
   UART_U0IER = UART_U0IER_RBR_Interrupt_Enabled | UART_U0IER_RLS_Interrupt_Enabled;
 
   return;
 }
 
+/**************************************************************************/
+/*! 
+    @brief Returns the baud rate that uartInit would actually set for
+           'baudrate' at the current clock (0 if it can't be reached)
+
+    @section Example
+
+    @code 
+    uint32_t actual = uartGetClosestBaudrate(921600);
+    // Error in per mille, compare against UART_BAUDERROR_MAX
+    uint32_t error = (actual > 921600 ? actual - 921600 : 921600 - actual) * 1000 / 921600;
+    @endcode
+*/
+/**************************************************************************/
+uint32_t uartGetClosestBaudrate(uint32_t baudrate)
+{
+  uint32_t dl, fdr;
+
+  return uartFindDivisor(uartGetPClk(cpuGetClock()), baudrate, &dl, &fdr);
+}
+
+/**************************************************************************/
+/*! 
+    @brief Detects the baud rate of the other side with the UART's
+           auto-baud hardware
+
+    The other side has to send 'A' or 'a' (the start bit and the first
+    data bit are timed), and the measured rate is rounded to the
+    nearest standard rate within 3% before being set through the
+    fractional divider.  Anything still in the TX buffer is sent first,
+    and the RX buffer is cleared afterwards.
+
+    @param[in]  timeoutMs
+                How long to wait for the character (0 = forever)
+
+    @return     The new baud rate, or 0 if nothing was measured, in
+                which case the previous rate is kept
+*/
+/**************************************************************************/
+uint32_t uartAutoBaud(uint32_t timeoutMs)
+{
+  uartTxDrain();
+  while (!(UART_U0LSR & UART_U0LSR_TEMT));
+
+  NVIC_DisableIRQ(UART_IRQn);
+  uartAutoBaudRate = 0;
+  eventClear(&pcb.events, UART_EVENT_AUTOBAUD);
+
+  // The fractional divider must be off while measuring
+  UART_U0FDR = 0x10;
+  UART_U0ACR = UART_U0ACR_Start | UART_U0ACR_Mode_Mode1 | UART_U0ACR_AutoRestart_NoRestart |
+               UART_U0ACR_ABEOIntClr | UART_U0ACR_ABTOIntClr;
+  UART_U0IER |= UART_U0IER_ABEOIntEn_Enabled | UART_U0IER_ABTOIntEn_Enabled;
+  NVIC_EnableIRQ(UART_IRQn);
+
+  if (!eventWait(&pcb.events, UART_EVENT_AUTOBAUD, timeoutMs))
+  {
+    // Nothing arrived, stop measuring and go back to the old rate
+    NVIC_DisableIRQ(UART_IRQn);
+    UART_U0ACR = UART_U0ACR_Stop | UART_U0ACR_ABEOIntClr | UART_U0ACR_ABTOIntClr;
+    UART_U0IER &= ~(UART_U0IER_ABEOIntEn_MASK | UART_U0IER_ABTOIntEn_MASK);
+    uartSetDivisors(cpuGetClock(), pcb.baudrate);
+    NVIC_EnableIRQ(UART_IRQn);
+    return 0;
+  }
+
+  uartRxBufferClearFIFO();
+  return uartAutoBaudRate;
+}
+
 /**************************************************************************/
 /*! 
     @brief Sends the contents of supplied text buffer over UART.
 
+    The data is copied into the TX buffer and sent by the UART interrupt,
+    so this only waits if the TX buffer is full.
+
     @param[in]  bufferPtr
                 Pointer to the text buffer
     @param[in]  bufferPtr
@@ -303,16 +617,36 @@ void uartInit(uint32_t baudrate)
 /**************************************************************************/
 void uartSend (uint8_t *bufferPtr, uint32_t length)
 {
+  uint16_t head;
+
   while (length != 0)
   {
-    /* THRE status, contain valid data */
-    while ( !(UART_U0LSR & UART_U0LSR_THRE) );
-    UART_U0THR = *bufferPtr;
+    head = pcb.txfifo.head;
+    if ((uint16_t)(head - pcb.txfifo.tail) >= CFG_UART_TXBUFSIZE)
+    {
+      /* Buffer full: feed the FIFO directly in case this is */
+      /* called with interrupts masked                       */
+      NVIC_DisableIRQ(UART_IRQn);
+      uartTxFill();
+      NVIC_EnableIRQ(UART_IRQn);
+      continue;
+    }
+
+    pcb.txfifo.buf[head & (CFG_UART_TXBUFSIZE - 1)] = *bufferPtr;
+    pcb.txfifo.head = head + 1;
 
     bufferPtr++;
     length--;
   }
 
+  /* Start sending if the FIFO is idle and let the THRE */
+  /* interrupt send the rest                            */
+  NVIC_DisableIRQ(UART_IRQn);
+  eventClear(&pcb.events, UART_EVENT_TXIDLE);
+  UART_U0IER |= UART_U0IER_THRE_Interrupt_Enabled;
+  uartTxFill();
+  NVIC_EnableIRQ(UART_IRQn);
+
   return;
 }
 
@@ -336,9 +670,7 @@ void uartSend (uint8_t *bufferPtr, uint32_t length)
 /**************************************************************************/
 void uartSendByte (uint8_t byte)
 {
-  /* THRE status, contain valid data */
-  while ( !(UART_U0LSR & UART_U0LSR_THRE) );
-  UART_U0THR = byte;
+  uartSend(&byte, 1);
 
   return;
 }
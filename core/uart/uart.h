@@ -41,29 +41,56 @@
 
 #include "projectconfig.h"
 
-// Buffer used for circular fifo
+// Buffer used for circular fifo.  The indices run freely and are masked
+// on access, so head is only written by the producer and tail only by the
+// consumer, and no counter is shared between the IRQ and the main loop.
 typedef struct _uart_buffer_t
 {
-  uint8_t ep_dir;
-  volatile uint8_t len;
-  volatile uint8_t wr_ptr;
-  volatile uint8_t rd_ptr;
+  volatile uint16_t head;
+  volatile uint16_t tail;
   uint8_t buf[CFG_UART_BUFSIZE];
 } uart_buffer_t;
 
+// TX fifo, filled by uartSend and emptied by the THRE interrupt
+typedef struct _uart_txbuffer_t
+{
+  volatile uint16_t head;
+  volatile uint16_t tail;
+  uint8_t buf[CFG_UART_TXBUFSIZE];
+} uart_txbuffer_t;
+
+// pcb events flags, set by the UART interrupt (see core/sched/event.c)
+#define UART_EVENT_TXIDLE   (1 << 0)    // Everything in the TX buffer has been sent
+#define UART_EVENT_RXDATA   (1 << 1)    // Bytes were added to the RX buffer
+#define UART_EVENT_AUTOBAUD (1 << 2)    // Auto-baud measurement finished or timed out
+#define UART_EVENT_RXFRAME  (1 << 3)    // An RS-485 frame for this node was queued
+
+// Baud rates accepted by uartInit.  The fastest rate is UART_PCLK / 16
+// (4.5M at 72MHz), and rates are only reached within UART_BAUDERROR_MAX
+// when the fractional divider can get close enough: 921600, 1M, 1.5M
+// and 2.25M baud work at 72MHz, 3M baud needs a 48MHz clock.
+#define UART_BAUDRATE_MIN   (1200)
+#define UART_BAUDRATE_MAX   (3000000)
+#define UART_BAUDERROR_MAX  (15)        // Largest acceptable error (per mille)
+
 // UART Protocol control block
 typedef struct _uart_pcb_t
 {
   BOOL initialised;
-  uint32_t baudrate;
+  uint32_t baudrate;                  // Requested (or auto-detected) baud rate
+  uint32_t actual;                    // Baud rate set by the divisors
   uint32_t status;
-  uint32_t pending_tx_data;
+  BOOL rs485;                         // Received bytes go to the RS-485 frame parser
+  volatile uint32_t events;           // UART_EVENT_...
   uart_buffer_t rxfifo;
+  uart_txbuffer_t txfifo;
 } uart_pcb_t;
 
 void UART_IRQHandler(void);
 uart_pcb_t *uartGetPCB();
 void uartInit(uint32_t Baudrate);
+uint32_t uartGetClosestBaudrate(uint32_t baudrate);
+uint32_t uartAutoBaud(uint32_t timeoutMs);
 void uartSend(uint8_t *BufferPtr, uint32_t Length);
 void uartSendByte (uint8_t byte);
 
@@ -73,6 +100,37 @@ uint8_t uartRxBufferRead();
 void uartRxBufferWrite(uint8_t data);
 void uartRxBufferClearFIFO();
 uint8_t uartRxBufferDataPending();
+uint16_t uartRxBufferCount();
 bool uartRxBufferReadArray(byte_t* rx, size_t* len);
 
+#ifdef CFG_UART_RS485
+#define UART_RS485_BROADCAST  (0xFF)  // Frames sent here are accepted by every node
+
+// RS-485 frame (see uart_rs485.c for the format on the bus)
+typedef struct _uart_rs485frame_t
+{
+  uint8_t dest;
+  uint8_t src;
+  uint8_t len;
+  uint8_t data[CFG_UART_RS485_MAXPAYLOAD];
+} uart_rs485frame_t;
+
+// RS-485 node address and statistics
+typedef struct _uart_rs485_t
+{
+  uint8_t address;
+  uint32_t rxFrames;                  // Frames queued for this node
+  uint32_t rxErrors;                  // Bad CRCs, lengths and gaps inside frames
+  uint32_t rxOverruns;                // Frames dropped because the queue was full
+  uint32_t txFrames;
+} uart_rs485_t;
+
+void uartRS485Init(uint32_t baudrate, uint8_t address);
+uart_rs485_t *uartRS485GetPCB(void);
+bool uartRS485Send(uint8_t dest, const uint8_t *data, uint8_t len);
+bool uartRS485Receive(uart_rs485frame_t *frame);
+uint8_t uartRS485FramesPending(void);
+bool uartRS485RxByte(uint8_t data);
+#endif
+
 #endif
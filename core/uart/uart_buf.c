@@ -48,6 +48,8 @@
 */
 /**************************************************************************/
 
+#include <string.h>
+
 #include "uart.h"
 
 /**************************************************************************/
@@ -58,15 +60,16 @@
 void uartRxBufferInit()
 {
   uart_pcb_t *pcb = uartGetPCB();
-  pcb->rxfifo.len = 0;
+  pcb->rxfifo.head = 0;
+  pcb->rxfifo.tail = 0;
 }
 
 /**************************************************************************/
 /*!
   Read one byte out of the RX buffer. This function will return the byte
-  located at the array index of the read pointer, and then increment the
-  read pointer index.  If the read pointer exceeds the maximum buffer
-  size, it will roll over to zero.
+  located at the read index, and then increment the read index.  Only
+  the read index is modified, so this is safe to call while the UART
+  IRQ is writing into the buffer.  Check uartRxBufferDataPending first.
 */
 /**************************************************************************/
 uint8_t uartRxBufferRead()
@@ -74,28 +77,37 @@ uint8_t uartRxBufferRead()
   uart_pcb_t *pcb = uartGetPCB();
   uint8_t data;
 
-  data = pcb->rxfifo.buf[pcb->rxfifo.rd_ptr];
-  pcb->rxfifo.rd_ptr = (pcb->rxfifo.rd_ptr + 1) % CFG_UART_BUFSIZE;
-  pcb->rxfifo.len--;
+  data = pcb->rxfifo.buf[pcb->rxfifo.tail & (CFG_UART_BUFSIZE - 1)];
+  pcb->rxfifo.tail++;
   return data;
 }
 
 /**************************************************************************/
 /*!
-  Read byte array from uart
+  Read every byte currently in the RX buffer into a byte array.  The
+  data is copied with (at most) two memcpy's, one for each contiguous
+  part of the ring.
  */
 /**************************************************************************/
 bool uartRxBufferReadArray(byte_t* rx, size_t* len)
 {
   uart_pcb_t *pcb = uartGetPCB();
-  *len = 0;
-  
-  while(pcb->rxfifo.len != 0)
+  uint16_t tail = pcb->rxfifo.tail;
+  uint16_t count = pcb->rxfifo.head - tail;
+  uint16_t offset = tail & (CFG_UART_BUFSIZE - 1);
+  uint16_t first;
+
+  // Part up to the end of the ring, then the part from the start
+  first = CFG_UART_BUFSIZE - offset;
+  if (first > count)
   {
-    (*rx) = uartRxBufferRead();
-    (*len)++;
-    rx++;
+    first = count;
   }
+  memcpy(rx, &pcb->rxfifo.buf[offset], first);
+  memcpy(rx + first, pcb->rxfifo.buf, count - first);
+
+  pcb->rxfifo.tail = tail + count;
+  *len = count;
   
   return (*len != 0);
 }
@@ -103,32 +115,34 @@ bool uartRxBufferReadArray(byte_t* rx, size_t* len)
 /**************************************************************************/
 /*!
   Write one byte into the RX buffer. This function will write one
-  byte into the array index specified by the write pointer and increment
-  the write index. If the write index exceeds the max buffer size, then it
-  will roll over to zero.
+  byte at the write index and increment the write index.  If the buffer
+  is full the byte is dropped.  This is only called by the UART IRQ.
 */
 /**************************************************************************/
 void uartRxBufferWrite(uint8_t data)
 {
   uart_pcb_t *pcb = uartGetPCB();
+  uint16_t head = pcb->rxfifo.head;
+
+  if ((uint16_t)(head - pcb->rxfifo.tail) >= CFG_UART_BUFSIZE)
+  {
+    return;
+  }
 
-  pcb->rxfifo.buf[pcb->rxfifo.wr_ptr] = data;
-  pcb->rxfifo.wr_ptr = (pcb->rxfifo.wr_ptr + 1) % CFG_UART_BUFSIZE;
-  pcb->rxfifo.len++;
+  pcb->rxfifo.buf[head & (CFG_UART_BUFSIZE - 1)] = data;
+  pcb->rxfifo.head = head + 1;
 }
 
 /**************************************************************************/
 /*!
-    Clear the fifo read and write pointers and set the length to zero.
+    Clear the fifo read and write pointers.
 */
 /**************************************************************************/
 void uartRxBufferClearFIFO()
 {
   uart_pcb_t *pcb = uartGetPCB();
 
-  pcb->rxfifo.rd_ptr = 0;
-  pcb->rxfifo.wr_ptr = 0;
-  pcb->rxfifo.len = 0;
+  pcb->rxfifo.tail = pcb->rxfifo.head;
 }
 
 /**************************************************************************/
@@ -140,10 +154,22 @@ uint8_t uartRxBufferDataPending()
 {
   uart_pcb_t *pcb = uartGetPCB();
 
-  if (pcb->rxfifo.len != 0)
+  if (pcb->rxfifo.head != pcb->rxfifo.tail)
   {
     return 1;
   }
 
   return 0;
 }
+
+/**************************************************************************/
+/*!
+    Returns the number of bytes waiting in the RX buffer.
+*/
+/**************************************************************************/
+uint16_t uartRxBufferCount()
+{
+  uart_pcb_t *pcb = uartGetPCB();
+
+  return (uint16_t)(pcb->rxfifo.head - pcb->rxfifo.tail);
+}
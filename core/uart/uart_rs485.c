@@ -0,0 +1,349 @@
+/**************************************************************************/
+/*! 
+    @file     uart_rs485.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    RS-485 multi-drop mode for the UART.  The transceiver's driver
+    enable is wired to RTS (PIO1.5), which the UART raises by itself
+    while a frame is being sent and drops CFG_UART_RS485_DEDELAY bit
+    times after the last stop bit, so no GPIO has to be timed in
+    software.
+
+    Every frame on the bus looks like this (CRC-16/CCITT over DEST
+    through the last data byte, see drivers/crypto/crc.c):
+
+      SYNC(0x7E) DEST SRC LEN DATA[LEN] CRC(high) CRC(low)
+
+    The UART interrupt parses frames as the bytes arrive.  Frames for
+    another node are skipped without being copied, checked or reported,
+    and only complete frames for this node (or UART_RS485_BROADCAST)
+    with a good CRC are queued, so the main loop is woken once per
+    frame for itself instead of once per byte on the bus.  A gap of
+    more than a couple of milliseconds inside a frame starts the hunt
+    for SYNC again.
+
+    @code
+    #include "core/uart/uart.h"
+
+    uart_rs485frame_t frame;
+
+    uartRS485Init(CFG_UART_BAUDRATE, CFG_UART_RS485_ADDRESS);
+    while (1)
+    {
+      if (uartRS485Receive(&frame) && frame.dest != UART_RS485_BROADCAST)
+      {
+        // Answer the master with the same payload
+        uartRS485Send(frame.src, frame.data, frame.len);
+      }
+    }
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include <string.h>
+
+#include "uart.h"
+#include "core/systick/systick.h"
+#include "drivers/crypto/crc.h"
+
+#ifdef CFG_UART_RS485
+
+#define UART_RS485_SYNC       (0x7E)
+#define UART_RS485_GAPTICKS   (2)     // Largest gap (in systicks) between two bytes of a frame
+
+typedef enum
+{
+  rs485State_Sync = 0,
+  rs485State_Dest,
+  rs485State_Src,
+  rs485State_Len,
+  rs485State_Data,
+  rs485State_CrcHigh,
+  rs485State_CrcLow
+} rs485State_t;
+
+static uart_rs485_t rs485;
+static uart_rs485frame_t rs485Queue[CFG_UART_RS485_RXFRAMES];
+static volatile uint8_t rs485Head;    // Written by the IRQ only
+static volatile uint8_t rs485Tail;    // Written by the main loop only
+
+// Parser state, only touched by the UART IRQ
+static rs485State_t rs485State;
+static uart_rs485frame_t *rs485Frame; // Slot being filled, NULL while skipping
+static uint8_t rs485Dest, rs485Len, rs485Count;
+static uint16_t rs485Crc;
+static uint32_t rs485LastTick;
+
+/**************************************************************************/
+/*! 
+    Returns the RS-485 statistics and node address
+*/
+/**************************************************************************/
+uart_rs485_t *uartRS485GetPCB(void)
+{
+  return &rs485;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Initialises the UART in RS-485 mode
+
+    @param[in]  baudrate
+                The bus speed (see uartInit)
+    @param[in]  address
+                This node's address (anything but UART_RS485_BROADCAST)
+*/
+/**************************************************************************/
+void uartRS485Init(uint32_t baudrate, uint8_t address)
+{
+  uart_pcb_t *pcb;
+
+  uartInit(baudrate);
+
+  NVIC_DisableIRQ(UART_IRQn);
+  memset(&rs485, 0, sizeof(uart_rs485_t));
+  rs485.address = address;
+  rs485Head = rs485Tail = 0;
+  rs485State = rs485State_Sync;
+
+  /* Set 1.5 UART RTS, driven by the UART as the transceiver's DE */
+  IOCON_PIO1_5 &= ~IOCON_PIO1_5_FUNC_MASK;
+  IOCON_PIO1_5 |= IOCON_PIO1_5_FUNC_RTS;
+
+  /* RTS goes high while sending (DE is active high on most transceivers) */
+  UART_U0RS485DLY = CFG_UART_RS485_DEDELAY;
+  UART_U0RS485CTRL = UART_U0RS485CTRL_DCTRL_Enabled |
+                     UART_U0RS485CTRL_SEL_RTS |
+                     UART_U0RS485CTRL_OINV_Inverted;
+
+  pcb = uartGetPCB();
+  pcb->rs485 = TRUE;
+  NVIC_EnableIRQ(UART_IRQn);
+}
+
+/**************************************************************************/
+/*! 
+    @brief Sends one frame to 'dest'
+
+    The whole frame goes into the TX buffer with a single uartSend so
+    the TX FIFO doesn't run dry (and drop DE) half way through it.
+
+    @return     FALSE if 'len' is larger than CFG_UART_RS485_MAXPAYLOAD
+*/
+/**************************************************************************/
+bool uartRS485Send(uint8_t dest, const uint8_t *data, uint8_t len)
+{
+  uint8_t frame[CFG_UART_RS485_MAXPAYLOAD + 6];
+  uint16_t crc;
+
+  if (len > CFG_UART_RS485_MAXPAYLOAD)
+  {
+    return FALSE;
+  }
+
+  frame[0] = UART_RS485_SYNC;
+  frame[1] = dest;
+  frame[2] = rs485.address;
+  frame[3] = len;
+  memcpy(&frame[4], data, len);
+  crc = crc16Update(CRC16_INIT, &frame[1], len + 3);
+  frame[len + 4] = crc >> 8;
+  frame[len + 5] = crc & 0xFF;
+
+  uartSend(frame, len + 6);
+  rs485.txFrames++;
+
+  return TRUE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Copies the oldest frame received for this node into 'frame'
+
+    @return     FALSE if no frame is waiting
+*/
+/**************************************************************************/
+bool uartRS485Receive(uart_rs485frame_t *frame)
+{
+  uint8_t tail = rs485Tail;
+  uart_rs485frame_t *slot;
+
+  if (tail == rs485Head)
+  {
+    return FALSE;
+  }
+
+  slot = &rs485Queue[tail & (CFG_UART_RS485_RXFRAMES - 1)];
+  frame->dest = slot->dest;
+  frame->src = slot->src;
+  frame->len = slot->len;
+  memcpy(frame->data, slot->data, slot->len);
+  rs485Tail = tail + 1;
+
+  return TRUE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Returns the number of frames waiting in the RX queue
+*/
+/**************************************************************************/
+uint8_t uartRS485FramesPending(void)
+{
+  return (uint8_t)(rs485Head - rs485Tail);
+}
+
+/**************************************************************************/
+/*! 
+    @brief Feeds one received byte to the frame parser.  This is only
+           called by the UART IRQ, and returns TRUE when a frame was
+           added to the RX queue.
+*/
+/**************************************************************************/
+bool uartRS485RxByte(uint8_t data)
+{
+  uint32_t now = systickGetTicks();
+  uint8_t head;
+
+  // A gap inside a frame means the rest of it was lost
+  if ((rs485State != rs485State_Sync) && (now - rs485LastTick > UART_RS485_GAPTICKS))
+  {
+    rs485.rxErrors++;
+    rs485State = rs485State_Sync;
+  }
+  rs485LastTick = now;
+
+  switch (rs485State)
+  {
+    case rs485State_Sync:
+      if (data == UART_RS485_SYNC)
+      {
+        rs485Crc = CRC16_INIT;
+        rs485State = rs485State_Dest;
+      }
+      return FALSE;
+
+    case rs485State_Dest:
+      rs485Dest = data;
+      rs485Frame = NULL;
+      if ((data == rs485.address) || (data == UART_RS485_BROADCAST))
+      {
+        head = rs485Head;
+        if ((uint8_t)(head - rs485Tail) < CFG_UART_RS485_RXFRAMES)
+        {
+          rs485Frame = &rs485Queue[head & (CFG_UART_RS485_RXFRAMES - 1)];
+          rs485Frame->dest = data;
+        }
+        else
+        {
+          rs485.rxOverruns++;
+        }
+      }
+      rs485State = rs485State_Src;
+      break;
+
+    case rs485State_Src:
+      if (rs485Frame)
+      {
+        rs485Frame->src = data;
+      }
+      rs485State = rs485State_Len;
+      break;
+
+    case rs485State_Len:
+      if (data > CFG_UART_RS485_MAXPAYLOAD)
+      {
+        // Too long for anyone on this bus, so it can't be a real frame
+        rs485.rxErrors++;
+        rs485State = rs485State_Sync;
+        return FALSE;
+      }
+      if (rs485Frame)
+      {
+        rs485Frame->len = data;
+      }
+      rs485Len = data;
+      rs485Count = 0;
+      rs485State = data ? rs485State_Data : rs485State_CrcHigh;
+      break;
+
+    case rs485State_Data:
+      if (rs485Frame)
+      {
+        rs485Frame->data[rs485Count] = data;
+      }
+      if (++rs485Count == rs485Len)
+      {
+        rs485State = rs485State_CrcHigh;
+      }
+      break;
+
+    case rs485State_CrcHigh:
+      if (rs485Frame)
+      {
+        // Only frames that are being kept have their CRC checked
+        if ((rs485Crc >> 8) != data)
+        {
+          rs485.rxErrors++;
+          rs485Frame = NULL;
+        }
+      }
+      rs485State = rs485State_CrcLow;
+      return FALSE;
+
+    case rs485State_CrcLow:
+      rs485State = rs485State_Sync;
+      if (!rs485Frame)
+      {
+        return FALSE;
+      }
+      if ((rs485Crc & 0xFF) != data)
+      {
+        rs485.rxErrors++;
+        return FALSE;
+      }
+      rs485Head++;
+      rs485.rxFrames++;
+      return TRUE;
+  }
+
+  if (rs485Frame)
+  {
+    rs485Crc = crc16Update(rs485Crc, &data, 1);
+  }
+
+  return FALSE;
+}
+
+#endif
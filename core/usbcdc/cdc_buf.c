@@ -69,24 +69,23 @@ cdc_buffer_t *cdcGetBuffer()
 /**************************************************************************/
 void cdcBufferInit()
 {
-  cdcfifo.len = 0;
+  cdcfifo.head = 0;
+  cdcfifo.tail = 0;
 }
 
 /**************************************************************************/
 /*!
   Read one byte out of the RX buffer. This function will return the byte
-  located at the array index of the read pointer, and then increment the
-  read pointer index.  If the read pointer exceeds the maximum buffer
-  size, it will roll over to zero.
+  located at the read index, and then increment the read index.  Check
+  cdcBufferDataPending first.
 */
 /**************************************************************************/
 uint8_t cdcBufferRead()
 {
   uint8_t data;
 
-  data = cdcfifo.buf[cdcfifo.rd_ptr];
-  cdcfifo.rd_ptr = (cdcfifo.rd_ptr + 1) % CFG_USBCDC_BUFFERSIZE;
-  cdcfifo.len--;
+  data = cdcfifo.buf[cdcfifo.tail & (CFG_USBCDC_BUFFERSIZE - 1)];
+  cdcfifo.tail++;
   return data;
 }
 
@@ -97,52 +96,44 @@ uint8_t cdcBufferRead()
 /**************************************************************************/
 uint32_t cdcBufferReadLen(uint8_t* buf, uint32_t len)
 {
-  uint32_t counter, actual;
-  counter = actual = 0;
+  uint32_t counter;
 
-  while(counter != len)
+  for (counter = 0; (counter != len) && cdcBufferDataPending(); counter++)
   {
-    // Make sure we don't exceed buffer limits
-    if (cdcfifo.len > 0)
-    {
-      buf[counter] = cdcBufferRead();
-      actual++;
-      counter++;
-    }
-    else
-    {
-      return actual;
-    }
+    buf[counter] = cdcBufferRead();
   }
 
-  return actual;
+  return counter;
 }
 
 /**************************************************************************/
 /*!
   Write one byte into the RX buffer. This function will write one
-  byte into the array index specified by the write pointer and increment
-  the write index. If the write index exceeds the max buffer size, then it
-  will roll over to zero.
+  byte at the write index and increment the write index.  The byte is
+  dropped if the buffer is full.
 */
 /**************************************************************************/
 void cdcBufferWrite(uint8_t data)
 {
-  cdcfifo.buf[cdcfifo.wr_ptr] = data;
-  cdcfifo.wr_ptr = (cdcfifo.wr_ptr + 1) % CFG_USBCDC_BUFFERSIZE;
-  cdcfifo.len++;
+  uint16_t head = cdcfifo.head;
+
+  if (cdcBufferFull())
+  {
+    return;
+  }
+
+  cdcfifo.buf[head & (CFG_USBCDC_BUFFERSIZE - 1)] = data;
+  cdcfifo.head = head + 1;
 }
 
 /**************************************************************************/
 /*!
-    Clear the fifo read and write pointers and set the length to zero.
+    Clear the fifo read and write pointers.
 */
 /**************************************************************************/
 void cdcBufferClearFIFO()
 {
-  cdcfifo.rd_ptr = 0;
-  cdcfifo.wr_ptr = 0;
-  cdcfifo.len = 0;
+  cdcfifo.tail = cdcfifo.head;
 }
 
 /**************************************************************************/
@@ -152,10 +143,62 @@ void cdcBufferClearFIFO()
 /**************************************************************************/
 uint8_t cdcBufferDataPending()
 {
-  if (cdcfifo.len != 0)
+  if (cdcfifo.head != cdcfifo.tail)
   {
     return 1;
   }
 
   return 0;
 }
+
+/**************************************************************************/
+/*!
+    Check whether the buffer is full.
+*/
+/**************************************************************************/
+uint8_t cdcBufferFull()
+{
+  return cdcBufferCount() >= CFG_USBCDC_BUFFERSIZE ? 1 : 0;
+}
+
+/**************************************************************************/
+/*!
+    Returns the number of bytes waiting in the buffer.
+*/
+/**************************************************************************/
+uint32_t cdcBufferCount()
+{
+  return (uint16_t)(cdcfifo.head - cdcfifo.tail);
+}
+
+/**************************************************************************/
+/*!
+    Returns a pointer to the oldest byte in the buffer, and the number of
+    bytes that follow it without wrapping around the end of the buffer.
+    This lets the data be sent straight from the buffer; call
+    cdcBufferDiscard once it has been used.
+*/
+/**************************************************************************/
+uint8_t * cdcBufferPeek(uint32_t *len)
+{
+  uint32_t offset = cdcfifo.tail & (CFG_USBCDC_BUFFERSIZE - 1);
+  uint32_t count = cdcBufferCount();
+
+  *len = CFG_USBCDC_BUFFERSIZE - offset;
+  if (*len > count)
+  {
+    *len = count;
+  }
+
+  return &cdcfifo.buf[offset];
+}
+
+/**************************************************************************/
+/*!
+    Removes 'len' bytes from the buffer (after cdcBufferPeek)
+*/
+/**************************************************************************/
+void cdcBufferDiscard(uint32_t len)
+{
+  cdcfifo.tail += len;
+}
@@ -9,13 +9,14 @@
 
 #include "projectconfig.h"
 
-// Buffer used for circular fifo
+// Buffer used for circular fifo.  The indices run freely and are masked
+// on access: head is only written by cdcBufferWrite (main loop) and tail
+// only by the readers (the bulk IN endpoint interrupt).
 typedef struct _cdc_buffer_t
 {
-  volatile uint8_t len;
-  volatile uint8_t wr_ptr;
-  volatile uint8_t rd_ptr;
   uint8_t buf[CFG_USBCDC_BUFFERSIZE];
+  volatile uint16_t head;
+  volatile uint16_t tail;
 } cdc_buffer_t;
 
 cdc_buffer_t * cdcGetBuffer();
@@ -25,5 +26,9 @@ uint32_t       cdcBufferReadLen(uint8_t* buf, uint32_t len);
 void           cdcBufferWrite(uint8_t data);
 void           cdcBufferClearFIFO();
 uint8_t        cdcBufferDataPending();
+uint8_t        cdcBufferFull();
+uint32_t       cdcBufferCount();
+uint8_t *      cdcBufferPeek(uint32_t *len);
+void           cdcBufferDiscard(uint32_t len);
 
 #endif
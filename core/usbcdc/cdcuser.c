@@ -25,22 +25,25 @@
 #include "cdc.h"
 #include "cdcuser.h"
 #include "cdc_buf.h"
+#include "core/systick/systick.h"
+#include "core/sched/event.h"
 
-// unsigned char BulkBufIn  [64];            // Buffer to store USB IN  packet
+unsigned char BulkBufIn  [CDC_DATA_PACKETSIZE];  // Buffer to store USB IN  packet
 unsigned char BulkBufOut [64];            // Buffer to store USB OUT packet
 unsigned char NotificationBuf [10];
 
 CDC_LINE_CODING CDC_LineCoding  = {CFG_USBCDC_BAUDRATE, 0, 0, 8};
 unsigned short  CDC_SerialState = 0x0000;
-unsigned short  CDC_DepInEmpty  = 1;                   // Data IN EP is empty
+volatile unsigned short CDC_DepInEmpty = 1;           // Data IN EP is empty
+static unsigned char CDC_LastInFull = 0;               // Last IN packet was 64 bytes
 
 /*----------------------------------------------------------------------------
   We need a buffer for incoming data on USB port because USB receives
   much faster than  UART transmits
  *---------------------------------------------------------------------------*/
 /* Buffer masks */
-#define CDC_BUF_SIZE               (64)   // Output buffer in bytes (power 2)
-                                                       // large enough for file transfer
+#define CDC_BUF_SIZE               (128)  // Output buffer in bytes (power 2)
+                                                       // room for 2 USB packets
 #define CDC_BUF_MASK               (CDC_BUF_SIZE-1ul)
 
 /* Buffer read / write macros */
@@ -48,8 +51,8 @@ unsigned short  CDC_DepInEmpty  = 1;                   // Data IN EP is empty
 #define CDC_BUF_WR(cdcBuf, dataIn) (cdcBuf.data[CDC_BUF_MASK & cdcBuf.wrIdx++] = (dataIn))
 #define CDC_BUF_RD(cdcBuf)         (cdcBuf.data[CDC_BUF_MASK & cdcBuf.rdIdx++])   
 #define CDC_BUF_EMPTY(cdcBuf)      (cdcBuf.rdIdx == cdcBuf.wrIdx)
-#define CDC_BUF_FULL(cdcBuf)       (cdcBuf.rdIdx == cdcBuf.wrIdx+1)
-#define CDC_BUF_COUNT(cdcBuf)      (CDC_BUF_MASK & (cdcBuf.wrIdx - cdcBuf.rdIdx))
+#define CDC_BUF_COUNT(cdcBuf)      (cdcBuf.wrIdx - cdcBuf.rdIdx)
+#define CDC_BUF_FREE(cdcBuf)       (CDC_BUF_SIZE - CDC_BUF_COUNT(cdcBuf))
 
 
 // CDC output buffer
@@ -62,6 +65,12 @@ typedef struct __CDC_BUF_T
 
 CDC_BUF_T  CDC_OutBuf;                                 // buffer for all CDC Out data
 
+// Set when an OUT packet was left in the endpoint because CDC_OutBuf
+// was too full.  The endpoint NAKs the host until it is read.
+static volatile unsigned char CDC_OutPending = 0;
+
+static void CDC_ReadOutPacket (void);
+
 /*----------------------------------------------------------------------------
   read data from CDC_OutBuf
  *---------------------------------------------------------------------------*/
@@ -69,17 +78,29 @@ int CDC_RdOutBuf (char *buffer, const int *length)
 {
   int bytesToRead, bytesRead;
   
-  /* Read *length bytes, block if *bytes are not avaialable	*/
-  bytesToRead = *length;
+  /* Read up to *length bytes (only as many as are available) */
+  bytesToRead = CDC_BUF_COUNT(CDC_OutBuf);
   bytesToRead = (bytesToRead < (*length)) ? bytesToRead : (*length);
   bytesRead = bytesToRead;
 
-
-  // ... add code to check for underrun
-
   while (bytesToRead--) {
     *buffer++ = CDC_BUF_RD(CDC_OutBuf);
   }
+
+  // Pick up any packets held back in the endpoint now there is room
+  if (CDC_OutPending) {
+    NVIC_DisableIRQ(USB_IRQn);
+    while (CDC_OutPending && (CDC_BUF_FREE(CDC_OutBuf) >= CDC_DATA_PACKETSIZE)) {
+      if (USB_EPFull(CDC_DEP_OUT)) {
+        CDC_ReadOutPacket();
+      }
+      else {
+        CDC_OutPending = 0;
+      }
+    }
+    NVIC_EnableIRQ(USB_IRQn);
+  }
+
   return (bytesRead);  
 }
 
@@ -90,13 +111,10 @@ int CDC_WrOutBuf (const char *buffer, int *length)
 {
   int bytesToWrite, bytesWritten;
 
-  // Write *length bytes
+  // Write *length bytes (the caller checks that there is room)
   bytesToWrite = *length;
   bytesWritten = bytesToWrite;
 
-
-  // ... add code to check for overwrite
-
   while (bytesToWrite) {
       CDC_BUF_WR(CDC_OutBuf, *buffer++);           // Copy Data to buffer  
       bytesToWrite--;
@@ -105,6 +123,35 @@ int CDC_WrOutBuf (const char *buffer, int *length)
   return (bytesWritten); 
 }
 
+/*----------------------------------------------------------------------------
+  write data to the CDC IN buffer (device to host) and start sending it.
+  If the buffer is full this waits for the bulk IN endpoint to make room,
+  and gives up (dropping the remaining bytes) if the host stops reading.
+ *---------------------------------------------------------------------------*/
+int CDC_WrInBuf (const char *buffer, int length) 
+{
+  int bytesWritten = 0;
+  uint32_t start;
+
+  while (bytesWritten < length) {
+    if (cdcBufferFull()) {
+      CDC_BulkInStart();
+      start = systickGetTicks();
+      while (cdcBufferFull() && USB_Configuration &&
+             (systickGetTicks() - start < CDC_IN_TIMEOUT));
+      if (cdcBufferFull()) {
+        break;
+      }
+    }
+    cdcBufferWrite(*buffer++);
+    bytesWritten++;
+  }
+
+  CDC_BulkInStart();
+
+  return (bytesWritten);
+}
+
 /*----------------------------------------------------------------------------
   check if character(s) are available at CDC_OutBuf
  *---------------------------------------------------------------------------*/
@@ -126,14 +173,16 @@ int CDC_OutBufAvailChar (int *availChar)
 void CDC_Init (void) 
 {
   CDC_DepInEmpty  = 1;
+  CDC_LastInFull  = 0;
   CDC_SerialState = CDC_GetSerialState();
 
   CDC_BUF_RESET(CDC_OutBuf);
+  CDC_OutPending = 0;
 
   // Initialise the CDC buffer.   This is required to buffer outgoing
-  // data (MCU to PC) since data can only be sent 64 bytes per frame
-  // with at least 1ms between frames.  To see how the buffer is used,
-  // see 'puts' in systeminit.c
+  // data (MCU to PC), which is sent by the bulk IN endpoint interrupt
+  // in 64 byte packets.  To see how the buffer is used, see 'puts' in
+  // sysinit.c
   cdcBufferInit();
 }
 
@@ -277,44 +326,102 @@ uint32_t CDC_SendBreak (unsigned short wDurationOfBreak) {
  *---------------------------------------------------------------------------*/
 void CDC_BulkIn(void) 
 {
-//  int numBytesRead, numBytesAvail;
-//
-//  // ToDo: Modify BulkIn to send incoming data to USB
-//        
-//  ser_AvailChar (&numBytesAvail);
-//
-//  // ... add code to check for overwrite
-//
-//  numBytesRead = ser_Read ((char *)&BulkBufIn[0], &numBytesAvail);
-//
-//  // send over USB
-//  if (numBytesRead > 0) {
-//	USB_WriteEP (CDC_DEP_IN, &BulkBufIn[0], numBytesRead);
-//  }
-//  else {
-//    CDC_DepInEmpty = 1;
-//  }
-//
-//
+  uint32_t contiguous, count;
+  uint8_t *data;
+
+  // The bulk endpoint is double buffered, so queue a second packet
+  // while the first one goes out
+  do {
+    count = cdcBufferCount();
+    if (count == 0) {
+      if (CDC_LastInFull) {
+        // End the transfer with a short (zero length) packet
+        CDC_LastInFull = 0;
+        USB_WriteEP (CDC_DEP_IN, BulkBufIn, 0);
+      }
+      else {
+        CDC_DepInEmpty = 1;
+      }
+      return;
+    }
+
+    if (count > CDC_DATA_PACKETSIZE) {
+      count = CDC_DATA_PACKETSIZE;
+    }
+
+    // Send straight out of the buffer when the packet doesn't wrap,
+    // otherwise gather it in BulkBufIn first
+    data = cdcBufferPeek(&contiguous);
+    if (contiguous < count) {
+      data = BulkBufIn;
+      cdcBufferReadLen(BulkBufIn, count);
+      USB_WriteEP (CDC_DEP_IN, data, count);
+    }
+    else {
+      USB_WriteEP (CDC_DEP_IN, data, count);
+      cdcBufferDiscard(count);
+    }
+
+    CDC_LastInFull = (count == CDC_DATA_PACKETSIZE);
+  } while (!USB_EPFull(CDC_DEP_IN));
 } 
 
 
+/*----------------------------------------------------------------------------
+  Start the bulk IN pipeline if it is idle.  Once started, each IN
+  endpoint interrupt (CDC_BulkIn) sends the next packet straight away,
+  until the buffer is empty.
+ *---------------------------------------------------------------------------*/
+void CDC_BulkInStart(void) 
+{
+  NVIC_DisableIRQ(USB_IRQn);
+  if (CDC_DepInEmpty && USB_Configuration && cdcBufferDataPending()) {
+    CDC_DepInEmpty = 0;
+    CDC_BulkIn();
+  }
+  NVIC_EnableIRQ(USB_IRQn);
+}
+
+
 /*----------------------------------------------------------------------------
   CDC_BulkOut call on DataOut Request
   Parameters:   none
   Return Value: none
  *---------------------------------------------------------------------------*/
 void CDC_BulkOut(void) 
+{
+  // The packet may already have been read by CDC_RdOutBuf
+  if (!USB_EPFull(CDC_DEP_OUT)) {
+    return;
+  }
+
+  // Empty both buffers of the double buffered endpoint if there is
+  // room.  If there's no room for a full packet, leave it in the
+  // endpoint.  The host is NAKed until CDC_RdOutBuf makes room and
+  // reads it.
+  do {
+    if (CDC_BUF_FREE(CDC_OutBuf) < CDC_DATA_PACKETSIZE) {
+      CDC_OutPending = 1;
+      return;
+    }
+    CDC_ReadOutPacket();
+  } while (USB_EPFull(CDC_DEP_OUT));
+}
+
+
+/*----------------------------------------------------------------------------
+  Read one OUT packet from the endpoint into CDC_OutBuf
+ *---------------------------------------------------------------------------*/
+static void CDC_ReadOutPacket (void) 
 {
   int numBytesRead;
 
   // get data from USB into intermediate buffer
   numBytesRead = USB_ReadEP(CDC_DEP_OUT, &BulkBufOut[0]);
 
-  // ... add code to check for overwrite
-
   // store data in a buffer to transmit it over serial interface
   CDC_WrOutBuf ((char *)&BulkBufOut[0], &numBytesRead);
+  eventSignal(EVENT_SOURCE_CDCOUT);
 }
 
 
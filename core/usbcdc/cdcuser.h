@@ -23,12 +23,19 @@
 extern int CDC_RdOutBuf        (char *buffer, const int *length);
 extern int CDC_WrOutBuf        (const char *buffer, int *length);
 extern int CDC_OutBufAvailChar (int *availChar);
+extern int CDC_WrInBuf         (const char *buffer, int length);
+
+/* Max time (in systick ticks) to wait for room in the IN buffer */
+#define CDC_IN_TIMEOUT   10
 
 
 /* CDC Data In/Out Endpoint Address */
 #define CDC_DEP_IN       0x83
 #define CDC_DEP_OUT      0x03
 
+/* CDC Data Endpoint max packet size (see usbdesc.c) */
+#define CDC_DATA_PACKETSIZE  64
+
 /* CDC Communication In Endpoint Address */
 #define CDC_CEP_IN       0x81
 
@@ -46,6 +53,7 @@ extern uint32_t CDC_SendBreak                (unsigned short wDurationOfBreak);
 /* CDC Bulk Callback Functions */
 extern void CDC_BulkIn                   (void);
 extern void CDC_BulkOut                  (void);
+extern void CDC_BulkInStart              (void);
 
 /* CDC Notification Callback Function */
 extern void CDC_NotificationIn           (void);
@@ -57,7 +65,7 @@ extern void CDC_Init (void);
 extern unsigned short CDC_GetSerialState (void);
 
 /* flow control */
-extern unsigned short CDC_DepInEmpty;         // DataEndPoint IN empty
+extern volatile unsigned short CDC_DepInEmpty;  // DataEndPoint IN empty
 
 #endif  /* __CDCUSER_H__ */
 
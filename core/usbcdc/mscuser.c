@@ -0,0 +1,785 @@
+/**************************************************************************/
+/*! 
+    @file     mscuser.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    USB Mass Storage (bulk-only transport, SCSI transparent command set)
+    for the SD card, added to the USB CDC configuration when
+    CFG_USBCDC_MSC is defined.  The bulk endpoint pair is logical
+    endpoint 2, so this can't be used with CFG_USBCDC_VENDORBULK.
+
+    The endpoint interrupt only schedules the work: MSC_Poll runs the
+    transport from a scheduler task (or from the main loop when
+    CFG_SCHEDULER isn't defined), since an SD card access can take
+    several milliseconds.
+
+    READ(10) is one multi-block read (disk_readstream_start) that is
+    pipelined with the IN endpoint: as soon as a packet has been handed
+    to the USB block the next 64 bytes are pulled off the card, so the
+    SD transfer of one packet overlaps the bus transfer of the previous
+    one instead of stalling the endpoint for a whole sector.  WRITE(10)
+    commands are sent to the card as a single multi-block write with
+    disk_stream_start.
+
+    The host owns the file system while it has the drive mounted, so
+    FatFs must not be used on the card at the same time (both sides
+    cache FAT and directory sectors).
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "mscuser.h"
+
+#ifdef CFG_USBCDC_MSC
+
+#include "usb.h"
+#include "usbhw.h"
+#include "usbcore.h"
+#include "msc.h"
+#include "drivers/fatfs/diskio.h"
+#include "drivers/fatfs/ffsync.h"
+
+#ifdef CFG_SCHEDULER
+  #include "core/sched/sched.h"
+#endif
+
+// Halt masks as used by usbcore.c for the bulk endpoints
+#define MSC_HALT_IN   ((1 << 16) << (MSC_EP_IN & 0x0F))
+#define MSC_HALT_OUT  (1 << MSC_EP_OUT)
+
+MSC_CBW CBW;
+MSC_CSW CSW;                          // usbcore.c resends it when Bulk-IN is unstalled
+
+static uint32_t _mscPacket[MSC_MAX_PACKET / 4];   // CBW (USB_ReadEP writes whole words)
+static uint32_t _mscBlock[MSC_BLOCK_SIZE / 4];    // Sector data or a command response
+static volatile uint8_t _mscStage = MSC_BS_CBW;
+static uint32_t _mscLength;           // Bytes left in the data phase
+static uint32_t _mscOffset;           // Position in _mscBlock
+static uint32_t _mscSector;           // Next sector to read or write
+static uint32_t _mscBlocks;           // Card size in sectors
+static bool _mscDisk;                 // Data phase is READ(10)/WRITE(10)
+static bool _mscDiskError;
+static bool _mscStreamOpen;           // disk_stream_start succeeded
+static bool _mscReadOpen;             // disk_readstream_start succeeded
+static bool _mscPending;              // _mscBlock holds the next READ(10) packet
+static uint8_t _mscSenseKey;
+static uint8_t _mscSenseASC;
+
+#ifdef CFG_SCHEDULER
+static schedTask_t _mscTask;
+static bool _mscTaskReady = false;
+
+static void MSC_Task (schedTask_t *task)
+{
+  MSC_Poll();
+}
+#endif
+
+/**************************************************************************/
+/*! 
+    @brief  Keeps the USB interrupt from using the command engine while
+            the transport touches the bulk endpoints
+*/
+/**************************************************************************/
+static inline void MSC_Lock (void)
+{
+  NVIC_DisableIRQ(USB_IRQn);
+}
+
+static inline void MSC_Unlock (void)
+{
+  NVIC_EnableIRQ(USB_IRQn);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Stalls a bulk endpoint so that the host notices the end of a
+            short or failed data phase
+*/
+/**************************************************************************/
+static void MSC_Stall (uint32_t EPNum)
+{
+  MSC_Lock();
+  USB_SetStallEP(EPNum);
+  USB_EndPointHalt |= (EPNum & 0x80) ? MSC_HALT_IN : MSC_HALT_OUT;
+  MSC_Unlock();
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Fills in the CSW.  It is sent from MSC_Poll, or by usbcore.c
+            once the host clears a Bulk-IN stall.
+*/
+/**************************************************************************/
+static void MSC_SetCSW (uint8_t status)
+{
+  CSW.dSignature = MSC_CSW_Signature;
+  CSW.bStatus = status;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Records the sense data for REQUEST SENSE
+*/
+/**************************************************************************/
+static void MSC_Sense (uint8_t key, uint8_t asc)
+{
+  _mscSenseKey = key;
+  _mscSenseASC = asc;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Ends a command with a failed (or phase error) status.  Any
+            data phase the host asked for is cut short with a stall.
+*/
+/**************************************************************************/
+static void MSC_Fail (uint8_t status)
+{
+  MSC_SetCSW(status);
+  if (CBW.dDataLength == 0)
+  {
+    _mscStage = MSC_BS_CSW;
+  }
+  else if (CBW.bmFlags & 0x80)
+  {
+    MSC_Stall(MSC_EP_IN);
+    _mscStage = MSC_BS_CBW;
+  }
+  else
+  {
+    MSC_Stall(MSC_EP_OUT);
+    _mscStage = MSC_BS_CSW;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Ends a command without a data phase
+*/
+/**************************************************************************/
+static void MSC_Pass (void)
+{
+  if (CBW.dDataLength != 0)
+  {
+    // The host expects data that isn't there
+    MSC_Fail(CSW_PHASE_ERROR);
+    return;
+  }
+  MSC_SetCSW(CSW_CMD_PASSED);
+  _mscStage = MSC_BS_CSW;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Starts sending a response of 'length' bytes from _mscBlock
+*/
+/**************************************************************************/
+static void MSC_DataIn (uint32_t length)
+{
+  if (!(CBW.bmFlags & 0x80))
+  {
+    MSC_Fail(CSW_PHASE_ERROR);
+    return;
+  }
+  _mscDisk = false;
+  _mscOffset = 0;
+  _mscLength = (length < CBW.dDataLength) ? length : CBW.dDataLength;
+  _mscStage = MSC_BS_DATA_IN;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Brings the card up if needed, and returns false (with the
+            sense data set) if there is no usable card
+*/
+/**************************************************************************/
+static bool MSC_MediaReady (void)
+{
+  DSTATUS stat = disk_status(0);
+
+  if ((stat & STA_NOINIT) && !(stat & STA_NODISK))
+  {
+    stat = disk_initialize(0);
+  }
+  if (stat & (STA_NOINIT | STA_NODISK))
+  {
+    MSC_Sense(SCSI_SENSE_NOT_READY, SCSI_ASC_MEDIUM_NOT_PRESENT);
+    return false;
+  }
+  if (disk_ioctl(0, GET_SECTOR_COUNT, &_mscBlocks) != RES_OK)
+  {
+    _mscBlocks = 0;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Checks the LBA and block count of a READ(10)/WRITE(10) and
+            starts its data phase
+*/
+/**************************************************************************/
+static bool MSC_RWSetup (uint32_t *count)
+{
+  uint8_t *cb = CBW.CB;
+  uint32_t length;
+
+  _mscSector = ((uint32_t)cb[2] << 24) | ((uint32_t)cb[3] << 16) | (cb[4] << 8) | cb[5];
+  *count = (cb[7] << 8) | cb[8];
+
+  if (!MSC_MediaReady())
+  {
+    MSC_Fail(CSW_CMD_FAILED);
+    return false;
+  }
+  if ((_mscSector >= _mscBlocks) || (*count > _mscBlocks - _mscSector))
+  {
+    MSC_Sense(SCSI_SENSE_ILLEGAL_REQUEST, SCSI_ASC_LBA_OUT_OF_RANGE);
+    MSC_Fail(CSW_CMD_FAILED);
+    return false;
+  }
+  if (*count == 0)
+  {
+    MSC_Pass();
+    return false;
+  }
+
+  length = *count * MSC_BLOCK_SIZE;
+  _mscLength = (length < CBW.dDataLength) ? length : CBW.dDataLength;
+  _mscDisk = true;
+  _mscDiskError = false;
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Decodes a new CBW and starts the command
+*/
+/**************************************************************************/
+static void MSC_GetCBW (void)
+{
+  uint8_t *r = (uint8_t *)_mscBlock;
+  uint32_t n, count;
+
+  MSC_Lock();
+  n = USB_ReadEP(MSC_EP_OUT, (uint8_t *)_mscPacket);
+  MSC_Unlock();
+  memcpy(&CBW, _mscPacket, sizeof(CBW));
+
+  if ((n != sizeof(MSC_CBW)) || (CBW.dSignature != MSC_CBW_Signature))
+  {
+    // Invalid CBW, both pipes stay stalled until a reset recovery
+    MSC_Stall(MSC_EP_IN);
+    MSC_Stall(MSC_EP_OUT);
+    USB_EndPointStall |= MSC_HALT_IN | MSC_HALT_OUT;
+    _mscStage = MSC_BS_ERROR;
+    return;
+  }
+
+  CSW.dTag = CBW.dTag;
+  CSW.dDataResidue = CBW.dDataLength;
+
+  if ((CBW.bLUN != 0) || (CBW.bCBLength < 1) || (CBW.bCBLength > 16))
+  {
+    MSC_Sense(SCSI_SENSE_ILLEGAL_REQUEST, SCSI_ASC_INVALID_FIELD_IN_CDB);
+    MSC_Fail(CSW_CMD_FAILED);
+    return;
+  }
+
+  switch (CBW.CB[0])
+  {
+    case SCSI_TEST_UNIT_READY:
+      if (MSC_MediaReady())
+      {
+        MSC_Pass();
+      }
+      else
+      {
+        MSC_Fail(CSW_CMD_FAILED);
+      }
+      break;
+
+    case SCSI_REQUEST_SENSE:
+      memset(r, 0, 18);
+      r[0] = 0x70;                        // Current errors
+      r[2] = _mscSenseKey;
+      r[7] = 10;                          // Additional length
+      r[12] = _mscSenseASC;
+      MSC_Sense(SCSI_SENSE_NONE, SCSI_ASC_NONE);
+      MSC_DataIn(18);
+      break;
+
+    case SCSI_INQUIRY:
+      memset(r, 0, 36);
+      r[1] = 0x80;                        // Removable medium
+      r[2] = 0x02;                        // SCSI-2
+      r[3] = 0x02;                        // Response data format
+      r[4] = 36 - 5;                      // Additional length
+      memcpy(&r[8],  "microBld", 8);      // Vendor
+      memcpy(&r[16], "LPC1343 SD Card ", 16);
+      memcpy(&r[32], "1.0 ", 4);
+      MSC_DataIn(36);
+      break;
+
+    case SCSI_MODE_SENSE6:
+      memset(r, 0, 4);
+      r[0] = 3;                           // Mode data length
+      r[2] = (disk_status(0) & STA_PROTECT) ? 0x80 : 0x00;
+      MSC_DataIn(4);
+      break;
+
+    case SCSI_MODE_SENSE10:
+      memset(r, 0, 8);
+      r[1] = 6;                           // Mode data length
+      r[3] = (disk_status(0) & STA_PROTECT) ? 0x80 : 0x00;
+      MSC_DataIn(8);
+      break;
+
+    case SCSI_READ_FORMAT_CAPACITIES:
+      if (!MSC_MediaReady())
+      {
+        MSC_Fail(CSW_CMD_FAILED);
+        break;
+      }
+      memset(r, 0, 12);
+      r[3] = 8;                           // Capacity list length
+      r[4] = _mscBlocks >> 24;
+      r[5] = _mscBlocks >> 16;
+      r[6] = _mscBlocks >> 8;
+      r[7] = _mscBlocks;
+      r[8] = 0x02;                        // Formatted media
+      r[10] = MSC_BLOCK_SIZE >> 8;
+      MSC_DataIn(12);
+      break;
+
+    case SCSI_READ_CAPACITY:
+      if (!MSC_MediaReady() || (_mscBlocks == 0))
+      {
+        MSC_Fail(CSW_CMD_FAILED);
+        break;
+      }
+      n = _mscBlocks - 1;                 // Last LBA
+      r[0] = n >> 24;
+      r[1] = n >> 16;
+      r[2] = n >> 8;
+      r[3] = n;
+      r[4] = 0;
+      r[5] = 0;
+      r[6] = MSC_BLOCK_SIZE >> 8;
+      r[7] = MSC_BLOCK_SIZE & 0xFF;
+      MSC_DataIn(8);
+      break;
+
+    case SCSI_READ10:
+      if (!(CBW.bmFlags & 0x80))
+      {
+        MSC_Fail(CSW_PHASE_ERROR);
+        break;
+      }
+      if (MSC_RWSetup(&count))
+      {
+        // One multi-block read for the whole command, drained a
+        // packet at a time by MSC_DataInPacket
+        _mscReadOpen = (disk_readstream_start(0, _mscSector) == RES_OK);
+        _mscPending = false;
+        _mscStage = MSC_BS_DATA_IN;
+      }
+      break;
+
+    case SCSI_WRITE10:
+      if ((CBW.bmFlags & 0x80) || (CBW.dDataLength == 0))
+      {
+        MSC_Fail(CSW_PHASE_ERROR);
+        break;
+      }
+      if (disk_status(0) & STA_PROTECT)
+      {
+        MSC_Sense(SCSI_SENSE_DATA_PROTECT, SCSI_ASC_WRITE_PROTECTED);
+        MSC_Fail(CSW_CMD_FAILED);
+        break;
+      }
+      if (MSC_RWSetup(&count))
+      {
+        // One multi-block write for the whole command
+        if (disk_stream_start(0, _mscSector, count) == RES_OK)
+        {
+          _mscStreamOpen = true;
+          // Whatever FatFs knew about the card is out of date now
+          ffSyncInvalidate();
+        }
+        else
+        {
+          MSC_Sense(SCSI_SENSE_MEDIUM_ERROR, SCSI_ASC_WRITE_FAULT);
+          _mscDiskError = true;
+        }
+        _mscOffset = 0;
+        _mscStage = MSC_BS_DATA_OUT;
+      }
+      break;
+
+    case SCSI_SYNC_CACHE10:
+      disk_ioctl(0, CTRL_SYNC, NULL);
+      MSC_Pass();
+      break;
+
+    case SCSI_START_STOP_UNIT:
+      // Eject: write back anything still cached
+      disk_ioctl(0, CTRL_SYNC, NULL);
+      MSC_Pass();
+      break;
+
+    case SCSI_MEDIA_REMOVAL:
+    case SCSI_VERIFY10:
+      MSC_Pass();
+      break;
+
+    default:
+      MSC_Sense(SCSI_SENSE_ILLEGAL_REQUEST, SCSI_ASC_INVALID_COMMAND);
+      MSC_Fail(CSW_CMD_FAILED);
+      break;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Pulls the next packet of a READ(10) off the card and into
+            _mscBlock.  Returns false if the read stream has failed.
+*/
+/**************************************************************************/
+static bool MSC_ReadNext (void)
+{
+  if (!_mscReadOpen)
+  {
+    return false;
+  }
+  if (disk_readstream_read(0, (BYTE *)_mscBlock, MSC_MAX_PACKET) != RES_OK)
+  {
+    // The driver has closed the stream
+    _mscReadOpen = false;
+    return false;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Sends the next packet of the data-in phase.  Returns false
+            if the IN endpoint is still busy.
+*/
+/**************************************************************************/
+static bool MSC_DataInPacket (void)
+{
+  uint32_t n;
+  bool full;
+
+  MSC_Lock();
+  full = USB_EPFull(MSC_EP_IN);
+  MSC_Unlock();
+  if (full)
+  {
+    return false;
+  }
+
+  if (_mscLength == 0)
+  {
+    if (CSW.dDataResidue)
+    {
+      // Less data than the host asked for
+      MSC_SetCSW(CSW_CMD_PASSED);
+      MSC_Stall(MSC_EP_IN);
+      _mscStage = MSC_BS_CBW;
+    }
+    else
+    {
+      MSC_SetCSW(CSW_CMD_PASSED);
+      _mscStage = MSC_BS_CSW;
+    }
+    return true;
+  }
+
+  if (_mscDisk)
+  {
+    if (!_mscPending && !MSC_ReadNext())
+    {
+      MSC_Sense(SCSI_SENSE_MEDIUM_ERROR, SCSI_ASC_UNRECOVERED_READ);
+      MSC_SetCSW(CSW_CMD_FAILED);
+      MSC_Stall(MSC_EP_IN);
+      _mscStage = MSC_BS_CBW;
+      return true;
+    }
+    _mscOffset = 0;
+  }
+
+  n = (_mscLength < MSC_MAX_PACKET) ? _mscLength : MSC_MAX_PACKET;
+  MSC_Lock();
+  USB_WriteEP(MSC_EP_IN, (uint8_t *)_mscBlock + _mscOffset, n);
+  MSC_Unlock();
+  _mscOffset += n;
+  _mscLength -= n;
+  CSW.dDataResidue -= n;
+
+  if (_mscDisk)
+  {
+    // The packet is in the endpoint buffer now, so fetch the next one
+    // while it goes out.  A failure is reported on the next call.
+    _mscPending = false;
+    if (_mscLength)
+    {
+      _mscPending = MSC_ReadNext();
+    }
+    else if (_mscReadOpen)
+    {
+      _mscReadOpen = false;
+      disk_readstream_stop(0);
+    }
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Collects the next packet of a WRITE(10) and passes each
+            complete sector on to the card.  Returns false if there is
+            no packet waiting.
+*/
+/**************************************************************************/
+static bool MSC_DataOutPacket (void)
+{
+  uint32_t n = 0;
+  bool full;
+
+  if (_mscLength == 0)
+  {
+    if (_mscStreamOpen)
+    {
+      _mscStreamOpen = false;
+      if (disk_stream_stop(0) != RES_OK)
+      {
+        MSC_Sense(SCSI_SENSE_MEDIUM_ERROR, SCSI_ASC_WRITE_FAULT);
+        _mscDiskError = true;
+      }
+    }
+    if (CSW.dDataResidue)
+    {
+      // The host has more data than the command covers
+      MSC_Stall(MSC_EP_OUT);
+    }
+    MSC_SetCSW(_mscDiskError ? CSW_CMD_FAILED : CSW_CMD_PASSED);
+    _mscStage = MSC_BS_CSW;
+    return true;
+  }
+
+  MSC_Lock();
+  full = USB_EPFull(MSC_EP_OUT);
+  if (full)
+  {
+    n = USB_ReadEP(MSC_EP_OUT, (uint8_t *)_mscBlock + _mscOffset);
+  }
+  MSC_Unlock();
+  if (!full)
+  {
+    return false;
+  }
+
+  if (n > _mscLength)
+  {
+    n = _mscLength;
+  }
+  _mscOffset += n;
+  _mscLength -= n;
+  CSW.dDataResidue -= n;
+
+  if (_mscOffset == MSC_BLOCK_SIZE)
+  {
+    if (_mscStreamOpen && (disk_stream_write(0, (const BYTE *)_mscBlock) != RES_OK))
+    {
+      // The stream has been closed, swallow the rest of the data
+      MSC_Sense(SCSI_SENSE_MEDIUM_ERROR, SCSI_ASC_WRITE_FAULT);
+      _mscStreamOpen = false;
+      _mscDiskError = true;
+    }
+    _mscOffset = 0;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Runs the bulk-only transport until it has to wait for the
+            host.  Called from a scheduler task posted by the endpoint
+            interrupt, or from the main loop without CFG_SCHEDULER.
+*/
+/**************************************************************************/
+void MSC_Poll (void)
+{
+  bool progress;
+  bool full;
+
+  if (!USB_Configuration)
+  {
+    return;
+  }
+
+  // A reset during READ(10)/WRITE(10) leaves the card in the
+  // multi-block transfer
+  if (_mscStreamOpen && (_mscStage != MSC_BS_DATA_OUT))
+  {
+    _mscStreamOpen = false;
+    disk_stream_stop(0);
+  }
+  if (_mscReadOpen && (_mscStage != MSC_BS_DATA_IN))
+  {
+    _mscReadOpen = false;
+    disk_readstream_stop(0);
+  }
+
+  do
+  {
+    progress = false;
+    switch (_mscStage)
+    {
+      case MSC_BS_CBW:
+        MSC_Lock();
+        full = USB_EPFull(MSC_EP_OUT);
+        MSC_Unlock();
+        if (full)
+        {
+          MSC_GetCBW();
+          progress = true;
+        }
+        break;
+      case MSC_BS_DATA_IN:
+        progress = MSC_DataInPacket();
+        break;
+      case MSC_BS_DATA_OUT:
+        progress = MSC_DataOutPacket();
+        break;
+      case MSC_BS_CSW:
+        MSC_Lock();
+        if (!USB_EPFull(MSC_EP_IN))
+        {
+          USB_WriteEP(MSC_EP_IN, (uint8_t *)&CSW, sizeof(CSW));
+          _mscStage = MSC_BS_CBW;
+          progress = true;
+        }
+        MSC_Unlock();
+        break;
+      default:
+        // Stalled until MSC_Reset
+        break;
+    }
+  } while (progress);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Schedules MSC_Poll (called from the USB interrupt)
+*/
+/**************************************************************************/
+static void MSC_Schedule (void)
+{
+  #ifdef CFG_SCHEDULER
+    if (_mscTaskReady)
+    {
+      schedPost(&_mscTask);
+    }
+  #endif
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Bulk-only mass storage reset (class request)
+*/
+/**************************************************************************/
+uint32_t MSC_Reset (void)
+{
+  // An open write stream is closed by MSC_Poll (not from the interrupt)
+  USB_EndPointStall &= ~(MSC_HALT_IN | MSC_HALT_OUT);
+  CSW.dSignature = 0;                     // Nothing to resend after the reset
+  _mscStage = MSC_BS_CBW;
+  return (TRUE);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Get Max LUN (class request), only LUN 0 is supported
+*/
+/**************************************************************************/
+uint32_t MSC_GetMaxLUN (void)
+{
+  EP0Buf[0] = 0;
+  return (TRUE);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Resets the transport when the device is configured
+*/
+/**************************************************************************/
+void MSC_Init (void)
+{
+  #ifdef CFG_SCHEDULER
+    if (!_mscTaskReady)
+    {
+      schedTaskInit(&_mscTask, MSC_Task, NULL);
+      _mscTaskReady = true;
+    }
+  #endif
+
+  MSC_Reset();
+  MSC_Sense(SCSI_SENSE_NONE, SCSI_ASC_NONE);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Bulk IN endpoint handler (the previous packet was collected)
+*/
+/**************************************************************************/
+void MSC_BulkIn (void)
+{
+  MSC_Schedule();
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Bulk OUT endpoint handler (a packet has arrived)
+*/
+/**************************************************************************/
+void MSC_BulkOut (void)
+{
+  MSC_Schedule();
+}
+
+#endif
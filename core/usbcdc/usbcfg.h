@@ -54,7 +54,11 @@
 */
 
 #define USB_POWER           0
-#define USB_IF_NUM          1
+#if defined CFG_USBCDC_VENDORBULK || defined CFG_USBCDC_MSC
+#define USB_IF_NUM          3
+#else
+#define USB_IF_NUM          2
+#endif
 #define USB_LOGIC_EP_NUM    5
 #define USB_EP_NUM          10
 #define USB_MAX_PACKET0     64
@@ -101,9 +105,13 @@
 #define USB_SUSPEND_EVENT   1
 #define USB_RESUME_EVENT    1
 #define USB_WAKEUP_EVENT    0
-#define USB_SOF_EVENT       1
+#define USB_SOF_EVENT       0
 #define USB_ERROR_EVENT     0
+#if defined CFG_USBCDC_VENDORBULK || defined CFG_USBCDC_MSC
+#define USB_EP_EVENT        0x000F
+#else
 #define USB_EP_EVENT        0x000B
+#endif
 #define USB_CONFIGURE_EVENT 1
 #define USB_INTERFACE_EVENT 0
 #define USB_FEATURE_EVENT   0
@@ -135,8 +143,12 @@
 #define USB_CLASS           1
 #define USB_HID             0
 #define USB_HID_IF_NUM      0
+#ifdef CFG_USBCDC_MSC
+#define USB_MSC             1
+#else
 #define USB_MSC             0
-#define USB_MSC_IF_NUM      0
+#endif
+#define USB_MSC_IF_NUM      2
 #define USB_AUDIO           0
 #define USB_ADC_CIF_NUM     0
 #define USB_ADC_SIF1_NUM    1
@@ -145,6 +157,7 @@
 #define USB_CDC_CIF_NUM     0
 #define USB_CDC_DIF_NUM     1
 #define USB_CDC_BUFSIZE     CFG_USBCDC_BUFSIZE
+#define USB_VENDOR_IF_NUM   2
 
 /*
 // <e0> USB Vendor Support
@@ -25,6 +25,7 @@
 #include "usbcfg.h"
 #include "usbdesc.h"
 #include "config.h"
+#include "msc.h"
 
  
 /* USB Standard Device Descriptor */
@@ -32,9 +33,15 @@ const uint8_t USB_DeviceDescriptor[] = {
   USB_DEVICE_DESC_SIZE,              /* bLength */
   USB_DEVICE_DESCRIPTOR_TYPE,        /* bDescriptorType */
   WBVAL(0x0200), /* 2.0 */           /* bcdUSB */
+#if defined CFG_USBCDC_VENDORBULK || defined CFG_USBCDC_MSC
+  0xEF,                              /* bDeviceClass: Miscellaneous (composite with IAD) */
+  0x02,                              /* bDeviceSubClass: Common Class */
+  0x01,                              /* bDeviceProtocol: Interface Association Descriptor */
+#else
   USB_DEVICE_CLASS_COMMUNICATIONS,   /* bDeviceClass CDC*/
   0x00,                              /* bDeviceSubClass */
   0x00,                              /* bDeviceProtocol */
+#endif
   USB_MAX_PACKET0,                   /* bMaxPacketSize0 */
   WBVAL(USB_VENDOR_ID),                     /* idVendor */
   WBVAL(USB_PROD_ID),                     /* idProduct */
@@ -58,13 +65,40 @@ const uint8_t USB_ConfigDescriptor[] = {
     1*USB_ENDPOINT_DESC_SIZE      +  /* interrupt endpoint */
     1*USB_INTERFACE_DESC_SIZE     +  /* data interface */
     2*USB_ENDPOINT_DESC_SIZE         /* bulk endpoints */
+#ifdef CFG_USBCDC_VENDORBULK
+                                  +
+    0x0008                        +  /* interface association */
+    1*USB_INTERFACE_DESC_SIZE     +  /* vendor interface */
+    2*USB_ENDPOINT_DESC_SIZE         /* vendor bulk endpoints */
+#endif
+#ifdef CFG_USBCDC_MSC
+                                  +
+    0x0008                        +  /* interface association */
+    1*USB_INTERFACE_DESC_SIZE     +  /* mass storage interface */
+    2*USB_ENDPOINT_DESC_SIZE         /* mass storage bulk endpoints */
+#endif
       ),
+#if defined CFG_USBCDC_VENDORBULK || defined CFG_USBCDC_MSC
+  0x03,                              /* bNumInterfaces */
+#else
   0x02,                              /* bNumInterfaces */
+#endif
   0x01,                              /* bConfigurationValue: 0x01 is used to select this configuration */
   0x00,                              /* iConfiguration: no string to describe this configuration */
   USB_CONFIG_BUS_POWERED /*|*/       /* bmAttributes */
 /*USB_CONFIG_REMOTE_WAKEUP*/,
   USB_CONFIG_POWER_MA(100),          /* bMaxPower, device power consumption is 100 mA */
+#if defined CFG_USBCDC_VENDORBULK || defined CFG_USBCDC_MSC
+/* Interface Association Descriptor, groups the two CDC interfaces */
+  0x08,                              /* bLength */
+  0x0B,                              /* bDescriptorType: INTERFACE ASSOCIATION */
+  USB_CDC_CIF_NUM,                   /* bFirstInterface */
+  0x02,                              /* bInterfaceCount */
+  CDC_COMMUNICATION_INTERFACE_CLASS, /* bFunctionClass */
+  CDC_ABSTRACT_CONTROL_MODEL,        /* bFunctionSubClass */
+  0x01,                              /* bFunctionProtocol */
+  0x00,                              /* iFunction */
+#endif
 /* Interface 0, Alternate Setting 0, Communication class interface descriptor */
   USB_INTERFACE_DESC_SIZE,           /* bLength */
   USB_INTERFACE_DESCRIPTOR_TYPE,     /* bDescriptorType */
@@ -128,6 +162,58 @@ const uint8_t USB_ConfigDescriptor[] = {
   USB_ENDPOINT_TYPE_BULK,            /* bmAttributes */
   WBVAL(64),                         /* wMaxPacketSize */
   0x00,                              /* bInterval: ignore for Bulk transfer */
+#ifdef CFG_USBCDC_VENDORBULK
+/* Interface 2, Alternate Setting 0, Vendor specific bulk interface */
+  USB_INTERFACE_DESC_SIZE,           /* bLength */
+  USB_INTERFACE_DESCRIPTOR_TYPE,     /* bDescriptorType */
+  USB_VENDOR_IF_NUM,                 /* bInterfaceNumber: Number of Interface */
+  0x00,                              /* bAlternateSetting: no alternate setting */
+  0x02,                              /* bNumEndpoints: two endpoints used */
+  0xFF,                              /* bInterfaceClass: Vendor Specific */
+  0x00,                              /* bInterfaceSubClass */
+  0x00,                              /* bInterfaceProtocol */
+  0x00,                              /* iInterface: */
+/* Endpoint, EP2 Bulk Out */
+  USB_ENDPOINT_DESC_SIZE,            /* bLength */
+  USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
+  USB_ENDPOINT_OUT(2),               /* bEndpointAddress */
+  USB_ENDPOINT_TYPE_BULK,            /* bmAttributes */
+  WBVAL(64),                         /* wMaxPacketSize */
+  0x00,                              /* bInterval: ignore for Bulk transfer */
+/* Endpoint, EP2 Bulk In */
+  USB_ENDPOINT_DESC_SIZE,            /* bLength */
+  USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
+  USB_ENDPOINT_IN(2),                /* bEndpointAddress */
+  USB_ENDPOINT_TYPE_BULK,            /* bmAttributes */
+  WBVAL(64),                         /* wMaxPacketSize */
+  0x00,                              /* bInterval: ignore for Bulk transfer */
+#endif
+#ifdef CFG_USBCDC_MSC
+/* Interface 2, Alternate Setting 0, Mass Storage (SD card) */
+  USB_INTERFACE_DESC_SIZE,           /* bLength */
+  USB_INTERFACE_DESCRIPTOR_TYPE,     /* bDescriptorType */
+  USB_MSC_IF_NUM,                    /* bInterfaceNumber: Number of Interface */
+  0x00,                              /* bAlternateSetting: no alternate setting */
+  0x02,                              /* bNumEndpoints: two endpoints used */
+  USB_DEVICE_CLASS_STORAGE,          /* bInterfaceClass: Mass Storage */
+  MSC_SUBCLASS_SCSI,                 /* bInterfaceSubClass: SCSI transparent */
+  MSC_PROTOCOL_BULK_ONLY,            /* bInterfaceProtocol: Bulk-only transport */
+  0x00,                              /* iInterface: */
+/* Endpoint, EP2 Bulk Out */
+  USB_ENDPOINT_DESC_SIZE,            /* bLength */
+  USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
+  USB_ENDPOINT_OUT(2),               /* bEndpointAddress */
+  USB_ENDPOINT_TYPE_BULK,            /* bmAttributes */
+  WBVAL(64),                         /* wMaxPacketSize */
+  0x00,                              /* bInterval: ignore for Bulk transfer */
+/* Endpoint, EP2 Bulk In */
+  USB_ENDPOINT_DESC_SIZE,            /* bLength */
+  USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
+  USB_ENDPOINT_IN(2),                /* bEndpointAddress */
+  USB_ENDPOINT_TYPE_BULK,            /* bmAttributes */
+  WBVAL(64),                         /* wMaxPacketSize */
+  0x00,                              /* bInterval: ignore for Bulk transfer */
+#endif
 /* Terminator */
   0                                  /* bLength */
 };
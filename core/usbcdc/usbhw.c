@@ -26,6 +26,8 @@
 #include "usbhw.h"
 #include "usbcore.h"
 #include "usbuser.h"
+#include "core/bench/isrstats.h"
+#include "core/delay/delay.h"
 
 
 /*    
@@ -73,23 +75,6 @@ void USBIOClkConfig( void )
   return;
 }
 
-/*
- *  Delay number of clock cycles
- *    Parameters:      Delay length
- *    Return Value:    None
- */
-
-void delay (uint32_t length ) 
-{
-  uint32_t i;
-
-  for ( i = 0; i < length; i++ )
-  {
-    __asm("nop");
-  }
-  return;
-}
-
 /*
  *  Get Endpoint Physical Address
  *    Parameters:      EPNum: Endpoint Number
@@ -184,10 +169,12 @@ void USB_Init (void)
   USB_DEVFIQSEL = 0x01;				/* SOF Use FIQ */
  
   /* Enable the USB Interrupt */
+  NVIC_SetPriority(USB_FIQn, CFG_IRQPRIO_USB);
   NVIC_EnableIRQ(USB_FIQn);
 #endif
 
   /* Enable the USB Interrupt */
+  NVIC_SetPriority(USB_IRQn, CFG_IRQPRIO_USB);
   NVIC_EnableIRQ(USB_IRQn);
     
   USB_Reset();
@@ -412,6 +399,27 @@ void USB_ClearEPBuf (uint32_t EPNum)
 }
 
 
+/*
+ *  Check whether a USB Endpoint Buffer holds data
+ *    Logical endpoint 3 is double buffered: for OUT the status is
+ *    full if either buffer holds a packet, for IN only if both do, so
+ *    FALSE on an IN endpoint always means a packet can be written.
+ *    Parameters:      EPNum: Endpoint Number
+ *                       EPNum.0..3: Address
+ *                       EPNum.7:    Dir
+ *    Return Value:    TRUE if the buffer is full (OUT: data to read,
+ *                     IN: no buffer free)
+ */
+
+uint32_t USB_EPFull (uint32_t EPNum) 
+{
+  uint32_t n = EPAdr(EPNum);
+
+  WrCmd(CMD_SEL_EP(n));
+  return ((RdCmdDat(DAT_SEL_EP(n)) & EP_SEL_F) ? TRUE : FALSE);
+}
+
+
 /*
  *  Read USB Endpoint Data
  *    Parameters:      EPNum: Endpoint Number
@@ -424,26 +432,49 @@ void USB_ClearEPBuf (uint32_t EPNum)
 uint32_t USB_ReadEP (uint32_t EPNum, uint8_t *pData) 
 {
   uint32_t cnt, n;
+  uint32_t *pWord;
 
   USB_CTRL = ((EPNum & 0x0F) << 2) | CTRL_RD_EN;
   /* 3 clock cycles to fetch the packet length from RAM. */ 
-  delay( 5 );
+  delayCycles( 5 );
 
   do 
   {
     cnt = USB_RXPLEN;
   } while ((cnt & PKT_DV) == 0);
   cnt &= PKT_LNGTH_MASK;
+  n = (cnt + 3) / 4;
 
-  for (n = 0; n < (cnt + 3) / 4; n++) 
+  if (((uint32_t)pData & 3) == 0)
+  {
+    /* Word aligned buffer, unrolled for full 64 byte packets */
+    pWord = (uint32_t *)pData;
+    while (n >= 4)
+    {
+      pWord[0] = USB_RXDATA;
+      pWord[1] = USB_RXDATA;
+      pWord[2] = USB_RXDATA;
+      pWord[3] = USB_RXDATA;
+      pWord += 4;
+      n -= 4;
+    }
+    while (n--)
+    {
+      *pWord++ = USB_RXDATA;
+    }
+  }
+  else
   {
-    *((uint32_t __attribute__((packed)) *)pData) = USB_RXDATA;
-    pData += 4;
+    while (n--)
+    {
+      *((uint32_t __attribute__((packed)) *)pData) = USB_RXDATA;
+      pData += 4;
+    }
   }
 
   USB_CTRL = 0;
 
-  if ((EPNum & 0x80) != 0x04) 
+  if ((EPNum & 0x0F) != 0x04) 
   {   /* Non-Isochronous Endpoint */
     WrCmdEP(EPNum, CMD_CLR_BUF);
   }
@@ -465,16 +496,39 @@ uint32_t USB_ReadEP (uint32_t EPNum, uint8_t *pData)
 uint32_t USB_WriteEP (uint32_t EPNum, uint8_t *pData, uint32_t cnt) 
 {
   uint32_t n;
+  const uint32_t *pWord;
 
   USB_CTRL = ((EPNum & 0x0F) << 2) | CTRL_WR_EN;
   /* 3 clock cycles to fetch the packet length from RAM. */ 
-  delay( 5 );
+  delayCycles( 5 );
   USB_TXPLEN = cnt;
+  n = (cnt + 3) / 4;
 
-  for (n = 0; n < (cnt + 3) / 4; n++) 
+  if (((uint32_t)pData & 3) == 0)
   {
-    USB_TXDATA = *((uint32_t __attribute__((packed)) *)pData);
-    pData += 4;
+    /* Word aligned buffer, unrolled for full 64 byte packets */
+    pWord = (const uint32_t *)pData;
+    while (n >= 4)
+    {
+      USB_TXDATA = pWord[0];
+      USB_TXDATA = pWord[1];
+      USB_TXDATA = pWord[2];
+      USB_TXDATA = pWord[3];
+      pWord += 4;
+      n -= 4;
+    }
+    while (n--)
+    {
+      USB_TXDATA = *pWord++;
+    }
+  }
+  else
+  {
+    while (n--)
+    {
+      USB_TXDATA = *((uint32_t __attribute__((packed)) *)pData);
+      pData += 4;
+    }
   }
 
   USB_CTRL = 0;
@@ -509,10 +563,18 @@ uint32_t USB_GetFrame (void)
 #ifdef CFG_USBCDC
 void USB_IRQHandler (void)
 {
-  uint32_t disr, val, n, m;
+  uint32_t disr, val, n, m, epint;
+  ISRSTAT_BEGIN();
 
   disr = USB_DEVINTST;                      /* Device Interrupt Status */
   USB_DEVINTCLR = disr;
+  epint = (disr >> 1) & 0xFF;               /* EP0 through EP7 */
+
+  /* Fast path: while streaming, usually only endpoint bits are set */
+  if ((disr & (DEV_STAT_INT | (USB_SOF_EVENT ? FRAME_INT : 0))) == 0)
+  {
+    goto isr_endpoints;
+  }
 
   /* Device Status Interrupt (Reset, Connect change, Suspend/Resume) */
   if (disr & DEV_STAT_INT) 
@@ -569,37 +631,35 @@ void USB_IRQHandler (void)
 #endif
 
   /* Endpoint's Interrupt */
-  if (disr & (0xFF<<1)) {
-	/* if any of the EP0 through EP7 is set, or bit 1 through 9 on disr */
-    for (n = 0; n < USB_EP_NUM; n++) {      /* Check All Endpoints */
-	  /* skip frame interrupt at bit 0 in disr */
-//      if (disr & ((1 << n)<<1)) {
-	  if ((disr>>1) & (1 << n)) {
-        m = n >> 1;
-		/* clear EP interrupt by sending cmd to the command engine. */
-		WrCmd(CMD_SEL_EP_CLRI(n));
-		val = RdCmdDat(DAT_SEL_EP_CLRI(n));
-        if ((n & 1) == 0) {                 /* OUT Endpoint */
-          if (n == 0) {                     /* Control OUT Endpoint */
-            if (val & EP_SEL_STP) {         /* Setup Packet */
-              if (USB_P_EP[0]) {
-                USB_P_EP[0](USB_EVT_SETUP);
-                continue;
-              }
-            }
-          }
-          if (USB_P_EP[m]) {
-            USB_P_EP[m](USB_EVT_OUT);
-          }
-        } else {                            /* IN Endpoint */
-          if (USB_P_EP[m]) {
-            USB_P_EP[m](USB_EVT_IN);
+isr_endpoints:
+  /* Only visit the endpoints that are set, lowest first */
+  while (epint) {
+    n = __builtin_ctz(epint);
+    epint &= epint - 1;
+    m = n >> 1;
+    /* clear EP interrupt by sending cmd to the command engine. */
+    WrCmd(CMD_SEL_EP_CLRI(n));
+    val = RdCmdDat(DAT_SEL_EP_CLRI(n));
+    if ((n & 1) == 0) {                     /* OUT Endpoint */
+      if (n == 0) {                         /* Control OUT Endpoint */
+        if (val & EP_SEL_STP) {             /* Setup Packet */
+          if (USB_P_EP[0]) {
+            USB_P_EP[0](USB_EVT_SETUP);
+            continue;
           }
         }
       }
+      if (USB_P_EP[m]) {
+        USB_P_EP[m](USB_EVT_OUT);
+      }
+    } else {                                /* IN Endpoint */
+      if (USB_P_EP[m]) {
+        USB_P_EP[m](USB_EVT_IN);
+      }
     }
   }
 isr_end:
+  ISRSTAT_END(isrStat_USB);
   return;
 }
 
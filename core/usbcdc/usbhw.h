@@ -53,6 +53,7 @@ extern void  USB_ResetEP    (uint32_t EPNum);
 extern void  USB_SetStallEP (uint32_t EPNum);
 extern void  USB_ClrStallEP (uint32_t EPNum);
 extern void  USB_ClearEPBuf (uint32_t EPNum);
+extern uint32_t USB_EPFull  (uint32_t EPNum);
 extern uint32_t USB_ReadEP  (uint32_t EPNum, uint8_t *pData);
 extern uint32_t USB_WriteEP (uint32_t EPNum, uint8_t *pData, uint32_t cnt);
 extern uint32_t USB_GetFrame(void);
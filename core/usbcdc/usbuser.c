@@ -23,6 +23,8 @@
 #include "usbcore.h"
 #include "usbuser.h"
 #include "cdcuser.h"
+#include "usbvendor.h"
+#include "mscuser.h"
 
 
 /*
@@ -114,7 +116,15 @@ void USB_Error_Event (uint32_t error) {
 void USB_Configure_Event (void) {
 
   if (USB_Configuration) {                  /* Check if USB is configured */
-    /* add your code here */
+    /* Restart the bulk IN pipeline with anything buffered so far */
+    CDC_DepInEmpty = 1;
+    CDC_BulkInStart();
+#ifdef CFG_USBCDC_VENDORBULK
+    usbVendorInit();
+#endif
+#ifdef CFG_USBCDC_MSC
+    MSC_Init();
+#endif
   }
 }
 #endif
@@ -184,7 +194,27 @@ void USB_EndPoint1 (uint32_t event) {
 
 void USB_EndPoint2 (uint32_t event) 
 {
+#ifdef CFG_USBCDC_VENDORBULK
+  switch (event) {
+    case USB_EVT_OUT:
+      usbVendorBulkOut ();           /* vendor data received from Host */
+      break;
+    case USB_EVT_IN:
+      usbVendorBulkIn ();            /* vendor data collected by Host */
+      break;
+  }
+#elif defined CFG_USBCDC_MSC
+  switch (event) {
+    case USB_EVT_OUT:
+      MSC_BulkOut ();                /* CBW or sector data from Host */
+      break;
+    case USB_EVT_IN:
+      MSC_BulkIn ();                 /* data or CSW collected by Host */
+      break;
+  }
+#else
   event = event;
+#endif
 }
 
 
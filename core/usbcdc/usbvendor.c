@@ -0,0 +1,288 @@
+/**************************************************************************/
+/*! 
+    @file     usbvendor.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Vendor-specific bulk IN/OUT endpoint pair (EP2), added to the USB CDC
+    configuration when CFG_USBCDC_VENDORBULK is defined.  This is meant
+    for raw binary data (ADC captures, file contents, etc.) that would
+    otherwise have to go through the CDC text interface.
+
+    Transfers work on caller supplied buffers: usbVendorSend streams the
+    buffer to the host one 64 byte packet per IN endpoint interrupt,
+    straight out of the buffer, and usbVendorReceive collects OUT packets
+    until the buffer is full or the host sends a short packet.  When no
+    receive buffer is posted, OUT packets are left in the endpoint and
+    the host is NAKed.  Buffers must stay valid until the callback.
+
+    @section Example
+
+    @code 
+    #include "core/usbcdc/usbvendor.h"
+
+    static uint16_t samples[512];
+    static volatile bool done;
+
+    void captureSent(uint8_t *buffer, uint32_t length)
+    {
+      done = true;
+    }
+
+    ...
+    done = false;
+    usbVendorSend((uint8_t *)samples, sizeof(samples), captureSent);
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "usbvendor.h"
+
+#ifdef CFG_USBCDC_VENDORBULK
+
+#include "usb.h"
+#include "usbhw.h"
+#include "usbcore.h"
+
+typedef struct
+{
+  uint8_t *buffer;                  // Start of the transfer
+  uint8_t *ptr;                     // Next byte to send/receive
+  uint32_t remaining;
+  usbVendorCallback_t callback;
+  volatile bool busy;
+} usbVendorTransfer_t;
+
+static usbVendorTransfer_t _usbVendorTx;
+static usbVendorTransfer_t _usbVendorRx;
+static bool _usbVendorLastInFull = false;
+
+// Used when an OUT packet doesn't fit in the rest of the receive buffer
+// (USB_ReadEP always writes whole 32-bit words)
+static uint8_t _usbVendorPacket[USBVENDOR_PACKETSIZE];
+
+/**************************************************************************/
+/*! 
+    @brief  Finishes a transfer and calls its callback
+*/
+/**************************************************************************/
+static void usbVendorComplete(usbVendorTransfer_t *transfer)
+{
+  transfer->busy = false;
+  if (transfer->callback != NULL)
+  {
+    transfer->callback(transfer->buffer, transfer->ptr - transfer->buffer);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Resets both endpoints (pending transfers are dropped)
+*/
+/**************************************************************************/
+void usbVendorInit(void)
+{
+  memset(&_usbVendorTx, 0, sizeof(_usbVendorTx));
+  memset(&_usbVendorRx, 0, sizeof(_usbVendorRx));
+  _usbVendorLastInFull = false;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Starts sending a buffer to the host
+
+    @param[in]  buffer
+                Data to send (must stay valid until the callback)
+    @param[in]  length
+                Number of bytes to send
+    @param[in]  callback
+                Called from the USB interrupt once everything has been
+                sent (may be NULL)
+
+    @return     false if USB isn't configured or a send is in progress
+*/
+/**************************************************************************/
+bool usbVendorSend(const uint8_t *buffer, uint32_t length, usbVendorCallback_t callback)
+{
+  if (!USB_Configuration || _usbVendorTx.busy)
+  {
+    return false;
+  }
+
+  _usbVendorTx.buffer = (uint8_t *)buffer;
+  _usbVendorTx.ptr = (uint8_t *)buffer;
+  _usbVendorTx.remaining = length;
+  _usbVendorTx.callback = callback;
+  _usbVendorTx.busy = true;
+  _usbVendorLastInFull = false;
+
+  // Send the first packet, the IN interrupt sends the rest
+  NVIC_DisableIRQ(USB_IRQn);
+  usbVendorBulkIn();
+  NVIC_EnableIRQ(USB_IRQn);
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Posts a buffer for data from the host.  The transfer ends
+            when the buffer is full or the host sends a short packet.
+
+    @param[in]  buffer
+                Buffer for the received data
+    @param[in]  length
+                Size of the buffer
+    @param[in]  callback
+                Called from the USB interrupt with the number of bytes
+                received (may be NULL)
+
+    @return     false if USB isn't configured or a receive is in progress
+*/
+/**************************************************************************/
+bool usbVendorReceive(uint8_t *buffer, uint32_t length, usbVendorCallback_t callback)
+{
+  if (!USB_Configuration || _usbVendorRx.busy || !length)
+  {
+    return false;
+  }
+
+  _usbVendorRx.buffer = buffer;
+  _usbVendorRx.ptr = buffer;
+  _usbVendorRx.remaining = length;
+  _usbVendorRx.callback = callback;
+  _usbVendorRx.busy = true;
+
+  // A packet may already be waiting in the endpoint
+  NVIC_DisableIRQ(USB_IRQn);
+  usbVendorBulkOut();
+  NVIC_EnableIRQ(USB_IRQn);
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns true while a send is in progress
+*/
+/**************************************************************************/
+bool usbVendorSendBusy(void)
+{
+  return _usbVendorTx.busy;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns true while a receive buffer is posted
+*/
+/**************************************************************************/
+bool usbVendorReceiveBusy(void)
+{
+  return _usbVendorRx.busy;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Bulk IN endpoint handler, sends the next packet (called from
+            USB_EndPoint2 when the previous packet has been collected)
+*/
+/**************************************************************************/
+void usbVendorBulkIn(void)
+{
+  uint32_t count;
+
+  if (!_usbVendorTx.busy)
+  {
+    return;
+  }
+
+  if (_usbVendorTx.remaining)
+  {
+    count = _usbVendorTx.remaining > USBVENDOR_PACKETSIZE ? USBVENDOR_PACKETSIZE : _usbVendorTx.remaining;
+    USB_WriteEP(USBVENDOR_EP_IN, _usbVendorTx.ptr, count);
+    _usbVendorTx.ptr += count;
+    _usbVendorTx.remaining -= count;
+    _usbVendorLastInFull = (count == USBVENDOR_PACKETSIZE);
+  }
+  else if (_usbVendorLastInFull)
+  {
+    // End the transfer with a zero length packet
+    _usbVendorLastInFull = false;
+    USB_WriteEP(USBVENDOR_EP_IN, _usbVendorPacket, 0);
+  }
+  else
+  {
+    usbVendorComplete(&_usbVendorTx);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Bulk OUT endpoint handler, reads a packet into the posted
+            receive buffer (called from USB_EndPoint2)
+*/
+/**************************************************************************/
+void usbVendorBulkOut(void)
+{
+  uint32_t count;
+
+  // Without a receive buffer the packet stays in the endpoint (NAK)
+  if (!_usbVendorRx.busy || !USB_EPFull(USBVENDOR_EP_OUT))
+  {
+    return;
+  }
+
+  if (_usbVendorRx.remaining >= USBVENDOR_PACKETSIZE)
+  {
+    count = USB_ReadEP(USBVENDOR_EP_OUT, _usbVendorRx.ptr);
+  }
+  else
+  {
+    count = USB_ReadEP(USBVENDOR_EP_OUT, _usbVendorPacket);
+    if (count > _usbVendorRx.remaining)
+    {
+      count = _usbVendorRx.remaining;
+    }
+    memcpy(_usbVendorRx.ptr, _usbVendorPacket, count);
+  }
+  _usbVendorRx.ptr += count;
+  _usbVendorRx.remaining -= count;
+
+  if ((_usbVendorRx.remaining == 0) || (count < USBVENDOR_PACKETSIZE))
+  {
+    usbVendorComplete(&_usbVendorRx);
+  }
+}
+
+#endif
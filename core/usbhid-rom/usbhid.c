@@ -42,6 +42,8 @@
 #include "core/adc/adc.h"
 #include "core/systick/systick.h"
 
+#include "core/bench/isrstats.h"
+
 #include "usbhid.h"
 
 USB_DEV_INFO DeviceInfo;
@@ -64,54 +66,103 @@ typedef struct usbhid_out_s
   uint32_t rollovers;
 } usbhid_out_t;
 
+// Reports sampled by usbHIDQueueReport, waiting to be sent
+static usbhid_out_t _usbHIDQueue[CFG_USBHID_REPORTQUEUE];
+static volatile uint16_t _usbHIDQueueHead = 0;
+static volatile uint16_t _usbHIDQueueTail = 0;
+static usbhid_out_t _usbHIDLastReport;
+static bool _usbHIDQueueUsed = false;
+
+/**************************************************************************/
+/*! 
+    @brief Samples the GPIO, ADC and systick values into a report
+*/
+/**************************************************************************/
+static void usbHIDSample (usbhid_out_t *out)
+{
+  out->gpio1Dir = GPIO_GPIO1DIR;
+  out->gpio1Data = GPIO_GPIO1DATA;
+  out->gpio2Dir = GPIO_GPIO2DIR;
+  out->gpio2Data = GPIO_GPIO2DATA;
+  out->gpio3Dir = GPIO_GPIO3DIR;
+  out->gpio3Data = GPIO_GPIO3DATA;
+  out->adc0 = adcRead(0);
+  out->adc1 = adcRead(1);
+  out->adc2 = adcRead(2);
+  out->adc3 = adcRead(3);
+  out->systicks = systickGetTicks();
+  out->rollovers = systickGetRollovers();
+}
+
+/**************************************************************************/
+/*! 
+    @brief Samples a report and queues it for the next IN transfer(s)
+
+    This is meant to be called at a fixed rate (from a timer interrupt
+    or the main loop) so that the USB callback doesn't have to touch
+    the ADC.  Once this has been called, the IN report callback only
+    copies queued reports, and repeats the last report if the queue
+    has run dry.
+
+    @return false if the queue is full and the report was dropped
+*/
+/**************************************************************************/
+bool usbHIDQueueReport (void)
+{
+  uint16_t head = _usbHIDQueueHead;
+
+  if ((uint16_t)(head - _usbHIDQueueTail) >= CFG_USBHID_REPORTQUEUE)
+  {
+    return false;
+  }
+
+  usbHIDSample(&_usbHIDQueue[head & (CFG_USBHID_REPORTQUEUE - 1)]);
+  _usbHIDQueueUsed = true;
+  _usbHIDQueueHead = head + 1;
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Returns the number of reports waiting to be sent
+*/
+/**************************************************************************/
+uint16_t usbHIDQueueCount (void)
+{
+  return (uint16_t)(_usbHIDQueueHead - _usbHIDQueueTail);
+}
+
 /**************************************************************************/
 /*! 
     @brief Gets the HID In Report (the report going from the LPC1343 to
     the USB host)
+
+    Each IN report holds CFG_USBHID_REPORTSPERPACKET samples, oldest
+    first.  If usbHIDQueueReport is never called, the samples are read
+    synchronously here.
 */
 /**************************************************************************/
 void usbHIDGetInReport (uint8_t src[], uint32_t length)
 {
-  usbhid_out_t out;
-
-  out.gpio1Dir = GPIO_GPIO1DIR;
-  out.gpio1Data = GPIO_GPIO1DATA;
-  out.gpio2Dir = GPIO_GPIO2DIR;
-  out.gpio2Data = GPIO_GPIO2DATA;
-  out.gpio3Dir = GPIO_GPIO3DIR;
-  out.gpio3Data = GPIO_GPIO3DATA;
-  out.adc0 = adcRead(0);
-  out.adc1 = adcRead(1);
-  out.adc2 = adcRead(2);
-  out.adc3 = adcRead(3);
-  out.systicks = systickGetTicks();
-  out.rollovers = systickGetRollovers();
-
-  size_t i = 0;
-  memcpy(&src[i], &out.gpio1Dir, sizeof out.gpio1Dir);
-  i += sizeof out.gpio1Dir;
-  memcpy(&src[i], &out.gpio1Data, sizeof out.gpio1Data);
-  i += sizeof out.gpio1Data;
-  memcpy(&src[i], &out.gpio2Dir, sizeof out.gpio2Dir);
-  i += sizeof out.gpio2Dir;
-  memcpy(&src[i], &out.gpio2Data, sizeof out.gpio2Data);
-  i += sizeof out.gpio2Data;
-  memcpy(&src[i], &out.gpio3Dir, sizeof out.gpio3Dir);
-  i += sizeof out.gpio3Dir;
-  memcpy(&src[i], &out.gpio3Data, sizeof out.gpio3Data);
-  i += sizeof out.gpio3Data;
-  memcpy(&src[i], &out.adc0, sizeof out.adc0);
-  i += sizeof out.adc0;
-  memcpy(&src[i], &out.adc1, sizeof out.adc1);
-  i += sizeof out.adc1;
-  memcpy(&src[i], &out.adc2, sizeof out.adc2);
-  i += sizeof out.adc2;
-  memcpy(&src[i], &out.adc3, sizeof out.adc3);
-  i += sizeof out.adc3;
-  memcpy(&src[i], &out.systicks, sizeof out.systicks);
-  i += sizeof out.systicks;
-  memcpy(&src[i], &out.rollovers, sizeof out.rollovers);
-  i += sizeof out.rollovers;
+  uint32_t i;
+  uint16_t tail;
+
+  for (i = 0; i < CFG_USBHID_REPORTSPERPACKET; i++)
+  {
+    tail = _usbHIDQueueTail;
+    if (tail != _usbHIDQueueHead)
+    {
+      _usbHIDLastReport = _usbHIDQueue[tail & (CFG_USBHID_REPORTQUEUE - 1)];
+      _usbHIDQueueTail = tail + 1;
+    }
+    else if (!_usbHIDQueueUsed)
+    {
+      usbHIDSample(&_usbHIDLastReport);
+    }
+    // The struct has no padding, so it can be copied as is
+    memcpy(&src[i * sizeof(usbhid_out_t)], &_usbHIDLastReport, sizeof(usbhid_out_t));
+  }
 }
 
 /**************************************************************************/
@@ -185,7 +236,7 @@ void usbHIDInit (void)
   HidDevInfo.idProduct = USB_PROD_ID;
   HidDevInfo.bcdDevice = USB_DEVICE; 
   HidDevInfo.StrDescPtr = (uint32_t)&USB_HIDStringDescriptor[0];
-  HidDevInfo.InReportCount = sizeof(usbhid_out_t);
+  HidDevInfo.InReportCount = sizeof(usbhid_out_t) * CFG_USBHID_REPORTSPERPACKET;
   HidDevInfo.OutReportCount = 1;
   HidDevInfo.SampleInterval = 0x20;
   HidDevInfo.InReport = usbHIDGetInReport;
@@ -216,7 +267,9 @@ void usbHIDInit (void)
 #ifdef CFG_USBHID
 void USB_IRQHandler()
 {
+  ISRSTAT_BEGIN();
   (*rom)->pUSBD->isr();
+  ISRSTAT_END(isrStat_USB);
 }
 #endif
 
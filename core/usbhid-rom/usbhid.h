@@ -41,6 +41,8 @@
 
 void usbHIDGetInReport (uint8_t src[], uint32_t length);
 void usbHIDSetOutReport (uint8_t dst[], uint32_t length);
+bool usbHIDQueueReport (void);
+uint16_t usbHIDQueueCount (void);
 void usbHIDInit (void);
 
 #endif
@@ -0,0 +1,241 @@
+/**************************************************************************/
+/*! 
+    @file     supervisor.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Task supervisor for the watchdog timer.  Rather than feeding the
+    watchdog from the main loop (which keeps it happy as long as
+    anything at all is running), each task registers the longest time
+    it may go without checking in, and the systick interrupt only feeds
+    the watchdog while every task is within its deadline.  Once a task
+    has missed its deadline the watchdog is never fed again, so the
+    device resets after CFG_WDT_SUPERVISOR_TIMEOUTMS.
+
+    The ID of the task that stalled is kept in a section of SRAM that
+    the startup code doesn't clear, and is available after the reset
+    from supervisorGetLastStalled.  Tasks are numbered in the order
+    they were registered, so register them in the same order on every
+    boot.  A loop that starves the other tasks shows up as one of its
+    victims, which narrows the search down to whatever was running
+    ahead of it.
+
+    A stall with interrupts disabled also stops the systick feed, in
+    which case the watchdog still resets the device but no task is
+    recorded.
+
+    @section Example
+
+    @code 
+    #include "core/wdt/supervisor.h"
+
+    static uint8_t radioId;
+    ...
+    supervisorInit();   // Called by systemInit when CFG_WDT_SUPERVISOR is defined
+    radioId = supervisorRegister("Radio", 500);
+
+    void radioTask(schedTask_t *task)
+    {
+      supervisorCheckIn(radioId);
+      ...
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "supervisor.h"
+#include "wdt.h"
+#include "sysdefs.h"
+#include "core/systick/systick.h"
+
+// Marks a valid stall record in no-init RAM ("WDTS")
+#define SUPERVISOR_MAGIC (0x57445453)
+
+typedef struct
+{
+  const char *name;
+  uint32_t deadline;                  // Deadline in systick ticks
+  volatile uint32_t lastCheckIn;      // Systick tick of the last check-in
+} supervisorTask_t;
+
+typedef struct
+{
+  uint32_t magic;
+  uint8_t id;
+} supervisorRecord_t;
+
+static supervisorTask_t _supervisorTasks[SUPERVISOR_MAXTASKS];
+static uint8_t _supervisorTaskCount = 0;
+static volatile uint8_t _supervisorStalled = SUPERVISOR_NONE;
+static uint8_t _supervisorLastStalled = SUPERVISOR_NONE;
+static bool _supervisorRunning = false;
+
+// Survives the watchdog reset (not cleared by the startup code)
+static supervisorRecord_t _supervisorRecord NOINIT;
+
+/**************************************************************************/
+/*! 
+    @brief  Reads back the stall record from before the last reset and
+            starts the watchdog with a system reset on timeout
+*/
+/**************************************************************************/
+void supervisorInit(void)
+{
+  // Only trust the record after a watchdog reset
+  if ((SCB_RESETSTAT & SCB_RESETSTAT_WDT_MASK) && (_supervisorRecord.magic == SUPERVISOR_MAGIC))
+  {
+    _supervisorLastStalled = _supervisorRecord.id;
+  }
+  _supervisorRecord.magic = 0;
+
+  // Clear the reset status flags (write one to clear)
+  SCB_RESETSTAT = SCB_RESETSTAT_WDT_MASK;
+
+  wdtInit(true);
+  wdtSetTimeout(CFG_WDT_SUPERVISOR_TIMEOUTMS);
+  wdtFeed();
+  _supervisorRunning = true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Adds a task to the supervisor
+
+    @param[in]  name
+                Name used in reports (the string must stay allocated)
+    @param[in]  deadlineMs
+                The longest time in milliseconds the task may go
+                between calls to supervisorCheckIn
+
+    @return     The ID to pass to supervisorCheckIn, or SUPERVISOR_NONE
+                if SUPERVISOR_MAXTASKS tasks are already registered
+*/
+/**************************************************************************/
+uint8_t supervisorRegister(const char *name, uint32_t deadlineMs)
+{
+  supervisorTask_t *task;
+
+  if (_supervisorTaskCount >= SUPERVISOR_MAXTASKS)
+  {
+    return SUPERVISOR_NONE;
+  }
+
+  task = &_supervisorTasks[_supervisorTaskCount];
+  task->name = name;
+  task->deadline = (deadlineMs + CFG_SYSTICK_DELAY_IN_MS - 1) / CFG_SYSTICK_DELAY_IN_MS;
+  task->lastCheckIn = systickGetTicks();
+
+  // The systick handler only looks at tasks below the count
+  return _supervisorTaskCount++;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Tells the supervisor that a task is still running properly
+
+    @param[in]  id
+                The ID returned by supervisorRegister
+*/
+/**************************************************************************/
+void supervisorCheckIn(uint8_t id)
+{
+  if (id < _supervisorTaskCount)
+  {
+    _supervisorTasks[id].lastCheckIn = systickGetTicks();
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Checks every task against its deadline and feeds the
+            watchdog if they are all healthy.  Called from the systick
+            interrupt.
+*/
+/**************************************************************************/
+void supervisorTick(void)
+{
+  uint32_t now;
+  uint8_t i;
+
+  if (!_supervisorRunning || (_supervisorStalled != SUPERVISOR_NONE))
+  {
+    return;
+  }
+
+  now = systickGetTicks();
+  for (i = 0; i < _supervisorTaskCount; i++)
+  {
+    if (now - _supervisorTasks[i].lastCheckIn > _supervisorTasks[i].deadline)
+    {
+      // Record the culprit and let the watchdog run out
+      _supervisorStalled = i;
+      _supervisorRecord.id = i;
+      _supervisorRecord.magic = SUPERVISOR_MAGIC;
+      return;
+    }
+  }
+
+  wdtFeed();
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the ID of the task that has missed its deadline (the
+            device is about to be reset), or SUPERVISOR_NONE
+*/
+/**************************************************************************/
+uint8_t supervisorGetStalled(void)
+{
+  return _supervisorStalled;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the ID of the task that caused the last watchdog
+            reset, or SUPERVISOR_NONE if the last reset wasn't caused by
+            a stalled task
+*/
+/**************************************************************************/
+uint8_t supervisorGetLastStalled(void)
+{
+  return _supervisorLastStalled;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the name a task was registered with, or NULL
+*/
+/**************************************************************************/
+const char *supervisorGetName(uint8_t id)
+{
+  return (id < _supervisorTaskCount) ? _supervisorTasks[id].name : NULL;
+}
@@ -66,6 +66,9 @@
 
 #define WDT_FEED_VALUE		(0x003FFFFF)
 
+// WDT_OSC set by wdtClockSetup (the WDT divides this by a further 4)
+#define WDT_CLOCKSPEED_HZ	(250000)
+
 volatile uint32_t wdt_counter;
 
 /**************************************************************************/
@@ -125,14 +128,32 @@ void wdtInit (bool reset)
   wdt_counter = 0;
 
   /* Enable the WDT interrupt */
+  NVIC_SetPriority(WDT_IRQn, CFG_IRQPRIO_PERIPH);
   NVIC_EnableIRQ(WDT_IRQn);
 
   /* Set timeout value (must be at least 0x000000FF) */
   WDT_WDTC = WDT_FEED_VALUE;
 
-  /* Enable the watchdog timer (without system reset) */
+  /* Enable the watchdog timer (with or without system reset) */
   WDT_WDMOD = WDT_WDMOD_WDEN_ENABLED |
-              reset ? WDT_WDMOD_WDRESET_ENABLED : WDT_WDMOD_WDRESET_DISABLED ;
+              (reset ? WDT_WDMOD_WDRESET_ENABLED : WDT_WDMOD_WDRESET_DISABLED);
+}
+
+/**************************************************************************/
+/*! 
+    Sets the time the watchdog waits for a feed before it times out.
+    The new value is loaded with the next wdtFeed.
+
+    @param[in]  ms
+                Timeout in milliseconds (at least 5ms)
+*/
+/**************************************************************************/
+void wdtSetTimeout (uint32_t ms)
+{
+  uint32_t count = ms * (WDT_CLOCKSPEED_HZ / 4 / 1000);
+
+  /* Must be at least 0x000000FF */
+  WDT_WDTC = count < 0xFF ? 0xFF : count;
 }
 
 /**************************************************************************/
@@ -42,6 +42,7 @@
 #include "projectconfig.h"
 
 void wdtInit (bool reset);
+void wdtSetTimeout (uint32_t ms);
 void wdtFeed (void);
 
 #endif
\ No newline at end of file
@@ -38,10 +38,77 @@
 #include "chb_drvr.h"
 #include "chb_buf.h"
 
+#include "core/systick/systick.h"
+#include "core/sched/event.h"
+
 static chb_pcb_t pcb;
-// these are for the duplicate checking and rejection
-static U8 prev_seq = 0xFF;
-static U16 prev_src_addr = 0xFFFE;
+
+// last sequence number seen from each of the most recent senders, for the
+// duplicate checking and rejection
+static struct
+{
+    U16 src_addr;
+    U8 seq;
+} dupes[CFG_CHIBI_DUPCACHE];
+static U8 dupe_idx = 0;
+
+#if CFG_CHIBI_LINKSTATS > 0
+static chb_link_t links[CFG_CHIBI_LINKSTATS];
+static U8 link_cnt = 0;
+#endif
+
+#ifdef CFG_CHIBI_ADAPTIVE
+#define CHB_ADAPT_SAMPLES       8       // frames to a node before its settings are adapted
+#define CHB_ADAPT_PDR_GOOD      243     // 95% acked: one retry is enough
+#define CHB_ADAPT_PDR_POOR      192     // below 75% acked: retry up to 7 times
+#define CHB_ADAPT_BUSY_LOW      8       // below 3% channel access failures: short backoffs
+#define CHB_ADAPT_BUSY_HIGH     32      // 12% channel access failures: long backoffs
+#define CHB_ADAPT_ED_STRONG     40      // its frames arrive 40dB above the sensitivity
+
+// power levels of the band, highest first. the link power steps go down
+// this table from CFG_CHIBI_POWER.
+#if (CFG_CHIBI_MODE == 1) || (CFG_CHIBI_MODE == 3)
+static const U8 tune_pwr_table[] = { CHB_PWR_NA_10DBM, CHB_PWR_NA_9DBM, CHB_PWR_NA_8DBM, CHB_PWR_NA_7DBM,
+                                     CHB_PWR_NA_6DBM, CHB_PWR_NA_5DBM, CHB_PWR_NA_4DBM, CHB_PWR_NA_3DBM,
+                                     CHB_PWR_NA_2DBM, CHB_PWR_NA_1DBM, CHB_PWR_NA_0DBM };
+#elif (CFG_CHIBI_MODE == 2)
+static const U8 tune_pwr_table[] = { CHB_PWR_CHINA_5DBM, CHB_PWR_CHINA_4DBM, CHB_PWR_CHINA_3DBM,
+                                     CHB_PWR_CHINA_2DBM, CHB_PWR_CHINA_1DBM, CHB_PWR_CHINA_0DBM };
+#else
+static const U8 tune_pwr_table[] = { CHB_PWR_EU2_3DBM, CHB_PWR_EU2_2DBM, CHB_PWR_EU2_1DBM, CHB_PWR_EU2_0DBM };
+#endif
+#define CHB_ADAPT_PWR_LEVELS    (sizeof(tune_pwr_table) / sizeof(tune_pwr_table[0]))
+
+// CFG_CHIBI_POWER's place in the table (CHB_ADAPT_PWR_LEVELS if it isn't
+// in it: the power isn't adapted then), and what the radio is set to now
+static U8 tune_pwr_base;
+static U8 tune_retries, tune_csma, tune_be, tune_pwr;
+#endif
+
+#if CFG_CHIBI_TXQUEUE > 0
+// queued frames waiting to be sent. the frame at tx_head is the one on
+// the air when CHB_TXQ_BUSY is set. the frame count and the busy flag
+// share tx_state so they can be updated together without a critical
+// section (only the isr and chb_tx_next clear the flag).
+typedef struct
+{
+    U8 hdr[CHB_HDR_SZ + 1];
+    U8 len;
+    bool more;                  // more fragments of the same write follow
+    U8 repeat;                  // broadcast copies still to be sent
+    chb_tx_cb_t cb;
+    void *arg;
+    U8 data[CHB_MAX_PAYLOAD];
+} chb_tx_frame_t;
+
+#define CHB_TXQ_COUNT   0xFF
+#define CHB_TXQ_BUSY    0x100
+
+static chb_tx_frame_t tx_queue[CFG_CHIBI_TXQUEUE];
+static volatile U8 tx_head = 0;
+static volatile U32 tx_state = 0;
+#endif
+
 /**************************************************************************/
 /*!
 
@@ -51,7 +118,28 @@ void chb_init()
 {
     memset(&pcb, 0, sizeof(chb_pcb_t));
     pcb.src_addr = chb_get_short_addr();
+    memset(dupes, 0xFF, sizeof(dupes));
+    chb_buf_init();
     chb_drvr_init();
+
+#ifdef CFG_CHIBI_ADAPTIVE
+    // the radio starts with the chip defaults
+    tune_retries = CHB_MAX_FRAME_RETRIES;
+    tune_csma = CHB_MAX_CSMA_RETRIES;
+    tune_be = (CHB_MAX_BE << CHB_MAX_BE_POS) | CHB_MIN_BE;
+    tune_pwr = 0;
+    for (tune_pwr_base=0; tune_pwr_base<CHB_ADAPT_PWR_LEVELS; tune_pwr_base++)
+    {
+        if (tune_pwr_table[tune_pwr_base] == CFG_CHIBI_POWER)
+        {
+            break;
+        }
+    }
+#if CHB_CC1190_PRESENT
+    // the external amplifier sets its own power
+    tune_pwr_base = CHB_ADAPT_PWR_LEVELS;
+#endif
+#endif
 }
 
 /**************************************************************************/
@@ -70,7 +158,7 @@ chb_pcb_t *chb_get_pcb()
     Returns the length of the hdr. 
 */
 /**************************************************************************/
-static U8 chb_gen_hdr(U8 *hdr, U16 addr, U8 len)
+U8 chb_gen_hdr(U8 *hdr, U16 addr, U8 len)
 {
     U8 *hdr_ptr = hdr;
 
@@ -80,7 +168,7 @@ static U8 chb_gen_hdr(U8 *hdr, U16 addr, U8 len)
 
     // use default fcf byte 0 val but test for ack request. we won't request
     // ack if broadcast. all other cases we will.
-    *hdr_ptr++ = CHB_FCF_BYTE_0 | ((addr != 0xFFFF) << CHB_ACK_REQ_POS);
+    *hdr_ptr++ = CHB_FCF_BYTE_0 | ((addr != CHB_BROADCAST) << CHB_ACK_REQ_POS);
     *hdr_ptr++ = CHB_FCF_BYTE_1;
 
     *hdr_ptr++ = pcb.seq++;
@@ -97,14 +185,451 @@ static U8 chb_gen_hdr(U8 *hdr, U16 addr, U8 len)
     return hdr_ptr - hdr;
 }
 
+#if CFG_CHIBI_LINKSTATS > 0
+/**************************************************************************/
+/*!
+    Returns the stats entry for addr, taking over the one that was used
+    least recently if it's a new neighbour and the table is full
+*/
+/**************************************************************************/
+static chb_link_t *chb_link_find(U16 addr)
+{
+    U8 i, oldest = 0;
+    chb_link_t *link;
+
+    for (i=0; i<link_cnt; i++)
+    {
+        if (links[i].addr == addr)
+        {
+            links[i].last = systickGetTicks();
+            return &links[i];
+        }
+        if ((links[i].last - links[oldest].last) & 0x80000000)
+        {
+            oldest = i;
+        }
+    }
+
+    link = (link_cnt < CFG_CHIBI_LINKSTATS) ? &links[link_cnt++] : &links[oldest];
+    memset(link, 0, sizeof(chb_link_t));
+    link->addr = addr;
+    link->last = systickGetTicks();
+    return link;
+}
+
+/**************************************************************************/
+/*!
+    Running average (7/8 old, 1/8 new). The first sample is taken as is.
+*/
+/**************************************************************************/
+static U16 chb_link_avg(U16 avg, U16 val, U16 samples)
+{
+    return samples ? (U16)(((U32)avg * 7 + val) / 8) : val;
+}
+
+/**************************************************************************/
+/*!
+    Number of neighbours in the link stats table
+*/
+/**************************************************************************/
+U8 chb_link_count()
+{
+    return link_cnt;
+}
+
+/**************************************************************************/
+/*!
+    Returns entry 'index' of the link stats table, or NULL
+*/
+/**************************************************************************/
+const chb_link_t *chb_link_get(U8 index)
+{
+    return (index < link_cnt) ? &links[index] : NULL;
+}
+
+/**************************************************************************/
+/*!
+    Clears the link stats table
+*/
+/**************************************************************************/
+void chb_link_clear()
+{
+    // a single byte store, the isr sees either the old table or none
+    link_cnt = 0;
+}
+#endif
+
+#ifdef CFG_CHIBI_ADAPTIVE
+/**************************************************************************/
+/*!
+    Update the delivery, channel access and power figures of a link with
+    the status of a frame sent to it (before the counters are updated)
+*/
+/**************************************************************************/
+static void chb_link_adapt(chb_link_t *link, U8 status)
+{
+    U16 sent = link->tx_success + link->tx_noack + link->tx_channel_fail;
+    bool ok = (status == CHB_SUCCESS) || (status == CHB_SUCCESS_DATA_PENDING);
+    U8 max_pwr = (tune_pwr_base < CHB_ADAPT_PWR_LEVELS) ? CHB_ADAPT_PWR_LEVELS - 1 - tune_pwr_base : 0;
+
+    // a frame that never got on the air says nothing about the link itself
+    if (status != CHB_CHANNEL_ACCESS_FAILURE)
+    {
+        link->pdr = chb_link_avg(link->pdr, ok ? 255 : 0, link->tx_success + link->tx_noack);
+    }
+    link->busy = chb_link_avg(link->busy, (status == CHB_CHANNEL_ACCESS_FAILURE) ? 255 : 0, sent);
+
+    // back up at once when a frame gets lost, down one step at a time
+    // while the link stays reliable and the node is heard loud and clear
+    if (status == CHB_NO_ACK)
+    {
+        if (link->pwr)
+        {
+            link->pwr--;
+        }
+    }
+    else if (ok && !((sent + 1) % CHB_ADAPT_SAMPLES) && (link->pdr >= CHB_ADAPT_PDR_GOOD) &&
+             (link->ed >= CHB_ADAPT_ED_STRONG) && (link->pwr < max_pwr))
+    {
+        link->pwr++;
+    }
+}
+
 /**************************************************************************/
 /*!
+    Set the retries, CSMA backoff and tx power for a frame to addr (called
+    by chb_tx_start). Broadcasts and nodes without enough history get the
+    defaults. Registers are only written when something changes.
+*/
+/**************************************************************************/
+void chb_link_tune(U16 addr)
+{
+    U8 i, be, retries = CHB_MAX_FRAME_RETRIES, csma = CHB_MAX_CSMA_RETRIES;
+    U8 min_be = CHB_MIN_BE, max_be = CHB_MAX_BE, pwr = 0;
+    chb_link_t *link = NULL;
+
+    // only look the node up: a new entry is made when the frame is done
+    for (i=0; (addr != CHB_BROADCAST) && (i<link_cnt); i++)
+    {
+        if (links[i].addr == addr)
+        {
+            link = &links[i];
+            break;
+        }
+    }
+
+    if (link && (link->tx_success + link->tx_noack + link->tx_channel_fail >= CHB_ADAPT_SAMPLES))
+    {
+        if (link->pdr >= CHB_ADAPT_PDR_GOOD)
+        {
+            retries = 1;
+        }
+        else if (link->pdr < CHB_ADAPT_PDR_POOR)
+        {
+            retries = 7;
+        }
 
+        if (link->busy < CHB_ADAPT_BUSY_LOW)
+        {
+            min_be = 2;
+            max_be = 4;
+            csma = 3;
+        }
+        else if (link->busy >= CHB_ADAPT_BUSY_HIGH)
+        {
+            min_be = 4;
+            max_be = 6;
+            csma = 5;
+        }
+        pwr = link->pwr;
+    }
+
+    if ((retries != tune_retries) || (csma != tune_csma))
+    {
+        chb_set_retries(retries, csma);
+        tune_retries = retries;
+        tune_csma = csma;
+    }
+    be = (max_be << CHB_MAX_BE_POS) | min_be;
+    if (be != tune_be)
+    {
+        chb_set_be(min_be, max_be);
+        tune_be = be;
+    }
+    if ((pwr != tune_pwr) && (tune_pwr_base < CHB_ADAPT_PWR_LEVELS))
+    {
+        chb_set_pwr(tune_pwr_table[tune_pwr_base + pwr]);
+        tune_pwr = pwr;
+    }
+}
+#endif
+
+/**************************************************************************/
+/*!
+    Update the transmit stats for a completed frame to addr
+*/
+/**************************************************************************/
+static void chb_tx_stats(U16 addr, U8 status)
+{
+#if CFG_CHIBI_LINKSTATS > 0
+    chb_link_t *link = chb_link_find(addr);
+    U16 sent = link->tx_success + link->tx_noack + link->tx_channel_fail;
+
+    // frames the radio refused (CHB_INVALID) never went on the air
+    if (status != CHB_INVALID)
+    {
+        link->tx_us = chb_link_avg(link->tx_us, (pcb.tx_us > 0xFFFF) ? 0xFFFF : pcb.tx_us, sent);
+#ifdef CFG_CHIBI_ADAPTIVE
+        if (addr != CHB_BROADCAST)
+        {
+            chb_link_adapt(link, status);
+        }
+#endif
+    }
+#endif
+
+    switch (status)
+    {
+    case CHB_SUCCESS:
+        // fall through
+    case CHB_SUCCESS_DATA_PENDING:
+        pcb.txd_success++;
+#if CFG_CHIBI_LINKSTATS > 0
+        link->tx_success++;
+#endif
+        break;
+
+    case CHB_NO_ACK:
+        pcb.txd_noack++;
+#if CFG_CHIBI_LINKSTATS > 0
+        link->tx_noack++;
+#endif
+        break;
+
+    case CHB_CHANNEL_ACCESS_FAILURE:
+        pcb.txd_channel_fail++;
+#if CFG_CHIBI_LINKSTATS > 0
+        link->tx_channel_fail++;
+#endif
+        break;
+
+    default:
+        break;
+    }
+}
+
+#if CFG_CHIBI_TXQUEUE > 0
+/**************************************************************************/
+/*!
+    Remove the frame at the head of the queue. Reports the status once the
+    last fragment of a write is done or as soon as one fragment fails (the
+    rest of the write is dropped).
+*/
+/**************************************************************************/
+static void chb_tx_pop(U8 status)
+{
+    chb_tx_frame_t *frm;
+    bool ok = (status == CHB_SUCCESS) || (status == CHB_SUCCESS_DATA_PENDING);
+
+    frm = &tx_queue[tx_head];
+    chb_tx_stats(frm->hdr[6] | (frm->hdr[7] << 8), status);
+
+    // pop the frame, and the remaining fragments of the write if it failed
+    do
+    {
+        frm = &tx_queue[tx_head];
+        tx_head = (tx_head + 1) % CFG_CHIBI_TXQUEUE;
+        tx_state--;
+    } while (!ok && frm->more && (tx_state & CHB_TXQ_COUNT));
+
+    if ((!ok || !frm->more) && frm->cb)
+    {
+        frm->cb(status, frm->arg);
+    }
+}
+
+/**************************************************************************/
+/*!
+    Start sending the frame at the head of the queue. If the radio refuses
+    it, complete it (and the rest of its write) with CHB_INVALID and try
+    the next one. Must be called with CHB_TXQ_BUSY set.
+*/
+/**************************************************************************/
+static void chb_tx_next()
+{
+    chb_tx_frame_t *frm;
+    U32 state;
+
+    while (tx_state & CHB_TXQ_COUNT)
+    {
+        frm = &tx_queue[tx_head];
+        if (chb_tx_start(frm->hdr, frm->data, frm->len) == RADIO_SUCCESS)
+        {
+            return;
+        }
+        chb_tx_pop(CHB_INVALID);
+    }
+
+    // only go idle if nothing was queued in the meantime (a completion
+    // callback can queue more from the isr while this runs from
+    // chb_write_async)
+    do
+    {
+        state = __LDREXW(&tx_state);
+        if (state & CHB_TXQ_COUNT)
+        {
+            __CLREX();
+            chb_tx_next();
+            return;
+        }
+    } while (__STREXW(state & ~CHB_TXQ_BUSY, &tx_state));
+}
+
+/**************************************************************************/
+/*!
+    Called from chb_ISR_Handler when a queued frame has been sent (or has
+    failed). Completes the frame and starts the next one.
+*/
+/**************************************************************************/
+void chb_tx_done(U8 status)
+{
+    chb_tx_frame_t *frm;
+
+    if (!(tx_state & CHB_TXQ_BUSY) || !(tx_state & CHB_TXQ_COUNT))
+    {
+        return;
+    }
+
+    // broadcasts aren't acked, so they go out more than once (with the
+    // same seq so that receivers drop the extra copies)
+    frm = &tx_queue[tx_head];
+    if (frm->repeat && (status == CHB_SUCCESS))
+    {
+        frm->repeat--;
+        chb_tx_next();
+        return;
+    }
+
+    chb_tx_pop(status);
+    chb_tx_next();
+}
+
+/**************************************************************************/
+/*!
+    Number of free frame slots in the transmit queue (each holds up to
+    CHB_MAX_PAYLOAD bytes)
+*/
+/**************************************************************************/
+U8 chb_tx_queue_free()
+{
+    return CFG_CHIBI_TXQUEUE - (tx_state & CHB_TXQ_COUNT);
+}
+
+/**************************************************************************/
+/*!
+    Queue data for transmission and return immediately. The data is copied
+    so the caller's buffer can be reused straight away. Writes longer than
+    CHB_MAX_PAYLOAD are split into several frames, which all have to fit in
+    the queue. cb (which can be NULL) is called from the radio interrupt
+    once the write has been sent or has failed.
+
+    Returns CHB_SUCCESS if the data was queued or CHB_INVALID if there
+    isn't enough room in the queue.
+*/
+/**************************************************************************/
+U8 chb_write_async(U16 addr, U8 *data, U8 len, chb_tx_cb_t cb, void *arg)
+{
+    U8 i, frm_len, frames, tail;
+    chb_tx_frame_t *frm;
+    U32 state;
+
+    frames = (len + CHB_MAX_PAYLOAD - 1) / CHB_MAX_PAYLOAD;
+    if (!frames || (frames > chb_tx_queue_free()))
+    {
+        return CHB_INVALID;
+    }
+
+    // fill the free slots after the tail. only this function adds frames,
+    // so the ISR can't touch them until tx_state includes them.
+    tail = (tx_head + (tx_state & CHB_TXQ_COUNT)) % CFG_CHIBI_TXQUEUE;
+    for (i=0; i<frames; i++)
+    {
+        frm = &tx_queue[(tail + i) % CFG_CHIBI_TXQUEUE];
+        frm_len = (len > CHB_MAX_PAYLOAD) ? CHB_MAX_PAYLOAD : len;
+        chb_gen_hdr(frm->hdr, addr, frm_len);
+        memcpy(frm->data, data, frm_len);
+        frm->len = frm_len;
+        frm->more = (i != frames - 1);
+        frm->repeat = (addr == CHB_BROADCAST) ? CFG_CHIBI_BCAST_REPEAT - 1 : 0;
+        frm->cb = cb;
+        frm->arg = arg;
+        data += frm_len;
+        len -= frm_len;
+    }
+
+    // add the frames and mark the queue busy in one go. if the isr
+    // completes a frame in between, the store fails and we try again.
+    do
+    {
+        state = __LDREXW(&tx_state);
+    } while (__STREXW((state + frames) | CHB_TXQ_BUSY, &tx_state));
+
+    // nothing on the air: kick off the first frame ourselves. otherwise
+    // chb_tx_done will get to it.
+    if (!(state & CHB_TXQ_BUSY))
+    {
+        chb_tx_next();
+    }
+    return CHB_SUCCESS;
+}
+
+/**************************************************************************/
+/*!
+    Completion callback used by the blocking chb_write
+*/
+/**************************************************************************/
+static void chb_write_done(U8 status, void *arg)
+{
+    *(volatile U8 *)arg = status;
+}
+
+/**************************************************************************/
+/*!
+    Blocking write: queue the data and wait until it has been sent.
+    Returns the status of the transmission.
 */
 /**************************************************************************/
 U8 chb_write(U16 addr, U8 *data, U8 len)
 {
-    U8 status, frm_len, hdr_len, hdr[CHB_HDR_SZ + 1];
+    volatile U8 status = 0xFF;
+
+    if (!len)
+    {
+        return CHB_SUCCESS;
+    }
+
+    // wait for a turn in the queue, then for the write to complete
+    while (chb_write_async(addr, data, len, chb_write_done, (void *)&status) != CHB_SUCCESS)
+    {
+        if ((len + CHB_MAX_PAYLOAD - 1) / CHB_MAX_PAYLOAD > CFG_CHIBI_TXQUEUE)
+        {
+            // this write will never fit
+            return CHB_INVALID;
+        }
+    }
+    while (status == 0xFF);
+
+    return status;
+}
+#else
+/**************************************************************************/
+/*!
+
+*/
+/**************************************************************************/
+U8 chb_write(U16 addr, U8 *data, U8 len)
+{
+    U8 i, status, frm_len, hdr_len, hdr[CHB_HDR_SZ + 1];
     
     while (len > 0)
     {
@@ -115,115 +640,191 @@ U8 chb_write(U16 addr, U8 *data, U8 len)
         // gen frame header
         hdr_len = chb_gen_hdr(hdr, addr, frm_len);
 
-        // send data to chip
-        status = chb_tx(hdr, data, frm_len);
+        // send data to chip. broadcasts aren't acked, so they go out more
+        // than once (with the same seq so that receivers drop the extras)
+        i = (addr == CHB_BROADCAST) ? CFG_CHIBI_BCAST_REPEAT : 1;
+        do
+        {
+            status = chb_tx(hdr, data, frm_len);
+        } while (--i && (status == CHB_SUCCESS));
+        chb_tx_stats(addr, status);
     
-        if (status != CHB_SUCCESS)
+        if ((status != CHB_SUCCESS) && (status != CHB_SUCCESS_DATA_PENDING))
         {
-            switch (status)
-            {
-            case RADIO_SUCCESS:
-                // fall through
-            case CHB_SUCCESS_DATA_PENDING:
-                pcb.txd_success++;
-                break;
-
-            case CHB_NO_ACK:
-                pcb.txd_noack++;
-                break;
-
-            case CHB_CHANNEL_ACCESS_FAILURE:
-                pcb.txd_channel_fail++;
-                break;
-
-            default:
-                break;
-            }
             return status;
         }
 
         // adjust len and restart
+        data += frm_len;
         len = len - frm_len;
     }
     return CHB_SUCCESS;
 }
+#endif
 
 /**************************************************************************/
 /*!
-    Read data from the buffer. Need to pass in a buffer of at leasts max frame
-    size and two 16-bit containers for the src and dest addresses.
+    Returns the oldest received frame without copying it, or NULL if there
+    isn't one. The frame stays valid, and is returned again by the next
+    call, until it's handed back with chb_free_frame.
  
-    The read function will automatically populate the addresses and the data with
-    the frm payload. It will then return the len of the payload.
+    The header is parsed in place: src_addr, dest_addr and len are filled in
+    and data points to the payload. Duplicate frames (retries of the last
+    frame we got from the same node) are dropped. In promiscuous mode data
+    points to the full raw frame instead and nothing gets dropped.
 */
 /**************************************************************************/
-U8 chb_read(chb_rx_data_t *rx)
+chb_rx_frame_t *chb_read_frame()
 {
-    U8 i, len, seq, *data_ptr;
-
-    data_ptr = rx->data;
+    chb_rx_frame_t *frm;
 
-    // first byte is always len. check it to make sure 
-    // we have a valid len byte.
-    if ((len = chb_buf_read()) > CHB_MAX_FRAME_LENGTH)
+    while ((frm = chb_buf_peek()) != NULL)
     {
-        return 0;
+        // already parsed by a previous call
+        if (frm->data)
+        {
+            return frm;
+        }
+
+        // parse the dest and src addresses
+        frm->dest_addr = frm->frm[5] | (frm->frm[6] << 8);
+        frm->src_addr = frm->frm[7] | (frm->frm[8] << 8);
+
+#if (CFG_CHIBI_PROMISCUOUS == 1)
+        // if we're in promiscuous mode, we don't want to do any duplicate rejection and we want to 
+        // capture the full frame so just point at the frame and return it.
+        frm->len = frm->frm_len;
+        frm->data = frm->frm;
+        return frm;
+#else
+        // frames that are too short to hold our header can't be ours
+        if (frm->frm_len < CHB_HDR_SZ + CHB_FCS_LEN)
+        {
+            chb_free_frame(frm);
+            continue;
+        }
+
+        // duplicate frame check (dupe check). we want to remove frames that have been already been received since they 
+        // are just retries (or repeated broadcasts). the last seq of the CFG_CHIBI_DUPCACHE most recent senders is
+        // kept, so frames from other nodes can come in between the dupes.
+        U8 i, seq = frm->frm[2];
+        bool dupe = false;
+
+        for (i=0; i<CFG_CHIBI_DUPCACHE; i++)
+        {
+            if (dupes[i].src_addr == frm->src_addr)
+            {
+                break;
+            }
+        }
+        if (i < CFG_CHIBI_DUPCACHE)
+        {
+            dupe = (dupes[i].seq == seq);
+        }
+        else
+        {
+            // new sender: take over the oldest entry
+            i = dupe_idx;
+            dupe_idx = (dupe_idx + 1) % CFG_CHIBI_DUPCACHE;
+            dupes[i].src_addr = frm->src_addr;
+        }
+
+#if CFG_CHIBI_LINKSTATS > 0
+        // the table is shared with the tx completion in the radio isr
+        CHB_ENTER_CRIT();
+        chb_link_t *link = chb_link_find(frm->src_addr);
+        if (dupe)
+        {
+            link->rx_dupes++;
+        }
+        else
+        {
+            link->ed = chb_link_avg(link->ed, frm->ed, link->rx_frames);
+            link->lqi = chb_link_avg(link->lqi, frm->lqi, link->rx_frames);
+            link->rx_frames++;
+        }
+        CHB_LEAVE_CRIT();
+#endif
+
+        if (dupe)
+        {
+            // this is a duplicate frame from a retry. the remote node thinks we didn't receive 
+            // it properly. discard.
+            chb_free_frame(frm);
+            continue;
+        }
+        dupes[i].seq = seq;
+
+        frm->len = frm->frm_len - CHB_HDR_SZ - CHB_FCS_LEN;
+        frm->data = frm->frm + CHB_HDR_SZ;
+        return frm;
+#endif
     }
-    *data_ptr++ = len;
 
-    // load the rest of the data into buffer
-    for (i=0; i<len; i++)
+    // nothing left (or only duplicates). clear the rx flag.
+    chb_free_frame(NULL);
+    return NULL;
+}
+
+/**************************************************************************/
+/*!
+    Hands a frame returned by chb_read_frame back to the receive buffer
+    (NULL just updates the rx flag)
+*/
+/**************************************************************************/
+void chb_free_frame(chb_rx_frame_t *frm)
+{
+    if (frm && (frm == chb_buf_peek()))
     {
-        *data_ptr++ = chb_buf_read();
+        chb_buf_release();
     }
 
-    // we're using the buffer that's fed in as an argument as a temp
-    // buffer as well to save resources.
-    // we'll use it as temp storage to parse the frame. then move the frame
-    // down so that only the payload will be in the buffer.
+    // if the rx buf is empty, then clear the rx flag. otherwise, keep it raised.
+    // clear it before looking so that a frame the isr adds in between raises
+    // it again rather than being missed.
+    eventClear(&pcb.events, CHB_EVENT_DATA_RCV);
+    if (chb_buf_get_count())
+    {
+        eventSet(&pcb.events, CHB_EVENT_DATA_RCV);
+    }
+}
 
-    // extract the sequence number
-    data_ptr = rx->data + 3;    // location of sequence number
-    seq = *data_ptr;
+/**************************************************************************/
+/*!
+    Read data from the buffer. Need to pass in a buffer of at leasts max frame
+    size and two 16-bit containers for the src and dest addresses.
+ 
+    The read function will automatically populate the addresses and the data with
+    the frm payload. It will then return the len of the payload.
 
-    // parse the buffer and extract the dest and src addresses
-    data_ptr = rx->data + 6;                // location of dest addr
-    rx->dest_addr = *(U16 *)data_ptr;
-    data_ptr += sizeof(U16);
-    rx->src_addr = *(U16 *)data_ptr;
-    data_ptr += sizeof(U16);
+    This copies the frame out of the receive buffer. Use chb_read_frame and
+    chb_free_frame to process frames in place.
+*/
+/**************************************************************************/
+U8 chb_read(chb_rx_data_t *rx)
+{
+    U8 len;
+    chb_rx_frame_t *frm;
 
-    // if the data in the rx buf is 0, then clear the rx_flag. otherwise, keep it raised
-    if (!chb_buf_get_len())
+    if ((frm = chb_read_frame()) == NULL)
     {
-        pcb.data_rcv = false;
+        return 0;
     }
 
+    rx->src_addr = frm->src_addr;
+    rx->dest_addr = frm->dest_addr;
+    pcb.ed = frm->ed;
+
 #if (CFG_CHIBI_PROMISCUOUS == 1)
-    // if we're in promiscuous mode, we don't want to do any duplicate rejection and we don't want to move the payload
-    // to the front of the buffer. We want to capture the full frame so just keep the frame intact and return the length.
-    return len;
+    // in promiscuous mode keep the full frame, preceded by its length byte
+    len = (frm->len < sizeof(rx->data)) ? frm->len : sizeof(rx->data) - 1;
+    rx->data[0] = frm->len;
+    memcpy(rx->data + 1, frm->data, len);
 #else
-    // duplicate frame check (dupe check). we want to remove frames that have been already been received since they 
-    // are just retries. 
-    // note: this dupe check only removes duplicate frames from the previous transfer. if another frame from a different
-    // node comes in between the dupes, then the dupe will show up as a received frame.
-    if ((seq == prev_seq) && (rx->src_addr == prev_src_addr))
-    {
-        // this is a duplicate frame from a retry. the remote node thinks we didn't receive 
-        // it properly. discard.
-        return 0;
-    }
-    else
-    {
-        prev_seq = seq;
-        prev_src_addr = rx->src_addr;
-    }
-
-    // move the payload down to the beginning of the data buffer
-    memmove(rx->data, data_ptr, len - CHB_HDR_SZ);
-    // finally, return the len of the payload
-    return len - CHB_HDR_SZ - CHB_FCS_LEN;
+    len = (frm->len <= sizeof(rx->data)) ? frm->len : sizeof(rx->data);
+    memcpy(rx->data, frm->data, len);
 #endif
-}
 
+    chb_free_frame(frm);
+    return len;
+}
@@ -35,10 +35,13 @@
 #define CHIBI_H
 
 #include "types.h"
+#include "projectconfig.h"
 
 #define CHB_HDR_SZ        9    // FCF + seq + pan_id + dest_addr + src_addr (2 + 1 + 2 + 2 + 2)
 #define CHB_FCS_LEN       2
 #define CHB_MAX_PAYLOAD   100
+#define CHB_MAX_FRAME_SZ  127  // largest 802.15.4 frame (PSDU) the radio can receive
+#define CHB_BROADCAST     0xFFFF // dest addr of frames for every node (sent without ack)
 
 
 // frame_type = data
@@ -61,16 +64,20 @@ enum
     CHB_SUCCESS_DATA_PENDING    = 1,
     CHB_CHANNEL_ACCESS_FAILURE  = 3,
     CHB_NO_ACK                  = 5,
-    CHB_INVALID                 = 7
+    CHB_INVALID                 = 7,
+    CHB_NO_ROUTE                = 8     // chb_route.c: no route known yet
 };
 
+// pcb events flags, set by the radio isr (see core/sched/event.c)
+#define CHB_EVENT_DATA_RCV  (1 << 0)    // frames are waiting in the rx buffer
+#define CHB_EVENT_TX_END    (1 << 1)    // the transmission has ended
+
 // Chibi Protocol control block
 typedef struct
 {
     U16 src_addr;
     U8 seq;
-    volatile bool data_rcv;
-    volatile bool tx_end;
+    volatile U32 events;        // CHB_EVENT_...
 
     // stats
     U16 rcvd_xfers;
@@ -82,8 +89,30 @@ typedef struct
     U8 battlow;
     U8 ed;
     U8 crc;
+    U32 tx_us;                  // how long the last transmission took
+    U32 tx_end_us;              // chb_time_us when it ended
 } chb_pcb_t;
 
+// per-neighbour link statistics (see chb_link_get)
+typedef struct
+{
+    U16 addr;
+    U16 tx_success;
+    U16 tx_noack;
+    U16 tx_channel_fail;
+    U16 rx_frames;
+    U16 rx_dupes;               // retries of frames we had already received
+    U16 tx_us;                  // average transmit time (csma, retries and ack)
+    U8 ed;                      // average energy detect level of its frames
+    U8 lqi;                     // average link quality of its frames
+#ifdef CFG_CHIBI_ADAPTIVE
+    U8 pdr;                     // recent frames that were acked (255 = all)
+    U8 busy;                    // recent frames that failed channel access (255 = all)
+    U8 pwr;                     // tx power steps below CFG_CHIBI_POWER
+#endif
+    U32 last;                   // systick tick of the last tx/rx
+} chb_link_t;
+
 typedef struct
 {
     U8 len;
@@ -92,9 +121,49 @@ typedef struct
     U8 data[CHB_MAX_PAYLOAD];
 } chb_rx_data_t;
 
+// received frame slot. the radio isr fills in the first four fields and
+// the raw frame, chb_read_frame parses the rest in place.
+typedef struct
+{
+    U32 timestamp;              // systick tick when the frame arrived
+                                // (chb_time_us at the start of the frame
+                                // with CFG_CHIBI_TIMESTAMP or
+                                // CFG_CHIBI_TSYNC)
+    U8 frm_len;                 // length of the raw frame (hdr + payload + fcs)
+    U8 lqi;
+    U8 ed;
+    U8 len;                     // payload len
+    U16 src_addr;
+    U16 dest_addr;
+    U8 *data;                   // payload (points into frm, NULL until parsed)
+    U8 frm[CHB_MAX_FRAME_SZ];
+} chb_rx_frame_t;
+
+// Transmit completion callback (called from chb_ISR_Handler with the
+// CHB_SUCCESS/CHB_NO_ACK/... status of the write)
+typedef void (*chb_tx_cb_t)(U8 status, void *arg);
+
 void chb_init();
 chb_pcb_t *chb_get_pcb();
+U8 chb_gen_hdr(U8 *hdr, U16 addr, U8 len);
+
+#if CFG_CHIBI_LINKSTATS > 0
+U8 chb_link_count();
+const chb_link_t *chb_link_get(U8 index);
+void chb_link_clear();
+#endif
+#ifdef CFG_CHIBI_ADAPTIVE
+void chb_link_tune(U16 addr);
+#endif
 U8 chb_write(U16 addr, U8 *data, U8 len);
 U8 chb_read(chb_rx_data_t *rx);
+chb_rx_frame_t *chb_read_frame();
+void chb_free_frame(chb_rx_frame_t *frm);
+
+#if CFG_CHIBI_TXQUEUE > 0
+U8 chb_write_async(U16 addr, U8 *data, U8 len, chb_tx_cb_t cb, void *arg);
+U8 chb_tx_queue_free();
+void chb_tx_done(U8 status);
+#endif
 
 #endif
@@ -0,0 +1,376 @@
+/**************************************************************************/
+/*! 
+    @file     chb_aggr.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Aggregation of small messages on top of chb.c.
+
+    Every frame pays for the MAC header, the FCS, the CSMA backoff and
+    the ack turnaround, which costs far more airtime than a few bytes
+    of telemetry.  chb_aggr_write collects the messages for the same
+    destination in one of CFG_CHIBI_AGGR_SLOTS frame buffers, and the
+    frame is only sent when the next message doesn't fit any more or
+    when the oldest message in it has waited CFG_CHIBI_AGGR_LATENCYMS.
+
+    An aggregated frame is CHB_AGGR_DATA followed by the messages, each
+    one preceded by its length.  The receiver passes frames to
+    chb_aggr_rx, which calls the rx callback once per message.
+
+    The messages are sent without waiting and the transmit status isn't
+    reported per message, so this is meant for periodic data where the
+    next reading replaces a lost one.  With CFG_SCHEDULER the latency
+    timer runs by itself, otherwise chb_aggr_poll has to be called
+    regularly (more often than CFG_CHIBI_AGGR_LATENCYMS).
+
+    @section Example
+
+    @code 
+    // send a reading, it leaves within CFG_CHIBI_AGGR_LATENCYMS
+    chb_aggr_write(0x1234, reading, sizeof(reading));
+
+    // in the receive loop
+    chb_rx_frame_t *frm;
+    while ((frm = chb_read_frame()) != NULL)
+    {
+        if (!chb_aggr_rx(frm))
+        {
+            // not an aggregated frame, handle it here
+        }
+        chb_free_frame(frm);
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "chb_aggr.h"
+
+#include "core/systick/systick.h"
+
+#ifdef CFG_SCHEDULER
+    #include "core/sched/sched.h"
+#endif
+
+#define CHB_AGGR_TICKS(ms)  ((ms) / CFG_SYSTICK_DELAY_IN_MS)
+
+// frame being collected for one destination
+typedef struct
+{
+    bool used;
+    U16 addr;
+    U8 len;                     // bytes in frm, including the type byte
+    U32 first_tick;             // when the oldest message was added
+    U8 frm[CHB_MAX_PAYLOAD];
+} chb_aggr_slot_t;
+
+static chb_aggr_slot_t slots[CFG_CHIBI_AGGR_SLOTS];
+static chb_aggr_rx_cb_t aggr_rx_cb = NULL;
+
+#ifdef CFG_SCHEDULER
+static schedTask_t aggr_task;
+static bool aggr_timer = false;
+#endif
+
+/**************************************************************************/
+/*!
+    Send the frame in a slot. If 'wait' is false and the transmit queue
+    is full, the frame stays in the slot and false is returned.
+*/
+/**************************************************************************/
+static bool chb_aggr_send(chb_aggr_slot_t *slot, bool wait)
+{
+#if CFG_CHIBI_TXQUEUE > 0
+    if (chb_write_async(slot->addr, slot->frm, slot->len, NULL, NULL) != CHB_SUCCESS)
+    {
+        if (!wait)
+        {
+            return false;
+        }
+        chb_write(slot->addr, slot->frm, slot->len);
+    }
+#else
+    chb_write(slot->addr, slot->frm, slot->len);
+#endif
+    slot->used = false;
+    return true;
+}
+
+#ifdef CFG_SCHEDULER
+/**************************************************************************/
+/*!
+    Arm the latency timer for the oldest frame, if it isn't running yet
+*/
+/**************************************************************************/
+static void chb_aggr_arm()
+{
+    U8 i;
+    U32 age, oldest = 0;
+    bool pending = false;
+    U32 now = systickGetTicks();
+
+    if (aggr_timer)
+    {
+        return;
+    }
+
+    for (i=0; i<CFG_CHIBI_AGGR_SLOTS; i++)
+    {
+        if (slots[i].used)
+        {
+            age = now - slots[i].first_tick;
+            if (!pending || (age > oldest))
+            {
+                oldest = age;
+            }
+            pending = true;
+        }
+    }
+
+    if (pending)
+    {
+        age = oldest * CFG_SYSTICK_DELAY_IN_MS;
+        schedStartTimer(&aggr_task, (age < CFG_CHIBI_AGGR_LATENCYMS) ? CFG_CHIBI_AGGR_LATENCYMS - age : 1, 0);
+        aggr_timer = true;
+    }
+}
+
+/**************************************************************************/
+/*!
+    Scheduler task: send the frames that have waited long enough
+*/
+/**************************************************************************/
+static void chb_aggr_task(schedTask_t *task)
+{
+    aggr_timer = false;
+    chb_aggr_poll();
+}
+#endif
+
+/**************************************************************************/
+/*!
+    Initialise the aggregation layer
+
+    @param[in]  rx_cb
+                Called with each message of incoming aggregated frames
+                (can be NULL if this node only sends)
+*/
+/**************************************************************************/
+void chb_aggr_init(chb_aggr_rx_cb_t rx_cb)
+{
+    memset(slots, 0, sizeof(slots));
+    aggr_rx_cb = rx_cb;
+
+#ifdef CFG_SCHEDULER
+    schedTaskInit(&aggr_task, chb_aggr_task, NULL);
+    aggr_timer = false;
+#endif
+}
+
+/**************************************************************************/
+/*!
+    Queue a message for another node. It is sent together with the other
+    messages for the same node, within CFG_CHIBI_AGGR_LATENCYMS.
+
+    Returns CHB_SUCCESS, or CHB_INVALID if the message is longer than
+    CHB_AGGR_MAX_MSG.
+*/
+/**************************************************************************/
+U8 chb_aggr_write(U16 addr, const U8 *data, U8 len)
+{
+    U8 i;
+    chb_aggr_slot_t *slot = NULL, *oldest = NULL;
+    U32 now = systickGetTicks();
+
+    if (!len || (len > CHB_AGGR_MAX_MSG))
+    {
+        return CHB_INVALID;
+    }
+
+    for (i=0; i<CFG_CHIBI_AGGR_SLOTS; i++)
+    {
+        if (slots[i].used && (slots[i].addr == addr))
+        {
+            slot = &slots[i];
+            break;
+        }
+    }
+
+    // no room left in this frame: send it and start a new one
+    if (slot && (slot->len + 1 + len > CHB_MAX_PAYLOAD))
+    {
+        chb_aggr_send(slot, true);
+    }
+
+    if (!slot || !slot->used)
+    {
+        slot = NULL;
+        for (i=0; i<CFG_CHIBI_AGGR_SLOTS; i++)
+        {
+            if (!slots[i].used)
+            {
+                slot = &slots[i];
+                break;
+            }
+            if (!oldest || ((now - slots[i].first_tick) > (now - oldest->first_tick)))
+            {
+                oldest = &slots[i];
+            }
+        }
+
+        // all slots hold frames for other nodes: the oldest one goes now
+        if (!slot)
+        {
+            slot = oldest;
+            chb_aggr_send(slot, true);
+        }
+
+        slot->used = true;
+        slot->addr = addr;
+        slot->frm[0] = CHB_AGGR_DATA;
+        slot->len = CHB_AGGR_HDR_SZ;
+        slot->first_tick = now;
+    }
+
+    slot->frm[slot->len++] = len;
+    memcpy(&slot->frm[slot->len], data, len);
+    slot->len += len;
+
+    // not even a one byte message would fit any more
+    if (slot->len + 2 > CHB_MAX_PAYLOAD)
+    {
+        chb_aggr_send(slot, false);
+    }
+
+#ifdef CFG_SCHEDULER
+    chb_aggr_arm();
+#endif
+    return CHB_SUCCESS;
+}
+
+/**************************************************************************/
+/*!
+    Send the messages collected for a node straight away
+*/
+/**************************************************************************/
+void chb_aggr_flush(U16 addr)
+{
+    U8 i;
+
+    for (i=0; i<CFG_CHIBI_AGGR_SLOTS; i++)
+    {
+        if (slots[i].used && (slots[i].addr == addr))
+        {
+            chb_aggr_send(&slots[i], true);
+        }
+    }
+}
+
+/**************************************************************************/
+/*!
+    Send everything that has been collected (before sleeping, for
+    example)
+*/
+/**************************************************************************/
+void chb_aggr_flush_all()
+{
+    U8 i;
+
+    for (i=0; i<CFG_CHIBI_AGGR_SLOTS; i++)
+    {
+        if (slots[i].used)
+        {
+            chb_aggr_send(&slots[i], true);
+        }
+    }
+}
+
+/**************************************************************************/
+/*!
+    Send the frames whose oldest message has waited for
+    CFG_CHIBI_AGGR_LATENCYMS. Without CFG_SCHEDULER this has to be
+    called regularly.
+*/
+/**************************************************************************/
+void chb_aggr_poll()
+{
+    U8 i;
+    U32 now = systickGetTicks();
+
+    for (i=0; i<CFG_CHIBI_AGGR_SLOTS; i++)
+    {
+        if (slots[i].used && ((now - slots[i].first_tick) >= CHB_AGGR_TICKS(CFG_CHIBI_AGGR_LATENCYMS)))
+        {
+            // if the transmit queue is full, try again next time
+            chb_aggr_send(&slots[i], false);
+        }
+    }
+
+#ifdef CFG_SCHEDULER
+    chb_aggr_arm();
+#endif
+}
+
+/**************************************************************************/
+/*!
+    Pass a received frame (from chb_read_frame) to the aggregation layer.
+    Returns true if it was an aggregated frame, false if it should be
+    handled by the application. The caller still frees the frame.
+*/
+/**************************************************************************/
+bool chb_aggr_rx(chb_rx_frame_t *frm)
+{
+    U8 pos, len;
+
+    if ((frm->len < CHB_AGGR_HDR_SZ) || (frm->data[0] != CHB_AGGR_DATA))
+    {
+        return false;
+    }
+
+    pos = CHB_AGGR_HDR_SZ;
+    while (pos < frm->len)
+    {
+        len = frm->data[pos++];
+        if (!len || (pos + len > frm->len))
+        {
+            // corrupt, drop the rest
+            break;
+        }
+        if (aggr_rx_cb)
+        {
+            aggr_rx_cb(frm->src_addr, &frm->data[pos], len);
+        }
+        pos += len;
+    }
+    return true;
+}
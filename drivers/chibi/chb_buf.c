@@ -35,9 +35,11 @@
 #include "chb_buf.h"
 #include "projectconfig.h"
 
-static U8 chb_buf[CFG_CHIBI_BUFFERSIZE];
-static volatile U32 rd_ptr, wr_ptr;
-static volatile U32 len;
+// ring of frame slots. the radio isr is the only writer (wr_cnt) and the
+// application the only reader (rd_cnt), so the free running counters
+// don't need locking. frames = wr_cnt - rd_cnt.
+static chb_rx_frame_t chb_buf[CFG_CHIBI_RXSLOTS];
+static volatile U8 rd_cnt, wr_cnt;
 
 /**************************************************************************/
 /*!
@@ -46,21 +48,23 @@ static volatile U32 len;
 /**************************************************************************/
 void chb_buf_init()
 {
-    rd_ptr = 0;
-    wr_ptr = 0;
-    len = 0;
+    rd_cnt = 0;
+    wr_cnt = 0;
 }
 
 /**************************************************************************/
 /*!
-
+    Returns the next free slot for the isr to fill, or NULL if all of the
+    slots are in use. The slot only becomes visible after chb_buf_commit.
 */
 /**************************************************************************/
-void chb_buf_write(U8 data)
+chb_rx_frame_t *chb_buf_alloc()
 {
-    chb_buf[wr_ptr] = data;
-    wr_ptr = (wr_ptr + 1) % CFG_CHIBI_BUFFERSIZE;
-    len++;
+    if ((U8)(wr_cnt - rd_cnt) >= CFG_CHIBI_RXSLOTS)
+    {
+        return NULL;
+    }
+    return &chb_buf[wr_cnt % CFG_CHIBI_RXSLOTS];
 }
 
 /**************************************************************************/
@@ -68,14 +72,36 @@ void chb_buf_write(U8 data)
 
 */
 /**************************************************************************/
-U8 chb_buf_read()
+void chb_buf_commit()
+{
+    wr_cnt++;
+}
+
+/**************************************************************************/
+/*!
+    Returns the oldest received frame, or NULL if there isn't one
+*/
+/**************************************************************************/
+chb_rx_frame_t *chb_buf_peek()
 {
-    U8 data;
+    if (wr_cnt == rd_cnt)
+    {
+        return NULL;
+    }
+    return &chb_buf[rd_cnt % CFG_CHIBI_RXSLOTS];
+}
 
-    data = chb_buf[rd_ptr];
-    rd_ptr = (rd_ptr + 1) % CFG_CHIBI_BUFFERSIZE;
-    len--;
-    return data;
+/**************************************************************************/
+/*!
+    Hands the oldest frame's slot back to the isr
+*/
+/**************************************************************************/
+void chb_buf_release()
+{
+    if (wr_cnt != rd_cnt)
+    {
+        rd_cnt++;
+    }
 }
 
 /**************************************************************************/
@@ -83,7 +109,7 @@ U8 chb_buf_read()
 
 */
 /**************************************************************************/
-U32 chb_buf_get_len()
+U8 chb_buf_get_count()
 {
-    return len;
+    return wr_cnt - rd_cnt;
 }
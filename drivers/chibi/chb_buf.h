@@ -35,10 +35,13 @@
 #define CHB_BUF_H
 
 #include "types.h"
+#include "chb.h"
 
 void chb_buf_init();
-void chb_buf_write(U8 data);
-U8 chb_buf_read();
-U32 chb_buf_get_len();
+chb_rx_frame_t *chb_buf_alloc();
+void chb_buf_commit();
+chb_rx_frame_t *chb_buf_peek();
+void chb_buf_release();
+U8 chb_buf_get_count();
 
 #endif
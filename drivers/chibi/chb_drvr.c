@@ -32,6 +32,7 @@
 
 *******************************************************************/
 #include <stdio.h>
+#include <string.h>
 #include "chb.h"
 #include "chb_drvr.h"
 #include "chb_buf.h"
@@ -39,11 +40,41 @@
 #include "chb_eeprom.h"
 
 #include "core/systick/systick.h"
-#include "core/timer16/timer16.h"
+#include "core/sched/event.h"
+#include "core/cpu/cpu.h"
+#include "core/delay/delay.h"
+
+#ifdef CFG_RANDOM
+#include "drivers/crypto/random.h"
+#endif
 
 // store string messages in flash rather than RAM
 const char chb_err_overflow[] = "BUFFER FULL. TOSSING INCOMING DATA\r\n";
 const char chb_err_init[] = "RADIO NOT INITIALIZED PROPERLY\r\n";
+
+// time (us) latched on the last rising edge of the radio irq, when the
+// last transmission was started, and (for CFG_CHIBI_TIMESTAMP and
+// CFG_CHIBI_TSYNC) when the last frame started arriving
+static volatile U32 irq_us;
+static U32 tx_start_us;
+#if defined CFG_CHIBI_TIMESTAMP || defined CFG_CHIBI_TSYNC
+static U32 rx_start_us;
+#endif
+
+/**************************************************************************/
+/*!
+    Microsecond clock for the timestamps: 32-bit timer 0 with
+    CFG_CHIBI_TIMESTAMP, the systick timer otherwise
+*/
+/**************************************************************************/
+U32 chb_time_us()
+{
+#ifdef CFG_CHIBI_TIMESTAMP
+    return TMR_TMR32B0TC;
+#else
+    return systickGetMicros();
+#endif
+}
 /**************************************************************************/
 /*!
 
@@ -71,31 +102,7 @@ static U8 chb_get_status()
 /**************************************************************************/
 static void chb_delay_us(U16 usec)
 {
-  // Determine maximum delay using a 16 bit timer
-  // ToDo: Move this to a macro or fixed value!
-  uint32_t maxus = 0xFFFF / (CFG_CPU_CCLK / 1000000);
-
-  // Check if delay can be done in one operation
-  if (usec <= maxus)
-  {
-    timer16DelayUS(0, usec);
-    return;
-  }
-
-  // Split delay into several steps (to stay within limit of 16-bit timer)
-  do
-  {
-    if (usec >= maxus)
-    {
-      timer16DelayUS(0, maxus);
-      usec -= maxus;
-    }
-    else
-    {
-      timer16DelayUS(0, usec);
-      usec = 0;
-    }
-  } while (usec > 0);
+    delayUs(usec);
 }
 
 /**************************************************************************/
@@ -247,7 +254,7 @@ void chb_reg_read_mod_write(U8 addr, U8 val, U8 mask)
 /**************************************************************************/
 void chb_frame_write(U8 *hdr, U8 hdr_len, U8 *data, U8 data_len)
 {
-    U8 i, dummy;
+    U8 dummy;
 
     // dont allow transmission longer than max frame size
     if ((hdr_len + data_len) > 127)
@@ -262,17 +269,9 @@ void chb_frame_write(U8 *hdr, U8 hdr_len, U8 *data, U8 data_len)
     // send fifo write command
     dummy = chb_xfer_byte(CHB_SPI_CMD_FW);
 
-    // write hdr contents to fifo
-    for (i=0; i<hdr_len; i++)
-    {
-        dummy = chb_xfer_byte(*hdr++);
-    }
-
-    // write data contents to fifo
-    for (i=0; i<data_len; i++)
-    {
-        dummy = chb_xfer_byte(*data++);
-    }
+    // write hdr contents, then data contents to fifo
+    chb_xfer_write(hdr, hdr_len);
+    chb_xfer_write(data, data_len);
 
     // terminate spi transaction
     CHB_SPI_DISABLE(); 
@@ -286,9 +285,11 @@ void chb_frame_write(U8 *hdr, U8 hdr_len, U8 *data, U8 data_len)
 /**************************************************************************/
 static void chb_frame_read()
 {
-    U8 i, len, data;
+    U8 len;
+    chb_rx_frame_t *frm;
+    chb_pcb_t *pcb = chb_get_pcb();
 
-    // CHB_ENTER_CRIT();
+    CHB_ENTER_CRIT();
     CHB_SPI_ENABLE();
 
     /*Send frame read command and read the length.*/
@@ -298,27 +299,30 @@ static void chb_frame_read()
     /*Check for correct frame length.*/
     if ((len >= CHB_MIN_FRAME_LENGTH) && (len <= CHB_MAX_FRAME_LENGTH))
     {
-        // check to see if there is room to write the frame in the buffer. if not, then drop it
-        if (len < (CFG_CHIBI_BUFFERSIZE - chb_buf_get_len()))
+        // check to see if there is a free slot for the frame. if not, then drop it
+        if ((frm = chb_buf_alloc()) != NULL)
         {
-            chb_buf_write(len);
-            
-            for (i=0; i<len; i++)
-            {
-                data = chb_xfer_byte(0);
-                chb_buf_write(data);
-            }
+            // read the frame and the lqi byte that follows it straight into the slot
+            chb_xfer_read(frm->frm, len);
+            frm->lqi = chb_xfer_byte(0);
+            frm->frm_len = len;
+            frm->ed = pcb->ed;
+#if defined CFG_CHIBI_TIMESTAMP || defined CFG_CHIBI_TSYNC
+            frm->timestamp = rx_start_us;
+#else
+            frm->timestamp = systickGetTicks();
+#endif
+            frm->data = NULL;
+#ifdef CFG_RANDOM
+            // the low bits of the arrival time and the signal levels are noise
+            randomAddSample(frm->timestamp ^ ((U32)frm->lqi << 24) ^ ((U32)frm->ed << 16));
+#endif
+            chb_buf_commit();
         }
         else
         {
-            // we've overflowed the buffer. toss the data and do some housekeeping
-            chb_pcb_t *pcb = chb_get_pcb();
-
-            // read out the data and throw it away
-            for (i=0; i<len; i++)
-            {
-                data = chb_xfer_byte(0);
-            }
+            // we've overflowed the buffer. the frame is simply left in the
+            // radio's frame buffer, where the next frame will overwrite it.
 
             // Increment the overflow stat
             pcb->overflow++;
@@ -334,14 +338,14 @@ static void chb_frame_read()
 
 /**************************************************************************/
 /*!
-    Read directly from the SRAM on the radio. This is only used for debugging
-    purposes.
+    Read directly from the SRAM on the radio (debugging, and the security
+    module's registers for CFG_CHIBI_SEC)
 */
 /**************************************************************************/
-#ifdef CHB_DEBUG
+#if defined CHB_DEBUG || defined CFG_CHIBI_SEC
 void chb_sram_read(U8 addr, U8 len, U8 *data)
 {
-    U8 i, dummy;
+    U8 dummy;
 
     CHB_ENTER_CRIT();
     CHB_SPI_ENABLE();
@@ -352,10 +356,7 @@ void chb_sram_read(U8 addr, U8 len, U8 *data)
     /*Send address where to start reading.*/
     dummy = chb_xfer_byte(addr);
 
-    for (i=0; i<len; i++)
-    {
-        *data++ = chb_xfer_byte(0);
-    }
+    chb_xfer_read(data, len);
 
     CHB_SPI_DISABLE();
     CHB_LEAVE_CRIT();
@@ -368,7 +369,7 @@ void chb_sram_read(U8 addr, U8 len, U8 *data)
 /**************************************************************************/
 void chb_sram_write(U8 addr, U8 len, U8 *data)
 {    
-    U8 i, dummy;
+    U8 dummy;
 
     CHB_ENTER_CRIT();
     CHB_SPI_ENABLE();
@@ -379,16 +380,76 @@ void chb_sram_write(U8 addr, U8 len, U8 *data)
     /*Send address where to start writing to.*/
     dummy = chb_xfer_byte(addr);
 
-    for (i=0; i<len; i++)
-    {
-        dummy = chb_xfer_byte(*data++);
-    }
+    chb_xfer_write(data, len);
 
     CHB_SPI_DISABLE();
     CHB_LEAVE_CRIT();
 }
 #endif
 
+#ifdef CFG_CHIBI_SEC
+/**************************************************************************/
+/*!
+    Returns true if the security module can be used (it isn't reachable
+    while the radio sleeps)
+*/
+/**************************************************************************/
+bool chb_aes_ready()
+{
+    return !gpioGetValue(CHB_SLPTRPORT, CHB_SLPTRPIN);
+}
+
+/**************************************************************************/
+/*!
+    Load the 16 byte AES key into the security module
+*/
+/**************************************************************************/
+void chb_aes_set_key(const U8 *key)
+{
+    U8 buf[1 + 16];
+
+    buf[0] = CHB_AES_MODE_KEY;
+    memcpy(buf + 1, key, 16);
+    chb_sram_write(CHB_AES_CTRL, sizeof(buf), buf);
+}
+
+/**************************************************************************/
+/*!
+    Encrypt one 16 byte block in ECB mode with the key loaded by
+    chb_aes_set_key (in and out may be the same buffer). The control
+    byte, the block and the start request all go out in one sram write.
+    Returns false if the security module didn't finish the block.
+*/
+/**************************************************************************/
+bool chb_aes_ecb(const U8 *in, U8 *out)
+{
+    U8 i, buf[1 + 16 + 1];
+
+    buf[0] = CHB_AES_MODE_ECB;
+    memcpy(buf + 1, in, 16);
+    buf[17] = CHB_AES_MODE_ECB | CHB_AES_REQUEST;
+    chb_sram_write(CHB_AES_CTRL, sizeof(buf), buf);
+
+    // the spi transfers take about as long as the block, so this
+    // rarely has to wait
+    for (i=0; i<4; i++)
+    {
+        chb_sram_read(CHB_AES_STATUS, 1, buf);
+        if (buf[0] & CHB_AES_ER)
+        {
+            return false;
+        }
+        if (buf[0] & CHB_AES_DONE)
+        {
+            chb_sram_read(CHB_AES_STATE_KEY, 16, out);
+            return true;
+        }
+        chb_delay_us(CHB_AES_TIME_US);
+    }
+    return false;
+}
+#endif
+
 /**************************************************************************/
 /*!
     Set the channel mode, BPSK, OQPSK, etc...
@@ -490,6 +551,142 @@ U8 chb_set_channel(U8 channel)
     return ((chb_reg_read(PHY_CC_CCA) & 0x1f) == channel) ? RADIO_SUCCESS : RADIO_TIMED_OUT;
 }
 
+/**************************************************************************/
+/*!
+
+*/
+/**************************************************************************/
+U8 chb_get_channel()
+{
+    return chb_reg_read(PHY_CC_CCA) & 0x1f;
+}
+
+/**************************************************************************/
+/*!
+    Average CHB_SCAN_SAMPLES manual energy detect measurements on the
+    current channel. The radio has to be in RX_ON.
+*/
+/**************************************************************************/
+static U8 chb_ed_average()
+{
+    U8 i;
+    U16 sum = 0;
+
+    for (i=0; i<CHB_SCAN_SAMPLES; i++)
+    {
+        // writing to PHY_ED_LEVEL starts a measurement
+        chb_reg_write(PHY_ED_LEVEL, 0);
+        chb_delay_us(CHB_ED_TIME_US);
+        sum += chb_reg_read(PHY_ED_LEVEL);
+    }
+    return sum / CHB_SCAN_SAMPLES;
+}
+
+/**************************************************************************/
+/*!
+    Measure the energy on channels first..last and store the averaged ed
+    level of each one in ed[0..last-first] (0 = below the sensitivity
+    limit, 1dB steps). Radio interrupts are masked during the scan, so
+    nothing is received. The original channel and state are restored.
+
+    Returns the quietest channel.
+*/
+/**************************************************************************/
+U8 chb_scan(U8 first, U8 last, U8 *ed)
+{
+    U8 ch, best, best_ed = 0xFF, orig = chb_get_channel();
+
+    // no frames from other channels while we're hopping around
+    chb_reg_write(IRQ_MASK, 0);
+
+    // manual ed only works in RX_ON (from RX_AACK_ON via PLL_ON)
+    chb_set_state(PLL_ON);
+    chb_set_state(RX_ON);
+
+    best = orig;
+    for (ch=first; ch<=last; ch++)
+    {
+        chb_set_channel(ch);
+        ed[ch - first] = chb_ed_average();
+        if (ed[ch - first] < best_ed)
+        {
+            best_ed = ed[ch - first];
+            best = ch;
+        }
+    }
+
+    chb_set_channel(orig);
+    chb_set_state(PLL_ON);
+    chb_set_state(RX_STATE);
+
+    // drop anything latched during the scan and unmask the interrupts again
+    chb_reg_read(IRQ_STATUS);
+    chb_reg_write(IRQ_MASK, (1<<IRQ_RX_START) | (1<<IRQ_TRX_END));
+
+    return best;
+}
+
+/**************************************************************************/
+/*!
+    Scan channels first..last and move to the quietest one. Every node in
+    the network has to end up on the same channel, so this is meant for
+    the node that the others look for (or for a manual re-scan).
+
+    Returns the new channel.
+*/
+/**************************************************************************/
+U8 chb_select_channel(U8 first, U8 last)
+{
+    U8 ch, ed[CHB_CHANNEL_LAST - CHB_CHANNEL_FIRST + 1];
+
+    if ((first > last) || (last - first > CHB_CHANNEL_LAST - CHB_CHANNEL_FIRST))
+    {
+        return chb_get_channel();
+    }
+
+    ch = chb_scan(first, last, ed);
+    chb_set_channel(ch);
+    return ch;
+}
+
+/**************************************************************************/
+/*!
+    Fill buf with len bytes from the radio's random number generator (the
+    two RND_VALUE bits in PHY_RSSI, which change every microsecond with
+    the receiver noise). Like the manual ed in chb_scan, this only works
+    in RX_ON, so radio interrupts are masked and nothing is received in
+    the meantime. The bits aren't whitened, so they should go through a
+    hash (see drivers/crypto/random.c) before being used.
+*/
+/**************************************************************************/
+void chb_get_rand(U8 *buf, U8 len)
+{
+    U8 i, j, val;
+
+    chb_reg_write(IRQ_MASK, 0);
+    chb_set_state(PLL_ON);
+    chb_set_state(RX_ON);
+
+    for (i=0; i<len; i++)
+    {
+        val = 0;
+        for (j=0; j<4; j++)
+        {
+            // a new value every microsecond
+            chb_delay_us(1);
+            val = (val << 2) | ((chb_reg_read(PHY_RSSI) >> CHB_RND_VALUE_POS) & 3);
+        }
+        buf[i] = val;
+    }
+
+    chb_set_state(PLL_ON);
+    chb_set_state(RX_STATE);
+
+    // drop anything latched meanwhile and unmask the interrupts again
+    chb_reg_read(IRQ_STATUS);
+    chb_reg_write(IRQ_MASK, (1<<IRQ_RX_START) | (1<<IRQ_TRX_END));
+}
+
 /**************************************************************************/
 /*!
     Set the power level
@@ -500,6 +697,29 @@ void chb_set_pwr(U8 val)
     chb_reg_write(PHY_TX_PWR, val);
 }
 
+/**************************************************************************/
+/*!
+    Set how often the radio retries a frame that wasn't acked (0..15) and
+    how many CSMA backoffs it tries before giving up (0..5)
+*/
+/**************************************************************************/
+void chb_set_retries(U8 frame_retries, U8 csma_retries)
+{
+    chb_reg_read_mod_write(XAH_CTRL_0,
+                           (frame_retries << CHB_MAX_FRAME_RETRIES_POS) | (csma_retries << CHB_MAX_CSMA_RETIRES_POS),
+                           (0xF << CHB_MAX_FRAME_RETRIES_POS) | (0x7 << CHB_MAX_CSMA_RETIRES_POS));
+}
+
+/**************************************************************************/
+/*!
+    Set the range of the CSMA backoff exponent (min_be <= max_be <= 8)
+*/
+/**************************************************************************/
+void chb_set_be(U8 min_be, U8 max_be)
+{
+    chb_reg_write(CSMA_BE, (max_be << CHB_MAX_BE_POS) | (min_be << CHB_MIN_BE_POS));
+}
+
 /**************************************************************************/
 /*!
     Set the TX/RX state machine state. Some manual manipulation is required 
@@ -537,7 +757,7 @@ U8 chb_set_state(U8 state)
         break;
 
     case TX_ARET_ON:
-        if (curr_state == RX_AACK_ON)
+        if ((curr_state == RX_AACK_ON) || (curr_state == RX_ON))
         {
             /* First do intermediate state transition to PLL_ON, then to TX_ARET_ON. */
             chb_reg_read_mod_write(TRX_STATE, CMD_PLL_ON, 0x1f);
@@ -639,11 +859,13 @@ void chb_set_hgm(U8 enb)
 
 /**************************************************************************/
 /*!
-    Load the data into the fifo, initiate a transmission attempt,
-    and return the status of the transmission attempt.
+    Load the data into the fifo and initiate a transmission attempt
+    without waiting for it to finish. The end of the transmission is
+    signalled by chb_ISR_Handler (CHB_EVENT_TX_END in pcb->events, and
+    chb_tx_done when the transmit queue is enabled).
 */
 /**************************************************************************/
-U8 chb_tx(U8 *hdr, U8 *data, U8 len)
+U8 chb_tx_start(U8 *hdr, U8 *data, U8 len)
 {
     U8 state = chb_get_state();
     chb_pcb_t *pcb = chb_get_pcb();
@@ -653,22 +875,46 @@ U8 chb_tx(U8 *hdr, U8 *data, U8 len)
         return RADIO_WRONG_STATE;
     }
 
-    // TODO: check why we need to transition to the off state before we go to tx_aret_on
-    chb_set_state(TRX_OFF);
-    chb_set_state(TX_ARET_ON);
+#ifdef CFG_CHIBI_ADAPTIVE
+    // retries, backoff and power for the destination (hdr[6..7])
+    chb_link_tune(hdr[6] | (hdr[7] << 8));
+#endif
 
-    // TODO: try and start the frame transmission by writing TX_START command instead of toggling
-    // sleep pin...i just feel like it's kind of weird...
+    // go to tx_aret_on directly (via pll_on, see chb_set_state). going through
+    // trx_off costs another pll lock time on every frame.
+    if (chb_set_state(TX_ARET_ON) != RADIO_SUCCESS)
+    {
+        return RADIO_WRONG_STATE;
+    }
+    eventClear(&pcb->events, CHB_EVENT_TX_END);
 
     // write frame to buffer. first write header into buffer (add 1 for len byte), then data. 
     chb_frame_write(hdr, CHB_HDR_SZ + 1, data, len);
 
     //Do frame transmission
+    tx_start_us = chb_time_us();
     chb_reg_read_mod_write(TRX_STATE, CMD_TX_START, 0x1F);
 
-    // wait for the transmission to end, signalled by the TRX END flag
-    while (!pcb->tx_end);
-    pcb->tx_end = false;
+    return RADIO_SUCCESS;
+}
+
+/**************************************************************************/
+/*!
+    Load the data into the fifo, initiate a transmission attempt,
+    and return the status of the transmission attempt.
+*/
+/**************************************************************************/
+U8 chb_tx(U8 *hdr, U8 *data, U8 len)
+{
+    chb_pcb_t *pcb = chb_get_pcb();
+
+    if (chb_tx_start(hdr, data, len) != RADIO_SUCCESS)
+    {
+        return RADIO_WRONG_STATE;
+    }
+
+    // sleep until the isr signals the end of the transmission (TRX END)
+    eventWait(&pcb->events, CHB_EVENT_TX_END, 0);
 
     // check the status of the transmission
     return chb_get_status();
@@ -724,6 +970,11 @@ static void chb_radio_init()
     // put trx in rx auto ack mode
     chb_set_state(RX_STATE);
 
+#ifdef CFG_CHIBI_AUTOCHANNEL
+    // move to the quietest channel of the band
+    chb_select_channel(CHB_CHANNEL_FIRST, CHB_CHANNEL_LAST);
+#endif
+
     // set pan ID
     chb_reg_write16(PAN_ID_0, CFG_CHIBI_PANID); // Defined in projectconfig.h
 
@@ -755,16 +1006,13 @@ static void chb_radio_init()
     // set internal resistor on EINT pin to inactive
     gpioSetPullup (&CHB_EINTPIN_IOCONREG, gpioPullupMode_Inactive);
 
-    // configure pin for interrupt
-    gpioSetInterrupt (CHB_EINTPORT,
-                      CHB_EINTPIN,
-                      gpioInterruptSense_Edge,        // Edge-sensitive
-                      gpioInterruptEdge_Single,       // Single edge
-                      gpioInterruptEvent_ActiveHigh); // High triggers interrupt
-
-    // enable interrupt
-    gpioIntEnable (CHB_EINTPORT,
-                   CHB_EINTPIN); 
+    // configure pin for interrupt and route it to the radio's handler
+    gpioAttachInterrupt (CHB_EINTPORT,
+                         CHB_EINTPIN,
+                         gpioInterruptSense_Edge,        // Edge-sensitive
+                         gpioInterruptEdge_Single,       // Single edge
+                         gpioInterruptEvent_ActiveHigh,  // High triggers interrupt
+                         chb_ISR_Handler);
 
     if (chb_get_state() != RX_STATE)
     {
@@ -786,9 +1034,21 @@ void chb_drvr_init()
     // config SPI for at86rf230 access
     chb_spi_init();
 
-    // Setup 16-bit timer 0 (used for us delays)
-    timer16Init(0, 0xFFFF);
-    timer16Enable(0);
+#ifdef CFG_CHIBI_TIMESTAMP
+    // 32-bit timer 0 free-runs at 1MHz for the rx timestamps (wraps
+    // around every 71 minutes)
+    SCB_SYSAHBCLKCTRL |= SCB_SYSAHBCLKCTRL_CT32B0;
+    NVIC_DisableIRQ(TIMER_32_0_IRQn);
+    TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERRESET_ENABLED;
+    TMR_TMR32B0PR = (cpuGetClock() / 1000000) - 1;
+    TMR_TMR32B0MCR = 0;
+    TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERENABLE_ENABLED;
+#endif
+
+#ifdef CFG_CHIBI_DEFERISR
+    // Deferred interrupt processing runs in PendSV at the lowest priority
+    SCB_SHPR3 = (SCB_SHPR3 & ~SCB_SHPR3_PRI_14_MASK) | SCB_SHPR3_PRI_14_LOWEST;
+#endif
 
     // Set sleep and reset as output
     gpioSetDir(CHB_SLPTRPORT, CHB_SLPTRPIN, 1);
@@ -831,20 +1091,34 @@ void chb_sleep(U8 enb)
     // we need to allow some time for the PLL to lock
     chb_delay_us(TIME_SLEEP_TO_TRX_OFF);
 
+    // drop anything that was latched while going to sleep (the irq
+    // service ignores the radio while it's asleep)
+    chb_reg_read(IRQ_STATUS);
+
     // Turn the transceiver back on
     chb_set_state(RX_STATE);
   }
 }
 /**************************************************************************/
 /*!
-
+    Read the radio's interrupt sources and handle them
 */
 /**************************************************************************/
-void chb_ISR_Handler (void)
+static void chb_irq_service (void)
 {
     U8 dummy, state, intp_src = 0;
+#if CFG_CHIBI_TXQUEUE > 0
+    U8 tx_status = 0xFF;
+#endif
     chb_pcb_t *pcb = chb_get_pcb();
 
+    // the registers can't be read while the radio sleeps (chb_sleep
+    // clears the irq status when it wakes up)
+    if (gpioGetValue(CHB_SLPTRPORT, CHB_SLPTRPIN))
+    {
+        return;
+    }
+
     CHB_ENTER_CRIT();
 
     /*Read Interrupt source.*/
@@ -855,12 +1129,18 @@ void chb_ISR_Handler (void)
     intp_src = chb_xfer_byte(0);
 
     CHB_SPI_DISABLE();
+    CHB_LEAVE_CRIT();
 
     while (intp_src)
     {
         /*Handle the incomming interrupt. Prioritized.*/
         if ((intp_src & CHB_IRQ_RX_START_MASK))
         {
+#if defined CFG_CHIBI_TIMESTAMP || defined CFG_CHIBI_TSYNC
+            // the irq line stays high until IRQ_STATUS is read, so the
+            // edge we latched is the one from the start of this frame
+            rx_start_us = irq_us;
+#endif
             intp_src &= ~CHB_IRQ_RX_START_MASK;
         }
         else if (intp_src & CHB_IRQ_TRX_END_MASK)
@@ -881,12 +1161,19 @@ void chb_ISR_Handler (void)
                     // get the data
                     chb_frame_read();
                     pcb->rcvd_xfers++;
-                    pcb->data_rcv = true;
+                    eventSet(&pcb->events, CHB_EVENT_DATA_RCV);
+                    eventSignal(EVENT_SOURCE_RADIORX);
                 }
             }
             else
             {
-                pcb->tx_end = true;
+#if CFG_CHIBI_TXQUEUE > 0
+                tx_status = chb_get_status();
+#endif
+                // includes csma backoffs, retries and the acks
+                pcb->tx_us = irq_us - tx_start_us;
+                pcb->tx_end_us = irq_us;
+                eventSet(&pcb->events, CHB_EVENT_TX_END);
             }
             intp_src &= ~CHB_IRQ_TRX_END_MASK;
             while (chb_set_state(RX_STATE) != RADIO_SUCCESS);
@@ -913,5 +1200,84 @@ void chb_ISR_Handler (void)
         {
         }
     }
-    CHB_LEAVE_CRIT();
+
+#if CFG_CHIBI_TXQUEUE > 0
+    // report the frame and start the next queued one (now that we're back in rx)
+    if (tx_status != 0xFF)
+    {
+        chb_tx_done(tx_status);
+    }
+#endif
+}
+
+/**************************************************************************/
+/*!
+    Runs the radio interrupt once the shared SSP bus is free again, if it
+    fired while another device was in the middle of a transfer (see
+    sspDeviceDefer). The IRQ sources are still latched in the radio.
+*/
+/**************************************************************************/
+static void chb_irq_resume (void)
+{
+#ifdef CFG_CHIBI_DEFERISR
+    SCB_ICSR = SCB_ICSR_PENDSVSET;
+#else
+    chb_irq_service();
+#endif
+}
+
+/**************************************************************************/
+/*!
+    Radio interrupt (called from PIOINT1_IRQHandler on the rising edge of
+    the radio's IRQ pin). With CFG_CHIBI_DEFERISR the work is left to
+    PendSV_Handler, which runs at the lowest priority once every other
+    interrupt has been serviced, so UART and USB aren't held off while a
+    frame is read or the radio switches state. The radio keeps the IRQ
+    sources latched in IRQ_STATUS until they are read.
+*/
+/**************************************************************************/
+void chb_ISR_Handler (void)
+{
+    irq_us = chb_time_us();
+
+#ifdef CFG_CHIBI_DEFERISR
+    SCB_ICSR = SCB_ICSR_PENDSVSET;
+#else
+    // another device is part way through a transfer on the shared bus
+    if (sspDeviceDefer(&chb_ssp_dev, chb_irq_resume))
+    {
+        return;
+    }
+
+    // no critical section around the whole service: each register access
+    // has its own (as when it runs from PendSV), and the pcb and rx
+    // buffer are shared with the main code through atomics and the
+    // single producer/consumer indexes, so other interrupts can still
+    // run while a frame is read
+    ISRSTAT_BEGIN();
+    chb_irq_service();
+    ISRSTAT_END(isrStat_Chibi);
+#endif
 }
+
+#ifdef CFG_CHIBI_DEFERISR
+/**************************************************************************/
+/*!
+    Deferred radio interrupt processing. Every SPI transaction in here is
+    its own short critical section, so higher priority interrupts can run
+    in between.
+*/
+/**************************************************************************/
+void PendSV_Handler (void)
+{
+    // another device is part way through a transfer on the shared bus
+    if (sspDeviceDefer(&chb_ssp_dev, chb_irq_resume))
+    {
+        return;
+    }
+
+    ISRSTAT_BEGIN();
+    chb_irq_service();
+    ISRSTAT_END(isrStat_Chibi);
+}
+#endif
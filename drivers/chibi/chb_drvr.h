@@ -37,6 +37,8 @@
 #include "types.h"
 #include "projectconfig.h"
 #include "core/gpio/gpio.h"
+#include "core/bench/isrstats.h"
+#include "core/cpu/irq.h"
 
 #define CHB_CC1190_PRESENT      0       /// Set to 1 if CC1190 is being used
 #define CHB_CHINA               0
@@ -52,6 +54,20 @@
 #define CHB_SPI_CMD_FR      0x20    /**<  Frame Receive Mode (long mode). */
 #define CHB_SPI_CMD_SW      0x40    /**<  SRAM Write. */
 #define CHB_SPI_CMD_SR      0x00    /**<  SRAM Read. */
+
+// security module (AES), accessed through the sram commands
+#define CHB_AES_STATUS      0x82    // sram address of AES_STATUS
+#define CHB_AES_CTRL        0x83    // sram address of AES_CTRL
+#define CHB_AES_STATE_KEY   0x84    // 16 bytes of state (or key in key mode)
+#define CHB_AES_CTRL_MIRROR 0x94    // writing it starts the operation in the same sram access
+#define CHB_AES_REQUEST     0x80    // AES_CTRL bits
+#define CHB_AES_MODE_ECB    0x00
+#define CHB_AES_MODE_KEY    0x10
+#define CHB_AES_MODE_CBC    0x20
+#define CHB_AES_DIR_DEC     0x08
+#define CHB_AES_DONE        0x01    // AES_STATUS bits
+#define CHB_AES_ER          0x80
+#define CHB_AES_TIME_US     24      // one block
 #define CHB_SPI_CMD_RADDRM  0x7F    /**<  Register Address Mask. */
 
 #define CHB_IRQ_BAT_LOW_MASK        0x80  /**< Mask for the BAT_LOW interrupt. */
@@ -83,8 +99,11 @@
 //#define CHB_RADIO_IRQ       INT6_vect
 //#define CHB_RADIO_IRQ_PIN   INT6
     
-#define CHB_ENTER_CRIT()    __disable_irq()
-#define CHB_LEAVE_CRIT()    __enable_irq()
+// only the radio's level (CFG_IRQPRIO_RADIO) and the ones below it are held
+// off, anything above still runs. like __disable_irq/__enable_irq, these
+// don't nest.
+#define CHB_ENTER_CRIT()    do { __set_BASEPRI_MAX(IRQ_BASEPRI(CFG_IRQPRIO_RADIO)); ISRSTAT_CRITENTER(); } while (0)
+#define CHB_LEAVE_CRIT()    do { ISRSTAT_CRITLEAVE(); __set_BASEPRI(0); } while (0)
 #define CHB_RST_ENABLE()    do {gpioSetValue(CHB_RSTPORT, CHB_RSTPIN, 0); } while (0)
 #define CHB_RST_DISABLE()   do {gpioSetValue(CHB_RSTPORT, CHB_RSTPIN, 1); } while (0)
 #define CHB_SLPTR_ENABLE()  do {gpioSetValue(CHB_SLPTRPORT, CHB_SLPTRPIN, 1); } while (0)
@@ -174,6 +193,8 @@ enum
 {
     CHB_MAX_FRAME_RETRIES_POS   = 4,
     CHB_MAX_CSMA_RETIRES_POS    = 1,
+    CHB_MIN_BE_POS              = 0,
+    CHB_MAX_BE_POS              = 4,
     CHB_CSMA_SEED1_POS          = 0,
     CHB_CCA_MODE_POS            = 5,
     CHB_AUTO_CRC_POS            = 5,
@@ -184,7 +205,8 @@ enum
     CHB_BPSK_TX_OFFSET          = 3,
     CHB_MIN_FRAME_LENGTH        = 3,
     CHB_MAX_FRAME_LENGTH        = 0x7f,
-    CHB_PA_EXT_EN_POS           = 7
+    CHB_PA_EXT_EN_POS           = 7,
+    CHB_RND_VALUE_POS           = 5
 };
 
 // transceiver timing
@@ -324,6 +346,32 @@ enum
   CHB_PWR_CHINA_0DBM = 0xAA
 };
 
+// channels available with CFG_CHIBI_MODE (see the modes above)
+#if (CFG_CHIBI_MODE == 1) || (CFG_CHIBI_MODE == 3)
+    #define CHB_CHANNEL_FIRST   1       // 915 MHz: channels 1-10
+    #define CHB_CHANNEL_LAST    10
+#elif (CFG_CHIBI_MODE == 2)
+    #define CHB_CHANNEL_FIRST   0       // 780 MHz: channels 0-3
+    #define CHB_CHANNEL_LAST    3
+#else
+    #define CHB_CHANNEL_FIRST   0       // 868 MHz: channel 0 only
+    #define CHB_CHANNEL_LAST    0
+#endif
+
+// air time of one byte with CFG_CHIBI_MODE (us)
+#if (CFG_CHIBI_MODE == 1) || (CFG_CHIBI_MODE == 2)
+    #define CHB_BYTE_US     32      // O-QPSK 250 kbps
+#elif (CFG_CHIBI_MODE == 3)
+    #define CHB_BYTE_US     200     // BPSK 40 kbps
+#elif (CFG_CHIBI_MODE == 4)
+    #define CHB_BYTE_US     400     // BPSK 20 kbps
+#else
+    #define CHB_BYTE_US     80      // O-QPSK 100 kbps
+#endif
+
+#define CHB_ED_TIME_US      500     // manual ed measurement (8 symbols at 20 kbps is 400us)
+#define CHB_SCAN_SAMPLES    8       // ed measurements averaged per channel
+
 // define receive state based on promiscuous mode setting
 #if (CFG_CHIBI_PROMISCUOUS == 1)
     #define RX_STATE RX_ON
@@ -332,6 +380,7 @@ enum
 #endif
 // init 
 void chb_drvr_init();
+U32 chb_time_us();
 
 // data access
 U8 chb_reg_read(U8 addr);
@@ -345,7 +394,13 @@ void chb_frame_write(U8 *hdr, U8 hdr_len, U8 *data, U8 data_len);
 // general configuration
 void chb_set_mode(U8 mode);
 U8 chb_set_channel(U8 channel);
+U8 chb_get_channel();
+U8 chb_scan(U8 first, U8 last, U8 *ed);
+U8 chb_select_channel(U8 first, U8 last);
+void chb_get_rand(U8 *buf, U8 len);
 void chb_set_pwr(U8 val);
+void chb_set_retries(U8 frame_retries, U8 csma_retries);
+void chb_set_be(U8 min_be, U8 max_be);
 void chb_set_ieee_addr(U8 *addr);
 void chb_get_ieee_addr(U8 *addr);
 void chb_set_short_addr(U16 addr);
@@ -356,18 +411,26 @@ U8 chb_set_state(U8 state);
 void chb_sleep(U8 enb);
 
 // data transmit
+U8 chb_tx_start(U8 *hdr, U8 *data, U8 len);
 U8 chb_tx(U8 *hdr, U8 *data, U8 len);
 
 #if (CHB_CC1190_PRESENT)
     void chb_set_hgm(U8 enb);
 #endif
 
-#ifdef CHB_DEBUG
+#if defined CHB_DEBUG || defined CFG_CHIBI_SEC
 // sram access
 void chb_sram_read(U8 addr, U8 len, U8 *data);
 void chb_sram_write(U8 addr, U8 len, U8 *data);
 #endif
 
+#ifdef CFG_CHIBI_SEC
+// aes engine
+bool chb_aes_ready();
+void chb_aes_set_key(const U8 *key);
+bool chb_aes_ecb(const U8 *in, U8 *out);
+#endif
+
 void chb_ISR_Handler (void);
 
 #endif
@@ -0,0 +1,273 @@
+/**************************************************************************/
+/*! 
+    @file     chb_lpl.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Low power listening (duty-cycled receive) for battery powered nodes.
+
+    Instead of sitting in RX_AACK_ON all the time, the radio is kept in
+    sleep mode and woken up by a scheduler timer every
+    CFG_CHIBI_LPL_INTERVALMS.  It then listens for CFG_CHIBI_LPL_LISTENMS:
+    if nothing was received and the channel is quiet by the end of that
+    window it goes straight back to sleep, otherwise it stays awake for
+    another CFG_CHIBI_LPL_HOLDMS (and again for as long as traffic keeps
+    coming in).
+
+    A sender can't know when the receiver is listening, so chb_lpl_write
+    keeps retransmitting the same frame (same sequence number, so the
+    receiver's duplicate check drops the extra copies) for up to one full
+    wake-up interval plus a listen window.  Unicast frames stop as soon as
+    one is acked, broadcasts are repeated for the whole interval.  After
+    sending, the sender stays awake for CFG_CHIBI_LPL_HOLDMS so the
+    receiver can reply straight away.
+
+    Waking up, sleeping and timing are all done from the scheduler, so
+    with CFG_SCHEDULER_TICKLESS (and CFG_SCHEDULER_DEEPSLEEP for
+    intervals of a second or more) the MCU sleeps between listen windows
+    as well.
+
+    chb_write and the layers built on it (chb_xport.c, chb_route.c) don't
+    strobe: while low power listening is enabled, send through
+    chb_lpl_write, or call chb_lpl_hold first on nodes that are known
+    to be awake.
+
+    @section Example
+
+    @code 
+    chb_init();
+    chb_lpl_init();
+    chb_lpl_enable(true);
+
+    // somewhere in a task
+    chb_lpl_write(0x1234, (U8 *)"hello", 6);
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "chb_lpl.h"
+#include "chb_drvr.h"
+
+#include "core/systick/systick.h"
+#include "core/sched/sched.h"
+
+#define CHB_LPL_TICKS(ms)   ((ms) / CFG_SYSTICK_DELAY_IN_MS)
+
+static schedTask_t lpl_task;
+static bool lpl_enb = false;
+static bool lpl_awake = true;
+static U16 lpl_rcvd;            // pcb->rcvd_xfers when the window started
+
+/**************************************************************************/
+/*!
+    True if something is (or was just) on the air
+*/
+/**************************************************************************/
+static bool chb_lpl_activity()
+{
+    U8 state = chb_reg_read(TRX_STATUS) & 0x1F;
+
+    if ((chb_get_pcb()->rcvd_xfers != lpl_rcvd) || (chb_get_pcb()->events & CHB_EVENT_DATA_RCV))
+    {
+        return true;
+    }
+    if ((state == BUSY_RX_AACK) || (state == BUSY_RX))
+    {
+        return true;
+    }
+    return ((chb_reg_read(PHY_RSSI) & 0x1F) >= CHB_LPL_RSSI_BUSY);
+}
+
+/**************************************************************************/
+/*!
+    Wake the radio (if needed) and listen for 'ms'
+*/
+/**************************************************************************/
+static void chb_lpl_listen(U32 ms)
+{
+    if (!lpl_awake)
+    {
+        chb_sleep(0);
+        lpl_awake = true;
+    }
+    lpl_rcvd = chb_get_pcb()->rcvd_xfers;
+    schedStartTimer(&lpl_task, ms, 0);
+}
+
+/**************************************************************************/
+/*!
+    Scheduler task: alternates between the sleep interval and the listen
+    window
+*/
+/**************************************************************************/
+static void chb_lpl_task(schedTask_t *task)
+{
+    if (!lpl_enb)
+    {
+        return;
+    }
+
+    if (!lpl_awake)
+    {
+        chb_lpl_listen(CFG_CHIBI_LPL_LISTENMS);
+    }
+    else if (chb_lpl_activity())
+    {
+        chb_lpl_listen(CFG_CHIBI_LPL_HOLDMS);
+    }
+    else
+    {
+        chb_sleep(1);
+        lpl_awake = false;
+        schedStartTimer(&lpl_task, CFG_CHIBI_LPL_INTERVALMS - CFG_CHIBI_LPL_LISTENMS, 0);
+    }
+}
+
+/**************************************************************************/
+/*!
+    Set up the low power listening task (call after chb_init). Low power
+    listening stays off until chb_lpl_enable is called.
+*/
+/**************************************************************************/
+void chb_lpl_init()
+{
+    schedTaskInit(&lpl_task, chb_lpl_task, NULL);
+    lpl_enb = false;
+    lpl_awake = true;
+}
+
+/**************************************************************************/
+/*!
+    Turn low power listening on or off. When it's turned off the radio
+    is left in receive mode permanently.
+*/
+/**************************************************************************/
+void chb_lpl_enable(bool enb)
+{
+    lpl_enb = enb;
+    if (enb)
+    {
+        chb_lpl_listen(CFG_CHIBI_LPL_LISTENMS);
+    }
+    else
+    {
+        schedStopTimer(&lpl_task);
+        if (!lpl_awake)
+        {
+            chb_sleep(0);
+            lpl_awake = true;
+        }
+    }
+}
+
+/**************************************************************************/
+/*!
+
+*/
+/**************************************************************************/
+bool chb_lpl_enabled()
+{
+    return lpl_enb;
+}
+
+/**************************************************************************/
+/*!
+    True while the radio is listening
+*/
+/**************************************************************************/
+bool chb_lpl_awake()
+{
+    return lpl_awake;
+}
+
+/**************************************************************************/
+/*!
+    Wake the radio now and keep it listening for CFG_CHIBI_LPL_HOLDMS,
+    e.g. while waiting for a reply
+*/
+/**************************************************************************/
+void chb_lpl_hold()
+{
+    if (lpl_enb)
+    {
+        chb_lpl_listen(CFG_CHIBI_LPL_HOLDMS);
+    }
+}
+
+/**************************************************************************/
+/*!
+    Send a single frame (up to CHB_MAX_PAYLOAD bytes) to a node that is
+    using low power listening. The frame is repeated until it's acked
+    or, for broadcasts, for a whole wake-up interval. Blocks for up to
+    CFG_CHIBI_LPL_INTERVALMS + CFG_CHIBI_LPL_LISTENMS.
+
+    Returns the status of the last attempt (CHB_NO_ACK if the receiver
+    never woke up).
+*/
+/**************************************************************************/
+U8 chb_lpl_write(U16 addr, U8 *data, U8 len)
+{
+    U8 status, hdr[CHB_HDR_SZ + 1];
+    U32 start;
+
+    if (!lpl_enb)
+    {
+        return chb_write(addr, data, len);
+    }
+    if (len > CHB_MAX_PAYLOAD)
+    {
+        return CHB_INVALID;
+    }
+
+#if CFG_CHIBI_TXQUEUE > 0
+    // let anything already queued go out first: the queue's completion
+    // handling must not see our frames
+    while (chb_tx_queue_free() != CFG_CHIBI_TXQUEUE);
+#endif
+
+    // every copy goes out with the same header (and sequence number)
+    chb_lpl_hold();
+    chb_gen_hdr(hdr, addr, len);
+    start = systickGetTicks();
+    do
+    {
+        status = chb_tx(hdr, data, len);
+        if ((addr != CHB_BROADCAST) && ((status == CHB_SUCCESS) || (status == CHB_SUCCESS_DATA_PENDING)))
+        {
+            break;
+        }
+    } while (systickGetTicks() - start < CHB_LPL_TICKS(CFG_CHIBI_LPL_INTERVALMS + CFG_CHIBI_LPL_LISTENMS));
+
+    // stay up for the reply
+    chb_lpl_hold();
+    return status;
+}
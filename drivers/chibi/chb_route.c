@@ -0,0 +1,584 @@
+/**************************************************************************/
+/*! 
+    @file     chb_route.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Lightweight multi-hop routing on top of chb.c.
+
+    Every node keeps a next-hop table of up to CFG_CHIBI_ROUTES entries,
+    sorted by destination address so lookups are a binary search.  Direct
+    neighbours are added as soon as any frame is heard from them, along
+    with a running average of the energy detect level of their frames.
+
+    When there is no route to a destination, a route request is flooded
+    through the network (each node forwards a given request once).  Nodes
+    learn the way back to the requester as the request passes, and the
+    destination answers with a route reply that travels back along that
+    path, so every node on the way learns the forward route.  Routes with
+    fewer hops win, and the link quality of the next hop breaks ties.
+
+    The table can be written to EEPROM with chb_route_save() so that a
+    node doesn't have to rediscover its routes after a reset.
+
+    chb_route_flood() sends one frame to every node in a group (or to
+    all of them with CHB_BROADCAST) however many hops away they are.
+    The frame is broadcast, and every node that hears it for the first
+    time hands it to its flood callback if it has joined the group and
+    then broadcasts it once more, until CFG_CHIBI_ROUTE_MAXHOPS hops.
+    Origin + id are remembered the same way as for route requests, so
+    no node forwards the same flood twice.  Like every broadcast there
+    is no ack (see CFG_CHIBI_BCAST_REPEAT), so floods suit commands
+    that can simply be sent again, such as configuration updates.
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "chb_route.h"
+#include "chb_eeprom.h"
+
+#define CHB_ROUTE_MAGIC     0xA7    // marks a valid table in EEPROM
+#define CHB_ROUTE_SEEN      8       // remembered route requests and floods
+
+static chb_route_t routes[CFG_CHIBI_ROUTES];
+static U8 route_cnt = 0;
+static chb_route_rx_cb_t route_rx_cb = NULL;
+static chb_route_flood_cb_t route_flood_cb = NULL;
+
+// route requests and floods already forwarded (origin + id). both use
+// the same id counter.
+static struct
+{
+    U16 origin;
+    U8 id;
+} seen[CHB_ROUTE_SEEN];
+static U8 seen_idx = 0;
+static U8 flood_id = 0;
+
+// joined groups (CHB_BROADCAST marks a free entry)
+static U16 groups[CHB_ROUTE_GROUPS];
+
+/**************************************************************************/
+/*!
+    Binary search for dest. Returns the index of the entry, or the index
+    it should be inserted at (with *found set to false).
+*/
+/**************************************************************************/
+static U8 chb_route_find(U16 dest, bool *found)
+{
+    U8 lo = 0, hi = route_cnt, mid;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (routes[mid].dest == dest)
+        {
+            *found = true;
+            return mid;
+        }
+        if (routes[mid].dest < dest)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    *found = false;
+    return lo;
+}
+
+/**************************************************************************/
+/*!
+    Returns the averaged ed level of a neighbour (0 if it isn't one)
+*/
+/**************************************************************************/
+static U8 chb_route_link_ed(U16 addr)
+{
+    const chb_route_t *r = chb_route_lookup(addr);
+
+    return (r && (r->hops == 1)) ? r->ed : 0;
+}
+
+/**************************************************************************/
+/*!
+    Add or improve the route to dest. An existing route is replaced if the
+    new one has fewer hops, goes through the same next hop (refresh), or
+    has as many hops over a better link. If the table is full, the entry
+    with the most hops is evicted when the new route is shorter.
+*/
+/**************************************************************************/
+static void chb_route_learn(U16 dest, U16 next_hop, U8 hops, U8 ed)
+{
+    bool found;
+    U8 i, idx, worst;
+    chb_route_t *r;
+
+    if (dest == chb_get_pcb()->src_addr)
+    {
+        return;
+    }
+
+    idx = chb_route_find(dest, &found);
+    if (found)
+    {
+        r = &routes[idx];
+        if ((hops < r->hops) || (next_hop == r->next_hop) ||
+            ((hops == r->hops) && (ed > r->ed)))
+        {
+            r->next_hop = next_hop;
+            r->hops = hops;
+            r->ed = ed;
+        }
+        return;
+    }
+
+    if (route_cnt == CFG_CHIBI_ROUTES)
+    {
+        worst = 0;
+        for (i=1; i<route_cnt; i++)
+        {
+            if (routes[i].hops > routes[worst].hops)
+            {
+                worst = i;
+            }
+        }
+        if (routes[worst].hops <= hops)
+        {
+            return;
+        }
+        memmove(&routes[worst], &routes[worst + 1], (route_cnt - worst - 1) * sizeof(chb_route_t));
+        route_cnt--;
+        idx = chb_route_find(dest, &found);
+    }
+
+    memmove(&routes[idx + 1], &routes[idx], (route_cnt - idx) * sizeof(chb_route_t));
+    routes[idx].dest = dest;
+    routes[idx].next_hop = next_hop;
+    routes[idx].hops = hops;
+    routes[idx].ed = ed;
+    route_cnt++;
+}
+
+/**************************************************************************/
+/*!
+    Returns true if origin + id has been seen before, otherwise remembers
+    it and returns false
+*/
+/**************************************************************************/
+static bool chb_route_seen(U16 origin, U8 id)
+{
+    U8 i;
+
+    for (i=0; i<CHB_ROUTE_SEEN; i++)
+    {
+        if ((seen[i].origin == origin) && (seen[i].id == id))
+        {
+            return true;
+        }
+    }
+    seen[seen_idx].origin = origin;
+    seen[seen_idx].id = id;
+    seen_idx = (seen_idx + 1) % CHB_ROUTE_SEEN;
+    return false;
+}
+
+/**************************************************************************/
+/*!
+    Fill in a routing header and send the frame to the next hop
+*/
+/**************************************************************************/
+static U8 chb_route_write(U16 next_hop, U8 type, U8 b, U16 origin, U16 dest, U8 *data, U8 len)
+{
+    U8 frm[CHB_MAX_PAYLOAD];
+
+    frm[0] = type;
+    frm[1] = b;
+    frm[2] = origin & 0xFF;
+    frm[3] = origin >> 8;
+    frm[4] = dest & 0xFF;
+    frm[5] = dest >> 8;
+    memcpy(frm + CHB_ROUTE_HDR_SZ, data, len);
+    return chb_write(next_hop, frm, CHB_ROUTE_HDR_SZ + len);
+}
+
+/**************************************************************************/
+/*!
+    Initialise the routing layer and load the table saved in EEPROM
+
+    @param[in]  rx_cb
+                Called with routed data addressed to this node
+*/
+/**************************************************************************/
+void chb_route_init(chb_route_rx_cb_t rx_cb)
+{
+    U8 i, hdr[2], e[5];
+
+    route_rx_cb = rx_cb;
+    route_cnt = 0;
+    memset(seen, 0xFF, sizeof(seen));
+    memset(groups, 0xFF, sizeof(groups));
+
+    chb_eeprom_read(CFG_EEPROM_CHIBI_ROUTES, hdr, 2);
+    if ((hdr[0] != CHB_ROUTE_MAGIC) || (hdr[1] > CFG_CHIBI_ROUTES))
+    {
+        return;
+    }
+
+    for (i=0; i<hdr[1]; i++)
+    {
+        chb_eeprom_read(CFG_EEPROM_CHIBI_ROUTES + 2 + i * 5, e, 5);
+        chb_route_learn(e[0] | (e[1] << 8), e[2] | (e[3] << 8), e[4], 0);
+    }
+}
+
+/**************************************************************************/
+/*!
+    Write the routing table to EEPROM (link quality isn't kept)
+*/
+/**************************************************************************/
+void chb_route_save()
+{
+    U8 i, buf[2 + CFG_CHIBI_ROUTES * 5], *p;
+
+    buf[0] = CHB_ROUTE_MAGIC;
+    buf[1] = route_cnt;
+    p = buf + 2;
+    for (i=0; i<route_cnt; i++)
+    {
+        *p++ = routes[i].dest & 0xFF;
+        *p++ = routes[i].dest >> 8;
+        *p++ = routes[i].next_hop & 0xFF;
+        *p++ = routes[i].next_hop >> 8;
+        *p++ = routes[i].hops;
+    }
+    chb_eeprom_write(CFG_EEPROM_CHIBI_ROUTES, buf, p - buf);
+}
+
+/**************************************************************************/
+/*!
+    Forget every route (the copy in EEPROM is kept until the next save)
+*/
+/**************************************************************************/
+void chb_route_clear()
+{
+    route_cnt = 0;
+}
+
+/**************************************************************************/
+/*!
+    Returns the route to dest, or NULL if there is none
+*/
+/**************************************************************************/
+const chb_route_t *chb_route_lookup(U16 dest)
+{
+    bool found;
+    U8 idx = chb_route_find(dest, &found);
+
+    return found ? &routes[idx] : NULL;
+}
+
+/**************************************************************************/
+/*!
+
+*/
+/**************************************************************************/
+U8 chb_route_count()
+{
+    return route_cnt;
+}
+
+/**************************************************************************/
+/*!
+    Returns table entry 'index' (in address order), or NULL
+*/
+/**************************************************************************/
+const chb_route_t *chb_route_get(U8 index)
+{
+    return (index < route_cnt) ? &routes[index] : NULL;
+}
+
+/**************************************************************************/
+/*!
+    Flood a route request for dest
+*/
+/**************************************************************************/
+void chb_route_discover(U16 dest)
+{
+    U16 self = chb_get_pcb()->src_addr;
+    U8 hops = 0;
+
+    // remember our own request so that we don't forward it when it comes back
+    chb_route_seen(self, ++flood_id);
+
+    chb_route_write(CHB_BROADCAST, CHB_ROUTE_RREQ, flood_id, self, dest, &hops, 1);
+}
+
+/**************************************************************************/
+/*!
+    Set the callback for flooded data (call after chb_route_init)
+*/
+/**************************************************************************/
+void chb_route_flood_init(chb_route_flood_cb_t flood_cb)
+{
+    route_flood_cb = flood_cb;
+}
+
+/**************************************************************************/
+/*!
+    Send data to every node in a group, or to every node in the network
+    with CHB_BROADCAST. Returns the status of the local broadcast.
+*/
+/**************************************************************************/
+U8 chb_route_flood(U16 group, U8 *data, U8 len)
+{
+    U16 self = chb_get_pcb()->src_addr;
+    U8 frm[CHB_MAX_PAYLOAD];
+
+    if (len > CHB_ROUTE_FLOOD_MAX_PAYLOAD)
+    {
+        return CHB_INVALID;
+    }
+
+    // don't forward our own flood when it comes back
+    chb_route_seen(self, ++flood_id);
+
+    frm[0] = CHB_ROUTE_FLOOD;
+    frm[1] = CFG_CHIBI_ROUTE_MAXHOPS;
+    frm[2] = self & 0xFF;
+    frm[3] = self >> 8;
+    frm[4] = group & 0xFF;
+    frm[5] = group >> 8;
+    frm[6] = flood_id;
+    memcpy(frm + CHB_ROUTE_FLOOD_HDR_SZ, data, len);
+    return chb_write(CHB_BROADCAST, frm, CHB_ROUTE_FLOOD_HDR_SZ + len);
+}
+
+/**************************************************************************/
+/*!
+    Join a group for chb_route_flood. Returns false if this node is
+    already in CHB_ROUTE_GROUPS groups.
+*/
+/**************************************************************************/
+bool chb_route_join(U16 group)
+{
+    U8 i;
+
+    for (i=0; i<CHB_ROUTE_GROUPS; i++)
+    {
+        if (groups[i] == group)
+        {
+            return true;
+        }
+    }
+    for (i=0; i<CHB_ROUTE_GROUPS; i++)
+    {
+        if (groups[i] == CHB_BROADCAST)
+        {
+            groups[i] = group;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**************************************************************************/
+/*!
+    Leave a group joined with chb_route_join
+*/
+/**************************************************************************/
+void chb_route_leave(U16 group)
+{
+    U8 i;
+
+    for (i=0; i<CHB_ROUTE_GROUPS; i++)
+    {
+        if (groups[i] == group)
+        {
+            groups[i] = CHB_BROADCAST;
+        }
+    }
+}
+
+/**************************************************************************/
+/*!
+    Returns true if flooded data for group is for this node
+*/
+/**************************************************************************/
+static bool chb_route_member(U16 group)
+{
+    U8 i;
+
+    if (group == CHB_BROADCAST)
+    {
+        return true;
+    }
+    for (i=0; i<CHB_ROUTE_GROUPS; i++)
+    {
+        if (groups[i] == group)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**************************************************************************/
+/*!
+    Send data to any node in the network. Returns CHB_NO_ROUTE (and starts
+    route discovery) if the way to dest isn't known yet, otherwise the
+    status of the transmission to the next hop.
+*/
+/**************************************************************************/
+U8 chb_route_send(U16 dest, U8 *data, U8 len)
+{
+    const chb_route_t *r = chb_route_lookup(dest);
+
+    if (len > CHB_ROUTE_MAX_PAYLOAD)
+    {
+        return CHB_INVALID;
+    }
+    if (!r)
+    {
+        chb_route_discover(dest);
+        return CHB_NO_ROUTE;
+    }
+    return chb_route_write(r->next_hop, CHB_ROUTE_DATA, CFG_CHIBI_ROUTE_MAXHOPS,
+                           chb_get_pcb()->src_addr, dest, data, len);
+}
+
+/**************************************************************************/
+/*!
+    Pass every received frame (from chb_read_frame) to the routing layer.
+    The sender is recorded as a neighbour. Returns true if it was a
+    routing frame, false if it should be handled by the application. The
+    caller still frees the frame.
+*/
+/**************************************************************************/
+bool chb_route_rx(chb_rx_frame_t *frm)
+{
+    U8 i, *p = frm->data;
+    U8 ed = chb_route_link_ed(frm->src_addr);
+    U16 self = chb_get_pcb()->src_addr;
+    U16 origin, dest;
+    const chb_route_t *r;
+
+    // every frame tells us about a neighbour (and how well we hear it)
+    ed = ed ? (ed * 3 + frm->ed) / 4 : frm->ed;
+    chb_route_learn(frm->src_addr, frm->src_addr, 1, ed);
+
+    if ((frm->len < CHB_ROUTE_HDR_SZ) || (p[0] < CHB_ROUTE_RREQ) || (p[0] > CHB_ROUTE_FLOOD))
+    {
+        return false;
+    }
+
+    origin = p[2] | (p[3] << 8);
+    dest = p[4] | (p[5] << 8);
+
+    switch (p[0])
+    {
+    case CHB_ROUTE_RREQ:
+        if ((frm->len < CHB_ROUTE_HDR_SZ + 1) || (origin == self) || chb_route_seen(origin, p[1]))
+        {
+            break;
+        }
+
+        // the way back to the requester is through whoever sent us this
+        chb_route_learn(origin, frm->src_addr, p[6] + 1, ed);
+
+        if (dest == self)
+        {
+            i = 0;
+            chb_route_write(frm->src_addr, CHB_ROUTE_RREP, 0, origin, self, &i, 1);
+        }
+        else if (p[6] + 1 < CFG_CHIBI_ROUTE_MAXHOPS)
+        {
+            p[6]++;
+            chb_route_write(CHB_BROADCAST, CHB_ROUTE_RREQ, p[1], origin, dest, p + 6, 1);
+        }
+        break;
+
+    case CHB_ROUTE_RREP:
+        if (frm->len < CHB_ROUTE_HDR_SZ + 1)
+        {
+            break;
+        }
+
+        // dest is the node that answered, reachable through the sender
+        chb_route_learn(dest, frm->src_addr, p[6] + 1, ed);
+        if ((origin != self) && ((r = chb_route_lookup(origin)) != NULL))
+        {
+            p[6]++;
+            chb_route_write(r->next_hop, CHB_ROUTE_RREP, 0, origin, dest, p + 6, 1);
+        }
+        break;
+
+    case CHB_ROUTE_DATA:
+        if (dest == self)
+        {
+            if (route_rx_cb)
+            {
+                route_rx_cb(origin, p + CHB_ROUTE_HDR_SZ, frm->len - CHB_ROUTE_HDR_SZ);
+            }
+        }
+        else if ((p[1] > 1) && ((r = chb_route_lookup(dest)) != NULL))
+        {
+            chb_route_write(r->next_hop, CHB_ROUTE_DATA, p[1] - 1, origin, dest,
+                            p + CHB_ROUTE_HDR_SZ, frm->len - CHB_ROUTE_HDR_SZ);
+        }
+        break;
+
+    case CHB_ROUTE_FLOOD:
+        // dest is the group here
+        if ((frm->len < CHB_ROUTE_FLOOD_HDR_SZ) || (origin == self) || chb_route_seen(origin, p[6]))
+        {
+            break;
+        }
+
+        // the first copy to arrive came the shortest way back to the origin
+        chb_route_learn(origin, frm->src_addr, CFG_CHIBI_ROUTE_MAXHOPS - p[1] + 1, ed);
+
+        if (chb_route_member(dest) && route_flood_cb)
+        {
+            route_flood_cb(origin, dest, p + CHB_ROUTE_FLOOD_HDR_SZ, frm->len - CHB_ROUTE_FLOOD_HDR_SZ);
+        }
+        if (p[1] > 1)
+        {
+            p[1]--;
+            chb_write(CHB_BROADCAST, p, frm->len);
+        }
+        break;
+    }
+    return true;
+}
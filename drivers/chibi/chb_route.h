@@ -0,0 +1,81 @@
+/**************************************************************************/
+/*! 
+    @file     chb_route.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef CHB_ROUTE_H
+#define CHB_ROUTE_H
+
+#include "types.h"
+#include "chb.h"
+
+#define CHB_ROUTE_RREQ      0xE1    // route request (broadcast)
+#define CHB_ROUTE_RREP      0xE2    // route reply (unicast back to the origin)
+#define CHB_ROUTE_DATA      0xE3    // routed data
+#define CHB_ROUTE_FLOOD     0xE4    // data flooded to a group (broadcast)
+#define CHB_ROUTE_HDR_SZ    6       // type + ttl + origin + dest (1 + 1 + 2 + 2)
+#define CHB_ROUTE_MAX_PAYLOAD (CHB_MAX_PAYLOAD - CHB_ROUTE_HDR_SZ)
+#define CHB_ROUTE_FLOOD_HDR_SZ 7    // type + ttl + origin + group + id (1 + 1 + 2 + 2 + 1)
+#define CHB_ROUTE_FLOOD_MAX_PAYLOAD (CHB_MAX_PAYLOAD - CHB_ROUTE_FLOOD_HDR_SZ)
+#define CHB_ROUTE_GROUPS    4       // groups a node can join (CHB_BROADCAST is always joined)
+
+// routing table entry (the table is kept sorted by dest)
+typedef struct
+{
+    U16 dest;
+    U16 next_hop;
+    U8 hops;                    // 1 = direct neighbour
+    U8 ed;                      // averaged energy detect level of next_hop
+} chb_route_t;
+
+// called with routed data addressed to this node
+typedef void (*chb_route_rx_cb_t)(U16 origin, U8 *data, U8 len);
+
+// called with flooded data for a group this node has joined
+typedef void (*chb_route_flood_cb_t)(U16 origin, U16 group, U8 *data, U8 len);
+
+void chb_route_init(chb_route_rx_cb_t rx_cb);
+U8 chb_route_send(U16 dest, U8 *data, U8 len);
+void chb_route_discover(U16 dest);
+void chb_route_flood_init(chb_route_flood_cb_t flood_cb);
+U8 chb_route_flood(U16 group, U8 *data, U8 len);
+bool chb_route_join(U16 group);
+void chb_route_leave(U16 group);
+bool chb_route_rx(chb_rx_frame_t *frm);
+const chb_route_t *chb_route_lookup(U16 dest);
+U8 chb_route_count();
+const chb_route_t *chb_route_get(U8 index);
+void chb_route_clear();
+void chb_route_save();
+
+#endif
@@ -0,0 +1,327 @@
+/**************************************************************************/
+/*! 
+    @file     chb_sec.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Link layer encryption and authentication on top of chb.c.
+
+    chb_sec_write encrypts the payload with AES-128 CCM (the same mode
+    802.15.4 uses) and appends a 4 byte tag.  The tag covers the
+    payload, a frame counter and both addresses, so a frame that was
+    changed, sent on to another node or replayed is dropped by
+    chb_sec_rx.  Every node of a network uses the same key; the nonce
+    is made of the sender's short address and its frame counter, so the
+    short addresses have to be unique.
+
+    CCM only ever runs the cipher forwards, and on the AT86RF212 that
+    is done by the radio's own AES engine (ECB mode through the sram
+    interface).  If the engine doesn't answer, or the radio is asleep,
+    the block is computed by the software AES in drivers/crypto
+    instead, which gives the same result.  Each block still costs
+    about 40 bytes on the spi bus, so compared with the T-table AES
+    (CFG_AES_TTABLES 1 or 4) the radio mostly saves cpu time when the
+    small table-less build is used.
+
+    The frame counter must never repeat with the same key: its upper
+    part is kept in EEPROM (CFG_EEPROM_CHIBI_SECCOUNTER) and written
+    once every CHB_SEC_COUNTER_STEP frames, so a reset skips at most
+    that many values.  The last counter of the CHB_SEC_PEERS most
+    recent senders is remembered to reject replays.
+
+    @section Example
+
+    @code 
+    static const U8 key[CHB_SEC_KEY_SZ] = { ... };
+
+    chb_init();
+    chb_sec_init(key, secRx);
+
+    chb_sec_write(0x1234, (U8 *)"hello", 5);
+
+    // in the receive loop
+    chb_rx_frame_t *frm;
+    while ((frm = chb_read_frame()) != NULL)
+    {
+        if (!chb_sec_rx(frm))
+        {
+            // not an encrypted frame, handle (or drop) it here
+        }
+        chb_free_frame(frm);
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "chb_sec.h"
+#include "chb_drvr.h"
+#include "chb_eeprom.h"
+
+#include "drivers/crypto/aes.h"
+
+#define CHB_SEC_NONCE_SZ        13
+#define CHB_SEC_AAD_SZ          (4 + CHB_SEC_HDR_SZ)    // dest + src + header
+#define CHB_SEC_PEERS           8                       // senders checked for replays
+#define CHB_SEC_COUNTER_STEP    256                     // frames between eeprom writes
+
+static aesContext_t sec_ctx;
+static U8 sec_key[CHB_SEC_KEY_SZ];
+static bool sec_hw = false;
+static chb_sec_rx_cb_t sec_rx_cb = NULL;
+
+// next frame counter and the first one not reserved in eeprom yet
+static U32 tx_counter;
+static U32 tx_reserved;
+
+// highest authentic frame counter of each recent sender
+static struct
+{
+    U16 addr;
+    U32 counter;
+} peers[CHB_SEC_PEERS];
+static U8 peer_idx = 0;
+
+/**************************************************************************/
+/*!
+    aesEncryptBlock engine: the radio, falling back to software for the
+    rest of the frame if it fails
+*/
+/**************************************************************************/
+static void chb_sec_engine(const uint8_t *in, uint8_t *out)
+{
+    if (!chb_aes_ecb(in, out))
+    {
+        sec_ctx.engine = NULL;
+        aesEncryptBlock(&sec_ctx, in, out);
+    }
+}
+
+/**************************************************************************/
+/*!
+    Select the cipher for the next frame. The key is loaded each time
+    since the radio may have slept since the last frame.
+*/
+/**************************************************************************/
+static void chb_sec_begin()
+{
+    sec_ctx.engine = NULL;
+    if (sec_hw && chb_aes_ready())
+    {
+        chb_aes_set_key(sec_key);
+        sec_ctx.engine = chb_sec_engine;
+    }
+}
+
+/**************************************************************************/
+/*!
+    Reserve the next CHB_SEC_COUNTER_STEP frame counters in EEPROM
+*/
+/**************************************************************************/
+static void chb_sec_reserve()
+{
+    U8 buf[4];
+
+    tx_reserved = tx_counter + CHB_SEC_COUNTER_STEP;
+    buf[0] = tx_reserved & 0xFF;
+    buf[1] = (tx_reserved >> 8) & 0xFF;
+    buf[2] = (tx_reserved >> 16) & 0xFF;
+    buf[3] = tx_reserved >> 24;
+    chb_eeprom_write(CFG_EEPROM_CHIBI_SECCOUNTER, buf, 4);
+}
+
+/**************************************************************************/
+/*!
+    Fill in the nonce and the authenticated header fields
+*/
+/**************************************************************************/
+static void chb_sec_nonce(U16 src, U16 dest, const U8 *hdr, U8 *nonce, U8 *aad)
+{
+    memset(nonce, 0, CHB_SEC_NONCE_SZ);
+    nonce[0] = src & 0xFF;
+    nonce[1] = src >> 8;
+    memcpy(nonce + 2, hdr + 1, 4);
+
+    aad[0] = dest & 0xFF;
+    aad[1] = dest >> 8;
+    aad[2] = src & 0xFF;
+    aad[3] = src >> 8;
+    memcpy(aad + 4, hdr, CHB_SEC_HDR_SZ);
+}
+
+/**************************************************************************/
+/*!
+    Initialise link security (after chb_init)
+
+    @param[in]  key
+                16 byte network key
+    @param[in]  rx_cb
+                Called with the payload of each authentic frame (can be
+                NULL if this node only sends)
+*/
+/**************************************************************************/
+void chb_sec_init(const U8 *key, chb_sec_rx_cb_t rx_cb)
+{
+    U8 buf[4], sw[16], hw[16];
+
+    memcpy(sec_key, key, CHB_SEC_KEY_SZ);
+    aesKeySetup(&sec_ctx, key);
+    sec_rx_cb = rx_cb;
+    memset(peers, 0xFF, sizeof(peers));
+
+    // a radio without a working aes engine gives a different block
+    memset(sw, 0, sizeof(sw));
+    aesEncryptBlock(&sec_ctx, sw, sw);
+    sec_hw = false;
+    if (chb_aes_ready())
+    {
+        memset(hw, 0, sizeof(hw));
+        chb_aes_set_key(sec_key);
+        sec_hw = chb_aes_ecb(hw, hw) && !memcmp(sw, hw, sizeof(hw));
+    }
+
+    // carry on after the last reserved counter (0xFFFFFFFF is blank eeprom)
+    chb_eeprom_read(CFG_EEPROM_CHIBI_SECCOUNTER, buf, 4);
+    tx_counter = buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((U32)buf[3] << 24);
+    if (tx_counter == 0xFFFFFFFF)
+    {
+        tx_counter = 0;
+    }
+    chb_sec_reserve();
+}
+
+/**************************************************************************/
+/*!
+    Encrypt and send up to CHB_SEC_MAX_PAYLOAD bytes. Returns the status
+    of chb_write, or CHB_INVALID if the data is too long or the frame
+    counter has run out (a new key is needed).
+*/
+/**************************************************************************/
+U8 chb_sec_write(U16 addr, const U8 *data, U8 len)
+{
+    U8 frm[CHB_MAX_PAYLOAD], nonce[CHB_SEC_NONCE_SZ], aad[CHB_SEC_AAD_SZ];
+
+    if ((len > CHB_SEC_MAX_PAYLOAD) || (tx_counter == 0xFFFFFFFF))
+    {
+        return CHB_INVALID;
+    }
+    if (tx_counter >= tx_reserved)
+    {
+        chb_sec_reserve();
+    }
+
+    frm[0] = CHB_SEC_DATA;
+    frm[1] = tx_counter & 0xFF;
+    frm[2] = (tx_counter >> 8) & 0xFF;
+    frm[3] = (tx_counter >> 16) & 0xFF;
+    frm[4] = tx_counter >> 24;
+    tx_counter++;
+    memcpy(frm + CHB_SEC_HDR_SZ, data, len);
+
+    chb_sec_nonce(chb_get_pcb()->src_addr, addr, frm, nonce, aad);
+    chb_sec_begin();
+    aesCcmEncrypt(&sec_ctx, nonce, CHB_SEC_NONCE_SZ, aad, CHB_SEC_AAD_SZ,
+                  frm + CHB_SEC_HDR_SZ, len, frm + CHB_SEC_HDR_SZ + len, CHB_SEC_MIC_SZ);
+
+    return chb_write(addr, frm, CHB_SEC_HDR_SZ + len + CHB_SEC_MIC_SZ);
+}
+
+/**************************************************************************/
+/*!
+    Pass a received frame (from chb_read_frame) to the security layer.
+    Returns true if it was an encrypted frame (authentic ones are
+    decrypted in place and handed to the rx callback, the rest are
+    dropped), false if it should be handled by the application. The
+    caller still frees the frame.
+*/
+/**************************************************************************/
+bool chb_sec_rx(chb_rx_frame_t *frm)
+{
+    U8 *p = frm->data;
+    U8 i, len, nonce[CHB_SEC_NONCE_SZ], aad[CHB_SEC_AAD_SZ];
+    U32 counter;
+
+    if ((frm->len < CHB_SEC_HDR_SZ + CHB_SEC_MIC_SZ) || (p[0] != CHB_SEC_DATA))
+    {
+        return false;
+    }
+
+    counter = p[1] | (p[2] << 8) | (p[3] << 16) | ((U32)p[4] << 24);
+    for (i=0; i<CHB_SEC_PEERS; i++)
+    {
+        if (peers[i].addr == frm->src_addr)
+        {
+            break;
+        }
+    }
+    if ((i < CHB_SEC_PEERS) && (counter <= peers[i].counter))
+    {
+        // replayed (or a retry that chb.c didn't catch)
+        return true;
+    }
+
+    len = frm->len - CHB_SEC_HDR_SZ - CHB_SEC_MIC_SZ;
+    chb_sec_nonce(frm->src_addr, frm->dest_addr, p, nonce, aad);
+    chb_sec_begin();
+    if (!aesCcmDecrypt(&sec_ctx, nonce, CHB_SEC_NONCE_SZ, aad, CHB_SEC_AAD_SZ,
+                       p + CHB_SEC_HDR_SZ, len, p + CHB_SEC_HDR_SZ + len, CHB_SEC_MIC_SZ))
+    {
+        return true;
+    }
+
+    // only authentic frames move the counter on
+    if (i == CHB_SEC_PEERS)
+    {
+        i = peer_idx;
+        peer_idx = (peer_idx + 1) % CHB_SEC_PEERS;
+        peers[i].addr = frm->src_addr;
+    }
+    peers[i].counter = counter;
+
+    if (sec_rx_cb)
+    {
+        sec_rx_cb(frm->src_addr, p + CHB_SEC_HDR_SZ, len);
+    }
+    return true;
+}
+
+/**************************************************************************/
+/*!
+    Returns true if the radio's aes engine is used (false if it failed
+    the check in chb_sec_init and the software aes does all the work)
+*/
+/**************************************************************************/
+bool chb_sec_is_hw()
+{
+    return sec_hw;
+}
@@ -0,0 +1,56 @@
+/**************************************************************************/
+/*! 
+    @file     chb_sec.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef CHB_SEC_H
+#define CHB_SEC_H
+
+#include "types.h"
+#include "chb.h"
+
+#define CHB_SEC_DATA        0xB1    // first payload byte of an encrypted frame
+#define CHB_SEC_HDR_SZ      5       // type + frame counter (1 + 4)
+#define CHB_SEC_MIC_SZ      4       // authentication tag
+#define CHB_SEC_KEY_SZ      16
+#define CHB_SEC_MAX_PAYLOAD (CHB_MAX_PAYLOAD - CHB_SEC_HDR_SZ - CHB_SEC_MIC_SZ)
+
+// called with the decrypted payload of each authentic frame
+typedef void (*chb_sec_rx_cb_t)(U16 src_addr, U8 *data, U8 len);
+
+void chb_sec_init(const U8 *key, chb_sec_rx_cb_t rx_cb);
+U8 chb_sec_write(U16 addr, const U8 *data, U8 len);
+bool chb_sec_rx(chb_rx_frame_t *frm);
+bool chb_sec_is_hw();
+
+#endif
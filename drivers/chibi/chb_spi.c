@@ -42,6 +42,9 @@
 #include "chb_spi.h"
 #include "core/ssp/ssp.h"
 
+// bus settings for the radio, only loaded when another device used ssp0 last
+sspDevice_t chb_ssp_dev;
+
 /**************************************************************************/
 /*!
 
@@ -51,6 +54,7 @@ void chb_spi_init()
 {
     // initialise spi, high between frames and transition on trailing edge
     sspInit(0, sspClockPolarity_High, sspClockPhase_FallingEdge);
+    sspDeviceRegister(&chb_ssp_dev, CHB_SPI_CLOCK, sspClockPolarity_High, sspClockPhase_FallingEdge);
 
     // set the slave select to idle
     CHB_SPI_DISABLE();
@@ -75,3 +79,32 @@ U8 chb_xfer_byte(U8 data)
     // Read the queue
     return SSP_SSP0DR;
 }
+
+/**************************************************************************/
+/*!
+    Write a block of data as one pipelined transfer (the data clocked back
+    in is discarded). SSEL has to be driven by the caller.
+*/
+/**************************************************************************/
+void chb_xfer_write(U8 *data, U8 len)
+{
+    if (len)
+    {
+        sspSend(0, data, len);
+    }
+}
+
+/**************************************************************************/
+/*!
+    Read a block of data as one pipelined transfer (0xFF is clocked out,
+    which the radio ignores during frame buffer and sram reads). SSEL has
+    to be driven by the caller.
+*/
+/**************************************************************************/
+void chb_xfer_read(U8 *data, U8 len)
+{
+    if (len)
+    {
+        sspReceive(0, data, len);
+    }
+}
@@ -44,19 +44,26 @@
 
 #include "projectconfig.h"
 #include "core/gpio/gpio.h"
+#include "core/ssp/ssp.h"
 
 #define CHB_SSPORT          (0) // P0.2 = SSEL
 #define CHB_SSPIN           (2)
+#define CHB_SPI_CLOCK       (4000000)
 
-#define CHB_SPI_ENABLE()    do {gpioSetValue(CHB_SSPORT, CHB_SSPIN, 0);} while (0)  // Drive SSEL low
-#define CHB_SPI_DISABLE()   do {gpioSetValue(CHB_SSPORT, CHB_SSPIN, 1);} while (0)  // Drive SSEL high
+// Every radio access takes the shared SSP bus (see sspDeviceAcquire)
+#define CHB_SPI_ENABLE()    do {sspDeviceAcquire(&chb_ssp_dev); gpioSetValue(CHB_SSPORT, CHB_SSPIN, 0);} while (0)  // Drive SSEL low
+#define CHB_SPI_DISABLE()   do {gpioSetValue(CHB_SSPORT, CHB_SSPIN, 1); sspDeviceRelease(&chb_ssp_dev);} while (0)  // Drive SSEL high
 
 #define CHB_SPIPORT     0
 #define CHB_SCK         1                 // PB.1 - Output: SPI Serial Clock (SCLK)
 #define CHB_MOSI        2                 // PB.2 - Output: SPI Master out - slave in (MOSI)
 #define CHB_MISO        3                 // PB.3 - Input:  SPI Master in - slave out (MISO)
 
+extern sspDevice_t chb_ssp_dev;
+
 void chb_spi_init();
 U8 chb_xfer_byte(U8 data);
+void chb_xfer_write(U8 *data, U8 len);
+void chb_xfer_read(U8 *data, U8 len);
 
 #endif
@@ -0,0 +1,442 @@
+/**************************************************************************/
+/*! 
+    @file     chb_tsync.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Network time synchronisation on top of chb.c (along the lines of
+    FTSP).
+
+    One node is the root and its chb_time_us clock is the network time.
+    Every CFG_CHIBI_TSYNC_PERIODMS each synchronised node broadcasts a
+    beacon.  The radio irq is latched when a frame starts arriving
+    (RX_START) and when a transmission ends, so both ends of a beacon
+    see the same moment of the frame, without the CSMA backoff or any
+    software delays in between.  The sender can only know the network
+    time of that moment once the beacon has gone out, so each beacon
+    carries the time of the previous one, and the receiver pairs it
+    with the timestamp it kept for that beacon.
+
+    The last CFG_CHIBI_TSYNC_POINTS pairs go into a fixed-point linear
+    regression that gives the offset to the root's clock and the drift
+    (skew) between the two crystals, so the network time keeps running
+    at the right rate between beacons and for a while after they stop.
+
+    A node takes the beacons of the neighbour closest to the root (the
+    lowest level) and beacons with level + 1 itself once it is in sync,
+    so the time spreads over several hops.  If the parent isn't heard
+    for three periods the node looks for another one.
+
+    The clock is 32-bit timer 0 with CFG_CHIBI_TIMESTAMP or the systick
+    timer otherwise (leaving timer 0 to CFG_ADC_TRIGGER).  Both count
+    microseconds and wrap around every 71 minutes, so compare times with
+    a signed difference.
+
+    @section Example
+
+    @code 
+    // every node, the one with the gps receiver is the root
+    chb_init();
+    chb_tsync_init(hasGps);
+
+    // in the receive loop
+    chb_rx_frame_t *frm;
+    while ((frm = chb_read_frame()) != NULL)
+    {
+        if (!chb_tsync_rx(frm))
+        {
+            // not a time beacon, handle it here
+        }
+        chb_free_frame(frm);
+    }
+
+    // sample on every node at the same network time (t was sent to
+    // all of them beforehand)
+    U32 start = chb_tsync_to_local(t);
+    while ((S32)(chb_time_us() - start) < 0);
+    adcTriggerStart(0, 1000, samples, 256, samplesReady);
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "chb_tsync.h"
+#include "chb_drvr.h"
+
+#include "core/systick/systick.h"
+
+#ifdef CFG_SCHEDULER
+    #include "core/sched/sched.h"
+#endif
+
+#define CHB_TSYNC_TICKS(ms) ((ms) / CFG_SYSTICK_DELAY_IN_MS)
+#define CHB_TSYNC_VALID     0x01    // flags: the global time of the previous beacon is valid
+#define CHB_TSYNC_RESET_US  10000   // a pair this far off the estimate restarts the regression
+#define CHB_TSYNC_LOST      3       // periods without the parent before looking for another one
+
+// time from the end of the phr (rx_start) to the end of a beacon (trx_end)
+#define CHB_TSYNC_AIR_US    ((CHB_HDR_SZ + CHB_TSYNC_LEN + CHB_FCS_LEN) * CHB_BYTE_US)
+
+static bool tsync_root = false;
+static U8 tsync_level = CHB_TSYNC_UNSYNCED;
+
+// the neighbour we take the time from and its last beacon
+static U16 parent;
+static U8 parent_seq;
+static U32 parent_rx_us;
+static bool parent_rx_valid = false;
+static U32 parent_tick;
+
+// our own last beacon
+static U8 tx_seq = 0;
+static U32 tx_global;
+static bool tx_valid = false;
+
+// (local time, global - local) pairs for the regression
+static U32 pt_local[CFG_CHIBI_TSYNC_POINTS];
+static S32 pt_offset[CFG_CHIBI_TSYNC_POINTS];
+static U8 pt_cnt = 0;
+static U8 pt_idx = 0;
+
+// result: global = local + est_offset + (local - est_local) * est_skew / 2^32
+static bool est_valid = false;
+static U32 est_local;
+static S32 est_offset;
+static S32 est_skew;
+
+#ifdef CFG_SCHEDULER
+static schedTask_t tsync_task;
+#else
+static U32 next_tick;
+#endif
+
+/**************************************************************************/
+/*!
+    Least squares fit of the offset over the local time. The local times
+    are taken in 256us units for the sums so that they fit in 64 bits.
+*/
+/**************************************************************************/
+static void chb_tsync_fit()
+{
+    U8 i;
+    U32 ref = pt_local[0];
+    S32 dx, dy, xm, ym;
+    int64_t sx = 0, sy = 0, num = 0, den = 0;
+
+    for (i=0; i<pt_cnt; i++)
+    {
+        sx += (S32)(pt_local[i] - ref);
+        sy += pt_offset[i];
+    }
+    xm = sx / pt_cnt;
+    ym = sy / pt_cnt;
+
+    for (i=0; i<pt_cnt; i++)
+    {
+        dx = ((S32)(pt_local[i] - ref) - xm) >> 8;
+        dy = pt_offset[i] - ym;
+        num += (int64_t)dx * dy;
+        den += (int64_t)dx * dx;
+    }
+
+    est_local = ref + xm;
+    est_offset = ym;
+    est_skew = den ? (S32)((num << 24) / den) : 0;
+    est_valid = true;
+}
+
+/**************************************************************************/
+/*!
+    Add a (local, global) pair and update the estimate
+*/
+/**************************************************************************/
+static void chb_tsync_add(U32 local, U32 global)
+{
+    S32 err;
+
+    // a jump (the parent's time base changed or a beacon was paired
+    // with the wrong timestamp) makes the old pairs useless
+    if (est_valid)
+    {
+        err = (S32)(global - chb_tsync_to_global(local));
+        if ((err > CHB_TSYNC_RESET_US) || (err < -CHB_TSYNC_RESET_US))
+        {
+            pt_cnt = 0;
+            pt_idx = 0;
+        }
+    }
+
+    pt_local[pt_idx] = local;
+    pt_offset[pt_idx] = (S32)(global - local);
+    pt_idx = (pt_idx + 1) % CFG_CHIBI_TSYNC_POINTS;
+    if (pt_cnt < CFG_CHIBI_TSYNC_POINTS)
+    {
+        pt_cnt++;
+    }
+    chb_tsync_fit();
+}
+
+/**************************************************************************/
+/*!
+    Broadcast a beacon with the network time of the previous one
+*/
+/**************************************************************************/
+static void chb_tsync_send()
+{
+    U8 status, hdr[CHB_HDR_SZ + 1], frm[CHB_TSYNC_LEN];
+    chb_pcb_t *pcb = chb_get_pcb();
+
+    // the parent has gone quiet: take the next one we hear
+    if (!tsync_root && (tsync_level != CHB_TSYNC_UNSYNCED) &&
+        (systickGetTicks() - parent_tick > CHB_TSYNC_TICKS(CHB_TSYNC_LOST * CFG_CHIBI_TSYNC_PERIODMS)))
+    {
+        tsync_level = CHB_TSYNC_UNSYNCED;
+        parent_rx_valid = false;
+    }
+    if (!tsync_root && ((tsync_level == CHB_TSYNC_UNSYNCED) || !est_valid))
+    {
+        return;
+    }
+
+    frm[0] = CHB_TSYNC_BEACON;
+    frm[1] = ++tx_seq;
+    frm[2] = tsync_root ? 0 : tsync_level;
+    frm[3] = tx_valid ? CHB_TSYNC_VALID : 0;
+    frm[4] = tx_global & 0xFF;
+    frm[5] = (tx_global >> 8) & 0xFF;
+    frm[6] = (tx_global >> 16) & 0xFF;
+    frm[7] = tx_global >> 24;
+
+#if CFG_CHIBI_TXQUEUE > 0
+    // the frame has to go out by itself, not from the queue, so that
+    // pcb->tx_end_us belongs to it
+    while (chb_tx_queue_free() != CFG_CHIBI_TXQUEUE);
+#endif
+
+    // sent once, without chb_write's broadcast repeats: the receivers
+    // keep the timestamp of the first copy, the sender only knows the
+    // last one
+    chb_gen_hdr(hdr, CHB_BROADCAST, CHB_TSYNC_LEN);
+    status = chb_tx(hdr, frm, CHB_TSYNC_LEN);
+    tx_valid = (status == CHB_SUCCESS);
+    if (tx_valid)
+    {
+        tx_global = chb_tsync_to_global(pcb->tx_end_us - CHB_TSYNC_AIR_US);
+    }
+}
+
+#ifdef CFG_SCHEDULER
+/**************************************************************************/
+/*!
+    Scheduler task: send the next beacon
+*/
+/**************************************************************************/
+static void chb_tsync_task(schedTask_t *task)
+{
+    chb_tsync_send();
+}
+#endif
+
+/**************************************************************************/
+/*!
+    Start time synchronisation
+
+    @param[in]  root
+                true on the one node whose clock is the network time
+*/
+/**************************************************************************/
+void chb_tsync_init(bool root)
+{
+    // neighbours at the same level beacon at different times
+    U32 first = (CFG_CHIBI_TSYNC_PERIODMS / 2) + (chb_get_pcb()->src_addr % (CFG_CHIBI_TSYNC_PERIODMS / 2));
+
+    tsync_root = root;
+    tsync_level = root ? 0 : CHB_TSYNC_UNSYNCED;
+    parent_rx_valid = false;
+    tx_valid = false;
+    pt_cnt = 0;
+    pt_idx = 0;
+    est_valid = false;
+
+#ifdef CFG_SCHEDULER
+    schedTaskInit(&tsync_task, chb_tsync_task, NULL);
+    schedStartTimer(&tsync_task, first, CFG_CHIBI_TSYNC_PERIODMS);
+#else
+    next_tick = systickGetTicks() + CHB_TSYNC_TICKS(first);
+#endif
+}
+
+/**************************************************************************/
+/*!
+    Send the beacon when it's due. Without CFG_SCHEDULER this has to be
+    called regularly, with it the beacons go out by themselves.
+*/
+/**************************************************************************/
+void chb_tsync_poll()
+{
+#ifndef CFG_SCHEDULER
+    if ((S32)(systickGetTicks() - next_tick) >= 0)
+    {
+        next_tick += CHB_TSYNC_TICKS(CFG_CHIBI_TSYNC_PERIODMS);
+        chb_tsync_send();
+    }
+#endif
+}
+
+/**************************************************************************/
+/*!
+    Pass a received frame (from chb_read_frame) to the time sync layer.
+    Returns true if it was a time beacon, false if it should be handled
+    by the application. The caller still frees the frame.
+*/
+/**************************************************************************/
+bool chb_tsync_rx(chb_rx_frame_t *frm)
+{
+    U8 *p = frm->data;
+    U8 level;
+    U32 global;
+
+    if ((frm->len != CHB_TSYNC_LEN) || (p[0] != CHB_TSYNC_BEACON))
+    {
+        return false;
+    }
+
+    level = p[2];
+    if (tsync_root || (level == CHB_TSYNC_UNSYNCED))
+    {
+        return true;
+    }
+
+    // a neighbour closer to the root becomes the parent. the network
+    // time is the same, so the pairs collected so far stay valid.
+    if ((frm->src_addr != parent) &&
+        ((tsync_level == CHB_TSYNC_UNSYNCED) || (level + 1 < tsync_level)))
+    {
+        parent = frm->src_addr;
+        parent_rx_valid = false;
+    }
+    if (frm->src_addr != parent)
+    {
+        return true;
+    }
+    tsync_level = level + 1;
+    parent_tick = systickGetTicks();
+
+    // the global time in this beacon is the one of the previous beacon
+    if ((p[3] & CHB_TSYNC_VALID) && parent_rx_valid && (p[1] == (U8)(parent_seq + 1)))
+    {
+        global = p[4] | (p[5] << 8) | (p[6] << 16) | ((U32)p[7] << 24);
+        chb_tsync_add(parent_rx_us, global);
+    }
+    parent_seq = p[1];
+    parent_rx_us = frm->timestamp;
+    parent_rx_valid = true;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+    Returns true if this node is the root or follows a parent
+*/
+/**************************************************************************/
+bool chb_tsync_is_synced()
+{
+    return tsync_root || ((tsync_level != CHB_TSYNC_UNSYNCED) && est_valid);
+}
+
+/**************************************************************************/
+/*!
+    Returns the number of hops to the root (CHB_TSYNC_UNSYNCED if there
+    is no parent)
+*/
+/**************************************************************************/
+U8 chb_tsync_get_level()
+{
+    return tsync_level;
+}
+
+/**************************************************************************/
+/*!
+    Returns how much faster the root's clock runs than ours, in parts
+    per 2^32 (4295 is 1 ppm)
+*/
+/**************************************************************************/
+S32 chb_tsync_get_skew()
+{
+    return est_valid ? est_skew : 0;
+}
+
+/**************************************************************************/
+/*!
+    Returns the current network time in microseconds
+*/
+/**************************************************************************/
+U32 chb_tsync_now()
+{
+    return chb_tsync_to_global(chb_time_us());
+}
+
+/**************************************************************************/
+/*!
+    Converts a chb_time_us value (a frame timestamp, for example) to
+    network time. Before the first beacon pair it is returned as is.
+*/
+/**************************************************************************/
+U32 chb_tsync_to_global(U32 local)
+{
+    if (tsync_root || !est_valid)
+    {
+        return local;
+    }
+    return local + est_offset + (S32)(((int64_t)(S32)(local - est_local) * est_skew) >> 32);
+}
+
+/**************************************************************************/
+/*!
+    Converts a network time to the chb_time_us value it happens at
+*/
+/**************************************************************************/
+U32 chb_tsync_to_local(U32 global)
+{
+    U32 local;
+
+    if (tsync_root || !est_valid)
+    {
+        return global;
+    }
+
+    // the skew is tiny, so one step from the offset alone is exact to
+    // well below a microsecond
+    local = global - est_offset;
+    return local - (S32)(((int64_t)(S32)(local - est_local) * est_skew) >> 32);
+}
@@ -0,0 +1,56 @@
+/**************************************************************************/
+/*! 
+    @file     chb_tsync.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef CHB_TSYNC_H
+#define CHB_TSYNC_H
+
+#include "types.h"
+#include "chb.h"
+
+#define CHB_TSYNC_BEACON    0xF1    // first payload byte of a time beacon
+#define CHB_TSYNC_LEN       8       // type + seq + level + flags + global time (1 + 1 + 1 + 1 + 4)
+#define CHB_TSYNC_UNSYNCED  0xFF    // level of a node that has no parent
+
+void chb_tsync_init(bool root);
+void chb_tsync_poll();
+bool chb_tsync_rx(chb_rx_frame_t *frm);
+bool chb_tsync_is_synced();
+U8 chb_tsync_get_level();
+S32 chb_tsync_get_skew();
+U32 chb_tsync_now();
+U32 chb_tsync_to_global(U32 local);
+U32 chb_tsync_to_local(U32 global);
+
+#endif
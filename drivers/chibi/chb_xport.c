@@ -0,0 +1,504 @@
+/**************************************************************************/
+/*! 
+    @file     chb_xport.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Transport layer for moving large blocks of data (firmware images, log
+    files, ...) between two nodes on top of chb.c.
+
+    The data is split into numbered fragments of CHB_XPORT_FRAG_SZ bytes.
+    The sender keeps up to CFG_CHIBI_XPORT_WINDOW fragments in flight
+    without waiting for each one to be acknowledged.  The receiver buffers
+    fragments that arrive out of order, hands the data to the application
+    in order as soon as it's contiguous, and acknowledges with the next
+    fragment it expects plus a bitmap of the fragments it already holds
+    beyond that.  The sender then only retransmits the fragments that are
+    missing.  Nothing is retransmitted blindly until no ack has been seen
+    for CFG_CHIBI_XPORT_TIMEOUTMS.
+
+    One transfer can be in progress in each direction.  The receiver only
+    needs room for one window of fragments, so transfers can be much
+    larger than the available RAM.  The data being sent is not copied and
+    must stay valid until the transfer has completed.
+
+    With CFG_CHIBI_XPORT_LZ, chb_xport_send_lz sends data that was
+    compressed with lzCompress, and the receiver decompresses it as the
+    fragments come in order, so the application gets the original data
+    (and offsets) just like for chb_xport_send.  Only the number of
+    fragments on the air changes.
+
+    @section Example
+
+    @code 
+    // in the receive loop
+    chb_rx_frame_t *frm;
+    while ((frm = chb_read_frame()) != NULL)
+    {
+        if (!chb_xport_rx(frm))
+        {
+            // not a transport frame, handle it here
+        }
+        chb_free_frame(frm);
+    }
+
+    // and from a periodic task (or the main loop)
+    chb_xport_poll();
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "chb_xport.h"
+#include "chb_drvr.h"
+
+#include "core/systick/systick.h"
+
+#ifdef CFG_CHIBI_XPORT_LZ
+    #include "core/compress/lz.h"
+#endif
+
+#define CHB_XPORT_TIMEOUT_TICKS   (CFG_CHIBI_XPORT_TIMEOUTMS / CFG_SYSTICK_DELAY_IN_MS)
+
+#ifdef CFG_CHIBI_XPORT_LZ
+    #define CHB_XPORT_IS_DATA(type)   (((type) == CHB_XPORT_DATA) || ((type) == CHB_XPORT_DATA_LZ))
+#else
+    #define CHB_XPORT_IS_DATA(type)   ((type) == CHB_XPORT_DATA)
+#endif
+
+static chb_xport_rx_cb_t xport_rx_cb = NULL;
+
+// outgoing transfer. bit i of the bitmaps is fragment base + i.
+static struct
+{
+    bool active;
+    U8 id;
+    U8 type;                    // CHB_XPORT_DATA or CHB_XPORT_DATA_LZ
+    U16 addr;
+    const U8 *data;
+    U32 len;
+    U16 total;                  // number of fragments
+    U16 base;                   // oldest fragment that hasn't been acked
+    U8 sent;                    // sent and not presumed lost
+    U8 acked;                   // acked out of order
+    U8 retries;
+    U32 last_tick;              // last time something was sent or acked
+    chb_xport_tx_cb_t cb;
+} tx;
+
+// incoming transfer (the id/addr/total of the last one are kept so that
+// retransmissions after it completed still get an ack)
+static struct
+{
+    bool active;
+    U8 id;
+    U16 addr;
+    U16 total;
+    U16 base;                   // next fragment to hand to the application
+    U8 have;                    // buffered fragments (bit i is base + i)
+    U32 offset;                 // (of the decompressed data for lz transfers)
+    bool lz;
+    U8 len[CFG_CHIBI_XPORT_WINDOW];
+    U8 buf[CFG_CHIBI_XPORT_WINDOW][CHB_XPORT_FRAG_SZ];
+} rx;
+
+#ifdef CFG_CHIBI_XPORT_LZ
+static lzDecoder_t rx_lz;
+#endif
+
+/**************************************************************************/
+/*!
+    Send one frame with a transport header
+*/
+/**************************************************************************/
+static bool chb_xport_write(U16 addr, U8 type, U8 id, U16 a, U16 b, const U8 *data, U8 len)
+{
+    U8 frm[CHB_MAX_PAYLOAD];
+
+    frm[0] = type;
+    frm[1] = id;
+    frm[2] = a & 0xFF;
+    frm[3] = a >> 8;
+    frm[4] = b & 0xFF;
+    frm[5] = b >> 8;
+    memcpy(frm + CHB_XPORT_HDR_SZ, data, len);
+
+#if CFG_CHIBI_TXQUEUE > 0
+    // don't block the caller: leave it for the next poll if the queue is full
+    return chb_write_async(addr, frm, CHB_XPORT_HDR_SZ + len, NULL, NULL) == CHB_SUCCESS;
+#else
+    chb_write(addr, frm, CHB_XPORT_HDR_SZ + len);
+    return true;
+#endif
+}
+
+/**************************************************************************/
+/*!
+    Acknowledge the fragments received so far
+*/
+/**************************************************************************/
+static void chb_xport_ack()
+{
+    chb_xport_write(rx.addr, CHB_XPORT_ACK, rx.id, rx.base, rx.have, NULL, 0);
+}
+
+/**************************************************************************/
+/*!
+    End the outgoing transfer
+*/
+/**************************************************************************/
+static void chb_xport_tx_finish(U8 status)
+{
+    tx.active = false;
+    if (tx.cb)
+    {
+        tx.cb(status);
+    }
+}
+
+/**************************************************************************/
+/*!
+    Initialise the transport layer
+
+    @param[in]  rx_cb
+                Called with the data of incoming transfers (can be NULL if
+                this node only sends)
+*/
+/**************************************************************************/
+void chb_xport_init(chb_xport_rx_cb_t rx_cb)
+{
+    memset(&tx, 0, sizeof(tx));
+    memset(&rx, 0, sizeof(rx));
+    xport_rx_cb = rx_cb;
+}
+
+/**************************************************************************/
+/*!
+    Start an outgoing transfer with data frames of the given type
+*/
+/**************************************************************************/
+static U8 chb_xport_start(U16 addr, U8 type, const U8 *data, U32 len, chb_xport_tx_cb_t cb)
+{
+    U32 frags = (len + CHB_XPORT_FRAG_SZ - 1) / CHB_XPORT_FRAG_SZ;
+
+    if (tx.active || !len || (frags > 0xFFFF) || (addr == 0xFFFF))
+    {
+        return CHB_INVALID;
+    }
+
+    tx.id++;
+    tx.type = type;
+    tx.addr = addr;
+    tx.data = data;
+    tx.len = len;
+    tx.total = frags;
+    tx.base = 0;
+    tx.sent = 0;
+    tx.acked = 0;
+    tx.retries = 0;
+    tx.last_tick = systickGetTicks();
+    tx.cb = cb;
+    tx.active = true;
+
+    chb_xport_poll();
+    return CHB_SUCCESS;
+}
+
+/**************************************************************************/
+/*!
+    Start sending a block of data to another node. The transfer is driven
+    by chb_xport_poll and chb_xport_rx.
+
+    Returns CHB_SUCCESS if the transfer was started, or CHB_INVALID if
+    another one is in progress or the arguments are out of range.
+*/
+/**************************************************************************/
+U8 chb_xport_send(U16 addr, const U8 *data, U32 len, chb_xport_tx_cb_t cb)
+{
+    return chb_xport_start(addr, CHB_XPORT_DATA, data, len, cb);
+}
+
+#ifdef CFG_CHIBI_XPORT_LZ
+/**************************************************************************/
+/*!
+    Same as chb_xport_send for data compressed with lzCompress. The
+    receiver hands the decompressed data to its rx callback.
+*/
+/**************************************************************************/
+U8 chb_xport_send_lz(U16 addr, const U8 *packed, U32 len, chb_xport_tx_cb_t cb)
+{
+    return chb_xport_start(addr, CHB_XPORT_DATA_LZ, packed, len, cb);
+}
+#endif
+
+/**************************************************************************/
+/*!
+    Returns true while an outgoing transfer is in progress
+*/
+/**************************************************************************/
+bool chb_xport_busy()
+{
+    return tx.active;
+}
+
+/**************************************************************************/
+/*!
+    Send the fragments in the window that haven't been sent yet and handle
+    ack timeouts. Call this regularly while chb_xport_busy is true.
+*/
+/**************************************************************************/
+void chb_xport_poll()
+{
+    U8 i, len;
+    U16 idx;
+    U32 now = systickGetTicks();
+
+    if (!tx.active)
+    {
+        return;
+    }
+
+    if ((now - tx.last_tick) >= CHB_XPORT_TIMEOUT_TICKS)
+    {
+        if (++tx.retries > CFG_CHIBI_XPORT_RETRIES)
+        {
+            chb_xport_tx_finish(CHB_NO_ACK);
+            return;
+        }
+
+        // nothing heard back: presume everything unacked was lost
+        tx.sent = tx.acked;
+        tx.last_tick = now;
+    }
+
+    for (i=0; i<CFG_CHIBI_XPORT_WINDOW; i++)
+    {
+        idx = tx.base + i;
+        if (idx >= tx.total)
+        {
+            break;
+        }
+        if ((tx.sent | tx.acked) & (1 << i))
+        {
+            continue;
+        }
+
+        len = (idx == tx.total - 1) ? tx.len - (U32)idx * CHB_XPORT_FRAG_SZ : CHB_XPORT_FRAG_SZ;
+        if (!chb_xport_write(tx.addr, tx.type, tx.id, idx, tx.total,
+                             tx.data + (U32)idx * CHB_XPORT_FRAG_SZ, len))
+        {
+            break;
+        }
+        tx.sent |= (1 << i);
+        tx.last_tick = now;
+    }
+}
+
+/**************************************************************************/
+/*!
+    Handle an ack for the outgoing transfer
+*/
+/**************************************************************************/
+static void chb_xport_rx_ack(U16 src_addr, U8 id, U16 base, U8 have)
+{
+    U8 i, shift;
+
+    if (!tx.active || (id != tx.id) || (src_addr != tx.addr) ||
+        (base < tx.base) || (base > tx.total))
+    {
+        return;
+    }
+
+    // slide the window up to the first fragment the receiver is missing
+    shift = ((base - tx.base) < 8) ? base - tx.base : 8;
+    tx.sent = (shift < 8) ? tx.sent >> shift : 0;
+    tx.acked = have;
+    tx.base = base;
+    tx.retries = 0;
+    tx.last_tick = systickGetTicks();
+
+    if (tx.base == tx.total)
+    {
+        chb_xport_tx_finish(CHB_SUCCESS);
+        return;
+    }
+
+    // anything below the highest fragment the receiver holds that it
+    // doesn't have was lost: clear it so that poll sends it again
+    for (i=CFG_CHIBI_XPORT_WINDOW; i>0; i--)
+    {
+        if (have & (1 << (i - 1)))
+        {
+            tx.sent &= ~((1 << (i - 1)) - 1) | have;
+            break;
+        }
+    }
+    chb_xport_poll();
+}
+
+/**************************************************************************/
+/*!
+    Hand the next fragment of the incoming transfer to the application
+*/
+/**************************************************************************/
+static void chb_xport_deliver(U8 *data, U8 len, bool last)
+{
+#ifdef CFG_CHIBI_XPORT_LZ
+    U8 out[CHB_XPORT_FRAG_SZ];
+    U32 used, n;
+    bool done;
+
+    if (rx.lz)
+    {
+        // one fragment can decompress into several blocks
+        do
+        {
+            n = lzDecode(&rx_lz, data, len, &used, out, sizeof(out));
+            data += used;
+            len -= used;
+            done = (len == 0) && (n < sizeof(out));
+            if ((n || (last && done)) && xport_rx_cb)
+            {
+                xport_rx_cb(rx.addr, rx.offset, out, n, last && done);
+            }
+            rx.offset += n;
+        } while (!done);
+        return;
+    }
+#endif
+
+    if (xport_rx_cb)
+    {
+        xport_rx_cb(rx.addr, rx.offset, data, len, last);
+    }
+    rx.offset += len;
+}
+
+/**************************************************************************/
+/*!
+    Handle an incoming data fragment
+*/
+/**************************************************************************/
+static void chb_xport_rx_data(U16 src_addr, U8 type, U8 id, U16 idx, U16 total, U8 *data, U8 len)
+{
+    U8 slot;
+
+    if (!rx.active || (id != rx.id) || (src_addr != rx.addr))
+    {
+        if ((id == rx.id) && (src_addr == rx.addr) && (total == rx.total))
+        {
+            // retransmission of a transfer that has already completed
+            chb_xport_ack();
+            return;
+        }
+        if (idx != 0)
+        {
+            // we missed the start of this one
+            return;
+        }
+
+        rx.active = true;
+        rx.id = id;
+        rx.addr = src_addr;
+        rx.total = total;
+        rx.base = 0;
+        rx.have = 0;
+        rx.offset = 0;
+        rx.lz = (type == CHB_XPORT_DATA_LZ);
+#ifdef CFG_CHIBI_XPORT_LZ
+        lzDecoderInit(&rx_lz);
+#endif
+    }
+
+    if ((idx >= rx.base) && (idx < rx.base + CFG_CHIBI_XPORT_WINDOW) && (idx < rx.total))
+    {
+        slot = idx % CFG_CHIBI_XPORT_WINDOW;
+        memcpy(rx.buf[slot], data, len);
+        rx.len[slot] = len;
+        rx.have |= (1 << (idx - rx.base));
+
+        // hand over everything that is now contiguous
+        while (rx.have & 1)
+        {
+            slot = rx.base % CFG_CHIBI_XPORT_WINDOW;
+            chb_xport_deliver(rx.buf[slot], rx.len[slot], rx.base == rx.total - 1);
+            rx.base++;
+            rx.have >>= 1;
+        }
+        if (rx.base == rx.total)
+        {
+            rx.active = false;
+        }
+
+        // ack at the end of each window, at the end of the transfer, and
+        // whenever there's a gap so the sender can fill it straight away
+        if (!rx.active || rx.have || ((idx + 1) % CFG_CHIBI_XPORT_WINDOW == 0))
+        {
+            chb_xport_ack();
+        }
+        return;
+    }
+
+    // duplicate or outside the window: tell the sender where we are
+    chb_xport_ack();
+}
+
+/**************************************************************************/
+/*!
+    Pass a received frame (from chb_read_frame) to the transport layer.
+    Returns true if it was a transport frame, false if it should be
+    handled by the application. The caller still frees the frame.
+*/
+/**************************************************************************/
+bool chb_xport_rx(chb_rx_frame_t *frm)
+{
+    U8 *p = frm->data;
+    U16 a, b;
+
+    if ((frm->len < CHB_XPORT_HDR_SZ) || (!CHB_XPORT_IS_DATA(p[0]) && (p[0] != CHB_XPORT_ACK)))
+    {
+        return false;
+    }
+
+    a = p[2] | (p[3] << 8);
+    b = p[4] | (p[5] << 8);
+    if (p[0] != CHB_XPORT_ACK)
+    {
+        chb_xport_rx_data(frm->src_addr, p[0], p[1], a, b, p + CHB_XPORT_HDR_SZ, frm->len - CHB_XPORT_HDR_SZ);
+    }
+    else
+    {
+        chb_xport_rx_ack(frm->src_addr, p[1], a, b);
+    }
+    return true;
+}
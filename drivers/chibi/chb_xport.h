@@ -0,0 +1,64 @@
+/**************************************************************************/
+/*! 
+    @file     chb_xport.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef CHB_XPORT_H
+#define CHB_XPORT_H
+
+#include "types.h"
+#include "chb.h"
+
+#define CHB_XPORT_DATA      0xD1    // first payload byte of a transport data frame
+#define CHB_XPORT_ACK       0xD2    // first payload byte of a transport ack frame
+#define CHB_XPORT_DATA_LZ   0xD3    // data frame of a compressed transfer (chb_xport_send_lz)
+#define CHB_XPORT_HDR_SZ    6       // type + xfer id + frag idx + frag count (1 + 1 + 2 + 2)
+#define CHB_XPORT_FRAG_SZ   (CHB_MAX_PAYLOAD - CHB_XPORT_HDR_SZ)
+
+// called when a transfer started with chb_xport_send has completed
+// (CHB_SUCCESS) or given up (CHB_NO_ACK)
+typedef void (*chb_xport_tx_cb_t)(U8 status);
+
+// called for each block of an incoming transfer, in order
+typedef void (*chb_xport_rx_cb_t)(U16 src_addr, U32 offset, U8 *data, U8 len, bool last);
+
+void chb_xport_init(chb_xport_rx_cb_t rx_cb);
+U8 chb_xport_send(U16 addr, const U8 *data, U32 len, chb_xport_tx_cb_t cb);
+#ifdef CFG_CHIBI_XPORT_LZ
+U8 chb_xport_send_lz(U16 addr, const U8 *packed, U32 len, chb_xport_tx_cb_t cb);
+#endif
+bool chb_xport_busy();
+void chb_xport_poll();
+bool chb_xport_rx(chb_rx_frame_t *frm);
+
+#endif
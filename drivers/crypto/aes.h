@@ -0,0 +1,69 @@
+/**************************************************************************/
+/*! 
+    @file     aes.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef _AES_H_
+#define _AES_H_
+
+#include "projectconfig.h"
+
+#define AES_BLOCKSIZE     (16)
+#define AES_ROUNDKEYS     (44)      // 11 round keys of 4 words (AES-128)
+
+/* Encrypts one block with a cipher outside this file (a radio's AES   *
+ * engine, for example) that has been loaded with the same key.        */
+typedef void (*aesEngine_t)(const uint8_t *in, uint8_t *out);
+
+/* Expanded AES-128 encryption key.  CTR and CCM only ever run the     *
+ * cipher forwards, so no decryption schedule is kept.  If 'engine' is *
+ * set (after aesKeySetup) every block goes through it instead.        */
+typedef struct aesContext_s
+{
+  uint32_t rk[AES_ROUNDKEYS];
+  aesEngine_t engine;
+}
+aesContext_t;
+
+void aesKeySetup(aesContext_t *ctx, const uint8_t *key);
+void aesEncryptBlock(const aesContext_t *ctx, const uint8_t *in, uint8_t *out);
+void aesCtrCrypt(const aesContext_t *ctx, uint8_t *counter, uint8_t *data, uint32_t len);
+void aesCcmEncrypt(const aesContext_t *ctx, const uint8_t *nonce, uint8_t nonceLen,
+                   const uint8_t *aad, uint32_t aadLen, uint8_t *data, uint32_t len,
+                   uint8_t *tag, uint8_t tagLen);
+bool aesCcmDecrypt(const aesContext_t *ctx, const uint8_t *nonce, uint8_t nonceLen,
+                   const uint8_t *aad, uint32_t aadLen, uint8_t *data, uint32_t len,
+                   const uint8_t *tag, uint8_t tagLen);
+
+#endif
@@ -0,0 +1,314 @@
+/**************************************************************************/
+/*! 
+    @file     random.c
+    @author   K. Townsend (microBuilder.eu)
+    @section DESCRIPTION
+
+    Entropy pool and random number generators.  There is no hardware
+    RNG on the LPC1343, so the entropy comes from the noise in the low
+    bits of an ADC channel (CFG_RANDOM_ADCCHANNEL) and the DWT cycle
+    counter at boot, the chip's unique ID (which doesn't add entropy,
+    but makes sure two boards never share a state), the AT86RF212's
+    random bits (randomSeedRadio, from sysinitChibi) and the arrival
+    times and signal levels of received frames.
+
+    Everything goes through SHA-256 into a 32-byte key, from which two
+    generators are run:
+
+    - randomBytes is a hash DRBG: each 32-byte block of output is
+      SHA-256(key, counter), and the key is replaced with a new hash
+      after every request, so a key read out of RAM later doesn't give
+      away earlier output.  Use it for nonces and keys.  It costs one
+      SHA-256 block (a few thousand cycles) per 32 bytes, and isn't
+      reentrant, so it must not be called from interrupts.
+
+    - randomGet/randomRange is xoshiro128**, seeded from the DRBG at
+      every reseed.  It takes a few cycles and can be called anywhere
+      (radio back-off, scheduler and polling jitter), but its output
+      is predictable from earlier output, so never use it for secrets.
+
+    randomAddSample is cheap enough for interrupt handlers: it only
+    folds the sample into an 8-word pool, which is hashed into the key
+    by the next randomReseed, or by randomBytes once RANDOM_RESEEDSAMPLES
+    samples have come in.
+
+    @code
+    uint8_t nonce[13];
+
+    randomBytes(nonce, sizeof(nonce));            // Crypto nonce
+    schedStartTimer(&task, 100 + randomRange(20), 0);  // 100..119ms
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include <string.h>
+
+#include "random.h"
+#include "sha256.h"
+#include "core/adc/adc.h"
+#include "core/iap/iap.h"
+
+#ifdef CFG_CHIBI
+  #include "drivers/chibi/chb_drvr.h"
+#endif
+
+#ifdef CFG_RANDOM
+
+#define RANDOM_ADCSAMPLES     (256)   // ADC readings hashed by randomInit
+#define RANDOM_RADIOBYTES     (32)    // Radio random bytes per randomSeedRadio
+#define RANDOM_RESEEDSAMPLES  (32)    // Pool samples before randomBytes reseeds
+#define RANDOM_POOLSIZE       (8)     // Words in the sample pool (power of 2)
+
+static uint8_t _randomKey[SHA256_DIGESTSIZE];
+static uint32_t _randomCounter = 0;
+static uint32_t _randomFast[4];
+static volatile uint32_t _randomPool[RANDOM_POOLSIZE];
+static volatile uint32_t _randomPoolIndex = 0;
+static volatile uint32_t _randomPoolCount = 0;
+
+/**************************************************************************/
+/*! 
+    Private - Rotates a 32-bit word left
+*/
+/**************************************************************************/
+static inline uint32_t randomRotl(uint32_t x, uint32_t n)
+{
+  return (x << n) | (x >> (32 - n));
+}
+
+/**************************************************************************/
+/*! 
+    Private - out = SHA-256(key, counter++)
+*/
+/**************************************************************************/
+static void randomBlock(uint8_t *out)
+{
+  sha256Context_t sha;
+
+  sha256Init(&sha);
+  sha256Update(&sha, _randomKey, sizeof(_randomKey));
+  sha256Update(&sha, (const uint8_t *)&_randomCounter, sizeof(_randomCounter));
+  sha256Final(&sha, out);
+  _randomCounter++;
+}
+
+/**************************************************************************/
+/*! 
+    Private - Hashes the pool and 'data' (if any) into the key, and
+    seeds the fast generator again
+*/
+/**************************************************************************/
+static void randomMix(const uint8_t *data, uint32_t len)
+{
+  sha256Context_t sha;
+  uint32_t pool[RANDOM_POOLSIZE];
+  uint8_t block[SHA256_DIGESTSIZE];
+  uint32_t cycles = DWT_CYCCNT;
+  uint8_t i;
+
+  // An interrupt adding a sample meanwhile can only lose that sample
+  for (i = 0; i < RANDOM_POOLSIZE; i++)
+  {
+    pool[i] = _randomPool[i];
+  }
+  _randomPoolCount = 0;
+
+  sha256Init(&sha);
+  sha256Update(&sha, _randomKey, sizeof(_randomKey));
+  sha256Update(&sha, (const uint8_t *)&_randomCounter, sizeof(_randomCounter));
+  sha256Update(&sha, (const uint8_t *)pool, sizeof(pool));
+  sha256Update(&sha, (const uint8_t *)&cycles, sizeof(cycles));
+  if (len)
+  {
+    sha256Update(&sha, data, len);
+  }
+  sha256Final(&sha, _randomKey);
+  _randomCounter++;
+
+  // xoshiro128** must not start from all zeros
+  do
+  {
+    randomBlock(block);
+    memcpy(_randomFast, block, sizeof(_randomFast));
+  } while (!(_randomFast[0] | _randomFast[1] | _randomFast[2] | _randomFast[3]));
+  memset(block, 0, sizeof(block));
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Seeds the pool from ADC noise, the cycle counter and the
+            device's unique ID.  adcInit must have been called.
+*/
+/**************************************************************************/
+void randomInit(void)
+{
+  sha256Context_t sha;
+  IAP_return_t uid;
+  uint32_t sample;
+  uint16_t i;
+
+  sha256Init(&sha);
+
+  uid = iapReadSerialNumber();
+  sha256Update(&sha, (const uint8_t *)uid.Result, sizeof(uid.Result));
+
+  // Only the last bit or two of each reading are noise, and the time
+  // each conversion takes varies by a few cycles
+  for (i = 0; i < RANDOM_ADCSAMPLES; i++)
+  {
+    sample = adcRead(CFG_RANDOM_ADCCHANNEL) ^ (DWT_CYCCNT << 10);
+    sha256Update(&sha, (const uint8_t *)&sample, sizeof(sample));
+  }
+
+  sha256Final(&sha, _randomKey);
+  randomReseed();
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Adds a sample (a timestamp, an RSSI reading, ...) to the
+            pool.  This is cheap and safe to call from interrupts.
+*/
+/**************************************************************************/
+void randomAddSample(uint32_t sample)
+{
+  uint32_t i = _randomPoolIndex++ & (RANDOM_POOLSIZE - 1);
+
+  _randomPool[i] = randomRotl(_randomPool[i], 7) ^ sample ^ DWT_CYCCNT;
+  _randomPoolCount++;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Hashes a block of entropy (and the pool) into the key.  Not
+            for interrupts.
+*/
+/**************************************************************************/
+void randomAddEntropy(const uint8_t *data, uint32_t len)
+{
+  randomMix(data, len);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Hashes the pool into the key and seeds randomGet again.  Not
+            for interrupts.
+*/
+/**************************************************************************/
+void randomReseed(void)
+{
+  randomMix(NULL, 0);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Fills 'buffer' with random bytes that are fit for keys and
+            nonces.  Not for interrupts.
+*/
+/**************************************************************************/
+void randomBytes(uint8_t *buffer, uint32_t len)
+{
+  uint8_t block[SHA256_DIGESTSIZE];
+  uint32_t n;
+
+  if (_randomPoolCount >= RANDOM_RESEEDSAMPLES)
+  {
+    randomReseed();
+  }
+
+  while (len)
+  {
+    randomBlock(block);
+    n = len < sizeof(block) ? len : sizeof(block);
+    memcpy(buffer, block, n);
+    buffer += n;
+    len -= n;
+  }
+
+  // Forget the key that this output came from
+  randomBlock(_randomKey);
+  memset(block, 0, sizeof(block));
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns a fast (xoshiro128**) random number, which is fine
+            for jitter and back-off but not for secrets
+*/
+/**************************************************************************/
+uint32_t randomGet(void)
+{
+  uint32_t *s = _randomFast;
+  uint32_t result = randomRotl(s[1] * 5, 7) * 9;
+  uint32_t t = s[1] << 9;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = randomRotl(s[3], 11);
+
+  return result;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns a fast random number in 0..range-1, with a multiply
+            instead of a division (the bias is below range / 2^32)
+*/
+/**************************************************************************/
+uint32_t randomRange(uint32_t range)
+{
+  return (uint32_t)(((uint64_t)randomGet() * range) >> 32);
+}
+
+#ifdef CFG_CHIBI
+/**************************************************************************/
+/*! 
+    @brief  Adds bytes from the AT86RF212's random number generator to
+            the pool (the radio stops receiving for a few hundred
+            microseconds).
+            chb_init must have been called.
+*/
+/**************************************************************************/
+void randomSeedRadio(void)
+{
+  uint8_t buffer[RANDOM_RADIOBYTES];
+
+  chb_get_rand(buffer, sizeof(buffer));
+  randomAddEntropy(buffer, sizeof(buffer));
+  memset(buffer, 0, sizeof(buffer));
+}
+#endif
+
+#endif
@@ -0,0 +1,217 @@
+/**************************************************************************/
+/*! 
+    @file     sha256.c
+    @author   K. Townsend (microBuilder.eu)
+    @section DESCRIPTION
+
+    Streaming SHA-256 (FIPS 180-2), for firmware image checks and
+    rsaVerifySha256.  The message schedule is kept as a rolling 16-word
+    window instead of the full 64 words, which keeps the context and
+    the stack frame under 200 bytes.  Input is limited to 4GB.
+
+    @code
+    sha256Context_t sha;
+    uint8_t digest[SHA256_DIGESTSIZE];
+
+    sha256Init(&sha);
+    sha256Update(&sha, chunk, chunkLen);    // As many times as needed
+    sha256Final(&sha, digest);
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include <string.h>
+
+#include "sha256.h"
+
+static const uint32_t sha256K[64] =
+{
+  0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+  0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+  0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+  0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+  0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+  0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+  0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+  0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+#define SHA_ROTR(x,n)   (((x) >> (n)) | ((x) << (32 - (n))))
+#define SHA_CH(x,y,z)   ((z) ^ ((x) & ((y) ^ (z))))
+#define SHA_MAJ(x,y,z)  (((x) & (y)) | ((z) & ((x) | (y))))
+#define SHA_S0(x)       (SHA_ROTR(x, 2) ^ SHA_ROTR(x, 13) ^ SHA_ROTR(x, 22))
+#define SHA_S1(x)       (SHA_ROTR(x, 6) ^ SHA_ROTR(x, 11) ^ SHA_ROTR(x, 25))
+#define SHA_G0(x)       (SHA_ROTR(x, 7) ^ SHA_ROTR(x, 18) ^ ((x) >> 3))
+#define SHA_G1(x)       (SHA_ROTR(x, 17) ^ SHA_ROTR(x, 19) ^ ((x) >> 10))
+
+/**************************************************************/
+/*! 
+    @brief  Compresses one 64-byte block into the state
+*/
+/**************************************************************/
+static void sha256Transform(uint32_t *state, const uint8_t *block)
+{
+  uint32_t w[16];
+  uint32_t a, b, c, d, e, f, g, h, t1, t2;
+  uint8_t i;
+
+  for (i = 0; i < 16; i++)
+  {
+    w[i] = ((uint32_t)block[4 * i] << 24) | ((uint32_t)block[4 * i + 1] << 16) |
+           ((uint32_t)block[4 * i + 2] << 8) | block[4 * i + 3];
+  }
+
+  a = state[0]; b = state[1]; c = state[2]; d = state[3];
+  e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+  for (i = 0; i < 64; i++)
+  {
+    if (i >= 16)
+    {
+      // W[i] = G1(W[i-2]) + W[i-7] + G0(W[i-15]) + W[i-16], in place
+      w[i & 15] += SHA_G1(w[(i - 2) & 15]) + w[(i - 7) & 15] + SHA_G0(w[(i - 15) & 15]);
+    }
+    t1 = h + SHA_S1(e) + SHA_CH(e, f, g) + sha256K[i] + w[i & 15];
+    t2 = SHA_S0(a) + SHA_MAJ(a, b, c);
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+
+  state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+  state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+/**************************************************************/
+/*! 
+    @brief  Starts a new hash
+*/
+/**************************************************************/
+void sha256Init(sha256Context_t *ctx)
+{
+  ctx->state[0] = 0x6A09E667;
+  ctx->state[1] = 0xBB67AE85;
+  ctx->state[2] = 0x3C6EF372;
+  ctx->state[3] = 0xA54FF53A;
+  ctx->state[4] = 0x510E527F;
+  ctx->state[5] = 0x9B05688C;
+  ctx->state[6] = 0x1F83D9AB;
+  ctx->state[7] = 0x5BE0CD19;
+  ctx->count = 0;
+}
+
+/**************************************************************/
+/*! 
+    @brief  Adds 'len' bytes to the hash.  Whole blocks are
+            compressed straight from 'data' without a copy.
+*/
+/**************************************************************/
+void sha256Update(sha256Context_t *ctx, const uint8_t *data, uint32_t len)
+{
+  uint32_t fill = ctx->count & (SHA256_BLOCKSIZE - 1);
+  uint32_t n;
+
+  ctx->count += len;
+
+  if (fill)
+  {
+    n = SHA256_BLOCKSIZE - fill;
+    if (len < n)
+    {
+      memcpy(ctx->buffer + fill, data, len);
+      return;
+    }
+    memcpy(ctx->buffer + fill, data, n);
+    sha256Transform(ctx->state, ctx->buffer);
+    data += n;
+    len -= n;
+  }
+
+  while (len >= SHA256_BLOCKSIZE)
+  {
+    sha256Transform(ctx->state, data);
+    data += SHA256_BLOCKSIZE;
+    len -= SHA256_BLOCKSIZE;
+  }
+
+  memcpy(ctx->buffer, data, len);
+}
+
+/**************************************************************/
+/*! 
+    @brief  Pads the message and writes the 32-byte digest
+*/
+/**************************************************************/
+void sha256Final(sha256Context_t *ctx, uint8_t *digest)
+{
+  uint32_t fill = ctx->count & (SHA256_BLOCKSIZE - 1);
+  uint32_t bits = ctx->count << 3;
+  uint8_t i;
+
+  ctx->buffer[fill++] = 0x80;
+  if (fill > SHA256_BLOCKSIZE - 8)
+  {
+    memset(ctx->buffer + fill, 0, SHA256_BLOCKSIZE - fill);
+    sha256Transform(ctx->state, ctx->buffer);
+    fill = 0;
+  }
+  memset(ctx->buffer + fill, 0, SHA256_BLOCKSIZE - 4 - fill);
+
+  // 64-bit big-endian bit count (the top bits come from the byte count)
+  ctx->buffer[59] = ctx->count >> 29;
+  ctx->buffer[60] = bits >> 24;
+  ctx->buffer[61] = bits >> 16;
+  ctx->buffer[62] = bits >> 8;
+  ctx->buffer[63] = bits;
+  sha256Transform(ctx->state, ctx->buffer);
+
+  for (i = 0; i < 8; i++)
+  {
+    digest[4 * i]     = ctx->state[i] >> 24;
+    digest[4 * i + 1] = ctx->state[i] >> 16;
+    digest[4 * i + 2] = ctx->state[i] >> 8;
+    digest[4 * i + 3] = ctx->state[i];
+  }
+}
+
+/**************************************************************/
+/*! 
+    @brief  Hashes a single buffer in one call
+*/
+/**************************************************************/
+void sha256(const uint8_t *data, uint32_t len, uint8_t *digest)
+{
+  sha256Context_t ctx;
+
+  sha256Init(&ctx);
+  sha256Update(&ctx, data, len);
+  sha256Final(&ctx, digest);
+}
@@ -23,6 +23,24 @@
 
     @endcode
 
+    With CFG_MCP4725_STREAM defined, a waveform buffer can also be
+    played out at a fixed sample rate.  Each sample is sent as a 2-byte
+    fast write, and 16-bit timer 0 queues up to 'burst' of them back to
+    back in one I2C transaction per tick.  With burst = 1 every sample
+    is paced by the timer; larger bursts trade some jitter (samples in a
+    burst are spaced by the I2C bit rate, ~18 bit times) for one address
+    byte and interrupt per burst instead of per sample.
+
+    @code
+    // One period of a 16-point sine, repeated at 8kHz (500Hz output)
+    static const uint16_t sine[16] = { 2048, 2831, 3495, 3939, 4095, 3939, 3495, 2831,
+                                       2048, 1264,  600,  156,    0,  156,  600, 1264 };
+
+    mcp4725StreamStart(sine, 16, 8000, 1, true);
+    ...
+    mcp4725StreamStop();
+    @endcode
+
     @section LICENSE
 
     Software License Agreement (BSD License)
@@ -55,6 +73,11 @@
 /**************************************************************************/
 #include "mcp4725.h"
 #include "core/i2c/i2c.h"
+#include "core/cpu/cpu.h"
+
+#ifdef CFG_MCP4725_STREAM
+  #include "core/timer16/timer16.h"
+#endif
 
 extern volatile uint8_t   I2CMasterBuffer[I2C_BUFSIZE];
 extern volatile uint8_t   I2CSlaveBuffer[I2C_BUFSIZE];
@@ -156,3 +179,175 @@ void mcp472ReadConfig( uint8_t *status, uint16_t *value )
   *value = ((I2CSlaveBuffer[1] << 4) | (I2CSlaveBuffer[2] >> 4));
 }
 
+#ifdef CFG_MCP4725_STREAM
+
+/* Two transfers so the next burst can be queued while one is on the bus */
+static struct
+{
+  const uint16_t   *samples;
+  uint32_t          count;
+  uint32_t          next;
+  uint32_t          burst;
+  bool              loop;
+  volatile bool     running;
+  volatile uint32_t underruns;
+  uint8_t           slot;
+  i2cTransfer_t     transfer[2];
+  uint8_t           buffer[2][CFG_MCP4725_STREAM_BURST * 2];
+} _mcp4725Stream;
+
+/**************************************************************************/
+/*! 
+    @brief  Starts playing a waveform buffer out of the DAC
+
+    @param[in]  samples
+                The 12-bit samples (0..4095), which must remain valid
+                until the stream is stopped
+    @param[in]  count
+                The number of samples in the buffer
+    @param[in]  sampleRate
+                The output rate in samples per second
+    @param[in]  burst
+                The number of samples sent per I2C transaction
+                (1..CFG_MCP4725_STREAM_BURST)
+    @param[in]  loop
+                If true the buffer is repeated until mcp4725StreamStop
+                is called, otherwise the stream stops at the end of it
+
+    @return     false if the parameters are out of range (the timer tick,
+                burst / sampleRate, must be 2us..65ms)
+*/
+/**************************************************************************/
+bool mcp4725StreamStart( const uint16_t *samples, uint32_t count, uint32_t sampleRate, uint32_t burst, bool loop )
+{
+  uint32_t tickUs;
+
+  if ((samples == NULL) || (count == 0) || (sampleRate == 0) ||
+      (burst < 1) || (burst > CFG_MCP4725_STREAM_BURST))
+  {
+    return false;
+  }
+
+  tickUs = (burst * 1000000) / sampleRate;
+  if ((tickUs < 2) || (tickUs > 0x10000))
+  {
+    return false;
+  }
+
+  if (!_mcp4725Initialised) mcp4725Init();
+  mcp4725StreamStop();
+
+  _mcp4725Stream.samples = samples;
+  _mcp4725Stream.count = count;
+  _mcp4725Stream.next = 0;
+  _mcp4725Stream.burst = burst;
+  _mcp4725Stream.loop = loop;
+  _mcp4725Stream.underruns = 0;
+  _mcp4725Stream.slot = 0;
+  _mcp4725Stream.transfer[0].state = I2CSTATE_IDLE;
+  _mcp4725Stream.transfer[1].state = I2CSTATE_IDLE;
+  _mcp4725Stream.running = true;
+
+  // Count in microseconds, one interrupt per burst
+  timer16Init(0, tickUs - 1);
+  TMR_TMR16B0PR = ((cpuGetClock()/SCB_SYSAHBCLKDIV) / 1000000) - 1;
+  timer16Enable(0);
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Stops the stream.  A transfer that is already queued still
+            completes.
+*/
+/**************************************************************************/
+void mcp4725StreamStop( void )
+{
+  timer16Disable(0);
+  _mcp4725Stream.running = false;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns true until a non-looping stream has sent its last
+            sample (or the stream is stopped)
+*/
+/**************************************************************************/
+bool mcp4725StreamBusy( void )
+{
+  return _mcp4725Stream.running;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the number of timer ticks since mcp4725StreamStart
+            where the bus was still busy with earlier bursts, and the
+            samples were held back.  If this keeps growing, lower the
+            sample rate or use a larger burst.
+*/
+/**************************************************************************/
+uint32_t mcp4725StreamUnderruns( void )
+{
+  return _mcp4725Stream.underruns;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Queues the next burst of fast writes.  Called from
+            TIMER16_0_IRQHandler once per tick.
+*/
+/**************************************************************************/
+void mcp4725StreamTimerIRQ( void )
+{
+  i2cTransfer_t *t = &_mcp4725Stream.transfer[_mcp4725Stream.slot];
+  uint8_t *buf = _mcp4725Stream.buffer[_mcp4725Stream.slot];
+  uint32_t start = _mcp4725Stream.next;
+  uint32_t i;
+
+  if (!_mcp4725Stream.running)
+  {
+    return;
+  }
+
+  // The slot is still waiting for the bus, so hold the samples back
+  if (t->state == I2CSTATE_PENDING)
+  {
+    _mcp4725Stream.underruns++;
+    return;
+  }
+
+  for (i = 0; (i < _mcp4725Stream.burst) && (_mcp4725Stream.next < _mcp4725Stream.count); i++)
+  {
+    uint16_t sample = _mcp4725Stream.samples[_mcp4725Stream.next++];
+    buf[i * 2] = MCP4726_CMD_FASTWRITE | ((sample >> 8) & 0x0F);
+    buf[i * 2 + 1] = sample & 0xFF;
+    if ((_mcp4725Stream.next == _mcp4725Stream.count) && _mcp4725Stream.loop)
+    {
+      _mcp4725Stream.next = 0;
+    }
+  }
+
+  t->address = MCP4725_ADDRESS;
+  t->writeBuffer = buf;
+  t->writeLength = i * 2;
+  t->readBuffer = NULL;
+  t->readLength = 0;
+  t->callback = NULL;
+  t->speed = I2C_SPEED_DEFAULT;
+  if (!i2cQueueTransfer(t))
+  {
+    // Queue full (shared with other drivers), try again next tick
+    _mcp4725Stream.next = start;
+    _mcp4725Stream.underruns++;
+    return;
+  }
+  _mcp4725Stream.slot ^= 1;
+
+  if (_mcp4725Stream.next == _mcp4725Stream.count)
+  {
+    mcp4725StreamStop();
+  }
+}
+
+#endif
\ No newline at end of file
@@ -43,9 +43,18 @@
 #define MCP4725_READ                    (0x01)
 #define MCP4726_CMD_WRITEDAC            (0x40)  // Writes data to the DAC
 #define MCP4726_CMD_WRITEDACEEPROM      (0x60)  // Writes data to the DAC and the EEPROM (persisting the assigned value after reset)
+#define MCP4726_CMD_FASTWRITE           (0x00)  // 2-byte write (C2.C1.PD1.PD0.D11.D10.D9.D8, D7..D0), repeatable in one transaction
 
 int  mcp4725Init();
 void mcp4725SetVoltage( uint16_t output, bool writeEEPROM );
 void mcp472ReadConfig( uint8_t *status, uint16_t *value );
 
+#ifdef CFG_MCP4725_STREAM
+bool     mcp4725StreamStart( const uint16_t *samples, uint32_t count, uint32_t sampleRate, uint32_t burst, bool loop );
+void     mcp4725StreamStop( void );
+bool     mcp4725StreamBusy( void );
+uint32_t mcp4725StreamUnderruns( void );
+void     mcp4725StreamTimerIRQ( void );
+#endif
+
 #endif
\ No newline at end of file
@@ -9,12 +9,11 @@
 
     Driver for Atmel's AT25010a/AT25020a/AT25040a 1K/2K/4K serial EEPROM.
     
-    @note     The AT25xxx has an 8-byte buffer, including 1 command byte
-              and one address offset byte, meaning that a maximum of 6
-              bytes can be read or written in one operation.  An error
-              will be returned if a value greater than 6 is passed in
-              for bufferLength with the eepromRead and eepromWrite
-              methods.
+    @note     at25Read and at25Write accept at most 6 bytes per call.
+              at25ReadBlock and at25WriteBlock have no such limit: reads
+              are a single sequential READ, and writes are split at the
+              8-byte page boundaries into one WREN + WRITE per page,
+              with RDSR polled until each write cycle is done.
 
     @section Example
 
@@ -94,28 +93,29 @@
 #include "at25040.h"
 #include "core/ssp/ssp.h"
 #include "core/gpio/gpio.h"
+#include "core/delay/delay.h"
 
 #define AT25_SELECT()       gpioSetValue(0, 2, 0)
 #define AT25_DESELECT()     gpioSetValue(0, 2, 1)
 
-uint32_t i, timeout;
-uint8_t src_addr[SSP_FIFOSIZE]; 
-uint8_t dest_addr[SSP_FIFOSIZE];
+// Bus settings, only loaded when another device used SSP0 last
+static sspDevice_t _at25Ssp;
 
 /**************************************************************************/
 /*! 
     @brief Sends the write enable command (WREN/0x06)
+
+    The write enable latch is set as soon as CS goes high again, so
+    the status register doesn't have to be checked.
 */
 /**************************************************************************/
-void at25WriteEnable()
+static void at25WriteEnable()
 {
+  uint8_t cmd = AT25_WREN;
+
   AT25_SELECT();
-  src_addr[0] = AT25_WREN;
-  sspSend(0, (uint8_t *)src_addr, 1);
+  sspSend(0, &cmd, 1);
   AT25_DESELECT();
-
-  // Delay for at least 250nS (1nS @ 72MHz = ~0.0072 ticks)
-  for (i = 0; i < 100; i++);
 }
 
 /**************************************************************************/
@@ -125,86 +125,206 @@ void at25WriteEnable()
     @return     The 8-bit value returned by the Read Status Register
 */
 /**************************************************************************/
-uint8_t at25GetRSR()
+static uint8_t at25GetRSR()
 {
+  uint8_t cmd = AT25_RDSR;
+  uint8_t status;
+
   AT25_SELECT();
-  src_addr[0] = AT25_RDSR;
-  sspSend(0, (uint8_t *)src_addr, 1);
-  sspReceive(0, (uint8_t *)dest_addr, 1);
+  sspSend(0, &cmd, 1);
+  sspReceive(0, &status, 1);
   AT25_DESELECT();
-  return dest_addr[0] & (AT25_RDSR_WEN | AT25_RDSR_RDY);
+  return status & (AT25_RDSR_WEN | AT25_RDSR_RDY);
+}
+
+/**************************************************************************/
+/*! 
+    @brief Polls RDSR until the device isn't busy with a write cycle
+           (at most AT25_RDSRPOLLMAX polls, 10us apart)
+*/
+/**************************************************************************/
+static bool at25WaitReady()
+{
+  uint32_t polls;
+
+  for (polls = 0; polls < AT25_RDSRPOLLMAX; polls++)
+  {
+    if (!(at25GetRSR() & AT25_RDSR_RDY))
+    {
+      return true;
+    }
+    delayUs(10);
+  }
+
+  return false;
 }
 
 /**************************************************************************/
 /*! 
     @brief  Initialises the SPI block (CLK set low when inactive, trigger
-            on leading edge).
+            on leading edge) and registers the EEPROM with the shared
+            SSP bus.
 */
 /**************************************************************************/
 void at25Init (void)
 {
-  sspInit(0, sspClockPolarity_Low, sspClockPhase_RisingEdge);
+  // Only configure SSP0 if nothing else (SD card, etc.) has done so yet,
+  // since sspInit would reset the bus clock another driver has selected
+  if (!(SSP_SSP0CR1 & SSP_SSP0CR1_SSE_ENABLED))
+  {
+    sspInit(0, sspClockPolarity_Low, sspClockPhase_RisingEdge);
+  }
+  sspDeviceRegister(&_at25Ssp, AT25_SPICLOCK, sspClockPolarity_Low, sspClockPhase_RisingEdge);
 }
 
 /**************************************************************************/
 /*! 
-    @brief Reads the specified number of bytes from the supplied address.
+    @brief Reads any number of bytes as one sequential read
 
-    This function will read one or more bytes starting at the supplied
-    address.
+    The READ command auto-increments through the whole array, so a
+    single command is enough whatever the length.
 
     @param[in]  address
-                The 16-bit address where the read will start.  The maximum
-                value for the address depends on the size of the EEPROM
+                The 16-bit address where the read will start
     @param[in]  *buffer
                 Pointer to the buffer that will store the read results
-    @param[in]  bufferLength
-                Length of the buffer
+    @param[in]  length
+                Number of bytes to read
 */
 /**************************************************************************/
-at25Error_e at25Read (uint16_t address, uint8_t *buffer, uint32_t bufferLength)
+at25Error_e at25ReadBlock (uint16_t address, uint8_t *buffer, uint32_t length)
 {
-  if (address >= AT25_MAXADDRESS)
+  uint8_t cmd[2];
+  at25Error_e error = AT25_ERROR_OK;
+
+  if (address + length > AT25_MAXADDRESS)
   {
     return AT25_ERROR_ADDRERR;
   }
+  if (!length)
+  {
+    return AT25_ERROR_OK;
+  }
+  if (!sspDeviceAcquire(&_at25Ssp))
+  {
+    return AT25_ERROR_BUSBUSY;
+  }
 
-  if (bufferLength > 6)
+  if (!at25WaitReady())
   {
-    return AT25_ERROR_BUFFEROVERFLOW;
+    error = AT25_ERROR_TIMEOUT_WFINISH;
   }
+  else
+  {
+    // Read command (0x03), append A8 if > addr 256 bytes
+    cmd[0] = address > 0xFF ? AT25_READ | AT25_A8 : AT25_READ;
+    cmd[1] = address;
+    AT25_SELECT();
+    sspSend(0, cmd, 2);
+    sspReceive(0, buffer, length);
+    AT25_DESELECT();
+  }
+
+  sspDeviceRelease(&_at25Ssp);
+  return error;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Writes any number of bytes, one page write per 8-byte page
+
+    Each page gets a WREN followed by a single WRITE burst, and RDSR
+    is polled until the write cycle is done instead of waiting for the
+    worst case.
 
-  timeout = 0;
-  while ( timeout < SSP_MAX_TIMEOUT )
+    @param[in]  address
+                The 16-bit address where the write will start
+    @param[in]  *buffer
+                Pointer to the data to write
+    @param[in]  length
+                Number of bytes to write
+*/
+/**************************************************************************/
+at25Error_e at25WriteBlock (uint16_t address, const uint8_t *buffer, uint32_t length)
+{
+  uint8_t cmd[2];
+  uint32_t chunk;
+  at25Error_e error = AT25_ERROR_OK;
+
+  if (address + length > AT25_MAXADDRESS)
+  {
+    return AT25_ERROR_ADDRERR;
+  }
+  if (!sspDeviceAcquire(&_at25Ssp))
   {
-    // Wait until the device is ready
-    uint8_t status = at25GetRSR() & AT25_RDSR_RDY;
-    if (status == 0)
+    return AT25_ERROR_BUSBUSY;
+  }
+
+  while (length && !error)
+  {
+    // Writes wrap around within a page, so stop at the page boundary
+    chunk = AT25_PAGESIZE - (address % AT25_PAGESIZE);
+    chunk = chunk < length ? chunk : length;
+
+    if (!at25WaitReady())
     {
+      error = AT25_ERROR_TIMEOUT_WFINISH;
       break;
     }
-    timeout++;
+    at25WriteEnable();
+
+    // Write command (0x02), append A8 if addr > 256 bytes
+    cmd[0] = address > 0xFF ? AT25_WRITE | AT25_A8 : AT25_WRITE;
+    cmd[1] = address;
+    AT25_SELECT();
+    sspSend(0, cmd, 2);
+    sspSend(0, (uint8_t *)buffer, chunk);
+    AT25_DESELECT();
+
+    address += chunk;
+    buffer += chunk;
+    length -= chunk;
   }
-  if ( timeout == SSP_MAX_TIMEOUT )
+
+  // Don't return before the last write cycle is done
+  if (!error && !at25WaitReady())
   {
-    return AT25_ERROR_TIMEOUT_WE;
+    error = AT25_ERROR_TIMEOUT_WFINISH;
   }
 
-  AT25_SELECT();
-  // Read command (0x03), append A8 if > addr 256 bytes
-  src_addr[0] = address > 0xFF ? AT25_READ | AT25_A8 : AT25_READ;
-  src_addr[1] = (address);
-  sspSend(0, (uint8_t *)src_addr, 2); 
-  sspReceive(0, (uint8_t *)&dest_addr[2], bufferLength);
-  AT25_DESELECT();
+  sspDeviceRelease(&_at25Ssp);
+  return error;
+}
 
-  // Fill response buffer
-  for (i = 0; i < bufferLength; i++)
+/**************************************************************************/
+/*! 
+    @brief Reads the specified number of bytes from the supplied address.
+
+    This function will read one or more bytes starting at the supplied
+    address.
+
+    @param[in]  address
+                The 16-bit address where the read will start.  The maximum
+                value for the address depends on the size of the EEPROM
+    @param[in]  *buffer
+                Pointer to the buffer that will store the read results
+    @param[in]  bufferLength
+                Length of the buffer (max 6, see at25ReadBlock)
+*/
+/**************************************************************************/
+at25Error_e at25Read (uint16_t address, uint8_t *buffer, uint32_t bufferLength)
+{
+  if (address >= AT25_MAXADDRESS)
   {
-    buffer[i] = dest_addr[i + 2];
+    return AT25_ERROR_ADDRERR;
   }
 
-  return AT25_ERROR_OK;
+  if (bufferLength > 6)
+  {
+    return AT25_ERROR_BUFFEROVERFLOW;
+  }
+
+  return at25ReadBlock(address, buffer, bufferLength);
 }
 
 /**************************************************************************/
@@ -221,7 +341,7 @@ at25Error_e at25Read (uint16_t address, uint8_t *buffer, uint32_t bufferLength)
     @param[in]  *buffer
                 Pointer to the buffer that contains the values to write.
     @param[in]  bufferLength
-                Length of the buffer
+                Length of the buffer (max 6, see at25WriteBlock)
 */
 /**************************************************************************/
 at25Error_e at25Write (uint16_t address, uint8_t *buffer, uint32_t bufferLength)
@@ -236,62 +356,5 @@ at25Error_e at25Write (uint16_t address, uint8_t *buffer, uint32_t bufferLength)
     return AT25_ERROR_BUFFEROVERFLOW;
   }
 
-  // Set write enable latch
-  at25WriteEnable();
-
-  timeout = 0;
-  while ( timeout < SSP_MAX_TIMEOUT )
-  {
-    // Wait until the device is write enabled
-    if (at25GetRSR() == AT25_RDSR_WEN)
-    {
-      break;
-    }
-    timeout++;
-  }
-  if ( timeout == SSP_MAX_TIMEOUT )
-  {
-    return AT25_ERROR_TIMEOUT_WE;
-  }
-
-  for (i = 0; i < bufferLength; i++)        // Init RD and WR buffer
-  {
-    src_addr[i+2] = buffer[i];              // leave two bytes for cmd and offset(8 bits)
-    dest_addr[i] = 0;
-  }
-
-  AT25_SELECT();
-  // Write command (0x02), append A8 if addr > 256 bytes
-  src_addr[0] = address > 0xFF ? AT25_WRITE | AT25_A8 : AT25_WRITE;
-  src_addr[1] = (address);
-  sspSend(0, (uint8_t *)src_addr, bufferLength + 2);
-  AT25_DESELECT();
-
-  // Wait at least 3ms
-  for (i = 0; i < ((CFG_CPU_CCLK / 1000) * 3); i++);
-  
-  timeout = 0;
-  while ( timeout < SSP_MAX_TIMEOUT )
-  {
-    // Check status to see if write cycle is done or not
-    AT25_SELECT();
-    src_addr[0] = AT25_RDSR;
-    sspSend(0, (uint8_t *)src_addr, 1);
-    sspReceive(0, (uint8_t *)dest_addr, 1);
-    AT25_DESELECT();
-    // Wait until device is ready
-    if ((dest_addr[0] & AT25_RDSR_RDY) == 0x00)
-    {
-      break;
-    }
-    timeout++;
-  }
-  if ( timeout == SSP_MAX_TIMEOUT )
-  {
-    return AT25_ERROR_TIMEOUT_WFINISH;
-  }
-
-  for (i = 0; i < 300; i++);                // Wait at least 250ns
-
-  return AT25_ERROR_OK;
+  return at25WriteBlock(address, buffer, bufferLength);
 }
@@ -20,9 +20,9 @@
     2. Redistributions in binary form must reproduce the above copyright
     notice, this list of conditions and the following disclaimer in the
     documentation and/or other materials provided with the distribution.
-    3. Neither the name of the copyright holders nor the
-    names of its contributors may be used to endorse or promote products
-    derived from this software without specific prior written permission.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
 
     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
     EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
@@ -46,6 +46,9 @@
 #define AT25_RDSR_WEN       0x02
 #define AT25_A8             0x08        // For addresses > 0xFF (AT25040 only) A8 must be added to R/W commands
 #define AT25_MAXADDRESS     0x0200      // AT25040 = 0X0200, AT25020 = 0x100, AT25010 = 0x80
+#define AT25_PAGESIZE       8           // Max bytes in one page write
+#define AT25_SPICLOCK       10000000    // 10 MHz (2.7V..5.5V)
+#define AT25_RDSRPOLLMAX    1000        // Max RDSR polls (10us apart) while waiting for a write cycle
 
 /**************************************************************************/
 /*! 
@@ -73,7 +76,8 @@ typedef enum
   AT25_ERROR_TIMEOUT_WE,        // Timed out waiting for write enable status
   AT25_ERROR_TIMEOUT_WFINISH,   // Timed out waiting for write to finish
   AT25_ERROR_ADDRERR,           // Address out of range
-  AT25_ERROR_BUFFEROVERFLOW,    // Max 6 bytes can be read/written in one operation
+  AT25_ERROR_BUFFEROVERFLOW,    // Max 6 bytes can be read/written with at25Read/at25Write
+  AT25_ERROR_BUSBUSY,           // Another SSP0 device is part way through a transfer
   AT2_ERROR_LAST
 }
 at25Error_e;
@@ -81,5 +85,7 @@ at25Error_e;
 void at25Init (void);
 at25Error_e at25Read (uint16_t address, uint8_t *buffer, uint32_t bufferLength);
 at25Error_e at25Write (uint16_t address, uint8_t *buffer, uint32_t bufferLength);
+at25Error_e at25ReadBlock (uint16_t address, uint8_t *buffer, uint32_t length);
+at25Error_e at25WriteBlock (uint16_t address, const uint8_t *buffer, uint32_t length);
 
 #endif
@@ -38,11 +38,174 @@
 #include "projectconfig.h"
 #include "eeprom.h"
 
-// Currently only the MCP24AA I2C EEPROM is used
-#include "drivers/eeprom/mcp24aa/mcp24aa.h"
+// The typed API below runs on either the MCP24AA I2C EEPROM or, if
+// CFG_EEPROM_AT25040 is defined, the AT25040 SPI EEPROM
+#ifdef CFG_EEPROM_AT25040
+  #include "drivers/eeprom/at25040/at25040.h"
+  typedef at25Error_e eepromError_e;
+  #define EEPROM_ERROR_OK           AT25_ERROR_OK
+  #define EEPROM_MAXADDR            (AT25_MAXADDRESS - 1)
+  #define eepromDevInit()           at25Init()
+  #define eepromDevRead(a, b, l)    at25ReadBlock(a, b, l)
+  #define eepromDevWrite(a, b, l)   at25WriteBlock(a, b, l)
+#else
+  #include "drivers/eeprom/mcp24aa/mcp24aa.h"
+  typedef mcp24aaError_e eepromError_e;
+  #define EEPROM_ERROR_OK           MCP24AA_ERROR_OK
+  #define EEPROM_MAXADDR            MCP24AA_MAXADDR
+  #define eepromDevInit()           mcp24aaInit()
+  #define eepromDevRead(a, b, l)    mcp24aaReadBlock(a, b, l)
+  #define eepromDevWrite(a, b, l)   mcp24aaWriteBlock(a, b, l)
+#endif
 
 static uint8_t buf[32];
 
+#if CFG_EEPROM_SHADOWSIZE > 0
+  // RAM copy of CFG_EEPROM_SHADOWSTART..+CFG_EEPROM_SHADOWSIZE, with one
+  // dirty bit per 32-byte chunk (whatever the EEPROM page size is, the
+  // block write functions split each chunk into page writes)
+  #define EEPROM_SHADOWCHUNK  (32)
+  #define EEPROM_SHADOWEND    (CFG_EEPROM_SHADOWSTART + CFG_EEPROM_SHADOWSIZE)
+  #define EEPROM_SHADOWPAGE(a) (((a) / EEPROM_SHADOWCHUNK) - (CFG_EEPROM_SHADOWSTART / EEPROM_SHADOWCHUNK))
+  static uint8_t _eepromShadow[CFG_EEPROM_SHADOWSIZE];
+  static uint32_t _eepromShadowDirty = 0;
+  static bool _eepromShadowLoaded = false;
+#endif
+
+/**************************************************************************/
+/*! 
+    @brief Reads from the shadow copy and/or the EEPROM
+*/
+/**************************************************************************/
+static eepromError_e eepromRead(uint16_t addr, uint8_t *buffer, uint32_t length)
+{
+#if CFG_EEPROM_SHADOWSIZE > 0
+  uint32_t start, end;
+
+  if (!_eepromShadowLoaded) eepromInit();
+
+  start = addr > CFG_EEPROM_SHADOWSTART ? addr : CFG_EEPROM_SHADOWSTART;
+  end = addr + length < EEPROM_SHADOWEND ? addr + length : EEPROM_SHADOWEND;
+  if ((start == addr) && (end == addr + length))
+  {
+    // Entirely in the shadow copy
+    memcpy(buffer, &_eepromShadow[addr - CFG_EEPROM_SHADOWSTART], length);
+    return EEPROM_ERROR_OK;
+  }
+  if (start < end)
+  {
+    // Partially shadowed: read the EEPROM and overlay the shadow copy,
+    // which may hold changes that haven't been flushed yet
+    eepromError_e error = eepromDevRead(addr, buffer, length);
+    memcpy(&buffer[start - addr], &_eepromShadow[start - CFG_EEPROM_SHADOWSTART], end - start);
+    return error;
+  }
+#endif
+
+  return eepromDevRead(addr, buffer, length);
+}
+
+/**************************************************************************/
+/*! 
+    @brief Writes to the shadow copy (deferred until eepromFlush) and/or
+           straight to the EEPROM
+*/
+/**************************************************************************/
+static eepromError_e eepromWrite(uint16_t addr, const uint8_t *buffer, uint32_t length)
+{
+#if CFG_EEPROM_SHADOWSIZE > 0
+  eepromError_e error = EEPROM_ERROR_OK;
+  uint32_t start, end, i;
+
+  if (!_eepromShadowLoaded) eepromInit();
+
+  start = addr > CFG_EEPROM_SHADOWSTART ? addr : CFG_EEPROM_SHADOWSTART;
+  end = addr + length < EEPROM_SHADOWEND ? addr + length : EEPROM_SHADOWEND;
+  if (start < end)
+  {
+    // Only mark the pages that actually change
+    for (i = start; i < end; i++)
+    {
+      if (_eepromShadow[i - CFG_EEPROM_SHADOWSTART] != buffer[i - addr])
+      {
+        _eepromShadow[i - CFG_EEPROM_SHADOWSTART] = buffer[i - addr];
+        _eepromShadowDirty |= 1UL << EEPROM_SHADOWPAGE(i);
+      }
+    }
+
+    // Write anything outside the shadowed region straight away
+    if (addr < start)
+    {
+      error = eepromDevWrite(addr, buffer, start - addr);
+    }
+    if ((addr + length > end) && !error)
+    {
+      error = eepromDevWrite(end, &buffer[end - addr], addr + length - end);
+    }
+    return error;
+  }
+#endif
+
+  return eepromDevWrite(addr, buffer, length);
+}
+
+/**************************************************************************/
+/*! 
+    @brief Initialises the EEPROM and, if CFG_EEPROM_SHADOWSIZE is not
+           zero, loads the shadowed region into RAM.  This is also done
+           automatically on the first access.
+*/
+/**************************************************************************/
+void eepromInit(void)
+{
+  eepromDevInit();
+
+#if CFG_EEPROM_SHADOWSIZE > 0
+  if (eepromDevRead(CFG_EEPROM_SHADOWSTART, _eepromShadow, CFG_EEPROM_SHADOWSIZE) == EEPROM_ERROR_OK)
+  {
+    _eepromShadowDirty = 0;
+    _eepromShadowLoaded = true;
+  }
+#endif
+}
+
+/**************************************************************************/
+/*! 
+    @brief Writes the pages of the shadowed region that have changed
+           since they were loaded or last flushed
+
+    @return     TRUE if everything was written, otherwise FALSE
+*/
+/**************************************************************************/
+bool eepromFlush(void)
+{
+#if CFG_EEPROM_SHADOWSIZE > 0
+  uint32_t page, start, end;
+
+  for (page = 0; _eepromShadowDirty; page++)
+  {
+    if (!(_eepromShadowDirty & (1UL << page)))
+    {
+      continue;
+    }
+
+    // Page boundaries clipped to the shadowed region
+    start = (CFG_EEPROM_SHADOWSTART / EEPROM_SHADOWCHUNK + page) * EEPROM_SHADOWCHUNK;
+    end = start + EEPROM_SHADOWCHUNK;
+    start = start > CFG_EEPROM_SHADOWSTART ? start : CFG_EEPROM_SHADOWSTART;
+    end = end < EEPROM_SHADOWEND ? end : EEPROM_SHADOWEND;
+
+    if (eepromDevWrite(start, &_eepromShadow[start - CFG_EEPROM_SHADOWSTART], end - start))
+    {
+      return FALSE;
+    }
+    _eepromShadowDirty &= ~(1UL << page);
+  }
+#endif
+
+  return TRUE;
+}
+
 /**************************************************************************/
 /*! 
     @brief Checks whether the supplied address is within the valid range
@@ -56,7 +219,7 @@ static uint8_t buf[32];
 bool eepromCheckAddress(uint16_t addr)
 {
   // Check for invalid values
-  return addr <= MCP24AA_MAXADDR ? FALSE : TRUE;
+  return addr <= EEPROM_MAXADDR ? FALSE : TRUE;
 }
 
 /**************************************************************************/
@@ -71,8 +234,8 @@ bool eepromCheckAddress(uint16_t addr)
 /**************************************************************************/
 uint8_t eepromReadU8(uint16_t addr)
 {
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaReadBuffer(addr, buf, sizeof(uint8_t));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromRead(addr, buf, sizeof(uint8_t));
 
   // ToDo: Handle any errors
   if (error) { };
@@ -94,8 +257,8 @@ int8_t eepromReadS8(uint16_t addr)
 {
   int8_t results;
 
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaReadBuffer(addr, buf, sizeof(int8_t));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromRead(addr, buf, sizeof(int8_t));
   
   // ToDo: Handle any errors
   if (error) { };
@@ -118,8 +281,8 @@ uint16_t eepromReadU16(uint16_t addr)
 {
   uint16_t results;
 
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaReadBuffer(addr, buf, sizeof(uint16_t));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromRead(addr, buf, sizeof(uint16_t));
   
   // ToDo: Handle any errors
   if (error) { };
@@ -143,8 +306,8 @@ int16_t eepromReadS16(uint16_t addr)
 {
   int16_t results;
 
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaReadBuffer(addr, buf, sizeof(int16_t));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromRead(addr, buf, sizeof(int16_t));
   
   // ToDo: Handle any errors
   if (error) { };
@@ -167,8 +330,8 @@ uint32_t eepromReadU32(uint16_t addr)
 {
   uint32_t results;
 
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaReadBuffer(addr, buf, sizeof(uint32_t));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromRead(addr, buf, sizeof(uint32_t));
   
   // ToDo: Handle any errors
   if (error) { };
@@ -191,8 +354,8 @@ int32_t eepromReadS32(uint16_t addr)
 {
   int32_t results;
 
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaReadBuffer(addr, buf, sizeof(int32_t));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromRead(addr, buf, sizeof(int32_t));
   
   // ToDo: Handle any errors
   if (error) { };
@@ -215,8 +378,8 @@ uint64_t eepromReadU64(uint16_t addr)
 {
   uint64_t results;
 
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaReadBuffer(addr, buf, sizeof(uint64_t));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromRead(addr, buf, sizeof(uint64_t));
   
   // ToDo: Handle any errors
   if (error) { };
@@ -239,8 +402,8 @@ int64_t eepromReadS64(uint16_t addr)
 {
   int64_t results;
 
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaReadBuffer(addr, buf, sizeof(int64_t));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromRead(addr, buf, sizeof(int64_t));
   
   // ToDo: Handle any errors
   if (error) { };
@@ -264,10 +427,10 @@ int64_t eepromReadS64(uint16_t addr)
 void eepromReadBuffer(uint16_t addr, uint8_t *buffer, uint32_t bufferLength)
 {
   // Instantiate error message placeholder
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
+  eepromError_e error = EEPROM_ERROR_OK;
   
   // Read the contents of address
-  error = mcp24aaReadBuffer(addr, buffer, bufferLength);
+  error = eepromRead(addr, buffer, bufferLength);
 
   // ToDo: Handle any errors
   if (error) { };
@@ -283,8 +446,8 @@ void eepromReadBuffer(uint16_t addr, uint8_t *buffer, uint32_t bufferLength)
 /**************************************************************************/
 void eepromWriteU8(uint16_t addr, uint8_t value)
 {
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaWriteBuffer(addr, (uint8_t *)&value, sizeof(value));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromWrite(addr, (uint8_t *)&value, sizeof(value));
 
   // ToDo: Handle any errors
   if (error) { };
@@ -300,8 +463,8 @@ void eepromWriteU8(uint16_t addr, uint8_t value)
 /**************************************************************************/
 void eepromWriteS8(uint16_t addr, int8_t value)
 {
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaWriteBuffer(addr, (uint8_t *)&value, sizeof(value));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromWrite(addr, (uint8_t *)&value, sizeof(value));
 
   // ToDo: Handle any errors
   if (error) { };
@@ -317,8 +480,8 @@ void eepromWriteS8(uint16_t addr, int8_t value)
 /**************************************************************************/
 void eepromWriteU16(uint16_t addr, uint16_t value)
 {
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaWriteBuffer(addr, (uint8_t *)&value, sizeof(value));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromWrite(addr, (uint8_t *)&value, sizeof(value));
 
   // ToDo: Handle any errors
   if (error) { };
@@ -334,8 +497,8 @@ void eepromWriteU16(uint16_t addr, uint16_t value)
 /**************************************************************************/
 void eepromWriteS16(uint16_t addr, int16_t value)
 {
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaWriteBuffer(addr, (uint8_t *)&value, sizeof(value));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromWrite(addr, (uint8_t *)&value, sizeof(value));
 
   // ToDo: Handle any errors
   if (error) { };
@@ -351,8 +514,8 @@ void eepromWriteS16(uint16_t addr, int16_t value)
 /**************************************************************************/
 void eepromWriteU32(uint16_t addr, uint32_t value)
 {
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaWriteBuffer(addr, (uint8_t *)&value, sizeof(value));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromWrite(addr, (uint8_t *)&value, sizeof(value));
 
   // ToDo: Handle any errors
   if (error) { };
@@ -368,8 +531,8 @@ void eepromWriteU32(uint16_t addr, uint32_t value)
 /**************************************************************************/
 void eepromWriteS32(uint16_t addr, int32_t value)
 {
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaWriteBuffer(addr, (uint8_t *)&value, sizeof(value));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromWrite(addr, (uint8_t *)&value, sizeof(value));
 
   // ToDo: Handle any errors
   if (error) { };
@@ -385,8 +548,8 @@ void eepromWriteS32(uint16_t addr, int32_t value)
 /**************************************************************************/
 void eepromWriteU64(uint16_t addr, uint64_t value)
 {
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaWriteBuffer(addr, (uint8_t *)&value, sizeof(value));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromWrite(addr, (uint8_t *)&value, sizeof(value));
 
   // ToDo: Handle any errors
   if (error) { };
@@ -402,9 +565,51 @@ void eepromWriteU64(uint16_t addr, uint64_t value)
 /**************************************************************************/
 void eepromWriteS64(uint16_t addr, int64_t value)
 {
-  mcp24aaError_e error = MCP24AA_ERROR_OK;
-  error = mcp24aaWriteBuffer(addr, (uint8_t *)&value, sizeof(value));
+  eepromError_e error = EEPROM_ERROR_OK;
+  error = eepromWrite(addr, (uint8_t *)&value, sizeof(value));
 
   // ToDo: Handle any errors
   if (error) { };
 }
+
+/**************************************************************************/
+/*! 
+    @brief Reads a block of any length from EEPROM
+
+    @param[in]  addr
+                The 16-bit address to read from in EEPROM
+    @param[out] buffer
+                Pointer to the buffer that will store the retrieved bytes
+    @param[in]  length
+                The number of bytes to read
+
+    @return     TRUE if the block was read, otherwise FALSE
+*/
+/**************************************************************************/
+bool eepromReadBlock(uint16_t addr, uint8_t *buffer, uint32_t length)
+{
+  return eepromRead(addr, buffer, length) == EEPROM_ERROR_OK ? TRUE : FALSE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Writes a block of any length to EEPROM
+
+    The block is split on the EEPROM page boundaries and written one
+    full page at a time, waiting only as long as each write cycle
+    actually takes.
+
+    @param[in]  addr
+                The 16-bit address to write to in EEPROM
+    @param[in]  buffer
+                Pointer to the bytes to write
+    @param[in]  length
+                The number of bytes to write
+
+    @return     TRUE if the block was written, otherwise FALSE
+*/
+/**************************************************************************/
+bool eepromWriteBlock(uint16_t addr, const uint8_t *buffer, uint32_t length)
+{
+  return eepromWrite(addr, buffer, length) == EEPROM_ERROR_OK ? TRUE : FALSE;
+}
@@ -39,6 +39,8 @@
 #include "projectconfig.h"
 
 // Method Prototypes
+void      eepromInit ( void );
+bool      eepromFlush ( void );
 bool      eepromCheckAddress ( uint16_t addr );
 uint8_t   eepromReadU8 ( uint16_t addr );
 int8_t    eepromReadS8 ( uint16_t addr );
@@ -57,5 +59,7 @@ void      eepromWriteU32 ( uint16_t addr, uint32_t value );
 void      eepromWriteS32 ( uint16_t addr, int32_t value );
 void      eepromWriteU64 ( uint16_t addr, uint64_t value );
 void      eepromWriteS64 ( uint16_t addr, int64_t value );
+bool      eepromReadBlock ( uint16_t addr, uint8_t *buffer, uint32_t length );
+bool      eepromWriteBlock ( uint16_t addr, const uint8_t *buffer, uint32_t length );
 
 #endif
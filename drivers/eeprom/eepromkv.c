@@ -0,0 +1,525 @@
+/**************************************************************************/
+/*! 
+    @file     eepromkv.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Small journaled key/value store on top of eeprom.c.
+
+    The EEPROM area defined by CFG_EEPROM_KV_START and CFG_EEPROM_KV_SIZE
+    is split into two banks.  Values are never rewritten in place:
+    every write appends one record to the end of the active bank, which
+    spreads the writes over the whole bank instead of wearing out the
+    same few cells.  When the active bank is full, the live values are
+    copied into the other bank (compaction) and its header is written
+    last, so a reset in the middle of a compaction leaves the old bank
+    in use.
+
+    At boot (eepromKvInit) the active bank is replayed into an index in
+    RAM that also caches the values, so reads never touch the EEPROM.
+
+    Bank layout:
+
+    'K' 'V' gen crc                           Bank header
+    key len gen value[len] crc                One record per write
+
+    A record with a length of 0 deletes the key.  The generation byte
+    and the CRC of every record are checked while replaying the bank,
+    and the first record that doesn't match marks the end of the log
+    (this also discards a record that was only partially written).
+
+    @section Example
+
+    @code 
+    #include "drivers/eeprom/eepromkv.h"
+
+    #define KEY_BACKLIGHT (1)
+
+    uint8_t level = 80;
+    uint8_t length;
+
+    eepromKvInit();
+    if (eepromKvRead(KEY_BACKLIGHT, &level, sizeof(level), &length))
+    {
+      // Not stored yet, so save the default value
+      eepromKvWrite(KEY_BACKLIGHT, &level, sizeof(level));
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "eepromkv.h"
+#include "eeprom.h"
+
+#define EEPROMKV_BANKSIZE       (CFG_EEPROM_KV_SIZE / 2)
+#define EEPROMKV_HEADERSIZE     (4)
+#define EEPROMKV_RECORDSIZE(n)  (4 + (n))
+
+typedef struct
+{
+  uint8_t key;
+  uint8_t length;
+  uint8_t value[CFG_EEPROM_KV_MAXVALUE];
+} eepromKvEntry_t;
+
+static eepromKvEntry_t _kvIndex[CFG_EEPROM_KV_MAXKEYS];
+static uint8_t _kvCount = 0;
+static uint8_t _kvBank = 0;
+static uint8_t _kvGeneration = 0;
+static uint16_t _kvFree = 0;
+static bool _kvInitialised = false;
+
+// Scratch buffer for one record
+static uint8_t _kvRecord[EEPROMKV_RECORDSIZE(CFG_EEPROM_KV_MAXVALUE)];
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*! 
+    @brief  Updates a CRC-8 (polynomial 0x07) with the supplied bytes
+*/
+/**************************************************************************/
+static uint8_t eepromKvCrc(uint8_t crc, const uint8_t *data, uint32_t length)
+{
+  uint8_t bit;
+
+  while (length--)
+  {
+    crc ^= *data++;
+    for (bit = 0; bit < 8; bit++)
+    {
+      crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+  }
+
+  return crc;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the EEPROM address of the supplied bank
+*/
+/**************************************************************************/
+static uint16_t eepromKvBankAddress(uint8_t bank)
+{
+  return CFG_EEPROM_KV_START + bank * EEPROMKV_BANKSIZE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the index slot for the supplied key, or NULL
+*/
+/**************************************************************************/
+static eepromKvEntry_t *eepromKvFind(uint8_t key)
+{
+  uint8_t i;
+
+  for (i = 0; i < _kvCount; i++)
+  {
+    if (_kvIndex[i].key == key)
+    {
+      return &_kvIndex[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Applies a record to the RAM index (a length of 0 removes
+            the key)
+*/
+/**************************************************************************/
+static eepromKvError_e eepromKvApply(uint8_t key, const uint8_t *value, uint8_t length)
+{
+  eepromKvEntry_t *entry = eepromKvFind(key);
+
+  if (length == 0)
+  {
+    if (entry != NULL)
+    {
+      // Move the last entry into the free slot
+      *entry = _kvIndex[--_kvCount];
+    }
+    return EEPROMKV_ERROR_OK;
+  }
+
+  if (entry == NULL)
+  {
+    if (_kvCount == CFG_EEPROM_KV_MAXKEYS)
+    {
+      return EEPROMKV_ERROR_FULL;
+    }
+    entry = &_kvIndex[_kvCount++];
+    entry->key = key;
+  }
+
+  entry->length = length;
+  memcpy(entry->value, value, length);
+
+  return EEPROMKV_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Writes one record at the supplied offset in a bank
+*/
+/**************************************************************************/
+static eepromKvError_e eepromKvWriteRecord(uint8_t bank, uint16_t offset, uint8_t key, const uint8_t *value, uint8_t length)
+{
+  _kvRecord[0] = key;
+  _kvRecord[1] = length;
+  _kvRecord[2] = _kvGeneration;
+  memcpy(&_kvRecord[3], value, length);
+  _kvRecord[3 + length] = eepromKvCrc(0, _kvRecord, 3 + length);
+
+  if (!eepromWriteBlock(eepromKvBankAddress(bank) + offset, _kvRecord, EEPROMKV_RECORDSIZE(length)))
+  {
+    return EEPROMKV_ERROR_EEPROM;
+  }
+
+  return EEPROMKV_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Writes the header that makes a bank valid
+*/
+/**************************************************************************/
+static eepromKvError_e eepromKvWriteHeader(uint8_t bank)
+{
+  uint8_t header[EEPROMKV_HEADERSIZE] = { 'K', 'V', _kvGeneration, 0 };
+
+  header[3] = eepromKvCrc(0, header, 3);
+  if (!eepromWriteBlock(eepromKvBankAddress(bank), header, sizeof(header)))
+  {
+    return EEPROMKV_ERROR_EEPROM;
+  }
+
+  return EEPROMKV_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reads a bank header
+
+    @return TRUE if the header is valid (its generation is stored in
+            'generation')
+*/
+/**************************************************************************/
+static bool eepromKvReadHeader(uint8_t bank, uint8_t *generation)
+{
+  uint8_t header[EEPROMKV_HEADERSIZE];
+
+  if (!eepromReadBlock(eepromKvBankAddress(bank), header, sizeof(header)))
+  {
+    return FALSE;
+  }
+  if ((header[0] != 'K') || (header[1] != 'V') || (header[3] != eepromKvCrc(0, header, 3)))
+  {
+    return FALSE;
+  }
+
+  *generation = header[2];
+  return TRUE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Replays the records in the active bank into the RAM index
+            and finds the end of the log
+*/
+/**************************************************************************/
+static eepromKvError_e eepromKvReplay(void)
+{
+  uint16_t base = eepromKvBankAddress(_kvBank);
+  uint16_t offset = EEPROMKV_HEADERSIZE;
+  uint8_t length;
+
+  _kvCount = 0;
+  while (offset + EEPROMKV_RECORDSIZE(0) <= EEPROMKV_BANKSIZE)
+  {
+    if (!eepromReadBlock(base + offset, _kvRecord, 3))
+    {
+      return EEPROMKV_ERROR_EEPROM;
+    }
+
+    // Stop at the first record that isn't part of this generation
+    length = _kvRecord[1];
+    if ((_kvRecord[0] == 0x00) || (_kvRecord[0] == 0xFF) ||
+        (_kvRecord[2] != _kvGeneration) ||
+        (length > CFG_EEPROM_KV_MAXVALUE) ||
+        (offset + EEPROMKV_RECORDSIZE(length) > EEPROMKV_BANKSIZE))
+    {
+      break;
+    }
+    if (!eepromReadBlock(base + offset + 3, &_kvRecord[3], length + 1))
+    {
+      return EEPROMKV_ERROR_EEPROM;
+    }
+    if (_kvRecord[3 + length] != eepromKvCrc(0, _kvRecord, 3 + length))
+    {
+      break;
+    }
+
+    eepromKvApply(_kvRecord[0], &_kvRecord[3], length);
+    offset += EEPROMKV_RECORDSIZE(length);
+  }
+
+  _kvFree = offset;
+  return EEPROMKV_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Appends a record to the active bank, compacting first if
+            there isn't enough room left
+*/
+/**************************************************************************/
+static eepromKvError_e eepromKvAppend(uint8_t key, const uint8_t *value, uint8_t length)
+{
+  eepromKvError_e error;
+
+  if (_kvFree + EEPROMKV_RECORDSIZE(length) > EEPROMKV_BANKSIZE)
+  {
+    // The RAM index is already up to date, so compaction stores it
+    return eepromKvCompact();
+  }
+
+  error = eepromKvWriteRecord(_kvBank, _kvFree, key, value, length);
+  if (error)
+  {
+    return error;
+  }
+
+  _kvFree += EEPROMKV_RECORDSIZE(length);
+  return EEPROMKV_ERROR_OK;
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*! 
+    @brief  Finds the active bank and builds the RAM index.  A blank
+            store is formatted the first time this is called.
+*/
+/**************************************************************************/
+eepromKvError_e eepromKvInit(void)
+{
+  uint8_t gen0, gen1;
+  bool valid0, valid1;
+
+  valid0 = eepromKvReadHeader(0, &gen0);
+  valid1 = eepromKvReadHeader(1, &gen1);
+
+  if (!valid0 && !valid1)
+  {
+    // Empty store
+    _kvBank = 0;
+    _kvGeneration = 0;
+    _kvCount = 0;
+    _kvFree = EEPROMKV_HEADERSIZE;
+    if (eepromKvWriteHeader(0))
+    {
+      return EEPROMKV_ERROR_EEPROM;
+    }
+    _kvInitialised = true;
+    return EEPROMKV_ERROR_OK;
+  }
+
+  // Use the most recent bank (the generation counter wraps)
+  if (valid0 && (!valid1 || (int8_t)(gen0 - gen1) > 0))
+  {
+    _kvBank = 0;
+    _kvGeneration = gen0;
+  }
+  else
+  {
+    _kvBank = 1;
+    _kvGeneration = gen1;
+  }
+
+  _kvInitialised = true;
+  return eepromKvReplay();
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reads a value from the RAM index
+
+    @param[in]  key
+                Key to look up (0x01..0xFE)
+    @param[out] buffer
+                Buffer that will receive the value
+    @param[in]  bufferLength
+                Size of 'buffer' (longer values are truncated)
+    @param[out] length
+                Length of the stored value (may be NULL)
+*/
+/**************************************************************************/
+eepromKvError_e eepromKvRead(uint8_t key, uint8_t *buffer, uint8_t bufferLength, uint8_t *length)
+{
+  eepromKvEntry_t *entry;
+
+  if (!_kvInitialised) eepromKvInit();
+
+  entry = eepromKvFind(key);
+  if (entry == NULL)
+  {
+    return EEPROMKV_ERROR_NOTFOUND;
+  }
+
+  memcpy(buffer, entry->value, entry->length < bufferLength ? entry->length : bufferLength);
+  if (length != NULL)
+  {
+    *length = entry->length;
+  }
+
+  return EEPROMKV_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Stores a value, appending a single record to the log.
+            Nothing is written if the value hasn't changed.
+
+    @param[in]  key
+                Key to store (0x01..0xFE)
+    @param[in]  value
+                Pointer to the value
+    @param[in]  length
+                Length of the value (1..CFG_EEPROM_KV_MAXVALUE)
+*/
+/**************************************************************************/
+eepromKvError_e eepromKvWrite(uint8_t key, const uint8_t *value, uint8_t length)
+{
+  eepromKvEntry_t *entry;
+  eepromKvError_e error;
+
+  if (!_kvInitialised) eepromKvInit();
+
+  if ((key == 0x00) || (key == 0xFF))
+  {
+    return EEPROMKV_ERROR_INVALIDKEY;
+  }
+  if ((length == 0) || (length > CFG_EEPROM_KV_MAXVALUE))
+  {
+    return EEPROMKV_ERROR_TOOLONG;
+  }
+
+  entry = eepromKvFind(key);
+  if ((entry != NULL) && (entry->length == length) && !memcmp(entry->value, value, length))
+  {
+    return EEPROMKV_ERROR_OK;
+  }
+
+  error = eepromKvApply(key, value, length);
+  if (error)
+  {
+    return error;
+  }
+
+  return eepromKvAppend(key, value, length);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Removes a key from the store
+
+    @param[in]  key
+                Key to remove (0x01..0xFE)
+*/
+/**************************************************************************/
+eepromKvError_e eepromKvDelete(uint8_t key)
+{
+  if (!_kvInitialised) eepromKvInit();
+
+  if (eepromKvFind(key) == NULL)
+  {
+    return EEPROMKV_ERROR_NOTFOUND;
+  }
+
+  eepromKvApply(key, NULL, 0);
+  return eepromKvAppend(key, NULL, 0);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Copies the live values into the other bank and makes it the
+            active bank.  This is done automatically when the active
+            bank is full.
+*/
+/**************************************************************************/
+eepromKvError_e eepromKvCompact(void)
+{
+  uint8_t bank = _kvBank ^ 1;
+  uint16_t offset = EEPROMKV_HEADERSIZE;
+  eepromKvError_e error;
+  uint8_t i;
+
+  if (!_kvInitialised) eepromKvInit();
+
+  _kvGeneration++;
+  for (i = 0; i < _kvCount; i++)
+  {
+    error = eepromKvWriteRecord(bank, offset, _kvIndex[i].key, _kvIndex[i].value, _kvIndex[i].length);
+    if (error)
+    {
+      _kvGeneration--;
+      return error;
+    }
+    offset += EEPROMKV_RECORDSIZE(_kvIndex[i].length);
+  }
+
+  // Writing the header last switches over to the new bank
+  error = eepromKvWriteHeader(bank);
+  if (error)
+  {
+    _kvGeneration--;
+    return error;
+  }
+
+  _kvBank = bank;
+  _kvFree = offset;
+  return EEPROMKV_ERROR_OK;
+}
@@ -0,0 +1,60 @@
+/**************************************************************************/
+/*! 
+    @file     eepromkv.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __EEPROMKV_H__ 
+#define __EEPROMKV_H__
+
+#include "projectconfig.h"
+
+typedef enum
+{
+  EEPROMKV_ERROR_OK = 0,              // Everything executed normally
+  EEPROMKV_ERROR_INVALIDKEY,          // Keys 0x00 and 0xFF are reserved
+  EEPROMKV_ERROR_TOOLONG,             // Value is longer than CFG_EEPROM_KV_MAXVALUE
+  EEPROMKV_ERROR_FULL,                // No free slot in the index for a new key
+  EEPROMKV_ERROR_NOTFOUND,            // The key isn't in the store
+  EEPROMKV_ERROR_EEPROM,              // Unable to read/write the EEPROM
+  EEPROMKV_ERROR_LAST
+}
+eepromKvError_e;
+
+// Method Prototypes
+eepromKvError_e eepromKvInit ( void );
+eepromKvError_e eepromKvRead ( uint8_t key, uint8_t *buffer, uint8_t bufferLength, uint8_t *length );
+eepromKvError_e eepromKvWrite ( uint8_t key, const uint8_t *value, uint8_t length );
+eepromKvError_e eepromKvDelete ( uint8_t key );
+eepromKvError_e eepromKvCompact ( void );
+
+#endif
@@ -0,0 +1,349 @@
+/**************************************************************************/
+/*! 
+    @file     eepromlog.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Append-only circular event log on top of eeprom.c, for post-mortem
+    diagnostics when nothing was attached to the CLI.
+
+    The EEPROM area defined by CFG_EEPROM_LOG_START and
+    CFG_EEPROM_LOG_SIZE is split into 16-byte records.  The records are
+    aligned so that each one sits inside a single MCP24AA page, which
+    means logging an event costs exactly one page write, and the oldest
+    record is simply overwritten once the area is full.
+
+    Record layout (little endian):
+
+    seq[4] timestamp[4] event[2] data[5] crc
+
+    The sequence number increments with every event and a valid record
+    has a matching CRC-8 and a sequence number other than 0 or
+    0xFFFFFFFF (erased EEPROM).  Starting from the record in slot 0,
+    slot i holds sequence number seq0 + i up to the most recent event,
+    and the slots after it are either empty or hold older events from
+    the previous lap.  That condition is monotonic, so eepromLogInit
+    finds the head with a binary search (log2 of the number of records
+    reads) instead of reading the whole area.  An event that was only
+    partially written fails its CRC and is treated as the end of the
+    log.
+
+    @section Example
+
+    @code 
+    #include "drivers/eeprom/eepromlog.h"
+
+    #define EVENT_BROWNOUT (0x0001)
+
+    uint8_t vbat = 31;        // Battery voltage in 0.1V
+    eepromLogEntry_t entry;
+
+    eepromLogInit();
+    eepromLogWrite(EVENT_BROWNOUT, &vbat, sizeof(vbat));
+
+    // Read back the most recent event
+    if (eepromLogRead(0, &entry) == EEPROMLOG_ERROR_OK)
+    {
+      printf("#%u event %04X\r\n", entry.sequence, entry.event);
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+/**************************************************************************/
+#include <string.h>
+
+#include "eepromlog.h"
+#include "eeprom.h"
+#include "core/systick/systick.h"
+
+static uint16_t _logHead = 0;         // Slot the next event is written to
+static uint16_t _logCount = 0;        // Number of valid events
+static uint32_t _logSequence = 1;     // Sequence number of the next event
+static bool _logInitialised = false;
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*! 
+    @brief  Updates a CRC-8 (polynomial 0x07) with the supplied bytes
+*/
+/**************************************************************************/
+static uint8_t eepromLogCrc(const uint8_t *data, uint32_t length)
+{
+  uint8_t crc = 0;
+  uint8_t bit;
+
+  while (length--)
+  {
+    crc ^= *data++;
+    for (bit = 0; bit < 8; bit++)
+    {
+      crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+  }
+
+  return crc;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reads the record in the supplied slot
+
+    @return TRUE if the slot holds a valid event
+*/
+/**************************************************************************/
+static bool eepromLogReadSlot(uint16_t slot, eepromLogEntry_t *entry)
+{
+  uint8_t record[EEPROMLOG_RECORDSIZE];
+
+  if (!eepromReadBlock(CFG_EEPROM_LOG_START + slot * EEPROMLOG_RECORDSIZE, record, sizeof(record)))
+  {
+    return FALSE;
+  }
+  if (record[EEPROMLOG_RECORDSIZE - 1] != eepromLogCrc(record, EEPROMLOG_RECORDSIZE - 1))
+  {
+    return FALSE;
+  }
+
+  entry->sequence = record[0] | (record[1] << 8) | (record[2] << 16) | ((uint32_t)record[3] << 24);
+  entry->timestamp = record[4] | (record[5] << 8) | (record[6] << 16) | ((uint32_t)record[7] << 24);
+  entry->event = record[8] | (record[9] << 8);
+  memcpy(entry->data, &record[10], EEPROMLOG_DATASIZE);
+
+  return (entry->sequence != 0) && (entry->sequence != 0xFFFFFFFF);
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*! 
+    @brief  Finds the head of the log with a binary search
+
+    @note   This is called automatically by the other methods, but can
+            be called at boot to keep the search out of a time
+            critical path.
+*/
+/**************************************************************************/
+eepromLogError_e eepromLogInit(void)
+{
+  eepromLogEntry_t first, entry;
+  uint16_t lo, hi, mid;
+
+  _logHead = 0;
+  _logCount = 0;
+  _logSequence = 1;
+  _logInitialised = true;
+
+  if (!eepromLogReadSlot(0, &first))
+  {
+    // Either the log is empty, or the event in slot 0 was being
+    // written after a lap, in which case the last slot is the newest
+    if (eepromLogReadSlot(EEPROMLOG_RECORDS - 1, &entry))
+    {
+      _logSequence = entry.sequence + 1;
+      _logCount = EEPROMLOG_RECORDS - 1;
+    }
+    return EEPROMLOG_ERROR_OK;
+  }
+
+  // Slot 0 holds first.sequence, so the head is the first slot (1 ..
+  // EEPROMLOG_RECORDS) that doesn't continue the sequence
+  lo = 1;
+  hi = EEPROMLOG_RECORDS;
+  while (lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+    if (eepromLogReadSlot(mid, &entry) && (entry.sequence == first.sequence + mid))
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  _logHead = lo % EEPROMLOG_RECORDS;
+  _logSequence = first.sequence + lo;
+  _logCount = lo;
+  if ((lo < EEPROMLOG_RECORDS) && eepromLogReadSlot(EEPROMLOG_RECORDS - 1, &entry))
+  {
+    // The slots after the head still hold the previous lap
+    _logCount = EEPROMLOG_RECORDS;
+    if (!eepromLogReadSlot(lo, &entry))
+    {
+      // Except for the head itself, which was cut short
+      _logCount--;
+    }
+  }
+
+  return EEPROMLOG_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Appends an event to the log, overwriting the oldest event
+            once the log is full (one EEPROM page write)
+
+    @param[in]  event
+                Application defined event code
+    @param[in]  *data
+                Optional data stored with the event (can be NULL)
+    @param[in]  length
+                The number of bytes of data (max EEPROMLOG_DATASIZE)
+*/
+/**************************************************************************/
+eepromLogError_e eepromLogWrite(uint16_t event, const uint8_t *data, uint8_t length)
+{
+  uint8_t record[EEPROMLOG_RECORDSIZE];
+  uint32_t now;
+
+  if (length > EEPROMLOG_DATASIZE)
+  {
+    return EEPROMLOG_ERROR_TOOLONG;
+  }
+
+  if (!_logInitialised) eepromLogInit();
+
+  // 0xFFFFFFFF is erased EEPROM, so skip it (and 0) when wrapping
+  if ((_logSequence == 0) || (_logSequence == 0xFFFFFFFF))
+  {
+    _logSequence = 1;
+  }
+
+  now = systickGetTicks();
+  record[0] = _logSequence & 0xFF;
+  record[1] = (_logSequence >> 8) & 0xFF;
+  record[2] = (_logSequence >> 16) & 0xFF;
+  record[3] = _logSequence >> 24;
+  record[4] = now & 0xFF;
+  record[5] = (now >> 8) & 0xFF;
+  record[6] = (now >> 16) & 0xFF;
+  record[7] = now >> 24;
+  record[8] = event & 0xFF;
+  record[9] = event >> 8;
+  memset(&record[10], 0, EEPROMLOG_DATASIZE);
+  if (length)
+  {
+    memcpy(&record[10], data, length);
+  }
+  record[EEPROMLOG_RECORDSIZE - 1] = eepromLogCrc(record, EEPROMLOG_RECORDSIZE - 1);
+
+  if (!eepromWriteBlock(CFG_EEPROM_LOG_START + _logHead * EEPROMLOG_RECORDSIZE, record, sizeof(record)))
+  {
+    return EEPROMLOG_ERROR_EEPROM;
+  }
+
+  _logSequence++;
+  _logHead = (_logHead + 1) % EEPROMLOG_RECORDS;
+  if (_logCount < EEPROMLOG_RECORDS)
+  {
+    _logCount++;
+  }
+
+  return EEPROMLOG_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reads an event from the log
+
+    @param[in]  age
+                0 for the most recent event, up to eepromLogCount() - 1
+                for the oldest one
+    @param[out] *entry
+                The event
+*/
+/**************************************************************************/
+eepromLogError_e eepromLogRead(uint16_t age, eepromLogEntry_t *entry)
+{
+  uint16_t slot;
+
+  if (!_logInitialised) eepromLogInit();
+
+  if (age >= _logCount)
+  {
+    return EEPROMLOG_ERROR_NOTFOUND;
+  }
+
+  slot = (_logHead + EEPROMLOG_RECORDS - 1 - age) % EEPROMLOG_RECORDS;
+  if (!eepromLogReadSlot(slot, entry))
+  {
+    return EEPROMLOG_ERROR_EEPROM;
+  }
+
+  return EEPROMLOG_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the number of events in the log
+*/
+/**************************************************************************/
+uint16_t eepromLogCount(void)
+{
+  if (!_logInitialised) eepromLogInit();
+
+  return _logCount;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Erases every record (one page write per record, so this
+            isn't meant to be called often)
+*/
+/**************************************************************************/
+eepromLogError_e eepromLogClear(void)
+{
+  uint8_t record[EEPROMLOG_RECORDSIZE];
+  uint16_t slot;
+
+  memset(record, 0xFF, sizeof(record));
+  for (slot = 0; slot < EEPROMLOG_RECORDS; slot++)
+  {
+    if (!eepromWriteBlock(CFG_EEPROM_LOG_START + slot * EEPROMLOG_RECORDSIZE, record, sizeof(record)))
+    {
+      return EEPROMLOG_ERROR_EEPROM;
+    }
+  }
+
+  return eepromLogInit();
+}
@@ -0,0 +1,72 @@
+/**************************************************************************/
+/*! 
+    @file     eepromlog.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+/**************************************************************************/
+#ifndef __EEPROMLOG_H__ 
+#define __EEPROMLOG_H__
+
+#include "projectconfig.h"
+
+#define EEPROMLOG_RECORDSIZE    (16)                                  // Bytes per record in EEPROM
+#define EEPROMLOG_DATASIZE      (5)                                   // Bytes of data in each event
+#define EEPROMLOG_RECORDS       (CFG_EEPROM_LOG_SIZE / EEPROMLOG_RECORDSIZE)
+
+typedef enum
+{
+  EEPROMLOG_ERROR_OK = 0,             // Everything executed normally
+  EEPROMLOG_ERROR_TOOLONG,            // More than EEPROMLOG_DATASIZE bytes of data
+  EEPROMLOG_ERROR_NOTFOUND,           // No event at the requested age
+  EEPROMLOG_ERROR_EEPROM,             // Unable to read/write the EEPROM
+  EEPROMLOG_ERROR_LAST
+}
+eepromLogError_e;
+
+typedef struct
+{
+  uint32_t sequence;                  // Increments with every event (never 0)
+  uint32_t timestamp;                 // systickGetTicks() when it was logged
+  uint16_t event;                     // Application defined event code
+  uint8_t data[EEPROMLOG_DATASIZE];   // Optional data (unused bytes are 0)
+}
+eepromLogEntry_t;
+
+// Method Prototypes
+eepromLogError_e eepromLogInit ( void );
+eepromLogError_e eepromLogWrite ( uint16_t event, const uint8_t *data, uint8_t length );
+eepromLogError_e eepromLogRead ( uint16_t age, eepromLogEntry_t *entry );
+uint16_t         eepromLogCount ( void );
+eepromLogError_e eepromLogClear ( void );
+
+#endif
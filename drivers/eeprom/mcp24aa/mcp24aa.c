@@ -112,6 +112,65 @@ uint32_t i, timeout;
 
 static bool _mcp24aaInitialised = false;
 
+// Address bytes followed by up to one page of data for the block methods
+static uint8_t _mcp24aaPage[2 + MCP24AA_PAGESIZE];
+
+/**************************************************************************/
+/*! 
+    @brief  Runs one transfer through the I2C queue and waits for it to
+            complete.  The first two bytes of _mcp24aaPage hold the
+            EEPROM address.
+
+    @param[in]  writeLength
+                The number of bytes in _mcp24aaPage to send
+    @param[in]  *readBuffer
+                Pointer to the buffer that will store any read results
+    @param[in]  readLength
+                The number of bytes to read after the write
+
+    @return     The terminal I2CSTATE_... value of the transfer
+*/
+/**************************************************************************/
+static uint32_t mcp24aaTransfer (uint8_t writeLength, uint8_t *readBuffer, uint8_t readLength)
+{
+  i2cTransfer_t transfer;
+
+  transfer.address = MCP24AA_ADDR;
+  transfer.writeBuffer = _mcp24aaPage;
+  transfer.writeLength = writeLength;
+  transfer.readBuffer = readBuffer;
+  transfer.readLength = readLength;
+  transfer.callback = NULL;
+  transfer.speed = MCP24AA_I2C_SPEED;
+
+  while (!i2cQueueTransfer(&transfer));
+  while (transfer.state == I2CSTATE_PENDING);
+
+  return transfer.state;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Waits for the current write cycle to finish by polling the
+            EEPROM until it acknowledges its address again (an address
+            only write doesn't start a new write cycle)
+*/
+/**************************************************************************/
+static mcp24aaError_e mcp24aaWaitForWrite (void)
+{
+  uint32_t poll;
+
+  for (poll = 0; poll < MCP24AA_ACKPOLLMAX; poll++)
+  {
+    if (mcp24aaTransfer(2, NULL, 0) == I2CSTATE_ACK)
+    {
+      return MCP24AA_ERROR_OK;
+    }
+  }
+
+  return MCP24AA_ERROR_TIMEOUT;
+}
+
 /**************************************************************************/
 /*! 
     @brief  Initialises the I2C block
@@ -182,7 +241,7 @@ mcp24aaError_e mcp24aaReadBuffer (uint16_t address, uint8_t *buffer, uint32_t bu
   I2CMasterBuffer[3] = MCP24AA_ADDR | MCP24AA_READBIT;  
 
   // Transmit command
-  i2cEngine();
+  i2cEngineSpeed(MCP24AA_I2C_SPEED);
 
   // Fill response buffer
   for (i = 0; i < bufferLength; i++)
@@ -244,7 +303,7 @@ mcp24aaError_e mcp24aaWriteBuffer (uint16_t address, uint8_t *buffer, uint32_t b
   }
 
   // Transmit command
-  i2cEngine();
+  i2cEngineSpeed(MCP24AA_I2C_SPEED);
 
   // Wait at least 10ms
   systickDelay(10);
@@ -337,3 +396,114 @@ mcp24aaError_e mcp24aaWriteByte (uint16_t address, uint8_t value)
   return mcp24aaWriteBuffer(address, wBuffer, 1);
 }
 
+/**************************************************************************/
+/*! 
+    @brief Reads an arbitrary number of bytes from the supplied address.
+
+    Unlike mcp24aaReadBuffer this isn't limited to 8 bytes, and the
+    bytes are read in large sequential reads straight into the
+    supplied buffer.
+
+    @param[in]  address
+                The 16-bit address where the read will start
+    @param[out] *buffer
+                Pointer to the buffer that will store the read results
+    @param[in]  length
+                The number of bytes to read
+*/
+/**************************************************************************/
+mcp24aaError_e mcp24aaReadBlock (uint16_t address, uint8_t *buffer, uint32_t length)
+{
+  uint32_t chunk;
+
+  if (!_mcp24aaInitialised) mcp24aaInit();
+
+  if ((uint32_t)address + length > MCP24AA_MAXADDR + 1)
+  {
+    return MCP24AA_ERROR_ADDRERR;
+  }
+
+  while (length)
+  {
+    // The I2C queue handles up to 255 bytes per transfer
+    chunk = length > 255 ? 255 : length;
+
+    _mcp24aaPage[0] = (address >> 8);               // Address (high byte)
+    _mcp24aaPage[1] = (address & 0xFF);             // Address (low byte)
+    if (mcp24aaTransfer(2, buffer, chunk) != I2CSTATE_ACK)
+    {
+      return MCP24AA_ERROR_NACK;
+    }
+
+    address += chunk;
+    buffer += chunk;
+    length -= chunk;
+  }
+
+  return MCP24AA_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Writes an arbitrary number of bytes at the supplied address.
+
+    The data is split on the EEPROM page boundaries and each page is
+    written in a single page write.  Instead of waiting a fixed 10ms
+    after each write, the EEPROM is polled until it acknowledges again,
+    so each page only takes as long as its actual write cycle.
+
+    @param[in]  address
+                The 16-bit address where the write will start
+    @param[in]  *buffer
+                Pointer to the buffer that contains the values to write
+    @param[in]  length
+                The number of bytes to write
+*/
+/**************************************************************************/
+mcp24aaError_e mcp24aaWriteBlock (uint16_t address, const uint8_t *buffer, uint32_t length)
+{
+  mcp24aaError_e error;
+  uint32_t chunk, i;
+
+  if (!_mcp24aaInitialised) mcp24aaInit();
+
+  if ((uint32_t)address + length > MCP24AA_MAXADDR + 1)
+  {
+    return MCP24AA_ERROR_ADDRERR;
+  }
+
+  while (length)
+  {
+    // Don't cross a page boundary (the address would wrap in the page)
+    chunk = MCP24AA_PAGESIZE - (address % MCP24AA_PAGESIZE);
+    if (chunk > length)
+    {
+      chunk = length;
+    }
+
+    _mcp24aaPage[0] = (address >> 8);               // Address (high byte)
+    _mcp24aaPage[1] = (address & 0xFF);             // Address (low byte)
+    for (i = 0; i < chunk; i++)
+    {
+      _mcp24aaPage[i + 2] = buffer[i];
+    }
+
+    // A NACK on the address means a previous write cycle is still running
+    error = mcp24aaWaitForWrite();
+    if (error)
+    {
+      return error;
+    }
+    if (mcp24aaTransfer(2 + chunk, NULL, 0) != I2CSTATE_ACK)
+    {
+      return MCP24AA_ERROR_NACK;
+    }
+
+    address += chunk;
+    buffer += chunk;
+    length -= chunk;
+  }
+
+  // Wait for the last page to be written
+  return mcp24aaWaitForWrite();
+}
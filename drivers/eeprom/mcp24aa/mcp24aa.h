@@ -42,9 +42,12 @@
 #include "projectconfig.h"
 
 #define MCP24AA_ADDR    0xA0          // 10100000
+#define MCP24AA_I2C_SPEED I2C_SPEED_FAST  // 400 kHz fast mode (Vcc >= 2.5V)
 #define MCP24AA_RW      0x01
 #define MCP24AA_READBIT 0x01
 #define MCP24AA_MAXADDR 0xFFF         // 4K = 4096
+#define MCP24AA_PAGESIZE 32           // Max bytes in one page write
+#define MCP24AA_ACKPOLLMAX 200        // Max ACK polls while waiting for a write cycle
 
 typedef enum
 {
@@ -53,6 +56,8 @@ typedef enum
   MCP24AA_ERROR_I2CBUSY,              // I2C already in use
   MCP24AA_ERROR_ADDRERR,              // Address out of range
   MCP24AA_ERROR_BUFFEROVERFLOW,       // Max 8 bytes can be read/written in one operation
+  MCP24AA_ERROR_NACK,                 // The EEPROM didn't acknowledge a transfer
+  MCP24AA_ERROR_TIMEOUT,              // The write cycle didn't complete in time
   MCP24AA_ERROR_LAST
 }
 mcp24aaError_e;
@@ -62,6 +67,8 @@ mcp24aaError_e mcp24aaReadBuffer (uint16_t address, uint8_t *buffer, uint32_t bu
 mcp24aaError_e mcp24aaWriteBuffer (uint16_t address, uint8_t *buffer, uint32_t bufferLength);
 mcp24aaError_e mcp24aaReadByte (uint16_t address, uint8_t *buffer);
 mcp24aaError_e mcp24aaWriteByte (uint16_t address, uint8_t value);
+mcp24aaError_e mcp24aaReadBlock (uint16_t address, uint8_t *buffer, uint32_t length);
+mcp24aaError_e mcp24aaWriteBlock (uint16_t address, const uint8_t *buffer, uint32_t length);
 
 
 #endif
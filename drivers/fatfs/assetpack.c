@@ -0,0 +1,340 @@
+/**************************************************************************/
+/*! 
+    @file     assetpack.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Raw sector access to the assets in a packed asset file
+              (see assetpack.h for the file format).
+
+    FatFs is only used by assetPackOpen() to find the pack and make sure
+    it is stored contiguously.  After that each asset ID maps directly to
+    an index entry and a range of LBAs, which are read with disk_read()
+    without any directory lookups or FAT accesses.  The pack stays open
+    until assetPackClose() is called or the card is removed.
+
+    @section Example
+
+    @code 
+    #include "drivers/fatfs/assetpack.h"
+    #include "assets.h"                 // Generated by tools/assetpack
+
+    assetpack_entry_t entry;
+    uint8_t buffer[4 * ASSETPACK_SECTORSIZE];
+
+    if (assetPackOpen("/ui.pak") == ASSETPACK_ERROR_NONE)
+    {
+      // Read the first four sectors of a font with one multi-block read
+      if (assetPackFind(ASSET_FONT_LARGE, &entry) == ASSETPACK_ERROR_NONE)
+        assetPackRead(&entry, 0, buffer, 4);
+    }
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "assetpack.h"
+
+#ifdef CFG_SDCARD
+
+#include "drivers/fatfs/diskio.h"
+#include "drivers/fatfs/ff.h"
+#include "drivers/fatfs/ffsync.h"
+
+// The card is only mounted while the pack is being opened, after that
+// sectors are read straight into a private buffer (the shared FATFS
+// window belongs to whoever has the card mounted next)
+static uint8_t  assetPackBuffer[ASSETPACK_SECTORSIZE];
+static bool     assetPackIsOpen = false;
+static uint32_t assetPackBase;          // LBA of the first sector of the pack
+static uint32_t assetPackSectors;       // Size of the pack in sectors
+static uint16_t assetPackAssets;        // Number of assets in the index
+static uint32_t assetPackBufSector;     // LBA held in the buffer (0 = none)
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Reads a little-endian 16-bit value from a byte buffer
+*/
+/**************************************************************************/
+static uint16_t assetPackLoadWord(const uint8_t *p)
+{
+  return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads a little-endian 32-bit value from a byte buffer
+*/
+/**************************************************************************/
+static uint32_t assetPackLoadDWord(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Closes the pack if the card has been removed or reset since
+            it was opened
+*/
+/**************************************************************************/
+static bool assetPackCheck(void)
+{
+  if (!assetPackIsOpen)
+    return false;
+
+  if (disk_status(0) & (STA_NOINIT | STA_NODISK))
+  {
+    assetPackIsOpen = false;
+    return false;
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Loads one sector of the pack into the buffer
+*/
+/**************************************************************************/
+static bool assetPackLoad(uint32_t sector)
+{
+  if (sector == assetPackBufSector)
+    return true;
+
+  assetPackBufSector = 0;
+  if (disk_read(0, assetPackBuffer, sector, 1) != RES_OK)
+    return false;
+  assetPackBufSector = sector;
+
+  return true;
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Opens an asset pack and checks its header.  Any pack that is
+            already open is closed first.
+
+    @param[in]  filename
+                Full path of the pack file
+*/
+/**************************************************************************/
+assetpack_error_t assetPackOpen(const char* filename)
+{
+  assetpack_error_t error = ASSETPACK_ERROR_NONE;
+  FIL file;
+  DWORD linkmap[4];
+
+  assetPackIsOpen = false;
+  assetPackBufSector = 0;
+
+  // Card not initialised or no disk present
+  if (ffSyncMount() != FR_OK) 
+    return ASSETPACK_ERROR_SDINITFAIL;
+
+  if (f_open(&file, filename, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+  {
+    ffSyncUnmount();
+    return ASSETPACK_ERROR_FILENOTFOUND;
+  }
+
+  // A contiguous file fits in a link map with a single fragment
+  file.cltbl = linkmap;
+  linkmap[0] = sizeof(linkmap) / sizeof(linkmap[0]);
+  if ((file.fsize < ASSETPACK_SECTORSIZE) || !file.org_clust)
+    error = ASSETPACK_ERROR_NOTAPACK;
+  else if (f_lseek(&file, CREATE_LINKMAP) != FR_OK)
+    error = ASSETPACK_ERROR_NOTCONTIGUOUS;
+
+  assetPackBase = ffSyncGetFs()->database + (file.org_clust - 2) * ffSyncGetFs()->csize;
+  assetPackSectors = file.fsize / ASSETPACK_SECTORSIZE;
+
+  f_close(&file);
+  ffSyncUnmount();
+
+  if (error)
+    return error;
+
+  // Check the header
+  if (!assetPackLoad(assetPackBase))
+    return ASSETPACK_ERROR_READFAIL;
+  if (memcmp(assetPackBuffer, ASSETPACK_MAGIC, 4) ||
+      (assetPackLoadWord(&assetPackBuffer[4]) != ASSETPACK_VERSION) ||
+      (assetPackLoadDWord(&assetPackBuffer[8]) > assetPackSectors))
+    return ASSETPACK_ERROR_NOTAPACK;
+
+  assetPackAssets = assetPackLoadWord(&assetPackBuffer[6]);
+  assetPackSectors = assetPackLoadDWord(&assetPackBuffer[8]);
+  assetPackIsOpen = true;
+
+  return ASSETPACK_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Closes the asset pack
+*/
+/**************************************************************************/
+void assetPackClose(void)
+{
+  assetPackIsOpen = false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the number of assets in the open pack (0 if no pack
+            is open)
+*/
+/**************************************************************************/
+uint16_t assetPackCount(void)
+{
+  return assetPackCheck() ? assetPackAssets : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Looks up an asset in the index.  This costs at most one
+            sector read, and none if the index sector is still in the
+            buffer.
+
+    @param[in]  id
+                Asset ID (the position in the index, see the header
+                generated by tools/assetpack)
+    @param[out] entry
+                Location and size of the asset
+*/
+/**************************************************************************/
+assetpack_error_t assetPackFind(uint16_t id, assetpack_entry_t *entry)
+{
+  uint32_t offset;
+  const uint8_t *p;
+
+  if (!assetPackCheck())
+    return ASSETPACK_ERROR_NOTOPEN;
+
+  if (id >= assetPackAssets)
+    return ASSETPACK_ERROR_INVALIDID;
+
+  offset = ASSETPACK_HEADERSIZE + (uint32_t)id * ASSETPACK_ENTRYSIZE;
+  if (!assetPackLoad(assetPackBase + offset / ASSETPACK_SECTORSIZE))
+    return ASSETPACK_ERROR_READFAIL;
+  p = &assetPackBuffer[offset % ASSETPACK_SECTORSIZE];
+
+  entry->sector = assetPackLoadDWord(&p[0]);
+  entry->length = assetPackLoadDWord(&p[4]);
+  entry->type = p[8];
+  entry->width = assetPackLoadWord(&p[10]);
+  entry->height = assetPackLoadWord(&p[12]);
+  entry->sectors = (entry->length + ASSETPACK_SECTORSIZE - 1) / ASSETPACK_SECTORSIZE;
+
+  // Make sure the asset lies inside the pack
+  if ((entry->sector == 0) || (entry->sector > assetPackSectors) ||
+      (entry->sectors > assetPackSectors - entry->sector))
+    return ASSETPACK_ERROR_INVALIDDATA;
+
+  entry->sector += assetPackBase;
+
+  return ASSETPACK_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads sectors of an asset into a buffer with a single
+            (multi-block) disk_read
+
+    @param[in]  entry
+                Asset returned by assetPackFind()
+    @param[in]  sector
+                First sector to read, relative to the start of the asset
+    @param[out] buffer
+                Buffer for count * ASSETPACK_SECTORSIZE bytes
+    @param[in]  count
+                Number of sectors to read
+*/
+/**************************************************************************/
+assetpack_error_t assetPackRead(const assetpack_entry_t *entry, uint32_t sector, uint8_t *buffer, uint8_t count)
+{
+  if (!assetPackCheck())
+    return ASSETPACK_ERROR_NOTOPEN;
+
+  if ((count == 0) || (sector >= entry->sectors) || (count > entry->sectors - sector))
+    return ASSETPACK_ERROR_INVALIDDATA;
+
+  if (disk_read(0, buffer, entry->sector + sector, count) != RES_OK)
+    return ASSETPACK_ERROR_READFAIL;
+
+  return ASSETPACK_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads one sector of an asset into the pack's own buffer and
+            returns a pointer to it, for callers that don't have 512
+            bytes to spare.  The data stays valid until the next call to
+            any of the asset pack functions.
+
+    @param[in]  entry
+                Asset returned by assetPackFind()
+    @param[in]  sector
+                Sector to read, relative to the start of the asset
+    @param[out] data
+                Pointer to the ASSETPACK_SECTORSIZE bytes of the sector
+*/
+/**************************************************************************/
+assetpack_error_t assetPackGetSector(const assetpack_entry_t *entry, uint32_t sector, const uint8_t **data)
+{
+  if (!assetPackCheck())
+    return ASSETPACK_ERROR_NOTOPEN;
+
+  if (sector >= entry->sectors)
+    return ASSETPACK_ERROR_INVALIDDATA;
+
+  if (!assetPackLoad(entry->sector + sector))
+    return ASSETPACK_ERROR_READFAIL;
+
+  *data = assetPackBuffer;
+
+  return ASSETPACK_ERROR_NONE;
+}
+
+#endif  // End of CFG_SDCARD check
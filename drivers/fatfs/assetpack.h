@@ -0,0 +1,131 @@
+/**************************************************************************/
+/*! 
+    @file     assetpack.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __ASSETPACK_H__
+#define __ASSETPACK_H__
+
+#include "projectconfig.h"
+
+/**************************************************************************
+    Asset Pack File Format
+    -----------------------------------------------------------------------
+    An asset pack bundles the images, fonts and strings used by the UI in
+    a single file (see tools/assetpack) so that they can be read with raw
+    sector reads instead of one FatFs lookup per file.  The file must be
+    stored contiguously on the card.  All values are little-endian:
+
+    --------------------------
+    |         Header         |        16 bytes
+    |-------------------------
+    |       Index Table      |        16 bytes per asset, IDs 0..count-1
+    |-------------------------
+    |       Asset Data       |        Each asset starts on a new sector
+    --------------------------
+
+    Header:   'u', 'P', 'A', 'K', version (16-bit), asset count (16-bit),
+              pack size in sectors (32-bit), reserved (32-bit)
+
+    Index:    first sector of the asset relative to the start of the pack
+              (32-bit), length in bytes (32-bit), type (8-bit), reserved
+              (8-bit), width (16-bit), height (16-bit), reserved (16-bit)
+
+    ASSETPACK_TYPE_IMG565 assets are raw top-down RGB565 pixel data (the
+    img565 pixel layout without its header), so the width and height come
+    from the index.  ASSETPACK_TYPE_STRING assets are NUL-terminated.
+
+ **************************************************************************/
+
+#define ASSETPACK_MAGIC         "uPAK"
+#define ASSETPACK_VERSION       (1)
+#define ASSETPACK_SECTORSIZE    (512)
+#define ASSETPACK_HEADERSIZE    (16)
+#define ASSETPACK_ENTRYSIZE     (16)
+
+/**************************************************************************/
+/*!
+    @brief  Asset types
+*/
+/**************************************************************************/
+typedef enum
+{
+  ASSETPACK_TYPE_RAW = 0,
+  ASSETPACK_TYPE_IMG565 = 1,
+  ASSETPACK_TYPE_FONT = 2,
+  ASSETPACK_TYPE_STRING = 3
+} assetpack_type_t;
+
+/**************************************************************************/
+/*!
+    @brief  Location and size of one asset on the card
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint32_t sector;                    /* First LBA of the asset      */
+  uint32_t sectors;                   /* Number of sectors           */
+  uint32_t length;                    /* Length in bytes             */
+  uint8_t  type;                      /* assetpack_type_t            */
+  uint16_t width;                     /* Image width in pixels       */
+  uint16_t height;                    /* Image height in pixels      */
+} assetpack_entry_t;
+
+/**************************************************************************/
+/*!
+    @brief  Error return codes for the asset pack functions
+*/
+/**************************************************************************/
+typedef enum
+{
+  ASSETPACK_ERROR_NONE = 0,
+  ASSETPACK_ERROR_SDINITFAIL = 1,
+  ASSETPACK_ERROR_FILENOTFOUND = 2,
+  ASSETPACK_ERROR_NOTAPACK = 3,           /* Missing 'uPAK' header or wrong version */
+  ASSETPACK_ERROR_NOTCONTIGUOUS = 4,      /* Pack is fragmented on the card */
+  ASSETPACK_ERROR_NOTOPEN = 5,
+  ASSETPACK_ERROR_INVALIDID = 6,
+  ASSETPACK_ERROR_INVALIDDATA = 7,        /* Index entry points outside the pack */
+  ASSETPACK_ERROR_READFAIL = 8
+} assetpack_error_t;
+
+#ifdef CFG_SDCARD
+assetpack_error_t assetPackOpen(const char* filename);
+void              assetPackClose(void);
+uint16_t          assetPackCount(void);
+assetpack_error_t assetPackFind(uint16_t id, assetpack_entry_t *entry);
+assetpack_error_t assetPackRead(const assetpack_entry_t *entry, uint32_t sector, uint8_t *buffer, uint8_t count);
+assetpack_error_t assetPackGetSector(const assetpack_entry_t *entry, uint32_t sector, const uint8_t **data);
+#endif
+
+#endif
@@ -534,6 +534,10 @@ WCHAR ff_wtoupper (	/* Upper converted character */
 	int i;
 
 
+	/* ASCII is all that most names hold, and a..z are the only lower
+	   case letters below 0x80, so skip the table search for them */
+	if (chr < 0x80) return (chr >= 'a' && chr <= 'z') ? chr - 0x20 : chr;
+
 	for (i = 0; tbl_lower[i] && chr != tbl_lower[i]; i++) ;
 
 	return tbl_lower[i] ? tbl_upper[i] : chr;
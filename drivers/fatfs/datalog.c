@@ -0,0 +1,570 @@
+/**************************************************************************/
+/*! 
+    @file     datalog.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Gap-free capture of ADC or sensor data to an SD card log
+
+    @section DESCRIPTION
+
+    Records are collected into a ring of CFG_SDCARD_DATALOG sector
+    buffers by dataLogWrite(), which is safe to call from interrupt
+    handlers and never waits for the card.  Each full sector is queued
+    and written to a contiguous, pre-erased log file (see logstream.c)
+    by dataLogPoll(), so one sector can be filled while another one
+    is on its way to the card.  With CFG_SCHEDULER, dataLogPoll() is
+    posted automatically every time a sector fills; without it, the
+    main loop has to call dataLogPoll() often enough.
+
+    Every sector starts with a dataLogHeader_t holding a sequence
+    number, the number of payload bytes used and the number of records
+    dropped just before the sector.  A record never spans two sectors.
+    If the card is slower than the data for longer than the buffers
+    can cover, records are dropped and counted rather than silently
+    lost, and dataLogGetStats() reports the deepest the queue ever got
+    and the slowest sector write, which shows how close the buffers
+    came to running out.
+
+    With CFG_ADC_TRIGGER, dataLogStartADC() samples an ADC channel at
+    a fixed rate in hardware and logs the 16-bit results in records of
+    DATALOG_ADCCHUNK samples, either as they are or delta coded with
+    varintDeltaEncode16 (usually about half the size).
+
+    With CFG_SDCARD_DATALOG_LZ, every full sector is compressed with
+    lzCompress before it goes to the card, and the file holds a stream
+    of chunks that can span sectors: a 16-bit little endian length
+    followed by that many bytes of LZ data that decompress to one 512
+    byte sector.  If a sector doesn't get any smaller, the chunk holds
+    the sector as it is and DATALOG_LZSTORED is set in the length.  A
+    length of 0 marks the end of the data.  tools/logdump unpacks and
+    prints the log files.
+
+    @section Example
+
+    @code 
+
+    #include "drivers/fatfs/datalog.h"
+
+    // Reserve 8192 blocks (4MB) and log AD1 at 8kHz
+    if (dataLogStart("/adc.log", 8192) == DATALOG_ERROR_NONE)
+    {
+      dataLogStartADC(1, 8000, true);
+    }
+
+    // ... later
+    dataLogStats_t stats;
+    dataLogStop();
+    dataLogGetStats(&stats);
+    printf("%u sectors, %u overruns%s", stats.sectorsWritten, stats.overruns, CFG_PRINTF_NEWLINE);
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "datalog.h"
+
+#if defined CFG_SDCARD && defined CFG_SDCARD_DATALOG && CFG_SDCARD_DATALOG > 0
+
+#include "core/systick/systick.h"
+
+#ifdef CFG_ADC_TRIGGER
+  #include "core/adc/adc.h"
+  #include "core/compress/varint.h"
+#endif
+
+#ifdef CFG_SDCARD_DATALOG_LZ
+  #include "core/compress/lz.h"
+#endif
+
+#ifdef CFG_SCHEDULER
+  #include "core/sched/sched.h"
+#endif
+
+static uint8_t _dataLogSectors[CFG_SDCARD_DATALOG][LOGSTREAM_BLOCKSIZE] __attribute__ ((aligned (4)));
+
+/* Sectors filled and sectors written since dataLogStart (the sector
+   being filled is always _dataLogHead % CFG_SDCARD_DATALOG) */
+static volatile uint32_t _dataLogHead;
+static volatile uint32_t _dataLogTail;
+
+static bool _dataLogRunning = false;
+static volatile bool _dataLogCapturing = false;
+static bool _dataLogSectorOpen;         /* Sector at the head is being filled */
+static uint16_t _dataLogFill;           /* Payload bytes in it */
+static uint32_t _dataLogLost;           /* Records dropped since the last sector was opened */
+static datalog_error_t _dataLogError;
+static dataLogStats_t _dataLogStats;
+
+#ifdef CFG_ADC_TRIGGER
+  static uint16_t _dataLogAdcBuffer[DATALOG_ADCCHUNK * 2];
+  static bool _dataLogAdcRunning = false;
+  static bool _dataLogAdcDelta;
+#endif
+
+#ifdef CFG_SDCARD_DATALOG_LZ
+  static uint8_t _dataLogChunk[2 + LOGSTREAM_BLOCKSIZE];
+  static uint8_t _dataLogPacked[LOGSTREAM_BLOCKSIZE] __attribute__ ((aligned (4)));
+  static uint16_t _dataLogPackedFill;
+#endif
+
+#ifdef CFG_SCHEDULER
+  static schedTask_t _dataLogTask;
+  static bool _dataLogTaskReady = false;
+#endif
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+#ifdef CFG_SCHEDULER
+/**************************************************************************/
+/*!
+    @brief  Writes the queued sectors in the background
+*/
+/**************************************************************************/
+static void dataLogTask(schedTask_t *task)
+{
+  dataLogPoll();
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Queues the sector being filled for writing (interrupts must
+            be disabled)
+*/
+/**************************************************************************/
+static void dataLogQueueSector(void)
+{
+  uint8_t *sector = _dataLogSectors[_dataLogHead % CFG_SDCARD_DATALOG];
+  uint32_t queued;
+
+  ((dataLogHeader_t *)sector)->length = _dataLogFill;
+  memset(&sector[DATALOG_HEADERSIZE + _dataLogFill], 0, DATALOG_PAYLOADSIZE - _dataLogFill);
+
+  _dataLogHead++;
+  _dataLogSectorOpen = false;
+
+  queued = _dataLogHead - _dataLogTail;
+  if (queued > _dataLogStats.maxQueued)
+  {
+    _dataLogStats.maxQueued = queued;
+  }
+
+  #ifdef CFG_SCHEDULER
+    schedPost(&_dataLogTask);
+  #endif
+}
+
+#ifdef CFG_ADC_TRIGGER
+/**************************************************************************/
+/*!
+    @brief  Logs each half of the ADC trigger buffer as one record
+*/
+/**************************************************************************/
+static void dataLogAdcBlock(uint16_t *samples, uint32_t count)
+{
+  uint8_t packed[DATALOG_ADCCHUNK * VARINT_MAXBYTES16];
+
+  if (_dataLogAdcDelta)
+  {
+    dataLogWrite(packed, varintDeltaEncode16(samples, count, packed));
+  }
+  else
+  {
+    dataLogWrite(samples, count * sizeof(uint16_t));
+  }
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Writes one sector to the file, keeping track of the slowest
+            write
+*/
+/**************************************************************************/
+static logstream_error_t dataLogWriteSector(const uint8_t *block)
+{
+  logstream_error_t error;
+  uint32_t start, elapsed;
+
+  start = systickGetMicros();
+  error = logStreamWrite(block);
+  elapsed = systickGetMicros() - start;
+
+  if (error == LOGSTREAM_ERROR_NONE)
+  {
+    if (elapsed > _dataLogStats.maxWriteUs)
+    {
+      _dataLogStats.maxWriteUs = elapsed;
+    }
+    _dataLogStats.sectorsWritten++;
+  }
+
+  return error;
+}
+
+#ifdef CFG_SDCARD_DATALOG_LZ
+/**************************************************************************/
+/*!
+    @brief  Compresses a sector and adds it to the packed sectors,
+            writing each one out as it fills
+*/
+/**************************************************************************/
+static logstream_error_t dataLogPackSector(const uint8_t *sector)
+{
+  logstream_error_t error;
+  uint16_t len, pos, n;
+
+  len = lzCompress(sector, LOGSTREAM_BLOCKSIZE, &_dataLogChunk[2], LOGSTREAM_BLOCKSIZE - 2);
+  if (len == 0)
+  {
+    memcpy(&_dataLogChunk[2], sector, LOGSTREAM_BLOCKSIZE);
+    _dataLogChunk[0] = LOGSTREAM_BLOCKSIZE & 0xFF;
+    _dataLogChunk[1] = (LOGSTREAM_BLOCKSIZE | DATALOG_LZSTORED) >> 8;
+    len = LOGSTREAM_BLOCKSIZE;
+  }
+  else
+  {
+    _dataLogChunk[0] = len & 0xFF;
+    _dataLogChunk[1] = len >> 8;
+  }
+  len += 2;
+
+  for (pos = 0; pos < len; pos += n)
+  {
+    n = len - pos;
+    if (n > LOGSTREAM_BLOCKSIZE - _dataLogPackedFill)
+    {
+      n = LOGSTREAM_BLOCKSIZE - _dataLogPackedFill;
+    }
+    memcpy(&_dataLogPacked[_dataLogPackedFill], &_dataLogChunk[pos], n);
+    _dataLogPackedFill += n;
+
+    if (_dataLogPackedFill == LOGSTREAM_BLOCKSIZE)
+    {
+      error = dataLogWriteSector(_dataLogPacked);
+      if (error != LOGSTREAM_ERROR_NONE)
+      {
+        return error;
+      }
+      _dataLogPackedFill = 0;
+    }
+  }
+
+  return LOGSTREAM_ERROR_NONE;
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Stops all of the data sources
+*/
+/**************************************************************************/
+static void dataLogStopCapture(void)
+{
+  _dataLogCapturing = false;
+
+  #ifdef CFG_ADC_TRIGGER
+    if (_dataLogAdcRunning)
+    {
+      adcTriggerStop();
+      _dataLogAdcRunning = false;
+    }
+  #endif
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Creates the log file and starts accepting records
+
+    @param[in]  filename
+                Full path of the file to create (an existing file
+                is overwritten)
+    @param[in]  blocks
+                Number of 512 byte blocks to reserve for the log
+*/
+/**************************************************************************/
+datalog_error_t dataLogStart(const char* filename, uint32_t blocks)
+{
+  logstream_error_t error;
+
+  if (_dataLogRunning)
+    return DATALOG_ERROR_ALREADYRUNNING;
+
+  memset(&_dataLogStats, 0, sizeof(_dataLogStats));
+
+  error = logStreamOpen(filename, blocks);
+  if (error != LOGSTREAM_ERROR_NONE)
+  {
+    _dataLogStats.streamError = error;
+    return DATALOG_ERROR_LOGSTREAM;
+  }
+
+  #ifdef CFG_SCHEDULER
+    if (!_dataLogTaskReady)
+    {
+      schedTaskInit(&_dataLogTask, dataLogTask, NULL);
+      _dataLogTaskReady = true;
+    }
+  #endif
+
+  _dataLogHead = _dataLogTail = 0;
+  _dataLogSectorOpen = false;
+  #ifdef CFG_SDCARD_DATALOG_LZ
+    _dataLogPackedFill = 0;
+  #endif
+  _dataLogFill = 0;
+  _dataLogLost = 0;
+  _dataLogError = DATALOG_ERROR_NONE;
+  _dataLogRunning = true;
+  _dataLogCapturing = true;
+
+  return DATALOG_ERROR_NONE;
+}
+
+#ifdef CFG_ADC_TRIGGER
+/**************************************************************************/
+/*!
+    @brief  Starts logging an ADC channel at a fixed sample rate (see
+            adcTriggerStart).  The samples stop with dataLogStop.
+
+    @param[in]  channelNum
+                The A/D channel [0..7] to sample
+    @param[in]  rateHz
+                The sample rate (1..ADC_TRIGGER_MAXHZ)
+    @param[in]  delta
+                true to delta code the records (varintDeltaEncode16)
+*/
+/**************************************************************************/
+datalog_error_t dataLogStartADC(uint8_t channelNum, uint32_t rateHz, bool delta)
+{
+  if (!_dataLogRunning || !_dataLogCapturing)
+    return DATALOG_ERROR_NOTRUNNING;
+
+  _dataLogAdcDelta = delta;
+  if (!adcTriggerStart(channelNum, rateHz, _dataLogAdcBuffer, DATALOG_ADCCHUNK * 2, dataLogAdcBlock))
+    return DATALOG_ERROR_INVALIDPARAM;
+
+  _dataLogAdcRunning = true;
+
+  return DATALOG_ERROR_NONE;
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Adds one record to the log.  This never waits for the card
+            and can be called from interrupt handlers.
+
+    @param[in]  record
+                The data to log
+    @param[in]  len
+                Record length in bytes (1..DATALOG_PAYLOADSIZE)
+
+    @return     DATALOG_ERROR_OVERRUN if the record was dropped because
+                no buffer was free
+*/
+/**************************************************************************/
+datalog_error_t dataLogWrite(const void *record, uint16_t len)
+{
+  uint8_t *sector;
+
+  if (!_dataLogCapturing)
+    return DATALOG_ERROR_NOTRUNNING;
+
+  if ((len == 0) || (len > DATALOG_PAYLOADSIZE))
+    return DATALOG_ERROR_INVALIDPARAM;
+
+  __disable_irq();
+
+  // Records don't span sectors
+  if (_dataLogSectorOpen && (_dataLogFill + len > DATALOG_PAYLOADSIZE))
+  {
+    dataLogQueueSector();
+  }
+
+  if (!_dataLogSectorOpen)
+  {
+    if (_dataLogHead - _dataLogTail >= CFG_SDCARD_DATALOG)
+    {
+      // Every buffer is still waiting for the card
+      _dataLogLost++;
+      _dataLogStats.overruns++;
+      __enable_irq();
+      return DATALOG_ERROR_OVERRUN;
+    }
+
+    sector = _dataLogSectors[_dataLogHead % CFG_SDCARD_DATALOG];
+    ((dataLogHeader_t *)sector)->sequence = _dataLogHead;
+    ((dataLogHeader_t *)sector)->lost = _dataLogLost > 0xFFFF ? 0xFFFF : _dataLogLost;
+    _dataLogLost = 0;
+    _dataLogFill = 0;
+    _dataLogSectorOpen = true;
+  }
+
+  sector = _dataLogSectors[_dataLogHead % CFG_SDCARD_DATALOG];
+  memcpy(&sector[DATALOG_HEADERSIZE + _dataLogFill], record, len);
+  _dataLogFill += len;
+
+  if (_dataLogFill == DATALOG_PAYLOADSIZE)
+  {
+    dataLogQueueSector();
+  }
+
+  __enable_irq();
+
+  return DATALOG_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes all of the full sectors to the card.  This is called
+            automatically with CFG_SCHEDULER, otherwise it has to be
+            called from the main loop.
+
+    If the card fails or the file is full, capturing stops and the
+    error is returned until dataLogStop is called.
+*/
+/**************************************************************************/
+datalog_error_t dataLogPoll(void)
+{
+  logstream_error_t error;
+
+  if (!_dataLogRunning)
+    return DATALOG_ERROR_NOTRUNNING;
+
+  while ((_dataLogError == DATALOG_ERROR_NONE) && (_dataLogTail != _dataLogHead))
+  {
+    #ifdef CFG_SDCARD_DATALOG_LZ
+      error = dataLogPackSector(_dataLogSectors[_dataLogTail % CFG_SDCARD_DATALOG]);
+    #else
+      error = dataLogWriteSector(_dataLogSectors[_dataLogTail % CFG_SDCARD_DATALOG]);
+    #endif
+
+    if (error != LOGSTREAM_ERROR_NONE)
+    {
+      dataLogStopCapture();
+      _dataLogStats.streamError = error;
+      _dataLogError = error == LOGSTREAM_ERROR_FILEFULL ? DATALOG_ERROR_FILEFULL : DATALOG_ERROR_LOGSTREAM;
+      break;
+    }
+
+    _dataLogStats.sectorsCaptured++;
+
+    // Only now can the producer reuse the buffer
+    _dataLogTail++;
+  }
+
+  return _dataLogError;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Stops the data sources, writes the last (partial) sector
+            and closes the log file
+*/
+/**************************************************************************/
+datalog_error_t dataLogStop(void)
+{
+  datalog_error_t error;
+
+  if (!_dataLogRunning)
+    return DATALOG_ERROR_NOTRUNNING;
+
+  dataLogStopCapture();
+
+  __disable_irq();
+  if (_dataLogSectorOpen)
+  {
+    dataLogQueueSector();
+  }
+  __enable_irq();
+
+  error = dataLogPoll();
+
+  #ifdef CFG_SDCARD_DATALOG_LZ
+    // Pad the last packed sector (a chunk length of 0 ends the data)
+    if ((error == DATALOG_ERROR_NONE) && _dataLogPackedFill)
+    {
+      memset(&_dataLogPacked[_dataLogPackedFill], 0, LOGSTREAM_BLOCKSIZE - _dataLogPackedFill);
+      _dataLogStats.streamError = dataLogWriteSector(_dataLogPacked);
+      if (_dataLogStats.streamError != LOGSTREAM_ERROR_NONE)
+      {
+        error = _dataLogStats.streamError == LOGSTREAM_ERROR_FILEFULL ? DATALOG_ERROR_FILEFULL : DATALOG_ERROR_LOGSTREAM;
+      }
+    }
+  #endif
+
+  if ((logStreamClose() != LOGSTREAM_ERROR_NONE) && (error == DATALOG_ERROR_NONE))
+  {
+    _dataLogStats.streamError = LOGSTREAM_ERROR_WRITEFAIL;
+    error = DATALOG_ERROR_LOGSTREAM;
+  }
+
+  _dataLogRunning = false;
+
+  return error;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns true between dataLogStart and dataLogStop
+*/
+/**************************************************************************/
+bool dataLogIsRunning(void)
+{
+  return _dataLogRunning;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Copies the statistics for the current (or last) log
+*/
+/**************************************************************************/
+void dataLogGetStats(dataLogStats_t *stats)
+{
+  __disable_irq();
+  *stats = _dataLogStats;
+  __enable_irq();
+}
+
+#endif  // End of CFG_SDCARD_DATALOG check
@@ -0,0 +1,101 @@
+/**************************************************************************/
+/*! 
+    @file     datalog.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __DATALOG_H__
+#define __DATALOG_H__
+
+#include "projectconfig.h"
+#include "logstream.h"
+
+#define DATALOG_HEADERSIZE      (8)     /* Bytes of dataLogHeader_t at the start of every sector */
+#define DATALOG_PAYLOADSIZE     (LOGSTREAM_BLOCKSIZE - DATALOG_HEADERSIZE)
+#define DATALOG_ADCCHUNK        (12)    /* ADC samples per record, 21 records fill a sector */
+#define DATALOG_LZSTORED        (0x8000) /* Chunk length flag for sectors that didn't compress */
+
+/**************************************************************************/
+/*!
+    @brief  Error return codes for the data logger
+*/
+/**************************************************************************/
+typedef enum
+{
+  DATALOG_ERROR_NONE = 0,
+  DATALOG_ERROR_ALREADYRUNNING = 1,
+  DATALOG_ERROR_NOTRUNNING = 2,
+  DATALOG_ERROR_INVALIDPARAM = 3,
+  DATALOG_ERROR_LOGSTREAM = 4,          /* See dataLogStats_t.streamError */
+  DATALOG_ERROR_FILEFULL = 5,           /* All preallocated blocks have been written */
+  DATALOG_ERROR_OVERRUN = 6             /* Every buffer is waiting for the card, record dropped */
+} datalog_error_t;
+
+/**************************************************************************/
+/*!
+    @brief  Header at the start of every 512 byte sector in the log
+            file.  'lost' is the number of records that were dropped
+            just before this sector because all of the buffers were
+            waiting for the card, so a gap in the data is always
+            visible in the file.
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint32_t sequence;                    /* Sector number, starting at 0 */
+  uint16_t length;                      /* Payload bytes used (the rest is 0) */
+  uint16_t lost;                        /* Records dropped before this sector (saturates) */
+} dataLogHeader_t;
+
+typedef struct
+{
+  uint32_t sectorsCaptured;             /* Sectors of records (before compression) */
+  uint32_t sectorsWritten;              /* Sectors written to the file */
+  uint32_t overruns;                    /* Records dropped since dataLogStart */
+  uint8_t  maxQueued;                   /* Most full sectors ever waiting for the card */
+  uint32_t maxWriteUs;                  /* Longest single sector write */
+  logstream_error_t streamError;        /* Set when the card stopped accepting data */
+} dataLogStats_t;
+
+#if defined CFG_SDCARD && defined CFG_SDCARD_DATALOG && CFG_SDCARD_DATALOG > 0
+datalog_error_t dataLogStart(const char* filename, uint32_t blocks);
+datalog_error_t dataLogWrite(const void *record, uint16_t len);
+datalog_error_t dataLogPoll(void);
+datalog_error_t dataLogStop(void);
+bool            dataLogIsRunning(void);
+void            dataLogGetStats(dataLogStats_t *stats);
+#ifdef CFG_ADC_TRIGGER
+datalog_error_t dataLogStartADC(uint8_t channelNum, uint32_t rateHz, bool delta);
+#endif
+#endif
+
+#endif
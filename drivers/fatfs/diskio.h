@@ -33,7 +33,15 @@ DRESULT disk_read (BYTE, BYTE*, DWORD, BYTE);
 DRESULT disk_write (BYTE, const BYTE*, DWORD, BYTE);
 #endif
 DRESULT disk_ioctl (BYTE, BYTE, void*);
-void	disk_timerproc (void);
+void	disk_socketirq (void);
+#if	_READONLY == 0
+DRESULT disk_stream_start (BYTE, DWORD, DWORD);
+DRESULT disk_stream_write (BYTE, const BYTE*);
+DRESULT disk_stream_stop (BYTE);
+#endif
+DRESULT disk_readstream_start (BYTE, DWORD);
+DRESULT disk_readstream_read (BYTE, BYTE*, UINT);
+DRESULT disk_readstream_stop (BYTE);
 
 
 
@@ -56,12 +64,16 @@ void	disk_timerproc (void);
 #define CTRL_POWER			4
 #define CTRL_LOCK			5
 #define CTRL_EJECT			6
+#define CTRL_ERASE_SECTOR	7	/* Erase a block of sectors (DWORD[2]: start, end) */
 /* MMC/SDC command */
 #define MMC_GET_TYPE		10
 #define MMC_GET_CSD			11
 #define MMC_GET_CID			12
 #define MMC_GET_OCR			13
 #define MMC_GET_SDSTAT		14
+#define MMC_GET_CLOCK		15
+#define MMC_GET_STATS		16	/* Copy the DSTATS (CFG_SDCARD_STATS) */
+#define MMC_CLEAR_STATS		17
 /* ATA/CF command */
 #define ATA_GET_REV			20
 #define ATA_GET_MODEL		21
@@ -77,5 +89,32 @@ void	disk_timerproc (void);
 #define CT_BLOCK			0x08	/* Block addressing */
 
 
+
+/* Card statistics (MMC_GET_STATS) */
+#define SDSTAT_CMD17		0	/* READ_SINGLE_BLOCK */
+#define SDSTAT_CMD18		1	/* READ_MULTIPLE_BLOCK */
+#define SDSTAT_CMD24		2	/* WRITE_BLOCK */
+#define SDSTAT_CMD25		3	/* WRITE_MULTIPLE_BLOCK */
+#define SDSTAT_STREAM		4	/* One block of a disk_stream_write() CMD25 */
+#define SDSTAT_BUSY			5	/* Busy time of the card (wait_ready, erase) */
+#define SDSTAT_CLASSES		6
+
+#define SDSTAT_BUCKETS		14	/* Bucket n counts times below BUCKET0_US << n, */
+#define SDSTAT_BUCKET0_US	128UL	/* the last one everything longer (0.5s+) */
+
+typedef struct {
+	DWORD	count[SDSTAT_CLASSES];		/* Successful commands (or busy waits) */
+	DWORD	maxUs[SDSTAT_CLASSES];		/* Longest time in microseconds */
+	WORD	hist[SDSTAT_CLASSES][SDSTAT_BUCKETS];	/* Latency histogram (saturates) */
+	DWORD	bytesRead;
+	DWORD	bytesWritten;
+	WORD	cmdErrors;		/* Data command rejected or no response */
+	WORD	tokenErrors;	/* No data token for a read */
+	WORD	crcErrors;		/* Data block rejected with a CRC error */
+	WORD	writeErrors;	/* Data block rejected with a write error */
+	WORD	busyTimeouts;	/* Card stayed busy for longer than the timeout */
+} DSTATS;
+
+
 #define _DISKIO
 #endif
@@ -141,6 +141,26 @@ static
 BYTE Drive;				/* Current drive */
 #endif
 
+#if _FS_DIRCACHE
+typedef struct _DCENT_ {
+	DWORD	sect;		/* Sector containing the first entry (0:Unused slot) */
+	DWORD	clust;		/* Cluster containing the first entry */
+	DWORD	sclust;		/* Start cluster of the directory */
+	WORD	id;			/* Owner file system mount ID */
+	WORD	index;		/* Index of the first entry of the object (LFN or SFN) */
+	WORD	last;		/* Index of the SFN entry of the object */
+	WORD	hash;		/* Hash of the name and directory */
+	WORD	stamp;		/* Time of last use (for LRU replacement) */
+} DCENT;
+
+static
+DCENT DirCache[_FS_DIRCACHE];	/* Directory entry cache */
+static
+DCENT DcFound;			/* First entry of the object last found by dir_scan */
+static
+WORD DcClock;			/* Incremented on every cache access */
+#endif
+
 
 #if _USE_LFN == 1	/* LFN with static LFN working buffer */
 static
@@ -432,6 +452,9 @@ FRESULT remove_chain (
 {
 	FRESULT res;
 	DWORD nxt;
+#if _USE_ERASE
+	DWORD scl = clst, ecl = clst, rt[2];
+#endif
 
 
 	if (clst < 2 || clst >= fs->max_clust) {	/* Check the range of cluster# */
@@ -450,6 +473,16 @@ FRESULT remove_chain (
 				fs->free_clust++;
 				fs->fsi_flag = 1;
 			}
+#if _USE_ERASE
+			if (ecl + 1 == nxt) {				/* Next cluster is contiguous? */
+				ecl = nxt;
+			} else {							/* End of a run, erase it */
+				rt[0] = (scl - 2) * fs->csize + fs->database;		/* Start sector */
+				rt[1] = (ecl - 2) * fs->csize + fs->database + fs->csize - 1;	/* End sector */
+				disk_ioctl(fs->drive, CTRL_ERASE_SECTOR, rt);	/* Failure only costs speed */
+				scl = ecl = nxt;
+			}
+#endif
 			clst = nxt;	/* Next cluster */
 		}
 	}
@@ -538,6 +571,35 @@ DWORD clust2sect (	/* !=0: Sector number, 0: Failed - invalid cluster# */
 
 
 
+#if _USE_FASTSEEK
+/*-----------------------------------------------------------------------*/
+/* Fast seek: Get cluster# from the cluster link map table               */
+/*-----------------------------------------------------------------------*/
+
+static
+DWORD clmt_clust (	/* <2:Error, >=2:Cluster number */
+	FIL *fp,		/* Pointer to the file object */
+	DWORD ofs		/* File offset to be converted to cluster# */
+)
+{
+	DWORD cl, ncl, *tbl;
+
+
+	tbl = fp->cltbl + 1;	/* Top of CLMT */
+	cl = ofs / SS(fp->fs) / fp->fs->csize;	/* Cluster order from top of the file */
+	for (;;) {
+		ncl = *tbl++;			/* Number of clusters in the fragment */
+		if (!ncl) return 0;		/* End of table? (error) */
+		if (cl < ncl) break;	/* In this fragment? */
+		cl -= ncl; tbl++;		/* Next fragment */
+	}
+	return cl + *tbl;	/* Return the cluster number */
+}
+#endif /* _USE_FASTSEEK */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Directory handling - Seek directory index                             */
 /*-----------------------------------------------------------------------*/
@@ -823,25 +885,113 @@ BYTE sum_sfn (
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Directory handling - Directory entry cache                            */
+/*-----------------------------------------------------------------------*/
+#if _FS_DIRCACHE
+
+static
+WORD dc_hash (		/* Hash of the name in a directory object */
+	DIR *dj			/* Directory object with the name to be found */
+)
+{
+	WORD h = (WORD)dj->sclust;
+	int i;
+
+
+#if _USE_LFN
+	const WCHAR *lfn = dj->lfn;
+
+	if (lfn) {		/* LFN, which also covers names in 8.3 format */
+		while (*lfn)
+			h = ((h << 5) | (h >> 11)) ^ ff_wtoupper(*lfn++);
+		return h;
+	}
+#endif
+	for (i = 0; i < 11; i++)
+		h = ((h << 5) | (h >> 11)) ^ dj->fn[i];
+	return h;
+}
+
+
+static
+DCENT* dc_find (	/* Pointer to the matching slot (0:Miss) */
+	DIR *dj			/* Directory object with the name to be found */
+)
+{
+	DCENT *dc;
+	WORD h;
+	int i;
+
+
+	h = dc_hash(dj);
+	for (i = 0, dc = DirCache; i < _FS_DIRCACHE; i++, dc++) {
+		if (dc->sect && dc->hash == h && dc->id == dj->fs->id && dc->sclust == dj->sclust) {
+			dj->index = dc->index;	/* Go to the first entry of the object */
+			dj->clust = dc->clust;
+			dj->sect = dc->sect;
+			dj->dir = dj->fs->win + (dc->index % (SS(dj->fs) / 32)) * 32;
+			return dc;
+		}
+	}
+	return 0;
+}
+
+
+static
+void dc_store (		/* Remember where dir_find found an object */
+	DIR *dj			/* Directory object pointing the SFN entry */
+)
+{
+	DCENT *dc;
+	int i;
+
+
+	dc = DirCache;					/* Replace a free or the least recently used slot */
+	for (i = 1; i < _FS_DIRCACHE && dc->sect; i++) {
+		if (!DirCache[i].sect || (WORD)(DcClock - DirCache[i].stamp) > (WORD)(DcClock - dc->stamp))
+			dc = &DirCache[i];
+	}
+	*dc = DcFound;					/* First entry of the object */
+	dc->sclust = dj->sclust;
+	dc->id = dj->fs->id;
+	dc->last = dj->index;
+	dc->hash = dc_hash(dj);
+	dc->stamp = ++DcClock;
+}
+
+
+#if !_FS_READONLY
+static
+void dc_flush (void)	/* Forget all entries, called when a directory is modified */
+{
+	int i;
+
+
+	for (i = 0; i < _FS_DIRCACHE; i++)
+		DirCache[i].sect = 0;
+}
+#endif
+#endif /* _FS_DIRCACHE */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Directory handling - Find an object in the directory                  */
 /*-----------------------------------------------------------------------*/
 
 static
-FRESULT dir_find (
-	DIR *dj			/* Pointer to the directory object linked to the file name */
+FRESULT dir_scan (	/* FR_OK:Found, FR_NO_FILE:Not found */
+	DIR *dj,		/* Directory object linked to the file name, at the first entry to check */
+	WORD last		/* Give up after this index */
 )
 {
 	FRESULT res;
 	BYTE c, *dir;
 #if _USE_LFN
 	BYTE a, ord, sum;
-#endif
-
-	res = dir_seek(dj, 0);			/* Rewind directory object */
-	if (res != FR_OK) return res;
 
-#if _USE_LFN
 	ord = sum = 0xFF;
 #endif
 	do {
@@ -861,6 +1011,11 @@ FRESULT dir_find (
 						sum = dir[LDIR_Chksum];
 						c &= 0xBF; ord = c;	/* LFN start order */
 						dj->lfn_idx = dj->index;
+#if _FS_DIRCACHE
+						DcFound.index = dj->index;	/* The object starts here if it matches */
+						DcFound.clust = dj->clust;
+						DcFound.sect = dj->sect;
+#endif
 					}
 					/* Check validity of the LFN entry and compare it with given name */
 					ord = (c == ord && sum == dir[LDIR_Chksum] && cmp_lfn(dj->lfn, dir)) ? ord - 1 : 0xFF;
@@ -868,13 +1023,27 @@ FRESULT dir_find (
 			} else {					/* An SFN entry is found */
 				if (!ord && sum == sum_sfn(dir)) break;	/* LFN matched? */
 				ord = 0xFF; dj->lfn_idx = 0xFFFF;	/* Reset LFN sequence */
-				if (!(dj->fn[NS] & NS_LOSS) && !mem_cmp(dir, dj->fn, 11)) break;	/* SFN matched? */
+				if (!(dj->fn[NS] & NS_LOSS) && !mem_cmp(dir, dj->fn, 11)) {	/* SFN matched? */
+#if _FS_DIRCACHE
+					DcFound.index = dj->index;
+					DcFound.clust = dj->clust;
+					DcFound.sect = dj->sect;
+#endif
+					break;
+				}
 			}
 		}
 #else		/* Non LFN configuration */
-		if (!(dir[DIR_Attr] & AM_VOL) && !mem_cmp(dir, dj->fn, 11)) /* Is it a valid entry? */
+		if (!(dir[DIR_Attr] & AM_VOL) && !mem_cmp(dir, dj->fn, 11)) { /* Is it a valid entry? */
+#if _FS_DIRCACHE
+			DcFound.index = dj->index;
+			DcFound.clust = dj->clust;
+			DcFound.sect = dj->sect;
+#endif
 			break;
+		}
 #endif
+		if (dj->index >= last) { res = FR_NO_FILE; break; }	/* Reached the end of the range */
 		res = dir_next(dj, FALSE);		/* Next entry */
 	} while (res == FR_OK);
 
@@ -882,6 +1051,40 @@ FRESULT dir_find (
 }
 
 
+static
+FRESULT dir_find (
+	DIR *dj			/* Pointer to the directory object linked to the file name */
+)
+{
+	FRESULT res;
+#if _FS_DIRCACHE
+	DCENT *dc;
+
+
+	dc = dc_find(dj);				/* Try the directory entry cache first */
+	if (dc) {
+		res = dir_scan(dj, dc->last);	/* Only check the entries of the cached object */
+		if (res == FR_OK) {
+			dc->stamp = ++DcClock;
+			return res;
+		}
+		dc->sect = 0;				/* Stale entry (or hash collision) */
+		if (res != FR_NO_FILE) return res;
+	}
+#endif
+
+	res = dir_seek(dj, 0);			/* Rewind directory object */
+	if (res != FR_OK) return res;
+
+	res = dir_scan(dj, 0xFFFF);
+#if _FS_DIRCACHE
+	if (res == FR_OK) dc_store(dj);
+#endif
+
+	return res;
+}
+
+
 
 
 /*-----------------------------------------------------------------------*/
@@ -1038,6 +1241,10 @@ FRESULT dir_register (	/* FR_OK:Successful, FR_DENIED:No free entry or too many
 		}
 	}
 
+#if _FS_DIRCACHE
+	dc_flush();
+#endif
+
 	return res;
 }
 #endif /* !_FS_READONLY */
@@ -1083,6 +1290,10 @@ FRESULT dir_remove (	/* FR_OK: Successful, FR_DISK_ERR: A disk error */
 	}
 #endif
 
+#if _FS_DIRCACHE
+	dc_flush();
+#endif
+
 	return res;
 }
 #endif /* !_FS_READONLY */
@@ -1749,6 +1960,9 @@ FRESULT f_open (
 	fp->fsize = LD_DWORD(dir+DIR_FileSize);	/* File size */
 	fp->fptr = 0; fp->csect = 255;		/* File pointer */
 	fp->dsect = 0;
+#if _USE_FASTSEEK
+	fp->cltbl = 0;						/* Normal seek mode */
+#endif
 	fp->fs = dj.fs; fp->id = dj.fs->id;	/* Owner file system object of the file */
 
 	LEAVE_FF(dj.fs, FR_OK);
@@ -1787,10 +2001,22 @@ FRESULT f_read (
 
 	for ( ;  btr;									/* Repeat until all data transferred */
 		rbuff += rcnt, fp->fptr += rcnt, *br += rcnt, btr -= rcnt) {
+#if _FS_REENTRANT
+		if (*br && (fp->fptr % SS(fp->fs)) == 0)	/* Let another task in between sectors */
+			ff_yield(fp->fs);
+#endif
 		if ((fp->fptr % SS(fp->fs)) == 0) {			/* On the sector boundary? */
 			if (fp->csect >= fp->fs->csize) {		/* On the cluster boundary? */
-				clst = (fp->fptr == 0) ?			/* On the top of the file? */
-					fp->org_clust : get_fat(fp->fs, fp->curr_clust);
+				if (fp->fptr == 0) {				/* On the top of the file? */
+					clst = fp->org_clust;			/* Follow from the origin */
+				} else {							/* Middle or end of the file */
+#if _USE_FASTSEEK
+					if (fp->cltbl)
+						clst = clmt_clust(fp, fp->fptr);	/* Get cluster# from the CLMT */
+					else
+#endif
+						clst = get_fat(fp->fs, fp->curr_clust);	/* Follow cluster chain on the FAT */
+				}
 				if (clst <= 1) ABORT(fp->fs, FR_INT_ERR);
 				if (clst == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
 				fp->curr_clust = clst;				/* Update current cluster */
@@ -1881,6 +2107,10 @@ FRESULT f_write (
 
 	for ( ;  btw;									/* Repeat until all data transferred */
 		wbuff += wcnt, fp->fptr += wcnt, *bw += wcnt, btw -= wcnt) {
+#if _FS_REENTRANT
+		if (*bw && (fp->fptr % SS(fp->fs)) == 0)	/* Let another task in between sectors */
+			ff_yield(fp->fs);
+#endif
 		if ((fp->fptr % SS(fp->fs)) == 0) {			/* On the sector boundary? */
 			if (fp->csect >= fp->fs->csize) {		/* On the cluster boundary? */
 				if (fp->fptr == 0) {				/* On the top of the file? */
@@ -1888,7 +2118,12 @@ FRESULT f_write (
 					if (clst == 0)					/* When there is no cluster chain, */
 						fp->org_clust = clst = create_chain(fp->fs, 0);	/* Create a new cluster chain */
 				} else {							/* Middle or end of the file */
-					clst = create_chain(fp->fs, fp->curr_clust);			/* Follow or streach cluster chain */
+#if _USE_FASTSEEK
+					if (fp->cltbl)
+						clst = clmt_clust(fp, fp->fptr);	/* Get cluster# from the CLMT (can't stretch the file) */
+					else
+#endif
+						clst = create_chain(fp->fs, fp->curr_clust);	/* Follow or streach cluster chain */
 				}
 				if (clst == 0) break;				/* Could not allocate a new cluster (disk full) */
 				if (clst == 1) ABORT(fp->fs, FR_INT_ERR);
@@ -2099,6 +2334,12 @@ FRESULT f_chdir (
 /*-----------------------------------------------------------------------*/
 /* Seek File R/W Pointer                                                 */
 /*-----------------------------------------------------------------------*/
+/* With _USE_FASTSEEK, point fp->cltbl at a DWORD table whose first item  */
+/* is its size in items and call f_lseek(fp, CREATE_LINKMAP) once.  The   */
+/* table then holds (length, first cluster) pairs for each fragment of   */
+/* the file (2 items per fragment + 2), and seeks no longer read the FAT. */
+/* FR_NOT_ENOUGH_CORE is returned, with the required size in the first   */
+/* item, if the table is too small.  The file can't grow in this mode.   */
 
 FRESULT f_lseek (
 	FIL *fp,		/* Pointer to the file object */
@@ -2113,51 +2354,46 @@ FRESULT f_lseek (
 	if (res != FR_OK) LEAVE_FF(fp->fs, res);
 	if (fp->flag & FA__ERROR)			/* Check abort flag */
 		LEAVE_FF(fp->fs, FR_INT_ERR);
-	if (ofs > fp->fsize					/* In read-only mode, clip offset with the file size */
-#if !_FS_READONLY
-		 && !(fp->flag & FA_WRITE)
-#endif
-		) ofs = fp->fsize;
-
-	ifptr = fp->fptr;
-	fp->fptr = nsect = 0; fp->csect = 255;
-	if (ofs > 0) {
-		bcs = (DWORD)fp->fs->csize * SS(fp->fs);	/* Cluster size (byte) */
-		if (ifptr > 0 &&
-			(ofs - 1) / bcs >= (ifptr - 1) / bcs) {	/* When seek to same or following cluster, */
-			fp->fptr = (ifptr - 1) & ~(bcs - 1);	/* start from the current cluster */
-			ofs -= fp->fptr;
-			clst = fp->curr_clust;
-		} else {									/* When seek to back cluster, */
-			clst = fp->org_clust;					/* start from the first cluster */
-#if !_FS_READONLY
-			if (clst == 0) {						/* If no cluster chain, create a new chain */
-				clst = create_chain(fp->fs, 0);
-				if (clst == 1) ABORT(fp->fs, FR_INT_ERR);
-				if (clst == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
-				fp->org_clust = clst;
-			}
-#endif
-			fp->curr_clust = clst;
-		}
-		if (clst != 0) {
-			while (ofs > bcs) {						/* Cluster following loop */
-#if !_FS_READONLY
-				if (fp->flag & FA_WRITE) {			/* Check if in write mode or not */
-					clst = create_chain(fp->fs, clst);	/* Force streached if in write mode */
-					if (clst == 0) {				/* When disk gets full, clip file size */
-						ofs = bcs; break;
+
+#if _USE_FASTSEEK
+	if (fp->cltbl) {					/* Fast seek */
+		DWORD pcl, ncl, tcl, tlen, ulen, *tbl;
+
+		if (ofs == CREATE_LINKMAP) {	/* Create CLMT */
+			tbl = fp->cltbl;
+			tlen = *tbl++; ulen = 2;	/* Given table size and required table size */
+			clst = fp->org_clust;		/* Top of the chain */
+			if (clst) {
+				do {
+					/* Get a fragment */
+					tcl = clst; ncl = 0; ulen += 2;	/* Top, length and used items */
+					do {
+						pcl = clst; ncl++;
+						clst = get_fat(fp->fs, clst);
+						if (clst <= 1) ABORT(fp->fs, FR_INT_ERR);
+						if (clst == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
+					} while (clst == pcl + 1);
+					if (ulen <= tlen) {		/* Store the length and top of the fragment */
+						*tbl++ = ncl; *tbl++ = tcl;
 					}
-				} else
-#endif
-					clst = get_fat(fp->fs, clst);	/* Follow cluster chain if not in write mode */
-				if (clst == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
-				if (clst <= 1 || clst >= fp->fs->max_clust) ABORT(fp->fs, FR_INT_ERR);
-				fp->curr_clust = clst;
-				fp->fptr += bcs;
-				ofs -= bcs;
+				} while (clst < fp->fs->max_clust);	/* Repeat until end of chain */
 			}
-			fp->fptr += ofs;
+			*fp->cltbl = ulen;			/* Number of items used */
+			if (ulen <= tlen)
+				*tbl = 0;				/* Terminate table */
+			else
+				res = FR_NOT_ENOUGH_CORE;	/* Given table size is smaller than required */
+			LEAVE_FF(fp->fs, res);
+		}
+
+		if (ofs > fp->fsize) ofs = fp->fsize;	/* Clip offset at the file size */
+		fp->fptr = ofs; nsect = 0; fp->csect = 255;
+		if (ofs > 0) {					/* Same position rules as the FAT walk below */
+			bcs = (DWORD)fp->fs->csize * SS(fp->fs);	/* Cluster size (byte) */
+			clst = clmt_clust(fp, ofs - 1);	/* Cluster holding the byte before ofs */
+			if (clst <= 1) ABORT(fp->fs, FR_INT_ERR);
+			fp->curr_clust = clst;
+			ofs -= ((ofs - 1) / bcs) * bcs;	/* Offset in the cluster (1..bcs) */
 			fp->csect = (BYTE)(ofs / SS(fp->fs));	/* Sector offset in the cluster */
 			if (ofs % SS(fp->fs)) {
 				nsect = clust2sect(fp->fs, clst);	/* Current sector */
@@ -2166,6 +2402,65 @@ FRESULT f_lseek (
 				fp->csect++;
 			}
 		}
+	} else
+#endif
+
+	/* Normal seek */
+	{
+		if (ofs > fp->fsize					/* In read-only mode, clip offset with the file size */
+#if !_FS_READONLY
+			 && !(fp->flag & FA_WRITE)
+#endif
+			) ofs = fp->fsize;
+
+		ifptr = fp->fptr;
+		fp->fptr = nsect = 0; fp->csect = 255;
+		if (ofs > 0) {
+			bcs = (DWORD)fp->fs->csize * SS(fp->fs);	/* Cluster size (byte) */
+			if (ifptr > 0 &&
+				(ofs - 1) / bcs >= (ifptr - 1) / bcs) {	/* When seek to same or following cluster, */
+				fp->fptr = (ifptr - 1) & ~(bcs - 1);	/* start from the current cluster */
+				ofs -= fp->fptr;
+				clst = fp->curr_clust;
+			} else {									/* When seek to back cluster, */
+				clst = fp->org_clust;					/* start from the first cluster */
+#if !_FS_READONLY
+				if (clst == 0) {						/* If no cluster chain, create a new chain */
+					clst = create_chain(fp->fs, 0);
+					if (clst == 1) ABORT(fp->fs, FR_INT_ERR);
+					if (clst == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
+					fp->org_clust = clst;
+				}
+#endif
+				fp->curr_clust = clst;
+			}
+			if (clst != 0) {
+				while (ofs > bcs) {						/* Cluster following loop */
+#if !_FS_READONLY
+					if (fp->flag & FA_WRITE) {			/* Check if in write mode or not */
+						clst = create_chain(fp->fs, clst);	/* Force streached if in write mode */
+						if (clst == 0) {				/* When disk gets full, clip file size */
+							ofs = bcs; break;
+						}
+					} else
+#endif
+						clst = get_fat(fp->fs, clst);	/* Follow cluster chain if not in write mode */
+					if (clst == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
+					if (clst <= 1 || clst >= fp->fs->max_clust) ABORT(fp->fs, FR_INT_ERR);
+					fp->curr_clust = clst;
+					fp->fptr += bcs;
+					ofs -= bcs;
+				}
+				fp->fptr += ofs;
+				fp->csect = (BYTE)(ofs / SS(fp->fs));	/* Sector offset in the cluster */
+				if (ofs % SS(fp->fs)) {
+					nsect = clust2sect(fp->fs, clst);	/* Current sector */
+					if (!nsect) ABORT(fp->fs, FR_INT_ERR);
+					nsect += fp->csect;
+					fp->csect++;
+				}
+			}
+		}
 	}
 	if (fp->fptr % SS(fp->fs) && nsect != fp->dsect) {
 #if !_FS_TINY
@@ -2368,8 +2663,12 @@ FRESULT f_getfree (
 		} while (--clst);
 	}
 	(*fatfs)->free_clust = n;
-	if (fat == FS_FAT32) (*fatfs)->fsi_flag = 1;
 	*nclst = n;
+	if (fat == FS_FAT32) {	/* Write the count back so the scan isn't needed on the next mount */
+		(*fatfs)->fsi_flag = 1;
+		if (!(disk_status((*fatfs)->drive) & STA_PROTECT))
+			sync(*fatfs);
+	}
 
 	LEAVE_FF(*fatfs, FR_OK);
 }
@@ -2741,8 +3040,16 @@ FRESULT f_forward (
 		fp->fptr += rcnt, *bf += rcnt, btr -= rcnt) {
 		if ((fp->fptr % SS(fp->fs)) == 0) {			/* On the sector boundary? */
 			if (fp->csect >= fp->fs->csize) {		/* On the cluster boundary? */
-				clst = (fp->fptr == 0) ?			/* On the top of the file? */
-					fp->org_clust : get_fat(fp->fs, fp->curr_clust);
+				if (fp->fptr == 0) {				/* On the top of the file? */
+					clst = fp->org_clust;			/* Follow from the origin */
+				} else {							/* Middle or end of the file */
+#if _USE_FASTSEEK
+					if (fp->cltbl)
+						clst = clmt_clust(fp, fp->fptr);	/* Get cluster# from the CLMT */
+					else
+#endif
+						clst = get_fat(fp->fs, fp->curr_clust);	/* Follow cluster chain on the FAT */
+				}
 				if (clst <= 1) ABORT(fp->fs, FR_INT_ERR);
 				if (clst == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
 				fp->curr_clust = clst;				/* Update current cluster */
@@ -2768,6 +3075,71 @@ FRESULT f_forward (
 
 
 
+#if _USE_EXPAND && !_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* Allocate a Contiguous Cluster Chain to an Empty File                  */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_expand (
+	FIL *fp,		/* Pointer to the file object (must be empty) */
+	DWORD fsz		/* File size to be allocated in bytes */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+	DWORD n, clst, stcl, scl, ncl, tcl;
+
+
+	res = validate(fp->fs, fp->id);		/* Check validity of the object */
+	if (res != FR_OK) LEAVE_FF(fp->fs, res);
+	if (fp->flag & FA__ERROR)			/* Check abort flag */
+		LEAVE_FF(fp->fs, FR_INT_ERR);
+	if (!(fp->flag & FA_WRITE) || !fsz || fp->fsize || fp->org_clust)	/* Check access mode and file state */
+		LEAVE_FF(fp->fs, FR_DENIED);
+
+	fs = fp->fs;
+	n = (DWORD)fs->csize * SS(fs);			/* Cluster size (byte) */
+	tcl = (fsz + n - 1) / n;				/* Number of clusters required */
+	stcl = fs->last_clust;					/* Start the search at the last allocated cluster */
+	if (stcl < 2 || stcl >= fs->max_clust) stcl = 2;
+
+	scl = clst = stcl; ncl = 0;
+	for (;;) {								/* Look for a run of tcl free clusters */
+		n = get_fat(fs, clst);
+		if (n == 1) { res = FR_INT_ERR; break; }
+		if (n == 0xFFFFFFFF) { res = FR_DISK_ERR; break; }
+		if (n == 0) {						/* Free cluster, extend the run */
+			if (++ncl == tcl) break;
+		} else {							/* Cluster in use, restart the run after it */
+			scl = clst + 1; ncl = 0;
+		}
+		if (++clst >= fs->max_clust) {		/* Wrap around (a run can't span the end) */
+			scl = clst = 2; ncl = 0;
+		}
+		if (clst == stcl) { res = FR_DENIED; break; }	/* No contiguous space */
+	}
+
+	if (res == FR_OK) {						/* Link the run into a cluster chain */
+		for (clst = scl, n = tcl; n; clst++, n--) {
+			res = put_fat(fs, clst, (n == 1) ? 0x0FFFFFFF : clst + 1);
+			if (res != FR_OK) ABORT(fs, res);
+		}
+		fs->last_clust = scl + tcl - 1;		/* Update FSINFO */
+		if (fs->free_clust != 0xFFFFFFFF) {
+			fs->free_clust -= tcl;
+			fs->fsi_flag = 1;
+		}
+		fp->org_clust = scl;
+		fp->fsize = fsz;
+		fp->flag |= FA__WRITTEN;
+	}
+
+	LEAVE_FF(fs, res);
+}
+#endif /* _USE_EXPAND */
+
+
+
 #if _USE_MKFS && !_FS_READONLY
 /*-----------------------------------------------------------------------*/
 /* Create File System on the Drive                                       */
@@ -362,6 +362,9 @@ typedef struct _FIL_ {
 	DWORD	org_clust;	/* File start cluster */
 	DWORD	curr_clust;	/* Current cluster */
 	DWORD	dsect;		/* Current data sector */
+#if _USE_FASTSEEK
+	DWORD*	cltbl;		/* Pointer to the cluster link map table (NULL on file open) */
+#endif
 #if !_FS_READONLY
 	DWORD	dir_sect;	/* Sector containing the directory entry */
 	BYTE*	dir_ptr;	/* Ponter to the directory entry in the window */
@@ -407,7 +410,8 @@ typedef enum {
 	FR_NOT_ENABLED,		/* 12 */
 	FR_NO_FILESYSTEM,	/* 13 */
 	FR_MKFS_ABORTED,	/* 14 */
-	FR_TIMEOUT			/* 15 */
+	FR_TIMEOUT,			/* 15 */
+	FR_NOT_ENOUGH_CORE	/* 16 */
 } FRESULT;
 
 
@@ -433,6 +437,7 @@ FRESULT f_chmod (const XCHAR*, BYTE, BYTE);			/* Change attriburte of the file/d
 FRESULT f_utime (const XCHAR*, const FILINFO*);		/* Change timestamp of the file/dir */
 FRESULT f_rename (const XCHAR*, const XCHAR*);		/* Rename/Move a file or directory */
 FRESULT f_forward (FIL*, UINT(*)(const BYTE*,UINT), UINT, UINT*);	/* Forward data to the stream */
+FRESULT f_expand (FIL*, DWORD);						/* Allocate a contiguous block to an empty file */
 FRESULT f_mkfs (BYTE, BYTE, WORD);					/* Create a file system on the drive */
 FRESULT f_chdir (const XCHAR*);						/* Change current directory */
 FRESULT f_chdrive (BYTE);							/* Change current drive */
@@ -472,6 +477,7 @@ BOOL ff_cre_syncobj(BYTE, _SYNC_t*);
 BOOL ff_del_syncobj(_SYNC_t);
 BOOL ff_req_grant(_SYNC_t);
 void ff_rel_grant(_SYNC_t);
+void ff_yield(FATFS*);
 #endif
 
 
@@ -495,6 +501,11 @@ void ff_rel_grant(_SYNC_t);
 #define FA__ERROR		0x80
 
 
+/* Fast seek: f_lseek offset that builds the cluster link map (FIL.cltbl) */
+
+#define CREATE_LINKMAP	0xFFFFFFFF
+
+
 /* FAT sub type (FATFS.fs_type) */
 
 #define FS_FAT12	1
@@ -45,10 +45,44 @@
 /* To enable f_mkfs function, set _USE_MKFS to 1 and set _FS_READONLY to 0 */
 
 
-#define	_USE_FORWARD	0	/* 0 or 1 */
+#define	_USE_FORWARD	1	/* 0 or 1 */
 /* To enable f_forward function, set _USE_FORWARD to 1 and set _FS_TINY to 1. */
 
 
+#define	_USE_FASTSEEK	1	/* 0 or 1 */
+/* To enable the fast seek feature, set _USE_FASTSEEK to 1.  A file's cluster
+/  chain can then be mapped into a caller supplied table with
+/  f_lseek(fp, CREATE_LINKMAP) (see f_lseek in ff.c), after which seeks and
+/  cluster changes on that file don't read the FAT at all. */
+
+
+#define	_USE_EXPAND	1	/* 0 or 1 */
+/* To enable f_expand function, set _USE_EXPAND to 1 and set _FS_READONLY to 0.
+/  f_expand allocates a contiguous cluster chain to an empty file, which is
+/  required by the streaming log file driver (logstream.c). */
+
+
+#ifdef CFG_SDCARD_TRIM
+#define	_USE_ERASE	1	/* 0 or 1 */
+#else
+#define	_USE_ERASE	0	/* 0 or 1 */
+#endif
+/* When _USE_ERASE is 1, every contiguous run of clusters that is freed
+/  (f_unlink, f_truncate, overwriting a file) is erased on the card with
+/  disk_ioctl(CTRL_ERASE_SECTOR), so the card doesn't have to copy stale
+/  data around when those blocks are written again.  Frees take longer,
+/  since each run waits for the erase to finish. */
+
+
+#define	_FS_DIRCACHE	CFG_SDCARD_DIRCACHE	/* 0:Disable or 1-32 */
+/* Number of entries in the directory entry cache.  Every name found by a
+/  directory search is remembered by a hash of its (long) name together with
+/  the position of its entries, so opening the same path again only checks
+/  those entries instead of rescanning the directory.  Each entry costs 24
+/  bytes of RAM.  The cache is flushed whenever an entry is created or
+/  removed, and entries of an unmounted volume are never used. */
+
+
 
 /*---------------------------------------------------------------------------/
 / Locale and Namespace Configurations
@@ -87,7 +121,11 @@
 */
 
 
-#define	_USE_LFN	0		/* 0, 1 or 2 */
+#ifdef CFG_SDCARD_REENTRANT
+#define	_USE_LFN	2		/* 0, 1 or 2 */
+#else
+#define	_USE_LFN	1		/* 0, 1 or 2 */
+#endif
 #define	_MAX_LFN	64		/* Maximum LFN length to handle (12 to 255) */
 /* The _USE_LFN option switches the LFN support.
 /
@@ -153,9 +191,13 @@
 /  performance and code size. */
 
 
+#ifdef CFG_SDCARD_REENTRANT
+#define _FS_REENTRANT	1		/* 0 or 1 */
+#else
 #define _FS_REENTRANT	0		/* 0 or 1 */
-#define _FS_TIMEOUT		1000	/* Timeout period in unit of time ticks */
-#define	_SYNC_t			HANDLE	/* O/S dependent type of sync object. e.g. HANDLE, OS_EVENT*, ID and etc.. */
+#endif
+#define _FS_TIMEOUT		0		/* Not used, a busy volume can't be waited for (see ffsync.c) */
+#define	_SYNC_t			BYTE	/* Volume number (see ffsync.c) */
 /* The _FS_REENTRANT option switches the reentrancy of the FatFs module.
 /
 /   0: Disable reentrancy. _SYNC_t and _FS_TIMEOUT have no effect.
@@ -0,0 +1,226 @@
+/**************************************************************************/
+/*! 
+    @file     ffsink.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Streams file data from the FatFs sector window straight
+              into another peripheral using f_forward().
+
+    With _FS_TINY set every file shares the sector buffer in the FATFS
+    object, so f_read() always ends up copying the data out of it into
+    a caller supplied buffer.  f_forward() hands out pointers into the
+    window instead, which lets the data go from the SD card to the CDC
+    or UART TX ring or the LCD without a second buffer on the stack.
+
+    @section Example
+
+    @code 
+    #include "drivers/fatfs/ffsink.h"
+
+    ffSink_t sink;
+    UINT sent;
+
+    // Dump an open file to the UART
+    ffSinkInitUART(&sink);
+    ffSinkForward(&file, &sink, file.fsize, &sent);
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "ffsink.h"
+
+#ifdef CFG_SDCARD
+
+#include "core/systick/systick.h"
+#include "core/uart/uart.h"
+
+#ifdef CFG_USBCDC
+  #include "core/usbcdc/usb.h"
+  #include "core/usbcdc/usbcore.h"
+  #include "core/usbcdc/cdcuser.h"
+  #include "core/usbcdc/cdc_buf.h"
+#endif
+
+#define FFSINK_TIMEOUT_TICKS    (FFSINK_TIMEOUT_MS / CFG_SYSTICK_DELAY_IN_MS)
+
+// f_forward's callback has no context argument
+static ffSink_t *ffSinkActive;
+
+/**************************************************************************/
+/*!
+    @brief  Passes f_forward's callback on to the active sink
+*/
+/**************************************************************************/
+static UINT ffSinkStream(const BYTE *data, UINT len)
+{
+  return ffSinkActive->write(ffSinkActive, data, len);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Waits for the sink to become ready, polling it in the
+            meantime.  Returns FALSE if it failed or timed out.
+*/
+/**************************************************************************/
+static bool ffSinkWait(ffSink_t *sink)
+{
+  uint32_t start = systickGetTicks();
+
+  while (!sink->write(sink, NULL, 0))
+  {
+    if (sink->status || (systickGetTicks() - start >= FFSINK_TIMEOUT_TICKS))
+      return FALSE;
+    if (sink->poll)
+      sink->poll(sink);
+  }
+
+  return sink->status ? FALSE : TRUE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Forwards up to btf bytes from the current position of an
+            open file to a sink
+
+    @param[in]  fp
+                File opened with FA_READ
+    @param[in]  sink
+                Sink set up with one of the ffSinkInit functions, or by
+                hand with a write callback
+    @param[in]  btf
+                Number of bytes to forward
+    @param[out] bf
+                Number of bytes actually forwarded (less than btf at EOF)
+
+    @returns    FR_OK, FR_TIMEOUT if the sink stopped accepting data or
+                failed, or any error from f_forward
+*/
+/**************************************************************************/
+FRESULT ffSinkForward(FIL *fp, ffSink_t *sink, UINT btf, UINT *bf)
+{
+  FRESULT res;
+  UINT n;
+
+  *bf = 0;
+  sink->status = 0;
+  ffSinkActive = sink;
+
+  while (btf && (fp->fptr < fp->fsize))
+  {
+    // f_forward returns early (without an error) whenever the sink is busy
+    res = f_forward(fp, ffSinkStream, btf, &n);
+    *bf += n;
+    btf -= n;
+    if (res != FR_OK)
+      return res;
+    if (!ffSinkWait(sink))
+      return FR_TIMEOUT;
+  }
+
+  // A sink that is still using the window has finished with it now (the
+  // last ffSinkWait), so the caller is free to touch the file again
+  return FR_OK;
+}
+
+/**************************************************************************/
+/*!
+    @brief  UART sink, fills the TX ring buffer
+*/
+/**************************************************************************/
+static UINT ffSinkUARTWrite(ffSink_t *sink, const BYTE *data, UINT len)
+{
+  uart_pcb_t *pcb = uartGetPCB();
+  UINT space = CFG_UART_TXBUFSIZE - (uint16_t)(pcb->txfifo.head - pcb->txfifo.tail);
+
+  if (data == NULL)
+    return space;
+
+  // Only queue what fits so that uartSend never blocks
+  if (len > space)
+    len = space;
+  uartSend((uint8_t *)data, len);
+
+  return len;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets up a sink that sends the file over the UART
+*/
+/**************************************************************************/
+void ffSinkInitUART(ffSink_t *sink)
+{
+  sink->write = ffSinkUARTWrite;
+  sink->poll = NULL;
+  sink->arg = NULL;
+  sink->status = 0;
+}
+
+#ifdef CFG_USBCDC
+/**************************************************************************/
+/*!
+    @brief  USB CDC sink, fills the bulk IN ring buffer
+*/
+/**************************************************************************/
+static UINT ffSinkCDCWrite(ffSink_t *sink, const BYTE *data, UINT len)
+{
+  UINT i, space = CFG_USBCDC_BUFFERSIZE - cdcBufferCount();
+
+  if (data == NULL)
+    return USB_Configuration ? space : 0;
+
+  if (len > space)
+    len = space;
+  for (i = 0; i < len; i++)
+    cdcBufferWrite(data[i]);
+
+  // Get the bulk IN endpoint going if it's idle
+  CDC_BulkInStart();
+
+  return len;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets up a sink that sends the file over USB CDC
+*/
+/**************************************************************************/
+void ffSinkInitCDC(ffSink_t *sink)
+{
+  sink->write = ffSinkCDCWrite;
+  sink->poll = NULL;
+  sink->arg = NULL;
+  sink->status = 0;
+}
+#endif
+
+#endif
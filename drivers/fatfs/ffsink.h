@@ -0,0 +1,75 @@
+/**************************************************************************/
+/*! 
+    @file     ffsink.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __FFSINK_H__
+#define __FFSINK_H__
+
+#include "projectconfig.h"
+
+#include "drivers/fatfs/ff.h"
+
+#define FFSINK_TIMEOUT_MS       (1000)  // Give up if a sink stays busy this long
+
+typedef struct ffSink_s ffSink_t;
+
+/**************************************************************************/
+/*!
+    @brief  A destination for ffSinkForward()
+
+    write() is called with data set to NULL to ask whether the sink can
+    take more data (non-zero = ready).  Otherwise it gets a pointer
+    straight into the FatFs sector window and returns the number of
+    bytes it consumed, which must be at least one.  The window is only
+    valid until write() returns, unless the sink reports itself busy
+    until it's done with it.
+*/
+/**************************************************************************/
+struct ffSink_s
+{
+  UINT (*write)(ffSink_t *sink, const BYTE *data, UINT len);
+  void (*poll)(ffSink_t *sink);       // Optional, called while the sink is busy
+  void *arg;                          // Sink specific context
+  volatile uint8_t status;            // Non-zero if the sink failed
+};
+
+#ifdef CFG_SDCARD
+FRESULT ffSinkForward(FIL *fp, ffSink_t *sink, UINT btf, UINT *bf);
+void    ffSinkInitUART(ffSink_t *sink);
+#ifdef CFG_USBCDC
+void    ffSinkInitCDC(ffSink_t *sink);
+#endif
+#endif
+
+#endif
@@ -0,0 +1,297 @@
+/**************************************************************************/
+/*! 
+    @file     ffsync.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Shared volume and FatFs sync objects for the scheduler.
+
+    Everything that uses files on the SD card (bitmaps, the data
+    logger, scripts, etc.) mounts the card through ffSyncMount, which
+    keeps one FATFS object for all of them and counts its users.  Two
+    FATFS objects on the same card would each cache their own FAT and
+    directory sectors, and the last f_mount would pull the volume out
+    from under the other one's open files.
+
+    The volume stays registered with FatFs when the last user is done,
+    so the free cluster count (read from FSInfo, or counted once by
+    f_getfree) is kept in RAM and updated as clusters are allocated and
+    freed.  ffSyncGetFree can then report the free space without going
+    through the FAT.  The card is mounted again when it had to be
+    initialised (it may have been swapped), and after ffSyncInvalidate,
+    which the USB mass storage interface calls when the host writes to
+    the card.
+
+    With CFG_SDCARD_REENTRANT, FatFs is built with _FS_REENTRANT and
+    the sync object is the volume number.  Tasks run to completion, so
+    FatFs calls only overlap when one of them lets other tasks in: a
+    long f_read or f_write (more than one sector) calls ff_yield
+    between sectors, which gives up the volume, runs one other ready
+    task (schedYield) and takes the volume back.  The task run there
+    can use any file on the card, and has finished with it by the time
+    the first call carries on.  A write stream opened by the data
+    logger is paused for these requests (see mmc.c), so logging goes
+    on while images load.
+
+    There is nobody to wait for when a task finds the volume taken
+    (the owner can't run until that task returns), so ff_req_grant
+    fails straight away and the FatFs call returns FR_TIMEOUT.
+
+    @section Example
+
+    @code 
+    #include "drivers/fatfs/ffsync.h"
+
+    FIL file;
+
+    if (ffSyncMount() == FR_OK)
+    {
+      if (f_open(&file, "/config.txt", FA_READ | FA_OPEN_EXISTING) == FR_OK)
+      {
+        ...
+        f_close(&file);
+      }
+      ffSyncUnmount();
+    }
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "ffsync.h"
+#include "diskio.h"
+
+#ifdef CFG_SDCARD
+
+#if _FS_REENTRANT
+  #include "core/sched/sched.h"
+
+  static volatile BYTE ffSyncLocked[_DRIVES];
+#endif
+
+static FATFS ffSyncFatfs;
+static uint8_t ffSyncUsers = 0;
+static bool ffSyncRegistered = false;
+
+/**************************************************************************/
+/*! 
+    @brief  Initialises the card if needed and mounts the shared volume
+            for one more user.  Every successful call must be matched by
+            ffSyncUnmount.
+
+    @return FR_NOT_READY if there is no card or it can't be initialised
+*/
+/**************************************************************************/
+FRESULT ffSyncMount(void)
+{
+  DSTATUS stat;
+  FRESULT res;
+
+  if (ffSyncUsers)
+  {
+    ffSyncUsers++;
+    return FR_OK;
+  }
+
+  stat = disk_status(0);
+  if (stat & STA_NOINIT)
+  {
+    // Possibly a different card, don't trust what's cached
+    ffSyncRegistered = false;
+    stat = disk_initialize(0);
+  }
+  if (stat & (STA_NOINIT | STA_NODISK))
+  {
+    return FR_NOT_READY;
+  }
+
+  if (!ffSyncRegistered)
+  {
+    res = f_mount(0, &ffSyncFatfs);
+    if (res != FR_OK)
+    {
+      return res;
+    }
+    ffSyncRegistered = true;
+  }
+
+  ffSyncUsers = 1;
+  return FR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Releases the volume.  The FATFS object stays registered
+            (see above), all files must be closed by now.
+*/
+/**************************************************************************/
+void ffSyncUnmount(void)
+{
+  if (ffSyncUsers)
+  {
+    ffSyncUsers--;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Drops everything FatFs has cached about the card (FAT and
+            directory sectors, the free cluster count), for when it has
+            been written without going through FatFs
+*/
+/**************************************************************************/
+void ffSyncInvalidate(void)
+{
+  ffSyncRegistered = false;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the shared FATFS object (only valid while mounted)
+*/
+/**************************************************************************/
+FATFS *ffSyncGetFs(void)
+{
+  return &ffSyncFatfs;
+}
+
+#if _FS_MINIMIZE == 0 && _FS_READONLY == 0
+/**************************************************************************/
+/*! 
+    @brief  Gets the free and total space on the card in KB.  This is
+            instant unless FSInfo was missing or invalid, in which case
+            the first call after a card is inserted counts the free
+            clusters (and writes the result back to FSInfo).
+
+    @param[out] freeKB
+                Free space in KB
+    @param[out] totalKB
+                Size of the data area in KB (can be NULL)
+*/
+/**************************************************************************/
+FRESULT ffSyncGetFree(DWORD *freeKB, DWORD *totalKB)
+{
+  FATFS *fs;
+  DWORD clusters;
+  FRESULT res;
+
+  res = ffSyncMount();
+  if (res != FR_OK)
+  {
+    return res;
+  }
+
+  res = f_getfree("0:", &clusters, &fs);
+  if (res == FR_OK)
+  {
+    *freeKB = clusters * fs->csize / 2;
+    if (totalKB)
+    {
+      *totalKB = (fs->max_clust - 2) * fs->csize / 2;
+    }
+  }
+
+  ffSyncUnmount();
+  return res;
+}
+#endif
+
+#if _FS_REENTRANT
+/**************************************************************************/
+/*! 
+    @brief  Creates the sync object for a volume (called by f_mount)
+*/
+/**************************************************************************/
+BOOL ff_cre_syncobj(BYTE vol, _SYNC_t *sobj)
+{
+  *sobj = vol;
+  return TRUE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Deletes the sync object for a volume (called by f_mount)
+*/
+/**************************************************************************/
+BOOL ff_del_syncobj(_SYNC_t sobj)
+{
+  return TRUE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Takes the volume at the start of a FatFs call
+
+    @return FALSE if another FatFs call has it
+*/
+/**************************************************************************/
+BOOL ff_req_grant(_SYNC_t sobj)
+{
+  BOOL granted = FALSE;
+
+  __disable_irq();
+  if (!ffSyncLocked[sobj])
+  {
+    ffSyncLocked[sobj] = 1;
+    granted = TRUE;
+  }
+  __enable_irq();
+
+  return granted;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Gives the volume back at the end of a FatFs call
+*/
+/**************************************************************************/
+void ff_rel_grant(_SYNC_t sobj)
+{
+  ffSyncLocked[sobj] = 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Lets one other task use the card between two sectors of a
+            long FatFs call.  The file system is consistent at that
+            point: the sector window is checked again before it's used,
+            and everything else that changes belongs to the caller's
+            file object.
+*/
+/**************************************************************************/
+void ff_yield(FATFS *fs)
+{
+  ff_rel_grant(fs->sobj);
+  schedYield();
+  ff_req_grant(fs->sobj);
+}
+#endif
+
+#endif
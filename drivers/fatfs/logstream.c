@@ -0,0 +1,229 @@
+/**************************************************************************/
+/*! 
+    @file     logstream.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Contiguous, pre-erased log files for streaming data to
+              an SD card
+
+    @section DESCRIPTION
+
+    Appending to a file with f_write means a FAT and directory update
+    every time a new cluster is needed, and the card has to erase each
+    block before it can be written, which can stall the card for tens
+    of milliseconds at a time.
+
+    logStreamOpen() creates a file with a single contiguous cluster
+    chain, erases the whole area on the card in one go (CMD32/33/38)
+    and then opens a raw multi-block write (ACMD23 + CMD25) at the
+    first sector of the file.  Each call to logStreamWrite() sends
+    exactly one 512 byte block straight to the next sector without
+    touching the FAT.  The file size is only fixed up in
+    logStreamClose(), where any unused preallocated clusters are also
+    released.
+
+    @note   The SD card stays selected while a log file is open, so
+            nothing else can use the SD card (or SSP0) until
+            logStreamClose() is called.  If power is lost before the
+            file is closed, the file will have the full preallocated
+            size and the data written so far.
+
+    @section Example
+
+    @code 
+
+    #include "drivers/fatfs/logstream.h"
+
+    uint8_t block[LOGSTREAM_BLOCKSIZE];
+
+    // Reserve 2048 blocks (1MB) for the log
+    if (logStreamOpen("/log.bin", 2048) == LOGSTREAM_ERROR_NONE)
+    {
+      while (logStreamBlocksWritten() < 2048)
+      {
+        // ... fill block with samples ...
+        if (logStreamWrite(block)) break;
+      }
+      logStreamClose();
+    }
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "logstream.h"
+
+#if defined CFG_SDCARD && defined CFG_SDCARD_READONLY && CFG_SDCARD_READONLY == 0
+
+#include "drivers/fatfs/diskio.h"
+#include "drivers/fatfs/ff.h"
+#include "drivers/fatfs/ffsync.h"
+
+static FIL      logStreamFile;
+static bool     logStreamIsOpen = false;
+static uint32_t logStreamBlocks;        // Number of blocks reserved
+static uint32_t logStreamWritten;       // Number of blocks written so far
+
+/**************************************************************************/
+/*!
+    @brief  Creates a new log file with a contiguous, pre-erased block
+            of 'blocks' sectors and prepares it for streaming.  Any
+            existing file with the same name is overwritten.
+
+    @param[in]  filename
+                Full path of the file to create
+    @param[in]  blocks
+                Number of 512 byte blocks to reserve
+*/
+/**************************************************************************/
+logstream_error_t logStreamOpen(const char* filename, uint32_t blocks)
+{
+  FATFS *fs;
+  DWORD range[2];
+  DWORD sector;
+
+  if (logStreamIsOpen) 
+    return LOGSTREAM_ERROR_ALREADYOPEN;
+
+  if (blocks == 0) 
+    return LOGSTREAM_ERROR_NOCONTIGUOUSSPACE;
+
+  // Card not initialised or no disk present
+  if (ffSyncMount() != FR_OK) 
+    return LOGSTREAM_ERROR_SDINITFAIL;
+
+  // Create a file (overwriting any existing file!)
+  if (f_open(&logStreamFile, filename, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK)
+  {
+    ffSyncUnmount();
+    return LOGSTREAM_ERROR_UNABLETOCREATEFILE;
+  }
+
+  // Allocate a single run of clusters and commit the FAT/directory entry
+  if ((f_expand(&logStreamFile, blocks * LOGSTREAM_BLOCKSIZE) != FR_OK) || 
+      (f_sync(&logStreamFile) != FR_OK))
+  {
+    f_close(&logStreamFile);
+    ffSyncUnmount();
+    return LOGSTREAM_ERROR_NOCONTIGUOUSSPACE;
+  }
+
+  // First sector of the file
+  fs = ffSyncGetFs();
+  sector = fs->database + (logStreamFile.org_clust - 2) * fs->csize;
+
+  // Erase the whole area up front (MMC doesn't support this, which is
+  // harmless since the card will then erase on write as usual)
+  range[0] = sector;
+  range[1] = sector + blocks - 1;
+  disk_ioctl(0, CTRL_ERASE_SECTOR, range);
+
+  // Open a raw multi-block write at the start of the file
+  if (disk_stream_start(0, sector, blocks) != RES_OK)
+  {
+    f_close(&logStreamFile);
+    ffSyncUnmount();
+    return LOGSTREAM_ERROR_WRITEFAIL;
+  }
+
+  logStreamBlocks = blocks;
+  logStreamWritten = 0;
+  logStreamIsOpen = true;
+
+  return LOGSTREAM_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes one 512 byte block to the next sector of the open
+            log file
+
+    @param[in]  block
+                Pointer to LOGSTREAM_BLOCKSIZE bytes of data
+*/
+/**************************************************************************/
+logstream_error_t logStreamWrite(const uint8_t *block)
+{
+  if (!logStreamIsOpen) 
+    return LOGSTREAM_ERROR_NOTOPEN;
+
+  if (logStreamWritten >= logStreamBlocks) 
+    return LOGSTREAM_ERROR_FILEFULL;
+
+  if (disk_stream_write(0, block) != RES_OK)
+    return LOGSTREAM_ERROR_WRITEFAIL;
+
+  logStreamWritten++;
+
+  return LOGSTREAM_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Ends the raw transfer, sets the file size to the number of
+            blocks actually written and releases any unused clusters
+*/
+/**************************************************************************/
+logstream_error_t logStreamClose(void)
+{
+  logstream_error_t error = LOGSTREAM_ERROR_NONE;
+
+  if (!logStreamIsOpen) 
+    return LOGSTREAM_ERROR_NOTOPEN;
+
+  if (disk_stream_stop(0) != RES_OK)
+    error = LOGSTREAM_ERROR_WRITEFAIL;
+
+  // Trim the file down to the data that was written
+  if ((f_lseek(&logStreamFile, logStreamWritten * LOGSTREAM_BLOCKSIZE) != FR_OK) ||
+      (f_truncate(&logStreamFile) != FR_OK))
+    error = LOGSTREAM_ERROR_WRITEFAIL;
+
+  if (f_close(&logStreamFile) != FR_OK)
+    error = LOGSTREAM_ERROR_WRITEFAIL;
+
+  ffSyncUnmount();
+  logStreamIsOpen = false;
+
+  return error;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the number of blocks written to the open log file
+*/
+/**************************************************************************/
+uint32_t logStreamBlocksWritten(void)
+{
+  return logStreamWritten;
+}
+
+#endif  // End of CFG_SDCARD check
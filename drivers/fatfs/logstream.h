@@ -0,0 +1,67 @@
+/**************************************************************************/
+/*! 
+    @file     logstream.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __LOGSTREAM_H__
+#define __LOGSTREAM_H__
+
+#include "projectconfig.h"
+
+#define LOGSTREAM_BLOCKSIZE     (512)   // Bytes per logStreamWrite() call
+
+/**************************************************************************/
+/*!
+    @brief  Error return codes for the streaming log file functions
+*/
+/**************************************************************************/
+typedef enum
+{
+  LOGSTREAM_ERROR_NONE = 0,
+  LOGSTREAM_ERROR_SDINITFAIL = 1,
+  LOGSTREAM_ERROR_UNABLETOCREATEFILE = 2,
+  LOGSTREAM_ERROR_NOCONTIGUOUSSPACE = 3,  /* No free block large enough for the file */
+  LOGSTREAM_ERROR_ALREADYOPEN = 4,
+  LOGSTREAM_ERROR_NOTOPEN = 5,
+  LOGSTREAM_ERROR_FILEFULL = 6,           /* All preallocated blocks have been written */
+  LOGSTREAM_ERROR_WRITEFAIL = 7
+} logstream_error_t;
+
+#if defined CFG_SDCARD && defined CFG_SDCARD_READONLY && CFG_SDCARD_READONLY == 0
+logstream_error_t logStreamOpen(const char* filename, uint32_t blocks);
+logstream_error_t logStreamWrite(const uint8_t *block);
+logstream_error_t logStreamClose(void);
+uint32_t          logStreamBlocksWritten(void);
+#endif
+
+#endif
@@ -1,11 +1,13 @@
 /*-----------------------------------------------------------------------*/
 /* MMCv3/SDv1/SDv2 (in SPI mode) control module  (C)ChaN, 2007           */
 /*-----------------------------------------------------------------------*/
-/* Only rcvr_spi(), xmit_spi(), disk_timerproc() and some macros         */
+/* Only rcvr_spi(), xmit_spi(), disk_socketirq() and some macros         */
 /* are platform dependent.                                               */
 /*-----------------------------------------------------------------------*/
 
 
+#include <string.h>
+
 #include "projectconfig.h"
 #include "diskio.h"
 #include "core/gpio/gpio.h"
@@ -16,6 +18,7 @@
 /* Definitions for MMC/SDC command */
 #define CMD0	(0x40+0)	/* GO_IDLE_STATE */
 #define CMD1	(0x40+1)	/* SEND_OP_COND (MMC) */
+#define CMD6	(0x40+6)	/* SWITCH_FUNC (SDC) */
 #define	ACMD41	(0xC0+41)	/* SEND_OP_COND (SDC) */
 #define CMD8	(0x40+8)	/* SEND_IF_COND */
 #define CMD9	(0x40+9)	/* SEND_CSD */
@@ -29,6 +32,9 @@
 #define	ACMD23	(0xC0+23)	/* SET_WR_BLK_ERASE_COUNT (SDC) */
 #define CMD24	(0x40+24)	/* WRITE_BLOCK */
 #define CMD25	(0x40+25)	/* WRITE_MULTIPLE_BLOCK */
+#define CMD32	(0x40+32)	/* ERASE_WR_BLK_START (SDC) */
+#define CMD33	(0x40+33)	/* ERASE_WR_BLK_END (SDC) */
+#define CMD38	(0x40+38)	/* ERASE */
 #define CMD55	(0x40+55)	/* APP_CMD */
 #define CMD58	(0x40+58)	/* READ_OCR */
 
@@ -52,11 +58,92 @@ static volatile
 DSTATUS Stat = STA_NOINIT;	/* Disk status */
 
 static volatile
-BYTE Timer1, Timer2;	/* 100Hz decrement timer */
+DWORD CdEdge;			/* systick tick of the last card detect edge */
+
+#define SOCKET_SETTLE	20	/* Card detect debounce time (ms) */
+#define SPIN_POLLS		64	/* Busy polls before sleeping between polls */
 
 static
 BYTE CardType;			/* Card type flags */
 
+static
+sspDevice_t SdDev;		/* Bus settings, shared SSP0 (see sspDeviceAcquire) */
+
+#define STREAM_NONE		0
+#define STREAM_WRITE	1	/* disk_stream_start() multi-block write is open */
+#define STREAM_READ		2	/* disk_readstream_start() multi-block read is open */
+#define STREAM_PAUSED	3	/* Write stream stopped for disk_read/disk_write (see stream_pause) */
+
+static
+BYTE Streaming;			/* STREAM_NONE, STREAM_WRITE, STREAM_READ or STREAM_PAUSED */
+
+#if defined CFG_SDCARD_REENTRANT && _READONLY == 0
+static
+DWORD StreamNext;		/* Card address of the next sector of a write stream */
+
+static DRESULT stream_pause (void);
+#endif
+
+static
+WORD StreamLeft;		/* Bytes left in the current block of a read stream */
+
+#if defined CFG_SDCARD_CACHESECTORS && CFG_SDCARD_CACHESECTORS > 0
+#define CACHE_SECTORS	CFG_SDCARD_CACHESECTORS
+
+#define CACHE_EMPTY		0	/* Window holds nothing */
+#define CACHE_READ		1	/* Window holds clean read-ahead data */
+#define CACHE_WRITE		2	/* Window holds dirty write-behind data */
+
+static
+DWORD CacheBuf[CACHE_SECTORS * 128];	/* Sector data (word aligned) */
+
+static
+DWORD CacheBase;		/* First sector held in the window */
+
+static
+DWORD ReadNext;			/* Sector following the last read (sequential detection) */
+
+static
+BYTE CacheCount;		/* Number of sectors held in the window */
+
+static
+BYTE CacheMode;			/* CACHE_EMPTY, CACHE_READ or CACHE_WRITE */
+
+#if _READONLY == 0
+static DRESULT cache_flush (void);
+#endif
+#endif
+
+#if defined CFG_SDCARD_STATS && CFG_SDCARD_STATS == 1
+static
+DSTATS Stats;			/* Latency histograms and error counters (MMC_GET_STATS) */
+
+#define STAT_NOW()			systickGetMicros()
+#define STAT_ADD(cnt, n)	Stats.cnt += (n)
+#define STAT_TIME(cls, t0)	stat_time(cls, t0)
+
+/* Files the time since 't0' under a command class */
+static
+void stat_time (
+	BYTE cls,		/* SDSTAT_CMD17..SDSTAT_BUSY */
+	DWORD t0		/* STAT_NOW() at the start */
+)
+{
+	DWORD us = systickGetMicros() - t0;
+	BYTE b = 0;
+
+
+	while (b < SDSTAT_BUCKETS - 1 && us >= (SDSTAT_BUCKET0_US << b)) b++;
+	if (Stats.hist[cls][b] != 0xFFFF) Stats.hist[cls][b]++;	/* Saturate */
+	Stats.count[cls]++;
+	if (us > Stats.maxUs[cls]) Stats.maxUs[cls] = us;
+}
+#else
+#define STAT_NOW()			0
+#define STAT_ADD(cnt, n)	((void)(n))
+#define STAT_TIME(cls, t0)	((void)(cls), (void)(t0))
+#endif
+
 /**************************************************************************/
 /*! 
     Set SSP clock to slow (400 KHz)
@@ -64,57 +151,19 @@ BYTE CardType;			/* Card type flags */
 /**************************************************************************/
 static void FCLK_SLOW()
 {
-    /* Divide by 10 (SSPCLKDIV also enables to SSP CLK) */
-    SCB_SSP0CLKDIV = SCB_SSP0CLKDIV_DIV10;
-  
-    /* (PCLK / (CPSDVSR * [SCR+1])) = (7,200,000 / (2 x [8 + 1])) = 400 KHz */
-    uint32_t configReg = ( SSP_SSP0CR0_DSS_8BIT     // Data size = 8-bit
-                  | SSP_SSP0CR0_FRF_SPI             // Frame format = SPI
-                  | SSP_SSP0CR0_SCR_8);             // Serial clock rate = 8
-  
-    // Set clock polarity (low between frames)
-    // configReg &= ~SSP_SSP0CR0_CPOL_MASK;    
-    // configReg |= SSP_SSP0CR0_CPOL_LOW;
-
-    // Set edge transition (leading edge)
-    // configReg &= ~SSP_SSP0CR0_CPHA_MASK;
-    // configReg |= SSP_SSP0CR0_CPHA_FIRST;
-  
-    // Assign config values to SSP0CR0
-    SSP_SSP0CR0 = configReg;
-  
-    /* Clock prescale register must be even and at least 2 in master mode */
-    SSP_SSP0CPSR = SSP_SSP0CPSR_CPSDVSR_DIV2;  
+    sspDeviceSetClock(&SdDev, 400000);
 }
 
 /**************************************************************************/
 /*! 
-    Set SSP clock to fast (6.0 MHz)
+    Set SSP clock to the fastest rate that doesn't exceed 'hz' (at most
+    PCLK / 2, 36 MHz at 72 MHz).  The bus manager recomputes the divider
+    when the CPU clock changes.
 */
 /**************************************************************************/
-static void FCLK_FAST()
-{
-    /* Divide by 1 (SSPCLKDIV also enables to SSP CLK) */
-    SCB_SSP0CLKDIV = SCB_SSP0CLKDIV_DIV1;
-  
-    /* (PCLK / (CPSDVSR * [SCR+1])) = (72,000,000 / (2 * [5 + 1])) = 6.0 MHz */
-    uint32_t configReg = ( SSP_SSP0CR0_DSS_8BIT   // Data size = 8-bit
-                  | SSP_SSP0CR0_FRF_SPI           // Frame format = SPI
-                  | SSP_SSP0CR0_SCR_5);           // Serial clock rate = 5
-  
-    // Set clock polarity (low between frames)
-    // configReg &= ~SSP_SSP0CR0_CPOL_MASK;    
-    // configReg |= SSP_SSP0CR0_CPOL_LOW;
-
-    // Set edge transition (leading edge)
-    // configReg &= ~SSP_SSP0CR0_CPHA_MASK;
-    // configReg |= SSP_SSP0CR0_CPHA_FIRST;
-  
-    // Assign config values to SSP0CR0
-    SSP_SSP0CR0 = configReg;
-  
-    /* Clock prescale register must be even and at least 2 in master mode */
-    SSP_SSP0CPSR = SSP_SSP0CPSR_CPSDVSR_DIV2;  
+static void FCLK_FAST(DWORD hz)
+{
+    sspDeviceSetClock(&SdDev, hz);
 }
 
 /*-----------------------------------------------------------------------*/
@@ -151,6 +200,44 @@ BYTE rcvr_spi (void)
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Timeouts  (Platform dependent)                                        */
+/*-----------------------------------------------------------------------*/
+/* Deadlines are taken from the systick counter, so nothing has to run   */
+/* in an interrupt to count them down.                                   */
+
+static
+DWORD deadline (
+	UINT ms			/* Timeout from now */
+)
+{
+	return systickGetTicks() + ms / CFG_SYSTICK_DELAY_IN_MS + 1;
+}
+
+static
+BOOL expired (
+	DWORD tmr		/* Deadline from deadline() */
+)
+{
+	return (int32_t)(systickGetTicks() - tmr) >= 0;
+}
+
+/* Called between polls of a busy card.  Short waits (most of them) are  */
+/* spun out, longer ones sleep until the next interrupt between polls.   */
+
+static
+void poll_wait (
+	UINT *n			/* Polls so far, 0 to start */
+)
+{
+	if (*n < SPIN_POLLS)
+		(*n)++;
+	else
+		__asm volatile ("wfi");
+}
+
+
+
 
 /*-----------------------------------------------------------------------*/
 /* Wait for card ready                                                   */
@@ -160,19 +247,57 @@ static
 BYTE wait_ready (void)
 {
 	BYTE res;
+	DWORD tmr = deadline(500);	/* Wait for ready in timeout of 500ms */
+	DWORD t0 = STAT_NOW();
+	UINT n = 0;
 
 
-	Timer2 = 50;	/* Wait for ready in timeout of 500ms */
 	rcvr_spi();
-	do
+	for (;;) {
 		res = rcvr_spi();
-	while ((res != 0xFF) && Timer2);
+		if (res == 0xFF || expired(tmr)) break;
+		poll_wait(&n);
+	}
+	if (res != 0xFF)
+		STAT_ADD(busyTimeouts, 1);
+	else if (n)						/* Only waits that found the card busy */
+		STAT_TIME(SDSTAT_BUSY, t0);
 
 	return res;
 }
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Wait for the end of a long busy state (erase)                         */
+/*-----------------------------------------------------------------------*/
+
+#if _READONLY == 0
+static
+BOOL wait_busy (
+	BYTE secs		/* Timeout in seconds */
+)
+{
+	DWORD tmr = deadline((UINT)secs * 1000);
+	DWORD t0 = STAT_NOW();
+	UINT n = 0;
+
+
+	do {
+		if (rcvr_spi() == 0xFF) {
+			STAT_TIME(SDSTAT_BUSY, t0);
+			return TRUE;
+		}
+		poll_wait(&n);
+	} while (!expired(tmr));
+	STAT_ADD(busyTimeouts, 1);
+
+	return FALSE;
+}
+#endif
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Deselect the card and release SPI bus                                 */
 /*-----------------------------------------------------------------------*/
@@ -181,7 +306,10 @@ static
 void deselect (void)
 {
 	CS_HIGH();
-	rcvr_spi();
+	if (sspDeviceAcquire(&SdDev)) {	/* One clock to release DO */
+		rcvr_spi();
+		sspDeviceRelease(&SdDev);	/* Deferred requests run here */
+	}
 }
 
 
@@ -193,6 +321,7 @@ void deselect (void)
 static
 BOOL select (void)	/* TRUE:Successful, FALSE:Timeout */
 {
+	if (!sspDeviceAcquire(&SdDev)) return FALSE;	/* Bus is mid-transfer */
 	CS_LOW();
 	if (wait_ready() != 0xFF) {
 		deselect();
@@ -203,6 +332,33 @@ BOOL select (void)	/* TRUE:Successful, FALSE:Timeout */
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Let other SPI devices in between two data blocks                      */
+/*-----------------------------------------------------------------------*/
+/* Multi-block transfers give the bus up at block boundaries when an     */
+/* interrupt has deferred a request (e.g. the radio), so it only waits   */
+/* for the current block rather than the whole transfer.  The card keeps */
+/* its place in the CMD18/CMD25 sequence while it is deselected.         */
+
+static
+BOOL reselect (void)	/* Resume an open multi-block transfer */
+{
+	if (!sspDeviceAcquire(&SdDev)) return FALSE;
+	CS_LOW();
+	return TRUE;
+}
+
+static
+void yield_bus (void)
+{
+	if (sspBusPending()) {
+		deselect();
+		reselect();
+	}
+}
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Power Control  (Platform dependent)                                   */
 /*-----------------------------------------------------------------------*/
@@ -232,19 +388,30 @@ int chk_power(void)		/* Socket power state: 0=off, 1=on */
 /*-----------------------------------------------------------------------*/
 
 static
-BOOL rcvr_datablock (
-	BYTE *buff,			/* Data buffer to store received data */
-	UINT btr			/* Byte count (must be multiple of 4) */
-)
+BOOL rcvr_token (void)
 {
 	BYTE token;
+	DWORD tmr = deadline(200);	/* Wait for data packet in timeout of 200ms */
+	UINT n = 0;
 
 
-	Timer1 = 20;
-	do {							/* Wait for data packet in timeout of 200ms */
+	for (;;) {
 		token = rcvr_spi();
-	} while ((token == 0xFF) && Timer1);
-	if(token != 0xFE) return FALSE;	/* If not valid data token, retutn with error */
+		if (token != 0xFF || expired(tmr)) break;
+		poll_wait(&n);
+	}
+	if (token != 0xFE) STAT_ADD(tokenErrors, 1);
+
+	return (token == 0xFE) ? TRUE : FALSE;	/* Valid data token? */
+}
+
+static
+BOOL rcvr_datablock (
+	BYTE *buff,			/* Data buffer to store received data */
+	UINT btr			/* Byte count (must be multiple of 4) */
+)
+{
+	if (!rcvr_token()) return FALSE;	/* If not valid data token, retutn with error */
 
 	do {							/* Receive the data block into buffer */
 		rcvr_spi_m(buff++);
@@ -286,8 +453,13 @@ BOOL xmit_datablock (
 		xmit_spi(0xFF);					/* CRC (Dummy) */
 		xmit_spi(0xFF);
 		resp = rcvr_spi();				/* Reveive data response */
-		if ((resp & 0x1F) != 0x05)		/* If not accepted, return with error */
+		if ((resp & 0x1F) != 0x05) {	/* If not accepted, return with error */
+			if ((resp & 0x1F) == 0x0B)
+				STAT_ADD(crcErrors, 1);		/* Rejected, CRC error */
+			else
+				STAT_ADD(writeErrors, 1);	/* Rejected, write error (or no response) */
 			return FALSE;
+		}
 	}
 
 	return TRUE;
@@ -349,6 +521,66 @@ BYTE send_cmd (
 ---------------------------------------------------------------------------*/
 
 
+/*-----------------------------------------------------------------------*/
+/* Pick the SPI clock for an initialised card                            */
+/*-----------------------------------------------------------------------*/
+/* The card's limit comes from TRAN_SPEED in the CSD.  SDv2 cards that   */
+/* support the switch command class are moved to high speed (50 MHz)     */
+/* first if CFG_SDCARD_HIGHSPEED is defined.  The result is capped at    */
+/* CFG_SDCARD_MAXCLOCK, which is what the board wiring allows.           */
+
+static
+DWORD neg_clock (void)
+{
+	static const BYTE tv[16] = { 0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80 };	/* TRAN_SPEED time value x 10 */
+	static const DWORD tu[4] = { 10000, 100000, 1000000, 10000000 };	/* TRAN_SPEED rate unit / 10 (Hz) */
+	BYTE csd[16];
+	DWORD hz = 0;
+
+
+	if (send_cmd(CMD9, 0) == 0 && rcvr_datablock(csd, 16)) {	/* Read CSD */
+#ifdef CFG_SDCARD_HIGHSPEED
+		BYTE sw[64];
+
+		if ((CardType & CT_SD2) && (csd[4] & 0x40)						/* CCC class 10 (switch) */
+			&& send_cmd(CMD6, 0x80FFFFF1) == 0 && rcvr_datablock(sw, 64)	/* Set function group 1 to high speed */
+			&& (sw[16] & 0x0F) == 1) {									/* Group 1 switched */
+			if (!(send_cmd(CMD9, 0) == 0 && rcvr_datablock(csd, 16)))	/* TRAN_SPEED changes to 50 MHz */
+				csd[3] = 0x5A;
+		}
+#endif
+		if ((csd[3] & 7) < 4)
+			hz = tv[(csd[3] >> 3) & 15] * tu[csd[3] & 7];
+	}
+	deselect();
+
+	if (!hz) hz = 6000000;		/* CSD unreadable, use a safe rate */
+	if (hz > CFG_SDCARD_MAXCLOCK) hz = CFG_SDCARD_MAXCLOCK;
+
+	return hz;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Socket status  (Platform dependent)                                   */
+/*-----------------------------------------------------------------------*/
+/* A removal is flagged straight away by disk_socketirq().  An insertion */
+/* only counts once the card detect pin has been steady for              */
+/* SOCKET_SETTLE ms, which is checked when the status is asked for.      */
+
+static
+void chk_socket (void)
+{
+	if (!gpioGetValue(CFG_SDCARD_CDPORT, CFG_SDCARD_CDPIN))	/* (Socket empty) */
+		Stat |= (STA_NODISK | STA_NOINIT);
+	else if (expired(CdEdge + SOCKET_SETTLE / CFG_SYSTICK_DELAY_IN_MS + 1))	/* (Card inserted, contacts settled) */
+		Stat &= ~STA_NODISK;
+	/* write protect NOT supported */
+}
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Initialize Disk Drive                                                 */
 /*-----------------------------------------------------------------------*/
@@ -358,32 +590,46 @@ DSTATUS disk_initialize (
 )
 {
 	BYTE n, cmd, ty, ocr[4];
+	DWORD tmr;
 
         // Init SSP (clock low between frames, transition on leading edge)      
         sspInit(0, sspClockPolarity_Low, sspClockPhase_RisingEdge); 
+        sspDeviceRegister(&SdDev, 400000, sspClockPolarity_Low, sspClockPhase_RisingEdge);
     
         gpioSetDir( SSP0_CSPORT, SSP0_CSPIN, gpioDirection_Output ); /* CS */
         gpioSetDir( CFG_SDCARD_CDPORT, CFG_SDCARD_CDPIN, gpioDirection_Input ); /* Card Detect */
         gpioSetPullup (&IOCON_PIO3_0, gpioPullupMode_Inactive);
 
-        // Wait 20ms for card detect to stabilise
-        systickDelay(20);        
+        // Watch both card detect edges, and give the pin time to settle
+        // the first time round
+        CdEdge = systickGetTicks();
+        gpioAttachInterrupt( CFG_SDCARD_CDPORT, CFG_SDCARD_CDPIN, gpioInterruptSense_Edge, gpioInterruptEdge_Double, gpioInterruptEvent_ActiveHigh, disk_socketirq );
+        tmr = deadline(SOCKET_SETTLE);
+        while (!expired(tmr)) __asm volatile ("wfi");
+        chk_socket();
 
 	if (drv) return STA_NOINIT;			/* Supports only single drive */
 	if (Stat & STA_NODISK) return Stat;	/* No card in the socket */
 
+#ifdef CACHE_SECTORS
+	CacheMode = CACHE_EMPTY;			/* Anything cached belongs to the previous card */
+	ReadNext = 0;
+#endif
+	Streaming = STREAM_NONE;
+
 	power_on();							/* Force socket power on */
 	FCLK_SLOW();
+	if (!sspDeviceAcquire(&SdDev)) return Stat;
 	for (n = 100; n; n--) rcvr_spi();	/* 80 dummy clocks */
 
 	ty = 0;
 	if (send_cmd(CMD0, 0) == 1) {			/* Enter Idle state */
-		Timer1 = 100;						/* Initialization timeout of 1000 msec */
+		tmr = deadline(1000);				/* Initialization timeout of 1000 msec */
 		if (send_cmd(CMD8, 0x1AA) == 1) {	/* SDHC */
 			for (n = 0; n < 4; n++) ocr[n] = rcvr_spi();		/* Get trailing return value of R7 resp */
 			if (ocr[2] == 0x01 && ocr[3] == 0xAA) {				/* The card can work at vdd range of 2.7-3.6V */
-				while (Timer1 && send_cmd(ACMD41, 1UL << 30));	/* Wait for leaving idle state (ACMD41 with HCS bit) */
-				if (Timer1 && send_cmd(CMD58, 0) == 0) {		/* Check CCS bit in the OCR */
+				while (!expired(tmr) && send_cmd(ACMD41, 1UL << 30));	/* Wait for leaving idle state (ACMD41 with HCS bit) */
+				if (!expired(tmr) && send_cmd(CMD58, 0) == 0) {		/* Check CCS bit in the OCR */
 					for (n = 0; n < 4; n++) ocr[n] = rcvr_spi();
 					ty = (ocr[0] & 0x40) ? CT_SD2 | CT_BLOCK : CT_SD2;	/* SDv2 */
 				}
@@ -394,8 +640,8 @@ DSTATUS disk_initialize (
 			} else {
 				ty = CT_MMC; cmd = CMD1;	/* MMCv3 */
 			}
-			while (Timer1 && send_cmd(cmd, 0));			/* Wait for leaving idle state */
-			if (!Timer1 || send_cmd(CMD16, 512) != 0)	/* Set R/W block length to 512 */
+			while (!expired(tmr) && send_cmd(cmd, 0));			/* Wait for leaving idle state */
+			if (expired(tmr) || send_cmd(CMD16, 512) != 0)	/* Set R/W block length to 512 */
 				ty = 0;
 		}
 	}
@@ -404,7 +650,7 @@ DSTATUS disk_initialize (
 
 	if (ty) {			/* Initialization succeded */
 		Stat &= ~STA_NOINIT;		/* Clear STA_NOINIT */
-		FCLK_FAST();
+		FCLK_FAST(neg_clock());
 	} else {			/* Initialization failed */
 		power_off();
 	}
@@ -423,6 +669,7 @@ DSTATUS disk_status (
 )
 {
 	if (drv) return STA_NOINIT;		/* Supports only single drive */
+	chk_socket();
 	return Stat;
 }
 
@@ -432,21 +679,24 @@ DSTATUS disk_status (
 /* Read Sector(s)                                                        */
 /*-----------------------------------------------------------------------*/
 
-DRESULT disk_read (
-	BYTE drv,			/* Physical drive nmuber (0) */
+static
+DRESULT mmc_read (
 	BYTE *buff,			/* Pointer to the data buffer to store read data */
 	DWORD sector,		/* Start sector number (LBA) */
 	BYTE count			/* Sector count (1..255) */
 )
 {
-	if (drv || !count) return RES_PARERR;
-	if (Stat & STA_NOINIT) return RES_NOTRDY;
+	BYTE cls = (count == 1) ? SDSTAT_CMD17 : SDSTAT_CMD18;
+	BYTE total = count;
+	DWORD t0 = STAT_NOW();
+
 
 	if (!(CardType & CT_BLOCK)) sector *= 512;	/* Convert to byte address if needed */
 
 	if (count == 1) {	/* Single block read */
-		if ((send_cmd(CMD17, sector) == 0)	/* READ_SINGLE_BLOCK */
-			&& rcvr_datablock(buff, 512))
+		if (send_cmd(CMD17, sector) != 0)	/* READ_SINGLE_BLOCK */
+			STAT_ADD(cmdErrors, 1);
+		else if (rcvr_datablock(buff, 512))
 			count = 0;
 	}
 	else {				/* Multiple block read */
@@ -454,15 +704,74 @@ DRESULT disk_read (
 			do {
 				if (!rcvr_datablock(buff, 512)) break;
 				buff += 512;
+				if (count > 1) yield_bus();
 			} while (--count);
 			send_cmd(CMD12, 0);				/* STOP_TRANSMISSION */
 		}
+		else STAT_ADD(cmdErrors, 1);
 	}
 	deselect();
+	STAT_ADD(bytesRead, (DWORD)(total - count) * 512);
+	if (!count) STAT_TIME(cls, t0);
 
 	return count ? RES_ERROR : RES_OK;
 }
 
+DRESULT disk_read (
+	BYTE drv,			/* Physical drive nmuber (0) */
+	BYTE *buff,			/* Pointer to the data buffer to store read data */
+	DWORD sector,		/* Start sector number (LBA) */
+	BYTE count			/* Sector count (1..255) */
+)
+{
+	if (drv || !count) return RES_PARERR;
+	if (Stat & STA_NOINIT) return RES_NOTRDY;
+#if defined CFG_SDCARD_REENTRANT && _READONLY == 0
+	if (Streaming == STREAM_READ) return RES_NOTRDY;	/* Card is busy with a raw stream */
+	if (stream_pause() != RES_OK) return RES_ERROR;	/* A write stream is reopened later */
+#else
+	if (Streaming) return RES_NOTRDY;	/* Card is busy with a raw stream */
+#endif
+
+#ifdef CACHE_SECTORS
+	BOOL seq = (sector == ReadNext);	/* Continues the previous read? */
+	ReadNext = sector + count;
+
+	/* Whole request is in the window (read-ahead or not yet flushed data) */
+	if (CacheMode != CACHE_EMPTY
+		&& sector >= CacheBase && sector + count <= CacheBase + CacheCount) {
+		memcpy(buff, (BYTE*)CacheBuf + (sector - CacheBase) * 512, (UINT)count * 512);
+		return RES_OK;
+	}
+
+#if _READONLY == 0
+	if (CacheMode == CACHE_WRITE) {
+		/* Pending writes must reach the card before they can be read back,
+		   otherwise leave the write-behind window alone */
+		if (sector >= CacheBase + CacheCount || sector + count <= CacheBase)
+			return mmc_read(buff, sector, count);
+		if (cache_flush() != RES_OK) return RES_ERROR;
+	}
+#endif
+
+	/* Read ahead on sequential access only, large requests are already
+	   a single multi-block read */
+	if (seq && count < CACHE_SECTORS) {
+		CacheMode = CACHE_EMPTY;
+		if (mmc_read((BYTE*)CacheBuf, sector, CACHE_SECTORS) == RES_OK) {
+			CacheBase = sector;
+			CacheCount = CACHE_SECTORS;
+			CacheMode = CACHE_READ;
+			memcpy(buff, CacheBuf, (UINT)count * 512);
+			return RES_OK;
+		}
+		/* Window may run past the end of the card, fall back to a plain read */
+	}
+#endif
+
+	return mmc_read(buff, sector, count);
+}
+
 
 
 /*-----------------------------------------------------------------------*/
@@ -470,22 +779,24 @@ DRESULT disk_read (
 /*-----------------------------------------------------------------------*/
 
 #if _READONLY == 0
-DRESULT disk_write (
-	BYTE drv,			/* Physical drive nmuber (0) */
+static
+DRESULT mmc_write (
 	const BYTE *buff,	/* Pointer to the data to be written */
 	DWORD sector,		/* Start sector number (LBA) */
 	BYTE count			/* Sector count (1..255) */
 )
 {
-	if (drv || !count) return RES_PARERR;
-	if (Stat & STA_NOINIT) return RES_NOTRDY;
-	if (Stat & STA_PROTECT) return RES_WRPRT;
+	BYTE cls = (count == 1) ? SDSTAT_CMD24 : SDSTAT_CMD25;
+	BYTE total = count;
+	DWORD t0 = STAT_NOW();
+
 
 	if (!(CardType & CT_BLOCK)) sector *= 512;	/* Convert to byte address if needed */
 
 	if (count == 1) {	/* Single block write */
-		if ((send_cmd(CMD24, sector) == 0)	/* WRITE_BLOCK */
-			&& xmit_datablock(buff, 0xFE))
+		if (send_cmd(CMD24, sector) != 0)	/* WRITE_BLOCK */
+			STAT_ADD(cmdErrors, 1);
+		else if (xmit_datablock(buff, 0xFE))
 			count = 0;
 	}
 	else {				/* Multiple block write */
@@ -494,19 +805,303 @@ DRESULT disk_write (
 			do {
 				if (!xmit_datablock(buff, 0xFC)) break;
 				buff += 512;
+				if (count > 1) yield_bus();
 			} while (--count);
 			if (!xmit_datablock(0, 0xFD))	/* STOP_TRAN token */
 				count = 1;
 		}
+		else STAT_ADD(cmdErrors, 1);
 	}
 	deselect();
+	STAT_ADD(bytesWritten, (DWORD)(total - count) * 512);
+	if (!count) STAT_TIME(cls, t0);
 
 	return count ? RES_ERROR : RES_OK;
 }
+
+DRESULT disk_write (
+	BYTE drv,			/* Physical drive nmuber (0) */
+	const BYTE *buff,	/* Pointer to the data to be written */
+	DWORD sector,		/* Start sector number (LBA) */
+	BYTE count			/* Sector count (1..255) */
+)
+{
+	if (drv || !count) return RES_PARERR;
+	if (Stat & STA_NOINIT) return RES_NOTRDY;
+	if (Stat & STA_PROTECT) return RES_WRPRT;
+#ifdef CFG_SDCARD_REENTRANT
+	if (Streaming == STREAM_READ) return RES_NOTRDY;	/* Card is busy with a raw stream */
+	if (stream_pause() != RES_OK) return RES_ERROR;	/* A write stream is reopened later */
+#else
+	if (Streaming) return RES_NOTRDY;	/* Card is busy with a raw stream */
+#endif
+
+#ifdef CACHE_SECTORS
+	if (CacheMode == CACHE_WRITE) {
+		/* Rewrite of sectors that are still in the window */
+		if (sector >= CacheBase && sector + count <= CacheBase + CacheCount) {
+			memcpy((BYTE*)CacheBuf + (sector - CacheBase) * 512, buff, (UINT)count * 512);
+			return RES_OK;
+		}
+		/* Sequential write that still fits in the window */
+		if (sector == CacheBase + CacheCount && CacheCount + count <= CACHE_SECTORS) {
+			memcpy((BYTE*)CacheBuf + (UINT)CacheCount * 512, buff, (UINT)count * 512);
+			CacheCount += count;
+			return RES_OK;
+		}
+		if (cache_flush() != RES_OK) return RES_ERROR;
+	}
+
+	/* Any read-ahead data is replaced by the new write-behind window */
+	CacheMode = CACHE_EMPTY;
+	if (count < CACHE_SECTORS) {
+		memcpy(CacheBuf, buff, (UINT)count * 512);
+		CacheBase = sector;
+		CacheCount = count;
+		CacheMode = CACHE_WRITE;
+		return RES_OK;
+	}
+#endif
+
+	return mmc_write(buff, sector, count);
+}
+
+#ifdef CACHE_SECTORS
+/*-----------------------------------------------------------------------*/
+/* Flush the write-behind window to the card as one multi-block write    */
+/*-----------------------------------------------------------------------*/
+
+static
+DRESULT cache_flush (void)
+{
+	if (CacheMode == CACHE_WRITE) {
+		if (mmc_write((const BYTE*)CacheBuf, CacheBase, CacheCount) != RES_OK)
+			return RES_ERROR;		/* Keep the data so that a later sync can retry */
+		CacheMode = CACHE_EMPTY;
+	}
+
+	return RES_OK;
+}
+#endif
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Raw Multi-block Write Stream                                          */
+/*-----------------------------------------------------------------------*/
+/* Opens a CMD25 multi-block write that is kept open between calls so    */
+/* sectors can be streamed to consecutive LBAs without any per-sector    */
+/* command overhead.  The card is deselected between sectors so other    */
+/* SPI devices can use the bus, and disk_read/disk_write return          */
+/* RES_NOTRDY until disk_stream_stop().  With CFG_SDCARD_REENTRANT they  */
+/* stop the stream instead (stream_pause), and the next                  */
+/* disk_stream_write reopens it at the sector it was going to write, so  */
+/* FatFs can be used on the card while a log is being streamed.          */
+
+DRESULT disk_stream_start (
+	BYTE drv,			/* Physical drive nmuber (0) */
+	DWORD sector,		/* Start sector number (LBA) */
+	DWORD count			/* Number of sectors that will be written (pre-erase hint) */
+)
+{
+	if (drv) return RES_PARERR;
+	if (Stat & STA_NOINIT) return RES_NOTRDY;
+	if (Stat & STA_PROTECT) return RES_WRPRT;
+	if (Streaming) return RES_NOTRDY;
+
+#ifdef CACHE_SECTORS
+	if (cache_flush() != RES_OK) return RES_ERROR;
+	CacheMode = CACHE_EMPTY;			/* Cached data would go stale */
+#endif
+
+	if (!(CardType & CT_BLOCK)) sector *= 512;	/* Convert to byte address if needed */
+
+	if (CardType & CT_SDC) send_cmd(ACMD23, count);	/* SET_WR_BLK_ERASE_COUNT */
+	if (send_cmd(CMD25, sector) != 0) {	/* WRITE_MULTIPLE_BLOCK */
+		deselect();
+		STAT_ADD(cmdErrors, 1);
+		return RES_ERROR;
+	}
+	deselect();
+	Streaming = STREAM_WRITE;
+#ifdef CFG_SDCARD_REENTRANT
+	StreamNext = sector;
+#endif
+
+	return RES_OK;
+}
+
+#ifdef CFG_SDCARD_REENTRANT
+/* Ends the CMD25 of an open write stream so that the card can serve     */
+/* another request.  The stream is left STREAM_PAUSED.                   */
+static
+DRESULT stream_pause (void)
+{
+	DRESULT res;
+
+
+	if (Streaming != STREAM_WRITE) return RES_OK;
+	if (!reselect()) return RES_NOTRDY;
+
+	res = xmit_datablock(0, 0xFD) ? RES_OK : RES_ERROR;	/* STOP_TRAN token */
+	deselect();
+	Streaming = STREAM_PAUSED;
+
+	return res;
+}
+#endif
+
+DRESULT disk_stream_write (
+	BYTE drv,			/* Physical drive nmuber (0) */
+	const BYTE *buff	/* 512 bytes of data to be written */
+)
+{
+	if (drv) return RES_PARERR;
+#ifdef CFG_SDCARD_REENTRANT
+	if (Streaming == STREAM_PAUSED) {	/* Reopen where it was stopped */
+		if (send_cmd(CMD25, StreamNext) != 0) {
+			deselect();
+			return RES_ERROR;
+		}
+		deselect();
+		Streaming = STREAM_WRITE;
+	}
+#endif
+	if (Streaming != STREAM_WRITE) return RES_NOTRDY;
+	if (!reselect()) return RES_NOTRDY;
+
+	DWORD t0 = STAT_NOW();
+	if (!xmit_datablock(buff, 0xFC)) {	/* Data rejected, end the stream */
+		disk_stream_stop(drv);
+		return RES_ERROR;
+	}
+	deselect();
+	STAT_ADD(bytesWritten, 512);
+	STAT_TIME(SDSTAT_STREAM, t0);
+#ifdef CFG_SDCARD_REENTRANT
+	StreamNext += (CardType & CT_BLOCK) ? 1 : 512;
+#endif
+
+	return RES_OK;
+}
+
+DRESULT disk_stream_stop (
+	BYTE drv			/* Physical drive nmuber (0) */
+)
+{
+	DRESULT res;
+
+
+	if (drv) return RES_PARERR;
+#ifdef CFG_SDCARD_REENTRANT
+	if (Streaming == STREAM_PAUSED) {	/* Already stopped by stream_pause */
+		Streaming = STREAM_NONE;
+		return RES_OK;
+	}
+#endif
+	if (Streaming != STREAM_WRITE) return RES_NOTRDY;
+	if (!reselect()) return RES_NOTRDY;
+
+	res = xmit_datablock(0, 0xFD) ? RES_OK : RES_ERROR;	/* STOP_TRAN token */
+	deselect();
+	Streaming = STREAM_NONE;
+
+	return res;
+}
 #endif /* _READONLY == 0 */
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Raw Multi-block Read Stream                                           */
+/*-----------------------------------------------------------------------*/
+/* Opens a CMD18 multi-block read that the caller drains in pieces of    */
+/* any multiple of 4 bytes, so a sector can be passed on (e.g. as 64     */
+/* byte USB packets) while the rest of it is still coming off the card.  */
+/* CMD12 is only sent by disk_readstream_stop(), and disk_read/          */
+/* disk_write return RES_NOTRDY in the meantime.  The read-ahead window  */
+/* is bypassed.  The card is deselected between sectors only, so the bus */
+/* is held while a sector is part way through.                           */
+
+DRESULT disk_readstream_start (
+	BYTE drv,			/* Physical drive nmuber (0) */
+	DWORD sector		/* Start sector number (LBA) */
+)
+{
+	if (drv) return RES_PARERR;
+	if (Stat & STA_NOINIT) return RES_NOTRDY;
+	if (Streaming) return RES_NOTRDY;
+
+#if defined CACHE_SECTORS && _READONLY == 0
+	if (cache_flush() != RES_OK) return RES_ERROR;	/* Pending writes first */
+#endif
+
+	if (!(CardType & CT_BLOCK)) sector *= 512;	/* Convert to byte address if needed */
+
+	if (send_cmd(CMD18, sector) != 0) {	/* READ_MULTIPLE_BLOCK */
+		deselect();
+		STAT_ADD(cmdErrors, 1);
+		return RES_ERROR;
+	}
+	deselect();
+	Streaming = STREAM_READ;
+	StreamLeft = 0;
+
+	return RES_OK;
+}
+
+DRESULT disk_readstream_read (
+	BYTE drv,			/* Physical drive nmuber (0) */
+	BYTE *buff,			/* Data buffer to store received data */
+	UINT btr			/* Byte count (multiple of 4, must not cross a sector) */
+)
+{
+	if (drv || !btr || (btr & 3)) return RES_PARERR;
+	if (Streaming != STREAM_READ) return RES_NOTRDY;
+
+	if (!StreamLeft) {					/* Start of the next sector */
+		if (!reselect()) return RES_NOTRDY;
+		if (!rcvr_token()) {			/* No data, end the stream */
+			disk_readstream_stop(drv);
+			return RES_ERROR;
+		}
+		StreamLeft = 512;
+	}
+	if (btr > StreamLeft) return RES_PARERR;
+
+	StreamLeft -= btr;
+	STAT_ADD(bytesRead, btr);
+	do {
+		rcvr_spi_m(buff++);
+		rcvr_spi_m(buff++);
+		rcvr_spi_m(buff++);
+		rcvr_spi_m(buff++);
+	} while (btr -= 4);
+	if (!StreamLeft) {					/* Discard CRC */
+		rcvr_spi();
+		rcvr_spi();
+		deselect();
+	}
+
+	return RES_OK;
+}
+
+DRESULT disk_readstream_stop (
+	BYTE drv			/* Physical drive nmuber (0) */
+)
+{
+	if (drv) return RES_PARERR;
+	if (Streaming != STREAM_READ) return RES_NOTRDY;
+
+	send_cmd(CMD12, 0);					/* STOP_TRANSMISSION */
+	deselect();
+	Streaming = STREAM_NONE;
+
+	return RES_OK;
+}
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Miscellaneous Functions                                               */
 /*-----------------------------------------------------------------------*/
@@ -521,6 +1116,7 @@ DRESULT disk_ioctl (
 	DRESULT res;
 	BYTE n, csd[16], *ptr = buff;
 	WORD csize;
+	DWORD st, ed;
 
 
 	if (drv) return RES_PARERR;
@@ -530,6 +1126,9 @@ DRESULT disk_ioctl (
 	if (ctrl == CTRL_POWER) {
 		switch (*ptr) {
 		case 0:		/* Sub control code == 0 (POWER_OFF) */
+#if defined CACHE_SECTORS && _READONLY == 0
+			if (cache_flush() != RES_OK) break;
+#endif
 			if (chk_power())
 				power_off();		/* Power off */
 			res = RES_OK;
@@ -546,11 +1145,30 @@ DRESULT disk_ioctl (
 			res = RES_PARERR;
 		}
 	}
+#if defined CFG_SDCARD_STATS && CFG_SDCARD_STATS == 1
+	else if (ctrl == MMC_GET_STATS) {	/* Copy the statistics (DSTATS), works without a card */
+		memcpy(buff, &Stats, sizeof(Stats));
+		res = RES_OK;
+	}
+	else if (ctrl == MMC_CLEAR_STATS) {
+		memset(&Stats, 0, sizeof(Stats));
+		res = RES_OK;
+	}
+#endif
 	else {
 		if (Stat & STA_NOINIT) return RES_NOTRDY;
+#if defined CFG_SDCARD_REENTRANT && _READONLY == 0
+		if (Streaming == STREAM_READ) return RES_NOTRDY;
+		if (stream_pause() != RES_OK) return RES_ERROR;
+#else
+		if (Streaming) return RES_NOTRDY;
+#endif
 
 		switch (ctrl) {
 		case CTRL_SYNC :		/* Make sure that no pending write process. Do not remove this or written sector might not left updated. */
+#if defined CACHE_SECTORS && _READONLY == 0
+			if (cache_flush() != RES_OK) break;
+#endif
 			if (select()) {
 				res = RES_OK;
 				deselect();
@@ -598,6 +1216,28 @@ DRESULT disk_ioctl (
 			}
 			break;
 
+#if _READONLY == 0
+		case CTRL_ERASE_SECTOR :	/* Erase a block of sectors (DWORD[2]: start, end) */
+			if (!(CardType & CT_SDC)) break;	/* CMD32/33 are SDC only */
+			st = ((DWORD*)buff)[0];
+			ed = ((DWORD*)buff)[1];
+			if (ed < st) { res = RES_PARERR; break; }
+#ifdef CACHE_SECTORS
+			if (cache_flush() != RES_OK) break;
+			CacheMode = CACHE_EMPTY;
+#endif
+			if (!(CardType & CT_BLOCK)) { st *= 512; ed *= 512; }	/* Convert to byte address if needed */
+			if (send_cmd(CMD32, st) == 0 && send_cmd(CMD33, ed) == 0	/* ERASE_WR_BLK_START/END */
+				&& send_cmd(CMD38, 0) == 0 && wait_busy(30))			/* ERASE (can take a while) */
+				res = RES_OK;
+			break;
+#endif
+
+		case MMC_GET_CLOCK :	/* Get the negotiated SPI clock in Hz (DWORD) */
+			*(DWORD*)buff = (Stat & STA_NOINIT) ? 0 : SdDev.clock;
+			res = RES_OK;
+			break;
+
 		case MMC_GET_TYPE :		/* Get card type flags (1 byte) */
 			*ptr = CardType;
 			res = RES_OK;
@@ -643,42 +1283,13 @@ DRESULT disk_ioctl (
 
 
 /*-----------------------------------------------------------------------*/
-/* Device Timer Interrupt Procedure  (Platform dependent)                */
+/* Card Detect Interrupt Procedure  (Platform dependent)                 */
 /*-----------------------------------------------------------------------*/
-/* This function must be called in period of 10ms                        */
-/* Called from SysTick_Handler in systick.c                              */
+/* Called on both card detect edges from the PIOINTn_IRQHandler in gpio.c */
 
-void disk_timerproc (void)
+void disk_socketirq (void)
 {
-  static BYTE pv;
-  BYTE n;
-  BYTE s;
-
-  n = Timer1;						/* 100Hz decrement timer */
-  if (n) Timer1 = --n;
-  n = Timer2;
-  if (n) Timer2 = --n;
-
-  n = pv;
-  pv = 0;
-  /* Sample card detect pin */
-  pv = gpioGetValue(CFG_SDCARD_CDPORT, CFG_SDCARD_CDPIN);
-    
-  /* Have contacts stabled? */
-  if (n == pv) 
-  {
-    s = Stat;
-      
-    /* write protect NOT supported */
-      
-    /* check card detect */
-    if (!pv)                            /* (Socket empty) */
-      s |= (STA_NODISK | STA_NOINIT);
-    else				/* (Card inserted) */
-      s &= ~STA_NODISK;
-    
-    Stat = s;
-  }
+	CdEdge = systickGetTicks();		/* Restart the settle time */
+	if (!gpioGetValue(CFG_SDCARD_CDPORT, CFG_SDCARD_CDPIN))	/* (Socket empty) */
+		Stat |= (STA_NODISK | STA_NOINIT);
 }
-
-
@@ -46,30 +46,47 @@
 
 #include "core/gpio/gpio.h"
 #include "core/systick/systick.h"
+#include "core/delay/delay.h"
 #include "drivers/lcd/smallfonts.h"
 
-void ssd1306SendByte(uint8_t byte);
-
-#define CMD(c)        do { gpioSetValue( SSD1306_CS_PORT, SSD1306_CS_PIN, 1 ); \
-                           gpioSetValue( SSD1306_DC_PORT, SSD1306_DC_PIN, 0 ); \
-                           gpioSetValue( SSD1306_CS_PORT, SSD1306_CS_PIN, 0 ); \
-                           ssd1306SendByte( c ); \
-                           gpioSetValue( SSD1306_CS_PORT, SSD1306_CS_PIN, 1 ); \
-                         } while (0);
-#define DATA(c)       do { gpioSetValue( SSD1306_CS_PORT, SSD1306_CS_PIN, 1 ); \
-                           gpioSetValue( SSD1306_DC_PORT, SSD1306_DC_PIN, 1 ); \
-                           gpioSetValue( SSD1306_CS_PORT, SSD1306_CS_PIN, 0 ); \
-                           ssd1306SendByte( c ); \
-                           gpioSetValue( SSD1306_CS_PORT, SSD1306_CS_PIN, 1 ); \
-                         } while (0);
-#define DELAY(mS)     do { systickDelay( mS / CFG_SYSTICK_DELAY_IN_MS ); } while(0);
+#if defined CFG_SSD1306_SSP && CFG_SSD1306_SSP == 1
+  #include "core/ssp/ssp.h"
+  #define SSD1306_USESSP
+  #define SSD1306_SSPCLOCK (10000000)   // 10 MHz (tcycle >= 100ns)
+  static sspDevice_t _ssd1306Ssp;
+#else
+  void ssd1306SendByte(uint8_t byte);
+#endif
+
+// The control lines are written together with masked GPIO stores
+#if SSD1306_CS_PORT != SSD1306_DC_PORT || SSD1306_SCLK_PORT != SSD1306_SDAT_PORT
+  #error "SSD1306 CS/DC and SCLK/SDAT must be on the same port"
+#endif
+#define SSD1306_CS    (1 << SSD1306_CS_PIN)
+#define SSD1306_DC    (1 << SSD1306_DC_PIN)
+#define SSD1306_SCLK  (1 << SSD1306_SCLK_PIN)
+#define SSD1306_SDAT  (1 << SSD1306_SDAT_PIN)
+
+#define CMD(c)        do { uint8_t _b = (c); ssd1306Burst( 0, &_b, 1 ); } while (0);
+#define DATA(c)       do { uint8_t _b = (c); ssd1306Burst( SSD1306_DC, &_b, 1 ); } while (0);
+#define DELAY(mS)     do { delayMs( mS ); } while(0);
 
 uint8_t buffer[SSD1306_LCDWIDTH * SSD1306_LCDHEIGHT / 8];
 
+// Range of modified columns in each page since the last refresh (a page
+// is clean when dirtyStart > dirtyEnd).  Everything starts out dirty so
+// that the first refresh sends the full buffer.
+static uint8_t dirtyStart[SSD1306_LCDHEIGHT / 8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+static uint8_t dirtyEnd[SSD1306_LCDHEIGHT / 8] = { SSD1306_LCDWIDTH - 1, SSD1306_LCDWIDTH - 1, 
+                                                   SSD1306_LCDWIDTH - 1, SSD1306_LCDWIDTH - 1, 
+                                                   SSD1306_LCDWIDTH - 1, SSD1306_LCDWIDTH - 1, 
+                                                   SSD1306_LCDWIDTH - 1, SSD1306_LCDWIDTH - 1 };
+
 /**************************************************************************/
 /* Private Methods                                                        */
 /**************************************************************************/
 
+#ifndef SSD1306_USESSP
 /**************************************************************************/
 /*! 
     @brief Simulates an SPI write using GPIO
@@ -83,18 +100,67 @@ void ssd1306SendByte(uint8_t byte)
   int8_t i;
 
   // Make sure clock pin starts high
-  gpioSetValue(SSD1306_SCLK_PORT, SSD1306_SCLK_PIN, 1);
+  GPIO_WRITEMASKED(SSD1306_SCLK_PORT, SSD1306_SCLK, SSD1306_SCLK);
 
   // Write from MSB to LSB
   for (i=7; i>=0; i--) 
   {
-    // Set clock pin low
-    gpioSetValue(SSD1306_SCLK_PORT, SSD1306_SCLK_PIN, 0);
-    // Set data pin high or low depending on the value of the current bit
-    gpioSetValue(SSD1306_SDAT_PORT, SSD1306_SDAT_PIN, byte & (1 << i) ? 1 : 0);
+    // Set clock pin low and the data pin to the current bit in one write
+    GPIO_WRITEMASKED(SSD1306_SCLK_PORT, SSD1306_SCLK | SSD1306_SDAT, byte & (1 << i) ? SSD1306_SDAT : 0);
     // Set clock pin high
-    gpioSetValue(SSD1306_SCLK_PORT, SSD1306_SCLK_PIN, 1);
+    GPIO_WRITEMASKED(SSD1306_SCLK_PORT, SSD1306_SCLK, SSD1306_SCLK);
+  }
+}
+#endif
+
+/**************************************************************************/
+/*! 
+    @brief Sends a run of command (dc = 0) or display data
+           (dc = SSD1306_DC) bytes with CS held low for the whole run
+
+    With CFG_SSD1306_SSP the run goes out as a single SSP burst.
+
+    @return     false if another device is part way through a transfer
+                on the shared bus
+*/
+/**************************************************************************/
+static bool ssd1306Burst(uint32_t dc, const uint8_t *data, uint8_t len)
+{
+#ifdef SSD1306_USESSP
+  if (!sspDeviceAcquire(&_ssd1306Ssp))
+  {
+    return false;
   }
+#endif
+
+  GPIO_WRITEMASKED( SSD1306_CS_PORT, SSD1306_CS | SSD1306_DC, SSD1306_CS | dc );
+  GPIO_WRITEMASKED( SSD1306_CS_PORT, SSD1306_CS, 0 );
+#ifdef SSD1306_USESSP
+  sspSend(0, (uint8_t *)data, len);
+#else
+  while (len--)
+  {
+    ssd1306SendByte(*data++);
+  }
+#endif
+  GPIO_WRITEMASKED( SSD1306_CS_PORT, SSD1306_CS, SSD1306_CS );
+
+#ifdef SSD1306_USESSP
+  sspDeviceRelease(&_ssd1306Ssp);
+#endif
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Flags a column in the specified page as modified
+*/
+/**************************************************************************/
+static void ssd1306MarkDirty(uint8_t x, uint8_t page)
+{
+  if (x < dirtyStart[page]) dirtyStart[page] = x;
+  if (x > dirtyEnd[page]) dirtyEnd[page] = x;
 }
 
 /**************************************************************************/
@@ -153,11 +219,22 @@ static void ssd1306DrawChar(uint16_t x, uint16_t y, uint8_t c, struct FONT_DEF f
 void ssd1306Init(uint8_t vccstate)
 {
   // Set all pins to output
+#ifdef SSD1306_USESSP
+  // Only configure SSP0 if nothing else (SD card, etc.) has done so yet,
+  // since sspInit would reset the bus clock another driver has selected
+  if (!(SSP_SSP0CR1 & SSP_SSP0CR1_SSE_ENABLED))
+  {
+    sspInit(0, sspClockPolarity_High, sspClockPhase_FallingEdge);
+  }
+  sspDeviceRegister(&_ssd1306Ssp, SSD1306_SSPCLOCK, sspClockPolarity_High, sspClockPhase_FallingEdge);
+#else
   gpioSetDir(SSD1306_SCLK_PORT, SSD1306_SCLK_PIN, gpioDirection_Output);
   gpioSetDir(SSD1306_SDAT_PORT, SSD1306_SDAT_PIN, gpioDirection_Output);
+#endif
   gpioSetDir(SSD1306_DC_PORT, SSD1306_DC_PIN, gpioDirection_Output);
   gpioSetDir(SSD1306_RST_PORT, SSD1306_RST_PIN, gpioDirection_Output);
   gpioSetDir(SSD1306_CS_PORT, SSD1306_CS_PIN, gpioDirection_Output);
+  gpioSetValue(SSD1306_CS_PORT, SSD1306_CS_PIN, 1);
 
   // Reset the LCD
   gpioSetValue(SSD1306_RST_PORT, SSD1306_RST_PIN, 1);
@@ -223,7 +300,12 @@ void ssd1306DrawPixel(uint8_t x, uint8_t y)
   if ((x >= SSD1306_LCDWIDTH) || (y >= SSD1306_LCDHEIGHT))
     return;
 
-  buffer[x+ (y/8)*SSD1306_LCDWIDTH] |= (1 << y%8);
+  uint8_t *b = &buffer[x+ (y/8)*SSD1306_LCDWIDTH];
+  if (!(*b & (1 << y%8)))
+  {
+    *b |= (1 << y%8);
+    ssd1306MarkDirty(x, y/8);
+  }
 }
 
 /**************************************************************************/
@@ -241,7 +323,12 @@ void ssd1306ClearPixel(uint8_t x, uint8_t y)
   if ((x >= SSD1306_LCDWIDTH) || (y >= SSD1306_LCDHEIGHT))
     return;
 
-  buffer[x+ (y/8)*SSD1306_LCDWIDTH] &= ~(1 << y%8); 
+  uint8_t *b = &buffer[x+ (y/8)*SSD1306_LCDWIDTH];
+  if (*b & (1 << y%8))
+  {
+    *b &= ~(1 << y%8);
+    ssd1306MarkDirty(x, y/8);
+  }
 }
 
 /**************************************************************************/
@@ -269,24 +356,57 @@ uint8_t ssd1306GetPixel(uint8_t x, uint8_t y)
 /**************************************************************************/
 void ssd1306ClearScreen() 
 {
+  uint8_t p;
+
   memset(buffer, 0, 1024);
+  for (p = 0; p < SSD1306_LCDHEIGHT / 8; p++)
+  {
+    dirtyStart[p] = 0;
+    dirtyEnd[p] = SSD1306_LCDWIDTH - 1;
+  }
 }
 
 /**************************************************************************/
 /*! 
     @brief Renders the contents of the pixel buffer on the LCD
+
+    Only the pages and columns modified since the previous refresh
+    are sent to the display.  Each dirty page is addressed with a
+    column/page window (the panel runs in horizontal addressing mode).
 */
 /**************************************************************************/
 void ssd1306Refresh(void) 
 {
-  CMD(SSD1306_SETLOWCOLUMN | 0x0);  // low col = 0
-  CMD(SSD1306_SETHIGHCOLUMN | 0x0);  // hi col = 0
+  uint8_t p;
+  uint8_t cmd[6];
+
   CMD(SSD1306_SETSTARTLINE | 0x0); // line #0
 
-  uint16_t i;
-  for (i=0; i<1024; i++) 
+  for (p = 0; p < SSD1306_LCDHEIGHT / 8; p++)
   {
-    DATA(buffer[i]);
+    if (dirtyStart[p] > dirtyEnd[p])
+    {
+      // Nothing changed in this page
+      continue;
+    }
+
+    cmd[0] = SSD1306_COLUMNADDR;
+    cmd[1] = dirtyStart[p];
+    cmd[2] = dirtyEnd[p];
+    cmd[3] = SSD1306_PAGEADDR;
+    cmd[4] = p;
+    cmd[5] = p;
+
+    // Leave the page dirty if the shared bus is busy, the next refresh
+    // picks it up
+    if (!ssd1306Burst(0, cmd, sizeof(cmd)) ||
+        !ssd1306Burst(SSD1306_DC, &buffer[(SSD1306_LCDWIDTH * p) + dirtyStart[p]], dirtyEnd[p] - dirtyStart[p] + 1))
+    {
+      return;
+    }
+
+    dirtyStart[p] = 0xFF;
+    dirtyEnd[p] = 0;
   }
 }
 
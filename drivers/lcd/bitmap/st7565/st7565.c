@@ -46,23 +46,95 @@
 
 #include "core/gpio/gpio.h"
 #include "core/systick/systick.h"
+#include "core/delay/delay.h"
 #include "drivers/lcd/smallfonts.h"
 
-void sendByte(uint8_t byte);
-
-#define CMD(c)        do { gpioSetValue( ST7565_A0_PORT, ST7565_A0_PIN, 0 ); sendByte( c ); } while (0);
-#define DATA(d)       do { gpioSetValue( ST7565_A0_PORT, ST7565_A0_PIN, 1 ); sendByte( d ); } while (0);
-#define DELAY(mS)     do { systickDelay( mS / CFG_SYSTICK_DELAY_IN_MS ); } while(0);
+#if defined CFG_ST7565_SSP && CFG_ST7565_SSP == 1
+  #include "core/ssp/ssp.h"
+  #define ST7565_USESSP
+  #define ST7565_SSPCLOCK (10000000)    // 10 MHz (tSCYC >= 50ns at 3.3V)
+  static sspDevice_t _st7565Ssp;
+#else
+  void sendByte(uint8_t byte);
+#endif
+
+// Clock and data are written together with masked GPIO stores
+#if ST7565_SCLK_PORT != ST7565_SDAT_PORT
+  #error "ST7565_SCLK_PORT and ST7565_SDAT_PORT must be the same port"
+#endif
+#define ST7565_SCLK   (1 << ST7565_SCLK_PIN)
+#define ST7565_SDAT   (1 << ST7565_SDAT_PIN)
+
+#define CMD(c)        do { uint8_t _b = (c); st7565Burst( 0, &_b, 1 ); } while (0);
+#define DATA(d)       do { uint8_t _b = (d); st7565Burst( 1, &_b, 1 ); } while (0);
+#define DELAY(mS)     do { delayMs( mS ); } while(0);
 
 uint8_t buffer[128*64/8];
 
+// Range of modified columns in each page since the last refresh (a page
+// is clean when dirtyStart > dirtyEnd).  Everything starts out dirty so
+// that the first refresh sends the full buffer.
+static uint8_t dirtyStart[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+static uint8_t dirtyEnd[8] = { 127, 127, 127, 127, 127, 127, 127, 127 };
+
 /**************************************************************************/
 /* Private Methods                                                        */
 /**************************************************************************/
 
 /**************************************************************************/
 /*! 
-    @brief Renders the buffer contents
+    @brief Sends a run of command (a0 = 0) or display data (a0 = 1)
+           bytes
+
+    With CFG_ST7565_SSP the run goes out as a single SSP burst, and CS
+    is only held low for the burst since the bus may be shared.
+
+    @return     false if another device is part way through a transfer
+                on the shared bus
+*/
+/**************************************************************************/
+static bool st7565Burst(uint8_t a0, const uint8_t *data, uint8_t len)
+{
+  gpioSetValue( ST7565_A0_PORT, ST7565_A0_PIN, a0 );
+
+#ifdef ST7565_USESSP
+  if (!sspDeviceAcquire(&_st7565Ssp))
+  {
+    return false;
+  }
+  gpioSetValue( ST7565_CS_PORT, ST7565_CS_PIN, 0 );
+  sspSend(0, (uint8_t *)data, len);
+  gpioSetValue( ST7565_CS_PORT, ST7565_CS_PIN, 1 );
+  sspDeviceRelease(&_st7565Ssp);
+#else
+  while (len--)
+  {
+    sendByte(*data++);
+  }
+#endif
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Flags a column in the specified page as modified
+*/
+/**************************************************************************/
+static void st7565MarkDirty(uint8_t x, uint8_t page)
+{
+  if (x < dirtyStart[page]) dirtyStart[page] = x;
+  if (x > dirtyEnd[page]) dirtyEnd[page] = x;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Renders the modified parts of the buffer contents
+
+    Only the pages that were touched since the last call are sent, and
+    only between the first and last modified column in each page.  The
+    address commands and the column data of each page are sent as one
+    burst each.
 
     @param[in]  buffer
                 Pointer to the buffer containing the raw pixel data
@@ -70,24 +142,38 @@ uint8_t buffer[128*64/8];
 /**************************************************************************/
 void writeBuffer(uint8_t *buffer) 
 {
-  uint8_t c, p;
+  uint8_t p, col;
+  uint8_t cmd[3];
   int pagemap[] = { 3, 2, 1, 0, 7, 6, 5, 4 };
 
   for(p = 0; p < 8; p++) 
   {
-    CMD(ST7565_CMD_SET_PAGE | pagemap[p]);
-    CMD(ST7565_CMD_SET_COLUMN_LOWER | (0x0 & 0xf));
-    CMD(ST7565_CMD_SET_COLUMN_UPPER | ((0x0 >> 4) & 0xf));
-    CMD(ST7565_CMD_RMW);
-    DATA(0xff);
+    if (dirtyStart[p] > dirtyEnd[p])
+    {
+      // Nothing changed in this page
+      continue;
+    }
+
+    // Buffer column 0 is displayed at controller column 1
+    col = dirtyStart[p] + 1;
+    cmd[0] = ST7565_CMD_SET_PAGE | pagemap[p];
+    cmd[1] = ST7565_CMD_SET_COLUMN_LOWER | (col & 0xf);
+    cmd[2] = ST7565_CMD_SET_COLUMN_UPPER | ((col >> 4) & 0xf);
     
-    for(c = 0; c < 128; c++) 
+    // Leave the page dirty if the shared bus is busy, the next refresh
+    // picks it up
+    if (!st7565Burst(0, cmd, 3) ||
+        !st7565Burst(1, &buffer[(128*p)+dirtyStart[p]], dirtyEnd[p] - dirtyStart[p] + 1))
     {
-      DATA(buffer[(128*p)+c]);
+      return;
     }
+
+    dirtyStart[p] = 0xFF;
+    dirtyEnd[p] = 0;
   }
 }
 
+#ifndef ST7565_USESSP
 /**************************************************************************/
 /*! 
     @brief Simulates an SPI write using GPIO
@@ -100,24 +186,19 @@ void sendByte(uint8_t byte)
 {
   int8_t i;
 
-  // Note: This code can be optimised to avoid the branches by setting
-  // GPIO registers directly, but we'll leave it as is for the moment
-  // for simplicity sake
-
   // Make sure clock pin starts high
-  gpioSetValue(ST7565_SCLK_PORT, ST7565_SCLK_PIN, 1);
+  GPIO_WRITEMASKED(ST7565_SCLK_PORT, ST7565_SCLK, ST7565_SCLK);
 
   // Write from MSB to LSB
   for (i=7; i>=0; i--) 
   {
-    // Set clock pin low
-    gpioSetValue(ST7565_SCLK_PORT, ST7565_SCLK_PIN, 0);
-    // Set data pin high or low depending on the value of the current bit
-    gpioSetValue(ST7565_SDAT_PORT, ST7565_SDAT_PIN, byte & (1 << i) ? 1 : 0);
+    // Set clock pin low and the data pin to the current bit in one write
+    GPIO_WRITEMASKED(ST7565_SCLK_PORT, ST7565_SCLK | ST7565_SDAT, byte & (1 << i) ? ST7565_SDAT : 0);
     // Set clock pin high
-    gpioSetValue(ST7565_SCLK_PORT, ST7565_SCLK_PIN, 1);
+    GPIO_WRITEMASKED(ST7565_SCLK_PORT, ST7565_SCLK, ST7565_SCLK);
   }
 }
+#endif
 
 /**************************************************************************/
 /*!
@@ -180,6 +261,17 @@ void st7565Init(void)
   // as is for clarity sake in case the pins are not all located in the
   // same bank.
 
+#ifdef ST7565_USESSP
+  // Only configure SSP0 if nothing else (SD card, etc.) has done so yet,
+  // since sspInit would reset the bus clock another driver has selected.
+  // The clock idles high and data is latched on the rising edge, as with
+  // the bit-banged version.
+  if (!(SSP_SSP0CR1 & SSP_SSP0CR1_SSE_ENABLED))
+  {
+    sspInit(0, sspClockPolarity_High, sspClockPhase_FallingEdge);
+  }
+  sspDeviceRegister(&_st7565Ssp, ST7565_SSPCLOCK, sspClockPolarity_High, sspClockPhase_FallingEdge);
+#else
   // Set clock pin to output and high
   gpioSetDir(ST7565_SCLK_PORT, ST7565_SCLK_PIN, 1);
   gpioSetValue(ST7565_SCLK_PORT, ST7565_SCLK_PIN, 1);
@@ -187,6 +279,7 @@ void st7565Init(void)
   // Set data pin to output and high
   gpioSetDir(ST7565_SDAT_PORT, ST7565_SDAT_PIN, 1);
   gpioSetValue(ST7565_SDAT_PORT, ST7565_SDAT_PIN, 1);
+#endif
 
   // Configure backlight pin to output and set high (off)
   gpioSetDir(ST7565_BL_PORT, ST7565_BL_PIN, 1);
@@ -209,6 +302,9 @@ void st7565Init(void)
   gpioSetValue(ST7565_RST_PORT, ST7565_RST_PIN, 0);   // Set reset low
   DELAY(500 / CFG_SYSTICK_DELAY_IN_MS);               // Wait 500mS
   gpioSetValue(ST7565_RST_PORT, ST7565_RST_PIN, 1);   // Set reset high
+#ifdef ST7565_USESSP
+  gpioSetValue(ST7565_CS_PORT, ST7565_CS_PIN, 1);     // CS is only low during bursts
+#endif
 
   // Configure Display
   CMD(ST7565_CMD_SET_BIAS_7);                         // LCD Bias Select
@@ -257,12 +353,22 @@ void st7565SetBrightness(uint8_t val)
 /**************************************************************************/
 void st7565ClearScreen(void) 
 {
+  uint8_t p;
+
   memset(&buffer, 0x00, 128*64/8);
+  for (p = 0; p < 8; p++)
+  {
+    dirtyStart[p] = 0;
+    dirtyEnd[p] = 127;
+  }
 }
 
 /**************************************************************************/
 /*! 
     @brief Renders the contents of the pixel buffer on the LCD
+
+    Only the pages and columns modified since the previous refresh
+    are sent to the display.
 */
 /**************************************************************************/
 void st7565Refresh(void)
@@ -286,7 +392,13 @@ void st7565DrawPixel(uint8_t x, uint8_t y)
     return;
 
   // x is which column
-  buffer[x+ (y/8)*128] |= (1 << (7-(y%8)));
+  uint8_t *b = &buffer[x+ (y/8)*128];
+  uint8_t mask = (1 << (7-(y%8)));
+  if (!(*b & mask))
+  {
+    *b |= mask;
+    st7565MarkDirty(x, y/8);
+  }
 }
 
 /**************************************************************************/
@@ -305,7 +417,13 @@ void st7565ClearPixel(uint8_t x, uint8_t y)
     return;
 
   // x is which column
-  buffer[x+ (y/8)*128] &= ~(1 << (7-(y%8)));
+  uint8_t *b = &buffer[x+ (y/8)*128];
+  uint8_t mask = (1 << (7-(y%8)));
+  if (*b & mask)
+  {
+    *b &= ~mask;
+    st7565MarkDirty(x, y/8);
+  }
 }
 
 /**************************************************************************/
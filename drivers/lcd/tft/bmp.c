@@ -50,7 +50,8 @@
 #ifdef CFG_SDCARD
   #include "drivers/fatfs/diskio.h"
   #include "drivers/fatfs/ff.h"
-  static FATFS Fatfs[1];
+  #include "drivers/fatfs/ffsink.h"
+  #include "drivers/fatfs/ffsync.h"
   #if defined CFG_SDCARD_READONLY && CFG_SDCARD_READONLY == 0
 	static FILINFO Finfo;
 	static FIL bmpSDFile;
@@ -61,71 +62,233 @@
 /* ----------------------- Private Methods ------------------------------ */
 /*                                                                        */
 /**************************************************************************/
-bmp_error_t bmpParseBitmap(uint16_t x, uint16_t y, FIL file)
+/**************************************************************************/
+/*!
+    @brief  Reads a little-endian 16-bit value from a byte buffer
+*/
+/**************************************************************************/
+static uint16_t bmpLoadWord(const uint8_t *p)
+{
+  return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads a little-endian 32-bit value from a byte buffer
+*/
+/**************************************************************************/
+static uint32_t bmpLoadDWord(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#define BMP_SINKPIXELS      (32)    // RGB565 pixels per lcdDrawPixels() burst
+
+/**************************************************************************/
+/*!
+    @brief  State of the LCD sink while the pixel data streams past.
+            BGR24 pixels can straddle sector boundaries, so a partial
+            pixel is carried over to the next call.
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint16_t x;                         /* Left edge of the image        */
+  uint16_t y;                         /* Top edge of the image         */
+  uint32_t rowSize;                   /* Bytes per row incl. padding   */
+  uint32_t visible;                   /* Pixels per row on the screen  */
+  uint32_t row;                       /* Rows left, bottom-up          */
+  uint32_t offset;                    /* Byte offset in the row        */
+  uint32_t col;                       /* Completed pixels in the row   */
+  bool     draw;                      /* Row falls on the screen       */
+  uint8_t  bgr[3];                    /* Partial pixel                 */
+  uint8_t  fill;                      /* Pixels waiting in pixels[]    */
+  uint16_t pixels[BMP_SINKPIXELS];
+} bmp_sink_t;
+
+/**************************************************************************/
+/*!
+    @brief  Sends any converted pixels to the LCD
+*/
+/**************************************************************************/
+static void bmpSinkFlush(bmp_sink_t *s)
+{
+  if (s->fill)
+  {
+    lcdDrawPixels(s->x + s->col - s->fill, s->y + s->row - 1, s->pixels, s->fill);
+    s->fill = 0;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Moves the sink on to the next row up
+*/
+/**************************************************************************/
+static void bmpSinkNextRow(bmp_sink_t *s)
+{
+  bmpSinkFlush(s);
+  s->row--;
+  s->offset = 0;
+  s->col = 0;
+  s->draw = s->visible && s->row && (s->y + s->row - 1 < lcdGetHeight());
+}
+
+/**************************************************************************/
+/*!
+    @brief  ffSink write callback, converts BGR24 data straight out of
+            the FatFs sector window into RGB565 bursts for the LCD.
+            Runs of whole visible pixels go through drawBGR24toRGB565,
+            and only pixels that straddle a sector boundary are
+            assembled byte by byte.
+*/
+/**************************************************************************/
+static UINT bmpSinkWrite(ffSink_t *sink, const BYTE *data, UINT len)
+{
+  bmp_sink_t *s = (bmp_sink_t *)sink->arg;
+  uint32_t skip, n;
+  UINT i = 0;
+
+  // The LCD is always ready
+  if (data == NULL)
+    return 1;
+
+  while ((i < len) && s->row)
+  {
+    n = 0;
+    if (s->draw && (s->col < s->visible) && !(s->offset % 3))
+    {
+      n = s->visible - s->col;
+      if (n > (len - i) / 3) n = (len - i) / 3;
+      if (n > BMP_SINKPIXELS - s->fill) n = BMP_SINKPIXELS - s->fill;
+    }
+
+    if (n)
+    {
+      // Convert a run of whole pixels in one go
+      drawBGR24toRGB565(&data[i], &s->pixels[s->fill], n);
+      i += n * 3;
+      s->offset += n * 3;
+      s->col += n;
+      s->fill += n;
+      if ((s->fill == BMP_SINKPIXELS) || (s->col == s->visible))
+        bmpSinkFlush(s);
+    }
+    else if (s->draw && (s->col < s->visible))
+    {
+      // A pixel split across two calls is assembled byte by byte
+      s->bgr[s->offset % 3] = data[i++];
+      s->offset++;
+      if (s->offset % 3)
+        continue;
+
+      // Got a complete pixel
+      s->col++;
+      s->pixels[s->fill++] = drawRGB24toRGB565(s->bgr[2], s->bgr[1], s->bgr[0]);
+      if ((s->fill == BMP_SINKPIXELS) || (s->col == s->visible))
+        bmpSinkFlush(s);
+    }
+    else
+    {
+      // Skip the row padding and anything off the screen
+      skip = s->rowSize - s->offset;
+      if (skip > len - i)
+        skip = len - i;
+      s->offset += skip;
+      i += skip;
+    }
+
+    if (s->offset == s->rowSize)
+      bmpSinkNextRow(s);
+  }
+
+  // Everything past the last row is ignored
+  return len;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parses the bitmap headers and streams the pixel data from
+            the sector window to the LCD with ffSinkForward(), so no
+            row buffer is needed.
+*/
+/**************************************************************************/
+static bmp_error_t bmpParseBitmap(uint16_t x, uint16_t y, FIL *file)
 {
   UINT              bytesRead;
   bmp_header_t      header;
   bmp_infoheader_t  infoHeader;
-
-  // Read the file header
-  // ToDo: Optimise this to read buffer once and parse it
-  f_read(&file, &header.type, sizeof(header.type), &bytesRead);
-  f_read(&file, &header.size, sizeof(header.size), &bytesRead);
-  f_read(&file, &header.reserved1, sizeof(header.reserved1), &bytesRead);
-  f_read(&file, &header.reserved2, sizeof(header.reserved2), &bytesRead);
-  f_read(&file, &header.offset, sizeof(header.offset), &bytesRead);
+  uint8_t           headers[BMP_HEADERSIZE + BMP_INFOHEADERSIZE];
+  bmp_sink_t        state;
+  ffSink_t          sink;
+
+  // Read both headers in one go and parse them (the structs aren't
+  // packed so the data can't be read into them directly)
+  if (f_read(file, headers, sizeof(headers), &bytesRead) || bytesRead != sizeof(headers))
+    return BMP_ERROR_NOTABITMAP;
+
+  header.type                 = bmpLoadWord(&headers[0]);
+  header.size                 = bmpLoadDWord(&headers[2]);
+  header.offset               = bmpLoadDWord(&headers[10]);
+  infoHeader.size             = bmpLoadDWord(&headers[14]);
+  infoHeader.width            = (int32_t)bmpLoadDWord(&headers[18]);
+  infoHeader.height           = (int32_t)bmpLoadDWord(&headers[22]);
+  infoHeader.planes           = bmpLoadWord(&headers[26]);
+  infoHeader.bits             = bmpLoadWord(&headers[28]);
+  infoHeader.compression      = bmpLoadDWord(&headers[30]);
 
   // Make sure this is a bitmap (first two bytes = 'BM' or 0x4D42 on little-endian systems)
   if (header.type != 0x4D42) return BMP_ERROR_NOTABITMAP;
 
-  // Read the info header
-  // ToDo: Optimise this to read buffer once and parse it
-  f_read(&file, &infoHeader.size, sizeof(infoHeader.size), &bytesRead);
-  f_read(&file, &infoHeader.width, sizeof(infoHeader.width), &bytesRead);
-  f_read(&file, &infoHeader.height, sizeof(infoHeader.height), &bytesRead);
-  f_read(&file, &infoHeader.planes, sizeof(infoHeader.planes), &bytesRead);
-  f_read(&file, &infoHeader.bits, sizeof(infoHeader.bits), &bytesRead);
-  f_read(&file, &infoHeader.compression, sizeof(infoHeader.compression), &bytesRead);
-  f_read(&file, &infoHeader.imagesize, sizeof(infoHeader.imagesize), &bytesRead);
-  f_read(&file, &infoHeader.xresolution, sizeof(infoHeader.xresolution), &bytesRead);
-  f_read(&file, &infoHeader.yresolution, sizeof(infoHeader.yresolution), &bytesRead);
-  f_read(&file, &infoHeader.ncolours, sizeof(infoHeader.ncolours), &bytesRead);
-  f_read(&file, &infoHeader.importantcolours, sizeof(infoHeader.importantcolours), &bytesRead);
-
   // Make sure that this is a 24-bit image
   if (infoHeader.bits != 24) 
     return BMP_ERROR_INVALIDBITDEPTH;
 
-  // Check image dimensions
-  if ((infoHeader.width > lcdGetWidth()) | (infoHeader.height > lcdGetHeight()))
+  // Check image dimensions (only bottom-up images are supported)
+  if ((infoHeader.width <= 0) || (infoHeader.height <= 0) ||
+      (infoHeader.width > lcdGetWidth()) || (infoHeader.height > lcdGetHeight()))
     return BMP_ERROR_INVALIDDIMENSIONS;
 
   // Make sure image is not compressed
   if (infoHeader.compression != BMP_COMPRESSION_NONE) 
     return BMP_ERROR_COMPRESSEDDATA;
 
-  // Read 24-bit image data
-  uint32_t px, py;
-  FRESULT res;
-  uint8_t buffer[infoHeader.width * 3];
-  for (py = infoHeader.height; py > 0; py--)
+  // Jump to the pixel data
+  if (f_lseek(file, header.offset))
+    return BMP_ERROR_PREMATUREEOF;
+
+  // Rows are padded to a multiple of 4 bytes
+  uint32_t rowSize = ((infoHeader.width * 3) + 3) & ~3;
+
+  // Clip anything that falls off the right or bottom edge of the screen
+  uint32_t visible = 0;
+  if (x < lcdGetWidth())
   {
-    // Read one row at a time
-    res = f_read(&file, &buffer, infoHeader.width * 3, &bytesRead);
-    if (res || bytesRead == 0)
-    {
-      // Error or EOF
-      return BMP_ERROR_PREMATUREEOF;
-    }
-    for (px = 0; px < infoHeader.width; px++)
-    {
-      // Render pixel
-      // ToDo: This is a brutally slow way of rendering bitmaps ...
-      //        update to pass one row of data at a time
-      drawPixel(x + px, y + py - 1, drawRGB24toRGB565(buffer[(px * 3) + 2], buffer[(px * 3) + 1], buffer[(px * 3)]));
-    }
+    visible = lcdGetWidth() - x;
+    if (visible > infoHeader.width) visible = infoHeader.width;
   }
 
+  // Rows are stored bottom-up, so start with the last one
+  state.x = x;
+  state.y = y;
+  state.rowSize = rowSize;
+  state.visible = visible;
+  state.row = infoHeader.height + 1;
+  state.fill = 0;
+  bmpSinkNextRow(&state);
+
+  sink.write = bmpSinkWrite;
+  sink.poll = NULL;
+  sink.arg = &state;
+
+  if (ffSinkForward(file, &sink, rowSize * infoHeader.height, &bytesRead))
+    return BMP_ERROR_PREMATUREEOF;
+
+  // The padding of the top row may be missing, the pixels may not
+  bmpSinkFlush(&state);
+  if (bytesRead < (rowSize * (infoHeader.height - 1)) + (infoHeader.width * 3))
+    return BMP_ERROR_PREMATUREEOF;
+
   return BMP_ERROR_NONE;
 }
 
@@ -159,48 +322,30 @@ bmp_error_t bmpParseBitmap(uint16_t x, uint16_t y, FIL file)
 bmp_error_t bmpDrawBitmap(uint16_t x, uint16_t y, const char* filename)
 {
   bmp_error_t error = BMP_ERROR_NONE;
-  DSTATUS stat;
-  BYTE res;
-
-  stat = disk_initialize(0);
+  FIL imgfile;  
 
-  if ((stat & STA_NOINIT) || (stat & STA_NODISK))
+  // Initialise the card if needed and mount the drive
+  if (ffSyncMount() != FR_OK)
   {
     // Card not initialised or no disk present
     return BMP_ERROR_SDINITFAIL;
   }
 
-  if (stat == 0)
-  {
-    // Try to mount drive
-    res = f_mount(0, &Fatfs[0]);
-    if (res != FR_OK) 
-    {
-      // Failed to mount 0:
-      return BMP_ERROR_SDINITFAIL;
-    }
-    if (res == FR_OK)
-    {
-      // Try to open the requested file
-      FIL imgfile;  
-      if(f_open(&imgfile, filename, FA_READ | FA_OPEN_EXISTING) != FR_OK) 
-      {  
-        // Unable to open the requested file
-        return BMP_ERROR_FILENOTFOUND;
-      }
-      // Try to render the specified image
-      error = bmpParseBitmap(x, y, imgfile);
-      // Close file
-      f_close(&imgfile);
-      // Unmount drive
-      f_mount(0,0);
-       // Return results
-      return error;
-    }
+  // Try to open the requested file
+  if(f_open(&imgfile, filename, FA_READ | FA_OPEN_EXISTING) != FR_OK) 
+  {  
+    // Unable to open the requested file
+    ffSyncUnmount();
+    return BMP_ERROR_FILENOTFOUND;
   }
-
-  // Return OK signal
-  return BMP_ERROR_NONE;
+  // Try to render the specified image
+  error = bmpParseBitmap(x, y, &imgfile);
+  // Close file
+  f_close(&imgfile);
+  // Unmount drive
+  ffSyncUnmount();
+  // Return results
+  return error;
 }
 
 #if defined CFG_SDCARD_READONLY && CFG_SDCARD_READONLY == 0
@@ -236,47 +381,28 @@ bmp_error_t bmpDrawBitmap(uint16_t x, uint16_t y, const char* filename)
 /**************************************************************************/
 bmp_error_t bmpSaveScreenshot(const char* filename)
 {
-  DSTATUS stat;
   bmp_error_t error = BMP_ERROR_NONE;
   bmp_header_t header;
   bmp_infoheader_t infoHeader;
-  uint32_t lcdWidth, lcdHeight, x, y, bgra32;
+  uint32_t lcdWidth, lcdHeight, x, y, i, len;
   UINT bytesWritten;
-  uint16_t rgb565, eof;
-  uint8_t r, g, b;
-
-  // Create a new file (Crossworks only)
-  stat = disk_initialize(0);
-  if (stat & STA_NOINIT) 
-  {
-    return BMP_ERROR_SDINITFAIL;
-  }
-  if (stat & STA_NODISK) 
+  uint16_t eof;
+  uint16_t pixels[32];
+  uint8_t bgr[32 * 3];
+  uint8_t sector[512];
+  uint32_t fill, limit;
+
+  // Initialise the card if needed and mount the drive
+  if (ffSyncMount() != FR_OK)
   {
     return BMP_ERROR_SDINITFAIL;
   }
-  if (stat == 0)
-  {
-    // SD card sucessfully initialised
-    DSTATUS stat;
-    DWORD p2;
-    WORD w1;
-    BYTE res, b1;
-    DIR dir; 
-    // Try to mount drive
-    res = f_mount(0, &Fatfs[0]);
-    if (res != FR_OK) 
-    {
-      return BMP_ERROR_SDINITFAIL;
-    }
-    if (res == FR_OK)
-    {
-      // Create a file (overwriting any existing file!)
-      if(f_open(&bmpSDFile, filename, FA_READ | FA_WRITE | FA_CREATE_ALWAYS)!=FR_OK) 
-      {  
-        return BMP_ERROR_UNABLETOCREATEFILE; 
-      }
-    }
+
+  // Create a file (overwriting any existing file!)
+  if(f_open(&bmpSDFile, filename, FA_READ | FA_WRITE | FA_CREATE_ALWAYS)!=FR_OK) 
+  {  
+    ffSyncUnmount();
+    return BMP_ERROR_UNABLETOCREATEFILE; 
   }
 
   lcdWidth = lcdGetWidth();
@@ -320,28 +446,59 @@ bmp_error_t bmpSaveScreenshot(const char* filename)
   f_write(&bmpSDFile, &infoHeader.ncolours, sizeof(infoHeader.ncolours), &bytesWritten);
   f_write(&bmpSDFile, &infoHeader.importantcolours, sizeof(infoHeader.importantcolours), &bytesWritten);
 
-  // Write image data to disk (starting from bottom row)
+  // Write image data to disk (starting from bottom row).  Pixels are
+  // read back in bursts and collected in a sector-sized buffer, and the
+  // first block is shortened by the header size so that every following
+  // write covers exactly one aligned sector.
+  fill = 0;
+  limit = sizeof(sector) - header.offset;
   for (y = lcdHeight; y != 0; y--)
   {
-    for (x = 0; x < lcdWidth; x++)
+    for (x = 0; x < lcdWidth; x += len)
     {
-      rgb565 = lcdGetPixel(x, y - 1);               // Get RGB565 pixel
-      bgra32 = drawRGB565toBGRA32(rgb565);          // Convert RGB565 to 24-bit color
-      r = (bgra32 & 0x00FF0000) >> 16;
-      g = (bgra32 & 0x0000FF00) >> 8;
-      b = (bgra32 & 0x000000FF);
-      f_write(&bmpSDFile, &b, 1, &bytesWritten);    // Write RGB data
-      f_write(&bmpSDFile, &g, 1, &bytesWritten);
-      f_write(&bmpSDFile, &r, 1, &bytesWritten);
+      len = lcdWidth - x > 32 ? 32 : lcdWidth - x;
+      lcdReadPixels(x, y - 1, pixels, len);         // Get RGB565 pixels
+      if (fill + len * 3 <= limit)
+      {
+        // Convert the burst straight into the sector buffer
+        drawRGB565toBGR24(pixels, &sector[fill], len);
+        fill += len * 3;
+      }
+      else
+      {
+        // The burst straddles the end of the sector
+        drawRGB565toBGR24(pixels, bgr, len);
+        for (i = 0; i < len * 3; i++)
+        {
+          sector[fill++] = bgr[i];
+          if (fill == limit)
+          {
+            f_write(&bmpSDFile, sector, fill, &bytesWritten);
+            fill = 0;
+            limit = sizeof(sector);
+          }
+        }
+      }
+      if (fill == limit)
+      {
+        f_write(&bmpSDFile, sector, fill, &bytesWritten);
+        fill = 0;
+        limit = sizeof(sector);
+      }
     }    
   }
   
-  // Write EOF (2 bytes)
+  // Write any remaining data plus EOF (2 bytes)
+  if (fill)
+  {
+    f_write(&bmpSDFile, sector, fill, &bytesWritten);
+  }
   eof = 0x0000;
   f_write(&bmpSDFile, &eof, 2, &bytesWritten);
 
   // Close the file
   f_close(&bmpSDFile);
+  ffSyncUnmount();
 
   // Return OK signal
   return BMP_ERROR_NONE;
@@ -62,6 +62,9 @@
  **************************************************************************/
 
 
+#define BMP_HEADERSIZE      (14)    // Size of the file header on disk
+#define BMP_INFOHEADERSIZE  (40)    // Size of the info header on disk
+
 /**************************************************************************/
 /*!
     @brief  14-byte Windows bitmap header
@@ -0,0 +1,320 @@
+/**************************************************************************/
+/*! 
+    @file     chart.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Scrolling strip chart for plotting live data
+
+    @section DESCRIPTION
+
+    Samples are plotted from left to right, one per column, and the
+    trace wraps back to the left edge when the chart is full (the same
+    way a sweep oscilloscope works).  Only the new column segment is
+    drawn for each sample, and the segment of the column immediately to
+    its right is erased so that the current position remains visible,
+    which means that the cost of a sample doesn't depend on the size of
+    the chart.  Erased segments are repainted with the background and
+    any grid pixels they crossed, so the grid never needs to be redrawn.
+
+    The last 'width' samples are kept in a caller-supplied ring buffer
+    so that the chart can be redrawn at any time with chartRedraw
+    (after a dialogue has been closed on top of it, for example).
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/chart.h"
+
+    static int16_t adcSamples[226];
+    static chart_t adcChart;
+
+    adcChart.x = 10;
+    adcChart.y = 25;
+    adcChart.width = 226;
+    adcChart.height = 176;
+    adcChart.minValue = 0;
+    adcChart.maxValue = 1023;
+    adcChart.gridX = 25;
+    adcChart.gridY = 25;
+    adcChart.bgColor = COLOR_BLACK;
+    adcChart.gridColor = COLOR_DARKERGRAY;
+    adcChart.traceColor = COLOR_YELLOW;
+    adcChart.samples = adcSamples;
+    chartInit(&adcChart);
+
+    while (1)
+    {
+      chartAddSample(&adcChart, adcRead(5));
+      systickDelay(1);
+    }
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "chart.h"
+
+#include "drivers/lcd/tft/lcd.h"
+#include "drivers/lcd/tft/drawing.h"
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Converts a sample to a screen row inside the plot area
+*/
+/**************************************************************************/
+static uint16_t chartValueToRow(chart_t *chart, int16_t value)
+{
+  int32_t offset;
+
+  if (value <= chart->minValue)
+  {
+    return chart->y + chart->height - 1;
+  }
+  if (value >= chart->maxValue)
+  {
+    return chart->y;
+  }
+
+  offset = ((int32_t)(value - chart->minValue) * (chart->height - 1)) / (chart->maxValue - chart->minValue);
+  return chart->y + chart->height - 1 - offset;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the two rows connected by the trace in 'column'
+            (a single point for the first column)
+*/
+/**************************************************************************/
+static void chartSegment(chart_t *chart, uint16_t column, uint16_t *top, uint16_t *bottom)
+{
+  uint16_t a, b;
+
+  b = chartValueToRow(chart, chart->samples[column]);
+  a = column ? chartValueToRow(chart, chart->samples[column - 1]) : b;
+
+  *top = a < b ? a : b;
+  *bottom = a < b ? b : a;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Repaints rows 'top' to 'bottom' of a single column with the
+            background and grid
+*/
+/**************************************************************************/
+static void chartEraseSegment(chart_t *chart, uint16_t column, uint16_t top, uint16_t bottom)
+{
+  uint16_t x = chart->x + column;
+  uint16_t row;
+
+  if (chart->gridX && !(column % chart->gridX))
+  {
+    // Vertical grid line
+    drawLine(x, top, x, bottom, chart->gridColor);
+    return;
+  }
+
+  drawLine(x, top, x, bottom, chart->bgColor);
+  if (chart->gridY)
+  {
+    // Restore the horizontal grid lines that were crossed
+    row = top - chart->y;
+    row += (chart->gridY - row % chart->gridY) % chart->gridY;
+    for ( ; chart->y + row <= bottom; row += chart->gridY)
+    {
+      drawPixel(x, chart->y + row, chart->gridColor);
+    }
+  }
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Checks the chart settings, clears the sample buffer and
+            draws the empty chart
+
+    @param[in]  chart
+                Chart to initialise, with the position, size, range,
+                colors and sample buffer already set
+*/
+/**************************************************************************/
+chart_error_t chartInit(chart_t *chart)
+{
+  if ((chart->width == 0) || (chart->height == 0) ||
+      (chart->x + chart->width > lcdGetWidth()) ||
+      (chart->y + chart->height > lcdGetHeight()))
+  {
+    return CHART_ERROR_INVALIDDIMENSIONS;
+  }
+  if (chart->maxValue <= chart->minValue)
+  {
+    return CHART_ERROR_INVALIDRANGE;
+  }
+  if (chart->samples == NULL)
+  {
+    return CHART_ERROR_NOBUFFER;
+  }
+
+  chart->position = 0;
+  chart->wrapped = FALSE;
+  chartRedraw(chart);
+
+  return CHART_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Adds a sample to the ring buffer and plots it in the next
+            column
+
+    @param[in]  chart
+                Chart initialised with chartInit
+    @param[in]  value
+                Sample value (clipped to minValue..maxValue)
+*/
+/**************************************************************************/
+void chartAddSample(chart_t *chart, int16_t value)
+{
+  uint16_t column = chart->position;
+  uint16_t next = column + 1 == chart->width ? 0 : column + 1;
+  uint16_t top, bottom;
+
+  // Erase the old segment ahead of the trace (it still connects to the
+  // old sample in this column, so this must happen before it's replaced)
+  if (chart->wrapped && next)
+  {
+    chartSegment(chart, next, &top, &bottom);
+    chartEraseSegment(chart, next, top, bottom);
+  }
+  else if (next == 0)
+  {
+    // Wrapping around: chartSegment returns the single point in column 0
+    chart->wrapped = TRUE;
+    chartSegment(chart, 0, &top, &bottom);
+    chartEraseSegment(chart, 0, top, bottom);
+  }
+
+  // Store and draw the new segment
+  chart->samples[column] = value;
+  chartSegment(chart, column, &top, &bottom);
+  drawLine(chart->x + column, top, chart->x + column, bottom, chart->traceColor);
+
+  chart->position = next;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Redraws the whole chart (background, grid and every sample
+            currently in the ring buffer)
+
+    @param[in]  chart
+                Chart initialised with chartInit
+*/
+/**************************************************************************/
+void chartRedraw(chart_t *chart)
+{
+  uint16_t i, count, top, bottom;
+  uint16_t x1 = chart->x + chart->width - 1;
+  uint16_t y1 = chart->y + chart->height - 1;
+
+  // Background and grid
+  drawRectangleFilled(chart->x, chart->y, x1, y1, chart->bgColor);
+  if (chart->gridY)
+  {
+    for (i = 0; i < chart->height; i += chart->gridY)
+    {
+      drawLine(chart->x, chart->y + i, x1, chart->y + i, chart->gridColor);
+    }
+  }
+  if (chart->gridX)
+  {
+    for (i = 0; i < chart->width; i += chart->gridX)
+    {
+      drawLine(chart->x + i, chart->y, chart->x + i, y1, chart->gridColor);
+    }
+  }
+
+  // Samples (the column after the current position is left blank)
+  count = chart->wrapped ? chart->width : chart->position;
+  for (i = 0; i < count; i++)
+  {
+    if (chart->wrapped && (i == chart->position))
+    {
+      continue;
+    }
+    chartSegment(chart, i, &top, &bottom);
+    drawLine(chart->x + i, top, chart->x + i, bottom, chart->traceColor);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a single column as a vertical bar from 'minValue' to
+            'maxValue', replacing whatever was in it.  This is meant for
+            charts that are drawn a screen at a time (for example the
+            min/max envelope of a decimated capture, see scopeRender)
+            rather than one sample at a time, and doesn't touch the
+            ring buffer.
+
+    @param[in]  chart
+                Chart initialised with chartInit
+    @param[in]  column
+                Column to draw (0..width-1)
+    @param[in]  minValue
+                Lowest value in the column (clipped to the chart range)
+    @param[in]  maxValue
+                Highest value in the column (clipped to the chart range)
+*/
+/**************************************************************************/
+void chartDrawColumn(chart_t *chart, uint16_t column, int16_t minValue, int16_t maxValue)
+{
+  uint16_t x = chart->x + column;
+
+  if (column >= chart->width)
+  {
+    return;
+  }
+
+  chartEraseSegment(chart, column, chart->y, chart->y + chart->height - 1);
+  drawLine(x, chartValueToRow(chart, maxValue), x, chartValueToRow(chart, minValue), chart->traceColor);
+}
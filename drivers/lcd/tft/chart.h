@@ -0,0 +1,84 @@
+/**************************************************************************/
+/*! 
+    @file     chart.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __CHART_H__
+#define __CHART_H__
+
+#include "projectconfig.h"
+
+/**************************************************************************/
+/*!
+    @brief  Strip chart state.  The first block of fields must be set
+            before calling chartInit, the rest is managed by chart.c.
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint16_t  x;                  /* Left edge of the plot area           */
+  uint16_t  y;                  /* Top edge of the plot area            */
+  uint16_t  width;              /* Width in pixels (one sample/column)  */
+  uint16_t  height;             /* Height in pixels                     */
+  int16_t   minValue;           /* Sample value at the bottom edge      */
+  int16_t   maxValue;           /* Sample value at the top edge         */
+  uint16_t  gridX;              /* Vertical grid spacing (0 = none)     */
+  uint16_t  gridY;              /* Horizontal grid spacing (0 = none)   */
+  uint16_t  bgColor;            /* Plot background                      */
+  uint16_t  gridColor;          /* Grid lines                           */
+  uint16_t  traceColor;         /* Sample trace                         */
+  int16_t  *samples;            /* Ring buffer with 'width' entries     */
+
+  uint16_t  position;           /* Column the next sample goes in       */
+  bool      wrapped;            /* TRUE once every column has a sample  */
+} chart_t;
+
+/**************************************************************************/
+/*!
+    @brief  Error return codes for the strip chart
+*/
+/**************************************************************************/
+typedef enum
+{
+  CHART_ERROR_NONE = 0,
+  CHART_ERROR_INVALIDDIMENSIONS = 1,    /* Plot area is empty or off the screen */
+  CHART_ERROR_INVALIDRANGE = 2,         /* maxValue must be larger than minValue */
+  CHART_ERROR_NOBUFFER = 3              /* 'samples' wasn't set */
+} chart_error_t;
+
+chart_error_t chartInit      ( chart_t *chart );
+void          chartAddSample ( chart_t *chart, int16_t value );
+void          chartRedraw    ( chart_t *chart );
+void          chartDrawColumn ( chart_t *chart, uint16_t column, int16_t minValue, int16_t maxValue );
+
+#endif
@@ -0,0 +1,202 @@
+/**************************************************************************/
+/*! 
+    @file     console.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Scrolling text console for event logs
+
+    @section DESCRIPTION
+
+    The console occupies a full-width horizontal band of the screen
+    and shows the most recent lines written to it, with new lines
+    added at the bottom.  Only the new line is ever drawn.
+
+    On controllers that support lcdSetScrollOffset (ILI9325/ILI9328 in
+    portrait mode), the band is treated as a ring buffer of lines in
+    GRAM: the oldest line is overwritten in place and the display
+    offset is moved by one line, so no pixel data has to be copied.
+    Elsewhere the band is scrolled with lcdScrollRegion before the new
+    line is drawn in the bottom row.
+
+    Since the GRAM lines inside the band don't match what is shown
+    while it is rotated, nothing else should be drawn inside the band,
+    and consoleInit needs to be called again after the orientation has
+    been changed.
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/console.h"
+    #include "drivers/lcd/tft/fonts/dejavusansmono8.h"
+
+    static console_t log;
+
+    log.y = 40;
+    log.height = 240;
+    log.font = &dejaVuSansMono8ptFontInfo;
+    log.fgColor = COLOR_GREEN;
+    log.bgColor = COLOR_BLACK;
+    consoleInit(&log);
+
+    consoleWriteLine(&log, "System started");
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "console.h"
+
+#include "drivers/lcd/tft/lcd.h"
+#include "drivers/lcd/tft/drawing.h"
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Draws a line of text in the specified slot, clearing the
+            rest of the line
+*/
+/**************************************************************************/
+static void consoleDrawSlot(console_t *console, uint8_t slot, char *text)
+{
+  uint16_t top, width;
+
+  top = console->y + slot * console->lineHeight;
+  width = text ? drawGetStringWidth(console->font, text) : 0;
+  if (width > lcdGetWidth())
+  {
+    width = lcdGetWidth();
+  }
+
+  // The opaque text clears its own cells, so only fill what's left
+  // (drawString's y co-ordinate is 7 lines below the top of the glyphs)
+  if (width)
+  {
+    drawStringOpaque(0, top + 7, console->fgColor, console->bgColor, console->font, text);
+  }
+  if (width < lcdGetWidth())
+  {
+    drawRectangleFilled(width, top, lcdGetWidth() - 1, top + console->lineHeight - 1, console->bgColor);
+  }
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Initialises the console and clears its area
+
+    @param[in]  console
+                Console to initialise, with the position, height, font
+                and colors already set
+*/
+/**************************************************************************/
+console_error_t consoleInit(console_t *console)
+{
+  if (console->font == NULL)
+  {
+    return CONSOLE_ERROR_NOFONT;
+  }
+
+  console->lineHeight = console->font->heightPages * 8;
+  console->lines = console->height / console->lineHeight > 255 ? 255 : console->height / console->lineHeight;
+  if ((console->lines == 0) || (console->y + console->lines * console->lineHeight > lcdGetHeight()))
+  {
+    return CONSOLE_ERROR_INVALIDDIMENSIONS;
+  }
+
+  consoleClear(console);
+
+  return CONSOLE_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Removes all lines from the console
+*/
+/**************************************************************************/
+void consoleClear(console_t *console)
+{
+  uint16_t y1 = console->y + console->lines * console->lineHeight - 1;
+
+  console->count = 0;
+  console->head = 0;
+  console->hwscroll = lcdSetScrollOffset(console->y, y1, 0);
+  drawRectangleFilled(0, console->y, lcdGetWidth() - 1, y1, console->bgColor);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Adds a line at the bottom of the console, scrolling the
+            older lines up once the console is full
+
+    @param[in]  console
+                Console initialised with consoleInit
+    @param[in]  text
+                Text to show (anything past the right edge of the
+                screen is clipped)
+*/
+/**************************************************************************/
+void consoleWriteLine(console_t *console, char *text)
+{
+  uint16_t y1 = console->y + console->lines * console->lineHeight - 1;
+  uint8_t slot;
+
+  if (console->count < console->lines)
+  {
+    // Still filling up, no need to scroll
+    slot = console->count++;
+  }
+  else if (console->hwscroll)
+  {
+    // Recycle the oldest line, which becomes the bottom line once the
+    // offset has been moved past it
+    slot = console->head;
+    console->head = (console->head + 1) % console->lines;
+    lcdSetScrollOffset(console->y, y1, console->head * console->lineHeight);
+  }
+  else
+  {
+    lcdScrollRegion(console->y, y1, console->lineHeight, console->bgColor);
+    slot = console->lines - 1;
+  }
+
+  consoleDrawSlot(console, slot, text);
+}
@@ -0,0 +1,81 @@
+/**************************************************************************/
+/*! 
+    @file     console.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __CONSOLE_H__
+#define __CONSOLE_H__
+
+#include "projectconfig.h"
+#include "drivers/lcd/tft/fonts/bitmapfonts.h"
+
+/**************************************************************************/
+/*!
+    @brief  Console state.  The first block of fields must be set
+            before calling consoleInit, the rest is managed by
+            console.c.
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint16_t        y;                  /* Top edge of the console          */
+  uint16_t        height;             /* Height in pixels (rounded down   */
+                                      /* to a whole number of lines)      */
+  const FONT_INFO *font;              /* Font used for every line         */
+  uint16_t        fgColor;            /* Text                             */
+  uint16_t        bgColor;            /* Background                       */
+
+  uint16_t        lineHeight;         /* Pixels per line                  */
+  uint8_t         lines;              /* Number of lines shown            */
+  uint8_t         count;              /* Lines written so far (<= lines)  */
+  uint8_t         head;               /* Slot holding the oldest line     */
+  bool            hwscroll;           /* TRUE if lcdSetScrollOffset works */
+} console_t;
+
+/**************************************************************************/
+/*!
+    @brief  Error return codes for the console
+*/
+/**************************************************************************/
+typedef enum
+{
+  CONSOLE_ERROR_NONE = 0,
+  CONSOLE_ERROR_INVALIDDIMENSIONS = 1,  /* Less than one line, or off the screen */
+  CONSOLE_ERROR_NOFONT = 2              /* 'font' wasn't set */
+} console_error_t;
+
+console_error_t consoleInit      ( console_t *console );
+void            consoleClear     ( console_t *console );
+void            consoleWriteLine ( console_t *console, char *text );
+
+#endif
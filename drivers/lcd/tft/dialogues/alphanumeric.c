@@ -95,6 +95,11 @@
 #define ALPHA_COL4_LEFT     ((ALPHA_BTN_SPACING * 4) + (ALPHA_BTN_WIDTH * 3))
 #define ALPHA_COL5_LEFT     ((ALPHA_BTN_SPACING * 5) + (ALPHA_BTN_WIDTH * 4))
 
+/* Text input region */
+#define ALPHA_TEXT_LEFT     (ALPHA_BTN_SPACING * 3)
+#define ALPHA_TEXT_TOP      (ALPHA_BTN_SPACING * 3)
+#define ALPHA_TEXT_RIGHT    (lcdGetWidth() - 1 - (ALPHA_BTN_SPACING * 3))
+
 /* Control which 'page' is currently shown on the keypad */
 static uint8_t alphaPage = 0;
 
@@ -102,9 +107,17 @@ static uint8_t alphaPage = 0;
 static uint8_t alphaString[80];
 static uint8_t *alphaString_ptr;
 
+/* X position where the next character will be drawn in the input box */
+static uint16_t alphaTextX;
+
 /* For quick retrieval of button X/Y locqtions */
 uint32_t alphaBtnX[5], alphaBtnY[6];
 
+/* What is currently on the screen for each button, so that only buttons
+   whose label or state has changed need to be redrawn ('\0' = invalid) */
+static char alphaBtnLabel[6][5];
+static bool alphaBtnSelected[6][5];
+
 /* Array showing which characters should be displayed on each alphaPage */
 /* You can rearrange the keypad by modifying the array contents below   */
 /* --------------------    --------------------   --------------------   --------------------
@@ -167,6 +180,11 @@ void alphaRenderButton(uint8_t alphaPage, uint8_t col, uint8_t row, bool selecte
 
   char c = alphaKeys[alphaPage][row][col];
   char key[2] = { alphaKeys[alphaPage][row][col], '\0' };
+
+  // Remember what was drawn for alphaRefreshScreen
+  alphaBtnLabel[row][col] = c;
+  alphaBtnSelected[row][col] = selected;
+
   // Handle special characters
   switch (c)
   {
@@ -193,7 +211,8 @@ void alphaRenderButton(uint8_t alphaPage, uint8_t col, uint8_t row, bool selecte
 
 /**************************************************************************/
 /*! 
-    @brief  Renders the UI
+    @brief  Brings the keypad up to date with the current page, redrawing
+            only the buttons that are selected or whose label changed
 */
 /**************************************************************************/
 void alphaRefreshScreen(void)
@@ -205,13 +224,71 @@ void alphaRefreshScreen(void)
   {
     for (x = 0; x < 5; x++)
     {
-      alphaRenderButton(alphaPage, x, y, false);
+      if (alphaBtnSelected[y][x] || (alphaBtnLabel[y][x] != alphaKeys[alphaPage][y][x]))
+      {
+        alphaRenderButton(alphaPage, x, y, false);
+      }
     }
   }
+}
 
-  /* Render Text */
+/**************************************************************************/
+/*! 
+    @brief  Draws the text input box and the entire string
+*/
+/**************************************************************************/
+void alphaRenderInput(void)
+{
   drawRectangleRounded(ALPHA_BTN_SPACING, ALPHA_BTN_SPACING, lcdGetWidth() - 1 - ALPHA_BTN_SPACING, ALPHA_KEYPAD_TOP - ALPHA_BTN_SPACING, ALPHA_COLOR_INPUTFILL, 10, DRAW_ROUNDEDCORNERS_ALL);
-  drawString(ALPHA_BTN_SPACING * 3, ALPHA_BTN_SPACING * 3, ALPHA_COLOR_INPUTTEXT, &dejaVuSans9ptFontInfo, (char *)&alphaString);
+  drawStringOpaque(ALPHA_TEXT_LEFT, ALPHA_TEXT_TOP, ALPHA_COLOR_INPUTTEXT, ALPHA_COLOR_INPUTFILL, &dejaVuSans9ptFontInfo, (char *)&alphaString);
+  alphaTextX = ALPHA_TEXT_LEFT + drawGetStringWidth(&dejaVuSans9ptFontInfo, (char *)&alphaString);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Appends a character to the string, drawing only the new glyph
+*/
+/**************************************************************************/
+void alphaAppendChar(char c)
+{
+  char glyph[2] = { c, '\0' };
+  uint16_t width = drawGetStringWidth(&dejaVuSans9ptFontInfo, glyph);
+
+  // Ignore the key if the string or the input box is full
+  if ((alphaString_ptr >= &alphaString[sizeof(alphaString) - 1]) || (alphaTextX + width > ALPHA_TEXT_RIGHT))
+  {
+    return;
+  }
+
+  *alphaString_ptr++ = c;
+  drawStringOpaque(alphaTextX, ALPHA_TEXT_TOP, ALPHA_COLOR_INPUTTEXT, ALPHA_COLOR_INPUTFILL, &dejaVuSans9ptFontInfo, glyph);
+  alphaTextX += width;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Removes the last character from the string, clearing only
+            the area covered by its glyph
+*/
+/**************************************************************************/
+void alphaRemoveChar(void)
+{
+  char glyph[2] = { '\0', '\0' };
+  uint16_t width;
+
+  if (alphaString_ptr == alphaString)
+  {
+    return;
+  }
+
+  alphaString_ptr--;
+  glyph[0] = *alphaString_ptr;
+  *alphaString_ptr = '\0';
+  width = drawGetStringWidth(&dejaVuSans9ptFontInfo, glyph);
+  alphaTextX -= width;
+  // Glyph cells start 7 lines above the y co-ordinate passed to drawString
+  drawRectangleFilled(alphaTextX, ALPHA_TEXT_TOP - 7, alphaTextX + width - 1, 
+                      ALPHA_TEXT_TOP - 8 + dejaVuSans9ptFontInfo.heightPages * 8, ALPHA_COLOR_INPUTFILL);
 }
 
 /**************************************************************************/
@@ -275,11 +352,7 @@ char alphaHandleTouchEvent(void)
   if (result == '<')
   {
     // Trim character if backspace was pressed
-    if (alphaString_ptr > alphaString)
-    {
-      alphaString_ptr--;
-      *alphaString_ptr = '\0';
-    }
+    alphaRemoveChar();
   }
   else if (result == '*')
   {
@@ -301,7 +374,7 @@ char alphaHandleTouchEvent(void)
   else
   {
     // Add text to string buffer
-    *alphaString_ptr++ = result;
+    alphaAppendChar(result);
   }
 
   // Brief delay
@@ -351,8 +424,13 @@ char* alphaShowDialogue(void)
   alphaString_ptr = alphaString;
   alphaPage = 0;
 
+  /* Nothing has been drawn yet, so every button needs to be rendered */
+  memset(&alphaBtnLabel[0][0], 0, sizeof(alphaBtnLabel));
+  memset(&alphaBtnSelected[0][0], 0, sizeof(alphaBtnSelected));
+
   /* Draw the background and render the buttons */
   drawFill(ALPHA_COLOR_BACKGROUND);
+  alphaRenderInput();
   alphaRefreshScreen();
 
   /* Capture results until the 'OK' button is pressed */
@@ -42,11 +42,27 @@
 #include <string.h>
 
 #include "drawing.h"
+#include "lcdinline.h"
 
 #ifdef CFG_SDCARD
   #include "bmp.h"
 #endif
 
+#if defined CFG_TFTLCD_FONTCACHE && CFG_TFTLCD_FONTCACHE > 0
+  #include "drivers/lcd/tft/fontcache.h"
+#endif
+
+#if defined CFG_TFTLCD_TILEBUFFER && CFG_TFTLCD_TILEBUFFER > 0
+  #define DRAW_TILES
+  static uint16_t drawTileBuffer[CFG_TFTLCD_TILEBUFFER];
+  static bool drawTileActive = FALSE;
+  static uint16_t drawTileX0, drawTileY0, drawTileX1, drawTileY1;
+#endif
+
+// Colors in a gradient ramp.  Each RGB565 channel has at most 64 levels,
+// so a longer ramp would only repeat colors.
+#define DRAW_GRADIENTSTEPS  (64)
+
 /**************************************************************************/
 /*                                                                        */
 /* ----------------------- Private Methods ------------------------------ */
@@ -55,926 +71,2403 @@
 
 /**************************************************************************/
 /*!
-    @brief  Draws a single bitmap character
+    @brief  Sends a horizontal line to the active tile, or directly to
+            the LCD if no tile is open
 */
 /**************************************************************************/
-void drawCharBitmap(const uint16_t xPixel, const uint16_t yPixel, uint16_t color, const uint8_t *glyph, uint8_t glyphHeightPages, uint8_t glyphWidthBits)
+static void drawTargetHLine(uint16_t x0, uint16_t x1, uint16_t y, uint16_t color)
 {
-  uint16_t verticalPage, horizBit, currentY, currentX;
-  uint16_t indexIntoGlyph;
-
-  // set initial current y
-  currentY = yPixel;
-  currentX = xPixel;
-
-  // for each page of the glyph
-  for (verticalPage = glyphHeightPages; verticalPage > 0; --verticalPage)
+  #ifdef DRAW_TILES
+  if (drawTileActive)
   {
-    // for each horizontol bit
-    for (horizBit = 0; horizBit < glyphWidthBits; ++horizBit)
+    uint16_t x, *p;
+    if (x1 < x0)
+    {
+      x = x0; x0 = x1; x1 = x;
+    }
+    if ((y < drawTileY0) || (y > drawTileY1) || (x1 < drawTileX0) || (x0 > drawTileX1))
+    {
+      return;
+    }
+    if (x0 < drawTileX0) x0 = drawTileX0;
+    if (x1 > drawTileX1) x1 = drawTileX1;
+    p = &drawTileBuffer[(y - drawTileY0) * (drawTileX1 - drawTileX0 + 1) + (x0 - drawTileX0)];
+    for (x = x0; x <= x1; x++)
     {
-      // next byte
-      indexIntoGlyph = (glyphHeightPages * horizBit) + verticalPage - 1;
-      
-      currentX = xPixel + (horizBit);
-      // send the data byte
-      if (glyph[indexIntoGlyph] & (0X80)) drawPixel(currentX, currentY, color);
-      if (glyph[indexIntoGlyph] & (0X40)) drawPixel(currentX, currentY - 1, color);
-      if (glyph[indexIntoGlyph] & (0X20)) drawPixel(currentX, currentY - 2, color);
-      if (glyph[indexIntoGlyph] & (0X10)) drawPixel(currentX, currentY - 3, color);
-      if (glyph[indexIntoGlyph] & (0X08)) drawPixel(currentX, currentY - 4, color);
-      if (glyph[indexIntoGlyph] & (0X04)) drawPixel(currentX, currentY - 5, color);
-      if (glyph[indexIntoGlyph] & (0X02)) drawPixel(currentX, currentY - 6, color);
-      if (glyph[indexIntoGlyph] & (0X01)) drawPixel(currentX, currentY - 7, color);
+      *p++ = color;
     }
-    // next line of pages
-    currentY += 8;
+    return;
   }
+  #endif
+
+  lcdDrawHLine(x0, x1, y, color);
 }
 
-#if defined CFG_TFTLCD_INCLUDESMALLFONTS & CFG_TFTLCD_INCLUDESMALLFONTS == 1
 /**************************************************************************/
 /*!
-    @brief  Draws a single smallfont character
+    @brief  Sends a vertical line to the active tile, or directly to
+            the LCD if no tile is open
 */
 /**************************************************************************/
-void drawCharSmall(uint16_t x, uint16_t y, uint16_t color, uint8_t c, struct FONT_DEF font)
+static void drawTargetVLine(uint16_t x, uint16_t y0, uint16_t y1, uint16_t color)
 {
-  uint8_t col, column[font.u8Width];
-
-  // Check if the requested character is available
-  if ((c >= font.u8FirstChar) && (c <= font.u8LastChar))
+  #ifdef DRAW_TILES
+  if (drawTileActive)
   {
-    // Retrieve appropriate columns from font data
-    for (col = 0; col < font.u8Width; col++)
+    uint16_t y;
+    if (y1 < y0)
     {
-      column[col] = font.au8FontTable[((c - 32) * font.u8Width) + col];    // Get first column of appropriate character
+      y = y0; y0 = y1; y1 = y;
     }
-  }
-  else
-  {    
-    // Requested character is not available in this font ... send a space instead
-    for (col = 0; col < font.u8Width; col++)
+    for (y = y0; y <= y1; y++)
     {
-      column[col] = 0xFF;    // Send solid space
+      drawTargetHLine(x, x, y, color);
     }
+    return;
   }
+  #endif
 
-  // Render each column
-  uint16_t xoffset, yoffset;
-  for (xoffset = 0; xoffset < font.u8Width; xoffset++)
+  lcdDrawVLine(x, y0, y1, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Fills an on-screen rectangle (already sorted and clipped) in
+            the active tile, or directly on the LCD if no tile is open
+*/
+/**************************************************************************/
+static void drawTargetFill(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color)
+{
+  #ifdef DRAW_TILES
+  if (drawTileActive)
   {
-    for (yoffset = 0; yoffset < (font.u8Height + 1); yoffset++)
+    uint16_t y;
+    if (y0 < drawTileY0) y0 = drawTileY0;
+    if (y1 > drawTileY1) y1 = drawTileY1;
+    for (y = y0; y <= y1; y++)
     {
-      uint8_t bit = 0x00;
-      bit = (column[xoffset] << (8 - (yoffset + 1)));     // Shift current row bit left
-      bit = (bit >> 7);                     // Shift current row but right (results in 0x01 for black, and 0x00 for white)
-      if (bit)
-      {
-        drawPixel(x + xoffset, y + yoffset, color);
-      }
+      drawTargetHLine(x0, x1, y, color);
     }
+    return;
   }
+  #endif
+
+  // Fill the whole area in one burst, letting the controller wrap lines
+  lcdSetWindow(x0, y0, x1, y1);
+  lcdStreamFill(color, (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1));
 }
-#endif
 
 /**************************************************************************/
 /*!
-    @brief  Helper method to accurately draw individual circle points
+    @brief  Draws a horizontal run given in signed co-ordinates, clipping
+            it to the screen (used by the circle and line rasterizers,
+            which can generate points off the edge of the screen)
 */
 /**************************************************************************/
-void drawCirclePoints(int cx, int cy, int x, int y, uint16_t color)
-{    
-  if (x == 0) 
-  {
-      drawPixel(cx, cy + y, color);
-      drawPixel(cx, cy - y, color);
-      drawPixel(cx + y, cy, color);
-      drawPixel(cx - y, cy, color);
-  } 
-  else if (x == y) 
-  {
-      drawPixel(cx + x, cy + y, color);
-      drawPixel(cx - x, cy + y, color);
-      drawPixel(cx + x, cy - y, color);
-      drawPixel(cx - x, cy - y, color);
-  } 
-  else if (x < y) 
+static void drawSpanH(int32_t x0, int32_t x1, int32_t y, uint16_t color)
+{
+  int32_t width = lcdGetWidth();
+
+  if ((y < 0) || (y >= lcdGetHeight()) || (x1 < 0) || (x0 >= width) || (x1 < x0))
   {
-      drawPixel(cx + x, cy + y, color);
-      drawPixel(cx - x, cy + y, color);
-      drawPixel(cx + x, cy - y, color);
-      drawPixel(cx - x, cy - y, color);
-      drawPixel(cx + y, cy + x, color);
-      drawPixel(cx - y, cy + x, color);
-      drawPixel(cx + y, cy - x, color);
-      drawPixel(cx - y, cy - x, color);
+    return;
   }
+  if (x0 < 0) x0 = 0;
+  if (x1 >= width) x1 = width - 1;
+  drawTargetHLine(x0, x1, y, color);
 }
 
-/**************************************************************************/
-/*                                                                        */
-/* ----------------------- Public Methods ------------------------------- */
-/*                                                                        */
-/**************************************************************************/
-
 /**************************************************************************/
 /*!
-    @brief  Draws a single pixel at the specified location
-
-    @param[in]  x
-                Horizontal position
-    @param[in]  y
-                Vertical position
-    @param[in]  color
-                Color used when drawing
+    @brief  Draws a vertical run given in signed co-ordinates, clipping
+            it to the screen
 */
 /**************************************************************************/
-void drawPixel(uint16_t x, uint16_t y, uint16_t color)
+static void drawSpanV(int32_t x, int32_t y0, int32_t y1, uint16_t color)
 {
-  if ((x >= lcdGetWidth()) || (y >= lcdGetHeight()))
+  int32_t height = lcdGetHeight();
+
+  if ((x < 0) || (x >= lcdGetWidth()) || (y1 < 0) || (y0 >= height) || (y1 < y0))
   {
-    // Pixel out of range
     return;
   }
-
-  // Redirect to LCD
-  lcdDrawPixel(x, y, color);
+  if (y0 < 0) y0 = 0;
+  if (y1 >= height) y1 = height - 1;
+  drawTargetVLine(x, y0, y1, color);
 }
 
 /**************************************************************************/
 /*!
-    @brief  Fills the screen with the specified color
-
-    @param[in]  color
-                Color used when drawing
+    @brief  Fills a rectangle whose corners are quarter circles of the
+            specified radius, one horizontal run per line
+
+    Each bit of 'corners' rounds one corner (1 = top left, 2 = top
+    right, 4 = bottom left, 8 = bottom right), and square corners
+    extend to the edge of the rectangle.  The middle band between the
+    corner rows is sent as a single filled rectangle.  A filled circle
+    is simply a square of 2 * radius + 1 pixels with four round
+    corners.
 */
 /**************************************************************************/
-void drawFill(uint16_t color)
+static void drawRoundedSpans(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t radius, uint8_t corners, uint16_t color)
 {
-  lcdFillRGB(color);
+  int32_t f = 1 - radius;
+  int32_t ddF_x = 1;
+  int32_t ddF_y = -2 * radius;
+  int32_t x = 0;
+  int32_t y = radius;
+  int32_t cx0 = x0 + radius, cx1 = x1 - radius;
+  int32_t cy0 = y0 + radius, cy1 = y1 - radius;
+  int32_t top0 = (corners & 1) ? 0 : 1, top1 = (corners & 2) ? 0 : 1;
+  int32_t bot0 = (corners & 4) ? 0 : 1, bot1 = (corners & 8) ? 0 : 1;
+
+  // top0 etc. select between the round edge (cx0 - w) and the square one (x0)
+  #define DRAW_ROUNDEDROW(dy, w) \
+    do { \
+      drawSpanH(top0 ? x0 : cx0 - (w), top1 ? x1 : cx1 + (w), cy0 - (dy), color); \
+      drawSpanH(bot0 ? x0 : cx0 - (w), bot1 ? x1 : cx1 + (w), cy1 + (dy), color); \
+    } while (0)
+
+  // Everything between the corner centres is a plain rectangle
+  if ((cy0 <= cy1) && (cy1 >= 0) && (x1 >= 0))
+  {
+    drawRectangleFilled(x0 < 0 ? 0 : x0, cy0 < 0 ? 0 : cy0, x1, cy1 < 0 ? 0 : cy1, color);
+  }
+
+  while (x < y)
+  {
+    if (f >= 0)
+    {
+      // Row 'y' won't get any wider, so it can be drawn now
+      DRAW_ROUNDEDROW(y, x);
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    DRAW_ROUNDEDROW(x, y);
+  }
+  if (y > x)
+  {
+    DRAW_ROUNDEDROW(y, x);
+  }
+
+  #undef DRAW_ROUNDEDROW
 }
 
 /**************************************************************************/
 /*!
-    @brief  Draws a simple color test pattern
+    @brief  Draws a single bitmap character
+
+    Glyphs are stored column by column, with the bottom page of each
+    column first.  Rather than setting every lit pixel individually,
+    each glyph row is scanned for runs of set bits and every run is
+    sent to the LCD as a single horizontal line.
 */
 /**************************************************************************/
-void drawTestPattern(void)
+void drawCharBitmap(const uint16_t xPixel, const uint16_t yPixel, uint16_t color, const uint8_t *glyph, uint8_t glyphHeightPages, uint8_t glyphWidthBits)
 {
-  lcdTest();
+  uint16_t row, col, start, page;
+  uint8_t mask;
+  int32_t y;
+  uint16_t lcdWidth = lcdGetWidth();
+  uint16_t lcdHeight = lcdGetHeight();
+
+  // for each glyph row, starting at the top
+  for (row = 0; row < glyphHeightPages * 8; row++)
+  {
+    // rows run upwards from the bottom bit of each page
+    y = (int32_t)yPixel - 7 + row;
+    if ((y < 0) || (y >= lcdHeight))
+    {
+      continue;
+    }
+    page = glyphHeightPages - 1 - (row >> 3);
+    mask = 1 << (row & 7);
+
+    // find runs of set pixels along the row
+    col = 0;
+    while (col < glyphWidthBits)
+    {
+      if (!(glyph[glyphHeightPages * col + page] & mask))
+      {
+        col++;
+        continue;
+      }
+      start = col;
+      while ((col < glyphWidthBits) && (glyph[glyphHeightPages * col + page] & mask))
+      {
+        col++;
+      }
+      if (xPixel + start < lcdWidth)
+      {
+        drawTargetHLine(xPixel + start, xPixel + col - 1, y, color);
+      }
+    }
+  }
 }
 
-#if defined CFG_TFTLCD_INCLUDESMALLFONTS & CFG_TFTLCD_INCLUDESMALLFONTS == 1
 /**************************************************************************/
 /*!
-    @brief  Draws a string using a small font (6 of 8 pixels high).
+    @brief  Draws a single bitmap character on a solid background
 
-    @param[in]  x
-                Starting x co-ordinate
-    @param[in]  y
-                Starting y co-ordinate
-    @param[in]  color
-                Color to use when rendering the font
-    @param[in]  text
-                The string to render
-    @param[in]  font
-                Pointer to the FONT_DEF to use when drawing the string
+    The glyph plus the one pixel spacing column to its right are
+    expanded row by row into a small RGB565 buffer and streamed
+    through a single LCD window, so every pixel of the character cell
+    is written exactly once.  Characters that don't fit entirely on
+    the screen fall back to the transparent renderer.
+*/
+/**************************************************************************/
+void drawCharBitmapOpaque(const uint16_t xPixel, const uint16_t yPixel, uint16_t color, uint16_t bgcolor, const uint8_t *glyph, uint8_t glyphHeightPages, uint8_t glyphWidthBits)
+{
+  uint16_t buffer[16];
+  uint16_t row, col, page, count;
+  uint8_t mask;
+  uint16_t cellHeight = glyphHeightPages * 8;
+  uint16_t cellWidth = glyphWidthBits + 1;
 
-    @section Example
+  if ((yPixel < 7) || (yPixel - 7 + cellHeight > lcdGetHeight()) || (xPixel + cellWidth > lcdGetWidth()))
+  {
+    drawCharBitmap(xPixel, yPixel, color, glyph, glyphHeightPages, glyphWidthBits);
+    return;
+  }
 
-    @code 
+  #ifdef DRAW_TILES
+  if (drawTileActive)
+  {
+    // The tile is already in RAM, so just paint the cell and the glyph
+    drawTargetFill(xPixel, yPixel - 7, xPixel + cellWidth - 1, yPixel - 8 + cellHeight, bgcolor);
+    drawCharBitmap(xPixel, yPixel, color, glyph, glyphHeightPages, glyphWidthBits);
+    return;
+  }
+  #endif
 
-    #include "drivers/lcd/fonts/smallfonts.h"
-    
-    drawStringSmall(1, 210, COLOR_WHITE, "5x8 System (Max 40 Characters)", Font_System5x8);
-    drawStringSmall(1, 220, COLOR_WHITE, "7x8 System (Max 30 Characters)", Font_System7x8);
+  lcdSetWindow(xPixel, yPixel - 7, xPixel + cellWidth - 1, yPixel - 8 + cellHeight);
 
-    @endcode
-*/
-/**************************************************************************/
-void drawStringSmall(uint16_t x, uint16_t y, uint16_t color, char* text, struct FONT_DEF font)
-{
-  uint8_t l;
-  for (l = 0; l < strlen(text); l++)
+  count = 0;
+  for (row = 0; row < cellHeight; row++)
   {
-    drawCharSmall(x + (l * (font.u8Width + 1)), y, color, text[l], font);
+    page = glyphHeightPages - 1 - (row >> 3);
+    mask = 1 << (row & 7);
+    for (col = 0; col < cellWidth; col++)
+    {
+      if ((col < glyphWidthBits) && (glyph[glyphHeightPages * col + page] & mask))
+      {
+        buffer[count++] = color;
+      }
+      else
+      {
+        buffer[count++] = bgcolor;
+      }
+      if (count == 16)
+      {
+        lcdStreamPixels(buffer, count);
+        count = 0;
+      }
+    }
+  }
+  if (count)
+  {
+    lcdStreamPixels(buffer, count);
   }
 }
-#endif
 
 /**************************************************************************/
 /*!
-    @brief  Draws a string using the supplied font
-
-    @param[in]  x
-                Starting x co-ordinate
-    @param[in]  y
-                Starting y co-ordinate
-    @param[in]  color
-                Color to use when rendering the font
-    @param[in]  fontInfo
-                Pointer to the FONT_INFO to use when drawing the string
-    @param[in]  str
-                The string to render
-
-    @section Example
-
-    @code 
-
-    #include "drivers/lcd/tft/fonts/veramono9.h"
-    
-    drawString(0, 90,  COLOR_BLACK, &bitstreamVeraSansMono9ptFontInfo, "Vera Mono 9 (30 chars wide)");
-    drawString(0, 105, COLOR_BLACK, &bitstreamVeraSansMono9ptFontInfo, "123456789012345678901234567890");
+    @brief  Draws a single run-length encoded character
 
-    @endcode
+    See bitmapfonts.h for a description of FONT_FORMAT_RLE.  Every
+    run is sent to the LCD as a horizontal line without having to
+    scan the glyph bit by bit.
 */
 /**************************************************************************/
-void drawString(uint16_t x, uint16_t y, uint16_t color, const FONT_INFO *fontInfo, char *str)
+void drawCharRle(const uint16_t xPixel, const uint16_t yPixel, uint16_t color, const uint8_t *glyph)
 {
-  uint16_t currentX, charWidth, characterToOutput;
-  const FONT_CHAR_INFO *charInfo;
-  uint16_t charOffset;
+  uint16_t row, last, col;
+  uint8_t run, len;
+  int32_t y;
+  uint16_t lcdWidth = lcdGetWidth();
+  uint16_t lcdHeight = lcdGetHeight();
 
-  // set current x, y to that of requested
-  currentX = x;
+  row = glyph[0] >> 4;
+  last = row + (glyph[0] & 0x0F);
+  glyph++;
 
-  // while not NULL
-  while (*str != '\0')
+  for ( ; row <= last; row++)
   {
-    // get character to output
-    characterToOutput = *str;
-    
-    // get char info
-    charInfo = fontInfo->charInfo;
-    
-    // some fonts have character descriptors, some don't
-    if (charInfo != NULL)
+    y = (int32_t)yPixel - 7 + row;
+    col = xPixel;
+    do
     {
-      // get correct char offset
-      charInfo += (characterToOutput - fontInfo->startChar);
-      
-      // get width from char info
-      charWidth = charInfo->widthBits;
-      
-      // get offset from char info
-      charOffset = charInfo->offset;
-    }        
-    else
-    {
-      // if no char info, char width is always 5
-      charWidth = 5;
-      
-      // char offset - assume 5 * letter offset
-      charOffset = (characterToOutput - fontInfo->startChar) * 5;
-    }        
-    
-    // Send individual characters
-    drawCharBitmap(currentX, y, color, &fontInfo->data[charOffset], fontInfo->heightPages, charWidth);
-
-    // next char X
-    currentX += charWidth + 1;
-    
-    // next char
-    str++;
+      run = *glyph++;
+      col += (run >> 4) & 0x07;
+      len = run & 0x0F;
+      if (len && (y >= 0) && (y < lcdHeight) && (col < lcdWidth))
+      {
+        drawTargetHLine(col, col + len - 1, y, color);
+      }
+      col += len;
+    } while (!(run & 0x80));
   }
 }
 
 /**************************************************************************/
 /*!
-    @brief  Returns the width in pixels of a string when it is rendered
-
-    This method can be used to determine whether a string will fit
-    inside a specific area, or if it needs to be broken up into multiple
-    lines to be properly rendered on the screen.
-
-    This function only applied to bitmap fonts (which can have variable
-    widths).  All smallfonts (if available) are fixed width and can
-    easily have their width calculated without costly functions like
-    this one.
+    @brief  Draws a single run-length encoded character on a solid
+            background
 
-    @param[in]  fontInfo
-                Pointer to the FONT_INFO for the font that will be used
-    @param[in]  str
-                The string that will be rendered
+    Each row is decoded into a bit mask and streamed through a single
+    LCD window, the same way drawCharBitmapOpaque does it.
 */
 /**************************************************************************/
-uint16_t drawGetStringWidth(const FONT_INFO *fontInfo, char *str)
+void drawCharRleOpaque(const uint16_t xPixel, const uint16_t yPixel, uint16_t color, uint16_t bgcolor, const uint8_t *glyph, uint8_t glyphHeightPages, uint8_t glyphWidthBits)
 {
-  uint16_t width = 0;
-  uint32_t currChar;
-  uint32_t startChar = fontInfo->startChar;
+  uint16_t buffer[16];
+  uint16_t row, first, last, col, count;
+  uint32_t bits;
+  uint8_t run, len;
+  const uint8_t *runs;
+  uint16_t cellHeight = glyphHeightPages * 8;
+  uint16_t cellWidth = glyphWidthBits + 1;
+
+  if ((yPixel < 7) || (yPixel - 7 + cellHeight > lcdGetHeight()) || (xPixel + cellWidth > lcdGetWidth()) || (cellWidth > 32))
+  {
+    drawCharRle(xPixel, yPixel, color, glyph);
+    return;
+  }
 
-  // until termination
-  for (currChar = *str; currChar; currChar = *(++str))
+  #ifdef DRAW_TILES
+  if (drawTileActive)
+  {
+    // The tile is already in RAM, so just paint the cell and the glyph
+    drawTargetFill(xPixel, yPixel - 7, xPixel + cellWidth - 1, yPixel - 8 + cellHeight, bgcolor);
+    drawCharRle(xPixel, yPixel, color, glyph);
+    return;
+  }
+  #endif
+
+  first = glyph[0] >> 4;
+  last = first + (glyph[0] & 0x0F);
+  runs = glyph + 1;
+
+  lcdSetWindow(xPixel, yPixel - 7, xPixel + cellWidth - 1, yPixel - 8 + cellHeight);
+
+  count = 0;
+  for (row = 0; row < cellHeight; row++)
   {
-    // if char info exists for the font, use width from there
-    if (fontInfo->charInfo != NULL)
+    // Decode the row into a bit mask (bit 0 = leftmost pixel)
+    bits = 0;
+    if ((row >= first) && (row <= last))
     {
-      width += fontInfo->charInfo[currChar - startChar].widthBits + 1;
+      col = 0;
+      do
+      {
+        run = *runs++;
+        col += (run >> 4) & 0x07;
+        len = run & 0x0F;
+        bits |= ((1UL << len) - 1) << col;
+        col += len;
+      } while (!(run & 0x80));
     }
-    else
+
+    for (col = 0; col < cellWidth; col++)
     {
-      width += 5 + 1;
+      buffer[count++] = (bits & 1) ? color : bgcolor;
+      bits >>= 1;
+      if (count == 16)
+      {
+        lcdStreamPixels(buffer, count);
+        count = 0;
+      }
     }
   }
-
-  /* return the wdith */
-  return width;
+  if (count)
+  {
+    lcdStreamPixels(buffer, count);
+  }
 }
 
 /**************************************************************************/
 /*!
-    @brief  Draws a bresenham line
+    @brief  Fills 'table' with 'levels' colors blended evenly from
+            'bgcolor' (entry 0) to 'color' (last entry)
 
-    @param[in]  x0
-                Starting x co-ordinate
-    @param[in]  y0
-                Starting y co-ordinate
-    @param[in]  x1
-                Ending x co-ordinate
-    @param[in]  y1
-                Ending y co-ordinate
-    @param[in]  color
-                Color used when drawing
+    This is done once per string so that anti-aliased glyphs only
+    cost a table lookup per pixel.
 */
 /**************************************************************************/
-void drawLine ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color )
+static void drawBlendTable(uint16_t color, uint16_t bgcolor, uint8_t levels, uint16_t *table)
 {
-  drawLineDotted(x0, y0, x1, y1, 0, 1, color);
+  uint8_t i, max = levels - 1;
+  int32_t r = bgcolor >> 11, g = (bgcolor >> 5) & 0x3F, b = bgcolor & 0x1F;
+  int32_t dr = (int32_t)(color >> 11) - r;
+  int32_t dg = (int32_t)((color >> 5) & 0x3F) - g;
+  int32_t db = (int32_t)(color & 0x1F) - b;
+
+  for (i = 0; i < levels; i++)
+  {
+    table[i] = ((r + (dr * i + max / 2) / max) << 11) |
+               ((g + (dg * i + max / 2) / max) << 5) |
+                (b + (db * i + max / 2) / max);
+  }
+  // Make sure the end points are exact despite rounding
+  table[0] = bgcolor;
+  table[max] = color;
 }
 
 /**************************************************************************/
 /*!
-    @brief  Draws a bresenham line with a fixed pattern of empty
-            and solid pixels
-
-    Based on: http://www.cs.unc.edu/~mcmillan/comp136/Lecture6/Lines.html
+    @brief  Draws a single anti-aliased (FONT_FORMAT_AA2/AA4) character
 
-    @param[in]  x0
-                Starting x co-ordinate
-    @param[in]  y0
-                Starting y co-ordinate
-    @param[in]  x1
-                Ending x co-ordinate
-    @param[in]  y1
-                Ending y co-ordinate
-    @param[in]  empty
-                The number of 'empty' pixels to render
-    @param[in]  solid
-                The number of 'solid' pixels to render
-    @param[in]  color
-                Color used when drawing
+    On a solid background the character cell (plus the one pixel
+    spacing column) is converted through the blend table and streamed
+    through a single LCD window.  Without a background there is no
+    colour to blend with, so pixels that are at least half covered are
+    drawn as solid runs in the foreground colour (table[levels - 1]).
 */
 /**************************************************************************/
-void drawLineDotted ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t empty, uint16_t solid, uint16_t color )
+void drawCharAntialiased(const uint16_t xPixel, const uint16_t yPixel, const uint16_t *table, bool opaque, const uint8_t *glyph, uint8_t glyphHeightPages, uint8_t glyphWidthBits, uint8_t bitsPerPixel)
 {
-  if (solid == 0)
-  {
-    return;
-  }
-
-  // If a negative y int was passed in it will overflow to 65K something
-  // Ugly, but drawCircleFilled() can pass in negative values so we need
-  // to check the values here
-  y0 = y0 > 65000 ? 0 : y0;
-  y1 = y1 > 65000 ? 0 : y1;
-
-  // Check if we can use the optimised horizontal line method
-  if ((y0 == y1) && (empty == 0))
+  uint16_t buffer[16];
+  uint16_t row, col, count, start;
+  uint32_t bit;
+  int32_t y;
+  uint8_t value;
+  uint8_t mask = (1 << bitsPerPixel) - 1;
+  uint8_t threshold = (mask + 1) / 2;
+  uint16_t cellHeight = glyphHeightPages * 8;
+  uint16_t cellWidth = glyphWidthBits + 1;
+  uint16_t lcdWidth = lcdGetWidth();
+  uint16_t lcdHeight = lcdGetHeight();
+  bool direct = opaque && (yPixel >= 7) && (yPixel - 7 + cellHeight <= lcdHeight) && (xPixel + cellWidth <= lcdWidth);
+
+  #ifdef DRAW_TILES
+  if (drawTileActive)
   {
-    lcdDrawHLine(x0, x1, y0, color);
-    return;
+    direct = FALSE;
   }
+  #endif
 
-  // Check if we can use the optimised vertical line method.
-  // This can make a huge difference in performance, but may
-  // not work properly on every LCD controller:
-  // ex.: drawCircleFilled(120, 160, 50, COLOR_RED);
-  //      = 678834 cycles using lcdDrawVLine w/ILI9328   =  9.43mS @ 72MHz
-  //      = 7546261 w/o lcdDrawVLine, setting each pixel = 104.8mS @ 72MHz
-  if ((x0 == x1) && (empty == 0))
+  if (direct)
   {
-    // Warning: This may actually be slower than drawing individual pixels on 
-    // short lines ... Set a minimum line size to use the 'optimised' method
-    // (which changes the screen orientation) ?
-    lcdDrawVLine(x0, y0, y1, color);
-    return;
+    lcdSetWindow(xPixel, yPixel - 7, xPixel + cellWidth - 1, yPixel - 8 + cellHeight);
   }
 
-  // Draw non-horizontal or dotted line
-  int dy = y1 - y0;
-  int dx = x1 - x0;
-  int stepx, stepy;
-  int emptycount, solidcount;
-
-  if (dy < 0) { dy = -dy;  stepy = -1; } else { stepy = 1; }
-  if (dx < 0) { dx = -dx;  stepx = -1; } else { stepx = 1; }
-  dy <<= 1;                               // dy is now 2*dy
-  dx <<= 1;                               // dx is now 2*dx
-
-  emptycount = empty;
-  solidcount = solid;
-
-  drawPixel(x0, y0, color);               // always start with solid pixels
-  solidcount--;
-  if (dx > dy) 
+  bit = 0;
+  count = 0;
+  for (row = 0; row < cellHeight; row++)
   {
-    int fraction = dy - (dx >> 1);        // same as 2*dy - dx
-    while (x0 != x1) 
+    y = (int32_t)yPixel - 7 + row;
+    start = cellWidth;
+    for (col = 0; col < cellWidth; col++)
     {
-      if (fraction >= 0) 
-      {
-        y0 += stepy;
-        fraction -= dx;                   // same as fraction -= 2*dx
-      }
-      x0 += stepx;
-      fraction += dy;                     // same as fraction -= 2*dy
-      if (empty == 0)
-      {
-        // always draw a pixel ... no dotted line requested
-        drawPixel(x0, y0, color);
-      }
-      else if (solidcount)
-      {
-        // Draw solid pxiel and decrement counter
-        drawPixel(x0, y0, color);
-        solidcount--;
-      }
-      else if(emptycount)
-      {
-        // Empty pixel ... don't draw anything an decrement counter
-        emptycount--;
-      }
-      else
+      value = 0;
+      if (col < glyphWidthBits)
       {
-        // Reset counters and draw solid pixel
-        emptycount = empty;
-        solidcount = solid;
-        drawPixel(x0, y0, color);
-        solidcount--;
+        value = (glyph[bit >> 3] >> (8 - bitsPerPixel - (bit & 7))) & mask;
+        bit += bitsPerPixel;
       }
-    }
-  } 
-  else 
-  {
-    int fraction = dx - (dy >> 1);
-    while (y0 != y1) 
-    {
-      if (fraction >= 0) 
+
+      if (direct)
       {
-        x0 += stepx;
-        fraction -= dy;
+        buffer[count++] = table[value];
+        if (count == 16)
+        {
+          lcdStreamPixels(buffer, count);
+          count = 0;
+        }
       }
-      y0 += stepy;
-      fraction += dx;
-      if (empty == 0)
+      else if ((y < 0) || (y >= lcdHeight) || (xPixel + col >= lcdWidth))
       {
-        // always draw a pixel ... no dotted line requested
-        drawPixel(x0, y0, color);
+        continue;
       }
-      if (solidcount)
+      else if (opaque)
       {
-        // Draw solid pxiel and decrement counter
-        drawPixel(x0, y0, color);
-        solidcount--;
+        // Clipped or rendering into a tile, so send pixels one by one
+        drawTargetHLine(xPixel + col, xPixel + col, y, table[value]);
       }
-      else if(emptycount)
+      else if (value >= threshold)
       {
-        // Empty pixel ... don't draw anything an decrement counter
-        emptycount--;
+        if (start == cellWidth)
+        {
+          start = col;
+        }
+        if ((col + 1 == glyphWidthBits) || (xPixel + col + 1 == lcdWidth))
+        {
+          drawTargetHLine(xPixel + start, xPixel + col, y, table[mask]);
+          start = cellWidth;
+        }
       }
-      else
+      else if (start != cellWidth)
       {
-        // Reset counters and draw solid pixel
-        emptycount = empty;
-        solidcount = solid;
-        drawPixel(x0, y0, color);
-        solidcount--;
+        drawTargetHLine(xPixel + start, xPixel + col - 1, y, table[mask]);
+        start = cellWidth;
       }
     }
   }
+  if (count)
+  {
+    lcdStreamPixels(buffer, count);
+  }
 }
 
 /**************************************************************************/
 /*!
-    @brief  Draws a circle
-
-    Based on: http://www.cs.unc.edu/~mcmillan/comp136/Lecture7/circle.html
-
-    @param[in]  xCenter
-                The horizontal center of the circle
-    @param[in]  yCenter
-                The vertical center of the circle
-    @param[in]  radius
-                The circle's radius in pixels
-    @param[in]  color
-                Color used when drawing
+    @brief  Returns the number of coverage bits per pixel for
+            anti-aliased fonts (0 for 1bpp fonts), and fills 'blend'
+            with the colors to use for each coverage level
 */
 /**************************************************************************/
-void drawCircle (uint16_t xCenter, uint16_t yCenter, uint16_t radius, uint16_t color)
+static uint8_t drawFontBlendTable(const FONT_INFO *fontInfo, uint16_t color, uint16_t bgcolor, uint16_t *blend)
 {
-  int x = 0;
-  int y = radius;
-  int p = (5 - radius*4)/4;
+  uint8_t bitsPerPixel = 0;
 
-  drawCirclePoints(xCenter, yCenter, x, y, color);
-  while (x < y) 
+  if (fontInfo->format == FONT_FORMAT_AA2)
   {
-    x++;
-    if (p < 0) 
-    {
-      p += 2*x+1;
-    } 
-    else 
-    {
-      y--;
-      p += 2*(x-y)+1;
-    }
-    drawCirclePoints(xCenter, yCenter, x, y, color);
+    bitsPerPixel = 2;
+  }
+  else if (fontInfo->format == FONT_FORMAT_AA4)
+  {
+    bitsPerPixel = 4;
+  }
+  if (bitsPerPixel)
+  {
+    drawBlendTable(color, bgcolor, 1 << bitsPerPixel, blend);
   }
+
+  return bitsPerPixel;
 }
 
 /**************************************************************************/
 /*!
-    @brief  Draws a filled circle
-
-    @param[in]  xCenter
-                The horizontal center of the circle
-    @param[in]  yCenter
-                The vertical center of the circle
-    @param[in]  radius
-                The circle's radius in pixels
-    @param[in]  color
-                Color used when drawing
+    @brief  Returns the width in pixels of a single character, not
+            including the one pixel spacing column
 */
 /**************************************************************************/
-void drawCircleFilled (uint16_t xCenter, uint16_t yCenter, uint16_t radius, uint16_t color)
+static uint16_t drawGetCharWidth(const FONT_INFO *fontInfo, char c)
 {
-  int16_t f = 1 - radius;
-  int16_t ddF_x = 1;
-  int16_t ddF_y = -2 * radius;
-  int16_t x = 0;
-  int16_t y = radius;
-  int16_t xc_px, yc_my, xc_mx, xc_py, yc_mx, xc_my;
-  int16_t lcdWidth = lcdGetWidth();
-
-  if (xCenter < lcdWidth) drawLine(xCenter, yCenter-radius < 0 ? 0 : yCenter-radius, xCenter, (yCenter-radius) + (2*radius), color);
-  
-  while (x<y) 
+  // some fonts have character descriptors, some don't
+  if (fontInfo->charInfo != NULL)
   {
-    if (f >= 0) 
-    {
-      y--;
-      ddF_y += 2;
-      f += ddF_y;
-    }
-    x++;
-    ddF_x += 2;
-    f += ddF_x;
-
-    xc_px = xCenter+x;
-    xc_mx = xCenter-x;
-    xc_py = xCenter+y;
-    xc_my = xCenter-y;
-    yc_mx = yCenter-x;
-    yc_my = yCenter-y;
-
-    // Make sure X positions are not negative or too large or the pixels will
-    // overflow.  Y overflow is handled in drawLine().
-    if ((xc_px < lcdWidth) && (xc_px >= 0)) drawLine(xc_px, yc_my, xc_px, yc_my + 2*y, color);
-    if ((xc_mx < lcdWidth) && (xc_mx >= 0)) drawLine(xc_mx, yc_my, xc_mx, yc_my + 2*y, color);
-    if ((xc_py < lcdWidth) && (xc_py >= 0)) drawLine(xc_py, yc_mx, xc_py, yc_mx + 2*x, color);
-    if ((xc_my < lcdWidth) && (xc_my >= 0)) drawLine(xc_my, yc_mx, xc_my, yc_mx + 2*x, color);
+    return fontInfo->charInfo[(uint8_t)c - fontInfo->startChar].widthBits;
   }
+
+  // if no char info, char width is always 5
+  return 5;
 }
 
 /**************************************************************************/
 /*!
-    @brief  Draws a simple arrow of the specified width
-
-    @param[in]  x
-                X co-ordinate of the smallest point of the arrow
-    @param[in]  y
-                Y co-ordinate of the smallest point of the arrow
-    @param[in]  size
-                Total width/height of the arrow in pixels
-    @param[in]  direction
-                The direction that the arrow is pointing
-    @param[in]  color
-                Color used when drawing
+    @brief  Returns a pointer to the glyph data of a single character
+            (NULL if a font loaded by fontcache.c couldn't be read)
 */
 /**************************************************************************/
-void drawArrow(uint16_t x, uint16_t y, uint16_t size, drawDirection_t direction, uint16_t color)
+static const uint8_t *drawGetGlyph(const FONT_INFO *fontInfo, char c)
 {
-  drawPixel(x, y, color);
+  uint16_t charOffset;
+  uint16_t characterToOutput = (uint8_t)c;
 
-  if (size == 1)
+  if (fontInfo->charInfo != NULL)
   {
-    return;
+    // get offset from char info
+    charOffset = fontInfo->charInfo[characterToOutput - fontInfo->startChar].offset;
+  }
+  else
+  {
+    // char offset - assume 5 * letter offset
+    charOffset = (characterToOutput - fontInfo->startChar) * 5;
   }
 
-  uint32_t i;
-  switch (direction)
+  #if defined CFG_TFTLCD_FONTCACHE && CFG_TFTLCD_FONTCACHE > 0
+  if (fontInfo->data == NULL)
   {
-    case DRAW_DIRECTION_LEFT:
-      for (i = 1; i<size; i++)
-      {
-        drawLine(x+i, y-i, x+i, y+i, color);
-      }
-      break;
-    case DRAW_DIRECTION_RIGHT:
-      for (i = 1; i<size; i++)
-      {
-        drawLine(x-i, y-i, x-i, y+i, color);
-      }
-      break;
-    case DRAW_DIRECTION_UP:
-      for (i = 1; i<size; i++)
-      {
-        drawLine(x-i, y+i, x+i, y+i, color);
-      }
-      break;
-    case DRAW_DIRECTION_DOWN:
-      for (i = 1; i<size; i++)
-      {
-        drawLine(x-i, y-i, x+i, y-i, color);
-      }
-      break;
-    default:
-      break;
+    // Font loaded from the SD card, the glyph comes from the RAM cache
+    return fontCacheGetGlyph(fontInfo, characterToOutput - fontInfo->startChar);
   }
+  #endif
+
+  return &fontInfo->data[charOffset];
 }
 
 /**************************************************************************/
 /*!
-    @brief  Draws a simple (empty) rectangle
-
-    @param[in]  x0
-                Starting x co-ordinate
-    @param[in]  y0
-                Starting y co-ordinate
-    @param[in]  x1
-                Ending x co-ordinate
-    @param[in]  y1
-                Ending y co-ordinate
-    @param[in]  color
-                Color used when drawing
+    @brief  Renders a single character in any of the bitmap font
+            formats, returning its width (shared by drawStringBitmap and
+            drawStringLayout)
 */
 /**************************************************************************/
-void drawRectangle ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color)
+static uint16_t drawCharFont(uint16_t x, uint16_t y, uint16_t color, uint16_t bgcolor, bool opaque, const FONT_INFO *fontInfo, char c, const uint16_t *blend, uint8_t bitsPerPixel)
 {
-  uint16_t x, y;
+  uint16_t charWidth;
+  const uint8_t *glyph;
 
-  if (y1 < y0)
+  charWidth = drawGetCharWidth(fontInfo, c);
+  glyph = drawGetGlyph(fontInfo, c);
+  if (glyph == NULL)
   {
-    // Switch y1 and y0
-    y = y1;
-    y1 = y0;
-    y0 = y;
+    return charWidth;
   }
 
-  if (x1 < x0)
+  // Send individual characters
+  if (bitsPerPixel)
   {
-    // Switch x1 and x0
-    x = x1;
-    x1 = x0;
-    x0 = x;
+    drawCharAntialiased(x, y, blend, opaque, glyph, fontInfo->heightPages, charWidth, bitsPerPixel);
   }
-
-  drawLine (x0, y0, x1, y0, color);
-  drawLine (x1, y0, x1, y1, color);
-  drawLine (x1, y1, x0, y1, color);
-  drawLine (x0, y1, x0, y0, color);
+  else if (fontInfo->format == FONT_FORMAT_RLE)
+  {
+    if (opaque)
+    {
+      drawCharRleOpaque(x, y, color, bgcolor, glyph, fontInfo->heightPages, charWidth);
+    }
+    else
+    {
+      drawCharRle(x, y, color, glyph);
+    }
+  }
+  else if (opaque)
+  {
+    drawCharBitmapOpaque(x, y, color, bgcolor, glyph, fontInfo->heightPages, charWidth);
+  }
+  else
+  {
+    drawCharBitmap(x, y, color, glyph, fontInfo->heightPages, charWidth);
+  }
+
+  return charWidth;
 }
 
 /**************************************************************************/
 /*!
-    @brief  Draws a filled rectangle
-
-    @param[in]  x0
-                Starting x co-ordinate
-    @param[in]  y0
-                Starting y co-ordinate
-    @param[in]  x1
-                Ending x co-ordinate
-    @param[in]  y1
-                Ending y co-ordinate
+    @brief  Expands a single character into an RGB565 buffer instead of
+            sending it to the LCD, returning the width of the glyph
+
+    The buffer holds 'width' pixels per row and fontInfo->heightPages * 8
+    rows, and is filled with 'bgcolor' before the glyph is rendered
+    'xOffset' pixels from the left edge (anything past 'width' is cut
+    off).  All the bitmap font formats are supported, so the result can
+    be sent later with lcdSetWindow and lcdStreamPixels as many times
+    as needed without decoding the glyph again (see readout.c).
+
+    @param[out] buffer
+                RGB565 buffer of width * heightPages * 8 pixels
+    @param[in]  width
+                Width of the buffer in pixels
+    @param[in]  xOffset
+                Column of the buffer the glyph starts in
     @param[in]  color
-                Color used when drawing
+                Foreground colour
+    @param[in]  bgcolor
+                Background colour
+    @param[in]  fontInfo
+                Pointer to the FONT_INFO for the font to render with
+    @param[in]  c
+                The character to render
 */
 /**************************************************************************/
-void drawRectangleFilled ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color)
+uint16_t drawCharToBuffer(uint16_t *buffer, uint16_t width, uint16_t xOffset, uint16_t color, uint16_t bgcolor, const FONT_INFO *fontInfo, char c)
 {
-  int height;
-  uint16_t x, y;
-
-  if (y1 < y0)
+  uint16_t blend[16];
+  uint16_t row, col, charWidth;
+  uint16_t height = fontInfo->heightPages * 8;
+  uint16_t *line;
+  const uint8_t *glyph;
+  uint32_t bit = 0;
+  uint8_t bitsPerPixel, mask, run, len, page;
+  uint8_t first = 0, last = 0;
+
+  charWidth = drawGetCharWidth(fontInfo, c);
+  glyph = drawGetGlyph(fontInfo, c);
+  bitsPerPixel = drawFontBlendTable(fontInfo, color, bgcolor, blend);
+  mask = (1 << bitsPerPixel) - 1;
+
+  if ((glyph != NULL) && (fontInfo->format == FONT_FORMAT_RLE))
   {
-    // Switch y1 and y0
-    y = y1;
-    y1 = y0;
-    y0 = y;
+    first = glyph[0] >> 4;
+    last = first + (glyph[0] & 0x0F);
+    glyph++;
   }
 
-  if (x1 < x0)
+  for (row = 0; row < height; row++)
   {
-    // Switch x1 and x0
-    x = x1;
-    x1 = x0;
-    x0 = x;
-  }
+    line = &buffer[row * width];
+    for (col = 0; col < width; col++)
+    {
+      line[col] = bgcolor;
+    }
+    if (glyph == NULL)
+    {
+      continue;
+    }
 
-  height = y1 - y0;
-  for (height = y0; y1 > height - 1; ++height)
-  {
-    drawLine(x0, height, x1, height, color);
+    if (bitsPerPixel)
+    {
+      // Rows of packed coverage values, MSB first
+      for (col = 0; col < charWidth; col++)
+      {
+        if (xOffset + col < width)
+        {
+          line[xOffset + col] = blend[(glyph[bit >> 3] >> (8 - bitsPerPixel - (bit & 7))) & mask];
+        }
+        bit += bitsPerPixel;
+      }
+    }
+    else if (fontInfo->format == FONT_FORMAT_RLE)
+    {
+      if ((row < first) || (row > last))
+      {
+        continue;
+      }
+      col = xOffset;
+      do
+      {
+        run = *glyph++;
+        col += (run >> 4) & 0x07;
+        for (len = run & 0x0F; len; len--, col++)
+        {
+          if (col < width)
+          {
+            line[col] = color;
+          }
+        }
+      } while (!(run & 0x80));
+    }
+    else
+    {
+      // Columns of 8-pixel pages, bottom page first
+      page = fontInfo->heightPages - 1 - (row >> 3);
+      for (col = 0; col < charWidth; col++)
+      {
+        if ((xOffset + col < width) && (glyph[fontInfo->heightPages * col + page] & (1 << (row & 7))))
+        {
+          line[xOffset + col] = color;
+        }
+      }
+    }
   }
+
+  return charWidth;
 }
 
 /**************************************************************************/
 /*!
-    @brief  Draws a filled rectangle with rounded corners
-
-    @param[in]  x0
-                Starting x co-ordinate
-    @param[in]  y0
-                Starting y co-ordinate
-    @param[in]  x1
-                Ending x co-ordinate
-    @param[in]  y1
-                Ending y co-ordinate
-    @param[in]  color
-                Color used when drawing
-    @param[in]  radius
-                Corner radius in pixels
-    @param[in]  corners
-                Which corners to round
+    @brief  Renders a string with either a transparent or an opaque
+            background (shared by drawString and drawStringOpaque)
 */
 /**************************************************************************/
-void drawRectangleRounded ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color, uint16_t radius, drawRoundedCorners_t corners )
+void drawStringBitmap(uint16_t x, uint16_t y, uint16_t color, uint16_t bgcolor, bool opaque, const FONT_INFO *fontInfo, char *str)
 {
-  int height;
-  uint16_t y;
+  uint16_t currentX;
+  uint16_t blend[16];
+  uint8_t bitsPerPixel;
 
-  if (corners == DRAW_ROUNDEDCORNERS_NONE)
-  {
-    drawRectangleFilled(x0, y0, x1, y1, color);
-    return;
-  }
+  // Anti-aliased fonts blend through a table built once per string
+  bitsPerPixel = drawFontBlendTable(fontInfo, color, bgcolor, blend);
 
-  // Calculate height
-  if (y1 < y0)
+  // set current x, y to that of requested
+  currentX = x;
+
+  // while not NULL
+  while (*str != '\0')
   {
-    y = y1;
-    y1 = y0;
-    y0 = y;
+    // draw the character and move to the next char X
+    currentX += drawCharFont(currentX, y, color, bgcolor, opaque, fontInfo, *str, blend, bitsPerPixel) + 1;
+    
+    // next char
+    str++;
   }
-  height = y1 - y0;
+}
 
-  // Check radius
-  if (radius > height / 2)
+#if defined CFG_TFTLCD_INCLUDESMALLFONTS & CFG_TFTLCD_INCLUDESMALLFONTS == 1
+/**************************************************************************/
+/*!
+    @brief  Draws a single smallfont character
+*/
+/**************************************************************************/
+void drawCharSmall(uint16_t x, uint16_t y, uint16_t color, uint8_t c, struct FONT_DEF font)
+{
+  uint8_t col, column[font.u8Width];
+
+  // Check if the requested character is available
+  if ((c >= font.u8FirstChar) && (c <= font.u8LastChar))
   {
-    radius = height / 2;
+    // Retrieve appropriate columns from font data
+    for (col = 0; col < font.u8Width; col++)
+    {
+      column[col] = font.au8FontTable[((c - 32) * font.u8Width) + col];    // Get first column of appropriate character
+    }
+  }
+  else
+  {    
+    // Requested character is not available in this font ... send a space instead
+    for (col = 0; col < font.u8Width; col++)
+    {
+      column[col] = 0xFF;    // Send solid space
+    }
   }
-  radius -= 1;
-
-  // Draw body  
-  drawRectangleFilled(x0 + radius, y0, x1 - radius, y1, color);
 
-  switch (corners)
+  // Render each column
+  uint16_t xoffset, yoffset;
+  for (xoffset = 0; xoffset < font.u8Width; xoffset++)
   {
-    case DRAW_ROUNDEDCORNERS_ALL:
-      drawCircleFilled(x0 + radius, y0 + radius, radius, color);
-      drawCircleFilled(x1 - radius, y0 + radius, radius, color);
-      drawCircleFilled(x0 + radius, y1 - radius, radius, color);
-      drawCircleFilled(x1 - radius, y1 - radius, radius, color);
-      if (radius*2+1 < height)
-      {
-        drawRectangleFilled(x0, y0 + radius, x0 + radius, y1 - radius, color);
-        drawRectangleFilled(x1 - radius, y0 + radius, x1, y1 - radius, color);
-      }
-      break;
-    case DRAW_ROUNDEDCORNERS_TOP:
-      drawCircleFilled(x0 + radius, y0 + radius, radius, color);
-      drawCircleFilled(x1 - radius, y0 + radius, radius, color);
-      drawRectangleFilled(x0, y0 + radius, x0 + radius, y1, color); 
-      drawRectangleFilled(x1 - radius, y0 + radius, x1, y1, color); 
-      break;
-    case DRAW_ROUNDEDCORNERS_BOTTOM:
-      drawCircleFilled(x0 + radius, y1 - radius, radius, color);
-      drawCircleFilled(x1 - radius, y1 - radius, radius, color);
-      drawRectangleFilled(x0, y0, x0 + radius, y1 - radius, color);
-      drawRectangleFilled(x1 - radius, y0, x1, y1 - radius, color);
-      break;
-    case DRAW_ROUNDEDCORNERS_LEFT:
-      drawCircleFilled(x0 + radius, y0 + radius, radius, color);
-      drawCircleFilled(x0 + radius, y1 - radius, radius, color);
-      if (radius*2+1 < height)
-      {
-        drawRectangleFilled(x0, y0 + radius, x0 + radius, y1 - radius, color);
-      }
-      drawRectangleFilled(x1 - radius, y0, x1, y1, color);
-      break;
-    case DRAW_ROUNDEDCORNERS_RIGHT:
-      drawCircleFilled(x1 - radius, y0 + radius, radius, color);
-      drawCircleFilled(x1 - radius, y1 - radius, radius, color);
-      if (radius*2+1 < height)
+    for (yoffset = 0; yoffset < (font.u8Height + 1); yoffset++)
+    {
+      uint8_t bit = 0x00;
+      bit = (column[xoffset] << (8 - (yoffset + 1)));     // Shift current row bit left
+      bit = (bit >> 7);                     // Shift current row but right (results in 0x01 for black, and 0x00 for white)
+      if (bit)
       {
-        drawRectangleFilled(x1 - radius, y0 + radius, x1, y1 - radius, color);
+        drawPixel(x + xoffset, y + yoffset, color);
       }
-      drawRectangleFilled(x0, y0, x0 + radius, y1, color);
-      break;
-    default:
-      break;
+    }
   }
 }
+#endif
 
 /**************************************************************************/
 /*!
-    @brief  Converts a 24-bit RGB color to an equivalent 16-bit RGB565 value
-
-    @param[in]  r
-                8-bit red
-    @param[in]  g
-                8-bit green
-    @param[in]  b
-                8-bit blue
-
-    @section Example
-
-    @code 
-
-    // Get 16-bit equivalent of 24-bit color
-    uint16_t gray = drawRGB24toRGB565(0x33, 0x33, 0x33);
-
-    @endcode
+    @brief  Draws the eight symmetric runs of a circle outline covering
+            the points (x, y) for x = x0..x1
 */
 /**************************************************************************/
-uint16_t drawRGB24toRGB565(uint8_t r, uint8_t g, uint8_t b)
+void drawCircleRuns(int cx, int cy, int x0, int x1, int y, uint16_t color)
 {
-  return ((r / 8) << 11) | ((g / 4) << 5) | (b / 8);
+  if (x1 < x0)
+  {
+    return;
+  }
+  drawSpanH(cx + x0, cx + x1, cy + y, color);
+  drawSpanH(cx - x1, cx - x0, cy + y, color);
+  drawSpanH(cx + x0, cx + x1, cy - y, color);
+  drawSpanH(cx - x1, cx - x0, cy - y, color);
+  drawSpanV(cx + y, cy + x0, cy + x1, color);
+  drawSpanV(cx - y, cy + x0, cy + x1, color);
+  drawSpanV(cx + y, cy - x1, cy - x0, color);
+  drawSpanV(cx - y, cy - x1, cy - x0, color);
 }
 
 /**************************************************************************/
 /*!
-    @brief  Converts a 16-bit RGB565 color to a standard 32-bit BGRA32
-            color (with alpha set to 0xFF)
-
-    @param[in]  color
-                16-bit rgb565 color
-
-    @section Example
+    @brief  Returns the palette index of one icon pixel
+*/
+/**************************************************************************/
+static uint8_t drawIcon16Index(uint16_t *planes[], uint8_t planeCount, uint8_t row, uint16_t bit)
+{
+  uint8_t p, index = 0;
 
-    @code 
+  for (p = 0; p < planeCount; p++)
+  {
+    if (planes[p][row] & bit)
+    {
+      index |= 1 << p;
+    }
+  }
+  return index;
+}
 
-    // First convert 24-bit color to RGB565
-    uint16_t rgb565 = drawRGB24toRGB565(0xFF, 0x00, 0x00);
-  
-    // Convert RGB565 color back to BGRA32
-    uint32_t bgra32 = drawRGB565toBGRA32(rgb565);
-  
-    // Display results
-    printf("BGRA32: 0x%08X R: %u G: %u B: %u A: %u \r\n", 
-        bgra32, 
-        (bgra32 & 0x000000FF),        // Blue
-        (bgra32 & 0x0000FF00) >> 8,   // Green
-        (bgra32 & 0x00FF0000) >> 16,  // Red
-        (bgra32 & 0xFF000000) >> 24); // Alpha
+/**************************************************************************/
+/*!
+    @brief  Renders 16x16 icon planes
 
-    @endcode
+    Opaque icons that are entirely on the screen are expanded row by
+    row and streamed through a single 16x16 LCD window.  Everything
+    else is scanned for runs of pixels with the same palette index,
+    and each run is sent as one horizontal line (runs of index 0 are
+    skipped when the icon is transparent).
 */
 /**************************************************************************/
-uint32_t drawRGB565toBGRA32(uint16_t color)
+static void drawIcon16Planes(uint16_t x, uint16_t y, uint16_t *planes[], uint8_t planeCount, const uint16_t palette[], bool opaque)
 {
-  uint32_t bits = (uint32_t)color;
-  uint32_t blue = bits & 0x001F;     // 5 bits blue
-  uint32_t green = bits & 0x07E0;    // 6 bits green
-  uint32_t red = bits & 0xF800;      // 5 bits red
+  uint16_t buffer[16];
+  uint16_t bit, x1;
+  uint8_t row, col, start, index;
+  uint16_t lcdWidth = lcdGetWidth();
+  uint16_t lcdHeight = lcdGetHeight();
+
+  if (opaque && (x + 16 <= lcdWidth) && (y + 16 <= lcdHeight)
+  #ifdef DRAW_TILES
+      && !drawTileActive
+  #endif
+     )
+  {
+    lcdSetWindow(x, y, x + 15, y + 15);
+    for (row = 0; row < 16; row++)
+    {
+      for (col = 0, bit = 0x8000; col < 16; col++, bit >>= 1)
+      {
+        buffer[col] = palette[drawIcon16Index(planes, planeCount, row, bit)];
+      }
+      lcdStreamPixels(buffer, 16);
+    }
+    return;
+  }
 
-  // Return shifted bits with alpha set to 0xFF
-  return (red << 8) | (green << 5) | (blue << 3) | 0xFF000000;
+  for (row = 0; (row < 16) && (y + row < lcdHeight); row++)
+  {
+    col = 0;
+    bit = 0x8000;
+    while ((col < 16) && (x + col < lcdWidth))
+    {
+      // Find the next run of pixels with the same color
+      start = col;
+      index = drawIcon16Index(planes, planeCount, row, bit);
+      do
+      {
+        col++;
+        bit >>= 1;
+      } while ((col < 16) && (drawIcon16Index(planes, planeCount, row, bit) == index));
+
+      if (opaque || index)
+      {
+        x1 = x + col - 1;
+        if (x1 >= lcdWidth)
+        {
+          x1 = lcdWidth - 1;
+        }
+        drawTargetHLine(x + start, x1, y + row, palette[index]);
+      }
+    }
+  }
 }
 
 /**************************************************************************/
-/*! 
-    @brief  Reverses a 16-bit color from BGR to RGB
-*/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
 /**************************************************************************/
-uint16_t drawBGR2RGB(uint16_t color)
-{   
-  uint16_t r, g, b;   
-   
-  b = (color>>0)  & 0x1f;   
-  g = (color>>5)  & 0x3f;   
-  r = (color>>11) & 0x1f;   
-     
-  return( (b<<11) + (g<<5) + (r<<0) );
-}  
 
 /**************************************************************************/
 /*!
-    @brief  Draws a progress bar with rounded corners
+    @brief  Draws a single pixel at the specified location
+
+    @param[in]  x
+                Horizontal position
+    @param[in]  y
+                Vertical position
+    @param[in]  color
+                Color used when drawing
+*/
+/**************************************************************************/
+void drawPixel(uint16_t x, uint16_t y, uint16_t color)
+{
+  if ((x >= lcdInlineGetWidth()) || (y >= lcdInlineGetHeight()))
+  {
+    // Pixel out of range
+    return;
+  }
+
+  #ifdef DRAW_TILES
+  if (drawTileActive)
+  {
+    drawTargetHLine(x, x, y, color);
+    return;
+  }
+  #endif
+
+  // Redirect to LCD
+  lcdInlineDrawPixel(x, y, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Fills the screen with the specified color
+
+    @param[in]  color
+                Color used when drawing
+*/
+/**************************************************************************/
+void drawFill(uint16_t color)
+{
+  drawRectangleFilled(0, 0, lcdGetWidth() - 1, lcdGetHeight() - 1, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a simple color test pattern
+*/
+/**************************************************************************/
+void drawTestPattern(void)
+{
+  lcdTest();
+}
+
+#if defined CFG_TFTLCD_INCLUDESMALLFONTS & CFG_TFTLCD_INCLUDESMALLFONTS == 1
+/**************************************************************************/
+/*!
+    @brief  Draws a string using a small font (6 of 8 pixels high).
+
+    @param[in]  x
+                Starting x co-ordinate
+    @param[in]  y
+                Starting y co-ordinate
+    @param[in]  color
+                Color to use when rendering the font
+    @param[in]  text
+                The string to render
+    @param[in]  font
+                Pointer to the FONT_DEF to use when drawing the string
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/fonts/smallfonts.h"
+    
+    drawStringSmall(1, 210, COLOR_WHITE, "5x8 System (Max 40 Characters)", Font_System5x8);
+    drawStringSmall(1, 220, COLOR_WHITE, "7x8 System (Max 30 Characters)", Font_System7x8);
+
+    @endcode
+*/
+/**************************************************************************/
+void drawStringSmall(uint16_t x, uint16_t y, uint16_t color, char* text, struct FONT_DEF font)
+{
+  uint8_t l;
+  for (l = 0; l < strlen(text); l++)
+  {
+    drawCharSmall(x + (l * (font.u8Width + 1)), y, color, text[l], font);
+  }
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Draws a string using the supplied font
+
+    @param[in]  x
+                Starting x co-ordinate
+    @param[in]  y
+                Starting y co-ordinate
+    @param[in]  color
+                Color to use when rendering the font
+    @param[in]  fontInfo
+                Pointer to the FONT_INFO to use when drawing the string
+    @param[in]  str
+                The string to render
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/fonts/veramono9.h"
+    
+    drawString(0, 90,  COLOR_BLACK, &bitstreamVeraSansMono9ptFontInfo, "Vera Mono 9 (30 chars wide)");
+    drawString(0, 105, COLOR_BLACK, &bitstreamVeraSansMono9ptFontInfo, "123456789012345678901234567890");
+
+    @endcode
+*/
+/**************************************************************************/
+void drawString(uint16_t x, uint16_t y, uint16_t color, const FONT_INFO *fontInfo, char *str)
+{
+  drawStringBitmap(x, y, color, 0, FALSE, fontInfo, str);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a string using the supplied font data, filling the
+            background of each character cell with 'bgcolor'
+
+    This is considerably faster than drawString since each character is
+    sent to the LCD as one windowed block, and it removes the need to
+    clear the area behind the text before redrawing it.
+
+    @param[in]  x
+                Starting x co-ordinate
+    @param[in]  y
+                Starting y co-ordinate
+    @param[in]  color
+                Color to use when rendering the font
+    @param[in]  bgcolor
+                Color to use for the character background
+    @param[in]  fontInfo
+                Flash-based uint8_t array containing the font definitions
+    @param[in]  str
+                The string to render
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/fonts/dejavusans9.h"
+    
+    drawStringOpaque(0, 90, COLOR_WHITE, COLOR_BLACK, &dejaVuSans9ptFontInfo, "Battery: 87%");
+
+    @endcode
+*/
+/**************************************************************************/
+void drawStringOpaque(uint16_t x, uint16_t y, uint16_t color, uint16_t bgcolor, const FONT_INFO *fontInfo, char *str)
+{
+  drawStringBitmap(x, y, color, bgcolor, TRUE, fontInfo, str);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the width in pixels of a string when it is rendered
+
+    This method can be used to determine whether a string will fit
+    inside a specific area, or if it needs to be broken up into multiple
+    lines to be properly rendered on the screen.
+
+    This function only applied to bitmap fonts (which can have variable
+    widths).  All smallfonts (if available) are fixed width and can
+    easily have their width calculated without costly functions like
+    this one.
+
+    @param[in]  fontInfo
+                Pointer to the FONT_INFO for the font that will be used
+    @param[in]  str
+                The string that will be rendered
+*/
+/**************************************************************************/
+uint16_t drawGetStringWidth(const FONT_INFO *fontInfo, char *str)
+{
+  uint16_t width = 0;
+  uint32_t currChar;
+
+  // until termination
+  for (currChar = *str; currChar; currChar = *(++str))
+  {
+    width += drawGetCharWidth(fontInfo, currChar) + 1;
+  }
+
+  /* return the wdith */
+  return width;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Measures, wraps and clips a string once so that it can be
+            drawn any number of times with drawStringLayout
+
+    Characters are placed one after the other until a line would be
+    wider than 'maxWidth', at which point the line is broken after the
+    last space (or before the current character if the line has no
+    spaces).  '\n' always starts a new line.  Words that don't fit in
+    'maxLines' lines and characters beyond DRAW_TEXTLAYOUT_MAXGLYPHS
+    are dropped.
+
+    The string itself isn't referenced after this call returns.
+
+    @param[out] layout
+                Layout record to fill in
+    @param[in]  fontInfo
+                Pointer to the FONT_INFO to use when drawing the string
+    @param[in]  str
+                The string to lay out
+    @param[in]  maxWidth
+                Maximum line width in pixels (0 for no wrapping)
+    @param[in]  maxLines
+                Maximum number of lines (0 for no limit)
+
+    @return     The number of characters from 'str' that fit in the
+                layout.  If this is less than strlen(str) the text was
+                clipped.
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/fonts/dejavusans9.h"
+
+    static drawTextLayout_t label;
+
+    // Measure the label once ...
+    drawMeasureString(&label, &dejaVuSans9ptFontInfo, "Press any key to continue", 100, 2);
+
+    // ... and draw it centered as often as required
+    drawStringLayout(&label, (lcdGetWidth() - label.width) / 2, 100, COLOR_WHITE);
+
+    @endcode
+*/
+/**************************************************************************/
+uint16_t drawMeasureString(drawTextLayout_t *layout, const FONT_INFO *fontInfo, char *str, uint16_t maxWidth, uint8_t maxLines)
+{
+  uint16_t i, j, x, w, shift;
+  uint16_t lineHeight = fontInfo->heightPages * 8;
+  uint8_t line, count, breakAt;
+
+  x = 0;
+  line = 0;
+  count = 0;
+  breakAt = DRAW_TEXTLAYOUT_MAXGLYPHS;    // No space on the current line
+
+  for (i = 0; str[i] != '\0'; i++)
+  {
+    if (str[i] == '\n')
+    {
+      if (maxLines && (line + 1 >= maxLines))
+      {
+        break;
+      }
+      line++;
+      x = 0;
+      breakAt = DRAW_TEXTLAYOUT_MAXGLYPHS;
+      continue;
+    }
+
+    w = drawGetCharWidth(fontInfo, str[i]) + 1;
+
+    // Wrap to a new line if this character doesn't fit
+    if (maxWidth && x && (x + w > maxWidth))
+    {
+      if (maxLines && (line + 1 >= maxLines))
+      {
+        if (breakAt < count)
+        {
+          // Don't leave half a word at the end of the last line
+          i -= count - breakAt;
+          count = breakAt;
+        }
+        break;
+      }
+      line++;
+      if (str[i] == ' ')
+      {
+        // The space is swallowed by the line break
+        x = 0;
+        breakAt = DRAW_TEXTLAYOUT_MAXGLYPHS;
+        continue;
+      }
+      if (breakAt < count)
+      {
+        // Drop the last space and move the partial word down a line
+        shift = (breakAt + 1 < count) ? layout->glyphs[breakAt + 1].x : x;
+        count--;
+        for (j = breakAt; j < count; j++)
+        {
+          layout->glyphs[j] = layout->glyphs[j + 1];
+          layout->glyphs[j].x -= shift;
+          layout->glyphs[j].y = line * lineHeight;
+        }
+        x -= shift;
+      }
+      else
+      {
+        x = 0;
+      }
+      breakAt = DRAW_TEXTLAYOUT_MAXGLYPHS;
+    }
+
+    if (count == DRAW_TEXTLAYOUT_MAXGLYPHS)
+    {
+      break;
+    }
+    if (str[i] == ' ')
+    {
+      breakAt = count;
+    }
+    layout->glyphs[count].x = x;
+    layout->glyphs[count].y = line * lineHeight;
+    layout->glyphs[count].c = str[i];
+    count++;
+    x += w;
+  }
+
+  // Find the widest line
+  layout->width = 0;
+  for (j = 0; j < count; j++)
+  {
+    w = layout->glyphs[j].x + drawGetCharWidth(fontInfo, layout->glyphs[j].c) + 1;
+    if (w > layout->width)
+    {
+      layout->width = w;
+    }
+  }
+
+  layout->fontInfo = fontInfo;
+  layout->count = count;
+  layout->lines = line + 1;
+  layout->height = layout->lines * lineHeight;
+
+  return i;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Renders a layout created by drawMeasureString (shared by
+            drawStringLayout and drawStringLayoutOpaque)
+*/
+/**************************************************************************/
+static void drawLayoutGlyphs(const drawTextLayout_t *layout, uint16_t x, uint16_t y, uint16_t color, uint16_t bgcolor, bool opaque)
+{
+  uint8_t i;
+  uint16_t blend[16];
+  uint8_t bitsPerPixel;
+
+  bitsPerPixel = drawFontBlendTable(layout->fontInfo, color, bgcolor, blend);
+
+  for (i = 0; i < layout->count; i++)
+  {
+    drawCharFont(x + layout->glyphs[i].x, y + layout->glyphs[i].y, color, bgcolor, opaque,
+                 layout->fontInfo, layout->glyphs[i].c, blend, bitsPerPixel);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a string that was measured with drawMeasureString
+
+    @param[in]  layout
+                Layout created by drawMeasureString
+    @param[in]  x
+                Starting x co-ordinate
+    @param[in]  y
+                Starting y co-ordinate of the first line
+    @param[in]  color
+                Color to use when rendering the font
+*/
+/**************************************************************************/
+void drawStringLayout(const drawTextLayout_t *layout, uint16_t x, uint16_t y, uint16_t color)
+{
+  drawLayoutGlyphs(layout, x, y, color, 0, FALSE);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a string that was measured with drawMeasureString,
+            filling the background of each character cell with
+            'bgcolor' (see drawStringOpaque)
+
+    @param[in]  layout
+                Layout created by drawMeasureString
+    @param[in]  x
+                Starting x co-ordinate
+    @param[in]  y
+                Starting y co-ordinate of the first line
+    @param[in]  color
+                Color to use when rendering the font
+    @param[in]  bgcolor
+                Color to use for the character background
+*/
+/**************************************************************************/
+void drawStringLayoutOpaque(const drawTextLayout_t *layout, uint16_t x, uint16_t y, uint16_t color, uint16_t bgcolor)
+{
+  drawLayoutGlyphs(layout, x, y, color, bgcolor, TRUE);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a bresenham line
+
+    @param[in]  x0
+                Starting x co-ordinate
+    @param[in]  y0
+                Starting y co-ordinate
+    @param[in]  x1
+                Ending x co-ordinate
+    @param[in]  y1
+                Ending y co-ordinate
+    @param[in]  color
+                Color used when drawing
+*/
+/**************************************************************************/
+void drawLine ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color )
+{
+  drawLineDotted(x0, y0, x1, y1, 0, 1, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a solid sloped line with Bresenham's algorithm
+
+    Consecutive pixels that share the same row (or column for steep
+    lines) are collected and sent as a single horizontal (or vertical)
+    line instead of being plotted one by one.
+*/
+/**************************************************************************/
+static void drawLineSolid(int x0, int y0, int x1, int y1, uint16_t color)
+{
+  int dy = y1 - y0;
+  int dx = x1 - x0;
+  int stepx, stepy, start;
+
+  if (dy < 0) { dy = -dy;  stepy = -1; } else { stepy = 1; }
+  if (dx < 0) { dx = -dx;  stepx = -1; } else { stepx = 1; }
+  dy <<= 1;                               // dy is now 2*dy
+  dx <<= 1;                               // dx is now 2*dx
+
+  start = x0;
+  if (dx > dy) 
+  {
+    int fraction = dy - (dx >> 1);        // same as 2*dy - dx
+    while (x0 != x1) 
+    {
+      if (fraction >= 0) 
+      {
+        // Row is complete
+        drawSpanH(stepx > 0 ? start : x0, stepx > 0 ? x0 : start, y0, color);
+        y0 += stepy;
+        fraction -= dx;                   // same as fraction -= 2*dx
+        start = x0 + stepx;
+      }
+      x0 += stepx;
+      fraction += dy;                     // same as fraction -= 2*dy
+    }
+    drawSpanH(stepx > 0 ? start : x0, stepx > 0 ? x0 : start, y0, color);
+  } 
+  else 
+  {
+    int fraction = dx - (dy >> 1);
+    start = y0;
+    while (y0 != y1) 
+    {
+      if (fraction >= 0) 
+      {
+        // Column is complete
+        drawSpanV(x0, stepy > 0 ? start : y0, stepy > 0 ? y0 : start, color);
+        x0 += stepx;
+        fraction -= dy;
+        start = y0 + stepy;
+      }
+      y0 += stepy;
+      fraction += dx;
+    }
+    drawSpanV(x0, stepy > 0 ? start : y0, stepy > 0 ? y0 : start, color);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a bresenham line with a fixed pattern of empty
+            and solid pixels
+
+    Based on: http://www.cs.unc.edu/~mcmillan/comp136/Lecture6/Lines.html
+
+    @param[in]  x0
+                Starting x co-ordinate
+    @param[in]  y0
+                Starting y co-ordinate
+    @param[in]  x1
+                Ending x co-ordinate
+    @param[in]  y1
+                Ending y co-ordinate
+    @param[in]  empty
+                The number of 'empty' pixels to render
+    @param[in]  solid
+                The number of 'solid' pixels to render
+    @param[in]  color
+                Color used when drawing
+*/
+/**************************************************************************/
+void drawLineDotted ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t empty, uint16_t solid, uint16_t color )
+{
+  if (solid == 0)
+  {
+    return;
+  }
+
+  // If a negative y int was passed in it will overflow to 65K something
+  // Ugly, but drawCircleFilled() can pass in negative values so we need
+  // to check the values here
+  y0 = y0 > 65000 ? 0 : y0;
+  y1 = y1 > 65000 ? 0 : y1;
+
+  // Check if we can use the optimised horizontal line method
+  if ((y0 == y1) && (empty == 0))
+  {
+    drawTargetHLine(x0, x1, y0, color);
+    return;
+  }
+
+  // Check if we can use the optimised vertical line method.
+  // This can make a huge difference in performance, but may
+  // not work properly on every LCD controller:
+  // ex.: drawCircleFilled(120, 160, 50, COLOR_RED);
+  //      = 678834 cycles using lcdDrawVLine w/ILI9328   =  9.43mS @ 72MHz
+  //      = 7546261 w/o lcdDrawVLine, setting each pixel = 104.8mS @ 72MHz
+  if ((x0 == x1) && (empty == 0))
+  {
+    // Warning: This may actually be slower than drawing individual pixels on 
+    // short lines ... Set a minimum line size to use the 'optimised' method
+    // (which changes the screen orientation) ?
+    drawTargetVLine(x0, y0, y1, color);
+    return;
+  }
+
+  // Solid sloped lines are drawn as a series of short runs
+  if (empty == 0)
+  {
+    drawLineSolid(x0, y0, x1, y1, color);
+    return;
+  }
+
+  // Draw dotted line
+  int dy = y1 - y0;
+  int dx = x1 - x0;
+  int stepx, stepy;
+  int emptycount, solidcount;
+
+  if (dy < 0) { dy = -dy;  stepy = -1; } else { stepy = 1; }
+  if (dx < 0) { dx = -dx;  stepx = -1; } else { stepx = 1; }
+  dy <<= 1;                               // dy is now 2*dy
+  dx <<= 1;                               // dx is now 2*dx
+
+  emptycount = empty;
+  solidcount = solid;
+
+  drawPixel(x0, y0, color);               // always start with solid pixels
+  solidcount--;
+  if (dx > dy) 
+  {
+    int fraction = dy - (dx >> 1);        // same as 2*dy - dx
+    while (x0 != x1) 
+    {
+      if (fraction >= 0) 
+      {
+        y0 += stepy;
+        fraction -= dx;                   // same as fraction -= 2*dx
+      }
+      x0 += stepx;
+      fraction += dy;                     // same as fraction -= 2*dy
+      if (empty == 0)
+      {
+        // always draw a pixel ... no dotted line requested
+        drawPixel(x0, y0, color);
+      }
+      else if (solidcount)
+      {
+        // Draw solid pxiel and decrement counter
+        drawPixel(x0, y0, color);
+        solidcount--;
+      }
+      else if(emptycount)
+      {
+        // Empty pixel ... don't draw anything an decrement counter
+        emptycount--;
+      }
+      else
+      {
+        // Reset counters and draw solid pixel
+        emptycount = empty;
+        solidcount = solid;
+        drawPixel(x0, y0, color);
+        solidcount--;
+      }
+    }
+  } 
+  else 
+  {
+    int fraction = dx - (dy >> 1);
+    while (y0 != y1) 
+    {
+      if (fraction >= 0) 
+      {
+        x0 += stepx;
+        fraction -= dy;
+      }
+      y0 += stepy;
+      fraction += dx;
+      if (empty == 0)
+      {
+        // always draw a pixel ... no dotted line requested
+        drawPixel(x0, y0, color);
+      }
+      else if (solidcount)
+      {
+        // Draw solid pxiel and decrement counter
+        drawPixel(x0, y0, color);
+        solidcount--;
+      }
+      else if(emptycount)
+      {
+        // Empty pixel ... don't draw anything an decrement counter
+        emptycount--;
+      }
+      else
+      {
+        // Reset counters and draw solid pixel
+        emptycount = empty;
+        solidcount = solid;
+        drawPixel(x0, y0, color);
+        solidcount--;
+      }
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a circle
+
+    Based on: http://www.cs.unc.edu/~mcmillan/comp136/Lecture7/circle.html
+
+    @param[in]  xCenter
+                The horizontal center of the circle
+    @param[in]  yCenter
+                The vertical center of the circle
+    @param[in]  radius
+                The circle's radius in pixels
+    @param[in]  color
+                Color used when drawing
+*/
+/**************************************************************************/
+void drawCircle (uint16_t xCenter, uint16_t yCenter, uint16_t radius, uint16_t color)
+{
+  int x = 0;
+  int y = radius;
+  int p = (5 - radius*4)/4;
+  int start = 0;
+  int cx = xCenter, cy = yCenter;
+
+  // Points with the same 'y' are collected into runs so that each
+  // octant is drawn as a handful of horizontal and vertical lines
+  // rather than one pixel at a time
+  while (x < y) 
+  {
+    x++;
+    if (p < 0) 
+    {
+      p += 2*x+1;
+    } 
+    else 
+    {
+      drawCircleRuns(cx, cy, start, x - 1, y, color);
+      start = x;
+      y--;
+      p += 2*(x-y)+1;
+    }
+  }
+  drawCircleRuns(cx, cy, start, x < y ? x : y, y, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a filled circle
+
+    @param[in]  xCenter
+                The horizontal center of the circle
+    @param[in]  yCenter
+                The vertical center of the circle
+    @param[in]  radius
+                The circle's radius in pixels
+    @param[in]  color
+                Color used when drawing
+*/
+/**************************************************************************/
+void drawCircleFilled (uint16_t xCenter, uint16_t yCenter, uint16_t radius, uint16_t color)
+{
+  // One horizontal run per line, clipped to the screen
+  drawRoundedSpans((int32_t)xCenter - radius, (int32_t)yCenter - radius, (int32_t)xCenter + radius, (int32_t)yCenter + radius, radius, 0x0F, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a simple arrow of the specified width
+
+    @param[in]  x
+                X co-ordinate of the smallest point of the arrow
+    @param[in]  y
+                Y co-ordinate of the smallest point of the arrow
+    @param[in]  size
+                Total width/height of the arrow in pixels
+    @param[in]  direction
+                The direction that the arrow is pointing
+    @param[in]  color
+                Color used when drawing
+*/
+/**************************************************************************/
+void drawArrow(uint16_t x, uint16_t y, uint16_t size, drawDirection_t direction, uint16_t color)
+{
+  drawPixel(x, y, color);
+
+  if (size == 1)
+  {
+    return;
+  }
+
+  uint32_t i;
+  switch (direction)
+  {
+    case DRAW_DIRECTION_LEFT:
+      for (i = 1; i<size; i++)
+      {
+        drawLine(x+i, y-i, x+i, y+i, color);
+      }
+      break;
+    case DRAW_DIRECTION_RIGHT:
+      for (i = 1; i<size; i++)
+      {
+        drawLine(x-i, y-i, x-i, y+i, color);
+      }
+      break;
+    case DRAW_DIRECTION_UP:
+      for (i = 1; i<size; i++)
+      {
+        drawLine(x-i, y+i, x+i, y+i, color);
+      }
+      break;
+    case DRAW_DIRECTION_DOWN:
+      for (i = 1; i<size; i++)
+      {
+        drawLine(x-i, y-i, x+i, y-i, color);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a simple (empty) rectangle
+
+    @param[in]  x0
+                Starting x co-ordinate
+    @param[in]  y0
+                Starting y co-ordinate
+    @param[in]  x1
+                Ending x co-ordinate
+    @param[in]  y1
+                Ending y co-ordinate
+    @param[in]  color
+                Color used when drawing
+*/
+/**************************************************************************/
+void drawRectangle ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color)
+{
+  uint16_t x, y;
+
+  if (y1 < y0)
+  {
+    // Switch y1 and y0
+    y = y1;
+    y1 = y0;
+    y0 = y;
+  }
+
+  if (x1 < x0)
+  {
+    // Switch x1 and x0
+    x = x1;
+    x1 = x0;
+    x0 = x;
+  }
+
+  drawLine (x0, y0, x1, y0, color);
+  drawLine (x1, y0, x1, y1, color);
+  drawLine (x1, y1, x0, y1, color);
+  drawLine (x0, y1, x0, y0, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a filled rectangle
+
+    @param[in]  x0
+                Starting x co-ordinate
+    @param[in]  y0
+                Starting y co-ordinate
+    @param[in]  x1
+                Ending x co-ordinate
+    @param[in]  y1
+                Ending y co-ordinate
+    @param[in]  color
+                Color used when drawing
+*/
+/**************************************************************************/
+void drawRectangleFilled ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color)
+{
+  uint16_t x, y;
+
+  if (y1 < y0)
+  {
+    // Switch y1 and y0
+    y = y1;
+    y1 = y0;
+    y0 = y;
+  }
+
+  if (x1 < x0)
+  {
+    // Switch x1 and x0
+    x = x1;
+    x1 = x0;
+    x0 = x;
+  }
+
+  // Check limits
+  if ((x0 >= lcdGetWidth()) || (y0 >= lcdGetHeight()))
+  {
+    return;
+  }
+  if (x1 >= lcdGetWidth())
+  {
+    x1 = lcdGetWidth() - 1;
+  }
+  if (y1 >= lcdGetHeight())
+  {
+    y1 = lcdGetHeight() - 1;
+  }
+
+  drawTargetFill(x0, y0, x1, y1, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a filled rectangle with rounded corners
+
+    @param[in]  x0
+                Starting x co-ordinate
+    @param[in]  y0
+                Starting y co-ordinate
+    @param[in]  x1
+                Ending x co-ordinate
+    @param[in]  y1
+                Ending y co-ordinate
+    @param[in]  color
+                Color used when drawing
+    @param[in]  radius
+                Corner radius in pixels
+    @param[in]  corners
+                Which corners to round
+*/
+/**************************************************************************/
+void drawRectangleRounded ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color, uint16_t radius, drawRoundedCorners_t corners )
+{
+  int height;
+  uint16_t y;
+  uint8_t mask;
+
+  if (corners == DRAW_ROUNDEDCORNERS_NONE)
+  {
+    drawRectangleFilled(x0, y0, x1, y1, color);
+    return;
+  }
+
+  // Calculate height
+  if (y1 < y0)
+  {
+    y = y1;
+    y1 = y0;
+    y0 = y;
+  }
+  height = y1 - y0;
+
+  // Check radius
+  if (radius > height / 2)
+  {
+    radius = height / 2;
+  }
+  if (radius == 0)
+  {
+    drawRectangleFilled(x0, y0, x1, y1, color);
+    return;
+  }
+  radius -= 1;
+
+  if (x1 < x0)
+  {
+    y = x1;
+    x1 = x0;
+    x0 = y;
+  }
+
+  // Corner bits for drawRoundedSpans (TL = 1, TR = 2, BL = 4, BR = 8)
+  switch (corners)
+  {
+    case DRAW_ROUNDEDCORNERS_ALL:
+      mask = 0x0F;
+      break;
+    case DRAW_ROUNDEDCORNERS_TOP:
+      mask = 0x03;
+      break;
+    case DRAW_ROUNDEDCORNERS_BOTTOM:
+      mask = 0x0C;
+      break;
+    case DRAW_ROUNDEDCORNERS_LEFT:
+      mask = 0x05;
+      break;
+    case DRAW_ROUNDEDCORNERS_RIGHT:
+      mask = 0x0A;
+      break;
+    default:
+      mask = 0;
+      break;
+  }
+
+  drawRoundedSpans(x0, y0, x1, y1, radius, mask, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Fills a rectangle with a linear gradient
+
+    The ramp of colors is calculated once (up to DRAW_GRADIENTSTEPS
+    entries, each covering an equal band of the rectangle) and the
+    rectangle is then streamed into a single window, so a horizontal
+    gradient costs one burst per row and a vertical gradient one burst
+    per band.  Anything past the edge of the screen is clipped without
+    changing the gradient.
+
+    @param[in]  x0
+                Starting x co-ordinate
+    @param[in]  y0
+                Starting y co-ordinate
+    @param[in]  x1
+                Ending x co-ordinate
+    @param[in]  y1
+                Ending y co-ordinate
+    @param[in]  startColor
+                Color the gradient starts with
+    @param[in]  endColor
+                Color the gradient ends with
+    @param[in]  direction
+                Direction the gradient goes in, for example
+                DRAW_DIRECTION_DOWN runs from startColor at the top to
+                endColor at the bottom
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/drawing.h"
+
+    // Title bar shaded from the lighter to the darker theme color
+    drawGradientRect(0, 0, 239, 23, COLOR_THEME_LIMEGREEN_LIGHTER, COLOR_THEME_LIMEGREEN_DARKER, DRAW_DIRECTION_DOWN);
+
+    @endcode
+*/
+/**************************************************************************/
+void drawGradientRect ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t startColor, uint16_t endColor, drawDirection_t direction )
+{
+  uint16_t ramp[DRAW_GRADIENTSTEPS];
+  uint16_t runs[DRAW_GRADIENTSTEPS];
+  uint16_t t, cx1, cy1, row;
+  uint32_t len, visible, start, end;
+  uint8_t steps, k;
+  bool vertical;
+
+  if (x1 < x0)
+  {
+    t = x0; x0 = x1; x1 = t;
+  }
+  if (y1 < y0)
+  {
+    t = y0; y0 = y1; y1 = t;
+  }
+
+  // Check limits
+  if ((x0 >= lcdGetWidth()) || (y0 >= lcdGetHeight()))
+  {
+    return;
+  }
+  cx1 = x1 < lcdGetWidth() ? x1 : lcdGetWidth() - 1;
+  cy1 = y1 < lcdGetHeight() ? y1 : lcdGetHeight() - 1;
+
+  vertical = (direction == DRAW_DIRECTION_UP) || (direction == DRAW_DIRECTION_DOWN);
+  len = vertical ? (uint32_t)y1 - y0 + 1 : (uint32_t)x1 - x0 + 1;
+  visible = vertical ? cy1 - y0 + 1 : cx1 - x0 + 1;
+  steps = len < DRAW_GRADIENTSTEPS ? len : DRAW_GRADIENTSTEPS;
+  if (steps < 2)
+  {
+    drawTargetFill(x0, y0, cx1, cy1, startColor);
+    return;
+  }
+
+  // Entry 0 is the color at the left or top edge
+  if ((direction == DRAW_DIRECTION_RIGHT) || (direction == DRAW_DIRECTION_DOWN))
+  {
+    drawBlendTable(endColor, startColor, steps, ramp);
+  }
+  else
+  {
+    drawBlendTable(startColor, endColor, steps, ramp);
+  }
+
+  // Band k covers positions ceil(k * len / steps) onwards, only the
+  // on-screen part of each band is drawn
+  start = 0;
+  for (k = 0; k < steps; k++)
+  {
+    end = ((k + 1) * len + steps - 1) / steps;
+    if (end > visible)
+    {
+      end = visible;
+    }
+    runs[k] = end > start ? end - start : 0;
+    if (end > start)
+    {
+      start = end;
+    }
+  }
+
+  #ifdef DRAW_TILES
+  if (drawTileActive)
+  {
+    uint16_t pos = vertical ? y0 : x0;
+    for (k = 0; k < steps; k++)
+    {
+      if (runs[k])
+      {
+        if (vertical)
+        {
+          drawTargetFill(x0, pos, cx1, pos + runs[k] - 1, ramp[k]);
+        }
+        else
+        {
+          drawTargetFill(pos, y0, pos + runs[k] - 1, cy1, ramp[k]);
+        }
+        pos += runs[k];
+      }
+    }
+    return;
+  }
+  #endif
+
+  lcdSetWindow(x0, y0, cx1, cy1);
+  if (vertical)
+  {
+    for (k = 0; k < steps; k++)
+    {
+      if (runs[k])
+      {
+        lcdStreamFill(ramp[k], (uint32_t)runs[k] * (cx1 - x0 + 1));
+      }
+    }
+    return;
+  }
+
+  // The controller wraps to the next row, so every row is one burst
+  for (row = y0; row <= cy1; row++)
+  {
+    for (k = 0; k < steps; k++)
+    {
+      if (runs[k])
+      {
+        lcdStreamFill(ramp[k], runs[k]);
+      }
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Fills a rectangle by repeating an RGB565 pattern
+
+    The pattern is anchored to the top left corner of the screen rather
+    than to the rectangle, so neighbouring fills with the same pattern
+    line up, and the rectangle is streamed into a single window, one
+    burst per row.
+
+    @param[in]  x0
+                Starting x co-ordinate
+    @param[in]  y0
+                Starting y co-ordinate
+    @param[in]  x1
+                Ending x co-ordinate
+    @param[in]  y1
+                Ending y co-ordinate
+    @param[in]  pattern
+                RGB565 pixels of the pattern, row by row
+    @param[in]  width
+                Width of the pattern in pixels
+    @param[in]  height
+                Height of the pattern in pixels
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/drawing.h"
+
+    // 2x2 checkerboard
+    static const uint16_t checker[] = { COLOR_GRAY_50, COLOR_GRAY_80,
+                                        COLOR_GRAY_80, COLOR_GRAY_50 };
+    drawPatternRect(0, 0, 239, 319, checker, 2, 2);
+
+    @endcode
+*/
+/**************************************************************************/
+void drawPatternRect ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, const uint16_t *pattern, uint16_t width, uint16_t height )
+{
+  const uint16_t *src;
+  uint16_t t, row, col, len, remaining;
+
+  if ((width == 0) || (height == 0))
+  {
+    return;
+  }
+  if (x1 < x0)
+  {
+    t = x0; x0 = x1; x1 = t;
+  }
+  if (y1 < y0)
+  {
+    t = y0; y0 = y1; y1 = t;
+  }
+
+  // Check limits
+  if ((x0 >= lcdGetWidth()) || (y0 >= lcdGetHeight()))
+  {
+    return;
+  }
+  if (x1 >= lcdGetWidth())
+  {
+    x1 = lcdGetWidth() - 1;
+  }
+  if (y1 >= lcdGetHeight())
+  {
+    y1 = lcdGetHeight() - 1;
+  }
+
+  #ifdef DRAW_TILES
+  if (drawTileActive)
+  {
+    uint16_t *dst;
+
+    if (x0 < drawTileX0) x0 = drawTileX0;
+    if (y0 < drawTileY0) y0 = drawTileY0;
+    if (x1 > drawTileX1) x1 = drawTileX1;
+    if (y1 > drawTileY1) y1 = drawTileY1;
+    for (row = y0; row <= y1; row++)
+    {
+      src = &pattern[(uint32_t)(row % height) * width];
+      dst = &drawTileBuffer[(row - drawTileY0) * (drawTileX1 - drawTileX0 + 1) + (x0 - drawTileX0)];
+      col = x0 % width;
+      for (t = x0; t <= x1; t++)
+      {
+        *dst++ = src[col];
+        if (++col == width)
+        {
+          col = 0;
+        }
+      }
+    }
+    return;
+  }
+  #endif
+
+  lcdSetWindow(x0, y0, x1, y1);
+  for (row = y0; row <= y1; row++)
+  {
+    src = &pattern[(uint32_t)(row % height) * width];
+    col = x0 % width;
+    remaining = x1 - x0 + 1;
+    while (remaining)
+    {
+      len = width - col < remaining ? width - col : remaining;
+      lcdStreamPixels((uint16_t *)&src[col], len);
+      remaining -= len;
+      col = 0;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts a 24-bit RGB color to an equivalent 16-bit RGB565 value
+
+    @param[in]  r
+                8-bit red
+    @param[in]  g
+                8-bit green
+    @param[in]  b
+                8-bit blue
+
+    @section Example
+
+    @code 
+
+    // Get 16-bit equivalent of 24-bit color
+    uint16_t gray = drawRGB24toRGB565(0x33, 0x33, 0x33);
+
+    @endcode
+*/
+/**************************************************************************/
+uint16_t drawRGB24toRGB565(uint8_t r, uint8_t g, uint8_t b)
+{
+  return ((r / 8) << 11) | ((g / 4) << 5) | (b / 8);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts a 16-bit RGB565 color to a standard 32-bit BGRA32
+            color (with alpha set to 0xFF)
+
+    @param[in]  color
+                16-bit rgb565 color
+
+    @section Example
+
+    @code 
+
+    // First convert 24-bit color to RGB565
+    uint16_t rgb565 = drawRGB24toRGB565(0xFF, 0x00, 0x00);
+  
+    // Convert RGB565 color back to BGRA32
+    uint32_t bgra32 = drawRGB565toBGRA32(rgb565);
+  
+    // Display results
+    printf("BGRA32: 0x%08X R: %u G: %u B: %u A: %u \r\n", 
+        bgra32, 
+        (bgra32 & 0x000000FF),        // Blue
+        (bgra32 & 0x0000FF00) >> 8,   // Green
+        (bgra32 & 0x00FF0000) >> 16,  // Red
+        (bgra32 & 0xFF000000) >> 24); // Alpha
+
+    @endcode
+*/
+/**************************************************************************/
+uint32_t drawRGB565toBGRA32(uint16_t color)
+{
+  uint32_t bits = (uint32_t)color;
+  uint32_t blue = bits & 0x001F;     // 5 bits blue
+  uint32_t green = bits & 0x07E0;    // 6 bits green
+  uint32_t red = bits & 0xF800;      // 5 bits red
+
+  // Return shifted bits with alpha set to 0xFF
+  return (red << 8) | (green << 5) | (blue << 3) | 0xFF000000;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts a run of packed 24-bit BGR pixels (the byte order
+            used by Windows bitmaps) to RGB565
+
+    Once the source is word-aligned, four pixels are loaded as three
+    32-bit words and converted with shifts and masks, instead of
+    calling drawRGB24toRGB565 with three byte arguments per pixel.
+    The source may have any alignment.
+
+    @param[in]  bgr
+                Packed blue, green, red bytes (count * 3 bytes)
+    @param[out] rgb565
+                Destination for 'count' RGB565 pixels
+    @param[in]  count
+                Number of pixels to convert
+
+    @section Example
+
+    @code 
+
+    uint8_t  bgr[] = { 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00 };
+    uint16_t pixels[2];
+
+    // pixels[] = { COLOR_RED, COLOR_BLUE }
+    drawBGR24toRGB565(bgr, pixels, 2);
+
+    @endcode
+*/
+/**************************************************************************/
+void drawBGR24toRGB565(const uint8_t *bgr, uint16_t *rgb565, uint32_t count)
+{
+  const uint32_t *words;
+  uint32_t w0, w1, w2;
+
+  // Convert single pixels until the source is word-aligned, which
+  // takes at most three of them
+  while (count && ((uintptr_t)bgr & 3))
+  {
+    *rgb565++ = ((bgr[2] & 0xF8) << 8) | ((bgr[1] & 0xFC) << 3) | (bgr[0] >> 3);
+    bgr += 3;
+    count--;
+  }
+
+  // Four pixels per three words: B0G0R0B1 G1R1B2G2 R2B3G3R3
+  words = (const uint32_t *)bgr;
+  for (; count >= 4; count -= 4)
+  {
+    w0 = *words++;
+    w1 = *words++;
+    w2 = *words++;
+    *rgb565++ = ((w0 >> 8) & 0xF800) | ((w0 >> 5) & 0x07E0) | ((w0 >> 3) & 0x001F);
+    *rgb565++ = (w1 & 0xF800) | ((w1 << 3) & 0x07E0) | (w0 >> 27);
+    *rgb565++ = ((w2 << 8) & 0xF800) | ((w1 >> 21) & 0x07E0) | ((w1 >> 19) & 0x001F);
+    *rgb565++ = ((w2 >> 16) & 0xF800) | ((w2 >> 13) & 0x07E0) | ((w2 >> 11) & 0x001F);
+  }
+
+  // Up to three pixels left over
+  bgr = (const uint8_t *)words;
+  while (count--)
+  {
+    *rgb565++ = ((bgr[2] & 0xF8) << 8) | ((bgr[1] & 0xFC) << 3) | (bgr[0] >> 3);
+    bgr += 3;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts a run of RGB565 pixels to packed 24-bit BGR, the
+            inverse of drawBGR24toRGB565.  The low bits of each channel
+            are set to 0, the same as drawRGB565toBGRA32.
+
+    Once the destination is word-aligned, four pixels are stored as
+    three 32-bit words.  The destination may have any alignment.
+
+    @param[in]  rgb565
+                'count' RGB565 pixels
+    @param[out] bgr
+                Destination for the blue, green, red bytes (count * 3
+                bytes)
+    @param[in]  count
+                Number of pixels to convert
+*/
+/**************************************************************************/
+void drawRGB565toBGR24(const uint16_t *rgb565, uint8_t *bgr, uint32_t count)
+{
+  uint32_t *words;
+  uint32_t p0, p1, p2, p3;
+
+  // Convert single pixels until the destination is word-aligned
+  while (count && ((uintptr_t)bgr & 3))
+  {
+    p0 = *rgb565++;
+    *bgr++ = (p0 << 3) & 0xF8;
+    *bgr++ = (p0 >> 3) & 0xFC;
+    *bgr++ = (p0 >> 8) & 0xF8;
+    count--;
+  }
+
+  // Each channel is first moved into place within its own byte
+  // (B = bits 0-7, G = 8-15, R = 16-23), then four pixels are packed
+  // into three words
+  words = (uint32_t *)bgr;
+  for (; count >= 4; count -= 4)
+  {
+    p0 = rgb565[0];
+    p1 = rgb565[1];
+    p2 = rgb565[2];
+    p3 = rgb565[3];
+    rgb565 += 4;
+    p0 = ((p0 << 8) & 0xF80000) | ((p0 << 5) & 0x00FC00) | ((p0 << 3) & 0x0000F8);
+    p1 = ((p1 << 8) & 0xF80000) | ((p1 << 5) & 0x00FC00) | ((p1 << 3) & 0x0000F8);
+    p2 = ((p2 << 8) & 0xF80000) | ((p2 << 5) & 0x00FC00) | ((p2 << 3) & 0x0000F8);
+    p3 = ((p3 << 8) & 0xF80000) | ((p3 << 5) & 0x00FC00) | ((p3 << 3) & 0x0000F8);
+    *words++ = p0 | (p1 << 24);
+    *words++ = (p1 >> 8) | (p2 << 16);
+    *words++ = (p2 >> 16) | (p3 << 8);
+  }
+
+  // Up to three pixels left over
+  bgr = (uint8_t *)words;
+  while (count--)
+  {
+    p0 = *rgb565++;
+    *bgr++ = (p0 << 3) & 0xF8;
+    *bgr++ = (p0 >> 3) & 0xFC;
+    *bgr++ = (p0 >> 8) & 0xF8;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reverses a 16-bit color from BGR to RGB
+*/
+/**************************************************************************/
+uint16_t drawBGR2RGB(uint16_t color)
+{   
+  uint16_t r, g, b;   
+   
+  b = (color>>0)  & 0x1f;   
+  g = (color>>5)  & 0x3f;   
+  r = (color>>11) & 0x1f;   
+     
+  return( (b<<11) + (g<<5) + (r<<0) );
+}  
+
+/**************************************************************************/
+/*!
+    @brief  Draws a progress bar with rounded corners
 
     @param[in]  x
                 Starting x location
@@ -1008,148 +2501,466 @@ uint16_t drawBGR2RGB(uint16_t color)
     // with rounded corners on the top and showing 72% progress)
     drawProgressBar(10, 195, 150, 15, DRAW_ROUNDEDCORNERS_TOP, DRAW_ROUNDEDCORNERS_TOP, COLOR_DARKERGRAY, COLOR_DARKGRAY, COLOR_LIMEGREENDIM, COLOR_LIMEGREEN, 72 );
 
-    @endcode
-*/
-/**************************************************************************/
-void drawProgressBar ( uint16_t x, uint16_t y, uint16_t width, uint16_t height, drawRoundedCorners_t borderCorners, drawRoundedCorners_t progressCorners, uint16_t borderColor, uint16_t borderFillColor, uint16_t progressBorderColor, uint16_t progressFillColor, uint8_t progress )
-{
-  // Draw border with rounded corners
-  drawRectangleRounded(x, y, x + width, y + height, borderColor, 5, borderCorners);
-  drawRectangleRounded(x+1, y+1, x + width - 1, y + height - 1, borderFillColor, 5, borderCorners);
+    @endcode
+*/
+/**************************************************************************/
+void drawProgressBar ( uint16_t x, uint16_t y, uint16_t width, uint16_t height, drawRoundedCorners_t borderCorners, drawRoundedCorners_t progressCorners, uint16_t borderColor, uint16_t borderFillColor, uint16_t progressBorderColor, uint16_t progressFillColor, uint8_t progress )
+{
+  // Draw border with rounded corners
+  drawRectangleRounded(x, y, x + width, y + height, borderColor, 5, borderCorners);
+  drawRectangleRounded(x+1, y+1, x + width - 1, y + height - 1, borderFillColor, 5, borderCorners);
+
+  // Progress bar
+  if (progress > 0 && progress <= 100)
+  {
+    // Calculate bar size
+    uint16_t bw;
+    bw = (width - 6);   // bar at 100%
+    if (progress != 100)
+    {
+      bw = (bw * progress) / 100;
+    } 
+    drawRectangleRounded(x + 3, y + 3, bw + x + 3, y + height - 3, progressBorderColor, 5, progressCorners);
+    drawRectangleRounded(x + 4, y + 4, bw + x + 3 - 1, y + height - 4, progressFillColor, 5, progressCorners);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a simple button
+
+    @param[in]  x
+                Starting x location
+    @param[in]  y
+                Starting y location
+    @param[in]  width
+                Total width of the button in pixels
+    @param[in]  height
+                Total height of the button in pixels
+    @param[in]  fontInfo
+                Pointer to the FONT_INFO used to render the button text
+    @param[in]  fontHeight
+                The height in pixels of the font (used for centering)
+    @param[in]  borderclr
+                The rgb565 border color
+    @param[in]  fillclr
+                The rgb565 background color
+    @param[in]  fontclr
+                The rgb565 font color
+    @param[in]  text
+                The text to render on the button
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/drawing.h"  
+    #include "drivers/lcd/tft/fonts/dejavusansbold9.h"
+
+    // Draw two buttons using Vera Sans Bold 9
+    drawButton(20, 195, 200, 35, &dejaVuSansBold9ptFontInfo, 7, COLOR_DARKERGRAY, COLOR_DARKERGRAY, COLOR_WHITE, "System Settings");
+    drawButton(20, 235, 200, 35, &dejaVuSansBold9ptFontInfo, 7, COLOR_LIMEGREENDIM, COLOR_LIMEGREEN, COLOR_BLACK, "System Settings");
+
+    @endcode
+*/
+/**************************************************************************/
+void drawButton(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const FONT_INFO *fontInfo, uint16_t fontHeight, uint16_t borderclr, uint16_t fillclr, uint16_t fontclr, char* text)
+{
+  uint16_t border, fill, font, activeborder, activefill, activefont;
+
+  // Set colors
+  border            = COLOR_GRAY_30;
+  fill              = COLOR_GRAY_30;
+  font              = COLOR_WHITE;
+  activeborder      = COLOR_THEME_DEFAULT_DARKER;
+  activefill        = COLOR_THEME_DEFAULT_BASE;
+  activefont        = COLOR_BLACK;
+
+  // Border
+  drawRectangleRounded(x, y, x + width, y + height, borderclr, 5, DRAW_ROUNDEDCORNERS_ALL);
+  // Fill
+  drawRectangleRounded(x+2, y+2, x+width-2, y+height-2, fillclr, 5, DRAW_ROUNDEDCORNERS_ALL);
+
+  // Render text
+  if (text != NULL)
+  {
+    uint16_t textWidth = drawGetStringWidth(&*fontInfo, text);
+    uint16_t xStart = x + (width / 2) - (textWidth / 2);
+    uint16_t yStart = y + (height / 2) - (fontHeight / 2) + 1;
+    drawString(xStart, yStart, fontclr, &*fontInfo, text);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Renders a 16x16 monochrome icon using the supplied uint16_t
+            array.
+
+    Each row is scanned for runs of set bits, and every run is sent
+    to the LCD as a single horizontal line.
+
+    @param[in]  x
+                The horizontal location to start rendering from
+    @param[in]  x
+                The vertical location to start rendering from
+    @param[in]  color
+                The RGB565 color to use when rendering the icon
+    @param[in]  icon
+                The uint16_t array containing the 16x16 image data
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/drawing.h"  
+    #include "drivers/lcd/icons16.h"
+
+    // Renders the info icon, which has two seperate parts ... the exterior
+    // and a seperate interior mask if you want to fill the contents with a
+    // different color
+    drawIcon16(132, 202, COLOR_BLUE, icons16_info);
+    drawIcon16(132, 202, COLOR_WHITE, icons16_info_interior);
+
+    @endcode
+*/
+/**************************************************************************/
+void drawIcon16(uint16_t x, uint16_t y, uint16_t color, uint16_t icon[])
+{
+  uint16_t palette[2] = { 0, color };
+  drawIcon16Planes(x, y, &icon, 1, palette, FALSE);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Renders a 16x16 monochrome icon on a solid background, which
+            is sent to the LCD as one 16x16 windowed burst
+
+    @param[in]  x
+                The horizontal location to start rendering from
+    @param[in]  y
+                The vertical location to start rendering from
+    @param[in]  color
+                The RGB565 color to use for set bits
+    @param[in]  bgcolor
+                The RGB565 color to use for cleared bits
+    @param[in]  icon
+                The uint16_t array containing the 16x16 image data
+*/
+/**************************************************************************/
+void drawIcon16Opaque(uint16_t x, uint16_t y, uint16_t color, uint16_t bgcolor, uint16_t icon[])
+{
+  uint16_t palette[2] = { bgcolor, color };
+  drawIcon16Planes(x, y, &icon, 1, palette, TRUE);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Renders a multi-color 16x16 icon made of up to four stacked
+            monochrome planes in a single pass
+
+    For every pixel, bit n of the palette index is taken from plane n,
+    so two planes give four colors.  This means that the existing
+    exterior/interior pairs in icons16.h can be drawn together instead
+    of with one drawIcon16 call per color.
+
+    @param[in]  x
+                The horizontal location to start rendering from
+    @param[in]  y
+                The vertical location to start rendering from
+    @param[in]  planes
+                Array of 'planeCount' pointers to 16x16 icon data
+    @param[in]  planeCount
+                Number of planes (1..4)
+    @param[in]  palette
+                RGB565 colors, with (1 << planeCount) entries
+    @param[in]  opaque
+                If FALSE, pixels with index 0 are left untouched
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/drawing.h"  
+    #include "drivers/lcd/icons16.h"
+
+    // Blue info icon with a white interior, in one pass
+    uint16_t *info[2] = { icons16_info, icons16_info_interior };
+    uint16_t palette[4] = { COLOR_BLACK, COLOR_BLUE, COLOR_WHITE, COLOR_WHITE };
+    drawIcon16Palette(132, 202, info, 2, palette, FALSE);
+
+    @endcode
+*/
+/**************************************************************************/
+void drawIcon16Palette(uint16_t x, uint16_t y, uint16_t *planes[], uint8_t planeCount, const uint16_t palette[], bool opaque)
+{
+  if ((planeCount == 0) || (planeCount > 4))
+  {
+    return;
+  }
+  drawIcon16Planes(x, y, planes, planeCount, palette, opaque);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Renders a palette-indexed image
+
+    Each pixel is stored as a 1, 2, 4 or 8-bit index into an RGB565
+    palette, packed MSB first with every row starting on a new byte.
+    Indices are expanded through the palette while the pixels are
+    streamed into a single LCD window, so a 4-bit image needs a
+    quarter of the flash (or SD bandwidth) of the same RGB565 image,
+    plus 32 bytes for its palette.  Anything past the right or bottom
+    edge of the screen is clipped.
+
+    @param[in]  x
+                Left edge of the image
+    @param[in]  y
+                Top edge of the image
+    @param[in]  width
+                Width of the image in pixels
+    @param[in]  height
+                Height of the image in pixels
+    @param[in]  bitsPerPixel
+                Size of each index (1, 2, 4 or 8)
+    @param[in]  palette
+                RGB565 colors, with (1 << bitsPerPixel) entries
+    @param[in]  data
+                Packed pixel indices, ((width * bitsPerPixel + 7) / 8)
+                bytes per row
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/drawing.h"  
+    #include "logo.h"   // Created with 'bmp2img565 -4 -c logo.bmp logo.h'
+
+    drawImageIndexed(10, 10, LOGO_WIDTH, LOGO_HEIGHT, LOGO_BITSPERPIXEL, logo_palette, logo_data);
+
+    @endcode
+*/
+/**************************************************************************/
+void drawImageIndexed(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t bitsPerPixel, const uint16_t palette[], const uint8_t *data)
+{
+  uint16_t buffer[16];
+  uint16_t row, col, visibleWidth, visibleHeight, count;
+  uint32_t rowBytes, bit;
+  uint8_t mask;
+  const uint8_t *src;
+
+  if ((bitsPerPixel != 1) && (bitsPerPixel != 2) && (bitsPerPixel != 4) && (bitsPerPixel != 8))
+  {
+    return;
+  }
+  if ((x >= lcdGetWidth()) || (y >= lcdGetHeight()) || (width == 0) || (height == 0))
+  {
+    return;
+  }
+
+  visibleWidth = lcdGetWidth() - x < width ? lcdGetWidth() - x : width;
+  visibleHeight = lcdGetHeight() - y < height ? lcdGetHeight() - y : height;
+  rowBytes = ((uint32_t)width * bitsPerPixel + 7) / 8;
+  mask = (1 << bitsPerPixel) - 1;
+
+  #ifdef DRAW_TILES
+  if (drawTileActive)
+  {
+    // Send runs of identical indices to the tile
+    uint16_t start;
+    uint8_t index;
+    for (row = 0; row < visibleHeight; row++)
+    {
+      src = &data[row * rowBytes];
+      col = 0;
+      while (col < visibleWidth)
+      {
+        start = col;
+        bit = (uint32_t)col * bitsPerPixel;
+        index = (src[bit >> 3] >> (8 - bitsPerPixel - (bit & 7))) & mask;
+        do
+        {
+          col++;
+          bit += bitsPerPixel;
+        } while ((col < visibleWidth) && (((src[bit >> 3] >> (8 - bitsPerPixel - (bit & 7))) & mask) == index));
+        drawTargetHLine(x + start, x + col - 1, y + row, palette[index]);
+      }
+    }
+    return;
+  }
+  #endif
+
+  lcdSetWindow(x, y, x + visibleWidth - 1, y + visibleHeight - 1);
+
+  count = 0;
+  for (row = 0; row < visibleHeight; row++)
+  {
+    src = &data[row * rowBytes];
+    for (col = 0, bit = 0; col < visibleWidth; col++, bit += bitsPerPixel)
+    {
+      buffer[count++] = palette[(src[bit >> 3] >> (8 - bitsPerPixel - (bit & 7))) & mask];
+      if (count == 16)
+      {
+        lcdStreamPixels(buffer, count);
+        count = 0;
+      }
+    }
+  }
+  if (count)
+  {
+    lcdStreamPixels(buffer, count);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Renders an RGB565 image, optionally skipping every pixel
+            that matches a transparent color key
+*/
+/**************************************************************************/
+static void drawImage565Clipped(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *data, bool keyed, uint16_t key)
+{
+  uint16_t row, col, start, visibleWidth, visibleHeight;
+  const uint16_t *src;
+
+  if ((x >= lcdGetWidth()) || (y >= lcdGetHeight()) || (width == 0) || (height == 0))
+  {
+    return;
+  }
+
+  #ifdef DRAW_TILES
+  if (drawTileActive)
+  {
+    // Copy the part inside the tile straight into the tile buffer
+    uint32_t x0, y0, x1, y1, tileWidth;
+    uint16_t *dst;
+
+    x0 = x > drawTileX0 ? x : drawTileX0;
+    y0 = y > drawTileY0 ? y : drawTileY0;
+    x1 = (uint32_t)x + width - 1 < drawTileX1 ? (uint32_t)x + width - 1 : drawTileX1;
+    y1 = (uint32_t)y + height - 1 < drawTileY1 ? (uint32_t)y + height - 1 : drawTileY1;
+    if ((x0 > x1) || (y0 > y1))
+    {
+      return;
+    }
+    tileWidth = drawTileX1 - drawTileX0 + 1;
+    for (row = y0; row <= y1; row++)
+    {
+      src = &data[(uint32_t)(row - y) * width + (x0 - x)];
+      dst = &drawTileBuffer[(row - drawTileY0) * tileWidth + (x0 - drawTileX0)];
+      for (col = x0; col <= x1; col++, src++, dst++)
+      {
+        if (!keyed || (*src != key))
+        {
+          *dst = *src;
+        }
+      }
+    }
+    return;
+  }
+  #endif
+
+  visibleWidth = lcdGetWidth() - x < width ? lcdGetWidth() - x : width;
+  visibleHeight = lcdGetHeight() - y < height ? lcdGetHeight() - y : height;
 
-  // Progress bar
-  if (progress > 0 && progress <= 100)
+  if (!keyed)
   {
-    // Calculate bar size
-    uint16_t bw;
-    bw = (width - 6);   // bar at 100%
-    if (progress != 100)
+    // Stream the whole image into one window
+    lcdSetWindow(x, y, x + visibleWidth - 1, y + visibleHeight - 1);
+    if (visibleWidth == width)
     {
-      bw = (bw * progress) / 100;
-    } 
-    drawRectangleRounded(x + 3, y + 3, bw + x + 3, y + height - 3, progressBorderColor, 5, progressCorners);
-    drawRectangleRounded(x + 4, y + 4, bw + x + 3 - 1, y + height - 4, progressFillColor, 5, progressCorners);
+      lcdStreamPixels((uint16_t *)data, (uint32_t)width * visibleHeight);
+      return;
+    }
+    for (row = 0; row < visibleHeight; row++)
+    {
+      lcdStreamPixels((uint16_t *)&data[(uint32_t)row * width], visibleWidth);
+    }
+    return;
+  }
+
+  // Send each run of opaque pixels as one burst
+  for (row = 0; row < visibleHeight; row++)
+  {
+    src = &data[(uint32_t)row * width];
+    col = 0;
+    while (col < visibleWidth)
+    {
+      while ((col < visibleWidth) && (src[col] == key))
+      {
+        col++;
+      }
+      start = col;
+      while ((col < visibleWidth) && (src[col] != key))
+      {
+        col++;
+      }
+      if (col > start)
+      {
+        lcdDrawPixels(x + start, y + row, (uint16_t *)&src[start], col - start);
+      }
+    }
   }
 }
 
 /**************************************************************************/
-/*!
-    @brief  Draws a simple button
+/*! 
+    @brief  Renders an RGB565 image stored row by row, top-down.
+            Anything past the right or bottom edge of the screen is
+            clipped, and inside an open tile the pixels are copied
+            straight into the tile buffer.
 
     @param[in]  x
-                Starting x location
+                Left edge of the image
     @param[in]  y
-                Starting y location
+                Top edge of the image
     @param[in]  width
-                Total width of the button in pixels
+                Width of the image in pixels
     @param[in]  height
-                Total height of the button in pixels
-    @param[in]  fontInfo
-                Pointer to the FONT_INFO used to render the button text
-    @param[in]  fontHeight
-                The height in pixels of the font (used for centering)
-    @param[in]  borderclr
-                The rgb565 border color
-    @param[in]  fillclr
-                The rgb565 background color
-    @param[in]  fontclr
-                The rgb565 font color
-    @param[in]  text
-                The text to render on the button
-
-    @section Example
-
-    @code 
-
-    #include "drivers/lcd/tft/drawing.h"  
-    #include "drivers/lcd/tft/fonts/dejavusansbold9.h"
-
-    // Draw two buttons using Vera Sans Bold 9
-    drawButton(20, 195, 200, 35, &dejaVuSansBold9ptFontInfo, 7, COLOR_DARKERGRAY, COLOR_DARKERGRAY, COLOR_WHITE, "System Settings");
-    drawButton(20, 235, 200, 35, &dejaVuSansBold9ptFontInfo, 7, COLOR_LIMEGREENDIM, COLOR_LIMEGREEN, COLOR_BLACK, "System Settings");
-
-    @endcode
+                Height of the image in pixels
+    @param[in]  data
+                width * height RGB565 pixels
 */
 /**************************************************************************/
-void drawButton(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const FONT_INFO *fontInfo, uint16_t fontHeight, uint16_t borderclr, uint16_t fillclr, uint16_t fontclr, char* text)
+void drawImage565(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *data)
 {
-  uint16_t border, fill, font, activeborder, activefill, activefont;
-
-  // Set colors
-  border            = COLOR_GRAY_30;
-  fill              = COLOR_GRAY_30;
-  font              = COLOR_WHITE;
-  activeborder      = COLOR_THEME_DEFAULT_DARKER;
-  activefill        = COLOR_THEME_DEFAULT_BASE;
-  activefont        = COLOR_BLACK;
-
-  // Border
-  drawRectangleRounded(x, y, x + width, y + height, borderclr, 5, DRAW_ROUNDEDCORNERS_ALL);
-  // Fill
-  drawRectangleRounded(x+2, y+2, x+width-2, y+height-2, fillclr, 5, DRAW_ROUNDEDCORNERS_ALL);
-
-  // Render text
-  if (text != NULL)
-  {
-    uint16_t textWidth = drawGetStringWidth(&*fontInfo, text);
-    uint16_t xStart = x + (width / 2) - (textWidth / 2);
-    uint16_t yStart = y + (height / 2) - (fontHeight / 2) + 1;
-    drawString(xStart, yStart, fontclr, &*fontInfo, text);
-  }
+  drawImage565Clipped(x, y, width, height, data, FALSE, 0);
 }
 
 /**************************************************************************/
 /*! 
-    @brief  Renders a 16x16 monochrome icon using the supplied uint16_t
-            array.
+    @brief  Renders an RGB565 image like drawImage565, but leaves the
+            pixels that match 'key' untouched so that whatever is
+            underneath shows through
 
     @param[in]  x
-                The horizontal location to start rendering from
-    @param[in]  x
-                The vertical location to start rendering from
-    @param[in]  color
-                The RGB565 color to use when rendering the icon
-    @param[in]  icon
-                The uint16_t array containing the 16x16 image data
+                Left edge of the image
+    @param[in]  y
+                Top edge of the image
+    @param[in]  width
+                Width of the image in pixels
+    @param[in]  height
+                Height of the image in pixels
+    @param[in]  data
+                width * height RGB565 pixels
+    @param[in]  key
+                Transparent color
 
     @section Example
 
     @code 
 
     #include "drivers/lcd/tft/drawing.h"  
-    #include "drivers/lcd/icons16.h"
+    #include "ball.h"
 
-    // Renders the info icon, which has two seperate parts ... the exterior
-    // and a seperate interior mask if you want to fill the contents with a
-    // different color
-    drawIcon16(132, 202, COLOR_BLUE, icons16_info);
-    drawIcon16(132, 202, COLOR_WHITE, icons16_info_interior);
+    // Magenta pixels around the ball aren't drawn
+    drawImage565Keyed(100, 100, BALL_WIDTH, BALL_HEIGHT, ball_data, COLOR_MAGENTA);
 
     @endcode
 */
 /**************************************************************************/
-void drawIcon16(uint16_t x, uint16_t y, uint16_t color, uint16_t icon[])
+void drawImage565Keyed(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *data, uint16_t key)
 {
-  int i;
-  for (i = 0; i<16; i++)
-  {
-    if (icon[i] & (0X8000)) drawPixel(x, y+i, color);
-    if (icon[i] & (0X4000)) drawPixel(x+1, y+i, color);
-    if (icon[i] & (0X2000)) drawPixel(x+2, y+i, color);
-    if (icon[i] & (0X1000)) drawPixel(x+3, y+i, color);
-    if (icon[i] & (0X0800)) drawPixel(x+4, y+i, color);
-    if (icon[i] & (0X0400)) drawPixel(x+5, y+i, color);
-    if (icon[i] & (0X0200)) drawPixel(x+6, y+i, color);
-    if (icon[i] & (0X0100)) drawPixel(x+7, y+i, color);
-    if (icon[i] & (0X0080)) drawPixel(x+8, y+i, color);
-    if (icon[i] & (0x0040)) drawPixel(x+9, y+i, color);
-    if (icon[i] & (0X0020)) drawPixel(x+10, y+i, color);
-    if (icon[i] & (0X0010)) drawPixel(x+11, y+i, color);
-    if (icon[i] & (0X0008)) drawPixel(x+12, y+i, color);
-    if (icon[i] & (0X0004)) drawPixel(x+13, y+i, color);
-    if (icon[i] & (0X0002)) drawPixel(x+14, y+i, color);
-    if (icon[i] & (0X0001)) drawPixel(x+15, y+i, color);
-  }
+  drawImage565Clipped(x, y, width, height, data, TRUE, key);
 }
 
 #ifdef CFG_SDCARD
@@ -1201,4 +3012,252 @@ bmp_error_t drawBitmapImage(uint16_t x, uint16_t y, char *filename)
   return bmpDrawBitmap(x, y, filename);
 }
 
+/**************************************************************************/
+/*!
+    @brief  Loads a pre-converted RGB565 image (raw or RLE compressed)
+            from the SD card and renders it.  This is considerably
+            faster than drawBitmapImage() since the pixel data is sent
+            to the LCD exactly as it is stored on the card.
+
+    Images can be created from 24-bit Windows bitmaps with the
+    converter in tools/bmp2img565.
+
+    @param[in]  x
+                Starting x co-ordinate
+    @param[in]  y
+                Starting y co-ordinate
+    @param[in]  filename
+                Full path and filename of the image (see img565.h)
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/drawing.h"
+
+    // Draw image.img (from the root folder) starting at pixel 0,0
+    img565_error_t error = drawImageFile(0, 0, "/image.img");
+
+    if (error)
+    {
+      // See img565_error_t in img565.h for a list of error codes
+    }
+        
+    @endcode
+*/
+/**************************************************************************/
+img565_error_t drawImageFile(uint16_t x, uint16_t y, char *filename)
+{
+  return img565DrawImage(x, y, filename);
+}
+
+#if defined CFG_TFTLCD_JPEG && CFG_TFTLCD_JPEG == 1
+/**************************************************************************/
+/*!
+    @brief  Loads a baseline JPEG image from the SD card and renders it
+            one MCU at a time, optionally scaled down by 2, 4 or 8.
+            Anything outside the LCD is clipped.
+
+    @param[in]  x
+                Starting x co-ordinate
+    @param[in]  y
+                Starting y co-ordinate
+    @param[in]  filename
+                Full path and filename of the image
+    @param[in]  scale
+                1 for full size, or 2, 4 or 8
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/drawing.h"
+
+    // Draw photo.jpg (from the root folder) at quarter size
+    jpeg_error_t error = drawJpegImage(0, 0, "/photo.jpg", 4);
+
+    if (error)
+    {
+      // See jpeg_error_t in jpeg.h for a list of error codes
+    }
+        
+    @endcode
+*/
+/**************************************************************************/
+jpeg_error_t drawJpegImage(uint16_t x, uint16_t y, char *filename, uint8_t scale)
+{
+  return jpegDrawImage(x, y, filename, scale);
+}
+#endif
+
+#endif
+
+#ifdef DRAW_TILES
+/**************************************************************************/
+/*!
+    @brief  Opens an offscreen tile.  Until drawTileEnd is called, all
+            drawing functions render into RAM instead of the LCD.
+
+    @param[in]  x0
+                Left edge of the tile
+    @param[in]  y0
+                Top edge of the tile
+    @param[in]  x1
+                Right edge of the tile
+    @param[in]  y1
+                Bottom edge of the tile
+    @param[in]  background
+                Color the tile is cleared to
+
+    @return     FALSE if a tile is already open or the area doesn't fit
+                in CFG_TFTLCD_TILEBUFFER pixels
+*/
+/**************************************************************************/
+bool drawTileBegin(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t background)
+{
+  uint16_t t;
+  uint32_t i, pixels;
+
+  if (drawTileActive)
+  {
+    return FALSE;
+  }
+
+  if (x1 < x0)
+  {
+    t = x0; x0 = x1; x1 = t;
+  }
+  if (y1 < y0)
+  {
+    t = y0; y0 = y1; y1 = t;
+  }
+
+  // Check limits
+  if ((x0 >= lcdGetWidth()) || (y0 >= lcdGetHeight()))
+  {
+    return FALSE;
+  }
+  if (x1 >= lcdGetWidth())
+  {
+    x1 = lcdGetWidth() - 1;
+  }
+  if (y1 >= lcdGetHeight())
+  {
+    y1 = lcdGetHeight() - 1;
+  }
+
+  pixels = (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+  if (pixels > CFG_TFTLCD_TILEBUFFER)
+  {
+    return FALSE;
+  }
+
+  for (i = 0; i < pixels; i++)
+  {
+    drawTileBuffer[i] = background;
+  }
+
+  drawTileX0 = x0;
+  drawTileY0 = y0;
+  drawTileX1 = x1;
+  drawTileY1 = y1;
+  drawTileActive = TRUE;
+
+  return TRUE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Closes the current tile and sends it to the LCD in a
+            single windowed burst
+*/
+/**************************************************************************/
+void drawTileEnd(void)
+{
+  if (!drawTileActive)
+  {
+    return;
+  }
+
+  drawTileActive = FALSE;
+  lcdSetWindow(drawTileX0, drawTileY0, drawTileX1, drawTileY1);
+  lcdStreamPixels(drawTileBuffer, (uint32_t)(drawTileX1 - drawTileX0 + 1) * (drawTileY1 - drawTileY0 + 1));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Renders an area of any size through the tile buffer
+
+    The area is split into full-width bands that fit in the tile
+    buffer, and 'render' is called once per band with everything
+    outside the band clipped away.  Every pixel in the area is sent to
+    the LCD exactly once.  If a single line of the area doesn't fit in
+    the buffer, 'render' is simply called once and draws directly.
+
+    @param[in]  x0
+                Left edge of the area
+    @param[in]  y0
+                Top edge of the area
+    @param[in]  x1
+                Right edge of the area
+    @param[in]  y1
+                Bottom edge of the area
+    @param[in]  background
+                Color the area is cleared to before rendering
+    @param[in]  render
+                Function that draws the contents of the area
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/drawing.h"  
+    #include "drivers/lcd/tft/fonts/dejavusansbold9.h"
+
+    static void renderOK(void)
+    {
+      drawButton(20, 235, 200, 35, &dejaVuSansBold9ptFontInfo, 7, COLOR_LIMEGREENDIM, COLOR_LIMEGREEN, COLOR_BLACK, "OK");
+    }
+
+    // Draw the button and its label without flicker
+    drawComposite(20, 235, 220, 270, COLOR_BLACK, renderOK);
+
+    @endcode
+*/
+/**************************************************************************/
+void drawComposite(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t background, drawRenderCallback_t render)
+{
+  uint16_t t, rows, y;
+
+  if (x1 < x0)
+  {
+    t = x0; x0 = x1; x1 = t;
+  }
+  if (y1 < y0)
+  {
+    t = y0; y0 = y1; y1 = t;
+  }
+  if (x1 >= lcdGetWidth())
+  {
+    x1 = lcdGetWidth() - 1;
+  }
+  if (y1 >= lcdGetHeight())
+  {
+    y1 = lcdGetHeight() - 1;
+  }
+
+  rows = CFG_TFTLCD_TILEBUFFER / (x1 - x0 + 1);
+  if ((rows == 0) || drawTileActive || (x0 > x1) || (y0 > y1))
+  {
+    render();
+    return;
+  }
+
+  for (y = y0; y <= y1; y += rows)
+  {
+    drawTileBegin(x0, y, x1, (y1 - y < rows) ? y1 : y + rows - 1, background);
+    render();
+    drawTileEnd();
+  }
+}
 #endif
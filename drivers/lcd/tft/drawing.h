@@ -49,6 +49,8 @@
 
 #ifdef CFG_SDCARD
   #include "bmp.h"
+  #include "img565.h"
+  #include "jpeg.h"
 #endif
 
 typedef struct
@@ -68,6 +70,25 @@ typedef enum
   DRAW_ROUNDEDCORNERS_RIGHT
 } drawRoundedCorners_t;
 
+#define DRAW_TEXTLAYOUT_MAXGLYPHS   (40)
+
+typedef struct
+{
+  uint16_t x;                           // Offset from the left of the layout
+  uint16_t y;                           // Offset from the first line
+  char     c;                           // Character to render
+} drawTextGlyph_t;
+
+typedef struct
+{
+  const FONT_INFO *fontInfo;            // Font the layout was measured with
+  uint16_t        width;                // Width of the widest line in pixels
+  uint16_t        height;               // Height of all lines in pixels
+  uint8_t         lines;                // Number of lines
+  uint8_t         count;                // Number of glyphs used
+  drawTextGlyph_t glyphs[DRAW_TEXTLAYOUT_MAXGLYPHS];
+} drawTextLayout_t;
+
 typedef enum
 {
   DRAW_DIRECTION_LEFT,
@@ -86,22 +107,48 @@ void      drawCircleFilled     ( uint16_t xCenter, uint16_t yCenter, uint16_t ra
 void      drawArrow            ( uint16_t x, uint16_t y, uint16_t size, drawDirection_t, uint16_t color );
 void      drawRectangle        ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color );
 void      drawRectangleFilled  ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color );
+void      drawGradientRect     ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t startColor, uint16_t endColor, drawDirection_t direction );
+void      drawPatternRect      ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, const uint16_t *pattern, uint16_t width, uint16_t height );
 void      drawRectangleRounded ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color, uint16_t radius, drawRoundedCorners_t corners );
 void      drawString           ( uint16_t x, uint16_t y, uint16_t color, const FONT_INFO *fontInfo, char *str );
+void      drawStringOpaque     ( uint16_t x, uint16_t y, uint16_t color, uint16_t bgcolor, const FONT_INFO *fontInfo, char *str );
 uint16_t  drawGetStringWidth   ( const FONT_INFO *fontInfo, char *str );
+uint16_t  drawCharToBuffer     ( uint16_t *buffer, uint16_t width, uint16_t xOffset, uint16_t color, uint16_t bgcolor, const FONT_INFO *fontInfo, char c );
+uint16_t  drawMeasureString    ( drawTextLayout_t *layout, const FONT_INFO *fontInfo, char *str, uint16_t maxWidth, uint8_t maxLines );
+void      drawStringLayout     ( const drawTextLayout_t *layout, uint16_t x, uint16_t y, uint16_t color );
+void      drawStringLayoutOpaque ( const drawTextLayout_t *layout, uint16_t x, uint16_t y, uint16_t color, uint16_t bgcolor );
 void      drawProgressBar      ( uint16_t x, uint16_t y, uint16_t width, uint16_t height, drawRoundedCorners_t borderCorners, drawRoundedCorners_t progressCorners, uint16_t borderColor, uint16_t borderFillColor, uint16_t progressBorderColor, uint16_t progressFillColor, uint8_t progress );
 void      drawButton           ( uint16_t x, uint16_t y, uint16_t width, uint16_t height, const FONT_INFO *fontInfo, uint16_t fontHeight, uint16_t borderclr, uint16_t fillclr, uint16_t fontclr, char* text );
 void      drawIcon16           ( uint16_t x, uint16_t y, uint16_t color, uint16_t icon[] );
+void      drawIcon16Opaque     ( uint16_t x, uint16_t y, uint16_t color, uint16_t bgcolor, uint16_t icon[] );
+void      drawIcon16Palette    ( uint16_t x, uint16_t y, uint16_t *planes[], uint8_t planeCount, const uint16_t palette[], bool opaque );
+void      drawImageIndexed     ( uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t bitsPerPixel, const uint16_t palette[], const uint8_t *data );
+void      drawImage565         ( uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *data );
+void      drawImage565Keyed    ( uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *data, uint16_t key );
 uint16_t  drawRGB24toRGB565    ( uint8_t r, uint8_t g, uint8_t b );
 uint32_t  drawRGB565toBGRA32   ( uint16_t color );
+void      drawBGR24toRGB565    ( const uint8_t *bgr, uint16_t *rgb565, uint32_t count );
+void      drawRGB565toBGR24    ( const uint16_t *rgb565, uint8_t *bgr, uint32_t count );
 uint16_t  drawBGR2RGB          ( uint16_t color );
 
 #if defined CFG_TFTLCD_INCLUDESMALLFONTS & CFG_TFTLCD_INCLUDESMALLFONTS == 1
 void      drawStringSmall      ( uint16_t x, uint16_t y, uint16_t color, char* text, struct FONT_DEF font );
 #endif
 
+#if defined CFG_TFTLCD_TILEBUFFER && CFG_TFTLCD_TILEBUFFER > 0
+typedef void (*drawRenderCallback_t)(void);
+
+bool      drawTileBegin        ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t background );
+void      drawTileEnd          ( void );
+void      drawComposite        ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t background, drawRenderCallback_t render );
+#endif
+
 #if defined CFG_SDCARD
 bmp_error_t   drawBitmapImage  ( uint16_t x, uint16_t y, char *filename );
+img565_error_t drawImageFile   ( uint16_t x, uint16_t y, char *filename );
+#if defined CFG_TFTLCD_JPEG && CFG_TFTLCD_JPEG == 1
+jpeg_error_t  drawJpegImage    ( uint16_t x, uint16_t y, char *filename, uint8_t scale );
+#endif
 #endif
 
 #endif
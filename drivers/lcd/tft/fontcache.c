@@ -0,0 +1,287 @@
+/**************************************************************************/
+/*! 
+    @file     fontcache.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Bitmap fonts loaded from an asset pack on the SD card
+
+    @section DESCRIPTION
+
+    Only the character descriptors of a font are kept in RAM (about 400
+    bytes per font, in the caller's fontcache_font_t).  Glyphs are read
+    from the card when they are first drawn, and the most recently used
+    ones are kept in a cache of CFG_TFTLCD_FONTCACHE slots of
+    FONTCACHE_GLYPHSIZE bytes shared by all fonts, so the usual text
+    on a screen is drawn without touching the card.  This allows any
+    number of extra fonts, sizes or languages without using any flash.
+
+    FONT_INFO.data is NULL for these fonts, which is how drawing.c
+    knows to ask fontCacheGetGlyph for the glyph data.
+
+    @section Example
+
+    @code 
+    #include "drivers/fatfs/assetpack.h"
+    #include "drivers/lcd/tft/drawing.h"
+    #include "drivers/lcd/tft/fontcache.h"
+    #include "assets.h"                 // Generated by tools/assetpack
+
+    static fontcache_font_t large;
+
+    if ((assetPackOpen("/ui.pak") == ASSETPACK_ERROR_NONE) &&
+        (fontCacheLoad(&large, ASSET_FONT_LARGE) == FONTCACHE_ERROR_NONE))
+    {
+      drawString(10, 10, COLOR_WHITE, &large.info, "Loaded from SD");
+    }
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "fontcache.h"
+
+#if defined CFG_TFTLCD_FONTCACHE && CFG_TFTLCD_FONTCACHE > 0
+
+typedef struct
+{
+  const fontcache_font_t *font;       /* NULL if the slot is free     */
+  uint8_t                 index;      /* Character - startChar        */
+  uint8_t                 data[FONTCACHE_GLYPHSIZE];
+} fontcache_slot_t;
+
+static fontcache_slot_t fontCacheSlots[CFG_TFTLCD_FONTCACHE];
+
+// Slot numbers, most recently used first
+static uint8_t fontCacheOrder[CFG_TFTLCD_FONTCACHE];
+static bool fontCacheReady = false;
+
+/**************************************************************************/
+/*!
+    @brief  Moves the slot at 'pos' in fontCacheOrder to the front
+*/
+/**************************************************************************/
+static uint8_t fontCacheTouch(uint8_t pos)
+{
+  uint8_t slot = fontCacheOrder[pos];
+
+  memmove(&fontCacheOrder[1], &fontCacheOrder[0], pos);
+  fontCacheOrder[0] = slot;
+  return slot;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Copies 'length' bytes at 'offset' in the asset to 'buffer'
+*/
+/**************************************************************************/
+static bool fontCacheRead(const assetpack_entry_t *entry, uint32_t offset, uint8_t *buffer, uint32_t length)
+{
+  const uint8_t *sector;
+  uint32_t n;
+
+  while (length)
+  {
+    if (assetPackGetSector(entry, offset / ASSETPACK_SECTORSIZE, &sector) != ASSETPACK_ERROR_NONE)
+    {
+      return false;
+    }
+    n = ASSETPACK_SECTORSIZE - (offset % ASSETPACK_SECTORSIZE);
+    if (n > length)
+    {
+      n = length;
+    }
+    memcpy(buffer, sector + (offset % ASSETPACK_SECTORSIZE), n);
+    buffer += n;
+    offset += n;
+    length -= n;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Loads the descriptors of a .fnt asset from the open asset
+            pack (see assetPackOpen)
+
+    @param[out] font
+                Font to fill in.  It must stay in scope until
+                fontCacheUnload is called, since cached glyphs refer
+                to it.
+    @param[in]  id
+                Asset ID of the font
+*/
+/**************************************************************************/
+fontcache_error_t fontCacheLoad(fontcache_font_t *font, uint16_t id)
+{
+  uint8_t header[FONTCACHE_HEADERSIZE];
+  uint8_t desc[3];
+  uint8_t i;
+
+  if (!fontCacheReady)
+  {
+    for (i = 0; i < CFG_TFTLCD_FONTCACHE; i++)
+    {
+      fontCacheOrder[i] = i;
+    }
+    fontCacheReady = true;
+  }
+
+  // Glyphs of whatever was loaded here before are stale
+  fontCacheUnload(font);
+  memset(font, 0, sizeof(fontcache_font_t));
+
+  if (assetPackFind(id, &font->entry) != ASSETPACK_ERROR_NONE)
+  {
+    return FONTCACHE_ERROR_NOTFOUND;
+  }
+  if ((font->entry.length < FONTCACHE_HEADERSIZE) || !fontCacheRead(&font->entry, 0, header, FONTCACHE_HEADERSIZE))
+  {
+    return FONTCACHE_ERROR_READFAIL;
+  }
+  if (memcmp(header, "uFNT", 4) || (header[4] == 0) || (header[7] > FONT_FORMAT_AA4))
+  {
+    return FONTCACHE_ERROR_NOTAFONT;
+  }
+  if (header[6] > FONTCACHE_MAXCHARS)
+  {
+    return FONTCACHE_ERROR_TOOMANYCHARS;
+  }
+  if (font->entry.length < FONTCACHE_HEADERSIZE + header[6] * 3)
+  {
+    return FONTCACHE_ERROR_NOTAFONT;
+  }
+
+  for (i = 0; i < header[6]; i++)
+  {
+    if (!fontCacheRead(&font->entry, FONTCACHE_HEADERSIZE + i * 3, desc, 3))
+    {
+      return FONTCACHE_ERROR_READFAIL;
+    }
+    font->chars[i].widthBits = desc[0];
+    font->chars[i].offset = desc[1] | (desc[2] << 8);
+  }
+
+  font->charCount = header[6];
+  font->info.heightPages = header[4];
+  font->info.startChar = header[5];
+  font->info.charInfo = font->chars;
+  font->info.data = NULL;
+  font->info.format = header[7];
+
+  return FONTCACHE_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Drops the cached glyphs of a font
+*/
+/**************************************************************************/
+void fontCacheUnload(fontcache_font_t *font)
+{
+  uint8_t i;
+
+  for (i = 0; i < CFG_TFTLCD_FONTCACHE; i++)
+  {
+    if (fontCacheSlots[i].font == font)
+    {
+      fontCacheSlots[i].font = NULL;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the glyph data of one character of a font loaded
+            with fontCacheLoad, reading it from the card if it isn't
+            cached yet.  The pointer is valid until the next call.
+
+    @param[in]  fontInfo
+                &font.info of the font
+    @param[in]  index
+                The character minus the font's startChar
+
+    @return     NULL if the glyph is empty, too large for a cache slot
+                or can't be read
+*/
+/**************************************************************************/
+const uint8_t *fontCacheGetGlyph(const FONT_INFO *fontInfo, uint8_t index)
+{
+  const fontcache_font_t *font = (const fontcache_font_t *)fontInfo;
+  fontcache_slot_t *s;
+  uint32_t offset, end;
+  uint8_t pos, slot, i;
+
+  if ((index >= font->charCount) || (font->chars[index].widthBits == 0))
+  {
+    return NULL;
+  }
+
+  for (pos = 0; pos < CFG_TFTLCD_FONTCACHE; pos++)
+  {
+    s = &fontCacheSlots[fontCacheOrder[pos]];
+    if ((s->font == font) && (s->index == index))
+    {
+      return fontCacheSlots[fontCacheTouch(pos)].data;
+    }
+  }
+
+  // Glyphs are stored in order, so each one ends where the next one starts
+  offset = font->chars[index].offset;
+  end = font->entry.length - FONTCACHE_HEADERSIZE - font->charCount * 3;
+  for (i = 0; i < font->charCount; i++)
+  {
+    if ((font->chars[i].offset > offset) && (font->chars[i].offset < end))
+    {
+      end = font->chars[i].offset;
+    }
+  }
+  if ((end <= offset) || (end - offset > FONTCACHE_GLYPHSIZE))
+  {
+    return NULL;
+  }
+
+  // Replace the least recently used glyph
+  slot = fontCacheTouch(CFG_TFTLCD_FONTCACHE - 1);
+  s = &fontCacheSlots[slot];
+  s->font = NULL;
+  if (!fontCacheRead(&font->entry, FONTCACHE_HEADERSIZE + font->charCount * 3 + offset, s->data, end - offset))
+  {
+    return NULL;
+  }
+  s->font = font;
+  s->index = index;
+
+  return s->data;
+}
+
+#endif
@@ -0,0 +1,86 @@
+/**************************************************************************/
+/*! 
+    @file     fontcache.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __FONTCACHE_H__
+#define __FONTCACHE_H__
+
+#include "projectconfig.h"
+#include "drivers/lcd/tft/fonts/bitmapfonts.h"
+#include "drivers/fatfs/assetpack.h"
+
+/* .fnt files (written by 'tools/fontsubset -b') start with an 8 byte
+   header: "uFNT", heightPages, startChar, charCount and format.  It is
+   followed by charCount x 3 bytes of character descriptors (width,
+   then the 16-bit little-endian offset into the glyph data) and by the
+   glyph data itself, in the same layout as the flash fonts. */
+#define FONTCACHE_HEADERSIZE    (8)
+#define FONTCACHE_MAXCHARS      (96)    /* ' ' to '\x7F' */
+#define FONTCACHE_GLYPHSIZE     (64)    /* Largest glyph that can be cached */
+
+/**************************************************************************/
+/*!
+    @brief  A font loaded from an asset pack.  Pass &font.info to the
+            text functions in drawing.c like any other FONT_INFO.
+*/
+/**************************************************************************/
+typedef struct
+{
+  FONT_INFO           info;           /* Must be first (see fontCacheGetGlyph) */
+  FONT_CHAR_INFO      chars[FONTCACHE_MAXCHARS];
+  assetpack_entry_t   entry;          /* Location of the .fnt asset   */
+  uint8_t             charCount;
+} fontcache_font_t;
+
+/**************************************************************************/
+/*!
+    @brief  Error return codes for the font cache
+*/
+/**************************************************************************/
+typedef enum
+{
+  FONTCACHE_ERROR_NONE = 0,
+  FONTCACHE_ERROR_NOTFOUND = 1,         /* No such asset in the open pack */
+  FONTCACHE_ERROR_READFAIL = 2,
+  FONTCACHE_ERROR_NOTAFONT = 3,         /* Missing 'uFNT' header */
+  FONTCACHE_ERROR_TOOMANYCHARS = 4      /* More than FONTCACHE_MAXCHARS characters */
+} fontcache_error_t;
+
+#if defined CFG_TFTLCD_FONTCACHE && CFG_TFTLCD_FONTCACHE > 0
+fontcache_error_t fontCacheLoad     ( fontcache_font_t *font, uint16_t id );
+void              fontCacheUnload   ( fontcache_font_t *font );
+const uint8_t *   fontCacheGetGlyph ( const FONT_INFO *fontInfo, uint8_t index );
+#endif
+
+#endif
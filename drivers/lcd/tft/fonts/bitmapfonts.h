@@ -40,6 +40,43 @@
 
 #include "projectconfig.h"
 
+/**************************************************************************/
+/*! 
+    @brief Glyph data formats (FONT_INFO.format)
+
+    FONT_FORMAT_PAGES is the native output of The Dot Factory: each
+    glyph is stored column by column in 8-pixel vertical pages, with
+    the bottom page of each column first.
+
+    FONT_FORMAT_RLE is generated from a Dot Factory font by
+    tools/fontrle and stores horizontal runs, so each run can be sent
+    to the LCD as a single line.  Each glyph starts with a header byte
+    holding the first stored row in the upper nibble and the number of
+    stored rows minus one in the lower nibble (rows above and below
+    the glyph are empty and aren't stored).  Each row is then a list
+    of run bytes:
+
+      bit 7     Set on the last run of the row
+      bit 6..4  Pixels to skip before the run (0-7)
+      bit 3..0  Length of the run (0-15, 0 = skip only)
+
+    An empty row is stored as a single 0x80.  RLE fonts are limited to
+    16 rows (2 pages).
+
+    FONT_FORMAT_AA2 and FONT_FORMAT_AA4 are anti-aliased fonts with 2
+    or 4 bits of coverage per pixel (0 = background, 3 or 15 = solid
+    foreground), generated by 'tools/fontrle -a' from a Dot Factory
+    font rendered at 2x or 4x the target size.  Glyphs are stored row
+    by row from the top, MSB first, with heightPages * 8 rows of
+    widthBits pixels packed without any padding between rows.  Each
+    glyph starts on a byte boundary.
+*/
+/**************************************************************************/
+#define FONT_FORMAT_PAGES   (0)
+#define FONT_FORMAT_RLE     (1)
+#define FONT_FORMAT_AA2     (2)
+#define FONT_FORMAT_AA4     (3)
+
 /**************************************************************************/
 /*! 
     @brief Describes a single character's display information
@@ -47,8 +84,8 @@
 /**************************************************************************/
 typedef struct
 {
-  const uint8_t widthBits;              // width, in bits (or pixels), of the character
-  const uint16_t offset;                // offset of the character's bitmap, in bytes, into the the FONT_INFO's data array
+  uint8_t widthBits;                    // width, in bits (or pixels), of the character
+  uint16_t offset;                      // offset of the character's bitmap, in bytes, into the the FONT_INFO's data array
 } FONT_CHAR_INFO;	
 
 /**************************************************************************/
@@ -58,10 +95,11 @@ typedef struct
 /**************************************************************************/
 typedef struct
 {
-  const uint8_t           heightPages;  // height, in pages (8 pixels), of the font's characters
-  const uint8_t           startChar;    // the first character in the font (e.g. in charInfo and data)
+  uint8_t                 heightPages;  // height, in pages (8 pixels), of the font's characters
+  uint8_t                 startChar;    // the first character in the font (e.g. in charInfo and data)
   const FONT_CHAR_INFO*	  charInfo;     // pointer to array of char information
-  const uint8_t*          data;         // pointer to generated array of character visual representation
+  const uint8_t*          data;         // pointer to generated array of character visual representation (NULL for fonts loaded by fontcache.c)
+  uint8_t                 format;       // FONT_FORMAT_PAGES (default if omitted), _RLE, _AA2 or _AA4
 } FONT_INFO;
 
 #endif
@@ -0,0 +1,1329 @@
+#include "veramono11rle.h"
+
+/* 
+**  Run-length encoded font data for Bitstream Vera Sans Mono 11pt
+**  (generated from The Dot Factory output by tools/fontrle)
+*/
+
+/* Character data for Bitstream Vera Sans Mono 11pt */
+const uint8_t bitstreamVeraSansMono11ptRleCharRuns[] = 
+{
+	/* @0 ' ' (9 pixels wide) */
+	0x00, /* rows 0-0 */
+	0x80,                   /*           */
+
+	/* @2 '!' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0x80,                   /*           */
+	0x80,                   /*           */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+
+	/* @14 '"' (9 pixels wide) */
+	0x13, /* rows 1-4 */
+	0x31, 0xA1,             /*    #  #   */
+	0x31, 0xA1,             /*    #  #   */
+	0x31, 0xA1,             /*    #  #   */
+	0x31, 0xA1,             /*    #  #   */
+
+	/* @23 '#' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x41, 0xA1,             /*     #  #  */
+	0x32, 0x92,             /*    ## ##  */
+	0x31, 0xA1,             /*    #  #   */
+	0x98,                   /*  ######## */
+	0x31, 0xA1,             /*    #  #   */
+	0x22, 0x92,             /*   ## ##   */
+	0x21, 0xA1,             /*   #  #    */
+	0x88,                   /* ########  */
+	0x21, 0xA1,             /*   #  #    */
+	0x21, 0x92,             /*   # ##    */
+	0x11, 0xA1,             /*  #  #     */
+
+	/* @44 '$' (9 pixels wide) */
+	0x0D, /* rows 0-13 */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xA5,                   /*   #####   */
+	0x12, 0x11, 0xA1,       /*  ## #  #  */
+	0x11, 0xA1,             /*  #  #     */
+	0x11, 0xA1,             /*  #  #     */
+	0xA3,                   /*   ###     */
+	0xC3,                   /*     ###   */
+	0x41, 0xA1,             /*     #  #  */
+	0x41, 0xA1,             /*     #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0xA5,                   /*   #####   */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+
+	/* @67 '%' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x93,                   /*  ###      */
+	0x01, 0xB1,             /* #   #     */
+	0x01, 0xB1,             /* #   #     */
+	0x01, 0xB1,             /* #   #     */
+	0x13, 0xA2,             /*  ###  ##  */
+	0xB3,                   /*    ###    */
+	0x12, 0xA3,             /*  ##  ###  */
+	0x41, 0xB1,             /*     #   # */
+	0x41, 0xB1,             /*     #   # */
+	0x41, 0xB1,             /*     #   # */
+	0xD3,                   /*      ###  */
+
+	/* @87 '&' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB4,                   /*    ####   */
+	0xA1,                   /*   #       */
+	0xA1,                   /*   #       */
+	0xA2,                   /*   ##      */
+	0xA3,                   /*   ###     */
+	0x12, 0x11, 0xA1,       /*  ## #  #  */
+	0x11, 0x31, 0x91,       /*  #   # #  */
+	0x11, 0xB3,             /*  #   ###  */
+	0x11, 0xC1,             /*  #    #   */
+	0x21, 0xB1,             /*   #   #   */
+	0x33, 0x91,             /*    ### #  */
+
+	/* @107 '\'' (9 pixels wide) */
+	0x13, /* rows 1-4 */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+
+	/* @112 '(' (9 pixels wide) */
+	0x1C, /* rows 1-13 */
+	0xD1,                   /*      #    */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xD1,                   /*      #    */
+
+	/* @126 ')' (9 pixels wide) */
+	0x1C, /* rows 1-13 */
+	0xA1,                   /*   #       */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xA1,                   /*   #       */
+
+	/* @140 '*' (9 pixels wide) */
+	0x15, /* rows 1-6 */
+	0xC1,                   /*     #     */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0xA5,                   /*   #####   */
+	0xB3,                   /*    ###    */
+	0x12, 0x11, 0x92,       /*  ## # ##  */
+	0xC1,                   /*     #     */
+
+	/* @151 '+' (9 pixels wide) */
+	0x46, /* rows 4-10 */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0x97,                   /*  #######  */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+
+	/* @159 ',' (9 pixels wide) */
+	0xA3, /* rows 10-13 */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC1,                   /*     #     */
+	0xB1,                   /*    #      */
+
+	/* @164 '-' (9 pixels wide) */
+	0x70, /* rows 7-7 */
+	0xB4,                   /*    ####   */
+
+	/* @166 '.' (9 pixels wide) */
+	0xA1, /* rows 10-11 */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+
+	/* @169 '/' (9 pixels wide) */
+	0x1B, /* rows 1-12 */
+	0xF1,                   /*        #  */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+	0xD1,                   /*      #    */
+	0xD1,                   /*      #    */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xA1,                   /*   #       */
+	0xA1,                   /*   #       */
+	0x91,                   /*  #        */
+
+	/* @182 '0' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB3,                   /*    ###    */
+	0x21, 0xB1,             /*   #   #   */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0x22, 0x91,       /*  #  ## #  */
+	0x11, 0x22, 0x91,       /*  #  ## #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB1,             /*   #   #   */
+	0xB3,                   /*    ###    */
+
+	/* @205 '1' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB2,                   /*    ##     */
+	0x21, 0x91,             /*   # #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xA5,                   /*   #####   */
+
+	/* @218 '2' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xA4,                   /*   ####    */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0xF1,                   /*        #  */
+	0xF1,                   /*        #  */
+	0xE1,                   /*       #   */
+	0xD1,                   /*      #    */
+	0xC1,                   /*     #     */
+	0xB1,                   /*    #      */
+	0xA1,                   /*   #       */
+	0x97,                   /*  #######  */
+
+	/* @232 '3' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xA4,                   /*   ####    */
+	0x11, 0xC2,             /*  #    ##  */
+	0xF1,                   /*        #  */
+	0xF1,                   /*        #  */
+	0xE2,                   /*       ##  */
+	0xB3,                   /*    ###    */
+	0xE2,                   /*       ##  */
+	0xF1,                   /*        #  */
+	0xF1,                   /*        #  */
+	0x11, 0xC2,             /*  #    ##  */
+	0xA5,                   /*   #####   */
+
+	/* @246 '4' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xD2,                   /*      ##   */
+	0xC3,                   /*     ###   */
+	0x41, 0x91,             /*     # #   */
+	0x31, 0xA1,             /*    #  #   */
+	0x22, 0xA1,             /*   ##  #   */
+	0x21, 0xB1,             /*   #   #   */
+	0x11, 0xC1,             /*  #    #   */
+	0x97,                   /*  #######  */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+
+	/* @263 '5' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x96,                   /*  ######   */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x95,                   /*  #####    */
+	0x11, 0xC1,             /*  #    #   */
+	0xF1,                   /*        #  */
+	0xF1,                   /*        #  */
+	0xF1,                   /*        #  */
+	0x11, 0xC1,             /*  #    #   */
+	0xA4,                   /*   ####    */
+
+	/* @277 '6' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB4,                   /*    ####   */
+	0x22, 0xB1,             /*   ##   #  */
+	0xA1,                   /*   #       */
+	0x91,                   /*  #        */
+	0x11, 0x94,             /*  # ####   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB2,             /*   #   ##  */
+	0xB4,                   /*    ####   */
+
+	/* @296 '7' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x97,                   /*  #######  */
+	0xE2,                   /*       ##  */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+	0xD1,                   /*      #    */
+	0xD1,                   /*      #    */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xA1,                   /*   #       */
+
+	/* @308 '8' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xA5,                   /*   #####   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0xB3,                   /*    ###    */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0xA5,                   /*   #####   */
+
+	/* @328 '9' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xA4,                   /*   ####    */
+	0x12, 0xB1,             /*  ##   #   */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x24, 0x91,             /*   #### #  */
+	0xF1,                   /*        #  */
+	0xE1,                   /*       #   */
+	0x11, 0xB2,             /*  #   ##   */
+	0xA4,                   /*   ####    */
+
+	/* @347 ':' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0x80,                   /*           */
+	0x80,                   /*           */
+	0x80,                   /*           */
+	0x80,                   /*           */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+
+	/* @356 ';' (9 pixels wide) */
+	0x49, /* rows 4-13 */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0x80,                   /*           */
+	0x80,                   /*           */
+	0x80,                   /*           */
+	0x80,                   /*           */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC1,                   /*     #     */
+	0xB1,                   /*    #      */
+
+	/* @367 '<' (9 pixels wide) */
+	0x46, /* rows 4-10 */
+	0x70, 0x91,             /*         # */
+	0xD3,                   /*      ###  */
+	0xA3,                   /*   ###     */
+	0x92,                   /*  ##       */
+	0xA3,                   /*   ###     */
+	0xD3,                   /*      ###  */
+	0x70, 0x91,             /*         # */
+
+	/* @377 '=' (9 pixels wide) */
+	0x53, /* rows 5-8 */
+	0x98,                   /*  ######## */
+	0x80,                   /*           */
+	0x80,                   /*           */
+	0x98,                   /*  ######## */
+
+	/* @382 '>' (9 pixels wide) */
+	0x46, /* rows 4-10 */
+	0x91,                   /*  #        */
+	0xA3,                   /*   ###     */
+	0xD3,                   /*      ###  */
+	0xF2,                   /*        ## */
+	0xD3,                   /*      ###  */
+	0xA3,                   /*   ###     */
+	0x91,                   /*  #        */
+
+	/* @390 '?' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB4,                   /*    ####   */
+	0x21, 0xC1,             /*   #    #  */
+	0xF1,                   /*        #  */
+	0xF1,                   /*        #  */
+	0xE1,                   /*       #   */
+	0xC2,                   /*     ##    */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0x80,                   /*           */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+
+	/* @403 '@' (9 pixels wide) */
+	0x2B, /* rows 2-13 */
+	0xB4,                   /*    ####   */
+	0x22, 0xA2,             /*   ##  ##  */
+	0x21, 0xC1,             /*   #    #  */
+	0x11, 0xB3,             /*  #   ###  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0xB3,             /*  #   ###  */
+	0xA1,                   /*   #       */
+	0xA2,                   /*   ##      */
+	0xC3,                   /*     ###   */
+
+	/* @428 'A' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xC1,                   /*     #     */
+	0x31, 0x91,             /*    # #    */
+	0x31, 0x91,             /*    # #    */
+	0x31, 0x91,             /*    # #    */
+	0x31, 0x91,             /*    # #    */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+	0xA5,                   /*   #####   */
+	0x21, 0xB1,             /*   #   #   */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+
+	/* @449 'B' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x96,                   /*  ######   */
+	0x11, 0xC2,             /*  #    ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xC2,             /*  #    ##  */
+	0x96,                   /*  ######   */
+	0x11, 0xC2,             /*  #    ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xC2,             /*  #    ##  */
+	0x96,                   /*  ######   */
+
+	/* @469 'C' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB4,                   /*    ####   */
+	0x21, 0xC1,             /*   #    #  */
+	0xA1,                   /*   #       */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0xA1,                   /*   #       */
+	0x21, 0xC1,             /*   #    #  */
+	0xB4,                   /*    ####   */
+
+	/* @483 'D' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x95,                   /*  #####    */
+	0x11, 0xB2,             /*  #   ##   */
+	0x11, 0xC1,             /*  #    #   */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xC1,             /*  #    #   */
+	0x11, 0xB2,             /*  #   ##   */
+	0x95,                   /*  #####    */
+
+	/* @504 'E' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x97,                   /*  #######  */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x97,                   /*  #######  */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x97,                   /*  #######  */
+
+	/* @516 'F' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x97,                   /*  #######  */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x97,                   /*  #######  */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+
+	/* @528 'G' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB4,                   /*    ####   */
+	0x21, 0xC1,             /*   #    #  */
+	0xA1,                   /*   #       */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x11, 0xB3,             /*  #   ###  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xC1,             /*   #    #  */
+	0x21, 0xC1,             /*   #    #  */
+	0xB4,                   /*    ####   */
+
+	/* @546 'H' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x97,                   /*  #######  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+
+	/* @568 'I' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xA5,                   /*   #####   */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xA5,                   /*   #####   */
+
+	/* @580 'J' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB4,                   /*    ####   */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+	0x11, 0xB2,             /*  #   ##   */
+	0xA4,                   /*   ####    */
+
+	/* @593 'K' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xC1,             /*  #    #   */
+	0x11, 0xB1,             /*  #   #    */
+	0x11, 0xA1,             /*  #  #     */
+	0x11, 0x91,             /*  # #      */
+	0x12, 0x91,             /*  ## #     */
+	0x11, 0xA1,             /*  #  #     */
+	0x11, 0xB1,             /*  #   #    */
+	0x11, 0xC1,             /*  #    #   */
+	0x11, 0xC1,             /*  #    #   */
+	0x11, 0xD1,             /*  #     #  */
+
+	/* @616 'L' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x97,                   /*  #######  */
+
+	/* @628 'M' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+
+	/* @658 'N' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x12, 0xC1,             /*  ##    #  */
+	0x12, 0xC1,             /*  ##    #  */
+	0x11, 0x11, 0xB1,       /*  # #   #  */
+	0x11, 0x11, 0xB1,       /*  # #   #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x31, 0x91,       /*  #   # #  */
+	0x11, 0x31, 0x91,       /*  #   # #  */
+	0x11, 0xC2,             /*  #    ##  */
+	0x11, 0xC2,             /*  #    ##  */
+
+	/* @688 'O' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB3,                   /*    ###    */
+	0x21, 0xB1,             /*   #   #   */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB1,             /*   #   #   */
+	0xB3,                   /*    ###    */
+
+	/* @709 'P' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x96,                   /*  ######   */
+	0x11, 0xC2,             /*  #    ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xC2,             /*  #    ##  */
+	0x96,                   /*  ######   */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+
+	/* @726 'Q' (9 pixels wide) */
+	0x1C, /* rows 1-13 */
+	0xB3,                   /*    ###    */
+	0x21, 0xB1,             /*   #   #   */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB1,             /*   #   #   */
+	0xB4,                   /*    ####   */
+	0xD2,                   /*      ##   */
+	0xE1,                   /*       #   */
+
+	/* @749 'R' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x96,                   /*  ######   */
+	0x11, 0xC2,             /*  #    ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xC2,             /*  #    ##  */
+	0x95,                   /*  #####    */
+	0x11, 0xC1,             /*  #    #   */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xE1,             /*  #      # */
+
+	/* @770 'S' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB4,                   /*    ####   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x92,                   /*  ##       */
+	0xB3,                   /*    ###    */
+	0xE2,                   /*       ##  */
+	0xF1,                   /*        #  */
+	0xF1,                   /*        #  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0xA5,                   /*   #####   */
+
+	/* @784 'T' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x97,                   /*  #######  */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+
+	/* @796 'U' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0xA5,                   /*   #####   */
+
+	/* @818 'V' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+	0x31, 0x91,             /*    # #    */
+	0x31, 0x91,             /*    # #    */
+	0x31, 0x91,             /*    # #    */
+	0x31, 0x91,             /*    # #    */
+	0xC1,                   /*     #     */
+
+	/* @840 'W' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x01, 0xF1,             /* #       # */
+	0x01, 0xF1,             /* #       # */
+	0x01, 0xF1,             /* #       # */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+
+	/* @874 'X' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+	0x31, 0x91,             /*    # #    */
+	0x31, 0x91,             /*    # #    */
+	0xC1,                   /*     #     */
+	0x31, 0x91,             /*    # #    */
+	0x31, 0x91,             /*    # #    */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+	0x11, 0xD1,             /*  #     #  */
+
+	/* @896 'Y' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x02, 0xD2,             /* ##     ## */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB1,             /*   #   #   */
+	0x22, 0xA1,             /*   ##  #   */
+	0x31, 0x91,             /*    # #    */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+
+	/* @913 'Z' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x97,                   /*  #######  */
+	0xF1,                   /*        #  */
+	0xE1,                   /*       #   */
+	0xD1,                   /*      #    */
+	0xD1,                   /*      #    */
+	0xC1,                   /*     #     */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xA1,                   /*   #       */
+	0x91,                   /*  #        */
+	0x97,                   /*  #######  */
+
+	/* @925 '[' (9 pixels wide) */
+	0x1C, /* rows 1-13 */
+	0xB3,                   /*    ###    */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB3,                   /*    ###    */
+
+	/* @939 '\\' (9 pixels wide) */
+	0x1B, /* rows 1-12 */
+	0x91,                   /*  #        */
+	0xA1,                   /*   #       */
+	0xA1,                   /*   #       */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xD1,                   /*      #    */
+	0xD1,                   /*      #    */
+	0xE1,                   /*       #   */
+	0xE1,                   /*       #   */
+	0xF1,                   /*        #  */
+
+	/* @952 ']' (9 pixels wide) */
+	0x1C, /* rows 1-13 */
+	0xA3,                   /*   ###     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xA3,                   /*   ###     */
+
+	/* @966 '^' (9 pixels wide) */
+	0x13, /* rows 1-4 */
+	0xC2,                   /*     ##    */
+	0xB4,                   /*    ####   */
+	0x22, 0xA2,             /*   ##  ##  */
+	0x12, 0xC2,             /*  ##    ## */
+
+	/* @973 '_' (9 pixels wide) */
+	0xF0, /* rows 15-15 */
+	0x88,                   /* ########  */
+
+	/* @975 '`' (9 pixels wide) */
+	0x02, /* rows 0-2 */
+	0xA2,                   /*   ##      */
+	0xB2,                   /*    ##     */
+	0xC2,                   /*     ##    */
+
+	/* @979 'a' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xB4,                   /*    ####   */
+	0x21, 0xC1,             /*   #    #  */
+	0xF1,                   /*        #  */
+	0xA6,                   /*   ######  */
+	0x12, 0xC1,             /*  ##    #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xC2,             /*  #    ##  */
+	0x24, 0x91,             /*   #### #  */
+
+	/* @993 'b' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x11, 0x93,             /*  # ###    */
+	0x12, 0xB1,             /*  ##   #   */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x12, 0xB1,             /*  ##   #   */
+	0x11, 0x93,             /*  # ###    */
+
+	/* @1013 'c' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xB3,                   /*    ###    */
+	0x21, 0xB1,             /*   #   #   */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x21, 0xB1,             /*   #   #   */
+	0xB3,                   /*    ###    */
+
+	/* @1024 'd' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xF1,                   /*        #  */
+	0xF1,                   /*        #  */
+	0xF1,                   /*        #  */
+	0x33, 0x91,             /*    ### #  */
+	0x21, 0xB2,             /*   #   ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB2,             /*   #   ##  */
+	0x33, 0x91,             /*    ### #  */
+
+	/* @1044 'e' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xB3,                   /*    ###    */
+	0x21, 0xB1,             /*   #   #   */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x97,                   /*  #######  */
+	0x91,                   /*  #        */
+	0x21, 0xC1,             /*   #    #  */
+	0xB4,                   /*    ####   */
+
+	/* @1057 'f' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xD3,                   /*      ###  */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xA6,                   /*   ######  */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+
+	/* @1069 'g' (9 pixels wide) */
+	0x4A, /* rows 4-14 */
+	0x33, 0x91,             /*    ### #  */
+	0x21, 0xB2,             /*   #   ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB2,             /*   #   ##  */
+	0x33, 0x91,             /*    ### #  */
+	0xF1,                   /*        #  */
+	0x21, 0xB2,             /*   #   ##  */
+	0xB4,                   /*    ####   */
+
+	/* @1090 'h' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x11, 0x94,             /*  # ####   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+
+	/* @1110 'i' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0x80,                   /*           */
+	0xA3,                   /*   ###     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0x97,                   /*  #######  */
+
+	/* @1122 'j' (9 pixels wide) */
+	0x1D, /* rows 1-14 */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0x80,                   /*           */
+	0xA3,                   /*   ###     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0x93,                   /*  ###      */
+
+	/* @1137 'k' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x11, 0xC1,             /*  #    #   */
+	0x11, 0xA2,             /*  #  ##    */
+	0x11, 0x91,             /*  # #      */
+	0x93,                   /*  ###      */
+	0x11, 0xA1,             /*  #  #     */
+	0x11, 0xB1,             /*  #   #    */
+	0x11, 0xC1,             /*  #    #   */
+	0x11, 0xD1,             /*  #     #  */
+
+	/* @1156 'l' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x84,                   /* ####      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xC3,                   /*     ###   */
+
+	/* @1168 'm' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x96,                   /*  ######   */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+
+	/* @1191 'n' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x11, 0x94,             /*  # ####   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+
+	/* @1208 'o' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xB3,                   /*    ###    */
+	0x21, 0xB1,             /*   #   #   */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB1,             /*   #   #   */
+	0xB3,                   /*    ###    */
+
+	/* @1223 'p' (9 pixels wide) */
+	0x4A, /* rows 4-14 */
+	0x11, 0x93,             /*  # ###    */
+	0x12, 0xB1,             /*  ##   #   */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x12, 0xB1,             /*  ##   #   */
+	0x11, 0x93,             /*  # ###    */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+	0x91,                   /*  #        */
+
+	/* @1243 'q' (9 pixels wide) */
+	0x4A, /* rows 4-14 */
+	0x33, 0x91,             /*    ### #  */
+	0x21, 0xB2,             /*   #   ##  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB2,             /*   #   ##  */
+	0x33, 0x91,             /*    ### #  */
+	0xF1,                   /*        #  */
+	0xF1,                   /*        #  */
+	0xF1,                   /*        #  */
+
+	/* @1263 'r' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x31, 0x93,             /*    # ###  */
+	0x32, 0xB1,             /*    ##   # */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+
+	/* @1274 's' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xA5,                   /*   #####   */
+	0x11, 0xD1,             /*  #     #  */
+	0x91,                   /*  #        */
+	0x94,                   /*  ####     */
+	0xD3,                   /*      ###  */
+	0xF1,                   /*        #  */
+	0x11, 0xD1,             /*  #     #  */
+	0xA5,                   /*   #####   */
+
+	/* @1285 't' (9 pixels wide) */
+	0x29, /* rows 2-11 */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0x96,                   /*  ######   */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xB1,                   /*    #      */
+	0xC3,                   /*     ###   */
+
+	/* @1296 'u' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x11, 0xD1,             /*  #     #  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x24, 0x91,             /*   #### #  */
+
+	/* @1313 'v' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+	0x31, 0x91,             /*    # #    */
+	0x31, 0x91,             /*    # #    */
+	0x31, 0x91,             /*    # #    */
+	0xC1,                   /*     #     */
+
+	/* @1329 'w' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x01, 0xF1,             /* #       # */
+	0x01, 0xF1,             /* #       # */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x21, 0xA1,       /*  #  #  #  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+
+	/* @1352 'x' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x21, 0xB1,             /*   #   #   */
+	0x31, 0x91,             /*    # #    */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0x31, 0x91,             /*    # #    */
+	0x21, 0xB1,             /*   #   #   */
+	0x12, 0xB2,             /*  ##   ##  */
+
+	/* @1367 'y' (9 pixels wide) */
+	0x4A, /* rows 4-14 */
+	0x11, 0xD1,             /*  #     #  */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+	0x21, 0xB1,             /*   #   #   */
+	0x31, 0x91,             /*    # #    */
+	0x31, 0x91,             /*    # #    */
+	0xC2,                   /*     ##    */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xA2,                   /*   ##      */
+
+	/* @1385 'z' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x97,                   /*  #######  */
+	0xF1,                   /*        #  */
+	0xE1,                   /*       #   */
+	0xD1,                   /*      #    */
+	0xB2,                   /*    ##     */
+	0xA1,                   /*   #       */
+	0x91,                   /*  #        */
+	0x97,                   /*  #######  */
+
+	/* @1394 '{' (9 pixels wide) */
+	0x1D, /* rows 1-14 */
+	0xD2,                   /*      ##   */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xA2,                   /*   ##      */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xD2,                   /*      ##   */
+
+	/* @1409 '|' (9 pixels wide) */
+	0x1E, /* rows 1-15 */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+
+	/* @1425 '}' (9 pixels wide) */
+	0x1D, /* rows 1-14 */
+	0xA2,                   /*   ##      */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xD2,                   /*      ##   */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xA2,                   /*   ##      */
+
+	/* @1440 '~' (9 pixels wide) */
+	0x61, /* rows 6-7 */
+	0x23, 0xB1,             /*   ###   # */
+	0x11, 0xB3,             /*  #   ###  */
+
+};
+
+/* Character descriptors for Bitstream Vera Sans Mono 11pt */
+/* { [Char width in bits], [Offset into bitstreamVeraSansMono11ptRleCharRuns in bytes] } */
+const FONT_CHAR_INFO bitstreamVeraSansMono11ptRleCharDescriptors[] =
+{
+	{9, 0}, 		/*   */
+	{9, 2}, 		/* ! */
+	{9, 14}, 		/* " */
+	{9, 23}, 		/* # */
+	{9, 44}, 		/* $ */
+	{9, 67}, 		/* % */
+	{9, 87}, 		/* & */
+	{9, 107}, 		/* ' */
+	{9, 112}, 		/* ( */
+	{9, 126}, 		/* ) */
+	{9, 140}, 		/* * */
+	{9, 151}, 		/* + */
+	{9, 159}, 		/* , */
+	{9, 164}, 		/* - */
+	{9, 166}, 		/* . */
+	{9, 169}, 		/* / */
+	{9, 182}, 		/* 0 */
+	{9, 205}, 		/* 1 */
+	{9, 218}, 		/* 2 */
+	{9, 232}, 		/* 3 */
+	{9, 246}, 		/* 4 */
+	{9, 263}, 		/* 5 */
+	{9, 277}, 		/* 6 */
+	{9, 296}, 		/* 7 */
+	{9, 308}, 		/* 8 */
+	{9, 328}, 		/* 9 */
+	{9, 347}, 		/* : */
+	{9, 356}, 		/* ; */
+	{9, 367}, 		/* < */
+	{9, 377}, 		/* = */
+	{9, 382}, 		/* > */
+	{9, 390}, 		/* ? */
+	{9, 403}, 		/* @ */
+	{9, 428}, 		/* A */
+	{9, 449}, 		/* B */
+	{9, 469}, 		/* C */
+	{9, 483}, 		/* D */
+	{9, 504}, 		/* E */
+	{9, 516}, 		/* F */
+	{9, 528}, 		/* G */
+	{9, 546}, 		/* H */
+	{9, 568}, 		/* I */
+	{9, 580}, 		/* J */
+	{9, 593}, 		/* K */
+	{9, 616}, 		/* L */
+	{9, 628}, 		/* M */
+	{9, 658}, 		/* N */
+	{9, 688}, 		/* O */
+	{9, 709}, 		/* P */
+	{9, 726}, 		/* Q */
+	{9, 749}, 		/* R */
+	{9, 770}, 		/* S */
+	{9, 784}, 		/* T */
+	{9, 796}, 		/* U */
+	{9, 818}, 		/* V */
+	{9, 840}, 		/* W */
+	{9, 874}, 		/* X */
+	{9, 896}, 		/* Y */
+	{9, 913}, 		/* Z */
+	{9, 925}, 		/* [ */
+	{9, 939}, 		/* \ */
+	{9, 952}, 		/* ] */
+	{9, 966}, 		/* ^ */
+	{9, 973}, 		/* _ */
+	{9, 975}, 		/* ` */
+	{9, 979}, 		/* a */
+	{9, 993}, 		/* b */
+	{9, 1013}, 		/* c */
+	{9, 1024}, 		/* d */
+	{9, 1044}, 		/* e */
+	{9, 1057}, 		/* f */
+	{9, 1069}, 		/* g */
+	{9, 1090}, 		/* h */
+	{9, 1110}, 		/* i */
+	{9, 1122}, 		/* j */
+	{9, 1137}, 		/* k */
+	{9, 1156}, 		/* l */
+	{9, 1168}, 		/* m */
+	{9, 1191}, 		/* n */
+	{9, 1208}, 		/* o */
+	{9, 1223}, 		/* p */
+	{9, 1243}, 		/* q */
+	{9, 1263}, 		/* r */
+	{9, 1274}, 		/* s */
+	{9, 1285}, 		/* t */
+	{9, 1296}, 		/* u */
+	{9, 1313}, 		/* v */
+	{9, 1329}, 		/* w */
+	{9, 1352}, 		/* x */
+	{9, 1367}, 		/* y */
+	{9, 1385}, 		/* z */
+	{9, 1394}, 		/* { */
+	{9, 1409}, 		/* | */
+	{9, 1425}, 		/* } */
+	{9, 1440}, 		/* ~ */
+};
+
+/* Font information for Bitstream Vera Sans Mono 11pt */
+const FONT_INFO bitstreamVeraSansMono11ptRleFontInfo =
+{
+	2, /*  Character height */
+	' ', /*  Start character */
+	bitstreamVeraSansMono11ptRleCharDescriptors, /*  Character decriptor array */
+	bitstreamVeraSansMono11ptRleCharRuns, /*  Character data array */
+	FONT_FORMAT_RLE, /*  Glyph data format */
+};
@@ -0,0 +1,11 @@
+#ifndef __VERAMONO11RLE__
+#define __VERAMONO11RLE__
+
+#include "bitmapfonts.h"
+
+/* Run-length encoded font data for Bitstream Vera Sans Mono 11pt */
+extern const uint8_t bitstreamVeraSansMono11ptRleCharRuns[];
+extern const FONT_CHAR_INFO bitstreamVeraSansMono11ptRleCharDescriptors[];
+extern const FONT_INFO bitstreamVeraSansMono11ptRleFontInfo;
+
+#endif
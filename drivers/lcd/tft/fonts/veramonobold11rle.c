@@ -0,0 +1,1341 @@
+#include "veramonobold11rle.h"
+
+/* 
+**  Run-length encoded font data for Bitstream Vera Sans Mono Bold 11pt
+**  (generated from The Dot Factory output by tools/fontrle)
+*/
+
+/* Character data for Bitstream Vera Sans Mono Bold 11pt */
+const uint8_t bitstreamVeraSansMonoBold11ptRleCharRuns[] = 
+{
+	/* @0 ' ' (9 pixels wide) */
+	0x00, /* rows 0-0 */
+	0x80,                   /*           */
+
+	/* @2 '!' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0x80,                   /*           */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+
+	/* @14 '"' (9 pixels wide) */
+	0x13, /* rows 1-4 */
+	0x22, 0xA2,             /*   ##  ##  */
+	0x22, 0xA2,             /*   ##  ##  */
+	0x22, 0xA2,             /*   ##  ##  */
+	0x22, 0xA2,             /*   ##  ##  */
+
+	/* @23 '#' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x32, 0xA1,             /*    ##  #  */
+	0x32, 0x92,             /*    ## ##  */
+	0x32, 0x92,             /*    ## ##  */
+	0x98,                   /*  ######## */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0x88,                   /* ########  */
+	0x12, 0xA1,             /*  ##  #    */
+	0x12, 0x92,             /*  ## ##    */
+	0x12, 0x92,             /*  ## ##    */
+
+	/* @44 '$' (9 pixels wide) */
+	0x0D, /* rows 0-13 */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+	0xA5,                   /*   #####   */
+	0x12, 0x11, 0x91,       /*  ## # #   */
+	0x12, 0x91,             /*  ## #     */
+	0x94,                   /*  ####     */
+	0xA5,                   /*   #####   */
+	0xC4,                   /*     ####  */
+	0x41, 0x92,             /*     # ##  */
+	0x41, 0x92,             /*     # ##  */
+	0x12, 0x11, 0x92,       /*  ## # ##  */
+	0xA5,                   /*   #####   */
+	0xC1,                   /*     #     */
+	0xC1,                   /*     #     */
+
+	/* @66 '%' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x93,                   /*  ###      */
+	0x01, 0xB1,             /* #   #     */
+	0x01, 0xB1,             /* #   #     */
+	0x01, 0xB1,             /* #   #     */
+	0x13, 0xB2,             /*  ###   ## */
+	0xB4,                   /*    ####   */
+	0x03, 0xA3,             /* ###  ###  */
+	0x41, 0xB1,             /*     #   # */
+	0x41, 0xB1,             /*     #   # */
+	0x41, 0xB1,             /*     #   # */
+	0xD3,                   /*      ###  */
+
+	/* @86 '&' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB3,                   /*    ###    */
+	0xA2,                   /*   ##      */
+	0xA2,                   /*   ##      */
+	0xB1,                   /*    #      */
+	0xA3,                   /*   ###     */
+	0x23, 0x92,             /*   ### ##  */
+	0x12, 0x94,             /*  ## ####  */
+	0x12, 0x94,             /*  ## ####  */
+	0x12, 0x93,             /*  ## ###   */
+	0x13, 0x92,             /*  ### ##   */
+	0xA6,                   /*   ######  */
+
+	/* @103 '\'' (9 pixels wide) */
+	0x13, /* rows 1-4 */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+
+	/* @108 '(' (9 pixels wide) */
+	0x1C, /* rows 1-13 */
+	0xD2,                   /*      ##   */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xD2,                   /*      ##   */
+
+	/* @122 ')' (9 pixels wide) */
+	0x1C, /* rows 1-13 */
+	0xA2,                   /*   ##      */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xA2,                   /*   ##      */
+
+	/* @136 '*' (9 pixels wide) */
+	0x15, /* rows 1-6 */
+	0xC1,                   /*     #     */
+	0x12, 0x11, 0x92,       /*  ## # ##  */
+	0xA5,                   /*   #####   */
+	0xA5,                   /*   #####   */
+	0x12, 0x11, 0x92,       /*  ## # ##  */
+	0xC1,                   /*     #     */
+
+	/* @147 '+' (9 pixels wide) */
+	0x37, /* rows 3-10 */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0x98,                   /*  ######## */
+	0x98,                   /*  ######## */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+
+	/* @156 ',' (9 pixels wide) */
+	0x94, /* rows 9-13 */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xA2,                   /*   ##      */
+
+	/* @162 '-' (9 pixels wide) */
+	0x71, /* rows 7-8 */
+	0xA5,                   /*   #####   */
+	0xA5,                   /*   #####   */
+
+	/* @165 '.' (9 pixels wide) */
+	0x92, /* rows 9-11 */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+
+	/* @169 '/' (9 pixels wide) */
+	0x1B, /* rows 1-12 */
+	0xF2,                   /*        ## */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xD2,                   /*      ##   */
+	0xD2,                   /*      ##   */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xA2,                   /*   ##      */
+	0xA2,                   /*   ##      */
+	0x92,                   /*  ##       */
+
+	/* @182 '0' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB3,                   /*    ###    */
+	0x22, 0x92,             /*   ## ##   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0x11, 0x92,       /*  ## # ##  */
+	0x12, 0x11, 0x92,       /*  ## # ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x22, 0x92,             /*   ## ##   */
+	0xB3,                   /*    ###    */
+
+	/* @205 '1' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB3,                   /*    ###    */
+	0x21, 0x92,             /*   # ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xA6,                   /*   ######  */
+
+	/* @218 '2' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xA4,                   /*   ####    */
+	0x11, 0xC2,             /*  #    ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xD3,                   /*      ###  */
+	0xD3,                   /*      ###  */
+	0xC3,                   /*     ###   */
+	0xB3,                   /*    ###    */
+	0xA3,                   /*   ###     */
+	0x93,                   /*  ###      */
+	0x97,                   /*  #######  */
+
+	/* @231 '3' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xA5,                   /*   #####   */
+	0x11, 0xC2,             /*  #    ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xB3,                   /*    ###    */
+	0xD2,                   /*      ##   */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0x11, 0xB3,             /*  #   ###  */
+	0xA4,                   /*   ####    */
+
+	/* @245 '4' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xD2,                   /*      ##   */
+	0xC3,                   /*     ###   */
+	0xB4,                   /*    ####   */
+	0x31, 0x92,             /*    # ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0x12, 0xA2,             /*  ##  ##   */
+	0x11, 0xB2,             /*  #   ##   */
+	0x97,                   /*  #######  */
+	0xD2,                   /*      ##   */
+	0xD2,                   /*      ##   */
+	0xD2,                   /*      ##   */
+
+	/* @261 '5' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x96,                   /*  ######   */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x95,                   /*  #####    */
+	0x11, 0xB2,             /*  #   ##   */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0x11, 0xB2,             /*  #   ##   */
+	0xA4,                   /*   ####    */
+
+	/* @275 '6' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB3,                   /*    ###    */
+	0x22, 0xA1,             /*   ##  #   */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x96,                   /*  ######   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x21, 0xB2,             /*   #   ##  */
+	0xB4,                   /*    ####   */
+
+	/* @293 '7' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x97,                   /*  #######  */
+	0xE2,                   /*       ##  */
+	0xD3,                   /*      ###  */
+	0xD2,                   /*      ##   */
+	0xD2,                   /*      ##   */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xB3,                   /*    ###    */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xA2,                   /*   ##      */
+
+	/* @305 '8' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xA5,                   /*   #####   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0xB3,                   /*    ###    */
+	0x22, 0x92,             /*   ## ##   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x13, 0x93,             /*  ### ###  */
+	0xA5,                   /*   #####   */
+
+	/* @325 '9' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xA4,                   /*   ####    */
+	0x12, 0xB1,             /*  ##   #   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0xA6,                   /*   ######  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0x21, 0xA2,             /*   #  ##   */
+	0xB3,                   /*    ###    */
+
+	/* @343 ':' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0x80,                   /*           */
+	0x80,                   /*           */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+
+	/* @352 ';' (9 pixels wide) */
+	0x49, /* rows 4-13 */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0x80,                   /*           */
+	0x80,                   /*           */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xA2,                   /*   ##      */
+
+	/* @363 '<' (9 pixels wide) */
+	0x37, /* rows 3-10 */
+	0x70, 0x91,             /*         # */
+	0xD4,                   /*      #### */
+	0xB4,                   /*    ####   */
+	0x93,                   /*  ###      */
+	0x93,                   /*  ###      */
+	0xB4,                   /*    ####   */
+	0xD4,                   /*      #### */
+	0x70, 0x91,             /*         # */
+
+	/* @374 '=' (9 pixels wide) */
+	0x45, /* rows 4-9 */
+	0x98,                   /*  ######## */
+	0x98,                   /*  ######## */
+	0x80,                   /*           */
+	0x80,                   /*           */
+	0x98,                   /*  ######## */
+	0x98,                   /*  ######## */
+
+	/* @381 '>' (9 pixels wide) */
+	0x37, /* rows 3-10 */
+	0x91,                   /*  #        */
+	0x94,                   /*  ####     */
+	0xB4,                   /*    ####   */
+	0xE3,                   /*       ### */
+	0xE3,                   /*       ### */
+	0xB4,                   /*    ####   */
+	0x94,                   /*  ####     */
+	0x91,                   /*  #        */
+
+	/* @390 '?' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xA4,                   /*   ####    */
+	0x11, 0xB2,             /*  #   ##   */
+	0xD2,                   /*      ##   */
+	0xC3,                   /*     ###   */
+	0xB3,                   /*    ###    */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0x80,                   /*           */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+
+	/* @403 '@' (9 pixels wide) */
+	0x2C, /* rows 2-14 */
+	0xB4,                   /*    ####   */
+	0x21, 0xB2,             /*   #   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x02, 0xA4,             /* ##  ####  */
+	0x02, 0x12, 0x92,       /* ## ## ##  */
+	0x02, 0x12, 0x92,       /* ## ## ##  */
+	0x02, 0x12, 0x92,       /* ## ## ##  */
+	0x02, 0x12, 0x92,       /* ## ## ##  */
+	0x02, 0x12, 0x92,       /* ## ## ##  */
+	0x02, 0xA4,             /* ##  ####  */
+	0x92,                   /*  ##       */
+	0x22, 0xA1,             /*   ##  #   */
+	0xB5,                   /*    #####  */
+
+	/* @432 'A' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB3,                   /*    ###    */
+	0xB3,                   /*    ###    */
+	0xB3,                   /*    ###    */
+	0xB3,                   /*    ###    */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0xA5,                   /*   #####   */
+	0x22, 0x92,             /*   ## ##   */
+	0x13, 0x93,             /*  ### ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+
+	/* @450 'B' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x96,                   /*  ######   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x95,                   /*  #####    */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x96,                   /*  ######   */
+
+	/* @470 'C' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB4,                   /*    ####   */
+	0x22, 0xB1,             /*   ##   #  */
+	0xA1,                   /*   #       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0xA1,                   /*   #       */
+	0x22, 0xB1,             /*   ##   #  */
+	0xB4,                   /*    ####   */
+
+	/* @484 'D' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x95,                   /*  #####    */
+	0x12, 0xA2,             /*  ##  ##   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xA2,             /*  ##  ##   */
+	0x95,                   /*  #####    */
+
+	/* @505 'E' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x97,                   /*  #######  */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x96,                   /*  ######   */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x97,                   /*  #######  */
+
+	/* @517 'F' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x97,                   /*  #######  */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x96,                   /*  ######   */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+
+	/* @529 'G' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB4,                   /*    ####   */
+	0x22, 0xB1,             /*   ##   #  */
+	0xA1,                   /*   #       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x12, 0xA3,             /*  ##  ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x22, 0xA2,             /*   ##  ##  */
+	0xB5,                   /*    #####  */
+
+	/* @546 'H' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x97,                   /*  #######  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+
+	/* @568 'I' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x96,                   /*  ######   */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0x96,                   /*  ######   */
+
+	/* @580 'J' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB5,                   /*    #####  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0x11, 0xC2,             /*  #    ##  */
+	0xA5,                   /*   #####   */
+
+	/* @593 'K' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xA3,             /*  ##  ###  */
+	0x12, 0x93,             /*  ## ###   */
+	0x12, 0x92,             /*  ## ##    */
+	0x94,                   /*  ####     */
+	0x95,                   /*  #####    */
+	0x96,                   /*  ######   */
+	0x12, 0xA2,             /*  ##  ##   */
+	0x12, 0xA3,             /*  ##  ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB3,             /*  ##   ### */
+
+	/* @613 'L' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x97,                   /*  #######  */
+
+	/* @625 'M' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x13, 0x93,             /*  ### ###  */
+	0x13, 0x93,             /*  ### ###  */
+	0x13, 0x93,             /*  ### ###  */
+	0x13, 0x93,             /*  ### ###  */
+	0x13, 0x93,             /*  ### ###  */
+	0x97,                   /*  #######  */
+	0x12, 0x11, 0x92,       /*  ## # ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+
+	/* @648 'N' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x13, 0xA2,             /*  ###  ##  */
+	0x13, 0xA2,             /*  ###  ##  */
+	0x13, 0xA2,             /*  ###  ##  */
+	0x14, 0x92,             /*  #### ##  */
+	0x14, 0x92,             /*  #### ##  */
+	0x12, 0x11, 0x92,       /*  ## # ##  */
+	0x12, 0x94,             /*  ## ####  */
+	0x12, 0x94,             /*  ## ####  */
+	0x12, 0xA3,             /*  ##  ###  */
+	0x12, 0xA3,             /*  ##  ###  */
+	0x12, 0xA3,             /*  ##  ###  */
+
+	/* @672 'O' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB3,                   /*    ###    */
+	0x22, 0x92,             /*   ## ##   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x22, 0x92,             /*   ## ##   */
+	0xB3,                   /*    ###    */
+
+	/* @693 'P' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x96,                   /*  ######   */
+	0x12, 0xA3,             /*  ##  ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xA3,             /*  ##  ###  */
+	0x96,                   /*  ######   */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+
+	/* @710 'Q' (9 pixels wide) */
+	0x1C, /* rows 1-13 */
+	0xB3,                   /*    ###    */
+	0x22, 0x92,             /*   ## ##   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x22, 0x92,             /*   ## ##   */
+	0xB4,                   /*    ####   */
+	0xD2,                   /*      ##   */
+	0xE1,                   /*       #   */
+
+	/* @733 'R' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x96,                   /*  ######   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x95,                   /*  #####    */
+	0x12, 0xA2,             /*  ##  ##   */
+	0x12, 0xA3,             /*  ##  ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB3,             /*  ##   ### */
+
+	/* @754 'S' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xB4,                   /*    ####   */
+	0x12, 0xC1,             /*  ##    #  */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x94,                   /*  ####     */
+	0xA5,                   /*   #####   */
+	0xC4,                   /*     ####  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0x11, 0xC2,             /*  #    ##  */
+	0xA5,                   /*   #####   */
+
+	/* @768 'T' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x88,                   /* ########  */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+
+	/* @780 'U' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0xA5,                   /*   #####   */
+
+	/* @802 'V' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0x31, 0x91,             /*    # #    */
+	0xB3,                   /*    ###    */
+	0xB3,                   /*    ###    */
+	0xB3,                   /*    ###    */
+
+	/* @822 'W' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x02, 0xD2,             /* ##     ## */
+	0x02, 0xD2,             /* ##     ## */
+	0x02, 0xD2,             /* ##     ## */
+	0x02, 0x21, 0xA2,       /* ##  #  ## */
+	0x02, 0x13, 0x92,       /* ## ### ## */
+	0x11, 0x13, 0x91,       /*  # ### #  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x11, 0x11, 0x11, 0x91, /*  # # # #  */
+	0x13, 0x93,             /*  ### ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+
+	/* @852 'X' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0xB3,                   /*    ###    */
+	0xB3,                   /*    ###    */
+	0xC1,                   /*     #     */
+	0xB3,                   /*    ###    */
+	0xB3,                   /*    ###    */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0x12, 0xB2,             /*  ##   ##  */
+
+	/* @870 'Y' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x03, 0xA3,             /* ###  ###  */
+	0x12, 0xA2,             /*  ##  ##   */
+	0x12, 0xA2,             /*  ##  ##   */
+	0xA4,                   /*   ####    */
+	0xA4,                   /*   ####    */
+	0xA4,                   /*   ####    */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+
+	/* @885 'Z' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x97,                   /*  #######  */
+	0xE2,                   /*       ##  */
+	0xD3,                   /*      ###  */
+	0xC3,                   /*     ###   */
+	0xC2,                   /*     ##    */
+	0xB3,                   /*    ###    */
+	0xB2,                   /*    ##     */
+	0xA2,                   /*   ##      */
+	0x93,                   /*  ###      */
+	0x92,                   /*  ##       */
+	0x97,                   /*  #######  */
+
+	/* @897 '[' (9 pixels wide) */
+	0x1C, /* rows 1-13 */
+	0xB4,                   /*    ####   */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB4,                   /*    ####   */
+
+	/* @911 '\\' (9 pixels wide) */
+	0x1B, /* rows 1-12 */
+	0x92,                   /*  ##       */
+	0xA1,                   /*   #       */
+	0xA2,                   /*   ##      */
+	0xB1,                   /*    #      */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xD1,                   /*      #    */
+	0xD2,                   /*      ##   */
+	0xE1,                   /*       #   */
+	0xE2,                   /*       ##  */
+
+	/* @924 ']' (9 pixels wide) */
+	0x1C, /* rows 1-13 */
+	0xA4,                   /*   ####    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xA4,                   /*   ####    */
+
+	/* @938 '^' (9 pixels wide) */
+	0x13, /* rows 1-4 */
+	0xB2,                   /*    ##     */
+	0xA4,                   /*   ####    */
+	0x12, 0xA2,             /*  ##  ##   */
+	0x02, 0xC2,             /* ##    ##  */
+
+	/* @945 '_' (9 pixels wide) */
+	0xF0, /* rows 15-15 */
+	0x89,                   /* ######### */
+
+	/* @947 '`' (9 pixels wide) */
+	0x02, /* rows 0-2 */
+	0x92,                   /*  ##       */
+	0xA2,                   /*   ##      */
+	0xB2,                   /*    ##     */
+
+	/* @951 'a' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xB4,                   /*    ####   */
+	0x21, 0xB2,             /*   #   ##  */
+	0xE2,                   /*       ##  */
+	0xA6,                   /*   ######  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xA3,             /*  ##  ###  */
+	0xA6,                   /*   ######  */
+
+	/* @964 'b' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x96,                   /*  ######   */
+	0x13, 0x93,             /*  ### ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x13, 0x93,             /*  ### ###  */
+	0x96,                   /*  ######   */
+
+	/* @982 'c' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xB4,                   /*    ####   */
+	0x22, 0xB1,             /*   ##   #  */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x22, 0xB1,             /*   ##   #  */
+	0xB4,                   /*    ####   */
+
+	/* @993 'd' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xA6,                   /*   ######  */
+	0x13, 0x93,             /*  ### ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x13, 0x93,             /*  ### ###  */
+	0xA6,                   /*   ######  */
+
+	/* @1011 'e' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xB4,                   /*    ####   */
+	0x21, 0xB2,             /*   #   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x97,                   /*  #######  */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x22, 0xB1,             /*   ##   #  */
+	0xB4,                   /*    ####   */
+
+	/* @1023 'f' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0xC4,                   /*     ####  */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0x97,                   /*  #######  */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+
+	/* @1035 'g' (9 pixels wide) */
+	0x4A, /* rows 4-14 */
+	0xA6,                   /*   ######  */
+	0x22, 0x93,             /*   ## ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x22, 0x93,             /*   ## ###  */
+	0xA6,                   /*   ######  */
+	0xE2,                   /*       ##  */
+	0x21, 0xB2,             /*   #   ##  */
+	0xB4,                   /*    ####   */
+
+	/* @1054 'h' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x96,                   /*  ######   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+
+	/* @1073 'i' (9 pixels wide) */
+	0x0B, /* rows 0-11 */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0x80,                   /*           */
+	0xA4,                   /*   ####    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0x98,                   /*  ######## */
+
+	/* @1086 'j' (9 pixels wide) */
+	0x0E, /* rows 0-14 */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0x80,                   /*           */
+	0xA4,                   /*   ####    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0x94,                   /*  ####     */
+
+	/* @1102 'k' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x12, 0xA2,             /*  ##  ##   */
+	0x12, 0x92,             /*  ## ##    */
+	0x94,                   /*  ####     */
+	0x94,                   /*  ####     */
+	0x12, 0x92,             /*  ## ##    */
+	0x12, 0x92,             /*  ## ##    */
+	0x12, 0xA2,             /*  ##  ##   */
+	0x12, 0xA3,             /*  ##  ###  */
+
+	/* @1120 'l' (9 pixels wide) */
+	0x1A, /* rows 1-11 */
+	0x94,                   /*  ####     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xC4,                   /*     ####  */
+
+	/* @1132 'm' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x98,                   /*  ######## */
+	0x12, 0x12, 0x92,       /*  ## ## ## */
+	0x12, 0x12, 0x92,       /*  ## ## ## */
+	0x12, 0x12, 0x92,       /*  ## ## ## */
+	0x12, 0x12, 0x92,       /*  ## ## ## */
+	0x12, 0x12, 0x92,       /*  ## ## ## */
+	0x12, 0x12, 0x92,       /*  ## ## ## */
+	0x12, 0x12, 0x92,       /*  ## ## ## */
+
+	/* @1155 'n' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x96,                   /*  ######   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+
+	/* @1171 'o' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xB3,                   /*    ###    */
+	0x22, 0x92,             /*   ## ##   */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x22, 0x92,             /*   ## ##   */
+	0xB3,                   /*    ###    */
+
+	/* @1186 'p' (9 pixels wide) */
+	0x4A, /* rows 4-14 */
+	0x96,                   /*  ######   */
+	0x13, 0x93,             /*  ### ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x13, 0x93,             /*  ### ###  */
+	0x96,                   /*  ######   */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+	0x92,                   /*  ##       */
+
+	/* @1204 'q' (9 pixels wide) */
+	0x4A, /* rows 4-14 */
+	0xA6,                   /*   ######  */
+	0x13, 0x93,             /*  ### ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x13, 0x93,             /*  ### ###  */
+	0xA6,                   /*   ######  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+	0xE2,                   /*       ##  */
+
+	/* @1222 'r' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xA6,                   /*   ######  */
+	0xA3,                   /*   ###     */
+	0xA2,                   /*   ##      */
+	0xA2,                   /*   ##      */
+	0xA2,                   /*   ##      */
+	0xA2,                   /*   ##      */
+	0xA2,                   /*   ##      */
+	0xA2,                   /*   ##      */
+
+	/* @1231 's' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0xA5,                   /*   #####   */
+	0x12, 0xC1,             /*  ##    #  */
+	0x92,                   /*  ##       */
+	0x95,                   /*  #####    */
+	0xB5,                   /*    #####  */
+	0xE2,                   /*       ##  */
+	0x11, 0xC2,             /*  #    ##  */
+	0xA5,                   /*   #####   */
+
+	/* @1242 't' (9 pixels wide) */
+	0x29, /* rows 2-11 */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0x97,                   /*  #######  */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xB2,                   /*    ##     */
+	0xC4,                   /*     ####  */
+
+	/* @1253 'u' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0xA6,                   /*   ######  */
+
+	/* @1269 'v' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x13, 0x93,             /*  ### ###  */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0x31, 0x91,             /*    # #    */
+	0xB3,                   /*    ###    */
+	0xB3,                   /*    ###    */
+
+	/* @1284 'w' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x02, 0xD2,             /* ##     ## */
+	0x02, 0xD2,             /* ##     ## */
+	0x02, 0x21, 0xA2,       /* ##  #  ## */
+	0x11, 0x13, 0x91,       /*  # ### #  */
+	0x13, 0x93,             /*  ### ###  */
+	0x13, 0x93,             /*  ### ###  */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x12, 0xB2,             /*  ##   ##  */
+
+	/* @1303 'x' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x13, 0x93,             /*  ### ###  */
+	0x22, 0x92,             /*   ## ##   */
+	0xB3,                   /*    ###    */
+	0xB3,                   /*    ###    */
+	0xB3,                   /*    ###    */
+	0xB4,                   /*    ####   */
+	0x22, 0x92,             /*   ## ##   */
+	0x13, 0x93,             /*  ### ###  */
+
+	/* @1316 'y' (9 pixels wide) */
+	0x4A, /* rows 4-14 */
+	0x12, 0xB2,             /*  ##   ##  */
+	0x22, 0x93,             /*   ## ###  */
+	0x22, 0x92,             /*   ## ##   */
+	0x22, 0x92,             /*   ## ##   */
+	0xB4,                   /*    ####   */
+	0xB3,                   /*    ###    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xB2,                   /*    ##     */
+	0xA3,                   /*   ###     */
+
+	/* @1332 'z' (9 pixels wide) */
+	0x47, /* rows 4-11 */
+	0x97,                   /*  #######  */
+	0xE2,                   /*       ##  */
+	0xD2,                   /*      ##   */
+	0xC2,                   /*     ##    */
+	0xB2,                   /*    ##     */
+	0xA2,                   /*   ##      */
+	0x92,                   /*  ##       */
+	0x97,                   /*  #######  */
+
+	/* @1341 '{' (9 pixels wide) */
+	0x1D, /* rows 1-14 */
+	0xD3,                   /*      ###  */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xA2,                   /*   ##      */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xD3,                   /*      ###  */
+
+	/* @1356 '|' (9 pixels wide) */
+	0x1E, /* rows 1-15 */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+
+	/* @1372 '}' (9 pixels wide) */
+	0x1D, /* rows 1-14 */
+	0xA3,                   /*   ###     */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xE2,                   /*       ##  */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xC2,                   /*     ##    */
+	0xA3,                   /*   ###     */
+
+	/* @1387 '~' (9 pixels wide) */
+	0x62, /* rows 6-8 */
+	0x23, 0xB1,             /*   ###   # */
+	0x98,                   /*  ######## */
+	0x11, 0xB3,             /*  #   ###  */
+
+};
+
+/* Character descriptors for Bitstream Vera Sans Mono Bold 11pt */
+/* { [Char width in bits], [Offset into bitstreamVeraSansMonoBold11ptRleCharRuns in bytes] } */
+const FONT_CHAR_INFO bitstreamVeraSansMonoBold11ptRleCharDescriptors[] =
+{
+	{9, 0}, 		/*   */
+	{9, 2}, 		/* ! */
+	{9, 14}, 		/* " */
+	{9, 23}, 		/* # */
+	{9, 44}, 		/* $ */
+	{9, 66}, 		/* % */
+	{9, 86}, 		/* & */
+	{9, 103}, 		/* ' */
+	{9, 108}, 		/* ( */
+	{9, 122}, 		/* ) */
+	{9, 136}, 		/* * */
+	{9, 147}, 		/* + */
+	{9, 156}, 		/* , */
+	{9, 162}, 		/* - */
+	{9, 165}, 		/* . */
+	{9, 169}, 		/* / */
+	{9, 182}, 		/* 0 */
+	{9, 205}, 		/* 1 */
+	{9, 218}, 		/* 2 */
+	{9, 231}, 		/* 3 */
+	{9, 245}, 		/* 4 */
+	{9, 261}, 		/* 5 */
+	{9, 275}, 		/* 6 */
+	{9, 293}, 		/* 7 */
+	{9, 305}, 		/* 8 */
+	{9, 325}, 		/* 9 */
+	{9, 343}, 		/* : */
+	{9, 352}, 		/* ; */
+	{9, 363}, 		/* < */
+	{9, 374}, 		/* = */
+	{9, 381}, 		/* > */
+	{9, 390}, 		/* ? */
+	{9, 403}, 		/* @ */
+	{9, 432}, 		/* A */
+	{9, 450}, 		/* B */
+	{9, 470}, 		/* C */
+	{9, 484}, 		/* D */
+	{9, 505}, 		/* E */
+	{9, 517}, 		/* F */
+	{9, 529}, 		/* G */
+	{9, 546}, 		/* H */
+	{9, 568}, 		/* I */
+	{9, 580}, 		/* J */
+	{9, 593}, 		/* K */
+	{9, 613}, 		/* L */
+	{9, 625}, 		/* M */
+	{9, 648}, 		/* N */
+	{9, 672}, 		/* O */
+	{9, 693}, 		/* P */
+	{9, 710}, 		/* Q */
+	{9, 733}, 		/* R */
+	{9, 754}, 		/* S */
+	{9, 768}, 		/* T */
+	{9, 780}, 		/* U */
+	{9, 802}, 		/* V */
+	{9, 822}, 		/* W */
+	{9, 852}, 		/* X */
+	{9, 870}, 		/* Y */
+	{9, 885}, 		/* Z */
+	{9, 897}, 		/* [ */
+	{9, 911}, 		/* \ */
+	{9, 924}, 		/* ] */
+	{9, 938}, 		/* ^ */
+	{9, 945}, 		/* _ */
+	{9, 947}, 		/* ` */
+	{9, 951}, 		/* a */
+	{9, 964}, 		/* b */
+	{9, 982}, 		/* c */
+	{9, 993}, 		/* d */
+	{9, 1011}, 		/* e */
+	{9, 1023}, 		/* f */
+	{9, 1035}, 		/* g */
+	{9, 1054}, 		/* h */
+	{9, 1073}, 		/* i */
+	{9, 1086}, 		/* j */
+	{9, 1102}, 		/* k */
+	{9, 1120}, 		/* l */
+	{9, 1132}, 		/* m */
+	{9, 1155}, 		/* n */
+	{9, 1171}, 		/* o */
+	{9, 1186}, 		/* p */
+	{9, 1204}, 		/* q */
+	{9, 1222}, 		/* r */
+	{9, 1231}, 		/* s */
+	{9, 1242}, 		/* t */
+	{9, 1253}, 		/* u */
+	{9, 1269}, 		/* v */
+	{9, 1284}, 		/* w */
+	{9, 1303}, 		/* x */
+	{9, 1316}, 		/* y */
+	{9, 1332}, 		/* z */
+	{9, 1341}, 		/* { */
+	{9, 1356}, 		/* | */
+	{9, 1372}, 		/* } */
+	{9, 1387}, 		/* ~ */
+};
+
+/* Font information for Bitstream Vera Sans Mono Bold 11pt */
+const FONT_INFO bitstreamVeraSansMonoBold11ptRleFontInfo =
+{
+	2, /*  Character height */
+	' ', /*  Start character */
+	bitstreamVeraSansMonoBold11ptRleCharDescriptors, /*  Character decriptor array */
+	bitstreamVeraSansMonoBold11ptRleCharRuns, /*  Character data array */
+	FONT_FORMAT_RLE, /*  Glyph data format */
+};
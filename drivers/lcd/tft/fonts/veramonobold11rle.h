@@ -0,0 +1,11 @@
+#ifndef __VERAMONOBOLD11RLE__
+#define __VERAMONOBOLD11RLE__
+
+#include "bitmapfonts.h"
+
+/* Run-length encoded font data for Bitstream Vera Sans Mono Bold 11pt */
+extern const uint8_t bitstreamVeraSansMonoBold11ptRleCharRuns[];
+extern const FONT_CHAR_INFO bitstreamVeraSansMonoBold11ptRleCharDescriptors[];
+extern const FONT_INFO bitstreamVeraSansMonoBold11ptRleFontInfo;
+
+#endif
@@ -80,6 +80,32 @@
 #define ILI9325_DATA_MASK         0x000001FE
 #define ILI9325_DATA_OFFSET       1    // Offset = PIN1
 
+#if defined CFG_TFTLCD_16BIT && CFG_TFTLCD_16BIT == 1
+// High data byte (DB8..DB15) for the 16-bit interface (IM[3:0] = 0010)
+// Note: LPC1343 ports are only 12 bits wide, so the bus is split over
+// two ports, with the low byte staying on the pins above.  The high
+// byte pins must also be consecutive and on the same port (max offset
+// 4).  The default of 1.0-1.7 takes the JTAG/SWD pins, UART (1.6/1.7)
+// and the touch screen pins used on the standard breakout, so boards
+// wiring all 16 lines will usually need to change these values along
+// with TS_* in touchscreen.h.
+#define ILI9325_DATAH_PORT        1     // 8-Pin High Data Port
+#define ILI9325_DATAH_MASK        0x000000FF
+#define ILI9325_DATAH_OFFSET      0     // Offset = DB8
+#define ILI9325_GPIODATA_DATAH    (*(pREG32 (GPIO_GPIO1_BASE + (ILI9325_DATAH_MASK << 2))))
+#define ILI9325_GPIODIR_DATAH     GPIO_GPIO1DIR
+
+// Switches 1.0-1.3 from JTAG/SWD to digital GPIO and disables the pullups
+#define ILI9325_DATAH_INIT() do { IOCON_JTAG_TMS_PIO1_0 = IOCON_JTAG_TMS_PIO1_0_FUNC_GPIO | IOCON_JTAG_TMS_PIO1_0_ADMODE_DIGITAL; \
+                                   IOCON_JTAG_TDO_PIO1_1 = IOCON_JTAG_TDO_PIO1_1_FUNC_GPIO | IOCON_JTAG_TDO_PIO1_1_ADMODE_DIGITAL; \
+                                   IOCON_JTAG_nTRST_PIO1_2 = IOCON_JTAG_nTRST_PIO1_2_FUNC_GPIO | IOCON_JTAG_nTRST_PIO1_2_ADMODE_DIGITAL; \
+                                   IOCON_SWDIO_PIO1_3 = IOCON_SWDIO_PIO1_3_FUNC_GPIO | IOCON_SWDIO_PIO1_3_ADMODE_DIGITAL; \
+                                   gpioSetPullup(&IOCON_PIO1_4, gpioPullupMode_Inactive); \
+                                   gpioSetPullup(&IOCON_PIO1_5, gpioPullupMode_Inactive); \
+                                   gpioSetPullup(&IOCON_PIO1_6, gpioPullupMode_Inactive); \
+                                   gpioSetPullup(&IOCON_PIO1_7, gpioPullupMode_Inactive); } while (0)
+#endif
+
 // Placed here to try to keep all pin specific values in header file
 #define ILI9325_DISABLEPULLUPS() do { gpioSetPullup(&IOCON_PIO2_1, gpioPullupMode_Inactive); \
                                       gpioSetPullup(&IOCON_PIO2_2, gpioPullupMode_Inactive); \
@@ -104,8 +130,13 @@
 #define ILI9325_GPIO1DATA_CS_CD_RD_WR (*(pREG32 (GPIO_GPIO1_BASE + ((ILI9325_CS_CD_RD_WR_PINS) << 2))))
 
 // Macros to set data bus direction to input/output
+#if defined CFG_TFTLCD_16BIT && CFG_TFTLCD_16BIT == 1
+#define ILI9325_GPIO2DATA_SETINPUT  do { GPIO_GPIO2DIR &= ~ILI9325_DATA_MASK; ILI9325_GPIODIR_DATAH &= ~ILI9325_DATAH_MASK; } while (0)
+#define ILI9325_GPIO2DATA_SETOUTPUT do { GPIO_GPIO2DIR |= ILI9325_DATA_MASK; ILI9325_GPIODIR_DATAH |= ILI9325_DATAH_MASK; } while (0)
+#else
 #define ILI9325_GPIO2DATA_SETINPUT  GPIO_GPIO2DIR &= ~ILI9325_DATA_MASK
 #define ILI9325_GPIO2DATA_SETOUTPUT GPIO_GPIO2DIR |= ILI9325_DATA_MASK
+#endif
 
 // Macros for control line state
 #define CLR_CD          ILI9325_GPIO1DATA_CD = (0)
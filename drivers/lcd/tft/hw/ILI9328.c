@@ -8,6 +8,8 @@
     Driver for ILI9328 240x320 pixel TFT LCD displays.
     
     This driver uses an 8-bit interface and a 16-bit RGB565 colour palette.
+    Boards that wire all 16 data lines can set CFG_TFTLCD_16BIT to 1 in
+    projectconfig.h to use the 16-bit interface instead (see ILI9328.h).
 
     @section  LICENSE
 
@@ -41,10 +43,27 @@
 /**************************************************************************/
 #include "ILI9328.h"
 #include "core/systick/systick.h"
+#include "core/delay/delay.h"
 #include "drivers/lcd/tft/touchscreen.h"
 
-static volatile lcdOrientation_t lcdOrientation = LCD_ORIENTATION_PORTRAIT;
-static lcdProperties_t ili9328Properties = { 240, 320, TRUE, TRUE, TRUE };
+// Orientation and window state are also read by the inline fast paths
+// in ILI9328.h (see drivers/lcd/tft/lcdinline.h)
+lcdOrientation_t ili9328Orientation = LCD_ORIENTATION_PORTRAIT;
+static lcdProperties_t ili9328Properties = { ILI9328_WIDTH, ILI9328_HEIGHT, TRUE, TRUE, TRUE };
+bool ili9328WindowActive = FALSE;
+static uint16_t ili9328EntryMode = 0x1030;        // Entry mode for the current orientation
+static uint16_t ili9328EntryModeActive = 0x1030;  // Entry mode last written to the controller
+
+// Entry mode AM bit: GRAM address is updated vertically first when set
+#define ILI9328_ENTRYMODE_AM  (0x0008)
+
+// RD must be held low for at least 150nS (tRDL) before the data bus is
+// valid.  Each pass through the delay loop takes roughly four cycles.
+#define ILI9328_READDELAY     (((CFG_CPU_CCLK / 1000000) * 160) / 4000 + 1)
+
+#if defined CFG_TFTLCD_STATS && CFG_TFTLCD_STATS == 1
+lcdStats_t lcdStats;
+#endif
 
 /*************************************************/
 /* Private Methods                               */
@@ -52,100 +71,231 @@ static lcdProperties_t ili9328Properties = { 240, 320, TRUE, TRUE, TRUE };
 
 /**************************************************************************/
 /*! 
-    @brief  Causes a brief delay (10 ticks per unit)
+    @brief  Writes the supplied 16-bit command using an 8-bit (or
+            16-bit) interface
+*/
+/**************************************************************************/
+void ili9328WriteCmd(uint16_t command) 
+{
+  ili9328WriteCmdInline(command);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Writes the supplied 16-bit data using an 8-bit (or 16-bit)
+            interface
 */
 /**************************************************************************/
-void ili9328Delay(unsigned int t)
+RAMFUNC void ili9328WriteData(uint16_t data)
+{
+  ili9328WriteDataInline(data);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Writes the same 16-bit value 'count' times in a single
+            burst using an 8-bit interface
+
+    CS and CD are only set once and the two byte patterns are worked
+    out up front, so each pixel costs no more than two data port writes
+    and four WR edges.  When the high and low bytes are identical (black,
+    white, most grays) the data port isn't touched at all inside the
+    loop and only WR is strobed.
+
+    With the 16-bit interface the whole pixel is on the bus at once, so
+    the data ports are only written once and each pixel is a single WR
+    strobe whatever the colour.
+*/
+/**************************************************************************/
+#if defined CFG_TFTLCD_16BIT && CFG_TFTLCD_16BIT == 1
+RAMFUNC void ili9328WriteDataRepeat(uint16_t data, uint32_t count)
+{
+  if (!count)
+  {
+    return;
+  }
+  LCD_STATS_ADD(dataWritten, count);
+
+  CLR_CS_SET_CD_RD_WR;
+  ILI9328_GPIO2DATA_DATA = data << ILI9328_DATA_OFFSET;
+  ILI9328_GPIODATA_DATAH = data >> (8 - ILI9328_DATAH_OFFSET);
+  while (count >= 8)
+  {
+    CLR_WR; SET_WR; CLR_WR; SET_WR;
+    CLR_WR; SET_WR; CLR_WR; SET_WR;
+    CLR_WR; SET_WR; CLR_WR; SET_WR;
+    CLR_WR; SET_WR; CLR_WR; SET_WR;
+    count -= 8;
+  }
+  while (count--)
+  {
+    CLR_WR; SET_WR;
+  }
+  SET_CS;
+}
+#else
+RAMFUNC void ili9328WriteDataRepeat(uint16_t data, uint32_t count)
 {
-  unsigned char t1;
-  while(t--)
-  for ( t1=10; t1 > 0; t1-- )
+  uint32_t high = data >> (8 - ILI9328_DATA_OFFSET);
+  uint32_t low = data << ILI9328_DATA_OFFSET;
+
+  if (!count)
+  {
+    return;
+  }
+  LCD_STATS_ADD(dataWritten, count);
+
+  CLR_CS_SET_CD_RD_WR;
+  if ((high & ILI9328_DATA_MASK) == (low & ILI9328_DATA_MASK))
+  {
+    ILI9328_GPIO2DATA_DATA = low;
+    while (count >= 4)
+    {
+      CLR_WR; SET_WR; CLR_WR; SET_WR;
+      CLR_WR; SET_WR; CLR_WR; SET_WR;
+      CLR_WR; SET_WR; CLR_WR; SET_WR;
+      CLR_WR; SET_WR; CLR_WR; SET_WR;
+      count -= 4;
+    }
+    while (count--)
+    {
+      CLR_WR; SET_WR; CLR_WR; SET_WR;
+    }
+  }
+  else
   {
-    __asm("nop");
+    while (count >= 4)
+    {
+      ILI9328_GPIO2DATA_DATA = high; CLR_WR; SET_WR;
+      ILI9328_GPIO2DATA_DATA = low;  CLR_WR; SET_WR;
+      ILI9328_GPIO2DATA_DATA = high; CLR_WR; SET_WR;
+      ILI9328_GPIO2DATA_DATA = low;  CLR_WR; SET_WR;
+      ILI9328_GPIO2DATA_DATA = high; CLR_WR; SET_WR;
+      ILI9328_GPIO2DATA_DATA = low;  CLR_WR; SET_WR;
+      ILI9328_GPIO2DATA_DATA = high; CLR_WR; SET_WR;
+      ILI9328_GPIO2DATA_DATA = low;  CLR_WR; SET_WR;
+      count -= 4;
+    }
+    while (count--)
+    {
+      ILI9328_GPIO2DATA_DATA = high; CLR_WR; SET_WR;
+      ILI9328_GPIO2DATA_DATA = low;  CLR_WR; SET_WR;
+    }
   }
+  SET_CS;
 }
+#endif
 
+#if defined CFG_TFTLCD_16BIT && CFG_TFTLCD_16BIT == 1
 /**************************************************************************/
 /*! 
-    @brief  Writes the supplied 16-bit command using an 8-bit interface
+    @brief  Strobes RD and samples one 16-bit value from both halves
+            of the data bus
+
+    The data ports must already be set to input and CS held low.
 */
 /**************************************************************************/
-void ili9328WriteCmd(uint16_t command) 
+static inline uint16_t ili9328ReadWord(void)
 {
-  // Compiled with -Os on GCC 4.4 this works out to 25 cycles
-  // (versus 36 compiled with no optimisations).  I'm not sure it
-  // can be improved further, so that means 25 cycles/350nS for
-  // continuous writes (cmd, data, data, data, ...) or ~150 cycles/
-  // ~2.1uS for a random pixel (Set X [cmd+data], Set Y [cmd+data],
-  // Set color [cmd+data]) (times assumes 72MHz clock).
+  volatile uint32_t d;
+  uint16_t value;
 
-  CLR_CS_CD_SET_RD_WR;  // Saves 18 commands compared to "CLR_CS; CLR_CD; SET_RD; SET_WR;" 
-  ILI9328_GPIO2DATA_DATA = (command >> (8 - ILI9328_DATA_OFFSET));
-  CLR_WR;
-  SET_WR;
-  ILI9328_GPIO2DATA_DATA = command << ILI9328_DATA_OFFSET;
-  CLR_WR;
-  SET_WR_CS;            // Saves 7 commands compared to "SET_WR; SET_CS;"
+  CLR_RD;
+  for (d = ILI9328_READDELAY; d; d--);
+  value = (ILI9328_GPIO2DATA_DATA >> ILI9328_DATA_OFFSET) & 0xFF;
+  value |= ((ILI9328_GPIODATA_DATAH >> ILI9328_DATAH_OFFSET) & 0xFF) << 8;
+  SET_RD;
+
+  return value;
+}
+#else
+/**************************************************************************/
+/*! 
+    @brief  Strobes RD and samples one byte from the 8-bit data bus
+
+    The data port must already be set to input and CS held low.
+*/
+/**************************************************************************/
+static inline uint16_t ili9328ReadByte(void)
+{
+  volatile uint32_t d;
+  uint16_t value;
+
+  CLR_RD;
+  for (d = ILI9328_READDELAY; d; d--);
+  value = (ILI9328_GPIO2DATA_DATA >> ILI9328_DATA_OFFSET) & 0xFF;
+  SET_RD;
+
+  return value;
 }
 
 /**************************************************************************/
 /*! 
-    @brief  Writes the supplied 16-bit data using an 8-bit interface
+    @brief  Reads one 16-bit value as two bytes, high byte first
 */
 /**************************************************************************/
-void ili9328WriteData(uint16_t data)
+static inline uint16_t ili9328ReadWord(void)
 {
-  CLR_CS_SET_CD_RD_WR;  // Saves 18 commands compared to SET_CD; SET_RD; SET_WR; CLR_CS"
-  ILI9328_GPIO2DATA_DATA = (data >> (8 - ILI9328_DATA_OFFSET));
-  CLR_WR;
-  SET_WR;
-  ILI9328_GPIO2DATA_DATA = data << ILI9328_DATA_OFFSET;
-  CLR_WR;
-  SET_WR_CS;            // Saves 7 commands compared to "SET_WR, SET_CS;"
+  uint16_t value;
+
+  value = ili9328ReadByte() << 8;
+  value |= ili9328ReadByte();
+
+  return value;
 }
+#endif
 
 /**************************************************************************/
 /*! 
-    @brief  Reads a 16-bit value from the 8-bit data bus
+    @brief  Reads a 16-bit value from the data bus
 */
 /**************************************************************************/
 uint16_t ili9328ReadData(void)
 {
-  // ToDo: Optimise this method!
-
-  uint16_t high, low;
-  high = low = 0;
   uint16_t d;
 
   SET_CD_RD_WR;   // Saves 14 commands compared to "SET_CD; SET_RD; SET_WR"
   CLR_CS;
   
   // set inputs
+  LCD_STATS_ADD(dataRead, 1);
   ILI9328_GPIO2DATA_SETINPUT;
-  CLR_RD;
-  ili9328Delay(100);
-  high = ILI9328_GPIO2DATA_DATA;  
-  high >>= ILI9328_DATA_OFFSET;
-  high &= 0xFF;
-  SET_RD;
-  
-  CLR_RD;
-  ili9328Delay(100);
-  low = ILI9328_GPIO2DATA_DATA;
-  low >>= ILI9328_DATA_OFFSET;
-  low &=0xFF;
-  SET_RD;
-  
+  d = ili9328ReadWord();
   SET_CS;
   ILI9328_GPIO2DATA_SETOUTPUT;
 
-  d = high;
-  d <<= 8;
-  d |= low;
-  
   return d;
 }
 
+/**************************************************************************/
+/*! 
+    @brief  Reads 'len' consecutive 16-bit values from GRAM, keeping CS
+            low and the data port set to input for the whole burst
+
+    The caller must already have set the cursor and issued R22h.  The
+    first value returned by the controller after R22h is a dummy and is
+    discarded here.
+*/
+/**************************************************************************/
+static void ili9328ReadGRAM(uint16_t *buf, uint32_t len)
+{
+  SET_CD_RD_WR;
+  CLR_CS;
+  ILI9328_GPIO2DATA_SETINPUT;
+
+  // Dummy read
+  LCD_STATS_ADD(dataRead, len + 1);
+  ili9328ReadWord();
+
+  while (len--)
+  {
+    *buf++ = ili9328ReadWord();
+  }
+
+  SET_CS;
+  ILI9328_GPIO2DATA_SETOUTPUT;
+}
+
 /**************************************************************************/
 /*! 
     @brief  Reads a 16-bit value
@@ -186,21 +336,7 @@ uint16_t ili9328Type(void)
 /**************************************************************************/
 void ili9328SetCursor(uint16_t x, uint16_t y)
 {
-  uint16_t al, ah;
-  
-  if (lcdOrientation == LCD_ORIENTATION_LANDSCAPE)
-  {
-    al = y;
-    ah = x;
-  }
-  else
-  {
-    al = x;
-    ah = y;
-  }
-
-  ili9328Command(ILI9328_COMMANDS_HORIZONTALGRAMADDRESSSET, al);
-  ili9328Command(ILI9328_COMMANDS_VERTICALGRAMADDRESSSET, ah);
+  ili9328SetCursorInline(x, y);
 }
 
 /**************************************************************************/
@@ -212,6 +348,9 @@ void ili9328InitDisplay(void)
 {
   // Clear data line
   GPIO_GPIO2DATA &= ~ILI9328_DATA_MASK;
+#if defined CFG_TFTLCD_16BIT && CFG_TFTLCD_16BIT == 1
+  ILI9328_GPIODATA_DATAH = 0;
+#endif
     
   SET_RD;
   SET_WR;
@@ -220,9 +359,9 @@ void ili9328InitDisplay(void)
 
   // Reset display
   CLR_RESET;
-  ili9328Delay(100);
+  delayUs(100);
   SET_RESET;
-  ili9328Delay(1000);
+  delayUs(1000);
 
   ili9328Command(ILI9328_COMMANDS_DRIVEROUTPUTCONTROL1, 0x0100);  // Driver Output Control Register (R01h)
   ili9328Command(ILI9328_COMMANDS_LCDDRIVINGCONTROL, 0x0700);     // LCD Driving Waveform Control (R02h)
@@ -234,15 +373,15 @@ void ili9328InitDisplay(void)
   ili9328Command(ILI9328_COMMANDS_POWERCONTROL2, 0x0007);         // Power Control 2 (R11h)
   ili9328Command(ILI9328_COMMANDS_POWERCONTROL3, 0x0000);         // Power Control 3 (R12h)
   ili9328Command(ILI9328_COMMANDS_POWERCONTROL4, 0x0000);         // Power Control 4 (R13h)
-  ili9328Delay(1000);  
+  delayUs(1000);  
   ili9328Command(ILI9328_COMMANDS_POWERCONTROL1, 0x14B0);         // Power Control 1 (R10h)  
-  ili9328Delay(500);  
+  delayUs(500);  
   ili9328Command(ILI9328_COMMANDS_POWERCONTROL2, 0x0007);         // Power Control 2 (R11h)  
-  ili9328Delay(500);  
+  delayUs(500);  
   ili9328Command(ILI9328_COMMANDS_POWERCONTROL3, 0x008E);         // Power Control 3 (R12h)
   ili9328Command(ILI9328_COMMANDS_POWERCONTROL4, 0x0C00);         // Power Control 4 (R13h)
   ili9328Command(ILI9328_COMMANDS_POWERCONTROL7, 0x0015);         // NVM read data 2 (R29h)
-  ili9328Delay(500);
+  delayUs(500);
   ili9328Command(ILI9328_COMMANDS_GAMMACONTROL1, 0x0000);         // Gamma Control 1
   ili9328Command(ILI9328_COMMANDS_GAMMACONTROL2, 0x0107);         // Gamma Control 2
   ili9328Command(ILI9328_COMMANDS_GAMMACONTROL3, 0x0000);         // Gamma Control 3
@@ -263,7 +402,7 @@ void ili9328InitDisplay(void)
 
   // Display On
   ili9328Command(ILI9328_COMMANDS_DISPLAYCONTROL1, 0x0133);     // Display Control (R07h)
-  ili9328Delay(500);
+  delayUs(500);
   ili9328WriteCmd(ILI9328_COMMANDS_WRITEDATATOGRAM);
 }
 
@@ -280,18 +419,60 @@ void ili9328Home(void)
 
 /**************************************************************************/
 /*! 
-    @brief  Sets the window confines
+    @brief  Sets the window confines (in screen coordinates, taking
+            the current orientation into account)
 */
 /**************************************************************************/
 void ili9328SetWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
 {
-  ili9328Command(ILI9328_COMMANDS_HORIZONTALADDRESSSTARTPOSITION, x0);
-  ili9328Command(ILI9328_COMMANDS_HORIZONTALADDRESSENDPOSITION, x1);
-  ili9328Command(ILI9328_COMMANDS_VERTICALADDRESSSTARTPOSITION, y0);
-  ili9328Command(ILI9328_COMMANDS_VERTICALADDRESSENDPOSITION, y1);
+  if (ili9328Orientation == LCD_ORIENTATION_LANDSCAPE)
+  {
+    // Screen X runs along the GRAM vertical address in landscape mode
+    ili9328Command(ILI9328_COMMANDS_HORIZONTALADDRESSSTARTPOSITION, y0);
+    ili9328Command(ILI9328_COMMANDS_HORIZONTALADDRESSENDPOSITION, y1);
+    ili9328Command(ILI9328_COMMANDS_VERTICALADDRESSSTARTPOSITION, x0);
+    ili9328Command(ILI9328_COMMANDS_VERTICALADDRESSENDPOSITION, x1);
+  }
+  else
+  {
+    ili9328Command(ILI9328_COMMANDS_HORIZONTALADDRESSSTARTPOSITION, x0);
+    ili9328Command(ILI9328_COMMANDS_HORIZONTALADDRESSENDPOSITION, x1);
+    ili9328Command(ILI9328_COMMANDS_VERTICALADDRESSSTARTPOSITION, y0);
+    ili9328Command(ILI9328_COMMANDS_VERTICALADDRESSENDPOSITION, y1);
+  }
   ili9328SetCursor(x0, y0);
 }
 
+/**************************************************************************/
+/*! 
+    @brief  Writes the entry mode register, skipping the write if the
+            controller is already in the requested mode
+*/
+/**************************************************************************/
+static void ili9328SetEntryMode(uint16_t mode)
+{
+  if (mode != ili9328EntryModeActive)
+  {
+    ili9328Command(ILI9328_COMMANDS_ENTRYMODE, mode);
+    ili9328EntryModeActive = mode;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Restores the full-screen window if it was narrowed by
+            lcdSetWindow, so that cursor-based writes don't wrap
+*/
+/**************************************************************************/
+void ili9328ReleaseWindow(void)
+{
+  if (ili9328WindowActive)
+  {
+    ili9328SetWindow(0, 0, lcdGetWidth() - 1, lcdGetHeight() - 1);
+    ili9328WindowActive = FALSE;
+  }
+}
+
 /*************************************************/
 /* Public Methods                                */
 /*************************************************/
@@ -314,6 +495,9 @@ void lcdInit(void)
 
   // Disable pullups
   ILI9328_DISABLEPULLUPS();
+#if defined CFG_TFTLCD_16BIT && CFG_TFTLCD_16BIT == 1
+  ILI9328_DATAH_INIT();
+#endif
   
   // Set backlight pin to output and turn it on
   gpioSetDir(ILI9328_BL_PORT, ILI9328_BL_PIN, 1);      // set to output
@@ -331,7 +515,7 @@ void lcdInit(void)
   systickDelay(50);
 
   // Set lcd to default orientation
-  lcdSetOrientation(lcdOrientation);
+  lcdSetOrientation(ili9328Orientation);
 
   // Fill black
   lcdFillRGB(COLOR_BLACK);
@@ -359,6 +543,8 @@ void lcdBacklight(bool state)
 void lcdTest(void)
 {
   uint32_t i,j;
+  ili9328ReleaseWindow();
+  ili9328SetEntryMode(ili9328EntryMode);
   ili9328Home();
   
   for(i=0;i<320;i++)
@@ -384,14 +570,10 @@ void lcdTest(void)
 /**************************************************************************/
 void lcdFillRGB(uint16_t data)
 {
-  unsigned int i;
+  LCD_DAMAGE(0, 0, lcdGetWidth() - 1, lcdGetHeight() - 1);
+  ili9328ReleaseWindow();
   ili9328Home();
-  
-  uint32_t pixels = 320*240;
-  for ( i=0; i < pixels; i++ )
-  {
-    ili9328WriteData(data);
-  } 
+  lcdStreamFill(data, 320*240);
 }
 
 /**************************************************************************/
@@ -401,6 +583,8 @@ void lcdFillRGB(uint16_t data)
 /**************************************************************************/
 void lcdDrawPixel(uint16_t x, uint16_t y, uint16_t color)
 {
+  LCD_DAMAGE(x, y, x, y);
+  ili9328ReleaseWindow();
   ili9328SetCursor(x, y);
   ili9328WriteCmd(ILI9328_COMMANDS_WRITEDATATOGRAM);  // Write Data to GRAM (R22h)
   ili9328WriteData(color);
@@ -415,6 +599,9 @@ void lcdDrawPixel(uint16_t x, uint16_t y, uint16_t color)
 void lcdDrawPixels(uint16_t x, uint16_t y, uint16_t *data, uint32_t len)
 {
   uint32_t i = 0;
+  LCD_DAMAGE_RUN(x, y, len);
+  ili9328ReleaseWindow();
+  ili9328SetEntryMode(ili9328EntryMode);
   ili9328SetCursor(x, y);
   ili9328WriteCmd(ILI9328_COMMANDS_WRITEDATATOGRAM);
   do
@@ -433,7 +620,7 @@ void lcdDrawPixels(uint16_t x, uint16_t y, uint16_t *data, uint32_t len)
 void lcdDrawHLine(uint16_t x0, uint16_t x1, uint16_t y, uint16_t color)
 {
   // Allows for slightly better performance than setting individual pixels
-  uint16_t x, pixels;
+  uint16_t x;
 
   if (x1 < x0)
   {
@@ -453,32 +640,139 @@ void lcdDrawHLine(uint16_t x0, uint16_t x1, uint16_t y, uint16_t color)
     x0 = lcdGetWidth() - 1;
   }
 
+  LCD_DAMAGE(x0, y, x1, y);
+  ili9328ReleaseWindow();
+  ili9328SetEntryMode(ili9328EntryMode);
   ili9328SetCursor(x0, y);
   ili9328WriteCmd(ILI9328_COMMANDS_WRITEDATATOGRAM);  // Write Data to GRAM (R22h)
-  for (pixels = 0; pixels < x1 - x0 + 1; pixels++)
-  {
-    ili9328WriteData(color);
-  }
+  ili9328WriteDataRepeat(color, x1 - x0 + 1);
 }
 
 /**************************************************************************/
 /*! 
     @brief  Optimised routine to draw a vertical line faster than
             setting individual pixels
+
+    The line is written in a single burst by temporarily switching the
+    direction the GRAM address is incremented in, rather than rotating
+    the display.
 */
 /**************************************************************************/
 void lcdDrawVLine(uint16_t x, uint16_t y0, uint16_t y1, uint16_t color)
 {
-  lcdOrientation_t orientation = lcdOrientation;
+  uint16_t y;
 
-  // Switch orientation
-  lcdSetOrientation(orientation == LCD_ORIENTATION_PORTRAIT ? LCD_ORIENTATION_LANDSCAPE : LCD_ORIENTATION_PORTRAIT);
+  if (y1 < y0)
+  {
+    // Switch y1 and y0
+    y = y1;
+    y1 = y0;
+    y0 = y;
+  }
 
-  // Draw horizontal line like usual
-  lcdDrawHLine(y0, y1, lcdGetHeight() - (x + 1), color);
+  // Check limits
+  if ((x >= lcdGetWidth()) || (y0 >= lcdGetHeight()))
+  {
+    return;
+  }
+  if (y1 >= lcdGetHeight())
+  {
+    y1 = lcdGetHeight() - 1;
+  }
 
-  // Switch orientation back
-  lcdSetOrientation(orientation);
+  // Flipping the AM bit makes the GRAM address advance along the
+  // screen's Y axis in either orientation.  The mode is left in place
+  // so that consecutive vertical lines don't need to rewrite it.
+  LCD_DAMAGE(x, y0, x, y1);
+  ili9328ReleaseWindow();
+  ili9328SetEntryMode(ili9328EntryMode ^ ILI9328_ENTRYMODE_AM);
+  ili9328SetCursor(x, y0);
+  ili9328WriteCmd(ILI9328_COMMANDS_WRITEDATATOGRAM);  // Write Data to GRAM (R22h)
+  ili9328WriteDataRepeat(color, y1 - y0 + 1);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Opens a rectangular window (inclusive coordinates) on the
+            LCD and prepares GRAM for streaming
+
+    Pixels sent with lcdStreamPixels or lcdStreamFill are written
+    left to right and top to bottom inside the window, with the
+    controller wrapping to the next line by itself, so filling an
+    area only costs one addressing sequence.  Any of the regular
+    drawing functions will restore the full-screen window.
+
+    @param[in]  x0
+                Left edge of the window
+    @param[in]  y0
+                Top edge of the window
+    @param[in]  x1
+                Right edge of the window
+    @param[in]  y1
+                Bottom edge of the window
+*/
+/**************************************************************************/
+void lcdSetWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+  uint16_t t;
+
+  if (x1 < x0)
+  {
+    t = x0; x0 = x1; x1 = t;
+  }
+  if (y1 < y0)
+  {
+    t = y0; y0 = y1; y1 = t;
+  }
+
+  // Check limits
+  if (x1 >= lcdGetWidth())
+  {
+    x1 = lcdGetWidth() - 1;
+  }
+  if (y1 >= lcdGetHeight())
+  {
+    y1 = lcdGetHeight() - 1;
+  }
+  if (x0 > x1)
+  {
+    x0 = x1;
+  }
+  if (y0 > y1)
+  {
+    y0 = y1;
+  }
+
+  LCD_DAMAGE(x0, y0, x1, y1);
+  ili9328SetEntryMode(ili9328EntryMode);
+  ili9328SetWindow(x0, y0, x1, y1);
+  ili9328WriteCmd(ILI9328_COMMANDS_WRITEDATATOGRAM);  // Write Data to GRAM (R22h)
+  ili9328WindowActive = TRUE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Streams an array of RGB565 pixels into the window opened
+            with lcdSetWindow
+*/
+/**************************************************************************/
+RAMFUNC void lcdStreamPixels(uint16_t *data, uint32_t len)
+{
+  while (len--)
+  {
+    ili9328WriteData(*data++);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Streams 'len' pixels of a single color into the window
+            opened with lcdSetWindow
+*/
+/**************************************************************************/
+void lcdStreamFill(uint16_t color, uint32_t len)
+{
+  ili9328WriteDataRepeat(color, len);
 }
 
 /**************************************************************************/
@@ -490,6 +784,7 @@ uint16_t lcdGetPixel(uint16_t x, uint16_t y)
 {
   uint16_t preFetch = 0;
 
+  ili9328ReleaseWindow();
   ili9328SetCursor(x, y);
   ili9328WriteCmd(ILI9328_COMMANDS_WRITEDATATOGRAM);
   preFetch = ili9328ReadData();
@@ -510,6 +805,12 @@ void lcdSetOrientation(lcdOrientation_t orientation)
   uint16_t entryMode = 0x1030;
   uint16_t outputControl = 0x0100;
 
+  // The window is held in GRAM coordinates, so drop it before rotating
+  ili9328ReleaseWindow();
+
+  // Partial images are only valid in portrait mode
+  ili9328Command(ILI9328_COMMANDS_DISPLAYCONTROL1, 0x0133);
+
   switch (orientation)
   {
     case LCD_ORIENTATION_PORTRAIT:
@@ -517,14 +818,15 @@ void lcdSetOrientation(lcdOrientation_t orientation)
       outputControl = 0x0100;
       break;
     case LCD_ORIENTATION_LANDSCAPE:
-      entryMode = 0x1028;
+      entryMode = 0x1038;
       outputControl = 0x0000;
       break;
   }
 
   ili9328Command(ILI9328_COMMANDS_ENTRYMODE, entryMode);
   ili9328Command(ILI9328_COMMANDS_DRIVEROUTPUTCONTROL1, outputControl);
-  lcdOrientation = orientation;
+  ili9328EntryMode = ili9328EntryModeActive = entryMode;
+  ili9328Orientation = orientation;
 
   ili9328SetCursor(0, 0);
 }
@@ -536,7 +838,7 @@ void lcdSetOrientation(lcdOrientation_t orientation)
 /**************************************************************************/
 lcdOrientation_t lcdGetOrientation(void)
 {
-  return lcdOrientation;
+  return ili9328Orientation;
 }
 
 /**************************************************************************/
@@ -547,7 +849,7 @@ lcdOrientation_t lcdGetOrientation(void)
 /**************************************************************************/
 uint16_t lcdGetWidth(void)
 {
-  switch (lcdOrientation) 
+  switch (ili9328Orientation) 
   {
     case LCD_ORIENTATION_PORTRAIT:
       return ili9328Properties.width;
@@ -566,7 +868,7 @@ uint16_t lcdGetWidth(void)
 /**************************************************************************/
 uint16_t lcdGetHeight(void)
 {
-  switch (lcdOrientation) 
+  switch (ili9328Orientation) 
   {
     case LCD_ORIENTATION_PORTRAIT:
       return ili9328Properties.height;
@@ -594,6 +896,178 @@ void lcdScroll(int16_t pixels, uint16_t fillColor)
   ili9328WriteData(y);
 }
 
+/**************************************************************************/
+/*! 
+    @brief  Reads a run of consecutive pixels from the LCD in one burst
+
+    Only one cursor setup and one dummy read are needed, since the
+    GRAM address is incremented after every read.  This is much faster
+    than calling lcdGetPixel for every pixel.
+
+    @param[in]  x
+                Starting x co-ordinate
+    @param[in]  y
+                Starting y co-ordinate
+    @param[out] buf
+                Buffer that receives the RGB565 pixel data
+    @param[in]  len
+                Number of pixels to read (the run must not go past the
+                end of the line)
+*/
+/**************************************************************************/
+void lcdReadPixels(uint16_t x, uint16_t y, uint16_t *buf, uint32_t len)
+{
+  if (!len)
+  {
+    return;
+  }
+
+  ili9328ReleaseWindow();
+  ili9328SetEntryMode(ili9328EntryMode);
+  ili9328SetCursor(x, y);
+  ili9328WriteCmd(ILI9328_COMMANDS_WRITEDATATOGRAM);
+  ili9328ReadGRAM(buf, len);
+}
+/**************************************************************************/
+/*! 
+    @brief  Scrolls the contents of a horizontal band of the screen
+
+    Unlike lcdScroll, which only shifts the whole panel's display start
+    line, this moves the GRAM contents between lines y0 and y1 so
+    fixed headers and footers stay in place and drawing coordinates
+    remain valid afterwards.  The lines uncovered by the scroll are
+    filled with 'fillColor'.
+
+    @param[in]  y0
+                First line of the scroll region
+    @param[in]  y1
+                Last line of the scroll region
+    @param[in]  pixels
+                Number of lines to scroll by (positive values move the
+                contents up, negative values move them down)
+    @param[in]  fillColor
+                Color used for the uncovered lines
+*/
+/**************************************************************************/
+void lcdScrollRegion(uint16_t y0, uint16_t y1, int16_t pixels, uint16_t fillColor)
+{
+  uint16_t buffer[32];
+  uint16_t width, height, lines, y, x, i, len, src, dst;
+  int16_t step;
+
+  if (y1 < y0)
+  {
+    y = y0; y0 = y1; y1 = y;
+  }
+  if (y1 >= lcdGetHeight())
+  {
+    y1 = lcdGetHeight() - 1;
+  }
+  if ((pixels == 0) || (y0 > y1))
+  {
+    return;
+  }
+
+  width = lcdGetWidth();
+  height = y1 - y0 + 1;
+  step = pixels > 0 ? pixels : -pixels;
+  LCD_DAMAGE(0, y0, width - 1, y1);
+  if (step >= height)
+  {
+    lcdSetWindow(0, y0, width - 1, y1);
+    lcdStreamFill(fillColor, (uint32_t)width * height);
+    return;
+  }
+
+  // Copy line by line, in chunks, working away from the destination
+  lines = height - step;
+  for (y = 0; y < lines; y++)
+  {
+    dst = pixels > 0 ? y0 + y : y1 - y;
+    src = pixels > 0 ? dst + step : dst - step;
+    for (x = 0; x < width; x += len)
+    {
+      len = width - x > 32 ? 32 : width - x;
+      lcdReadPixels(x, src, buffer, len);
+      ili9328SetCursor(x, dst);
+      ili9328WriteCmd(ILI9328_COMMANDS_WRITEDATATOGRAM);
+      for (i = 0; i < len; i++)
+      {
+        ili9328WriteData(buffer[i]);
+      }
+    }
+  }
+
+  // Clear the uncovered lines
+  if (pixels > 0)
+  {
+    lcdSetWindow(0, y1 - step + 1, width - 1, y1);
+  }
+  else
+  {
+    lcdSetWindow(0, y0, width - 1, y0 + step - 1);
+  }
+  lcdStreamFill(fillColor, (uint32_t)width * step);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Rotates the lines of a horizontal band of the screen without
+            moving any GRAM data
+
+    The band is displayed through the two partial image windows
+    (R80h..R85h), which take priority over the base image: partial
+    image 1 shows GRAM lines y0 + offset..y1 at the top of the band
+    and partial image 2 shows GRAM lines y0..y0 + offset - 1 under it.
+    The band thus behaves like a ring buffer of lines, which can be
+    scrolled by rewriting six registers and redrawing only the line
+    that was recycled.
+
+    Only supported in portrait mode, since the partial images are
+    defined in gate lines.  Calling this with an offset of 0 restores
+    the normal display.
+
+    @param[in]  y0
+                First line of the band
+    @param[in]  y1
+                Last line of the band
+    @param[in]  offset
+                GRAM line (relative to y0) to show at the top of the
+                band
+
+    @return     FALSE if the band can't be rotated by the hardware
+*/
+/**************************************************************************/
+bool lcdSetScrollOffset(uint16_t y0, uint16_t y1, uint16_t offset)
+{
+  uint16_t height;
+
+  if ((ili9328Orientation != LCD_ORIENTATION_PORTRAIT) || (y1 < y0) || (y1 >= ili9328Properties.height))
+  {
+    return FALSE;
+  }
+
+  height = y1 - y0 + 1;
+  offset %= height;
+  if (offset == 0)
+  {
+    // Back to the base image only
+    ili9328Command(ILI9328_COMMANDS_DISPLAYCONTROL1, 0x0133);
+    return TRUE;
+  }
+
+  ili9328Command(ILI9328_COMMANDS_PARTIALIMAGE1DISPLAYPOSITION, y0);
+  ili9328Command(ILI9328_COMMANDS_PARTIALIMAGE1AREASTARTLINE, y0 + offset);
+  ili9328Command(ILI9328_COMMANDS_PARTIALIMAGE1AREAENDLINE, y1);
+  ili9328Command(ILI9328_COMMANDS_PARTIALIMAGE2DISPLAYPOSITION, y0 + height - offset);
+  ili9328Command(ILI9328_COMMANDS_PARTIALIMAGE2AREASTARTLINE, y0);
+  ili9328Command(ILI9328_COMMANDS_PARTIALIMAGE2AREAENDLINE, y0 + offset - 1);
+  // Base image plus both partial images (PTDE1, PTDE0, BASEE)
+  ili9328Command(ILI9328_COMMANDS_DISPLAYCONTROL1, 0x3133);
+
+  return TRUE;
+}
+
 /**************************************************************************/
 /*! 
     @brief  Gets the controller's 16-bit (4 hexdigit) ID
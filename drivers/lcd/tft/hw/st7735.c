@@ -44,16 +44,89 @@
 #include "core/systick/systick.h"
 #include "core/gpio/gpio.h"
 
+#if defined CFG_TFTLCD_ST7735_SSP && CFG_TFTLCD_ST7735_SSP == 1
+  #include "core/ssp/ssp.h"
+  #define ST7735_USESSP
+#endif
+
 static lcdOrientation_t lcdOrientation = LCD_ORIENTATION_PORTRAIT;
 static lcdProperties_t st7735Properties = { 128, 160, FALSE, FALSE, FALSE };
 
+#if defined CFG_TFTLCD_STATS && CFG_TFTLCD_STATS == 1
+lcdStats_t lcdStats;
+#endif
+
 /*************************************************/
 /* Private Methods                               */
 /*************************************************/
 
+#ifdef ST7735_USESSP
+/*************************************************/
+void st7735WriteCmd(uint8_t command) 
+{
+  LCD_STATS_ADD(commands, 1);
+  CLR_RS;
+  CLR_CS;
+  sspSend(0, &command, 1);
+  SET_CS;
+}
+
+/*************************************************/
+void st7735WriteData(uint8_t data)
+{
+  LCD_STATS_ADD(dataWritten, 1);
+  SET_RS;
+  CLR_CS;
+  sspSend(0, &data, 1);
+  SET_CS;
+}
+
+/*************************************************/
+/* Sends a block of RGB565 pixels to display RAM */
+/* using 16-bit SSP frames                       */
+/*************************************************/
+static void st7735WritePixels(const uint16_t *data, uint32_t len)
+{
+  LCD_STATS_ADD(dataWritten, len * 2);
+  SET_RS;
+  CLR_CS;
+  sspSetFrameSize(0, sspFrameSize_16Bit);
+  sspSend16(0, data, len);
+  sspSetFrameSize(0, sspFrameSize_8Bit);
+  SET_CS;
+}
+
+/*************************************************/
+/* Sends 'len' copies of a single RGB565 color   */
+/*************************************************/
+static void st7735WriteColor(uint16_t color, uint32_t len)
+{
+  uint16_t buffer[16];
+  uint32_t i, count;
+
+  for (i = 0; i < 16; i++)
+  {
+    buffer[i] = color;
+  }
+  LCD_STATS_ADD(dataWritten, len * 2);
+
+  SET_RS;
+  CLR_CS;
+  sspSetFrameSize(0, sspFrameSize_16Bit);
+  while (len)
+  {
+    count = len > 16 ? 16 : len;
+    sspSend16(0, buffer, count);
+    len -= count;
+  }
+  sspSetFrameSize(0, sspFrameSize_8Bit);
+  SET_CS;
+}
+#else
 /*************************************************/
 void st7735WriteCmd(uint8_t command) 
 {
+  LCD_STATS_ADD(commands, 1);
   CLR_CS;
   CLR_RS;
   uint8_t i = 0;
@@ -77,6 +150,7 @@ void st7735WriteCmd(uint8_t command)
 /*************************************************/
 void st7735WriteData(uint8_t data)
 {
+  LCD_STATS_ADD(dataWritten, 1);
   CLR_CS;
   SET_RS; 
   uint8_t i = 0;
@@ -97,9 +171,35 @@ void st7735WriteData(uint8_t data)
   SET_CS;
 }
 
+/*************************************************/
+/* Sends a block of RGB565 pixels to display RAM */
+/*************************************************/
+static void st7735WritePixels(const uint16_t *data, uint32_t len)
+{
+  while (len--)
+  {
+    st7735WriteData(*data >> 8);
+    st7735WriteData(*data++);
+  }
+}
+
+/*************************************************/
+/* Sends 'len' copies of a single RGB565 color   */
+/*************************************************/
+static void st7735WriteColor(uint16_t color, uint32_t len)
+{
+  while (len--)
+  {
+    st7735WriteData(color >> 8);
+    st7735WriteData(color);
+  }
+}
+#endif
+
 /*************************************************/
 void st7735SetAddrWindow(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1)
 {
+  LCD_STATS_ADD(cursorSets, 1);
   st7735WriteCmd(ST7735_CASET);   // column addr set
   st7735WriteData(0x00);
   st7735WriteData(x0+2);          // XSTART 
@@ -225,12 +325,27 @@ void lcdInit(void)
 {
   // Set control pins to output
   gpioSetDir(ST7735_PORT, ST7735_RS_PIN, 1);
-  gpioSetDir(ST7735_PORT, ST7735_SDA_PIN, 1);
-  gpioSetDir(ST7735_PORT, ST7735_SCL_PIN, 1);
   gpioSetDir(ST7735_PORT, ST7735_CS_PIN, 1);
   gpioSetDir(ST7735_PORT, ST7735_RES_PIN, 1);
   gpioSetDir(ST7735_PORT, ST7735_BL_PIN, 1);
 
+  #ifdef ST7735_USESSP
+  // Only configure SSP0 if nothing else (SD card, etc.) has done so yet,
+  // since sspInit would reset the bus clock another driver has selected
+  if (!(SSP_SSP0CR1 & SSP_SSP0CR1_SSE_ENABLED))
+  {
+    sspInit(0, sspClockPolarity_Low, sspClockPhase_RisingEdge);
+  }
+
+  // Keep CS high while idle since the bus may be shared
+  CLR_RS;
+  SET_CS;
+  CLR_BL;
+  SET_RES;
+  #else
+  gpioSetDir(ST7735_PORT, ST7735_SDA_PIN, 1);
+  gpioSetDir(ST7735_PORT, ST7735_SCL_PIN, 1);
+
   // Set pins low by default (except reset)
   CLR_RS;
   CLR_SDA;
@@ -238,6 +353,7 @@ void lcdInit(void)
   CLR_CS;
   CLR_BL;
   SET_RES;
+  #endif
   
   // Turn backlight on
   lcdBacklight(TRUE);
@@ -285,17 +401,9 @@ void lcdTest(void)
 /*************************************************/
 void lcdFillRGB(uint16_t color)
 {
-  uint8_t x, y;
   st7735SetAddrWindow(0, 0, lcdGetWidth() - 1, lcdGetHeight() - 1);
   st7735WriteCmd(ST7735_RAMWR);  // write to RAM
-  for (x=0; x < lcdGetWidth(); x++) 
-  {
-    for (y=0; y < lcdGetHeight(); y++) 
-    {
-      st7735WriteData(color >> 8);    
-      st7735WriteData(color);    
-    }
-  }
+  st7735WriteColor(color, (uint32_t)lcdGetWidth() * lcdGetHeight());
   st7735WriteCmd(ST7735_NOP);
 }
 
@@ -316,20 +424,17 @@ void lcdDrawPixel(uint16_t x, uint16_t y, uint16_t color)
 /**************************************************************************/
 void lcdDrawPixels(uint16_t x, uint16_t y, uint16_t *data, uint32_t len)
 {
-  // ToDo: Optimise this function ... currently only a placeholder
-  uint32_t i = 0;
-  do
-  {
-    lcdDrawPixel(x+i, y, data[i]);
-    i++;
-  } while (i<len);
+  st7735SetAddrWindow(x, y, lcdGetWidth() - 1, y);
+  st7735WriteCmd(ST7735_RAMWR);  // write to RAM
+  st7735WritePixels(data, len);
+  st7735WriteCmd(ST7735_NOP);
 }
 
 /*************************************************/
 void lcdDrawHLine(uint16_t x0, uint16_t x1, uint16_t y, uint16_t color)
 {
   // Allows for slightly better performance than setting individual pixels
-  uint16_t x, pixels;
+  uint16_t x;
 
   if (x1 < x0)
   {
@@ -351,11 +456,7 @@ void lcdDrawHLine(uint16_t x0, uint16_t x1, uint16_t y, uint16_t color)
 
   st7735SetAddrWindow(x0, y, lcdGetWidth(), y + 1);
   st7735WriteCmd(ST7735_RAMWR);  // write to RAM
-  for (pixels = 0; pixels < x1 - x0 + 1; pixels++)
-  {
-    st7735WriteData(color >> 8);  
-    st7735WriteData(color);
-  }
+  st7735WriteColor(color, x1 - x0 + 1);
   st7735WriteCmd(ST7735_NOP);
 }
 
@@ -363,7 +464,7 @@ void lcdDrawHLine(uint16_t x0, uint16_t x1, uint16_t y, uint16_t color)
 void lcdDrawVLine(uint16_t x, uint16_t y0, uint16_t y1, uint16_t color)
 {
   // Allows for slightly better performance than setting individual pixels
-  uint16_t y, pixels;
+  uint16_t y;
 
   if (y1 < y0)
   {
@@ -385,12 +486,64 @@ void lcdDrawVLine(uint16_t x, uint16_t y0, uint16_t y1, uint16_t color)
 
   st7735SetAddrWindow(x, y0, x, lcdGetHeight());
   st7735WriteCmd(ST7735_RAMWR);  // write to RAM
-  for (pixels = 0; pixels < y1 - y0 + 1; pixels++)
+  st7735WriteColor(color, y1 - y0 + 1);
+  st7735WriteCmd(ST7735_NOP);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Opens a rectangular window (inclusive coordinates) on the
+            LCD and prepares RAM for streaming
+
+    Pixels sent with lcdStreamPixels or lcdStreamFill are written
+    left to right and top to bottom inside the window.
+*/
+/**************************************************************************/
+void lcdSetWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+  uint16_t t;
+
+  if (x1 < x0)
   {
-    st7735WriteData(color >> 8);  
-    st7735WriteData(color);
+    t = x0; x0 = x1; x1 = t;
   }
-  st7735WriteCmd(ST7735_NOP);
+  if (y1 < y0)
+  {
+    t = y0; y0 = y1; y1 = t;
+  }
+
+  // Check limits
+  if (x1 >= lcdGetWidth())
+  {
+    x1 = lcdGetWidth() - 1;
+  }
+  if (y1 >= lcdGetHeight())
+  {
+    y1 = lcdGetHeight() - 1;
+  }
+  if (x0 > x1)
+  {
+    x0 = x1;
+  }
+  if (y0 > y1)
+  {
+    y0 = y1;
+  }
+
+  st7735SetAddrWindow(x0, y0, x1, y1);
+  st7735WriteCmd(ST7735_RAMWR);  // write to RAM
+}
+
+/*************************************************/
+void lcdStreamPixels(uint16_t *data, uint32_t len)
+{
+  st7735WritePixels(data, len);
+}
+
+/*************************************************/
+void lcdStreamFill(uint16_t color, uint32_t len)
+{
+  st7735WriteColor(color, len);
 }
 
 /*************************************************/
@@ -400,6 +553,16 @@ uint16_t lcdGetPixel(uint16_t x, uint16_t y)
   return 0;
 }
 
+/*************************************************/
+void lcdReadPixels(uint16_t x, uint16_t y, uint16_t *buf, uint32_t len)
+{
+  // ToDo (no read-back on the serial interface)
+  while (len--)
+  {
+    *buf++ = 0;
+  }
+}
+
 /*************************************************/
 void lcdSetOrientation(lcdOrientation_t orientation)
 {
@@ -430,6 +593,19 @@ void lcdScroll(int16_t pixels, uint16_t fillColor)
   // ToDo
 }
 
+/*************************************************/
+void lcdScrollRegion(uint16_t y0, uint16_t y1, int16_t pixels, uint16_t fillColor)
+{
+  // ToDo
+}
+
+/*************************************************/
+bool lcdSetScrollOffset(uint16_t y0, uint16_t y1, uint16_t offset)
+{
+  // ToDo
+  return FALSE;
+}
+
 /*************************************************/
 uint16_t lcdGetControllerID(void)
 {
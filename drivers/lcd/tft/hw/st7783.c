@@ -45,26 +45,21 @@
 /**************************************************************************/
 #include "st7783.h"
 #include "core/systick/systick.h"
+#include "core/delay/delay.h"
 #include "drivers/lcd/tft/touchscreen.h"
 
 static lcdOrientation_t lcdOrientation = LCD_ORIENTATION_PORTRAIT;
 static lcdProperties_t st7783Properties = { 240, 320, TRUE, TRUE, FALSE };
+static bool st7783WindowActive = FALSE;
+
+#if defined CFG_TFTLCD_STATS && CFG_TFTLCD_STATS == 1
+lcdStats_t lcdStats;
+#endif
 
 /*************************************************/
 /* Private Methods                               */
 /*************************************************/
 
-/*************************************************/
-void st7783Delay(unsigned int t)
-{
-  unsigned char t1;
-  while(t--)
-  for ( t1=10; t1 > 0; t1-- )
-  {
-    __asm("nop");
-  }
-}
-
 /*************************************************/
 void st7783WriteCmd(uint16_t command) 
 {
@@ -75,6 +70,7 @@ void st7783WriteCmd(uint16_t command)
   // ~2.1uS for a random pixel (Set X [cmd+data], Set Y [cmd+data],
   // Set color [cmd+data]) (times assumes 72MHz clock).
 
+  LCD_STATS_ADD(commands, 1);
   CLR_CS_CD_SET_RD_WR;  // Saves 18 commands compared to "CLR_CS; CLR_CD; SET_RD; SET_WR;" 
   ST7783_GPIO2DATA_DATA = (command >> (8 - ST7783_DATA_OFFSET));
   CLR_WR;
@@ -87,6 +83,7 @@ void st7783WriteCmd(uint16_t command)
 /*************************************************/
 void st7783WriteData(uint16_t data)
 {
+  LCD_STATS_ADD(dataWritten, 1);
   CLR_CS_SET_CD_RD_WR;  // Saves 18 commands compared to SET_CD; SET_RD; SET_WR; CLR_CS"
   ST7783_GPIO2DATA_DATA = (data >> (8 - ST7783_DATA_OFFSET));
   CLR_WR;
@@ -109,16 +106,17 @@ uint16_t st7783ReadData(void)
   CLR_CS;
   
   // set inputs
+  LCD_STATS_ADD(dataRead, 1);
   ST7783_GPIO2DATA_SETINPUT;
   CLR_RD;
-  st7783Delay(100);
+  delayUs(100);
   high = ST7783_GPIO2DATA_DATA;  
   high >>= ST7783_DATA_OFFSET;
   high &= 0xFF;
   SET_RD;
   
   CLR_RD;
-  st7783Delay(100);
+  delayUs(100);
   low = ST7783_GPIO2DATA_DATA;
   low >>= ST7783_DATA_OFFSET;
   low &=0xFF;
@@ -162,6 +160,7 @@ void st7783SetCursor(uint16_t x, uint16_t y)
 {
   uint16_t he, ve, al, ah;
   
+  LCD_STATS_ADD(cursorSets, 1);
   switch (lcdOrientation) 
   {
   case LCD_ORIENTATION_LANDSCAPE:
@@ -197,9 +196,9 @@ void st7783InitDisplay(void)
 
   // Reset display
   CLR_RESET;
-  st7783Delay(10000);
+  delayUs(10000);
   SET_RESET;
-  st7783Delay(500);
+  delayUs(500);
 
   st7783Command(0x00FF, 0x0001);
   st7783Command(0x00F3, 0x0008);
@@ -214,15 +213,15 @@ void st7783InitDisplay(void)
   st7783Command(0x0011, 0x0007);     // Power Control 2 (R11h)  
   st7783Command(0x0012, 0x0000);     // Power Control 3 (R12h)
   st7783Command(0x0013, 0x0000);     // Power Control 4 (R13h)
-  st7783Delay(1000);  
+  delayUs(1000);  
   st7783Command(0x0010, 0x14B0);     // Power Control 1 (R10h)  
-  st7783Delay(500);  
+  delayUs(500);  
   st7783Command(0x0011, 0x0007);     // Power Control 2 (R11h)  
-  st7783Delay(500);  
+  delayUs(500);  
   st7783Command(0x0012, 0x008E);     // Power Control 3 (R12h)
   st7783Command(0x0013, 0x0C00);     // Power Control 4 (R13h)
   st7783Command(0x0029, 0x0015);     // NVM read data 2 (R29h)
-  st7783Delay(500);
+  delayUs(500);
   st7783Command(0x0030, 0x0000);     // Gamma Control 1
   st7783Command(0x0031, 0x0107);     // Gamma Control 2
   st7783Command(0x0032, 0x0000);     // Gamma Control 3
@@ -243,7 +242,7 @@ void st7783InitDisplay(void)
 
   // Display On
   st7783Command(0x0007, 0x0133);     // Display Control (R07h)
-  st7783Delay(500);
+  delayUs(500);
   st7783WriteCmd(0x0022);
 }
 
@@ -271,6 +270,22 @@ void st7783SetWindow(uint16_t x, uint16_t y, uint16_t height, uint16_t width)
   st7783SetCursor(x, y);
 }
 
+/*************************************************/
+/* Restores the full GRAM window after           */
+/* lcdSetWindow has narrowed it                  */
+/*************************************************/
+static void st7783ReleaseWindow(void)
+{
+  if (st7783WindowActive)
+  {
+    st7783Command(0x0050, 0x0000);
+    st7783Command(0x0051, st7783Properties.width - 1);
+    st7783Command(0x0052, 0x0000);
+    st7783Command(0x0053, st7783Properties.height - 1);
+    st7783WindowActive = FALSE;
+  }
+}
+
 /*************************************************/
 /* Public Methods                                */
 /*************************************************/
@@ -324,6 +339,7 @@ void lcdBacklight(bool state)
 void lcdTest(void)
 {
   uint32_t i,j;
+  st7783ReleaseWindow();
   st7783Home();
   
   for(i=0;i<320;i++)
@@ -345,19 +361,15 @@ void lcdTest(void)
 /*************************************************/
 void lcdFillRGB(uint16_t data)
 {
-  unsigned int i;
+  st7783ReleaseWindow();
   st7783Home();
-  
-  uint32_t pixels = 320*240;
-  for ( i=0; i < pixels; i++ )
-  {
-    st7783WriteData(data);
-  } 
+  lcdStreamFill(data, 320*240);
 }
 
 /*************************************************/
 void lcdDrawPixel(uint16_t x, uint16_t y, uint16_t color)
 {
+  st7783ReleaseWindow();
   st7783SetCursor(x, y);
   st7783WriteCmd(0x0022);  // Write Data to GRAM (R22h)
   st7783WriteData(color);
@@ -372,6 +384,7 @@ void lcdDrawPixel(uint16_t x, uint16_t y, uint16_t color)
 void lcdDrawPixels(uint16_t x, uint16_t y, uint16_t *data, uint32_t len)
 {
   uint32_t i = 0;
+  st7783ReleaseWindow();
   st7783SetCursor(x, y);
   st7783WriteCmd(0x0022);  // Write Data to GRAM (R22h)
   do
@@ -394,6 +407,7 @@ void lcdDrawHLine(uint16_t x0, uint16_t x1, uint16_t y, uint16_t color)
     x1 = x0;
     x0 = x;
   }
+  st7783ReleaseWindow();
   st7783SetCursor(x0, y);
   st7783WriteCmd(0x0022);  // Write Data to GRAM (R22h)
   for (pixels = 0; pixels < x1 - x0 + 1; pixels++)
@@ -418,11 +432,109 @@ void lcdDrawVLine(uint16_t x, uint16_t y0, uint16_t y1, uint16_t color)
   lcdSetOrientation(orientation);
 }
 
+/**************************************************************************/
+/*! 
+    @brief  Opens a rectangular window (inclusive coordinates) on the
+            LCD and prepares GRAM for streaming
+
+    Pixels sent with lcdStreamPixels or lcdStreamFill are written
+    left to right and top to bottom inside the window, with the
+    controller wrapping to the next line by itself.  Any of the
+    regular drawing functions will restore the full-screen window.
+*/
+/**************************************************************************/
+void lcdSetWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+  uint16_t t;
+
+  if (x1 < x0)
+  {
+    t = x0; x0 = x1; x1 = t;
+  }
+  if (y1 < y0)
+  {
+    t = y0; y0 = y1; y1 = t;
+  }
+
+  // Check limits
+  if (x1 >= lcdGetWidth())
+  {
+    x1 = lcdGetWidth() - 1;
+  }
+  if (y1 >= lcdGetHeight())
+  {
+    y1 = lcdGetHeight() - 1;
+  }
+  if (x0 > x1)
+  {
+    x0 = x1;
+  }
+  if (y0 > y1)
+  {
+    y0 = y1;
+  }
+
+  // st7783SetCursor moves the window end registers in landscape
+  // mode, so the window and GRAM address are written directly here
+  if (lcdOrientation == LCD_ORIENTATION_LANDSCAPE)
+  {
+    st7783Command(0x0050, y0);
+    st7783Command(0x0051, y1);
+    st7783Command(0x0052, x0);
+    st7783Command(0x0053, x1);
+    st7783Command(0x0020, y0);
+    st7783Command(0x0021, x0);
+  }
+  else
+  {
+    st7783Command(0x0050, x0);
+    st7783Command(0x0051, x1);
+    st7783Command(0x0052, y0);
+    st7783Command(0x0053, y1);
+    st7783Command(0x0020, x0);
+    st7783Command(0x0021, y0);
+  }
+  st7783WriteCmd(0x0022);  // Write Data to GRAM (R22h)
+  st7783WindowActive = TRUE;
+}
+
+/*************************************************/
+void lcdStreamPixels(uint16_t *data, uint32_t len)
+{
+  while (len--)
+  {
+    st7783WriteData(*data++);
+  }
+}
+
+/*************************************************/
+void lcdStreamFill(uint16_t color, uint32_t len)
+{
+  // Unrolled to keep the loop overhead out of large fills
+  while (len >= 8)
+  {
+    st7783WriteData(color);
+    st7783WriteData(color);
+    st7783WriteData(color);
+    st7783WriteData(color);
+    st7783WriteData(color);
+    st7783WriteData(color);
+    st7783WriteData(color);
+    st7783WriteData(color);
+    len -= 8;
+  }
+  while (len--)
+  {
+    st7783WriteData(color);
+  }
+}
+
 /*************************************************/
 uint16_t lcdGetPixel(uint16_t x, uint16_t y)
 {
   uint16_t preFetch = 0;
 
+  st7783ReleaseWindow();
   st7783SetCursor(x, y);
   st7783WriteCmd(0x0022);
   preFetch = st7783ReadData();
@@ -433,18 +545,31 @@ uint16_t lcdGetPixel(uint16_t x, uint16_t y)
   return st7783ReadData();
 }
 
+/*************************************************/
+void lcdReadPixels(uint16_t x, uint16_t y, uint16_t *buf, uint32_t len)
+{
+  // ToDo: Read in a single burst like the ILI932x drivers
+  while (len--)
+  {
+    *buf++ = lcdGetPixel(x++, y);
+  }
+}
+
 /*************************************************/
 void lcdSetOrientation(lcdOrientation_t orientation)
 {
   uint16_t entryMode = 0x1030;
 
+  // The window is held in GRAM coordinates, so drop it before rotating
+  st7783ReleaseWindow();
+
   switch (orientation)
   {
     case LCD_ORIENTATION_PORTRAIT:
       entryMode = 0x1030;
       break;
     case LCD_ORIENTATION_LANDSCAPE:
-      entryMode = 0x1028;
+      entryMode = 0x1038;
       break;
   }
   st7783WriteCmd(0x0003);
@@ -493,6 +618,19 @@ void lcdScroll(int16_t pixels, uint16_t fillColor)
   // Not implemented in ST7783
 }
 
+/*************************************************/
+void lcdScrollRegion(uint16_t y0, uint16_t y1, int16_t pixels, uint16_t fillColor)
+{
+  // Not implemented in ST7783
+}
+
+/*************************************************/
+bool lcdSetScrollOffset(uint16_t y0, uint16_t y1, uint16_t offset)
+{
+  // Not implemented in ST7783
+  return FALSE;
+}
+
 /*************************************************/
 uint16_t lcdGetControllerID(void)
 {
@@ -0,0 +1,398 @@
+/**************************************************************************/
+/*! 
+    @file     img565.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Loads pre-converted RGB565 images (raw or RLE compressed)
+              from the SD card
+
+    @section DESCRIPTION
+
+    24-bit bitmaps need to be converted to RGB565 pixel by pixel and
+    are stored bottom-up, so every image pays for the colour conversion
+    and for reading 50% more data than the LCD actually needs.  Images
+    in the native format described in img565.h are already stored
+    top-down as RGB565, so each row can be read straight into a line
+    buffer and sent to the LCD as is.
+
+    Palette-indexed images only store a 1, 2, 4 or 8-bit index per
+    pixel, which is expanded through their palette by drawImageIndexed
+    as each row is sent to the LCD.
+
+    Images can be created from 24-bit bitmaps with the converter in
+    tools/bmp2img565.
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/img565.h"
+
+    // Draw splash.img (from the root folder) starting at pixel 0,0
+    img565_error_t error = img565DrawImage(0, 0, "/splash.img");
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "img565.h"
+
+#include "drivers/lcd/tft/lcd.h"
+#include "drivers/lcd/tft/drawing.h"
+
+// Only include read support if CFG_SDCARD is defined
+#ifdef CFG_SDCARD
+  #include "drivers/fatfs/diskio.h"
+  #include "drivers/fatfs/ff.h"
+  #include "drivers/fatfs/assetpack.h"
+  #include "drivers/fatfs/ffsync.h"
+
+#define IMG565_READBUFSIZE    (128)   // Size of the RLE input buffer (must be even)
+
+/* Buffered 16-bit word reader used for RLE data */
+typedef struct
+{
+  FIL     *file;
+  uint16_t buffer[IMG565_READBUFSIZE / 2];
+  UINT     len;                       // Words in the buffer
+  UINT     pos;                       // Next word to read
+} img565_reader_t;
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Reads the next 16-bit word from the RLE stream
+*/
+/**************************************************************************/
+static bool img565ReadWord(img565_reader_t *reader, uint16_t *word)
+{
+  UINT bytesRead;
+
+  if (reader->pos >= reader->len)
+  {
+    if (f_read(reader->file, reader->buffer, IMG565_READBUFSIZE, &bytesRead) || (bytesRead < 2))
+      return false;
+    reader->len = bytesRead / 2;
+    reader->pos = 0;
+  }
+
+  *word = reader->buffer[reader->pos++];
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Renders the palette and pixel indices following the header
+            of an indexed image, one row at a time
+*/
+/**************************************************************************/
+static img565_error_t img565ParseIndexed(uint16_t x, uint16_t y, FIL *file, const img565_header_t *header)
+{
+  UINT     bytesRead;
+  uint32_t py, rowBytes, colors;
+
+  if ((header->depth != 1) && (header->depth != 2) && (header->depth != 4) && (header->depth != 8))
+    return IMG565_ERROR_INVALIDDEPTH;
+
+  if (header->compression != IMG565_COMPRESSION_NONE)
+    return IMG565_ERROR_COMPRESSEDDATA;
+
+  colors = 1 << header->depth;
+  rowBytes = ((uint32_t)header->width * header->depth + 7) / 8;
+
+  uint16_t palette[colors];
+  uint8_t  row[rowBytes];
+
+  if (f_read(file, palette, colors * 2, &bytesRead) || (bytesRead != colors * 2))
+    return IMG565_ERROR_PREMATUREEOF;
+
+  for (py = 0; py < header->height; py++)
+  {
+    if (f_read(file, row, rowBytes, &bytesRead) || (bytesRead != rowBytes))
+      return IMG565_ERROR_PREMATUREEOF;
+    if (y + py < lcdGetHeight())
+      drawImageIndexed(x, y + py, header->width, 1, header->depth, palette, row);
+  }
+
+  return IMG565_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parses the image header and renders the image one row at
+            a time with lcdDrawPixels()
+*/
+/**************************************************************************/
+static img565_error_t img565ParseImage(uint16_t x, uint16_t y, FIL *file)
+{
+  UINT            bytesRead;
+  img565_header_t header;
+  uint8_t         raw[IMG565_HEADERSIZE];
+  uint32_t        px, py, visible;
+
+  // Read and parse the header
+  if (f_read(file, raw, IMG565_HEADERSIZE, &bytesRead) || bytesRead != IMG565_HEADERSIZE)
+    return IMG565_ERROR_NOTANIMAGE;
+
+  memcpy(header.magic, raw, 4);
+  header.width = raw[4] | (raw[5] << 8);
+  header.height = raw[6] | (raw[7] << 8);
+  header.compression = raw[8];
+  header.depth = raw[9];
+
+  if (memcmp(header.magic, IMG565_MAGIC, 4))
+    return IMG565_ERROR_NOTANIMAGE;
+
+  if ((header.width == 0) || (header.height == 0) ||
+      (header.width > lcdGetWidth()) || (header.height > lcdGetHeight()))
+    return IMG565_ERROR_INVALIDDIMENSIONS;
+
+  if ((header.compression != IMG565_COMPRESSION_NONE) && (header.compression != IMG565_COMPRESSION_RLE))
+    return IMG565_ERROR_COMPRESSEDDATA;
+
+  if (header.depth)
+    return img565ParseIndexed(x, y, file, &header);
+
+  // Clip anything that falls off the right edge of the screen
+  visible = 0;
+  if (x < lcdGetWidth())
+  {
+    visible = lcdGetWidth() - x;
+    if (visible > header.width) visible = header.width;
+  }
+
+  uint16_t row[header.width];
+
+  if (header.compression == IMG565_COMPRESSION_NONE)
+  {
+    // Raw data ... read each row straight into the line buffer
+    for (py = 0; py < header.height; py++)
+    {
+      if (f_read(file, row, header.width * 2, &bytesRead) || (bytesRead != header.width * 2))
+        return IMG565_ERROR_PREMATUREEOF;
+      if (visible && (y + py < lcdGetHeight()))
+        lcdDrawPixels(x, y + py, row, visible);
+    }
+    return IMG565_ERROR_NONE;
+  }
+
+  // RLE data ... decode packets into the line buffer
+  img565_reader_t reader;
+  uint16_t ctrl, color = 0;
+  uint32_t count = 0;
+  bool run = false;
+
+  reader.file = file;
+  reader.len = reader.pos = 0;
+
+  for (py = 0; py < header.height; py++)
+  {
+    for (px = 0; px < header.width; px++)
+    {
+      if (count == 0)
+      {
+        // Start a new packet
+        if (!img565ReadWord(&reader, &ctrl))
+          return IMG565_ERROR_PREMATUREEOF;
+        run = ctrl & IMG565_RLE_RUN;
+        count = (ctrl & ~IMG565_RLE_RUN) + 1;
+        if (run && !img565ReadWord(&reader, &color))
+          return IMG565_ERROR_PREMATUREEOF;
+      }
+      if (!run && !img565ReadWord(&reader, &color))
+        return IMG565_ERROR_PREMATUREEOF;
+      row[px] = color;
+      count--;
+    }
+    if (visible && (y + py < lcdGetHeight()))
+      lcdDrawPixels(x, y + py, row, visible);
+  }
+
+  // A packet that runs past the end of the image means corrupt data
+  return count ? IMG565_ERROR_INVALIDDATA : IMG565_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Loads an RGB565 image (see img565.h) from the SD card and
+            renders it
+
+    @param[in]  x
+                Left edge of the image on the LCD
+    @param[in]  y
+                Top edge of the image on the LCD
+    @param[in]  filename
+                Full path of the image file
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/img565.h"
+
+    img565_error_t error;
+
+    // Draw logo.img (from the root folder) starting at pixel 10,10
+    error = img565DrawImage(10, 10, "/logo.img");
+
+    // Check 'error' for problems such as IMG565_ERROR_FILENOTFOUND
+
+    @endcode
+*/
+/**************************************************************************/
+img565_error_t img565DrawImage(uint16_t x, uint16_t y, const char* filename)
+{
+  img565_error_t error;
+  FIL imgfile;
+
+  // Initialise the card if needed and mount the drive
+  if (ffSyncMount() != FR_OK) 
+  {
+    // Card not initialised or no disk present
+    return IMG565_ERROR_SDINITFAIL;
+  }
+
+  // Try to open the requested file
+  if (f_open(&imgfile, filename, FA_READ | FA_OPEN_EXISTING) != FR_OK) 
+  {  
+    ffSyncUnmount();
+    return IMG565_ERROR_FILENOTFOUND;
+  }
+
+  // Try to render the specified image
+  error = img565ParseImage(x, y, &imgfile);
+
+  // Close file and unmount drive
+  f_close(&imgfile);
+  ffSyncUnmount();
+
+  return error;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Renders an ASSETPACK_TYPE_IMG565 image from the open asset
+            pack.  The pixel data is sent to the LCD straight out of the
+            sector buffer, one sector (256 pixels) at a time, so no line
+            buffer is needed and no files are opened.
+
+    @param[in]  x
+                Left edge of the image on the LCD
+    @param[in]  y
+                Top edge of the image on the LCD
+    @param[in]  id
+                Asset ID in the pack opened with assetPackOpen()
+
+    @section Example
+
+    @code 
+
+    #include "drivers/fatfs/assetpack.h"
+    #include "drivers/lcd/tft/img565.h"
+    #include "assets.h"
+
+    assetPackOpen("/ui.pak");
+    img565DrawAsset(0, 0, ASSET_BACKGROUND);
+    img565DrawAsset(10, 10, ASSET_LOGO);
+
+    @endcode
+*/
+/**************************************************************************/
+img565_error_t img565DrawAsset(uint16_t x, uint16_t y, uint16_t id)
+{
+  assetpack_entry_t entry;
+  const uint8_t     *data;
+  const uint16_t    *pixels;
+  uint32_t          sector, pos, n, px, py, visible;
+
+  if (assetPackFind(id, &entry) != ASSETPACK_ERROR_NONE)
+    return IMG565_ERROR_FILENOTFOUND;
+
+  if (entry.type != ASSETPACK_TYPE_IMG565)
+    return IMG565_ERROR_NOTANIMAGE;
+
+  if ((entry.width == 0) || (entry.height == 0) ||
+      (entry.width > lcdGetWidth()) || (entry.height > lcdGetHeight()))
+    return IMG565_ERROR_INVALIDDIMENSIONS;
+
+  if (entry.length < (uint32_t)entry.width * entry.height * 2)
+    return IMG565_ERROR_PREMATUREEOF;
+
+  // Clip anything that falls off the right edge of the screen
+  visible = 0;
+  if (x < lcdGetWidth())
+  {
+    visible = lcdGetWidth() - x;
+    if (visible > entry.width) visible = entry.width;
+  }
+
+  // Rows don't line up with sectors, so each sector is drawn as a
+  // sequence of (partial) row segments
+  px = py = 0;
+  for (sector = 0; py < entry.height; sector++)
+  {
+    if (assetPackGetSector(&entry, sector, &data) != ASSETPACK_ERROR_NONE)
+      return IMG565_ERROR_PREMATUREEOF;
+    pixels = (const uint16_t *)data;
+
+    for (pos = 0; (pos < ASSETPACK_SECTORSIZE / 2) && (py < entry.height); pos += n)
+    {
+      n = entry.width - px;
+      if (n > ASSETPACK_SECTORSIZE / 2 - pos)
+        n = ASSETPACK_SECTORSIZE / 2 - pos;
+      if ((px < visible) && (y + py < lcdGetHeight()))
+        lcdDrawPixels(x + px, y + py, (uint16_t *)&pixels[pos], px + n > visible ? visible - px : n);
+      px += n;
+      if (px == entry.width)
+      {
+        px = 0;
+        py++;
+      }
+    }
+  }
+
+  return IMG565_ERROR_NONE;
+}
+
+#endif  // End of CFG_SDCARD check
@@ -0,0 +1,129 @@
+/**************************************************************************/
+/*! 
+    @file     img565.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __IMG565_H__
+#define __IMG565_H__
+
+#include "projectconfig.h"
+
+/**************************************************************************
+    Native RGB565 Image File Format
+    -----------------------------------------------------------------------
+    Images are converted ahead of time on the PC (see tools/bmp2img565)
+    so that the pixel data can be sent to the LCD exactly as it is read
+    from the SD card, without any colour conversion or row reversal.
+    All values are little-endian:
+
+    --------------------------
+    |         Header         |        16 bytes (img565_header_t)
+    |-------------------------
+    |       Image Data       |        width * height pixels, top-down
+    --------------------------
+
+    With IMG565_COMPRESSION_NONE the image data is simply one 16-bit
+    RGB565 word per pixel, starting at the top-left corner.
+
+    If 'depth' is 1, 2, 4 or 8 the image is palette-indexed instead.
+    The header is followed by (1 << depth) RGB565 palette entries, and
+    then by one row of packed indices per line (MSB first, with each
+    row padded to a whole byte).  Indexed images are never compressed.
+    A depth of 0 means 16-bit RGB565 pixels.
+
+    With IMG565_COMPRESSION_RLE the image data is a sequence of packets
+    that together describe width * height pixels (packets may span
+    rows):
+
+    - Control word with bit 15 set:   ((ctrl & 0x7FFF) + 1) copies of
+                                      the single RGB565 word that follows
+    - Control word with bit 15 clear: (ctrl + 1) literal RGB565 words
+                                      follow
+
+ **************************************************************************/
+
+#define IMG565_MAGIC            "R565"
+#define IMG565_HEADERSIZE       (16)
+#define IMG565_RLE_RUN          (0x8000)    // Control word run flag
+#define IMG565_RLE_MAXCOUNT     (0x8000)    // Max pixels per packet
+
+/**************************************************************************/
+/*!
+    @brief  16-byte image header
+*/
+/**************************************************************************/
+typedef struct 
+{
+  char     magic[4];                  /* 'R', '5', '6', '5'          */
+  uint16_t width;                     /* Width in pixels             */
+  uint16_t height;                    /* Height in pixels            */
+  uint8_t  compression;               /* img565_compression_t        */
+  uint8_t  depth;                     /* Index bits, 0 = RGB565      */
+  uint8_t  reserved[6];
+} img565_header_t;
+
+/**************************************************************************/
+/*!
+    @brief  Compression methods for the image data
+*/
+/**************************************************************************/
+typedef enum
+{
+  IMG565_COMPRESSION_NONE = 0,
+  IMG565_COMPRESSION_RLE = 1
+} img565_compression_t;
+
+/**************************************************************************/
+/*!
+    @brief  Error return codes when processing RGB565 images
+*/
+/**************************************************************************/
+typedef enum
+{
+  IMG565_ERROR_NONE = 0,
+  IMG565_ERROR_SDINITFAIL = 1,
+  IMG565_ERROR_FILENOTFOUND = 2,
+  IMG565_ERROR_NOTANIMAGE = 10,         /* Missing 'R565' header */
+  IMG565_ERROR_COMPRESSEDDATA = 11,     /* Unknown compression method */
+  IMG565_ERROR_INVALIDDIMENSIONS = 12,  /* Image is larger than the LCD */
+  IMG565_ERROR_PREMATUREEOF = 13,       /* EOF reached unexpectedly in pixel data */
+  IMG565_ERROR_INVALIDDATA = 14,        /* Corrupt RLE data */
+  IMG565_ERROR_INVALIDDEPTH = 15        /* Depth isn't 0, 1, 2, 4 or 8 */
+} img565_error_t;
+
+#ifdef CFG_SDCARD
+img565_error_t img565DrawImage(uint16_t x, uint16_t y, const char* filename);
+img565_error_t img565DrawAsset(uint16_t x, uint16_t y, uint16_t id);
+#endif
+
+#endif
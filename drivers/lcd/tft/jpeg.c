@@ -0,0 +1,1068 @@
+/**************************************************************************/
+/*! 
+    @file     jpeg.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Streaming baseline JPEG decoder that renders straight to
+              the LCD
+
+    @section DESCRIPTION
+
+    A JPEG image is stored as a sequence of MCUs (minimum coded units),
+    each covering 8x8 to 16x16 pixels depending on how the colour
+    information was subsampled.  Rather than decoding the whole image
+    into RAM (which would need 150KB for a full 240x320 screen), every
+    MCU is decoded on its own, converted to RGB565 and sent to the LCD
+    through a window opened with lcdSetWindow(), so the only buffers
+    needed are a sector-sized input buffer, the Huffman and quantization
+    tables and the samples for one MCU.
+
+    The IDCT is the accurate integer version from the IJG library
+    (jidctint.c), with a shortcut for the columns and rows that only
+    contain a DC coefficient, which is the common case after
+    quantization.  Images can also be scaled down by 2, 4 or 8 while
+    they are decoded (see jpeg.h).
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/jpeg.h"
+
+    // Draw photo.jpg (from the root folder) at half size starting at 0,0
+    jpeg_error_t error = jpegDrawImage(0, 0, "/photo.jpg", 2);
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "jpeg.h"
+
+#include "drivers/lcd/tft/lcd.h"
+
+// Only include the decoder if CFG_SDCARD and CFG_TFTLCD_JPEG are defined
+#if defined CFG_SDCARD && defined CFG_TFTLCD_JPEG && CFG_TFTLCD_JPEG == 1
+  #include "drivers/fatfs/diskio.h"
+  #include "drivers/fatfs/ff.h"
+  #include "drivers/fatfs/ffsync.h"
+
+#define JPEG_READBUFSIZE      (512)   // Size of the input buffer (one SD sector)
+
+// Markers
+#define JPEG_MARKER_SOF0      (0xC0)  // Baseline DCT
+#define JPEG_MARKER_SOF1      (0xC1)  // Extended sequential DCT
+#define JPEG_MARKER_DHT       (0xC4)  // Define Huffman tables
+#define JPEG_MARKER_RST0      (0xD0)  // Restart markers 0..7
+#define JPEG_MARKER_RST7      (0xD7)
+#define JPEG_MARKER_SOI       (0xD8)  // Start of image
+#define JPEG_MARKER_EOI       (0xD9)  // End of image
+#define JPEG_MARKER_SOS       (0xDA)  // Start of scan
+#define JPEG_MARKER_DQT       (0xDB)  // Define quantization tables
+#define JPEG_MARKER_DRI       (0xDD)  // Define restart interval
+
+// Fixed point constants for the IDCT (see jidctint.c in the IJG library)
+#define JPEG_CONST_BITS       (13)
+#define JPEG_PASS1_BITS       (2)
+#define JPEG_FIX_0_298631336  (2446)
+#define JPEG_FIX_0_390180644  (3196)
+#define JPEG_FIX_0_541196100  (4433)
+#define JPEG_FIX_0_765366865  (6270)
+#define JPEG_FIX_0_899976223  (7373)
+#define JPEG_FIX_1_175875602  (9633)
+#define JPEG_FIX_1_501321110  (12299)
+#define JPEG_FIX_1_847759065  (15137)
+#define JPEG_FIX_1_961570560  (16069)
+#define JPEG_FIX_2_053119869  (16819)
+#define JPEG_FIX_2_562915447  (20995)
+#define JPEG_FIX_3_072711026  (25172)
+#define JPEG_DESCALE(x,n)     (((x) + (1 << ((n) - 1))) >> (n))
+
+/* Huffman table, decoded canonically one code length at a time */
+typedef struct
+{
+  int32_t  maxcode[17];               // Largest code of each length, -1 if none
+  int32_t  valoffset[17];             // huffval index = code + valoffset[length]
+  uint8_t  huffval[162];              // Symbols in order of increasing code length
+} jpeg_huffman_t;
+
+/* Image component (Y, Cb or Cr) */
+typedef struct
+{
+  uint8_t  id;
+  uint8_t  h, v;                      // Sampling factors
+  uint8_t  tq;                        // Quantization table
+  uint8_t  td, ta;                    // DC and AC Huffman tables
+  int16_t  dcpred;                    // Previous DC value
+} jpeg_component_t;
+
+/* Decoder state ... everything that doesn't fit comfortably on the stack */
+typedef struct
+{
+  FIL              *file;
+  uint8_t          buffer[JPEG_READBUFSIZE];
+  UINT             len;               // Bytes in the buffer
+  UINT             pos;               // Next byte to read
+  bool             eof;               // Read past the end of the file
+  uint32_t         bits;              // Entropy coded bits, MSB first
+  uint8_t          bitCount;          // Valid bits in 'bits'
+  uint8_t          marker;            // Marker found in the entropy coded data
+  uint8_t          tables;            // Bit mask of the tables that were defined
+  uint8_t          components;        // 1 (greyscale) or 3 (YCbCr)
+  uint16_t         width, height;
+  uint16_t         restartInterval;   // MCUs between RSTn markers, 0 if none
+  uint8_t          qt[4][64];         // Quantization tables in zigzag order
+  jpeg_huffman_t   huffman[4];        // DC 0, DC 1, AC 0, AC 1
+  jpeg_component_t component[3];
+  int16_t          block[64];         // Dequantized coefficients
+  uint8_t          y[256];            // Scaled samples for one MCU
+  uint8_t          cb[64];
+  uint8_t          cr[64];
+} jpeg_decoder_t;
+
+static jpeg_decoder_t jpeg;
+
+#define JPEG_TABLE_DQT(n)     (1 << (n))
+#define JPEG_TABLE_DHT(n)     (1 << (4 + (n)))
+
+/* Natural (row-major) position of each coefficient in zigzag order */
+static const uint8_t jpegZigzag[64] =
+{
+   0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+  12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+  35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+  58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Reads the next byte from the file, returning 0 and setting
+            'eof' once the end of the file is reached
+*/
+/**************************************************************************/
+static uint8_t jpegReadByte(void)
+{
+  if (jpeg.pos >= jpeg.len)
+  {
+    if (f_read(jpeg.file, jpeg.buffer, JPEG_READBUFSIZE, &jpeg.len) || (jpeg.len == 0))
+    {
+      jpeg.len = jpeg.pos = 0;
+      jpeg.eof = true;
+      return 0;
+    }
+    jpeg.pos = 0;
+  }
+
+  return jpeg.buffer[jpeg.pos++];
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads a big-endian 16-bit word from the file
+*/
+/**************************************************************************/
+static uint16_t jpegReadWord(void)
+{
+  uint16_t word = jpegReadByte() << 8;
+  return word | jpegReadByte();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Tops up the bit buffer with at least 25 valid bits.
+
+    A 0xFF data byte is always followed by a stuffed 0x00, which is
+    dropped.  Any other byte after 0xFF is a marker (normally RSTn or
+    EOI), at which point zeros are shifted in until the marker has been
+    dealt with.
+*/
+/**************************************************************************/
+static void jpegFillBits(void)
+{
+  uint32_t byte;
+
+  while (jpeg.bitCount <= 24)
+  {
+    byte = 0;
+    if (!jpeg.marker && !jpeg.eof)
+    {
+      byte = jpegReadByte();
+      if (byte == 0xFF)
+      {
+        uint8_t next;
+        do
+        {
+          next = jpegReadByte();
+        } while ((next == 0xFF) && !jpeg.eof);
+        if (next)
+        {
+          jpeg.marker = next;
+          byte = 0;
+        }
+      }
+    }
+    jpeg.bits |= byte << (24 - jpeg.bitCount);
+    jpeg.bitCount += 8;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads 'count' bits (1..16) from the entropy coded data
+*/
+/**************************************************************************/
+static inline uint32_t jpegGetBits(uint8_t count)
+{
+  uint32_t value;
+
+  if (jpeg.bitCount < count)
+    jpegFillBits();
+
+  value = jpeg.bits >> (32 - count);
+  jpeg.bits <<= count;
+  jpeg.bitCount -= count;
+  return value;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts the 'count' bits following a Huffman code into a
+            signed coefficient (F.2.2.1 in the JPEG standard)
+*/
+/**************************************************************************/
+static inline int32_t jpegExtend(uint32_t value, uint8_t count)
+{
+  if (value < (1UL << (count - 1)))
+    return (int32_t)value - (int32_t)(1UL << count) + 1;
+  return (int32_t)value;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes the next Huffman coded symbol, or returns -1 if the
+            bits don't match any code in the table
+*/
+/**************************************************************************/
+static int32_t jpegDecodeSymbol(const jpeg_huffman_t *table)
+{
+  uint32_t code;
+  uint8_t  length;
+
+  if (jpeg.bitCount < 16)
+    jpegFillBits();
+
+  for (length = 1; length <= 16; length++)
+  {
+    code = jpeg.bits >> (32 - length);
+    if ((int32_t)code <= table->maxcode[length])
+    {
+      jpeg.bits <<= length;
+      jpeg.bitCount -= length;
+      return table->huffval[code + table->valoffset[length]];
+    }
+  }
+
+  return -1;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parses a DHT segment, which can hold several tables
+*/
+/**************************************************************************/
+static jpeg_error_t jpegParseDHT(int32_t length)
+{
+  jpeg_huffman_t *table;
+  uint8_t  counts[17];
+  uint32_t code, total, i;
+  uint8_t  info, n;
+
+  while (length > 0)
+  {
+    info = jpegReadByte();
+    if (((info >> 4) > 1) || ((info & 0x0F) > 1))
+      return JPEG_ERROR_UNSUPPORTED;
+    table = &jpeg.huffman[((info >> 4) << 1) | (info & 0x0F)];
+
+    total = 0;
+    for (n = 1; n <= 16; n++)
+    {
+      counts[n] = jpegReadByte();
+      total += counts[n];
+    }
+    if (total > sizeof(table->huffval))
+      return JPEG_ERROR_INVALIDDATA;
+    for (i = 0; i < total; i++)
+      table->huffval[i] = jpegReadByte();
+
+    // Generate the canonical codes (C.2 in the JPEG standard)
+    code = 0;
+    i = 0;
+    for (n = 1; n <= 16; n++)
+    {
+      table->valoffset[n] = (int32_t)i - (int32_t)code;
+      code += counts[n];
+      i += counts[n];
+      if (code > (1UL << n))
+        return JPEG_ERROR_INVALIDDATA;
+      table->maxcode[n] = counts[n] ? (int32_t)code - 1 : -1;
+      code <<= 1;
+    }
+
+    jpeg.tables |= JPEG_TABLE_DHT(((info >> 4) << 1) | (info & 0x0F));
+    length -= 17 + total;
+  }
+
+  return jpeg.eof ? JPEG_ERROR_PREMATUREEOF : JPEG_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parses a DQT segment, which can hold several tables
+*/
+/**************************************************************************/
+static jpeg_error_t jpegParseDQT(int32_t length)
+{
+  uint8_t info, i;
+
+  while (length > 0)
+  {
+    info = jpegReadByte();
+    // Only 8-bit tables are used with 8-bit samples
+    if ((info >> 4) || ((info & 0x0F) > 3))
+      return JPEG_ERROR_UNSUPPORTED;
+    for (i = 0; i < 64; i++)
+      jpeg.qt[info & 0x0F][i] = jpegReadByte();
+    jpeg.tables |= JPEG_TABLE_DQT(info & 0x0F);
+    length -= 65;
+  }
+
+  return jpeg.eof ? JPEG_ERROR_PREMATUREEOF : JPEG_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parses a SOF0/SOF1 segment and checks that the image is
+            one this decoder can handle
+*/
+/**************************************************************************/
+static jpeg_error_t jpegParseSOF(void)
+{
+  jpeg_component_t *c;
+  uint8_t i, sampling;
+
+  if (jpegReadByte() != 8)
+    return JPEG_ERROR_UNSUPPORTED;
+
+  jpeg.height = jpegReadWord();
+  jpeg.width = jpegReadWord();
+  jpeg.components = jpegReadByte();
+
+  if ((jpeg.width == 0) || (jpeg.height == 0))
+    return JPEG_ERROR_UNSUPPORTED;
+  if ((jpeg.components != 1) && (jpeg.components != 3))
+    return JPEG_ERROR_UNSUPPORTED;
+
+  for (i = 0; i < jpeg.components; i++)
+  {
+    c = &jpeg.component[i];
+    c->id = jpegReadByte();
+    sampling = jpegReadByte();
+    c->h = sampling >> 4;
+    c->v = sampling & 0x0F;
+    c->tq = jpegReadByte();
+    if (c->tq > 3)
+      return JPEG_ERROR_INVALIDDATA;
+  }
+
+  if (jpeg.components == 1)
+  {
+    // A single component is never interleaved, so each MCU is one block
+    jpeg.component[0].h = jpeg.component[0].v = 1;
+  }
+  else
+  {
+    c = jpeg.component;
+    if ((c[0].h < 1) || (c[0].h > 2) || (c[0].v < 1) || (c[0].v > 2) ||
+        (c[1].h != 1) || (c[1].v != 1) || (c[2].h != 1) || (c[2].v != 1))
+      return JPEG_ERROR_UNSUPPORTED;
+  }
+
+  return jpeg.eof ? JPEG_ERROR_PREMATUREEOF : JPEG_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parses a SOS segment, which assigns the Huffman tables to
+            each component.  Only a single scan containing every
+            component is supported.
+*/
+/**************************************************************************/
+static jpeg_error_t jpegParseSOS(void)
+{
+  jpeg_component_t *c;
+  uint8_t i, n, id, tables;
+
+  if (jpegReadByte() != jpeg.components)
+    return JPEG_ERROR_UNSUPPORTED;
+
+  for (i = 0; i < jpeg.components; i++)
+  {
+    id = jpegReadByte();
+    tables = jpegReadByte();
+    for (n = 0, c = NULL; n < jpeg.components; n++)
+    {
+      if (jpeg.component[n].id == id)
+        c = &jpeg.component[n];
+    }
+    if (c == NULL)
+      return JPEG_ERROR_INVALIDDATA;
+    c->td = tables >> 4;
+    c->ta = tables & 0x0F;
+    if ((c->td > 1) || (c->ta > 1))
+      return JPEG_ERROR_UNSUPPORTED;
+    if (!(jpeg.tables & JPEG_TABLE_DHT(c->td)) || !(jpeg.tables & JPEG_TABLE_DHT(2 + c->ta)) ||
+        !(jpeg.tables & JPEG_TABLE_DQT(c->tq)))
+      return JPEG_ERROR_INVALIDDATA;
+  }
+
+  // Spectral selection and successive approximation are fixed in a
+  // sequential scan
+  jpegReadByte();
+  jpegReadByte();
+  jpegReadByte();
+
+  return jpeg.eof ? JPEG_ERROR_PREMATUREEOF : JPEG_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads the markers up to and including SOS
+*/
+/**************************************************************************/
+static jpeg_error_t jpegParseHeaders(void)
+{
+  jpeg_error_t error;
+  uint8_t      marker;
+  int32_t      length;
+  bool         frame = false;
+
+  if ((jpegReadByte() != 0xFF) || (jpegReadByte() != JPEG_MARKER_SOI))
+    return JPEG_ERROR_NOTAJPEG;
+
+  while (1)
+  {
+    // Markers can be preceded by any number of 0xFF fill bytes
+    if (jpegReadByte() != 0xFF)
+      return jpeg.eof ? JPEG_ERROR_PREMATUREEOF : JPEG_ERROR_INVALIDDATA;
+    do
+    {
+      marker = jpegReadByte();
+    } while ((marker == 0xFF) && !jpeg.eof);
+
+    if (jpeg.eof)
+      return JPEG_ERROR_PREMATUREEOF;
+    if (marker == JPEG_MARKER_EOI)
+      return JPEG_ERROR_INVALIDDATA;
+
+    length = (int32_t)jpegReadWord() - 2;
+    if (length < 0)
+      return JPEG_ERROR_INVALIDDATA;
+
+    error = JPEG_ERROR_NONE;
+    switch (marker)
+    {
+      case JPEG_MARKER_SOF0:
+      case JPEG_MARKER_SOF1:
+        error = jpegParseSOF();
+        frame = true;
+        break;
+      case JPEG_MARKER_DHT:
+        error = jpegParseDHT(length);
+        break;
+      case JPEG_MARKER_DQT:
+        error = jpegParseDQT(length);
+        break;
+      case JPEG_MARKER_DRI:
+        jpeg.restartInterval = jpegReadWord();
+        break;
+      case JPEG_MARKER_SOS:
+        if (!frame)
+          return JPEG_ERROR_INVALIDDATA;
+        return jpegParseSOS();
+      default:
+        // Any other frame type (progressive, lossless, arithmetic
+        // coding) can't be decoded
+        if ((marker & 0xF0) == 0xC0)
+          return JPEG_ERROR_UNSUPPORTED;
+        // Skip APPn, COM and anything else
+        while (length-- && !jpeg.eof)
+          jpegReadByte();
+        break;
+    }
+
+    if (error)
+      return error;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes one 8x8 block into jpeg.block (dequantized and in
+            natural order).  With 'dcOnly' set (1/8 scaling) the AC
+            coefficients are decoded but not stored.
+*/
+/**************************************************************************/
+static jpeg_error_t jpegDecodeBlock(jpeg_component_t *c, bool dcOnly)
+{
+  const jpeg_huffman_t *ac = &jpeg.huffman[2 + c->ta];
+  const uint8_t        *qt = jpeg.qt[c->tq];
+  int32_t              symbol;
+  uint8_t              k, run, size;
+
+  // DC coefficient, coded as the difference to the last block
+  symbol = jpegDecodeSymbol(&jpeg.huffman[c->td]);
+  if ((symbol < 0) || (symbol > 11))
+    return JPEG_ERROR_INVALIDDATA;
+  if (symbol)
+    c->dcpred += jpegExtend(jpegGetBits(symbol), symbol);
+
+  if (!dcOnly)
+    memset(jpeg.block, 0, sizeof(jpeg.block));
+  jpeg.block[0] = c->dcpred * qt[0];
+
+  // AC coefficients, run length coded in zigzag order
+  for (k = 1; k < 64; k++)
+  {
+    symbol = jpegDecodeSymbol(ac);
+    if (symbol < 0)
+      return JPEG_ERROR_INVALIDDATA;
+    run = symbol >> 4;
+    size = symbol & 0x0F;
+    if (size == 0)
+    {
+      if (run != 15)
+        break;                        // End of block
+      k += 15;                        // 16 zeros
+      continue;
+    }
+    k += run;
+    if (k > 63)
+      return JPEG_ERROR_INVALIDDATA;
+    symbol = jpegExtend(jpegGetBits(size), size);
+    if (!dcOnly)
+      jpeg.block[jpegZigzag[k]] = symbol * qt[k];
+  }
+
+  return JPEG_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clamps an IDCT output sample to 0..255
+*/
+/**************************************************************************/
+static inline uint8_t jpegClamp(int32_t sample)
+{
+  if (sample < 0) return 0;
+  if (sample > 255) return 255;
+  return (uint8_t)sample;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Inverse DCT of jpeg.block into an 8x8 block of samples
+            (jpeg_idct_islow from the IJG library)
+
+    @param[out] out
+                Top-left sample of the output block
+    @param[in]  stride
+                Distance in bytes between output rows
+*/
+/**************************************************************************/
+static void jpegIDCT(uint8_t *out, uint8_t stride)
+{
+  int32_t tmp0, tmp1, tmp2, tmp3, tmp10, tmp11, tmp12, tmp13;
+  int32_t z1, z2, z3, z4, z5;
+  int32_t workspace[64];
+  int16_t *in;
+  int32_t *ws;
+  uint8_t i;
+
+  // Pass 1: columns, results are scaled up by sqrt(8) << PASS1_BITS
+  for (i = 0, in = jpeg.block, ws = workspace; i < 8; i++, in++, ws++)
+  {
+    if (!in[8] && !in[16] && !in[24] && !in[32] && !in[40] && !in[48] && !in[56])
+    {
+      // DC only ... the whole column has the same value
+      int32_t dc = in[0] << JPEG_PASS1_BITS;
+      ws[0] = ws[8] = ws[16] = ws[24] = ws[32] = ws[40] = ws[48] = ws[56] = dc;
+      continue;
+    }
+
+    // Even part
+    z2 = in[16];
+    z3 = in[48];
+    z1 = (z2 + z3) * JPEG_FIX_0_541196100;
+    tmp2 = z1 - z3 * JPEG_FIX_1_847759065;
+    tmp3 = z1 + z2 * JPEG_FIX_0_765366865;
+    tmp0 = (in[0] + in[32]) << JPEG_CONST_BITS;
+    tmp1 = (in[0] - in[32]) << JPEG_CONST_BITS;
+    tmp10 = tmp0 + tmp3;
+    tmp13 = tmp0 - tmp3;
+    tmp11 = tmp1 + tmp2;
+    tmp12 = tmp1 - tmp2;
+
+    // Odd part
+    tmp0 = in[56];
+    tmp1 = in[40];
+    tmp2 = in[24];
+    tmp3 = in[8];
+    z1 = tmp0 + tmp3;
+    z2 = tmp1 + tmp2;
+    z3 = tmp0 + tmp2;
+    z4 = tmp1 + tmp3;
+    z5 = (z3 + z4) * JPEG_FIX_1_175875602;
+    tmp0 *= JPEG_FIX_0_298631336;
+    tmp1 *= JPEG_FIX_2_053119869;
+    tmp2 *= JPEG_FIX_3_072711026;
+    tmp3 *= JPEG_FIX_1_501321110;
+    z1 = z1 * -JPEG_FIX_0_899976223;
+    z2 = z2 * -JPEG_FIX_2_562915447;
+    z3 = z3 * -JPEG_FIX_1_961570560 + z5;
+    z4 = z4 * -JPEG_FIX_0_390180644 + z5;
+    tmp0 += z1 + z3;
+    tmp1 += z2 + z4;
+    tmp2 += z2 + z3;
+    tmp3 += z1 + z4;
+
+    ws[0]  = JPEG_DESCALE(tmp10 + tmp3, JPEG_CONST_BITS - JPEG_PASS1_BITS);
+    ws[56] = JPEG_DESCALE(tmp10 - tmp3, JPEG_CONST_BITS - JPEG_PASS1_BITS);
+    ws[8]  = JPEG_DESCALE(tmp11 + tmp2, JPEG_CONST_BITS - JPEG_PASS1_BITS);
+    ws[48] = JPEG_DESCALE(tmp11 - tmp2, JPEG_CONST_BITS - JPEG_PASS1_BITS);
+    ws[16] = JPEG_DESCALE(tmp12 + tmp1, JPEG_CONST_BITS - JPEG_PASS1_BITS);
+    ws[40] = JPEG_DESCALE(tmp12 - tmp1, JPEG_CONST_BITS - JPEG_PASS1_BITS);
+    ws[24] = JPEG_DESCALE(tmp13 + tmp0, JPEG_CONST_BITS - JPEG_PASS1_BITS);
+    ws[32] = JPEG_DESCALE(tmp13 - tmp0, JPEG_CONST_BITS - JPEG_PASS1_BITS);
+  }
+
+  // Pass 2: rows, removing the scaling and the level shift
+  for (i = 0, ws = workspace; i < 8; i++, ws += 8, out += stride)
+  {
+    if (!ws[1] && !ws[2] && !ws[3] && !ws[4] && !ws[5] && !ws[6] && !ws[7])
+    {
+      memset(out, jpegClamp(JPEG_DESCALE(ws[0], JPEG_PASS1_BITS + 3) + 128), 8);
+      continue;
+    }
+
+    // Even part
+    z2 = ws[2];
+    z3 = ws[6];
+    z1 = (z2 + z3) * JPEG_FIX_0_541196100;
+    tmp2 = z1 - z3 * JPEG_FIX_1_847759065;
+    tmp3 = z1 + z2 * JPEG_FIX_0_765366865;
+    tmp0 = (ws[0] + ws[4]) << JPEG_CONST_BITS;
+    tmp1 = (ws[0] - ws[4]) << JPEG_CONST_BITS;
+    tmp10 = tmp0 + tmp3;
+    tmp13 = tmp0 - tmp3;
+    tmp11 = tmp1 + tmp2;
+    tmp12 = tmp1 - tmp2;
+
+    // Odd part
+    tmp0 = ws[7];
+    tmp1 = ws[5];
+    tmp2 = ws[3];
+    tmp3 = ws[1];
+    z1 = tmp0 + tmp3;
+    z2 = tmp1 + tmp2;
+    z3 = tmp0 + tmp2;
+    z4 = tmp1 + tmp3;
+    z5 = (z3 + z4) * JPEG_FIX_1_175875602;
+    tmp0 *= JPEG_FIX_0_298631336;
+    tmp1 *= JPEG_FIX_2_053119869;
+    tmp2 *= JPEG_FIX_3_072711026;
+    tmp3 *= JPEG_FIX_1_501321110;
+    z1 = z1 * -JPEG_FIX_0_899976223;
+    z2 = z2 * -JPEG_FIX_2_562915447;
+    z3 = z3 * -JPEG_FIX_1_961570560 + z5;
+    z4 = z4 * -JPEG_FIX_0_390180644 + z5;
+    tmp0 += z1 + z3;
+    tmp1 += z2 + z4;
+    tmp2 += z2 + z3;
+    tmp3 += z1 + z4;
+
+    #define JPEG_OUTPUT(x)  jpegClamp(JPEG_DESCALE((x), JPEG_CONST_BITS + JPEG_PASS1_BITS + 3) + 128)
+    out[0] = JPEG_OUTPUT(tmp10 + tmp3);
+    out[7] = JPEG_OUTPUT(tmp10 - tmp3);
+    out[1] = JPEG_OUTPUT(tmp11 + tmp2);
+    out[6] = JPEG_OUTPUT(tmp11 - tmp2);
+    out[2] = JPEG_OUTPUT(tmp12 + tmp1);
+    out[5] = JPEG_OUTPUT(tmp12 - tmp1);
+    out[3] = JPEG_OUTPUT(tmp13 + tmp0);
+    out[4] = JPEG_OUTPUT(tmp13 - tmp0);
+    #undef JPEG_OUTPUT
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes one block and stores it, scaled down by 1 << shift,
+            in one of the MCU sample planes
+
+    @param[out] out
+                Top-left sample of the (scaled) block in the plane
+    @param[in]  stride
+                Width of the plane in samples
+*/
+/**************************************************************************/
+static jpeg_error_t jpegDecodeScaled(jpeg_component_t *c, uint8_t *out, uint8_t stride, uint8_t shift)
+{
+  jpeg_error_t error;
+  uint8_t      samples[64];
+  uint8_t      size, px, py, sx, sy;
+  uint16_t     sum;
+
+  error = jpegDecodeBlock(c, shift == 3);
+  if (error)
+    return error;
+
+  switch (shift)
+  {
+    case 0:
+      jpegIDCT(out, stride);
+      break;
+    case 3:
+      // The DC coefficient is 8x the average of the block
+      *out = jpegClamp(JPEG_DESCALE((int32_t)jpeg.block[0], 3) + 128);
+      break;
+    default:
+      // Average each (1 << shift) square of the full block
+      jpegIDCT(samples, 8);
+      size = 8 >> shift;
+      for (py = 0; py < size; py++)
+      {
+        for (px = 0; px < size; px++)
+        {
+          sum = 0;
+          for (sy = 0; sy < (1 << shift); sy++)
+            for (sx = 0; sx < (1 << shift); sx++)
+              sum += samples[((py << shift) + sy) * 8 + (px << shift) + sx];
+          out[py * stride + px] = (sum + (1 << (2 * shift - 1))) >> (2 * shift);
+        }
+      }
+      break;
+  }
+
+  return JPEG_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Skips to the RSTn marker expected after every restart
+            interval and resets the DC predictions
+*/
+/**************************************************************************/
+static jpeg_error_t jpegRestart(void)
+{
+  uint8_t i;
+
+  // Drop the padding bits and look for the marker if the bit reader
+  // hasn't already run into it
+  jpeg.bits = 0;
+  jpeg.bitCount = 0;
+  while (!jpeg.marker && !jpeg.eof)
+  {
+    if (jpegReadByte() != 0xFF)
+      continue;
+    do
+    {
+      i = jpegReadByte();
+    } while ((i == 0xFF) && !jpeg.eof);
+    if (i)
+      jpeg.marker = i;
+  }
+
+  if (jpeg.eof)
+    return JPEG_ERROR_PREMATUREEOF;
+  if ((jpeg.marker < JPEG_MARKER_RST0) || (jpeg.marker > JPEG_MARKER_RST7))
+    return JPEG_ERROR_INVALIDDATA;
+
+  jpeg.marker = 0;
+  for (i = 0; i < jpeg.components; i++)
+    jpeg.component[i].dcpred = 0;
+
+  return JPEG_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts the samples of one MCU to RGB565 and sends the
+            visible part to the LCD
+
+    @param[in]  x, y
+                Top-left corner of the MCU on the LCD
+    @param[in]  width, height
+                Visible size of the MCU in pixels
+    @param[in]  stride
+                Width of the luma plane (scaled MCU width)
+*/
+/**************************************************************************/
+static void jpegDrawMCU(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t stride)
+{
+  uint16_t buffer[16];
+  uint32_t count;
+  uint16_t px, py;
+  uint8_t  hshift, vshift;
+  const uint8_t *yp, *cb, *cr;
+  int32_t  luma, r, g, b;
+
+  hshift = jpeg.component[0].h - 1;
+  vshift = jpeg.component[0].v - 1;
+
+  lcdSetWindow(x, y, x + width - 1, y + height - 1);
+
+  count = 0;
+  for (py = 0; py < height; py++)
+  {
+    yp = &jpeg.y[py * stride];
+    cb = &jpeg.cb[(py >> vshift) * (stride >> hshift)];
+    cr = &jpeg.cr[(py >> vshift) * (stride >> hshift)];
+    for (px = 0; px < width; px++)
+    {
+      if (jpeg.components == 1)
+      {
+        r = g = b = yp[px];
+      }
+      else
+      {
+        // YCbCr to RGB (JFIF) in 16.16 fixed point
+        luma = (yp[px] << 16) + 32768;
+        r = cr[px >> hshift] - 128;
+        b = cb[px >> hshift] - 128;
+        g = (luma - 22554 * b - 46802 * r) >> 16;
+        r = (luma + 91881 * r) >> 16;
+        b = (luma + 116130 * b) >> 16;
+        r = jpegClamp(r);
+        g = jpegClamp(g);
+        b = jpegClamp(b);
+      }
+      buffer[count++] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+      if (count == 16)
+      {
+        lcdStreamPixels(buffer, count);
+        count = 0;
+      }
+    }
+  }
+  if (count)
+  {
+    lcdStreamPixels(buffer, count);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes the scan MCU by MCU and renders the visible ones
+*/
+/**************************************************************************/
+static jpeg_error_t jpegDecodeScan(uint16_t x, uint16_t y, uint8_t shift)
+{
+  jpeg_component_t *c;
+  jpeg_error_t error;
+  uint32_t mcusX, mcusY, mcuX, mcuY, mcuCount, left, top;
+  uint32_t imageWidth, imageHeight, width, height;
+  uint8_t  mcuWidth, mcuHeight, blockSize, bx, by, i;
+
+  blockSize = 8 >> shift;
+  mcuWidth = jpeg.component[0].h * 8;
+  mcuHeight = jpeg.component[0].v * 8;
+  mcusX = (jpeg.width + mcuWidth - 1) / mcuWidth;
+  mcusY = (jpeg.height + mcuHeight - 1) / mcuHeight;
+  imageWidth = (jpeg.width + (1 << shift) - 1) >> shift;
+  imageHeight = (jpeg.height + (1 << shift) - 1) >> shift;
+  mcuWidth >>= shift;
+  mcuHeight >>= shift;
+
+  for (i = 0; i < jpeg.components; i++)
+    jpeg.component[i].dcpred = 0;
+  jpeg.bits = 0;
+  jpeg.bitCount = 0;
+  jpeg.marker = 0;
+
+  mcuCount = 0;
+  for (mcuY = 0; mcuY < mcusY; mcuY++)
+  {
+    top = y + mcuY * mcuHeight;
+    if (top >= lcdGetHeight())
+    {
+      // Nothing else will be visible
+      break;
+    }
+    height = imageHeight - mcuY * mcuHeight;
+    if (height > mcuHeight) height = mcuHeight;
+    if (height > lcdGetHeight() - top) height = lcdGetHeight() - top;
+
+    for (mcuX = 0; mcuX < mcusX; mcuX++, mcuCount++)
+    {
+      if (jpeg.restartInterval && mcuCount && !(mcuCount % jpeg.restartInterval))
+      {
+        error = jpegRestart();
+        if (error)
+          return error;
+      }
+
+      // Luma blocks, then one block of each chroma component
+      c = &jpeg.component[0];
+      for (by = 0; by < c->v; by++)
+      {
+        for (bx = 0; bx < c->h; bx++)
+        {
+          error = jpegDecodeScaled(c, &jpeg.y[by * blockSize * mcuWidth + bx * blockSize], mcuWidth, shift);
+          if (error)
+            return error;
+        }
+      }
+      if (jpeg.components == 3)
+      {
+        if ((error = jpegDecodeScaled(&jpeg.component[1], jpeg.cb, blockSize, shift)) ||
+            (error = jpegDecodeScaled(&jpeg.component[2], jpeg.cr, blockSize, shift)))
+          return error;
+      }
+      if (jpeg.eof)
+        return JPEG_ERROR_PREMATUREEOF;
+
+      // Clip the MCU to the image and the screen
+      left = x + mcuX * mcuWidth;
+      if (left >= lcdGetWidth())
+        continue;
+      width = imageWidth - mcuX * mcuWidth;
+      if (width > mcuWidth) width = mcuWidth;
+      if (width > lcdGetWidth() - left) width = lcdGetWidth() - left;
+
+      jpegDrawMCU(left, top, width, height, mcuWidth);
+    }
+  }
+
+  return JPEG_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Loads a baseline JPEG image (see jpeg.h) from the SD card
+            and renders it
+
+    @param[in]  x
+                Left edge of the image on the LCD
+    @param[in]  y
+                Top edge of the image on the LCD
+    @param[in]  filename
+                Full path of the image file
+    @param[in]  scale
+                1 for full size, or 2, 4 or 8 to scale the image down
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/jpeg.h"
+
+    jpeg_error_t error;
+
+    // Show a thumbnail of photo.jpg (from the root folder) at 10,10
+    error = jpegDrawImage(10, 10, "/photo.jpg", 8);
+
+    // Check 'error' for problems such as JPEG_ERROR_UNSUPPORTED
+
+    @endcode
+*/
+/**************************************************************************/
+jpeg_error_t jpegDrawImage(uint16_t x, uint16_t y, const char* filename, uint8_t scale)
+{
+  jpeg_error_t error;
+  FIL imgfile;
+  uint8_t shift;
+
+  switch (scale)
+  {
+    case 1: shift = 0; break;
+    case 2: shift = 1; break;
+    case 4: shift = 2; break;
+    case 8: shift = 3; break;
+    default:
+      return JPEG_ERROR_INVALIDSCALE;
+  }
+
+  // Initialise the card if needed and mount the drive
+  if (ffSyncMount() != FR_OK) 
+  {
+    // Card not initialised or no disk present
+    return JPEG_ERROR_SDINITFAIL;
+  }
+
+  // Try to open the requested file
+  if (f_open(&imgfile, filename, FA_READ | FA_OPEN_EXISTING) != FR_OK) 
+  {  
+    ffSyncUnmount();
+    return JPEG_ERROR_FILENOTFOUND;
+  }
+
+  // Parse the headers and decode the image
+  memset(&jpeg, 0, sizeof(jpeg));
+  jpeg.file = &imgfile;
+  error = jpegParseHeaders();
+  if (!error)
+    error = jpegDecodeScan(x, y, shift);
+
+  // Running out of data usually shows up as an invalid code first
+  if (error && jpeg.eof)
+    error = JPEG_ERROR_PREMATUREEOF;
+
+  // Close file and unmount drive
+  f_close(&imgfile);
+  ffSyncUnmount();
+
+  return error;
+}
+
+#endif
@@ -0,0 +1,87 @@
+/**************************************************************************/
+/*! 
+    @file     jpeg.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __JPEG_H__
+#define __JPEG_H__
+
+#include "projectconfig.h"
+
+/**************************************************************************
+    Baseline JPEG Decoder
+    -----------------------------------------------------------------------
+    JPEG images are decoded one MCU (minimum coded unit) at a time and
+    each MCU is sent straight to the LCD through a window, so the whole
+    decoder only needs about 2.5KB of SRAM no matter how large the image
+    is.  The following subset of the standard is supported, which covers
+    the files written by most cameras and image editors:
+
+    - Baseline and extended sequential (SOF0/SOF1) Huffman coding with
+      8-bit samples.  Progressive and arithmetic coded files are
+      rejected with JPEG_ERROR_UNSUPPORTED.
+    - Greyscale images, or YCbCr with the luma sampled at 1x1, 2x1, 1x2
+      or 2x2 (4:4:4, 4:2:2, 4:4:0 and 4:2:0) and the chroma at 1x1.
+    - Restart intervals (DRI/RSTn markers).
+
+    Images can be scaled down by 2, 4 or 8 while decoding.  At 1/8 only
+    the DC coefficient of every block is used, which skips the IDCT
+    entirely and makes it the fastest way to show a preview.
+
+    Images larger than the LCD are clipped, and decoding stops as soon
+    as the bottom edge of the screen is reached.
+
+ **************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Error return codes when decoding JPEG images
+*/
+/**************************************************************************/
+typedef enum
+{
+  JPEG_ERROR_NONE = 0,
+  JPEG_ERROR_SDINITFAIL = 1,
+  JPEG_ERROR_FILENOTFOUND = 2,
+  JPEG_ERROR_NOTAJPEG = 10,             /* Missing SOI marker */
+  JPEG_ERROR_UNSUPPORTED = 11,          /* Progressive, 12-bit, unusual sampling, etc. */
+  JPEG_ERROR_INVALIDSCALE = 12,         /* Scale isn't 1, 2, 4 or 8 */
+  JPEG_ERROR_PREMATUREEOF = 13,         /* EOF reached unexpectedly in the image */
+  JPEG_ERROR_INVALIDDATA = 14           /* Corrupt headers or entropy coded data */
+} jpeg_error_t;
+
+#if defined CFG_SDCARD && defined CFG_TFTLCD_JPEG && CFG_TFTLCD_JPEG == 1
+jpeg_error_t jpegDrawImage(uint16_t x, uint16_t y, const char* filename, uint8_t scale);
+#endif
+
+#endif
@@ -61,16 +61,53 @@ typedef struct
   bool     hwscrolling;   // Whether the LCD support HW scrolling
 } lcdProperties_t;
 
+// Bus traffic counters kept by the HW driver when CFG_TFTLCD_STATS is 1.
+// 'dataWritten' and 'dataRead' are bus transfers, which are 16-bit words
+// on the ILI9325/ILI9328/ST7783 and bytes on the ST7735.
+typedef struct
+{
+  uint32_t commands;      // Register index/command writes
+  uint32_t cursorSets;    // GRAM address (or address window) updates
+  uint32_t dataWritten;   // Data transfers to the panel, pixels included
+  uint32_t dataRead;      // Data transfers read back from the panel
+} lcdStats_t;
+
+#if defined CFG_TFTLCD_STATS && CFG_TFTLCD_STATS == 1
+  extern lcdStats_t lcdStats;
+  #define LCD_STATS_ADD(counter, n)   lcdStats.counter += (n)
+#else
+  #define LCD_STATS_ADD(counter, n)
+#endif
+
+// Reports the area covered by a write to the remote display (lcdremote.c)
+// when CFG_TFTLCD_REMOTE is 1.  LCD_DAMAGE takes inclusive co-ordinates,
+// LCD_DAMAGE_RUN a run of pixels that wraps to the next line like GRAM.
+#if defined CFG_TFTLCD_REMOTE && CFG_TFTLCD_REMOTE == 1
+  extern void lcdRemoteDamage(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+  extern void lcdRemoteDamageRun(uint16_t x, uint16_t y, uint32_t len);
+  #define LCD_DAMAGE(x0, y0, x1, y1)    lcdRemoteDamage(x0, y0, x1, y1)
+  #define LCD_DAMAGE_RUN(x, y, len)     lcdRemoteDamageRun(x, y, len)
+#else
+  #define LCD_DAMAGE(x0, y0, x1, y1)
+  #define LCD_DAMAGE_RUN(x, y, len)
+#endif
+
 extern void     lcdInit(void);
 extern void     lcdTest(void);
 extern uint16_t lcdGetPixel(uint16_t x, uint16_t y);
+extern void     lcdReadPixels(uint16_t x, uint16_t y, uint16_t *buf, uint32_t len);
 extern void     lcdFillRGB(uint16_t data);
 extern void     lcdDrawPixel(uint16_t x, uint16_t y, uint16_t color);
 extern void     lcdDrawPixels(uint16_t x, uint16_t y, uint16_t *data, uint32_t len);
 extern void     lcdDrawHLine(uint16_t x0, uint16_t x1, uint16_t y, uint16_t color);
 extern void     lcdDrawVLine(uint16_t x, uint16_t y0, uint16_t y1, uint16_t color);
+extern void     lcdSetWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+extern void     lcdStreamPixels(uint16_t *data, uint32_t len);
+extern void     lcdStreamFill(uint16_t color, uint32_t len);
 extern void     lcdBacklight(bool state);
 extern void     lcdScroll(int16_t pixels, uint16_t fillColor);
+extern void     lcdScrollRegion(uint16_t y0, uint16_t y1, int16_t pixels, uint16_t fillColor);
+extern bool     lcdSetScrollOffset(uint16_t y0, uint16_t y1, uint16_t offset);
 extern uint16_t lcdGetWidth(void);
 extern uint16_t lcdGetHeight(void);
 extern void     lcdSetOrientation(lcdOrientation_t orientation);
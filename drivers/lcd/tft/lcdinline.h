@@ -0,0 +1,86 @@
+/**************************************************************************/
+/*! 
+    @file     lcdinline.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Compile-time binding of the low-level LCD primitives used in tight
+    drawing loops.
+
+    With CFG_TFTLCD_INLINE set to 1 the functions below are static
+    inline wrappers around the ILI9328 bus writes, so drawPixel and
+    friends don't pay a call per pixel and the orientation and window
+    checks can be hoisted out of loops by the compiler.  Otherwise they
+    fall back to the regular out-of-line lcd.h API, which works with any
+    driver selected in the Makefile.
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __LCDINLINE_H__
+#define __LCDINLINE_H__
+
+#include "projectconfig.h"
+#include "lcd.h"
+
+#if defined CFG_TFTLCD_INLINE && CFG_TFTLCD_INLINE == 1
+  // Only the ILI9328 has inline primitives, ILI9328.o must be the driver
+  // selected in the Makefile
+  #include "drivers/lcd/tft/hw/ILI9328.h"
+
+  static inline uint16_t lcdInlineGetWidth(void)
+  {
+    return ili9328Orientation == LCD_ORIENTATION_PORTRAIT ? ILI9328_WIDTH : ILI9328_HEIGHT;
+  }
+
+  static inline uint16_t lcdInlineGetHeight(void)
+  {
+    return ili9328Orientation == LCD_ORIENTATION_PORTRAIT ? ILI9328_HEIGHT : ILI9328_WIDTH;
+  }
+
+  static inline void lcdInlineDrawPixel(uint16_t x, uint16_t y, uint16_t color)
+  {
+    LCD_DAMAGE(x, y, x, y);
+    if (ili9328WindowActive)
+    {
+      ili9328ReleaseWindow();
+    }
+    ili9328SetCursorInline(x, y);
+    ili9328WriteCmdInline(ILI9328_COMMANDS_WRITEDATATOGRAM);
+    ili9328WriteDataInline(color);
+  }
+#else
+  #define lcdInlineGetWidth()               lcdGetWidth()
+  #define lcdInlineGetHeight()              lcdGetHeight()
+  #define lcdInlineDrawPixel(x, y, color)   lcdDrawPixel(x, y, color)
+#endif
+
+#endif
@@ -0,0 +1,603 @@
+/**************************************************************************/
+/*! 
+    @file     lcdremote.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Streams the contents of the TFT LCD to a host over USB
+
+    @section DESCRIPTION
+
+    Remote display mode for support and debugging, as a live alternative
+    to saving screenshots to the SD card with bmpSaveScreenshot.
+
+    While the mode is active the LCD driver reports the area covered by
+    every write (lcdDrawPixel, lcdDrawHLine, lcdSetWindow, etc.) through
+    LCD_DAMAGE in lcd.h, and the areas are merged into a short list of
+    damaged rectangles.  lcdRemotePoll reads the damaged rectangles
+    back from GRAM and sends them RLE compressed over the vendor bulk
+    endpoint (CFG_USBCDC_VENDORBULK), one buffer being filled while the
+    other is on the bus, so an idle screen costs nothing and the
+    traffic follows the amount of the screen that changed.  Nothing is
+    kept in SRAM but the damage list and the two transmit buffers,
+    since a copy of the screen wouldn't fit.
+
+    The host viewer ('tools/lcdview') asks for a full refresh by
+    sending any data on the OUT endpoint, which also resynchronises
+    it after it was started in the middle of a stream.  The viewer
+    shows the GRAM contents, so the hardware scrolling of lcdScroll
+    and lcdSetScrollOffset isn't mirrored.  Only the ILI9325 and
+    ILI9328 drivers report damage.
+
+    lcdRemotePoll runs from a scheduler task with CFG_SCHEDULER, and
+    from the main loop otherwise.
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/lcdremote.h"
+
+    lcdRemoteStart();
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "lcdremote.h"
+
+#if defined CFG_TFTLCD_REMOTE && CFG_TFTLCD_REMOTE == 1
+
+#include "lcd.h"
+#include "core/usbcdc/usbvendor.h"
+
+#ifdef CFG_SCHEDULER
+  #include "core/sched/sched.h"
+#endif
+
+#define LCDREMOTE_PIXELSHEADER  (11)    /* Size of a PIXELS message header */
+#define LCDREMOTE_CHUNK         (32)    /* Pixels read from GRAM at a time */
+#define LCDREMOTE_MAXCOUNT      (0xFFFF - LCDREMOTE_CHUNK)
+
+typedef struct
+{
+  uint16_t x0, y0, x1, y1;              /* Inclusive screen co-ordinates */
+} lcdRemoteRect_t;
+
+/* RLE encoder state for the message being written */
+typedef struct
+{
+  uint8_t  *buffer;
+  uint16_t len;                         /* Bytes used in buffer */
+  uint16_t literal;                     /* Offset of the open literal token */
+  uint8_t  literalCount;                /* Pixels in it, 0 when none is open */
+  uint8_t  repeatCount;                 /* Pending copies of repeatColor */
+  uint16_t repeatColor;
+} lcdRemoteRle_t;
+
+static bool _lcdRemoteActive = false;
+
+static lcdRemoteRect_t _lcdRemoteDamage[LCDREMOTE_MAXDAMAGE];
+static uint8_t _lcdRemoteDamageCount = 0;
+
+/* Rectangle being sent, and the next pixel of it */
+static lcdRemoteRect_t _lcdRemoteRect;
+static bool _lcdRemoteSending = false;
+static uint16_t _lcdRemoteX, _lcdRemoteY;
+
+/* Screen size last sent to the host, 0 forces a SCREEN message */
+static uint16_t _lcdRemoteWidth = 0;
+static uint16_t _lcdRemoteHeight = 0;
+
+static uint8_t _lcdRemoteBuffer[2][LCDREMOTE_BUFFERSIZE];
+static uint16_t _lcdRemoteQueued[2];    /* Bytes waiting in each buffer */
+static uint8_t _lcdRemoteFill = 0;      /* Next buffer to encode into */
+static uint8_t _lcdRemoteSend = 0;      /* Next buffer to send */
+static bool _lcdRemoteInFlight = false; /* _lcdRemoteSend is on the bus */
+
+/* Refresh requests from the host */
+static uint8_t _lcdRemoteRequest[4];
+static volatile bool _lcdRemoteRefresh = false;
+
+#ifdef CFG_SCHEDULER
+static schedTask_t _lcdRemoteTask;
+static bool _lcdRemoteTaskReady = false;
+
+static void lcdRemoteTask(schedTask_t *task)
+{
+  lcdRemotePoll();
+}
+#endif
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Checks whether two rectangles overlap or touch
+*/
+/**************************************************************************/
+static bool lcdRemoteRectTouches(const lcdRemoteRect_t *a, const lcdRemoteRect_t *b)
+{
+  return (a->x0 <= b->x1 + 1) && (b->x0 <= a->x1 + 1) && (a->y0 <= b->y1 + 1) && (b->y0 <= a->y1 + 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Grows 'a' to include 'b'
+*/
+/**************************************************************************/
+static void lcdRemoteRectUnion(lcdRemoteRect_t *a, const lcdRemoteRect_t *b)
+{
+  if (b->x0 < a->x0) a->x0 = b->x0;
+  if (b->y0 < a->y0) a->y0 = b->y0;
+  if (b->x1 > a->x1) a->x1 = b->x1;
+  if (b->y1 > a->y1) a->y1 = b->y1;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the number of pixels in the union of 'a' and 'b'
+*/
+/**************************************************************************/
+static uint32_t lcdRemoteRectUnionArea(const lcdRemoteRect_t *a, const lcdRemoteRect_t *b)
+{
+  lcdRemoteRect_t u = *a;
+  lcdRemoteRectUnion(&u, b);
+  return (uint32_t)(u.x1 - u.x0 + 1) * (u.y1 - u.y0 + 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Adds a rectangle to the damage list, merging it with the
+            regions it overlaps or touches
+*/
+/**************************************************************************/
+static void lcdRemoteAddDamage(lcdRemoteRect_t rect)
+{
+  uint32_t area, best;
+  uint8_t i, merge;
+
+  // Absorb any regions that touch the new one (which may in turn
+  // make it touch regions that were checked earlier)
+  i = 0;
+  while (i < _lcdRemoteDamageCount)
+  {
+    if (lcdRemoteRectTouches(&rect, &_lcdRemoteDamage[i]))
+    {
+      lcdRemoteRectUnion(&rect, &_lcdRemoteDamage[i]);
+      _lcdRemoteDamage[i] = _lcdRemoteDamage[--_lcdRemoteDamageCount];
+      i = 0;
+      continue;
+    }
+    i++;
+  }
+
+  if (_lcdRemoteDamageCount < LCDREMOTE_MAXDAMAGE)
+  {
+    _lcdRemoteDamage[_lcdRemoteDamageCount++] = rect;
+    return;
+  }
+
+  // No room left, merge with the region that grows the least
+  merge = 0;
+  best = 0xFFFFFFFF;
+  for (i = 0; i < _lcdRemoteDamageCount; i++)
+  {
+    area = lcdRemoteRectUnionArea(&_lcdRemoteDamage[i], &rect);
+    if (area < best)
+    {
+      best = area;
+      merge = i;
+    }
+  }
+  lcdRemoteRectUnion(&rect, &_lcdRemoteDamage[merge]);
+  _lcdRemoteDamage[merge] = _lcdRemoteDamage[--_lcdRemoteDamageCount];
+  lcdRemoteAddDamage(rect);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Appends a 16-bit little-endian value to a buffer
+*/
+/**************************************************************************/
+static void lcdRemotePut16(uint8_t *buffer, uint16_t value)
+{
+  buffer[0] = value & 0xFF;
+  buffer[1] = value >> 8;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes out the pending repeat, as a repeat token or as part
+            of a literal run when the color only occurred once (adds
+            at most 3 bytes)
+*/
+/**************************************************************************/
+static void lcdRemoteRleFlush(lcdRemoteRle_t *rle)
+{
+  if (rle->repeatCount == 1)
+  {
+    if ((rle->literalCount == 0) || (rle->literalCount == 128))
+    {
+      rle->literal = rle->len++;
+      rle->literalCount = 0;
+    }
+    lcdRemotePut16(&rle->buffer[rle->len], rle->repeatColor);
+    rle->len += 2;
+    rle->buffer[rle->literal] = rle->literalCount++;
+  }
+  else if (rle->repeatCount > 1)
+  {
+    rle->literalCount = 0;
+    rle->buffer[rle->len++] = LCDREMOTE_RLE_REPEAT | (rle->repeatCount - 1);
+    lcdRemotePut16(&rle->buffer[rle->len], rle->repeatColor);
+    rle->len += 2;
+  }
+  rle->repeatCount = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Adds one pixel to the RLE stream
+*/
+/**************************************************************************/
+static void lcdRemoteRlePush(lcdRemoteRle_t *rle, uint16_t color)
+{
+  if (rle->repeatCount && (color == rle->repeatColor) && (rle->repeatCount < 128))
+  {
+    rle->repeatCount++;
+    return;
+  }
+  lcdRemoteRleFlush(rle);
+  rle->repeatColor = color;
+  rle->repeatCount = 1;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Fills a transmit buffer with the next messages
+
+    @return The number of bytes written, 0 if there is nothing to send
+*/
+/**************************************************************************/
+static uint16_t lcdRemoteEncode(uint8_t *buffer)
+{
+  uint16_t pixels[LCDREMOTE_CHUNK];
+  lcdRemoteRle_t rle;
+  uint16_t width, height, len, count, chunk, room, i;
+
+  len = 0;
+
+  // A new screen size (or a refresh) restarts the stream
+  width = lcdGetWidth();
+  height = lcdGetHeight();
+  if ((width != _lcdRemoteWidth) || (height != _lcdRemoteHeight))
+  {
+    buffer[0] = LCDREMOTE_MSG_SCREEN;
+    buffer[1] = 'L';
+    buffer[2] = 'C';
+    buffer[3] = 'D';
+    lcdRemotePut16(&buffer[4], width);
+    lcdRemotePut16(&buffer[6], height);
+    len = 8;
+    _lcdRemoteWidth = width;
+    _lcdRemoteHeight = height;
+    _lcdRemoteSending = false;
+    _lcdRemoteDamage[0].x0 = 0;
+    _lcdRemoteDamage[0].y0 = 0;
+    _lcdRemoteDamage[0].x1 = width - 1;
+    _lcdRemoteDamage[0].y1 = height - 1;
+    _lcdRemoteDamageCount = 1;
+  }
+
+  // Room for a header and at least one pixel
+  while (len + LCDREMOTE_PIXELSHEADER + 6 <= LCDREMOTE_BUFFERSIZE)
+  {
+    if (!_lcdRemoteSending)
+    {
+      if (!_lcdRemoteDamageCount)
+      {
+        break;
+      }
+      _lcdRemoteRect = _lcdRemoteDamage[--_lcdRemoteDamageCount];
+      _lcdRemoteX = _lcdRemoteRect.x0;
+      _lcdRemoteY = _lcdRemoteRect.y0;
+      _lcdRemoteSending = true;
+    }
+
+    buffer[len] = LCDREMOTE_MSG_PIXELS;
+    lcdRemotePut16(&buffer[len + 1], _lcdRemoteRect.x0);
+    lcdRemotePut16(&buffer[len + 3], _lcdRemoteRect.x1 - _lcdRemoteRect.x0 + 1);
+    lcdRemotePut16(&buffer[len + 5], _lcdRemoteX);
+    lcdRemotePut16(&buffer[len + 7], _lcdRemoteY);
+
+    memset(&rle, 0, sizeof(rle));
+    rle.buffer = buffer;
+    rle.len = len + LCDREMOTE_PIXELSHEADER;
+    count = 0;
+
+    // n more pixels add at most 3 * (n + 1) bytes, the pending repeat
+    // included
+    while (_lcdRemoteSending && (count < LCDREMOTE_MAXCOUNT))
+    {
+      room = LCDREMOTE_BUFFERSIZE - rle.len;
+      if (room < 6)
+      {
+        break;
+      }
+      chunk = room / 3 - 1;
+      if (chunk > LCDREMOTE_CHUNK)
+      {
+        chunk = LCDREMOTE_CHUNK;
+      }
+      if (chunk > _lcdRemoteRect.x1 - _lcdRemoteX + 1)
+      {
+        chunk = _lcdRemoteRect.x1 - _lcdRemoteX + 1;
+      }
+
+      lcdReadPixels(_lcdRemoteX, _lcdRemoteY, pixels, chunk);
+      for (i = 0; i < chunk; i++)
+      {
+        lcdRemoteRlePush(&rle, pixels[i]);
+      }
+      count += chunk;
+
+      _lcdRemoteX += chunk;
+      if (_lcdRemoteX > _lcdRemoteRect.x1)
+      {
+        _lcdRemoteX = _lcdRemoteRect.x0;
+        if (_lcdRemoteY == _lcdRemoteRect.y1)
+        {
+          _lcdRemoteSending = false;
+        }
+        else
+        {
+          _lcdRemoteY++;
+        }
+      }
+    }
+
+    lcdRemoteRleFlush(&rle);
+    lcdRemotePut16(&buffer[len + 9], count);
+    len = rle.len;
+  }
+
+  return len;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Called from the USB interrupt when the host asks for a
+            full refresh
+*/
+/**************************************************************************/
+static void lcdRemoteRequested(uint8_t *buffer, uint32_t length)
+{
+  _lcdRemoteRefresh = true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts sending the next buffer if the endpoint is free
+*/
+/**************************************************************************/
+static void lcdRemoteKick(void)
+{
+  // The buffer on the bus is free again once the transfer has ended
+  // (or was dropped by a USB reset)
+  if (_lcdRemoteInFlight && !usbVendorSendBusy())
+  {
+    _lcdRemoteInFlight = false;
+    _lcdRemoteQueued[_lcdRemoteSend] = 0;
+    _lcdRemoteSend ^= 1;
+  }
+
+  if (!_lcdRemoteInFlight && _lcdRemoteQueued[_lcdRemoteSend])
+  {
+    if (usbVendorSend(_lcdRemoteBuffer[_lcdRemoteSend], _lcdRemoteQueued[_lcdRemoteSend], NULL))
+    {
+      _lcdRemoteInFlight = true;
+    }
+  }
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Starts the remote display, beginning with the whole screen
+*/
+/**************************************************************************/
+void lcdRemoteStart(void)
+{
+  _lcdRemoteDamageCount = 0;
+  _lcdRemoteSending = false;
+  _lcdRemoteWidth = _lcdRemoteHeight = 0;
+  _lcdRemoteActive = true;
+
+  #ifdef CFG_SCHEDULER
+    if (!_lcdRemoteTaskReady)
+    {
+      schedTaskInit(&_lcdRemoteTask, lcdRemoteTask, NULL);
+      _lcdRemoteTaskReady = true;
+    }
+    schedStartTimer(&_lcdRemoteTask, 0, LCDREMOTE_POLLMS);
+  #endif
+}
+
+/**************************************************************************/
+/*!
+    @brief  Stops tracking damage and sending updates (data already
+            queued is still sent)
+*/
+/**************************************************************************/
+void lcdRemoteStop(void)
+{
+  _lcdRemoteActive = false;
+  _lcdRemoteDamageCount = 0;
+  _lcdRemoteSending = false;
+
+  #ifdef CFG_SCHEDULER
+    if (_lcdRemoteTaskReady)
+    {
+      schedStopTimer(&_lcdRemoteTask);
+    }
+  #endif
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns true while the remote display is running
+*/
+/**************************************************************************/
+bool lcdRemoteIsActive(void)
+{
+  return _lcdRemoteActive;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sends whatever changed since the last call, as far as the
+            two transmit buffers allow
+*/
+/**************************************************************************/
+void lcdRemotePoll(void)
+{
+  uint16_t len;
+
+  if (!_lcdRemoteActive)
+  {
+    return;
+  }
+
+  // Listen for refresh requests from the viewer
+  if (_lcdRemoteRefresh)
+  {
+    _lcdRemoteRefresh = false;
+    _lcdRemoteWidth = _lcdRemoteHeight = 0;
+  }
+  if (!usbVendorReceiveBusy())
+  {
+    usbVendorReceive(_lcdRemoteRequest, sizeof(_lcdRemoteRequest), lcdRemoteRequested);
+  }
+
+  lcdRemoteKick();
+
+  // Encode into the free buffer while the other one is being sent
+  if (!_lcdRemoteQueued[_lcdRemoteFill])
+  {
+    len = lcdRemoteEncode(_lcdRemoteBuffer[_lcdRemoteFill]);
+    if (len)
+    {
+      _lcdRemoteQueued[_lcdRemoteFill] = len;
+      _lcdRemoteFill ^= 1;
+      lcdRemoteKick();
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Marks a rectangle of the screen as changed (called by the
+            LCD driver through LCD_DAMAGE)
+*/
+/**************************************************************************/
+void lcdRemoteDamage(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+  lcdRemoteRect_t rect;
+  uint16_t width, height;
+  uint8_t i;
+
+  if (!_lcdRemoteActive)
+  {
+    return;
+  }
+
+  width = lcdGetWidth();
+  height = lcdGetHeight();
+  if (x1 < x0) { rect.x0 = x1; rect.x1 = x0; } else { rect.x0 = x0; rect.x1 = x1; }
+  if (y1 < y0) { rect.y0 = y1; rect.y1 = y0; } else { rect.y0 = y0; rect.y1 = y1; }
+  if ((rect.x0 >= width) || (rect.y0 >= height))
+  {
+    return;
+  }
+  if (rect.x1 >= width) rect.x1 = width - 1;
+  if (rect.y1 >= height) rect.y1 = height - 1;
+
+  // Most writes are pixels or lines inside an area that is already damaged
+  for (i = 0; i < _lcdRemoteDamageCount; i++)
+  {
+    if ((rect.x0 >= _lcdRemoteDamage[i].x0) && (rect.x1 <= _lcdRemoteDamage[i].x1) &&
+        (rect.y0 >= _lcdRemoteDamage[i].y0) && (rect.y1 <= _lcdRemoteDamage[i].y1))
+    {
+      return;
+    }
+  }
+
+  lcdRemoteAddDamage(rect);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Marks a run of 'len' pixels written from x, y onwards as
+            changed, wrapping to the following lines like GRAM does
+*/
+/**************************************************************************/
+void lcdRemoteDamageRun(uint16_t x, uint16_t y, uint32_t len)
+{
+  uint16_t width;
+
+  if (!_lcdRemoteActive || !len)
+  {
+    return;
+  }
+
+  width = lcdGetWidth();
+  if (x + len <= width)
+  {
+    lcdRemoteDamage(x, y, x + len - 1, y);
+  }
+  else
+  {
+    lcdRemoteDamage(0, y, width - 1, y + (x + len - 1) / width);
+  }
+}
+
+#endif
@@ -0,0 +1,79 @@
+/**************************************************************************/
+/*! 
+    @file     lcdremote.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __LCDREMOTE_H__
+#define __LCDREMOTE_H__
+
+#include "projectconfig.h"
+
+#if defined CFG_TFTLCD_REMOTE && CFG_TFTLCD_REMOTE == 1
+
+/* Number of separate damaged regions tracked while the host catches up */
+#define LCDREMOTE_MAXDAMAGE     (8)
+
+/* Size of each of the two transmit buffers (one is filled while the
+   other is being sent) */
+#define LCDREMOTE_BUFFERSIZE    (256)
+
+/* Poll period when running from the scheduler */
+#define LCDREMOTE_POLLMS        (10)
+
+/* Stream messages, all values are little-endian.
+
+   SCREEN  0x01 'L' 'C' 'D' <width:16> <height:16>
+           Starts a new stream: the host resizes its copy of the screen
+           and waits for the full screen that follows.
+
+   PIXELS  0x02 <left:16> <width:16> <x:16> <y:16> <count:16> <rle...>
+           'count' pixels of a rectangle that is 'width' pixels wide and
+           starts at column 'left', beginning at x, y and going left to
+           right and top to bottom.  The pixels are RLE compressed into
+           tokens: 0x80 | (n - 1) followed by one RGB565 pixel repeats
+           that pixel n times, and n - 1 followed by n RGB565 pixels
+           is a literal run (n = 1..128 in both cases). */
+#define LCDREMOTE_MSG_SCREEN    (0x01)
+#define LCDREMOTE_MSG_PIXELS    (0x02)
+#define LCDREMOTE_RLE_REPEAT    (0x80)
+
+void lcdRemoteStart     ( void );
+void lcdRemoteStop      ( void );
+bool lcdRemoteIsActive  ( void );
+void lcdRemotePoll      ( void );
+void lcdRemoteDamage    ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1 );
+void lcdRemoteDamageRun ( uint16_t x, uint16_t y, uint32_t len );
+
+#endif
+
+#endif
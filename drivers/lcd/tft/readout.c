@@ -0,0 +1,374 @@
+/**************************************************************************/
+/*! 
+    @file     readout.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Fixed-width numeric readouts that only redraw the digits
+              that changed
+
+    @section DESCRIPTION
+
+    A readout is a row of equally sized character cells.  The text on
+    screen is remembered, so when a new value is set only the cells
+    whose character changed are painted, and a value that didn't change
+    costs nothing but a string comparison.  Values are right-aligned,
+    and a value that doesn't fit is shown as a row of '-'.
+
+    The digits '0' to '9' of the font are expanded once into a
+    caller-supplied RGB565 buffer by readoutFontInit, centered in a
+    cell as wide as the widest digit, so every digit is sent to the LCD
+    as a single windowed burst straight from RAM with no glyph decoding.
+    Any number of readouts can share the same readoutFont_t.  Other
+    characters ('-', '.', '%', ...) are drawn over a cleared cell with
+    drawString.
+
+    Readouts are drawn straight to the LCD, so they shouldn't be
+    updated between drawTileBegin and drawTileEnd.
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/readout.h"
+    #include "drivers/lcd/tft/fonts/dejavusans9.h"
+
+    // Digits in DejaVu Sans 9pt are 6 pixels wide and 2 pages high
+    static uint16_t glyphBuffer[READOUT_BUFFERSIZE(6, 2)];
+    static readoutFont_t valueFont;
+    static readout_t voltage, raw;
+
+    valueFont.fontInfo = &dejaVuSans9ptFontInfo;
+    valueFont.color = COLOR_WHITE;
+    valueFont.bgColor = COLOR_BLACK;
+    valueFont.glyphs = glyphBuffer;
+    valueFont.glyphsLen = sizeof(glyphBuffer) / sizeof(uint16_t);
+    readoutFontInit(&valueFont);
+
+    voltage.x = 10;
+    voltage.y = 20;
+    voltage.cells = 6;
+    voltage.font = &valueFont;
+    readoutInit(&voltage);
+
+    raw = voltage;
+    raw.y = 40;
+    readoutInit(&raw);
+
+    while (1)
+    {
+      uint32_t sample = adcRead(5);
+
+      // Millivolts shown as volts, 3.3V reference
+      readoutSetFixed(&voltage, (sample * 3300) / 1023, 3);
+      readoutSetInt(&raw, sample);
+      systickDelay(100);
+    }
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "readout.h"
+
+#include "core/libc/itoa.h"
+#include "drivers/lcd/tft/lcd.h"
+#include "drivers/lcd/tft/drawing.h"
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Returns the width of a character in the font, without the
+            one pixel spacing column
+*/
+/**************************************************************************/
+static uint16_t readoutCharWidth(const FONT_INFO *fontInfo, char c)
+{
+  if (fontInfo->charInfo != NULL)
+  {
+    return fontInfo->charInfo[(uint8_t)c - fontInfo->startChar].widthBits;
+  }
+
+  return 5;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Paints a single cell of the field
+*/
+/**************************************************************************/
+static void readoutDrawCell(readout_t *readout, uint8_t cell, char c)
+{
+  readoutFont_t *font = readout->font;
+  uint16_t x = readout->x + cell * font->cellWidth;
+  uint32_t pixels = (uint32_t)font->cellWidth * font->cellHeight;
+  char str[2];
+
+  lcdSetWindow(x, readout->y, x + font->cellWidth - 1, readout->y + font->cellHeight - 1);
+  if ((c >= '0') && (c <= '9'))
+  {
+    // Pre-rendered, so the whole cell is a single burst
+    lcdStreamPixels(&font->glyphs[(c - '0') * pixels], pixels);
+    return;
+  }
+
+  lcdStreamFill(font->bgColor, pixels);
+  if ((c == ' ') || ((uint8_t)c < font->fontInfo->startChar))
+  {
+    return;
+  }
+
+  str[0] = c;
+  str[1] = '\0';
+  x += (font->cellWidth - 1 - readoutCharWidth(font->fontInfo, c)) / 2;
+  drawString(x, readout->y + 7, font->color, font->fontInfo, str);
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Renders the digits of the font into the glyph buffer
+
+    @param[in]  font
+                Pointer to the readoutFont_t with fontInfo, color,
+                bgColor, glyphs and glyphsLen set
+*/
+/**************************************************************************/
+readout_error_t readoutFontInit(readoutFont_t *font)
+{
+  uint16_t maxWidth, width;
+  uint32_t pixels;
+  char c;
+
+  if ((font->fontInfo == NULL) || (font->fontInfo->startChar > '0'))
+  {
+    return READOUT_ERROR_INVALIDFONT;
+  }
+  if (font->glyphs == NULL)
+  {
+    return READOUT_ERROR_NOBUFFER;
+  }
+
+  maxWidth = 0;
+  for (c = '0'; c <= '9'; c++)
+  {
+    width = readoutCharWidth(font->fontInfo, c);
+    if (width > maxWidth)
+    {
+      maxWidth = width;
+    }
+  }
+
+  font->cellWidth = maxWidth + 1;
+  font->cellHeight = font->fontInfo->heightPages * 8;
+  pixels = (uint32_t)font->cellWidth * font->cellHeight;
+  if (font->glyphsLen < pixels * READOUT_GLYPHS)
+  {
+    return READOUT_ERROR_NOBUFFER;
+  }
+
+  // Center each digit in the cell, the spacing column stays on the right
+  for (c = '0'; c <= '9'; c++)
+  {
+    width = readoutCharWidth(font->fontInfo, c);
+    drawCharToBuffer(&font->glyphs[(c - '0') * pixels], font->cellWidth, (maxWidth - width) / 2,
+                     font->color, font->bgColor, font->fontInfo, c);
+  }
+
+  return READOUT_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks the field and paints it blank
+
+    @param[in]  readout
+                Pointer to the readout_t with x, y, cells and an
+                initialised font set
+*/
+/**************************************************************************/
+readout_error_t readoutInit(readout_t *readout)
+{
+  if ((readout->font == NULL) || (readout->font->cellWidth == 0))
+  {
+    return READOUT_ERROR_INVALIDFONT;
+  }
+  if ((readout->cells == 0) || (readout->cells > READOUT_MAXCELLS) ||
+      (readout->x + readout->cells * readout->font->cellWidth > lcdGetWidth()) ||
+      (readout->y + readout->font->cellHeight > lcdGetHeight()))
+  {
+    return READOUT_ERROR_INVALIDDIMENSIONS;
+  }
+
+  memset(readout->text, ' ', readout->cells);
+  readout->text[readout->cells] = '\0';
+  readoutRedraw(readout);
+
+  return READOUT_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Shows 'str' right-aligned in the field, painting only the
+            cells whose character changed
+
+    @param[in]  readout
+                Pointer to the readout_t
+    @param[in]  str
+                The text to show, '-' is shown in every cell if it is
+                longer than the field
+*/
+/**************************************************************************/
+void readoutSetString(readout_t *readout, const char *str)
+{
+  uint8_t cell, pad;
+  size_t len = strlen(str);
+  char c;
+
+  pad = len <= readout->cells ? readout->cells - len : 0;
+  for (cell = 0; cell < readout->cells; cell++)
+  {
+    if (len > readout->cells)
+    {
+      c = '-';
+    }
+    else
+    {
+      c = cell < pad ? ' ' : str[cell - pad];
+    }
+
+    if (c != readout->text[cell])
+    {
+      readoutDrawCell(readout, cell, c);
+      readout->text[cell] = c;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Shows a decimal integer in the field
+*/
+/**************************************************************************/
+void readoutSetInt(readout_t *readout, int32_t value)
+{
+  char text[12];
+
+  readoutSetString(readout, itoa(value, text, 10));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Shows a fixed point value in the field
+
+    @param[in]  readout
+                Pointer to the readout_t
+    @param[in]  value
+                The value scaled by 10^decimals (2153 with 2 decimals
+                is shown as "21.53")
+    @param[in]  decimals
+                Number of digits after the decimal point (0-9)
+*/
+/**************************************************************************/
+void readoutSetFixed(readout_t *readout, int32_t value, uint8_t decimals)
+{
+  char digits[12];
+  char text[16];
+  char *p = text;
+  uint32_t magnitude = value < 0 ? -(uint32_t)value : (uint32_t)value;
+  uint8_t len, i;
+
+  if (decimals > 9)
+  {
+    decimals = 9;
+  }
+
+  utoa(magnitude, digits, 10);
+  len = strlen(digits);
+
+  if (value < 0)
+  {
+    *p++ = '-';
+  }
+  if (len <= decimals)
+  {
+    // Leading zero plus any zeros between the point and the digits
+    *p++ = '0';
+    *p++ = '.';
+    for (i = len; i < decimals; i++)
+    {
+      *p++ = '0';
+    }
+    memcpy(p, digits, len);
+    p += len;
+  }
+  else
+  {
+    memcpy(p, digits, len - decimals);
+    p += len - decimals;
+    if (decimals)
+    {
+      *p++ = '.';
+      memcpy(p, &digits[len - decimals], decimals);
+      p += decimals;
+    }
+  }
+  *p = '\0';
+
+  readoutSetString(readout, text);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Repaints every cell of the field (after a dialogue has been
+            closed on top of it, for example)
+*/
+/**************************************************************************/
+void readoutRedraw(readout_t *readout)
+{
+  uint8_t cell;
+
+  for (cell = 0; cell < readout->cells; cell++)
+  {
+    readoutDrawCell(readout, cell, readout->text[cell]);
+  }
+}
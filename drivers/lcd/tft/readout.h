@@ -0,0 +1,105 @@
+/**************************************************************************/
+/*! 
+    @file     readout.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __READOUT_H__
+#define __READOUT_H__
+
+#include "projectconfig.h"
+#include "drivers/lcd/tft/fonts/bitmapfonts.h"
+
+#define READOUT_MAXCELLS    (12)    /* Longest field in characters          */
+#define READOUT_GLYPHS      (10)    /* Pre-rendered glyphs ('0'..'9')       */
+
+// Size in pixels of the glyph buffer for a font with digits 'maxWidth'
+// pixels wide (the widest digit of the font, without spacing)
+#define READOUT_BUFFERSIZE(maxWidth, heightPages)  (((maxWidth) + 1) * (heightPages) * 8 * READOUT_GLYPHS)
+
+/**************************************************************************/
+/*!
+    @brief  Pre-rendered digits shared by any number of readouts.  The
+            first block of fields must be set before calling
+            readoutFontInit, the rest is managed by readout.c.
+*/
+/**************************************************************************/
+typedef struct
+{
+  const FONT_INFO *fontInfo;    /* Font used for every cell             */
+  uint16_t  color;              /* Text colour                          */
+  uint16_t  bgColor;            /* Background colour                    */
+  uint16_t *glyphs;             /* RGB565 buffer (see READOUT_BUFFERSIZE) */
+  uint32_t  glyphsLen;          /* Size of 'glyphs' in pixels           */
+
+  uint16_t  cellWidth;          /* Widest digit plus spacing            */
+  uint16_t  cellHeight;         /* heightPages * 8                      */
+} readoutFont_t;
+
+/**************************************************************************/
+/*!
+    @brief  Fixed-width numeric field.  The first block of fields must
+            be set before calling readoutInit, the rest is managed by
+            readout.c.
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint16_t       x;             /* Left edge of the field               */
+  uint16_t       y;             /* Top edge of the field                */
+  uint8_t        cells;         /* Width of the field in characters     */
+  readoutFont_t *font;          /* Initialised with readoutFontInit     */
+
+  char           text[READOUT_MAXCELLS + 1];  /* Characters on screen   */
+} readout_t;
+
+/**************************************************************************/
+/*!
+    @brief  Error return codes for the numeric readouts
+*/
+/**************************************************************************/
+typedef enum
+{
+  READOUT_ERROR_NONE = 0,
+  READOUT_ERROR_NOBUFFER = 1,           /* 'glyphs' wasn't set or is too small */
+  READOUT_ERROR_INVALIDFONT = 2,        /* No font, or the font has no digits */
+  READOUT_ERROR_INVALIDDIMENSIONS = 3   /* Too many cells or the field is off the screen */
+} readout_error_t;
+
+readout_error_t readoutFontInit ( readoutFont_t *font );
+readout_error_t readoutInit     ( readout_t *readout );
+void            readoutSetString ( readout_t *readout, const char *str );
+void            readoutSetInt   ( readout_t *readout, int32_t value );
+void            readoutSetFixed ( readout_t *readout, int32_t value, uint8_t decimals );
+void            readoutRedraw   ( readout_t *readout );
+
+#endif
@@ -0,0 +1,555 @@
+/**************************************************************************/
+/*! 
+    @file     sprite.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Flicker-free sprites with frame pacing
+
+    @section DESCRIPTION
+
+    Animating something by erasing and redrawing it straight on the LCD
+    flickers, since the background briefly shows through, and redrawing
+    the whole screen every frame wastes most of the CPU time on pixels
+    that didn't change.
+
+    This module keeps a small pool of sprites (statically allocated,
+    see CFG_TFTLCD_SPRITES) and remembers where each one was last drawn.
+    When a frame is rendered, every sprite that moved, changed frame or
+    was shown or hidden marks its old and new position as damaged, with
+    overlapping areas merged into one region.  Each region is then
+    composed in the tile buffer with drawComposite: the background is
+    restored (a solid color, or redrawn by a callback), any sprites
+    that overlap the region are drawn on top in creation order, and the
+    finished tile is sent to the LCD in a single windowed burst.  A
+    sprite moving by a few pixels therefore costs one small burst, and
+    nothing on the screen is ever erased before it is redrawn.
+
+    spriteFrame paces frames off the systick microsecond clock and
+    sleeps until the next frame is due, returning the number of frame
+    periods since the previous frame so that motion can follow real
+    time when frames are dropped.  If the panel's frame marker (FMARK
+    or TE) is wired to a GPIO pin (see CFG_TFTLCD_FMARK_PORT), each
+    frame is also held back until the start of the next panel refresh
+    to avoid tearing.
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/sprite.h"
+    #include "ball.h"
+
+    static const spriteImage_t ballImage = { ball_data, 16, 16, 4, COLOR_MAGENTA };
+    sprite_t *ball;
+    uint16_t x = 0;
+
+    spriteReset(COLOR_BLACK, NULL);
+    spriteSetFrameRate(30);
+    ball = spriteCreate(&ballImage, 0, 100);
+    ball->flags |= SPRITE_FLAG_KEYED;
+    spriteAnimate(ball, 3);             // Next image every 3 frames
+
+    // 60 pixels per second, whatever the actual frame rate
+    while (1)
+    {
+      x = (x + 2 * spriteFrame()) % 224;
+      spriteMove(ball, x, 100);
+    }
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "sprite.h"
+
+#if defined CFG_TFTLCD_SPRITES && CFG_TFTLCD_SPRITES > 0
+
+#include "core/systick/systick.h"
+#include "core/pmu/pmu.h"
+#include "drivers/lcd/tft/lcd.h"
+#include "drivers/lcd/tft/drawing.h"
+
+#if defined CFG_TFTLCD_FMARK_PORT && defined CFG_TFTLCD_FMARK_PIN
+  #include "core/gpio/gpio.h"
+  #define SPRITE_FMARK
+  #define SPRITE_FMARK_TIMEOUT  (25000)   /* Longest panel refresh (us) */
+#endif
+
+typedef struct
+{
+  uint16_t x0, y0, x1, y1;              /* Inclusive screen co-ordinates */
+} spriteRect_t;
+
+static sprite_t spritePool[CFG_TFTLCD_SPRITES];
+static uint8_t spriteCount = 0;
+static uint16_t spriteBackground = COLOR_BLACK;
+static spriteBackgroundCallback_t spriteRenderBackground = NULL;
+
+static spriteRect_t spriteDamage[SPRITE_MAXDAMAGE];
+static uint8_t spriteDamageCount = 0;
+
+/* Region being painted, used by the drawComposite callback */
+static spriteRect_t spriteClip;
+
+/* Frame pacing */
+static uint32_t spritePeriod = 0;       /* Microseconds per frame, 0 = unpaced */
+static uint32_t spriteDeadline = 0;     /* When the next frame is due */
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Checks whether two rectangles overlap
+*/
+/**************************************************************************/
+static bool spriteRectOverlaps(const spriteRect_t *a, const spriteRect_t *b)
+{
+  return (a->x0 <= b->x1) && (b->x0 <= a->x1) && (a->y0 <= b->y1) && (b->y0 <= a->y1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Grows 'a' to include 'b'
+*/
+/**************************************************************************/
+static void spriteRectUnion(spriteRect_t *a, const spriteRect_t *b)
+{
+  if (b->x0 < a->x0) a->x0 = b->x0;
+  if (b->y0 < a->y0) a->y0 = b->y0;
+  if (b->x1 > a->x1) a->x1 = b->x1;
+  if (b->y1 > a->y1) a->y1 = b->y1;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the number of pixels in the union of 'a' and 'b'
+*/
+/**************************************************************************/
+static uint32_t spriteRectUnionArea(const spriteRect_t *a, const spriteRect_t *b)
+{
+  spriteRect_t u = *a;
+  spriteRectUnion(&u, b);
+  return (uint32_t)(u.x1 - u.x0 + 1) * (u.y1 - u.y0 + 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the screen area covered by a sprite at x, y
+*/
+/**************************************************************************/
+static void spriteGetRect(const sprite_t *sprite, uint16_t x, uint16_t y, spriteRect_t *rect)
+{
+  rect->x0 = x;
+  rect->y0 = y;
+  rect->x1 = x + sprite->image->width - 1;
+  rect->y1 = y + sprite->image->height - 1;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Restores the background of spriteClip and draws every
+            visible sprite overlapping it
+*/
+/**************************************************************************/
+static void spriteRenderClip(void)
+{
+  const spriteImage_t *image;
+  spriteRect_t rect;
+  sprite_t *sprite;
+  uint8_t i, frame;
+
+  if (spriteRenderBackground)
+  {
+    spriteRenderBackground(spriteClip.x0, spriteClip.y0, spriteClip.x1, spriteClip.y1);
+  }
+
+  for (i = 0; i < spriteCount; i++)
+  {
+    sprite = &spritePool[i];
+    if (!(sprite->flags & SPRITE_FLAG_VISIBLE))
+    {
+      continue;
+    }
+    spriteGetRect(sprite, sprite->x, sprite->y, &rect);
+    if (!spriteRectOverlaps(&rect, &spriteClip))
+    {
+      continue;
+    }
+    image = sprite->image;
+    frame = image->frames ? sprite->frame % image->frames : 0;
+    if (sprite->flags & SPRITE_FLAG_KEYED)
+    {
+      drawImage565Keyed(sprite->x, sprite->y, image->width, image->height,
+                        &image->pixels[(uint32_t)frame * image->width * image->height], image->key);
+    }
+    else
+    {
+      drawImage565(sprite->x, sprite->y, image->width, image->height,
+                   &image->pixels[(uint32_t)frame * image->width * image->height]);
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Restores and repaints one damaged region
+*/
+/**************************************************************************/
+static void spritePaintRegion(const spriteRect_t *region)
+{
+  spriteClip = *region;
+
+  if (spriteClip.x1 - spriteClip.x0 + 1 <= CFG_TFTLCD_TILEBUFFER)
+  {
+    drawComposite(spriteClip.x0, spriteClip.y0, spriteClip.x1, spriteClip.y1, spriteBackground, spriteRenderClip);
+    return;
+  }
+
+  // Too wide for the tile buffer, so draw straight to the LCD
+  drawRectangleFilled(spriteClip.x0, spriteClip.y0, spriteClip.x1, spriteClip.y1, spriteBackground);
+  spriteRenderClip();
+}
+
+#ifdef SPRITE_FMARK
+/**************************************************************************/
+/*!
+    @brief  Waits for the rising edge of the panel's frame marker,
+            which is sent just before the panel starts a new refresh
+*/
+/**************************************************************************/
+static void spriteWaitForFMARK(void)
+{
+  uint32_t start = systickGetMicros();
+
+  while (gpioGetValue(CFG_TFTLCD_FMARK_PORT, CFG_TFTLCD_FMARK_PIN) &&
+         (systickGetMicros() - start < SPRITE_FMARK_TIMEOUT));
+  while (!gpioGetValue(CFG_TFTLCD_FMARK_PORT, CFG_TFTLCD_FMARK_PIN) &&
+         (systickGetMicros() - start < SPRITE_FMARK_TIMEOUT));
+}
+#endif
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Releases every sprite and sets up the background
+
+    Nothing is repainted, so the screen can be drawn as usual first.
+    Call spriteInvalidateRect for the whole screen to have it painted
+    by the next frame instead.
+
+    @param[in]  background
+                Color the area behind the sprites is cleared to
+    @param[in]  render
+                Function that redraws the scene behind the sprites on
+                top of 'background', or NULL
+*/
+/**************************************************************************/
+void spriteReset(uint16_t background, spriteBackgroundCallback_t render)
+{
+  spriteCount = 0;
+  spriteDamageCount = 0;
+  spriteBackground = background;
+  spriteRenderBackground = render;
+
+  #ifdef SPRITE_FMARK
+  gpioSetDir(CFG_TFTLCD_FMARK_PORT, CFG_TFTLCD_FMARK_PIN, gpioDirection_Input);
+  #endif
+}
+
+/**************************************************************************/
+/*!
+    @brief  Allocates a visible sprite on top of all existing sprites.
+            It appears with the next frame.
+
+    @param[in]  image
+                Sprite image (must remain valid while the sprite is used)
+    @param[in]  x
+                Left edge
+    @param[in]  y
+                Top edge
+
+    @return     The new sprite, or NULL if the pool is exhausted
+*/
+/**************************************************************************/
+sprite_t *spriteCreate(const spriteImage_t *image, uint16_t x, uint16_t y)
+{
+  sprite_t *sprite;
+
+  if ((spriteCount >= CFG_TFTLCD_SPRITES) || (image == NULL) ||
+      (image->width == 0) || (image->height == 0))
+  {
+    return NULL;
+  }
+
+  sprite = &spritePool[spriteCount++];
+  memset(sprite, 0, sizeof(sprite_t));
+  sprite->image = image;
+  sprite->x = x;
+  sprite->y = y;
+  sprite->flags = SPRITE_FLAG_VISIBLE;
+
+  return sprite;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Moves a sprite.  The old position is restored and the new
+            one drawn with the next frame.
+*/
+/**************************************************************************/
+void spriteMove(sprite_t *sprite, uint16_t x, uint16_t y)
+{
+  sprite->x = x;
+  sprite->y = y;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Steps through the frames of the sprite's image, moving on
+            to the next one every 'interval' frames (0 stops the
+            animation on the current image)
+*/
+/**************************************************************************/
+void spriteAnimate(sprite_t *sprite, uint8_t interval)
+{
+  sprite->interval = interval;
+  sprite->ticks = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Shows or hides a sprite
+*/
+/**************************************************************************/
+void spriteSetVisible(sprite_t *sprite, bool visible)
+{
+  if (visible)
+  {
+    sprite->flags |= SPRITE_FLAG_VISIBLE;
+  }
+  else
+  {
+    sprite->flags &= ~SPRITE_FLAG_VISIBLE;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Marks a screen area as needing to be restored by the next
+            frame (for example after the background changed), merging
+            it with any damage it overlaps
+*/
+/**************************************************************************/
+void spriteInvalidateRect(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+  spriteRect_t rect;
+  uint32_t area, best;
+  uint8_t i, merge;
+
+  if (x1 < x0) { rect.x0 = x1; rect.x1 = x0; } else { rect.x0 = x0; rect.x1 = x1; }
+  if (y1 < y0) { rect.y0 = y1; rect.y1 = y0; } else { rect.y0 = y0; rect.y1 = y1; }
+  if ((rect.x0 >= lcdGetWidth()) || (rect.y0 >= lcdGetHeight()))
+  {
+    return;
+  }
+  if (rect.x1 >= lcdGetWidth()) rect.x1 = lcdGetWidth() - 1;
+  if (rect.y1 >= lcdGetHeight()) rect.y1 = lcdGetHeight() - 1;
+
+  // Absorb any regions that overlap the new one (which may in turn
+  // make it overlap regions that were checked earlier)
+  i = 0;
+  while (i < spriteDamageCount)
+  {
+    if (spriteRectOverlaps(&rect, &spriteDamage[i]))
+    {
+      spriteRectUnion(&rect, &spriteDamage[i]);
+      spriteDamage[i] = spriteDamage[--spriteDamageCount];
+      i = 0;
+      continue;
+    }
+    i++;
+  }
+
+  if (spriteDamageCount < SPRITE_MAXDAMAGE)
+  {
+    spriteDamage[spriteDamageCount++] = rect;
+    return;
+  }
+
+  // No room left, merge with the region that grows the least
+  merge = 0;
+  best = 0xFFFFFFFF;
+  for (i = 0; i < spriteDamageCount; i++)
+  {
+    area = spriteRectUnionArea(&spriteDamage[i], &rect);
+    if (area < best)
+    {
+      best = area;
+      merge = i;
+    }
+  }
+  spriteRectUnion(&rect, &spriteDamage[merge]);
+  spriteDamage[merge] = spriteDamage[--spriteDamageCount];
+  spriteInvalidateRect(rect.x0, rect.y0, rect.x1, rect.y1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets the frame rate spriteFrame paces itself to
+
+    @param[in]  fps
+                Frames per second, or 0 to render every frame as soon
+                as spriteFrame is called
+*/
+/**************************************************************************/
+void spriteSetFrameRate(uint8_t fps)
+{
+  spritePeriod = fps ? 1000000 / fps : 0;
+  spriteDeadline = systickGetMicros() + spritePeriod;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sends everything that changed since the last frame to the
+            LCD, without any pacing
+*/
+/**************************************************************************/
+void spriteRender(void)
+{
+  spriteRect_t rect, region;
+  sprite_t *sprite;
+  bool visible, changed;
+  uint8_t i;
+
+  // Damage the old and the new position of every sprite that changed
+  for (i = 0; i < spriteCount; i++)
+  {
+    sprite = &spritePool[i];
+    visible = (sprite->flags & SPRITE_FLAG_VISIBLE) ? TRUE : FALSE;
+    changed = (visible != sprite->drawn) || (sprite->x != sprite->drawnX) ||
+              (sprite->y != sprite->drawnY) || (sprite->frame != sprite->drawnFrame);
+    if (!changed)
+    {
+      continue;
+    }
+    if (sprite->drawn)
+    {
+      spriteGetRect(sprite, sprite->drawnX, sprite->drawnY, &rect);
+      spriteInvalidateRect(rect.x0, rect.y0, rect.x1, rect.y1);
+    }
+    if (visible)
+    {
+      spriteGetRect(sprite, sprite->x, sprite->y, &rect);
+      spriteInvalidateRect(rect.x0, rect.y0, rect.x1, rect.y1);
+    }
+    sprite->drawn = visible;
+    sprite->drawnX = sprite->x;
+    sprite->drawnY = sprite->y;
+    sprite->drawnFrame = sprite->frame;
+  }
+
+  while (spriteDamageCount)
+  {
+    region = spriteDamage[--spriteDamageCount];
+    spritePaintRegion(&region);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Waits until the next frame is due (sleeping in the
+            meantime), then advances the sprite animations and renders
+            the frame
+
+    @return     Number of frame periods since the previous frame: 1 if
+                the frame rate was met, more if frames were dropped
+                because the application fell behind
+*/
+/**************************************************************************/
+uint32_t spriteFrame(void)
+{
+  uint32_t elapsed = 1, now, steps;
+  sprite_t *sprite;
+  uint8_t i;
+
+  if (spritePeriod)
+  {
+    now = systickGetMicros();
+    if ((int32_t)(now - spriteDeadline) < 0)
+    {
+      // Early ... sleep until the frame is due (systick wakes us up)
+      while ((int32_t)(systickGetMicros() - spriteDeadline) < 0)
+      {
+        pmuSleep();
+      }
+    }
+    else
+    {
+      // Late ... skip the frames that were missed
+      elapsed = (now - spriteDeadline) / spritePeriod + 1;
+    }
+    spriteDeadline += elapsed * spritePeriod;
+  }
+
+  #ifdef SPRITE_FMARK
+  spriteWaitForFMARK();
+  #endif
+
+  // Advance the animations
+  for (i = 0; i < spriteCount; i++)
+  {
+    sprite = &spritePool[i];
+    if (!sprite->interval || (sprite->image->frames < 2))
+    {
+      continue;
+    }
+    steps = sprite->ticks + elapsed;
+    sprite->frame = (sprite->frame + steps / sprite->interval) % sprite->image->frames;
+    sprite->ticks = steps % sprite->interval;
+  }
+
+  spriteRender();
+
+  return elapsed;
+}
+
+#endif
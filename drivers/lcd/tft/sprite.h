@@ -0,0 +1,112 @@
+/**************************************************************************/
+/*! 
+    @file     sprite.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __SPRITE_H__
+#define __SPRITE_H__
+
+#include "projectconfig.h"
+
+#if defined CFG_TFTLCD_SPRITES && CFG_TFTLCD_SPRITES > 0
+
+/* Number of separate damage regions tracked between two frames (see
+   WIDGET_MAXDAMAGE in widget.h) */
+#define SPRITE_MAXDAMAGE      (6)
+
+/* Sprite flags */
+#define SPRITE_FLAG_VISIBLE   (0x01)    /* Sprite is drawn */
+#define SPRITE_FLAG_KEYED     (0x02)    /* Pixels matching image->key aren't drawn */
+
+/**************************************************************************/
+/*!
+    @brief  Sprite image.  Animation frames are stored one after the
+            other, each one width * height RGB565 pixels (top-down),
+            so an image can be shared by several sprites.
+*/
+/**************************************************************************/
+typedef struct
+{
+  const uint16_t *pixels;               /* All frames                   */
+  uint16_t       width;                 /* Width in pixels              */
+  uint16_t       height;                /* Height of one frame          */
+  uint8_t        frames;                /* Number of frames             */
+  uint16_t       key;                   /* Transparent color            */
+} spriteImage_t;
+
+/**************************************************************************/
+/*!
+    @brief  Sprite node.  Sprites are allocated from a static pool by
+            spriteCreate and are drawn in the order they were created,
+            so later sprites appear on top.
+
+            The public fields can be changed at any time.  Nothing is
+            sent to the LCD until the next spriteRender or spriteFrame,
+            which compares every sprite with what is on the screen and
+            only repaints the areas that changed.
+*/
+/**************************************************************************/
+typedef struct
+{
+  const spriteImage_t *image;
+  uint16_t       x;                     /* Left edge                    */
+  uint16_t       y;                     /* Top edge                     */
+  uint8_t        frame;                 /* Current animation frame      */
+  uint8_t        interval;              /* Frames per animation step, 0 = stopped */
+  uint8_t        flags;                 /* SPRITE_FLAG_*                */
+
+  /* Private: what is on the screen */
+  uint8_t        ticks;                 /* Frames since the last step   */
+  uint8_t        drawnFrame;
+  bool           drawn;
+  uint16_t       drawnX;
+  uint16_t       drawnY;
+} sprite_t;
+
+/* Redraws the static scene behind the sprites in an area of the screen.
+   Called with a tile open, so anything outside the area is clipped. */
+typedef void (*spriteBackgroundCallback_t)(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+
+void      spriteReset          ( uint16_t background, spriteBackgroundCallback_t render );
+sprite_t *spriteCreate         ( const spriteImage_t *image, uint16_t x, uint16_t y );
+void      spriteMove           ( sprite_t *sprite, uint16_t x, uint16_t y );
+void      spriteAnimate        ( sprite_t *sprite, uint8_t interval );
+void      spriteSetVisible     ( sprite_t *sprite, bool visible );
+void      spriteInvalidateRect ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1 );
+void      spriteSetFrameRate   ( uint8_t fps );
+void      spriteRender         ( void );
+uint32_t  spriteFrame          ( void );
+
+#endif
+
+#endif
@@ -40,6 +40,7 @@
 #include "core/adc/adc.h"
 #include "core/gpio/gpio.h"
 #include "core/systick/systick.h"
+#include "core/sched/event.h"
 #include "drivers/eeprom/eeprom.h"
 #include "drivers/lcd/tft/lcd.h"
 #include "drivers/lcd/tft/drawing.h"
@@ -54,6 +55,18 @@ static uint8_t _tsThreshhold = CFG_TFTLCD_TS_DEFAULTTHRESHOLD;
 tsPoint_t _tsLCDPoints[3]; 
 tsPoint_t _tsTSPoints[3]; 
 tsMatrix_t _tsMatrix;
+static tsFixedMatrix_t _tsFixedMatrix;
+
+#ifdef CFG_TFTLCD_TS_IRQ
+static tsEvent_t _tsQueue[CFG_TFTLCD_TS_QUEUESIZE];
+static volatile uint8_t _tsQueueHead = 0;     // Written by the systick ISR
+static volatile uint8_t _tsQueueTail = 0;     // Written by tsGetEvent
+static volatile bool _tsEventsEnabled = false;
+static volatile bool _tsSampling = false;     // Pen down, sampling with systick
+static uint32_t _tsSampleTicks = 0;
+static bool _tsPenDown = false;
+static tsEvent_t _tsLast;
+#endif
 
 /**************************************************************************/
 /*                                                                        */
@@ -61,6 +74,18 @@ tsMatrix_t _tsMatrix;
 /*                                                                        */
 /**************************************************************************/
 
+/**************************************************************************/
+/*!
+    @brief  Reads one touch screen channel, filtered with
+            adcReadOversampled but kept on the 10-bit scale that the
+            threshold and the stored calibration data use
+*/
+/**************************************************************************/
+static uint32_t tsReadADC(uint8_t channelNum)
+{
+  return adcReadOversampled(channelNum, CFG_ADC_OVERSAMPLE) >> 2;
+}
+
 /**************************************************************************/
 /*!
     @brief  Reads the current Z/pressure level using the ADC
@@ -87,7 +112,7 @@ void tsReadZ(uint32_t* z1, uint32_t* z2)
   gpioSetValue(TS_YP_PORT, TS_YP_PIN, 1);   // 3.3V
 
   TS_XP_FUNC_ADC;
-  *z1 = adcRead(TS_XP_ADC_CHANNEL);
+  *z1 = tsReadADC(TS_XP_ADC_CHANNEL);
 
   // XP = GPIO Input
   // XM = GPIO Output Low
@@ -98,7 +123,7 @@ void tsReadZ(uint32_t* z1, uint32_t* z2)
   gpioSetDir (TS_YM_PORT, TS_YM_PIN, 0);
 
   TS_YM_FUNC_ADC;
-  *z2 = adcRead(TS_YM_ADC_CHANNEL);
+  *z2 = tsReadADC(TS_YM_ADC_CHANNEL);
 }
 
 /**************************************************************************/
@@ -129,7 +154,7 @@ uint32_t tsReadX(void)
   TS_YP_FUNC_ADC;  
 
   // Return the ADC results
-  return adcRead(TS_YP_ADC_CHANNEL);
+  return tsReadADC(TS_YP_ADC_CHANNEL);
 }
 
 /**************************************************************************/
@@ -160,9 +185,165 @@ uint32_t tsReadY(void)
   TS_XM_FUNC_ADC;
 
   // Return the ADC results
-  return adcRead(TS_XM_ADC_CHANNEL);
+  return tsReadADC(TS_XM_ADC_CHANNEL);
+}
+
+#ifdef CFG_TFTLCD_TS_IRQ
+/**************************************************************************/
+/*!
+    @brief  Sets the panel up to detect a touch with an interrupt.
+
+    YM is driven low and XP is a digital input with its pull-up on, so
+    that the pull-up wins until the pen connects the two plates and pulls
+    XP down.
+*/
+/**************************************************************************/
+static void tsPenArm(void)
+{
+  TS_XM_FUNC_GPIO;
+  TS_YP_FUNC_GPIO;
+  TS_YM_FUNC_GPIO;
+
+  gpioSetDir (TS_XM_PORT, TS_XM_PIN, 0);
+  gpioSetDir (TS_YP_PORT, TS_YP_PIN, 0);
+  gpioSetDir (TS_YM_PORT, TS_YM_PIN, 1);
+  gpioSetValue(TS_YM_PORT, TS_YM_PIN, 0);   // GND
+
+  IOCON_JTAG_TMS_PIO1_0 = IOCON_JTAG_TMS_PIO1_0_FUNC_GPIO |
+                          IOCON_JTAG_TMS_PIO1_0_MODE_PULLUP |
+                          IOCON_JTAG_TMS_PIO1_0_ADMODE_DIGITAL;
+  gpioSetDir (TS_XP_PORT, TS_XP_PIN, 0);
+
+  gpioIntClear(TS_XP_PORT, TS_XP_PIN);
+  gpioIntEnable(TS_XP_PORT, TS_XP_PIN);
 }
 
+/**************************************************************************/
+/*!
+    @brief  Stops pen down detection and removes the XP pull-up so that
+            it doesn't bias the ADC readings
+*/
+/**************************************************************************/
+static void tsPenDisarm(void)
+{
+  gpioIntDisable(TS_XP_PORT, TS_XP_PIN);
+  IOCON_JTAG_TMS_PIO1_0 &= ~IOCON_JTAG_TMS_PIO1_0_MODE_MASK;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Adds an event to the queue (systick ISR only).  When the
+            queue is full, MOVE events are dropped and DOWN/UP events
+            replace the newest queued event so the pen state stays right.
+*/
+/**************************************************************************/
+static void tsQueueEvent(tsEventType_t type)
+{
+  uint8_t head = _tsQueueHead;
+  uint8_t next = (head + 1) % CFG_TFTLCD_TS_QUEUESIZE;
+
+  _tsLast.type = type;
+  _tsLast.timestamp = systickGetTicks();
+
+  if (next == _tsQueueTail)
+  {
+    if (type != TS_EVENT_MOVE)
+    {
+      _tsQueue[(head + CFG_TFTLCD_TS_QUEUESIZE - 1) % CFG_TFTLCD_TS_QUEUESIZE] = _tsLast;
+    }
+    return;
+  }
+
+  _tsQueue[head] = _tsLast;
+  _tsQueueHead = next;
+  eventSignal(EVENT_SOURCE_TOUCH);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Takes one reading while the pen is down and turns it into
+            DOWN/MOVE/UP events
+*/
+/**************************************************************************/
+static void tsSample(void)
+{
+  tsTouchData_t data;
+  tsTouchError_t error;
+  int32_t dx, dy;
+
+  error = tsRead(&data);
+  if (data.valid)
+  {
+    dx = (int32_t)data.xlcd - _tsLast.xlcd;
+    dy = (int32_t)data.ylcd - _tsLast.ylcd;
+    if (_tsPenDown && (dx < TS_EVENT_MOVEMIN) && (dx > -TS_EVENT_MOVEMIN) &&
+        (dy < TS_EVENT_MOVEMIN) && (dy > -TS_EVENT_MOVEMIN))
+    {
+      return;
+    }
+    _tsLast.xraw = data.xraw;
+    _tsLast.yraw = data.yraw;
+    _tsLast.xlcd = data.xlcd;
+    _tsLast.ylcd = data.ylcd;
+    tsQueueEvent(_tsPenDown ? TS_EVENT_MOVE : TS_EVENT_DOWN);
+    _tsPenDown = true;
+  }
+  else if (error == TS_ERROR_NONE)
+  {
+    // Pressure is below the threshold, so the pen is up (or the
+    // interrupt was a glitch): report it and wait for the next touch
+    if (_tsPenDown)
+    {
+      tsQueueEvent(TS_EVENT_UP);
+    }
+    _tsPenDown = false;
+    _tsSampling = false;
+    tsPenArm();
+  }
+  // On an X/Y mismatch the pen is moving, try again next period
+}
+
+/**************************************************************************/
+/*!
+    @brief  Called from PIOINT1_IRQHandler when the pen touches the
+            screen.  The interrupt stays off while the pen is down and
+            the screen is sampled from the systick interrupt instead.
+*/
+/**************************************************************************/
+void tsPenDownIRQ(void)
+{
+  gpioIntDisable(TS_XP_PORT, TS_XP_PIN);
+  if (_tsEventsEnabled && !_tsSampling)
+  {
+    // Take the first reading on the next tick
+    _tsSampleTicks = CFG_TFTLCD_TS_SAMPLEMS;
+    _tsSampling = true;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Called from SysTick_Handler every tick.  Samples the screen
+            every CFG_TFTLCD_TS_SAMPLEMS while the pen is down, and does
+            nothing at all while it is up.
+*/
+/**************************************************************************/
+void tsTimerProc(void)
+{
+  if (!_tsSampling)
+  {
+    return;
+  }
+
+  if (++_tsSampleTicks >= CFG_TFTLCD_TS_SAMPLEMS)
+  {
+    _tsSampleTicks = 0;
+    tsPenDisarm();
+    tsSample();
+  }
+}
+#endif
+
 /**************************************************************************/
 /*!
     @brief  Centers a line of text horizontally
@@ -204,6 +385,32 @@ tsTouchData_t tsRenderCalibrationScreen(uint16_t x, uint16_t y, uint16_t radius)
   return data;
 }
 
+/**************************************************************************/
+/*!
+    @brief  Divides the calibration matrix through by Divider once, so
+            that getDisplayPoint doesn't have to divide every sample.
+            64-bit maths is only needed here: Cn and Fn can be close to
+            the 32-bit limit before the divide.
+*/
+/**************************************************************************/
+static void tsSetFixedMatrix( tsFixedMatrix_t * fixedPtr, tsMatrix_t * matrixPtr )
+{
+  int64_t div = matrixPtr->Divider;
+
+  fixedPtr->valid = (div != 0);
+  if (!fixedPtr->valid)
+  {
+    return;
+  }
+
+  fixedPtr->a = (int32_t)(((int64_t)matrixPtr->An << TS_MATRIX_SHIFT) / div);
+  fixedPtr->b = (int32_t)(((int64_t)matrixPtr->Bn << TS_MATRIX_SHIFT) / div);
+  fixedPtr->c = (int32_t)(((int64_t)matrixPtr->Cn << TS_MATRIX_SHIFT) / div);
+  fixedPtr->d = (int32_t)(((int64_t)matrixPtr->Dn << TS_MATRIX_SHIFT) / div);
+  fixedPtr->e = (int32_t)(((int64_t)matrixPtr->En << TS_MATRIX_SHIFT) / div);
+  fixedPtr->f = (int32_t)(((int64_t)matrixPtr->Fn << TS_MATRIX_SHIFT) / div);
+}
+
 /**************************************************************************/
 /*!
     @brief Calculates the difference between the touch screen and the
@@ -265,8 +472,11 @@ int setCalibrationMatrix( tsPoint_t * displayPtr, tsPoint_t * screenPtr, tsMatri
     eepromWriteS32(CFG_EEPROM_TOUCHSCREEN_CAL_FN, matrixPtr->Fn);
     eepromWriteS32(CFG_EEPROM_TOUCHSCREEN_CAL_DIVIDER, matrixPtr->Divider);
     eepromWriteU8(CFG_EEPROM_TOUCHSCREEN_CALIBRATED, 1);
+    eepromFlush();
   }
 
+  tsSetFixedMatrix(&_tsFixedMatrix, matrixPtr);
+
   return( retValue ) ;
 } 
 
@@ -282,21 +492,22 @@ int setCalibrationMatrix( tsPoint_t * displayPtr, tsPoint_t * screenPtr, tsMatri
            written by Carlos E. Vidales (copyright (c) 2001).
 */
 /**************************************************************************/
-int getDisplayPoint( tsPoint_t * displayPtr, tsPoint_t * screenPtr, tsMatrix_t * matrixPtr )
+int getDisplayPoint( tsPoint_t * displayPtr, tsPoint_t * screenPtr, tsFixedMatrix_t * fixedPtr )
 {
   int  retValue = 0 ;
   
-  if( matrixPtr->Divider != 0 )
+  if( fixedPtr->valid )
   {
-    displayPtr->x = ( (matrixPtr->An * screenPtr->x) + 
-                      (matrixPtr->Bn * screenPtr->y) + 
-                       matrixPtr->Cn 
-                    ) / matrixPtr->Divider ;
-
-    displayPtr->y = ( (matrixPtr->Dn * screenPtr->x) + 
-                      (matrixPtr->En * screenPtr->y) + 
-                       matrixPtr->Fn 
-                    ) / matrixPtr->Divider ;
+    // Rounded to the nearest pixel
+    displayPtr->x = ( (fixedPtr->a * screenPtr->x) + 
+                      (fixedPtr->b * screenPtr->y) + 
+                       fixedPtr->c + (1 << (TS_MATRIX_SHIFT - 1))
+                    ) >> TS_MATRIX_SHIFT ;
+
+    displayPtr->y = ( (fixedPtr->d * screenPtr->x) + 
+                      (fixedPtr->e * screenPtr->y) + 
+                       fixedPtr->f + (1 << (TS_MATRIX_SHIFT - 1))
+                    ) >> TS_MATRIX_SHIFT ;
   }
   else
   {
@@ -350,9 +561,97 @@ void tsInit(void)
     _tsMatrix.En = eepromReadS32(CFG_EEPROM_TOUCHSCREEN_CAL_EN);
     _tsMatrix.Fn = eepromReadS32(CFG_EEPROM_TOUCHSCREEN_CAL_FN);
     _tsMatrix.Divider = eepromReadS32(CFG_EEPROM_TOUCHSCREEN_CAL_DIVIDER);
+    tsSetFixedMatrix(&_tsFixedMatrix, &_tsMatrix);
+  }
+
+#ifdef CFG_TFTLCD_TS_IRQ
+  tsEventsStart();
+#endif
+}
+
+#ifdef CFG_TFTLCD_TS_IRQ
+/**************************************************************************/
+/*!
+    @brief  Starts interrupt driven touch detection.  Nothing runs while
+            the screen isn't touched; after a pen down interrupt the
+            screen is read every CFG_TFTLCD_TS_SAMPLEMS from the systick
+            interrupt, and DOWN/MOVE/UP events are queued for tsGetEvent
+            and tsWaitForEvent.  This is done by tsInit.
+
+    @note   tsRead must not be called from the main code while event
+            mode is running, since it would fight the systick interrupt
+            over the touch screen pins and the ADC.
+*/
+/**************************************************************************/
+void tsEventsStart(void)
+{
+  if (!_tsInitialised) tsInit();
+
+  if (_tsEventsEnabled)
+  {
+    return;
+  }
+
+  _tsQueueHead = _tsQueueTail = 0;
+  _tsPenDown = false;
+  _tsSampling = false;
+  _tsEventsEnabled = true;
+
+  // Falling edge on XP (tsPenArm clears anything latched while the
+  // callback was attached)
+  gpioAttachInterrupt(TS_XP_PORT,
+                      TS_XP_PIN,
+                      gpioInterruptSense_Edge,
+                      gpioInterruptEdge_Single,
+                      gpioInterruptEvent_ActiveLow,
+                      tsPenDownIRQ);
+  tsPenArm();
+
+  // Don't miss a touch that started before the interrupt was enabled
+  if (!gpioGetValue(TS_XP_PORT, TS_XP_PIN))
+  {
+    tsPenDownIRQ();
   }
 }
 
+/**************************************************************************/
+/*!
+    @brief  Stops interrupt driven touch detection so that tsRead can be
+            used directly (e.g. to calibrate the screen)
+*/
+/**************************************************************************/
+void tsEventsStop(void)
+{
+  __disable_irq();
+  _tsEventsEnabled = false;
+  _tsSampling = false;
+  __enable_irq();
+
+  tsPenDisarm();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the oldest queued touch event without waiting
+
+    @return false if the queue is empty
+*/
+/**************************************************************************/
+bool tsGetEvent(tsEvent_t *event)
+{
+  uint8_t tail = _tsQueueTail;
+
+  if (tail == _tsQueueHead)
+  {
+    return false;
+  }
+
+  *event = _tsQueue[tail];
+  _tsQueueTail = (tail + 1) % CFG_TFTLCD_TS_QUEUESIZE;
+  return true;
+}
+#endif
+
 /**************************************************************************/
 /*!
     @brief  Reads the current X, Y and Z co-ordinates of the touch screen
@@ -384,8 +683,10 @@ tsTouchError_t tsRead(tsTouchData_t* data)
   y1 = tsReadY();
   y2 = tsReadY();
 
-  // Throw an error if both readings aren't identical
-  if (x1 != x2 || y1 != y2)
+  // Throw an error if the readings differ by more than the filtered
+  // noise, which means the pen moved or was lifted between them
+  if ((x1 > x2 ? x1 - x2 : x2 - x1) > TS_XYTOLERANCE ||
+      (y1 > y2 ? y1 - y2 : y2 - y1) > TS_XYTOLERANCE)
   {
     data->valid = false;
     data->xraw = x1;
@@ -394,6 +695,8 @@ tsTouchError_t tsRead(tsTouchData_t* data)
   }
 
   // X/Y seems to be valid and reading has been confirmed twice
+  x1 = (x1 + x2) / 2;
+  y1 = (y1 + y2) / 2;
   data->xraw = x1;
   data->yraw = y1;
 
@@ -401,7 +704,7 @@ tsTouchError_t tsRead(tsTouchData_t* data)
   tsPoint_t location, touch;
   touch.x = x1;
   touch.y = y1;
-  getDisplayPoint( &location, &touch, &_tsMatrix) ;
+  getDisplayPoint( &location, &touch, &_tsFixedMatrix) ;
   data->xlcd = location.x;
   data->ylcd = location.y;
   data->valid = true;
@@ -420,6 +723,12 @@ void tsCalibrate(void)
 {
   tsTouchData_t data;
 
+#ifdef CFG_TFTLCD_TS_IRQ
+  // tsRenderCalibrationScreen polls tsRead directly
+  if (!_tsInitialised) tsInit();
+  tsEventsStop();
+#endif
+
   /* --------------- Welcome Screen --------------- */
   data = tsRenderCalibrationScreen(lcdGetWidth() / 2, lcdGetHeight() / 2, 5);
   systickDelay(250);
@@ -459,6 +768,10 @@ void tsCalibrate(void)
 
   // Do matrix calculations for calibration and store to EEPROM
   setCalibrationMatrix(&_tsLCDPoints[0], &_tsTSPoints[0], &_tsMatrix);
+
+#ifdef CFG_TFTLCD_TS_IRQ
+  tsEventsStart();
+#endif
 }
 
 /**************************************************************************/
@@ -509,6 +822,40 @@ tsTouchError_t tsWaitForEvent(tsTouchData_t* data, uint32_t timeoutMS)
 {
   if (!_tsInitialised) tsInit();
 
+#ifdef CFG_TFTLCD_TS_IRQ
+  if (_tsEventsEnabled)
+  {
+    tsEvent_t event;
+    uint32_t startTick = systickGetTicks();
+
+    while (1)
+    {
+      // Any DOWN or MOVE event is a valid touch, UP events are skipped
+      while (tsGetEvent(&event))
+      {
+        if (event.type != TS_EVENT_UP)
+        {
+          data->xraw = event.xraw;
+          data->yraw = event.yraw;
+          data->xlcd = event.xlcd;
+          data->ylcd = event.ylcd;
+          data->z1 = 0;
+          data->z2 = 0;
+          data->valid = true;
+          return TS_ERROR_NONE;
+        }
+      }
+      if (timeoutMS && ((systickGetTicks() - startTick) > timeoutMS))
+      {
+        data->valid = false;
+        return TS_ERROR_TIMEOUT;
+      }
+      // Sleep until the next interrupt (systick at the latest)
+      __asm volatile ("wfi");
+    }
+  }
+#endif
+
   tsRead(data);
 
   // Return the results right away if reading is valid
@@ -580,6 +927,7 @@ int tsSetThreshhold(uint8_t value)
 
   // Persist to EEPROM
   eepromWriteU8(CFG_EEPROM_TOUCHSCREEN_THRESHHOLD, value);
+  eepromFlush();
 
   return 0;
 }
@@ -63,6 +63,9 @@
 #define TS_XM_ADC_CHANNEL   (2)   // ADC0.2
 #define TS_YM_ADC_CHANNEL   (3)   // ADC0.3
 
+#define TS_XYTOLERANCE      (1)   // Max difference between X/Y readings (10-bit)
+#define TS_EVENT_MOVEMIN    (2)   // Pixels the pen must move for a TS_EVENT_MOVE
+
 typedef struct Point 
 {
   int32_t x;
@@ -80,6 +83,18 @@ typedef struct Matrix
           Divider ;
 } tsMatrix_t;
 
+#define TS_MATRIX_SHIFT     (16)  // Fraction bits in tsFixedMatrix_t
+
+/* The calibration matrix pre-divided by Divider, in fixed point with
+   TS_MATRIX_SHIFT fraction bits, so that a touch sample converts with
+   six MULs and no divide: x = (a * xraw + b * yraw + c) >> TS_MATRIX_SHIFT */
+typedef struct
+{
+  int32_t a, b, c,
+          d, e, f;
+  bool    valid;
+} tsFixedMatrix_t;
+
 typedef struct
 {
   uint32_t xraw;  // Touch screen x
@@ -98,6 +113,25 @@ typedef enum
   TS_ERROR_XYMISMATCH   = -2    // Unable to get a stable X/Y value
 } tsTouchError_t;
 
+#ifdef CFG_TFTLCD_TS_IRQ
+typedef enum
+{
+  TS_EVENT_DOWN         = 0,    // Pen touched the screen
+  TS_EVENT_MOVE,                // Pen moved while touching the screen
+  TS_EVENT_UP                   // Pen lifted (at the last known position)
+} tsEventType_t;
+
+typedef struct
+{
+  tsEventType_t type;
+  uint16_t xraw;      // Touch screen X
+  uint16_t yraw;      // Touch screen Y
+  uint16_t xlcd;      // LCD co-ordinate X
+  uint16_t ylcd;      // LCD co-ordinate Y
+  uint32_t timestamp; // systickGetTicks() when the event was sampled
+} tsEvent_t;
+#endif
+
 // Method Prototypes
 void           tsInit ( void );
 tsTouchError_t tsRead(tsTouchData_t* data);
@@ -106,4 +140,12 @@ tsTouchError_t tsWaitForEvent(tsTouchData_t* data, uint32_t timeoutMS);
 int            tsSetThreshhold(uint8_t value);
 uint8_t        tsGetThreshhold(void);
 
+#ifdef CFG_TFTLCD_TS_IRQ
+void           tsEventsStart ( void );
+void           tsEventsStop ( void );
+bool           tsGetEvent ( tsEvent_t *event );
+void           tsPenDownIRQ ( void );
+void           tsTimerProc ( void );
+#endif
+
 #endif
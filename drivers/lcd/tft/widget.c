@@ -0,0 +1,626 @@
+/**************************************************************************/
+/*! 
+    @file     widget.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Retained widget tree with damage tracking
+
+    @section DESCRIPTION
+
+    The drawing functions in drawing.c have no memory of what is on the
+    screen, so anything that changes has to be redrawn by the caller.
+    This module keeps a small tree of widgets (statically allocated,
+    CFG_TFTLCD_WIDGETS nodes) together with a list of damaged screen
+    regions.  Changing a widget only records its bounding box, and
+    widgetPaint then clears and repaints each damaged region once,
+    drawing every visible widget that overlaps it in tree order.
+
+    Overlapping damage is merged as it is recorded, so invalidating the
+    same widget several times (or several neighbouring widgets) between
+    two paint passes costs a single repaint.
+
+    If CFG_TFTLCD_TILEBUFFER is enabled, each region is rendered through
+    drawComposite, so it is clipped and sent to the LCD in windowed
+    bursts without flicker.  Otherwise (or if a region is too wide for
+    the tile buffer) the region is first grown to cover every widget it
+    touches, cleared with one windowed fill and the widgets are painted
+    directly on top.
+
+    The same bounding boxes are used for touch hit-testing, which
+    returns the topmost visible widget with WIDGET_FLAG_TOUCH set.
+
+    @section Example
+
+    @code 
+
+    #include "drivers/lcd/tft/widget.h"
+    #include "drivers/lcd/tft/fonts/dejavusans9.h"
+
+    widget_t *bar, *ok;
+    uint8_t i;
+
+    widgetReset(COLOR_BLACK);
+    bar = widgetCreate(NULL, WIDGET_TYPE_PROGRESS, 20, 100, 200, 20);
+    ok = widgetCreate(NULL, WIDGET_TYPE_BUTTON, 70, 250, 100, 30);
+    ok->font = &dejaVuSans9ptFontInfo;
+    ok->text = "OK";
+    widgetPaint();
+
+    // Only the progress bar is sent to the LCD each time
+    for (i = 0; i <= 100; i++)
+    {
+      widgetSetValue(bar, i);
+      widgetPaint();
+      systickDelay(50);
+    }
+
+    // Wait for the OK button
+    while (widgetWaitForTouch() != ok);
+
+    @endcode
+	
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "widget.h"
+
+#if defined CFG_TFTLCD_WIDGETS && CFG_TFTLCD_WIDGETS > 0
+
+#include "drivers/lcd/tft/lcd.h"
+#include "drivers/lcd/tft/drawing.h"
+#include "drivers/lcd/tft/touchscreen.h"
+
+typedef struct
+{
+  uint16_t x0, y0, x1, y1;              /* Inclusive screen co-ordinates */
+} widgetRect_t;
+
+static widget_t widgetPool[CFG_TFTLCD_WIDGETS];
+static uint8_t widgetCount = 0;
+static widget_t *widgetRoot = NULL;     /* First top-level widget */
+static uint16_t widgetBackground = COLOR_BLACK;
+
+static widgetRect_t widgetDamage[WIDGET_MAXDAMAGE];
+static uint8_t widgetDamageCount = 0;
+
+/* Region being painted, used by the drawComposite callback */
+static widgetRect_t widgetClip;
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Private Methods ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Returns the widget after 'widget' in paint order (parents
+            before children, children in order), optionally skipping
+            the children of 'widget'
+*/
+/**************************************************************************/
+static widget_t *widgetNext(widget_t *widget, bool children)
+{
+  if (children && widget->child)
+  {
+    return widget->child;
+  }
+  while (widget)
+  {
+    if (widget->next)
+    {
+      return widget->next;
+    }
+    widget = widget->parent;
+  }
+  return NULL;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the screen area covered by a widget
+*/
+/**************************************************************************/
+static void widgetGetRect(widget_t *widget, widgetRect_t *rect)
+{
+  rect->x0 = widget->x;
+  rect->y0 = widget->y;
+  rect->x1 = widget->x + widget->width - 1;
+  rect->y1 = widget->y + widget->height - 1;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks whether two rectangles overlap
+*/
+/**************************************************************************/
+static bool widgetRectOverlaps(const widgetRect_t *a, const widgetRect_t *b)
+{
+  return (a->x0 <= b->x1) && (b->x0 <= a->x1) && (a->y0 <= b->y1) && (b->y0 <= a->y1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Grows 'a' to include 'b'
+*/
+/**************************************************************************/
+static void widgetRectUnion(widgetRect_t *a, const widgetRect_t *b)
+{
+  if (b->x0 < a->x0) a->x0 = b->x0;
+  if (b->y0 < a->y0) a->y0 = b->y0;
+  if (b->x1 > a->x1) a->x1 = b->x1;
+  if (b->y1 > a->y1) a->y1 = b->y1;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the number of pixels in the union of 'a' and 'b'
+*/
+/**************************************************************************/
+static uint32_t widgetRectUnionArea(const widgetRect_t *a, const widgetRect_t *b)
+{
+  widgetRect_t u = *a;
+  widgetRectUnion(&u, b);
+  return (uint32_t)(u.x1 - u.x0 + 1) * (u.y1 - u.y0 + 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws a single widget
+*/
+/**************************************************************************/
+static void widgetDraw(widget_t *widget)
+{
+  uint16_t fg, bg, x1, y1;
+
+  fg = widget->fgColor;
+  bg = widget->bgColor;
+  if (widget->flags & WIDGET_FLAG_SELECTED)
+  {
+    fg = widget->bgColor;
+    bg = widget->fgColor;
+  }
+  x1 = widget->x + widget->width - 1;
+  y1 = widget->y + widget->height - 1;
+
+  switch (widget->type)
+  {
+    case WIDGET_TYPE_PANEL:
+      drawRectangleFilled(widget->x, widget->y, x1, y1, bg);
+      if (widget->borderColor != bg)
+      {
+        drawRectangle(widget->x, widget->y, x1, y1, widget->borderColor);
+      }
+      break;
+    case WIDGET_TYPE_LABEL:
+      drawRectangleFilled(widget->x, widget->y, x1, y1, bg);
+      if (widget->text && widget->font)
+      {
+        // drawString's y co-ordinate is 7 lines below the top of the glyphs
+        drawString(widget->x, widget->y + 7, fg, widget->font, widget->text);
+      }
+      break;
+    case WIDGET_TYPE_BUTTON:
+      drawButton(widget->x, widget->y, widget->width - 1, widget->height - 1, widget->font, 
+                 widget->font ? widget->font->heightPages * 8 : 0, 
+                 widget->borderColor, bg, fg, widget->font ? widget->text : NULL);
+      break;
+    case WIDGET_TYPE_PROGRESS:
+      drawProgressBar(widget->x, widget->y, widget->width - 1, widget->height - 1, 
+                      DRAW_ROUNDEDCORNERS_ALL, DRAW_ROUNDEDCORNERS_ALL, 
+                      widget->borderColor, bg, fg, fg, widget->value);
+      break;
+    case WIDGET_TYPE_ICON16:
+      if (widget->icon && (widget->width == 16) && (widget->height == 16))
+      {
+        drawIcon16Opaque(widget->x, widget->y, fg, bg, widget->icon);
+        break;
+      }
+      drawRectangleFilled(widget->x, widget->y, x1, y1, bg);
+      if (widget->icon)
+      {
+        drawIcon16(widget->x, widget->y, fg, widget->icon);
+      }
+      break;
+    case WIDGET_TYPE_CUSTOM:
+      if (widget->paint)
+      {
+        widget->paint(widget);
+      }
+      break;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draws every visible widget overlapping widgetClip
+*/
+/**************************************************************************/
+static void widgetRenderClip(void)
+{
+  widget_t *widget = widgetRoot;
+  widgetRect_t rect;
+
+  while (widget)
+  {
+    if (!(widget->flags & WIDGET_FLAG_VISIBLE))
+    {
+      // Hidden widgets hide their children as well
+      widget = widgetNext(widget, FALSE);
+      continue;
+    }
+    widgetGetRect(widget, &rect);
+    if (widgetRectOverlaps(&rect, &widgetClip))
+    {
+      widgetDraw(widget);
+    }
+    widget = widgetNext(widget, TRUE);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Grows widgetClip until it fully covers every visible widget
+            that it overlaps, so that widgets can be drawn unclipped
+            without overwriting anything outside the cleared region
+*/
+/**************************************************************************/
+static void widgetGrowClip(void)
+{
+  widget_t *widget;
+  widgetRect_t rect;
+  bool grown = TRUE;
+
+  while (grown)
+  {
+    grown = FALSE;
+    widget = widgetRoot;
+    while (widget)
+    {
+      if (!(widget->flags & WIDGET_FLAG_VISIBLE))
+      {
+        widget = widgetNext(widget, FALSE);
+        continue;
+      }
+      widgetGetRect(widget, &rect);
+      if (widgetRectOverlaps(&rect, &widgetClip) &&
+          ((rect.x0 < widgetClip.x0) || (rect.y0 < widgetClip.y0) ||
+           (rect.x1 > widgetClip.x1) || (rect.y1 > widgetClip.y1)))
+      {
+        widgetRectUnion(&widgetClip, &rect);
+        grown = TRUE;
+      }
+      widget = widgetNext(widget, TRUE);
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clears and repaints one damaged region
+*/
+/**************************************************************************/
+static void widgetPaintRegion(const widgetRect_t *region)
+{
+  widgetClip = *region;
+
+  #if defined CFG_TFTLCD_TILEBUFFER && CFG_TFTLCD_TILEBUFFER > 0
+  if (widgetClip.x1 - widgetClip.x0 + 1 <= CFG_TFTLCD_TILEBUFFER)
+  {
+    drawComposite(widgetClip.x0, widgetClip.y0, widgetClip.x1, widgetClip.y1, widgetBackground, widgetRenderClip);
+    return;
+  }
+  #endif
+
+  widgetGrowClip();
+  drawRectangleFilled(widgetClip.x0, widgetClip.y0, widgetClip.x1, widgetClip.y1, widgetBackground);
+  widgetRenderClip();
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ----------------------- Public Methods ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Releases every widget and marks the whole screen as damaged
+
+    @param[in]  background
+                Color shown wherever there is no widget
+*/
+/**************************************************************************/
+void widgetReset(uint16_t background)
+{
+  widgetCount = 0;
+  widgetRoot = NULL;
+  widgetBackground = background;
+  widgetDamageCount = 0;
+  widgetInvalidateRect(0, 0, lcdGetWidth() - 1, lcdGetHeight() - 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Allocates a visible widget and adds it as the last child of
+            'parent' (or as the last top-level widget if 'parent' is
+            NULL), so that it is drawn on top of its siblings
+
+    @param[in]  parent
+                Parent widget, or NULL
+    @param[in]  type
+                Widget type
+    @param[in]  x, y
+                Top left corner in screen co-ordinates
+    @param[in]  width, height
+                Size in pixels
+
+    @return     The new widget, with default colors, or NULL if the
+                pool is full or the widget isn't entirely on screen
+*/
+/**************************************************************************/
+widget_t *widgetCreate(widget_t *parent, widgetType_t type, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+  widget_t *widget, **link;
+
+  if ((widgetCount >= CFG_TFTLCD_WIDGETS) || (width == 0) || (height == 0) ||
+      (x + width > lcdGetWidth()) || (y + height > lcdGetHeight()))
+  {
+    return NULL;
+  }
+
+  widget = &widgetPool[widgetCount++];
+  memset(widget, 0, sizeof(widget_t));
+  widget->x = x;
+  widget->y = y;
+  widget->width = width;
+  widget->height = height;
+  widget->type = type;
+  widget->flags = WIDGET_FLAG_VISIBLE;
+  widget->fgColor = COLOR_WHITE;
+  widget->bgColor = COLOR_GRAY_30;
+  widget->borderColor = COLOR_GRAY_30;
+  if (type == WIDGET_TYPE_BUTTON)
+  {
+    widget->flags |= WIDGET_FLAG_TOUCH;
+  }
+  else if (type == WIDGET_TYPE_PROGRESS)
+  {
+    widget->fgColor = COLOR_THEME_DEFAULT_BASE;
+  }
+
+  // Append to the parent's (or the top-level) list
+  widget->parent = parent;
+  link = parent ? &parent->child : &widgetRoot;
+  while (*link)
+  {
+    link = &(*link)->next;
+  }
+  *link = widget;
+
+  widgetInvalidate(widget);
+  return widget;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Marks the area covered by a widget as needing to be redrawn
+*/
+/**************************************************************************/
+void widgetInvalidate(widget_t *widget)
+{
+  widgetInvalidateRect(widget->x, widget->y, widget->x + widget->width - 1, widget->y + widget->height - 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Marks a screen area as needing to be redrawn by the next
+            call to widgetPaint, merging it with any damage it overlaps
+*/
+/**************************************************************************/
+void widgetInvalidateRect(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+  widgetRect_t rect;
+  uint32_t area, best;
+  uint8_t i, merge;
+
+  if (x1 < x0) { rect.x0 = x1; rect.x1 = x0; } else { rect.x0 = x0; rect.x1 = x1; }
+  if (y1 < y0) { rect.y0 = y1; rect.y1 = y0; } else { rect.y0 = y0; rect.y1 = y1; }
+  if ((rect.x0 >= lcdGetWidth()) || (rect.y0 >= lcdGetHeight()))
+  {
+    return;
+  }
+  if (rect.x1 >= lcdGetWidth()) rect.x1 = lcdGetWidth() - 1;
+  if (rect.y1 >= lcdGetHeight()) rect.y1 = lcdGetHeight() - 1;
+
+  // Absorb any regions that overlap the new one (which may in turn
+  // make it overlap regions that were checked earlier)
+  i = 0;
+  while (i < widgetDamageCount)
+  {
+    if (widgetRectOverlaps(&rect, &widgetDamage[i]))
+    {
+      widgetRectUnion(&rect, &widgetDamage[i]);
+      widgetDamage[i] = widgetDamage[--widgetDamageCount];
+      i = 0;
+      continue;
+    }
+    i++;
+  }
+
+  if (widgetDamageCount < WIDGET_MAXDAMAGE)
+  {
+    widgetDamage[widgetDamageCount++] = rect;
+    return;
+  }
+
+  // No room left, merge with the region that grows the least
+  merge = 0;
+  best = 0xFFFFFFFF;
+  for (i = 0; i < widgetDamageCount; i++)
+  {
+    area = widgetRectUnionArea(&widgetDamage[i], &rect);
+    if (area < best)
+    {
+      best = area;
+      merge = i;
+    }
+  }
+  widgetRectUnion(&rect, &widgetDamage[merge]);
+  widgetDamage[merge] = widgetDamage[--widgetDamageCount];
+  widgetInvalidateRect(rect.x0, rect.y0, rect.x1, rect.y1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Changes the text of a label or button
+*/
+/**************************************************************************/
+void widgetSetText(widget_t *widget, char *text)
+{
+  // The same buffer may hold new contents, so the pointers can't be
+  // compared to decide whether anything changed
+  widget->text = text;
+  widgetInvalidate(widget);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Changes the value of a progress bar (0..100)
+*/
+/**************************************************************************/
+void widgetSetValue(widget_t *widget, uint8_t value)
+{
+  if (widget->value != value)
+  {
+    widget->value = value;
+    widgetInvalidate(widget);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Selects or deselects a widget
+*/
+/**************************************************************************/
+void widgetSetSelected(widget_t *widget, bool selected)
+{
+  if (!(widget->flags & WIDGET_FLAG_SELECTED) != !selected)
+  {
+    widget->flags ^= WIDGET_FLAG_SELECTED;
+    widgetInvalidate(widget);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Shows or hides a widget and its children
+*/
+/**************************************************************************/
+void widgetSetVisible(widget_t *widget, bool visible)
+{
+  if (!(widget->flags & WIDGET_FLAG_VISIBLE) != !visible)
+  {
+    widget->flags ^= WIDGET_FLAG_VISIBLE;
+    widgetInvalidate(widget);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Repaints all damaged regions and clears the damage list
+*/
+/**************************************************************************/
+void widgetPaint(void)
+{
+  widgetRect_t region;
+
+  while (widgetDamageCount)
+  {
+    region = widgetDamage[--widgetDamageCount];
+    widgetPaintRegion(&region);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the topmost visible widget at the supplied screen
+            co-ordinates that has WIDGET_FLAG_TOUCH set, or NULL
+*/
+/**************************************************************************/
+widget_t *widgetHitTest(uint16_t x, uint16_t y)
+{
+  widget_t *widget = widgetRoot;
+  widget_t *hit = NULL;
+
+  while (widget)
+  {
+    if (!(widget->flags & WIDGET_FLAG_VISIBLE))
+    {
+      widget = widgetNext(widget, FALSE);
+      continue;
+    }
+    // Widgets later in paint order are on top
+    if ((widget->flags & WIDGET_FLAG_TOUCH) &&
+        (x >= widget->x) && (x < widget->x + widget->width) &&
+        (y >= widget->y) && (y < widget->y + widget->height))
+    {
+      hit = widget;
+    }
+    widget = widgetNext(widget, TRUE);
+  }
+
+  return hit;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Waits for a touch event (painting pending damage first) and
+            returns the widget that was touched, or NULL if the touch
+            didn't land on a touchable widget
+*/
+/**************************************************************************/
+widget_t *widgetWaitForTouch(void)
+{
+  tsTouchData_t data;
+  int32_t tsError = -1;
+
+  widgetPaint();
+  while (tsError)
+  {
+    tsError = tsWaitForEvent(&data, 0);
+  }
+
+  return widgetHitTest(data.xlcd, data.ylcd);
+}
+
+#endif
@@ -0,0 +1,114 @@
+/**************************************************************************/
+/*! 
+    @file     widget.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef __WIDGET_H__
+#define __WIDGET_H__
+
+#include "projectconfig.h"
+#include "drivers/lcd/tft/fonts/bitmapfonts.h"
+
+#if defined CFG_TFTLCD_WIDGETS && CFG_TFTLCD_WIDGETS > 0
+
+/* Number of separate damage regions tracked between two paint passes.
+   When a new region can't be merged and the list is full, it is merged
+   with the region that grows the least. */
+#define WIDGET_MAXDAMAGE      (4)
+
+/* Widget flags */
+#define WIDGET_FLAG_VISIBLE   (0x01)    /* Widget and its children are drawn */
+#define WIDGET_FLAG_SELECTED  (0x02)    /* Drawn with fgColor/bgColor swapped */
+#define WIDGET_FLAG_TOUCH     (0x04)    /* Returned by widgetHitTest */
+
+typedef enum
+{
+  WIDGET_TYPE_PANEL = 0,                /* Filled rectangle with a border */
+  WIDGET_TYPE_LABEL = 1,                /* Text on a solid background */
+  WIDGET_TYPE_BUTTON = 2,               /* drawButton */
+  WIDGET_TYPE_PROGRESS = 3,             /* drawProgressBar using 'value' */
+  WIDGET_TYPE_ICON16 = 4,               /* drawIcon16 on a solid background */
+  WIDGET_TYPE_CUSTOM = 5                /* Drawn by the 'paint' callback */
+} widgetType_t;
+
+struct widget_s;
+typedef void (*widgetPaintCallback_t)(struct widget_s *widget);
+
+/**************************************************************************/
+/*!
+    @brief  Retained widget node.  Widgets are allocated from a static
+            pool by widgetCreate.  Positions are absolute screen
+            co-ordinates, and children are drawn after (on top of)
+            their parent and any earlier siblings.
+
+            Fields can be changed directly as long as widgetInvalidate
+            is called afterwards, or through the widgetSet* helpers
+            which only invalidate the widget if something changed.
+*/
+/**************************************************************************/
+typedef struct widget_s
+{
+  uint16_t              x;              /* Left edge                    */
+  uint16_t              y;              /* Top edge                     */
+  uint16_t              width;          /* Width in pixels              */
+  uint16_t              height;         /* Height in pixels             */
+  uint8_t               type;           /* widgetType_t                 */
+  uint8_t               flags;          /* WIDGET_FLAG_*                */
+  uint8_t               value;          /* Progress in percent          */
+  uint16_t              fgColor;        /* Text, icon or progress bar   */
+  uint16_t              bgColor;        /* Fill                         */
+  uint16_t              borderColor;    /* Border                       */
+  const FONT_INFO       *font;          /* Font for 'text'              */
+  char                  *text;          /* Label or button text         */
+  uint16_t              *icon;          /* 16x16 icon data              */
+  widgetPaintCallback_t paint;          /* WIDGET_TYPE_CUSTOM only      */
+  struct widget_s       *parent;
+  struct widget_s       *child;         /* First child                  */
+  struct widget_s       *next;          /* Next sibling                 */
+} widget_t;
+
+void      widgetReset          ( uint16_t background );
+widget_t *widgetCreate         ( widget_t *parent, widgetType_t type, uint16_t x, uint16_t y, uint16_t width, uint16_t height );
+void      widgetInvalidate     ( widget_t *widget );
+void      widgetInvalidateRect ( uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1 );
+void      widgetSetText        ( widget_t *widget, char *text );
+void      widgetSetValue       ( widget_t *widget, uint8_t value );
+void      widgetSetSelected    ( widget_t *widget, bool selected );
+void      widgetSetVisible     ( widget_t *widget, bool visible );
+void      widgetPaint          ( void );
+widget_t *widgetHitTest        ( uint16_t x, uint16_t y );
+widget_t *widgetWaitForTouch   ( void );
+
+#endif
+
+#endif
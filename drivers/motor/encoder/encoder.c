@@ -0,0 +1,227 @@
+/**************************************************************************/
+/*! 
+    @file     encoder.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Quadrature encoder decoder.  Both edges of both encoder
+              outputs (A and B) raise a GPIO interrupt, and the handler
+              reads the two pins with a single masked load and looks the
+              old and new states up in a 16 entry table, which gives
+              +1, -1 or 0 counts (full x4 decoding, so a 500 line
+              encoder gives 2000 counts per revolution).  A transition
+              where both outputs changed at once means an edge was
+              missed; it isn't counted, but is recorded in the error
+              count.
+
+              When A leads B the count goes up.  Swap the pins to count
+              the other way.  The pins are left with their default
+              pull-up, which suits open collector encoders.
+
+              Encoders can be attached to stepper axes with
+              stepperAxisSetEncoder, to catch and make up missed steps.
+
+    @section Example
+
+    @code 
+    #include "drivers/motor/encoder/encoder.h"
+
+    // Encoder on 2.4 (A) and 2.5 (B)
+    encoderInit(0, 2, 4, 5);
+
+    while (1)
+    {
+      printf("%d%s", (int)encoderGetCount(0), CFG_PRINTF_NEWLINE);
+      systickDelay(100);
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include "encoder.h"
+#include "core/gpio/gpio.h"
+
+#ifdef CFG_ENCODER
+
+typedef struct
+{
+  REG32    *data;                         // Masked GPIO data register for A and B
+  uint8_t  pinA;
+  uint8_t  pinB;
+  uint8_t  state;                         // Last state (A << 1 | B)
+  volatile int32_t  count;
+  volatile uint32_t errors;               // Transitions with both outputs changed
+} encoderChannel_t;
+
+static encoderChannel_t encoders[ENCODER_CHANNELS];
+
+/* Count change for each (old state << 2 | new state), where a state is
+   (A << 1 | B).  Forward is 00 -> 10 -> 11 -> 01 -> 00. */
+static const int8_t encoderTable[16] =
+{
+   0, -1,  1,  0,
+   1,  0,  0, -1,
+  -1,  0,  0,  1,
+   0,  1, -1,  0
+};
+
+/**************************************************************************/
+/*! 
+    Private - Reads the current state of a channel
+*/
+/**************************************************************************/
+static inline uint8_t encoderRead(encoderChannel_t *enc)
+{
+  uint32_t value = *enc->data;
+
+  return (((value >> enc->pinA) & 1) << 1) | ((value >> enc->pinB) & 1);
+}
+
+/**************************************************************************/
+/*! 
+    Private - Decodes one transition (called from the GPIO interrupt)
+*/
+/**************************************************************************/
+static inline void encoderUpdate(encoderChannel_t *enc)
+{
+  uint8_t state = encoderRead(enc);
+  int8_t delta = encoderTable[(enc->state << 2) | state];
+
+  if (delta)
+  {
+    enc->count += delta;
+  }
+  else if (state != enc->state)
+  {
+    enc->errors++;
+  }
+  enc->state = state;
+}
+
+static void encoderIRQ0(void)
+{
+  encoderUpdate(&encoders[0]);
+}
+
+static void encoderIRQ1(void)
+{
+  encoderUpdate(&encoders[1]);
+}
+
+static const gpioIntCallback_t encoderIRQs[ENCODER_CHANNELS] = { encoderIRQ0, encoderIRQ1 };
+
+/**************************************************************************/
+/*! 
+    @brief      Sets up a quadrature encoder on two pins of the same port
+                and starts counting from 0
+
+    @param[in]  channel
+                The encoder (0..ENCODER_CHANNELS-1)
+    @param[in]  port
+                The GPIO port of both pins
+    @param[in]  pinA
+                The pin number of output A
+    @param[in]  pinB
+                The pin number of output B
+
+    @return     false if the channel or pins are out of range, or there
+                aren't enough GPIO interrupt callbacks left
+*/
+/**************************************************************************/
+bool encoderInit(uint8_t channel, uint32_t port, uint32_t pinA, uint32_t pinB)
+{
+  encoderChannel_t *enc;
+
+  if ((channel >= ENCODER_CHANNELS) || (port > 3) || (pinA > 11) || (pinB > 11) || (pinA == pinB))
+  {
+    return false;
+  }
+  enc = &encoders[channel];
+
+  gpioSetDir(port, pinA, gpioDirection_Input);
+  gpioSetDir(port, pinB, gpioDirection_Input);
+
+  enc->data = &GPIO_MASKEDDATA(port, (1 << pinA) | (1 << pinB));
+  enc->pinA = pinA;
+  enc->pinB = pinB;
+  enc->state = encoderRead(enc);
+  enc->count = 0;
+  enc->errors = 0;
+
+  if (!gpioAttachInterrupt(port, pinA, gpioInterruptSense_Edge, gpioInterruptEdge_Double,
+                           gpioInterruptEvent_ActiveHigh, encoderIRQs[channel]))
+  {
+    return false;
+  }
+  if (!gpioAttachInterrupt(port, pinB, gpioInterruptSense_Edge, gpioInterruptEdge_Double,
+                           gpioInterruptEvent_ActiveHigh, encoderIRQs[channel]))
+  {
+    gpioDetachInterrupt(port, pinA);
+    return false;
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Returns the current count of an encoder
+*/
+/**************************************************************************/
+int32_t encoderGetCount(uint8_t channel)
+{
+  return encoders[channel % ENCODER_CHANNELS].count;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Sets the current count of an encoder
+*/
+/**************************************************************************/
+void encoderSetCount(uint8_t channel, int32_t count)
+{
+  __disable_irq();
+  encoders[channel % ENCODER_CHANNELS].count = count;
+  __enable_irq();
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Returns the number of invalid transitions seen (both
+                outputs changing at once, so at least one edge was
+                missed)
+*/
+/**************************************************************************/
+uint32_t encoderGetErrors(uint8_t channel)
+{
+  return encoders[channel % ENCODER_CHANNELS].errors;
+}
+
+#endif
@@ -9,6 +9,52 @@
               position handling methods to keep track of the motor's
               relative position and the spindle's current rotation.
 
+              Steps are generated from the 32-bit timer 0 match
+              interrupt, so stepperMove and stepperMoveTo return right
+              away while the motor runs in the background.  With an
+              acceleration set (stepperSetAcceleration) the motor ramps
+              up to the speed set with stepperSetSpeed and back down to
+              stop on the target, with a trapezoidal profile.  The step
+              intervals are calculated incrementally in fixed point
+              (D. Austin, "Generate stepper-motor speed profiles in real
+              time", 2005) so the interrupt needs no square roots.
+
+              Up to CFG_STEPPER_AXES motors share the timer.  Each move
+              is a segment in a queue of CFG_STEPPER_QUEUESIZE entries:
+              the axis with the most steps (the major axis) sets the
+              pace and the other axes are stepped along with it
+              Bresenham style, so they all start and finish together.
+              When a segment is queued the whole queue is re-planned:
+              the speed at each junction is limited by the angle between
+              the two moves (full speed when they are in line, a stop on
+              a reversal or right angle), and the entry speeds are then
+              lowered where needed so that every segment can still slow
+              down in time for the next one and the queue ends at rest.
+              Speeds are in steps/s of each segment's major axis.
+
+              With CFG_ENCODER an axis can have a quadrature encoder
+              attached (stepperAxisSetEncoder).  Before each step the
+              step interrupt compares the encoder with the position it
+              has commanded, and if they are more than
+              CFG_STEPPER_ENCODER_TOLERANCE steps apart the motor has
+              slipped: the position is corrected to what the encoder
+              reads, and the missing steps are made up with an extra
+              move once the queue has run out, so queued moves still end
+              where they were planned.  If the steps can't be made up
+              after STEPPER_MAXCORRECTIONS tries the axis is taken to be
+              stalled (stepperIsStalled).
+
+              With CFG_STEPPER_MICROSTEPS above 1, axis 0 is microstepped:
+              each step moves the coil currents 1/CFG_STEPPER_MICROSTEPS
+              of a full step along a sine/cosine curve.  The two coil
+              currents are set with the PWM outputs of 16-bit timer 1
+              (MAT0 on 1.9 for coil A, MAT1 on 1.10 for coil B, wired to
+              the bridge enable pins) from a quarter wave table in flash,
+              and IN1..IN4 only set the direction of each coil.  They are
+              updated from the step interrupt with the rest of the step.
+              Positions, speeds and steps per rotation of axis 0 are then
+              in microsteps.
+
     @section Example
 
     @code 
@@ -26,8 +72,8 @@
 
     while (1)
     {
-      stepperStep(400);       // Move forward 400 steps
-      stepperStep(-200);      // Move backward 200 steps
+      stepperStep(400);       // Move forward 400 steps (blocking)
+      stepperStep(-200);      // Move backward 200 steps (blocking)
       systickDelay(1000);     // Wait one second
 
       // Move 'home' after 10 loops (current position = 2000)
@@ -40,6 +86,23 @@
 
     @endcode    
 
+    Pan/tilt rig with the tilt motor on 2.0-2.3 (CFG_STEPPER_AXES = 2):
+
+    @code 
+    int32_t path[4][2] = { { 400, 0 }, { 400, 400 }, { 0, 400 }, { -800, -800 } };
+    uint8_t i;
+
+    stepperInit(200);                           // Axis 0 on 3.0-3.3
+    stepperAxisInit(1, 2, 0, 1, 2, 3, 200);     // Axis 1 on 2.0-2.3
+    stepperSetAcceleration(2000);               // steps/s^2
+
+    for (i = 0; i < 4; i++)
+    {
+      // Wait for space in the queue, then queue the next segment
+      while (!stepperQueueMove(path[i], 800));
+    }
+    @endcode
+
     @section LICENSE
 
     Software License Agreement (BSD License)
@@ -74,78 +137,880 @@
 
 #include "stepper.h"
 #include "core/gpio/gpio.h"
-#include "core/timer32/timer32.h"
+#include "core/cpu/cpu.h"
+#include "core/dsp/dsp.h"
+
+#ifdef CFG_ENCODER
+#include "drivers/motor/encoder/encoder.h"
+#endif
+
+#define STEPPER_TIMERHZ     (1000000)     // 32-bit timer 0 runs at 1MHz
+#define STEPPER_MAXSPEED    (65535)       // steps/s, so that speed^2 fits in 32 bits
+#define STEPPER_MAXCORRECTIONS (3)        // Make-up moves in a row before giving up
+
+#if CFG_STEPPER_MICROSTEPS > 1
+#define STEPPER_PWMHZ       (20000)       // Coil PWM frequency (above hearing)
+#define STEPPER_SINESTEPS   (16)          // Table entries per quarter wave
+
+/* sin(i * 90 / STEPPER_SINESTEPS) * 255, for i = 0..STEPPER_SINESTEPS */
+static const uint8_t stepperSine[STEPPER_SINESTEPS + 1] =
+{
+    0,  25,  50,  74,  98, 120, 142, 162,
+  180, 197, 212, 225, 236, 244, 250, 254,
+  255
+};
+
+static uint32_t stepperPwmPeriod;         // Timer ticks per PWM period
+#endif
+
+typedef struct
+{
+  REG32    *data;                         // Masked GPIO data register for the coil pins
+  uint32_t pattern[4];                    // Coil patterns (IN1..IN4) for each step
+  int64_t  position;                      // The current position (in steps) relative to 'Home'
+  uint32_t stepNumber;                    // The current position (in steps) relative to 0
+  uint32_t stepsPerRotation;              // Number of steps in a full 360 rotation
+#if CFG_STEPPER_MICROSTEPS > 1
+  bool     microstep;                     // Coil currents set by PWM (axis 0 only)
+#endif
+#ifdef CFG_ENCODER
+  int8_t   encoder;                       // Encoder channel, or -1 for none
+  uint32_t stepsPerCount;                 // Steps per encoder count (Q16)
+  int32_t  encoderHome;                   // Encoder count at 'Home'
+  int32_t  makeup;                        // Steps still owed after a slip
+  uint32_t missed;                        // Total steps lost
+#endif
+} stepperAxis_t;
+
+typedef struct
+{
+  int32_t  delta[CFG_STEPPER_AXES];       // Steps to move on each axis
+  uint32_t steps;                         // Steps on the major axis (largest |delta|)
+  uint32_t nominal;                       // Cruise speed
+  uint32_t maxEntry;                      // Junction speed limit with the previous segment
+  uint32_t entry;                         // Planned entry speed
+} stepperSegment_t;
+
+typedef enum
+{
+  STEPPER_STATE_IDLE = 0,
+  STEPPER_STATE_ACCEL,
+  STEPPER_STATE_RUN,
+  STEPPER_STATE_DECEL
+} stepperState_t;
 
-static int64_t  stepperPosition = 0;          // The current position (in steps) relative to 'Home'
-static uint32_t stepperStepNumber = 0;        // The current position (in steps) relative to 0
-static uint32_t stepperStepsPerRotation = 0;  // Number of steps in a full 360 rotation
-static uint32_t stepperStepDelay = 0;         // Delay in CPU ticks between individual steps
+static volatile stepperAxis_t stepperAxes[CFG_STEPPER_AXES];
+static uint32_t stepperAccel = 0;             // Steps/s^2 (0 = constant speed)
+static uint32_t stepperDefaultSpeed = 1;      // Steps/s, set with stepperSetSpeed
+
+/* Segment queue: stepperQueueHead is the segment being run, and is only
+   advanced by the timer interrupt.  Segments are only added with the
+   timer interrupt disabled. */
+static stepperSegment_t stepperQueue[CFG_STEPPER_QUEUESIZE];
+static volatile uint8_t stepperQueueHead = 0;
+static volatile uint8_t stepperQueueCount = 0;
+static int64_t stepperPlanned[CFG_STEPPER_AXES]; // Position at the end of the queue
+static bool stepperPlannedValid = false;
+
+/* Only touched by the timer interrupt while a segment is running */
+static volatile stepperState_t stepperState = STEPPER_STATE_IDLE;
+static volatile uint32_t stepperStepsLeft = 0;
+static uint32_t stepperError[CFG_STEPPER_AXES]; // Bresenham error terms
+static uint32_t stepperRampStep = 0;          // Steps into the ramp = steps needed to stop
+static volatile uint32_t stepperExitRamp = 0; // Ramp step to slow down to by the end
+static uint32_t stepperDelay = 0;             // Current step interval (us, Q8)
+static uint32_t stepperMinDelay = 0;          // Step interval at cruise speed (us, Q8)
+#ifdef CFG_ENCODER
+static uint8_t stepperCorrections = 0;        // Make-up moves since the last queued move
+static bool stepperNoMakeup = false;          // Set by stepperStop
+static volatile bool stepperStalled = false;
+#endif
 
 /**************************************************************************/
 /*! 
-    Private - Cause the motor to step forward or backward one step
+    Private - Integer square root of a 64-bit value
 */
 /**************************************************************************/
-void stepMotor(uint32_t thisStep)
+static uint32_t stepperSqrt64(uint64_t value)
 {
-  switch (thisStep)
+  uint64_t root = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+
+  while (bit > value)
+  {
+    bit >>= 2;
+  }
+  while (bit)
+  {
+    if (value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return (uint32_t)root;
+}
+
+/**************************************************************************/
+/*! 
+    Private - Returns the interval before the first step from rest
+    (us, Q8): c0 = 0.676 * f * sqrt(2 / accel)
+*/
+/**************************************************************************/
+static uint32_t stepperFirstDelay(void)
+{
+  uint32_t root8;
+  uint64_t delay;
+
+  // sqrt(accel) in Q8, keeping as much precision as the range allows
+  root8 = (stepperAccel < 0x10000) ? dspSqrt(stepperAccel << 16) : (uint32_t)dspSqrt(stepperAccel) << 8;
+  if (!root8)
+  {
+    return 0x7FFFFFFF;
+  }
+
+  // 0.676 * 1MHz * sqrt(2) = 956008, scaled by 2^8 (Q8) * 2^8 (root8)
+  delay = ((uint64_t)956008 << 16) / root8;
+  return delay > 0x7FFFFFFF ? 0x7FFFFFFF : (uint32_t)delay;
+}
+
+/**************************************************************************/
+/*! 
+    Private - Step interval (us, Q8) at 'speed' steps/s
+*/
+/**************************************************************************/
+static inline uint32_t stepperDelayFor(uint32_t speed)
+{
+  return ((uint32_t)STEPPER_TIMERHZ << 8) / speed;
+}
+
+/**************************************************************************/
+/*! 
+    Private - Ramp step at which the speed reaches 'speed' steps/s
+    (v^2 = 2 * a * n)
+*/
+/**************************************************************************/
+static inline uint32_t stepperRampFor(uint32_t speed)
+{
+  return stepperAccel ? (speed * speed) / (2 * stepperAccel) : 0;
+}
+
+/**************************************************************************/
+/*! 
+    Private - Highest speed reached from 'speed' after accelerating
+    over 'steps' steps, capped at 'limit': sqrt(v^2 + 2 * a * n)
+*/
+/**************************************************************************/
+static uint32_t stepperReachable(uint32_t speed, uint32_t steps, uint32_t limit)
+{
+  uint64_t v2 = (uint64_t)speed * speed + (uint64_t)2 * stepperAccel * steps;
+
+  if (v2 >= (uint64_t)limit * limit)
+  {
+    return limit;
+  }
+  return dspSqrt((uint32_t)v2);
+}
+
+/**************************************************************************/
+/*! 
+    Private - Loads the next step interval into the timer
+*/
+/**************************************************************************/
+static inline void stepperSetDelay(uint32_t delayQ8)
+{
+  uint32_t us = delayQ8 >> 8;
+  TMR_TMR32B0MR0 = us ? us - 1 : 0;
+}
+
+#if CFG_STEPPER_MICROSTEPS > 1
+/**************************************************************************/
+/*! 
+    Private - Sets the PWM duty cycle of one coil (MR0 or MR1) for a
+    current of 'level' (0..255).  The output goes high when the timer
+    reaches the match value, and a match past the end of the period
+    keeps it low.
+*/
+/**************************************************************************/
+static inline uint32_t stepperPwmMatch(uint8_t level)
+{
+  return level ? stepperPwmPeriod - (stepperPwmPeriod * level) / 255 : 0xFFFF;
+}
+
+/**************************************************************************/
+/*! 
+    Private - Sets the coil currents of a microstepped axis for
+    'microstep' (0..4*CFG_STEPPER_MICROSTEPS-1 per electrical cycle):
+    coil A follows cos() and coil B sin() of the electrical angle, so
+    every CFG_STEPPER_MICROSTEPS microsteps make one full step.
+*/
+/**************************************************************************/
+static void stepperMicrostepSet(volatile stepperAxis_t *axis, uint32_t microstep)
+{
+  uint32_t quadrant = (microstep / CFG_STEPPER_MICROSTEPS) & 3;
+  uint32_t pos = (microstep % CFG_STEPPER_MICROSTEPS) * (STEPPER_SINESTEPS / CFG_STEPPER_MICROSTEPS);
+  uint8_t a, b;
+  uint32_t dir;
+
+  // The quadrant sets the direction of each coil (A on IN1/IN2, B on
+  // IN3/IN4, in the same order as the full step patterns)
+  switch (quadrant)
+  {
+    case 0:
+      a = stepperSine[STEPPER_SINESTEPS - pos];
+      b = stepperSine[pos];
+      dir = axis->pattern[0];
+      break;
+    case 1:
+      a = stepperSine[pos];
+      b = stepperSine[STEPPER_SINESTEPS - pos];
+      dir = axis->pattern[1];
+      break;
+    case 2:
+      a = stepperSine[STEPPER_SINESTEPS - pos];
+      b = stepperSine[pos];
+      dir = axis->pattern[2];
+      break;
+    default:
+      a = stepperSine[pos];
+      b = stepperSine[STEPPER_SINESTEPS - pos];
+      dir = axis->pattern[3];
+      break;
+  }
+
+  TMR_TMR16B1MR0 = stepperPwmMatch(a);
+  TMR_TMR16B1MR1 = stepperPwmMatch(b);
+  *axis->data = dir;
+}
+
+/**************************************************************************/
+/*! 
+    Private - Starts the coil PWM on 16-bit timer 1, MAT0 (1.9) and
+    MAT1 (1.10), with both coils off
+*/
+/**************************************************************************/
+static void stepperPwmInit(void)
+{
+  SCB_SYSAHBCLKCTRL |= (SCB_SYSAHBCLKCTRL_CT16B1);
+
+  IOCON_PIO1_9 &= ~IOCON_PIO1_9_FUNC_MASK;
+  IOCON_PIO1_9 |= IOCON_PIO1_9_FUNC_CT16B1_MAT0;
+  IOCON_PIO1_10 &= ~(IOCON_PIO1_10_FUNC_MASK | IOCON_PIO1_10_ADMODE_MASK);
+  IOCON_PIO1_10 |= (IOCON_PIO1_10_FUNC_CT16B1_MAT1 | IOCON_PIO1_10_ADMODE_DIGITAL);
+
+  stepperPwmPeriod = (cpuGetClock()/SCB_SYSAHBCLKDIV) / STEPPER_PWMHZ;
+  TMR_TMR16B1TCR = TMR_TMR16B1TCR_COUNTERRESET_ENABLED;
+  TMR_TMR16B1PR = 0;
+  TMR_TMR16B1MR3 = stepperPwmPeriod;
+  TMR_TMR16B1MR0 = 0xFFFF;
+  TMR_TMR16B1MR1 = 0xFFFF;
+  TMR_TMR16B1MCR = TMR_TMR16B1MCR_MR3_RESET_ENABLED;
+  TMR_TMR16B1PWMC = TMR_TMR16B1PWMC_PWM0_ENABLED | TMR_TMR16B1PWMC_PWM1_ENABLED | TMR_TMR16B1PWMC_PWM3_ENABLED;
+  TMR_TMR16B1TCR = TMR_TMR16B1TCR_COUNTERENABLE_ENABLED;
+}
+#endif
+
+/**************************************************************************/
+/*! 
+    Private - Moves one axis one step and energises its coils with a
+    single masked store to the GPIO port
+*/
+/**************************************************************************/
+static inline void stepperAxisStep(volatile stepperAxis_t *axis, bool forward)
+{
+  if (forward)
+  {
+    axis->position++;
+    if (++axis->stepNumber >= axis->stepsPerRotation)
+    {
+      axis->stepNumber = 0;
+    }
+  }
+  else
+  {
+    axis->position--;
+    if (axis->stepNumber == 0)
+    {
+      axis->stepNumber = axis->stepsPerRotation;
+    }
+    axis->stepNumber--;
+  }
+
+#if CFG_STEPPER_MICROSTEPS > 1
+  if (axis->microstep)
+  {
+    stepperMicrostepSet(axis, axis->stepNumber);
+    return;
+  }
+#endif
+  if (axis->data)
+  {
+    *axis->data = axis->pattern[axis->stepNumber & 3];
+  }
+}
+
+/**************************************************************************/
+/*! 
+    Private - Works out how far the running segment has to slow down,
+    which is the entry speed of the next one (or a stop)
+*/
+/**************************************************************************/
+static void stepperUpdateExit(void)
+{
+  if (stepperQueueCount > 1)
+  {
+    stepperExitRamp = stepperRampFor(stepperQueue[(stepperQueueHead + 1) % CFG_STEPPER_QUEUESIZE].entry);
+  }
+  else
+  {
+    stepperExitRamp = 0;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    Private - Sets the interrupt state up for the segment at the head of
+    the queue and loads its first interval
+*/
+/**************************************************************************/
+static void stepperSegmentStart(void)
+{
+  stepperSegment_t *seg = &stepperQueue[stepperQueueHead];
+  uint8_t i;
+
+  stepperStepsLeft = seg->steps;
+  for (i = 0; i < CFG_STEPPER_AXES; i++)
+  {
+    stepperError[i] = seg->steps / 2;
+  }
+
+  stepperMinDelay = stepperDelayFor(seg->nominal);
+  if (!stepperAccel)
+  {
+    stepperRampStep = 0;
+    stepperDelay = stepperMinDelay;
+  }
+  else if (seg->entry)
+  {
+    stepperRampStep = stepperRampFor(seg->entry);
+    stepperDelay = stepperDelayFor(seg->entry);
+  }
+  else
+  {
+    stepperRampStep = 0;
+    stepperDelay = stepperFirstDelay();
+  }
+
+  if (stepperDelay > stepperMinDelay)
+  {
+    stepperState = STEPPER_STATE_ACCEL;
+  }
+  else
+  {
+    stepperDelay = stepperMinDelay;
+    stepperState = STEPPER_STATE_RUN;
+  }
+
+  stepperUpdateExit();
+  stepperSetDelay(stepperDelay);
+}
+
+#ifdef CFG_ENCODER
+/**************************************************************************/
+/*! 
+    Private - Compares an axis with its encoder before the next step,
+    and takes the position from the encoder if the motor has slipped
+*/
+/**************************************************************************/
+static inline void stepperAxisCheck(volatile stepperAxis_t *axis)
+{
+  int32_t measured, error;
+
+  if (axis->encoder < 0)
+  {
+    return;
+  }
+
+  measured = (int32_t)(((int64_t)(encoderGetCount(axis->encoder) - axis->encoderHome) * axis->stepsPerCount + 0x8000) >> 16);
+  error = measured - (int32_t)axis->position;
+  if ((error > CFG_STEPPER_ENCODER_TOLERANCE) || (error < -CFG_STEPPER_ENCODER_TOLERANCE))
+  {
+    axis->position += error;
+    axis->makeup -= error;
+    axis->missed += abs(error);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    Private - Once the queue has run out, queues a move with the steps
+    that were lost on the way.  Called from the timer interrupt.
+
+    @return true if a make-up move was started
+*/
+/**************************************************************************/
+static bool stepperMakeupStart(void)
+{
+  stepperSegment_t *seg = &stepperQueue[stepperQueueHead];
+  uint32_t len;
+  uint8_t i;
+
+  seg->steps = 0;
+  for (i = 0; i < CFG_STEPPER_AXES; i++)
+  {
+    seg->delta[i] = stepperAxes[i].makeup;
+    stepperAxes[i].makeup = 0;
+    len = abs(seg->delta[i]);
+    if (len > seg->steps)
+    {
+      seg->steps = len;
+    }
+  }
+  if (!seg->steps || stepperNoMakeup)
+  {
+    return false;
+  }
+
+  if (stepperCorrections >= STEPPER_MAXCORRECTIONS)
+  {
+    stepperStalled = true;
+    return false;
+  }
+  stepperCorrections++;
+
+  seg->nominal = stepperDefaultSpeed;
+  seg->entry = 0;
+  seg->maxEntry = 0;
+  stepperQueueCount = 1;
+  stepperSegmentStart();
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    Private - Forgets any steps owed (the next move is relative to where
+    the motors really are)
+*/
+/**************************************************************************/
+static void stepperMakeupClear(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < CFG_STEPPER_AXES; i++)
+  {
+    stepperAxes[i].makeup = 0;
+  }
+}
+#endif
+
+/**************************************************************************/
+/*! 
+    Private - Stops the step timer
+*/
+/**************************************************************************/
+static void stepperTimerStop(void)
+{
+  TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERENABLE_DISABLED;
+  stepperState = STEPPER_STATE_IDLE;
+}
+
+/**************************************************************************/
+/*! 
+    Private - Called from the timer interrupt when the last queued
+    segment has finished
+*/
+/**************************************************************************/
+static void stepperQueueDone(void)
+{
+#ifdef CFG_ENCODER
+  if (stepperMakeupStart())
+  {
+    return;
+  }
+#endif
+  stepperTimerStop();
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Takes one step on the major axis (plus any other axes that
+            are due) and works out the interval to the next one.  Called
+            from TIMER32_0_IRQHandler on every MR0 match.
+*/
+/**************************************************************************/
+void stepperTimerIRQ(void)
+{
+  stepperSegment_t *seg;
+  uint8_t i;
+
+  if (stepperState == STEPPER_STATE_IDLE)
+  {
+    return;
+  }
+
+  // Bresenham: every axis gets |delta| steps spread over 'steps' ticks
+  seg = &stepperQueue[stepperQueueHead];
+  for (i = 0; i < CFG_STEPPER_AXES; i++)
   {
-    case 0: // 1010
-      gpioSetValue(STEPPER_IN1_PORT, STEPPER_IN1_PIN, 1);
-      gpioSetValue(STEPPER_IN2_PORT, STEPPER_IN2_PIN, 0);
-      gpioSetValue(STEPPER_IN3_PORT, STEPPER_IN3_PIN, 1);
-      gpioSetValue(STEPPER_IN4_PORT, STEPPER_IN4_PIN, 0);
+    stepperError[i] += abs(seg->delta[i]);
+    if (stepperError[i] >= seg->steps)
+    {
+      stepperError[i] -= seg->steps;
+#ifdef CFG_ENCODER
+      stepperAxisCheck(&stepperAxes[i]);
+#endif
+      stepperAxisStep(&stepperAxes[i], seg->delta[i] > 0);
+    }
+  }
+
+  if (--stepperStepsLeft == 0)
+  {
+    // On to the next segment, if there is one
+    stepperQueueHead = (stepperQueueHead + 1) % CFG_STEPPER_QUEUESIZE;
+    if (--stepperQueueCount)
+    {
+      stepperSegmentStart();
+    }
+    else
+    {
+      stepperQueueDone();
+    }
+    return;
+  }
+
+  // Start slowing down once the remaining steps are what it takes to
+  // get down to the exit speed
+  if ((stepperState != STEPPER_STATE_DECEL) && (stepperRampStep > stepperExitRamp) &&
+      (stepperStepsLeft <= stepperRampStep - stepperExitRamp))
+  {
+    stepperState = STEPPER_STATE_DECEL;
+  }
+
+  switch (stepperState)
+  {
+    case STEPPER_STATE_ACCEL:
+      // c(n) = c(n-1) - 2 * c(n-1) / (4n + 1)
+      stepperRampStep++;
+      stepperDelay -= (2 * stepperDelay) / (4 * stepperRampStep + 1);
+      if (stepperDelay <= stepperMinDelay)
+      {
+        stepperDelay = stepperMinDelay;
+        stepperState = STEPPER_STATE_RUN;
+      }
       break;
-    case 1: // 0110
-      gpioSetValue(STEPPER_IN1_PORT, STEPPER_IN1_PIN, 0);
-      gpioSetValue(STEPPER_IN2_PORT, STEPPER_IN2_PIN, 1);
-      gpioSetValue(STEPPER_IN3_PORT, STEPPER_IN3_PIN, 1);
-      gpioSetValue(STEPPER_IN4_PORT, STEPPER_IN4_PIN, 0);
+    case STEPPER_STATE_DECEL:
+      // The acceleration ramp backwards: c(n-1) = c(n) + 2 * c(n) / (4n - 1)
+      if (stepperRampStep > stepperExitRamp)
+      {
+        stepperDelay += (2 * stepperDelay) / (4 * stepperRampStep - 1);
+        stepperRampStep--;
+      }
       break;
-    case 2: // 0101
-      gpioSetValue(STEPPER_IN1_PORT, STEPPER_IN1_PIN, 0);
-      gpioSetValue(STEPPER_IN2_PORT, STEPPER_IN2_PIN, 1);
-      gpioSetValue(STEPPER_IN3_PORT, STEPPER_IN3_PIN, 0);
-      gpioSetValue(STEPPER_IN4_PORT, STEPPER_IN4_PIN, 1);
+    default:
       break;
-    case 3: // 1001
-      gpioSetValue(STEPPER_IN1_PORT, STEPPER_IN1_PIN, 1);
-      gpioSetValue(STEPPER_IN2_PORT, STEPPER_IN2_PIN, 0);
-      gpioSetValue(STEPPER_IN3_PORT, STEPPER_IN3_PIN, 0);
-      gpioSetValue(STEPPER_IN4_PORT, STEPPER_IN4_PIN, 1);
-      break;     
   }
+
+  stepperSetDelay(stepperDelay);
 }
 
 /**************************************************************************/
 /*! 
-    @brief      Initialises the GPIO pins and delay timer and sets any
-                default values.
+    Private - Speed limit at the junction of two segments: the lower of
+    the two cruise speeds, scaled by the cosine of the angle between
+    them (so a reversal or a right angle needs a stop)
+*/
+/**************************************************************************/
+static uint32_t stepperJunctionSpeed(stepperSegment_t *prev, stepperSegment_t *next)
+{
+  int64_t dot = 0;
+  uint64_t len1 = 0, len2 = 0;
+  uint32_t speed, cosQ16;
+  uint8_t i;
+
+  for (i = 0; i < CFG_STEPPER_AXES; i++)
+  {
+    dot  += (int64_t)prev->delta[i] * next->delta[i];
+    len1 += (int64_t)prev->delta[i] * prev->delta[i];
+    len2 += (int64_t)next->delta[i] * next->delta[i];
+  }
+  if (dot <= 0)
+  {
+    return 0;
+  }
+
+  len1 = stepperSqrt64(len1);
+  len2 = stepperSqrt64(len2);
+  cosQ16 = (uint32_t)((((uint64_t)dot / len1) << 16) / len2);
+  if (cosQ16 > 0x10000)
+  {
+    cosQ16 = 0x10000;
+  }
+
+  speed = prev->nominal < next->nominal ? prev->nominal : next->nominal;
+  return (uint32_t)(((uint64_t)speed * cosQ16) >> 16);
+}
+
+/**************************************************************************/
+/*! 
+    Private - Re-plans the entry speed of every queued segment after the
+    running one (whose entry speed is already used).  Called with the
+    timer interrupt disabled.
+*/
+/**************************************************************************/
+static void stepperReplan(void)
+{
+  stepperSegment_t *seg, *next;
+  uint32_t exitSpeed = 0;
+  uint8_t i, idx;
+
+  if (!stepperAccel || (stepperQueueCount < 2))
+  {
+    return;
+  }
+
+  // Backward pass: each segment must be able to slow down to the entry
+  // speed of the next one (the last one ends at rest)
+  for (i = stepperQueueCount - 1; i > 0; i--)
+  {
+    seg = &stepperQueue[(stepperQueueHead + i) % CFG_STEPPER_QUEUESIZE];
+    seg->entry = stepperReachable(exitSpeed, seg->steps, seg->maxEntry);
+    exitSpeed = seg->entry;
+  }
+
+  // Forward pass: and must be able to speed up to it
+  for (i = 0; i < stepperQueueCount - 1; i++)
+  {
+    idx = (stepperQueueHead + i) % CFG_STEPPER_QUEUESIZE;
+    seg = &stepperQueue[idx];
+    next = &stepperQueue[(idx + 1) % CFG_STEPPER_QUEUESIZE];
+    next->entry = stepperReachable(seg->entry, seg->steps, next->entry);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Initialises the GPIO pins and step timer, sets up axis 0
+                on pins 3.0-3.3 and sets any default values.
 
     @param[in]  steps
-                The number of steps per rotation (typically 200 or 400)
+                The number of full steps per rotation (typically 200 or
+                400).  With CFG_STEPPER_MICROSTEPS, axis 0 then has
+                steps * CFG_STEPPER_MICROSTEPS microsteps per rotation.
 */
 /**************************************************************************/
 void stepperInit(uint32_t steps)
 {
-  // Setup motor control pins
-  gpioSetDir(STEPPER_IN1_PORT, STEPPER_IN1_PIN, 1);
-  gpioSetDir(STEPPER_IN2_PORT, STEPPER_IN2_PIN, 1);
-  gpioSetDir(STEPPER_IN3_PORT, STEPPER_IN3_PIN, 1);
-  gpioSetDir(STEPPER_IN4_PORT, STEPPER_IN4_PIN, 1);
+  uint8_t i;
 
-  gpioSetValue(STEPPER_IN1_PORT, STEPPER_IN1_PIN, 0);
-  gpioSetValue(STEPPER_IN2_PORT, STEPPER_IN2_PIN, 0);
-  gpioSetValue(STEPPER_IN3_PORT, STEPPER_IN3_PIN, 0);
-  gpioSetValue(STEPPER_IN4_PORT, STEPPER_IN4_PIN, 0);
+  for (i = 0; i < CFG_STEPPER_AXES; i++)
+  {
+    stepperAxes[i].data = 0;
+    stepperAxes[i].position = 0;
+    stepperAxes[i].stepNumber = 0;
+    stepperAxes[i].stepsPerRotation = steps;
+#if CFG_STEPPER_MICROSTEPS > 1
+    stepperAxes[i].microstep = false;
+#endif
+#ifdef CFG_ENCODER
+    stepperAxes[i].encoder = -1;
+    stepperAxes[i].makeup = 0;
+    stepperAxes[i].missed = 0;
+#endif
+  }
+  stepperAxisInit(0, STEPPER_IN1_PORT, STEPPER_IN1_PIN, STEPPER_IN2_PIN, STEPPER_IN3_PIN, STEPPER_IN4_PIN, steps);
 
-  // Set the number of steps per rotation
-  stepperStepsPerRotation = steps;
+  // 32-bit timer 0 counts at 1MHz, interrupting and resetting on MR0
+  SCB_SYSAHBCLKCTRL |= (SCB_SYSAHBCLKCTRL_CT32B0);
+  TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERENABLE_DISABLED;
+  TMR_TMR32B0PR = (cpuGetClock()/SCB_SYSAHBCLKDIV) / STEPPER_TIMERHZ - 1;
+  TMR_TMR32B0MCR = (TMR_TMR32B0MCR_MR0_INT_ENABLED | TMR_TMR32B0MCR_MR0_RESET_ENABLED);
+  NVIC_SetPriority(TIMER_32_0_IRQn, CFG_IRQPRIO_TIMER);
+  NVIC_EnableIRQ(TIMER_32_0_IRQn);
 
   // Set the default speed (2 rotations per second)
   stepperSetSpeed(120);
 }
 
+/**************************************************************************/
+/*! 
+    @brief      Sets up the coil pins of one axis.  All four pins must be
+                on the same port, since they are written with a single
+                masked store.  Axis 0 is set up by stepperInit.
+
+                With CFG_STEPPER_MICROSTEPS, axis 0 is microstepped, with
+                the coil currents on 1.9 and 1.10, and stepsPerRotation
+                is the number of full steps (the axis then counts in
+                microsteps).
+
+    @param[in]  axis
+                The axis (0..CFG_STEPPER_AXES-1)
+    @param[in]  port
+                The GPIO port of the coil pins
+    @param[in]  in1
+                The pin number of IN1 (IN2..IN4 are in2..in4)
+    @param[in]  stepsPerRotation
+                The number of steps per rotation of this motor
+
+    @return     false if the axis or pins are out of range
+*/
+/**************************************************************************/
+bool stepperAxisInit(uint8_t axis, uint32_t port, uint32_t in1, uint32_t in2, uint32_t in3, uint32_t in4, uint32_t stepsPerRotation)
+{
+  volatile stepperAxis_t *a;
+  uint32_t mask;
+
+  if ((axis >= CFG_STEPPER_AXES) || (port > 3) || (in1 > 11) || (in2 > 11) || (in3 > 11) || (in4 > 11))
+  {
+    return false;
+  }
+  a = &stepperAxes[axis];
+
+  gpioSetDir(port, in1, 1);
+  gpioSetDir(port, in2, 1);
+  gpioSetDir(port, in3, 1);
+  gpioSetDir(port, in4, 1);
+
+  a->pattern[0] = (1 << in1) | (1 << in3);      // 1010
+  a->pattern[1] = (1 << in2) | (1 << in3);      // 0110
+  a->pattern[2] = (1 << in2) | (1 << in4);      // 0101
+  a->pattern[3] = (1 << in1) | (1 << in4);      // 1001
+  a->stepsPerRotation = stepsPerRotation;
+  a->stepNumber = 0;
+
+  // Masked data register, only writes the four coil pins
+  mask = (1 << in1) | (1 << in2) | (1 << in3) | (1 << in4);
+  a->data = &GPIO_MASKEDDATA(port, mask);
+  *a->data = 0;
+
+#if CFG_STEPPER_MICROSTEPS > 1
+  if (axis == 0)
+  {
+    a->stepsPerRotation = stepsPerRotation * CFG_STEPPER_MICROSTEPS;
+    a->microstep = true;
+    stepperPwmInit();
+    stepperMicrostepSet(a, 0);
+  }
+#endif
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief    Gets the current position (in steps) of an axis relative to
+              'Home'.
+*/
+/**************************************************************************/
+int64_t stepperAxisGetPosition(uint8_t axis)
+{
+  int64_t position;
+
+  // 64-bit reads aren't atomic
+  NVIC_DisableIRQ(TIMER_32_0_IRQn);
+  position = stepperAxes[axis % CFG_STEPPER_AXES].position;
+  NVIC_EnableIRQ(TIMER_32_0_IRQn);
+
+  return position;
+}
+
+/**************************************************************************/
+/*! 
+    @brief    Sets the current position of an axis as 'Home'
+*/
+/**************************************************************************/
+void stepperAxisSetHome(uint8_t axis)
+{
+  volatile stepperAxis_t *a = &stepperAxes[axis % CFG_STEPPER_AXES];
+
+  NVIC_DisableIRQ(TIMER_32_0_IRQn);
+  a->position = 0;
+#ifdef CFG_ENCODER
+  if (a->encoder >= 0)
+  {
+    a->encoderHome = encoderGetCount(a->encoder);
+  }
+  a->makeup = 0;
+#endif
+  stepperPlannedValid = false;
+  NVIC_EnableIRQ(TIMER_32_0_IRQn);
+}
+
+#ifdef CFG_ENCODER
+/**************************************************************************/
+/*! 
+    @brief    Attaches a quadrature encoder (set up with encoderInit) to
+              an axis, so that missed steps are caught and made up.  The
+              encoder's current count is taken to be the axis' current
+              position.
+
+    @param[in]  axis
+                The axis (0..CFG_STEPPER_AXES-1)
+    @param[in]  channel
+                The encoder channel, or -1 to detach the encoder
+    @param[in]  countsPerRotation
+                Encoder counts per motor revolution (4 x the encoder's
+                lines per revolution)
+
+    @return     false if the axis or channel are out of range
+*/
+/**************************************************************************/
+bool stepperAxisSetEncoder(uint8_t axis, int8_t channel, uint32_t countsPerRotation)
+{
+  volatile stepperAxis_t *a;
+  int32_t count;
+
+  if ((axis >= CFG_STEPPER_AXES) || (channel >= ENCODER_CHANNELS) || ((channel >= 0) && !countsPerRotation))
+  {
+    return false;
+  }
+  a = &stepperAxes[axis];
+
+  NVIC_DisableIRQ(TIMER_32_0_IRQn);
+  a->encoder = channel < 0 ? -1 : channel;
+  if (channel >= 0)
+  {
+    a->stepsPerCount = (uint32_t)(((uint64_t)a->stepsPerRotation << 16) / countsPerRotation);
+    // Home is wherever the encoder read 'position' steps ago
+    count = encoderGetCount(channel);
+    a->encoderHome = count - (int32_t)((a->position * countsPerRotation) / a->stepsPerRotation);
+  }
+  a->makeup = 0;
+  NVIC_EnableIRQ(TIMER_32_0_IRQn);
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief    Returns the total number of steps an axis has lost (as
+              seen by its encoder)
+*/
+/**************************************************************************/
+uint32_t stepperAxisGetMissed(uint8_t axis)
+{
+  return stepperAxes[axis % CFG_STEPPER_AXES].missed;
+}
+
+/**************************************************************************/
+/*! 
+    @brief    Returns true if lost steps couldn't be made up after
+              STEPPER_MAXCORRECTIONS tries, so an axis is probably
+              blocked.  Cleared by the next move.
+*/
+/**************************************************************************/
+bool stepperIsStalled(void)
+{
+  return stepperStalled;
+}
+#endif
+
 /**************************************************************************/
 /*! 
     @brief    Gets the current position (in steps) relative to 'Home'.
@@ -157,7 +1022,7 @@ void stepperInit(uint32_t steps)
 /**************************************************************************/
 int64_t stepperGetPosition()
 {
-  return stepperPosition;
+  return stepperAxisGetPosition(0);
 }
 
 /**************************************************************************/
@@ -166,12 +1031,12 @@ int64_t stepperGetPosition()
               the spindle's 'Zero' position.
 
     @return   The current step (0 .. steps per rotation) on the motor's
-              spindle relative to 0°.  Value is always positive.
+              spindle relative to 0.  Value is always positive.
 */
 /**************************************************************************/
 uint32_t stepperGetRotation()
 {
-  return stepperStepNumber;
+  return stepperAxes[0].stepNumber;
 }
 
 /**************************************************************************/
@@ -183,7 +1048,7 @@ uint32_t stepperGetRotation()
 /**************************************************************************/
 void stepperSetHome()
 {
-  stepperPosition = 0;
+  stepperAxisSetHome(0);
 }
 
 /**************************************************************************/
@@ -193,7 +1058,7 @@ void stepperSetHome()
 /**************************************************************************/
 void stepperMoveHome()
 {
-  stepperStep(stepperPosition * -1);
+  stepperStep(stepperGetPosition() * -1);
 }
 
 /**************************************************************************/
@@ -205,7 +1070,7 @@ void stepperMoveHome()
 /**************************************************************************/
 void stepperSetZero()
 {
-  stepperStepNumber = 0;
+  stepperAxes[0].stepNumber = 0;
 }
 
 /**************************************************************************/
@@ -217,16 +1082,19 @@ void stepperSetZero()
 /**************************************************************************/
 void stepperMoveZero()
 {
-  if (!stepperStepNumber)
+  if (!stepperAxes[0].stepNumber)
   {
-    stepperStep(stepperStepsPerRotation - stepperStepNumber);
+    stepperStep(stepperAxes[0].stepsPerRotation - stepperAxes[0].stepNumber);
   }
 }
 
 /**************************************************************************/
 /*! 
     @brief    Sets the motor speed in rpm, meaning the number of times the
-              motor will fully rotate in a one minute period.
+              motor will fully rotate in a one minute period.  With an
+              acceleration set, this is the top speed of each move.  This
+              is the default speed for segments queued without one (in
+              steps/s of axis 0).  Takes effect on the next move.
 
     @param[in]  rpm
                 Motor speed in revolutions per minute (RPM)
@@ -238,63 +1106,259 @@ void stepperMoveZero()
 /**************************************************************************/
 void stepperSetSpeed(uint32_t rpm)
 {
-  uint32_t ticksOneRPM = ((CFG_CPU_CCLK/SCB_SYSAHBCLKDIV) / stepperStepsPerRotation) * 60;
+  uint32_t speed = (stepperAxes[0].stepsPerRotation * rpm + 30) / 60;
 
-  // Set stepper RPM
-  stepperStepDelay = ticksOneRPM / rpm;
+  stepperDefaultSpeed = speed < 1 ? 1 : (speed > STEPPER_MAXSPEED ? STEPPER_MAXSPEED : speed);
+}
+
+/**************************************************************************/
+/*! 
+    @brief    Sets the acceleration and deceleration used by each move.
+              Takes effect on the next move.
 
-  // Initialise 32-bit timer 0 with the appropriate delay
-  timer32Init(0, stepperStepDelay);
-  timer32Enable(0);
+    @param[in]  stepsPerSec2
+                Acceleration in steps/s^2, or 0 to start and stop at
+                full speed
+*/
+/**************************************************************************/
+void stepperSetAcceleration(uint32_t stepsPerSec2)
+{
+  stepperAccel = stepsPerSec2;
 }
 
 /**************************************************************************/
 /*! 
-    @brief      Moves the motor forward or backward the specified number
-                of steps.  A positive number moves the motor forward,
-                while a negative number moves the motor backwards.
+    @brief      Adds a coordinated move to the end of the queue, and
+                returns right away.  The queue is re-planned with the new
+                segment and the motors start if they were idle.
 
     @param[in]  steps
-                The number of steps to move foreward (positive) or
-                backward (negative)
+                CFG_STEPPER_AXES relative moves, one per axis
+    @param[in]  speed
+                Cruise speed in steps/s of the axis that moves furthest
+                (0 for the stepperSetSpeed default)
+
+    @return     false if the queue is full (try again once a segment has
+                finished)
 */
 /**************************************************************************/
-void stepperStep(int32_t steps)
+bool stepperQueueMove(const int32_t *steps, uint32_t speed)
 {
-  uint32_t stepsLeft = abs(steps);          // Force number to be positive
+  stepperSegment_t *seg;
+  uint32_t major = 0, len;
+  uint8_t i;
 
-  while (stepsLeft > 0)
+  for (i = 0; i < CFG_STEPPER_AXES; i++)
   {
-    // Wait 1 tick between individual steps
-    timer32Delay(0, 1);
-
-    // Increment or decrement step counters (depending on direction)
-    if (steps > 0)
+    len = abs(steps[i]);
+    if (len > major)
     {
-      stepperPosition++;          // Increment global position counter
-      stepperStepNumber++;        // Increment single rotation counter
-      if (stepperStepNumber == stepperStepsPerRotation)
-      {
-        stepperStepNumber = 0;
-      }
+      major = len;
     }
-    else
+  }
+  if (!major)
+  {
+    return true;
+  }
+
+  NVIC_DisableIRQ(TIMER_32_0_IRQn);
+  if (stepperQueueCount == CFG_STEPPER_QUEUESIZE)
+  {
+    NVIC_EnableIRQ(TIMER_32_0_IRQn);
+    return false;
+  }
+#ifdef CFG_ENCODER
+  stepperCorrections = 0;
+  stepperNoMakeup = false;
+  stepperStalled = false;
+#endif
+
+  if (!stepperPlannedValid)
+  {
+    for (i = 0; i < CFG_STEPPER_AXES; i++)
     {
-      stepperPosition--;          // Decrement global position counter
-      if (stepperStepNumber == 0)
-      {
-        stepperStepNumber = stepperStepsPerRotation;
-      }
-      stepperStepNumber--;        // Decrement single rotation counter
+      stepperPlanned[i] = stepperAxes[i].position;
     }
+    stepperPlannedValid = true;
+  }
 
-    // Decrement number of remaining steps
-    stepsLeft--;
+  seg = &stepperQueue[(stepperQueueHead + stepperQueueCount) % CFG_STEPPER_QUEUESIZE];
+  for (i = 0; i < CFG_STEPPER_AXES; i++)
+  {
+    seg->delta[i] = steps[i];
+    stepperPlanned[i] += steps[i];
+  }
+  seg->steps = major;
+  speed = speed ? speed : stepperDefaultSpeed;
+  seg->nominal = speed > STEPPER_MAXSPEED ? STEPPER_MAXSPEED : speed;
+  seg->entry = 0;
+  seg->maxEntry = 0;
+  if (stepperQueueCount)
+  {
+    seg->maxEntry = stepperJunctionSpeed(
+        &stepperQueue[(stepperQueueHead + stepperQueueCount - 1) % CFG_STEPPER_QUEUESIZE], seg);
+  }
+  stepperQueueCount++;
+
+  if (stepperState == STEPPER_STATE_IDLE)
+  {
+    // First step after one interval
+    TMR_TMR32B0IR = TMR_TMR32B0IR_MR0;
+    TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERRESET_ENABLED;
+    stepperSegmentStart();
+    TMR_TMR32B0TCR = TMR_TMR32B0TCR_COUNTERENABLE_ENABLED;
+  }
+  else
+  {
+    stepperReplan();
+    stepperUpdateExit();
+  }
+  NVIC_EnableIRQ(TIMER_32_0_IRQn);
 
-    // Step the motor one step
-    stepMotor(stepperStepNumber % 4);
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Adds a coordinated move to absolute positions (in steps
+                relative to 'Home') to the end of the queue.  The move is
+                worked out from where the queued moves will leave each
+                axis, so a path can be queued point by point.
+
+    @note       Straight after stepperStop the end position isn't known
+                until the motors have stopped, so this waits for them.
+
+    @return     false if the queue is full
+*/
+/**************************************************************************/
+bool stepperQueueMoveTo(const int64_t *position, uint32_t speed)
+{
+  int32_t steps[CFG_STEPPER_AXES];
+  uint8_t i;
+
+  if (!stepperPlannedValid)
+  {
+    while (stepperIsMoving());
+  }
+
+  NVIC_DisableIRQ(TIMER_32_0_IRQn);
+  for (i = 0; i < CFG_STEPPER_AXES; i++)
+  {
+    steps[i] = (int32_t)(position[i] - (stepperPlannedValid ? stepperPlanned[i] : stepperAxes[i].position));
   }
+  NVIC_EnableIRQ(TIMER_32_0_IRQn);
+
+  return stepperQueueMove(steps, speed);
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Returns the number of free entries in the segment queue
+*/
+/**************************************************************************/
+uint8_t stepperQueueSpace(void)
+{
+  return CFG_STEPPER_QUEUESIZE - stepperQueueCount;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Starts moving the motor forward or backward the specified
+                number of steps, and returns right away.  A positive
+                number moves the motor forward, while a negative number
+                moves the motor backwards.  Any queued moves are dropped
+                and the move in progress is cut short.
+
+    @param[in]  steps
+                The number of steps to move foreward (positive) or
+                backward (negative)
+*/
+/**************************************************************************/
+void stepperMove(int32_t steps)
+{
+  int32_t move[CFG_STEPPER_AXES] = { 0 };
+
+  NVIC_DisableIRQ(TIMER_32_0_IRQn);
+  stepperTimerStop();
+  stepperQueueCount = 0;
+  stepperPlannedValid = false;
+#ifdef CFG_ENCODER
+  stepperMakeupClear();
+#endif
+  NVIC_EnableIRQ(TIMER_32_0_IRQn);
+
+  move[0] = steps;
+  stepperQueueMove(move, 0);
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Starts moving the motor to an absolute position (in steps
+                relative to 'Home'), and returns right away
+*/
+/**************************************************************************/
+void stepperMoveTo(int64_t position)
+{
+  stepperMove((int32_t)(position - stepperGetPosition()));
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Returns true while any axis is moving
+*/
+/**************************************************************************/
+bool stepperIsMoving(void)
+{
+  return stepperState != STEPPER_STATE_IDLE;
 }
 
+/**************************************************************************/
+/*! 
+    @brief      Drops the queued moves and brings the motors to a stop as
+                quickly as the acceleration allows (straight away at
+                constant speed), and returns right away
+*/
+/**************************************************************************/
+void stepperStop(void)
+{
+  NVIC_DisableIRQ(TIMER_32_0_IRQn);
+  if (stepperState != STEPPER_STATE_IDLE)
+  {
+    stepperQueueCount = 1;
+    stepperExitRamp = 0;
+    if (!stepperAccel || !stepperRampStep)
+    {
+      stepperTimerStop();
+      stepperQueueCount = 0;
+    }
+    else if (stepperStepsLeft > stepperRampStep)
+    {
+      stepperStepsLeft = stepperRampStep;
+      stepperState = STEPPER_STATE_DECEL;
+    }
+  }
+  stepperPlannedValid = false;
+#ifdef CFG_ENCODER
+  stepperMakeupClear();
+  stepperNoMakeup = true;
+#endif
+  NVIC_EnableIRQ(TIMER_32_0_IRQn);
+}
 
+/**************************************************************************/
+/*! 
+    @brief      Moves the motor forward or backward the specified number
+                of steps, and waits until the move is done.  A positive
+                number moves the motor forward, while a negative number
+                moves the motor backwards.
 
+    @param[in]  steps
+                The number of steps to move foreward (positive) or
+                backward (negative)
+*/
+/**************************************************************************/
+void stepperStep(int32_t steps)
+{
+  stepperMove(steps);
+  while (stepperIsMoving());
+}
@@ -49,7 +49,19 @@
 #define STEPPER_IN4_PIN    (3)
 
 void     stepperInit( uint32_t steps );
+bool     stepperAxisInit( uint8_t axis, uint32_t port, uint32_t in1, uint32_t in2, uint32_t in3, uint32_t in4, uint32_t stepsPerRotation );
+int64_t  stepperAxisGetPosition( uint8_t axis );
+void     stepperAxisSetHome( uint8_t axis );
+#ifdef CFG_ENCODER
+bool     stepperAxisSetEncoder( uint8_t axis, int8_t channel, uint32_t countsPerRotation );
+uint32_t stepperAxisGetMissed( uint8_t axis );
+bool     stepperIsStalled( void );
+#endif
+bool     stepperQueueMove( const int32_t *steps, uint32_t speed );
+bool     stepperQueueMoveTo( const int64_t *position, uint32_t speed );
+uint8_t  stepperQueueSpace( void );
 void     stepperSetSpeed( uint32_t rpm );
+void     stepperSetAcceleration( uint32_t stepsPerSec2 );
 int64_t  stepperGetPosition();
 uint32_t stepperGetRotation();
 void     stepperMoveHome();
@@ -57,5 +69,10 @@ void     stepperSetHome();
 void     stepperMoveZero();
 void     stepperSetZero();
 void     stepperStep( int32_t steps );
+void     stepperMove( int32_t steps );
+void     stepperMoveTo( int64_t position );
+bool     stepperIsMoving( void );
+void     stepperStop( void );
+void     stepperTimerIRQ( void );
 
 #endif
\ No newline at end of file
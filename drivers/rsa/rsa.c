@@ -22,10 +22,68 @@
               values with it (%lld, etc.).  Using 32-bit values (changing
               the definition of huge_t to uint32_t) will avoid this issue
               entirely, though at the expense of weaker encryption.
+
+    The rsaMont/rsaBig functions below work on real key sizes (up to
+    CFG_RSA_MAXBITS bits, in 32-bit limbs).  Multiplications are done in
+    Montgomery form, so the reduction mod n needs no division, and the
+    64-bit products map straight onto the M3's UMULL/UMLAL instructions.
+    Exponentiation uses a sliding window of CFG_RSA_WINDOW bits, which
+    takes 2^(CFG_RSA_WINDOW-1) precomputed powers on the stack (1KB with
+    a 4-bit window and 1024-bit keys).  Short public exponents (65537)
+    are done with plain square-and-multiply.
+
+    Private key operations (rsaBigPrivate, rsaSignSha256) use the CRT
+    form of the key: two exponentiations with half-length numbers mod p
+    and mod q, recombined with Garner's formula m = mq + q * (qinv *
+    (mp - mq) mod p).  Each half costs about 1/8 of a full-length
+    exponentiation, so signing is roughly 4x faster than c^d mod n.
+    The key can be kept in the EEPROM key/value store (rsaBigPriKeySave
+    and rsaBigPriKeyLoad), split over consecutive keys of up to
+    CFG_EEPROM_KV_MAXVALUE bytes.  A 1024-bit key is 321 bytes, so
+    CFG_EEPROM_KV_MAXVALUE/MAXKEYS/SIZE must be raised to hold it, and
+    keep in mind that the store caches all values in RAM and doesn't
+    encrypt them.
+
+    No attempt is made to make the timing independent of the operands,
+    which is fine for signature checks on public data.  The timing of
+    private key operations depends on dp and dq, so they should only be
+    used where an attacker can't take precise timings of many
+    signatures.
+
+    @code
+    // Verify a PKCS#1 v1.5 signature on a SHA-256 digest
+    rsaBigPubKey_t key;
+
+    rsaBigKeyInit(&key, modulus, 128, 65537);     // 1024-bit, big-endian
+    if (rsaVerifySha256(&key, signature, digest))
+    {
+      // Authenticated
+    }
+    @endcode
+
+    @code
+    // Sign a report with the private key kept in EEPROM (keys 0x40..)
+    rsaBigPriKey_t priKey;
+    uint8_t digest[32];
+    uint8_t signature[128];
+
+    eepromKvInit();
+    if (!rsaBigPriKeyLoad(&priKey, 0x40))
+    {
+      // p, q, dp, dq and qinv are 64 bytes each, big-endian
+      rsaBigPriKeyInit(&priKey, p, q, dp, dq, qinv, 64);
+      rsaBigPriKeySave(&priKey, 0x40);
+    }
+    sha256(report, reportLength, digest);
+    rsaSignSha256(&priKey, signature, digest);
+    @endcode
 */
 /**************************************************************************/
 
+#include <string.h>
+
 #include "rsa.h"
+#include "drivers/eeprom/eepromkv.h"
 
 huge_t modexp(huge_t a, huge_t b, huge_t n) 
 {
@@ -126,3 +184,746 @@ void rsaDecrypt(huge_t ciphertext, huge_t *plaintext, rsaPriKey_t prikey)
 
   return;
 }
+
+/**************************************************************************/
+/*! 
+    Private - Compares two multi-precision numbers (-1, 0 or 1)
+*/
+/**************************************************************************/
+static int rsaBigCmp(const uint32_t *a, const uint32_t *b, uint8_t len)
+{
+  while (len--)
+  {
+    if (a[len] != b[len])
+    {
+      return a[len] > b[len] ? 1 : -1;
+    }
+  }
+  return 0;
+}
+
+/**************************************************************************/
+/*! 
+    Private - r = a - b, returning the borrow
+*/
+/**************************************************************************/
+static uint32_t rsaBigSub(uint32_t *r, const uint32_t *a, const uint32_t *b, uint8_t len)
+{
+  uint32_t borrow = 0;
+  uint64_t d;
+  uint8_t i;
+
+  for (i = 0; i < len; i++)
+  {
+    d = (uint64_t)a[i] - b[i] - borrow;
+    r[i] = (uint32_t)d;
+    borrow = (uint32_t)(d >> 32) & 1;
+  }
+  return borrow;
+}
+
+/**************************************************************************/
+/*! 
+    Private - Returns bit 'bit' of a multi-precision number
+*/
+/**************************************************************************/
+static inline uint32_t rsaBigBit(const uint32_t *a, uint32_t bit)
+{
+  return (a[bit >> 5] >> (bit & 31)) & 1;
+}
+
+/**************************************************************************/
+/*! 
+    Private - r = a + b, returning the carry
+*/
+/**************************************************************************/
+static uint32_t rsaBigAdd(uint32_t *r, const uint32_t *a, const uint32_t *b, uint8_t len)
+{
+  uint32_t carry = 0;
+  uint64_t s;
+  uint8_t i;
+
+  for (i = 0; i < len; i++)
+  {
+    s = (uint64_t)a[i] + b[i] + carry;
+    r[i] = (uint32_t)s;
+    carry = (uint32_t)(s >> 32);
+  }
+  return carry;
+}
+
+/**************************************************************************/
+/*! 
+    Private - r = a * b (aLen + bLen limbs, r can't be a or b)
+*/
+/**************************************************************************/
+static void rsaBigMul(uint32_t *r, const uint32_t *a, uint8_t aLen, const uint32_t *b, uint8_t bLen)
+{
+  uint32_t carry;
+  uint64_t p;
+  uint8_t i, j;
+
+  memset(r, 0, (aLen + bLen) * sizeof(uint32_t));
+  for (i = 0; i < bLen; i++)
+  {
+    carry = 0;
+    for (j = 0; j < aLen; j++)
+    {
+      p = (uint64_t)a[j] * b[i] + r[i + j] + carry;
+      r[i + j] = (uint32_t)p;
+      carry = (uint32_t)(p >> 32);
+    }
+    r[i + aLen] = carry;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    Private - r = (2 * r + bit) mod n, with r < n
+*/
+/**************************************************************************/
+static void rsaBigShiftMod(uint32_t *r, uint32_t bit, const uint32_t *n, uint8_t len)
+{
+  uint32_t carry = bit;
+  uint32_t limb;
+  uint8_t j;
+
+  for (j = 0; j < len; j++)
+  {
+    limb = r[j];
+    r[j] = (limb << 1) | carry;
+    carry = limb >> 31;
+  }
+  if (carry || (rsaBigCmp(r, n, len) >= 0))
+  {
+    rsaBigSub(r, r, n, len);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    Private - r = a mod n for any length of 'a' (aLen limbs), one bit
+    at a time.  This is only used a few times per private key
+    operation, where it costs far less than the Montgomery products.
+*/
+/**************************************************************************/
+static void rsaBigMod(const rsaMont_t *mont, uint32_t *r, const uint32_t *a, uint8_t aLen)
+{
+  int32_t bit;
+
+  memset(r, 0, mont->len * sizeof(uint32_t));
+  for (bit = (int32_t)aLen * 32 - 1; bit >= 0; bit--)
+  {
+    rsaBigShiftMod(r, rsaBigBit(a, bit), mont->n, mont->len);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    Sets up the Montgomery context for modulus 'n'.
+
+    @param[in]  mont
+                The context to fill in
+    @param[in]  n
+                The modulus, least significant limb first
+    @param[in]  len
+                The number of limbs (1..RSA_MAXLIMBS)
+
+    @returns    false if the modulus is even or too long
+*/
+/**************************************************************************/
+bool rsaMontInit(rsaMont_t *mont, const uint32_t *n, uint8_t len)
+{
+  uint32_t inv;
+  uint16_t i;
+
+  if (!len || (len > RSA_MAXLIMBS) || !(n[0] & 1))
+  {
+    return false;
+  }
+
+  // Drop leading zero limbs
+  while ((len > 1) && !n[len - 1])
+  {
+    len--;
+  }
+
+  memcpy(mont->n, n, len * sizeof(uint32_t));
+  mont->len = len;
+
+  // -n^-1 mod 2^32 by Newton's iteration (each step doubles the
+  // number of correct bits, starting with 3 for any odd n)
+  inv = n[0];
+  for (i = 0; i < 4; i++)
+  {
+    inv *= 2 - n[0] * inv;
+  }
+  mont->n0inv = -inv;
+
+  // R^2 mod n: start from 1 and double 2 * 32 * len times mod n
+  memset(mont->rr, 0, len * sizeof(uint32_t));
+  mont->rr[0] = 1;
+  for (i = 0; i < 64 * (uint16_t)len; i++)
+  {
+    rsaBigShiftMod(mont->rr, 0, mont->n, len);
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    Montgomery multiplication: r = a * b / R mod n, with a and b < n
+    (CIOS method).  r can be the same as a or b.
+*/
+/**************************************************************************/
+void rsaMontMul(const rsaMont_t *mont, uint32_t *r, const uint32_t *a, const uint32_t *b)
+{
+  uint32_t t[RSA_MAXLIMBS + 2];
+  uint32_t carry, m;
+  uint64_t p;
+  uint8_t len = mont->len;
+  uint8_t i, j;
+
+  memset(t, 0, (len + 2) * sizeof(uint32_t));
+
+  for (i = 0; i < len; i++)
+  {
+    // t += a * b[i]
+    carry = 0;
+    for (j = 0; j < len; j++)
+    {
+      p = (uint64_t)a[j] * b[i] + t[j] + carry;
+      t[j] = (uint32_t)p;
+      carry = (uint32_t)(p >> 32);
+    }
+    p = (uint64_t)t[len] + carry;
+    t[len] = (uint32_t)p;
+    t[len + 1] = (uint32_t)(p >> 32);
+
+    // t = (t + m * n) / 2^32, with m chosen so the low limb is zero
+    m = t[0] * mont->n0inv;
+    p = (uint64_t)m * mont->n[0] + t[0];
+    carry = (uint32_t)(p >> 32);
+    for (j = 1; j < len; j++)
+    {
+      p = (uint64_t)m * mont->n[j] + t[j] + carry;
+      t[j - 1] = (uint32_t)p;
+      carry = (uint32_t)(p >> 32);
+    }
+    p = (uint64_t)t[len] + carry;
+    t[len - 1] = (uint32_t)p;
+    t[len] = t[len + 1] + (uint32_t)(p >> 32);
+  }
+
+  // t < 2n
+  if (t[len] || (rsaBigCmp(t, mont->n, len) >= 0))
+  {
+    rsaBigSub(t, t, mont->n, len);
+  }
+  memcpy(r, t, len * sizeof(uint32_t));
+}
+
+/**************************************************************************/
+/*! 
+    Modular exponentiation: r = base^exp mod n
+
+    @param[in]  mont
+                Montgomery context for n (rsaMontInit)
+    @param[out] r
+                The result (mont->len limbs)
+    @param[in]  base
+                The base (mont->len limbs, must be below n)
+    @param[in]  exp
+                The exponent, least significant limb first
+    @param[in]  expLen
+                The number of limbs in the exponent
+
+    @returns    false if the base isn't below n
+*/
+/**************************************************************************/
+bool rsaModExp(const rsaMont_t *mont, uint32_t *r, const uint32_t *base, const uint32_t *exp, uint8_t expLen)
+{
+  uint32_t table[1 << (CFG_RSA_WINDOW - 1)][RSA_MAXLIMBS];
+  uint32_t acc[RSA_MAXLIMBS];
+  uint32_t one[RSA_MAXLIMBS];
+  uint8_t len = mont->len;
+  uint8_t window, entries, k;
+  int32_t bit, low;
+  uint32_t value;
+  bool started = false;
+
+  if (rsaBigCmp(base, mont->n, len) >= 0)
+  {
+    return false;
+  }
+
+  // Number of bits in the exponent
+  while (expLen && !exp[expLen - 1])
+  {
+    expLen--;
+  }
+  bit = (int32_t)expLen * 32 - 1;
+  while ((bit >= 0) && !rsaBigBit(exp, bit))
+  {
+    bit--;
+  }
+
+  // The precomputed powers only pay off for long exponents
+  window = (bit >= 64) ? CFG_RSA_WINDOW : 1;
+  entries = 1 << (window - 1);
+
+  // table[k] = base^(2k+1) in Montgomery form
+  rsaMontMul(mont, table[0], base, mont->rr);
+  if (entries > 1)
+  {
+    rsaMontMul(mont, acc, table[0], table[0]);
+    for (k = 1; k < entries; k++)
+    {
+      rsaMontMul(mont, table[k], table[k - 1], acc);
+    }
+  }
+
+  while (bit >= 0)
+  {
+    if (!rsaBigBit(exp, bit))
+    {
+      if (started)
+      {
+        rsaMontMul(mont, acc, acc, acc);
+      }
+      bit--;
+      continue;
+    }
+
+    // Longest window ending on a 1 bit
+    low = bit - window + 1;
+    if (low < 0)
+    {
+      low = 0;
+    }
+    while (!rsaBigBit(exp, low))
+    {
+      low++;
+    }
+    value = 0;
+    for (k = 0; k <= bit - low; k++)
+    {
+      value = (value << 1) | rsaBigBit(exp, bit - k);
+      if (started)
+      {
+        rsaMontMul(mont, acc, acc, acc);
+      }
+    }
+
+    if (started)
+    {
+      rsaMontMul(mont, acc, acc, table[value >> 1]);
+    }
+    else
+    {
+      memcpy(acc, table[value >> 1], len * sizeof(uint32_t));
+      started = true;
+    }
+    bit = low - 1;
+  }
+
+  // Out of Montgomery form (or 1 for a zero exponent)
+  memset(one, 0, len * sizeof(uint32_t));
+  one[0] = 1;
+  if (started)
+  {
+    rsaMontMul(mont, r, acc, one);
+  }
+  else
+  {
+    rsaMontMul(mont, r, mont->rr, one);
+    rsaMontMul(mont, r, r, one);
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    Converts a big-endian byte string (as RSA keys and signatures are
+    normally stored) to 'len' limbs.  Bytes beyond 'len' limbs are lost.
+*/
+/**************************************************************************/
+void rsaBigFromBytes(uint32_t *r, uint8_t len, const uint8_t *bytes, uint32_t size)
+{
+  uint32_t i;
+
+  memset(r, 0, len * sizeof(uint32_t));
+  for (i = 0; (i < size) && (i < len * 4u); i++)
+  {
+    r[i >> 2] |= (uint32_t)bytes[size - 1 - i] << ((i & 3) * 8);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    Converts 'len' limbs to a big-endian byte string of 'size' bytes
+*/
+/**************************************************************************/
+void rsaBigToBytes(uint8_t *bytes, uint32_t size, const uint32_t *a, uint8_t len)
+{
+  uint32_t i;
+
+  for (i = 0; i < size; i++)
+  {
+    bytes[size - 1 - i] = (i < len * 4u) ? (uint8_t)(a[i >> 2] >> ((i & 3) * 8)) : 0;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    Loads a public key.
+
+    @param[in]  key
+                The key to fill in
+    @param[in]  modulus
+                The modulus as a big-endian byte string
+    @param[in]  size
+                The size of the modulus in bytes (a multiple of 4, up to
+                CFG_RSA_MAXBITS / 8)
+    @param[in]  e
+                The public exponent
+
+    @returns    false if the modulus is even or too long
+*/
+/**************************************************************************/
+bool rsaBigKeyInit(rsaBigPubKey_t *key, const uint8_t *modulus, uint32_t size, uint32_t e)
+{
+  uint32_t n[RSA_MAXLIMBS];
+
+  if (!size || (size & 3) || (size > RSA_MAXLIMBS * 4))
+  {
+    return false;
+  }
+
+  rsaBigFromBytes(n, size / 4, modulus, size);
+  key->e = e;
+  return rsaMontInit(&key->mont, n, size / 4);
+}
+
+/**************************************************************************/
+/*! 
+    Public key operation (encryption, or signature recovery): out =
+    in^e mod n, with 'in' and 'out' big-endian and the size of the
+    modulus.
+
+    @returns    false if 'in' isn't below the modulus
+*/
+/**************************************************************************/
+bool rsaBigPublic(const rsaBigPubKey_t *key, uint8_t *out, const uint8_t *in)
+{
+  uint32_t a[RSA_MAXLIMBS];
+  uint8_t len = key->mont.len;
+
+  rsaBigFromBytes(a, len, in, len * 4);
+  if (!rsaModExp(&key->mont, a, a, &key->e, 1))
+  {
+    return false;
+  }
+  rsaBigToBytes(out, len * 4, a, len);
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    Checks a PKCS#1 v1.5 signature on a SHA-256 digest.
+
+    @param[in]  key
+                The signer's public key
+    @param[in]  signature
+                The signature (big-endian, the size of the modulus)
+    @param[in]  digest
+                The 32-byte SHA-256 digest of the signed data
+
+    @returns    true if the signature is valid
+*/
+/**************************************************************************/
+bool rsaVerifySha256(const rsaBigPubKey_t *key, const uint8_t *signature, const uint8_t *digest)
+{
+  // DER encoded DigestInfo header for SHA-256
+  static const uint8_t digestInfo[19] = { 0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+                                          0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20 };
+  uint8_t em[RSA_MAXLIMBS * 4];
+  uint32_t size = key->mont.len * 4;
+  uint32_t pad, i;
+  uint8_t diff = 0;
+
+  // 00 01 FF .. FF 00 DigestInfo digest, with at least 8 bytes of FF
+  if (size < 3 + 8 + sizeof(digestInfo) + 32)
+  {
+    return false;
+  }
+  if (!rsaBigPublic(key, em, signature))
+  {
+    return false;
+  }
+
+  pad = size - 3 - sizeof(digestInfo) - 32;
+  diff |= em[0] | (em[1] ^ 0x01) | em[2 + pad];
+  for (i = 0; i < pad; i++)
+  {
+    diff |= em[2 + i] ^ 0xFF;
+  }
+  for (i = 0; i < sizeof(digestInfo); i++)
+  {
+    diff |= em[3 + pad + i] ^ digestInfo[i];
+  }
+  for (i = 0; i < 32; i++)
+  {
+    diff |= em[size - 32 + i] ^ digest[i];
+  }
+
+  return diff == 0;
+}
+
+/**************************************************************************/
+/*! 
+    Loads a private key in CRT form.
+
+    @param[in]  key
+                The key to fill in
+    @param[in]  p, q
+                The two primes as big-endian byte strings
+    @param[in]  dp, dq
+                d mod (p-1) and d mod (q-1), big-endian
+    @param[in]  qinv
+                q^-1 mod p, big-endian
+    @param[in]  size
+                The size of each value in bytes (half the modulus, a
+                multiple of 4, up to CFG_RSA_MAXBITS / 16)
+
+    @returns    false if p or q is even or qinv isn't below p
+*/
+/**************************************************************************/
+bool rsaBigPriKeyInit(rsaBigPriKey_t *key, const uint8_t *p, const uint8_t *q, const uint8_t *dp, const uint8_t *dq, const uint8_t *qinv, uint32_t size)
+{
+  uint32_t a[RSA_MAXLIMBS / 2];
+  uint8_t len = size / 4;
+
+  if (!size || (size & 3) || (size > RSA_MAXLIMBS * 2))
+  {
+    return false;
+  }
+
+  rsaBigFromBytes(a, len, p, size);
+  if (!rsaMontInit(&key->p, a, len))
+  {
+    return false;
+  }
+  rsaBigFromBytes(a, len, q, size);
+  if (!rsaMontInit(&key->q, a, len))
+  {
+    return false;
+  }
+
+  rsaBigFromBytes(key->dp, len, dp, size);
+  rsaBigFromBytes(key->dq, len, dq, size);
+  rsaBigFromBytes(key->qinv, len, qinv, size);
+  key->len = len;
+
+  // qinv goes into rsaMontMul mod p, which only reads p.len limbs
+  memset(a, 0, sizeof(a));
+  memcpy(a, key->p.n, key->p.len * sizeof(uint32_t));
+  return rsaBigCmp(key->qinv, a, len) < 0;
+}
+
+/**************************************************************************/
+/*! 
+    Private key operation (decryption, or signing): out = in^d mod n,
+    with 'in' and 'out' big-endian and the size of the modulus (2 *
+    key->len * 4 bytes).  'in' and 'out' can be the same buffer.
+
+    @returns    false if 'in' isn't below the modulus
+*/
+/**************************************************************************/
+bool rsaBigPrivate(const rsaBigPriKey_t *key, uint8_t *out, const uint8_t *in)
+{
+  uint32_t c[RSA_MAXLIMBS];
+  uint32_t m[RSA_MAXLIMBS];
+  uint32_t mp[RSA_MAXLIMBS / 2];
+  uint32_t mq[RSA_MAXLIMBS / 2];
+  uint32_t h[RSA_MAXLIMBS / 2];
+  uint8_t pLen = key->p.len;
+  uint8_t qLen = key->q.len;
+  uint8_t len = key->len * 2;
+
+  rsaBigFromBytes(c, len, in, len * 4);
+
+  // n = p * q, only for the range check
+  memset(m, 0, sizeof(m));
+  rsaBigMul(m, key->p.n, pLen, key->q.n, qLen);
+  if (rsaBigCmp(c, m, len) >= 0)
+  {
+    return false;
+  }
+
+  // mp = c^dp mod p, mq = c^dq mod q
+  rsaBigMod(&key->p, mp, c, len);
+  rsaModExp(&key->p, mp, mp, key->dp, key->len);
+  rsaBigMod(&key->q, mq, c, len);
+  rsaModExp(&key->q, mq, mq, key->dq, key->len);
+
+  // h = qinv * (mp - mq) mod p (mq can be above p if q > p).  The
+  // first product is qinv * h / R, and the second one multiplies by
+  // R^2 / R to get rid of the 1/R.
+  rsaBigMod(&key->p, h, mq, qLen);
+  if (rsaBigSub(h, mp, h, pLen))
+  {
+    rsaBigAdd(h, h, key->p.n, pLen);
+  }
+  rsaMontMul(&key->p, h, h, key->qinv);
+  rsaMontMul(&key->p, h, h, key->p.rr);
+
+  // m = mq + h * q (< n, so it can't overflow)
+  memset(m, 0, sizeof(m));
+  rsaBigMul(m, h, pLen, key->q.n, qLen);
+  memset(c, 0, sizeof(c));
+  memcpy(c, mq, qLen * sizeof(uint32_t));
+  rsaBigAdd(m, m, c, len);
+  rsaBigToBytes(out, len * 4, m, len);
+
+  // Don't leave the intermediate values on the stack
+  memset(mp, 0, sizeof(mp));
+  memset(mq, 0, sizeof(mq));
+  memset(h, 0, sizeof(h));
+  memset(m, 0, sizeof(m));
+
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    Makes a PKCS#1 v1.5 signature on a SHA-256 digest.
+
+    @param[in]  key
+                The signer's private key
+    @param[out] signature
+                The signature (big-endian, the size of the modulus)
+    @param[in]  digest
+                The 32-byte SHA-256 digest of the data to sign
+
+    @returns    false if the modulus is too short for the padding
+*/
+/**************************************************************************/
+bool rsaSignSha256(const rsaBigPriKey_t *key, uint8_t *signature, const uint8_t *digest)
+{
+  // DER encoded DigestInfo header for SHA-256 (see rsaVerifySha256)
+  static const uint8_t digestInfo[19] = { 0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+                                          0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20 };
+  uint32_t size = key->len * 8;
+  uint32_t pad;
+
+  // 00 01 FF .. FF 00 DigestInfo digest, with at least 8 bytes of FF
+  if (size < 3 + 8 + sizeof(digestInfo) + 32)
+  {
+    return false;
+  }
+
+  pad = size - 3 - sizeof(digestInfo) - 32;
+  signature[0] = 0x00;
+  signature[1] = 0x01;
+  memset(&signature[2], 0xFF, pad);
+  signature[2 + pad] = 0x00;
+  memcpy(&signature[3 + pad], digestInfo, sizeof(digestInfo));
+  memcpy(&signature[size - 32], digest, 32);
+
+  return rsaBigPrivate(key, signature, signature);
+}
+
+/* Stored private key: len, then p, q, dp, dq and qinv (len * 4 bytes   *
+ * each, big-endian)                                                     */
+#define RSA_PRIKEY_STORESIZE(len)   (1 + 5 * 4 * (uint32_t)(len))
+
+/**************************************************************************/
+/*! 
+    Writes a private key to the EEPROM key/value store, split over keys
+    baseKey, baseKey + 1, ... in chunks of CFG_EEPROM_KV_MAXVALUE bytes
+    (eepromKvInit must have been called).
+
+    @returns    false if a chunk couldn't be written (the store is full,
+                or would run past key 0xFE)
+*/
+/**************************************************************************/
+bool rsaBigPriKeySave(const rsaBigPriKey_t *key, uint8_t baseKey)
+{
+  uint8_t store[RSA_PRIKEY_STORESIZE(RSA_MAXLIMBS / 2)];
+  uint32_t size = key->len * 4;
+  uint32_t total = RSA_PRIKEY_STORESIZE(key->len);
+  uint32_t offset, chunk;
+  bool ok = true;
+
+  if ((uint32_t)baseKey + (total + CFG_EEPROM_KV_MAXVALUE - 1) / CFG_EEPROM_KV_MAXVALUE > 0xFF)
+  {
+    return false;
+  }
+
+  store[0] = key->len;
+  rsaBigToBytes(&store[1], size, key->p.n, key->p.len);
+  rsaBigToBytes(&store[1 + size], size, key->q.n, key->q.len);
+  rsaBigToBytes(&store[1 + 2 * size], size, key->dp, key->len);
+  rsaBigToBytes(&store[1 + 3 * size], size, key->dq, key->len);
+  rsaBigToBytes(&store[1 + 4 * size], size, key->qinv, key->len);
+
+  for (offset = 0; ok && (offset < total); offset += chunk)
+  {
+    chunk = total - offset;
+    if (chunk > CFG_EEPROM_KV_MAXVALUE)
+    {
+      chunk = CFG_EEPROM_KV_MAXVALUE;
+    }
+    ok = eepromKvWrite(baseKey++, &store[offset], chunk) == EEPROMKV_ERROR_OK;
+  }
+
+  memset(store, 0, sizeof(store));
+  return ok;
+}
+
+/**************************************************************************/
+/*! 
+    Reads a private key written by rsaBigPriKeySave.
+
+    @returns    false if the key isn't in the store (or is damaged)
+*/
+/**************************************************************************/
+bool rsaBigPriKeyLoad(rsaBigPriKey_t *key, uint8_t baseKey)
+{
+  uint8_t store[RSA_PRIKEY_STORESIZE(RSA_MAXLIMBS / 2)];
+  uint32_t total = 1;
+  uint32_t offset, size, chunk;
+  uint8_t length;
+  bool ok = true;
+
+  for (offset = 0; ok && (offset < total); offset += length)
+  {
+    chunk = sizeof(store) - offset;
+    if (chunk > CFG_EEPROM_KV_MAXVALUE)
+    {
+      chunk = CFG_EEPROM_KV_MAXVALUE;
+    }
+    ok = (eepromKvRead(baseKey++, &store[offset], chunk, &length) == EEPROMKV_ERROR_OK) && length;
+    if (ok && !offset)
+    {
+      // The first byte says how long the whole key is
+      ok = store[0] && (store[0] <= RSA_MAXLIMBS / 2);
+      total = RSA_PRIKEY_STORESIZE(store[0]);
+    }
+  }
+
+  if (ok)
+  {
+    size = store[0] * 4;
+    ok = (offset == total) &&
+         rsaBigPriKeyInit(key, &store[1], &store[1 + size], &store[1 + 2 * size],
+                          &store[1 + 3 * size], &store[1 + 4 * size], size);
+  }
+
+  memset(store, 0, sizeof(store));
+  return ok;
+}
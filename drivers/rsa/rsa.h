@@ -6,7 +6,9 @@
     @date     4 January, 2010
     @version  1.0
 
-    Basic RSA-encryption using 64-bit math (32-bit keys).
+    Basic RSA-encryption using 64-bit math (32-bit keys), and
+    multi-precision RSA with Montgomery arithmetic for real key sizes
+    (up to CFG_RSA_MAXBITS).
 
     Based on the examples from "Mastering Algorithms with C" by
     Kyle Loudon (O'Reilly, 1999).
@@ -44,8 +46,58 @@ typedef struct rsaPriKey_s
 } 
 rsaPriKey_t;
 
+/* Multi-precision numbers are arrays of 32-bit limbs, least significant  *
+ * limb first.                                                             */
+#define RSA_MAXLIMBS    (CFG_RSA_MAXBITS / 32)
+
+/* Montgomery context for one modulus (see rsaMontInit) */
+typedef struct rsaMont_s
+{
+  uint32_t n[RSA_MAXLIMBS];     // Modulus (odd)
+  uint32_t rr[RSA_MAXLIMBS];    // R^2 mod n, with R = 2^(32 * len)
+  uint32_t n0inv;               // -n^-1 mod 2^32
+  uint8_t  len;                 // Limbs in use
+}
+rsaMont_t;
+
+/* Big RSA public key */
+typedef struct rsaBigPubKey_s
+{
+  rsaMont_t mont;
+  uint32_t  e;                  // Public exponent (typically 65537)
+}
+rsaBigPubKey_t;
+
+/* Big RSA private key in CRT form, with two primes of (at most) half    *
+ * the modulus length.  dp = d mod (p-1), dq = d mod (q-1) and           *
+ * qinv = q^-1 mod p.                                                    */
+typedef struct rsaBigPriKey_s
+{
+  rsaMont_t p;
+  rsaMont_t q;
+  uint32_t  dp[RSA_MAXLIMBS / 2];
+  uint32_t  dq[RSA_MAXLIMBS / 2];
+  uint32_t  qinv[RSA_MAXLIMBS / 2];
+  uint8_t   len;                // Limbs in each value (half the modulus)
+}
+rsaBigPriKey_t;
+
 void rsaTest();
 void rsaEncrypt(huge_t plaintext, huge_t *ciphertext, rsaPubKey_t pubkey);
 void rsaDecrypt(huge_t ciphertext, huge_t *plaintext, rsaPriKey_t prikey);
 
+bool rsaMontInit(rsaMont_t *mont, const uint32_t *n, uint8_t len);
+void rsaMontMul(const rsaMont_t *mont, uint32_t *r, const uint32_t *a, const uint32_t *b);
+bool rsaModExp(const rsaMont_t *mont, uint32_t *r, const uint32_t *base, const uint32_t *exp, uint8_t expLen);
+void rsaBigFromBytes(uint32_t *r, uint8_t len, const uint8_t *bytes, uint32_t size);
+void rsaBigToBytes(uint8_t *bytes, uint32_t size, const uint32_t *a, uint8_t len);
+bool rsaBigKeyInit(rsaBigPubKey_t *key, const uint8_t *modulus, uint32_t size, uint32_t e);
+bool rsaBigPublic(const rsaBigPubKey_t *key, uint8_t *out, const uint8_t *in);
+bool rsaVerifySha256(const rsaBigPubKey_t *key, const uint8_t *signature, const uint8_t *digest);
+bool rsaBigPriKeyInit(rsaBigPriKey_t *key, const uint8_t *p, const uint8_t *q, const uint8_t *dp, const uint8_t *dq, const uint8_t *qinv, uint32_t size);
+bool rsaBigPrivate(const rsaBigPriKey_t *key, uint8_t *out, const uint8_t *in);
+bool rsaSignSha256(const rsaBigPriKey_t *key, uint8_t *signature, const uint8_t *digest);
+bool rsaBigPriKeySave(const rsaBigPriKey_t *key, uint8_t baseKey);
+bool rsaBigPriKeyLoad(rsaBigPriKey_t *key, uint8_t baseKey);
+
 #endif
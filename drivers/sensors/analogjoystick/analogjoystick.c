@@ -6,10 +6,32 @@
     @section DESCRIPTION
 
     Driver for a simple four-way analog joystick.
+
+    With CFG_ADC_BURST, joystickScanStart leaves both axes converting in
+    the background in burst mode, and joystickPoll drains the burst
+    rings every JOYSTICK_POLLMS, averages the new samples and smooths
+    them further with an exponential filter.  A dead zone around the
+    centre position (with some hysteresis so it doesn't chatter at the
+    edge) is treated as 'no direction', and the callback is only called
+    when the direction or the select button changes, so the UI gets
+    events instead of having to poll the ADC.  joystickGetValues and
+    joystickGetDirection then return the smoothed values without
+    starting any conversions.
+
+    joystickPoll runs from a scheduler task with CFG_SCHEDULER, and has
+    to be called from the main loop otherwise.
     
     @section Example
 
     @code 
+    static void joystickChanged(joystick_direction_t direction, bool select)
+    {
+      printf("Direction %d, select %d%s", direction, select, CFG_PRINTF_NEWLINE);
+    }
+
+    ...
+    joystickInit();
+    joystickScanStart(joystickChanged);
     @endcode
 	
     @section LICENSE
@@ -42,11 +64,80 @@
     SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 /**************************************************************************/
+#include <stdlib.h>
+
 #include "analogjoystick.h"
 #include "core/adc/adc.h"
 #include "core/gpio/gpio.h"
+#ifdef CFG_SCHEDULER
+  #include "core/sched/sched.h"
+#endif
 
 static bool _joystickInitialised = false;
+static uint32_t _joystickCentreH = 512;     // Axis readings at rest
+static uint32_t _joystickCentreV = 512;
+static joystick_direction_t _joystickDirection = JOYSTICK_DIR_NONE;
+
+#ifdef CFG_ADC_BURST
+static bool _joystickScanning = false;
+static joystickCallback_t _joystickCallback = 0;
+static uint32_t _joystickH, _joystickV;     // Smoothed, Q(JOYSTICK_SMOOTHSHIFT)
+static bool _joystickSelect;
+#ifdef CFG_SCHEDULER
+static schedTask_t _joystickTask;
+static bool _joystickTaskReady = false;
+
+static void joystickTask(schedTask_t *task)
+{
+  joystickPoll();
+}
+#endif
+#endif
+
+/**************************************************************************/
+/*! 
+    @brief  Works out the direction from a pair of readings.  The
+            previous direction is kept in mind so that a stick resting
+            on the edge of the dead zone doesn't flip in and out of it.
+*/
+/**************************************************************************/
+static joystick_direction_t joystickDirectionFor(uint32_t hor, uint32_t ver)
+{
+  static const joystick_direction_t sectors[3][3] =
+  {
+    { JOYSTICK_DIR_SOUTHWEST, JOYSTICK_DIR_SOUTH, JOYSTICK_DIR_SOUTHEAST },
+    { JOYSTICK_DIR_WEST,      JOYSTICK_DIR_NONE,  JOYSTICK_DIR_EAST      },
+    { JOYSTICK_DIR_NORTHWEST, JOYSTICK_DIR_NORTH, JOYSTICK_DIR_NORTHEAST }
+  };
+  int32_t dx = (int32_t)hor - (int32_t)_joystickCentreH;
+  int32_t dy = (int32_t)ver - (int32_t)_joystickCentreV;
+  int32_t ax = abs(dx), ay = abs(dy);
+  int32_t zone = JOYSTICK_DEADZONE;
+  int8_t sx, sy;
+
+  if (_joystickDirection == JOYSTICK_DIR_NONE)
+  {
+    zone += JOYSTICK_HYSTERESIS;
+  }
+  if ((ax <= zone) && (ay <= zone))
+  {
+    return JOYSTICK_DIR_NONE;
+  }
+
+  // Diagonal between 22.5 and 67.5 degrees (tan(67.5) ~ 12/5)
+  sx = dx < 0 ? -1 : 1;
+  sy = dy < 0 ? -1 : 1;
+  if (ay * 5 > ax * 12)
+  {
+    sx = 0;
+  }
+  else if (ax * 5 > ay * 12)
+  {
+    sy = 0;
+  }
+
+  return sectors[sy + 1][sx + 1];
+}
 
 /**************************************************************************/
 /*! 
@@ -68,6 +159,10 @@ void joystickInit(void)
   JOYSTICK_HORIZ_FUNC_ADC;
 
   _joystickInitialised = true;
+
+  // The stick is assumed to be at rest here
+  bool select;
+  joystickGetValues(&_joystickCentreH, &_joystickCentreV, &select);
 }
 
 /**************************************************************************/
@@ -90,9 +185,20 @@ void joystickGetValues(uint32_t *horizontal, uint32_t *vertical, bool *select)
 {
   if (!_joystickInitialised) joystickInit();
 
-  // Get current ADC values
-  *horizontal = adcRead(JOYSTICK_HORIZ_ADCPORT);
-  *vertical = adcRead(JOYSTICK_VERT_ADCPORT);
+#ifdef CFG_ADC_BURST
+  // The scan has the values already
+  if (_joystickScanning)
+  {
+    *horizontal = _joystickH >> JOYSTICK_SMOOTHSHIFT;
+    *vertical = _joystickV >> JOYSTICK_SMOOTHSHIFT;
+    *select = _joystickSelect;
+    return;
+  }
+#endif
+
+  // Get current ADC values (filtered, but kept on the 10-bit scale)
+  *horizontal = adcReadOversampled(JOYSTICK_HORIZ_ADCPORT, CFG_ADC_OVERSAMPLE) >> 2;
+  *vertical = adcReadOversampled(JOYSTICK_VERT_ADCPORT, CFG_ADC_OVERSAMPLE) >> 2;
   *select = gpioGetValue(JOYSTICK_SEL_PORT, JOYSTICK_SEL_PIN);
 }
 
@@ -113,11 +219,19 @@ void joystickGetDirection(joystick_direction_t *direction)
   uint32_t hor, ver;
   bool sel;
 
+#ifdef CFG_ADC_BURST
+  // Kept up to date by joystickPoll
+  if (_joystickScanning)
+  {
+    *direction = _joystickDirection;
+    return;
+  }
+#endif
+
   // Get current joystick position
   joystickGetValues(&hor, &ver, &sel);
-
-  // ToDo: Process values
-  direction = JOYSTICK_DIR_NONE;
+  _joystickDirection = joystickDirectionFor(hor, ver);
+  *direction = _joystickDirection;
 }
 
 /**************************************************************************/
@@ -136,3 +250,118 @@ void joystickGetRotation(uint32_t *rotation)
 
   // ToDo
 }
+
+#ifdef CFG_ADC_BURST
+/**************************************************************************/
+/*! 
+    @brief  Starts scanning both axes in the background (ADC burst mode)
+            and calls 'callback' from joystickPoll each time the
+            direction or the select button changes
+
+    @param[in]  callback
+                Called with the new direction and select state (can be
+                0 if joystickGetDirection is polled instead)
+*/
+/**************************************************************************/
+void joystickScanStart(joystickCallback_t callback)
+{
+  if (!_joystickInitialised) joystickInit();
+
+  _joystickCallback = callback;
+  _joystickH = _joystickCentreH << JOYSTICK_SMOOTHSHIFT;
+  _joystickV = _joystickCentreV << JOYSTICK_SMOOTHSHIFT;
+  _joystickSelect = gpioGetValue(JOYSTICK_SEL_PORT, JOYSTICK_SEL_PIN);
+  _joystickDirection = JOYSTICK_DIR_NONE;
+
+  adcBurstStart((1 << JOYSTICK_HORIZ_ADCPORT) | (1 << JOYSTICK_VERT_ADCPORT));
+  _joystickScanning = true;
+
+  #ifdef CFG_SCHEDULER
+    if (!_joystickTaskReady)
+    {
+      schedTaskInit(&_joystickTask, joystickTask, NULL);
+      _joystickTaskReady = true;
+    }
+    schedStartTimer(&_joystickTask, JOYSTICK_POLLMS, JOYSTICK_POLLMS);
+  #endif
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Stops the background scan (and burst mode)
+*/
+/**************************************************************************/
+void joystickScanStop(void)
+{
+  if (!_joystickScanning)
+  {
+    return;
+  }
+
+  _joystickScanning = false;
+  adcBurstStop();
+
+  #ifdef CFG_SCHEDULER
+    schedStopTimer(&_joystickTask);
+  #endif
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Averages the samples scanned since the last call into an
+            axis' smoothed value (left alone if there are none)
+*/
+/**************************************************************************/
+static void joystickSmooth(uint8_t channel, uint32_t *smoothed)
+{
+  uint16_t samples[CFG_ADC_RINGSIZE];
+  uint32_t count, sum = 0, n;
+
+  count = adcReadBlock(channel, samples, CFG_ADC_RINGSIZE);
+  if (!count)
+  {
+    return;
+  }
+  for (n = 0; n < count; n++)
+  {
+    sum += samples[n];
+  }
+
+  // smoothed += average - smoothed / 2^shift, all in Q(shift)
+  *smoothed += sum / count - (*smoothed >> JOYSTICK_SMOOTHSHIFT);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Updates the smoothed axes and calls the callback if the
+            direction or the select button changed.  Runs from the
+            scheduler with CFG_SCHEDULER, and has to be called
+            regularly from the main loop otherwise.
+*/
+/**************************************************************************/
+void joystickPoll(void)
+{
+  joystick_direction_t direction;
+  bool select;
+
+  if (!_joystickScanning)
+  {
+    return;
+  }
+
+  joystickSmooth(JOYSTICK_HORIZ_ADCPORT, &_joystickH);
+  joystickSmooth(JOYSTICK_VERT_ADCPORT, &_joystickV);
+
+  direction = joystickDirectionFor(_joystickH >> JOYSTICK_SMOOTHSHIFT, _joystickV >> JOYSTICK_SMOOTHSHIFT);
+  select = gpioGetValue(JOYSTICK_SEL_PORT, JOYSTICK_SEL_PIN);
+  if ((direction != _joystickDirection) || (select != _joystickSelect))
+  {
+    _joystickDirection = direction;
+    _joystickSelect = select;
+    if (_joystickCallback)
+    {
+      _joystickCallback(direction, select);
+    }
+  }
+}
+#endif
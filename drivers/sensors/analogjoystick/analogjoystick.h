@@ -61,9 +61,30 @@ typedef enum
   JOYSTICK_DIR_NORTHWEST = 8
 } joystick_direction_t;
 
+#define JOYSTICK_DEADZONE         (64)    // Counts from the centre treated as centred
+#define JOYSTICK_HYSTERESIS       (16)    // Extra counts needed to leave the centre
+
+#ifdef CFG_ADC_BURST
+#define JOYSTICK_POLLMS           (20)    // Scan period when running from the scheduler
+#define JOYSTICK_SMOOTHSHIFT      (2)     // Smoothing: each scan moves 1/4 of the way
+
+/**************************************************************************/
+/*! 
+    Called by joystickPoll when the direction or the select button
+    changes
+*/
+/**************************************************************************/
+typedef void (*joystickCallback_t)(joystick_direction_t direction, bool select);
+#endif
+
 void joystickInit(void);
 void joystickGetValues(uint32_t *horizontal, uint32_t *vertical, bool *select);
 void joystickGetDirection(joystick_direction_t *direction);
 void joystickGetRotation(uint32_t *rotation);
+#ifdef CFG_ADC_BURST
+void joystickScanStart(joystickCallback_t callback);
+void joystickScanStop(void);
+void joystickPoll(void);
+#endif
 
 #endif
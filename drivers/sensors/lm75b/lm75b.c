@@ -12,6 +12,14 @@
     in degrees celsius where each unit is equal to 0.125°C.  For example,
     if the temperature reading is 198, it means that the temperature in
     degree celsius is: 198 / 8 = 24.75°C.
+
+    Instead of polling, the OS output can wake the MCU when the
+    temperature goes above a limit and again once it has dropped back
+    below the hysteresis point (lm75bSetThresholds).  lm75bAlarmStart
+    keeps the sensor converting with OS in comparator mode and calls
+    back from the GPIO interrupt on both edges, so nothing needs to be
+    read over I2C until the alarm changes (lm75bAlarmActive tells which
+    way it went).  OS is open-drain and needs a pull-up.
     
     @section Example
 
@@ -49,6 +57,31 @@
       }
     }
     @endcode
+
+    @code 
+    static volatile bool tempChanged = false;
+
+    static void tempAlarm(void)
+    {
+      tempChanged = true;
+    }
+
+    ...
+    // Alarm above 30.0°C, cleared again below 28.0°C (0.125°C units),
+    // with OS on 2.4 and two readings in a row needed to change state
+    lm75bSetThresholds(30 * 8, 28 * 8);
+    lm75bAlarmStart(2, 4, LM75B_CONFIG_FAULTQUEUE_2, tempAlarm);
+
+    while (1)
+    {
+      __WFI();
+      if (tempChanged)
+      {
+        tempChanged = false;
+        printf("Alarm %s\n", lm75bAlarmActive() ? "on" : "off");
+      }
+    }
+    @endcode
 	
     @section LICENSE
 
@@ -82,6 +115,7 @@
 /**************************************************************************/
 
 #include "lm75b.h"
+#include "core/gpio/gpio.h"
 
 extern volatile uint8_t   I2CMasterBuffer[I2C_BUFSIZE];
 extern volatile uint8_t   I2CSlaveBuffer[I2C_BUFSIZE];
@@ -90,6 +124,56 @@ extern volatile uint32_t  I2CReadLength, I2CWriteLength;
 uint32_t i;
 
 static bool _lm75bInitialised = false;
+static bool _lm75bAlarm = false;            // Converting continuously for OS
+static uint32_t _lm75bAlarmPort, _lm75bAlarmPin;
+static void (*_lm75bAlarmCallback)(void) = 0;
+
+static uint32_t lm75bConversionTime(void)
+{
+  // The first conversion after leaving shutdown takes up to 100ms
+  return 100;
+}
+
+/* OS changed state (GPIO interrupt) */
+static void lm75bAlarmIRQ(void)
+{
+  if (_lm75bAlarmCallback)
+  {
+    _lm75bAlarmCallback();
+  }
+}
+
+/* Batch sampling with sensorPoll: returns the temperature register, */
+/* to be converted with lm75bConvert(sensorPollGet16BE(poll, 0))     */
+const sensorPollDevice_t lm75bPollDevice =
+{
+  .address        = LM75B_ADDRESS,
+  .speed          = LM75B_I2C_SPEED,
+  .start          = { LM75B_REGISTER_CONFIGURATION, LM75B_CONFIG_SHUTDOWN_POWERON },
+  .stop           = { LM75B_REGISTER_CONFIGURATION, LM75B_CONFIG_SHUTDOWN_SHUTDOWN },
+  .reads          = { LM75B_REGISTER_TEMPERATURE },
+  .readCount      = 1,
+  .conversionTime = lm75bConversionTime
+};
+
+/**************************************************************************/
+/*! 
+    @brief  Converts the raw temperature register (MSB first) into
+            signed units of 0.125C
+*/
+/**************************************************************************/
+int32_t lm75bConvert (uint16_t raw)
+{
+  int32_t value = raw >> 5;
+
+  //  Sign extend negative numbers
+  if (raw & 0x8000)
+  {
+    // Negative number
+    value |= 0xFFFFFC00;
+  }
+  return value;
+}
 
 /**************************************************************************/
 /*! 
@@ -109,7 +193,7 @@ lm75bError_e lm75bWrite8 (uint8_t reg, uint32_t value)
   I2CMasterBuffer[0] = LM75B_ADDRESS;             // I2C device address
   I2CMasterBuffer[1] = reg;                       // Command register
   I2CMasterBuffer[2] = (value & 0xFF);            // Value to write
-  i2cEngine();
+  i2cEngineSpeed(LM75B_I2C_SPEED);
   return LM75B_ERROR_OK;
 }
 
@@ -132,17 +216,33 @@ lm75bError_e lm75bRead16(uint8_t reg, int32_t *value)
   I2CMasterBuffer[1] = reg;                       // Command register
   // Append address w/read bit
   I2CMasterBuffer[2] = LM75B_ADDRESS | LM75B_READBIT;  
-  i2cEngine();
+  i2cEngineSpeed(LM75B_I2C_SPEED);
 
   // Shift values to create properly formed integer
-  *value = ((I2CSlaveBuffer[0] << 8) | I2CSlaveBuffer[1]) >> 5;
+  *value = lm75bConvert((I2CSlaveBuffer[0] << 8) | I2CSlaveBuffer[1]);
+  return LM75B_ERROR_OK;
+}
 
-  //  Sign extend negative numbers
-  if (I2CSlaveBuffer[0] & 0x80)
+/**************************************************************************/
+/*! 
+    @brief  Writes a 16 bit value (MSB first) over I2C
+*/
+/**************************************************************************/
+lm75bError_e lm75bWrite16 (uint8_t reg, uint16_t value)
+{
+  // Clear write buffers
+  for ( i = 0; i < I2C_BUFSIZE; i++ )
   {
-    // Negative number
-    *value |= 0xFFFFFC00;
+    I2CMasterBuffer[i] = 0x00;
   }
+
+  I2CWriteLength = 4;
+  I2CReadLength = 0;
+  I2CMasterBuffer[0] = LM75B_ADDRESS;             // I2C device address
+  I2CMasterBuffer[1] = reg;                       // Command register
+  I2CMasterBuffer[2] = (value >> 8);              // MSB
+  I2CMasterBuffer[3] = (value & 0xFF);            // LSB
+  i2cEngineSpeed(LM75B_I2C_SPEED);
   return LM75B_ERROR_OK;
 }
 
@@ -182,15 +282,21 @@ lm75bError_e lm75bGetTemperature (int32_t *temp)
 {
   if (!_lm75bInitialised) lm75bInit();
 
-  // Turn device on
-  lm75bConfigWrite (LM75B_CONFIG_SHUTDOWN_POWERON);
+  // Turn device on (it's left on while the alarm is running)
+  if (!_lm75bAlarm)
+  {
+    lm75bConfigWrite (LM75B_CONFIG_SHUTDOWN_POWERON);
+  }
 
   // Read temperature
   lm75bError_e error = LM75B_ERROR_OK;
   error = lm75bRead16 (LM75B_REGISTER_TEMPERATURE, temp);
 
   // Shut device back down
-  lm75bConfigWrite (LM75B_CONFIG_SHUTDOWN_SHUTDOWN);
+  if (!_lm75bAlarm)
+  {
+    lm75bConfigWrite (LM75B_CONFIG_SHUTDOWN_SHUTDOWN);
+  }
 
   return error;
 }
@@ -206,3 +312,112 @@ lm75bError_e lm75bConfigWrite (uint8_t configValue)
 
   return lm75bWrite8 (LM75B_REGISTER_CONFIGURATION, configValue);
 }
+
+/**************************************************************************/
+/*! 
+    @brief  Sets the OS alarm limit and the point it is cleared again
+
+    @param[in]  limit
+                OS becomes active above this temperature (0.125°C units,
+                rounded down to the 0.5°C steps of the register)
+    @param[in]  hysteresis
+                OS becomes inactive again below this temperature (must
+                be lower than 'limit')
+*/
+/**************************************************************************/
+lm75bError_e lm75bSetThresholds (int32_t limit, int32_t hysteresis)
+{
+  lm75bError_e error;
+
+  // 9-bit two's complement registers, 0.5°C per unit, left justified
+  limit >>= 2;
+  hysteresis >>= 2;
+  if ((hysteresis >= limit) || (limit > 255) || (hysteresis < -256))
+  {
+    return LM75B_ERROR_INVALIDTHRESHOLD;
+  }
+
+  if (!_lm75bInitialised) lm75bInit();
+
+  error = lm75bWrite16 (LM75B_REGISTER_TOS, (uint16_t)(limit << 7));
+  if (error) return error;
+  return lm75bWrite16 (LM75B_REGISTER_THYST, (uint16_t)(hysteresis << 7));
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Keeps the sensor converting with OS (active low) in
+            comparator mode, and calls 'callback' from the GPIO interrupt
+            each time OS changes state
+
+    @param[in]  port
+                The GPIO port OS is connected to
+    @param[in]  pin
+                The pin OS is connected to
+    @param[in]  faultQueue
+                LM75B_CONFIG_FAULTQUEUE_1..6, the number of readings in
+                a row needed to change the state of OS
+    @param[in]  callback
+                Called from the interrupt when OS changes (can be 0 if
+                the interrupt is only used to wake the MCU)
+*/
+/**************************************************************************/
+lm75bError_e lm75bAlarmStart (uint32_t port, uint32_t pin, uint8_t faultQueue, void (*callback)(void))
+{
+  lm75bError_e error;
+
+  if ((port > 3) || (pin > 11))
+  {
+    return LM75B_ERROR_INTERRUPT;
+  }
+
+  lm75bAlarmStop();
+
+  error = lm75bConfigWrite (LM75B_CONFIG_SHUTDOWN_POWERON | LM75B_CONFIG_OSMODE_COMPARATOR |
+                            LM75B_CONFIG_OSPOL_ACTIVELOW | (faultQueue & LM75B_CONFIG_FAULTQUEUE_MASK));
+  if (error) return error;
+
+  _lm75bAlarmCallback = callback;
+  gpioSetDir(port, pin, gpioDirection_Input);
+  if (!gpioAttachInterrupt(port, pin, gpioInterruptSense_Edge, gpioInterruptEdge_Double,
+                           gpioInterruptEvent_ActiveLow, lm75bAlarmIRQ))
+  {
+    lm75bConfigWrite (LM75B_CONFIG_SHUTDOWN_SHUTDOWN);
+    return LM75B_ERROR_INTERRUPT;
+  }
+
+  _lm75bAlarmPort = port;
+  _lm75bAlarmPin = pin;
+  _lm75bAlarm = true;
+
+  return LM75B_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Stops the alarm interrupt and shuts the sensor back down
+*/
+/**************************************************************************/
+lm75bError_e lm75bAlarmStop (void)
+{
+  if (!_lm75bAlarm)
+  {
+    return LM75B_ERROR_OK;
+  }
+
+  gpioDetachInterrupt(_lm75bAlarmPort, _lm75bAlarmPin);
+  _lm75bAlarm = false;
+
+  return lm75bConfigWrite (LM75B_CONFIG_SHUTDOWN_SHUTDOWN);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns true while OS is active (above the limit and not
+            yet back below the hysteresis point)
+*/
+/**************************************************************************/
+bool lm75bAlarmActive (void)
+{
+  return _lm75bAlarm && !gpioGetValue(_lm75bAlarmPort, _lm75bAlarmPin);
+}
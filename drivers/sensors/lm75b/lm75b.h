@@ -41,22 +41,39 @@
 
 #include "projectconfig.h"
 #include "core/i2c/i2c.h"
+#include "drivers/sensors/sensorpoll/sensorpoll.h"
 
 #define LM75B_ADDRESS (0x90) // 100 1000 shifted left 1 bit = 0x90
+#define LM75B_I2C_SPEED (I2C_SPEED_FAST)  // 400 kHz fast mode
 #define LM75B_READBIT (0x01)
 
 #define LM75B_REGISTER_TEMPERATURE      (0x00)
 #define LM75B_REGISTER_CONFIGURATION    (0x01)
+#define LM75B_REGISTER_THYST            (0x02)
+#define LM75B_REGISTER_TOS              (0x03)
 
 #define LM75B_CONFIG_SHUTDOWN_MASK      (0x01)
 #define LM75B_CONFIG_SHUTDOWN_POWERON   (0x00)
 #define LM75B_CONFIG_SHUTDOWN_SHUTDOWN  (0x01)
+#define LM75B_CONFIG_OSMODE_MASK        (0x02)
+#define LM75B_CONFIG_OSMODE_COMPARATOR  (0x00)
+#define LM75B_CONFIG_OSMODE_INTERRUPT   (0x02)
+#define LM75B_CONFIG_OSPOL_MASK         (0x04)
+#define LM75B_CONFIG_OSPOL_ACTIVELOW    (0x00)
+#define LM75B_CONFIG_OSPOL_ACTIVEHIGH   (0x04)
+#define LM75B_CONFIG_FAULTQUEUE_MASK    (0x18)
+#define LM75B_CONFIG_FAULTQUEUE_1       (0x00)
+#define LM75B_CONFIG_FAULTQUEUE_2       (0x08)
+#define LM75B_CONFIG_FAULTQUEUE_4       (0x10)
+#define LM75B_CONFIG_FAULTQUEUE_6       (0x18)
 
 typedef enum
 {
   LM75B_ERROR_OK = 0,               // Everything executed normally
   LM75B_ERROR_I2CINIT,              // Unable to initialise I2C
   LM75B_ERROR_I2CBUSY,              // I2C already in use
+  LM75B_ERROR_INVALIDTHRESHOLD,     // Hysteresis not below the limit, or out of range
+  LM75B_ERROR_INTERRUPT,            // Pin out of range or no GPIO callback free
   LM75B_ERROR_LAST
 }
 lm75bError_e;
@@ -64,6 +81,13 @@ lm75bError_e;
 lm75bError_e lm75bInit(void);
 lm75bError_e lm75bGetTemperature (int32_t *temp);
 lm75bError_e lm75bConfigWrite (uint8_t configValue);
+int32_t      lm75bConvert (uint16_t raw);
+lm75bError_e lm75bSetThresholds (int32_t limit, int32_t hysteresis);
+lm75bError_e lm75bAlarmStart (uint32_t port, uint32_t pin, uint8_t faultQueue, void (*callback)(void));
+lm75bError_e lm75bAlarmStop (void);
+bool         lm75bAlarmActive (void);
+
+extern const sensorPollDevice_t lm75bPollDevice;
 
 #endif
 
@@ -12,6 +12,211 @@
 
 static pn532_pcb_t pcb;
 
+enum
+{
+  PN532_PARSE_PREAMBLE,
+  PN532_PARSE_LEN,
+  PN532_PARSE_LCS,
+  PN532_PARSE_DATA,
+  PN532_PARSE_DCS
+};
+
+/**************************************************************************/
+/*! 
+    @brief  Resets the frame parser to look for a new start code
+*/
+/**************************************************************************/
+void pn532FrameReset(pn532_parser_t *parser)
+{
+  parser->state = PN532_PARSE_PREAMBLE;
+  parser->zeros = 0;
+  parser->pos = 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Feeds one received byte to the frame parser.  Checksums are
+            checked as the bytes arrive, so the frame is known to be
+            complete and valid the moment its DCS byte is in.
+
+    @param  parser      Parser state (see pn532FrameReset)
+    @param  b           The received byte
+    @param  pbtFrame    Buffer the frame is stored in, normalised to
+                        00 00 FF LEN LCS TFI DATA... DCS 00.  It must
+                        stay the same until the frame is complete.
+    @param  szFrameMax  Size of pbtFrame
+
+    @return PN532_FRAME_INCOMPLETE until a whole frame (or an error) has
+            been seen, after which the parser starts over.  The frame
+            length is then parser->pos.
+*/
+/**************************************************************************/
+pn532_frame_t pn532FrameParse(pn532_parser_t *parser, byte_t b, byte_t *pbtFrame, size_t szFrameMax)
+{
+  switch (parser->state)
+  {
+    case PN532_PARSE_PREAMBLE:
+      // Any number of 00's followed by the FF start code
+      if (b == 0x00)
+      {
+        parser->zeros++;
+      }
+      else if ((b == 0xFF) && parser->zeros)
+      {
+        pbtFrame[0] = 0x00;
+        pbtFrame[1] = 0x00;
+        pbtFrame[2] = 0xFF;
+        parser->pos = 3;
+        parser->state = PN532_PARSE_LEN;
+      }
+      else
+      {
+        parser->zeros = 0;
+      }
+      return PN532_FRAME_INCOMPLETE;
+
+    case PN532_PARSE_LEN:
+      parser->len = b;
+      pbtFrame[parser->pos++] = b;
+      parser->state = PN532_PARSE_LCS;
+      return PN532_FRAME_INCOMPLETE;
+
+    case PN532_PARSE_LCS:
+      pbtFrame[parser->pos++] = b;
+      pn532FrameReset(parser);
+      if ((parser->len == 0x00) && (b == 0xFF))
+      {
+        return PN532_FRAME_ACK;
+      }
+      if ((parser->len == 0xFF) && (b == 0x00))
+      {
+        return PN532_FRAME_NACK;
+      }
+      if ((parser->len == 0xFF) && (b == 0xFF))
+      {
+        return PN532_FRAME_EXTENDED;
+      }
+      if ((byte_t)(parser->len + b) || (parser->len == 0))
+      {
+        return PN532_FRAME_CHECKSUMERROR;
+      }
+      if (parser->len + PN532_NORMAL_FRAME__OVERHEAD - 1 > szFrameMax)
+      {
+        return PN532_FRAME_OVERFLOW;
+      }
+      parser->pos = 5;
+      parser->sum = 0;
+      parser->state = PN532_PARSE_DATA;
+      return PN532_FRAME_INCOMPLETE;
+
+    case PN532_PARSE_DATA:
+      pbtFrame[parser->pos++] = b;
+      parser->sum += b;
+      if (parser->pos == 5 + parser->len)
+      {
+        parser->state = PN532_PARSE_DCS;
+      }
+      return PN532_FRAME_INCOMPLETE;
+
+    default:
+      // DCS: the frame is done, the postamble isn't waited for
+      pbtFrame[parser->pos++] = b;
+      pbtFrame[parser->pos++] = 0x00;
+      parser->state = PN532_PARSE_PREAMBLE;
+      parser->zeros = 0;
+      if ((byte_t)(parser->sum + b))
+      {
+        return PN532_FRAME_CHECKSUMERROR;
+      }
+      if ((parser->len == 1) && (pbtFrame[5] == 0x7F))
+      {
+        return PN532_FRAME_ERROR;
+      }
+      return PN532_FRAME_RESPONSE;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Converts a complete frame from pn532FrameParse into the
+            matching stack error, recording the application level
+            error code from error frames in the PCB.  This is shared by
+            all of the transport drivers.
+*/
+/**************************************************************************/
+pn532_error_t pn532FrameError(pn532_frame_t frame, const byte_t * pbtResponse)
+{
+  switch (frame)
+  {
+    case PN532_FRAME_RESPONSE:
+      return PN532_ERROR_NONE;
+    case PN532_FRAME_ERROR:
+      // Error frame
+      PN532_DEBUG("Application level error (%02d)%s", pbtResponse[5], CFG_PRINTF_NEWLINE);
+      // Set application error message ID
+      pcb.appError = pbtResponse[5];
+      return PN532_ERROR_APPLEVELERROR;
+    case PN532_FRAME_EXTENDED:
+      PN532_DEBUG("Extended frames currently unsupported%s", CFG_PRINTF_NEWLINE);
+      return PN532_ERROR_EXTENDEDFRAME;
+    case PN532_FRAME_NACK:
+    case PN532_FRAME_OVERFLOW:
+      PN532_DEBUG("Frame preamble + start code mismatch%s", CFG_PRINTF_NEWLINE);
+      return PN532_ERROR_PREAMBLEMISMATCH;
+    default:
+      PN532_DEBUG("Length checksum mismatch%s", CFG_PRINTF_NEWLINE);
+      return PN532_ERROR_LENCHECKSUMMISMATCH;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Builds a standard PN532 frame using the supplied data
+
+    @param  pbtFrame  Pointer to the field that will hold the frame data
+    @param  pszFrame  Pointer to the field that will hold the frame length
+    @param  pbtData   Pointer to the data to insert in a frame
+    @param  swData    Length of the data to insert in bytes
+
+    @note   Possible error messages are:
+
+            - PN532_ERROR_EXTENDEDFRAME
+*/
+/**************************************************************************/
+pn532_error_t pn532BuildFrame(byte_t * pbtFrame, size_t * pszFrame, const byte_t * pbtData, const size_t szData)
+{
+  if (szData > PN532_NORMAL_FRAME__DATA_MAX_LEN) 
+  {
+    // Extended frames currently unsupported
+    return PN532_ERROR_EXTENDEDFRAME;
+  }
+
+  // LEN - Packet length = data length (len) + checksum (1) + end of stream marker (1)
+  pbtFrame[3] = szData + 1;
+  // LCS - Packet length checksum
+  pbtFrame[4] = 256 - (szData + 1);
+  // TFI
+  pbtFrame[5] = 0xD4;
+  // DATA - Copy the PN53X command into the packet buffer
+  memcpy (pbtFrame + 6, pbtData, szData);
+
+  // DCS - Calculate data payload checksum
+  byte_t btDCS = (256 - 0xD4);
+  size_t szPos;
+  for (szPos = 0; szPos < szData; szPos++) 
+  {
+    btDCS -= pbtData[szPos];
+  }
+  pbtFrame[6 + szData] = btDCS;
+
+  // 0x00 - End of stream marker
+  pbtFrame[szData + 7] = 0x00;
+
+  (*pszFrame) = szData + PN532_NORMAL_FRAME__OVERHEAD;
+
+  return PN532_ERROR_NONE;
+}
+
 /**************************************************************************/
 /*! 
     @brief  Prints a hexadecimal value in plain characters
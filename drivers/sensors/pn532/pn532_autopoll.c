@@ -0,0 +1,309 @@
+/**************************************************************************/
+/*! 
+    @file     pn532_autopoll.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Continuous ISO14443A card detection with the PN532's InAutoPoll
+    command.  The PN532 does the polling itself ('period' x 150ms per
+    round), and pn532AutoPollTask, called from the main loop, sends the
+    next InAutoPoll as soon as the previous one has answered.
+
+    Cards that were seen recently are cached with their timestamps, so
+    the arrival callback fires once per card rather than once per poll,
+    and the removal callback fires when a card hasn't been seen for
+    'removeTimeout' ms.
+
+    @code
+    #include "drivers/sensors/pn532/pn532_autopoll.h"
+
+    void cardArrived(const pn532_card_t *card) { ... }
+    void cardRemoved(const pn532_card_t *card) { ... }
+
+    // Poll every 150ms, forget cards after 1s out of the field
+    pn532AutoPollInit(1, 1000, cardArrived, cardRemoved);
+    while (1)
+    {
+      pn532AutoPollTask();
+      __asm volatile ("wfi");
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include <string.h>
+
+#include "pn532_autopoll.h"
+#include "pn532_drvr.h"
+#include "core/systick/systick.h"
+
+#define PN532_AUTOPOLL_TYPE_GENERIC106  (0x00)    // Passive 106kbps ISO14443A (Mifare, -4A, DEP)
+#define PN532_AUTOPOLL_RETRYMS          (100)     // Wait after a transport error
+
+typedef enum
+{
+  PN532_AUTOPOLL_STATE_IDLE,
+  PN532_AUTOPOLL_STATE_WAITING,
+  PN532_AUTOPOLL_STATE_BACKOFF
+} pn532_autopollstate_t;
+
+static struct
+{
+  pn532_autopollstate_t state;
+  uint8_t               period;
+  uint32_t              removeTicks;
+  uint32_t              timeoutTicks;
+  uint32_t              started;
+  pn532_cardcallback_t  arrival;
+  pn532_cardcallback_t  removal;
+  pn532_card_t          cache[PN532_AUTOPOLL_CACHESIZE];
+} _pn532AutoPoll;
+
+/* The response is parsed in place across several pn532Read calls, so  *
+ * the buffer has to stay put between pn532AutoPollTask calls.         */
+static byte_t _pn532AutoPollResponse[PN532_BUFFER_LEN];
+
+/**************************************************************************/
+/*! 
+    @brief  Sets up the engine, which starts polling on the first call
+            to pn532AutoPollTask
+
+    @param  period          Time between polling rounds in units of 150ms
+                            (1..15)
+    @param  removeTimeout   A card is reported as removed when it hasn't
+                            been seen for this many ms
+    @param  arrival         Called when a new card enters the field (may
+                            be NULL)
+    @param  removal         Called when a card has left the field (may be
+                            NULL)
+*/
+/**************************************************************************/
+void pn532AutoPollInit(uint8_t period, uint32_t removeTimeout, pn532_cardcallback_t arrival, pn532_cardcallback_t removal)
+{
+  memset(&_pn532AutoPoll, 0, sizeof(_pn532AutoPoll));
+
+  if (period < 1) period = 1;
+  if (period > 15) period = 15;
+
+  _pn532AutoPoll.period = period;
+  _pn532AutoPoll.removeTicks = removeTimeout / CFG_SYSTICK_DELAY_IN_MS;
+  // One polling round plus the frame time, with some margin
+  _pn532AutoPoll.timeoutTicks = (period * 150 * 2 + 100) / CFG_SYSTICK_DELAY_IN_MS;
+  _pn532AutoPoll.arrival = arrival;
+  _pn532AutoPoll.removal = removal;
+  _pn532AutoPoll.state = PN532_AUTOPOLL_STATE_IDLE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Adds or refreshes a card in the cache
+*/
+/**************************************************************************/
+static void pn532AutoPollSeen(const byte_t *uid, uint8_t uidLen, uint16_t sensRes, uint8_t selRes, uint32_t now)
+{
+  pn532_card_t *card, *slot = NULL;
+  uint8_t i;
+
+  if (uidLen > PN532_AUTOPOLL_UIDMAXLEN)
+  {
+    return;
+  }
+
+  for (i = 0; i < PN532_AUTOPOLL_CACHESIZE; i++)
+  {
+    card = &_pn532AutoPoll.cache[i];
+    if ((card->uidLen == uidLen) && !memcmp(card->uid, uid, uidLen))
+    {
+      // Known card, just note that it's still there
+      card->lastSeen = now;
+      return;
+    }
+    // Remember a free entry, or else the one seen least recently
+    if (!slot || (slot->uidLen && (!card->uidLen || (now - card->lastSeen) > (now - slot->lastSeen))))
+    {
+      slot = card;
+    }
+  }
+
+  // Cache full: the evicted card counts as removed
+  if (slot->uidLen && _pn532AutoPoll.removal)
+  {
+    _pn532AutoPoll.removal(slot);
+  }
+
+  memcpy(slot->uid, uid, uidLen);
+  slot->uidLen = uidLen;
+  slot->sensRes = sensRes;
+  slot->selRes = selRes;
+  slot->firstSeen = now;
+  slot->lastSeen = now;
+
+  if (_pn532AutoPoll.arrival)
+  {
+    _pn532AutoPoll.arrival(slot);
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Walks an InAutoPoll response (D5 61 NbTg [Type Len Data]...)
+            and caches every ISO14443A target in it
+*/
+/**************************************************************************/
+static void pn532AutoPollParse(const byte_t *frame, size_t len, uint32_t now)
+{
+  size_t pos = 8;                 // First target, after 00 00 FF LEN LCS D5 61 NbTg
+  size_t end = 5 + frame[3];      // End of TFI + data
+  uint8_t targets;
+
+  if ((len < 9) || (frame[5] != 0xD5) || (frame[6] != PN532_COMMAND_INAUTOPOLL + 1) || (end > len))
+  {
+    return;
+  }
+
+  for (targets = frame[7]; targets && (pos + 2 <= end); targets--)
+  {
+    uint8_t type = frame[pos];
+    uint8_t dataLen = frame[pos + 1];
+    const byte_t *data = &frame[pos + 2];
+
+    if (pos + 2 + dataLen > end)
+    {
+      break;
+    }
+
+    // 106kbps type A targets: Tg SENS_RES(2) SEL_RES NFCIDLen NFCID...
+    if (((type & 0x0F) == PN532_AUTOPOLL_TYPE_GENERIC106) && (dataLen >= 5) && (5 + data[4] <= dataLen))
+    {
+      pn532AutoPollSeen(&data[5], data[4], (data[1] << 8) | data[2], data[3], now);
+    }
+
+    pos += 2 + dataLen;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reports and drops cards that haven't been seen for the
+            removal timeout
+*/
+/**************************************************************************/
+static void pn532AutoPollExpire(uint32_t now)
+{
+  pn532_card_t *card;
+  uint8_t i;
+
+  for (i = 0; i < PN532_AUTOPOLL_CACHESIZE; i++)
+  {
+    card = &_pn532AutoPoll.cache[i];
+    if (card->uidLen && ((now - card->lastSeen) > _pn532AutoPoll.removeTicks))
+    {
+      if (_pn532AutoPoll.removal)
+      {
+        _pn532AutoPoll.removal(card);
+      }
+      card->uidLen = 0;
+    }
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Runs the polling engine.  Never blocks for longer than one
+            command ACK, so call it as often as possible from the main
+            loop.  Callbacks are run from here.
+*/
+/**************************************************************************/
+void pn532AutoPollTask(void)
+{
+  // Poll once per command so removals are seen, then re-issue
+  byte_t abtCommand[] = { PN532_COMMAND_INAUTOPOLL, 0x01, _pn532AutoPoll.period, PN532_AUTOPOLL_TYPE_GENERIC106 };
+  uint32_t now = systickGetTicks();
+  pn532_error_t error;
+  size_t len;
+
+  switch (_pn532AutoPoll.state)
+  {
+    case PN532_AUTOPOLL_STATE_BACKOFF:
+      if ((now - _pn532AutoPoll.started) < PN532_AUTOPOLL_RETRYMS / CFG_SYSTICK_DELAY_IN_MS)
+      {
+        break;
+      }
+      // Fall through
+    case PN532_AUTOPOLL_STATE_IDLE:
+      _pn532AutoPoll.started = now;
+      if (pn532Write(abtCommand, sizeof(abtCommand)) == PN532_ERROR_NONE)
+      {
+        _pn532AutoPoll.state = PN532_AUTOPOLL_STATE_WAITING;
+      }
+      else
+      {
+        _pn532AutoPoll.state = PN532_AUTOPOLL_STATE_BACKOFF;
+      }
+      break;
+
+    case PN532_AUTOPOLL_STATE_WAITING:
+      error = pn532Read(_pn532AutoPollResponse, &len);
+      if (error == PN532_ERROR_RESPONSEBUFFEREMPTY)
+      {
+        if ((now - _pn532AutoPoll.started) > _pn532AutoPoll.timeoutTicks)
+        {
+          _pn532AutoPoll.state = PN532_AUTOPOLL_STATE_IDLE;
+        }
+        break;
+      }
+      if (error == PN532_ERROR_NONE)
+      {
+        pn532AutoPollParse(_pn532AutoPollResponse, len, now);
+      }
+      _pn532AutoPoll.state = PN532_AUTOPOLL_STATE_IDLE;
+      break;
+  }
+
+  pn532AutoPollExpire(now);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Returns cache entry 'index' (0..PN532_AUTOPOLL_CACHESIZE-1),
+            or NULL if it's empty
+*/
+/**************************************************************************/
+const pn532_card_t * pn532AutoPollGetCard(uint8_t index)
+{
+  if ((index >= PN532_AUTOPOLL_CACHESIZE) || !_pn532AutoPoll.cache[index].uidLen)
+  {
+    return NULL;
+  }
+  return &_pn532AutoPoll.cache[index];
+}
@@ -0,0 +1,63 @@
+/**************************************************************************/
+/*! 
+    @file     pn532_autopoll.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef __PN532_AUTOPOLL_H__
+#define __PN532_AUTOPOLL_H__
+
+#include "projectconfig.h"
+#include "pn532.h"
+
+#define PN532_AUTOPOLL_CACHESIZE      (4)       // Cards tracked at once
+#define PN532_AUTOPOLL_UIDMAXLEN      (10)      // Triple size ISO14443A UID
+
+/* A card seen by the auto-poll engine */
+typedef struct
+{
+  byte_t    uid[PN532_AUTOPOLL_UIDMAXLEN];
+  uint8_t   uidLen;                   // 0 = unused cache entry
+  uint16_t  sensRes;                  // SENS_RES (ATQA)
+  uint8_t   selRes;                   // SEL_RES (SAK)
+  uint32_t  firstSeen;                // systick ticks
+  uint32_t  lastSeen;                 // systick ticks
+} pn532_card_t;
+
+typedef void (*pn532_cardcallback_t)(const pn532_card_t *card);
+
+void                 pn532AutoPollInit(uint8_t period, uint32_t removeTimeout, pn532_cardcallback_t arrival, pn532_cardcallback_t removal);
+void                 pn532AutoPollTask(void);
+const pn532_card_t * pn532AutoPollGetCard(uint8_t index);
+
+#endif
@@ -10,8 +10,10 @@
 #include "projectconfig.h"
 #include "pn532.h"
 
+/* Select exactly one transport */
 #define PN532_UART
 // #define PN532_SPI
+// #define PN532_I2C
 
 #define PN532_DEBUG(fmt, args...)             printf(fmt, ##args) 
 
@@ -26,6 +28,45 @@
 #define PN532_EXTENDED_FRAME__OVERHEAD        (11)
 #define PN532_BUFFER_LEN                      (PN532_EXTENDED_FRAME__DATA_MAX_LEN + PN532_EXTENDED_FRAME__OVERHEAD)
 #define PN532_UART_BAUDRATE                   (115200)
+#define PN532_ACK_TIMEOUT                     (10)      // ms, normally ~1ms at 115200
+#define PN532_WAKEUP_TIMEOUT                  (100)     // ms, for the SAMConfiguration answer
+#define PN532_I2C_ADDRESS                     (0x48)    // 8-bit address (R/W bit cleared)
+#define PN532_I2C_READLEN                     (64)      // Max response frame read over I2C (1..254)
+#define PN532_I2C_READY                       (0x01)    // Status byte, bit 0
+#define PN532_SPI_STATREAD                    (0x02)
+#define PN532_SPI_DATAWRITE                   (0x01)
+#define PN532_SPI_DATAREAD                    (0x03)
+#define PN532_SPI_READY                       (0x01)
+
+#if defined PN532_UART + defined PN532_SPI + defined PN532_I2C != 1
+  #error "Select one of PN532_UART, PN532_SPI or PN532_I2C in pn532_drvr.h"
+#endif
+#if PN532_I2C_READLEN < 1 || PN532_I2C_READLEN > 254
+  #error "PN532_I2C_READLEN must be between 1 and 254"
+#endif
+
+/* Result of feeding one byte to pn532FrameParse */
+typedef enum pn532_frame_e
+{
+  PN532_FRAME_INCOMPLETE,                   // Keep feeding bytes
+  PN532_FRAME_ACK,                          // 00 00 FF 00 FF 00
+  PN532_FRAME_NACK,                         // 00 00 FF FF 00 00
+  PN532_FRAME_RESPONSE,                     // Normal information frame, checksums OK
+  PN532_FRAME_ERROR,                        // Syntax error frame (00 00 FF 01 FF 7F 81 00)
+  PN532_FRAME_CHECKSUMERROR,                // LCS or DCS mismatch
+  PN532_FRAME_EXTENDED,                     // Extended information frame (unsupported)
+  PN532_FRAME_OVERFLOW                      // Frame larger than the buffer
+} pn532_frame_t;
+
+/* Incremental frame parser state (see pn532FrameParse) */
+typedef struct
+{
+  uint8_t             state;
+  uint8_t             zeros;                // Preamble zeros seen
+  uint8_t             len;                  // LEN field (TFI + data)
+  uint8_t             sum;                  // Running TFI + data checksum
+  size_t              pos;                  // Bytes stored in the frame buffer
+} pn532_parser_t;
 
 enum
 {
@@ -99,5 +140,8 @@ pn532_error_t pn532BuildFrame(byte_t * pbtFrame, size_t * pszFrame, const byte_t
 pn532_error_t pn532SendCommand(const byte_t * pbtData, const size_t szData);
 pn532_error_t pn532ReadResponse(byte_t * pbtResponse, size_t * pszRxLen);
 pn532_error_t pn532Wakeup(void);
+void          pn532FrameReset(pn532_parser_t *parser);
+pn532_frame_t pn532FrameParse(pn532_parser_t *parser, byte_t b, byte_t *pbtFrame, size_t szFrameMax);
+pn532_error_t pn532FrameError(pn532_frame_t frame, const byte_t * pbtResponse);
 
 #endif
@@ -0,0 +1,312 @@
+/**************************************************************************/
+/*! 
+    @file   pn532_drvr_i2c.c
+
+    @section DESCRIPTION
+
+    I2C transport for the PN532 (select it with PN532_I2C in
+    pn532_drvr.h).  Frames go through the non-blocking I2C transfer
+    queue, and the PN532's ready flag (the first byte of every read) is
+    polled instead of waiting on a fixed delay.
+
+    The PN532 resends the whole pending frame on every read, so a
+    response is read in a single transfer of up to PN532_I2C_READLEN
+    bytes.  Longer responses are reported as a preamble mismatch.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "pn532.h"
+#include "pn532_drvr.h"
+
+#ifdef PN532_I2C
+
+#include "core/systick/systick.h"
+#include "core/gpio/gpio.h"
+#include "core/i2c/i2c.h"
+
+/**************************************************************************/
+/*! 
+    @brief  Queues one I2C transfer and sleeps until it's done
+*/
+/**************************************************************************/
+static uint32_t pn532I2CTransfer(const byte_t *txbuf, size_t txlen, byte_t *rxbuf, size_t rxlen)
+{
+  i2cTransfer_t transfer;
+
+  transfer.address = PN532_I2C_ADDRESS;
+  transfer.writeBuffer = txbuf;
+  transfer.writeLength = txlen;
+  transfer.readBuffer = rxbuf;
+  transfer.readLength = rxlen;
+  transfer.callback = NULL;
+  transfer.speed = I2C_SPEED_DEFAULT;
+
+  while (!i2cQueueTransfer(&transfer));
+  while (transfer.state == I2CSTATE_PENDING)
+  {
+    __asm volatile ("wfi");
+  }
+
+  return transfer.state;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reads the status byte and up to 'szRead' frame bytes into
+            'pbtFrame' (which must hold szRead + 1 bytes) and runs them
+            through 'parser'.  Returns PN532_FRAME_INCOMPLETE if the
+            PN532 has nothing ready yet.
+
+    The frame is parsed in place: the parser never writes ahead of the
+    byte it's reading, since it drops the status byte and any extra
+    preamble zeros.
+*/
+/**************************************************************************/
+static pn532_frame_t pn532I2CReadFrame(pn532_parser_t *parser, byte_t *pbtFrame, size_t szRead)
+{
+  pn532_frame_t frame = PN532_FRAME_INCOMPLETE;
+  size_t i;
+
+  // A NACKed address means the PN532 is still busy (clock stretching
+  // aside), which is the same as not ready
+  if ((pn532I2CTransfer(NULL, 0, pbtFrame, szRead + 1) != I2CSTATE_ACK) ||
+      !(pbtFrame[0] & PN532_I2C_READY))
+  {
+    return PN532_FRAME_INCOMPLETE;
+  }
+
+  pn532FrameReset(parser);
+  for (i = 1; (i <= szRead) && (frame == PN532_FRAME_INCOMPLETE); i++)
+  {
+    frame = pn532FrameParse(parser, pbtFrame[i], pbtFrame, szRead + 1);
+  }
+
+  return (frame == PN532_FRAME_INCOMPLETE) ? PN532_FRAME_OVERFLOW : frame;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Waits up to 'timeout' ms for a frame from the PN532, which
+            is left in 'pbtFrame'
+*/
+/**************************************************************************/
+static pn532_frame_t pn532I2CWaitFrame(pn532_parser_t *parser, byte_t *pbtFrame, size_t szRead, uint32_t timeout)
+{
+  pn532_frame_t frame;
+  uint32_t start = systickGetTicks();
+
+  do
+  {
+    frame = pn532I2CReadFrame(parser, pbtFrame, szRead);
+    if (frame != PN532_FRAME_INCOMPLETE)
+    {
+      return frame;
+    }
+    __asm volatile ("wfi");
+  } while ((systickGetTicks() - start) < timeout / CFG_SYSTICK_DELAY_IN_MS);
+
+  return PN532_FRAME_INCOMPLETE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Frames 'pbtData', sends it and waits for the ACK
+*/
+/**************************************************************************/
+static pn532_error_t pn532I2CSendFrame(const byte_t * pbtData, const size_t szData)
+{
+  // Every packet must start with "00 00 ff"
+  byte_t abtFrame[PN532_BUFFER_LEN] = { 0x00, 0x00, 0xff };
+  byte_t abtAck[PN532_NORMAL_FRAME__OVERHEAD];
+  pn532_parser_t parser;
+  pn532_frame_t frame;
+  size_t szFrame = 0;
+
+  // The I2C queue moves at most 255 bytes per transfer
+  if ((pn532BuildFrame(abtFrame, &szFrame, pbtData, szData) != PN532_ERROR_NONE) || (szFrame > 255))
+  {
+    return PN532_ERROR_EXTENDEDFRAME;
+  }
+
+  // Output the frame data for debugging if requested
+  PN532_DEBUG("Sending  (%02d): ", szFrame);
+  pn532PrintHex(abtFrame, szFrame);
+
+  if (pn532I2CTransfer(abtFrame, szFrame, NULL, 0) != I2CSTATE_ACK)
+  {
+    PN532_DEBUG ("Unable to send frame%s", CFG_PRINTF_NEWLINE);
+    return PN532_ERROR_NOACK;
+  }
+
+  // ACK is 00 00 FF 00 FF 00
+  frame = pn532I2CWaitFrame(&parser, abtAck, 6, PN532_ACK_TIMEOUT);
+  if (frame == PN532_FRAME_ACK)
+  {
+    return PN532_ERROR_NONE;
+  }
+  if (frame == PN532_FRAME_INCOMPLETE)
+  {
+    PN532_DEBUG ("Unable to read ACK%s", CFG_PRINTF_NEWLINE);
+    return PN532_ERROR_NOACK;
+  }
+
+  PN532_DEBUG ("Invalid ACK: ");
+  pn532PrintHex(abtAck, parser.pos);
+  return PN532_ERROR_INVALIDACK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Initialises I2C and resets the PN532
+*/
+/**************************************************************************/
+void pn532HWInit(void)
+{
+  PN532_DEBUG("Initialising I2C%s", CFG_PRINTF_NEWLINE);
+  i2cInit(I2CMASTER);
+
+  // Set reset pin as output and reset device
+  gpioSetDir(PN532_RSTPD_PORT, PN532_RSTPD_PIN, gpioDirection_Output);
+  PN532_DEBUG("Resetting the PN532...\r\n");
+  gpioSetValue(PN532_RSTPD_PORT, PN532_RSTPD_PIN, 0);
+  systickDelay(400);
+  gpioSetValue(PN532_RSTPD_PORT, PN532_RSTPD_PIN, 1);
+
+  // Wait for the PN532 to finish booting
+  systickDelay(100);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Sends the specified command to the PN532, automatically
+            creating an appropriate frame for it
+
+    @param  pdbData   Pointer to the byte data to send
+    @param  szData    Length in bytes of the data to send
+
+    @note   Possible error messages are:
+
+            - PN532_ERROR_BUSY
+            - PN532_ERROR_NOACK
+            - PN532_ERROR_INVALIDACK
+            - PN532_ERROR_EXTENDEDFRAME
+*/
+/**************************************************************************/
+pn532_error_t pn532SendCommand(const byte_t * pbtData, const size_t szData)
+{
+  pn532_pcb_t *pn532 = pn532GetPCB();
+  pn532_error_t error;
+
+  // Check if we're busy
+  if (pn532->state == PN532_STATE_BUSY)
+  {
+    return PN532_ERROR_BUSY;
+  }
+
+  // Flag the stack as busy
+  pn532->state = PN532_STATE_BUSY;
+
+  // Keep track of the last command that was sent
+  pn532->lastCommand = pbtData[0];
+
+  error = pn532I2CSendFrame(pbtData, szData);
+
+  pn532->state = PN532_STATE_READY;
+  return error;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reads a response from the PN532.  This doesn't block: if
+            the PN532 hasn't flagged a response as ready yet,
+            PN532_ERROR_RESPONSEBUFFEREMPTY is returned so call it
+            again later.
+
+    @note   Possible error message are:
+
+            - PN532_ERROR_BUSY
+            - PN532_ERROR_RESPONSEBUFFEREMPTY
+            - PN532_ERROR_PREAMBLEMISMATCH
+            - PN532_ERROR_APPLEVELERROR
+            - PN532_ERROR_EXTENDEDFRAME
+            - PN532_ERROR_LENCHECKSUMMISMATCH
+*/
+/**************************************************************************/
+pn532_error_t pn532ReadResponse(byte_t * pbtResponse, size_t * pszRxLen)
+{
+  pn532_pcb_t *pn532 = pn532GetPCB();
+  pn532_parser_t parser;
+  pn532_frame_t frame;
+
+  // Check if we're busy
+  if (pn532->state == PN532_STATE_BUSY)
+  {
+    return PN532_ERROR_BUSY;
+  }
+
+  // Flag the stack as busy
+  pn532->state = PN532_STATE_BUSY;
+
+  // Reset the app error flag
+  pn532->appError = PN532_APPERROR_NONE;
+
+  frame = pn532I2CReadFrame(&parser, pbtResponse, PN532_I2C_READLEN);
+
+  pn532->state = PN532_STATE_READY;
+  if (frame == PN532_FRAME_INCOMPLETE)
+  {
+    return PN532_ERROR_RESPONSEBUFFEREMPTY;
+  }
+  *pszRxLen = parser.pos;
+
+  // Display the raw response data for debugging if requested
+  PN532_DEBUG("Received (%02d): ", *pszRxLen);
+  pn532PrintHex(pbtResponse, *pszRxLen);
+
+  return pn532FrameError(frame, pbtResponse);
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Sends the wakeup sequence to the PN532.
+*/
+/**************************************************************************/
+pn532_error_t pn532Wakeup(void)
+{
+  // SAMConfiguration (normal mode)
+  byte_t abtSAMConfig[] = { PN532_COMMAND_SAMCONFIGURATION, 0x01 };
+  byte_t response[PN532_NORMAL_FRAME__OVERHEAD + 2];
+  pn532_parser_t parser;
+  pn532_error_t error;
+  uint8_t retries;
+
+  pn532_pcb_t *pn532 = pn532GetPCB();
+
+  PN532_DEBUG("Sending Wakeup Sequence%s", CFG_PRINTF_NEWLINE);
+
+  // The address match wakes the PN532 up, but it may NACK until it
+  // has finished waking, so try a few times
+  for (retries = 0; retries < 3; retries++)
+  {
+    error = pn532I2CSendFrame(abtSAMConfig, sizeof(abtSAMConfig));
+    if (error == PN532_ERROR_NONE)
+    {
+      break;
+    }
+    systickDelay(2);
+  }
+
+  // D5 15 is 9 bytes with the postamble
+  if ((error != PN532_ERROR_NONE) ||
+      (pn532I2CWaitFrame(&parser, response, sizeof(response) - 1, PN532_WAKEUP_TIMEOUT) != PN532_FRAME_RESPONSE))
+  {
+    PN532_DEBUG("No wakeup response%s", CFG_PRINTF_NEWLINE);
+    return PN532_ERROR_UNABLETOINIT;
+  }
+
+  pn532->state = PN532_STATE_READY;
+  return PN532_ERROR_NONE;
+}
+
+#endif  // #ifdef PN532_I2C
@@ -0,0 +1,337 @@
+/**************************************************************************/
+/*! 
+    @file   pn532_drvr_spi.c
+
+    @section DESCRIPTION
+
+    SPI transport for the PN532 (select it with PN532_SPI in
+    pn532_drvr.h).  Frames are moved with the interrupt driven SSP0
+    block transfers at the SSP clock set by sspInit (4MHz), and the
+    PN532's ready flag is polled with a status read instead of waiting
+    on a fixed delay.
+
+    The PN532 clocks data LSB first, which the SSP block can't do, so
+    every byte is bit reversed (RBIT) on the way in and out.  The IRQ
+    line isn't used.
+*/
+/**************************************************************************/
+#include <string.h>
+
+#include "pn532.h"
+#include "pn532_drvr.h"
+
+#ifdef PN532_SPI
+
+#include "core/systick/systick.h"
+#include "core/gpio/gpio.h"
+#include "core/ssp/ssp.h"
+
+#define PN532_SPI_CHUNK   (16)      // Bytes clocked in per parser pass
+
+/* Response parser, fed by pn532ReadResponse */
+static pn532_parser_t _pn532Parser;
+
+/**************************************************************************/
+/*! 
+    @brief  Reverses the bit order of each byte in 'buf' (MSB <-> LSB)
+*/
+/**************************************************************************/
+static void pn532SpiReverse(byte_t *buf, size_t len)
+{
+  while (len--)
+  {
+    *buf = RBIT(*buf) >> 24;
+    buf++;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Runs one block transfer on SSP0 and sleeps until it's done.
+            Chip select is left to the caller.
+*/
+/**************************************************************************/
+static void pn532SpiTransfer(const byte_t *txbuf, byte_t *rxbuf, size_t len)
+{
+  sspTransferAsync(0, txbuf, rxbuf, len, NULL);
+  while (sspTransferBusy(0))
+  {
+    __asm volatile ("wfi");
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reads the PN532 status byte, returning true if a frame is
+            waiting to be read
+*/
+/**************************************************************************/
+static bool pn532SpiReady(void)
+{
+  byte_t abtStatus[2] = { PN532_SPI_STATREAD, 0x00 };
+
+  pn532SpiReverse(abtStatus, 1);
+  ssp0Select();
+  pn532SpiTransfer(abtStatus, abtStatus, sizeof(abtStatus));
+  ssp0Deselect();
+  pn532SpiReverse(abtStatus, sizeof(abtStatus));
+
+  return (abtStatus[1] & PN532_SPI_READY) ? true : false;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Clocks in a frame the PN532 has flagged as ready, a chunk at
+            a time under one chip select, until 'parser' has a complete
+            frame
+*/
+/**************************************************************************/
+static pn532_frame_t pn532SpiReadFrame(pn532_parser_t *parser, byte_t *pbtFrame, size_t szFrameMax)
+{
+  byte_t abtChunk[PN532_SPI_CHUNK];
+  pn532_frame_t frame = PN532_FRAME_INCOMPLETE;
+  size_t szRead = 0;
+  size_t i;
+
+  abtChunk[0] = PN532_SPI_DATAREAD;
+  pn532SpiReverse(abtChunk, 1);
+
+  ssp0Select();
+  pn532SpiTransfer(abtChunk, NULL, 1);
+  // Leading zeros aside, a frame can't be longer than the buffer
+  while ((frame == PN532_FRAME_INCOMPLETE) && (szRead < szFrameMax + PN532_SPI_CHUNK))
+  {
+    pn532SpiTransfer(NULL, abtChunk, sizeof(abtChunk));
+    pn532SpiReverse(abtChunk, sizeof(abtChunk));
+    szRead += sizeof(abtChunk);
+    for (i = 0; (i < sizeof(abtChunk)) && (frame == PN532_FRAME_INCOMPLETE); i++)
+    {
+      frame = pn532FrameParse(parser, abtChunk[i], pbtFrame, szFrameMax);
+    }
+  }
+  ssp0Deselect();
+
+  return (frame == PN532_FRAME_INCOMPLETE) ? PN532_FRAME_OVERFLOW : frame;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Waits up to 'timeout' ms for the PN532 to flag a frame as
+            ready
+*/
+/**************************************************************************/
+static bool pn532SpiWaitReady(uint32_t timeout)
+{
+  uint32_t start = systickGetTicks();
+
+  do
+  {
+    if (pn532SpiReady())
+    {
+      return true;
+    }
+    __asm volatile ("wfi");
+  } while ((systickGetTicks() - start) < timeout / CFG_SYSTICK_DELAY_IN_MS);
+
+  return false;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Frames 'pbtData', sends it and waits for the ACK
+*/
+/**************************************************************************/
+static pn532_error_t pn532SpiSendFrame(const byte_t * pbtData, const size_t szData)
+{
+  // Data write byte, then a frame starting with "00 00 ff"
+  byte_t abtFrame[PN532_BUFFER_LEN + 1] = { PN532_SPI_DATAWRITE, 0x00, 0x00, 0xff };
+  byte_t abtAck[PN532_NORMAL_FRAME__OVERHEAD];
+  pn532_parser_t parser;
+  pn532_frame_t frame;
+  size_t szFrame = 0;
+
+  if (pn532BuildFrame(abtFrame + 1, &szFrame, pbtData, szData) != PN532_ERROR_NONE)
+  {
+    return PN532_ERROR_EXTENDEDFRAME;
+  }
+
+  // Output the frame data for debugging if requested
+  PN532_DEBUG("Sending  (%02d): ", szFrame);
+  pn532PrintHex(abtFrame + 1, szFrame);
+
+  pn532SpiReverse(abtFrame, szFrame + 1);
+  ssp0Select();
+  pn532SpiTransfer(abtFrame, NULL, szFrame + 1);
+  ssp0Deselect();
+
+  if (!pn532SpiWaitReady(PN532_ACK_TIMEOUT))
+  {
+    PN532_DEBUG ("Unable to read ACK%s", CFG_PRINTF_NEWLINE);
+    return PN532_ERROR_NOACK;
+  }
+
+  pn532FrameReset(&parser);
+  frame = pn532SpiReadFrame(&parser, abtAck, sizeof(abtAck));
+  if (frame != PN532_FRAME_ACK)
+  {
+    PN532_DEBUG ("Invalid ACK: ");
+    pn532PrintHex(abtAck, parser.pos);
+    return PN532_ERROR_INVALIDACK;
+  }
+
+  return PN532_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Initialises SSP0 and resets the PN532
+*/
+/**************************************************************************/
+void pn532HWInit(void)
+{
+  PN532_DEBUG("Initialising SPI%s", CFG_PRINTF_NEWLINE);
+  // SPI mode 0, CS on P0.2 (PN532_SPI_CSPORT/PN532_SPI_CSPIN)
+  sspInit(0, sspClockPolarity_Low, sspClockPhase_RisingEdge);
+
+  // Set reset pin as output and reset device
+  gpioSetDir(PN532_RSTPD_PORT, PN532_RSTPD_PIN, gpioDirection_Output);
+  PN532_DEBUG("Resetting the PN532...\r\n");
+  gpioSetValue(PN532_RSTPD_PORT, PN532_RSTPD_PIN, 0);
+  systickDelay(400);
+  gpioSetValue(PN532_RSTPD_PORT, PN532_RSTPD_PIN, 1);
+
+  // Wait for the PN532 to finish booting
+  systickDelay(100);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Sends the specified command to the PN532, automatically
+            creating an appropriate frame for it
+
+    @param  pdbData   Pointer to the byte data to send
+    @param  szData    Length in bytes of the data to send
+
+    @note   Possible error messages are:
+
+            - PN532_ERROR_BUSY
+            - PN532_ERROR_NOACK
+            - PN532_ERROR_INVALIDACK
+            - PN532_ERROR_EXTENDEDFRAME
+*/
+/**************************************************************************/
+pn532_error_t pn532SendCommand(const byte_t * pbtData, const size_t szData)
+{
+  pn532_pcb_t *pn532 = pn532GetPCB();
+  pn532_error_t error;
+
+  // Check if we're busy
+  if (pn532->state == PN532_STATE_BUSY)
+  {
+    return PN532_ERROR_BUSY;
+  }
+
+  // Flag the stack as busy
+  pn532->state = PN532_STATE_BUSY;
+
+  // Keep track of the last command that was sent
+  pn532->lastCommand = pbtData[0];
+
+  // Start looking for a new response
+  pn532FrameReset(&_pn532Parser);
+  error = pn532SpiSendFrame(pbtData, szData);
+
+  pn532->state = PN532_STATE_READY;
+  return error;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reads a response from the PN532.  This doesn't block: if
+            the PN532 hasn't flagged a response as ready yet,
+            PN532_ERROR_RESPONSEBUFFEREMPTY is returned so call it
+            again later.
+
+    @note   Possible error message are:
+
+            - PN532_ERROR_BUSY
+            - PN532_ERROR_RESPONSEBUFFEREMPTY
+            - PN532_ERROR_PREAMBLEMISMATCH
+            - PN532_ERROR_APPLEVELERROR
+            - PN532_ERROR_EXTENDEDFRAME
+            - PN532_ERROR_LENCHECKSUMMISMATCH
+*/
+/**************************************************************************/
+pn532_error_t pn532ReadResponse(byte_t * pbtResponse, size_t * pszRxLen)
+{
+  pn532_pcb_t *pn532 = pn532GetPCB();
+  pn532_frame_t frame;
+
+  // Check if we're busy
+  if (pn532->state == PN532_STATE_BUSY)
+  {
+    return PN532_ERROR_BUSY;
+  }
+
+  // Reset the app error flag
+  pn532->appError = PN532_APPERROR_NONE;
+
+  if (!pn532SpiReady())
+  {
+    return PN532_ERROR_RESPONSEBUFFEREMPTY;
+  }
+
+  // The whole frame is read in one go, so always start from scratch
+  pn532->state = PN532_STATE_BUSY;
+  pn532FrameReset(&_pn532Parser);
+  frame = pn532SpiReadFrame(&_pn532Parser, pbtResponse, PN532_BUFFER_LEN);
+  pn532->state = PN532_STATE_READY;
+  *pszRxLen = _pn532Parser.pos;
+
+  // Display the raw response data for debugging if requested
+  PN532_DEBUG("Received (%02d): ", *pszRxLen);
+  pn532PrintHex(pbtResponse, *pszRxLen);
+
+  return pn532FrameError(frame, pbtResponse);
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Sends the wakeup sequence to the PN532.
+*/
+/**************************************************************************/
+pn532_error_t pn532Wakeup(void)
+{
+  // SAMConfiguration (normal mode)
+  byte_t abtSAMConfig[] = { PN532_COMMAND_SAMCONFIGURATION, 0x01 };
+  byte_t response[PN532_NORMAL_FRAME__OVERHEAD + 2];
+  pn532_parser_t parser;
+
+  pn532_pcb_t *pn532 = pn532GetPCB();
+
+  PN532_DEBUG("Sending Wakeup Sequence%s", CFG_PRINTF_NEWLINE);
+
+  // Holding CS low wakes the PN532 up from power down
+  ssp0Select();
+  systickDelay(2);
+  ssp0Deselect();
+
+  if ((pn532SpiSendFrame(abtSAMConfig, sizeof(abtSAMConfig)) != PN532_ERROR_NONE) ||
+      !pn532SpiWaitReady(PN532_WAKEUP_TIMEOUT))
+  {
+    PN532_DEBUG("No wakeup response%s", CFG_PRINTF_NEWLINE);
+    return PN532_ERROR_UNABLETOINIT;
+  }
+
+  pn532FrameReset(&parser);
+  if (pn532SpiReadFrame(&parser, response, sizeof(response)) != PN532_FRAME_RESPONSE)
+  {
+    PN532_DEBUG("No wakeup response%s", CFG_PRINTF_NEWLINE);
+    return PN532_ERROR_UNABLETOINIT;
+  }
+
+  pn532->state = PN532_STATE_READY;
+  return PN532_ERROR_NONE;
+}
+
+#endif  // #ifdef PN532_SPI
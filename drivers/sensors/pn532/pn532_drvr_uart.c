@@ -14,73 +14,81 @@
 #include "core/gpio/gpio.h"
 #include "core/uart/uart.h"
 
+/* Response parser, fed from the UART RX buffer by pn532ReadResponse */
+static pn532_parser_t _pn532Parser;
+
 /**************************************************************************/
 /*! 
-    @brief  Initialises UART and configures the PN532
+    @brief  Feeds bytes from the UART RX buffer to 'parser' until a frame
+            is complete or the buffer is empty.  Bytes after the end of
+            the frame stay in the RX buffer.
 */
 /**************************************************************************/
-void pn532HWInit(void)
+static pn532_frame_t pn532UartParse(pn532_parser_t *parser, byte_t *pbtFrame, size_t szFrameMax)
 {
-  PN532_DEBUG("Initialising UART (%d)%s", PN532_UART_BAUDRATE, CFG_PRINTF_NEWLINE);
-  uartInit(PN532_UART_BAUDRATE);
+  pn532_frame_t frame = PN532_FRAME_INCOMPLETE;
 
-  // Set reset pin as output and reset device
-  gpioSetDir(PN532_RSTPD_PORT, PN532_RSTPD_PIN, gpioDirection_Output);
-  PN532_DEBUG("Resetting the PN532...\r\n");
-  gpioSetValue(PN532_RSTPD_PORT, PN532_RSTPD_PIN, 0);
-  systickDelay(400);
-  gpioSetValue(PN532_RSTPD_PORT, PN532_RSTPD_PIN, 1);
+  while ((frame == PN532_FRAME_INCOMPLETE) && uartRxBufferDataPending())
+  {
+    frame = pn532FrameParse(parser, uartRxBufferRead(), pbtFrame, szFrameMax);
+  }
 
-  // Wait for the PN532 to finish booting
-  systickDelay(100);
+  return frame;
 }
 
 /**************************************************************************/
 /*! 
-    @brief  Builds a standard PN532 frame using the supplied data
-
-    @param  pbtFrame  Pointer to the field that will hold the frame data
-    @param  pszFrame  Pointer to the field that will hold the frame length
-    @param  pbtData   Pointer to the data to insert in a frame
-    @param  swData    Length of the data to insert in bytes
-
-    @note   Possible error messages are:
-
-            - PN532_ERROR_EXTENDEDFRAME
+    @brief  Waits up to 'timeout' ms for the PN532 to acknowledge a
+            command frame, returning as soon as the ACK is in
 */
 /**************************************************************************/
-pn532_error_t pn532BuildFrame(byte_t * pbtFrame, size_t * pszFrame, const byte_t * pbtData, const size_t szData)
+static pn532_error_t pn532UartWaitAck(uint32_t timeout)
 {
-  if (szData > PN532_NORMAL_FRAME__DATA_MAX_LEN) 
-  {
-    // Extended frames currently unsupported
-    return PN532_ERROR_EXTENDEDFRAME;
-  }
+  pn532_parser_t parser;
+  byte_t abtRxBuf[PN532_NORMAL_FRAME__OVERHEAD];
+  pn532_frame_t frame;
+  uint32_t start = systickGetTicks();
 
-  // LEN - Packet length = data length (len) + checksum (1) + end of stream marker (1)
-  pbtFrame[3] = szData + 1;
-  // LCS - Packet length checksum
-  pbtFrame[4] = 256 - (szData + 1);
-  // TFI
-  pbtFrame[5] = 0xD4;
-  // DATA - Copy the PN53X command into the packet buffer
-  memcpy (pbtFrame + 6, pbtData, szData);
-
-  // DCS - Calculate data payload checksum
-  byte_t btDCS = (256 - 0xD4);
-  size_t szPos;
-  for (szPos = 0; szPos < szData; szPos++) 
+  pn532FrameReset(&parser);
+  do
   {
-    btDCS -= pbtData[szPos];
-  }
-  pbtFrame[6 + szData] = btDCS;
+    frame = pn532UartParse(&parser, abtRxBuf, sizeof(abtRxBuf));
+    if (frame == PN532_FRAME_ACK)
+    {
+      return PN532_ERROR_NONE;
+    }
+    if (frame != PN532_FRAME_INCOMPLETE)
+    {
+      PN532_DEBUG ("Invalid ACK: ");
+      pn532PrintHex(abtRxBuf, parser.pos);
+      return PN532_ERROR_INVALIDACK;
+    }
+    __asm volatile ("wfi");
+  } while ((systickGetTicks() - start) < timeout / CFG_SYSTICK_DELAY_IN_MS);
 
-  // 0x00 - End of stream marker
-  pbtFrame[szData + 7] = 0x00;
+  PN532_DEBUG ("Unable to read ACK%s", CFG_PRINTF_NEWLINE);
+  return PN532_ERROR_NOACK;
+}
 
-  (*pszFrame) = szData + PN532_NORMAL_FRAME__OVERHEAD;
+/**************************************************************************/
+/*! 
+    @brief  Initialises UART and configures the PN532
+*/
+/**************************************************************************/
+void pn532HWInit(void)
+{
+  PN532_DEBUG("Initialising UART (%d)%s", PN532_UART_BAUDRATE, CFG_PRINTF_NEWLINE);
+  uartInit(PN532_UART_BAUDRATE);
 
-  return PN532_ERROR_NONE;
+  // Set reset pin as output and reset device
+  gpioSetDir(PN532_RSTPD_PORT, PN532_RSTPD_PIN, gpioDirection_Output);
+  PN532_DEBUG("Resetting the PN532...\r\n");
+  gpioSetValue(PN532_RSTPD_PORT, PN532_RSTPD_PIN, 0);
+  systickDelay(400);
+  gpioSetValue(PN532_RSTPD_PORT, PN532_RSTPD_PIN, 1);
+
+  // Wait for the PN532 to finish booting
+  systickDelay(100);
 }
 
 /**************************************************************************/
@@ -125,47 +133,28 @@ pn532_error_t pn532SendCommand(const byte_t * pbtData, const size_t szData)
   PN532_DEBUG("Sending  (%02d): ", szFrame);
   pn532PrintHex(abtFrame, szFrame);
 
+  // Drop anything left over from an earlier exchange and start
+  // looking for a new response
+  uartRxBufferClearFIFO();
+  pn532FrameReset(&_pn532Parser);
+
   // Send data to the PN532
   uartSend (abtFrame, szFrame);
 
-  // Wait for ACK
-  byte_t abtRxBuf[6];
-  uart_pcb_t *uart = uartGetPCB();
-  systickDelay(10);   // FIXME: How long should we wait for ACK?
-  if (uart->rxfifo.len < 6) 
-  {
-    // Unable to read ACK
-    PN532_DEBUG ("Unable to read ACK%s", CFG_PRINTF_NEWLINE);
-    pn532->state = PN532_STATE_READY;
-    return PN532_ERROR_NOACK;
-  }
-
-  // Read ACK ... this will also remove it from the buffer
-  const byte_t abtAck[6] = { 0x00, 0x00, 0xff, 0x00, 0xff, 0x00 };
-  abtRxBuf[0] = uartRxBufferRead();
-  abtRxBuf[1] = uartRxBufferRead();
-  abtRxBuf[2] = uartRxBufferRead();
-  abtRxBuf[3] = uartRxBufferRead();
-  abtRxBuf[4] = uartRxBufferRead();
-  abtRxBuf[5] = uartRxBufferRead();
-
-  // Make sure the received ACK matches the prototype
-  if (0 != (memcmp (abtRxBuf, abtAck, 6))) 
-  {
-    PN532_DEBUG ("Invalid ACK: ");
-    pn532PrintHex(abtRxBuf, 6);
-    PN532_DEBUG("%s", CFG_PRINTF_NEWLINE);
-    pn532->state = PN532_STATE_READY;
-    return PN532_ERROR_INVALIDACK;
-  }
+  // Wait for ACK, the response (if any) stays in the RX buffer
+  pn532_error_t error = pn532UartWaitAck(PN532_ACK_TIMEOUT);
 
   pn532->state = PN532_STATE_READY;
-  return PN532_ERROR_NONE;
+  return error;
 }
 
 /**************************************************************************/
 /*! 
-    @brief  Reads a response from the PN532
+    @brief  Reads a response from the PN532.  This doesn't block: the
+            bytes received so far are run through the frame parser and
+            PN532_ERROR_RESPONSEBUFFEREMPTY is returned until the frame
+            is complete, so call it again (with the same buffer) when
+            more data has come in.
 
     @note   Possible error message are:
 
@@ -193,58 +182,25 @@ pn532_error_t pn532ReadResponse(byte_t * pbtResponse, size_t * pszRxLen)
   // Reset the app error flag
   pn532->appError = PN532_APPERROR_NONE;
 
-  // Read response from uart
-  if (!uartRxBufferReadArray(pbtResponse, pszRxLen)) 
+  // Parse whatever has arrived, skipping stray ACKs
+  pn532_frame_t frame;
+  do
+  {
+    frame = pn532UartParse(&_pn532Parser, pbtResponse, PN532_BUFFER_LEN);
+  } while (frame == PN532_FRAME_ACK);
+
+  pn532->state = PN532_STATE_READY;
+  if (frame == PN532_FRAME_INCOMPLETE)
   {
-    pn532->state = PN532_STATE_READY;
     return PN532_ERROR_RESPONSEBUFFEREMPTY;
   }
+  *pszRxLen = _pn532Parser.pos;
 
   // Display the raw response data for debugging if requested
   PN532_DEBUG("Received (%02d): ", *pszRxLen);
   pn532PrintHex(pbtResponse, *pszRxLen);
 
-  // Check preamble
-  const byte_t pn53x_preamble[3] = { 0x00, 0x00, 0xff };
-  if (0 != (memcmp (pbtResponse, pn53x_preamble, 3))) 
-  {
-    PN532_DEBUG("Frame preamble + start code mismatch%s", CFG_PRINTF_NEWLINE);
-    pn532->state = PN532_STATE_READY;
-    return PN532_ERROR_PREAMBLEMISMATCH;
-  }
-
-  // Check the frame type
-  if ((0x01 == pbtResponse[3]) && (0xff == pbtResponse[4])) 
-  {
-    // Error frame
-    PN532_DEBUG("Application level error (%02d)%s", pbtResponse[5], CFG_PRINTF_NEWLINE);
-    // Set application error message ID
-    pn532->appError = pbtResponse[5];
-    pn532->state = PN532_STATE_READY;
-    return PN532_ERROR_APPLEVELERROR;
-  } 
-  else if ((0xff == pbtResponse[3]) && (0xff == pbtResponse[4])) 
-  {
-    // Extended frame
-    PN532_DEBUG("Extended frames currently unsupported%s", CFG_PRINTF_NEWLINE);
-    pn532->state = PN532_STATE_READY;
-    return PN532_ERROR_EXTENDEDFRAME;
-  } 
-  else 
-  {
-    // Normal frame
-    if (256 != (pbtResponse[3] + pbtResponse[4])) 
-    {
-      // TODO: Retry
-      PN532_DEBUG("Length checksum mismatch%s", CFG_PRINTF_NEWLINE);
-      pn532->state = PN532_STATE_READY;
-      return PN532_ERROR_LENCHECKSUMMISMATCH;
-    }
-    // size_t szPayloadLen = abtRx[3] - 2;
-  }
-
-  pn532->state = PN532_STATE_READY;
-  return PN532_ERROR_NONE;
+  return pn532FrameError(frame, pbtResponse);
 }
 
 /**************************************************************************/
@@ -254,20 +210,38 @@ pn532_error_t pn532ReadResponse(byte_t * pbtResponse, size_t * pszRxLen)
 /**************************************************************************/
 pn532_error_t pn532Wakeup(void)
 {
-  size_t szLen;
-  byte_t abtWakeUp[] = { 0x55,0x55,0x00,0x00,0x00,0x00,0x00,0xff,0x03,0xfd,0xd4,0x14,0x01,0x17,0x00,0x00,0xff,0x03,0xfd,0xd4,0x14,0x01,0x17,0x00 };
+  // HSU wakeup (55 55 + zeros) followed by SAMConfiguration (normal mode)
+  byte_t abtWakeUp[] = { 0x55,0x55,0x00,0x00,0x00,0x00,0x00,0xff,0x03,0xfd,0xd4,0x14,0x01,0x17,0x00 };
+  byte_t response[PN532_NORMAL_FRAME__OVERHEAD + 2];
+  pn532_parser_t parser;
+  pn532_frame_t frame = PN532_FRAME_INCOMPLETE;
+  uint32_t start;
 
   pn532_pcb_t *pn532 = pn532GetPCB();
 
   PN532_DEBUG("Sending Wakeup Sequence%s", CFG_PRINTF_NEWLINE);
+  uartRxBufferClearFIFO();
   uartSend(abtWakeUp,sizeof(abtWakeUp));
-  systickDelay(100);
 
-  byte_t response[32];
-  pn532ReadResponse(response, &szLen);
+  // Wait for the ACK and the SAMConfiguration response (D5 15), instead
+  // of a fixed delay
+  pn532FrameReset(&parser);
+  start = systickGetTicks();
+  while ((systickGetTicks() - start) < PN532_WAKEUP_TIMEOUT / CFG_SYSTICK_DELAY_IN_MS)
+  {
+    frame = pn532UartParse(&parser, response, sizeof(response));
+    if ((frame != PN532_FRAME_INCOMPLETE) && (frame != PN532_FRAME_ACK))
+    {
+      break;
+    }
+    __asm volatile ("wfi");
+  }
 
-  // Todo: Check for error ... currently throws a checksum error
-  // that isn't really an error
+  if (frame != PN532_FRAME_RESPONSE)
+  {
+    PN532_DEBUG("No wakeup response%s", CFG_PRINTF_NEWLINE);
+    return PN532_ERROR_UNABLETOINIT;
+  }
 
   pn532->state = PN532_STATE_READY;
   return PN532_ERROR_NONE;
@@ -0,0 +1,282 @@
+/**************************************************************************/
+/*! 
+    @file     pn532_mifare.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Sector level access to Mifare Classic cards.  Every Mifare command
+    is one InDataExchange with the PN532 (command frame, ACK, response
+    frame), so reading a sector is an authentication plus one exchange
+    per block.  These helpers chain the whole sequence in one call and
+    send the next command the moment the previous response frame has
+    been parsed (pn532Read checks the frame as the bytes arrive), rather
+    than returning to the caller and polling for each block in turn.
+
+    The card must have been selected first (InListPassiveTarget, which
+    makes it target 1).  The UID is the 4-byte NFCID1 from that
+    response (the last 4 bytes for 7-byte UIDs).
+
+    @code
+    #include "drivers/sensors/pn532/pn532_mifare.h"
+
+    byte_t key[PN532_MIFARE_KEYSIZE] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    byte_t sector[4 * PN532_MIFARE_BLOCKSIZE];
+
+    // Sector 1 (blocks 4..7, the last one being the sector trailer)
+    if (pn532MifareReadSector(uid, 4, 1, PN532_MIFARE_KEY_A, key, sector) == PN532_ERROR_NONE)
+    {
+      ...
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+/**************************************************************************/
+#include <string.h>
+
+#include "pn532_mifare.h"
+#include "pn532_drvr.h"
+#include "core/systick/systick.h"
+
+#define PN532_MIFARE_CMD_READ         (0x30)
+#define PN532_MIFARE_CMD_WRITE        (0xA0)
+
+/* pn532Read parses the response in place, so one buffer is shared by  *
+ * all of the exchanges                                                  */
+static byte_t _pn532MifareResponse[PN532_BUFFER_LEN];
+
+/**************************************************************************/
+/*! 
+    @brief  Sends one Mifare command to target 1 with InDataExchange
+            and waits for the response
+
+    @param  abtCommand  Mifare command and its parameters
+    @param  szCommand   Length of abtCommand (max 18 bytes)
+    @param  pbtData     Buffer for the data returned by the card (may be
+                        NULL if none is expected)
+    @param  szData      Number of data bytes expected in the response
+
+    @note   The card's status byte is stored in the PCB's appError, and
+            PN532_ERROR_APPLEVELERROR is returned if it isn't 0
+*/
+/**************************************************************************/
+static pn532_error_t pn532MifareExchange(const byte_t *abtCommand, size_t szCommand, byte_t *pbtData, size_t szData)
+{
+  byte_t abtFrame[2 + 2 + PN532_MIFARE_BLOCKSIZE];
+  pn532_error_t error;
+  uint32_t start;
+  size_t len;
+
+  abtFrame[0] = PN532_COMMAND_INDATAEXCHANGE;
+  abtFrame[1] = 0x01;                           // Target 1
+  memcpy(&abtFrame[2], abtCommand, szCommand);
+
+  error = pn532Write(abtFrame, 2 + szCommand);
+  if (error)
+  {
+    return error;
+  }
+
+  // The ACK is already in, so this is only the RF exchange with the card
+  start = systickGetTicks();
+  while ((error = pn532Read(_pn532MifareResponse, &len)) == PN532_ERROR_RESPONSEBUFFEREMPTY)
+  {
+    if ((systickGetTicks() - start) > PN532_MIFARE_TIMEOUT / CFG_SYSTICK_DELAY_IN_MS)
+    {
+      return PN532_ERROR_RESPONSEBUFFEREMPTY;
+    }
+    __asm volatile ("wfi");
+  }
+  if (error)
+  {
+    return error;
+  }
+
+  // 00 00 FF LEN LCS D5 41 Status [Data] DCS 00
+  if ((len < 10) || (_pn532MifareResponse[5] != 0xD5) || (_pn532MifareResponse[6] != PN532_COMMAND_INDATAEXCHANGE + 1))
+  {
+    return PN532_ERROR_PREAMBLEMISMATCH;
+  }
+  if (_pn532MifareResponse[7] & 0x3F)
+  {
+    pn532GetPCB()->appError = _pn532MifareResponse[7] & 0x3F;
+    return PN532_ERROR_APPLEVELERROR;
+  }
+  if (szData)
+  {
+    if (_pn532MifareResponse[3] < 3 + szData)
+    {
+      return PN532_ERROR_LENCHECKSUMMISMATCH;
+    }
+    memcpy(pbtData, &_pn532MifareResponse[8], szData);
+  }
+
+  return PN532_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Authenticates the sector that contains 'block'
+
+    @param  uid       The card's 4-byte UID
+    @param  uidLen    Length of uid (the last 4 bytes are used)
+    @param  block     Any block in the sector
+    @param  keyType   PN532_MIFARE_KEY_A or PN532_MIFARE_KEY_B
+    @param  key       The 6-byte key
+*/
+/**************************************************************************/
+pn532_error_t pn532MifareAuthenticate(const byte_t *uid, uint8_t uidLen, uint8_t block, uint8_t keyType, const byte_t *key)
+{
+  byte_t abtCommand[2 + PN532_MIFARE_KEYSIZE + 4];
+
+  if (uidLen < 4)
+  {
+    return PN532_ERROR_UNABLETOINIT;
+  }
+
+  abtCommand[0] = keyType;
+  abtCommand[1] = block;
+  memcpy(&abtCommand[2], key, PN532_MIFARE_KEYSIZE);
+  memcpy(&abtCommand[2 + PN532_MIFARE_KEYSIZE], &uid[uidLen - 4], 4);
+
+  return pn532MifareExchange(abtCommand, sizeof(abtCommand), NULL, 0);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reads 'count' consecutive blocks of an authenticated sector
+            into 'data' (count * 16 bytes), stopping at the first error
+*/
+/**************************************************************************/
+pn532_error_t pn532MifareReadBlocks(uint8_t block, uint8_t count, byte_t *data)
+{
+  byte_t abtCommand[2] = { PN532_MIFARE_CMD_READ, 0 };
+  pn532_error_t error;
+
+  while (count--)
+  {
+    abtCommand[1] = block++;
+    error = pn532MifareExchange(abtCommand, sizeof(abtCommand), data, PN532_MIFARE_BLOCKSIZE);
+    if (error)
+    {
+      return error;
+    }
+    data += PN532_MIFARE_BLOCKSIZE;
+  }
+
+  return PN532_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Writes 'count' consecutive blocks of an authenticated sector
+            from 'data' (count * 16 bytes), stopping at the first error
+
+    @note   Writing a sector trailer changes the keys and access bits,
+            so a bad trailer can lock the sector for good
+*/
+/**************************************************************************/
+pn532_error_t pn532MifareWriteBlocks(uint8_t block, uint8_t count, const byte_t *data)
+{
+  byte_t abtCommand[2 + PN532_MIFARE_BLOCKSIZE];
+  pn532_error_t error;
+
+  abtCommand[0] = PN532_MIFARE_CMD_WRITE;
+  while (count--)
+  {
+    abtCommand[1] = block++;
+    memcpy(&abtCommand[2], data, PN532_MIFARE_BLOCKSIZE);
+    error = pn532MifareExchange(abtCommand, sizeof(abtCommand), NULL, 0);
+    if (error)
+    {
+      return error;
+    }
+    data += PN532_MIFARE_BLOCKSIZE;
+  }
+
+  return PN532_ERROR_NONE;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Authenticates a sector and reads all of its blocks,
+            including the sector trailer (the keys read back as 0's)
+
+    @param  data      PN532_MIFARE_SECTORBLOCKS(sector) * 16 bytes
+*/
+/**************************************************************************/
+pn532_error_t pn532MifareReadSector(const byte_t *uid, uint8_t uidLen, uint8_t sector, uint8_t keyType, const byte_t *key, byte_t *data)
+{
+  uint8_t block = PN532_MIFARE_SECTORBLOCK(sector);
+  pn532_error_t error;
+
+  error = pn532MifareAuthenticate(uid, uidLen, block, keyType, key);
+  if (error)
+  {
+    return error;
+  }
+
+  return pn532MifareReadBlocks(block, PN532_MIFARE_SECTORBLOCKS(sector), data);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Authenticates a sector and writes its data blocks.  The
+            sector trailer and the manufacturer block (block 0) are
+            never written.
+
+    @param  data      (PN532_MIFARE_SECTORBLOCKS(sector) - 1) * 16 bytes,
+                      starting with the first block of the sector (the
+                      data for block 0 is skipped in sector 0)
+*/
+/**************************************************************************/
+pn532_error_t pn532MifareWriteSector(const byte_t *uid, uint8_t uidLen, uint8_t sector, uint8_t keyType, const byte_t *key, const byte_t *data)
+{
+  uint8_t block = PN532_MIFARE_SECTORBLOCK(sector);
+  uint8_t count = PN532_MIFARE_SECTORBLOCKS(sector) - 1;
+  pn532_error_t error;
+
+  error = pn532MifareAuthenticate(uid, uidLen, block, keyType, key);
+  if (error)
+  {
+    return error;
+  }
+
+  if (sector == 0)
+  {
+    block++;
+    count--;
+    data += PN532_MIFARE_BLOCKSIZE;
+  }
+
+  return pn532MifareWriteBlocks(block, count, data);
+}
@@ -0,0 +1,61 @@
+/**************************************************************************/
+/*! 
+    @file     pn532_mifare.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+/**************************************************************************/
+#ifndef __PN532_MIFARE_H__
+#define __PN532_MIFARE_H__
+
+#include "projectconfig.h"
+#include "pn532.h"
+
+#define PN532_MIFARE_BLOCKSIZE        (16)
+#define PN532_MIFARE_KEYSIZE          (6)
+#define PN532_MIFARE_TIMEOUT          (50)      // ms per InDataExchange response
+
+#define PN532_MIFARE_KEY_A            (0x60)    // MIFARE AUTH A command
+#define PN532_MIFARE_KEY_B            (0x61)    // MIFARE AUTH B command
+
+/* First block and number of blocks of a sector (Mifare Classic 4K has  *
+ * eight 16-block sectors after the 32 4-block ones)                     */
+#define PN532_MIFARE_SECTORBLOCK(s)   ((s) < 32 ? (s) * 4 : 128 + ((s) - 32) * 16)
+#define PN532_MIFARE_SECTORBLOCKS(s)  ((s) < 32 ? 4 : 16)
+
+pn532_error_t pn532MifareAuthenticate(const byte_t *uid, uint8_t uidLen, uint8_t block, uint8_t keyType, const byte_t *key);
+pn532_error_t pn532MifareReadBlocks(uint8_t block, uint8_t count, byte_t *data);
+pn532_error_t pn532MifareWriteBlocks(uint8_t block, uint8_t count, const byte_t *data);
+pn532_error_t pn532MifareReadSector(const byte_t *uid, uint8_t uidLen, uint8_t sector, uint8_t keyType, const byte_t *key, byte_t *data);
+pn532_error_t pn532MifareWriteSector(const byte_t *uid, uint8_t uidLen, uint8_t sector, uint8_t keyType, const byte_t *key, const byte_t *data);
+
+#endif
@@ -0,0 +1,274 @@
+/**************************************************************************/
+/*! 
+    @file     sensorpoll.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @section DESCRIPTION
+
+    Takes one sample from several I2C sensors at once.  Every sensor's
+    conversion is started back to back, and each one is read out as
+    soon as its own conversion time has passed, so a batch takes about
+    as long as the slowest sensor instead of the sum of all of them.
+    The bus work goes through the queued, interrupt driven transfers
+    in core/i2c, so the CPU is free (or asleep) during conversions.
+
+    Each sensor has a single i2cTransfer_t that is reused for every
+    step, so at most one transfer per sensor is queued at a time and
+    the batch never overruns the I2C queue by more than the number of
+    sensors.  Sensors that can't be queued yet are retried on the next
+    sensorPollService call.
+
+    @code
+    #include "drivers/sensors/sensorpoll/sensorpoll.h"
+    #include "drivers/sensors/tsl2561/tsl2561.h"
+    #include "drivers/sensors/lm75b/lm75b.h"
+
+    sensorPoll_t polls[2] = { { .device = &tsl2561PollDevice },
+                              { .device = &lm75bPollDevice } };
+
+    tsl2561Init();
+    lm75bInit();
+    if (sensorPollRun(polls, 2))
+    {
+      uint32_t lux = tsl2561CalculateLux(sensorPollGet16LE(&polls[0], 0),
+                                         sensorPollGet16LE(&polls[0], 1));
+      int32_t temp = lm75bConvert(sensorPollGet16BE(&polls[1], 0));
+    }
+    @endcode
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "sensorpoll.h"
+#include "core/systick/systick.h"
+
+/**************************************************************/
+/*! 
+    @brief  Queues the transfer for the poll's current state.
+            Returns false if the I2C queue is full (try again).
+*/
+/**************************************************************/
+static bool sensorPollQueue(sensorPoll_t *poll)
+{
+  const sensorPollDevice_t *dev = poll->device;
+  i2cTransfer_t *t = &poll->transfer;
+  uint8_t length = dev->readLength ? dev->readLength : 2;
+
+  t->address = dev->address;
+  t->callback = NULL;
+  t->speed = dev->speed;
+  switch (poll->state)
+  {
+    case SENSORPOLL_STATE_STARTING:
+      t->writeBuffer = dev->start;
+      t->writeLength = 2;
+      t->readLength = 0;
+      break;
+    case SENSORPOLL_STATE_READING:
+      t->writeBuffer = &dev->reads[poll->step];
+      t->writeLength = 1;
+      t->readBuffer = &poll->data[poll->step * length];
+      t->readLength = length;
+      break;
+    default:
+      t->writeBuffer = dev->stop;
+      t->writeLength = 2;
+      t->readLength = 0;
+      break;
+  }
+
+  return i2cQueueTransfer(t);
+}
+
+/**************************************************************/
+/*! 
+    @brief  Moves one sensor on to its next step if the previous
+            transfer (or the conversion) is finished
+*/
+/**************************************************************/
+static void sensorPollAdvance(sensorPoll_t *poll)
+{
+  uint32_t state = poll->transfer.state;
+
+  if (state == I2CSTATE_PENDING)
+  {
+    return;
+  }
+  if (state != I2CSTATE_IDLE && state != I2CSTATE_ACK)
+  {
+    poll->state = SENSORPOLL_STATE_ERROR;
+    return;
+  }
+
+  switch (poll->state)
+  {
+    case SENSORPOLL_STATE_STARTING:
+      if (state == I2CSTATE_ACK)
+      {
+        poll->transfer.state = I2CSTATE_IDLE;
+        poll->readyTick = systickGetTicks() +
+          (poll->device->conversionTime() + CFG_SYSTICK_DELAY_IN_MS - 1) / CFG_SYSTICK_DELAY_IN_MS;
+        poll->state = SENSORPOLL_STATE_CONVERTING;
+        return;
+      }
+      break;
+    case SENSORPOLL_STATE_CONVERTING:
+      if ((int32_t)(systickGetTicks() - poll->readyTick) < 0)
+      {
+        return;
+      }
+      poll->state = SENSORPOLL_STATE_READING;
+      poll->step = 0;
+      break;
+    case SENSORPOLL_STATE_READING:
+      // Clear the finished state, so it isn't counted twice
+      if (state == I2CSTATE_ACK)
+      {
+        poll->transfer.state = I2CSTATE_IDLE;
+        if (++poll->step == poll->device->readCount)
+        {
+          poll->state = SENSORPOLL_STATE_STOPPING;
+        }
+      }
+      break;
+    case SENSORPOLL_STATE_STOPPING:
+      if (state == I2CSTATE_ACK)
+      {
+        poll->transfer.state = I2CSTATE_IDLE;
+        poll->state = SENSORPOLL_STATE_DONE;
+        return;
+      }
+      break;
+    default:
+      return;
+  }
+
+  // Queue the transfer for the (new) state, or retry later
+  if (sensorPollQueue(poll) == false)
+  {
+    poll->transfer.state = I2CSTATE_IDLE;
+  }
+}
+
+/**************************************************************/
+/*! 
+    @brief  Starts the conversions on all 'count' sensors
+*/
+/**************************************************************/
+void sensorPollStart(sensorPoll_t *polls, uint8_t count)
+{
+  uint8_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    polls[i].state = SENSORPOLL_STATE_STARTING;
+    polls[i].transfer.state = I2CSTATE_IDLE;
+    if (sensorPollQueue(&polls[i]) == false)
+    {
+      polls[i].transfer.state = I2CSTATE_IDLE;
+    }
+  }
+}
+
+/**************************************************************/
+/*! 
+    @brief  Moves the batch along.  Call this from the main loop
+            after sensorPollStart.
+
+    @return true once every sensor is either done or has failed
+*/
+/**************************************************************/
+bool sensorPollService(sensorPoll_t *polls, uint8_t count)
+{
+  bool finished = true;
+  uint8_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    sensorPollAdvance(&polls[i]);
+    if (polls[i].state != SENSORPOLL_STATE_DONE && polls[i].state != SENSORPOLL_STATE_ERROR)
+    {
+      finished = false;
+    }
+  }
+
+  return finished;
+}
+
+/**************************************************************/
+/*! 
+    @brief  Takes one sample from every sensor, sleeping between
+            steps (the systick and I2C interrupts wake it up)
+
+    @return true if all sensors answered
+*/
+/**************************************************************/
+bool sensorPollRun(sensorPoll_t *polls, uint8_t count)
+{
+  uint8_t i;
+
+  sensorPollStart(polls, count);
+  while (!sensorPollService(polls, count))
+  {
+    __asm volatile ("wfi");
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    if (polls[i].state != SENSORPOLL_STATE_DONE)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**************************************************************/
+/*! 
+    @brief  Returns a raw register read, for sensors that send
+            the low byte first (TSL2561, TCS3414) ...  'index'
+            counts 16-bit words from the start of 'data'.
+*/
+/**************************************************************/
+uint16_t sensorPollGet16LE(const sensorPoll_t *poll, uint8_t index)
+{
+  return poll->data[2 * index] | (poll->data[2 * index + 1] << 8);
+}
+
+/**************************************************************/
+/*! 
+    @brief  ... or the high byte first (LM75B)
+*/
+/**************************************************************/
+uint16_t sensorPollGet16BE(const sensorPoll_t *poll, uint8_t index)
+{
+  return (poll->data[2 * index] << 8) | poll->data[2 * index + 1];
+}
@@ -0,0 +1,95 @@
+/**************************************************************************/
+/*! 
+    @file     sensorpoll.h
+    @author   K. Townsend (microBuilder.eu)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef _SENSORPOLL_H_
+#define _SENSORPOLL_H_
+
+#include "projectconfig.h"
+#include "core/i2c/i2c.h"
+
+#define SENSORPOLL_MAXREADS   (4)
+#define SENSORPOLL_MAXDATA    (8)       // Bytes of register data per sensor
+
+/* Describes how to take one sample from an I2C sensor: a register   *
+ * write that starts a conversion, the time it takes, the registers  *
+ * to read once it's done and a write that powers the sensor back    *
+ * down.  Each driver exports one of these.                          */
+typedef struct sensorPollDevice_s
+{
+  uint8_t   address;                      // 8-bit I2C address
+  uint32_t  speed;                        // SCL rate (I2C_SPEED_..., 0 = default)
+  uint8_t   start[2];                     // Command/register and value
+  uint8_t   stop[2];                      // Command/register and value
+  uint8_t   reads[SENSORPOLL_MAXREADS];   // Command/register of each read
+  uint8_t   readCount;
+  uint8_t   readLength;                   // Bytes per read (2, 0 = 2)
+  uint32_t  (*conversionTime)(void);      // Milliseconds from start to valid data
+}
+sensorPollDevice_t;
+
+typedef enum
+{
+  SENSORPOLL_STATE_IDLE = 0,
+  SENSORPOLL_STATE_STARTING,
+  SENSORPOLL_STATE_CONVERTING,
+  SENSORPOLL_STATE_READING,
+  SENSORPOLL_STATE_STOPPING,
+  SENSORPOLL_STATE_DONE,
+  SENSORPOLL_STATE_ERROR                  // The sensor didn't ACK
+}
+sensorPollState_t;
+
+/* One sensor in a batch.  Only 'device' has to be filled in, the    *
+ * raw register contents of all reads end up back to back in 'data'  *
+ * (in the order the sensor sends them, see sensorPollGet16LE/BE).   */
+typedef struct sensorPoll_s
+{
+  const sensorPollDevice_t *device;
+  uint8_t           data[SENSORPOLL_MAXDATA];
+  sensorPollState_t state;
+  uint8_t           step;
+  uint32_t          readyTick;
+  i2cTransfer_t     transfer;
+}
+sensorPoll_t;
+
+void     sensorPollStart(sensorPoll_t *polls, uint8_t count);
+bool     sensorPollService(sensorPoll_t *polls, uint8_t count);
+bool     sensorPollRun(sensorPoll_t *polls, uint8_t count);
+uint16_t sensorPollGet16LE(const sensorPoll_t *poll, uint8_t index);
+uint16_t sensorPollGet16BE(const sensorPoll_t *poll, uint8_t index);
+
+#endif
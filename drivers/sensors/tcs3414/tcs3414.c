@@ -57,6 +57,26 @@ uint32_t i;
 
 static bool _tcs3414Initialised = false;
 
+static uint32_t tcs3414ConversionTime(void)
+{
+  // Same wait as tcs3414GetRGBL (>12ms at the default timing)
+  return 13;
+}
+
+/* Batch sampling with sensorPoll: one block read that returns green, */
+/* red, blue and clear (register order)                               */
+const sensorPollDevice_t tcs3414PollDevice =
+{
+  .address        = TCS3414_ADDRESS,
+  .speed          = TCS3414_I2C_SPEED,
+  .start          = { TCS3414_COMMAND_BIT | TCS3414_REGISTER_CONTROL, TCS3414_CONTROL_POWERON },
+  .stop           = { TCS3414_COMMAND_BIT | TCS3414_REGISTER_CONTROL, TCS3414_CONTROL_POWEROFF },
+  .reads          = { TCS3414_COMMAND_BIT | TCS3414_BLOCK_BIT | TCS3414_REGISTER_GREENLOW },
+  .readCount      = 1,
+  .readLength     = 8,
+  .conversionTime = tcs3414ConversionTime
+};
+
 /**************************************************************************/
 /*! 
     @brief  Sends a single command byte over I2C
@@ -74,7 +94,7 @@ tcs3414Error_e tcs3414WriteCmd (uint8_t cmd)
   I2CReadLength = 0;
   I2CMasterBuffer[0] = TCS3414_ADDRESS;       // I2C device address
   I2CMasterBuffer[1] = cmd;                   // Command register
-  i2cEngine();
+  i2cEngineSpeed(TCS3414_I2C_SPEED);
   return TCS3414_ERROR_OK;
 }
 
@@ -96,7 +116,7 @@ tcs3414Error_e tcs3414Write8 (uint8_t reg, uint32_t value)
   I2CMasterBuffer[0] = TCS3414_ADDRESS;           // I2C device address
   I2CMasterBuffer[1] = reg;                       // Command register
   I2CMasterBuffer[2] = (value & 0xFF);            // Value to write
-  i2cEngine();
+  i2cEngineSpeed(TCS3414_I2C_SPEED);
   return TCS3414_ERROR_OK;
 }
 
@@ -119,7 +139,7 @@ tcs3414Error_e tcs3414Read16(uint8_t reg, uint16_t *value)
   I2CMasterBuffer[1] = reg;                       // Command register
   // Append address w/read bit
   I2CMasterBuffer[2] = TCS3414_ADDRESS | TCS3414_READBIT;  
-  i2cEngine();
+  i2cEngineSpeed(TCS3414_I2C_SPEED);
 
   // Shift values to create properly formed integer (low byte first)
   *value = (I2CSlaveBuffer[0] | (I2CSlaveBuffer[1] << 8));
@@ -127,6 +147,31 @@ tcs3414Error_e tcs3414Read16(uint8_t reg, uint16_t *value)
   return TCS3414_ERROR_OK;
 }
 
+/**************************************************************************/
+/*! 
+    @brief  Reads 'len' consecutive registers in a single I2C transaction
+            using the block protocol
+*/
+/**************************************************************************/
+tcs3414Error_e tcs3414ReadBlock(uint8_t reg, uint8_t *buffer, uint8_t len)
+{
+  i2cTransfer_t transfer;
+  uint8_t cmd = TCS3414_COMMAND_BIT | TCS3414_BLOCK_BIT | reg;
+
+  transfer.address = TCS3414_ADDRESS;
+  transfer.writeBuffer = &cmd;
+  transfer.writeLength = 1;
+  transfer.readBuffer = buffer;
+  transfer.readLength = len;
+  transfer.callback = NULL;
+  transfer.speed = TCS3414_I2C_SPEED;
+
+  while (!i2cQueueTransfer(&transfer));
+  while (transfer.state == I2CSTATE_PENDING);
+
+  return TCS3414_ERROR_OK;
+}
+
 /**************************************************************************/
 /*! 
     @brief  Initialises the I2C block
@@ -183,6 +228,7 @@ tcs3414Error_e tcs3414GetRGBL(uint16_t *red, uint16_t *green, uint16_t *blue, ui
   if (!_tcs3414Initialised) tcs3414Init();
 
   tcs3414Error_e error = TCS3414_ERROR_OK;
+  uint8_t data[8];
 
   // Enable the device by setting the control bit to 0x03 (power + ADC on)
   error = tcs3414Write8(TCS3414_COMMAND_BIT | TCS3414_REGISTER_CONTROL, TCS3414_CONTROL_POWERON);
@@ -191,21 +237,14 @@ tcs3414Error_e tcs3414GetRGBL(uint16_t *red, uint16_t *green, uint16_t *blue, ui
   // Wait >12ms for ADC to complete
   systickDelay(13);
 
-  // Reads two byte red value
-  error = tcs3414Read16(TCS3414_COMMAND_BIT | TCS3414_WORD_BIT | TCS3414_REGISTER_REDLOW, red);
-  if (error) return error;
-
-  // Reads two byte green value
-  error = tcs3414Read16(TCS3414_COMMAND_BIT | TCS3414_WORD_BIT | TCS3414_REGISTER_GREENLOW, green);
-  if (error) return error;
-
-  // Reads two byte blue value
-  error = tcs3414Read16(TCS3414_COMMAND_BIT | TCS3414_WORD_BIT | TCS3414_REGISTER_BLUELOW, blue);
+  // Read green, red, blue and clear (low byte first) in one go
+  error = tcs3414ReadBlock(TCS3414_REGISTER_GREENLOW, data, sizeof(data));
   if (error) return error;
 
-  // Reads two byte clear value
-  error = tcs3414Read16(TCS3414_COMMAND_BIT | TCS3414_WORD_BIT | TCS3414_REGISTER_CLEARLOW, clear);
-  if (error) return error;
+  *green = data[0] | (data[1] << 8);
+  *red   = data[2] | (data[3] << 8);
+  *blue  = data[4] | (data[5] << 8);
+  *clear = data[6] | (data[7] << 8);
 
   // Turn the device off to save power
   error = tcs3414Write8(TCS3414_COMMAND_BIT | TCS3414_REGISTER_CONTROL, TCS3414_CONTROL_POWEROFF);
@@ -224,37 +263,30 @@ tcs3414Error_e tcs3414GetRGBL(uint16_t *red, uint16_t *green, uint16_t *blue, ui
 /**************************************************************************/
 uint32_t tcs3414CalculateCCT (uint16_t red, uint16_t green, uint16_t blue)
 {
-    volatile float R;
-    volatile float G;
-    volatile float B;
-    volatile float X;
-    volatile float Y;
-    volatile float Z;
-    volatile float x;
-    volatile float y;
-    volatile float n;
-    volatile float CCT;
-
-    // Convert RGB values to a 0-100 scale
-    R = (((float) red) / 65536) * 100;
-    G = (((float) green) / 65536) * 100;
-    B = (((float) blue)/ 65536) * 100;
-
-    //do matrix transformation
-    X = (-0.14282 * R) + (1.54924 * G) + (-0.95641 * B);
-    Y = (-0.32466 * R) + (1.57837 * G) + (-0.73191 * B);
-    Z = (-0.68202 * R) + (0.77073 * G) + (0.56332 * B);
-
-    //calc chromaticity coordinates
-    x = (X)/(X + Y + Z);
-    y = (Y)/(X + Y + Z);
-
-    //use McCamys formula to get CCT:
-    n = (x - 0.3320) / (0.1858 - y);
-    CCT =  (449 * n *  n * n);    // we don't have pow
-    CCT += (3525 * n * n);
-    CCT += (6823.3 * n);
-    CCT += 5520.33;
-
-    return ((uint32_t) CCT);
+  int64_t X, Y, Z, S, num, den, n, cct;
+
+  // RGB to XYZ with the matrix scaled by 10^5 (the scale cancels out)
+  X = (-14282LL * red) + (154924LL * green) - (95641LL * blue);
+  Y = (-32466LL * red) + (157837LL * green) - (73191LL * blue);
+  Z = (-68202LL * red) + (77073LL * green)  + (56332LL * blue);
+  S = X + Y + Z;
+
+  // McCamy's n = (x - 0.3320) / (0.1858 - y), with x = X/S and y = Y/S,
+  // multiplied through by S so a single division is left.  num takes up
+  // to 49 bits, so 2 bits are dropped to leave room for the 16.16 shift.
+  num = X * 10000 - S * 3320;
+  den = (S * 1858 - Y * 10000) >> 2;
+  if (den == 0)
+  {
+    return 0;
+  }
+  n = (num << 14) / den;
+
+  // CCT = 449n^3 + 3525n^2 + 6823.3n + 5520.33, in Horner form
+  cct = 449 * n + (3525 << 16);
+  cct = ((cct * n) >> 16) + 447171789;              // 6823.3 * 2^16
+  cct = ((cct * n) >> 16) + 361780347;              // 5520.33 * 2^16
+  cct >>= 16;
+
+  return cct > 0 ? (uint32_t)cct : 0;
 }
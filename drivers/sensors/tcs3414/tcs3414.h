@@ -39,12 +39,15 @@
 
 #include "projectconfig.h"
 #include "core/i2c/i2c.h"
+#include "drivers/sensors/sensorpoll/sensorpoll.h"
 
 #define TCS3414_ADDRESS                           (0x72)    // 0111001 shifted left 1 bit = 0x72 (ADDR = GND or floating)
+#define TCS3414_I2C_SPEED                         (I2C_SPEED_FAST)      // 400 kHz fast mode
 #define TCS3414_READBIT                           (0x01)
 
 #define TCS3414_COMMAND_BIT                       (0x80)    // Must be 1
 #define TCS3414_WORD_BIT                          (0x20)    // 1 = read/write word (rather than byte)
+#define TCS3414_BLOCK_BIT                         (0x40)    // 1 = block read/write from the addressed register on
 
 #define TCS3414_REGISTER_CONTROL                  (0x00)
 #define TCS3414_REGISTER_TIMING                   (0x01)
@@ -125,6 +128,8 @@ tcs3414Error_e tcs3414SetSensitivity(tcs3414Gain_t gain, tcs3414Prescalar_t pres
 tcs3414Error_e tcs3414GetRGBL (uint16_t *red, uint16_t *green, uint16_t *blue, uint16_t *clear);
 uint32_t       tcs3414CalculateCCT (uint16_t red, uint16_t green, uint16_t blue);
 
+extern const sensorPollDevice_t tcs3414PollDevice;
+
 #endif
 
 
@@ -34,6 +34,32 @@
 
     @endcode
 
+    Instead of polling, the sensor can be left running and pull its INT
+    output low when channel 0 leaves a window set with
+    tsl2561SetThresholds, so the MCU can sleep until the light level
+    changes.  tsl2561IntStart handles the pin through the GPIO interrupt
+    dispatch table, and tsl2561IntService (called from the main loop,
+    since it needs I2C) reads both channels, clears the interrupt and
+    can move the window to +/- 'hysteresis' around the new reading.
+    INT is open-drain and needs a pull-up.
+
+    @code
+    // Wake on INT (2.5) whenever the light level moves by more than
+    // 200 counts, once it has been out of the window for 2 periods
+    tsl2561IntStart(2, 5, 2, 0);
+    tsl2561IntService(&broadband, &ir, 200);
+
+    while (1)
+    {
+      __WFI();
+      if (tsl2561IntPending())
+      {
+        tsl2561IntService(&broadband, &ir, 200);
+        lux = tsl2561CalculateLux(broadband, ir);
+      }
+    }
+    @endcode
+
     @section LICENSE
 
     Software License Agreement (BSD License)
@@ -66,6 +92,7 @@
 /**************************************************************************/
 #include "tsl2561.h"
 #include "core/systick/systick.h"
+#include "core/gpio/gpio.h"
 
 extern volatile uint8_t   I2CMasterBuffer[I2C_BUFSIZE];
 extern volatile uint8_t   I2CSlaveBuffer[I2C_BUFSIZE];
@@ -76,6 +103,58 @@ uint32_t i;
 static bool _tsl2561Initialised = false;
 static tsl2561IntegrationTime_t _tsl2561IntegrationTime = TSL2561_INTEGRATIONTIME_402MS;
 static tsl2561Gain_t _tsl2561Gain = TSL2561_GAIN_0X;
+static bool _tsl2561IntActive = false;      // Left powered on for the interrupt
+static volatile bool _tsl2561IntPending = false;
+static uint32_t _tsl2561IntPort, _tsl2561IntPin;
+static void (*_tsl2561IntCallback)(void) = 0;
+
+static uint32_t tsl2561ConversionTime(void);
+
+/* Batch sampling with sensorPoll: returns broadband (0) and IR (1) */
+const sensorPollDevice_t tsl2561PollDevice =
+{
+  .address        = TSL2561_ADDRESS,
+  .speed          = TSL2561_I2C_SPEED,
+  .start          = { TSL2561_COMMAND_BIT | TSL2561_REGISTER_CONTROL, TSL2561_CONTROL_POWERON },
+  .stop           = { TSL2561_COMMAND_BIT | TSL2561_REGISTER_CONTROL, TSL2561_CONTROL_POWEROFF },
+  .reads          = { TSL2561_COMMAND_BIT | TSL2561_WORD_BIT | TSL2561_REGISTER_CHAN0_LOW,
+                      TSL2561_COMMAND_BIT | TSL2561_WORD_BIT | TSL2561_REGISTER_CHAN1_LOW },
+  .readCount      = 2,
+  .conversionTime = tsl2561ConversionTime
+};
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the time (in ms) one ADC cycle takes with the current
+            integration time
+*/
+/**************************************************************************/
+static uint32_t tsl2561ConversionTime(void)
+{
+  switch (_tsl2561IntegrationTime)
+  {
+    case TSL2561_INTEGRATIONTIME_13MS:
+      return 14;
+    case TSL2561_INTEGRATIONTIME_101MS:
+      return 102;
+    default:
+      return 403;
+  }
+}
+
+/**************************************************************************/
+/*! 
+    @brief  INT went low (GPIO interrupt)
+*/
+/**************************************************************************/
+static void tsl2561IntIRQ(void)
+{
+  _tsl2561IntPending = true;
+  if (_tsl2561IntCallback)
+  {
+    _tsl2561IntCallback();
+  }
+}
 
 /**************************************************************************/
 /*! 
@@ -94,7 +173,7 @@ tsl2561Error_t tsl2561WriteCmd (uint8_t cmd)
   I2CReadLength = 0;
   I2CMasterBuffer[0] = TSL2561_ADDRESS;       // I2C device address
   I2CMasterBuffer[1] = cmd;                   // Command register
-  i2cEngine();
+  i2cEngineSpeed(TSL2561_I2C_SPEED);
   return TSL2561_ERROR_OK;
 }
 
@@ -116,7 +195,30 @@ tsl2561Error_t tsl2561Write8 (uint8_t reg, uint32_t value)
   I2CMasterBuffer[0] = TSL2561_ADDRESS;           // I2C device address
   I2CMasterBuffer[1] = reg;                       // Command register
   I2CMasterBuffer[2] = (value & 0xFF);            // Value to write
-  i2cEngine();
+  i2cEngineSpeed(TSL2561_I2C_SPEED);
+  return TSL2561_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Writes a 16 bit value (low byte first) over I2C
+*/
+/**************************************************************************/
+tsl2561Error_t tsl2561Write16 (uint8_t reg, uint16_t value)
+{
+  // Clear write buffers
+  for ( i = 0; i < I2C_BUFSIZE; i++ )
+  {
+    I2CMasterBuffer[i] = 0x00;
+  }
+
+  I2CWriteLength = 4;
+  I2CReadLength = 0;
+  I2CMasterBuffer[0] = TSL2561_ADDRESS;           // I2C device address
+  I2CMasterBuffer[1] = reg;                       // Command register
+  I2CMasterBuffer[2] = (value & 0xFF);            // Low byte
+  I2CMasterBuffer[3] = (value >> 8);              // High byte
+  i2cEngineSpeed(TSL2561_I2C_SPEED);
   return TSL2561_ERROR_OK;
 }
 
@@ -139,7 +241,7 @@ tsl2561Error_t tsl2561Read16(uint8_t reg, uint16_t *value)
   I2CMasterBuffer[1] = reg;                       // Command register
   // Append address w/read bit
   I2CMasterBuffer[2] = TSL2561_ADDRESS | TSL2561_READBIT;  
-  i2cEngine();
+  i2cEngineSpeed(TSL2561_I2C_SPEED);
 
   // Shift values to create properly formed integer (low byte first)
   *value = (I2CSlaveBuffer[0] | (I2CSlaveBuffer[1] << 8));
@@ -162,12 +264,14 @@ tsl2561Error_t tsl2561Enable(void)
 
 /**************************************************************************/
 /*! 
-    @brief  Disables the device (putting it in lower power sleep mode)
+    @brief  Disables the device (putting it in lower power sleep mode),
+            unless it's being kept on for the threshold interrupt
 */
 /**************************************************************************/
 tsl2561Error_t tsl2561Disable(void)
 {
   if (!_tsl2561Initialised) tsl2561Init();
+  if (_tsl2561IntActive) return TSL2561_ERROR_OK;
 
   // Turn the device off to save power
   return tsl2561Write8(TSL2561_COMMAND_BIT | TSL2561_REGISTER_CONTROL, TSL2561_CONTROL_POWEROFF);
@@ -237,22 +341,14 @@ tsl2561Error_t tsl2561GetLuminosity (uint16_t *broadband, uint16_t *ir)
 
   tsl2561Error_t error = TSL2561_ERROR_OK;
 
-  // Enable the device by setting the control bit to 0x03
-  error = tsl2561Enable();
-  if (error) return error;  
-
-  // Wait x ms for ADC to complete
-  switch (_tsl2561IntegrationTime)
+  // Enable the device by setting the control bit to 0x03 and wait x ms
+  // for ADC to complete (it's already running in interrupt mode)
+  if (!_tsl2561IntActive)
   {
-    case TSL2561_INTEGRATIONTIME_13MS:
-      systickDelay(14);
-      break;
-    case TSL2561_INTEGRATIONTIME_101MS:
-      systickDelay(102);
-      break;
-    default:
-      systickDelay(400);
-      break;
+    error = tsl2561Enable();
+    if (error) return error;  
+
+    systickDelay(tsl2561ConversionTime() / CFG_SYSTICK_DELAY_IN_MS);
   }
 
   // Reads two byte value from channel 0 (visible + infrared)
@@ -270,17 +366,172 @@ tsl2561Error_t tsl2561GetLuminosity (uint16_t *broadband, uint16_t *ir)
   return error;
 }
 
+/**************************************************************************/
+/*! 
+    @brief  Piecewise linear lux fit from the datasheet: for a channel
+            ratio up to k, lux = ch0 * b - ch1 * m
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint16_t k;       // Upper ch1/ch0 ratio, scaled by 2^TSL2561_LUX_RATIOSCALE
+  uint16_t b;       // Scaled by 2^TSL2561_LUX_LUXSCALE
+  uint16_t m;       // Scaled by 2^TSL2561_LUX_LUXSCALE
+}
+tsl2561LuxSegment_t;
+
+static const tsl2561LuxSegment_t tsl2561LuxTable[] =
+{
+#ifdef TSL2561_PACKAGE_CS
+  { TSL2561_LUX_K1C, TSL2561_LUX_B1C, TSL2561_LUX_M1C },
+  { TSL2561_LUX_K2C, TSL2561_LUX_B2C, TSL2561_LUX_M2C },
+  { TSL2561_LUX_K3C, TSL2561_LUX_B3C, TSL2561_LUX_M3C },
+  { TSL2561_LUX_K4C, TSL2561_LUX_B4C, TSL2561_LUX_M4C },
+  { TSL2561_LUX_K5C, TSL2561_LUX_B5C, TSL2561_LUX_M5C },
+  { TSL2561_LUX_K6C, TSL2561_LUX_B6C, TSL2561_LUX_M6C },
+  { TSL2561_LUX_K7C, TSL2561_LUX_B7C, TSL2561_LUX_M7C },
+  { 0xFFFF,          TSL2561_LUX_B8C, TSL2561_LUX_M8C }
+#else
+  { TSL2561_LUX_K1T, TSL2561_LUX_B1T, TSL2561_LUX_M1T },
+  { TSL2561_LUX_K2T, TSL2561_LUX_B2T, TSL2561_LUX_M2T },
+  { TSL2561_LUX_K3T, TSL2561_LUX_B3T, TSL2561_LUX_M3T },
+  { TSL2561_LUX_K4T, TSL2561_LUX_B4T, TSL2561_LUX_M4T },
+  { TSL2561_LUX_K5T, TSL2561_LUX_B5T, TSL2561_LUX_M5T },
+  { TSL2561_LUX_K6T, TSL2561_LUX_B6T, TSL2561_LUX_M6T },
+  { TSL2561_LUX_K7T, TSL2561_LUX_B7T, TSL2561_LUX_M7T },
+  { 0xFFFF,          TSL2561_LUX_B8T, TSL2561_LUX_M8T }
+#endif
+};
+
+/**************************************************************************/
+/*! 
+    @brief  Integration time and gain settings for auto-ranging, from
+            the most to the least sensitive.  'exposure' is relative
+            (402ms at 1x = 322, the datasheet's scale factors) and
+            'clip' is the highest count the ADC can reach in that time.
+*/
+/**************************************************************************/
+typedef struct
+{
+  tsl2561IntegrationTime_t integration;
+  tsl2561Gain_t            gain;
+  uint16_t                 exposure;
+  uint16_t                 clip;
+}
+tsl2561Range_t;
+
+static const tsl2561Range_t tsl2561Ranges[] =
+{
+  { TSL2561_INTEGRATIONTIME_402MS, TSL2561_GAIN_16X, 322 * 16, 65535 },
+  { TSL2561_INTEGRATIONTIME_101MS, TSL2561_GAIN_16X, 81 * 16,  37177 },
+  { TSL2561_INTEGRATIONTIME_402MS, TSL2561_GAIN_0X,  322,      65535 },
+  { TSL2561_INTEGRATIONTIME_13MS,  TSL2561_GAIN_16X, 11 * 16,  5047  },
+  { TSL2561_INTEGRATIONTIME_101MS, TSL2561_GAIN_0X,  81,       37177 },
+  { TSL2561_INTEGRATIONTIME_13MS,  TSL2561_GAIN_0X,  11,       5047  }
+};
+
+#define TSL2561_RANGES    (sizeof(tsl2561Ranges) / sizeof(tsl2561Ranges[0]))
+
+/**************************************************************************/
+/*! 
+    @brief  Returns the index of the current setting in tsl2561Ranges
+*/
+/**************************************************************************/
+static uint8_t tsl2561RangeIndex(void)
+{
+  uint8_t r;
+
+  for (r = 0; r < TSL2561_RANGES - 1; r++)
+  {
+    if (tsl2561Ranges[r].integration == _tsl2561IntegrationTime &&
+        tsl2561Ranges[r].gain == _tsl2561Gain)
+    {
+      break;
+    }
+  }
+  return r;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Picks the integration time and gain for the next reading
+            from the broadband count of the last one.  A saturated (above
+            90% of full scale) reading moves down a step, and a reading
+            that would stay below 3/4 of that after moving up a step
+            moves up, so the setting doesn't oscillate.
+
+    @return true if the setting was changed.  If the reading was above the
+            limit, it should be taken again.
+
+    @note   Also works for samples from sensorPoll: the new setting
+            applies to the next batch.
+*/
+/**************************************************************************/
+bool tsl2561AutoRange(uint16_t broadband)
+{
+  uint8_t r = tsl2561RangeIndex();
+  const tsl2561Range_t *cur = &tsl2561Ranges[r];
+
+  if (broadband > cur->clip - cur->clip / 10 && r < TSL2561_RANGES - 1)
+  {
+    r++;
+  }
+  else if (r > 0 &&
+           (uint32_t)broadband * tsl2561Ranges[r - 1].exposure * 4 <
+           (uint32_t)(tsl2561Ranges[r - 1].clip - tsl2561Ranges[r - 1].clip / 10) * cur->exposure * 3)
+  {
+    r--;
+  }
+  else
+  {
+    return false;
+  }
+
+  tsl2561SetTiming(tsl2561Ranges[r].integration, tsl2561Ranges[r].gain);
+  return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Reads both channels, adjusting integration time and gain
+            until the broadband channel is in range.  In bright light
+            this settles on a short integration time, so reads get
+            faster, and the last setting is kept for the next call.
+*/
+/**************************************************************************/
+tsl2561Error_t tsl2561GetLuminosityAuto (uint16_t *broadband, uint16_t *ir)
+{
+  tsl2561Error_t error;
+  uint8_t tries = TSL2561_RANGES;
+
+  do
+  {
+    error = tsl2561GetLuminosity(broadband, ir);
+    if (error) return error;
+  } while (tsl2561AutoRange(*broadband) && --tries);
+
+  return TSL2561_ERROR_OK;
+}
+
 /**************************************************************************/
 /*! 
     @brief  Calculates LUX from the supplied ch0 (broadband) and ch1 
             (IR) readings
+
+    @return The illuminance in lux, or TSL2561_LUX_SATURATED if either
+            channel was at full scale (see tsl2561GetLuminosityAuto)
 */
 /**************************************************************************/
 uint32_t tsl2561CalculateLux(uint16_t ch0, uint16_t ch1)
 {
-  unsigned long chScale;
-  unsigned long channel1;
-  unsigned long channel0;
+  const tsl2561LuxSegment_t *seg = tsl2561LuxTable;
+  const tsl2561Range_t *range = &tsl2561Ranges[tsl2561RangeIndex()];
+  uint32_t chScale, channel0, channel1, ratio, b, m;
+
+  if (ch0 >= range->clip || ch1 >= range->clip)
+  {
+    return TSL2561_LUX_SATURATED;
+  }
 
   switch (_tsl2561IntegrationTime)
   {
@@ -302,63 +553,169 @@ uint32_t tsl2561CalculateLux(uint16_t ch0, uint16_t ch1)
   channel0 = (ch0 * chScale) >> TSL2561_LUX_CHSCALE;
   channel1 = (ch1 * chScale) >> TSL2561_LUX_CHSCALE;
 
-  // find the ratio of the channel values (Channel1/Channel0)
-  unsigned long ratio1 = 0;
-  if (channel0 != 0) ratio1 = (channel1 << (TSL2561_LUX_RATIOSCALE+1)) / channel0;
+  // find the rounded ratio of the channel values (Channel1/Channel0)
+  ratio = 0;
+  if (channel0 != 0) ratio = ((channel1 << (TSL2561_LUX_RATIOSCALE+1)) / channel0 + 1) >> 1;
 
-  // round the ratio value
-  unsigned long ratio = (ratio1 + 1) >> 1;
+  // find the segment of the fit (the last one catches everything)
+  while (ratio > seg->k && seg < &tsl2561LuxTable[7]) seg++;
+  b = channel0 * seg->b;
+  m = channel1 * seg->m;
 
-  unsigned int b, m;
+  // do not allow negative lux value
+  if (m >= b) return 0;
 
-#ifdef TSL2561_PACKAGE_CS
-  if ((ratio >= 0) && (ratio <= TSL2561_LUX_K1C))
-    {b=TSL2561_LUX_B1C; m=TSL2561_LUX_M1C;}
-  else if (ratio <= TSL2561_LUX_K2C)
-    {b=TSL2561_LUX_B2C; m=TSL2561_LUX_M2C;}
-  else if (ratio <= TSL2561_LUX_K3C)
-    {b=TSL2561_LUX_B3C; m=TSL2561_LUX_M3C;}
-  else if (ratio <= TSL2561_LUX_K4C)
-    {b=TSL2561_LUX_B4C; m=TSL2561_LUX_M4C;}
-  else if (ratio <= TSL2561_LUX_K5C)
-    {b=TSL2561_LUX_B5C; m=TSL2561_LUX_M5C;}
-  else if (ratio <= TSL2561_LUX_K6C)
-    {b=TSL2561_LUX_B6C; m=TSL2561_LUX_M6C;}
-  else if (ratio <= TSL2561_LUX_K7C)
-    {b=TSL2561_LUX_B7C; m=TSL2561_LUX_M7C;}
-  else if (ratio > TSL2561_LUX_K8C)
-    {b=TSL2561_LUX_B8C; m=TSL2561_LUX_M8C;}
-#else
-  if ((ratio >= 0) && (ratio <= TSL2561_LUX_K1T))
-    {b=TSL2561_LUX_B1T; m=TSL2561_LUX_M1T;}
-  else if (ratio <= TSL2561_LUX_K2T)
-    {b=TSL2561_LUX_B2T; m=TSL2561_LUX_M2T;}
-  else if (ratio <= TSL2561_LUX_K3T)
-    {b=TSL2561_LUX_B3T; m=TSL2561_LUX_M3T;}
-  else if (ratio <= TSL2561_LUX_K4T)
-    {b=TSL2561_LUX_B4T; m=TSL2561_LUX_M4T;}
-  else if (ratio <= TSL2561_LUX_K5T)
-    {b=TSL2561_LUX_B5T; m=TSL2561_LUX_M5T;}
-  else if (ratio <= TSL2561_LUX_K6T)
-    {b=TSL2561_LUX_B6T; m=TSL2561_LUX_M6T;}
-  else if (ratio <= TSL2561_LUX_K7T)
-    {b=TSL2561_LUX_B7T; m=TSL2561_LUX_M7T;}
-  else if (ratio > TSL2561_LUX_K8T)
-    {b=TSL2561_LUX_B8T; m=TSL2561_LUX_M8T;}
-#endif
+  // round lsb (2^(LUX_SCALE-1)) and strip off fractional portion
+  return (b - m + (1 << (TSL2561_LUX_LUXSCALE-1))) >> TSL2561_LUX_LUXSCALE;
+}
 
-  unsigned long temp;
-  temp = ((channel0 * b) - (channel1 * m));
+/**************************************************************************/
+/*! 
+    @brief  Sets the window for the threshold interrupt: INT goes low
+            when the channel 0 (broadband) reading is below 'low' or
+            above 'high'
+*/
+/**************************************************************************/
+tsl2561Error_t tsl2561SetThresholds(uint16_t low, uint16_t high)
+{
+  if (!_tsl2561Initialised) tsl2561Init();
 
-  // do not allow negative lux value
-  if (temp < 0) temp = 0;
+  tsl2561Error_t error = TSL2561_ERROR_OK;
+
+  error = tsl2561Write16(TSL2561_COMMAND_BIT | TSL2561_WORD_BIT | TSL2561_REGISTER_THRESHHOLDL_LOW, low);
+  if (error) return error;
+
+  return tsl2561Write16(TSL2561_COMMAND_BIT | TSL2561_WORD_BIT | TSL2561_REGISTER_THRESHHOLDH_LOW, high);
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Keeps the sensor running and enables the level interrupt on
+            INT, handled through the GPIO interrupt dispatch table
+
+    @param[in]  port
+                The GPIO port INT is connected to
+    @param[in]  pin
+                The pin INT is connected to
+    @param[in]  persist
+                The number of integration periods in a row the reading
+                has to be outside the window (1..15, 0 interrupts after
+                every period)
+    @param[in]  callback
+                Called from the GPIO interrupt when INT goes low (can be
+                0, and tsl2561IntPending polled instead)
+*/
+/**************************************************************************/
+tsl2561Error_t tsl2561IntStart(uint32_t port, uint32_t pin, uint8_t persist, void (*callback)(void))
+{
+  if (!_tsl2561Initialised) tsl2561Init();
+
+  tsl2561Error_t error = TSL2561_ERROR_OK;
+
+  if ((port > 3) || (pin > 11))
+  {
+    return TSL2561_ERROR_INTERRUPT;
+  }
+
+  tsl2561IntStop();
+
+  error = tsl2561Enable();
+  if (error) return error;
+
+  error = tsl2561Write8(TSL2561_COMMAND_BIT | TSL2561_REGISTER_INTERRUPT,
+                        TSL2561_INTERRUPT_LEVEL | (persist & TSL2561_INTERRUPT_PERSIST_MASK));
+  if (error) return error;
+
+  // Clear anything left over, so the next interrupt is a falling edge
+  error = tsl2561WriteCmd(TSL2561_COMMAND_BIT | TSL2561_CLEAR_BIT);
+  if (error) return error;
+
+  _tsl2561IntCallback = callback;
+  _tsl2561IntPending = false;
+  gpioSetDir(port, pin, gpioDirection_Input);
+  if (!gpioAttachInterrupt(port, pin, gpioInterruptSense_Edge, gpioInterruptEdge_Single,
+                           gpioInterruptEvent_ActiveLow, tsl2561IntIRQ))
+  {
+    tsl2561Write8(TSL2561_COMMAND_BIT | TSL2561_REGISTER_INTERRUPT, TSL2561_INTERRUPT_DISABLED);
+    tsl2561Disable();
+    return TSL2561_ERROR_INTERRUPT;
+  }
+
+  _tsl2561IntPort = port;
+  _tsl2561IntPin = pin;
+  _tsl2561IntActive = true;
+
+  return TSL2561_ERROR_OK;
+}
+
+/**************************************************************************/
+/*! 
+    @brief  Disables the threshold interrupt and powers the sensor down
+*/
+/**************************************************************************/
+tsl2561Error_t tsl2561IntStop(void)
+{
+  tsl2561Error_t error = TSL2561_ERROR_OK;
+
+  if (!_tsl2561IntActive)
+  {
+    return TSL2561_ERROR_OK;
+  }
+
+  gpioDetachInterrupt(_tsl2561IntPort, _tsl2561IntPin);
+  _tsl2561IntActive = false;
+  _tsl2561IntPending = false;
+
+  error = tsl2561Write8(TSL2561_COMMAND_BIT | TSL2561_REGISTER_INTERRUPT, TSL2561_INTERRUPT_DISABLED);
+  if (error) return error;
+
+  return tsl2561Disable();
+}
 
-  // round lsb (2^(LUX_SCALE-1))
-  temp += (1 << (TSL2561_LUX_LUXSCALE-1));
+/**************************************************************************/
+/*! 
+    @brief  Returns true if INT has gone low since the last
+            tsl2561IntService
+*/
+/**************************************************************************/
+bool tsl2561IntPending(void)
+{
+  return _tsl2561IntPending;
+}
 
-  // strip off fractional portion
-  uint32_t lux = temp >> TSL2561_LUX_LUXSCALE;
+/**************************************************************************/
+/*! 
+    @brief  Reads both channels and clears the interrupt.  Must be called
+            after each interrupt (outside the interrupt, since it uses
+            I2C) so that INT can fire again.
+
+    @param[out] broadband
+                The channel 0 reading (visible + infrared)
+    @param[out] ir
+                The channel 1 reading (infrared)
+    @param[in]  hysteresis
+                If not 0, the window is moved to 'broadband' +/- this
+                many counts, so the next interrupt comes when the light
+                level has changed by that much
+*/
+/**************************************************************************/
+tsl2561Error_t tsl2561IntService(uint16_t *broadband, uint16_t *ir, uint16_t hysteresis)
+{
+  tsl2561Error_t error = TSL2561_ERROR_OK;
+  uint32_t high;
+
+  _tsl2561IntPending = false;
+
+  error = tsl2561GetLuminosity(broadband, ir);
+  if (error) return error;
+
+  if (hysteresis)
+  {
+    high = (uint32_t)*broadband + hysteresis;
+    error = tsl2561SetThresholds(*broadband > hysteresis ? *broadband - hysteresis : 0,
+                                 high > 0xFFFF ? 0xFFFF : high);
+    if (error) return error;
+  }
 
-  // Signal I2C had no errors
-  return lux;
+  return tsl2561WriteCmd(TSL2561_COMMAND_BIT | TSL2561_CLEAR_BIT);
 }
@@ -39,11 +39,13 @@
 
 #include "projectconfig.h"
 #include "core/i2c/i2c.h"
+#include "drivers/sensors/sensorpoll/sensorpoll.h"
 
 #define TSL2561_PACKAGE_CS                  // Lux calculations differ slightly for CS package
 // #define TSL2561_PACKAGE_T_FN_CL
 
 #define TSL2561_ADDRESS           (0x72)    // 0111001 shifted left 1 bit = 0x72 (ADDR = GND or floating)
+#define TSL2561_I2C_SPEED         (I2C_SPEED_FAST)      // 400 kHz fast mode
 #define TSL2561_READBIT           (0x01)
 
 #define TSL2561_COMMAND_BIT       (0x80)    // Must be 1
@@ -54,6 +56,11 @@
 #define TSL2561_CONTROL_POWERON   (0x03)
 #define TSL2561_CONTROL_POWEROFF  (0x00)
 
+#define TSL2561_INTERRUPT_DISABLED  (0x00)
+#define TSL2561_INTERRUPT_LEVEL     (0x10)  // Active low until cleared
+#define TSL2561_INTERRUPT_PERSIST_MASK (0x0F) // Out of range periods in a row (0 = every period)
+
+#define TSL2561_LUX_SATURATED     (65536)   // Returned when a channel clipped
 #define TSL2561_LUX_LUXSCALE      (14)      // Scale by 2^14
 #define TSL2561_LUX_RATIOSCALE    (9)       // Scale ratio by 2^9
 #define TSL2561_LUX_CHSCALE       (10)      // Scale channel values by 2^10
@@ -149,6 +156,7 @@ typedef enum
   TSL2561_ERROR_OK = 0,               // Everything executed normally
   TSL2561_ERROR_I2CINIT,              // Unable to initialise I2C
   TSL2561_ERROR_I2CBUSY,              // I2C already in use
+  TSL2561_ERROR_INTERRUPT,            // Pin out of range or no GPIO callback free
   TSL2561_ERROR_LAST
 }
 tsl2561Error_t;
@@ -156,7 +164,16 @@ tsl2561Error_t;
 tsl2561Error_t tsl2561Init(void);
 tsl2561Error_t tsl2561SetTiming(tsl2561IntegrationTime_t integration, tsl2561Gain_t gain);
 tsl2561Error_t tsl2561GetLuminosity (uint16_t *broadband, uint16_t *ir);
+tsl2561Error_t tsl2561GetLuminosityAuto (uint16_t *broadband, uint16_t *ir);
+bool tsl2561AutoRange(uint16_t broadband);
 uint32_t tsl2561CalculateLux(uint16_t ch0, uint16_t ch1);
+tsl2561Error_t tsl2561SetThresholds(uint16_t low, uint16_t high);
+tsl2561Error_t tsl2561IntStart(uint32_t port, uint32_t pin, uint8_t persist, void (*callback)(void));
+tsl2561Error_t tsl2561IntStop(void);
+bool tsl2561IntPending(void);
+tsl2561Error_t tsl2561IntService(uint16_t *broadband, uint16_t *ir, uint16_t hysteresis);
+
+extern const sensorPollDevice_t tsl2561PollDevice;
 
 #endif
 
@@ -110,6 +110,21 @@
 #define SCB_CPUID_VARIANT_MASK                    ((unsigned int) 0x00F00000) // Variant
 #define SCB_CPUID_IMPLEMENTER_MASK                ((unsigned int) 0xFF000000) // Implementer
 
+/*  Interrupt Control and State Register */
+
+#define SCB_ICSR                                  (*(pREG32 (0xE000ED04)))
+#define SCB_ICSR_PENDSTCLR                        ((unsigned int) 0x02000000) // Clear pending SysTick
+#define SCB_ICSR_PENDSTSET                        ((unsigned int) 0x04000000) // Set pending SysTick
+#define SCB_ICSR_PENDSVCLR                        ((unsigned int) 0x08000000) // Clear pending PendSV
+#define SCB_ICSR_PENDSVSET                        ((unsigned int) 0x10000000) // Set pending PendSV
+
+/*  System Handler Priority Register 3 */
+
+#define SCB_SHPR3                                 (*(pREG32 (0xE000ED20)))
+#define SCB_SHPR3_PRI_14_MASK                     ((unsigned int) 0x00FF0000) // PendSV priority
+#define SCB_SHPR3_PRI_14_LOWEST                   ((unsigned int) 0x00FF0000)
+#define SCB_SHPR3_PRI_15_MASK                     ((unsigned int) 0xFF000000) // SysTick priority
+
 /*  System Control Register */
 
 #define SCB_SCR                                   (*(pREG32 (0xE000ED10)))
@@ -1938,6 +1953,20 @@ typedef struct
 static inline void __enable_irq()                 { __asm volatile ("cpsie i"); }
 static inline void __disable_irq()                { __asm volatile ("cpsid i"); }
 
+/* Exclusive load/store for lock-free updates: if anything (an interrupt,  *
+ * or __CLREX) touched the reservation in between, __STREXW fails and      *
+ * returns 1, and the load/modify/store has to be retried.                 */
+static inline uint32_t __LDREXW(volatile uint32_t *addr)          { uint32_t v; __asm volatile ("ldrex %0, [%1]" : "=r" (v) : "r" (addr) : "memory"); return v; }
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) { uint32_t r; __asm volatile ("strex %0, %2, [%1]" : "=&r" (r) : "r" (addr), "r" (value) : "memory"); return r; }
+static inline void __CLREX()                      { __asm volatile ("clrex" ::: "memory"); }
+static inline void __DMB()                        { __asm volatile ("dmb" ::: "memory"); }
+
+/* BASEPRI masks every interrupt at or below a priority level (0 = off).   *
+ * __set_BASEPRI_MAX only ever raises the mask, so sections can nest.      */
+static inline uint32_t __get_BASEPRI()            { uint32_t v; __asm volatile ("mrs %0, basepri" : "=r" (v)); return v; }
+static inline void __set_BASEPRI(uint32_t value)  { __asm volatile ("msr basepri, %0" :: "r" (value) : "memory"); }
+static inline void __set_BASEPRI_MAX(uint32_t value) { __asm volatile ("msr basepri_max, %0" :: "r" (value) : "memory"); }
+
 typedef enum IRQn
 {
 /******  Cortex-M3 Processor Exceptions Numbers ***************************************************/
@@ -2019,6 +2048,43 @@ static inline void NVIC_DisableIRQ(IRQn_t IRQn)
   NVIC->ICER[((uint32_t)(IRQn) >> 5)] = (1 << ((uint32_t)(IRQn) & 0x1F));
 }
 
+static inline void NVIC_SetPendingIRQ(IRQn_t IRQn)
+{
+  NVIC->ISPR[((uint32_t)(IRQn) >> 5)] = (1 << ((uint32_t)(IRQn) & 0x1F));
+}
+
+#define __NVIC_PRIO_BITS                          (3)   /* 8 priority levels */
+
+/* Priorities are 0 (highest) .. 7, system handlers (SysTick_IRQn, etc.)  *
+ * are set through the byte-wide SHPR1..3 registers                       */
+static inline void NVIC_SetPriority(IRQn_t IRQn, uint32_t priority)
+{
+  if ((int32_t)(IRQn) < 0)
+  {
+    ((volatile uint8_t *)0xE000ED18)[((uint32_t)(IRQn) & 0xF) - 4] = (priority << (8 - __NVIC_PRIO_BITS)) & 0xFF;
+  }
+  else
+  {
+    NVIC->IP[(uint32_t)(IRQn)] = (priority << (8 - __NVIC_PRIO_BITS)) & 0xFF;
+  }
+}
+
+static inline uint32_t NVIC_GetPriority(IRQn_t IRQn)
+{
+  if ((int32_t)(IRQn) < 0)
+  {
+    return ((volatile uint8_t *)0xE000ED18)[((uint32_t)(IRQn) & 0xF) - 4] >> (8 - __NVIC_PRIO_BITS);
+  }
+  return NVIC->IP[(uint32_t)(IRQn)] >> (8 - __NVIC_PRIO_BITS);
+}
+
+/* PRIGROUP: bits [group:0] of each priority byte are the sub-priority */
+static inline void NVIC_SetPriorityGrouping(uint32_t group)
+{
+  SCB_AIRCR = (SCB_AIRCR & ~(SCB_AIRCR_VECTKEY_MASK | SCB_AIRCR_PRIGROUP_MASK)) |
+              SCB_AIRCR_VECTKEY_VALUE | ((group & 7) << 8);
+}
+
 /*##############################################################################
 ## GPIO - General Purpose I/O
 ##############################################################################*/
@@ -3360,6 +3426,12 @@ static inline void NVIC_DisableIRQ(IRQn_t IRQn)
 #define ADC_AD0CR_START_MASK                      (0x07000000)
 #define ADC_AD0CR_START_NOSTART                   (0x00000000)
 #define ADC_AD0CR_START_STARTNOW                  (0x01000000)
+#define ADC_AD0CR_START_CT16B0_CAP0               (0x02000000)  // Start on edge of CT16B0_CAP0 (PIO0_2)
+#define ADC_AD0CR_START_CT32B0_CAP0               (0x03000000)  // Start on edge of CT32B0_CAP0 (PIO1_5)
+#define ADC_AD0CR_START_CT32B0_MAT0               (0x04000000)  // Start on edge of CT32B0_MAT0
+#define ADC_AD0CR_START_CT32B0_MAT1               (0x05000000)  // Start on edge of CT32B0_MAT1
+#define ADC_AD0CR_START_CT16B0_MAT0               (0x06000000)  // Start on edge of CT16B0_MAT0
+#define ADC_AD0CR_START_CT16B0_MAT1               (0x07000000)  // Start on edge of CT16B0_MAT1
 #define ADC_AD0CR_EDGE_MASK                       (0x08000000)
 #define ADC_AD0CR_EDGE_FALLING                    (0x08000000)
 #define ADC_AD0CR_EDGE_RISING                     (0x00000000)
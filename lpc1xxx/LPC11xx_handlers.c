@@ -101,7 +101,7 @@ extern void boot_entry(void);
 // Defined irq vectors using simple c code following the description in a white 
 // paper from ARM[3] and code example from Simonsson Fun Technologies[4].
 // These vectors are placed at the memory location defined in the linker script
-const void *vectors[] SECTION(".irq_vectors") =
+const void *vectors[] SECTION(".irq_vectors") __attribute__ ((used)) =
 {
   // Stack and program reset entry point
   &stack_entry,          // The initial stack pointer
@@ -28,6 +28,8 @@
  *
  */
 
+#include "core/stack/stack.h"
+
 // These are defined and created by the linker, locating them in memory
 extern unsigned char _etext;
 extern unsigned char _data;
@@ -44,7 +46,8 @@ void boot_entry(void)
 {
   register unsigned char *src, *dst;
 
-  // Get physical data address and copy it to sram
+  // Get physical data address and copy it to sram (this also copies
+  // any RAMFUNC code, which the linker places at the start of .data)
   src = &_etext;
   dst = &_data;
   while(dst < &_edata) {
@@ -57,6 +60,14 @@ void boot_entry(void)
     *dst++ = 0;
   }
 
+  // Paint the free RAM below the stack so that core/stack can find the
+  // stack high-water mark (a few bytes are left for this frame)
+  __asm volatile ("mov %0, sp" : "=r" (src));
+  src -= 16;
+  while(dst < src) {
+    *dst++ = STACK_PAINTBYTE;
+  }
+
   // Execute the code at the program entry point
   main();
 
@@ -42,33 +42,84 @@
 
 #include "core/gpio/gpio.h"
 #include "core/systick/systick.h"
+#include "core/sched/event.h"
 
 #ifdef CFG_INTERFACE
   #include "core/cmd/cmd.h"
 #endif
 
+#ifdef CFG_SCHEDULER
+  #include "core/sched/sched.h"
+#endif
+
+#ifdef CFG_WDT_SUPERVISOR
+  #include "core/wdt/supervisor.h"
+#endif
+
+#if defined CFG_USBCDC_MSC && !defined CFG_SCHEDULER
+  #include "core/usbcdc/mscuser.h"
+#endif
+
+#if defined CFG_TFTLCD && defined CFG_TFTLCD_REMOTE && CFG_TFTLCD_REMOTE == 1
+  #include "drivers/lcd/tft/lcdremote.h"
+#endif
+
+#ifdef CFG_BENCH_AUTORUN
+  // Benchmark suite in project/commands/cmd_bench.c
+  void cmd_bench(uint8_t argc, char **argv);
+#endif
+
+#ifdef CFG_SCHEDULER
+static schedTask_t ledTask;
+
+#ifdef CFG_WDT_SUPERVISOR
+static uint8_t ledSupervisorId;
+#endif
+
 /**************************************************************************/
 /*! 
-    Approximates a 1 millisecond delay using "nop".  This is less
-    accurate than a dedicated timer, but is useful in certain situations.
-
-    The number of ticks to delay depends on the optimisation level set
-    when compiling (-O).  Depending on the compiler settings, one of the
-    two defined values for 'delay' should be used.
+    Toggles the LED (runs once per second)
 */
 /**************************************************************************/
-void delayms(uint32_t ms)
+static void ledToggle(schedTask_t *task)
 {
-  uint32_t delay = ms * ((CFG_CPU_CCLK / 100) / 45);      // Release Mode (-Os)
-  // uint32_t delay = ms * ((CFG_CPU_CCLK / 100) / 120);  // Debug Mode (No optimisations)
+  #ifdef CFG_WDT_SUPERVISOR
+    supervisorCheckIn(ledSupervisorId);
+  #endif
 
-  while (delay > 0)
+  if (gpioGetValue(CFG_LED_PORT, CFG_LED_PIN) == CFG_LED_OFF)
+  {
+    gpioSetValue (CFG_LED_PORT, CFG_LED_PIN, CFG_LED_ON); 
+  }
+  else
   {
-    __asm volatile ("nop");
-    delay--;
+    gpioSetValue (CFG_LED_PORT, CFG_LED_PIN, CFG_LED_OFF); 
   }
 }
 
+#ifdef CFG_INTERFACE
+static schedTask_t cmdTask;
+
+#ifdef CFG_WDT_SUPERVISOR
+static uint8_t cmdSupervisorId;
+#endif
+
+/**************************************************************************/
+/*! 
+    Polls for CLI input (runs every systick tick)
+*/
+/**************************************************************************/
+static void cmdTaskPoll(schedTask_t *task)
+{
+  #ifdef CFG_WDT_SUPERVISOR
+    supervisorCheckIn(cmdSupervisorId);
+  #endif
+
+  cmdPoll();
+}
+#endif
+#endif
+
 /**************************************************************************/
 /*! 
     Main program entry point.  After reset, normal code execution will
@@ -80,11 +131,48 @@ int main(void)
   // Configure cpu and mandatory peripherals
   systemInit();
 
-  uint32_t currentSecond, lastSecond;
+  #ifdef CFG_BENCH_AUTORUN
+    // 'make bench' firmware: give the terminal a moment to open the
+    // port, then print the results once ('M csv' prints them again)
+    char *benchArgs[] = { "csv" };
+    systickDelay(2000 / CFG_SYSTICK_DELAY_IN_MS);
+    cmd_bench(1, benchArgs);
+  #endif
+
+  #ifdef CFG_SCHEDULER
+    schedTaskInit(&ledTask, ledToggle, NULL);
+    schedStartTimer(&ledTask, 1000, 1000);
+    #ifdef CFG_WDT_SUPERVISOR
+      ledSupervisorId = supervisorRegister("LED", 2000);
+    #endif
+    #ifdef CFG_INTERFACE
+      schedTaskInit(&cmdTask, cmdTaskPoll, NULL);
+      schedStartTimer(&cmdTask, 0, CFG_SYSTICK_DELAY_IN_MS);
+      #ifdef CFG_WDT_SUPERVISOR
+        // Long enough for the slowest command to complete
+        cmdSupervisorId = supervisorRegister("CLI", 5000);
+      #endif
+    #endif
+
+    // Run tasks and sleep when idle (never returns)
+    schedRun();
+  #endif
+
+  uint32_t currentSecond, lastSecond, idleMs;
   currentSecond = lastSecond = 0;
 
   while (1)
   {
+    // Sleep until there is input for the CLI or the LED is due.  The
+    // USB mass storage and remote display polls below still need to
+    // run every tick.
+    #if defined CFG_USBCDC_MSC || (defined CFG_TFTLCD && defined CFG_TFTLCD_REMOTE && CFG_TFTLCD_REMOTE == 1)
+      idleMs = CFG_SYSTICK_DELAY_IN_MS;
+    #else
+      idleMs = 1000 - (uint32_t)(systickGetMicros64() / 1000 % 1000);
+    #endif
+    eventWaitAny(EVENT_SOURCE_UARTRX | EVENT_SOURCE_CDCOUT, idleMs);
+
     // Toggle LED once per second ... rollover = 136 years :)
     currentSecond = systickGetSecondsActive();
     if (currentSecond != lastSecond)
@@ -104,6 +192,16 @@ int main(void)
     #ifdef CFG_INTERFACE 
       cmdPoll(); 
     #endif
+
+    // Serve the USB mass storage interface (a scheduler task otherwise)
+    #ifdef CFG_USBCDC_MSC
+      MSC_Poll();
+    #endif
+
+    // Send screen updates to the remote display (a scheduler task otherwise)
+    #if defined CFG_TFTLCD && defined CFG_TFTLCD_REMOTE && CFG_TFTLCD_REMOTE == 1
+      lcdRemotePoll();
+    #endif
   }
 
   return 0;
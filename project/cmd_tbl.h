@@ -47,6 +47,15 @@
 
 // Function prototypes for the command table
 void cmd_help(uint8_t argc, char **argv);         // handled by core/cmd/cmd.c
+#if CFG_INTERFACE_BINARYMODE == 1
+void cmd_cmdmode(uint8_t argc, char **argv);      // handled by core/cmd/cmd.c
+#endif
+#if CFG_INTERFACE_CMDLISTSIZE > 0
+void cmd_cmdlist(uint8_t argc, char **argv);      // handled by core/cmd/cmd.c
+#endif
+#if CFG_INTERFACE_SCRIPTS == 1
+void cmd_script(uint8_t argc, char **argv);       // handled by core/cmd/cmd.c
+#endif
 void cmd_sysinfo(uint8_t argc, char **argv);
 
 #ifdef CFG_TFTLCD
@@ -65,6 +74,12 @@ void cmd_text(uint8_t argc, char **argv);
 void cmd_textw(uint8_t argc, char **argv);
 void cmd_tsthreshhold(uint8_t argc, char **argv);
 void cmd_tswait(uint8_t argc, char **argv);
+#if defined CFG_TFTLCD_STATS && CFG_TFTLCD_STATS == 1
+void cmd_lcdstats(uint8_t argc, char **argv);
+#endif
+#if defined CFG_TFTLCD_REMOTE && CFG_TFTLCD_REMOTE == 1
+void cmd_lcdremote(uint8_t argc, char **argv);
+#endif
 #ifdef CFG_SDCARD
 void cmd_bmp(uint8_t argc, char **argv);
 #endif
@@ -73,11 +88,14 @@ void cmd_bmp(uint8_t argc, char **argv);
 #ifdef CFG_CHIBI
 void cmd_chibi_addr(uint8_t argc, char **argv);
 void cmd_chibi_tx(uint8_t argc, char **argv);
+void cmd_chibi_scan(uint8_t argc, char **argv);
+void cmd_chibi_stats(uint8_t argc, char **argv);
 #endif
 
 #ifdef CFG_I2CEEPROM
 void cmd_i2ceeprom_read(uint8_t argc, char **argv);
 void cmd_i2ceeprom_write(uint8_t argc, char **argv);
+void cmd_eeprom_log(uint8_t argc, char **argv);
 void cmd_uart(uint8_t argc, char **argv);
 #endif
 
@@ -87,6 +105,25 @@ void cmd_lm75b_gettemp(uint8_t argc, char **argv);
 
 #ifdef CFG_SDCARD
 void cmd_sd_dir(uint8_t argc, char **argv);
+#if CFG_SDCARD_STATS == 1
+void cmd_sd_stats(uint8_t argc, char **argv);
+#endif
+#endif
+
+#ifdef CFG_BENCH
+void cmd_bench(uint8_t argc, char **argv);
+#endif
+
+#ifdef CFG_PROFILER
+void cmd_profiler(uint8_t argc, char **argv);
+#endif
+
+#ifdef CFG_ISRSTATS
+void cmd_isrstats(uint8_t argc, char **argv);
+#endif
+
+#ifdef CFG_TRACE
+void cmd_trace(uint8_t argc, char **argv);
 #endif
 
 #define CMD_NOPARAMS "This command has no parameters"
@@ -100,26 +137,43 @@ void cmd_sd_dir(uint8_t argc, char **argv);
     cause a NULL entry to be appended to the end of the table.
 */
 /**************************************************************************/
-cmd_t cmd_tbl[] = 
+const cmd_t cmd_tbl[] = 
 {
   // command name, min args, max args, hidden, function name, command description, syntax
   { "?",    0,  0,  0, cmd_help              , "Help"                           , CMD_NOPARAMS },
   { "V",    0,  0,  0, cmd_sysinfo           , "System Info"                    , CMD_NOPARAMS },
+  #if CFG_INTERFACE_BINARYMODE == 1
+  { "#",    0,  1,  1, cmd_cmdmode           , "Command Mode"                   , "'# [<0=text|1=binary>]'" },
+  #endif
+  #if CFG_INTERFACE_CMDLISTSIZE > 0
+  { "D",    0,  1,  0, cmd_cmdlist           , "Command List"                   , "'D [<1=record|0=stop>]' (no args runs the list)" },
+  #endif
+  #if CFG_INTERFACE_SCRIPTS == 1
+  { "X",    1,  1,  0, cmd_script            , "Run Script (SD Card)"           , "'X <file>'" },
+  #endif
 
   #ifdef CFG_I2CEEPROM
   { "e",    1,  1,  0, cmd_i2ceeprom_read    , "EEPROM Read"                    , "'e <addr>'" },
   { "w",    2,  2,  0, cmd_i2ceeprom_write   , "EEPROM Write"                   , "'w <addr> <val>'" },
-  { "U",    0,  1,  0, cmd_uart              , "UART baud rate"                 , "'U [<val>]'" },
+  { "j",    0,  1,  0, cmd_eeprom_log        , "Event Log"                      , "'j [<count>]' (0 clears the log)" },
+  { "U",    0,  1,  0, cmd_uart              , "UART baud rate"                 , "'U [<val>|auto]'" },
   #endif
 
   #ifdef CFG_TFTLCD
   { "b",    7,  99, 0, cmd_button            , "Button"                         , "'b <x> <y> <w> <h> <brdrclr> <fillclr> <fontclr> [<txt>]'" },
   #ifdef CFG_SDCARD
+  #if defined CFG_TFTLCD_JPEG && CFG_TFTLCD_JPEG == 1
+  { "B",    3,  4,  0, cmd_bmp               , "Bitmap/JPEG (SD Card)"          , "'B <x> <y> <file> [<scale 1|2|4|8>]' (scale is JPEG only)" },
+  #else
   { "B",    3,  3,  0, cmd_bmp               , "Bitmap (SD Card)"               , "'B <x> <y> <file>'" },
   #endif
+  #endif
   { "c",    4,  6,  0, cmd_circle            , "Circle"                         , "'c <x> <y> <radius> <color> [<filled[0|1]> <bcolor>]'" },
   { "C",    0,  0,  0, cmd_calibrate         , "Calibrate Touch Screen"         , CMD_NOPARAMS },
   { "F",    0,  1,  0, cmd_clear             , "Fill"                           , "'F [<color>]'" },
+  #if defined CFG_TFTLCD_STATS && CFG_TFTLCD_STATS == 1
+  { "g",    0,  1,  0, cmd_lcdstats          , "LCD Bus Stats"                  , "'g [0]' (0 clears the stats)" },
+  #endif
   { "l",    5,  7,  0, cmd_line              , "Line"                           , "'l <x1> <y1> <x2> <y2> <color> [<empty> <solid>]'" },
   { "o",    0,  1,  0, cmd_orientation       , "LCD Orientation"                , "'o [<0|1>]'" },
   { "p",    3,  3,  0, cmd_pixel             , "Draw Pixel"                     , "'p <x> <y> <color>'" },
@@ -129,6 +183,9 @@ cmd_t cmd_tbl[] =
   { "s",    2, 99,  0, cmd_textw             , "Text Width"                     , "'s <font#> <msg>'" },
   { "t",    5, 99,  0, cmd_text              , "Text"                           , "'t <x> <y> <color> <font#> <msg>'" },
   { "T",    0,  0,  0, cmd_gettext           , "Text Dialogue"                  , CMD_NOPARAMS },
+  #if defined CFG_TFTLCD_REMOTE && CFG_TFTLCD_REMOTE == 1
+  { "v",    0,  1,  0, cmd_lcdremote         , "Remote Display (USB)"           , "'v [<0|1>]'" },
+  #endif
   { "W",    0,  1,  0, cmd_tswait            , "Wait for Touch"                 , "'W [<ms>]'" },
   { "x",    0,  1,  0, cmd_tsthreshhold      , "Touch Threshold"                , "'x [<0..254>]'" },
   #endif
@@ -136,6 +193,10 @@ cmd_t cmd_tbl[] =
   #ifdef CFG_CHIBI
   { "A",    0,  1,  0, cmd_chibi_addr        , "Get/Set Node Address"           , "'A [<0x0..0xFFFE>]'" },
   { "S",    2, 99,  0, cmd_chibi_tx          , "Send Message"                   , "'S <destaddr> <msg>'" },
+  { "E",    0,  1,  0, cmd_chibi_scan        , "Energy Scan"                    , "'E [<1=move to quietest>]'" },
+  #if CFG_CHIBI_LINKSTATS > 0
+  { "L",    0,  1,  0, cmd_chibi_stats       , "Link Stats"                     , "'L [0]' (0 clears the stats)" },
+  #endif
   #endif
 
   #ifdef CFG_LM75B
@@ -144,6 +205,25 @@ cmd_t cmd_tbl[] =
 
   #ifdef CFG_SDCARD
   { "d",    0,  1,  0,  cmd_sd_dir           , "Dir (SD Card)"                  , "'d [<path>]'" },
+  #if CFG_SDCARD_STATS == 1
+  { "H",    0,  1,  0, cmd_sd_stats          , "SD Card Health"                 , "'H [0]' (0 clears the stats)" },
+  #endif
+  #endif
+
+  #ifdef CFG_BENCH
+  { "M",    0,  1,  0, cmd_bench             , "Benchmarks"                     , "'M [<test#>|csv]'" },
+  #endif
+
+  #ifdef CFG_PROFILER
+  { "z",    0,  1,  0, cmd_profiler          , "Profiler"                       , "'z [<0=stop|1=start|2=clear>]' (no args dumps)" },
+  #endif
+
+  #ifdef CFG_ISRSTATS
+  { "I",    0,  1,  0, cmd_isrstats          , "Interrupt Stats"                , "'I [0]' (0 clears the stats)" },
+  #endif
+
+  #ifdef CFG_TRACE
+  { "y",    0,  1,  0, cmd_trace             , "Trace Log"                      , "'y [<1=raw>]' (raw is for tools/tracedump)" },
   #endif
 };
 
@@ -0,0 +1,308 @@
+/**************************************************************************/
+/*! 
+    @file     cmd_bench.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Runs a set of benchmarks and displays the results as a
+              table (see core/bench/bench.c)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "projectconfig.h"
+#include "core/cmd/cmd.h"
+#include "core/cpu/cpu.h"
+#include "project/commands.h"       // Generic helper functions
+
+#ifdef CFG_BENCH
+  #include "core/bench/bench.h"
+
+#ifdef CFG_TFTLCD
+  #include "drivers/lcd/tft/lcd.h"
+  #include "drivers/lcd/tft/drawing.h"
+  #include "drivers/lcd/tft/fonts/dejavusans9.h"
+#endif
+
+#ifdef CFG_SDCARD
+  #include "core/ssp/ssp.h"
+  #include "drivers/fatfs/diskio.h"
+#endif
+
+#ifdef CFG_I2CEEPROM
+  #include "drivers/eeprom/mcp24aa/mcp24aa.h"
+#endif
+
+#define BENCH_SDSECTORS     (16)
+#define BENCH_CONSOLEBYTES  (512)
+
+// Board name in the 'M csv' results (tools/bench/<board>.txt)
+#if defined CFG_BRD_LPC1343_REFDESIGN
+  #define BENCH_BOARD       "refdesign"
+#elif defined CFG_BRD_LPC1343_TFTLCDSTANDALONE
+  #define BENCH_BOARD       "tftlcdstandalone"
+#elif defined CFG_BRD_LPC1343_802154USBSTICK
+  #define BENCH_BOARD       "802154usbstick"
+#else
+  #define BENCH_BOARD       "custom"
+#endif
+
+// Scratch buffer for the SD, SSP and I2C tests
+static uint8_t *_benchBuffer;
+
+typedef struct
+{
+  const char *name;
+  uint32_t iterations;
+  bool (*run)(void);          // Returns false if the test can't be run
+  uint32_t bytes;             // Bytes moved per iteration (0 = n/a)
+} benchTest_t;
+
+#ifdef CFG_TFTLCD
+static bool benchLcdFill(void)
+{
+  drawFill(COLOR_BLACK);
+  return true;
+}
+
+static bool benchText(void)
+{
+  drawString(0, 0, COLOR_WHITE, &dejaVuSans9ptFontInfo, "The quick brown fox jumps");
+  return true;
+}
+#endif
+
+#if defined CFG_TFTLCD && defined CFG_SDCARD
+static bool benchBmp(void)
+{
+  return drawBitmapImage(0, 0, "/bench.bmp") == BMP_ERROR_NONE;
+}
+#endif
+
+#ifdef CFG_SDCARD
+static bool benchSdRead(void)
+{
+  uint32_t sector;
+
+  if (disk_initialize(0) & (STA_NOINIT | STA_NODISK))
+  {
+    return false;
+  }
+  for (sector = 0; sector < BENCH_SDSECTORS; sector++)
+  {
+    if (disk_read(0, _benchBuffer, sector, 1) != RES_OK)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool benchSspSend(void)
+{
+  // The SD card's CS line isn't asserted, so this only clocks the bus
+  sspSend(0, _benchBuffer, 512);
+  return true;
+}
+#endif
+
+#ifdef CFG_I2CEEPROM
+static bool benchI2c(void)
+{
+  return mcp24aaReadBlock(0, _benchBuffer, 1) == MCP24AA_ERROR_OK;
+}
+#endif
+
+static bool benchConsole(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < BENCH_CONSOLEBYTES / 32; i++)
+  {
+    printf("................................");
+  }
+  printf("%s", CFG_PRINTF_NEWLINE);
+  return true;
+}
+
+static const benchTest_t _benchTests[] =
+{
+  // name, iterations, function, bytes per iteration
+  #ifdef CFG_TFTLCD
+  { "LCD Fill",       4, benchLcdFill, 0 },
+  { "Text",          10, benchText,    0 },
+  #endif
+  #if defined CFG_TFTLCD && defined CFG_SDCARD
+  { "BMP Load",       1, benchBmp,     0 },
+  #endif
+  #ifdef CFG_SDCARD
+  { "SD Seq Read",    1, benchSdRead,  BENCH_SDSECTORS * 512 },
+  { "SSP0 Send",      8, benchSspSend, 512 },
+  #endif
+  #ifdef CFG_I2CEEPROM
+  { "I2C EEPROM",    10, benchI2c,     1 },
+  #endif
+  { "Console",        1, benchConsole, BENCH_CONSOLEBYTES },
+};
+
+#define BENCH_COUNT (sizeof(_benchTests) / sizeof(benchTest_t))
+
+/**************************************************************************/
+/*! 
+    Prints the results in the machine-readable form compared by
+    tools/bench/benchcmp, one line per test:
+
+    BENCH,<board>,<version>,<MHz>,<timer>
+    BENCH,<#>,<test>,<iter>,<cycles/iter>,<us/iter>,<KB/s>
+    BENCH,END
+
+    Tests that couldn't be run have "skipped" instead of the numbers,
+    and "-" is used when the KB/s doesn't apply.
+*/
+/**************************************************************************/
+static void benchPrintCsv(const uint32_t *results)
+{
+  uint32_t i, perIter;
+  const benchTest_t *t;
+
+  printf("BENCH,%s,%d.%d.%d,%u,%s%s", BENCH_BOARD,
+         CFG_FIRMWARE_VERSION_MAJOR, CFG_FIRMWARE_VERSION_MINOR, CFG_FIRMWARE_VERSION_REVISION,
+         (unsigned int)(cpuGetClock() / 1000000), benchHasCycleCounter() ? "dwt" : "systick", CFG_PRINTF_NEWLINE);
+  for (i = 0; i < BENCH_COUNT; i++)
+  {
+    t = &_benchTests[i];
+    perIter = results[i];
+    if (perIter == 0xFFFFFFFF)
+    {
+      printf("BENCH,%d,%s,%u,skipped%s", (int)i, t->name, (unsigned int)t->iterations, CFG_PRINTF_NEWLINE);
+      continue;
+    }
+    printf("BENCH,%d,%s,%u,%u,%u,", (int)i, t->name, (unsigned int)t->iterations, (unsigned int)perIter, (unsigned int)benchCyclesToUs(perIter));
+    if (t->bytes && perIter)
+    {
+      printf("%u%s", (unsigned int)(t->bytes * (cpuGetClock() / 1024) / perIter), CFG_PRINTF_NEWLINE);
+    }
+    else
+    {
+      printf("-%s", CFG_PRINTF_NEWLINE);
+    }
+  }
+  printf("BENCH,END%s", CFG_PRINTF_NEWLINE);
+}
+
+/**************************************************************************/
+/*! 
+    'bench' command handler ('M csv' runs every test and prints the
+    results for tools/bench/benchcmp)
+*/
+/**************************************************************************/
+void cmd_bench(uint8_t argc, char **argv)
+{
+  uint8_t buffer[512];
+  uint32_t i, n, cycles, total, perIter;
+  int32_t test = -1;
+  uint32_t results[BENCH_COUNT];
+  const benchTest_t *t;
+  bool ok, csv = false;
+
+  if (argc > 0)
+  {
+    if (strcmp(argv[0], "csv") == 0)
+    {
+      csv = true;
+    }
+    else
+    {
+      getNumber(argv[0], &test);
+    }
+  }
+
+  _benchBuffer = buffer;
+  memset(buffer, 0xFF, sizeof(buffer));
+  benchInit();
+
+  // Run all of the tests first, so that the console test doesn't end
+  // up in the middle of the table
+  for (i = 0; i < BENCH_COUNT; i++)
+  {
+    results[i] = 0;
+    if (test >= 0 && (uint32_t)test != i)
+    {
+      continue;
+    }
+    t = &_benchTests[i];
+    ok = true;
+    total = 0;
+    for (n = 0; n < t->iterations && ok; n++)
+    {
+      BENCH_BEGIN(cycles);
+      ok = t->run();
+      BENCH_END(cycles);
+      total += cycles;
+    }
+    results[i] = ok ? total / t->iterations : 0xFFFFFFFF;
+  }
+
+  if (csv)
+  {
+    benchPrintCsv(results);
+    return;
+  }
+
+  printf("%sTimer: %s%s%s", CFG_PRINTF_NEWLINE, benchHasCycleCounter() ? "DWT CYCCNT" : "SysTick", CFG_PRINTF_NEWLINE, CFG_PRINTF_NEWLINE);
+  printf("#  %-15s %5s %12s %10s %8s%s", "Test", "Iter", "Cycles/Iter", "us/Iter", "KB/s", CFG_PRINTF_NEWLINE);
+  for (i = 0; i < BENCH_COUNT; i++)
+  {
+    if (test >= 0 && (uint32_t)test != i)
+    {
+      continue;
+    }
+    t = &_benchTests[i];
+    perIter = results[i];
+    if (perIter == 0xFFFFFFFF)
+    {
+      printf("%d  %-15s %5s%s", (int)i, t->name, "skipped", CFG_PRINTF_NEWLINE);
+      continue;
+    }
+    printf("%d  %-15s %5u %12u %10u ", (int)i, t->name, (unsigned int)t->iterations, (unsigned int)perIter, (unsigned int)benchCyclesToUs(perIter));
+    if (t->bytes && perIter)
+    {
+      printf("%8u%s", (unsigned int)(t->bytes * (cpuGetClock() / 1024) / perIter), CFG_PRINTF_NEWLINE);
+    }
+    else
+    {
+      printf("%8s%s", "-", CFG_PRINTF_NEWLINE);
+    }
+  }
+}
+
+#endif
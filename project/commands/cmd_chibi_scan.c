@@ -0,0 +1,85 @@
+/**************************************************************************/
+/*! 
+    @file     cmd_chibi_scan.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Code to execute for cmd_chibi_scan in the 'core/cmd'
+              command-line interpretter.
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <stdio.h>
+
+#include "projectconfig.h"
+#include "core/cmd/cmd.h"
+#include "project/commands.h"       // Generic helper functions
+
+#ifdef CFG_CHIBI
+  #include "drivers/chibi/chb.h"
+  #include "drivers/chibi/chb_drvr.h"
+
+/**************************************************************************/
+/*! 
+    Measures the energy on every channel of the current band and shows
+    the averaged ED level of each one (1dB steps, 0 = below the receiver
+    sensitivity).  With '1' the radio moves to the quietest channel.
+*/
+/**************************************************************************/
+void cmd_chibi_scan(uint8_t argc, char **argv)
+{
+  uint8_t i, best, ed[CHB_CHANNEL_LAST - CHB_CHANNEL_FIRST + 1];
+  int32_t select = 0;
+
+  if (argc > 0)
+  {
+    getNumber (argv[0], &select);
+  }
+
+  best = chb_scan(CHB_CHANNEL_FIRST, CHB_CHANNEL_LAST, ed);
+  for (i = 0; i <= CHB_CHANNEL_LAST - CHB_CHANNEL_FIRST; i++)
+  {
+    printf("Channel %2d: %3d%s%s", i + CHB_CHANNEL_FIRST, ed[i],
+           (i + CHB_CHANNEL_FIRST == chb_get_channel()) ? " (current)" : "",
+           CFG_PRINTF_NEWLINE);
+  }
+
+  if (select == 1)
+  {
+    chb_set_channel(best);
+    printf("Channel set to: %d%s", best, CFG_PRINTF_NEWLINE);
+  }
+  else
+  {
+    printf("Quietest channel: %d%s", best, CFG_PRINTF_NEWLINE);
+  }
+}
+
+#endif
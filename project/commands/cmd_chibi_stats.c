@@ -0,0 +1,105 @@
+/**************************************************************************/
+/*! 
+    @file     cmd_chibi_stats.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Code to execute for cmd_chibi_stats in the 'core/cmd'
+              command-line interpretter.
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <stdio.h>
+
+#include "projectconfig.h"
+#include "core/cmd/cmd.h"
+#include "project/commands.h"       // Generic helper functions
+
+#ifdef CFG_CHIBI
+  #include "drivers/chibi/chb.h"
+  #include "drivers/chibi/chb_drvr.h"
+
+#if CFG_CHIBI_LINKSTATS > 0
+/**************************************************************************/
+/*! 
+    Displays the global radio counters and the statistics of every
+    neighbour we've recently talked to: frames sent (and the share that
+    was acked), failures, average time on the air per frame in us
+    (including CSMA backoffs and retries), frames received, duplicates
+    (frames the neighbour had to retry) and the averaged ED and LQI.
+    'L 0' clears the table.
+*/
+/**************************************************************************/
+void cmd_chibi_stats(uint8_t argc, char **argv)
+{
+  uint8_t i;
+  uint16_t sent;
+  const chb_link_t *link;
+  chb_pcb_t *pcb = chb_get_pcb();
+
+  if (argc > 0)
+  {
+    int32_t clear;
+    getNumber (argv[0], &clear);
+    if (clear == 0)
+    {
+      chb_link_clear();
+      printf("Link stats cleared%s", CFG_PRINTF_NEWLINE);
+    }
+    return;
+  }
+
+  printf("TX OK: %u NOACK: %u CCA: %u  RX: %u OVF: %u UR: %u%s",
+         pcb->txd_success, pcb->txd_noack, pcb->txd_channel_fail,
+         pcb->rcvd_xfers, pcb->overflow, pcb->underrun, CFG_PRINTF_NEWLINE);
+  #ifdef CFG_CHIBI_ADAPTIVE
+  printf("Addr    Sent  OK%% NoAck  CCA   TxUs  Rcvd  Dupe  ED LQI PDR%% Pwr-%s", CFG_PRINTF_NEWLINE);
+  #else
+  printf("Addr    Sent  OK%% NoAck  CCA   TxUs  Rcvd  Dupe  ED LQI%s", CFG_PRINTF_NEWLINE);
+  #endif
+
+  for (i = 0; (link = chb_link_get(i)) != NULL; i++)
+  {
+    sent = link->tx_success + link->tx_noack + link->tx_channel_fail;
+    printf("0x%04X %5u %4u %5u %4u %6u %5u %5u %3u %3u",
+           link->addr, sent,
+           sent ? (uint16_t)((uint32_t)link->tx_success * 100 / sent) : 0,
+           link->tx_noack, link->tx_channel_fail, link->tx_us,
+           link->rx_frames, link->rx_dupes, link->ed, link->lqi);
+    #ifdef CFG_CHIBI_ADAPTIVE
+    // recent delivery ratio and the power steps below CFG_CHIBI_POWER
+    printf(" %4u %4u", (uint16_t)link->pdr * 100 / 255, link->pwr);
+    #endif
+    printf("%s", CFG_PRINTF_NEWLINE);
+  }
+}
+#endif
+
+#endif
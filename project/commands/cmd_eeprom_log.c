@@ -0,0 +1,84 @@
+/**************************************************************************/
+/*! 
+    @file     cmd_eeprom_log.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Lists the events in the EEPROM event log (see
+              drivers/eeprom/eepromlog.c)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+/**************************************************************************/
+#include <stdio.h>
+
+#include "projectconfig.h"
+#include "core/cmd/cmd.h"
+#include "project/commands.h"       // Generic helper functions
+
+#ifdef CFG_I2CEEPROM
+  #include "drivers/eeprom/eepromlog.h"
+
+/**************************************************************************/
+/*! 
+    Event log command handler ('j <count>' lists the most recent
+    events, 'j 0' clears the log)
+*/
+/**************************************************************************/
+void cmd_eeprom_log(uint8_t argc, char **argv)
+{
+  eepromLogEntry_t entry;
+  int32_t limit = EEPROMLOG_RECORDS;
+  uint16_t age;
+  uint8_t i;
+
+  if (argc > 0)
+  {
+    getNumber (argv[0], &limit);
+    if (limit == 0)
+    {
+      printf("%s%s", eepromLogClear() ? "Unable to clear the log" : "Log cleared", CFG_PRINTF_NEWLINE);
+      return;
+    }
+  }
+
+  printf("%u of %u events%s", eepromLogCount(), EEPROMLOG_RECORDS, CFG_PRINTF_NEWLINE);
+  for (age = 0; (age < limit) && (eepromLogRead(age, &entry) == EEPROMLOG_ERROR_OK); age++)
+  {
+    printf("%8u %10u ms  %04X ", (unsigned int)entry.sequence, (unsigned int)entry.timestamp, entry.event);
+    for (i = 0; i < EEPROMLOG_DATASIZE; i++)
+    {
+      printf(" %02X", entry.data[i]);
+    }
+    printf("%s", CFG_PRINTF_NEWLINE);
+  }
+}
+
+#endif
@@ -0,0 +1,85 @@
+/**************************************************************************/
+/*! 
+    @file     cmd_isrstats.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Displays the interrupt handler statistics
+              (see core/bench/isrstats.c)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <stdio.h>
+
+#include "projectconfig.h"
+#include "core/cmd/cmd.h"
+#include "project/commands.h"       // Generic helper functions
+
+#ifdef CFG_ISRSTATS
+  #include "core/bench/bench.h"
+  #include "core/bench/isrstats.h"
+
+/**************************************************************************/
+/*! 
+    'isrstats' command handler ('I 0' clears the statistics)
+*/
+/**************************************************************************/
+void cmd_isrstats(uint8_t argc, char **argv)
+{
+  isrStatEntry_t e;
+  uint32_t i;
+
+  if (argc > 0)
+  {
+    isrStatReset();
+    return;
+  }
+
+  printf("%-10s %10s %8s %8s %8s (cycles)%s", "Handler", "Count", "Min", "Avg", "Max", CFG_PRINTF_NEWLINE);
+  for (i = 0; i < isrStat_Last; i++)
+  {
+    isrStatGet(i, &e);
+    if (e.count)
+    {
+      printf("%-10s %10u %8u %8u %8u%s", isrStatGetName(i), (unsigned int)e.count, (unsigned int)e.min, (unsigned int)(e.total / e.count), (unsigned int)e.max, CFG_PRINTF_NEWLINE);
+    }
+    else
+    {
+      printf("%-10s %10u %8s %8s %8s%s", isrStatGetName(i), 0, "-", "-", "-", CFG_PRINTF_NEWLINE);
+    }
+  }
+  printf("%sMax IRQ masked (CHB_ENTER_CRIT) : %u cycles (%u us)%s", CFG_PRINTF_NEWLINE, (unsigned int)isrStatGetMaxCrit(), (unsigned int)benchCyclesToUs(isrStatGetMaxCrit()), CFG_PRINTF_NEWLINE);
+  if (!benchHasCycleCounter())
+  {
+    printf("Note: DWT cycle counter not available, using SysTick%s", CFG_PRINTF_NEWLINE);
+  }
+}
+
+#endif
@@ -0,0 +1,95 @@
+/**************************************************************************/
+/*! 
+    @file     cmd_profiler.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Controls the sampling profiler and dumps its histogram
+              (see core/timer32/profiler.c)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <stdio.h>
+
+#include "projectconfig.h"
+#include "core/cmd/cmd.h"
+#include "project/commands.h"       // Generic helper functions
+
+#ifdef CFG_PROFILER
+  #include "core/timer32/profiler.h"
+
+/**************************************************************************/
+/*! 
+    'profiler' command handler
+
+    'z 1' starts sampling, 'z 0' stops, 'z 2' clears the histogram and
+    'z' on its own lists every bucket with at least one sample as:
+
+    <start address> <samples>
+*/
+/**************************************************************************/
+void cmd_profiler(uint8_t argc, char **argv)
+{
+  int32_t action;
+  uint32_t i, count;
+
+  if (argc > 0)
+  {
+    getNumber(argv[0], &action);
+    switch (action)
+    {
+      case 0:
+        profilerStop();
+        break;
+      case 1:
+        profilerStart();
+        break;
+      case 2:
+        profilerClear();
+        break;
+      default:
+        printf("Invalid action%s", CFG_PRINTF_NEWLINE);
+        break;
+    }
+    return;
+  }
+
+  printf("Samples: %u (%u outside flash), %u Hz, %u byte buckets%s", (unsigned int)profilerGetSamples(), (unsigned int)profilerGetOutside(), CFG_PROFILER_RATE, PROFILER_BUCKETSIZE, CFG_PRINTF_NEWLINE);
+  for (i = 0; i < PROFILER_BUCKETS; i++)
+  {
+    count = profilerGetBucket(i);
+    if (count)
+    {
+      printf("0x%04X %u%s", (unsigned int)(i * PROFILER_BUCKETSIZE), (unsigned int)count, CFG_PRINTF_NEWLINE);
+    }
+  }
+}
+
+#endif
@@ -48,9 +48,12 @@
   #include "core/ssp/ssp.h"
   #include "drivers/fatfs/diskio.h"
   #include "drivers/fatfs/ff.h"
+  #include "drivers/fatfs/ffsync.h"
 
   static FILINFO Finfo;
-  static FATFS Fatfs[1];
+  #if _USE_LFN
+    static char Lfname[_MAX_LFN + 1];
+  #endif
 
 /**************************************************************************/
 /*! 
@@ -68,34 +71,27 @@ void cmd_sd_dir(uint8_t argc, char **argv)
   // Display root folder by default
   path = argc > 0 ? argv[0] : "/";
 
-  // Initialise SD Card
-  DSTATUS stat;
-  stat = disk_initialize(0);
-  if (stat & STA_NOINIT) 
+  // Initialise SD Card and mount the drive
+  BYTE res;
+  DIR dir;
+
+  res = ffSyncMount();
+  if (res == FR_NOT_READY) 
   {
     printf("SD init failed%s", CFG_PRINTF_NEWLINE);
   }
-  if (stat & STA_NODISK) 
+  else if (res != FR_OK) 
   {
-    printf("No SD card%s", CFG_PRINTF_NEWLINE);
+    printf("Failed to mount partition%s" , CFG_PRINTF_NEWLINE);
   }
-  if (stat == 0)
+  else
   {
-    BYTE res;
-    DIR dir;
-
-    // Try to mount drive
-    res = f_mount(0, &Fatfs[0]);
-    if (res != FR_OK) 
-    {
-      printf("Failed to mount partition%s" , CFG_PRINTF_NEWLINE);
-    }
-    if (res == FR_OK)
     {
       res = f_opendir(&dir, path);
       if (res) 
       {
           printf("Failed to open '%s' %s", path, CFG_PRINTF_NEWLINE);
+          ffSyncUnmount();
           return;
       }
 
@@ -106,19 +102,26 @@ void cmd_sd_dir(uint8_t argc, char **argv)
 
       // Read directory contents
       int folderBytes = 0;
+      char *name;
+      #if _USE_LFN
+        Finfo.lfname = Lfname;
+        Finfo.lfsize = sizeof(Lfname);
+      #endif
       for(;;) 
       {
           res = f_readdir(&dir, &Finfo);
           if ((res != FR_OK) || !Finfo.fname[0]) break;
-          #if _USE_LFN == 0
-            if (Finfo.fattrib & AM_DIR) 
-              printf(" <DIR> %-25s %s", (char *)&Finfo.fname[0], CFG_PRINTF_NEWLINE);
-            else
-              printf("       %-25s %12d Bytes %s", (char *)&Finfo.fname[0], (int)(Finfo.fsize), CFG_PRINTF_NEWLINE);
-              folderBytes += Finfo.fsize;
+          #if _USE_LFN
+            // Show the long name when the entry has one
+            name = *Finfo.lfname ? Finfo.lfname : Finfo.fname;
           #else
-            // ToDo
+            name = Finfo.fname;
           #endif
+          if (Finfo.fattrib & AM_DIR) 
+            printf(" <DIR> %-25s %s", name, CFG_PRINTF_NEWLINE);
+          else
+            printf("       %-25s %12d Bytes %s", name, (int)(Finfo.fsize), CFG_PRINTF_NEWLINE);
+          folderBytes += Finfo.fsize;
       }
 
       // Display folder size
@@ -127,17 +130,18 @@ void cmd_sd_dir(uint8_t argc, char **argv)
 
       // Get free disk space (only available if FATFS was compiled with _FS_MINIMIZE set to 0)
       #if _FS_MINIMIZE == 0 && _FS_READONLY == 0
-        FATFS *fs = &Fatfs[0];
-        DWORD clust;
+        DWORD freeKB, totalKB;
       
-        // Get free clusters
-        res = f_getfree("0:", &clust, &fs);
-    
-        // Display total and free space
-        printf("       %-25s %12d KB %s", "Disk Size: ", (int)((DWORD)(fs->max_clust - 2) * fs->csize / 2), CFG_PRINTF_NEWLINE);
-        printf("       %-25s %12d KB %s", "Space Available: ", (int)(clust * fs->csize / 2), CFG_PRINTF_NEWLINE);
+        // Get free space (cached by the driver, see ffsync.c)
+        if (ffSyncGetFree(&freeKB, &totalKB) == FR_OK)
+        {
+          // Display total and free space
+          printf("       %-25s %12d KB %s", "Disk Size: ", (int)totalKB, CFG_PRINTF_NEWLINE);
+          printf("       %-25s %12d KB %s", "Space Available: ", (int)freeKB, CFG_PRINTF_NEWLINE);
+        }
       #endif
     }
+    ffSyncUnmount();
   }
 }
 
@@ -0,0 +1,112 @@
+/**************************************************************************/
+/*! 
+    @file     cmd_sd_stats.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Displays the SD card latency histograms and error counters
+              (see MMC_GET_STATS in drivers/fatfs/mmc.c)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <stdio.h>
+
+#include "projectconfig.h"
+#include "core/cmd/cmd.h"
+#include "project/commands.h"       // Generic helper functions
+
+#if defined CFG_SDCARD && CFG_SDCARD_STATS == 1
+  #include "drivers/fatfs/diskio.h"
+
+static const char *cmd_sd_statsNames[SDSTAT_CLASSES] = 
+{
+  "CMD17", "CMD18", "CMD24", "CMD25", "Stream", "Busy"
+};
+
+/**************************************************************************/
+/*! 
+    SD card health command handler ('H 0' clears the stats)
+
+    Prints a latency histogram for each command class, with the upper
+    bound of each bucket in the header (u = microseconds, m = ms), and
+    the error and byte counters.  Multi-block commands are timed as a
+    whole, "Stream" is one block of a data log write stream and "Busy"
+    is the time the card held the bus busy before a command or while
+    erasing.  The longest writes show how much a write-behind buffer
+    (CFG_SDCARD_DATALOG) has to absorb.
+*/
+/**************************************************************************/
+void cmd_sd_stats(uint8_t argc, char **argv)
+{
+  DSTATS s;
+  uint32_t ub;
+  uint8_t c, b;
+
+  if (argc > 0)
+  {
+    disk_ioctl(0, MMC_CLEAR_STATS, 0);
+    return;
+  }
+
+  disk_ioctl(0, MMC_GET_STATS, &s);
+
+  // Header with the upper bound of every bucket
+  printf("%-6s %8s %8s ", "", "Count", "Max(us)");
+  for (b = 0; b < SDSTAT_BUCKETS - 1; b++)
+  {
+    ub = SDSTAT_BUCKET0_US << b;
+    if (ub < 1000)
+      printf("%4uu", (unsigned int)ub);
+    else
+      printf("%4um", (unsigned int)(ub / 1000));
+  }
+  printf("  more%s", CFG_PRINTF_NEWLINE);
+
+  for (c = 0; c < SDSTAT_CLASSES; c++)
+  {
+    printf("%-6s %8u %8u ", cmd_sd_statsNames[c], (unsigned int)s.count[c], (unsigned int)s.maxUs[c]);
+    for (b = 0; b < SDSTAT_BUCKETS; b++)
+    {
+      printf("%5u", (unsigned int)s.hist[c][b]);
+    }
+    printf("%s", CFG_PRINTF_NEWLINE);
+  }
+
+  printf("%s", CFG_PRINTF_NEWLINE);
+  printf("%-14s : %u KB%s", "Read", (unsigned int)(s.bytesRead / 1024), CFG_PRINTF_NEWLINE);
+  printf("%-14s : %u KB%s", "Written", (unsigned int)(s.bytesWritten / 1024), CFG_PRINTF_NEWLINE);
+  printf("%-14s : %u%s", "Cmd errors", (unsigned int)s.cmdErrors, CFG_PRINTF_NEWLINE);
+  printf("%-14s : %u%s", "Token errors", (unsigned int)s.tokenErrors, CFG_PRINTF_NEWLINE);
+  printf("%-14s : %u%s", "CRC errors", (unsigned int)s.crcErrors, CFG_PRINTF_NEWLINE);
+  printf("%-14s : %u%s", "Write errors", (unsigned int)s.writeErrors, CFG_PRINTF_NEWLINE);
+  printf("%-14s : %u%s", "Busy timeouts", (unsigned int)s.busyTimeouts, CFG_PRINTF_NEWLINE);
+}
+
+#endif
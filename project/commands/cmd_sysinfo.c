@@ -40,8 +40,11 @@
 
 #include "projectconfig.h"
 #include "core/cmd/cmd.h"
+#include "core/cpu/cpu.h"
 #include "core/systick/systick.h"
 #include "core/iap/iap.h"
+#include "core/stack/stack.h"
+#include "sysinit.h"
 #include "project/commands.h"       // Generic helper functions
 
 #ifdef CFG_CHIBI
@@ -61,8 +64,21 @@
   #include "drivers/lcd/tft/lcd.h"
 #endif
 
+#ifdef CFG_SCHEDULER_DEEPSLEEP
+  #include "core/pmu/pmu.h"
+#endif
+
+#ifdef CFG_CLKGATE
+  #include "core/clkgate/clkgate.h"
+#endif
+
+#ifdef CFG_WDT_SUPERVISOR
+  #include "core/wdt/supervisor.h"
+#endif
+
 #ifdef CFG_SDCARD
   #include "core/gpio/gpio.h"
+  #include "drivers/fatfs/diskio.h"
 #endif
 
 /**************************************************************************/
@@ -74,7 +90,7 @@ void cmd_sysinfo(uint8_t argc, char **argv)
 {
   IAP_return_t iap_return;
 
-  printf("%-25s : %d.%d MHz %s", "System Clock", CFG_CPU_CCLK / 1000000, CFG_CPU_CCLK % 1000000, CFG_PRINTF_NEWLINE);
+  printf("%-25s : %d.%d MHz %s", "System Clock", cpuGetClock() / 1000000, cpuGetClock() % 1000000, CFG_PRINTF_NEWLINE);
   printf("%-25s : v%d.%d.%d %s", "Firmware", CFG_FIRMWARE_VERSION_MAJOR, CFG_FIRMWARE_VERSION_MINOR, CFG_FIRMWARE_VERSION_REVISION, CFG_PRINTF_NEWLINE);
 
   // 128-bit MCU Serial Number
@@ -84,9 +100,34 @@ void cmd_sysinfo(uint8_t argc, char **argv)
     printf("%-25s : %08X %08X %08X %08X %s", "Serial Number", iap_return.Result[0],iap_return.Result[1],iap_return.Result[2],iap_return.Result[3], CFG_PRINTF_NEWLINE);
   }
 
+  // SRAM usage (the stack peak is the deepest it has been since reset)
+  uint32_t stackSize = stackGetSize();
+  uint32_t stackPeak = stackGetPeak();
+  printf("%-25s : %u bytes %s", "Reserved RAM (USB)", (unsigned int)stackGetReservedSize(), CFG_PRINTF_NEWLINE);
+  printf("%-25s : %u bytes %s", "Static RAM", (unsigned int)stackGetStaticSize(), CFG_PRINTF_NEWLINE);
+  printf("%-25s : %u of %u bytes %s", "Stack Peak", (unsigned int)stackPeak, (unsigned int)stackSize, CFG_PRINTF_NEWLINE);
+  printf("%-25s : %u bytes %s", "Free RAM", (unsigned int)(stackSize - stackPeak), CFG_PRINTF_NEWLINE);
+
   // CLI and buffer Settings
   #ifdef CFG_INTERFACE
     printf("%-25s : %d bytes %s", "Max CLI Command", CFG_INTERFACE_MAXMSGSIZE, CFG_PRINTF_NEWLINE);
+    #if CFG_INTERFACE_CMDLISTSIZE > 0
+    printf("%-25s : %d bytes %s", "CLI Command List", CFG_INTERFACE_CMDLISTSIZE, CFG_PRINTF_NEWLINE);
+    #endif
+  #endif
+
+  #ifdef CFG_PRINTF_UART
+    printf("%-25s : %d/%d bytes %s", "UART RX/TX Buffers", CFG_UART_BUFSIZE, CFG_UART_TXBUFSIZE, CFG_PRINTF_NEWLINE);
+  #endif
+
+  #if defined CFG_TFTLCD && defined CFG_TFTLCD_TILEBUFFER && CFG_TFTLCD_TILEBUFFER > 0
+    printf("%-25s : %d bytes %s", "LCD Tile Buffer", CFG_TFTLCD_TILEBUFFER * 2, CFG_PRINTF_NEWLINE);
+  #endif
+
+  #ifdef CFG_POOL
+    printf("%-25s : %d bytes %s", "Memory Pool",
+           CFG_POOL_SMALLSIZE * CFG_POOL_SMALLCOUNT + CFG_POOL_MEDIUMSIZE * CFG_POOL_MEDIUMCOUNT + CFG_POOL_LARGESIZE * CFG_POOL_LARGECOUNT,
+           CFG_PRINTF_NEWLINE);
   #endif
 
   #ifdef CFG_PRINTF_UART
@@ -112,6 +153,38 @@ void cmd_sysinfo(uint8_t argc, char **argv)
   // System Uptime (based on systick timer)
   printf("%-25s : %u s %s", "System Uptime", (unsigned int)systickGetSecondsActive(), CFG_PRINTF_NEWLINE);
 
+  // Time at which each boot phase finished
+  const sysinitPhase_t *phases;
+  uint8_t phaseCount = systemGetBootPhases(&phases);
+  uint8_t i;
+  for (i = 0; i < phaseCount; i++)
+  {
+    printf("Boot: %-19s : %u us %s", phases[i].name, (unsigned int)phases[i].timeUs, CFG_PRINTF_NEWLINE);
+  }
+
+  #ifdef CFG_SCHEDULER_DEEPSLEEP
+    printf("%-25s : %u us %s", "Last Wake-up", (unsigned int)pmuGetWakeLatency(), CFG_PRINTF_NEWLINE);
+  #endif
+
+  #ifdef CFG_WDT_SUPERVISOR
+    // Task that stalled before the last watchdog reset (if any)
+    uint8_t stalled = supervisorGetLastStalled();
+    if (stalled == SUPERVISOR_NONE)
+    {
+      printf("%-25s : %s %s", "Last Stalled Task", "None", CFG_PRINTF_NEWLINE);
+    }
+    else
+    {
+      const char *name = supervisorGetName(stalled);
+      printf("%-25s : %d (%s) %s", "Last Stalled Task", stalled, name ? name : "?", CFG_PRINTF_NEWLINE);
+    }
+  #endif
+
+  #ifdef CFG_CLKGATE
+    // Rough estimate from core/clkgate/clkgate.c
+    printf("%-25s : ~%u uA %s", "Peripheral Current", (unsigned int)clkgateGetCurrent(), CFG_PRINTF_NEWLINE);
+  #endif
+
   // System Temperature (if LM75B Present)
   #ifdef CFG_LM75B
     int32_t temp = 0;
@@ -122,5 +195,11 @@ void cmd_sysinfo(uint8_t argc, char **argv)
 
   #ifdef CFG_SDCARD
     printf("%-25s : %s %s", "SD Card Present", gpioGetValue(CFG_SDCARD_CDPORT, CFG_SDCARD_CDPIN) ? "True" : "False", CFG_PRINTF_NEWLINE);
+    // SPI clock negotiated with the card (once it's been initialised)
+    uint32_t sdClock = 0;
+    if ((disk_ioctl(0, MMC_GET_CLOCK, &sdClock) == RES_OK) && sdClock)
+    {
+      printf("%-25s : %u kHz %s", "SD Card SPI Clock", (unsigned int)(sdClock / 1000), CFG_PRINTF_NEWLINE);
+    }
   #endif
 }
@@ -37,6 +37,7 @@
 */
 /**************************************************************************/
 #include <stdio.h>
+#include <string.h>
 
 #include "projectconfig.h"
 #include "core/cmd/cmd.h"
@@ -45,30 +46,63 @@
 #ifdef CFG_I2CEEPROM
   #include "drivers/eeprom/eeprom.h"
   #include "core/uart/uart.h"
+  #include "core/cpu/cpu.h"
 
 /**************************************************************************/
 /*! 
-    Gets or sets the UART speed from EEPROM.
+    Gets or sets the UART speed from EEPROM.  'auto' measures the rate
+    of the terminal with the UART's auto-baud hardware.
 */
 /**************************************************************************/
 void cmd_uart(uint8_t argc, char **argv)
 {
   if (argc > 0)
   {
-    // Try to convert supplied value to an integer
     int32_t speed;
+
+    #ifdef CFG_PRINTF_UART
+    if (!strcmp(argv[0], "auto"))
+    {
+      // Measure the terminal's rate from an 'A' sent at the new speed
+      printf("Change the terminal's baud rate and send 'A' within 10s%s", CFG_PRINTF_NEWLINE);
+      speed = uartAutoBaud(10000);
+      if (!speed)
+      {
+        printf("No baud rate detected%s", CFG_PRINTF_NEWLINE);
+        return;
+      }
+      printf("Detected baud rate: %d%s", (int)speed, CFG_PRINTF_NEWLINE);
+      eepromWriteU32(CFG_EEPROM_UART_SPEED, speed);
+      eepromFlush();
+      return;
+    }
+    #endif
+
+    // Try to convert supplied value to an integer
     getNumber (argv[0], &speed);
     
     // Check for invalid values (getNumber may complain about this as well)
-    if (speed < 9600 || speed  > 115200)
+    if (speed < UART_BAUDRATE_MIN || speed > UART_BAUDRATE_MAX)
+    {
+      printf("Invalid baud rate: %d-%d required.%s", UART_BAUDRATE_MIN, UART_BAUDRATE_MAX, CFG_PRINTF_NEWLINE);
+      return;
+    }
+
+    // Make sure the divisors can get close enough at the current clock
+    uint32_t actual = uartGetClosestBaudrate(speed);
+    uint32_t error = actual > (uint32_t)speed ? actual - speed : speed - actual;
+    error = (uint32_t)(((uint64_t)error * 1000) / speed);
+    if (!actual || error > UART_BAUDERROR_MAX)
     {
-      printf("Invalid baud rate: 9600-115200 required.%s", CFG_PRINTF_NEWLINE);
+      printf("Baud rate not reachable at %d MHz (closest: %u)%s", (int)(cpuGetClock() / 1000000), (unsigned int)actual, CFG_PRINTF_NEWLINE);
       return;
     }
 
     // Write baud rate to EEPROM and reinitialise UART if using it
-    printf("Setting UART to: %d%s", (int)speed, CFG_PRINTF_NEWLINE);
+    printf("Setting UART to: %d (actual %u, %u.%u%% error)%s", (int)speed, (unsigned int)actual,
+           (unsigned int)(error / 10), (unsigned int)(error % 10), CFG_PRINTF_NEWLINE);
     eepromWriteU32(CFG_EEPROM_UART_SPEED, speed);
+    eepromFlush();
     #ifdef CFG_PRINTF_UART
     uartInit(speed);
     #endif
@@ -37,6 +37,8 @@
 */
 /**************************************************************************/
 #include <stdio.h>
+#include <string.h>
+#include <ctype.h>
 
 #include "projectconfig.h"
 #include "core/cmd/cmd.h"
@@ -46,6 +48,70 @@
   #include "drivers/lcd/tft/lcd.h"    
   #include "drivers/lcd/tft/drawing.h"  
 
+#if defined CFG_TFTLCD_JPEG && CFG_TFTLCD_JPEG == 1
+/**************************************************************************/
+/*! 
+    Returns true if the filename ends in '.jpg' or '.jpeg'
+*/
+/**************************************************************************/
+static bool cmd_bmp_isjpeg(const char *filename)
+{
+  const char *ext = strrchr(filename, '.');
+  char lower[6];
+  uint8_t i;
+
+  if ((ext == NULL) || (strlen(ext) > 5))
+    return false;
+
+  for (i = 0; ext[i]; i++)
+    lower[i] = tolower((unsigned char)ext[i]);
+  lower[i] = '\0';
+
+  return !strcmp(lower, ".jpg") || !strcmp(lower, ".jpeg");
+}
+
+/**************************************************************************/
+/*! 
+    Displays a JPEG image on the LCD, scaled down by 1, 2, 4 or 8.
+*/
+/**************************************************************************/
+static void cmd_bmp_jpeg(int32_t x, int32_t y, char *filename, int32_t scale)
+{
+  jpeg_error_t error;
+  if ((scale < 1) || (scale > 8))
+    error = JPEG_ERROR_INVALIDSCALE;
+  else
+    error = drawJpegImage(x, y, filename, scale);
+
+  switch (error)
+  {
+    case JPEG_ERROR_SDINITFAIL:
+      printf("SD Init Failed%s", CFG_PRINTF_NEWLINE);
+      break;
+    case JPEG_ERROR_FILENOTFOUND:
+      printf("File Not Found: '%s'%s", filename, CFG_PRINTF_NEWLINE);
+      break;
+    case JPEG_ERROR_NOTAJPEG:
+      printf("Not a JPEG: '%s'%s", filename, CFG_PRINTF_NEWLINE);
+      break;
+    case JPEG_ERROR_UNSUPPORTED:
+      printf("Only Baseline JPEGs Supported%s", CFG_PRINTF_NEWLINE);
+      break;
+    case JPEG_ERROR_INVALIDSCALE:
+      printf("Scale must be 1, 2, 4 or 8%s", CFG_PRINTF_NEWLINE);
+      break;
+    case JPEG_ERROR_PREMATUREEOF:
+      printf("Premature EOF%s", CFG_PRINTF_NEWLINE);
+      break;
+    case JPEG_ERROR_INVALIDDATA:
+      printf("Corrupt Image Data%s", CFG_PRINTF_NEWLINE);
+      break;
+    case JPEG_ERROR_NONE:
+      break;
+  }
+}
+#endif
+
 /**************************************************************************/
 /*! 
     Displays a bitmap image on the LCD.
@@ -61,6 +127,25 @@ void cmd_bmp(uint8_t argc, char **argv)
   getNumber (argv[1], &y);
   filename = argv[2];
 
+  #if defined CFG_TFTLCD_JPEG && CFG_TFTLCD_JPEG == 1
+  // JPEG images can be scaled down while they are decoded
+  int32_t scale = 1;
+  if (argc == 4)
+  {
+    getNumber (argv[3], &scale);
+  }
+  if (cmd_bmp_isjpeg(filename))
+  {
+    cmd_bmp_jpeg(x, y, filename, scale);
+    return;
+  }
+  if (scale != 1)
+  {
+    printf("Only JPEG images can be scaled%s", CFG_PRINTF_NEWLINE);
+    return;
+  }
+  #endif
+
   // Render image
   bmp_error_t error;
   error = drawBitmapImage(x, y, filename);
@@ -0,0 +1,80 @@
+/**************************************************************************/
+/*! 
+    @file     cmd_lcdremote.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Code to execute for cmd_lcdremote in the 'core/cmd'
+              command-line interpretter.
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <stdio.h>
+
+#include "projectconfig.h"
+#include "core/cmd/cmd.h"
+#include "project/commands.h"       // Generic helper functions
+
+#if defined CFG_TFTLCD && defined CFG_TFTLCD_REMOTE && CFG_TFTLCD_REMOTE == 1
+  #include "drivers/lcd/tft/lcdremote.h"
+
+/**************************************************************************/
+/*! 
+    Starts ('v 1') or stops ('v 0') mirroring the screen to the host
+    over USB, or shows whether it is running.  Starting it again sends
+    the whole screen.
+*/
+/**************************************************************************/
+void cmd_lcdremote(uint8_t argc, char **argv)
+{
+  int32_t enable;
+
+  if (argc > 0)
+  {
+    getNumber (argv[0], &enable);
+    if ((enable < 0) || (enable > 1))
+    {
+      printf("Invalid value: Enter 0 or 1%s", CFG_PRINTF_NEWLINE);
+      return;
+    }
+    if (enable)
+    {
+      lcdRemoteStart();
+    }
+    else
+    {
+      lcdRemoteStop();
+    }
+  }
+
+  printf("Remote display %s%s", lcdRemoteIsActive() ? "on" : "off", CFG_PRINTF_NEWLINE);
+}
+
+#endif
@@ -0,0 +1,76 @@
+/**************************************************************************/
+/*! 
+    @file     cmd_lcdstats.c
+    @author   K. Townsend (microBuilder.eu)
+
+    @brief    Code to execute for cmd_lcdstats in the 'core/cmd'
+              command-line interpretter.
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2010, microBuilder SARL
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "projectconfig.h"
+#include "core/cmd/cmd.h"
+#include "project/commands.h"       // Generic helper functions
+
+#if defined CFG_TFTLCD && defined CFG_TFTLCD_STATS && CFG_TFTLCD_STATS == 1
+  #include "drivers/lcd/tft/lcd.h"
+
+/**************************************************************************/
+/*! 
+    Shows the LCD bus traffic counters since the last reset ('g 0'
+    clears them).  A lot of cursor updates compared to the amount of
+    data written points to pixel-by-pixel drawing.
+*/
+/**************************************************************************/
+void cmd_lcdstats(uint8_t argc, char **argv)
+{
+  lcdStats_t s = lcdStats;
+
+  if (argc > 0)
+  {
+    memset(&lcdStats, 0, sizeof(lcdStats));
+    return;
+  }
+
+  printf("%-12s : %u%s", "Commands", (unsigned int)s.commands, CFG_PRINTF_NEWLINE);
+  printf("%-12s : %u%s", "Cursor sets", (unsigned int)s.cursorSets, CFG_PRINTF_NEWLINE);
+  printf("%-12s : %u%s", "Data written", (unsigned int)s.dataWritten, CFG_PRINTF_NEWLINE);
+  printf("%-12s : %u%s", "Data read", (unsigned int)s.dataRead, CFG_PRINTF_NEWLINE);
+  if (s.cursorSets)
+  {
+    printf("%-12s : %u%s", "Data/cursor", (unsigned int)(s.dataWritten / s.cursorSets), CFG_PRINTF_NEWLINE);
+  }
+}
+
+#endif
@@ -83,10 +83,15 @@
 
     SDCARD      .     .     .     .       X       . . . .     .
     PWM         .     X     .     .       .       . . . .     .
+    CAPTURE     .     .     X     .       .       . . . .     .
     PMU [1]     .     .     X     .       .       . . . .     .
     USB         .     .     .     X       .       . . . .     .
-    STEPPER     .     .     X     .       .       . . . .     .
-    CHIBI       x     .     .     .       X       . . . .     .
+    STEPPER     .     x[6]  X     .       .       . . . .     .
+    SWTIMER     .     .     .     X       .       . . . .     .
+    CHIBI       .     .     x[3]  .       X       . . . .     .
+    ADC         .     .     x[4]  .       .       . . . .     .
+    MCP4725     x[5]  .     .     .       .       . . . .     .
+    LOGIC       X     .     .     .       .       . . . .     .
     ILI9325/8   .     .     .     .       .       X X X X     .
     ST7565      .     .     .     .       .       X X X X     .
     ST7535      .     .     .     .       .       . . . .     .
@@ -97,6 +102,11 @@
          can safely be used by other peripherals, but may need to be
          reconfigured when you wakeup from deep-sleep.
     [2]  INTERFACE can be configured to use either USBCDC or UART
+    [3]  Only with CFG_CHIBI_TIMESTAMP
+    [4]  Only with CFG_ADC_TRIGGER
+    [5]  Only with CFG_MCP4725_STREAM
+    [6]  Only with CFG_STEPPER_MICROSTEPS > 1, which also uses pins 1.9
+         and 1.10
 
  **************************************************************************/
 
@@ -134,6 +144,74 @@
 /*=========================================================================*/
 
 
+/*=========================================================================
+    INTERRUPT PRIORITIES
+    -----------------------------------------------------------------------
+
+    The LPC1343 has 8 interrupt priority levels (0 is the highest).  Each
+    driver sets its interrupt's priority from these values when it is
+    initialised, so that a long handler (USB, SSP) can be preempted by
+    the ones whose latency matters (the radio, UART RX, the timers).
+    Giving everything the same value means no handler can preempt
+    another.  Level 0 isn't used by default: nothing can mask it except
+    __disable_irq, which makes it the place for anything that must never
+    be held off (the profiler uses it while it samples).
+
+    CFG_IRQ_SUBPRIOBITS       How many of the three priority bits are a
+                              sub-priority (0..2).  Interrupts that only
+                              differ in the sub-priority can't preempt
+                              each other, it only decides which runs
+                              first when both are pending.  With 1, for
+                              example, 0/1, 2/3, 4/5 and 6/7 are four
+                              preemption levels.
+    CFG_IRQPRIO_RADIO         GPIO port 1, where the Chibi radio's IRQ
+                              pin (and the touchscreen pen IRQ) is.
+                              CHB_ENTER_CRIT masks this level and the
+                              ones below it with BASEPRI, so it can't be
+                              in the highest preemption level.
+    CFG_IRQPRIO_UART          The UART
+    CFG_IRQPRIO_TIMER         The 16 and 32-bit timers
+    CFG_IRQPRIO_SYSTICK       The systick timer
+    CFG_IRQPRIO_GPIO          GPIO ports 0, 2 and 3
+    CFG_IRQPRIO_PERIPH        SSP, I2C, ADC and the watchdog
+    CFG_IRQPRIO_USB           USB (and the USB FIQ)
+
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      #define CFG_IRQ_SUBPRIOBITS         (0)
+      #define CFG_IRQPRIO_RADIO           (1)
+      #define CFG_IRQPRIO_UART            (2)
+      #define CFG_IRQPRIO_TIMER           (3)
+      #define CFG_IRQPRIO_SYSTICK         (4)
+      #define CFG_IRQPRIO_GPIO            (5)
+      #define CFG_IRQPRIO_PERIPH          (5)
+      #define CFG_IRQPRIO_USB             (6)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      #define CFG_IRQ_SUBPRIOBITS         (0)
+      #define CFG_IRQPRIO_RADIO           (1)
+      #define CFG_IRQPRIO_UART            (2)
+      #define CFG_IRQPRIO_TIMER           (3)
+      #define CFG_IRQPRIO_SYSTICK         (4)
+      #define CFG_IRQPRIO_GPIO            (5)
+      #define CFG_IRQPRIO_PERIPH          (5)
+      #define CFG_IRQPRIO_USB             (6)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      #define CFG_IRQ_SUBPRIOBITS         (0)
+      #define CFG_IRQPRIO_RADIO           (1)
+      #define CFG_IRQPRIO_UART            (2)
+      #define CFG_IRQPRIO_TIMER           (3)
+      #define CFG_IRQPRIO_SYSTICK         (4)
+      #define CFG_IRQPRIO_GPIO            (5)
+      #define CFG_IRQPRIO_PERIPH          (5)
+      #define CFG_IRQPRIO_USB             (6)
+    #endif
+/*=========================================================================*/
+
+
 /*=========================================================================
     SYSTICK TIMER
     -----------------------------------------------------------------------
@@ -156,6 +234,221 @@
 /*=========================================================================*/
 
 
+/*=========================================================================
+    SCHEDULER
+    -----------------------------------------------------------------------
+
+    CFG_SCHEDULER             If this field is defined, main.c runs the
+                              LED and CLI polling as tasks on the
+                              cooperative scheduler in core/sched, and
+                              the core sleeps in WFI between ticks
+                              instead of spinning in the main loop.
+    CFG_SCHEDULER_TICKLESS    If this field is defined, the scheduler
+                              stops the systick interrupt when idle and
+                              sleeps until the next timer deadline using
+                              a match on 32-bit timer 1, then adds the
+                              time spent asleep to the tick counter.  Any
+                              task that runs every tick (the CLI polling
+                              task in main.c, for example) keeps the core
+                              from sleeping for more than a tick.
+    CFG_SCHEDULER_TICKLESS_MAXMS  The longest tickless sleep in
+                              milliseconds (used when no timer is
+                              running).  Must be below 59000 at 72MHz.
+    CFG_SCHEDULER_DEEPSLEEP   If this field is defined, idle periods of
+                              one second or more are spent in deep-sleep
+                              mode (pmuDeepSleep) rather than sleep mode.
+                              UART and USB can't receive in deep-sleep,
+                              and only whole seconds are slept.
+    CFG_SCHEDULER_DEFERINIT   If this field is defined, systemInit only
+                              brings up the mandatory peripherals and the
+                              CLI, and leaves the displays, Chibi and USB
+                              enumeration (unless printf uses USB CDC) to
+                              a scheduler task that runs one step at a
+                              time alongside the other tasks.  Commands
+                              that use those peripherals must not run
+                              before systemBootComplete returns true.
+
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      #define CFG_SCHEDULER
+      // #define CFG_SCHEDULER_TICKLESS
+      #define CFG_SCHEDULER_TICKLESS_MAXMS  (10000)
+      // #define CFG_SCHEDULER_DEEPSLEEP
+      #define CFG_SCHEDULER_DEFERINIT
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      #define CFG_SCHEDULER
+      // #define CFG_SCHEDULER_TICKLESS
+      #define CFG_SCHEDULER_TICKLESS_MAXMS  (10000)
+      // #define CFG_SCHEDULER_DEEPSLEEP
+      #define CFG_SCHEDULER_DEFERINIT
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      #define CFG_SCHEDULER
+      // #define CFG_SCHEDULER_TICKLESS
+      #define CFG_SCHEDULER_TICKLESS_MAXMS  (10000)
+      // #define CFG_SCHEDULER_DEEPSLEEP
+      #define CFG_SCHEDULER_DEFERINIT
+    #endif
+/*=========================================================================*/
+
+
+/*=========================================================================
+    SOFTWARE TIMERS
+    -----------------------------------------------------------------------
+
+    CFG_SWTIMER               If this field is defined, 32-bit timer 1
+                              counts microseconds and runs any number of
+                              one-shot and periodic callbacks from a
+                              single match register (see
+                              core/timer32/swtimer.c).  Can't be used with
+                              CFG_USBHID, CFG_PROFILER or
+                              CFG_SCHEDULER_TICKLESS (which all need
+                              timer 1).
+
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      // #define CFG_SWTIMER
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      // #define CFG_SWTIMER
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      // #define CFG_SWTIMER
+    #endif
+/*=========================================================================*/
+
+
+/*=========================================================================
+    MEMORY POOL
+    -----------------------------------------------------------------------
+
+    CFG_POOL                  If this field is defined, core/pool/pool.c
+                              provides fixed-size blocks for temporary
+                              buffers (poolAlloc/poolFree), and the CLI
+                              takes its argument lists from the pool
+                              instead of the stack.  Allocation and
+                              release take a fixed time and are safe in
+                              interrupt handlers.
+    CFG_POOL_SMALLSIZE        Size in bytes of the small blocks
+    CFG_POOL_SMALLCOUNT       Number of small blocks
+    CFG_POOL_MEDIUMSIZE       Size in bytes of the medium blocks
+    CFG_POOL_MEDIUMCOUNT      Number of medium blocks
+    CFG_POOL_LARGESIZE        Size in bytes of the large blocks
+    CFG_POOL_LARGECOUNT       Number of large blocks
+
+                              Sizes must be multiples of 4 and in
+                              increasing order, and each count must be
+                              between 1 and 255.  The pool uses the sum
+                              of size * count for each class in SRAM
+                              (1536 bytes with the values below), so
+                              keep the counts to what the application
+                              needs at once.
+
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      // #define CFG_POOL
+      #define CFG_POOL_SMALLSIZE    (32)
+      #define CFG_POOL_SMALLCOUNT   (8)
+      #define CFG_POOL_MEDIUMSIZE   (128)
+      #define CFG_POOL_MEDIUMCOUNT  (4)
+      #define CFG_POOL_LARGESIZE    (512)
+      #define CFG_POOL_LARGECOUNT   (1)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      // #define CFG_POOL
+      #define CFG_POOL_SMALLSIZE    (32)
+      #define CFG_POOL_SMALLCOUNT   (8)
+      #define CFG_POOL_MEDIUMSIZE   (128)
+      #define CFG_POOL_MEDIUMCOUNT  (4)
+      #define CFG_POOL_LARGESIZE    (512)
+      #define CFG_POOL_LARGECOUNT   (1)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      // #define CFG_POOL
+      #define CFG_POOL_SMALLSIZE    (32)
+      #define CFG_POOL_SMALLCOUNT   (8)
+      #define CFG_POOL_MEDIUMSIZE   (128)
+      #define CFG_POOL_MEDIUMCOUNT  (4)
+      #define CFG_POOL_LARGESIZE    (512)
+      #define CFG_POOL_LARGECOUNT   (1)
+    #endif
+/*=========================================================================*/
+
+
+/*=========================================================================
+    CLOCK GATING
+    -----------------------------------------------------------------------
+
+    CFG_CLKGATE               If this field is defined, core/clkgate
+                              turns off the clock (and the analog power
+                              for the ADC) of the ADC, I2C and 32-bit
+                              timer 0 whenever their drivers aren't
+                              using them.  The UART and SSP keep their
+                              clocks once initialised.  Without it, the
+                              drivers still keep count of their users
+                              but the clocks are left on.
+
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      // #define CFG_CLKGATE
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      // #define CFG_CLKGATE
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      // #define CFG_CLKGATE
+    #endif
+/*=========================================================================*/
+
+
+/*=========================================================================
+    WATCHDOG SUPERVISOR
+    -----------------------------------------------------------------------
+
+    CFG_WDT_SUPERVISOR        If this field is defined, systemInit starts
+                              the watchdog with a system reset, and the
+                              systick interrupt only feeds it while every
+                              task registered with supervisorRegister
+                              has checked in within its deadline (see
+                              core/wdt/supervisor.c).  The ID of the task
+                              that stalled is kept through the reset and
+                              shown by 'sysinfo'.  Can't be used with
+                              CFG_SCHEDULER_DEEPSLEEP.
+    CFG_WDT_SUPERVISOR_TIMEOUTMS  The watchdog timeout in milliseconds,
+                              which is the time from a missed deadline
+                              (or interrupts being disabled) to the
+                              reset.  Must be longer than
+                              CFG_SCHEDULER_TICKLESS_MAXMS when the
+                              tickless scheduler is used, since the
+                              systick interrupt is stopped while asleep.
+
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      // #define CFG_WDT_SUPERVISOR
+      #define CFG_WDT_SUPERVISOR_TIMEOUTMS  (2000)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      // #define CFG_WDT_SUPERVISOR
+      #define CFG_WDT_SUPERVISOR_TIMEOUTMS  (2000)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      // #define CFG_WDT_SUPERVISOR
+      #define CFG_WDT_SUPERVISOR_TIMEOUTMS  (2000)
+    #endif
+/*=========================================================================*/
+
+
 /*=========================================================================
     UART
     -----------------------------------------------------------------------
@@ -163,26 +456,67 @@
     CFG_UART_BAUDRATE         The default UART speed.  This value is used 
                               when initialising UART, and should be a 
                               standard value like 57600, 9600, etc.  
+                              Rates up to 3M baud are set through the
+                              fractional divider (see uartInit), though
+                              3M baud is only exact with a 48MHz clock.
                               NOTE: This value may be overridden if
                               another value is stored in EEPROM!
     CFG_UART_BUFSIZE          The length in bytes of the UART RX FIFO. This
                               will determine the maximum number of received
-                              characters to store in memory.
+                              characters to store in memory.  Must be a
+                              power of two.
+    CFG_UART_TXBUFSIZE        The length in bytes of the UART TX FIFO.  Bytes
+                              sent with uartSend/uartSendByte are queued here
+                              and sent by the UART interrupt, so the caller
+                              only waits when the buffer is full.  Must be a
+                              power of two.
+    CFG_UART_RS485            If this field is defined the UART joins an
+                              RS-485 bus at CFG_UART_BAUDRATE, with the
+                              transceiver's DE driven by RTS (pin 1.5),
+                              and exchanges addressed binary frames
+                              instead of text (see core/uart/uart_rs485.c).
+                              This can't be used with CFG_PRINTF_UART.
+    CFG_UART_RS485_ADDRESS    This node's address on the bus (0..254, 255
+                              is the broadcast address).
+    CFG_UART_RS485_MAXPAYLOAD The largest frame payload in bytes (1..250).
+                              Each queued frame takes this plus 3 bytes.
+    CFG_UART_RS485_RXFRAMES   How many received frames can wait for the
+                              main loop.  Must be a power of two.
+    CFG_UART_RS485_DEDELAY    Bit times DE is held after the last stop bit
+                              of a frame (0..255).
 
     -----------------------------------------------------------------------*/
     #ifdef CFG_BRD_LPC1343_REFDESIGN
       #define CFG_UART_BAUDRATE           (115200)
       #define CFG_UART_BUFSIZE            (512)
+      #define CFG_UART_TXBUFSIZE          (128)
+      // #define CFG_UART_RS485
+      #define CFG_UART_RS485_ADDRESS      (0x01)
+      #define CFG_UART_RS485_MAXPAYLOAD   (64)
+      #define CFG_UART_RS485_RXFRAMES     (4)
+      #define CFG_UART_RS485_DEDELAY      (1)
     #endif
 
     #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
       #define CFG_UART_BAUDRATE           (115200)
       #define CFG_UART_BUFSIZE            (512)
+      #define CFG_UART_TXBUFSIZE          (128)
+      // #define CFG_UART_RS485
+      #define CFG_UART_RS485_ADDRESS      (0x01)
+      #define CFG_UART_RS485_MAXPAYLOAD   (64)
+      #define CFG_UART_RS485_RXFRAMES     (4)
+      #define CFG_UART_RS485_DEDELAY      (1)
     #endif
 
     #ifdef CFG_BRD_LPC1343_802154USBSTICK
       #define CFG_UART_BAUDRATE           (115200)
       #define CFG_UART_BUFSIZE            (512)
+      #define CFG_UART_TXBUFSIZE          (128)
+      // #define CFG_UART_RS485
+      #define CFG_UART_RS485_ADDRESS      (0x01)
+      #define CFG_UART_RS485_MAXPAYLOAD   (64)
+      #define CFG_UART_RS485_RXFRAMES     (4)
+      #define CFG_UART_RS485_DEDELAY      (1)
     #endif
 /*=========================================================================*/
 
@@ -212,6 +546,65 @@
 /*=========================================================================*/
 
 
+/*=========================================================================
+    ADC
+    -----------------------------------------------------------------------
+
+    CFG_ADC_BURST             If this field is defined, adcBurstStart can
+                              put the ADC in hardware scan (BURST) mode,
+                              with the ADC interrupt collecting results
+                              into a ring buffer per channel
+    CFG_ADC_RINGSIZE          The number of samples kept per channel in
+                              burst mode (power of 2, max 256).  The 8
+                              rings take 16 bytes of RAM per sample.
+    CFG_ADC_OVERSAMPLE        The number of conversions the touch screen
+                              and joystick drivers take per reading with
+                              adcReadOversampled (1..16, 1 disables
+                              filtering).  The highest and lowest quarter
+                              are discarded and the rest averaged.
+    CFG_ADC_TRIGGER           If this field is defined, adcTriggerStart
+                              can sample one channel at a fixed rate,
+                              with conversions started in hardware by
+                              32-bit timer 0 and the results collected
+                              into a caller supplied double buffer
+    CFG_SCOPE                 If this field is defined, scopeStart can
+                              take triggered oscilloscope style captures
+                              of one channel (needs CFG_ADC_TRIGGER, see
+                              core/adc/scope.c)
+    CFG_SCOPE_SAMPLES         The capture buffer size in samples (power
+                              of 2, 64..2048).  Takes 2 bytes of RAM per
+                              sample.
+
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      // #define CFG_ADC_BURST
+      #define CFG_ADC_RINGSIZE        (16)
+      #define CFG_ADC_OVERSAMPLE      (8)
+      // #define CFG_ADC_TRIGGER
+      // #define CFG_SCOPE
+      #define CFG_SCOPE_SAMPLES       (512)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      // #define CFG_ADC_BURST
+      #define CFG_ADC_RINGSIZE        (16)
+      #define CFG_ADC_OVERSAMPLE      (8)
+      // #define CFG_ADC_TRIGGER
+      // #define CFG_SCOPE
+      #define CFG_SCOPE_SAMPLES       (512)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      // #define CFG_ADC_BURST
+      #define CFG_ADC_RINGSIZE        (16)
+      #define CFG_ADC_OVERSAMPLE      (8)
+      // #define CFG_ADC_TRIGGER
+      // #define CFG_SCOPE
+      #define CFG_SCOPE_SAMPLES       (512)
+    #endif
+/*=========================================================================*/
+
+
 /*=========================================================================
     ON-BOARD LED
     -----------------------------------------------------------------------
@@ -256,10 +649,70 @@
                               saving some flash space.
     CFG_SDCARD_CDPORT         The card detect port number
     CFG_SDCARD_CDPIN          The card detect pin number
+    CFG_SDCARD_MAXCLOCK       The fastest SPI clock in Hz the board allows
+                              (max 36000000).  After initialisation the
+                              clock is set from the card's TRAN_SPEED,
+                              capped at this value.
+    CFG_SDCARD_HIGHSPEED      If this field is defined, SDv2 cards are
+                              switched to high speed mode (50MHz) with
+                              CMD6 when they support it.  Only useful if
+                              CFG_SDCARD_MAXCLOCK is above 25MHz.
+    CFG_SDCARD_CACHESECTORS   Number of 512 byte sectors in the optional
+                              sector cache that sits under FatFs (0 to
+                              disable, max 8).  Sequential reads are
+                              read ahead and sequential writes are
+                              collected and sent as a single multi-block
+                              write (CMD18/CMD25).  The cache costs
+                              512 bytes of RAM per sector.
+    CFG_SDCARD_DIRCACHE       Number of entries in the optional FatFs
+                              directory entry cache (0 to disable, max
+                              32).  Each file or folder that is found
+                              is remembered by name so that opening it
+                              again doesn't rescan the directory.  The
+                              cache costs 24 bytes of RAM per entry.
+    CFG_SDCARD_DATALOG        Number of 512 byte sector buffers used by
+                              the data logger in datalog.c (0 to
+                              disable, 2 to 8).  One buffer is filled
+                              (from interrupts if required) while the
+                              others are written to the card, so more
+                              buffers ride out longer card stalls.
+                              Requires CFG_SDCARD_READONLY to be 0.
+    CFG_SDCARD_DATALOG_LZ     If this field is defined, the data logger
+                              compresses each sector with lzCompress
+                              (core/compress) before writing it, which
+                              costs another 1KB of RAM.  Use
+                              tools/logdump to unpack the files.
+    CFG_SDCARD_REENTRANT      If this field is defined, FatFs is built
+                              with _FS_REENTRANT and long reads and
+                              writes (more than one sector) let one
+                              other scheduler task run between sectors,
+                              which may use the card as well.  A FatFs
+                              call made while the volume is in use
+                              returns FR_TIMEOUT.  Requires
+                              CFG_SCHEDULER.  See drivers/fatfs/ffsync.c
+    CFG_SDCARD_TRIM           If this field is defined, FatFs erases
+                              clusters on the card as they are freed
+                              (see _USE_ERASE in ffconf.h), which keeps
+                              write speeds up on cards that are filled
+                              and emptied by a logger.  Deleting files
+                              gets slower.  Requires
+                              CFG_SDCARD_READONLY to be 0.
+    CFG_SDCARD_STATS          If set to 1, mmc.c keeps latency histograms
+                              of the read/write commands and of the time
+                              the card spends busy, as well as error and
+                              byte counters ('H' command, see DSTATS in
+                              diskio.h).  Costs ~250 bytes of RAM and a
+                              few microseconds per command.
 
     NOTE:                     All config settings for FAT32 are defined
                               in ffconf.h
 
+    NOTE:                     Cached writes only reach the card when the
+                              cache is full, when an unrelated sector is
+                              accessed or when f_sync/f_close is called,
+                              so files must be synced or closed before
+                              the card is removed or power is lost.
+
     BENCHMARK:                With SPI set to 6.0MHz, FATFS can read
                               ~300KB/s (w/512 byte read buffer)
 							  
@@ -274,6 +727,15 @@
       #define CFG_SDCARD_READONLY         (1)   // Must be 0 or 1
       #define CFG_SDCARD_CDPORT           (3)
       #define CFG_SDCARD_CDPIN            (0)
+      #define CFG_SDCARD_MAXCLOCK         (24000000)
+      // #define CFG_SDCARD_HIGHSPEED
+      #define CFG_SDCARD_CACHESECTORS     (0)   // 0 = disabled, max 8
+      #define CFG_SDCARD_DIRCACHE         (0)   // 0 = disabled, max 32
+      #define CFG_SDCARD_DATALOG          (0)   // 0 = disabled, 2 to 8
+      // #define CFG_SDCARD_DATALOG_LZ
+      // #define CFG_SDCARD_REENTRANT
+      // #define CFG_SDCARD_TRIM
+      #define CFG_SDCARD_STATS            (0)   // Must be 0 or 1
     #endif
 
     #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
@@ -281,6 +743,15 @@
       #define CFG_SDCARD_READONLY         (1)   // Must be 0 or 1
       #define CFG_SDCARD_CDPORT           (3)
       #define CFG_SDCARD_CDPIN            (0)
+      #define CFG_SDCARD_MAXCLOCK         (24000000)
+      // #define CFG_SDCARD_HIGHSPEED
+      #define CFG_SDCARD_CACHESECTORS     (0)   // 0 = disabled, max 8
+      #define CFG_SDCARD_DIRCACHE         (8)   // 0 = disabled, max 32
+      #define CFG_SDCARD_DATALOG          (0)   // 0 = disabled, 2 to 8
+      // #define CFG_SDCARD_DATALOG_LZ
+      // #define CFG_SDCARD_REENTRANT
+      // #define CFG_SDCARD_TRIM
+      #define CFG_SDCARD_STATS            (0)   // Must be 0 or 1
     #endif
 
     #ifdef CFG_BRD_LPC1343_802154USBSTICK
@@ -288,6 +759,15 @@
       #define CFG_SDCARD_READONLY         (1)   // Must be 0 or 1
       #define CFG_SDCARD_CDPORT           (3)
       #define CFG_SDCARD_CDPIN            (0)
+      #define CFG_SDCARD_MAXCLOCK         (24000000)
+      // #define CFG_SDCARD_HIGHSPEED
+      #define CFG_SDCARD_CACHESECTORS     (0)   // 0 = disabled, max 8
+      #define CFG_SDCARD_DIRCACHE         (0)   // 0 = disabled, max 32
+      #define CFG_SDCARD_DATALOG          (0)   // 0 = disabled, 2 to 8
+      // #define CFG_SDCARD_DATALOG_LZ
+      // #define CFG_SDCARD_REENTRANT
+      // #define CFG_SDCARD_TRIM
+      #define CFG_SDCARD_STATS            (0)   // Must be 0 or 1
     #endif
 /*=========================================================================*/
 
@@ -298,6 +778,12 @@
 
     CFG_USBHID                If this field is defined USB HID support will
                               be included.  Currently uses ROM-based USB HID
+    CFG_USBHID_REPORTQUEUE    Number of reports that usbHIDQueueReport can
+                              sample ahead of the host.  Must be a power
+                              of two.
+    CFG_USBHID_REPORTSPERPACKET Number of queued reports sent in every
+                              HID IN transfer (the 28 byte reports must
+                              fit in a 64 byte packet, so 1 or 2)
     CFG_USBCDC                If this field is defined USB CDC support will
                               be included, with the USB Serial Port speed
                               set to 115200 BPS by default
@@ -307,10 +793,22 @@
     CFG_USBCDC_INITTIMEOUT    The maximum delay in milliseconds to wait for
                               USB to connect.  Must be a multiple of 10!
     CFG_USBCDC_BUFFERSIZE     Size of the buffer (in bytes) that stores
-                              printf data until it can be sent out in
-                              64 byte frames.  The buffer is required since
-                              only one frame per ms can be sent using USB
-                              CDC (see 'puts' in systeminit.c).
+                              printf data until it is sent out in 64 byte
+                              packets by the bulk IN endpoint interrupt
+                              (see 'puts' in sysinit.c).  Must be a power
+                              of two.
+    CFG_USBCDC_VENDORBULK     If this field is defined, a vendor-specific
+                              interface with a bulk IN/OUT endpoint pair
+                              (EP2) is added next to the CDC interfaces,
+                              for raw binary transfers (see usbvendor.c)
+    CFG_USBCDC_MSC            If this field is defined, a USB mass storage
+                              interface for the SD card is added next to
+                              the CDC interfaces (see mscuser.c), so that
+                              the host can copy files straight off the
+                              card.  Uses EP2, so it can't be combined
+                              with CFG_USBCDC_VENDORBULK, and requires
+                              CFG_SDCARD.  HID can't be added as well:
+                              the LPC1343 has no IN endpoint left.
 
     -----------------------------------------------------------------------*/
     #define CFG_USB_VID                   (0x239A)
@@ -318,26 +816,38 @@
 
     #ifdef CFG_BRD_LPC1343_REFDESIGN
       // #define CFG_USBHID
+      #define CFG_USBHID_REPORTQUEUE      (4)
+      #define CFG_USBHID_REPORTSPERPACKET (1)
       #define CFG_USBCDC
       #define CFG_USBCDC_BAUDRATE         (115200)
       #define CFG_USBCDC_INITTIMEOUT      (5000)
       #define CFG_USBCDC_BUFFERSIZE       (256)
+      // #define CFG_USBCDC_VENDORBULK
+      // #define CFG_USBCDC_MSC
     #endif
 
     #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
       // #define CFG_USBHID
+      #define CFG_USBHID_REPORTQUEUE      (4)
+      #define CFG_USBHID_REPORTSPERPACKET (1)
       #define CFG_USBCDC
       #define CFG_USBCDC_BAUDRATE         (115200)
       #define CFG_USBCDC_INITTIMEOUT      (5000)
       #define CFG_USBCDC_BUFFERSIZE       (256)
+      // #define CFG_USBCDC_VENDORBULK
+      // #define CFG_USBCDC_MSC
     #endif
 
     #ifdef CFG_BRD_LPC1343_802154USBSTICK
       // #define CFG_USBHID
+      #define CFG_USBHID_REPORTQUEUE      (4)
+      #define CFG_USBHID_REPORTSPERPACKET (1)
       #define CFG_USBCDC
       #define CFG_USBCDC_BAUDRATE         (115200)
       #define CFG_USBCDC_INITTIMEOUT      (5000)
       #define CFG_USBCDC_BUFFERSIZE       (256)
+      // #define CFG_USBCDC_VENDORBULK
+      // #define CFG_USBCDC_MSC
     #endif
 /*=========================================================================*/
 
@@ -352,6 +862,9 @@
                               redirect to USB Serial
     CFG_PRINTF_NEWLINE        This should be either "\r\n" for Windows or
                               "\n" for *nix
+    CFG_PRINTF_NOPADDING      If this field is defined, printf ignores
+                              field widths and '0' fill (%5d, %08X, etc.),
+                              which makes it slightly smaller and faster
 
     Note: If no printf redirection definitions are present, all printf
     output will be ignored, though this will also save ~350 bytes flash.
@@ -362,18 +875,21 @@
       // #define CFG_PRINTF_UART
       #define CFG_PRINTF_USBCDC
       #define CFG_PRINTF_NEWLINE          "\r\n"
+      // #define CFG_PRINTF_NOPADDING
     #endif
 
     #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
       // #define CFG_PRINTF_UART
       #define CFG_PRINTF_USBCDC
       #define CFG_PRINTF_NEWLINE          "\r\n"
+      // #define CFG_PRINTF_NOPADDING
     #endif
 
     #ifdef CFG_BRD_LPC1343_802154USBSTICK
       // #define CFG_PRINTF_UART
       #define CFG_PRINTF_USBCDC
       #define CFG_PRINTF_NEWLINE          "\r\n"
+      // #define CFG_PRINTF_NOPADDING
     #endif
 /*=========================================================================*/
 
@@ -405,6 +921,26 @@
                               new command can safely be sent.
     CFG_INTERFACE_IRQPORT     The gpio port for the IRQ/busy pin
     CFG_INTERFACE_IRQPIN      The gpio pin number for the IRQ/busy pin
+    CFG_INTERFACE_BINARYMODE  If this is set to 1, the hidden '#' command
+                              can switch the interface to a compact
+                              binary frame format (see cmdRxFrame in
+                              core/cmd/cmd.c) that is dispatched to the
+                              same command handlers, without echo or
+                              prompt.
+    CFG_INTERFACE_CMDLISTSIZE Size in bytes of the RAM buffer used by the
+                              'D' command to record a list of commands
+                              (for example all the drawing commands for
+                              one screen) and run them in one go.  Set
+                              to 0 to remove the command.
+    CFG_INTERFACE_SCRIPTS     If this is set to 1, the 'X <file>' command
+                              runs a text file from the SD card one
+                              line at a time, without echo or prompt,
+                              and reports the lines that failed (see
+                              cmdRunScript in core/cmd/cmd.c).  Costs
+                              ~850 bytes of RAM.  Requires CFG_SDCARD.
+    CFG_INTERFACE_AUTORUN     Script run by cmdInit at boot, if it
+                              exists (only used if CFG_INTERFACE_SCRIPTS
+                              is 1).
 
     NOTE:                     The command-line interface will use either
                               USB-CDC or UART depending on whether
@@ -419,6 +955,10 @@
       #define CFG_INTERFACE_ENABLEIRQ     (0)
       #define CFG_INTERFACE_IRQPORT       (2)
       #define CFG_INTERFACE_IRQPIN        (0)
+      #define CFG_INTERFACE_BINARYMODE    (1)
+      #define CFG_INTERFACE_CMDLISTSIZE   (0)
+      #define CFG_INTERFACE_SCRIPTS       (0)
+      #define CFG_INTERFACE_AUTORUN       "autorun.txt"
     #endif
 
     #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
@@ -429,6 +969,10 @@
       #define CFG_INTERFACE_ENABLEIRQ     (1)
       #define CFG_INTERFACE_IRQPORT       (2)
       #define CFG_INTERFACE_IRQPIN        (0)
+      #define CFG_INTERFACE_BINARYMODE    (1)
+      #define CFG_INTERFACE_CMDLISTSIZE   (512)
+      #define CFG_INTERFACE_SCRIPTS       (0)
+      #define CFG_INTERFACE_AUTORUN       "autorun.txt"
     #endif
 
     #ifdef CFG_BRD_LPC1343_802154USBSTICK
@@ -439,6 +983,107 @@
       #define CFG_INTERFACE_ENABLEIRQ     (0)
       #define CFG_INTERFACE_IRQPORT       (2)
       #define CFG_INTERFACE_IRQPIN        (0)
+      #define CFG_INTERFACE_BINARYMODE    (1)
+      #define CFG_INTERFACE_CMDLISTSIZE   (0)
+      #define CFG_INTERFACE_SCRIPTS       (0)
+      #define CFG_INTERFACE_AUTORUN       "autorun.txt"
+    #endif
+/*=========================================================================*/
+
+
+/*=========================================================================
+    BENCHMARKS
+    -----------------------------------------------------------------------
+
+    CFG_BENCH                 If this field is defined, the 'M' command
+                              will be added to the command-line interface
+                              to run a set of timing benchmarks (LCD,
+                              SD card, SSP, I2C and console output) using
+                              core/bench.  An SD card with '/bench.bmp' is
+                              needed for the bitmap test.
+    CFG_BENCH_AUTORUN         Set by 'make bench' (don't define it here).
+                              Enables CFG_BENCH and runs the benchmarks
+                              once at boot, printing machine-readable
+                              results ('M csv') that can be compared
+                              against the reference results in
+                              tools/bench with tools/bench/benchcmp.
+    CFG_PROFILER              If this field is defined, a sampling
+                              profiler is included that records the
+                              interrupted PC from 32-bit timer 1 into a
+                              histogram, dumped with the 'z' command
+                              (see core/timer32/profiler.c).  Can't be
+                              used with CFG_USBHID (which needs timer 1).
+    CFG_ISRSTATS              If this field is defined, the UART, USB,
+                              Chibi, SysTick and I2C interrupt handlers
+                              record their call count and min/max/avg
+                              duration in CPU cycles, and the longest
+                              CHB_ENTER_CRIT section is tracked.  The
+                              results are shown with the 'I' command
+                              (see core/bench/isrstats.c)
+    CFG_PROFILER_RATE         Profiler samples per second
+    CFG_PROFILER_BUCKETSHIFT  Each histogram bucket covers 2^n bytes of
+                              flash.  The histogram uses 2 bytes of RAM
+                              per bucket (7 = 128 byte buckets, 512 bytes
+                              of RAM for 32KB flash)
+    CFG_LOGIC                 If this field is defined, a GPIO port can be
+                              captured at a fixed rate with 16-bit timer
+                              0 and sent RLE compressed over the vendor
+                              bulk endpoint, as a simple logic analyser
+                              (see core/logic/logic.c and
+                              'tools/logicdump').  Requires
+                              CFG_USBCDC_VENDORBULK.
+    CFG_LOGIC_SAMPLES         Capture length in samples, a power of two
+                              between 64 and 2048 (2 bytes of RAM each)
+    CFG_TRACE                 If this field is defined, the TRACE macro
+                              records its format string pointer, a cycle
+                              count and up to 4 arguments in a RAM ring
+                              without formatting anything, so it can be
+                              used in interrupts.  The log is printed
+                              with the 'y' command, or formatted on the
+                              host with 'tools/tracedump' (see
+                              core/bench/trace.c).
+    CFG_TRACE_ENTRIES         Entries in the trace ring, a power of two
+                              (24 bytes of RAM each)
+
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      // #define CFG_BENCH
+      // #define CFG_PROFILER
+      // #define CFG_ISRSTATS
+      #define CFG_PROFILER_RATE           (1000)
+      #define CFG_PROFILER_BUCKETSHIFT    (7)
+      // #define CFG_LOGIC
+      #define CFG_LOGIC_SAMPLES           (512)
+      // #define CFG_TRACE
+      #define CFG_TRACE_ENTRIES           (32)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      // #define CFG_BENCH
+      // #define CFG_PROFILER
+      // #define CFG_ISRSTATS
+      #define CFG_PROFILER_RATE           (1000)
+      #define CFG_PROFILER_BUCKETSHIFT    (7)
+      // #define CFG_LOGIC
+      #define CFG_LOGIC_SAMPLES           (512)
+      // #define CFG_TRACE
+      #define CFG_TRACE_ENTRIES           (32)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      // #define CFG_BENCH
+      // #define CFG_PROFILER
+      // #define CFG_ISRSTATS
+      #define CFG_PROFILER_RATE           (1000)
+      #define CFG_PROFILER_BUCKETSHIFT    (7)
+      // #define CFG_LOGIC
+      #define CFG_LOGIC_SAMPLES           (512)
+      // #define CFG_TRACE
+      #define CFG_TRACE_ENTRIES           (32)
+    #endif
+
+    #if defined CFG_BENCH_AUTORUN && !defined CFG_BENCH
+      #define CFG_BENCH
     #endif
 /*=========================================================================*/
 
@@ -481,6 +1126,45 @@
 /*=========================================================================*/
 
 
+/*=========================================================================
+    INPUT CAPTURE SETTINGS
+    -----------------------------------------------------------------------
+
+    CFG_CAPTURE                 If this is defined, the frequency, period
+                                and duty cycle of the signal on pin 1.5
+                                can be measured with the capture input of
+                                32-bit timer 0 (see core/timer32/capture.c)
+    CFG_CAPTURE_SAMPLES         The number of cycles averaged in
+                                captureMode_Period (1..16, 8 bytes of RAM
+                                each)
+    CFG_CAPTURE_TIMEOUTMS       If no edge arrives for this long the
+                                measurement is discarded, which sets the
+                                lowest frequency that can be measured
+                                (up to 1000)
+
+    DEPENDENCIES:               Input capture requires the use of 32-bit
+                                timer 0 and pin 1.5 (CT32B0_CAP0)
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      // #define CFG_CAPTURE
+      #define CFG_CAPTURE_SAMPLES         (8)
+      #define CFG_CAPTURE_TIMEOUTMS       (1000)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      // #define CFG_CAPTURE
+      #define CFG_CAPTURE_SAMPLES         (8)
+      #define CFG_CAPTURE_TIMEOUTMS       (1000)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      // #define CFG_CAPTURE
+      #define CFG_CAPTURE_SAMPLES         (8)
+      #define CFG_CAPTURE_TIMEOUTMS       (1000)
+    #endif
+/*=========================================================================*/
+
+
 /*=========================================================================
     STEPPER MOTOR SETTINGS
     -----------------------------------------------------------------------
@@ -488,20 +1172,89 @@
     CFG_STEPPER                 If this is defined, a simple bi-polar 
                                 stepper motor will be included for common
                                 H-bridge chips like the L293D or SN754410N
+    CFG_STEPPER_AXES            The number of motors driven together with
+                                coordinated moves (axis 0 is on 3.0-3.3,
+                                the others are set up with stepperAxisInit)
+    CFG_STEPPER_QUEUESIZE       The number of moves that can be queued and
+                                planned ahead (~36 bytes each with 2 axes)
+    CFG_ENCODER                 If this is defined, quadrature encoders
+                                can be decoded from GPIO pin interrupts
+                                (see drivers/motor/encoder/encoder.c) and
+                                attached to stepper axes to catch and
+                                make up missed steps
+    CFG_STEPPER_ENCODER_TOLERANCE   How far (in steps) an axis can be from
+                                its encoder before it is taken to have
+                                slipped.  Should be at least 2, since the
+                                rotor lags the coils under load
+    CFG_STEPPER_MICROSTEPS      Microsteps per full step on axis 0 (1, 2,
+                                4, 8 or 16, 1 = full steps only).  Above
+                                1 the coil currents follow a sine table
+                                through PWM on 1.9 (coil A) and 1.10
+                                (coil B), which have to drive the enable
+                                pins of the H-bridge.
 
     DEPENDENCIES:               STEPPER requires the use of pins 3.0-3 and
-                                32-bit Timer 0.
+                                32-bit Timer 0.  Each encoder uses two
+                                GPIO interrupt callbacks.  Microstepping
+                                also uses 16-bit Timer 1 and pins 1.9 and
+                                1.10, so the PWM driver can't be used.
     -----------------------------------------------------------------------*/
     #ifdef CFG_BRD_LPC1343_REFDESIGN
       // #define CFG_STEPPER
+      #define CFG_STEPPER_AXES            (2)
+      #define CFG_STEPPER_QUEUESIZE       (8)
+      // #define CFG_ENCODER
+      #define CFG_STEPPER_ENCODER_TOLERANCE (2)
+      #define CFG_STEPPER_MICROSTEPS      (1)
     #endif
 
     #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
       // #define CFG_STEPPER
+      #define CFG_STEPPER_AXES            (2)
+      #define CFG_STEPPER_QUEUESIZE       (8)
+      // #define CFG_ENCODER
+      #define CFG_STEPPER_ENCODER_TOLERANCE (2)
+      #define CFG_STEPPER_MICROSTEPS      (1)
     #endif
 
     #ifdef CFG_BRD_LPC1343_802154USBSTICK
       // #define CFG_STEPPER
+      #define CFG_STEPPER_AXES            (2)
+      #define CFG_STEPPER_QUEUESIZE       (8)
+      // #define CFG_ENCODER
+      #define CFG_STEPPER_ENCODER_TOLERANCE (2)
+      #define CFG_STEPPER_MICROSTEPS      (1)
+    #endif
+/*=========================================================================*/
+
+
+/*=========================================================================
+    DAC STREAMING SETTINGS
+    -----------------------------------------------------------------------
+
+    CFG_MCP4725_STREAM          If this is defined, mcp4725StreamStart can
+                                play a waveform buffer out of the MCP4725
+                                DAC at a fixed sample rate, using 2-byte
+                                fast write commands on the I2C queue
+    CFG_MCP4725_STREAM_BURST    The maximum number of samples sent back
+                                to back in one I2C transaction (1..8)
+
+    DEPENDENCIES:               MCP4725 streaming requires the use of
+                                16-bit Timer 0.
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      // #define CFG_MCP4725_STREAM
+      #define CFG_MCP4725_STREAM_BURST    (4)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      // #define CFG_MCP4725_STREAM
+      #define CFG_MCP4725_STREAM_BURST    (4)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      // #define CFG_MCP4725_STREAM
+      #define CFG_MCP4725_STREAM_BURST    (4)
     #endif
 /*=========================================================================*/
 
@@ -513,6 +1266,12 @@
     CFG_I2CEEPROM             If defined, drivers for the onboard EEPROM
                               will be included during build
     CFG_I2CEEPROM_SIZE        The number of bytes available on the EEPROM
+    CFG_EEPROM_AT25040        If defined, the EEPROM API (eeprom.c and the
+                              key/value store) uses an AT25040 SPI EEPROM
+                              on SSP0 (CS on pin 0.2) instead of the
+                              MCP24AA.  The AT25040 only has 512 bytes,
+                              so CFG_EEPROM_KV_START/SIZE must be reduced
+                              to fit.
 
     -----------------------------------------------------------------------*/
     #ifdef CFG_BRD_LPC1343_REFDESIGN
@@ -542,11 +1301,30 @@
     are reserved for this (0x0000..0x00FF).
 
     CFG_EEPROM_RESERVED       The last byte of reserved EEPROM memory
+    CFG_EEPROM_SHADOWSTART    Start of an EEPROM region that is kept in
+                              RAM (loaded by eepromInit).  Reads in the
+                              region don't use I2C, and writes are only
+                              stored in RAM until eepromFlush is called,
+                              which writes the changed pages.
+    CFG_EEPROM_SHADOWSIZE     Size of the shadowed region in bytes (max
+                              1024), or 0 to disable the shadow copy
+    CFG_EEPROM_KV_START       Start of the area used by the key/value
+                              store in eepromkv.c (must be above the
+                              reserved area)
+    CFG_EEPROM_KV_SIZE        Size of the key/value area.  It is split
+                              into two banks that are used in turn.
+    CFG_EEPROM_KV_MAXKEYS     The number of keys held in the RAM index
+    CFG_EEPROM_KV_MAXVALUE    The maximum length of a value (each key
+                              uses MAXVALUE + 2 bytes of RAM)
+    CFG_EEPROM_LOG_START      Start of the circular event log in
+                              eepromlog.c (must be a multiple of 16)
+    CFG_EEPROM_LOG_SIZE       Size of the event log area.  Each event
+                              uses one 16-byte record (one page write)
 
           EEPROM Address (0x0000..0x00FF)
           ===============================
           0 1 2 3 4 5 6 7 8 9 A B C D E F
-    000x  x x x x x x x x . x x . . . . .   Chibi
+    000x  x x x x x x x x . x x x x x x .   Chibi
     001x  . . . . . . . . . . . . . . . .   
     002x  x x x x . . . . . . . . . . . .   UART
     003x  x x x x x x x x x x x x x x x x   Touch Screen Calibration
@@ -554,12 +1332,12 @@
     005x  . . . . . . . . . . . . . . . .
     006x  . . . . . . . . . . . . . . . .
     007x  . . . . . . . . . . . . . . . .
-    008x  . . . . . . . . . . . . . . . .
-    009x  . . . . . . . . . . . . . . . .
-    00Ax  . . . . . . . . . . . . . . . .
-    00Bx  . . . . . . . . . . . . . . . .
-    00Cx  . . . . . . . . . . . . . . . .
-    00Dx  . . . . . . . . . . . . . . . .
+    008x  x x x x x x x x x x x x x x x x   Chibi Routing Table
+    009x  x x x x x x x x x x x x x x x x   Chibi Routing Table
+    00Ax  x x x x x x x x x x x x x x x x   Chibi Routing Table
+    00Bx  x x x x x x x x x x x x x x x x   Chibi Routing Table
+    00Cx  x x x x x x x x x x x x x x x x   Chibi Routing Table
+    00Dx  x x . . . . . . . . . . . . . .   Chibi Routing Table
     00Ex  . . . . . . . . . . . . . . . .
     00Fx  . . . . . . . . . . . . . . . .
 
@@ -567,6 +1345,7 @@
     #define CFG_EEPROM_RESERVED                 (0x00FF)              // Protect first 256 bytes of memory
     #define CFG_EEPROM_CHIBI_IEEEADDR           (uint16_t)(0x0000)    // 8
     #define CFG_EEPROM_CHIBI_SHORTADDR          (uint16_t)(0x0009)    // 2
+    #define CFG_EEPROM_CHIBI_SECCOUNTER         (uint16_t)(0x000B)    // 4
     #define CFG_EEPROM_TOUCHSCREEN_CALIBRATED   (uint16_t)(0x0030)    // 1
     #define CFG_EEPROM_TOUCHSCREEN_CAL_AN       (uint16_t)(0x0031)    // 4
     #define CFG_EEPROM_TOUCHSCREEN_CAL_BN       (uint16_t)(0x0035)    // 4
@@ -577,6 +1356,18 @@
     #define CFG_EEPROM_TOUCHSCREEN_CAL_DIVIDER  (uint16_t)(0x0049)    // 4
     #define CFG_EEPROM_TOUCHSCREEN_THRESHHOLD   (uint16_t)(0x004D)    // 1
     #define CFG_EEPROM_UART_SPEED               (uint16_t)(0x0020)    // 4
+    #define CFG_EEPROM_CHIBI_ROUTES             (uint16_t)(0x0080)    // 82
+
+    #define CFG_EEPROM_SHADOWSTART              (0x0000)
+    #define CFG_EEPROM_SHADOWSIZE               (0)                   // Set to 0x0100 to shadow the reserved area
+
+    #define CFG_EEPROM_KV_START                 (0x0100)
+    #define CFG_EEPROM_KV_SIZE                  (0x0200)              // 2 banks of 256 bytes
+    #define CFG_EEPROM_KV_MAXKEYS               (16)
+    #define CFG_EEPROM_KV_MAXVALUE              (8)
+
+    #define CFG_EEPROM_LOG_START                (0x0300)
+    #define CFG_EEPROM_LOG_SIZE                 (0x0400)              // 64 events
 /*=========================================================================*/
 
 
@@ -615,11 +1406,111 @@
                                 chb_drvr.h for possible values
     CFG_CHIBI_CHANNEL           802.15.4 Channel (0 = 868MHz, 1-10 = 915MHz)
     CFG_CHIBI_PANID             16-bit PAN Identifier (ex.0x1234)
+    CFG_CHIBI_AUTOCHANNEL       If defined, the radio scans every channel of
+                                the band selected by CFG_CHIBI_MODE at boot
+                                and moves to the one with the least energy
+                                instead of staying on CFG_CHIBI_CHANNEL.
+                                Only useful on the node that the others
+                                have to find (see also the 'E' command).
     CFG_CHIBI_PROMISCUOUS       Set to 1 to enabled promiscuous mode or
                                 0 to disable it.  If promiscuous mode is
-                                enabled be sure to set CFG_CHIBI_BUFFERSIZE
-                                to an appropriately large value (ex. 1024)
-    CFG_CHIBI_BUFFERSIZE        The size of the message buffer in bytes
+                                enabled be sure to set CFG_CHIBI_RXSLOTS
+                                to an appropriately large value (ex. 7)
+    CFG_CHIBI_RXSLOTS           The number of received frames that can be
+                                buffered (each slot takes about 144 bytes
+                                of RAM).  Frames arriving while all slots
+                                are in use are dropped.
+    CFG_CHIBI_DEFERISR          If defined, the radio interrupt only pends
+                                PendSV, and the frame reads and state
+                                changes are done there at the lowest
+                                interrupt priority so that UART and USB
+                                interrupts aren't delayed by radio traffic.
+    CFG_CHIBI_XPORT_WINDOW      The number of fragments the transport layer
+                                (chb_xport.c) keeps in flight (1..8).  The
+                                receiver buffers one window of fragments
+                                (94 bytes each).
+    CFG_CHIBI_XPORT_TIMEOUTMS   How long the transport layer waits for an
+                                ack before resending unacked fragments
+    CFG_CHIBI_XPORT_RETRIES     How many timeouts in a row before a
+                                transfer is abandoned
+    CFG_CHIBI_XPORT_LZ          If defined, chb_xport_send_lz can send data
+                                compressed with lzCompress (core/compress)
+                                and received transfers of that kind are
+                                decompressed on the fly (about 270 bytes
+                                of RAM for the decoder).
+    CFG_CHIBI_DUPCACHE          The number of senders whose last sequence
+                                number is remembered so that retried
+                                frames can be dropped (1..16, 4 bytes of
+                                RAM each).  Make this at least the number
+                                of nodes a board hears regularly.
+    CFG_CHIBI_BCAST_REPEAT      How many times each frame sent to
+                                CHB_BROADCAST goes out (1..4).  Broadcasts
+                                aren't acked, so repeating them is the
+                                only way to make up for lost frames; the
+                                copies share a sequence number and are
+                                dropped by the duplicate cache.
+    CFG_CHIBI_AGGR_SLOTS        The number of destinations chb_aggr.c can
+                                collect small messages for at the same
+                                time (1..4, about 110 bytes of RAM each)
+    CFG_CHIBI_AGGR_LATENCYMS    The longest a message written with
+                                chb_aggr_write waits for others to share
+                                its frame
+    CFG_CHIBI_ROUTES            The size of the multi-hop routing table in
+                                chb_route.c (max 16, 6 bytes of RAM each)
+    CFG_CHIBI_ROUTE_MAXHOPS     The furthest a routed frame or a route
+                                request is forwarded
+    CFG_CHIBI_LPL               If defined, chb_lpl.c can duty-cycle the
+                                receiver (low power listening, turned on
+                                with chb_lpl_enable).  Requires
+                                CFG_SCHEDULER.
+    CFG_CHIBI_LPL_INTERVALMS    How often a sleeping receiver wakes up to
+                                listen.  Senders strobe for this long, so
+                                every node must use the same value.
+    CFG_CHIBI_LPL_LISTENMS      How long the receiver listens each time it
+                                wakes up (must cover the gap between two
+                                strobed frames)
+    CFG_CHIBI_LPL_HOLDMS        How long the receiver stays awake after
+                                traffic was heard or a frame was sent
+    CFG_CHIBI_TSYNC             If defined, chb_tsync.c keeps a network
+                                time shared by every node (see
+                                chb_tsync_now).  Frames are timestamped
+                                in microseconds on RX_START, with timer
+                                0 if CFG_CHIBI_TIMESTAMP is defined as
+                                well and with the systick timer otherwise.
+    CFG_CHIBI_TSYNC_PERIODMS    How often each synchronised node sends a
+                                time beacon
+    CFG_CHIBI_TSYNC_POINTS      How many beacons the offset and drift are
+                                estimated from (2..16, 8 bytes of RAM
+                                each).  More points average out more
+                                jitter but follow temperature changes of
+                                the crystals more slowly.
+    CFG_CHIBI_SEC               If defined, chb_sec.c can encrypt and
+                                authenticate frames (AES-128 CCM, with the
+                                radio's AES engine and drivers/crypto as
+                                the fallback).  Uses 4 bytes of EEPROM at
+                                CFG_EEPROM_CHIBI_SECCOUNTER.
+    CFG_CHIBI_TIMESTAMP         If defined, 32-bit timer 0 is used as a free
+                                running 1MHz counter, and the timestamp of
+                                each received frame is the counter value
+                                latched on its RX_START interrupt instead
+                                of the systick tick (used by the wsbridge
+                                sniffer example).
+    CFG_CHIBI_LINKSTATS         The number of neighbours chb.c keeps transmit
+                                and receive statistics for (about 24 bytes
+                                of RAM each, see the 'L' command).  Set to
+                                0 to disable.
+    CFG_CHIBI_ADAPTIVE          If defined, the retry count, the CSMA
+                                backoff and the transmit power are chosen
+                                per destination from its link statistics
+                                before every frame: fewer retries and less
+                                power on reliable links, more retries on
+                                lossy ones and longer backoffs where the
+                                channel is busy.  Requires
+                                CFG_CHIBI_LINKSTATS.
+    CFG_CHIBI_TXQUEUE           The number of frames that can be queued
+                                with chb_write_async (each one takes about
+                                120 bytes of RAM).  Set to 0 to disable
+                                the queue and transmit synchronously.
 
     DEPENDENCIES:               Chibi requires the use of SSP0, 16-bit timer
                                 0 and pins 3.1, 3.2, 3.3.  It also requires
@@ -635,8 +1526,32 @@
       #define CFG_CHIBI_POWER             (0xE9)              // CHB_PWR_EU2_3DBM
       #define CFG_CHIBI_CHANNEL           (0)                 // 868-868.6 MHz
       #define CFG_CHIBI_PANID             (0x1234)
+      // #define CFG_CHIBI_AUTOCHANNEL
+      // #define CFG_CHIBI_TIMESTAMP
       #define CFG_CHIBI_PROMISCUOUS       (0)
-      #define CFG_CHIBI_BUFFERSIZE        (128)
+      #define CFG_CHIBI_RXSLOTS           (2)
+      #define CFG_CHIBI_TXQUEUE           (4)
+      #define CFG_CHIBI_LINKSTATS         (8)
+      // #define CFG_CHIBI_ADAPTIVE
+      #define CFG_CHIBI_DEFERISR
+      #define CFG_CHIBI_XPORT_WINDOW      (4)
+      #define CFG_CHIBI_XPORT_TIMEOUTMS   (100)
+      #define CFG_CHIBI_XPORT_RETRIES     (5)
+      // #define CFG_CHIBI_XPORT_LZ
+      #define CFG_CHIBI_DUPCACHE          (8)
+      #define CFG_CHIBI_BCAST_REPEAT      (2)
+      #define CFG_CHIBI_AGGR_SLOTS        (2)
+      #define CFG_CHIBI_AGGR_LATENCYMS    (20)
+      #define CFG_CHIBI_ROUTES            (16)
+      #define CFG_CHIBI_ROUTE_MAXHOPS     (8)
+      // #define CFG_CHIBI_LPL
+      #define CFG_CHIBI_LPL_INTERVALMS    (500)
+      #define CFG_CHIBI_LPL_LISTENMS      (10)
+      #define CFG_CHIBI_LPL_HOLDMS        (50)
+      // #define CFG_CHIBI_TSYNC
+      #define CFG_CHIBI_TSYNC_PERIODMS    (10000)
+      #define CFG_CHIBI_TSYNC_POINTS      (8)
+      // #define CFG_CHIBI_SEC
     #endif
 
     #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
@@ -645,8 +1560,32 @@
       #define CFG_CHIBI_POWER             (0xE9)              // CHB_PWR_EU2_3DBM
       #define CFG_CHIBI_CHANNEL           (0)                 // 868-868.6 MHz
       #define CFG_CHIBI_PANID             (0x1234)
+      // #define CFG_CHIBI_AUTOCHANNEL
+      // #define CFG_CHIBI_TIMESTAMP
       #define CFG_CHIBI_PROMISCUOUS       (0)
-      #define CFG_CHIBI_BUFFERSIZE        (128)
+      #define CFG_CHIBI_RXSLOTS           (2)
+      #define CFG_CHIBI_TXQUEUE           (4)
+      #define CFG_CHIBI_LINKSTATS         (8)
+      // #define CFG_CHIBI_ADAPTIVE
+      #define CFG_CHIBI_DEFERISR
+      #define CFG_CHIBI_XPORT_WINDOW      (4)
+      #define CFG_CHIBI_XPORT_TIMEOUTMS   (100)
+      #define CFG_CHIBI_XPORT_RETRIES     (5)
+      // #define CFG_CHIBI_XPORT_LZ
+      #define CFG_CHIBI_DUPCACHE          (8)
+      #define CFG_CHIBI_BCAST_REPEAT      (2)
+      #define CFG_CHIBI_AGGR_SLOTS        (2)
+      #define CFG_CHIBI_AGGR_LATENCYMS    (20)
+      #define CFG_CHIBI_ROUTES            (16)
+      #define CFG_CHIBI_ROUTE_MAXHOPS     (8)
+      // #define CFG_CHIBI_LPL
+      #define CFG_CHIBI_LPL_INTERVALMS    (500)
+      #define CFG_CHIBI_LPL_LISTENMS      (10)
+      #define CFG_CHIBI_LPL_HOLDMS        (50)
+      // #define CFG_CHIBI_TSYNC
+      #define CFG_CHIBI_TSYNC_PERIODMS    (10000)
+      #define CFG_CHIBI_TSYNC_POINTS      (8)
+      // #define CFG_CHIBI_SEC
     #endif
 
     #ifdef CFG_BRD_LPC1343_802154USBSTICK
@@ -655,8 +1594,32 @@
       #define CFG_CHIBI_POWER             (0xE9)              // CHB_PWR_EU2_3DBM
       #define CFG_CHIBI_CHANNEL           (0)                 // 868-868.6 MHz
       #define CFG_CHIBI_PANID             (0x1234)
+      // #define CFG_CHIBI_AUTOCHANNEL
+      // #define CFG_CHIBI_TIMESTAMP
       #define CFG_CHIBI_PROMISCUOUS       (0)
-      #define CFG_CHIBI_BUFFERSIZE        (1024)
+      #define CFG_CHIBI_RXSLOTS           (7)
+      #define CFG_CHIBI_TXQUEUE           (4)
+      #define CFG_CHIBI_LINKSTATS         (8)
+      // #define CFG_CHIBI_ADAPTIVE
+      #define CFG_CHIBI_DEFERISR
+      #define CFG_CHIBI_XPORT_WINDOW      (4)
+      #define CFG_CHIBI_XPORT_TIMEOUTMS   (100)
+      #define CFG_CHIBI_XPORT_RETRIES     (5)
+      // #define CFG_CHIBI_XPORT_LZ
+      #define CFG_CHIBI_DUPCACHE          (8)
+      #define CFG_CHIBI_BCAST_REPEAT      (2)
+      #define CFG_CHIBI_AGGR_SLOTS        (2)
+      #define CFG_CHIBI_AGGR_LATENCYMS    (20)
+      #define CFG_CHIBI_ROUTES            (16)
+      #define CFG_CHIBI_ROUTE_MAXHOPS     (8)
+      // #define CFG_CHIBI_LPL
+      #define CFG_CHIBI_LPL_INTERVALMS    (500)
+      #define CFG_CHIBI_LPL_LISTENMS      (10)
+      #define CFG_CHIBI_LPL_HOLDMS        (50)
+      // #define CFG_CHIBI_TSYNC
+      #define CFG_CHIBI_TSYNC_PERIODMS    (10000)
+      #define CFG_CHIBI_TSYNC_POINTS      (8)
+      // #define CFG_CHIBI_SEC
     #endif
 /*=========================================================================*/
 
@@ -686,6 +1649,102 @@
                                 a value stored in EEPROM.
     CFG_TFTLCD_TS_KEYPADDELAY   The delay in milliseconds between key
                                 presses in dialogue boxes
+    CFG_TFTLCD_TS_IRQ           If defined, a touch is detected with a pen
+                                down interrupt on XP (1.0), the screen is
+                                sampled from the systick interrupt while
+                                it is touched, and tsWaitForEvent sleeps
+                                until a DOWN/MOVE event is queued instead
+                                of polling the panel
+    CFG_TFTLCD_TS_SAMPLEMS      Milliseconds between readings while the
+                                pen is down (CFG_TFTLCD_TS_IRQ only)
+    CFG_TFTLCD_TS_QUEUESIZE     Number of queued touch events, 12 bytes
+                                each (CFG_TFTLCD_TS_IRQ only)
+    CFG_TFTLCD_ST7735_SSP       If set to 1, the ST7735 driver will talk
+                                to the display through SSP0 instead of
+                                bit-banging SDA and SCL.  SDA must then be
+                                wired to MOSI0 (0.9) and SCL to SCK0 (see
+                                CFG_SSP0_SCKPIN_*), while RS, CS and RES
+                                stay on GPIO.  The bus can be shared with
+                                the SD card since each device has its own
+                                chip select.  Ignored by other drivers.
+    CFG_TFTLCD_STATS            If set to 1, the HW driver counts the
+                                commands, cursor updates and data words
+                                it sends to and reads from the panel
+                                ('g' command, see lcdStats_t in lcd.h).
+                                Costs a few cycles per bus transfer.
+    CFG_TFTLCD_REMOTE           If set to 1, the screen can be mirrored
+                                to 'tools/lcdview' over the USB vendor
+                                bulk endpoint ('v' command, see
+                                lcdremote.c).  The ILI9325/ILI9328
+                                drivers report the area of every write
+                                and only the damaged rectangles are
+                                sent, RLE compressed.  Requires
+                                CFG_USBCDC_VENDORBULK, and uses about
+                                600 bytes of SRAM.
+    CFG_TFTLCD_INLINE           If set to 1, drawing.c is bound to the
+                                ILI9328 at compile time through static
+                                inline pixel and cursor writes (see
+                                lcdinline.h) instead of calling
+                                lcdDrawPixel for every pixel.  Only valid
+                                when ILI9328.o is the driver selected in
+                                the Makefile.  Set to 0 for any other
+                                driver.
+    CFG_TFTLCD_16BIT            If set to 1, the ILI9325/ILI9328 drivers
+                                use the controller's 16-bit interface
+                                (IM[3:0] strapped to 0010) so that each
+                                pixel is written with a single WR strobe
+                                instead of two.  The LPC1343 ports are
+                                only 12 bits wide, so the low byte stays
+                                on 2.1-2.8 and the high byte goes on the
+                                ILI932x_DATAH_* pins in the driver header
+                                (1.0-1.7 by default, which takes the
+                                JTAG/SWD, UART and touch screen pins).
+                                Set to 0 for the standard 8-bit breakout.
+    CFG_TFTLCD_JPEG             If set to 1, baseline JPEG images can be
+                                decoded from the SD card and drawn with
+                                drawJpegImage (see jpeg.h), or with the
+                                'B' command for any .jpg file.  Images
+                                are streamed to the LCD one MCU at a time
+                                and can be scaled down by 2, 4 or 8.
+                                Costs about 2.5KB of SRAM and requires
+                                CFG_SDCARD.
+    CFG_TFTLCD_TILEBUFFER       Size in pixels of an optional offscreen
+                                RGB565 buffer used by drawTileBegin and
+                                drawComposite in drawing.c.  Primitives
+                                drawn while a tile is open are rendered
+                                into RAM and sent to the LCD in a single
+                                windowed burst, so overlapping elements
+                                don't flicker.  Each pixel costs 2 bytes
+                                of SRAM (1024 = 32x32 pixels = 2KB).  Set
+                                to 0 to disable.
+    CFG_TFTLCD_WIDGETS          Number of statically allocated nodes for
+                                the retained widget tree in widget.c
+                                (48 bytes of SRAM each).  Changed
+                                widgets are tracked as damaged regions
+                                and repainted in a single pass by
+                                widgetPaint.  Set to 0 to disable.
+    CFG_TFTLCD_SPRITES          Number of statically allocated sprites
+                                for sprite.c (20 bytes of SRAM each).
+                                Moved or animated sprites are composed
+                                over the restored background in the tile
+                                buffer and sent as one burst per changed
+                                area, and spriteFrame paces the frames.
+                                Requires CFG_TFTLCD_TILEBUFFER.  Set to 0
+                                to disable.
+    CFG_TFTLCD_FMARK_PORT       If defined, the port and pin that the
+    CFG_TFTLCD_FMARK_PIN        panel's frame marker (FMARK/TE) output
+                                is wired to.  spriteFrame then waits for
+                                the start of a panel refresh before
+                                sending a frame so that sprites don't
+                                tear.  The pin isn't connected on the
+                                standard TFT breakout.
+    CFG_TFTLCD_FONTCACHE        Number of glyph slots (68 bytes of SRAM
+                                each) in the LRU cache used by
+                                fontcache.c for fonts loaded from an
+                                asset pack on the SD card, which are drawn
+                                like any other font without using flash.
+                                Requires CFG_SDCARD.  Set to 0 to
+                                disable.
 
     PIN LAYOUT:                 The pin layout that is used by this driver
                                 can be seen in the following schematic:
@@ -699,6 +1758,21 @@
       #define CFG_TFTLCD_INCLUDESMALLFONTS   (0)
       #define CFG_TFTLCD_TS_DEFAULTTHRESHOLD (50)
       #define CFG_TFTLCD_TS_KEYPADDELAY      (100)
+      // #define CFG_TFTLCD_TS_IRQ
+      #define CFG_TFTLCD_TS_SAMPLEMS         (20)
+      #define CFG_TFTLCD_TS_QUEUESIZE        (8)
+      #define CFG_TFTLCD_ST7735_SSP          (0)
+      #define CFG_TFTLCD_INLINE              (0)
+      #define CFG_TFTLCD_16BIT               (0)
+      #define CFG_TFTLCD_STATS               (0)
+      #define CFG_TFTLCD_REMOTE              (0)
+      #define CFG_TFTLCD_JPEG                (0)
+      #define CFG_TFTLCD_TILEBUFFER          (0)   // 0 = disabled, max 2048
+      #define CFG_TFTLCD_WIDGETS             (0)   // 0 = disabled, max 64
+      #define CFG_TFTLCD_SPRITES             (0)   // 0 = disabled, max 32
+      // #define CFG_TFTLCD_FMARK_PORT       (2)
+      // #define CFG_TFTLCD_FMARK_PIN        (10)
+      #define CFG_TFTLCD_FONTCACHE           (0)   // 0 = disabled, max 32
     #endif
 
     #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
@@ -706,6 +1780,21 @@
       #define CFG_TFTLCD_INCLUDESMALLFONTS   (0)
       #define CFG_TFTLCD_TS_DEFAULTTHRESHOLD (50)
       #define CFG_TFTLCD_TS_KEYPADDELAY      (100)
+      // #define CFG_TFTLCD_TS_IRQ
+      #define CFG_TFTLCD_TS_SAMPLEMS         (20)
+      #define CFG_TFTLCD_TS_QUEUESIZE        (8)
+      #define CFG_TFTLCD_ST7735_SSP          (0)
+      #define CFG_TFTLCD_INLINE              (0)
+      #define CFG_TFTLCD_16BIT               (0)
+      #define CFG_TFTLCD_STATS               (0)
+      #define CFG_TFTLCD_REMOTE              (0)
+      #define CFG_TFTLCD_JPEG                (0)
+      #define CFG_TFTLCD_TILEBUFFER          (0)   // 0 = disabled, max 2048
+      #define CFG_TFTLCD_WIDGETS             (0)   // 0 = disabled, max 64
+      #define CFG_TFTLCD_SPRITES             (0)   // 0 = disabled, max 32
+      // #define CFG_TFTLCD_FMARK_PORT       (2)
+      // #define CFG_TFTLCD_FMARK_PIN        (10)
+      #define CFG_TFTLCD_FONTCACHE           (0)   // 0 = disabled, max 32
     #endif
 
     #ifdef CFG_BRD_LPC1343_802154USBSTICK
@@ -713,6 +1802,21 @@
       #define CFG_TFTLCD_INCLUDESMALLFONTS   (0)
       #define CFG_TFTLCD_TS_DEFAULTTHRESHOLD (50)
       #define CFG_TFTLCD_TS_KEYPADDELAY      (100)
+      // #define CFG_TFTLCD_TS_IRQ
+      #define CFG_TFTLCD_TS_SAMPLEMS         (20)
+      #define CFG_TFTLCD_TS_QUEUESIZE        (8)
+      #define CFG_TFTLCD_ST7735_SSP          (0)
+      #define CFG_TFTLCD_INLINE              (0)
+      #define CFG_TFTLCD_16BIT               (0)
+      #define CFG_TFTLCD_STATS               (0)
+      #define CFG_TFTLCD_REMOTE              (0)
+      #define CFG_TFTLCD_JPEG                (0)
+      #define CFG_TFTLCD_TILEBUFFER          (0)   // 0 = disabled, max 2048
+      #define CFG_TFTLCD_WIDGETS             (0)   // 0 = disabled, max 64
+      #define CFG_TFTLCD_SPRITES             (0)   // 0 = disabled, max 32
+      // #define CFG_TFTLCD_FMARK_PORT       (2)
+      // #define CFG_TFTLCD_FMARK_PIN        (10)
+      #define CFG_TFTLCD_FONTCACHE           (0)   // 0 = disabled, max 32
     #endif
 /*=========================================================================*/
 
@@ -726,6 +1830,14 @@
     CFG_SSD1306               If defined, this will cause drivers for
                               the 128x64 pixel SSD1306 OLED display to be
                               included
+    CFG_ST7565_SSP            If set to 1, the ST7565/SSD1306 driver
+    CFG_SSD1306_SSP           sends each dirty page as one SSP0 burst
+                              instead of bit-banging SCLK and SDAT.  SDAT
+                              must then be wired to MOSI0 (0.9) and SCLK
+                              to SCK0 (see CFG_SSP0_SCKPIN_*), while
+                              A0/DC, CS and RST stay on port 2.  The bus
+                              is shared with other SSP0 devices through
+                              sspDeviceAcquire.
 
     Note:                     LPC1114 @ 36MHz and the ST7565 with the
                               backlight enabled consumes ~35mA
@@ -736,16 +1848,22 @@
     #ifdef CFG_BRD_LPC1343_REFDESIGN
       // #define CFG_ST7565
       // #define CFG_SSD1306
+      #define CFG_ST7565_SSP                 (0)
+      #define CFG_SSD1306_SSP                (0)
     #endif
 
     #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
       // #define CFG_ST7565
       // #define CFG_SSD1306
+      #define CFG_ST7565_SSP                 (0)
+      #define CFG_SSD1306_SSP                (0)
     #endif
 
     #ifdef CFG_BRD_LPC1343_802154USBSTICK
       // #define CFG_ST7565
       // #define CFG_SSD1306
+      #define CFG_ST7565_SSP                 (0)
+      #define CFG_SSD1306_SSP                (0)
     #endif
 /*=========================================================================*/
 
@@ -763,6 +1881,16 @@
                                 with 64-bit providing higher security, and
                                 32-bit providing smaller encrypted text
                                 size.
+    CFG_RSA_MAXBITS             The largest modulus (in bits, a multiple
+                                of 32) for the multi-precision rsaBig
+                                functions, used for signature checks
+                                and (in CRT form, with primes of half
+                                this size) for signing
+    CFG_RSA_WINDOW              Sliding window size (1..5 bits) for long
+                                exponents.  Each step up halves the
+                                multiplications per window but doubles
+                                the stack used for the precomputed
+                                powers (2^(n-1) * CFG_RSA_MAXBITS/8 bytes)
                                   
     NOTE:                       Please note that Printf can not be
                                 used to display 64-bit values (%lld)!
@@ -770,16 +1898,122 @@
     #ifdef CFG_BRD_LPC1343_REFDESIGN
       // #define CFG_RSA
       #define CFG_RSA_BITS                  (32)
+      #define CFG_RSA_MAXBITS               (1024)
+      #define CFG_RSA_WINDOW                (4)
     #endif
 
     #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
       // #define CFG_RSA
       #define CFG_RSA_BITS                  (32)
+      #define CFG_RSA_MAXBITS               (1024)
+      #define CFG_RSA_WINDOW                (4)
     #endif
 
     #ifdef CFG_BRD_LPC1343_802154USBSTICK
       // #define CFG_RSA
       #define CFG_RSA_BITS                  (32)
+      #define CFG_RSA_MAXBITS               (1024)
+      #define CFG_RSA_WINDOW                (4)
+    #endif
+/*=========================================================================*/
+
+
+/*=========================================================================
+    SYMMETRIC CRYPTO
+    -----------------------------------------------------------------------
+
+    CFG_AES_TTABLES             Lookup tables used by the AES-128 cipher
+                                in drivers/crypto/aes.c:
+                                0 = S-box only (256 bytes, slowest)
+                                1 = one 1KB T-table plus rotates
+                                4 = four T-tables (4KB, fastest)
+                                SHA-256 and the CRC tables are fixed in
+                                size and only linked in when used.
+    CFG_RANDOM                  If defined, the entropy pool and random
+                                number generators in
+                                drivers/crypto/random.c are included,
+                                seeded at boot from ADC noise and, with
+                                CFG_CHIBI, the radio's random bits
+    CFG_RANDOM_ADCCHANNEL       The A/D channel (0..3) sampled for noise
+                                by randomInit.  An unconnected or noisy
+                                input is best.
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      #define CFG_AES_TTABLES               (1)
+      // #define CFG_RANDOM
+      #define CFG_RANDOM_ADCCHANNEL         (0)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      #define CFG_AES_TTABLES               (0)
+      // #define CFG_RANDOM
+      #define CFG_RANDOM_ADCCHANNEL         (0)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      #define CFG_AES_TTABLES               (1)
+      // #define CFG_RANDOM
+      #define CFG_RANDOM_ADCCHANNEL         (0)
+    #endif
+/*=========================================================================*/
+
+
+/*=========================================================================
+    FIRMWARE UPDATES
+    -----------------------------------------------------------------------
+
+    CFG_FWUPDATE_STAGINGSECTOR  First 4KB flash sector of the staging area
+                                that core/iap/fwupdate.c receives new
+                                images into.  The application must end
+                                below it, and images can be no larger
+                                than either half (4 = 16KB each way).
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      #define CFG_FWUPDATE_STAGINGSECTOR    (4)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      #define CFG_FWUPDATE_STAGINGSECTOR    (4)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      #define CFG_FWUPDATE_STAGINGSECTOR    (4)
+    #endif
+/*=========================================================================*/
+
+
+/*=========================================================================
+    FLASH STORAGE
+    -----------------------------------------------------------------------
+
+    CFG_FLASHSTORE              If defined, core/iap/flashstore.c keeps
+                                read-mostly data (calibration or lookup
+                                tables, fonts, ...) in the top flash
+                                sectors, written with IAP and read
+                                through plain pointers (FLASHSTORE_PTR)
+    CFG_FLASHSTORE_FIRSTSECTOR  First 4KB flash sector of the storage
+                                area.  The application must end below
+                                it, and the firmware update staging area
+                                (CFG_FWUPDATE_STAGINGSECTOR) stops below
+                                it, reducing the largest update.
+    CFG_FLASHSTORE_SECTORS      Number of 4KB sectors in the storage area
+    -----------------------------------------------------------------------*/
+    #ifdef CFG_BRD_LPC1343_REFDESIGN
+      // #define CFG_FLASHSTORE
+      #define CFG_FLASHSTORE_FIRSTSECTOR    (7)
+      #define CFG_FLASHSTORE_SECTORS        (1)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_TFTLCDSTANDALONE
+      // #define CFG_FLASHSTORE
+      #define CFG_FLASHSTORE_FIRSTSECTOR    (7)
+      #define CFG_FLASHSTORE_SECTORS        (1)
+    #endif
+
+    #ifdef CFG_BRD_LPC1343_802154USBSTICK
+      // #define CFG_FLASHSTORE
+      #define CFG_FLASHSTORE_FIRSTSECTOR    (7)
+      #define CFG_FLASHSTORE_SECTORS        (1)
     #endif
 /*=========================================================================*/
 
@@ -805,6 +2039,9 @@
   #error "CFG_PRINTF_UART or CFG_PRINTF_USBCDC cannot both be defined at once"
 #endif
 
+#if defined CFG_USBCDC && ((CFG_USBCDC_BUFFERSIZE & (CFG_USBCDC_BUFFERSIZE - 1)) || CFG_USBCDC_BUFFERSIZE > 32768)
+  #error "CFG_USBCDC_BUFFERSIZE must be a power of two (max 32768)"
+#endif
 #if defined CFG_PRINTF_USBCDC && !defined CFG_USBCDC
   #error "CFG_PRINTF_CDC requires CFG_USBCDC to be defined as well"
 #endif
@@ -812,6 +2049,18 @@
 #if defined CFG_USBCDC && defined CFG_USBHID
   #error "Only one USB class can be defined at a time (CFG_USBCDC or CFG_USBHID)"
 #endif
+#if defined CFG_USBCDC_MSC && (!defined CFG_USBCDC || !defined CFG_SDCARD)
+  #error "CFG_USBCDC_MSC requires CFG_USBCDC and CFG_SDCARD to be defined as well"
+#endif
+#if defined CFG_USBCDC_MSC && defined CFG_USBCDC_VENDORBULK
+  #error "CFG_USBCDC_MSC and CFG_USBCDC_VENDORBULK both use EP2"
+#endif
+#if defined CFG_USBHID && ((CFG_USBHID_REPORTQUEUE & (CFG_USBHID_REPORTQUEUE - 1)) || CFG_USBHID_REPORTQUEUE == 0)
+  #error "CFG_USBHID_REPORTQUEUE must be a power of two"
+#endif
+#if defined CFG_USBHID && (CFG_USBHID_REPORTSPERPACKET < 1 || CFG_USBHID_REPORTSPERPACKET > 2)
+  #error "CFG_USBHID_REPORTSPERPACKET must be 1 or 2"
+#endif
 
 #if defined CFG_SSP0_SCKPIN_2_11 && defined CFG_SSP0_SCKPIN_0_6
   #error "Only one SCK pin can be defined at a time for SSP0"
@@ -821,6 +2070,119 @@
   #error "An SCK pin must be selected for SSP0 (CFG_SSP0_SCKPIN_2_11 or CFG_SSP0_SCKPIN_0_6)"
 #endif
 
+#if (CFG_UART_BUFSIZE & (CFG_UART_BUFSIZE - 1)) || CFG_UART_BUFSIZE > 32768
+  #error "CFG_UART_BUFSIZE must be a power of two (max 32768)"
+#endif
+#if (CFG_UART_TXBUFSIZE & (CFG_UART_TXBUFSIZE - 1)) || CFG_UART_TXBUFSIZE > 32768
+  #error "CFG_UART_TXBUFSIZE must be a power of two (max 32768)"
+#endif
+#ifdef CFG_UART_RS485
+  #if defined CFG_PRINTF_UART
+    #error "CFG_UART_RS485 and CFG_PRINTF_UART can't share the UART"
+  #endif
+  #if defined CFG_CAPTURE
+    #error "CFG_UART_RS485 uses pin 1.5 (RTS) for DE, which is also used by CFG_CAPTURE"
+  #endif
+  #if defined CFG_TFTLCD && defined CFG_TFTLCD_16BIT && CFG_TFTLCD_16BIT == 1
+    #error "CFG_TFTLCD_16BIT uses pins 1.5-1.7, which are also used by CFG_UART_RS485"
+  #endif
+  #if CFG_UART_RS485_ADDRESS > 254
+    #error "CFG_UART_RS485_ADDRESS must be between 0 and 254"
+  #endif
+  #if CFG_UART_RS485_MAXPAYLOAD < 1 || CFG_UART_RS485_MAXPAYLOAD > 250
+    #error "CFG_UART_RS485_MAXPAYLOAD must be between 1 and 250"
+  #endif
+  #if CFG_UART_RS485_MAXPAYLOAD + 6 > CFG_UART_TXBUFSIZE
+    #error "CFG_UART_TXBUFSIZE must hold a whole RS-485 frame (CFG_UART_RS485_MAXPAYLOAD + 6)"
+  #endif
+  #if CFG_UART_RS485_RXFRAMES < 1 || CFG_UART_RS485_RXFRAMES > 128 || (CFG_UART_RS485_RXFRAMES & (CFG_UART_RS485_RXFRAMES - 1))
+    #error "CFG_UART_RS485_RXFRAMES must be a power of two (max 128)"
+  #endif
+  #if CFG_UART_RS485_DEDELAY > 255
+    #error "CFG_UART_RS485_DEDELAY must be between 0 and 255"
+  #endif
+#endif
+
+#if CFG_IRQ_SUBPRIOBITS > 2
+  #error "CFG_IRQ_SUBPRIOBITS must be 0, 1 or 2"
+#endif
+#if CFG_IRQPRIO_RADIO > 7 || CFG_IRQPRIO_UART > 7 || CFG_IRQPRIO_TIMER > 7 || CFG_IRQPRIO_SYSTICK > 7 || \
+    CFG_IRQPRIO_GPIO > 7 || CFG_IRQPRIO_PERIPH > 7 || CFG_IRQPRIO_USB > 7
+  #error "The CFG_IRQPRIO_... values must be between 0 and 7"
+#endif
+#if (CFG_IRQPRIO_RADIO >> CFG_IRQ_SUBPRIOBITS) == 0
+  #error "CFG_IRQPRIO_RADIO can't be in the highest preemption level (BASEPRI can't mask it)"
+#endif
+
+#if defined CFG_BENCH && !defined CFG_INTERFACE
+  #error "CFG_BENCH requires CFG_INTERFACE to be defined as well"
+#endif
+#if defined CFG_ISRSTATS && !defined CFG_INTERFACE
+  #error "CFG_ISRSTATS requires CFG_INTERFACE to be defined as well"
+#endif
+#if defined CFG_PROFILER && defined CFG_USBHID
+  #error "CFG_PROFILER and CFG_USBHID both use 32-bit timer 1"
+#endif
+#if defined CFG_SCHEDULER_TICKLESS && !defined CFG_SCHEDULER
+  #error "CFG_SCHEDULER_TICKLESS requires CFG_SCHEDULER to be defined as well"
+#endif
+#if defined CFG_SCHEDULER_TICKLESS && (defined CFG_PROFILER || defined CFG_USBHID)
+  #error "CFG_SCHEDULER_TICKLESS uses 32-bit timer 1 (not available with CFG_PROFILER or CFG_USBHID)"
+#endif
+#if defined CFG_SCHEDULER_TICKLESS && (CFG_SCHEDULER_TICKLESS_MAXMS < 1 || CFG_SCHEDULER_TICKLESS_MAXMS > 59000)
+  #error "CFG_SCHEDULER_TICKLESS_MAXMS must be between 1 and 59000"
+#endif
+#if defined CFG_SCHEDULER_DEEPSLEEP && !defined CFG_SCHEDULER_TICKLESS
+  #error "CFG_SCHEDULER_DEEPSLEEP requires CFG_SCHEDULER_TICKLESS to be defined as well"
+#endif
+#if defined CFG_SCHEDULER_DEFERINIT && !defined CFG_SCHEDULER
+  #error "CFG_SCHEDULER_DEFERINIT requires CFG_SCHEDULER to be defined as well"
+#endif
+#if defined CFG_WDT_SUPERVISOR && defined CFG_SCHEDULER_DEEPSLEEP
+  #error "CFG_WDT_SUPERVISOR can't be used with CFG_SCHEDULER_DEEPSLEEP"
+#endif
+#if defined CFG_WDT_SUPERVISOR && defined CFG_SCHEDULER_TICKLESS && (CFG_WDT_SUPERVISOR_TIMEOUTMS <= CFG_SCHEDULER_TICKLESS_MAXMS)
+  #error "CFG_WDT_SUPERVISOR_TIMEOUTMS must be longer than CFG_SCHEDULER_TICKLESS_MAXMS"
+#endif
+#if defined CFG_SWTIMER && (defined CFG_PROFILER || defined CFG_USBHID || defined CFG_SCHEDULER_TICKLESS)
+  #error "CFG_SWTIMER uses 32-bit timer 1 (not available with CFG_PROFILER, CFG_USBHID or CFG_SCHEDULER_TICKLESS)"
+#endif
+
+#ifdef CFG_POOL
+  #if (CFG_POOL_SMALLSIZE % 4) || (CFG_POOL_MEDIUMSIZE % 4) || (CFG_POOL_LARGESIZE % 4)
+    #error "CFG_POOL_SMALLSIZE, CFG_POOL_MEDIUMSIZE and CFG_POOL_LARGESIZE must be multiples of 4"
+  #endif
+  #if (CFG_POOL_SMALLSIZE < 4) || (CFG_POOL_MEDIUMSIZE <= CFG_POOL_SMALLSIZE) || (CFG_POOL_LARGESIZE <= CFG_POOL_MEDIUMSIZE)
+    #error "CFG_POOL block sizes must be in increasing order"
+  #endif
+  #if (CFG_POOL_SMALLCOUNT < 1) || (CFG_POOL_SMALLCOUNT > 255) || (CFG_POOL_MEDIUMCOUNT < 1) || (CFG_POOL_MEDIUMCOUNT > 255) || (CFG_POOL_LARGECOUNT < 1) || (CFG_POOL_LARGECOUNT > 255)
+    #error "CFG_POOL block counts must be between 1 and 255"
+  #endif
+#endif
+#if defined CFG_PROFILER && (CFG_PROFILER_BUCKETSHIFT < 4 || CFG_PROFILER_BUCKETSHIFT > 12)
+  #error "CFG_PROFILER_BUCKETSHIFT must be between 4 and 12"
+#endif
+
+#ifdef CFG_LOGIC
+  #if !defined CFG_USBCDC_VENDORBULK
+    #error "CFG_LOGIC requires CFG_USBCDC_VENDORBULK to send the captures to the host"
+  #endif
+  #if defined CFG_TFTLCD_REMOTE && CFG_TFTLCD_REMOTE == 1
+    #error "CFG_LOGIC and CFG_TFTLCD_REMOTE both use the vendor bulk endpoint"
+  #endif
+  #ifdef CFG_MCP4725_STREAM
+    #error "CFG_LOGIC and CFG_MCP4725_STREAM both use 16-bit timer 0"
+  #endif
+  #if CFG_LOGIC_SAMPLES < 64 || CFG_LOGIC_SAMPLES > 2048 || (CFG_LOGIC_SAMPLES & (CFG_LOGIC_SAMPLES - 1))
+    #error "CFG_LOGIC_SAMPLES must be a power of two between 64 and 2048"
+  #endif
+#endif
+
+#ifdef CFG_TRACE
+  #if CFG_TRACE_ENTRIES < 2 || (CFG_TRACE_ENTRIES & (CFG_TRACE_ENTRIES - 1))
+    #error "CFG_TRACE_ENTRIES must be a power of two"
+  #endif
+#endif
 #ifdef CFG_INTERFACE
   #if !defined CFG_PRINTF_UART && !defined CFG_PRINTF_USBCDC
     #error "CFG_PRINTF_UART or CFG_PRINTF_USBCDC must be defined for for CFG_INTERFACE Input/Output"
@@ -828,14 +2190,96 @@
   #if defined CFG_PRINTF_USBCDC && CFG_INTERFACE_SILENTMODE == 1
     #error "CFG_INTERFACE_SILENTMODE typically isn't enabled with CFG_PRINTF_USBCDC"
   #endif
+  #if CFG_INTERFACE_SCRIPTS != 0 && CFG_INTERFACE_SCRIPTS != 1
+    #error "CFG_INTERFACE_SCRIPTS must be equal to either 1 or 0"
+  #endif
+  #if CFG_INTERFACE_SCRIPTS == 1 && !defined CFG_SDCARD
+    #error "CFG_INTERFACE_SCRIPTS requires CFG_SDCARD to be defined as well"
+  #endif
+#endif
+
+#ifdef CFG_ADC_BURST
+  #if (CFG_ADC_RINGSIZE & (CFG_ADC_RINGSIZE - 1)) || CFG_ADC_RINGSIZE < 2 || CFG_ADC_RINGSIZE > 256
+    #error "CFG_ADC_RINGSIZE must be a power of 2 between 2 and 256"
+  #endif
+#endif
+
+#if CFG_ADC_OVERSAMPLE < 1 || CFG_ADC_OVERSAMPLE > 16
+  #error "CFG_ADC_OVERSAMPLE must be between 1 and 16"
+#endif
+
+#ifdef CFG_MCP4725_STREAM
+  #if CFG_MCP4725_STREAM_BURST < 1 || CFG_MCP4725_STREAM_BURST > 8
+    #error "CFG_MCP4725_STREAM_BURST must be between 1 and 8"
+  #endif
+#endif
+
+#ifdef CFG_ADC_TRIGGER
+  #if defined CFG_CHIBI_TIMESTAMP || defined CFG_SCHEDULER_DEEPSLEEP || defined CFG_STEPPER
+    #error "CFG_ADC_TRIGGER needs 32-bit timer 0 (also used by CFG_CHIBI_TIMESTAMP, CFG_SCHEDULER_DEEPSLEEP and CFG_STEPPER)"
+  #endif
+#endif
+
+#ifdef CFG_SCOPE
+  #ifndef CFG_ADC_TRIGGER
+    #error "CFG_SCOPE requires CFG_ADC_TRIGGER"
+  #endif
+  #if (CFG_SCOPE_SAMPLES & (CFG_SCOPE_SAMPLES - 1)) || CFG_SCOPE_SAMPLES < 64 || CFG_SCOPE_SAMPLES > 2048
+    #error "CFG_SCOPE_SAMPLES must be a power of 2 between 64 and 2048"
+  #endif
+#endif
+
+#ifdef CFG_CAPTURE
+  #if defined CFG_ADC_TRIGGER || defined CFG_CHIBI_TIMESTAMP || defined CFG_SCHEDULER_DEEPSLEEP || defined CFG_STEPPER
+    #error "CFG_CAPTURE needs 32-bit timer 0 (also used by CFG_ADC_TRIGGER, CFG_CHIBI_TIMESTAMP, CFG_SCHEDULER_DEEPSLEEP and CFG_STEPPER)"
+  #endif
+  #if CFG_CAPTURE_SAMPLES < 1 || CFG_CAPTURE_SAMPLES > 16
+    #error "CFG_CAPTURE_SAMPLES must be between 1 and 16"
+  #endif
+  #if CFG_CAPTURE_TIMEOUTMS < CFG_SYSTICK_DELAY_IN_MS || CFG_CAPTURE_TIMEOUTMS > 1000
+    #error "CFG_CAPTURE_TIMEOUTMS must be at least one systick and no more than 1000"
+  #endif
 #endif
 
 #ifdef CFG_CHIBI
+  #if CFG_CHIBI_DUPCACHE < 1 || CFG_CHIBI_DUPCACHE > 16
+    #error "CFG_CHIBI_DUPCACHE must be between 1 and 16"
+  #endif
+  #if CFG_CHIBI_BCAST_REPEAT < 1 || CFG_CHIBI_BCAST_REPEAT > 4
+    #error "CFG_CHIBI_BCAST_REPEAT must be between 1 and 4"
+  #endif
+  #if defined CFG_CHIBI_ADAPTIVE && CFG_CHIBI_LINKSTATS == 0
+    #error "CFG_CHIBI_ADAPTIVE requires CFG_CHIBI_LINKSTATS"
+  #endif
+  #if CFG_CHIBI_AGGR_SLOTS < 1 || CFG_CHIBI_AGGR_SLOTS > 4
+    #error "CFG_CHIBI_AGGR_SLOTS must be between 1 and 4"
+  #endif
+  #if CFG_CHIBI_ROUTES < 1 || CFG_CHIBI_ROUTES > 16
+    #error "CFG_CHIBI_ROUTES must be between 1 and 16 (see CFG_EEPROM_CHIBI_ROUTES)"
+  #endif
+  #if defined CFG_CHIBI_LPL && !defined CFG_SCHEDULER
+    #error "CFG_CHIBI_LPL requires CFG_SCHEDULER to be defined as well"
+  #endif
+  #if defined CFG_CHIBI_TSYNC && (CFG_CHIBI_TSYNC_POINTS < 2 || CFG_CHIBI_TSYNC_POINTS > 16)
+    #error "CFG_CHIBI_TSYNC_POINTS must be between 2 and 16"
+  #endif
+  #if defined CFG_CHIBI_TSYNC && CFG_CHIBI_TSYNC_PERIODMS < 1000
+    #error "CFG_CHIBI_TSYNC_PERIODMS must be at least 1000"
+  #endif
+  #if defined CFG_CHIBI_LPL && (CFG_CHIBI_LPL_LISTENMS < CFG_SYSTICK_DELAY_IN_MS || CFG_CHIBI_LPL_LISTENMS >= CFG_CHIBI_LPL_INTERVALMS)
+    #error "CFG_CHIBI_LPL_LISTENMS must be at least one systick and shorter than CFG_CHIBI_LPL_INTERVALMS"
+  #endif
+  #if defined CFG_CHIBI_TIMESTAMP && (defined CFG_SCHEDULER_DEEPSLEEP || defined CFG_STEPPER)
+    #error "CFG_CHIBI_TIMESTAMP needs 32-bit timer 0 (also used by CFG_SCHEDULER_DEEPSLEEP and CFG_STEPPER)"
+  #endif
+  #if CFG_CHIBI_XPORT_WINDOW < 1 || CFG_CHIBI_XPORT_WINDOW > 8
+    #error "CFG_CHIBI_XPORT_WINDOW must be between 1 and 8"
+  #endif
   #if !defined CFG_I2CEEPROM
     #error "CFG_CHIBI requires CFG_I2CEEPROM to store and retrieve addresses"
   #endif
   #ifdef CFG_SDCARD
-    #error "CFG_CHIBI and CFG_SDCARD can not be defined at the same time. Only one SPI block is available on the LPC1343."
+    #error "CFG_CHIBI and CFG_SDCARD can not be defined at the same time since they both use pin 0.2 as chip select (SSP0 itself can be shared, see sspDeviceAcquire)."
   #endif
   #ifdef CFG_TFTLCD
     #error "CFG_CHIBI and CFG_TFTLCD can not be defined at the same time since they both use pins 1.8, 1.9 and 1.10."
@@ -848,6 +2292,24 @@
   #endif
 #endif
 
+#ifdef CFG_STEPPER
+  #if CFG_STEPPER_AXES < 1 || CFG_STEPPER_AXES > 4
+    #error "CFG_STEPPER_AXES must be between 1 and 4"
+  #endif
+  #if CFG_STEPPER_QUEUESIZE < 2 || CFG_STEPPER_QUEUESIZE > 32
+    #error "CFG_STEPPER_QUEUESIZE must be between 2 and 32"
+  #endif
+  #if defined CFG_ENCODER && CFG_STEPPER_ENCODER_TOLERANCE < 1
+    #error "CFG_STEPPER_ENCODER_TOLERANCE must be at least 1"
+  #endif
+  #if CFG_STEPPER_MICROSTEPS != 1 && CFG_STEPPER_MICROSTEPS != 2 && CFG_STEPPER_MICROSTEPS != 4 && CFG_STEPPER_MICROSTEPS != 8 && CFG_STEPPER_MICROSTEPS != 16
+    #error "CFG_STEPPER_MICROSTEPS must be 1, 2, 4, 8 or 16"
+  #endif
+  #if CFG_STEPPER_MICROSTEPS > 1 && (defined CFG_CHIBI || defined CFG_TFTLCD || defined CFG_ST7565)
+    #error "CFG_STEPPER_MICROSTEPS > 1 needs pins 1.9 and 1.10 (also used by CFG_CHIBI, CFG_TFTLCD and CFG_ST7565)"
+  #endif
+#endif
+
 #ifdef CFG_TFTLCD
   #ifdef CFG_ST7565
     #error "CFG_TFTLCD and CFG_ST7565 can not be defined at the same time."
@@ -861,12 +2323,121 @@
   #if !defined CFG_I2CEEPROM
     #error "CFG_TFTLCD requires CFG_I2CEEPROM to store and retrieve configuration settings"
   #endif
+  #if CFG_TFTLCD_16BIT != 0 && CFG_TFTLCD_16BIT != 1
+    #error "CFG_TFTLCD_16BIT must be equal to either 1 or 0"
+  #endif
+  #if CFG_TFTLCD_16BIT == 1 && defined CFG_PRINTF_UART
+    #error "CFG_TFTLCD_16BIT uses pins 1.6 and 1.7 for the high data byte by default, which are also used by CFG_PRINTF_UART"
+  #endif
+  #if CFG_TFTLCD_TILEBUFFER < 0 || CFG_TFTLCD_TILEBUFFER > 2048
+    #error "CFG_TFTLCD_TILEBUFFER must be between 0 and 2048 pixels"
+  #endif
+  #if CFG_TFTLCD_WIDGETS < 0 || CFG_TFTLCD_WIDGETS > 64
+    #error "CFG_TFTLCD_WIDGETS must be between 0 and 64"
+  #endif
+  #if CFG_TFTLCD_SPRITES < 0 || CFG_TFTLCD_SPRITES > 32
+    #error "CFG_TFTLCD_SPRITES must be between 0 and 32"
+  #endif
+  #if CFG_TFTLCD_SPRITES > 0 && CFG_TFTLCD_TILEBUFFER == 0
+    #error "CFG_TFTLCD_SPRITES requires CFG_TFTLCD_TILEBUFFER to compose frames without flicker"
+  #endif
+  #if CFG_TFTLCD_FONTCACHE < 0 || CFG_TFTLCD_FONTCACHE > 32
+    #error "CFG_TFTLCD_FONTCACHE must be between 0 and 32"
+  #endif
+  #if CFG_TFTLCD_FONTCACHE > 0 && !defined CFG_SDCARD
+    #error "CFG_TFTLCD_FONTCACHE requires CFG_SDCARD to load fonts from the card"
+  #endif
+  #if CFG_TFTLCD_JPEG == 1 && !defined CFG_SDCARD
+    #error "CFG_TFTLCD_JPEG requires CFG_SDCARD to read images from the card"
+  #endif
+  #if CFG_TFTLCD_REMOTE == 1 && !defined CFG_USBCDC_VENDORBULK
+    #error "CFG_TFTLCD_REMOTE requires CFG_USBCDC_VENDORBULK to send the screen to the host"
+  #endif
+  #ifdef CFG_TFTLCD_TS_IRQ
+    #if CFG_TFTLCD_TS_QUEUESIZE < 2 || CFG_TFTLCD_TS_QUEUESIZE > 32
+      #error "CFG_TFTLCD_TS_QUEUESIZE must be between 2 and 32"
+    #endif
+    #if CFG_TFTLCD_TS_SAMPLEMS < 2
+      #error "CFG_TFTLCD_TS_SAMPLEMS must be at least 2, each reading takes ~0.5ms in the systick interrupt"
+    #endif
+    #ifdef CFG_SCHEDULER_TICKLESS
+      #error "CFG_TFTLCD_TS_IRQ samples from the systick interrupt, which CFG_SCHEDULER_TICKLESS stops while idle"
+    #endif
+  #endif
+#endif
+
+#if CFG_EEPROM_SHADOWSIZE < 0 || CFG_EEPROM_SHADOWSIZE > 1024
+  #error "CFG_EEPROM_SHADOWSIZE must be between 0 and 1024 bytes"
+#endif
+
+#ifdef CFG_EEPROM_AT25040
+  #if CFG_EEPROM_KV_START + CFG_EEPROM_KV_SIZE > 0x0200 || CFG_EEPROM_SHADOWSTART + CFG_EEPROM_SHADOWSIZE > 0x0200
+    #error "CFG_EEPROM_AT25040 only has 512 bytes, reduce CFG_EEPROM_KV_SIZE and CFG_EEPROM_SHADOWSIZE to fit"
+  #endif
+  #if CFG_EEPROM_LOG_START + CFG_EEPROM_LOG_SIZE > 0x0200
+    #error "CFG_EEPROM_AT25040 only has 512 bytes, move CFG_EEPROM_LOG_START and reduce CFG_EEPROM_LOG_SIZE to fit"
+  #endif
+  #ifdef CFG_SDCARD
+    #error "CFG_EEPROM_AT25040 and CFG_SDCARD can not be defined at the same time since they both use pin 0.2 as chip select"
+  #endif
+  #ifdef CFG_CHIBI
+    #error "CFG_EEPROM_AT25040 and CFG_CHIBI can not be defined at the same time since they both use pin 0.2 as chip select"
+  #endif
+#endif
+
+#if CFG_EEPROM_KV_START <= CFG_EEPROM_RESERVED
+  #error "CFG_EEPROM_KV_START must be above CFG_EEPROM_RESERVED"
+#endif
+#if CFG_EEPROM_KV_MAXVALUE < 1 || CFG_EEPROM_KV_MAXVALUE > 255
+  #error "CFG_EEPROM_KV_MAXVALUE must be between 1 and 255"
+#endif
+#if 4 + CFG_EEPROM_KV_MAXKEYS * (CFG_EEPROM_KV_MAXVALUE + 4) > CFG_EEPROM_KV_SIZE / 2
+  #error "CFG_EEPROM_KV_SIZE is too small to compact CFG_EEPROM_KV_MAXKEYS values"
+#endif
+#if CFG_EEPROM_LOG_START <= CFG_EEPROM_RESERVED
+  #error "CFG_EEPROM_LOG_START must be above CFG_EEPROM_RESERVED"
+#endif
+#if CFG_EEPROM_LOG_START % 16 != 0 || CFG_EEPROM_LOG_SIZE % 16 != 0 || CFG_EEPROM_LOG_SIZE < 32
+  #error "CFG_EEPROM_LOG_START and CFG_EEPROM_LOG_SIZE must be multiples of 16 (with room for at least 2 events)"
+#endif
+#if CFG_EEPROM_LOG_START < CFG_EEPROM_KV_START + CFG_EEPROM_KV_SIZE && CFG_EEPROM_KV_START < CFG_EEPROM_LOG_START + CFG_EEPROM_LOG_SIZE
+  #error "CFG_EEPROM_LOG_START/SIZE overlaps the key/value store"
+#endif
+#if defined CFG_I2CEEPROM_SIZE && !defined CFG_EEPROM_AT25040 && CFG_EEPROM_LOG_START + CFG_EEPROM_LOG_SIZE > CFG_I2CEEPROM_SIZE
+  #error "CFG_EEPROM_LOG_START + CFG_EEPROM_LOG_SIZE is larger than CFG_I2CEEPROM_SIZE"
 #endif
 
 #ifdef CFG_SDCARD
   #ifdef CFG_STEPPER
     #error  "CFG_SDCARD and CFG_STEPPER can not be defined at the same time since they both use pin 3.0."
   #endif
+  #if CFG_SDCARD_CACHESECTORS < 0 || CFG_SDCARD_CACHESECTORS > 8
+    #error "CFG_SDCARD_CACHESECTORS must be between 0 and 8"
+  #endif
+  #if CFG_SDCARD_DIRCACHE < 0 || CFG_SDCARD_DIRCACHE > 32
+    #error "CFG_SDCARD_DIRCACHE must be between 0 and 32"
+  #endif
+  #if CFG_SDCARD_DATALOG != 0 && (CFG_SDCARD_DATALOG < 2 || CFG_SDCARD_DATALOG > 8)
+    #error "CFG_SDCARD_DATALOG must be 0 or between 2 and 8"
+  #endif
+  #if CFG_SDCARD_DATALOG > 0 && CFG_SDCARD_READONLY != 0
+    #error "CFG_SDCARD_DATALOG requires CFG_SDCARD_READONLY to be 0"
+  #endif
+  #if defined CFG_SDCARD_DATALOG_LZ && CFG_SDCARD_DATALOG == 0
+    #error "CFG_SDCARD_DATALOG_LZ requires CFG_SDCARD_DATALOG"
+  #endif
+  #if defined CFG_SDCARD_REENTRANT && !defined CFG_SCHEDULER
+    #error "CFG_SDCARD_REENTRANT requires CFG_SCHEDULER to be defined as well"
+  #endif
+  #if defined CFG_SDCARD_TRIM && CFG_SDCARD_READONLY != 0
+    #error "CFG_SDCARD_TRIM requires CFG_SDCARD_READONLY to be 0"
+  #endif
+  #if CFG_SDCARD_STATS != 0 && CFG_SDCARD_STATS != 1
+    #error "CFG_SDCARD_STATS must be 0 or 1"
+  #endif
+  #if CFG_SDCARD_MAXCLOCK < 400000 || CFG_SDCARD_MAXCLOCK > 36000000
+    #error "CFG_SDCARD_MAXCLOCK must be between 400000 and 36000000"
+  #endif
 #endif
 
 #ifdef CFG_ST7565
@@ -879,6 +2450,35 @@
   #if CFG_RSA_BITS != 64 && CFG_RSA_BITS != 32
     #error "CFG_RSA_BITS must be equal to either 32 or 64."
   #endif
+  #if CFG_RSA_MAXBITS < 64 || CFG_RSA_MAXBITS > 2048 || (CFG_RSA_MAXBITS % 32)
+    #error "CFG_RSA_MAXBITS must be a multiple of 32 between 64 and 2048"
+  #endif
+  #if CFG_RSA_WINDOW < 1 || CFG_RSA_WINDOW > 5
+    #error "CFG_RSA_WINDOW must be between 1 and 5"
+  #endif
+#endif
+
+#if CFG_AES_TTABLES != 0 && CFG_AES_TTABLES != 1 && CFG_AES_TTABLES != 4
+  #error "CFG_AES_TTABLES must be 0, 1 or 4"
+#endif
+
+#ifdef CFG_RANDOM
+  #if CFG_RANDOM_ADCCHANNEL > 3
+    #error "CFG_RANDOM_ADCCHANNEL must be 0..3 (only these channels are configured in adcInit)"
+  #endif
+#endif
+
+#if CFG_FWUPDATE_STAGINGSECTOR < 1 || CFG_FWUPDATE_STAGINGSECTOR > 7
+  #error "CFG_FWUPDATE_STAGINGSECTOR must be between 1 and 7"
+#endif
+
+#ifdef CFG_FLASHSTORE
+  #if CFG_FLASHSTORE_SECTORS < 1 || CFG_FLASHSTORE_FIRSTSECTOR < 1 || CFG_FLASHSTORE_FIRSTSECTOR + CFG_FLASHSTORE_SECTORS > 8
+    #error "CFG_FLASHSTORE_FIRSTSECTOR and CFG_FLASHSTORE_SECTORS must describe at least one sector between 1 and 7"
+  #endif
+  #if CFG_FWUPDATE_STAGINGSECTOR >= CFG_FLASHSTORE_FIRSTSECTOR
+    #error "CFG_FWUPDATE_STAGINGSECTOR must be below CFG_FLASHSTORE_FIRSTSECTOR"
+  #endif
 #endif
 
 #endif
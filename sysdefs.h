@@ -57,6 +57,20 @@ typedef unsigned char byte_t;
 #define pREG16 (REG16 *)
 #define pREG32 (REG32 *)
 
+// Compiles a single function for speed in a file otherwise optimised
+// for size (whole files can be added to HOT_OBJS in the Makefile)
+#define HOTFUNC __attribute__ ((optimize("O2")))
+
+// Places a function in SRAM (copied with .data by the startup code) so
+// it runs without flash wait states.  Keep these few and small since
+// every byte comes out of the 8KB of SRAM.
+#define RAMFUNC __attribute__ ((section(".ramfunc"), long_call))
+
+// Places a variable in SRAM that the startup code neither copies nor
+// clears, so it keeps its value through a watchdog or software reset
+// (but not a power cycle).  Don't give these an initial value.
+#define NOINIT __attribute__ ((section(".noinit")))
+
 #ifndef NULL
 #define NULL ((void *) 0)
 #endif
@@ -45,8 +45,9 @@
 #include "core/cpu/cpu.h"
 #include "core/pmu/pmu.h"
 #include "core/adc/adc.h"
+#include "core/delay/delay.h"
 
-#ifdef CFG_PRINTF_UART
+#if defined CFG_PRINTF_UART || defined CFG_UART_RS485
   #include "core/uart/uart.h"
 #endif
 
@@ -54,16 +55,27 @@
   #include "core/cmd/cmd.h"
 #endif
 
+#ifdef CFG_ISRSTATS
+  #include "core/bench/isrstats.h"
+#endif
+
+#ifdef CFG_TRACE
+  #include "core/bench/trace.h"
+#endif
+
 #ifdef CFG_CHIBI
   #include "drivers/chibi/chb.h"
 #endif
 
+#ifdef CFG_RANDOM
+  #include "drivers/crypto/random.h"
+#endif
+
 #ifdef CFG_USBHID
   #include "core/usbhid-rom/usbhid.h"
 #endif
 
 #ifdef CFG_USBCDC
-  volatile unsigned int lastTick;
   #include "core/usbcdc/usb.h"
   #include "core/usbcdc/usbcore.h"
   #include "core/usbcdc/usbhw.h"
@@ -92,10 +104,26 @@
   #include "drivers/eeprom/eeprom.h"
 #endif
 
+#ifdef CFG_SWTIMER
+  #include "core/timer32/swtimer.h"
+#endif
+
+#ifdef CFG_LOGIC
+  #include "core/logic/logic.h"
+#endif
+
+#ifdef CFG_WDT_SUPERVISOR
+  #include "core/wdt/supervisor.h"
+#endif
+
 #ifdef CFG_PWM
   #include "core/pwm/pwm.h"
 #endif
 
+#ifdef CFG_SCHEDULER_DEFERINIT
+  #include "core/sched/sched.h"
+#endif
+
 #ifdef CFG_SDCARD
   #include "core/ssp/ssp.h"
   #include "drivers/fatfs/diskio.h"
@@ -108,6 +136,174 @@
   }
 #endif
 
+static sysinitPhase_t sysinitPhases[SYSINIT_MAXPHASES];
+static uint8_t sysinitPhaseCount;
+static bool sysinitComplete;
+
+#ifdef CFG_USBCDC
+  static uint32_t sysinitUsbStart;
+#endif
+
+/**************************************************************************/
+/*! 
+    @brief  Records the time at which a boot phase finished
+*/
+/**************************************************************************/
+static void sysinitMark(const char *name)
+{
+  if (sysinitPhaseCount < SYSINIT_MAXPHASES)
+  {
+    sysinitPhases[sysinitPhaseCount].name = name;
+    sysinitPhases[sysinitPhaseCount].timeUs = systickGetMicros();
+    sysinitPhaseCount++;
+  }
+}
+
+#ifdef CFG_USBCDC
+/**************************************************************************/
+/*! 
+    @brief  Returns true once USB is configured or CFG_USBCDC_INITTIMEOUT
+            has passed since USB_Connect
+*/
+/**************************************************************************/
+static bool sysinitUsbReady(void)
+{
+  return USB_Configuration ||
+         (systickGetTicks() - sysinitUsbStart >= CFG_USBCDC_INITTIMEOUT / CFG_SYSTICK_DELAY_IN_MS);
+}
+#endif
+
+#if defined CFG_ST7565 || defined CFG_SSD1306 || defined CFG_TFTLCD
+/**************************************************************************/
+/*! 
+    @brief  Initialises the display, which needs long reset and power-up
+            delays
+*/
+/**************************************************************************/
+static bool sysinitDisplay(void)
+{
+  // Initialise the ST7565 128x64 pixel display
+  #ifdef CFG_ST7565
+    st7565Init();
+    st7565ClearScreen();    // Clear the screen  
+    st7565Backlight(1);     // Enable the backlight
+  #endif
+
+  // Initialise the SSD1306 OLED display
+  #ifdef CFG_SSD1306
+    ssd1306Init(SSD1306_SWITCHCAPVCC);
+    ssd1306ClearScreen();   // Clear the screen  
+  #endif
+
+  // Initialise TFT LCD Display
+  #ifdef CFG_TFTLCD
+    lcdInit();
+  #endif
+
+  sysinitMark("Display");
+  return true;
+}
+#endif
+
+#ifdef CFG_CHIBI
+/**************************************************************************/
+/*! 
+    @brief  Resets and initialises the AT86RF212 transceiver
+*/
+/**************************************************************************/
+static bool sysinitChibi(void)
+{
+  // Warning: CFG_CHIBI must be disabled if no antenna is connected,
+  // otherwise the SW will halt during initialisation
+  // Write addresses to EEPROM for the first time if necessary
+  // uint16_t addr_short = 0x0025;
+  // uint64_t addr_ieee =  0x0000000000000025;
+  // mcp24aaWriteBuffer(CFG_EEPROM_CHIBI_SHORTADDR, (uint8_t *)&addr_short, 2);
+  // mcp24aaWriteBuffer(CFG_EEPROM_CHIBI_IEEEADDR, (uint8_t *)&addr_ieee, 8);
+  chb_init();
+  // chb_pcb_t *pcb = chb_get_pcb();
+  // printf("%-40s : 0x%04X%s", "Chibi Initialised", pcb->src_addr, CFG_PRINTF_NEWLINE);
+  #ifdef CFG_RANDOM
+    randomSeedRadio();                      // The radio's noise is the best entropy we have
+  #endif
+
+  sysinitMark("Chibi");
+  return true;
+}
+#endif
+
+#if defined CFG_USBCDC && !defined CFG_PRINTF_USBCDC
+/**************************************************************************/
+/*! 
+    @brief  Waits (one step at a time) for the host to configure USB
+*/
+/**************************************************************************/
+static bool sysinitUsbWait(void)
+{
+  if (!sysinitUsbReady())
+  {
+    return false;
+  }
+  sysinitMark("USB Configured");
+  return true;
+}
+#endif
+
+/**************************************************************************/
+/*! 
+    Optional peripherals that aren't needed for the CLI.  Each step
+    returns false if it has to be called again later.  With
+    CFG_SCHEDULER_DEFERINIT they run as a scheduler task after the CLI
+    is up, one step per pass so that CLI polling and other tasks can
+    run in between, otherwise systemInit runs them in order before
+    starting the CLI.
+*/
+/**************************************************************************/
+static bool (* const sysinitOptional[])(void) =
+{
+  #if defined CFG_USBCDC && !defined CFG_PRINTF_USBCDC
+    sysinitUsbWait,
+  #endif
+  #if defined CFG_ST7565 || defined CFG_SSD1306 || defined CFG_TFTLCD
+    sysinitDisplay,
+  #endif
+  #ifdef CFG_CHIBI
+    sysinitChibi,
+  #endif
+  NULL
+};
+
+#ifdef CFG_SCHEDULER_DEFERINIT
+static schedTask_t sysinitTask;
+static uint8_t sysinitStep;
+
+/**************************************************************************/
+/*! 
+    Runs the next optional initialisation step
+*/
+/**************************************************************************/
+static void sysinitDeferred(schedTask_t *task)
+{
+  if (sysinitOptional[sysinitStep] == NULL)
+  {
+    sysinitMark("Boot Complete");
+    sysinitComplete = true;
+    return;
+  }
+
+  if (sysinitOptional[sysinitStep]())
+  {
+    sysinitStep++;
+    schedPost(task);
+  }
+  else
+  {
+    // Not ready yet (USB enumeration), check again in 10ms
+    schedStartTimer(task, 10, 0);
+  }
+}
+#endif
+
 /**************************************************************************/
 /*! 
     Configures the core system clock and sets up any mandatory
@@ -116,29 +312,55 @@
     This function should set the HW to the default state you wish to be
     in coming out of reset/startup, such as disabling or enabling LEDs,
     setting specific pin states, etc.
+
+    With CFG_SCHEDULER_DEFERINIT, the displays, Chibi and (unless printf
+    goes to USB CDC) USB enumeration are left to a scheduler task, and
+    the CLI is started as soon as the mandatory peripherals are up.
 */
 /**************************************************************************/
 void systemInit()
 {
   cpuInit();                                // Configure the CPU
+  #ifdef CFG_ISRSTATS
+    isrStatReset();                         // Start the cycle counter
+  #endif
+  #ifdef CFG_TRACE
+    traceInit();                            // Anything can TRACE from here on
+  #endif
   systickInit(CFG_SYSTICK_DELAY_IN_MS);     // Start systick timer
+  sysinitMark("CPU/Systick");
+  delayInit();                              // Start the cycle counter for delays
   gpioInit();                               // Enable GPIO
   pmuInit();                                // Configure power management
   adcInit();                                // Config adc pins to save power
+  #ifdef CFG_RANDOM
+    randomInit();                           // Seed the entropy pool from ADC noise
+  #endif
+  #ifdef CFG_SWTIMER
+    swtimerInit();                          // Start the software timer service
+  #endif
+  #ifdef CFG_LOGIC
+    logicInit();                            // Listen for logic analyser captures
+  #endif
+  #ifdef CFG_WDT_SUPERVISOR
+    supervisorInit();                       // Start the watchdog supervisor
+  #endif
 
   // Set LED pin as output and turn LED off
   gpioSetDir(CFG_LED_PORT, CFG_LED_PIN, 1);
   gpioSetValue(CFG_LED_PORT, CFG_LED_PIN, CFG_LED_OFF);
+  sysinitMark("Core Peripherals");
 
   // Initialise EEPROM
   #ifdef CFG_I2CEEPROM
-    mcp24aaInit();
+    eepromInit();
+    sysinitMark("EEPROM");
   #endif
 
   // Initialise UART with the default baud rate
   #ifdef CFG_PRINTF_UART
     uint32_t uart = eepromReadU32(CFG_EEPROM_UART_SPEED);
-    if ((uart == 0xFFFFFFFF) || (uart > 115200))
+    if ((uart == 0xFFFFFFFF) || (uart < UART_BAUDRATE_MIN) || (uart > UART_BAUDRATE_MAX))
     {
       uartInit(CFG_UART_BAUDRATE);  // Use default baud rate
     }
@@ -146,6 +368,13 @@ void systemInit()
     {
       uartInit(uart);               // Use baud rate from EEPROM
     }
+    sysinitMark("UART");
+  #endif
+
+  // Join the RS-485 bus
+  #ifdef CFG_UART_RS485
+    uartRS485Init(CFG_UART_BAUDRATE, CFG_UART_RS485_ADDRESS);
+    sysinitMark("RS485");
   #endif
 
   // Initialise PWM (requires 16-bit Timer 1 and P1.9)
@@ -156,62 +385,83 @@ void systemInit()
   // Initialise USB HID
   #ifdef CFG_USBHID
     usbHIDInit();
+    sysinitMark("USB HID");
   #endif
 
   // Initialise USB CDC
   #ifdef CFG_USBCDC
-    lastTick = systickGetTicks();   // Used to control output/printf timing
     CDC_Init();                     // Initialise VCOM
     USB_Init();                     // USB Initialization
     USB_Connect(TRUE);              // USB Connect
-    // Wait until USB is configured or timeout occurs
-    uint32_t usbTimeout = 0; 
-    while ( usbTimeout < CFG_USBCDC_INITTIMEOUT / 10 )
-    {
-      if (USB_Configuration) break;
-      systickDelay(10);             // Wait 10ms
-      usbTimeout++;
-    }
+    sysinitUsbStart = systickGetTicks();
+    // Printf needs USB to be configured (or timeout) before going on
+    #ifdef CFG_PRINTF_USBCDC
+      while (!sysinitUsbReady())
+      {
+        systickDelay(10 / CFG_SYSTICK_DELAY_IN_MS);
+      }
+      sysinitMark("USB Configured");
+    #endif
   #endif
 
   // Printf can now be used with UART or USBCDC
 
-  // Initialise the ST7565 128x64 pixel display
-  #ifdef CFG_ST7565
-    st7565Init();
-    st7565ClearScreen();    // Clear the screen  
-    st7565Backlight(1);     // Enable the backlight
+  #ifdef CFG_SCHEDULER_DEFERINIT
+    // Leave the optional peripherals to the scheduler
+    schedTaskInit(&sysinitTask, sysinitDeferred, NULL);
+    schedPost(&sysinitTask);
+  #else
+    uint8_t i;
+    for (i = 0; sysinitOptional[i] != NULL; i++)
+    {
+      // Only the USB step can be not ready yet
+      while (!sysinitOptional[i]())
+      {
+        systickDelay(10 / CFG_SYSTICK_DELAY_IN_MS);
+      }
+    }
   #endif
 
-  // Initialise the SSD1306 OLED display
-  #ifdef CFG_SSD1306
-    ssd1306Init(SSD1306_SWITCHCAPVCC);
-    ssd1306ClearScreen();   // Clear the screen  
+  // Start the command line interface
+  #ifdef CFG_INTERFACE
+    cmdInit();
+    sysinitMark("CLI");
   #endif
 
-  // Initialise TFT LCD Display
-  #ifdef CFG_TFTLCD
-    lcdInit();
+  #ifndef CFG_SCHEDULER_DEFERINIT
+    sysinitMark("Boot Complete");
+    sysinitComplete = true;
   #endif
+}
 
-  // Initialise Chibi
-  // Warning: CFG_CHIBI must be disabled if no antenna is connected,
-  // otherwise the SW will halt during initialisation
-  #ifdef CFG_CHIBI
-    // Write addresses to EEPROM for the first time if necessary
-    // uint16_t addr_short = 0x0025;
-    // uint64_t addr_ieee =  0x0000000000000025;
-    // mcp24aaWriteBuffer(CFG_EEPROM_CHIBI_SHORTADDR, (uint8_t *)&addr_short, 2);
-    // mcp24aaWriteBuffer(CFG_EEPROM_CHIBI_IEEEADDR, (uint8_t *)&addr_ieee, 8);
-    chb_init();
-    // chb_pcb_t *pcb = chb_get_pcb();
-    // printf("%-40s : 0x%04X%s", "Chibi Initialised", pcb->src_addr, CFG_PRINTF_NEWLINE);
-  #endif
+/**************************************************************************/
+/*! 
+    @brief Returns the boot phases recorded by systemInit, each with the
+           time in microseconds (since the systick timer was started) at
+           which it finished
 
-  // Start the command line interface
-  #ifdef CFG_INTERFACE
-    cmdInit();
-  #endif
+    @param[out] phases
+                Set to point to the phase table
+
+    @return     The number of phases in the table
+*/
+/**************************************************************************/
+uint8_t systemGetBootPhases(const sysinitPhase_t **phases)
+{
+  *phases = sysinitPhases;
+  return sysinitPhaseCount;
+}
+
+/**************************************************************************/
+/*! 
+    @brief Returns true once all of the peripherals have been
+           initialised, including the ones deferred with
+           CFG_SCHEDULER_DEFERINIT
+*/
+/**************************************************************************/
+bool systemBootComplete(void)
+{
+  return sysinitComplete;
 }
 
 /**************************************************************************/
@@ -245,30 +495,16 @@ void __putchar(const char c)
 /**************************************************************************/
 int puts(const char * str)
 {
-  // There must be at least 1ms between USB frames (of up to 64 bytes)
-  // This buffers all data and writes it out from the buffer one frame
-  // and one millisecond at a time
+  // This buffers all data, which is then sent by the bulk IN endpoint
+  // interrupt in 64 byte packets, back to back
   #ifdef CFG_PRINTF_USBCDC
     if (USB_Configuration) 
     {
-      while(*str)
-        cdcBufferWrite(*str++);
-      // Check if we can flush the buffer now or if we need to wait
-      unsigned int currentTick = systickGetTicks();
-      if (currentTick != lastTick)
-      {
-        uint8_t frame[64];
-        uint32_t bytesRead = 0;
-        while (cdcBufferDataPending())
-        {
-          // Read up to 64 bytes as long as possible
-          bytesRead = cdcBufferReadLen(frame, 64);
-          USB_WriteEP (CDC_DEP_IN, frame, bytesRead);
-          systickDelay(1);
-        }
-        lastTick = currentTick;
-      }
+      CDC_WrInBuf(str, strlen(str));
     }
+  #elif defined CFG_PRINTF_UART
+    // Queue the whole string in the UART TX buffer at once
+    uartSend((uint8_t *)str, strlen(str));
   #else
     // Handle output character by character in __putchar
     while(*str) __putchar(*str++);
@@ -44,7 +44,23 @@
 #include "core/gpio/gpio.h"
 #include "core/systick/systick.h"
 
+#define SYSINIT_MAXPHASES (10)
+
+/**************************************************************************/
+/*! 
+    A boot phase recorded by systemInit, with the time in microseconds
+    since the systick timer was started at which the phase finished
+*/
+/**************************************************************************/
+typedef struct
+{
+  const char *name;
+  uint32_t timeUs;
+} sysinitPhase_t;
+
 // Function prototypes
 void systemInit();
+uint8_t systemGetBootPhases(const sysinitPhase_t **phases);
+bool systemBootComplete(void);
 
 #endif
\ No newline at end of file
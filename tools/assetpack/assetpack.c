@@ -0,0 +1,350 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Packs images, fonts and strings into a single asset pack for
+ * drivers/fatfs/assetpack.c (see assetpack.h for the file format), and
+ * writes a C header with an ID for each asset.
+ *
+ * syntax: assetpack <output.pak> <output.h> <name>=<file> [<name>=<file> ...]
+ *
+ *   The asset type comes from the file extension:
+ *
+ *   .img   RGB565 image made by bmp2img565 (RLE images are expanded,
+ *          since the pixel data is sent to the LCD as it is read)
+ *   .txt   String (a terminating NUL is added)
+ *   .fnt   Font data
+ *   other  Raw data
+ *
+ *   Each asset gets the ID 'ASSET_<NAME>' in the header, in the order
+ *   given on the command line.  Copy the pack to the card in one go on
+ *   a freshly formatted (or defragmented) card so that it is stored
+ *   contiguously.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#define SECTOR_SIZE     512
+#define HEADER_SIZE     16
+#define ENTRY_SIZE      16
+#define MAXASSETS       1024
+
+#define TYPE_RAW        0
+#define TYPE_IMG565     1
+#define TYPE_FONT       2
+#define TYPE_STRING     3
+
+#define IMG565_HEADER   16
+#define IMG565_RLE_RUN  0x8000
+
+typedef struct
+{
+  char     name[64];
+  uint8_t  type;
+  uint8_t *data;
+  uint32_t length;
+  uint16_t width;
+  uint16_t height;
+  uint32_t sector;
+} asset_t;
+
+static asset_t assets[MAXASSETS];
+
+static uint16_t ld16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static void st16(uint8_t *p, uint16_t w)
+{
+  p[0] = w & 0xFF;
+  p[1] = w >> 8;
+}
+
+static void st32(uint8_t *p, uint32_t d)
+{
+  st16(p, d & 0xFFFF);
+  st16(p + 2, d >> 16);
+}
+
+static uint8_t *readFile(const char *path, uint32_t *len)
+{
+  FILE *pf;
+  uint8_t *buf;
+  long size;
+
+  if ((pf = fopen(path, "rb")) == NULL)
+    return NULL;
+  fseek(pf, 0, SEEK_END);
+  size = ftell(pf);
+  fseek(pf, 0, SEEK_SET);
+  buf = malloc(size + 1);
+  if (!buf || (fread(buf, 1, size, pf) != (size_t)size))
+  {
+    fclose(pf);
+    free(buf);
+    return NULL;
+  }
+  fclose(pf);
+  *len = size;
+  return buf;
+}
+
+// Replaces the img565 file with its raw (uncompressed) pixel data
+static int loadImage(asset_t *a, const char *path)
+{
+  uint8_t *raw = a->data;
+  uint32_t pixels, i, pos, count;
+  uint16_t ctrl, *out;
+
+  if ((a->length < IMG565_HEADER) || memcmp(raw, "R565", 4))
+  {
+    fprintf(stderr, "%s: not an img565 image\n", path);
+    return -1;
+  }
+  a->width = ld16(&raw[4]);
+  a->height = ld16(&raw[6]);
+  pixels = (uint32_t)a->width * a->height;
+
+  out = malloc(pixels * 2 + 1);
+  if (raw[9] != 0)
+  {
+    // Palette-indexed image ... expand it, since packed images are
+    // drawn straight out of the sector buffer
+    uint32_t depth = raw[9], rowBytes, x, y, bit;
+    const uint8_t *src;
+    if ((depth != 1) && (depth != 2) && (depth != 4) && (depth != 8))
+    {
+      fprintf(stderr, "%s: invalid depth\n", path);
+      return -1;
+    }
+    rowBytes = (a->width * depth + 7) / 8;
+    if (a->length < IMG565_HEADER + (2u << depth) + rowBytes * a->height)
+    {
+      fprintf(stderr, "%s: truncated image\n", path);
+      return -1;
+    }
+    src = raw + IMG565_HEADER + (2u << depth);
+    for (y = 0, i = 0; y < a->height; y++, src += rowBytes)
+    {
+      for (x = 0, bit = 0; x < a->width; x++, bit += depth)
+      {
+        pos = (src[bit >> 3] >> (8 - depth - (bit & 7))) & ((1 << depth) - 1);
+        out[i++] = ld16(&raw[IMG565_HEADER + pos * 2]);
+      }
+    }
+  }
+  else if (raw[8] == 0)
+  {
+    if (a->length < IMG565_HEADER + pixels * 2)
+    {
+      fprintf(stderr, "%s: truncated image\n", path);
+      return -1;
+    }
+    memcpy(out, raw + IMG565_HEADER, pixels * 2);
+  }
+  else if (raw[8] == 1)
+  {
+    for (i = 0, pos = IMG565_HEADER; i < pixels; )
+    {
+      if (pos + 2 > a->length) break;
+      ctrl = ld16(&raw[pos]);
+      pos += 2;
+      count = (ctrl & ~IMG565_RLE_RUN) + 1;
+      if (count > pixels - i) break;
+      if (ctrl & IMG565_RLE_RUN)
+      {
+        if (pos + 2 > a->length) break;
+        while (count--) memcpy(&out[i++], &raw[pos], 2);
+        pos += 2;
+      }
+      else
+      {
+        if (pos + count * 2 > a->length) break;
+        memcpy(&out[i], &raw[pos], count * 2);
+        i += count;
+        pos += count * 2;
+      }
+    }
+    if (i != pixels)
+    {
+      fprintf(stderr, "%s: corrupt RLE data\n", path);
+      return -1;
+    }
+  }
+  else
+  {
+    fprintf(stderr, "%s: unknown compression\n", path);
+    return -1;
+  }
+
+  free(raw);
+  a->data = (uint8_t *)out;
+  a->length = pixels * 2;
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  FILE *pf;
+  uint8_t sector[SECTOR_SIZE];
+  uint32_t count, i, j, next, indexBytes;
+  char *eq, *ext, *n;
+
+  if (argc < 4)
+  {
+    fprintf(stderr, "syntax: assetpack <output.pak> <output.h> <name>=<file> [<name>=<file> ...]\n");
+    return 1;
+  }
+
+  count = argc - 3;
+  if (count > MAXASSETS)
+  {
+    fprintf(stderr, "Too many assets (max %d)\n", MAXASSETS);
+    return 1;
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    asset_t *a = &assets[i];
+    const char *arg = argv[i + 3];
+
+    eq = strchr(arg, '=');
+    if (!eq || (eq == arg) || (eq - arg >= (int)sizeof(a->name)))
+    {
+      fprintf(stderr, "Invalid asset '%s', expected <name>=<file>\n", arg);
+      return 1;
+    }
+    memcpy(a->name, arg, eq - arg);
+    a->name[eq - arg] = 0;
+    for (n = a->name; *n; n++)
+    {
+      if (!isalnum((unsigned char)*n) && (*n != '_'))
+      {
+        fprintf(stderr, "Invalid asset name '%s'\n", a->name);
+        return 1;
+      }
+      *n = toupper((unsigned char)*n);
+    }
+
+    if ((a->data = readFile(eq + 1, &a->length)) == NULL)
+    {
+      fprintf(stderr, "Unable to read %s\n", eq + 1);
+      return 1;
+    }
+
+    ext = strrchr(eq + 1, '.');
+    a->type = TYPE_RAW;
+    if (ext && !strcmp(ext, ".img"))
+    {
+      a->type = TYPE_IMG565;
+      if (loadImage(a, eq + 1)) return 1;
+    }
+    else if (ext && !strcmp(ext, ".txt"))
+    {
+      a->type = TYPE_STRING;
+      a->data[a->length++] = 0;
+    }
+    else if (ext && !strcmp(ext, ".fnt"))
+    {
+      a->type = TYPE_FONT;
+    }
+  }
+
+  // Lay out the data, each asset starting on a new sector
+  indexBytes = HEADER_SIZE + count * ENTRY_SIZE;
+  next = (indexBytes + SECTOR_SIZE - 1) / SECTOR_SIZE;
+  for (i = 0; i < count; i++)
+  {
+    assets[i].sector = next;
+    next += (assets[i].length + SECTOR_SIZE - 1) / SECTOR_SIZE;
+  }
+
+  if ((pf = fopen(argv[1], "wb")) == NULL)
+  {
+    fprintf(stderr, "Unable to create %s\n", argv[1]);
+    return 1;
+  }
+
+  // Header and index, padded to a whole number of sectors
+  for (j = 0; j < indexBytes; j += SECTOR_SIZE)
+  {
+    memset(sector, 0, sizeof(sector));
+    for (i = j; (i < j + SECTOR_SIZE) && (i < indexBytes); i += ENTRY_SIZE)
+    {
+      uint8_t *p = &sector[i - j];
+      if (i == 0)
+      {
+        memcpy(p, "uPAK", 4);
+        st16(&p[4], 1);
+        st16(&p[6], count);
+        st32(&p[8], next);
+      }
+      else
+      {
+        asset_t *a = &assets[(i - HEADER_SIZE) / ENTRY_SIZE];
+        st32(&p[0], a->sector);
+        st32(&p[4], a->length);
+        p[8] = a->type;
+        st16(&p[10], a->width);
+        st16(&p[12], a->height);
+      }
+    }
+    fwrite(sector, 1, SECTOR_SIZE, pf);
+  }
+
+  // Asset data
+  for (i = 0; i < count; i++)
+  {
+    fwrite(assets[i].data, 1, assets[i].length, pf);
+    memset(sector, 0, sizeof(sector));
+    if (assets[i].length % SECTOR_SIZE)
+      fwrite(sector, 1, SECTOR_SIZE - assets[i].length % SECTOR_SIZE, pf);
+  }
+  fclose(pf);
+
+  // ID header
+  if ((pf = fopen(argv[2], "w")) == NULL)
+  {
+    fprintf(stderr, "Unable to create %s\n", argv[2]);
+    return 1;
+  }
+  fprintf(pf, "// Generated by tools/assetpack from %s, do not edit\n", argv[1]);
+  fprintf(pf, "#ifndef __ASSETS_H__\n#define __ASSETS_H__\n\n");
+  for (i = 0; i < count; i++)
+    fprintf(pf, "#define ASSET_%-24s (%u)\n", assets[i].name, i);
+  fprintf(pf, "\n#define ASSET_COUNT                    (%u)\n\n#endif\n", count);
+  fclose(pf);
+
+  printf("%s: %u assets, %u sectors\n", argv[1], count, next);
+  return 0;
+}
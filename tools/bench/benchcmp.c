@@ -0,0 +1,232 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Compares the results of the benchmark firmware ('make bench', or
+ * 'M csv' on the CLI, see project/commands/cmd_bench.c) against a
+ * reference result set such as refdesign.txt.
+ *
+ * syntax: benchcmp [-t <percent>] <reference.txt> <results.txt>
+ *
+ *   Only the 'BENCH,...' lines are read, so the results can be a raw
+ *   capture of the serial console.  Tests are matched by name and the
+ *   cycles per iteration are compared: anything more than '-t' percent
+ *   slower (default 5) is a regression, and tests that are missing or
+ *   skipped in the results count as one too.  References without
+ *   numbers ('-') are only listed.
+ *
+ *   Returns 1 if there was a regression, so it can be used in scripts.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAXTESTS  (32)
+#define MAXNAME   (32)
+
+typedef struct
+{
+  char name[MAXNAME];
+  long cycles;                  // -1 = skipped, -2 = no reference yet
+} benchResult_t;
+
+typedef struct
+{
+  char board[MAXNAME];
+  char version[MAXNAME];
+  int count;
+  benchResult_t tests[MAXTESTS];
+} benchSet_t;
+
+static void usage(void)
+{
+  fprintf(stderr, "syntax: benchcmp [-t <percent>] <reference.txt> <results.txt>\n");
+  exit(1);
+}
+
+/*
+ * Splits a line on commas (in place) and returns the number of fields
+ */
+static int split(char *line, char **fields, int max)
+{
+  int n = 0;
+
+  line[strcspn(line, "\r\n")] = 0;
+  while (n < max)
+  {
+    fields[n++] = line;
+    line = strchr(line, ',');
+    if (!line)
+      break;
+    *line++ = 0;
+  }
+  return n;
+}
+
+static int load(const char *path, benchSet_t *set)
+{
+  char line[256], *f[8];
+  char *start;
+  FILE *in;
+  int n;
+
+  in = fopen(path, "r");
+  if (!in)
+  {
+    perror(path);
+    return 0;
+  }
+
+  memset(set, 0, sizeof(*set));
+  while (fgets(line, sizeof(line), in))
+  {
+    // The console capture can have other output in front of the results
+    start = strstr(line, "BENCH,");
+    if (!start || line[0] == '#')
+      continue;
+    n = split(start, f, 8);
+    if (n == 2 && !strcmp(f[1], "END"))
+      break;
+    if (n == 5 && strcmp(f[4], "skipped"))
+    {
+      // BENCH,<board>,<version>,<MHz>,<timer> starts a new result set
+      set->count = 0;
+      snprintf(set->board, MAXNAME, "%s", f[1]);
+      snprintf(set->version, MAXNAME, "%s", f[2]);
+    }
+    else if (n >= 5 && set->count < MAXTESTS)
+    {
+      // BENCH,<#>,<test>,<iter>,<cycles>,... or BENCH,<#>,<test>,<iter>,skipped
+      snprintf(set->tests[set->count].name, MAXNAME, "%s", f[2]);
+      if (!strcmp(f[4], "skipped"))
+        set->tests[set->count].cycles = -1;
+      else if (!strcmp(f[4], "-"))
+        set->tests[set->count].cycles = -2;
+      else
+        set->tests[set->count].cycles = strtol(f[4], NULL, 10);
+      set->count++;
+    }
+  }
+
+  fclose(in);
+  return 1;
+}
+
+static const benchResult_t *find(const benchSet_t *set, const char *name)
+{
+  int i;
+
+  for (i = 0; i < set->count; i++)
+  {
+    if (!strcmp(set->tests[i].name, name))
+      return &set->tests[i];
+  }
+  return NULL;
+}
+
+int main(int argc, char **argv)
+{
+  static benchSet_t ref, res;
+  const benchResult_t *r, *n;
+  double threshold = 5.0, change;
+  int arg, i, regressions = 0;
+
+  for (arg = 1; (arg < argc) && (argv[arg][0] == '-'); arg++)
+  {
+    if (!strcmp(argv[arg], "-t") && arg + 1 < argc)
+      threshold = atof(argv[++arg]);
+    else
+      usage();
+  }
+  if (arg != argc - 2)
+  {
+    usage();
+  }
+
+  if (!load(argv[arg], &ref) || !load(argv[arg + 1], &res))
+  {
+    return 1;
+  }
+  if (!res.count)
+  {
+    fprintf(stderr, "%s: no benchmark results\n", argv[arg + 1]);
+    return 1;
+  }
+  if (strcmp(ref.board, res.board))
+  {
+    fprintf(stderr, "Warning: comparing %s results against a %s reference\n", res.board, ref.board);
+  }
+
+  printf("%-16s %12s %12s %8s\n", "Test", ref.version, res.version, "Change");
+  for (i = 0; i < ref.count; i++)
+  {
+    r = &ref.tests[i];
+    n = find(&res, r->name);
+    if (!n || n->cycles < 0)
+    {
+      if (r->cycles >= 0)
+        printf("%-16s %12ld %12s %8s", r->name, r->cycles, n ? "skipped" : "missing", "");
+      else
+        printf("%-16s %12s %12s %8s", r->name, "-", n ? "skipped" : "missing", "");
+      if (r->cycles >= 0)
+      {
+        printf("  REGRESSION");
+        regressions++;
+      }
+      printf("\n");
+      continue;
+    }
+    if (r->cycles < 0)
+    {
+      printf("%-16s %12s %12ld %8s\n", r->name, r->cycles == -1 ? "skipped" : "-", n->cycles, "");
+      continue;
+    }
+
+    change = r->cycles ? 100.0 * (n->cycles - r->cycles) / r->cycles : 0;
+    printf("%-16s %12ld %12ld %+7.1f%%", r->name, r->cycles, n->cycles, change);
+    if (change > threshold)
+    {
+      printf("  REGRESSION");
+      regressions++;
+    }
+    printf("\n");
+  }
+
+  // New tests that don't have a reference yet
+  for (i = 0; i < res.count; i++)
+  {
+    if (!find(&ref, res.tests[i].name))
+      printf("%-16s %12s %12ld %8s\n", res.tests[i].name, "new", res.tests[i].cycles, "");
+  }
+
+  return regressions ? 1 : 0;
+}
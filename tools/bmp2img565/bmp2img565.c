@@ -0,0 +1,339 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Converts an uncompressed 24-bit Windows bitmap into the native RGB565
+ * image format used by drivers/lcd/tft/img565.c (see img565.h for a
+ * description of the file format).
+ *
+ * syntax: bmp2img565 [-r] [-1|-2|-4|-8 [-c]] <input.bmp> <output>
+ *
+ *   -r   RLE compress the pixel data
+ *   -n   Store a palette-indexed image with n bits per pixel (1, 2, 4 or
+ *        8).  The palette holds the exact RGB565 colours of the image, so
+ *        the conversion fails if the image has more than 2^n colours.
+ *   -c   Write a C header with the palette and pixel data (to be drawn
+ *        from flash with drawImageIndexed) instead of an image file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define HEADER_SIZE     16
+#define RLE_RUN         0x8000
+#define RLE_MAXCOUNT    0x8000
+#define RLE_MINRUN      3       // Shorter runs are cheaper as literals
+
+static uint16_t ld16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t ld32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static void put16(FILE *pf, uint16_t w)
+{
+  fputc(w & 0xFF, pf);
+  fputc(w >> 8, pf);
+}
+
+// Writes 'count' literal pixels starting at 'pixels'
+static void putLiteral(FILE *pf, const uint16_t *pixels, uint32_t count)
+{
+  uint32_t i, n;
+
+  while (count)
+  {
+    n = count > RLE_MAXCOUNT ? RLE_MAXCOUNT : count;
+    put16(pf, n - 1);
+    for (i = 0; i < n; i++) put16(pf, pixels[i]);
+    pixels += n;
+    count -= n;
+  }
+}
+
+// Builds the palette for an indexed image and replaces each pixel with
+// its index, returning the number of colours or -1 if there are too many
+static int buildPalette(uint16_t *pixels, uint32_t total, uint16_t *palette, int maxColors)
+{
+  uint32_t i;
+  int c, colors = 0;
+
+  for (i = 0; i < total; i++)
+  {
+    for (c = 0; c < colors; c++)
+      if (palette[c] == pixels[i]) break;
+    if (c == colors)
+    {
+      if (colors == maxColors) return -1;
+      palette[colors++] = pixels[i];
+    }
+    pixels[i] = c;
+  }
+  return colors;
+}
+
+// Packs one row of indices MSB first, padding the row to a whole byte
+static void packRow(const uint16_t *indices, uint32_t width, int depth, uint8_t *out)
+{
+  uint32_t x, bit;
+
+  memset(out, 0, (width * depth + 7) / 8);
+  for (x = 0, bit = 0; x < width; x++, bit += depth)
+    out[bit >> 3] |= indices[x] << (8 - depth - (bit & 7));
+}
+
+// Writes the palette and pixel data as C arrays, using the output
+// filename (without its extension) as the prefix for all names
+static void writeHeader(FILE *pf, const char *path, uint32_t width, uint32_t height, int depth,
+                        const uint16_t *palette, const uint16_t *indices)
+{
+  char name[64], upper[64];
+  const char *base;
+  uint32_t rowBytes = (width * depth + 7) / 8, i, y;
+  uint8_t *row = malloc(rowBytes);
+  int n;
+
+  base = strrchr(path, '/');
+  base = base ? base + 1 : path;
+  for (n = 0; base[n] && (base[n] != '.') && (n < (int)sizeof(name) - 1); n++)
+  {
+    name[n] = ((base[n] >= 'a' && base[n] <= 'z') || (base[n] >= 'A' && base[n] <= 'Z') ||
+               (base[n] >= '0' && base[n] <= '9')) ? base[n] : '_';
+    upper[n] = (name[n] >= 'a' && name[n] <= 'z') ? name[n] - 'a' + 'A' : name[n];
+  }
+  name[n] = upper[n] = '\0';
+
+  fprintf(pf, "// Created by bmp2img565, draw with:\n");
+  fprintf(pf, "// drawImageIndexed(x, y, %s_WIDTH, %s_HEIGHT, %s_BITSPERPIXEL, %s_palette, %s_data);\n\n",
+          upper, upper, upper, name, name);
+  fprintf(pf, "#define %s_WIDTH         (%u)\n", upper, width);
+  fprintf(pf, "#define %s_HEIGHT        (%u)\n", upper, height);
+  fprintf(pf, "#define %s_BITSPERPIXEL  (%d)\n\n", upper, depth);
+
+  fprintf(pf, "static const uint16_t %s_palette[%d] =\n{", name, 1 << depth);
+  for (i = 0; i < (uint32_t)(1 << depth); i++)
+    fprintf(pf, "%s0x%04X%s", (i % 8) ? " " : "\n  ", palette[i], i + 1 < (uint32_t)(1 << depth) ? "," : "");
+  fprintf(pf, "\n};\n\n");
+
+  fprintf(pf, "static const uint8_t %s_data[%u] =\n{", name, rowBytes * height);
+  for (y = 0; y < height; y++)
+  {
+    packRow(&indices[y * width], width, depth, row);
+    for (i = 0; i < rowBytes; i++)
+      fprintf(pf, "%s0x%02X%s", (i % 12) ? " " : "\n  ", row[i], (y + 1 < height) || (i + 1 < rowBytes) ? "," : "");
+  }
+  fprintf(pf, "\n};\n");
+  free(row);
+}
+
+static void writeRLE(FILE *pf, const uint16_t *pixels, uint32_t total)
+{
+  uint32_t i = 0, literal = 0, run;
+
+  while (i < total)
+  {
+    // Measure the run starting at i
+    run = 1;
+    while ((i + run < total) && (run < RLE_MAXCOUNT) && (pixels[i + run] == pixels[i])) run++;
+
+    if (run >= RLE_MINRUN)
+    {
+      // Flush pending literals, then emit the run
+      putLiteral(pf, &pixels[i - literal], literal);
+      literal = 0;
+      put16(pf, RLE_RUN | (run - 1));
+      put16(pf, pixels[i]);
+      i += run;
+    }
+    else
+    {
+      literal += run;
+      i += run;
+    }
+  }
+  putLiteral(pf, &pixels[i - literal], literal);
+}
+
+int main(int argc, char *argv[])
+{
+  FILE *pf;
+  uint8_t hdr[54], out[HEADER_SIZE];
+  uint8_t *row;
+  uint16_t *pixels;
+  int32_t width, height;
+  uint16_t palette[256];
+  uint32_t rowSize, x, y, sy, offset;
+  int rle = 0, depth = 0, csource = 0, arg = 1;
+  int topdown = 0, colors = 0;
+
+  // Check for options and required arguments
+  while ((arg < argc) && (argv[arg][0] == '-'))
+  {
+    if (strcmp(argv[arg], "-r") == 0)
+      rle = 1;
+    else if (strcmp(argv[arg], "-c") == 0)
+      csource = 1;
+    else if (!strcmp(argv[arg], "-1") || !strcmp(argv[arg], "-2") || !strcmp(argv[arg], "-4") || !strcmp(argv[arg], "-8"))
+      depth = argv[arg][1] - '0';
+    else
+      break;
+    arg++;
+  }
+  if ((argc - arg < 2) || (depth && rle) || (csource && !depth))
+  {
+    printf("syntax: bmp2img565 [-r] [-1|-2|-4|-8 [-c]] <input.bmp> <output>\n");
+    return 1;
+  }
+
+  // Try to open the supplied bitmap
+  if ((pf = fopen(argv[arg], "rb")) == NULL)
+  {
+    printf("error: could not open file [%s]\n", argv[arg]);
+    return 1;
+  }
+
+  if ((fread(hdr, 1, sizeof(hdr), pf) != sizeof(hdr)) || (ld16(&hdr[0]) != 0x4D42))
+  {
+    printf("error: [%s] is not a bitmap image\n", argv[arg]);
+    fclose(pf);
+    return 1;
+  }
+
+  offset = ld32(&hdr[10]);
+  width  = (int32_t)ld32(&hdr[18]);
+  height = (int32_t)ld32(&hdr[22]);
+  if (height < 0)
+  {
+    topdown = 1;
+    height = -height;
+  }
+
+  if ((ld16(&hdr[28]) != 24) || (ld32(&hdr[30]) != 0))
+  {
+    printf("error: only uncompressed 24-bit bitmaps are supported\n");
+    fclose(pf);
+    return 1;
+  }
+  if ((width <= 0) || (width > 0xFFFF) || (height == 0) || (height > 0xFFFF))
+  {
+    printf("error: invalid image dimensions\n");
+    fclose(pf);
+    return 1;
+  }
+
+  // Read and convert the pixel data (rows are padded to 4 bytes)
+  rowSize = ((width * 3) + 3) & ~3;
+  row = malloc(rowSize);
+  pixels = malloc(width * height * sizeof(uint16_t));
+  if (!row || !pixels || fseek(pf, offset, SEEK_SET))
+  {
+    printf("error: could not read pixel data\n");
+    fclose(pf);
+    return 1;
+  }
+
+  for (y = 0; y < (uint32_t)height; y++)
+  {
+    if (fread(row, 1, rowSize, pf) < (uint32_t)width * 3)
+    {
+      printf("error: unexpected end of file in pixel data\n");
+      fclose(pf);
+      return 1;
+    }
+    // Bitmaps are normally stored bottom-up
+    sy = topdown ? y : height - 1 - y;
+    for (x = 0; x < (uint32_t)width; x++)
+    {
+      uint8_t b = row[x * 3], g = row[x * 3 + 1], r = row[x * 3 + 2];
+      pixels[sy * width + x] = ((r / 8) << 11) | ((g / 4) << 5) | (b / 8);
+    }
+  }
+  fclose(pf);
+
+  if (depth)
+  {
+    memset(palette, 0, sizeof(palette));
+    colors = buildPalette(pixels, width * height, palette, 1 << depth);
+    if (colors < 0)
+    {
+      printf("error: image has more than %d colours\n", 1 << depth);
+      return 1;
+    }
+  }
+
+  // Write the image
+  if ((pf = fopen(argv[arg + 1], csource ? "w" : "wb")) == NULL)
+  {
+    printf("error: could not create file [%s]\n", argv[arg + 1]);
+    return 1;
+  }
+
+  if (csource)
+  {
+    writeHeader(pf, argv[arg + 1], width, height, depth, palette, pixels);
+    printf("succesfully converted %dx%d image with %d colours\n", (int)width, (int)height, colors);
+    fclose(pf);
+    free(row);
+    free(pixels);
+    return 0;
+  }
+
+  memset(out, 0, sizeof(out));
+  memcpy(out, "R565", 4);
+  out[4] = width & 0xFF;
+  out[5] = width >> 8;
+  out[6] = height & 0xFF;
+  out[7] = height >> 8;
+  out[8] = rle;
+  out[9] = depth;
+  fwrite(out, 1, sizeof(out), pf);
+
+  if (depth)
+  {
+    uint8_t *packed = malloc((width * depth + 7) / 8);
+    for (x = 0; x < (uint32_t)(1 << depth); x++) put16(pf, palette[x]);
+    for (y = 0; y < (uint32_t)height; y++)
+    {
+      packRow(&pixels[y * width], width, depth, packed);
+      fwrite(packed, 1, (width * depth + 7) / 8, pf);
+    }
+    free(packed);
+  }
+  else if (rle)
+    writeRLE(pf, pixels, width * height);
+  else
+    for (x = 0; x < (uint32_t)(width * height); x++) put16(pf, pixels[x]);
+
+  printf("succesfully converted %dx%d image (%ld bytes)\n", (int)width, (int)height, ftell(pf));
+  fclose(pf);
+  free(row);
+  free(pixels);
+
+  return 0;
+}
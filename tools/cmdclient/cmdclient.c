@@ -0,0 +1,444 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Host client for the binary command frames of the device CLI (see
+ * cmdRxFrame in core/cmd/cmd.c).  Commands are sent without waiting for
+ * each one to finish, with up to <window> requests in flight.
+ *
+ * syntax: cmdclient [-b <baud>] [-w <window>] [-q <bytes>] <device>
+ *         cmdclient [...] -t <count> <device>
+ *         cmdclient [...] -l <count> <device>
+ *
+ *   Without -t or -l, commands are read from stdin in the usual text
+ *   form, one per line ("t 10 20 0xFFFF 0 Hello").  Leading numeric
+ *   arguments are sent as 32-bit values and anything from the first
+ *   non-numeric argument onwards is sent as text.  Device output is
+ *   copied to stdout.
+ *
+ *   -t <count>  Throughput: sends <count> empty '#' frames pipelined and
+ *               reports the command rate
+ *   -l <count>  Latency: sends <count> empty '#' frames one at a time and
+ *               reports the min/avg/max round trip
+ *   -w <window> Requests in flight (default 8, max 64)
+ *   -q <bytes>  Frame bytes in flight (default 192), keep this under the
+ *               RX buffer size of the device (CFG_UART_BUFSIZE or
+ *               CFG_USBCDC_BUFFERSIZE)
+ *   -b <baud>   UART baud rate (default 115200, ignored by USB CDC)
+ *
+ *   Frames aren't acknowledged, so every request is followed by an
+ *   empty '#' frame, which prints the current mode ("1") once the
+ *   request before it has run.  Those lines are removed from the
+ *   output, so a command that prints a line with just "1" on it will
+ *   confuse the client.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FRAME_SYNC      0xA5
+#define FRAME_MAXNUM    12          // Numeric args per frame (CMD_FRAME_MAXNUM)
+#define FRAME_MAXLEN    255         // 'len' is a single byte
+#define MAXWINDOW       64
+#define TIMEOUT_MS      2000
+
+static int fd;
+
+// Requests in flight, oldest first
+static double sent[MAXWINDOW];
+static int sentBytes[MAXWINDOW];
+static int head, inflight, inflightBytes;
+
+static double latMin, latMax, latSum;
+static long latCount;
+
+static char line[1024];
+static int lineLength;
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint8_t crc8(uint8_t crc, uint8_t data)
+{
+  int bit;
+
+  crc ^= data;
+  for (bit = 0; bit < 8; bit++)
+  {
+    crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+  }
+  return crc;
+}
+
+static speed_t baudRate(long baud)
+{
+  switch (baud)
+  {
+    case 9600:    return B9600;
+    case 19200:   return B19200;
+    case 38400:   return B38400;
+    case 57600:   return B57600;
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    default:      return 0;
+  }
+}
+
+static int openPort(const char *path, long baud)
+{
+  struct termios tio;
+  speed_t speed = baudRate(baud);
+
+  if (!speed)
+  {
+    fprintf(stderr, "Unsupported baud rate %ld\n", baud);
+    return -1;
+  }
+  if ((fd = open(path, O_RDWR | O_NOCTTY)) < 0)
+  {
+    fprintf(stderr, "Unable to open %s: %s\n", path, strerror(errno));
+    return -1;
+  }
+  if (tcgetattr(fd, &tio) < 0)
+  {
+    fprintf(stderr, "%s is not a serial port\n", path);
+    return -1;
+  }
+  cfmakeraw(&tio);
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  tcsetattr(fd, TCSANOW, &tio);
+  return 0;
+}
+
+static int writeAll(const uint8_t *data, int length)
+{
+  int n;
+
+  while (length > 0)
+  {
+    if ((n = write(fd, data, length)) < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN) continue;
+      fprintf(stderr, "Write failed: %s\n", strerror(errno));
+      return -1;
+    }
+    data += n;
+    length -= n;
+  }
+  return 0;
+}
+
+// Discards anything the device sends until it has been quiet for 'ms'
+static void drain(int ms)
+{
+  struct pollfd pfd = { fd, POLLIN, 0 };
+  uint8_t buf[256];
+
+  while (poll(&pfd, 1, ms) > 0 && read(fd, buf, sizeof(buf)) > 0)
+    ;
+}
+
+/*
+ * Builds a frame from a text command line.  Returns the frame length,
+ * 0 for an empty line or -1 if the command can't be framed.
+ */
+static int buildFrame(uint8_t *frame, char *cmd)
+{
+  char *tok, *end, *text = NULL;
+  uint32_t args[FRAME_MAXNUM];
+  uint8_t opcode, crc;
+  int nargs = 0, textLength = 0, length, i;
+  long long value;
+
+  tok = strtok(cmd, " \t\r\n");
+  if (!tok) return 0;
+  if (tok[1])
+  {
+    fprintf(stderr, "'%s': binary frames only support single character commands\n", tok);
+    return -1;
+  }
+  opcode = tok[0];
+
+  while ((tok = strtok(NULL, " \t\r\n")) != NULL)
+  {
+    value = strtoll(tok, &end, 0);
+    if (*end || nargs == FRAME_MAXNUM)
+    {
+      // The rest of the line goes in as text (split on spaces again by
+      // the device)
+      text = tok;
+      textLength = strlen(tok);
+      while ((tok = strtok(NULL, " \t\r\n")) != NULL)
+      {
+        text[textLength++] = ' ';
+        memmove(text + textLength, tok, strlen(tok) + 1);
+        textLength += strlen(tok);
+      }
+      break;
+    }
+    args[nargs++] = (uint32_t)value;
+  }
+
+  length = 2 + nargs * 4 + textLength;
+  if (length > FRAME_MAXLEN)
+  {
+    fprintf(stderr, "Command too long for a frame (%d bytes, max %d)\n", length, FRAME_MAXLEN);
+    return -1;
+  }
+
+  frame[0] = FRAME_SYNC;
+  frame[1] = length;
+  frame[2] = opcode;
+  frame[3] = nargs;
+  for (i = 0; i < nargs; i++)
+  {
+    frame[4 + i * 4] = args[i];
+    frame[5 + i * 4] = args[i] >> 8;
+    frame[6 + i * 4] = args[i] >> 16;
+    frame[7 + i * 4] = args[i] >> 24;
+  }
+  memcpy(&frame[4 + nargs * 4], text, textLength);
+
+  crc = 0;
+  for (i = 1; i < 2 + length; i++)
+  {
+    crc = crc8(crc, frame[i]);
+  }
+  frame[2 + length] = crc;
+
+  return 3 + length;
+}
+
+// Empty '#' frame, answered with the current mode
+static int buildPing(uint8_t *frame)
+{
+  char cmd[] = "#";
+
+  return buildFrame(frame, cmd);
+}
+
+static void completed(void)
+{
+  double lat = now() - sent[head];
+
+  if (!latCount || lat < latMin) latMin = lat;
+  if (!latCount || lat > latMax) latMax = lat;
+  latSum += lat;
+  latCount++;
+
+  inflightBytes -= sentBytes[head];
+  head = (head + 1) % MAXWINDOW;
+  inflight--;
+}
+
+/*
+ * Reads whatever the device has sent within 'ms', retiring a request
+ * for each "1" line and printing everything else if 'echo' is set.
+ * Returns 0 on a timeout.
+ */
+static int receive(int ms, int echo)
+{
+  struct pollfd pfd = { fd, POLLIN, 0 };
+  uint8_t buf[256];
+  int n, i;
+
+  if (poll(&pfd, 1, ms) <= 0) return 0;
+  if ((n = read(fd, buf, sizeof(buf))) <= 0) return 0;
+
+  for (i = 0; i < n; i++)
+  {
+    if (buf[i] == '\r') continue;
+    if (buf[i] != '\n')
+    {
+      if (lineLength < (int)sizeof(line) - 1) line[lineLength++] = buf[i];
+      continue;
+    }
+    line[lineLength] = 0;
+    if (inflight && !strcmp(line, "1"))
+    {
+      completed();
+    }
+    else if (echo)
+    {
+      printf("%s\n", line);
+    }
+    lineLength = 0;
+  }
+  return 1;
+}
+
+static int sendFrame(const uint8_t *frame, int length, int window, int maxBytes, int echo)
+{
+  // Wait for room in the window (one request can always be sent)
+  while (inflight && (inflight >= window || inflightBytes + length > maxBytes))
+  {
+    if (!receive(TIMEOUT_MS, echo))
+    {
+      fprintf(stderr, "Timed out with %d requests in flight\n", inflight);
+      return -1;
+    }
+  }
+
+  sent[(head + inflight) % MAXWINDOW] = now();
+  sentBytes[(head + inflight) % MAXWINDOW] = length;
+  inflight++;
+  inflightBytes += length;
+  return writeAll(frame, length);
+}
+
+static int flush(int echo)
+{
+  while (inflight)
+  {
+    if (!receive(TIMEOUT_MS, echo))
+    {
+      fprintf(stderr, "Timed out with %d requests in flight\n", inflight);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static void report(const char *what, long count, double elapsed)
+{
+  if (!latCount) return;
+  fprintf(stderr, "%s: %ld commands in %.3f s, %.1f commands/s\n", what, count, elapsed, count / elapsed);
+  fprintf(stderr, "latency: min %.2f ms, avg %.2f ms, max %.2f ms\n",
+          latMin * 1e3, latSum / latCount * 1e3, latMax * 1e3);
+}
+
+int main(int argc, char *argv[])
+{
+  uint8_t frame[3 + FRAME_MAXLEN + 3 + 3];
+  uint8_t textMode[3 + 2 + 4];
+  char cmd[sizeof(line)];
+  long baud = 115200, count = 0, i;
+  int window = 8, maxBytes = 192, mode = 0, opt, n, ping, result = 0;
+  double start;
+
+  while ((opt = getopt(argc, argv, "b:w:q:t:l:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'b': baud = atol(optarg); break;
+      case 'w': window = atoi(optarg); break;
+      case 'q': maxBytes = atoi(optarg); break;
+      case 't':
+      case 'l': mode = opt; count = atol(optarg); break;
+      default:  optind = argc + 1; break;
+    }
+  }
+  if (optind != argc - 1 || window < 1 || window > MAXWINDOW || (mode && count < 1))
+  {
+    fprintf(stderr, "syntax: cmdclient [-b <baud>] [-w <window>] [-q <bytes>] [-t <count> | -l <count>] <device>\n");
+    return 1;
+  }
+  if (openPort(argv[optind], baud)) return 1;
+
+  // Switch the CLI to binary frames and throw away the echo
+  writeAll((const uint8_t *)"\r# 1\r", 5);
+  drain(200);
+
+  ping = buildPing(frame);
+  start = now();
+  if (mode == 't')
+  {
+    for (i = 0; i < count && !result; i++)
+    {
+      result = sendFrame(frame, ping, window, maxBytes, 0);
+    }
+    if (!result) result = flush(0);
+    if (!result) report("throughput", count, now() - start);
+  }
+  else if (mode == 'l')
+  {
+    for (i = 0; i < count && !result; i++)
+    {
+      if (!(result = sendFrame(frame, ping, 1, maxBytes, 0))) result = flush(0);
+    }
+    if (!result) report("round trip", count, now() - start);
+  }
+  else
+  {
+    count = 0;
+    while (fgets(cmd, sizeof(cmd), stdin))
+    {
+      if ((n = buildFrame(frame, cmd)) <= 0)
+      {
+        if (n < 0) result = 1;
+        continue;
+      }
+      // Follow the command with a ping so we know when it has run
+      n += buildPing(frame + n);
+      if (sendFrame(frame, n, window, maxBytes, 1))
+      {
+        result = 1;
+        break;
+      }
+      count++;
+    }
+    if (flush(1)) result = 1;
+    if (lineLength)
+    {
+      line[lineLength] = 0;
+      printf("%s\n", line);
+    }
+    report("script", count, now() - start);
+  }
+
+  // Back to the text command line ('#' frame with a 0 argument)
+  strcpy(cmd, "# 0");
+  n = buildFrame(textMode, cmd);
+  writeAll(textMode, n);
+  tcdrain(fd);
+  close(fd);
+
+  return result ? 1 : 0;
+}
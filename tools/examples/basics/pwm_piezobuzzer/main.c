@@ -51,6 +51,10 @@
   #include "core/pwm/pwm.h"
 #endif
 
+// Short two-tone alerts, played in the background by the PWM timer ISR
+static const pwmNote_t alertOn[] = { { 4000, 50 }, { 0, 25 }, { 4000, 50 } };
+static const pwmNote_t alertOff[] = { { 2000, 100 } };
+
 /**************************************************************************/
 /*! 
     Main program entry point.  After reset, normal code execution will
@@ -93,15 +97,13 @@ int main(void)
       // Set the LED state and buzzer loudness depending on the current LED state
       if (gpioGetValue(CFG_LED_PORT, CFG_LED_PIN) == CFG_LED_OFF)
       {
-        pwmSetFrequencyInTicks(CFG_CPU_CCLK / 4000);            // 4khz (louder)
-        pwmStartFixed(200);                                     // 2x as long as @ 2khz since it's 2x faster
-        gpioSetValue (CFG_LED_PORT, CFG_LED_PIN, CFG_LED_ON);   // Turn the LED on
+        pwmPlayNotes(alertOn, sizeof(alertOn) / sizeof(pwmNote_t));   // 4khz double beep (louder)
+        gpioSetValue (CFG_LED_PORT, CFG_LED_PIN, CFG_LED_ON);         // Turn the LED on
       }
       else
       {
-        pwmSetFrequencyInTicks(CFG_CPU_CCLK / 2000);            // 2khz (softer)
-        pwmStartFixed(100);                                    
-        gpioSetValue (CFG_LED_PORT, CFG_LED_PIN, CFG_LED_OFF);  // Turn the LED off
+        pwmPlayNotes(alertOff, sizeof(alertOff) / sizeof(pwmNote_t)); // 2khz beep (softer)
+        gpioSetValue (CFG_LED_PORT, CFG_LED_PIN, CFG_LED_OFF);        // Turn the LED off
       }
     }
   }
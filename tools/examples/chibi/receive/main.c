@@ -74,7 +74,7 @@ int edToDBM(uint32_t ed)
     --------------------------------------------------
     CFG_CHIBI             -> Enabled
     CFG_CHIBI_PROMISCUOUS -> 0
-    CFG_CHIBI_BUFFERSIZE  -> 128
+    CFG_CHIBI_RXSLOTS     -> 2
 */
 /**************************************************************************/
 int main(void)
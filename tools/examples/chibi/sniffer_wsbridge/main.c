@@ -44,11 +44,9 @@
   #include "drivers/chibi/chb.h"
   #include "drivers/chibi/chb_drvr.h"
   #include "core/uart/uart.h"
-  static chb_rx_data_t rx_data;
 #endif
 
 #ifdef CFG_PRINTF_USBCDC
-  volatile unsigned int lastTick;
   #include "core/usbcdc/usb.h"
   #include "core/usbcdc/usbcore.h"
   #include "core/usbcdc/usbhw.h"
@@ -56,16 +54,48 @@
   #include "core/usbcdc/cdc_buf.h"
 #endif
 
+// Start of each captured frame on the serial link
+#define SNIFFER_SYNC  (0xA5)
+
+/**************************************************************************/
+/*! 
+    Sends a block of bytes to the PC
+*/
+/**************************************************************************/
+static void snifferSend(uint8_t *data, uint32_t len)
+{
+  #ifdef CFG_PRINTF_UART
+    uartSend(data, len);
+  #endif
+  #ifdef CFG_PRINTF_USBCDC
+    if (USB_Configuration) 
+    {
+      CDC_WrInBuf((char *)data, len);
+    }  
+  #endif
+}
+
 /**************************************************************************/
 /*! 
     Use Chibi as a wireless sniffer and write all captured frames
     to UART or USB CDC for wsbridge to handle (see "tools/wsbridge")
+
+    Each frame is sent in binary as:
+
+      [0xA5] [len] [timestamp (4 bytes, LSB first)] [len bytes of frame]
+
+    where the frame includes the 2-byte FCS, and the timestamp is the
+    time the frame started arriving in microseconds.  With
+    CFG_CHIBI_TIMESTAMP it's latched from 32-bit timer 0 in the radio's
+    RX_START interrupt, otherwise it's derived from the systick counter
+    (millisecond resolution only).
   
     projectconfig.h settings:
     --------------------------------------------------
     CFG_CHIBI             -> Enabled
     CFG_CHIBI_PROMISCUOUS -> 1
-    CFG_CHIBI_BUFFERSIZE  -> 1024   
+    CFG_CHIBI_RXSLOTS     -> 7   
+    CFG_CHIBI_TIMESTAMP   -> Enabled (recommended)
 */
 /**************************************************************************/
 int main(void)
@@ -85,59 +115,38 @@ int main(void)
   #endif
 
   #if defined CFG_CHIBI && CFG_CHIBI_PROMISCUOUS != 0
-    // Get a reference to the Chibi peripheral control block
-    chb_pcb_t *pcb = chb_get_pcb();
+    chb_rx_frame_t *frm;
+    uint8_t hdr[6];
+    uint32_t us;
     
     // Wait for incoming frames and transmit the raw data over uart
     while(1)
     {
       // Check for incoming messages 
-      while (pcb->data_rcv) 
+      while ((frm = chb_read_frame()) != NULL)
       { 
-        // get the length of the data
-        rx_data.len = chb_read(&rx_data);
-        // make sure the length is nonzero
-        if (rx_data.len)
-        {
-          // Enable LED to indicate message reception 
-          gpioSetValue (CFG_LED_PORT, CFG_LED_PIN, CFG_LED_ON); 
-
-          
-          // Send raw data the to PC for processing using wsbridge
-          uint8_t i;
-          for (i=0; i<rx_data.len; i++)
-          {
-            #ifdef CFG_PRINTF_UART
-              uartSendByte(rx_data.data[i]);
-            #endif
-            #ifdef CFG_PRINTF_USBCDC
-               // ToDo: This really needs to be refactored!
-              if (USB_Configuration) 
-              {
-                cdcBufferWrite(rx_data.data[i]);
-                // Check if we can flush the buffer now or if we need to wait
-                unsigned int currentTick = systickGetTicks();
-                if (currentTick != lastTick)
-                {
-                  uint8_t frame[64];
-                  uint32_t bytesRead = 0;
-                  while (cdcBufferDataPending())
-                  {
-                    // Read 64 byte chunks until end of data
-                    bytesRead = cdcBufferReadLen(frame, 64);
-                    // debug_printf("%d,", bytesRead);
-                    USB_WriteEP (CDC_DEP_IN, frame, bytesRead);
-                    systickDelay(1);
-                  }
-                  lastTick = currentTick;
-                }
-              }  
-            #endif
-          }
-
-          // Disable LED
-          gpioSetValue (CFG_LED_PORT, CFG_LED_PIN, CFG_LED_OFF); 
-        }
+        // Enable LED to indicate message reception 
+        gpioSetValue (CFG_LED_PORT, CFG_LED_PIN, CFG_LED_ON); 
+
+        #ifdef CFG_CHIBI_TIMESTAMP
+          us = frm->timestamp;
+        #else
+          us = frm->timestamp * CFG_SYSTICK_DELAY_IN_MS * 1000;
+        #endif
+
+        // Send the raw frame to the PC for processing using wsbridge
+        hdr[0] = SNIFFER_SYNC;
+        hdr[1] = frm->len;
+        hdr[2] = us & 0xFF;
+        hdr[3] = (us >> 8) & 0xFF;
+        hdr[4] = (us >> 16) & 0xFF;
+        hdr[5] = (us >> 24) & 0xFF;
+        snifferSend(hdr, sizeof(hdr));
+        snifferSend(frm->data, frm->len);
+        chb_free_frame(frm);
+
+        // Disable LED
+        gpioSetValue (CFG_LED_PORT, CFG_LED_PIN, CFG_LED_OFF); 
       }
     }
   #endif
@@ -38,21 +38,36 @@
 #include "projectconfig.h"
 #include "sysinit.h"
 
-#include "core/gpio/gpio.h"
 #include "core/adc/adc.h"
+#include "core/adc/scope.h"
 #include "core/systick/systick.h"
 
 #include "drivers/lcd/tft/lcd.h"
 #include "drivers/lcd/tft/drawing.h"
+#include "drivers/lcd/tft/chart.h"
 #include "drivers/lcd/tft/touchscreen.h"
 #include "drivers/lcd/tft/fonts/dejavusans9.h"
 #include "drivers/lcd/tft/fonts/dejavusansbold9.h"
 
-static uint8_t adcBuffer[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-static uint8_t digBuffer[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+// The grid is 9 x 7 divisions of 25 pixels, and each capture is 50
+// samples per division (two per column)
+#define SCOPE_DIVSAMPLES  (50)
+#define SCOPE_LENGTH      (SCOPE_DIVSAMPLES * 9)
+#define SCOPE_PRETRIGGER  (SCOPE_DIVSAMPLES * 2)
 
-bool adcEnabled = true;
-bool digEnabled = false;
+// 3.5V at the top of the grid, 500mV per division (1023 = 3.3V)
+#define SCOPE_FULLSCALE   (1085)
+
+// Capture without a trigger if nothing happened for this long
+#define SCOPE_AUTOMS      (250)
+
+static const uint32_t  rates[3] = { 50000, 5000, 500 };
+static char           *rateNames[3] = { "1ms/Div", "10ms/Div", "100ms/Div" };
+static uint8_t         rate = 0;
+static scopeTrigger_t  edge = SCOPE_TRIGGER_RISING;
+
+static int16_t         chartSamples[225];
+static chart_t         chart;
 
 /**************************************************************************/
 /*! 
@@ -62,7 +77,7 @@ bool digEnabled = false;
 void renderLCDFrame(void)
 {
   // Clear the screen
-  drawFill(COLOR_DARKGRAY);
+  drawFill(COLOR_GRAY_80);
 
   // Render V references
   drawString(245,  27, COLOR_BLACK, &dejaVuSansBold9ptFontInfo, "3.5V");
@@ -71,19 +86,16 @@ void renderLCDFrame(void)
   drawString(244, 194, COLOR_WHITE, &dejaVuSansBold9ptFontInfo, "0.0V");
 
   // Div settings
-  drawString( 10, 10, COLOR_BLACK, &dejaVuSansBold9ptFontInfo, "~100ms/Div");
-  drawString(  9,  9, COLOR_WHITE, &dejaVuSansBold9ptFontInfo, "~100ms/Div");
+  drawString( 10, 10, COLOR_BLACK, &dejaVuSansBold9ptFontInfo, rateNames[rate]);
+  drawString(  9,  9, COLOR_WHITE, &dejaVuSansBold9ptFontInfo, rateNames[rate]);
   drawString( 95, 10, COLOR_BLACK, &dejaVuSansBold9ptFontInfo, "500mV/Div");
   drawString( 94,  9, COLOR_WHITE, &dejaVuSansBold9ptFontInfo, "500mV/Div");
 
-  // Clear the ADC output level just in case
-  drawRectangleFilled(175, 5, 250, 18, COLOR_DARKGRAY);
-
-  // Render the channel text
-  drawString( 25, 220, COLOR_BLACK,  &dejaVuSansBold9ptFontInfo, "P1.4 (Analog)");
-  drawString( 24, 219, adcEnabled ? COLOR_YELLOW : COLOR_MEDIUMGRAY, &dejaVuSansBold9ptFontInfo, "P1.4 (Analog)");
-  drawString(135, 220, COLOR_BLACK,  &dejaVuSansBold9ptFontInfo, "P2.0 (Digital)");
-  drawString(134, 219, digEnabled ? COLOR_GREEN : COLOR_MEDIUMGRAY, &dejaVuSansBold9ptFontInfo, "P2.0 (Digital)");
+  // Render the buttons (time base and trigger edge)
+  drawString( 25, 220, COLOR_BLACK,  &dejaVuSansBold9ptFontInfo, "Time Base");
+  drawString( 24, 219, COLOR_YELLOW, &dejaVuSansBold9ptFontInfo, "Time Base");
+  drawString(135, 220, COLOR_BLACK,  &dejaVuSansBold9ptFontInfo, edge == SCOPE_TRIGGER_RISING ? "Trig: Rising" : "Trig: Falling");
+  drawString(134, 219, COLOR_GREEN,  &dejaVuSansBold9ptFontInfo, edge == SCOPE_TRIGGER_RISING ? "Trig: Rising" : "Trig: Falling");
 
   // ADC Warning
   drawString(245,  80, COLOR_BLACK, &dejaVuSansBold9ptFontInfo, "Warning:");
@@ -91,110 +103,51 @@ void renderLCDFrame(void)
   drawString(244,  95, COLOR_WHITE, &dejaVuSans9ptFontInfo, "ADC input");
   drawString(244, 110, COLOR_WHITE, &dejaVuSans9ptFontInfo, "is not 5.0V");
   drawString(244, 125, COLOR_WHITE, &dejaVuSans9ptFontInfo, "tolerant!");
-}
 
-/**************************************************************************/
-/*! 
-    Converts the supplied 8-bit value to an approximate pixel height in
-    the data grid
-*/
-/**************************************************************************/
-uint16_t adcValToPixel(uint8_t value)
-{
-  // Since the chart is 175 pixels high and 3.3V is at
-  // approximately 165 pixels height, we need to
-  // divide the 8 bit ADC readings by 1.545 (255/165)
-  // using fixed point math, and then substract
-  // the number from the bottom of the frame
-  uint16_t pixel = 0;
-  pixel = 200 - (value * 1000 / 1545);
-  return pixel;
+  // Redraw the empty grid
+  drawRectangle(9, 24, 236, 201, COLOR_GRAY_200);
+  chartRedraw(&chart);
 }
 
 /**************************************************************************/
 /*! 
-    Redraws the grid and renders the data points on the LCD
+    Draws the finished capture, with a marker above the grid where the
+    trigger was and the min/max voltage of the capture
 */
 /**************************************************************************/
-void renderLCDGrid(void)
+void renderCapture(void)
 {
-  if ((!adcEnabled) && (!digEnabled))
-  {    
-    return;
-  }
-
-  // Redraw the grid
-  drawRectangle(9, 24, 236, 201, COLOR_LIGHTGRAY);
-  drawRectangleFilled(10, 25, 235, 200, COLOR_BLACK);
-
-  // Horizontal lines
-  drawLine(10,  50, 235,  50, COLOR_DARKERGRAY);
-  drawLine(10,  75, 235,  75, COLOR_DARKERGRAY);
-  drawLine(10, 100, 235, 100, COLOR_DARKERGRAY);
-  drawLine(10, 125, 235, 125, COLOR_DARKERGRAY);
-  drawLine(10, 150, 235, 150, COLOR_DARKERGRAY);
-  drawLine(10, 175, 235, 175, COLOR_DARKERGRAY);
-
-  // Vertical lines
-  drawLine( 35, 25,  35, 200, COLOR_DARKERGRAY);
-  drawLine( 60, 25,  60, 200, COLOR_DARKERGRAY);
-  drawLine( 85, 25,  85, 200, COLOR_DARKERGRAY);
-  drawLine(110, 25, 110, 200, COLOR_DARKERGRAY);
-  drawLine(135, 25, 135, 200, COLOR_DARKERGRAY);
-  drawLine(160, 25, 160, 200, COLOR_DARKERGRAY);
-  drawLine(185, 25, 185, 200, COLOR_DARKERGRAY);
-  drawLine(210, 25, 210, 200, COLOR_DARKERGRAY);
-
-  // Render the individual data points
-  uint32_t counter;
-  for (counter = 0; counter < 9; counter++)
-  {
-    // Draw historical data
-    uint32_t arrayPosition = 9 - counter;
-
-    // Draw analog data points (Yellow)
-    if (adcEnabled)
-    {
-      drawLine(10 + counter * 25, adcValToPixel(adcBuffer[arrayPosition]), 10 + (counter + 1) * 25, adcValToPixel(adcBuffer[arrayPosition - 1]), COLOR_YELLOW);
-    }
-
-    // Draw digital data points (Green)
-    if (digEnabled)
-    {
-      drawLine(10 + counter * 25, adcValToPixel(digBuffer[arrayPosition]), 10 + (counter + 1) * 25, adcValToPixel(digBuffer[arrayPosition - 1]), COLOR_GREEN);
-    }
-  }
-
-  // Render ADC value in text if present
-  if (adcEnabled)
-  {
-    char text[10];
-    // Assuming 3.3V supply and 8-bit ADC values, 1 unit = 12.89mV (3300/256)
-    sprintf(text, "%u.%u V", ((adcBuffer[0] * 1289) / 100) / 1000, ((adcBuffer[0] * 1294) / 100) % 1000);
-    // Clear the previous text
-    drawRectangleFilled(175, 5, 250, 18, COLOR_DARKGRAY);
-    // Render the latest value in mV
-    drawString(180, 10, COLOR_BLACK, &dejaVuSansBold9ptFontInfo, text);
-    drawString(179,  9, COLOR_YELLOW, &dejaVuSansBold9ptFontInfo, text);
-  }
+  char text[20];
+  uint16_t lo, hi, x;
+
+  scopeRender(&chart, 0, SCOPE_LENGTH);
+
+  // Trigger marker
+  x = chart.x + scopeGetTrigger() * chart.width / SCOPE_LENGTH;
+  drawRectangleFilled(chart.x, 19, chart.x + chart.width - 1, 22, COLOR_GRAY_80);
+  drawLine(x - 2, 19, x + 2, 19, COLOR_YELLOW);
+  drawLine(x - 1, 20, x + 1, 20, COLOR_YELLOW);
+  drawPixel(x, 21, COLOR_YELLOW);
+
+  // Assuming a 3.3V supply, 1 unit = 3.226mV (3300/1023)
+  scopeGetRange(0, SCOPE_LENGTH, &lo, &hi);
+  lo = lo * 3300 / 1023;
+  hi = hi * 3300 / 1023;
+  sprintf(text, "%u.%02u-%u.%02uV", lo / 1000, (lo % 1000) / 10, hi / 1000, (hi % 1000) / 10);
+  drawRectangleFilled(175, 5, 319, 18, COLOR_GRAY_80);
+  drawString(180, 10, COLOR_BLACK, &dejaVuSansBold9ptFontInfo, text);
+  drawString(179,  9, COLOR_YELLOW, &dejaVuSansBold9ptFontInfo, text);
 }
 
 /**************************************************************************/
 /*! 
-    Shifts the buffer contents right one byte, and inserts the latest
-    value at the beginning.
+    Arms a new capture on AD5, triggering as the signal crosses half of
+    the supply
 */
 /**************************************************************************/
-void addToBuffer(uint8_t *buffer, uint8_t value)
+void startCapture(void)
 {
-  uint32_t counter;
-  for (counter = 9; counter > 0; counter--)
-  {
-    buffer[counter] = buffer[counter - 1];
-  }
-
-  // Append the latest value
-  buffer[0] = value;
+  scopeStart(5, rates[rate], edge, 512, SCOPE_LENGTH, SCOPE_PRETRIGGER);
 }
 
 /**************************************************************************/
@@ -208,15 +161,21 @@ int main(void)
   #if !defined CFG_TFTLCD
     #error "CFG_TFTLCD must be enabled in projectconfig.h for this test"
   #endif
+  #if !defined CFG_SCOPE
+    #error "CFG_SCOPE (and CFG_ADC_TRIGGER) must be enabled in projectconfig.h for this test"
+  #endif
+  #if CFG_SCOPE_SAMPLES < SCOPE_LENGTH
+    #error "CFG_SCOPE_SAMPLES must be at least 450 for this test"
+  #endif
   #if defined CFG_INTERFACE
     #error "CFG_INTERFACE must be disabled in projectconfig.h for this test (to save space)"
   #endif
 
+  uint32_t armedTicks = 0;
+  tsTouchData_t touch;
+
   // Configure cpu and mandatory peripherals
   systemInit();
-  
-  /* Set P2.0 to GPIO input (just in case) */
-  gpioSetDir(2, 0, 0);
 
   /* Set P1.4/AD5 to analog input (only AD0..3 are configured by adcInit) */
   IOCON_PIO1_4 &= ~(IOCON_PIO1_4_ADMODE_MASK |
@@ -227,46 +186,67 @@ int main(void)
 
   // Rotate the screen and render the area around the data grid
   lcdSetOrientation(LCD_ORIENTATION_LANDSCAPE);
+  chart.x = 10;
+  chart.y = 25;
+  chart.width = 225;
+  chart.height = 175;
+  chart.minValue = 0;
+  chart.maxValue = SCOPE_FULLSCALE;
+  chart.gridX = 25;
+  chart.gridY = 25;
+  chart.bgColor = COLOR_BLACK;
+  chart.gridColor = COLOR_GRAY_30;
+  chart.traceColor = COLOR_YELLOW;
+  chart.samples = chartSamples;
+  chartInit(&chart);
   renderLCDFrame();
 
-  tsTouchData_t touch;
+  startCapture();
 
-  // Start reading
   while (1)
   {
     // Wait up to 5ms for a touch event
     tsTouchError_t error = tsWaitForEvent(&touch, 5);
     if (!error)
     {
-      if (touch.x > 25 && touch.x < 100 && touch.y > 210)
+      if (touch.xlcd > 25 && touch.xlcd < 100 && touch.ylcd > 210)
       {
-        // Analog switch selected
-        adcEnabled = adcEnabled ? false : true;
+        // Next time base
+        rate = (rate + 1) % 3;
       }
-      if (touch.x > 125 && touch.x < 200 && touch.y > 210)
+      if (touch.xlcd > 125 && touch.xlcd < 225 && touch.ylcd > 210)
       {
-        // Digital switch selected
-        digEnabled = digEnabled ? false : true;
+        // Toggle the trigger edge
+        edge = edge == SCOPE_TRIGGER_RISING ? SCOPE_TRIGGER_FALLING : SCOPE_TRIGGER_RISING;
       }
-      // Refresh the frame
+      // Refresh the frame and start again with the new settings
       renderLCDFrame();
+      startCapture();
+      armedTicks = 0;
     }
 
-    // Read pins
-    if (adcEnabled)
-      addToBuffer(adcBuffer, adcRead(5) / 4); // 10-bit value converted to 8-bits
-    if (digEnabled)
-      addToBuffer(digBuffer, gpioGetValue(2, 0) ? 0xFF : 0x00);
-
-    // Update the LCD is required
-    renderLCDGrid();
-
-    // Note, this will actually mean the timing is ~100mS + the amount of
-    // time it took to get the readings and update the LCD
-    // A timer interrupt could be used to get much more accurate results,
-    // filling the buffer inside the IRQ and rendering the screen updates
-    // every x milliseconds
-    systickDelay(100);
+    switch (scopeGetState())
+    {
+      case SCOPE_STATE_DONE:
+        // Show the capture and arm the next one
+        renderCapture();
+        startCapture();
+        armedTicks = 0;
+        break;
+      case SCOPE_STATE_ARMED:
+        // Free run if the signal never crosses the trigger level
+        if (!armedTicks)
+        {
+          armedTicks = systickGetTicks();
+        }
+        else if ((systickGetTicks() - armedTicks) * CFG_SYSTICK_DELAY_IN_MS > SCOPE_AUTOMS)
+        {
+          scopeForce();
+        }
+        break;
+      default:
+        break;
+    }
   }
 
   return 0;
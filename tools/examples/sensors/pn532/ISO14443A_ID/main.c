@@ -85,11 +85,16 @@ int main (void)
     // Send the command
     error = pn532Write(abtCommand, sizeof(abtCommand));
 
-    // Wait until we get a response or an unexpected error message
+    // Wait until we get a response or an unexpected error message.  The
+    // frame is parsed as it arrives, so sleep until the next interrupt
+    // (UART RX or systick) and check again.
     do
     {
       error = pn532Read(response, &responseLen);
-      systickDelay(25);
+      if (error == PN532_ERROR_RESPONSEBUFFEREMPTY)
+      {
+        __asm volatile ("wfi");
+      }
     }
     #ifdef PN532_UART
     while (error == PN532_ERROR_RESPONSEBUFFEREMPTY);
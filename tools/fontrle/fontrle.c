@@ -0,0 +1,544 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Converts a font generated by The Dot Factory (see 'tools/dotfactory'
+ * and the existing files in drivers/lcd/tft/fonts) into the run-length
+ * encoded FONT_FORMAT_RLE variant described in bitmapfonts.h, or into an
+ * anti-aliased FONT_FORMAT_AA2/AA4 font.
+ *
+ * syntax: fontrle [-a <2|4>] <input.c> <output>
+ *
+ *   -a   Anti-alias with 2 or 4 bits per pixel.  The input font must be
+ *        rendered by The Dot Factory at 2x (-a 2) or 4x (-a 4) the
+ *        target size, and every 2x2 or 4x4 block of pixels becomes one
+ *        pixel of the output.
+ *
+ *   Writes <output>.c and <output>.h, with every symbol of the original
+ *   font suffixed by 'Rle', 'Aa2' or 'Aa4' (ex.
+ *   'bitstreamVeraSansMono11ptRleFontInfo').
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#define MAXROWS         16      // Row numbers are stored in 4-bit fields
+#define MAXWIDTH        31      // Limit used by drawCharRleOpaque()
+#define MAXCHARS        256
+#define RLE_LAST        0x80
+#define RLE_MAXSKIP     7
+#define RLE_MAXLEN      15
+
+static char *src;
+static char prefix[128];
+static char description[128];
+static uint8_t bitmaps[65536];
+static uint32_t bitmapCount;
+static uint8_t widths[MAXCHARS];
+static uint16_t offsets[MAXCHARS];
+static uint32_t charCount;
+static uint32_t heightPages;
+static uint32_t startChar;
+
+// Output settings (run-length encoding unless '-a' is given)
+static uint32_t aaBits;
+static const char *suffix = "Rle";
+static const char *arrayName = "CharRuns";
+static const char *kind = "Run-length encoded";
+static const char *formatName = "FONT_FORMAT_RLE";
+static uint32_t outHeightPages;
+static uint8_t outWidths[MAXCHARS];
+static uint16_t outOffsets[MAXCHARS];
+
+// Replaces every C comment with spaces so it doesn't confuse the parser
+static void stripComments(char *s)
+{
+  char *end;
+
+  while ((s = strstr(s, "/*")) != NULL)
+  {
+    end = strstr(s + 2, "*/");
+    if (end == NULL)
+    {
+      end = s + strlen(s) - 2;
+    }
+    memset(s, ' ', end + 2 - s);
+    s = end + 2;
+  }
+}
+
+// Returns the body of the initializer following 'name', or exits
+static char *findInitializer(char *s, const char *name)
+{
+  char *p = strstr(s, name);
+
+  if ((p == NULL) || ((p = strchr(p, '{')) == NULL))
+  {
+    fprintf(stderr, "Can't find '%s' in the input file\n", name);
+    exit(1);
+  }
+  return p + 1;
+}
+
+static void parse(void)
+{
+  char *p, *q, *end;
+  unsigned int w, o;
+
+  // Font name and description (taken before comments are removed)
+  if ((p = strstr(src, "/* Character bitmaps for ")) != NULL)
+  {
+    p += strlen("/* Character bitmaps for ");
+    q = strstr(p, " */");
+    if ((q != NULL) && (q - p < (int)sizeof(description)))
+    {
+      memcpy(description, p, q - p);
+    }
+  }
+  stripComments(src);
+  if ((p = strstr(src, "CharBitmaps[]")) == NULL)
+  {
+    fprintf(stderr, "Input doesn't look like a Dot Factory font\n");
+    exit(1);
+  }
+  q = p;
+  while ((q > src) && (isalnum((unsigned char)q[-1]) || (q[-1] == '_'))) q--;
+  if (p - q >= (int)sizeof(prefix))
+  {
+    fprintf(stderr, "Symbol name too long\n");
+    exit(1);
+  }
+  memcpy(prefix, q, p - q);
+  if (!description[0])
+  {
+    strcpy(description, prefix);
+  }
+
+  // Bitmap data
+  p = findInitializer(p, "CharBitmaps[]");
+  end = strstr(p, "};");
+  while ((p = strstr(p, "0x")) != NULL && p < end)
+  {
+    if (bitmapCount == sizeof(bitmaps))
+    {
+      fprintf(stderr, "Bitmap array too large\n");
+      exit(1);
+    }
+    bitmaps[bitmapCount++] = (uint8_t)strtoul(p, &p, 16);
+  }
+
+  // Character descriptors
+  p = findInitializer(src, "CharDescriptors[]");
+  end = strstr(p, "};");
+  while ((p = strchr(p, '{')) != NULL && p < end)
+  {
+    if ((sscanf(p, "{ %u , %u }", &w, &o) != 2) || (charCount == MAXCHARS))
+    {
+      fprintf(stderr, "Invalid character descriptor\n");
+      exit(1);
+    }
+    widths[charCount] = w;
+    offsets[charCount++] = o;
+    p++;
+  }
+
+  // Font information
+  p = findInitializer(src, "FontInfo =");
+  heightPages = strtoul(p, &p, 10);
+  if ((p = strchr(p, '\'')) != NULL)
+  {
+    startChar = (p[1] == '\\') ? (unsigned char)p[2] : (unsigned char)p[1];
+  }
+}
+
+// Returns TRUE if the pixel at (col, row) is set, with row 0 at the top
+static int getPixel(uint32_t c, uint32_t col, uint32_t row)
+{
+  uint32_t page = heightPages - 1 - (row >> 3);
+  return bitmaps[offsets[c] + heightPages * col + page] & (1 << (row & 7));
+}
+
+// Encodes a single row, returning the number of bytes written to 'out'
+static uint32_t encodeRow(uint32_t c, uint32_t row, uint8_t *out)
+{
+  uint32_t col = 0, last = 0, start, skip, len, n = 0;
+
+  while (col < widths[c])
+  {
+    if (!getPixel(c, col, row))
+    {
+      col++;
+      continue;
+    }
+    start = col;
+    while ((col < widths[c]) && getPixel(c, col, row)) col++;
+    skip = start - last;
+    len = col - start;
+    last = col;
+    while (skip > RLE_MAXSKIP)
+    {
+      out[n++] = RLE_MAXSKIP << 4;
+      skip -= RLE_MAXSKIP;
+    }
+    while (len > RLE_MAXLEN)
+    {
+      out[n++] = (skip << 4) | RLE_MAXLEN;
+      skip = 0;
+      len -= RLE_MAXLEN;
+    }
+    out[n++] = (skip << 4) | len;
+  }
+
+  if (n == 0)
+  {
+    out[n++] = 0;
+  }
+  out[n - 1] |= RLE_LAST;
+  return n;
+}
+
+static void printChar(FILE *pf, uint32_t c)
+{
+  if (c == '\\' || c == '\'')
+    fprintf(pf, "'\\%c'", c);
+  else
+    fprintf(pf, "'%c'", c);
+}
+
+// Writes the FONT_FORMAT_RLE glyph data, returning its size in bytes
+static uint32_t writeRleGlyphs(FILE *pf)
+{
+  uint8_t row[64];
+  uint32_t c, r, i, n, first, last, total = 0;
+
+  for (c = 0; c < charCount; c++)
+  {
+    // Only the rows between the first and last set pixel are stored
+    first = 0;
+    last = 0;
+    for (r = 0; r < heightPages * 8; r++)
+    {
+      for (i = 0; i < widths[c] && !getPixel(c, i, r); i++);
+      if (i < widths[c])
+      {
+        if (last == 0)
+        {
+          first = r;
+        }
+        last = r + 1;
+      }
+    }
+    if (last == 0)
+    {
+      first = 0;
+      last = 1;
+    }
+
+    outWidths[c] = widths[c];
+    outOffsets[c] = total;
+    fprintf(pf, "\t/* @%u ", total);
+    printChar(pf, c + startChar);
+    fprintf(pf, " (%u pixels wide) */\r\n", widths[c]);
+    fprintf(pf, "\t0x%02X, /* rows %u-%u */\r\n", (first << 4) | (last - first - 1), first, last - 1);
+    total++;
+
+    for (r = first; r < last; r++)
+    {
+      n = encodeRow(c, r, row);
+      fprintf(pf, "\t");
+      for (i = 0; i < n; i++)
+      {
+        fprintf(pf, "0x%02X, ", row[i]);
+      }
+      fprintf(pf, "%*s/* ", (int)(6 * (4 - (n > 4 ? 4 : n))), "");
+      for (i = 0; i < widths[c]; i++)
+      {
+        fputc(getPixel(c, i, r) ? '#' : ' ', pf);
+      }
+      fprintf(pf, " */\r\n");
+      total += n;
+    }
+    fprintf(pf, "\r\n");
+  }
+  outHeightPages = heightPages;
+
+  return total;
+}
+
+// Returns the coverage (0..2^aaBits-1) of one pixel of the scaled down glyph
+static uint32_t getCoverage(uint32_t c, uint32_t col, uint32_t row)
+{
+  uint32_t scale = aaBits, x, y, count = 0;
+  uint32_t max = (1 << aaBits) - 1;
+
+  for (y = row * scale; y < (row + 1) * scale; y++)
+  {
+    for (x = col * scale; x < (col + 1) * scale; x++)
+    {
+      if ((x < widths[c]) && (y < heightPages * 8) && getPixel(c, x, y))
+      {
+        count++;
+      }
+    }
+  }
+  return (count * max + (scale * scale) / 2) / (scale * scale);
+}
+
+// Writes the FONT_FORMAT_AA2/AA4 glyph data, returning its size in bytes
+static uint32_t writeAaGlyphs(FILE *pf)
+{
+  static const char shades[] = " .:-=+*%#";
+  uint32_t c, r, i, bits, n, total = 0;
+  uint32_t max = (1 << aaBits) - 1;
+  uint32_t rows, picture[MAXROWS * 4][MAXWIDTH + 1];
+  uint8_t acc;
+
+  // Each 2x2 (2 bpp) or 4x4 (4 bpp) block of the source is one pixel
+  rows = (heightPages * 8 + aaBits - 1) / aaBits;
+  outHeightPages = (rows + 7) / 8;
+
+  for (c = 0; c < charCount; c++)
+  {
+    outWidths[c] = (widths[c] + aaBits - 1) / aaBits;
+    outOffsets[c] = total;
+    fprintf(pf, "\t/* @%u ", total);
+    printChar(pf, c + startChar);
+    fprintf(pf, " (%u pixels wide) */\r\n", outWidths[c]);
+
+    for (r = 0; r < outHeightPages * 8; r++)
+    {
+      for (i = 0; i < outWidths[c]; i++)
+      {
+        picture[r][i] = getCoverage(c, i, r);
+      }
+    }
+
+    // Pack the pixels MSB first, without padding between rows
+    acc = 0;
+    bits = 0;
+    n = 0;
+    fprintf(pf, "\t");
+    for (r = 0; r < outHeightPages * 8; r++)
+    {
+      for (i = 0; i < outWidths[c]; i++)
+      {
+        acc = (acc << aaBits) | picture[r][i];
+        bits += aaBits;
+        if (bits == 8)
+        {
+          fprintf(pf, "0x%02X, ", acc);
+          if (++n % 8 == 0)
+          {
+            fprintf(pf, "\r\n\t");
+          }
+          acc = 0;
+          bits = 0;
+        }
+      }
+    }
+    if (bits)
+    {
+      fprintf(pf, "0x%02X, ", (uint8_t)(acc << (8 - bits)));
+      n++;
+    }
+    fprintf(pf, "\r\n");
+    total += n;
+
+    // Draw a preview of the glyph for reference
+    for (r = 0; r < outHeightPages * 8; r++)
+    {
+      fprintf(pf, "\t/* ");
+      for (i = 0; i < outWidths[c]; i++)
+      {
+        fputc(shades[(picture[r][i] * 8 + max / 2) / max], pf);
+      }
+      fprintf(pf, " */\r\n");
+    }
+    fprintf(pf, "\r\n");
+  }
+
+  return total;
+}
+
+static uint32_t writeSource(FILE *pf, const char *header)
+{
+  uint32_t c, total;
+
+  fprintf(pf, "#include \"%s\"\r\n\r\n", header);
+  fprintf(pf, "/* \r\n**  %s font data for %s\r\n", kind, description);
+  fprintf(pf, "**  (generated from The Dot Factory output by tools/fontrle)\r\n*/\r\n\r\n");
+  fprintf(pf, "/* Character data for %s */\r\n", description);
+  fprintf(pf, "const uint8_t %s%s%s[] = \r\n{\r\n", prefix, suffix, arrayName);
+  total = aaBits ? writeAaGlyphs(pf) : writeRleGlyphs(pf);
+  fprintf(pf, "};\r\n\r\n");
+
+  fprintf(pf, "/* Character descriptors for %s */\r\n", description);
+  fprintf(pf, "/* { [Char width in bits], [Offset into %s%s%s in bytes] } */\r\n", prefix, suffix, arrayName);
+  fprintf(pf, "const FONT_CHAR_INFO %s%sCharDescriptors[] =\r\n{\r\n", prefix, suffix);
+  for (c = 0; c < charCount; c++)
+  {
+    fprintf(pf, "\t{%u, %u}, \t\t/* %c */\r\n", outWidths[c], outOffsets[c], c + startChar);
+  }
+  fprintf(pf, "};\r\n\r\n");
+
+  fprintf(pf, "/* Font information for %s */\r\n", description);
+  fprintf(pf, "const FONT_INFO %s%sFontInfo =\r\n{\r\n", prefix, suffix);
+  fprintf(pf, "\t%u, /*  Character height */\r\n", outHeightPages);
+  fprintf(pf, "\t");
+  printChar(pf, startChar);
+  fprintf(pf, ", /*  Start character */\r\n");
+  fprintf(pf, "\t%s%sCharDescriptors, /*  Character decriptor array */\r\n", prefix, suffix);
+  fprintf(pf, "\t%s%s%s, /*  Character data array */\r\n", prefix, suffix, arrayName);
+  fprintf(pf, "\t%s, /*  Glyph data format */\r\n", formatName);
+  fprintf(pf, "};\r\n");
+
+  return total;
+}
+
+static void writeHeader(FILE *pf, const char *name)
+{
+  char guard[128];
+  size_t i;
+
+  for (i = 0; name[i] && i < sizeof(guard) - 1; i++)
+  {
+    guard[i] = isalnum((unsigned char)name[i]) ? toupper((unsigned char)name[i]) : '_';
+  }
+  guard[i] = '\0';
+
+  fprintf(pf, "#ifndef __%s__\r\n#define __%s__\r\n\r\n", guard, guard);
+  fprintf(pf, "#include \"bitmapfonts.h\"\r\n\r\n");
+  fprintf(pf, "/* %s font data for %s */\r\n", kind, description);
+  fprintf(pf, "extern const uint8_t %s%s%s[];\r\n", prefix, suffix, arrayName);
+  fprintf(pf, "extern const FONT_CHAR_INFO %s%sCharDescriptors[];\r\n", prefix, suffix);
+  fprintf(pf, "extern const FONT_INFO %s%sFontInfo;\r\n\r\n", prefix, suffix);
+  fprintf(pf, "#endif\r\n");
+}
+
+int main(int argc, char **argv)
+{
+  FILE *pf;
+  long size;
+  uint32_t c, total;
+  char path[1024], header[1024];
+  const char *base;
+  int arg = 1;
+
+  if ((argc == 5) && (strcmp(argv[1], "-a") == 0))
+  {
+    aaBits = atoi(argv[2]);
+    arg = 3;
+    if (aaBits == 2)
+    {
+      suffix = "Aa2";
+      formatName = "FONT_FORMAT_AA2";
+    }
+    else if (aaBits == 4)
+    {
+      suffix = "Aa4";
+      formatName = "FONT_FORMAT_AA4";
+    }
+    else
+    {
+      fprintf(stderr, "Anti-aliased fonts must use 2 or 4 bits per pixel\n");
+      return 1;
+    }
+    arrayName = "CharBitmaps";
+    kind = "Anti-aliased";
+  }
+  else if (argc != 3)
+  {
+    fprintf(stderr, "syntax: fontrle [-a <2|4>] <input.c> <output>\n");
+    return 1;
+  }
+
+  // Read the whole source file
+  if ((pf = fopen(argv[arg], "rb")) == NULL)
+  {
+    fprintf(stderr, "Can't open %s\n", argv[arg]);
+    return 1;
+  }
+  fseek(pf, 0, SEEK_END);
+  size = ftell(pf);
+  fseek(pf, 0, SEEK_SET);
+  src = calloc(size + 1, 1);
+  if ((src == NULL) || (fread(src, 1, size, pf) != (size_t)size))
+  {
+    fprintf(stderr, "Can't read %s\n", argv[arg]);
+    return 1;
+  }
+  fclose(pf);
+
+  parse();
+
+  // Check the limits of the encoding
+  if ((charCount == 0) || (heightPages == 0) || (heightPages * 8 > (aaBits ? MAXROWS * aaBits : MAXROWS)))
+  {
+    fprintf(stderr, "Font is too tall for this format\n");
+    return 1;
+  }
+  for (c = 0; c < charCount; c++)
+  {
+    if ((widths[c] > (aaBits ? MAXWIDTH * aaBits : MAXWIDTH)) || (offsets[c] + widths[c] * heightPages > bitmapCount))
+    {
+      fprintf(stderr, "Invalid character %u\n", c + startChar);
+      return 1;
+    }
+  }
+
+  base = strrchr(argv[arg + 1], '/');
+  base = base ? base + 1 : argv[arg + 1];
+  snprintf(header, sizeof(header), "%s.h", base);
+
+  snprintf(path, sizeof(path), "%s.c", argv[arg + 1]);
+  if ((pf = fopen(path, "wb")) == NULL)
+  {
+    fprintf(stderr, "Can't create %s\n", path);
+    return 1;
+  }
+  total = writeSource(pf, header);
+  fclose(pf);
+
+  snprintf(path, sizeof(path), "%s.h", argv[arg + 1]);
+  if ((pf = fopen(path, "wb")) == NULL)
+  {
+    fprintf(stderr, "Can't create %s\n", path);
+    return 1;
+  }
+  writeHeader(pf, base);
+  fclose(pf);
+
+  printf("%s: %u characters, %u bytes -> %u bytes\n", prefix, charCount, bitmapCount, total);
+
+  return 0;
+}
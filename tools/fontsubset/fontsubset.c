@@ -0,0 +1,517 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Strips the glyphs that a project doesn't use out of a font in
+ * drivers/lcd/tft/fonts (as generated by The Dot Factory or by
+ * tools/fontrle), or converts a font to the .fnt format that
+ * drivers/lcd/tft/fontcache.c loads from an asset pack.
+ *
+ * syntax: fontsubset [-b] [-c <chars>] [-s <source.c> ...] [--] <input.c> <output>
+ *
+ *   -c   Keep the characters in <chars>
+ *   -s   Keep every character that appears in a string or character
+ *        literal in the given source files (everything up to the next
+ *        option or '--')
+ *   -b   Write <output>.fnt (see fontcache.h) instead of <output>.c
+ *
+ *   A space is always kept, and without -c or -s every glyph is kept.
+ *   The character range and all symbol names stay the same, so the
+ *   original header can still be used and the .c file can be linked
+ *   instead of the original one.  Dropped characters are given a width
+ *   of 0 and are not drawn.
+ *
+ *   Only text drawn from string literals can be found with -s: strings
+ *   built at run time (numbers from printf, text from the CLI, etc.)
+ *   need their characters added with -c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#define MAXCHARS        256
+#define MAXDATA         65536
+
+static char *src;
+static char includes[1024];
+static char description[128];
+static char dataName[128];
+static char prefix[128];
+static char format[32] = "FONT_FORMAT_PAGES";
+static uint8_t data[MAXDATA];
+static uint32_t dataCount;
+static uint8_t widths[MAXCHARS];
+static uint16_t offsets[MAXCHARS];
+static uint32_t charCount;
+static uint32_t heightPages;
+static uint32_t startChar;
+
+static uint8_t keep[256];
+static int subset;
+
+static uint8_t outData[MAXDATA];
+static uint32_t outCount;
+static uint8_t outWidths[MAXCHARS];
+static uint16_t outOffsets[MAXCHARS];
+static uint8_t outKept[MAXCHARS];
+
+static char *readFile(const char *path)
+{
+  FILE *pf;
+  long size;
+  char *s;
+
+  if ((pf = fopen(path, "rb")) == NULL)
+  {
+    fprintf(stderr, "Can't open %s\n", path);
+    exit(1);
+  }
+  fseek(pf, 0, SEEK_END);
+  size = ftell(pf);
+  fseek(pf, 0, SEEK_SET);
+  s = calloc(size + 1, 1);
+  if ((s == NULL) || (fread(s, 1, size, pf) != (size_t)size))
+  {
+    fprintf(stderr, "Can't read %s\n", path);
+    exit(1);
+  }
+  fclose(pf);
+  return s;
+}
+
+static void stripComments(char *s)
+{
+  char *end;
+
+  while ((s = strstr(s, "/*")) != NULL)
+  {
+    end = strstr(s + 2, "*/");
+    if (end == NULL)
+    {
+      end = s + strlen(s) - 2;
+    }
+    memset(s, ' ', end + 2 - s);
+    s = end + 2;
+  }
+}
+
+// Returns the body of the initializer following 'name', or exits
+static char *findInitializer(char *s, const char *name)
+{
+  char *p = strstr(s, name);
+
+  if ((p == NULL) || ((p = strchr(p, '{')) == NULL))
+  {
+    fprintf(stderr, "Can't find '%s' in the input file\n", name);
+    exit(1);
+  }
+  return p + 1;
+}
+
+// Copies the identifier that ends just before 'p'
+static void getName(char *dst, size_t size, const char *start, const char *p)
+{
+  const char *q = p;
+
+  while ((q > start) && (isalnum((unsigned char)q[-1]) || (q[-1] == '_'))) q--;
+  if ((size_t)(p - q) >= size)
+  {
+    fprintf(stderr, "Symbol name too long\n");
+    exit(1);
+  }
+  memcpy(dst, q, p - q);
+  dst[p - q] = '\0';
+}
+
+static void parse(void)
+{
+  char *p, *q, *end;
+  unsigned int w, o;
+  size_t n;
+
+  // Includes and description (taken before comments are removed)
+  for (p = src; (p = strstr(p, "#include")) != NULL; p = q)
+  {
+    q = strchr(p, '\n');
+    q = q ? q + 1 : p + strlen(p);
+    n = strlen(includes);
+    if (n + (q - p) + 1 < sizeof(includes))
+    {
+      memcpy(includes + n, p, q - p);
+    }
+  }
+  for (p = src; !description[0] && (p = strstr(p, "/* Character ")) != NULL; p = q)
+  {
+    q = strstr(p, " */");
+    if ((q == NULL) || ((p = strstr(p, " for ")) == NULL) || (p > q))
+    {
+      break;
+    }
+    p += strlen(" for ");
+    if ((q - p < (int)sizeof(description)) && !memchr(p, '\n', q - p))
+    {
+      memcpy(description, p, q - p);
+    }
+  }
+  stripComments(src);
+
+  // The glyph data is the only uint8_t array, the names of the other
+  // symbols are taken from the descriptors
+  if ((p = strstr(src, "const uint8_t")) == NULL || (q = strstr(p, "[]")) == NULL)
+  {
+    fprintf(stderr, "Input doesn't look like a bitmap font\n");
+    exit(1);
+  }
+  getName(dataName, sizeof(dataName), p, q);
+  if ((q = strstr(src, "CharDescriptors[]")) == NULL)
+  {
+    fprintf(stderr, "Input doesn't look like a bitmap font\n");
+    exit(1);
+  }
+  getName(prefix, sizeof(prefix), src, q);
+  if (!description[0])
+  {
+    strcpy(description, prefix);
+  }
+
+  // Glyph data
+  p = findInitializer(p, dataName);
+  end = strstr(p, "};");
+  while ((p = strstr(p, "0x")) != NULL && p < end)
+  {
+    if (dataCount == sizeof(data))
+    {
+      fprintf(stderr, "Glyph data too large\n");
+      exit(1);
+    }
+    data[dataCount++] = (uint8_t)strtoul(p, &p, 16);
+  }
+
+  // Character descriptors
+  p = findInitializer(src, "CharDescriptors[]");
+  end = strstr(p, "};");
+  while ((p = strchr(p, '{')) != NULL && p < end)
+  {
+    if ((sscanf(p, "{ %u , %u }", &w, &o) != 2) || (charCount == MAXCHARS) || (o > dataCount))
+    {
+      fprintf(stderr, "Invalid character descriptor\n");
+      exit(1);
+    }
+    widths[charCount] = w;
+    offsets[charCount++] = o;
+    p++;
+  }
+
+  // Font information
+  p = findInitializer(src, "FontInfo =");
+  end = strstr(p, "};");
+  heightPages = strtoul(p, &p, 10);
+  if ((p = strchr(p, '\'')) != NULL)
+  {
+    startChar = (p[1] == '\\') ? (unsigned char)p[2] : (unsigned char)p[1];
+  }
+  if (((p = strstr(src, "FONT_FORMAT_")) != NULL) && (p < end))
+  {
+    for (n = 0; (n < sizeof(format) - 1) && (isalnum((unsigned char)p[n]) || (p[n] == '_')); n++)
+    {
+      format[n] = p[n];
+    }
+    format[n] = '\0';
+  }
+}
+
+// Glyphs are stored in order, so each one ends where the next one starts
+static uint32_t glyphLength(uint32_t c)
+{
+  uint32_t i, end = dataCount;
+
+  for (i = 0; i < charCount; i++)
+  {
+    if ((offsets[i] > offsets[c]) && (offsets[i] < end))
+    {
+      end = offsets[i];
+    }
+  }
+  return end - offsets[c];
+}
+
+// Marks the characters of every string and character literal in 'path'
+static void scanSource(const char *path)
+{
+  char *s = readFile(path), *p;
+  char quote;
+
+  stripComments(s);
+  for (p = s; *p; p++)
+  {
+    if (p[0] == '/' && p[1] == '/')
+    {
+      while (*p && *p != '\n') p++;
+      if (!*p) break;
+      continue;
+    }
+    if (*p != '"' && *p != '\'')
+    {
+      continue;
+    }
+    quote = *p++;
+    while (*p && *p != quote && *p != '\n')
+    {
+      if (*p == '\\' && p[1])
+      {
+        p++;
+        switch (*p)
+        {
+          case 'n': case 'r': case 't': case '0': break;
+          case 'x': p++; keep[(uint8_t)strtoul(p, &p, 16)] = 1; p--; break;
+          default: keep[(uint8_t)*p] = 1; break;
+        }
+      }
+      else
+      {
+        keep[(uint8_t)*p] = 1;
+      }
+      p++;
+    }
+    if (!*p) break;
+  }
+  free(s);
+}
+
+static void buildSubset(void)
+{
+  uint32_t c, length, empty = 0;
+
+  // FONT_FORMAT_RLE glyphs aren't bounded by the width, so dropped
+  // characters share one empty glyph (a single blank row)
+  if (subset && !strcmp(format, "FONT_FORMAT_RLE"))
+  {
+    outData[outCount++] = 0x00;
+    outData[outCount++] = 0x80;
+  }
+
+  for (c = 0; c < charCount; c++)
+  {
+    if (subset && !keep[c + startChar])
+    {
+      outWidths[c] = 0;
+      outOffsets[c] = empty;
+      continue;
+    }
+    length = glyphLength(c);
+    outKept[c] = 1;
+    outWidths[c] = widths[c];
+    outOffsets[c] = outCount;
+    memcpy(&outData[outCount], &data[offsets[c]], length);
+    outCount += length;
+  }
+}
+
+static void printChar(FILE *pf, uint32_t c)
+{
+  if (c == '\\' || c == '\'')
+    fprintf(pf, "'\\%c'", c);
+  else
+    fprintf(pf, "'%c'", c);
+}
+
+static void writeSource(FILE *pf)
+{
+  uint32_t c, i, length;
+
+  for (i = 0; includes[i]; i++)
+  {
+    if (includes[i] == '\n' && (i == 0 || includes[i - 1] != '\r')) fputc('\r', pf);
+    fputc(includes[i], pf);
+  }
+  fprintf(pf, "\r\n/* \r\n**  Font data for %s\r\n", description);
+  fprintf(pf, "**  (subset generated by tools/fontsubset)\r\n*/\r\n\r\n");
+  fprintf(pf, "/* Character data for %s */\r\n", description);
+  fprintf(pf, "const uint8_t %s[] = \r\n{\r\n", dataName);
+  if (subset && !strcmp(format, "FONT_FORMAT_RLE"))
+  {
+    fprintf(pf, "\t/* @0 (empty glyph for the dropped characters) */\r\n");
+    fprintf(pf, "\t0x00, 0x80,\r\n\r\n");
+  }
+  for (c = 0; c < charCount; c++)
+  {
+    if (!outKept[c]) continue;
+    length = glyphLength(c);
+    fprintf(pf, "\t/* @%u ", outOffsets[c]);
+    printChar(pf, c + startChar);
+    fprintf(pf, " (%u pixels wide) */\r\n", outWidths[c]);
+    for (i = 0; i < length; i++)
+    {
+      fprintf(pf, "%s0x%02X,%s", (i % 8) ? " " : "\t", outData[outOffsets[c] + i], ((i % 8) == 7 || i == length - 1) ? "\r\n" : "");
+    }
+    fprintf(pf, "\r\n");
+  }
+  fprintf(pf, "};\r\n\r\n");
+
+  fprintf(pf, "/* Character descriptors for %s */\r\n", description);
+  fprintf(pf, "/* { [Char width in bits], [Offset into %s in bytes] } */\r\n", dataName);
+  fprintf(pf, "const FONT_CHAR_INFO %sCharDescriptors[] =\r\n{\r\n", prefix);
+  for (c = 0; c < charCount; c++)
+  {
+    fprintf(pf, "\t{%u, %u}, \t\t/* %c */\r\n", outWidths[c], outOffsets[c], c + startChar);
+  }
+  fprintf(pf, "};\r\n\r\n");
+
+  fprintf(pf, "/* Font information for %s */\r\n", description);
+  fprintf(pf, "const FONT_INFO %sFontInfo =\r\n{\r\n", prefix);
+  fprintf(pf, "\t%u, /*  Character height */\r\n", heightPages);
+  fprintf(pf, "\t");
+  printChar(pf, startChar);
+  fprintf(pf, ", /*  Start character */\r\n");
+  fprintf(pf, "\t%sCharDescriptors, /*  Character decriptor array */\r\n", prefix);
+  fprintf(pf, "\t%s, /*  Character data array */\r\n", dataName);
+  fprintf(pf, "\t%s, /*  Glyph data format */\r\n", format);
+  fprintf(pf, "};\r\n");
+}
+
+// .fnt layout: "uFNT", heightPages, startChar, charCount, format, then
+// charCount * { width, offset (16-bit LE) } and the glyph data
+static void writeBinary(FILE *pf)
+{
+  static const char *formats[] = { "FONT_FORMAT_PAGES", "FONT_FORMAT_RLE", "FONT_FORMAT_AA2", "FONT_FORMAT_AA4" };
+  uint8_t hdr[8];
+  uint32_t c, f;
+
+  for (f = 0; f < 4 && strcmp(format, formats[f]); f++);
+  hdr[0] = 'u';
+  hdr[1] = 'F';
+  hdr[2] = 'N';
+  hdr[3] = 'T';
+  hdr[4] = heightPages;
+  hdr[5] = startChar;
+  hdr[6] = charCount;
+  hdr[7] = f;
+  fwrite(hdr, 1, sizeof(hdr), pf);
+  for (c = 0; c < charCount; c++)
+  {
+    fputc(outWidths[c], pf);
+    fputc(outOffsets[c] & 0xFF, pf);
+    fputc(outOffsets[c] >> 8, pf);
+  }
+  fwrite(outData, 1, outCount, pf);
+}
+
+int main(int argc, char **argv)
+{
+  FILE *pf;
+  char path[1024];
+  const char *chars;
+  int arg, binary = 0, scanning = 0;
+  uint32_t c, kept = 0;
+
+  for (arg = 1; arg < argc; arg++)
+  {
+    if (!strcmp(argv[arg], "--"))
+    {
+      arg++;
+      break;
+    }
+    else if (!strcmp(argv[arg], "-b"))
+    {
+      binary = 1;
+      scanning = 0;
+    }
+    else if (!strcmp(argv[arg], "-c") && (arg + 1 < argc))
+    {
+      for (chars = argv[++arg]; *chars; chars++)
+      {
+        keep[(uint8_t)*chars] = 1;
+      }
+      subset = 1;
+      scanning = 0;
+    }
+    else if (!strcmp(argv[arg], "-s"))
+    {
+      subset = 1;
+      scanning = 1;
+    }
+    else if (scanning && (argc - arg > 2))
+    {
+      scanSource(argv[arg]);
+    }
+    else
+    {
+      break;
+    }
+  }
+  if ((argc - arg != 2) || (argv[arg][0] == '-'))
+  {
+    fprintf(stderr, "syntax: fontsubset [-b] [-c <chars>] [-s <source.c> ...] [--] <input.c> <output>\n");
+    return 1;
+  }
+  keep[' '] = 1;
+
+  src = readFile(argv[arg]);
+  parse();
+  if ((charCount == 0) || (heightPages == 0) || (startChar + charCount > 256))
+  {
+    fprintf(stderr, "Invalid font\n");
+    return 1;
+  }
+  if (binary && charCount > 255)
+  {
+    fprintf(stderr, "Too many characters for a .fnt file\n");
+    return 1;
+  }
+  buildSubset();
+
+  snprintf(path, sizeof(path), binary ? "%s.fnt" : "%s.c", argv[arg + 1]);
+  if ((pf = fopen(path, "wb")) == NULL)
+  {
+    fprintf(stderr, "Can't create %s\n", path);
+    return 1;
+  }
+  if (binary)
+  {
+    writeBinary(pf);
+  }
+  else
+  {
+    writeSource(pf);
+  }
+  fclose(pf);
+
+  for (c = 0; c < charCount; c++)
+  {
+    if (outKept[c]) kept++;
+  }
+  printf("%s: %u of %u characters, %u bytes -> %u bytes\n", prefix, kept, charCount, dataCount, outCount);
+
+  return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * The few FatFs calls used by bmp.c and img565.c, implemented on top of
+ * stdio so images can be loaded from and saved to the host file system
+ * (paths are relative to the current directory), plus ffSinkForward.  Asset packs use raw
+ * SD sector reads, which aren't emulated: assetPackFind always fails.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "projectconfig.h"
+#include "drivers/fatfs/diskio.h"
+#include "drivers/fatfs/ff.h"
+#include "drivers/fatfs/ffsink.h"
+#include "drivers/fatfs/ffsync.h"
+#include "drivers/fatfs/assetpack.h"
+
+#define SIM_MAXFILES    (4)
+
+static struct
+{
+  FIL  *fp;
+  FILE *file;
+} simFiles[SIM_MAXFILES];
+
+static FILE *simLookup(FIL *fp)
+{
+  int i;
+
+  for (i = 0; i < SIM_MAXFILES; i++)
+  {
+    if (simFiles[i].fp == fp)
+    {
+      return simFiles[i].file;
+    }
+  }
+  return NULL;
+}
+
+FRESULT ffSyncMount(void)
+{
+  return FR_OK;
+}
+
+void ffSyncUnmount(void)
+{
+}
+
+FRESULT f_open(FIL *fp, const XCHAR *path, BYTE mode)
+{
+  const char *m = (mode & FA_CREATE_ALWAYS) ? "w+b" : (mode & FA_WRITE) ? "r+b" : "rb";
+  FILE *file;
+  int i;
+
+  while (*path == '/')
+  {
+    path++;
+  }
+  for (i = 0; i < SIM_MAXFILES && simFiles[i].fp; i++);
+  if (i == SIM_MAXFILES)
+  {
+    return FR_NOT_ENOUGH_CORE;
+  }
+  if ((file = fopen((const char *)path, m)) == NULL)
+  {
+    return FR_NO_FILE;
+  }
+
+  memset(fp, 0, sizeof(FIL));
+  fseek(file, 0, SEEK_END);
+  fp->fsize = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  simFiles[i].fp = fp;
+  simFiles[i].file = file;
+  return FR_OK;
+}
+
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br)
+{
+  FILE *file = simLookup(fp);
+
+  if (!file)
+  {
+    return FR_INVALID_OBJECT;
+  }
+  *br = fread(buff, 1, btr, file);
+  fp->fptr += *br;
+  return ferror(file) ? FR_DISK_ERR : FR_OK;
+}
+
+FRESULT f_write(FIL *fp, const void *buff, UINT btw, UINT *bw)
+{
+  FILE *file = simLookup(fp);
+
+  if (!file)
+  {
+    return FR_INVALID_OBJECT;
+  }
+  *bw = fwrite(buff, 1, btw, file);
+  fp->fptr += *bw;
+  if (fp->fptr > fp->fsize)
+  {
+    fp->fsize = fp->fptr;
+  }
+  return *bw == btw ? FR_OK : FR_DISK_ERR;
+}
+
+FRESULT f_lseek(FIL *fp, DWORD ofs)
+{
+  FILE *file = simLookup(fp);
+
+  if (!file)
+  {
+    return FR_INVALID_OBJECT;
+  }
+  fp->fptr = ofs;
+  return fseek(file, ofs, SEEK_SET) ? FR_DISK_ERR : FR_OK;
+}
+
+FRESULT f_close(FIL *fp)
+{
+  int i;
+
+  for (i = 0; i < SIM_MAXFILES; i++)
+  {
+    if (simFiles[i].fp == fp)
+    {
+      simFiles[i].fp = NULL;
+      return fclose(simFiles[i].file) ? FR_DISK_ERR : FR_OK;
+    }
+  }
+  return FR_INVALID_OBJECT;
+}
+
+FRESULT ffSinkForward(FIL *fp, ffSink_t *sink, UINT btf, UINT *bf)
+{
+  BYTE window[512];
+  UINT n, off, used;
+  FRESULT res;
+
+  // Hands the data over one sector window at a time, like f_forward
+  *bf = 0;
+  sink->status = 0;
+  while (btf && (fp->fptr < fp->fsize))
+  {
+    n = sizeof(window) - (fp->fptr % sizeof(window));
+    if ((res = f_read(fp, window, n < btf ? n : btf, &n)) != FR_OK)
+    {
+      return res;
+    }
+    if (!n)
+    {
+      break;
+    }
+    for (off = 0; off < n; off += used)
+    {
+      if (!(used = sink->write(sink, &window[off], n - off)) || sink->status)
+      {
+        return FR_TIMEOUT;
+      }
+    }
+    *bf += n;
+    btf -= n;
+  }
+  return FR_OK;
+}
+
+assetpack_error_t assetPackFind(uint16_t id, assetpack_entry_t *entry)
+{
+  (void)id;
+  (void)entry;
+  return ASSETPACK_ERROR_NOTOPEN;
+}
+
+assetpack_error_t assetPackGetSector(const assetpack_entry_t *entry, uint32_t sector, const uint8_t **data)
+{
+  (void)entry;
+  (void)sector;
+  (void)data;
+  return ASSETPACK_ERROR_NOTOPEN;
+}
@@ -0,0 +1,522 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Framebuffer implementation of drivers/lcd/tft/lcd.h (see lcdsim.h).
+ * The bus traffic charged to each call follows the ILI9328 driver:
+ * a cursor set is two register writes, opening a window is four, and
+ * lines and fills go through the repeated data write.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lcdsim.h"
+#include "drivers/lcd/tft/lcd.h"
+
+lcdSimStats_t lcdSimStats;
+
+static uint16_t simGram[LCDSIM_WIDTH * LCDSIM_HEIGHT];
+static lcdOrientation_t simOrientation = LCD_ORIENTATION_PORTRAIT;
+static lcdProperties_t simProperties = { LCDSIM_WIDTH, LCDSIM_HEIGHT, TRUE, TRUE, FALSE };
+
+// Window opened with lcdSetWindow, in screen coordinates
+static bool simWindowActive = FALSE;
+static uint16_t simWinX0, simWinY0, simWinX1, simWinY1;
+
+// Current GRAM address, in screen coordinates
+static uint16_t simX, simY;
+
+/**************************************************************************/
+/*                                                                        */
+/* ------------------------- Bus cost model ----------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+static void simCommand(uint32_t count)
+{
+  lcdSimStats.commands += count;
+  lcdSimStats.busCycles += count * LCDSIM_CYCLES_CMD;
+}
+
+static void simData(uint32_t count)
+{
+  lcdSimStats.dataWrites += count;
+  lcdSimStats.busCycles += count * LCDSIM_CYCLES_DATA;
+}
+
+static void simRegister(uint32_t count)
+{
+  simCommand(count);
+  simData(count);
+}
+
+static void simRepeat(uint32_t count)
+{
+  lcdSimStats.dataWrites += count;
+  lcdSimStats.busCycles += count * LCDSIM_CYCLES_REPEAT;
+}
+
+static void simRead(uint32_t count)
+{
+  lcdSimStats.pixelsRead += count;
+  lcdSimStats.busCycles += count * LCDSIM_CYCLES_READ;
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ------------------------- GRAM emulation ----------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+static uint16_t *simAddress(uint16_t x, uint16_t y)
+{
+  // Screen X runs along the GRAM vertical address in landscape mode
+  if (simOrientation == LCD_ORIENTATION_LANDSCAPE)
+  {
+    return &simGram[x * LCDSIM_WIDTH + y];
+  }
+  return &simGram[y * LCDSIM_WIDTH + x];
+}
+
+static void simReleaseWindow(void)
+{
+  if (simWindowActive)
+  {
+    simWindowActive = FALSE;
+    lcdSimStats.windowSets++;
+    simRegister(4);
+  }
+}
+
+static void simSetCursor(uint16_t x, uint16_t y)
+{
+  lcdSimStats.cursorSets++;
+  simRegister(2);
+  simCommand(1);          // Write Data to GRAM (R22h)
+  simX = x;
+  simY = y;
+}
+
+// Stores a pixel at the GRAM address and advances it like the
+// controller does, wrapping at the window (or screen) edges
+static void simPut(uint16_t color)
+{
+  uint16_t x0 = simWindowActive ? simWinX0 : 0;
+  uint16_t x1 = simWindowActive ? simWinX1 : lcdGetWidth() - 1;
+  uint16_t y0 = simWindowActive ? simWinY0 : 0;
+  uint16_t y1 = simWindowActive ? simWinY1 : lcdGetHeight() - 1;
+
+  if ((simX < lcdGetWidth()) && (simY < lcdGetHeight()))
+  {
+    *simAddress(simX, simY) = color;
+  }
+  lcdSimStats.pixelsWritten++;
+
+  if (++simX > x1)
+  {
+    simX = x0;
+    if (++simY > y1)
+    {
+      simY = y0;
+    }
+  }
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* --------------------------- Sim helpers ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Clears the counters (the framebuffer is left untouched)
+*/
+/**************************************************************************/
+void lcdSimReset(void)
+{
+  memset(&lcdSimStats, 0, sizeof(lcdSimStats));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads a pixel without charging any bus traffic
+*/
+/**************************************************************************/
+uint16_t lcdSimGetPixel(uint16_t x, uint16_t y)
+{
+  return *simAddress(x, y);
+}
+
+/**************************************************************************/
+/*!
+    @brief  FNV-1a hash of the whole GRAM, used for the golden images
+*/
+/**************************************************************************/
+uint32_t lcdSimHash(void)
+{
+  uint32_t hash = 2166136261u;
+  uint32_t i;
+
+  for (i = 0; i < LCDSIM_WIDTH * LCDSIM_HEIGHT; i++)
+  {
+    hash = (hash ^ (simGram[i] & 0xFF)) * 16777619u;
+    hash = (hash ^ (simGram[i] >> 8)) * 16777619u;
+  }
+  return hash;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes the screen (in the current orientation) as a binary
+            PPM image
+
+    @return 0 on success, -1 if the file couldn't be written
+*/
+/**************************************************************************/
+int lcdSimWritePPM(const char *filename)
+{
+  FILE *f;
+  uint16_t x, y, c;
+
+  if ((f = fopen(filename, "wb")) == NULL)
+  {
+    return -1;
+  }
+  fprintf(f, "P6\n%d %d\n255\n", lcdGetWidth(), lcdGetHeight());
+  for (y = 0; y < lcdGetHeight(); y++)
+  {
+    for (x = 0; x < lcdGetWidth(); x++)
+    {
+      c = lcdSimGetPixel(x, y);
+      fputc(((c >> 11) & 0x1F) * 255 / 31, f);
+      fputc(((c >> 5) & 0x3F) * 255 / 63, f);
+      fputc((c & 0x1F) * 255 / 31, f);
+    }
+  }
+  return fclose(f) ? -1 : 0;
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ---------------------------- lcd.h API ------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+void lcdInit(void)
+{
+  lcdSimStats.calls++;
+  memset(simGram, 0, sizeof(simGram));
+  simOrientation = LCD_ORIENTATION_PORTRAIT;
+  simWindowActive = FALSE;
+  simX = simY = 0;
+}
+
+void lcdTest(void)
+{
+  uint32_t i;
+
+  lcdSimStats.calls++;
+  simReleaseWindow();
+  simSetCursor(0, 0);
+  for (i = 0; i < LCDSIM_WIDTH * LCDSIM_HEIGHT; i++)
+  {
+    simPut((i / LCDSIM_WIDTH / 40) & 1 ? 0xFFFF : 0x0000);
+  }
+  simRepeat(LCDSIM_WIDTH * LCDSIM_HEIGHT);
+}
+
+uint16_t lcdGetPixel(uint16_t x, uint16_t y)
+{
+  lcdSimStats.calls++;
+  simReleaseWindow();
+  simSetCursor(x, y);
+  simRead(2);             // Dummy read + pixel
+  lcdSimStats.pixelsRead--;
+  return *simAddress(x, y);
+}
+
+void lcdReadPixels(uint16_t x, uint16_t y, uint16_t *buf, uint32_t len)
+{
+  lcdSimStats.calls++;
+  if (!len)
+  {
+    return;
+  }
+  simReleaseWindow();
+  simSetCursor(x, y);
+  simRead(len + 1);       // Dummy read + pixels
+  lcdSimStats.pixelsRead--;
+  while (len--)
+  {
+    *buf++ = (x < lcdGetWidth()) ? *simAddress(x, y) : 0;
+    x++;
+  }
+}
+
+void lcdFillRGB(uint16_t data)
+{
+  uint32_t i;
+
+  lcdSimStats.calls++;
+  simReleaseWindow();
+  simSetCursor(0, 0);
+  for (i = 0; i < LCDSIM_WIDTH * LCDSIM_HEIGHT; i++)
+  {
+    simPut(data);
+  }
+  simRepeat(LCDSIM_WIDTH * LCDSIM_HEIGHT);
+}
+
+void lcdDrawPixel(uint16_t x, uint16_t y, uint16_t color)
+{
+  lcdSimStats.calls++;
+  simReleaseWindow();
+  simSetCursor(x, y);
+  simPut(color);
+  simData(1);
+}
+
+void lcdDrawPixels(uint16_t x, uint16_t y, uint16_t *data, uint32_t len)
+{
+  lcdSimStats.calls++;
+  simReleaseWindow();
+  simSetCursor(x, y);
+  simData(len);
+  while (len--)
+  {
+    simPut(*data++);
+  }
+}
+
+void lcdDrawHLine(uint16_t x0, uint16_t x1, uint16_t y, uint16_t color)
+{
+  uint16_t x;
+
+  lcdSimStats.calls++;
+  if (x1 < x0)
+  {
+    x = x1; x1 = x0; x0 = x;
+  }
+  if (x1 >= lcdGetWidth()) x1 = lcdGetWidth() - 1;
+  if (x0 >= lcdGetWidth()) x0 = lcdGetWidth() - 1;
+
+  simReleaseWindow();
+  simSetCursor(x0, y);
+  simRepeat(x1 - x0 + 1);
+  for (x = x0; x <= x1; x++)
+  {
+    simPut(color);
+  }
+}
+
+void lcdDrawVLine(uint16_t x, uint16_t y0, uint16_t y1, uint16_t color)
+{
+  uint16_t y;
+
+  lcdSimStats.calls++;
+  if (y1 < y0)
+  {
+    y = y1; y1 = y0; y0 = y;
+  }
+  if ((x >= lcdGetWidth()) || (y0 >= lcdGetHeight()))
+  {
+    return;
+  }
+  if (y1 >= lcdGetHeight()) y1 = lcdGetHeight() - 1;
+
+  // The driver flips the entry mode instead of setting each pixel
+  simReleaseWindow();
+  simRegister(1);
+  simSetCursor(x, y0);
+  simRepeat(y1 - y0 + 1);
+  for (y = y0; y <= y1; y++)
+  {
+    *simAddress(x, y) = color;
+    lcdSimStats.pixelsWritten++;
+  }
+}
+
+void lcdSetWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+  lcdSimStats.calls++;
+  lcdSimStats.windowSets++;
+  simRegister(4);
+  simWindowActive = TRUE;
+  simWinX0 = x0;
+  simWinY0 = y0;
+  simWinX1 = x1;
+  simWinY1 = y1;
+  simSetCursor(x0, y0);
+}
+
+void lcdStreamPixels(uint16_t *data, uint32_t len)
+{
+  lcdSimStats.calls++;
+  simData(len);
+  while (len--)
+  {
+    simPut(*data++);
+  }
+}
+
+void lcdStreamFill(uint16_t color, uint32_t len)
+{
+  lcdSimStats.calls++;
+  simRepeat(len);
+  while (len--)
+  {
+    simPut(color);
+  }
+}
+
+void lcdBacklight(bool state)
+{
+  (void)state;
+  lcdSimStats.calls++;
+}
+
+void lcdScroll(int16_t pixels, uint16_t fillColor)
+{
+  // Only moves the display start line, GRAM is left as it is
+  (void)pixels;
+  (void)fillColor;
+  lcdSimStats.calls++;
+  simRegister(1);
+}
+
+void lcdScrollRegion(uint16_t y0, uint16_t y1, int16_t pixels, uint16_t fillColor)
+{
+  uint16_t width = lcdGetWidth();
+  uint16_t y, x, height, step, lines, src, dst;
+
+  lcdSimStats.calls++;
+  if (y1 < y0)
+  {
+    y = y0; y0 = y1; y1 = y;
+  }
+  if (y1 >= lcdGetHeight())
+  {
+    y1 = lcdGetHeight() - 1;
+  }
+  if ((pixels == 0) || (y0 > y1))
+  {
+    return;
+  }
+
+  height = y1 - y0 + 1;
+  step = pixels > 0 ? pixels : -pixels;
+  if (step > height)
+  {
+    step = height;
+  }
+
+  // Same traffic as the driver: lines are read back in 32 pixel chunks
+  lines = height - step;
+  for (y = 0; y < lines; y++)
+  {
+    dst = pixels > 0 ? y0 + y : y1 - y;
+    src = pixels > 0 ? dst + step : dst - step;
+    for (x = 0; x < width; x += 32)
+    {
+      uint16_t len = width - x > 32 ? 32 : width - x;
+      lcdSimStats.cursorSets += 2;
+      simRegister(4);
+      simCommand(2);
+      simRead(len + 1);
+      lcdSimStats.pixelsRead--;
+      simData(len);
+      lcdSimStats.pixelsWritten += len;
+    }
+    for (x = 0; x < width; x++)
+    {
+      *simAddress(x, dst) = *simAddress(x, src);
+    }
+  }
+
+  lcdSimStats.windowSets++;
+  simRegister(4);
+  simRepeat((uint32_t)width * step);
+  for (y = 0; y < step; y++)
+  {
+    dst = pixels > 0 ? y1 - y : y0 + y;
+    for (x = 0; x < width; x++)
+    {
+      *simAddress(x, dst) = fillColor;
+    }
+  }
+  lcdSimStats.pixelsWritten += (uint32_t)width * step;
+  simWindowActive = FALSE;
+}
+
+bool lcdSetScrollOffset(uint16_t y0, uint16_t y1, uint16_t offset)
+{
+  // Partial image windows aren't emulated
+  (void)y0;
+  (void)y1;
+  (void)offset;
+  lcdSimStats.calls++;
+  return FALSE;
+}
+
+uint16_t lcdGetWidth(void)
+{
+  return simOrientation == LCD_ORIENTATION_PORTRAIT ? LCDSIM_WIDTH : LCDSIM_HEIGHT;
+}
+
+uint16_t lcdGetHeight(void)
+{
+  return simOrientation == LCD_ORIENTATION_PORTRAIT ? LCDSIM_HEIGHT : LCDSIM_WIDTH;
+}
+
+void lcdSetOrientation(lcdOrientation_t orientation)
+{
+  lcdSimStats.calls++;
+  simWindowActive = FALSE;
+  simRegister(2);
+  simOrientation = orientation;
+  simSetCursor(0, 0);
+}
+
+uint16_t lcdGetControllerID(void)
+{
+  return 0x9328;
+}
+
+lcdOrientation_t lcdGetOrientation(void)
+{
+  return simOrientation;
+}
+
+lcdProperties_t lcdGetProperties(void)
+{
+  return simProperties;
+}
@@ -0,0 +1,75 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Mock lcd.h backend for building drivers/lcd/tft on a PC.
+ *
+ * Every lcd.h call is applied to a 240x320 RGB565 framebuffer laid out
+ * like the ILI9328 GRAM, and the bus traffic the ILI9328 driver would
+ * generate for it is added to a set of counters.  The cycle costs are
+ * those of the 8-bit bus routines in ILI9328.c at 72MHz, so the totals
+ * are estimates, but they move in step with the real driver when a
+ * drawing routine changes.
+ */
+
+#ifndef _LCDSIM_H_
+#define _LCDSIM_H_
+
+#include <stdint.h>
+
+#define LCDSIM_WIDTH            (240)   // GRAM width (portrait)
+#define LCDSIM_HEIGHT           (320)   // GRAM height (portrait)
+
+// Approximate CPU cycles per bus operation (see ili9328WriteCmd)
+#define LCDSIM_CYCLES_CMD       (25)    // Register index write
+#define LCDSIM_CYCLES_DATA      (25)    // 16-bit data write
+#define LCDSIM_CYCLES_REPEAT    (12)    // Pixel in ili9328WriteDataRepeat
+#define LCDSIM_CYCLES_READ      (60)    // 16-bit GRAM read (two strobed bytes)
+
+typedef struct
+{
+  uint32_t calls;           // Calls into lcd.h
+  uint32_t cursorSets;      // GRAM address set (2 register writes each)
+  uint32_t windowSets;      // Window set (4 register writes each)
+  uint32_t commands;        // Register index writes
+  uint32_t dataWrites;      // 16-bit data writes, register values included
+  uint32_t pixelsWritten;   // Pixels written to GRAM
+  uint32_t pixelsRead;      // Pixels read back from GRAM
+  uint64_t busCycles;       // Estimated CPU cycles spent on the bus
+} lcdSimStats_t;
+
+extern lcdSimStats_t lcdSimStats;
+
+void     lcdSimReset(void);
+uint16_t lcdSimGetPixel(uint16_t x, uint16_t y);
+uint32_t lcdSimHash(void);
+int      lcdSimWritePPM(const char *filename);
+
+#endif
@@ -0,0 +1,365 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Renders a set of typical screens with drivers/lcd/tft on a PC (see
+ * lcdsim.c), and prints the bus traffic each one costs on an ILI9328.
+ * The framebuffer hash of every screen is compared against a golden
+ * file so that changes to the drawing code that alter the output are
+ * caught, and the cycle count is shown next to the golden one so the
+ * cost of a change is visible.
+ *
+ * syntax: lcdsim [-g <golden.txt>] [-u] [-d <dir>] [<scene> ...]
+ *
+ *   -g   Golden file to compare against (default 'golden.txt')
+ *   -u   Rewrite the golden file with the current results
+ *   -d   Write a PPM image of every scene to <dir>
+ *
+ *   Returns 1 if any scene doesn't match its golden image.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lcdsim.h"
+#include "drivers/lcd/tft/drawing.h"
+#include "drivers/lcd/tft/fonts/dejavusans9.h"
+#include "drivers/lcd/tft/fonts/dejavusansbold9.h"
+#include "drivers/lcd/tft/fonts/veramono11.h"
+#include "drivers/lcd/tft/fonts/veramonobold11rle.h"
+#include "drivers/lcd/icons16.h"
+
+#define MAXSCENES       (32)
+
+typedef struct
+{
+  const char *name;
+  void (*render)(void);
+} scene_t;
+
+typedef struct
+{
+  char     name[32];
+  uint32_t hash;
+  uint64_t cycles;
+} golden_t;
+
+static golden_t golden[MAXSCENES];
+static int goldenCount = 0;
+
+/**************************************************************************/
+/*                                                                        */
+/* ------------------------------ Scenes -------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+static void sceneFill(void)
+{
+  drawFill(COLOR_BLUE);
+}
+
+static void scenePrimitives(void)
+{
+  uint16_t i;
+
+  drawFill(COLOR_BLACK);
+  for (i = 0; i < 240; i += 24)
+  {
+    drawLine(0, 0, i, 319, COLOR_GREEN);
+    drawLine(239, 0, i, 319, COLOR_RED);
+  }
+  drawLineDotted(0, 160, 239, 160, 2, 4, COLOR_WHITE);
+  drawCircle(120, 80, 50, COLOR_YELLOW);
+  drawCircleFilled(120, 240, 40, COLOR_CYAN);
+  drawRectangle(10, 10, 100, 60, COLOR_WHITE);
+  drawRectangleFilled(140, 10, 230, 60, COLOR_MAGENTA);
+  drawRectangleRounded(20, 180, 220, 300, COLOR_GRAY_200, 10, DRAW_ROUNDEDCORNERS_ALL);
+  drawArrow(30, 120, 8, DRAW_DIRECTION_LEFT, COLOR_WHITE);
+  drawArrow(210, 120, 8, DRAW_DIRECTION_RIGHT, COLOR_WHITE);
+}
+
+static void sceneText(void)
+{
+  uint16_t y;
+
+  drawFill(COLOR_WHITE);
+  for (y = 4; y < 120; y += 16)
+  {
+    drawString(4, y, COLOR_BLACK, &dejaVuSans9ptFontInfo, "The quick brown fox jumps");
+  }
+  drawString(4, 130, COLOR_BLUE, &dejaVuSansBold9ptFontInfo, "Bold 9pt heading");
+  drawStringOpaque(4, 150, COLOR_WHITE, COLOR_GRAY_80, &bitstreamVeraSansMono11ptFontInfo, "Mono 11pt opaque");
+  drawString(4, 175, COLOR_RED, &bitstreamVeraSansMonoBold11ptRleFontInfo, "RLE 11pt 0123456789");
+  drawStringOpaque(4, 200, COLOR_BLACK, COLOR_YELLOW, &bitstreamVeraSansMonoBold11ptRleFontInfo, "RLE opaque");
+}
+
+static void sceneDialog(void)
+{
+  drawFill(COLOR_THEME_LIMEGREEN_BASE);
+  drawRectangleRounded(10, 40, 229, 280, COLOR_THEME_LIMEGREEN_DARKER, 8, DRAW_ROUNDEDCORNERS_ALL);
+  drawRectangleRounded(12, 42, 227, 278, COLOR_THEME_LIMEGREEN_LIGHTER, 8, DRAW_ROUNDEDCORNERS_ALL);
+  drawIcon16(24, 56, COLOR_BLUE, icons16_info);
+  drawString(48, 60, COLOR_BLACK, &dejaVuSansBold9ptFontInfo, "Firmware update");
+  drawString(24, 90, COLOR_BLACK, &dejaVuSans9ptFontInfo, "Copying image to flash");
+  drawProgressBar(24, 120, 192, 16, DRAW_ROUNDEDCORNERS_ALL, DRAW_ROUNDEDCORNERS_ALL,
+                  COLOR_THEME_LIMEGREEN_DARKER, COLOR_THEME_LIMEGREEN_SHADOW,
+                  COLOR_THEME_LIMEGREEN_ACCENT, COLOR_THEME_LIMEGREEN_ACCENT, 65);
+  drawButton(24, 220, 90, 40, &dejaVuSansBold9ptFontInfo, 9, COLOR_THEME_LIMEGREEN_DARKER,
+             COLOR_THEME_LIMEGREEN_BASE, COLOR_BLACK, "Cancel");
+  drawButton(126, 220, 90, 40, &dejaVuSansBold9ptFontInfo, 9, COLOR_THEME_LIMEGREEN_DARKER,
+             COLOR_THEME_LIMEGREEN_ACCENT, COLOR_BLACK, "OK");
+}
+
+static void sceneLandscape(void)
+{
+  lcdSetOrientation(LCD_ORIENTATION_LANDSCAPE);
+  drawFill(COLOR_GRAY_15);
+  drawRectangleFilled(0, 0, 319, 24, COLOR_THEME_VIOLET_DARKER);
+  drawString(6, 8, COLOR_WHITE, &dejaVuSansBold9ptFontInfo, "Landscape status bar");
+  drawLine(0, 239, 319, 30, COLOR_THEME_VIOLET_ACCENT);
+  drawCircle(160, 130, 60, COLOR_THEME_VIOLET_LIGHTER);
+}
+
+static void renderComposite(void)
+{
+  drawCircleFilled(60, 60, 30, COLOR_RED);
+  drawString(35, 56, COLOR_WHITE, &dejaVuSansBold9ptFontInfo, "Tile");
+}
+
+static void sceneTiles(void)
+{
+  drawFill(COLOR_BLACK);
+  drawComposite(30, 30, 90, 90, COLOR_GRAY_50, renderComposite);
+}
+
+static void sceneBitmap(void)
+{
+  // Round trip through bmp.c: save the screen, clear it and load it back
+  scenePrimitives();
+  if (bmpSaveScreenshot("lcdsim.bmp") != BMP_ERROR_NONE)
+  {
+    fprintf(stderr, "lcdsim: bmpSaveScreenshot failed\n");
+    return;
+  }
+  drawFill(COLOR_BLACK);
+  lcdSimReset();
+  if (drawBitmapImage(0, 0, "lcdsim.bmp") != BMP_ERROR_NONE)
+  {
+    fprintf(stderr, "lcdsim: drawBitmapImage failed\n");
+  }
+  remove("lcdsim.bmp");
+}
+
+static const scene_t scenes[] =
+{
+  { "fill",       sceneFill },
+  { "primitives", scenePrimitives },
+  { "text",       sceneText },
+  { "dialog",     sceneDialog },
+  { "landscape",  sceneLandscape },
+  { "tiles",      sceneTiles },
+  { "bitmap",     sceneBitmap }
+};
+
+#define SCENECOUNT  (int)(sizeof(scenes) / sizeof(scenes[0]))
+
+/**************************************************************************/
+/*                                                                        */
+/* --------------------------- Golden file ------------------------------ */
+/*                                                                        */
+/**************************************************************************/
+
+static void goldenLoad(const char *filename)
+{
+  FILE *f = fopen(filename, "r");
+  char line[128];
+  unsigned long long cycles;
+
+  if (!f)
+  {
+    return;
+  }
+  while (fgets(line, sizeof(line), f) && goldenCount < MAXSCENES)
+  {
+    golden_t *g = &golden[goldenCount];
+    if ((line[0] == '#') || (sscanf(line, "%31s %x %llu", g->name, &g->hash, &cycles) != 3))
+    {
+      continue;
+    }
+    g->cycles = cycles;
+    goldenCount++;
+  }
+  fclose(f);
+}
+
+static const golden_t *goldenFind(const char *name)
+{
+  int i;
+
+  for (i = 0; i < goldenCount; i++)
+  {
+    if (!strcmp(golden[i].name, name))
+    {
+      return &golden[i];
+    }
+  }
+  return NULL;
+}
+
+/**************************************************************************/
+/*                                                                        */
+/* ------------------------------- Main --------------------------------- */
+/*                                                                        */
+/**************************************************************************/
+
+static bool selected(const char *name, int argc, char **argv, int first)
+{
+  int i;
+
+  if (first >= argc)
+  {
+    return true;
+  }
+  for (i = first; i < argc; i++)
+  {
+    if (!strcmp(argv[i], name))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char **argv)
+{
+  const char *goldenFile = "golden.txt";
+  const char *dumpDir = NULL;
+  bool update = false;
+  FILE *out = NULL;
+  int i, failed = 0;
+
+  for (i = 1; i < argc && argv[i][0] == '-'; i++)
+  {
+    if (!strcmp(argv[i], "-u"))
+    {
+      update = true;
+    }
+    else if (!strcmp(argv[i], "-g") && i + 1 < argc)
+    {
+      goldenFile = argv[++i];
+    }
+    else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+    {
+      dumpDir = argv[++i];
+    }
+    else
+    {
+      fprintf(stderr, "syntax: lcdsim [-g <golden.txt>] [-u] [-d <dir>] [<scene> ...]\n");
+      return 2;
+    }
+  }
+
+  goldenLoad(goldenFile);
+  if (update && ((out = fopen(goldenFile, "w")) == NULL))
+  {
+    perror(goldenFile);
+    return 2;
+  }
+  if (out)
+  {
+    fprintf(out, "# scene hash cycles (written by 'lcdsim -u')\n");
+  }
+
+  printf("%-11s %7s %7s %6s %8s %8s %8s %10s %8s  %s\n", "scene", "calls", "cursor", "window",
+         "commands", "data", "pixels", "cycles", "golden", "image");
+
+  for (int s = 0; s < SCENECOUNT; s++)
+  {
+    const golden_t *g;
+    uint32_t hash;
+    const char *status;
+    char delta[16] = "-";
+
+    if (!selected(scenes[s].name, argc, argv, i))
+    {
+      continue;
+    }
+
+    lcdInit();
+    lcdSimReset();
+    scenes[s].render();
+    hash = lcdSimHash();
+
+    g = goldenFind(scenes[s].name);
+    if (!g)
+    {
+      status = "new";
+    }
+    else
+    {
+      status = g->hash == hash ? "ok" : "CHANGED";
+      if (g->cycles)
+      {
+        snprintf(delta, sizeof(delta), "%+.1f%%",
+                 100.0 * ((double)lcdSimStats.busCycles - (double)g->cycles) / (double)g->cycles);
+      }
+      if (g->hash != hash && !update)
+      {
+        failed = 1;
+      }
+    }
+
+    printf("%-11s %7u %7u %6u %8u %8u %8u %10llu %8s  %08x %s\n", scenes[s].name,
+           lcdSimStats.calls, lcdSimStats.cursorSets, lcdSimStats.windowSets,
+           lcdSimStats.commands, lcdSimStats.dataWrites, lcdSimStats.pixelsWritten,
+           (unsigned long long)lcdSimStats.busCycles, delta, hash, status);
+
+    if (out)
+    {
+      fprintf(out, "%s %08x %llu\n", scenes[s].name, hash, (unsigned long long)lcdSimStats.busCycles);
+    }
+    if (dumpDir)
+    {
+      char path[256];
+      snprintf(path, sizeof(path), "%s/%s.ppm", dumpDir, scenes[s].name);
+      if (lcdSimWritePPM(path))
+      {
+        perror(path);
+      }
+    }
+  }
+
+  if (out)
+  {
+    fclose(out);
+  }
+  return failed;
+}
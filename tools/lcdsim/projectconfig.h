@@ -0,0 +1,68 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Host replacement for the firmware's projectconfig.h, used to build
+ * drivers/lcd/tft on a PC for lcdsim.  Only the options that affect
+ * drawing.c, bmp.c, img565.c and jpeg.c are set here, and the ARM specific
+ * attributes from sysdefs.h are defined away.
+ */
+
+#ifndef _PROJECTCONFIG_H_
+#define _PROJECTCONFIG_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BOOL bool
+#define TRUE true
+#define FALSE false
+
+#define HOTFUNC
+#define RAMFUNC
+#define NOINIT
+
+#define CFG_CPU_CCLK                    (72000000)
+
+#define CFG_TFTLCD
+#define CFG_TFTLCD_INCLUDESMALLFONTS    (0)
+#define CFG_TFTLCD_INLINE               (0)
+#define CFG_TFTLCD_JPEG                 (1)
+#define CFG_TFTLCD_TILEBUFFER           (1024)
+#define CFG_TFTLCD_WIDGETS              (0)
+#define CFG_TFTLCD_FONTCACHE            (0)
+
+// bmp.c, img565.c and jpeg.c read and write files through fatfs_host.c
+#define CFG_SDCARD
+#define CFG_SDCARD_READONLY             (0)
+#define CFG_SDCARD_DIRCACHE             (0)
+
+#endif
@@ -0,0 +1,362 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Host viewer for the remote display stream of drivers/lcd/tft/lcdremote.c
+ * (CFG_TFTLCD_REMOTE), read from the USB vendor bulk endpoint with
+ * libusb-1.0.
+ *
+ * syntax: lcdview [-d <vid>:<pid>] [-r <capture>] <output.ppm>
+ *         lcdview -f <capture> <output.ppm>
+ *
+ *   The device's screen is kept in memory and written to <output.ppm>
+ *   whenever the stream goes quiet after an update (the file is
+ *   replaced atomically, so any image viewer that reloads files on
+ *   change can be used as the display).  Start the stream with 'v 1'
+ *   on the device CLI; the viewer asks for a full refresh when it
+ *   connects.
+ *
+ *   -d <vid>:<pid>  USB IDs in hex (default 239a:1002, CFG_USB_VID/PID)
+ *   -r <capture>    Also saves the raw stream to <capture>
+ *   -f <capture>    Decodes a saved stream instead of reading from USB
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <libusb-1.0/libusb.h>
+
+#define VENDOR_IF       2           // USB_VENDOR_IF_NUM in usbcfg.h
+#define VENDOR_EP_IN    0x82
+#define VENDOR_EP_OUT   0x02
+#define IDLE_MS         100         // Quiet time before the image is saved
+
+#define MSG_SCREEN      0x01        // See lcdremote.h
+#define MSG_PIXELS      0x02
+#define RLE_REPEAT      0x80
+
+#define MAXWIDTH        320
+#define MAXHEIGHT       320
+
+static uint16_t screen[MAXWIDTH * MAXHEIGHT];
+static int width = 0, height = 0;   // 0 until a SCREEN message is seen
+static int changed = 0;
+static unsigned long pixelCount = 0, byteCount = 0;
+
+static uint16_t get16(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+/* Sets the next pixel of a PIXELS message and moves along the rectangle */
+static void putPixel(int left, int w, int *x, int *y, uint16_t color)
+{
+  if ((*x < width) && (*y < height))
+    screen[*y * width + *x] = color;
+  if (++*x >= left + w)
+  {
+    *x = left;
+    ++*y;
+  }
+}
+
+/*
+ * Decodes one message from the start of 'data'.  Returns the number of
+ * bytes used, 0 if the message is incomplete, or -1 if it is invalid.
+ */
+static int decode(const uint8_t *data, int len)
+{
+  int left, w, x, y, count, n, pos, i, k;
+
+  if (data[0] == MSG_SCREEN)
+  {
+    if (len < 8)
+      return 0;
+    if (memcmp(&data[1], "LCD", 3))
+      return -1;
+    w = get16(&data[4]);
+    n = get16(&data[6]);
+    if ((w == 0) || (n == 0) || (w > MAXWIDTH) || (n > MAXHEIGHT))
+      return -1;
+    width = w;
+    height = n;
+    memset(screen, 0, sizeof(screen));
+    printf("Screen %dx%d\n", width, height);
+    return 8;
+  }
+
+  if ((data[0] != MSG_PIXELS) || !width)
+    return -1;
+  if (len < 11)
+    return 0;
+
+  left = get16(&data[1]);
+  w = get16(&data[3]);
+  x = get16(&data[5]);
+  y = get16(&data[7]);
+  count = get16(&data[9]);
+  if ((w == 0) || (left + w > width) || (x < left) || (x >= left + w) || (y >= height))
+    return -1;
+
+  // Check that the whole message is there before drawing it
+  pos = 11;
+  for (i = 0; i < count; i += n)
+  {
+    if (pos >= len)
+      return 0;
+    n = (data[pos] & ~RLE_REPEAT) + 1;
+    pos += 1 + ((data[pos] & RLE_REPEAT) ? 2 : n * 2);
+    if (i + n > count)
+      return -1;
+  }
+  if (pos > len)
+    return 0;
+
+  pos = 11;
+  for (i = 0; i < count; i += n)
+  {
+    n = (data[pos] & ~RLE_REPEAT) + 1;
+    if (data[pos++] & RLE_REPEAT)
+    {
+      for (k = 0; k < n; k++)
+        putPixel(left, w, &x, &y, get16(&data[pos]));
+      pos += 2;
+    }
+    else
+    {
+      for (k = 0; k < n; k++, pos += 2)
+        putPixel(left, w, &x, &y, get16(&data[pos]));
+    }
+  }
+
+  pixelCount += count;
+  changed = 1;
+  return pos;
+}
+
+/*
+ * Decodes as many messages as possible from 'data' and returns the
+ * number of bytes used.  Until a SCREEN message is found everything is
+ * skipped, which resynchronises a viewer started in the middle of a
+ * stream.
+ */
+static int decodeAll(const uint8_t *data, int len)
+{
+  int pos = 0, used;
+
+  while (pos < len)
+  {
+    if (!width && ((len - pos < 4) || (data[pos] != MSG_SCREEN) || memcmp(&data[pos + 1], "LCD", 3)))
+    {
+      if (len - pos < 4)
+        break;
+      pos++;
+      continue;
+    }
+    used = decode(&data[pos], len - pos);
+    if (used == 0)
+      break;
+    if (used < 0)
+    {
+      fprintf(stderr, "Invalid message, waiting for the next screen\n");
+      width = 0;
+      pos++;
+      continue;
+    }
+    pos += used;
+  }
+  return pos;
+}
+
+/* Writes the screen as a binary PPM, through a temporary file */
+static int savePPM(const char *filename)
+{
+  char tmp[1024];
+  FILE *f;
+  int i;
+
+  snprintf(tmp, sizeof(tmp), "%s.tmp", filename);
+  f = fopen(tmp, "wb");
+  if (!f)
+  {
+    perror(tmp);
+    return -1;
+  }
+  fprintf(f, "P6\n%d %d\n255\n", width, height);
+  for (i = 0; i < width * height; i++)
+  {
+    uint16_t c = screen[i];
+    fputc(((c >> 11) & 0x1F) * 255 / 31, f);
+    fputc(((c >> 5) & 0x3F) * 255 / 63, f);
+    fputc((c & 0x1F) * 255 / 31, f);
+  }
+  fclose(f);
+  if (rename(tmp, filename))
+  {
+    perror(filename);
+    return -1;
+  }
+  changed = 0;
+  return 0;
+}
+
+static void usage(void)
+{
+  fprintf(stderr, "syntax: lcdview [-d <vid>:<pid>] [-r <capture>] <output.ppm>\n");
+  fprintf(stderr, "        lcdview -f <capture> <output.ppm>\n");
+  exit(1);
+}
+
+/* Decodes a saved stream */
+static int replay(const char *capture, const char *output)
+{
+  static uint8_t data[1 << 20];
+  FILE *f;
+  int len;
+
+  f = fopen(capture, "rb");
+  if (!f)
+  {
+    perror(capture);
+    return 1;
+  }
+  len = fread(data, 1, sizeof(data), f);
+  fclose(f);
+
+  byteCount = len;
+  decodeAll(data, len);
+  if (!width)
+  {
+    fprintf(stderr, "No screen found in %s\n", capture);
+    return 1;
+  }
+  printf("%lu bytes, %lu pixels\n", byteCount, pixelCount);
+  return savePPM(output) ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+  static uint8_t data[4096 + 512];
+  unsigned int vid = 0x239A, pid = 0x1002;
+  const char *capture = NULL, *replayFile = NULL, *output;
+  libusb_device_handle *dev;
+  FILE *raw = NULL;
+  int i, r, got, len = 0, used;
+  uint8_t request = 0;
+
+  for (i = 1; i < argc - 1; i++)
+  {
+    if (!strcmp(argv[i], "-d") && (i + 2 < argc))
+    {
+      if (sscanf(argv[++i], "%x:%x", &vid, &pid) != 2)
+        usage();
+    }
+    else if (!strcmp(argv[i], "-r") && (i + 2 < argc))
+      capture = argv[++i];
+    else if (!strcmp(argv[i], "-f") && (i + 2 < argc))
+      replayFile = argv[++i];
+    else
+      usage();
+  }
+  if (i != argc - 1)
+    usage();
+  output = argv[i];
+
+  if (replayFile)
+    return replay(replayFile, output);
+
+  if (libusb_init(NULL))
+  {
+    fprintf(stderr, "libusb_init failed\n");
+    return 1;
+  }
+  dev = libusb_open_device_with_vid_pid(NULL, vid, pid);
+  if (!dev)
+  {
+    fprintf(stderr, "No device %04x:%04x found\n", vid, pid);
+    return 1;
+  }
+  r = libusb_claim_interface(dev, VENDOR_IF);
+  if (r)
+  {
+    fprintf(stderr, "Can't claim interface %d: %s\n", VENDOR_IF, libusb_error_name(r));
+    return 1;
+  }
+  if (capture)
+  {
+    raw = fopen(capture, "wb");
+    if (!raw)
+    {
+      perror(capture);
+      return 1;
+    }
+  }
+
+  // Any data on the OUT endpoint asks for the whole screen
+  libusb_bulk_transfer(dev, VENDOR_EP_OUT, &request, 1, &got, 1000);
+
+  while (1)
+  {
+    r = libusb_bulk_transfer(dev, VENDOR_EP_IN, &data[len], 4096, &got, IDLE_MS);
+    if ((r == LIBUSB_ERROR_TIMEOUT) && !got)
+    {
+      if (changed && width)
+      {
+        savePPM(output);
+        printf("%lu bytes, %lu pixels\n", byteCount, pixelCount);
+      }
+      continue;
+    }
+    if (r && (r != LIBUSB_ERROR_TIMEOUT))
+    {
+      fprintf(stderr, "Read failed: %s\n", libusb_error_name(r));
+      break;
+    }
+
+    if (raw)
+      fwrite(&data[len], 1, got, raw);
+    byteCount += got;
+    len += got;
+    used = decodeAll(data, len);
+    memmove(data, &data[used], len - used);
+    len -= used;
+    if (len > 512)
+      len = 0;                      // Can't be a valid message
+  }
+
+  if (raw)
+    fclose(raw);
+  libusb_release_interface(dev, VENDOR_IF);
+  libusb_close(dev);
+  libusb_exit(NULL);
+  return 1;
+}
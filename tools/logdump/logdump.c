@@ -0,0 +1,205 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Unpacks and prints log files written by drivers/fatfs/datalog.c
+ * (CFG_SDCARD_DATALOG).
+ *
+ * syntax: logdump [-z] [-a | -d] <logfile>
+ *
+ *   Without -a or -d, one line is printed per sector: its sequence
+ *   number, the payload bytes used and the records lost before it.
+ *
+ *   -z  The file was written with CFG_SDCARD_DATALOG_LZ
+ *   -a  Prints the samples logged by dataLogStartADC(.., false), one
+ *       per line
+ *   -d  Prints the samples logged by dataLogStartADC(.., true)
+ *
+ *   Lost records show up as '# <n> records lost' lines between the
+ *   samples.  A summary goes to stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "drivers/fatfs/datalog.h"
+#include "core/compress/lz.h"
+#include "core/compress/varint.h"
+
+static FILE *in;
+static int packed = 0;
+static uint8_t chunk[LOGSTREAM_BLOCKSIZE];
+
+static unsigned long sectors = 0, lost = 0, gaps = 0, samples = 0;
+
+/* Reads the next 512 byte sector of records, unpacking it if need be */
+static int readSector(uint8_t *sector)
+{
+  int c0, c1;
+  unsigned len;
+
+  if (!packed)
+  {
+    return fread(sector, 1, LOGSTREAM_BLOCKSIZE, in) == LOGSTREAM_BLOCKSIZE;
+  }
+
+  c0 = fgetc(in);
+  c1 = fgetc(in);
+  if ((c0 == EOF) || (c1 == EOF))
+  {
+    return 0;
+  }
+  len = c0 | (c1 << 8);
+  if (len == 0)
+  {
+    /* End of the data */
+    return 0;
+  }
+
+  if (len & DATALOG_LZSTORED)
+  {
+    len &= ~DATALOG_LZSTORED;
+    return (len == LOGSTREAM_BLOCKSIZE) && (fread(sector, 1, len, in) == len);
+  }
+
+  if ((len > sizeof(chunk)) || (fread(chunk, 1, len, in) != len) ||
+      (lzDecompress(chunk, len, sector, LOGSTREAM_BLOCKSIZE) != LOGSTREAM_BLOCKSIZE))
+  {
+    fprintf(stderr, "Corrupt chunk after sector %lu\n", sectors);
+    return 0;
+  }
+
+  return 1;
+}
+
+static void usage(void)
+{
+  fprintf(stderr, "syntax: logdump [-z] [-a | -d] <logfile>\n");
+  exit(1);
+}
+
+int main(int argc, char **argv)
+{
+  uint8_t sector[LOGSTREAM_BLOCKSIZE];
+  const dataLogHeader_t *hdr = (const dataLogHeader_t *)sector;
+  const uint8_t *payload = sector + DATALOG_HEADERSIZE;
+  uint16_t block[DATALOG_ADCCHUNK];
+  uint32_t next = 0;
+  unsigned pos, n, i;
+  int mode = 0, arg;
+
+  for (arg = 1; (arg < argc) && (argv[arg][0] == '-'); arg++)
+  {
+    if (!strcmp(argv[arg], "-z"))
+      packed = 1;
+    else if (!strcmp(argv[arg], "-a") || !strcmp(argv[arg], "-d"))
+      mode = argv[arg][1];
+    else
+      usage();
+  }
+  if (arg != argc - 1)
+  {
+    usage();
+  }
+
+  in = fopen(argv[arg], "rb");
+  if (!in)
+  {
+    perror(argv[arg]);
+    return 1;
+  }
+
+  while (readSector(sector))
+  {
+    if ((hdr->sequence != next) && sectors)
+    {
+      /* Sectors the card didn't take (file full or write error) */
+      gaps++;
+    }
+    next = hdr->sequence + 1;
+    lost += hdr->lost;
+    sectors++;
+
+    if (hdr->length > DATALOG_PAYLOADSIZE)
+    {
+      fprintf(stderr, "Sector %u: bad length %u\n", hdr->sequence, hdr->length);
+      continue;
+    }
+
+    if (!mode)
+    {
+      printf("%8u %4u %5u\n", hdr->sequence, hdr->length, hdr->lost);
+      continue;
+    }
+
+    if (hdr->lost)
+    {
+      printf("# %u records lost\n", hdr->lost);
+    }
+
+    if (mode == 'a')
+    {
+      for (pos = 0; pos + 1 < hdr->length; pos += 2)
+      {
+        printf("%u\n", payload[pos] | (payload[pos + 1] << 8));
+        samples++;
+      }
+      continue;
+    }
+
+    for (pos = 0; pos < hdr->length; pos += n)
+    {
+      n = varintDeltaDecode16(payload + pos, hdr->length - pos, block, DATALOG_ADCCHUNK);
+      if (n == 0)
+      {
+        fprintf(stderr, "Sector %u: truncated record\n", hdr->sequence);
+        break;
+      }
+      for (i = 0; i < DATALOG_ADCCHUNK; i++)
+      {
+        printf("%u\n", block[i]);
+      }
+      samples += DATALOG_ADCCHUNK;
+    }
+  }
+
+  fclose(in);
+
+  fprintf(stderr, "%lu sectors, %lu records lost, %lu gaps in the sequence", sectors, lost, gaps);
+  if (mode)
+  {
+    fprintf(stderr, ", %lu samples", samples);
+  }
+  fprintf(stderr, "\n");
+
+  return 0;
+}
@@ -0,0 +1,371 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Host side of the logic analyser in core/logic/logic.c (CFG_LOGIC):
+ * arms a capture over the USB vendor bulk endpoint with libusb-1.0,
+ * waits for it and writes it as a VCD file for GTKWave or similar.
+ *
+ * syntax: logicdump [-d <vid>:<pid>] [-p <port>] [-m <mask>]
+ *                   [-s <rate>] [-t <mask>:<value>] [-n <samples>]
+ *                   [-b <before>] [-w <seconds>] [-r <capture>]
+ *                   <output.vcd>
+ *         logicdump -f <capture> <output.vcd>
+ *
+ *   -d <vid>:<pid>      USB IDs in hex (default 239a:1002)
+ *   -p <port>           GPIO port to sample (default 2)
+ *   -m <mask>           Pins to sample, in hex (default fff)
+ *   -s <rate>           Samples per second (default 100000)
+ *   -t <mask>:<value>   Trigger when the pins in <mask> read <value>
+ *                       (both in hex, default: straight away)
+ *   -n <samples>        Capture length (default: the whole buffer)
+ *   -b <before>         Samples before the trigger (default 0)
+ *   -w <seconds>        How long to wait for the trigger (default 10)
+ *   -r <capture>        Also saves the raw stream to <capture>
+ *   -f <capture>        Decodes a saved stream instead of reading USB
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <libusb-1.0/libusb.h>
+
+#define VENDOR_IF       2           // USB_VENDOR_IF_NUM in usbcfg.h
+#define VENDOR_EP_IN    0x82
+#define VENDOR_EP_OUT   0x02
+
+#define REQUESTSIZE     16          // See logic.h
+#define HEADERSIZE      14
+#define FLAG_TRIGGERED  0x01
+#define MAXSAMPLES      65535
+
+static uint16_t samples[MAXSAMPLES];
+
+typedef struct
+{
+  int port;
+  unsigned int mask;
+  unsigned long rate;
+  int count;
+  int trigger;
+  int triggered;
+} capture_t;
+
+static uint16_t get16(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+static void put16(uint8_t *p, unsigned int value)
+{
+  p[0] = value & 0xFF;
+  p[1] = (value >> 8) & 0xFF;
+}
+
+/* Reads a varint, returns the number of bytes used or 0 if incomplete */
+static int getVarint(const uint8_t *p, int len, unsigned long *value)
+{
+  int i;
+
+  *value = 0;
+  for (i = 0; (i < len) && (i < 5); i++)
+  {
+    *value |= (unsigned long)(p[i] & 0x7F) << (7 * i);
+    if (!(p[i] & 0x80))
+      return i + 1;
+  }
+  return 0;
+}
+
+/*
+ * Decodes a stream (header and RLE records).  Returns the number of
+ * samples decoded so far, or -1 if the stream is invalid.
+ */
+static int decode(const uint8_t *data, int len, capture_t *cap)
+{
+  unsigned long run, k;
+  int pos, n, got = 0;
+  uint16_t value;
+
+  if (len < HEADERSIZE)
+    return 0;
+  if ((data[0] != 'L') || (data[1] != 'A'))
+    return -1;
+  cap->port = data[2];
+  cap->triggered = data[3] & FLAG_TRIGGERED;
+  cap->mask = get16(&data[4]);
+  cap->rate = get16(&data[6]) | ((unsigned long)get16(&data[8]) << 16);
+  cap->count = get16(&data[10]);
+  cap->trigger = get16(&data[12]);
+  if (!cap->rate)
+    return -1;
+
+  pos = HEADERSIZE;
+  while ((got < cap->count) && (pos + 2 < len))
+  {
+    value = get16(&data[pos]);
+    n = getVarint(&data[pos + 2], len - pos - 2, &run);
+    if (!n)
+      break;
+    if (got + run + 1 > (unsigned long)cap->count)
+      return -1;
+    for (k = 0; k <= run; k++)
+      samples[got++] = value;
+    pos += 2 + n;
+  }
+  return got;
+}
+
+/* Writes the capture as a VCD file, one wire per sampled pin */
+static int saveVCD(const char *filename, const capture_t *cap)
+{
+  FILE *f;
+  int i, pin;
+  uint16_t last = 0;
+  unsigned long long t;
+
+  f = fopen(filename, "w");
+  if (!f)
+  {
+    perror(filename);
+    return -1;
+  }
+  fprintf(f, "$comment %d samples of port %d at %lu Hz", cap->count, cap->port, cap->rate);
+  if (cap->triggered)
+    fprintf(f, ", triggered at sample %d", cap->trigger);
+  fprintf(f, " $end\n$timescale 1ns $end\n$scope module port%d $end\n", cap->port);
+  for (pin = 0; pin < 16; pin++)
+    if (cap->mask & (1 << pin))
+      fprintf(f, "$var wire 1 %c P%d_%d $end\n", '!' + pin, cap->port, pin);
+  fprintf(f, "$upscope $end\n$enddefinitions $end\n");
+
+  for (i = 0; i < cap->count; i++)
+  {
+    if (i && (samples[i] == last))
+      continue;
+    t = (unsigned long long)i * 1000000000ULL / cap->rate;
+    fprintf(f, "#%llu\n", t);
+    for (pin = 0; pin < 16; pin++)
+      if ((cap->mask & (1 << pin)) && (!i || ((samples[i] ^ last) & (1 << pin))))
+        fprintf(f, "%d%c\n", (samples[i] >> pin) & 1, '!' + pin);
+    last = samples[i];
+  }
+  fprintf(f, "#%llu\n", (unsigned long long)cap->count * 1000000000ULL / cap->rate);
+  fclose(f);
+  return 0;
+}
+
+static void summary(const capture_t *cap, int len)
+{
+  printf("%d samples at %lu Hz in %d bytes", cap->count, cap->rate, len);
+  if (cap->triggered)
+    printf(", triggered at sample %d", cap->trigger);
+  printf("\n");
+}
+
+static void usage(void)
+{
+  fprintf(stderr, "syntax: logicdump [-d <vid>:<pid>] [-p <port>] [-m <mask>]\n");
+  fprintf(stderr, "                  [-s <rate>] [-t <mask>:<value>] [-n <samples>]\n");
+  fprintf(stderr, "                  [-b <before>] [-w <seconds>] [-r <capture>]\n");
+  fprintf(stderr, "                  <output.vcd>\n");
+  fprintf(stderr, "        logicdump -f <capture> <output.vcd>\n");
+  exit(1);
+}
+
+/* Decodes a saved stream */
+static int replay(const char *capture, const char *output)
+{
+  static uint8_t data[1 << 20];
+  capture_t cap;
+  FILE *f;
+  int len;
+
+  f = fopen(capture, "rb");
+  if (!f)
+  {
+    perror(capture);
+    return 1;
+  }
+  len = fread(data, 1, sizeof(data), f);
+  fclose(f);
+
+  if ((decode(data, len, &cap) != cap.count) || (len < HEADERSIZE))
+  {
+    fprintf(stderr, "%s doesn't hold a complete capture\n", capture);
+    return 1;
+  }
+  summary(&cap, len);
+  return saveVCD(output, &cap) ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+  static uint8_t data[1 << 20];
+  unsigned int vid = 0x239A, pid = 0x1002;
+  unsigned int port = 2, mask = 0xFFF, trigMask = 0, trigValue = 0;
+  unsigned int count = 0, before = 0, wait = 10;
+  unsigned long rate = 100000;
+  const char *capture = NULL, *replayFile = NULL, *output;
+  uint8_t request[REQUESTSIZE];
+  libusb_device_handle *dev;
+  capture_t cap;
+  FILE *raw;
+  int i, r, got, len = 0, decoded = 0, waited = 0;
+
+  for (i = 1; i < argc - 1; i++)
+  {
+    if (!strcmp(argv[i], "-d"))
+    {
+      if (sscanf(argv[++i], "%x:%x", &vid, &pid) != 2)
+        usage();
+    }
+    else if (!strcmp(argv[i], "-p"))
+      port = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-m"))
+      mask = strtoul(argv[++i], NULL, 16);
+    else if (!strcmp(argv[i], "-s"))
+      rate = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "-t"))
+    {
+      if (sscanf(argv[++i], "%x:%x", &trigMask, &trigValue) != 2)
+        usage();
+    }
+    else if (!strcmp(argv[i], "-n"))
+      count = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-b"))
+      before = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-w"))
+      wait = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-r"))
+      capture = argv[++i];
+    else if (!strcmp(argv[i], "-f"))
+      replayFile = argv[++i];
+    else
+      usage();
+  }
+  if (i != argc - 1)
+    usage();
+  output = argv[i];
+
+  if (replayFile)
+    return replay(replayFile, output);
+
+  if (libusb_init(NULL))
+  {
+    fprintf(stderr, "libusb_init failed\n");
+    return 1;
+  }
+  dev = libusb_open_device_with_vid_pid(NULL, vid, pid);
+  if (!dev)
+  {
+    fprintf(stderr, "No device %04x:%04x found\n", vid, pid);
+    return 1;
+  }
+  r = libusb_claim_interface(dev, VENDOR_IF);
+  if (r)
+  {
+    fprintf(stderr, "Can't claim interface %d: %s\n", VENDOR_IF, libusb_error_name(r));
+    return 1;
+  }
+
+  // Drop anything left over from an earlier capture
+  while (!libusb_bulk_transfer(dev, VENDOR_EP_IN, data, 4096, &got, 50) && got);
+
+  request[0] = 'L';
+  request[1] = port;
+  put16(&request[2], mask);
+  put16(&request[4], rate & 0xFFFF);
+  put16(&request[6], rate >> 16);
+  put16(&request[8], trigMask);
+  put16(&request[10], trigValue);
+  put16(&request[12], count);
+  put16(&request[14], before);
+  r = libusb_bulk_transfer(dev, VENDOR_EP_OUT, request, REQUESTSIZE, &got, 1000);
+  if (r)
+  {
+    fprintf(stderr, "Request failed: %s\n", libusb_error_name(r));
+    return 1;
+  }
+
+  while (1)
+  {
+    r = libusb_bulk_transfer(dev, VENDOR_EP_IN, &data[len], 4096, &got, 1000);
+    if ((r == LIBUSB_ERROR_TIMEOUT) && !got)
+    {
+      if (++waited >= (int)wait)
+      {
+        fprintf(stderr, "No capture after %u seconds\n", wait);
+        return 1;
+      }
+      continue;
+    }
+    if (r && (r != LIBUSB_ERROR_TIMEOUT))
+    {
+      fprintf(stderr, "Read failed: %s\n", libusb_error_name(r));
+      return 1;
+    }
+    len += got;
+    decoded = decode(data, len, &cap);
+    if (decoded < 0)
+    {
+      fprintf(stderr, "Invalid capture stream\n");
+      return 1;
+    }
+    if ((len >= HEADERSIZE) && (decoded == cap.count))
+      break;
+    if (len > (int)sizeof(data) - 4096)
+    {
+      fprintf(stderr, "Capture too large\n");
+      return 1;
+    }
+  }
+
+  libusb_release_interface(dev, VENDOR_IF);
+  libusb_close(dev);
+  libusb_exit(NULL);
+
+  if (capture)
+  {
+    raw = fopen(capture, "wb");
+    if (!raw)
+    {
+      perror(capture);
+      return 1;
+    }
+    fwrite(data, 1, len, raw);
+    fclose(raw);
+  }
+
+  summary(&cap, len);
+  return saveVCD(output, &cap) ? 1 : 0;
+}
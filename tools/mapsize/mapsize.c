@@ -0,0 +1,461 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Per-module and per-function flash/RAM usage from the linker map file
+ * (firmware.map, written by 'make' with -Wl,-Map).
+ *
+ * syntax: mapsize [-n <count>] [-o "<objs>"] [-b <baseline>] [-w <baseline>]
+ *                 [-g <bytes>] <firmware.map>
+ *
+ *   Prints one line per object file with the bytes it uses in each
+ *   section, followed by the '-n' (default 20) largest functions and
+ *   variables.  Flash is .text/.rodata plus the initial values of
+ *   .data and the RAM functions (.ramfunc, see RAMFUNC in sysdefs.h),
+ *   RAM is .data/.ramfunc/.noinit/.bss.
+ *
+ *   -o  Object files compiled for speed (HOT_OBJS in the Makefile),
+ *       marked with '*' so the cost of -O2 is easy to see
+ *   -b  Compares every module and the totals against a baseline and
+ *       flags the ones that grew by more than '-g' bytes (default 0)
+ *   -w  Writes the sizes to a baseline file for later comparisons
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAXMODULES  (256)
+#define MAXSYMBOLS  (2048)
+#define MAXNAME     (64)
+
+enum { SEC_TEXT = 0, SEC_RODATA, SEC_DATA, SEC_RAMFUNC, SEC_NOINIT, SEC_BSS, SEC_COUNT };
+
+static const char *secNames[SEC_COUNT] = { "text", "rodata", "data", "ramfunc", "noinit", "bss" };
+
+typedef struct
+{
+  char name[MAXNAME];
+  unsigned long size[SEC_COUNT];
+  long baseFlash, baseRam;      // -1 = not in the baseline
+  int hot;
+} module_t;
+
+typedef struct
+{
+  char name[MAXNAME];
+  char moduleName[MAXNAME];
+  int sec;
+  unsigned long size;
+} symbol_t;
+
+static module_t modules[MAXMODULES];
+static symbol_t symbols[MAXSYMBOLS];
+static int moduleCount = 0;
+static int symbolCount = 0;
+
+static void usage(void)
+{
+  fprintf(stderr, "syntax: mapsize [-n <count>] [-o \"<objs>\"] [-b <baseline>] [-w <baseline>]\n");
+  fprintf(stderr, "                [-g <bytes>] <firmware.map>\n");
+  exit(1);
+}
+
+static unsigned long flashSize(const unsigned long *s)
+{
+  return s[SEC_TEXT] + s[SEC_RODATA] + s[SEC_DATA] + s[SEC_RAMFUNC];
+}
+
+static unsigned long ramSize(const unsigned long *s)
+{
+  return s[SEC_DATA] + s[SEC_RAMFUNC] + s[SEC_NOINIT] + s[SEC_BSS];
+}
+
+/*
+ * Returns the module for an object file, without its path, adding it
+ * if needed ("libm.a(lib_a-sqrt.o)" is kept as one module per member)
+ */
+static int findModule(const char *path)
+{
+  const char *name = path, *p;
+  int i;
+
+  // Strip the folders, but not from inside the archive member name
+  for (p = path; *p && *p != '('; p++)
+  {
+    if (*p == '/' || *p == '\\')
+      name = p + 1;
+  }
+
+  for (i = 0; i < moduleCount; i++)
+  {
+    if (!strcmp(modules[i].name, name))
+      return i;
+  }
+  if (moduleCount == MAXMODULES)
+    return -1;
+
+  memset(&modules[moduleCount], 0, sizeof(module_t));
+  snprintf(modules[moduleCount].name, MAXNAME, "%s", name);
+  modules[moduleCount].baseFlash = modules[moduleCount].baseRam = -1;
+  return moduleCount++;
+}
+
+/*
+ * Maps an input section to one of the SEC_ classes, based on the output
+ * section it was placed in (see lpc1xxx/linkscript.ld)
+ */
+static int classify(const char *output, const char *input)
+{
+  if (!strcmp(output, ".text") || !strncmp(output, ".ARM.ex", 7))
+    return strncmp(input, ".rodata", 7) ? SEC_TEXT : SEC_RODATA;
+  if (!strcmp(output, ".data"))
+    return strncmp(input, ".ramfunc", 8) ? SEC_DATA : SEC_RAMFUNC;
+  if (!strcmp(output, ".noinit"))
+    return SEC_NOINIT;
+  if (!strcmp(output, ".bss"))
+    return SEC_BSS;
+  return -1;
+}
+
+static void addSection(const char *output, const char *input, unsigned long size, const char *file)
+{
+  const char *dot;
+  int sec, m;
+
+  sec = classify(output, input);
+  if (sec < 0 || size == 0)
+    return;
+  m = findModule(file);
+  if (m < 0)
+    return;
+  modules[m].size[sec] += size;
+
+  // -ffunction-sections/-fdata-sections give each function and variable
+  // its own section, named after it (.text.<name>, .bss.<name>, ...)
+  dot = strchr(input + 1, '.');
+  if (dot && dot[1] && symbolCount < MAXSYMBOLS && strncmp(input, ".rodata.str", 11) && strncmp(input, ".ARM", 4))
+  {
+    snprintf(symbols[symbolCount].name, MAXNAME, "%s", dot + 1);
+    snprintf(symbols[symbolCount].moduleName, MAXNAME, "%s", modules[m].name);
+    symbols[symbolCount].sec = sec;
+    symbols[symbolCount].size = size;
+    symbolCount++;
+  }
+}
+
+static int readMap(const char *path)
+{
+  char line[512], output[MAXNAME] = "", input[MAXNAME] = "", file[256];
+  unsigned long addr, size;
+  int inMap = 0;
+  FILE *in;
+
+  in = fopen(path, "r");
+  if (!in)
+  {
+    perror(path);
+    return 0;
+  }
+
+  while (fgets(line, sizeof(line), in))
+  {
+    line[strcspn(line, "\r\n")] = 0;
+    if (!inMap)
+    {
+      // The discarded sections and memory regions come first
+      inMap = !strncmp(line, "Linker script and memory map", 28);
+      continue;
+    }
+
+    if (line[0] == '.' || line[0] == '/')
+    {
+      // Output section: ".text  0x00000000  0x1234" (the address and
+      // size are on the next line if the name is long)
+      sscanf(line, "%63s", output);
+      input[0] = 0;
+    }
+    else if (line[0] == ' ' && (line[1] == '.' || !strncmp(line + 1, "COMMON", 6)))
+    {
+      // Input section: " .text.main  0x000000c8  0x40 main.o", also
+      // split over two lines if the section name is long
+      file[0] = 0;
+      if (sscanf(line, " %63s 0x%lx 0x%lx %255[^\n]", input, &addr, &size, file) == 4)
+      {
+        addSection(output, input, size, file);
+        input[0] = 0;
+      }
+    }
+    else if (input[0] && sscanf(line, " 0x%lx 0x%lx %255[^\n]", &addr, &size, file) == 3)
+    {
+      // Second line of a long input section name
+      addSection(output, input, size, file);
+      input[0] = 0;
+    }
+    else
+    {
+      // Symbol assignments, *fill* and the linker script itself
+      input[0] = 0;
+    }
+  }
+
+  fclose(in);
+  return 1;
+}
+
+static void readBaseline(const char *path)
+{
+  char line[256], name[MAXNAME];
+  long flash, ram;
+  FILE *in;
+  int m;
+
+  in = fopen(path, "r");
+  if (!in)
+  {
+    fprintf(stderr, "%s: no baseline yet (write one with -w)\n", path);
+    return;
+  }
+  while (fgets(line, sizeof(line), in))
+  {
+    if (line[0] == '#' || sscanf(line, "%63s %ld %ld", name, &flash, &ram) != 3)
+      continue;
+    m = findModule(name);
+    if (m >= 0)
+    {
+      modules[m].baseFlash = flash;
+      modules[m].baseRam = ram;
+    }
+  }
+  fclose(in);
+}
+
+static int writeBaseline(const char *path)
+{
+  FILE *out;
+  int i;
+
+  out = fopen(path, "w");
+  if (!out)
+  {
+    perror(path);
+    return 0;
+  }
+  fprintf(out, "# mapsize baseline: <module> <flash> <ram>\n");
+  for (i = 0; i < moduleCount; i++)
+  {
+    fprintf(out, "%s %lu %lu\n", modules[i].name, flashSize(modules[i].size), ramSize(modules[i].size));
+  }
+  fclose(out);
+  return 1;
+}
+
+/*
+ * Returns 1 if the name is in a space separated list (as in HOT_OBJS)
+ */
+static int inList(const char *list, const char *name)
+{
+  size_t len = strlen(name);
+  const char *p = list;
+
+  while ((p = strstr(p, name)) != NULL)
+  {
+    if ((p == list || p[-1] == ' ') && (p[len] == ' ' || p[len] == 0))
+      return 1;
+    p += len;
+  }
+  return 0;
+}
+
+static int byFlash(const void *a, const void *b)
+{
+  const module_t *ma = a, *mb = b;
+  unsigned long fa = flashSize(ma->size), fb = flashSize(mb->size);
+
+  if (fa != fb)
+    return fa < fb ? 1 : -1;
+  return strcmp(ma->name, mb->name);
+}
+
+static int bySize(const void *a, const void *b)
+{
+  const symbol_t *sa = a, *sb = b;
+
+  if (sa->size != sb->size)
+    return sa->size < sb->size ? 1 : -1;
+  return strcmp(sa->name, sb->name);
+}
+
+/*
+ * Prints the change against the baseline, flagged if it is above the
+ * threshold
+ */
+static int printGrowth(long now, long base, long threshold)
+{
+  if (base < 0)
+  {
+    printf(" %7s", "new");
+    return now > threshold;
+  }
+  if (now == base)
+  {
+    printf(" %7s", "");
+    return 0;
+  }
+  printf(" %+7ld", now - base);
+  return now - base > threshold;
+}
+
+int main(int argc, char **argv)
+{
+  const char *hotObjs = NULL, *baseline = NULL, *output = NULL;
+  unsigned long total[SEC_COUNT] = { 0 };
+  long threshold = 0, baseFlash = 0, baseRam = 0;
+  int count = 20, compare = 0, arg, i, s, grew, flagged = 0;
+
+  for (arg = 1; (arg < argc) && (argv[arg][0] == '-'); arg++)
+  {
+    if (arg + 1 >= argc)
+      usage();
+    if (!strcmp(argv[arg], "-n"))
+      count = atoi(argv[++arg]);
+    else if (!strcmp(argv[arg], "-o"))
+      hotObjs = argv[++arg];
+    else if (!strcmp(argv[arg], "-b"))
+      baseline = argv[++arg];
+    else if (!strcmp(argv[arg], "-w"))
+      output = argv[++arg];
+    else if (!strcmp(argv[arg], "-g"))
+      threshold = atol(argv[++arg]);
+    else
+      usage();
+  }
+  if (arg != argc - 1)
+  {
+    usage();
+  }
+
+  if (!readMap(argv[arg]))
+  {
+    return 1;
+  }
+  if (!moduleCount)
+  {
+    fprintf(stderr, "%s: no memory map found\n", argv[arg]);
+    return 1;
+  }
+  if (output)
+  {
+    return writeBaseline(output) ? 0 : 1;
+  }
+
+  // Modules that are only in the baseline are added with a size of 0
+  if (baseline)
+  {
+    readBaseline(baseline);
+    for (i = 0; i < moduleCount; i++)
+    {
+      if (modules[i].baseFlash >= 0)
+      {
+        compare = 1;
+        baseFlash += modules[i].baseFlash;
+        baseRam += modules[i].baseRam;
+      }
+    }
+  }
+
+  for (i = 0; i < moduleCount; i++)
+  {
+    modules[i].hot = hotObjs && inList(hotObjs, modules[i].name);
+    for (s = 0; s < SEC_COUNT; s++)
+      total[s] += modules[i].size[s];
+  }
+
+  qsort(modules, moduleCount, sizeof(module_t), byFlash);
+
+  printf("%-24s", "Module");
+  for (s = 0; s < SEC_COUNT; s++)
+    printf(" %7s", secNames[s]);
+  printf(" %7s %7s", "Flash", "RAM");
+  if (compare)
+    printf(" %7s %7s", "dFlash", "dRAM");
+  printf("\n");
+
+  for (i = 0; i < moduleCount; i++)
+  {
+    module_t *m = &modules[i];
+    unsigned long flash = flashSize(m->size), ram = ramSize(m->size);
+
+    if (!flash && !ram && m->baseFlash <= 0 && m->baseRam <= 0)
+      continue;
+    printf("%-23s%c", m->name, m->hot ? '*' : ' ');
+    for (s = 0; s < SEC_COUNT; s++)
+      printf(" %7lu", m->size[s]);
+    printf(" %7lu %7lu", flash, ram);
+    if (compare)
+    {
+      grew = printGrowth(flash, m->baseFlash, threshold);
+      grew |= printGrowth(ram, m->baseRam, threshold);
+      if (grew)
+      {
+        printf("  GREW");
+        flagged++;
+      }
+    }
+    printf("\n");
+  }
+
+  printf("%-24s", "Total");
+  for (s = 0; s < SEC_COUNT; s++)
+    printf(" %7lu", total[s]);
+  printf(" %7lu %7lu", flashSize(total), ramSize(total));
+  if (compare)
+  {
+    printGrowth(flashSize(total), baseFlash, threshold);
+    printGrowth(ramSize(total), baseRam, threshold);
+  }
+  printf("\n");
+  if (hotObjs)
+    printf("(* compiled for speed, see HOT_OBJS)\n");
+
+  if (count > 0 && symbolCount)
+  {
+    qsort(symbols, symbolCount, sizeof(symbol_t), bySize);
+    printf("\n%-32s %-8s %7s  %s\n", "Largest functions/variables", "Section", "Bytes", "Module");
+    for (i = 0; i < symbolCount && i < count; i++)
+      printf("%-32s %-8s %7lu  %s\n", symbols[i].name, secNames[symbols[i].sec], symbols[i].size, symbols[i].moduleName);
+  }
+
+  if (flagged)
+    printf("\n%d module(s) grew by more than %ld bytes since the baseline\n", flagged, threshold);
+
+  return 0;
+}
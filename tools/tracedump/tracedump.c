@@ -0,0 +1,296 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2010, microBuilder SARL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the
+ * names of its contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Host side of the trace log in core/bench/trace.c (CFG_TRACE): reads the
+ * raw entries printed by 'y 1' (lines of 'T <format> <time> <args>' in hex,
+ * anything else is skipped, so a whole terminal log can be given) and
+ * formats them with the strings from the firmware's .elf file.
+ *
+ * syntax: tracedump [-m <MHz>] <firmware.elf> [<capture.txt>]
+ *
+ *   -m <MHz>    CPU clock, to turn cycles into microseconds (default 72)
+ *
+ * The entries are read from stdin if no capture file is given. Each line
+ * shows the time in microseconds, the time since the previous entry and
+ * the formatted message.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define SHT_PROGBITS    (1)
+#define SHF_ALLOC       (2)
+
+static uint8_t *elf;
+static long elfSize;
+
+static uint32_t rd16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t rd32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static void usage(void)
+{
+  fprintf(stderr, "syntax: tracedump [-m <MHz>] <firmware.elf> [<capture.txt>]\n");
+  exit(1);
+}
+
+static int loadElf(const char *name)
+{
+  FILE *f = fopen(name, "rb");
+
+  if (!f)
+  {
+    perror(name);
+    return 0;
+  }
+  fseek(f, 0, SEEK_END);
+  elfSize = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  elf = malloc(elfSize);
+  if (!elf || fread(elf, 1, elfSize, f) != (size_t)elfSize)
+  {
+    fprintf(stderr, "%s: read error\n", name);
+    fclose(f);
+    return 0;
+  }
+  fclose(f);
+
+  // 32-bit little endian ELF (ARM)
+  if (elfSize < 52 || memcmp(elf, "\177ELF", 4) || elf[4] != 1 || elf[5] != 1)
+  {
+    fprintf(stderr, "%s: not a 32-bit little endian ELF file\n", name);
+    return 0;
+  }
+  return 1;
+}
+
+/* Returns the string at 'addr' in the image, or NULL if it isn't in any
+   section that is loaded into the device (or has no terminator there)  */
+static const char *elfString(uint32_t addr)
+{
+  uint32_t shoff = rd32(elf + 0x20);
+  uint32_t shentsize = rd16(elf + 0x2E);
+  uint32_t shnum = rd16(elf + 0x30);
+  uint32_t i;
+
+  for (i = 0; i < shnum; i++)
+  {
+    const uint8_t *sh = elf + shoff + i * shentsize;
+    uint32_t type, flags, start, offset, size;
+
+    if (shoff + (i + 1) * shentsize > (uint32_t)elfSize)
+    {
+      break;
+    }
+    type = rd32(sh + 0x04);
+    flags = rd32(sh + 0x08);
+    start = rd32(sh + 0x0C);
+    offset = rd32(sh + 0x10);
+    size = rd32(sh + 0x14);
+    if (type != SHT_PROGBITS || !(flags & SHF_ALLOC) || addr < start || addr - start >= size ||
+        offset + size > (uint32_t)elfSize)
+    {
+      continue;
+    }
+    if (!memchr(elf + offset + (addr - start), 0, size - (addr - start)))
+    {
+      return NULL;
+    }
+    return (const char *)elf + offset + (addr - start);
+  }
+  return NULL;
+}
+
+/* Formats one entry the way the firmware's printf would: the arguments are
+   all 32 bits, and %s arguments are looked up in the image too            */
+static void printEntry(const char *format, const uint32_t *args)
+{
+  char spec[32];
+  const char *s;
+  int arg = 0;
+  size_t n;
+
+  while (*format)
+  {
+    if (*format != '%')
+    {
+      putchar(*format++);
+      continue;
+    }
+    if (format[1] == '%')
+    {
+      putchar('%');
+      format += 2;
+      continue;
+    }
+
+    // Flags, width and precision are passed on, length modifiers dropped
+    n = 0;
+    spec[n++] = *format++;
+    while (*format && strchr("-+ #0123456789.", *format) && n < sizeof(spec) - 2)
+    {
+      spec[n++] = *format++;
+    }
+    while (*format && strchr("hlLqjzt", *format))
+    {
+      format++;
+    }
+    if (!*format)
+    {
+      break;
+    }
+    spec[n++] = *format;
+    spec[n] = 0;
+    if (arg >= 4)
+    {
+      printf("<missing>");
+      format++;
+      continue;
+    }
+
+    switch (*format++)
+    {
+      case 'd':
+      case 'i':
+        printf(spec, (int)(int32_t)args[arg++]);
+        break;
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'o':
+        printf(spec, (unsigned int)args[arg++]);
+        break;
+      case 'c':
+        printf(spec, (int)(args[arg++] & 0xFF));
+        break;
+      case 's':
+        s = elfString(args[arg]);
+        if (s)
+        {
+          printf(spec, s);
+        }
+        else
+        {
+          printf("<%08X>", (unsigned int)args[arg]);
+        }
+        arg++;
+        break;
+      case 'p':
+        printf("0x%08X", (unsigned int)args[arg++]);
+        break;
+      default:
+        printf("%s", spec);
+        break;
+    }
+  }
+  putchar('\n');
+}
+
+int main(int argc, char **argv)
+{
+  char line[256];
+  FILE *in = stdin;
+  unsigned int mhz = 72;
+  uint32_t last = 0;
+  int first = 1;
+  int i;
+
+  for (i = 1; i < argc && argv[i][0] == '-'; i++)
+  {
+    if (!strcmp(argv[i], "-m") && i + 1 < argc)
+    {
+      mhz = strtoul(argv[++i], NULL, 0);
+    }
+    else
+    {
+      usage();
+    }
+  }
+  if (i >= argc || i + 2 < argc || !mhz)
+  {
+    usage();
+  }
+  if (!loadElf(argv[i]))
+  {
+    return 1;
+  }
+  if (i + 1 < argc)
+  {
+    in = fopen(argv[i + 1], "r");
+    if (!in)
+    {
+      perror(argv[i + 1]);
+      return 1;
+    }
+  }
+
+  while (fgets(line, sizeof(line), in))
+  {
+    unsigned int f, t, a[4], dropped;
+    uint32_t args[4];
+    const char *format;
+
+    if (sscanf(line, "T %x %x %x %x %x %x", &f, &t, &a[0], &a[1], &a[2], &a[3]) == 6)
+    {
+      args[0] = a[0];
+      args[1] = a[1];
+      args[2] = a[2];
+      args[3] = a[3];
+      printf("%10u %+9d  ", (unsigned int)(t / mhz), first ? 0 : (int)((uint32_t)(t - last) / mhz));
+      last = t;
+      first = 0;
+
+      format = elfString(f);
+      if (format)
+      {
+        printEntry(format, args);
+      }
+      else
+      {
+        printf("<unknown format %08X> %08X %08X %08X %08X\n", f, a[0], a[1], a[2], a[3]);
+      }
+    }
+    else if (sscanf(line, "D %x", &dropped) == 1 && dropped)
+    {
+      printf("(%u entries dropped)\n", dropped);
+    }
+  }
+
+  if (in != stdin)
+  {
+    fclose(in);
+  }
+  free(elf);
+
+  return 0;
+}
@@ -42,6 +42,22 @@
     all frames will be in IEEE 802.15.4 format. After that, it is up to the user
     to choose any higher layer protocols to decode above 802.15.4 via the
     wireshark "enable protocols" menu. 
+
+    Each frame arrives on the serial port as:
+
+      [0xA5] [len] [timestamp (4 bytes, LSB first)] [len bytes of frame]
+
+    The timestamp is the time (in microseconds, wrapping around every 71
+    minutes) at which the sniffer started receiving the frame. The first
+    frame is anchored to the PC clock, and every later frame is stamped
+    with the PC time of the first one plus the elapsed sniffer time, so
+    the inter-frame timing doesn't depend on serial or USB latency.
+
+    Each pcap record (header and frame) is built in one piece and queued
+    in a ring buffer, and the pipe is non-blocking and drained by poll()
+    in large writes, so a slow Wireshark only fills the ring instead of
+    stalling the serial reads.  If the ring does fill up, whole records
+    are dropped and counted.
 */
 /**************************************************************************/
 #include <stddef.h>
@@ -50,35 +66,54 @@
 #include <string.h>
 #include <errno.h>
 #include <time.h>
+#include <sys/time.h>
+#include <unistd.h>
 #include <stdint.h>
 #include <signal.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <termios.h>
+#include <poll.h>
 
-#define PORTBUFSIZE     32
-#define BUFSIZE         1024
+#define PORTBUFSIZE     512
+#define RINGSIZE        (256 * 1024)
+#define RECORD_HDRSZ    16
+#define FRAMESIZE       127
 #define PACKET_FCS      2
-#define DEBUG           1
+#define PACKET_SYNC     0xA5
+#define PACKET_TIMESZ   4
+#define DEBUG           0
 #define PIPENAME        "/tmp/wireshark"
 #define BAUDRATE        B115200
 
 enum FSM
 {
-    START_CAPTURE,
+    WAIT_SYNC,
+    GET_LEN,
+    GET_TIME,
     PACKET_CAPTURE
 };
 
 static int FD_pipe = -1;
 static int FD_com = -1;
 static uint8_t port_buf[PORTBUFSIZE];
-static uint8_t circ_buf[BUFSIZE];
-static uint16_t rd_idx = 0;
-static uint16_t wr_idx = 0;
+static uint8_t frame_buf[FRAMESIZE];
 static uint8_t len;
-static uint8_t state = START_CAPTURE;
-static uint8_t file_write = 0;
+static uint8_t byte_ctr;
+static uint32_t frame_time;
+static uint8_t state = WAIT_SYNC;
+
+// pcap data waiting for the pipe
+static uint8_t ring[RINGSIZE];
+static size_t ring_head;            // next byte to write to the pipe
+static size_t ring_count;           // bytes queued
+static unsigned long dropped;
+
+// sniffer time of the last frame and the pc time it corresponds to (usec)
+static int anchored = 0;
+static uint32_t last_time;
+static uint64_t host_usec;
 
 /**************************************************************************/
 /*!
@@ -99,6 +134,10 @@ static int serial_open(char *portname)
     }
     else
     {
+        // raw mode, so that no byte in a frame gets translated or eaten
+        tcgetattr(FD_com, &term);
+        cfmakeraw(&term);
+
         // set speed of port
         cfsetspeed(&term, BAUDRATE);
 
@@ -136,22 +175,75 @@ static void named_pipe_create(char *name)
         perror("Error connecting to named pipe");
         exit(1);
     }
+
+    // from now on the pipe is only written when poll() says there's room
+    fcntl(FD_pipe, F_SETFL, fcntl(FD_pipe, F_GETFL) | O_NONBLOCK);
 }
 
 /**************************************************************************/
 /*!
-    Write data to the pipe
+    Queue data for the pipe. Returns 0 (and queues nothing) if it doesn't
+    all fit in the ring buffer.
 */
 /**************************************************************************/
-size_t data_write(const void *ptr, size_t size)
+static int data_write(const void *ptr, size_t size)
 {
-    ssize_t bytes = 0;
-    if (FD_pipe != -1) 
+    const uint8_t *data = ptr;
+    size_t tail, n;
+
+    if (size > RINGSIZE - ring_count)
+    {
+        return 0;
+    }
+
+    // copy in at most two pieces, up to the end of the ring and from the start
+    tail = (ring_head + ring_count) % RINGSIZE;
+    n = (size < RINGSIZE - tail) ? size : RINGSIZE - tail;
+    memcpy(&ring[tail], data, n);
+    memcpy(ring, data + n, size - n);
+    ring_count += size;
+    return 1;
+}
+
+/**************************************************************************/
+/*!
+    Send as much of the ring buffer to the pipe as it will take without
+    blocking.
+*/
+/**************************************************************************/
+static void pipe_flush(void)
+{
+    ssize_t bytes;
+    size_t n;
+
+    while (ring_count)
     {
-        bytes = write(FD_pipe, ptr, size);
+        n = (ring_count < RINGSIZE - ring_head) ? ring_count : RINGSIZE - ring_head;
+        bytes = write(FD_pipe, &ring[ring_head], n);
+        if (bytes <= 0)
+        {
+            if ((bytes < 0) && (errno != EAGAIN) && (errno != EINTR))
+            {
+                perror("Error writing to named pipe");
+                exit(1);
+            }
+            return;
+        }
+        ring_head = (ring_head + bytes) % RINGSIZE;
+        ring_count -= bytes;
     }
 }
 
+static void put32(uint8_t *p, uint32_t val)
+{
+    memcpy(p, &val, sizeof(val));   // pcap fields are in host byte order
+}
+
+static void put16(uint8_t *p, uint16_t val)
+{
+    memcpy(p, &val, sizeof(val));
+}
+
 /**************************************************************************/
 /*!
     Write the global header to wireshark. This is only done once at the
@@ -160,93 +252,72 @@ size_t data_write(const void *ptr, size_t size)
 /**************************************************************************/
 static void write_global_hdr()
 {
-    uint32_t magic_number = 0xa1b2c3d4; /* magic number */
-    uint16_t version_major = 2; /* major version number */
-    uint16_t version_minor = 4; /* minor version number */
-    int32_t thiszone = 0;       /* GMT to local correction */
-    uint32_t sigfigs = 0;       /* accuracy of timestamps */
-    uint32_t snaplen = 65535;   /* max length of captured packets, in octets */
-    uint32_t network = 195;     /* data link type (DLT) - IEEE 802.15.4 */
-
-    data_write(&magic_number, sizeof(magic_number));
-    data_write(&version_major, sizeof(version_major));
-    data_write(&version_minor, sizeof(version_minor));
-    data_write(&thiszone, sizeof(thiszone));
-    data_write(&sigfigs, sizeof(sigfigs));
-    data_write(&snaplen, sizeof(snaplen));
-    data_write(&network, sizeof(network));
+    uint8_t hdr[24];
+
+    put32(&hdr[0], 0xa1b2c3d4);     /* magic number */
+    put16(&hdr[4], 2);              /* major version number */
+    put16(&hdr[6], 4);              /* minor version number */
+    put32(&hdr[8], 0);              /* GMT to local correction */
+    put32(&hdr[12], 0);             /* accuracy of timestamps */
+    put32(&hdr[16], 65535);         /* max length of captured packets, in octets */
+    put32(&hdr[20], 195);           /* data link type (DLT) - IEEE 802.15.4 */
+
+    data_write(hdr, sizeof(hdr));
+    pipe_flush();
 }
 
 /**************************************************************************/
 /*!
-    Write the frame header into wireshark. This is required for the libpcap
+    Fill in the frame header for wireshark. This is required for the libpcap
     format and informs wireshark that a new frame is coming.
 */
 /**************************************************************************/
-static void write_frame_hdr(uint8_t len)
+static void write_frame_hdr(uint8_t *hdr, uint8_t len, uint32_t timestamp)
 {
-    uint32_t ts_sec;    /* timestamp seconds */
-    uint32_t ts_usec;   /* timestamp microseconds */
-    uint32_t incl_len;  /* number of octets of packet saved in file */
-    uint32_t orig_len;  /* actual length of packet */
     struct timeval tv;
 
-    gettimeofday(&tv, NULL);
-    ts_sec      = tv.tv_sec;
-    ts_usec     = tv.tv_usec;
-    incl_len    = len;
-    orig_len    = len + PACKET_FCS;
+    if (!anchored)
+    {
+        // first frame: line the sniffer clock up with ours
+        gettimeofday(&tv, NULL);
+        host_usec = (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+        anchored = 1;
+    }
+    else
+    {
+        // unsigned subtraction takes care of the 32-bit wraparound
+        host_usec += (uint32_t)(timestamp - last_time);
+    }
+    last_time = timestamp;
 
-    data_write(&ts_sec, sizeof(ts_sec));
-    data_write(&ts_usec, sizeof(ts_usec));
-    data_write(&incl_len, sizeof(incl_len));
-    data_write(&orig_len, sizeof(orig_len));
+    put32(&hdr[0], host_usec / 1000000);    /* timestamp seconds */
+    put32(&hdr[4], host_usec % 1000000);    /* timestamp microseconds */
+    put32(&hdr[8], len);                    /* number of octets of packet saved in file */
+    put32(&hdr[12], len + PACKET_FCS);      /* actual length of packet */
 }
 
 /**************************************************************************/
 /*!
-    Write one frame into wireshark (via the pipe).
+    Queue one frame for wireshark (via the pipe).
 */
 /**************************************************************************/
-static void write_frame(uint8_t frame_len)
+static void write_frame(uint8_t frame_len, uint32_t timestamp)
 {
-    uint8_t i;
+    uint8_t record[RECORD_HDRSZ + FRAMESIZE];
 
     // actual frame length for wireshark should not include FCS
     frame_len -= PACKET_FCS;
 
-    // write header to inform WS that new frame has arrived
-    write_frame_hdr(frame_len);
-
-    // bump rd_idx. we don't want to write the length byte
-    rd_idx = (rd_idx + 1) % BUFSIZE;
+    // header to inform WS that new frame has arrived, followed by the frame.
+    // we're not using the trailing FCS value
+    write_frame_hdr(record, frame_len, timestamp);
+    memcpy(&record[RECORD_HDRSZ], frame_buf, frame_len);
 
-    // write frame into wireshark
-    for (i=0; i<frame_len; i++)
+    // a record is queued whole or not at all, so the capture stays in sync
+    if (!data_write(record, RECORD_HDRSZ + frame_len))
     {
-        data_write(&circ_buf[rd_idx], 1);
-        rd_idx = (rd_idx + 1) % BUFSIZE;
-    }
-
-    // bump rd_idx. we're not using the trailing FCS value
-    rd_idx = (rd_idx + 1) % BUFSIZE;
-}
-
-/**************************************************************************/
-/*!
-    Calculate total number of bytes in buffer.
-*/
-/**************************************************************************/
-static uint16_t calc_bytes_in_buf()
-{
-    if (rd_idx > wr_idx)
-    {
-        // read index is greater than write. we must have wrapped around
-        return (BUFSIZE - (rd_idx - wr_idx));
-    }
-    else
-    {
-        return (wr_idx - rd_idx);
+        dropped++;
+        printf("Wireshark isn't keeping up, %lu frames dropped.\n", dropped);
     }
 }
 
@@ -294,8 +365,9 @@ static void signal_init(void)
 /**************************************************************************/
 int main(int argc, char *argv[])
 {
+    struct pollfd fds[2];
     int nbytes;
-    uint8_t i;
+    int i;
 
     // capture any signals that will terminate program
     signal_init();
@@ -333,87 +405,105 @@ int main(int argc, char *argv[])
         printf("Client connected to pipe.\n");
     }
 
+    fds[0].fd = FD_com;
+    fds[0].events = POLLIN;
+    fds[1].fd = FD_pipe;
+
     for (;;) 
     {
-        uint16_t bytes_in_buf;
-        uint8_t frame_len, byte_ctr;
+        // wait for serial data, or for room in the pipe if anything is queued
+        fds[1].events = ring_count ? POLLOUT : 0;
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("poll");
+            exit(1);
+        }
+
+        if (fds[1].revents & (POLLOUT | POLLERR | POLLHUP))
+        {
+            pipe_flush();
+        }
 
-        // wait for data to come in on the serial port
-        if ((nbytes = read(FD_com, port_buf, PORTBUFSIZE)) > 0)
+        if (!(fds[0].revents & POLLIN))
         {
-            // write data to circular buffer. loop through all received bytes
+            continue;
+        }
+
+        // read everything the serial port has
+        while ((nbytes = read(FD_com, port_buf, PORTBUFSIZE)) > 0)
+        {
+            // loop through all received bytes
             for (i=0; i<nbytes; i++)
             {
                 switch (state)
                 {
-                    case START_CAPTURE:
-                        // new frame starting
+                    case WAIT_SYNC:
+                        // skip anything until the start of a frame
+                        if (port_buf[i] == PACKET_SYNC)
+                        {
+                            state = GET_LEN;
+                        }
+                        break;
+
+                    case GET_LEN:
                         len = port_buf[i];
-                        byte_ctr = 0;
+                        if ((len <= PACKET_FCS) || (len > FRAMESIZE))
+                        {
+                            // not a valid frame length. we must have lost sync
+                            state = WAIT_SYNC;
+                            break;
+                        }
 
+#if DEBUG
                         printf("Len = %02X.\n", len);
-
-                        circ_buf[wr_idx] = len;
-                        wr_idx = (wr_idx + 1) % BUFSIZE;
-                        state = PACKET_CAPTURE;
+#endif
+                        frame_time = 0;
+                        byte_ctr = 0;
+                        state = GET_TIME;
                         break;
 
+                    case GET_TIME:
+                        // timestamp, lsb first
+                        frame_time |= (uint32_t)port_buf[i] << (8 * byte_ctr);
+                        byte_ctr++;
+                        if (byte_ctr == PACKET_TIMESZ)
+                        {
+                            byte_ctr = 0;
+                            state = PACKET_CAPTURE;
+                        }
+                        break;
 
                     case PACKET_CAPTURE:
                         // continue capturing bytes until end of frame
-
-                        // write data to circular buffer and increment index
-                        circ_buf[wr_idx] = port_buf[i];
+                        frame_buf[byte_ctr] = port_buf[i];
                         
-                        printf("%02X ", circ_buf[wr_idx]);
-
-                        wr_idx = (wr_idx + 1) % BUFSIZE;
+#if DEBUG
+                        printf("%02X ", frame_buf[byte_ctr]);
+#endif
 
-                        // track number of received bytes. when received bytes
-                        // equals frame length, then restart state machine and 
-                        // write bytes to wireshark
+                        // when received bytes equals frame length, then restart
+                        // state machine and write the frame to wireshark
                         byte_ctr++;
-                        if (byte_ctr == (len - 1))
+                        if (byte_ctr == len)
                         {
-                            state = START_CAPTURE;
-                            file_write = 1;
+#if DEBUG
                             printf("\n");
+#endif
+                            write_frame(len, frame_time);
+                            state = WAIT_SYNC;
                         }
                         break;
                 }
-                fflush(stdout);
-            }
-
-            // at least one frame has been written. loop through circular buffer 
-            // and write out all completed frames
-            while (file_write)
-            {
-                // capture frame length and check buffer to see if one or more frames 
-                // are available.
-                frame_len = circ_buf[rd_idx];
-                bytes_in_buf = calc_bytes_in_buf();
-            
-                if (bytes_in_buf > frame_len)
-                {
-                    // if more than one frame is available, then write one frame to 
-                    // wireshark and then see if any more are available.
-                    write_frame(frame_len);
-                }
-                else if (bytes_in_buf == frame_len)
-                {
-                    // only one frame is available. write to wireshark and then quit
-                    // the loop
-                    write_frame(frame_len);
-                    file_write = 0;
-                }
-                else
-                {
-                    // less than one frame is available. quit the loop and collect more 
-                    // bytes. we normally should not get here.
-                    file_write = 0;
-                }
             }
         }
+        fflush(stdout);
+
+        // try to pass the new frames on straight away
+        pipe_flush();
     }
 }
 
@@ -10,25 +10,32 @@ namespace wsbridge
         static NamedPipeServerStream wspipe;
         static BinaryWriter ws;
         static SerialPort p;
-        const uint BUFSIZE = 1024;
-        static byte[] b = new byte[BUFSIZE];
-        static uint wr_idx = 0;
-        static uint rd_idx = 0;
+        const uint FRAMESIZE = 127;
+        static byte[] b = new byte[FRAMESIZE];
         static byte len;
         static FSM state;
-        static bool file_write = false;
         static long start_time_in_ticks;
         static byte byte_ctr;
+        static uint frame_time;
         static String port;
 
+        // sniffer time of the last frame and the elapsed time it corresponds to (usec)
+        static bool anchored = false;
+        static uint last_time;
+        static long elapsed_usec;
+
         enum FSM
         {
-            START_CAPTURE,
+            WAIT_SYNC,
+            GET_LEN,
+            GET_TIME,
             PACKET_CAPTURE
         }
 
+        // each frame arrives as [0xA5] [len] [timestamp (4 bytes, LSB first, usec)] [len bytes of frame]
         const int PACKET_FCS = 2;
-        const int PACKET_LEN = 1;
+        const byte PACKET_SYNC = 0xA5;
+        const int PACKET_TIMESZ = 4;
         const bool DEBUG_PRINT = true;
 
         static void Main(string[] args)
@@ -91,7 +98,7 @@ namespace wsbridge
 
             // add serial data capture
             p.DataReceived += new SerialDataReceivedEventHandler(serialPort_DataReceived);
-            state = FSM.START_CAPTURE;
+            state = FSM.WAIT_SYNC;
             
             // keep track of time started. this will be used for timestamps
             start_time_in_ticks = DateTime.Now.Ticks; 
@@ -108,97 +115,73 @@ namespace wsbridge
         // serial port handler. this gets executed whenever data is available on the serial port
         static void serialPort_DataReceived(object sender, System.IO.Ports.SerialDataReceivedEventArgs e)
         {
-            uint frame_len, bytes_in_buf;
+            byte data;
 
             // loop until serial port buffer is empty
             while (p.BytesToRead != 0)
             {
+                data = (byte)p.ReadByte();
                 switch (state)
                 {
-                    case FSM.START_CAPTURE:
-                        // starting a new frame. the first byte will indicate the length
-                        len = (byte)p.ReadByte();
-                        b[wr_idx] = len;
-                        byte_ctr = 0;
+                    case FSM.WAIT_SYNC:
+                        // skip anything until the start of a frame
+                        if (data == PACKET_SYNC)
+                        {
+                            state = FSM.GET_LEN;
+                        }
+                        break;
+
+                    case FSM.GET_LEN:
+                        // the length of the frame (including the FCS)
+                        len = data;
+                        if ((len <= PACKET_FCS) || (len > FRAMESIZE))
+                        {
+                            // not a valid frame length. we must have lost sync
+                            state = FSM.WAIT_SYNC;
+                            break;
+                        }
 
                         if (DEBUG_PRINT)
                         {
                             Console.WriteLine();
-                            Console.Write(String.Format("{0,2:X}", b[wr_idx]) + ' ');
+                            Console.Write(String.Format("{0,2:X}", len) + ' ');
                         }
 
-                        // increment the buffer index and wrap back to 0 if it reaches the max size
-                        // (standard circular buffer behavior)
-                        wr_idx = (wr_idx + 1) % BUFSIZE;
-                        state = FSM.PACKET_CAPTURE;
+                        frame_time = 0;
+                        byte_ctr = 0;
+                        state = FSM.GET_TIME;
+                        break;
+
+                    case FSM.GET_TIME:
+                        // timestamp from the sniffer, lsb first
+                        frame_time |= (uint)data << (8 * byte_ctr);
+                        byte_ctr++;
+                        if (byte_ctr == PACKET_TIMESZ)
+                        {
+                            byte_ctr = 0;
+                            state = FSM.PACKET_CAPTURE;
+                        }
                         break;
 
                     case FSM.PACKET_CAPTURE:
                         // capture bytes until the total length of the frame
-                        b[wr_idx] = (byte)p.ReadByte();
+                        b[byte_ctr] = data;
 
                         if (DEBUG_PRINT)
                         {
-                            Console.Write(String.Format("{0,2:X}", b[wr_idx]) + ' ');
+                            Console.Write(String.Format("{0,2:X}", data) + ' ');
                         }
 
-                        wr_idx = (wr_idx + 1) % BUFSIZE;
+                        // we've captured all bytes in frame. write it into wireshark
                         byte_ctr++;
-
-                        // we've captured all bytes in frame. tell the next section we're ready to write
-                        // the frame into wireshark
-                        if (byte_ctr == (len - 1))
+                        if (byte_ctr == len)
                         {
-                            state = FSM.START_CAPTURE;
-                            file_write = true;
+                            write_frame(len, frame_time);
+                            state = FSM.WAIT_SYNC;
                         }
                         break;
                 }
             }
-
-            // at least one frame has been captured. write it into wireshark
-            while (file_write == true)
-            {
-                frame_len = b[rd_idx];
-                bytes_in_buf = calc_bytes_in_buf();
-
-                // compare the frame lengto the number of bytes in the buffer. if the bytes in buffer are
-                // greater than the frame length, then we have more than one frame. loop through until 
-                // all complete frames have been written to wireshark
-                if (bytes_in_buf > frame_len)
-                {
-                    // more than one frame in buffer. don't indicate we're finished yet in case we have 
-                    // other frames we can send out.
-                    write_frame(frame_len);
-                }
-                else if (bytes_in_buf == frame_len)
-                {
-                    // only one frame in buffer. indicate we're finished after we write this frame out.
-                    write_frame(frame_len);
-                    file_write = false;
-                }
-                else
-                {
-                    // what?! no frames in buffer? we shouldn't reach here. 
-                    file_write = false;
-                }
-            }
-        }
-
-        // return the number of bytes in the buffer
-        static uint calc_bytes_in_buf()
-        {
-            if (rd_idx > wr_idx)
-            {
-                // since we're using a circular buffer, its possible for the write index to be less
-                // than the read index if a wraparound occurred. handle this case here.
-                return (BUFSIZE - (rd_idx - wr_idx));
-            }
-            else
-            {
-                // normal way to calculate bytes in the buffer
-                return (wr_idx - rd_idx);
-            }
         }
 
         // this is the global header that starts any packet capture file. this will tell wireshark what 
@@ -252,43 +235,44 @@ namespace wsbridge
 
         // this writes a frame into wireshark. it calculates the timestamp and length and uses that 
         // for the frame header. it then writes captured bytes into wireshark
-        static void write_frame(uint frame_len)
+        static void write_frame(uint frame_len, uint timestamp)
         {
             uint incl_len, orig_len;
             long sec, usec;
 
-            // generating timestamp. its kind of cheesy but there isn't a unix timestamp mechanism in win. 
-            // just counting ticks from when program was started. each tick is 100 nsec. 
-            long diff_in_ticks = DateTime.Now.Ticks - start_time_in_ticks;  // get difference in ticks
-            sec = diff_in_ticks / TimeSpan.TicksPerSecond;                  // get seconds
-            diff_in_ticks -= (sec * TimeSpan.TicksPerSecond);               // subtract off seconds from total
-            usec = diff_in_ticks / 10;                                      // get usec
+            // generating timestamp. the first frame is stamped with the time since the program was
+            // started (each tick is 100 nsec). after that, the sniffer's own timestamps are used so 
+            // that the spacing between frames is accurate. unsigned subtraction handles the wraparound.
+            if (!anchored)
+            {
+                elapsed_usec = (DateTime.Now.Ticks - start_time_in_ticks) / 10;
+                anchored = true;
+            }
+            else
+            {
+                elapsed_usec += (uint)(timestamp - last_time);
+            }
+            last_time = timestamp;
+            sec = elapsed_usec / 1000000;
+            usec = elapsed_usec % 1000000;
 
             // calculate frame length. we won't be feeding frame checksum (FCS) into wireshark. 
             incl_len = (uint)frame_len - PACKET_FCS;
             orig_len = frame_len;
 
-            // increment over the length byte. we won't feed that into wireshark either. it doesn't seem to like it. 
-            rd_idx = (rd_idx + 1) % BUFSIZE;
-
             // write frame header first
             write_frm_hdr(sec, usec, incl_len, orig_len);
 
-            // loop through entire length and write data into wireshark
-            for (int i = 0; i < incl_len; i++)
+            // write the frame data into wireshark
+            try
             {
-                try
-                {
-                    ws.Write(b[rd_idx]);
-                }
-                catch
-                {
-                    Console.WriteLine("Pipe has been closed.");
-                    close();
-                }
-                rd_idx = (rd_idx + 1) % BUFSIZE;
+                ws.Write(b, 0, (int)incl_len);
+            }
+            catch
+            {
+                Console.WriteLine("Pipe has been closed.");
+                close();
             }
-            rd_idx = (rd_idx + 1) % BUFSIZE;
         }
 
         // Received some type of termination. Close everything and wrap up.